@@ -0,0 +1,82 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace pw::allocator {
+namespace {
+
+// Returns the number of bytes needed to align ptr, which may be past end.
+size_t AlignmentPadding(const std::byte* ptr, size_t alignment) {
+  const uintptr_t misalignment =
+      reinterpret_cast<uintptr_t>(ptr) & (alignment - 1);
+  return misalignment == 0u ? 0u : alignment - misalignment;
+}
+
+}  // namespace
+
+void* Arena::DoAllocate(size_t size, size_t alignment) {
+  size_t padding = AlignmentPadding(position_, alignment);
+  const size_t available = static_cast<size_t>(end_ - position_);
+
+  if (padding > available || size > available - padding) {
+    if (!AddChunk(size, alignment)) {
+      return nullptr;
+    }
+    padding = AlignmentPadding(position_, alignment);
+  }
+
+  std::byte* ptr = position_ + padding;
+  position_ = ptr + size;
+  return ptr;
+}
+
+bool Arena::AddChunk(size_t size, size_t alignment) {
+  if (parent_ == nullptr) {
+    return false;
+  }
+
+  // Leave room for the header and for aligning the allocation after it.
+  const size_t chunk_size =
+      std::max(chunk_size_, sizeof(Chunk) + alignment - 1 + size);
+  void* memory = parent_->Allocate(chunk_size, alignof(Chunk));
+  if (memory == nullptr) {
+    return false;
+  }
+
+  Chunk* chunk = static_cast<Chunk*>(memory);
+  chunk->previous = chunks_;
+  chunk->end = static_cast<std::byte*>(memory) + chunk_size;
+
+  chunks_ = chunk;
+  position_ = reinterpret_cast<std::byte*>(chunk + 1);
+  end_ = chunk->end;
+  return true;
+}
+
+void Arena::Rewind(Checkpoint checkpoint) {
+  while (chunks_ != checkpoint.chunk_) {
+    Chunk* previous = chunks_->previous;
+    parent_->Deallocate(chunks_);
+    chunks_ = previous;
+  }
+
+  position_ = checkpoint.position_;
+  end_ = chunks_ == nullptr ? buffer_.data() + buffer_.size() : chunks_->end;
+}
+
+}  // namespace pw::allocator
@@ -0,0 +1,172 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/arena.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_allocator/allocator.h"
+#include "pw_allocator/freelist_heap.h"
+
+namespace pw::allocator {
+namespace {
+
+bool IsAligned(const void* ptr, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(ptr) % alignment == 0u;
+}
+
+TEST(Arena, AllocatesFromFrontOfBuffer) {
+  alignas(16) std::byte buffer[64];
+  Arena arena(buffer);
+
+  void* ptr1 = arena.Allocate(10, 1);
+  void* ptr2 = arena.Allocate(6, 1);
+  EXPECT_EQ(ptr1, &buffer[0]);
+  EXPECT_EQ(ptr2, &buffer[10]);
+}
+
+TEST(Arena, AlignsAllocations) {
+  alignas(16) std::byte buffer[64];
+  Arena arena(buffer);
+
+  ASSERT_NE(arena.Allocate(1, 1), nullptr);
+  void* ptr = arena.Allocate(4, 8);
+  EXPECT_EQ(ptr, &buffer[8]);
+  EXPECT_TRUE(IsAligned(arena.Allocate(1), alignof(std::max_align_t)));
+}
+
+TEST(Arena, ReturnsNullWhenFull) {
+  alignas(16) std::byte buffer[32];
+  Arena arena(buffer);
+
+  EXPECT_NE(arena.Allocate(32, 1), nullptr);
+  EXPECT_EQ(arena.Allocate(1, 1), nullptr);
+}
+
+TEST(Arena, AlignmentPaddingCountsAgainstSpace) {
+  alignas(16) std::byte buffer[16];
+  Arena arena(buffer);
+
+  ASSERT_NE(arena.Allocate(1, 1), nullptr);
+  EXPECT_EQ(arena.Allocate(9, 8), nullptr);
+  EXPECT_EQ(arena.Allocate(8, 8), &buffer[8]);
+}
+
+TEST(Arena, RewindReleasesLaterAllocations) {
+  alignas(16) std::byte buffer[64];
+  Arena arena(buffer);
+
+  ASSERT_NE(arena.Allocate(8, 1), nullptr);
+  const Arena::Checkpoint checkpoint = arena.checkpoint();
+  void* ptr = arena.Allocate(40, 1);
+  ASSERT_NE(ptr, nullptr);
+
+  arena.Rewind(checkpoint);
+  EXPECT_EQ(arena.Allocate(40, 1), ptr);
+}
+
+TEST(Arena, ScopeRewindsOnExit) {
+  alignas(16) std::byte buffer[64];
+  Arena arena(buffer);
+
+  void* ptr;
+  {
+    Arena::Scope scope(arena);
+    ptr = arena.Allocate(64, 1);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(arena.Allocate(1, 1), nullptr);
+  }
+  EXPECT_EQ(arena.Allocate(64, 1), ptr);
+}
+
+TEST(Arena, ResetReleasesEverything) {
+  alignas(16) std::byte buffer[64];
+  Arena arena(buffer);
+
+  ASSERT_NE(arena.Allocate(64, 1), nullptr);
+  arena.Reset();
+  EXPECT_EQ(arena.Allocate(1, 1), &buffer[0]);
+}
+
+class ArenaWithParent : public ::testing::Test {
+ protected:
+  static constexpr size_t kChunkSize = 128;
+
+  ArenaWithParent()
+      : heap_(heap_buffer_),
+        parent_(heap_),
+        arena_(arena_buffer_, &parent_, kChunkSize) {}
+
+  alignas(Block) std::byte heap_buffer_[1024] = {};
+  FreeListHeapBuffer<> heap_;
+  HeapAllocator<FreeListHeapBuffer<>> parent_;
+  alignas(16) std::byte arena_buffer_[32];
+  Arena arena_;
+};
+
+TEST_F(ArenaWithParent, ChainsChunksWhenBufferIsFull) {
+  ASSERT_NE(arena_.Allocate(32, 1), nullptr);
+
+  void* ptr = arena_.Allocate(16, 1);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_GE(static_cast<std::byte*>(ptr), &heap_buffer_[0]);
+  EXPECT_LT(static_cast<std::byte*>(ptr), &heap_buffer_[sizeof(heap_buffer_)]);
+  EXPECT_EQ(heap_.heap_stats().total_allocate_calls, 1u);
+
+  // Further allocations use the same chunk until it is full.
+  ASSERT_NE(arena_.Allocate(16, 1), nullptr);
+  EXPECT_EQ(heap_.heap_stats().total_allocate_calls, 1u);
+}
+
+TEST_F(ArenaWithParent, LargeAllocationGetsLargerChunk) {
+  void* ptr = arena_.Allocate(kChunkSize * 2, 8);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_TRUE(IsAligned(ptr, 8));
+}
+
+TEST_F(ArenaWithParent, RewindReturnsChunksToParent) {
+  ASSERT_NE(arena_.Allocate(16, 1), nullptr);
+  {
+    Arena::Scope scope(arena_);
+    ASSERT_NE(arena_.Allocate(kChunkSize, 1), nullptr);
+    ASSERT_NE(arena_.Allocate(kChunkSize, 1), nullptr);
+    EXPECT_EQ(heap_.heap_stats().total_allocate_calls, 2u);
+  }
+  EXPECT_EQ(heap_.heap_stats().total_free_calls, 2u);
+
+  // The rest of the original buffer is used again.
+  EXPECT_EQ(arena_.Allocate(16, 1), &arena_buffer_[16]);
+}
+
+TEST_F(ArenaWithParent, FailsWhenParentIsFull) {
+  EXPECT_EQ(arena_.Allocate(sizeof(heap_buffer_), 1), nullptr);
+}
+
+TEST(HeapAllocator, AllocatesFromHeap) {
+  alignas(Block) std::byte buffer[256] = {};
+  FreeListHeapBuffer<> heap(buffer);
+  HeapAllocator allocator(heap);
+
+  void* ptr = allocator.Allocate(32, alignof(Block));
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(heap.heap_stats().total_allocate_calls, 1u);
+
+  allocator.Deallocate(ptr);
+  allocator.Deallocate(nullptr);
+  EXPECT_EQ(heap.heap_stats().total_free_calls, 1u);
+}
+
+}  // namespace
+}  // namespace pw::allocator
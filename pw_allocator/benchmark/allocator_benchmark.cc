@@ -0,0 +1,409 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program replays a sequence of allocations and frees against each heap
+// in pw_allocator and against the system allocator, and logs the time per
+// operation, the peak footprint, and how fragmentation develops. It runs on
+// the host.
+//
+//   allocator_benchmark [--buckets=16,32,...] [trace_file]
+//
+// Without a trace file, a synthetic workload is generated. A trace file has one
+// operation per line; lines starting with # are ignored.
+//
+//   a <id> <size>  Allocate size bytes. The id may be any integer, such as the
+//                  address returned by the device's allocator.
+//   f <id>         Free the allocation with the id.
+//
+// --buckets runs an additional FreeListHeap with the given bucket sizes.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "pw_allocator/allocator.h"
+#include "pw_allocator/block.h"
+#include "pw_allocator/freelist_heap.h"
+#include "pw_allocator/heap_metrics.h"
+#include "pw_allocator/slab_heap.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_random/xor_shift.h"
+
+namespace {
+
+using pw::allocator::Allocator;
+using pw::allocator::Block;
+using pw::allocator::FreeListBuffer;
+using pw::allocator::FreeListHeap;
+using pw::allocator::FreeListHeapBuffer;
+using pw::allocator::HeapAllocator;
+using pw::allocator::HeapMetrics;
+using pw::allocator::SlabHeap;
+using pw::allocator::SlabHeapBuffer;
+using pw::allocator::TlsfHeapBuffer;
+using pw::chrono::SystemClock;
+
+constexpr size_t kHeapSizeBytes = 64 * 1024;
+constexpr size_t kMaxBuckets = 8;
+
+// The number of times fragmentation is sampled while replaying.
+constexpr size_t kFragmentationSamples = 10;
+
+alignas(Block) std::array<std::byte, kHeapSizeBytes> heap_region;
+
+// Operations refer to allocations by a dense slot index, which is reused once
+// the allocation in it is freed.
+struct Operation {
+  bool allocate;
+  uint32_t slot;
+  uint32_t size;
+};
+
+std::vector<Operation> operations;
+std::vector<void*> slots;
+
+constexpr std::array<SlabHeap::Slab, 3> kSlabs = {
+    SlabHeap::Slab(32, 64),
+    SlabHeap::Slab(64, 64),
+    SlabHeap::Slab(128, 32),
+};
+
+// Allocates from the C library's malloc and free, for comparison.
+class SystemAllocator final : public Allocator {
+ private:
+  void* DoAllocate(size_t size, size_t) override { return std::malloc(size); }
+  void DoDeallocate(void* ptr) override { std::free(ptr); }
+};
+
+// Generates a steady-state workload of mostly small allocations with random
+// lifetimes.
+void GenerateOperations() {
+  constexpr size_t kOperations = 20'000;
+  constexpr size_t kMaxLive = 256;
+
+  pw::random::XorShiftStarRng64 rng(0x5eed);
+  std::vector<uint32_t> live;
+  std::vector<uint32_t> free_slots;
+
+  for (size_t i = 0; i < kOperations; ++i) {
+    uint32_t random;
+    rng.GetInt(random);
+
+    if (!live.empty() && (live.size() == kMaxLive || random % 2 == 0)) {
+      const size_t index = (random >> 1) % live.size();
+      operations.push_back({false, live[index], 0});
+      free_slots.push_back(live[index]);
+      live[index] = live.back();
+      live.pop_back();
+      continue;
+    }
+
+    // 60% from 8 to 64 bytes, 30% up to 256 bytes, and 10% up to 1024 bytes.
+    uint32_t size_random;
+    rng.GetInt(size_random);
+    const uint32_t bucket = size_random % 10;
+    uint32_t size;
+    if (bucket < 6) {
+      size = 8 + (size_random >> 4) % 57;
+    } else if (bucket < 9) {
+      size = 65 + (size_random >> 4) % 192;
+    } else {
+      size = 257 + (size_random >> 4) % 768;
+    }
+
+    uint32_t slot;
+    if (free_slots.empty()) {
+      slot = static_cast<uint32_t>(slots.size());
+      slots.push_back(nullptr);
+    } else {
+      slot = free_slots.back();
+      free_slots.pop_back();
+    }
+    live.push_back(slot);
+    operations.push_back({true, slot, size});
+  }
+}
+
+bool LoadOperations(const char* path) {
+  std::FILE* file = std::fopen(path, "r");
+  if (file == nullptr) {
+    PW_LOG_ERROR("Failed to open %s", path);
+    return false;
+  }
+
+  std::unordered_map<unsigned long long, uint32_t> live;
+  std::vector<uint32_t> free_slots;
+  char line[128];
+  size_t line_number = 0;
+
+  while (std::fgets(line, sizeof(line), file) != nullptr) {
+    line_number += 1;
+    char type;
+    unsigned long long id;
+    unsigned long size = 0;
+    const int fields = std::sscanf(line, " %c %lli %lu", &type, &id, &size);
+    if (fields <= 0 || type == '#') {
+      continue;
+    }
+
+    if (type == 'a' && fields == 3) {
+      uint32_t slot;
+      if (free_slots.empty()) {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.push_back(nullptr);
+      } else {
+        slot = free_slots.back();
+        free_slots.pop_back();
+      }
+      live[id] = slot;
+      operations.push_back({true, slot, static_cast<uint32_t>(size)});
+    } else if (type == 'f' && fields >= 2) {
+      auto allocation = live.find(id);
+      if (allocation == live.end()) {
+        PW_LOG_WARN("Line %u frees unknown id; skipping",
+                    static_cast<unsigned>(line_number));
+        continue;
+      }
+      operations.push_back({false, allocation->second, 0});
+      free_slots.push_back(allocation->second);
+      live.erase(allocation);
+    } else {
+      PW_LOG_WARN("Line %u is not a valid operation; skipping",
+                  static_cast<unsigned>(line_number));
+    }
+  }
+
+  std::fclose(file);
+  return true;
+}
+
+struct ReplayResult {
+  SystemClock::duration elapsed;
+  size_t failures;
+  size_t peak_requested_bytes;
+  size_t peak_footprint_bytes;  // Highest heap offset used.
+};
+
+// Replays every operation against the allocator, then frees whatever is left.
+// sample(i) is called before operation i at kFragmentationSamples evenly
+// spaced points.
+template <typename Sample>
+ReplayResult Replay(Allocator& allocator, Sample&& sample) {
+  std::vector<uint32_t> sizes(slots.size());
+  std::fill(slots.begin(), slots.end(), nullptr);
+
+  ReplayResult result{};
+  size_t requested_bytes = 0;
+  const size_t sample_interval =
+      std::max<size_t>(1, operations.size() / kFragmentationSamples);
+
+  const SystemClock::time_point start = SystemClock::now();
+  for (size_t i = 0; i < operations.size(); ++i) {
+    if (i % sample_interval == 0u) {
+      sample(i);
+    }
+
+    const Operation& operation = operations[i];
+    if (!operation.allocate) {
+      allocator.Deallocate(slots[operation.slot]);
+      requested_bytes -= sizes[operation.slot];
+      slots[operation.slot] = nullptr;
+      sizes[operation.slot] = 0;
+      continue;
+    }
+
+    void* ptr = allocator.Allocate(operation.size, alignof(Block));
+    slots[operation.slot] = ptr;
+    if (ptr == nullptr) {
+      result.failures += 1;
+      continue;
+    }
+
+    sizes[operation.slot] = operation.size;
+    requested_bytes += operation.size;
+    result.peak_requested_bytes =
+        std::max(result.peak_requested_bytes, requested_bytes);
+
+    const std::byte* end = static_cast<std::byte*>(ptr) + operation.size;
+    if (end > heap_region.data() && end <= heap_region.end()) {
+      result.peak_footprint_bytes =
+          std::max(result.peak_footprint_bytes,
+                   static_cast<size_t>(end - heap_region.data()));
+    }
+  }
+  result.elapsed = SystemClock::now() - start;
+
+  for (void* ptr : slots) {
+    allocator.Deallocate(ptr);
+  }
+  return result;
+}
+
+void LogResult(const char* name, const ReplayResult& result) {
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(result.elapsed)
+          .count();
+  PW_LOG_INFO("%s: %u ops, %u ns/op, %u failed allocations",
+              name,
+              static_cast<unsigned>(operations.size()),
+              static_cast<unsigned>(elapsed_ns / operations.size()),
+              static_cast<unsigned>(result.failures));
+  PW_LOG_INFO("  peak requested %u B",
+              static_cast<unsigned>(result.peak_requested_bytes));
+
+  // The system allocator does not use the heap region.
+  if (result.peak_footprint_bytes != 0u) {
+    PW_LOG_INFO("  peak footprint %u B",
+                static_cast<unsigned>(result.peak_footprint_bytes));
+  }
+}
+
+// Returns the object that records heap metrics for a heap.
+template <typename Heap>
+Heap& MetricsHeap(Heap& heap) {
+  return heap;
+}
+
+template <size_t kNumSlabs>
+FreeListHeap& MetricsHeap(SlabHeapBuffer<kNumSlabs>& heap) {
+  return heap.heap();
+}
+
+// Replays the operations twice with a new heap each time: once to time them,
+// and once with HeapMetrics attached to sample fragmentation. make_heap must
+// return the heap by value; heaps can't be moved, so this relies on copy
+// elision.
+template <typename MakeHeap>
+void BenchmarkHeap(const char* name, MakeHeap&& make_heap) {
+  {
+    auto heap = make_heap();
+    HeapAllocator allocator(heap);
+    LogResult(name, Replay(allocator, [](size_t) {}));
+  }
+
+  auto heap = make_heap();
+  HeapMetrics metrics;
+  auto& metrics_heap = MetricsHeap(heap);
+  metrics_heap.set_metrics(&metrics);
+
+  HeapAllocator allocator(heap);
+  Replay(allocator, [&](size_t operation) {
+    metrics_heap.UpdateFreeBlockMetrics();
+    PW_LOG_INFO(
+        "  op %6u: %6u B in use, largest free %6u B, fragmentation %.2f",
+        static_cast<unsigned>(operation),
+        static_cast<unsigned>(metrics.bytes_in_use()),
+        static_cast<unsigned>(metrics.largest_free_block()),
+        metrics.fragmentation());
+  });
+  // For SlabHeap, this only covers allocations that did not fit in a slab.
+  PW_LOG_INFO("  peak bytes in use %u B",
+              static_cast<unsigned>(metrics.peak_bytes_in_use()));
+}
+
+// A FreeListHeap that owns a freelist with caller-provided buckets.
+class CustomBucketHeap {
+ public:
+  CustomBucketHeap(const std::array<size_t, kMaxBuckets>& buckets)
+      : freelist_(buckets), heap_(heap_region, freelist_) {}
+
+  void* Allocate(size_t size) { return heap_.Allocate(size); }
+  void Free(void* ptr) { heap_.Free(ptr); }
+
+  void set_metrics(HeapMetrics* metrics) { heap_.set_metrics(metrics); }
+  void UpdateFreeBlockMetrics() { heap_.UpdateFreeBlockMetrics(); }
+
+ private:
+  FreeListBuffer<kMaxBuckets> freelist_;
+  FreeListHeap heap_;
+};
+
+// Parses a comma-separated list of increasing bucket sizes. Unused buckets
+// repeat the last size, which leaves them empty.
+bool ParseBuckets(const char* list, std::array<size_t, kMaxBuckets>& buckets) {
+  size_t count = 0;
+  while (*list != '\0') {
+    char* end;
+    const unsigned long size = std::strtoul(list, &end, 10);
+    if (end == list || count == buckets.size() ||
+        (count > 0 && size <= buckets[count - 1])) {
+      return false;
+    }
+    buckets[count++] = size;
+    list = *end == ',' ? end + 1 : end;
+  }
+  if (count == 0) {
+    return false;
+  }
+  std::fill(buckets.begin() + count, buckets.end(), buckets[count - 1]);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const char* trace = nullptr;
+  const char* bucket_list = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], "--buckets=", 10) == 0) {
+      bucket_list = argv[i] + 10;
+    } else {
+      trace = argv[i];
+    }
+  }
+
+  std::array<size_t, kMaxBuckets> buckets;
+  if (bucket_list != nullptr && !ParseBuckets(bucket_list, buckets)) {
+    PW_LOG_ERROR("--buckets takes up to %u increasing sizes, such as 16,32,64",
+                 static_cast<unsigned>(kMaxBuckets));
+    return 1;
+  }
+
+  if (trace == nullptr) {
+    GenerateOperations();
+  } else if (!LoadOperations(trace)) {
+    return 1;
+  }
+  if (operations.empty()) {
+    PW_LOG_ERROR("There are no operations to replay");
+    return 1;
+  }
+
+  {
+    SystemAllocator allocator;
+    LogResult("System allocator", Replay(allocator, [](size_t) {}));
+  }
+
+  BenchmarkHeap("FreeListHeap, default buckets",
+                [] { return FreeListHeapBuffer<>(heap_region); });
+  if (bucket_list != nullptr) {
+    BenchmarkHeap("FreeListHeap, custom buckets",
+                  [&] { return CustomBucketHeap(buckets); });
+  }
+  BenchmarkHeap("TlsfHeap",
+                [] { return TlsfHeapBuffer<kHeapSizeBytes>(heap_region); });
+  BenchmarkHeap("SlabHeap", [] {
+    return SlabHeapBuffer<kSlabs.size()>(heap_region, kSlabs);
+  });
+  return 0;
+}
@@ -0,0 +1,222 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/compact_block.h"
+
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+
+using std::byte;
+
+namespace pw::allocator {
+namespace {
+
+using Block16 = CompactBlock<uint16_t, 16>;
+
+constexpr size_t kAlign = 16;
+
+bool IsAligned(const void* ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % kAlign == 0;
+}
+
+TEST(CompactBlock, HeaderIsSmall) {
+  EXPECT_EQ(sizeof(Block16), 4u);
+  EXPECT_EQ(Block16::kHeaderSize, 4u);
+  EXPECT_EQ(sizeof(CompactBlock<uint32_t, 16>), 8u);
+  EXPECT_EQ(Block16::kMaxRegionSize, 16383u * 16u);
+}
+
+TEST(CompactBlock, CanCreateSingleBlock) {
+  alignas(kAlign) byte bytes[256];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+
+  // The first unit is trimmed so the usable space is aligned.
+  EXPECT_TRUE(IsAligned(block->UsableSpace()));
+  EXPECT_EQ(block->OuterSize(), 240u);
+  EXPECT_EQ(block->InnerSize(), 236u);
+  EXPECT_EQ(block->Prev(), nullptr);
+  EXPECT_FALSE(block->Used());
+  EXPECT_TRUE(block->Last());
+  EXPECT_TRUE(block->IsValid());
+  EXPECT_EQ(Block16::FromUsableSpace(block->UsableSpace()), block);
+}
+
+TEST(CompactBlock, UnalignedRegionIsTrimmed) {
+  alignas(kAlign) byte bytes[256];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(std::span(bytes + 1, 200), &block), OkStatus());
+  EXPECT_TRUE(IsAligned(block->UsableSpace()));
+  EXPECT_GE(reinterpret_cast<byte*>(block), bytes + 1);
+  EXPECT_LE(reinterpret_cast<byte*>(block->Next()), bytes + 201);
+}
+
+TEST(CompactBlock, CannotCreateTooSmallOrTooLargeBlock) {
+  alignas(kAlign) byte bytes[kAlign];
+  Block16* block = nullptr;
+  EXPECT_EQ(Block16::Init(bytes, &block), Status::InvalidArgument());
+
+  // A region larger than the offsets can describe is rejected.
+  using TinyBlock = CompactBlock<uint8_t, 4>;
+  alignas(4) byte tiny_region[512];
+  TinyBlock* tiny_block = nullptr;
+  EXPECT_EQ(TinyBlock::Init(tiny_region, &tiny_block),
+            Status::InvalidArgument());
+  EXPECT_EQ(TinyBlock::Init(std::span(tiny_region, 64), &tiny_block),
+            OkStatus());
+}
+
+TEST(CompactBlock, CanSplitBlock) {
+  alignas(kAlign) byte bytes[1024];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+  const size_t outer_size = block->OuterSize();
+
+  Block16* next_block = nullptr;
+  ASSERT_EQ(block->Split(20, &next_block), OkStatus());
+
+  // 20 usable bytes and the header round up to two units.
+  EXPECT_EQ(block->OuterSize(), 32u);
+  EXPECT_EQ(block->InnerSize(), 28u);
+  EXPECT_FALSE(block->Last());
+  EXPECT_EQ(block->Next(), next_block);
+
+  EXPECT_EQ(next_block->OuterSize(), outer_size - 32);
+  EXPECT_TRUE(next_block->Last());
+  EXPECT_EQ(next_block->Prev(), block);
+  EXPECT_TRUE(IsAligned(next_block->UsableSpace()));
+
+  EXPECT_TRUE(block->IsValid());
+  EXPECT_TRUE(next_block->IsValid());
+}
+
+TEST(CompactBlock, SplitInTheMiddleUpdatesNextBlock) {
+  alignas(kAlign) byte bytes[1024];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+
+  Block16* third = nullptr;
+  ASSERT_EQ(block->Split(500, &third), OkStatus());
+  Block16* second = nullptr;
+  ASSERT_EQ(block->Split(100, &second), OkStatus());
+
+  EXPECT_EQ(block->Next(), second);
+  EXPECT_EQ(second->Next(), third);
+  EXPECT_EQ(third->Prev(), second);
+  EXPECT_EQ(second->Prev(), block);
+  EXPECT_TRUE(block->IsValid());
+  EXPECT_TRUE(second->IsValid());
+  EXPECT_TRUE(third->IsValid());
+}
+
+TEST(CompactBlock, CannotSplitUsedOrTooSmallBlock) {
+  alignas(kAlign) byte bytes[64];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+  Block16* next_block = nullptr;
+
+  EXPECT_EQ(block->Split(block->InnerSize() + 1, &next_block),
+            Status::OutOfRange());
+  EXPECT_EQ(block->Split(block->InnerSize() - 8, &next_block),
+            Status::ResourceExhausted());
+  EXPECT_EQ(block->Split(8, nullptr), Status::InvalidArgument());
+
+  block->MarkUsed();
+  EXPECT_EQ(block->Split(8, &next_block), Status::FailedPrecondition());
+}
+
+TEST(CompactBlock, CanMarkBlockUsedAndLast) {
+  alignas(kAlign) byte bytes[256];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+  const size_t outer_size = block->OuterSize();
+
+  block->MarkUsed();
+  EXPECT_TRUE(block->Used());
+  EXPECT_EQ(block->OuterSize(), outer_size);
+  block->MarkFree();
+  EXPECT_FALSE(block->Used());
+
+  block->ClearLast();
+  EXPECT_FALSE(block->Last());
+  block->MarkLast();
+  EXPECT_TRUE(block->Last());
+  EXPECT_EQ(block->OuterSize(), outer_size);
+}
+
+TEST(CompactBlock, CanMergeWithNextAndPrevBlocks) {
+  alignas(kAlign) byte bytes[1024];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+  const size_t outer_size = block->OuterSize();
+
+  Block16* third = nullptr;
+  ASSERT_EQ(block->Split(500, &third), OkStatus());
+  Block16* second = nullptr;
+  ASSERT_EQ(block->Split(100, &second), OkStatus());
+
+  ASSERT_EQ(second->MergeNext(), OkStatus());
+  EXPECT_TRUE(second->Last());
+  EXPECT_EQ(block->Next(), second);
+  EXPECT_TRUE(second->IsValid());
+
+  ASSERT_EQ(second->MergePrev(), OkStatus());
+  EXPECT_EQ(block->OuterSize(), outer_size);
+  EXPECT_TRUE(block->Last());
+  EXPECT_TRUE(block->IsValid());
+
+  EXPECT_EQ(block->MergeNext(), Status::OutOfRange());
+  EXPECT_EQ(block->MergePrev(), Status::OutOfRange());
+}
+
+TEST(CompactBlock, CannotMergeUsedBlocks) {
+  alignas(kAlign) byte bytes[256];
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+  Block16* next_block = nullptr;
+  ASSERT_EQ(block->Split(64, &next_block), OkStatus());
+
+  next_block->MarkUsed();
+  EXPECT_EQ(block->MergeNext(), Status::FailedPrecondition());
+  EXPECT_EQ(next_block->MergePrev(), Status::FailedPrecondition());
+}
+
+TEST(CompactBlock, DetectsCorruptedHeaders) {
+  alignas(kAlign) byte bytes[512] = {};
+
+  Block16* block = nullptr;
+  ASSERT_EQ(Block16::Init(bytes, &block), OkStatus());
+  Block16* next_block = nullptr;
+  ASSERT_EQ(block->Split(64, &next_block), OkStatus());
+
+  // Overwrite the next block's prev offset, as an overflow of the first
+  // block's usable space would.
+  uint16_t bad_offset = 1;
+  std::memcpy(reinterpret_cast<byte*>(next_block) + 2, &bad_offset, 2);
+  EXPECT_FALSE(block->IsValid());
+  EXPECT_FALSE(next_block->IsValid());
+}
+
+}  // namespace
+}  // namespace pw::allocator
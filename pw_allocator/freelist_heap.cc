@@ -14,6 +14,7 @@
 
 #include "pw_allocator/freelist_heap.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "pw_assert/check.h"
@@ -21,25 +22,30 @@
 
 namespace pw::allocator {
 
-FreeListHeap::FreeListHeap(std::span<std::byte> region, FreeList& freelist)
-    : freelist_(freelist), heap_stats_() {
+template <typename FreeListType>
+BasicFreeListHeap<FreeListType>::BasicFreeListHeap(
+    std::span<std::byte> region, FreeListType& freelist)
+    : freelist_(freelist), heap_stats_(), metrics_(nullptr) {
   Block* block;
   PW_CHECK_OK(
       Block::Init(region, &block),
       "Failed to initialize FreeListHeap region; misaligned or too small");
 
-  freelist_.AddChunk(BlockToSpan(block));
+  PW_CHECK_OK(freelist_.AddChunk(BlockToSpan(block)),
+              "Failed to add the FreeListHeap region to its freelist");
 
   region_ = region;
   heap_stats_.total_bytes = region.size();
 }
 
-void* FreeListHeap::Allocate(size_t size) {
+template <typename FreeListType>
+void* BasicFreeListHeap<FreeListType>::Allocate(size_t size) {
   // Find a chunk in the freelist. Split it if needed, then return
 
   auto chunk = freelist_.FindChunk(size);
 
   if (chunk.data() == nullptr) {
+    RecordFailure();
     return nullptr;
   }
   freelist_.RemoveChunk(chunk);
@@ -48,6 +54,52 @@ void* FreeListHeap::Allocate(size_t size) {
 
   chunk_block->CrashIfInvalid();
 
+  return AllocateBlock(chunk_block, size);
+}
+
+template <typename FreeListType>
+void* BasicFreeListHeap<FreeListType>::AllocateAligned(size_t size,
+                                                       size_t alignment) {
+  if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+    return nullptr;
+  }
+  if (alignment <= alignof(Block)) {
+    return Allocate(size);
+  }
+
+  // Find a chunk with room for a pad block in front of the aligned space.
+  auto chunk = freelist_.FindChunk(size + alignment + kBlockOverhead);
+
+  if (chunk.data() == nullptr) {
+    RecordFailure();
+    return nullptr;
+  }
+  freelist_.RemoveChunk(chunk);
+
+  Block* chunk_block = Block::FromUsableSpace(chunk.data());
+
+  chunk_block->CrashIfInvalid();
+
+  const uintptr_t usable_space = reinterpret_cast<uintptr_t>(chunk.data());
+  if ((usable_space & (alignment - 1)) != 0) {
+    // Split off a pad block so that the usable space of the block after it is
+    // aligned. A pad that is too small for the freelist is not added to it,
+    // but it is still merged back when the aligned block is freed.
+    const uintptr_t aligned_space =
+        (usable_space + kBlockOverhead + alignment - 1) & ~(alignment - 1);
+    Block* aligned_block;
+    PW_CHECK_OK(chunk_block->Split(
+        aligned_space - usable_space - kBlockOverhead, &aligned_block));
+    freelist_.AddChunk(BlockToSpan(chunk_block));
+    chunk_block = aligned_block;
+  }
+
+  return AllocateBlock(chunk_block, size);
+}
+
+template <typename FreeListType>
+void* BasicFreeListHeap<FreeListType>::AllocateBlock(Block* chunk_block,
+                                                     size_t size) {
   // Split that chunk. If there's a leftover chunk, add it to the freelist
   Block* leftover;
   auto status = chunk_block->Split(size, &leftover);
@@ -60,11 +112,15 @@ void* FreeListHeap::Allocate(size_t size) {
   heap_stats_.bytes_allocated += size;
   heap_stats_.cumulative_allocated += size;
   heap_stats_.total_allocate_calls += 1;
+  if (metrics_ != nullptr) {
+    metrics_->RecordAllocation(chunk_block->InnerSize());
+  }
 
   return chunk_block->UsableSpace();
 }
 
-void FreeListHeap::Free(void* ptr) {
+template <typename FreeListType>
+void BasicFreeListHeap<FreeListType>::Free(void* ptr) {
   std::byte* bytes = static_cast<std::byte*>(ptr);
 
   if (bytes < region_.data() || bytes >= region_.data() + region_.size()) {
@@ -109,11 +165,15 @@ void FreeListHeap::Free(void* ptr) {
   heap_stats_.bytes_allocated -= size_freed;
   heap_stats_.cumulative_freed += size_freed;
   heap_stats_.total_free_calls += 1;
+  if (metrics_ != nullptr) {
+    metrics_->RecordFree(size_freed);
+  }
 }
 
 // Follows constract of the C standard realloc() function
 // If ptr is free'd, will return nullptr.
-void* FreeListHeap::Realloc(void* ptr, size_t size) {
+template <typename FreeListType>
+void* BasicFreeListHeap<FreeListType>::Realloc(void* ptr, size_t size) {
   if (size == 0) {
     Free(ptr);
     return nullptr;
@@ -137,10 +197,8 @@ void* FreeListHeap::Realloc(void* ptr, size_t size) {
   }
   size_t old_size = chunk_block->InnerSize();
 
-  // Do nothing and return ptr if the required memory size is smaller than
-  // the current size.
-  // TODO: Currently do not support shrink of memory chunk.
-  if (old_size >= size) {
+  // Shrink the block, or grow it into the next block if that is free.
+  if (ResizeInPlace(chunk_block, size)) {
     return ptr;
   }
 
@@ -155,7 +213,52 @@ void* FreeListHeap::Realloc(void* ptr, size_t size) {
   return new_ptr;
 }
 
-void* FreeListHeap::Calloc(size_t num, size_t size) {
+template <typename FreeListType>
+bool BasicFreeListHeap<FreeListType>::ResizeInPlace(Block* chunk_block,
+                                                    size_t size) {
+  const size_t old_size = chunk_block->InnerSize();
+  Block* next = nullptr;
+  if (!chunk_block->Last() && !chunk_block->Next()->Used()) {
+    next = chunk_block->Next();
+  }
+
+  if (old_size < size &&
+      (next == nullptr || old_size + next->OuterSize() < size)) {
+    return false;
+  }
+
+  // Blocks are only split and merged while they are free.
+  chunk_block->MarkFree();
+  if (next != nullptr) {
+    freelist_.RemoveChunk(BlockToSpan(next));
+    chunk_block->MergeNext();
+  }
+
+  Block* leftover;
+  auto status = chunk_block->Split(size, &leftover);
+  if (status == PW_STATUS_OK) {
+    freelist_.AddChunk(BlockToSpan(leftover));
+  }
+
+  chunk_block->MarkUsed();
+
+  // Count the resize like the allocation and free it replaces.
+  const size_t new_size = chunk_block->InnerSize();
+  heap_stats_.bytes_allocated += new_size;
+  heap_stats_.bytes_allocated -= old_size;
+  heap_stats_.cumulative_allocated += new_size;
+  heap_stats_.cumulative_freed += old_size;
+  heap_stats_.total_allocate_calls += 1;
+  heap_stats_.total_free_calls += 1;
+  if (metrics_ != nullptr) {
+    metrics_->RecordFree(old_size);
+    metrics_->RecordAllocation(new_size);
+  }
+  return true;
+}
+
+template <typename FreeListType>
+void* BasicFreeListHeap<FreeListType>::Calloc(size_t num, size_t size) {
   void* ptr = Allocate(num * size);
   if (ptr != nullptr) {
     memset(ptr, 0, num * size);
@@ -163,7 +266,8 @@ void* FreeListHeap::Calloc(size_t num, size_t size) {
   return ptr;
 }
 
-void FreeListHeap::LogHeapStats() {
+template <typename FreeListType>
+void BasicFreeListHeap<FreeListType>::LogHeapStats() {
   PW_LOG_INFO(" ");
   PW_LOG_INFO("    The current heap information: ");
   PW_LOG_INFO("          The total heap size is %u bytes.",
@@ -184,10 +288,64 @@ void FreeListHeap::LogHeapStats() {
   PW_LOG_INFO(" ");
 }
 
+template <typename FreeListType>
+void BasicFreeListHeap<FreeListType>::set_metrics(HeapMetrics* metrics) {
+  metrics_ = metrics;
+  if (metrics_ == nullptr) {
+    return;
+  }
+
+  size_t bytes_in_use = 0;
+  for (Block* block = reinterpret_cast<Block*>(region_.data());;
+       block = block->Next()) {
+    if (block->Used()) {
+      bytes_in_use += block->InnerSize();
+    }
+    if (block->Last()) {
+      break;
+    }
+  }
+  metrics_->SetBytesInUse(bytes_in_use);
+  UpdateFreeBlockMetrics();
+}
+
+template <typename FreeListType>
+void BasicFreeListHeap<FreeListType>::RecordFailure() {
+  if (metrics_ != nullptr) {
+    metrics_->RecordFailure();
+    UpdateFreeBlockMetrics();
+  }
+}
+
+template <typename FreeListType>
+void BasicFreeListHeap<FreeListType>::UpdateFreeBlockMetrics() {
+  if (metrics_ == nullptr) {
+    return;
+  }
+
+  size_t free_bytes = 0;
+  size_t largest_free_block = 0;
+  for (Block* block = reinterpret_cast<Block*>(region_.data());;
+       block = block->Next()) {
+    if (!block->Used()) {
+      free_bytes += block->InnerSize();
+      largest_free_block = std::max(largest_free_block, block->InnerSize());
+    }
+    if (block->Last()) {
+      break;
+    }
+  }
+  metrics_->RecordFreeBlocks(free_bytes, largest_free_block);
+}
+
 // TODO: Add stack tracing to locate which call to the heap operation caused
 // the corruption.
-void FreeListHeap::InvalidFreeCrash() {
+template <typename FreeListType>
+void BasicFreeListHeap<FreeListType>::InvalidFreeCrash() {
   PW_DCHECK(false, "You tried to free an invalid pointer!");
 }
 
+template class BasicFreeListHeap<FreeList>;
+template class BasicFreeListHeap<TlsfFreeList>;
+
 }  // namespace pw::allocator
@@ -14,6 +14,8 @@
 
 #include "pw_allocator/freelist_heap.h"
 
+#include <cstdint>
+#include <cstring>
 #include <span>
 
 #include "gtest/gtest.h"
@@ -207,7 +209,7 @@ TEST(FreeListHeap, ReallocSmallerSize) {
   void* ptr1 = allocator.Allocate(kAllocSize);
   void* ptr2 = allocator.Realloc(ptr1, kNewAllocSize);
 
-  // For smaller sizes, Realloc will not shrink the block.
+  // For smaller sizes, Realloc shrinks the block in place.
   EXPECT_EQ(ptr1, ptr2);
 }
 
@@ -227,6 +229,115 @@ TEST(FreeListHeap, ReallocTooLarge) {
   EXPECT_EQ(nullptr, ptr2);
 }
 
+TEST(FreeListHeap, ReallocGrowsIntoFreeNextBlock) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 256;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  void* ptr1 = allocator.Allocate(kAllocSize);
+  void* ptr2 = allocator.Allocate(kAllocSize);
+  ASSERT_NE(ptr2, nullptr);
+  allocator.Free(ptr2);
+
+  std::memset(ptr1, 0x5a, kAllocSize);
+  EXPECT_EQ(allocator.Realloc(ptr1, 3 * kAllocSize), ptr1);
+  for (size_t i = 0; i < kAllocSize; ++i) {
+    EXPECT_EQ(static_cast<std::byte*>(ptr1)[i], std::byte(0x5a));
+  }
+
+  // The rest of the merged block was returned to the heap.
+  EXPECT_NE(allocator.Allocate(kAllocSize), nullptr);
+}
+
+TEST(FreeListHeap, ReallocMovesWhenNextBlockIsUsed) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 256;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  void* ptr1 = allocator.Allocate(kAllocSize);
+  void* ptr2 = allocator.Allocate(kAllocSize);
+  ASSERT_NE(ptr2, nullptr);
+
+  void* ptr3 = allocator.Realloc(ptr1, 2 * kAllocSize);
+  ASSERT_NE(ptr3, nullptr);
+  EXPECT_NE(ptr3, ptr1);
+}
+
+TEST(FreeListHeap, ReallocShrinkReturnsSpaceToHeap) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 1024;
+  constexpr size_t kNewAllocSize = 256;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  void* ptr1 = allocator.Allocate(kAllocSize);
+  void* ptr2 = allocator.Allocate(kNewAllocSize);
+  ASSERT_NE(ptr2, nullptr);
+
+  EXPECT_EQ(allocator.Realloc(ptr1, kNewAllocSize), ptr1);
+
+  // The space at the end of the shrunk block can be allocated again.
+  void* ptr3 = allocator.Allocate(kNewAllocSize);
+  ASSERT_NE(ptr3, nullptr);
+  EXPECT_GT(ptr3, ptr1);
+  EXPECT_LT(ptr3, ptr2);
+}
+
+TEST(FreeListHeap, AllocateAlignedReturnsAlignedPointers) {
+  constexpr size_t N = 2048;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  // Misalign the next free block.
+  ASSERT_NE(allocator.Allocate(8), nullptr);
+
+  for (size_t alignment : {size_t(16), size_t(64), size_t(256)}) {
+    void* ptr = allocator.AllocateAligned(100, alignment);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) & (alignment - 1), 0u);
+  }
+}
+
+TEST(FreeListHeap, AllocateAlignedReusesPadBlock) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAlignment = 512;
+  alignas(kAlignment) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  void* aligned = allocator.AllocateAligned(64, kAlignment);
+  ASSERT_NE(aligned, nullptr);
+  EXPECT_EQ(aligned, &buf[kAlignment]);
+
+  // The pad block before the aligned block is available to allocations.
+  void* ptr = allocator.Allocate(128);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_LT(ptr, aligned);
+
+  // Freeing everything merges the pad block back.
+  allocator.Free(ptr);
+  allocator.Free(aligned);
+  EXPECT_NE(
+      allocator.Allocate(N - sizeof(Block) - 2 * PW_ALLOCATOR_POISON_OFFSET),
+      nullptr);
+}
+
+TEST(FreeListHeap, AllocateAlignedRejectsInvalidAlignment) {
+  constexpr size_t N = 2048;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+
+  EXPECT_EQ(allocator.AllocateAligned(64, 0), nullptr);
+  EXPECT_EQ(allocator.AllocateAligned(64, 48), nullptr);
+}
+
 TEST(FreeListHeap, CanCalloc) {
   constexpr size_t N = 2048;
   constexpr size_t kAllocSize = 128;
@@ -274,4 +385,150 @@ TEST(FreeListHeap, CallocTooLarge) {
 
   EXPECT_EQ(allocator.Calloc(1, kAllocSize), nullptr);
 }
+
+TEST(TlsfHeap, CanAllocate) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 512;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  TlsfHeapBuffer<N> allocator(buf);
+
+  void* ptr = allocator.Allocate(kAllocSize);
+
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(ptr, &buf[0] + sizeof(Block) + PW_ALLOCATOR_POISON_OFFSET);
+}
+
+TEST(TlsfHeap, CanFreeAndRealloc) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 512;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  TlsfHeapBuffer<N> allocator(buf);
+
+  void* ptr1 = allocator.Allocate(kAllocSize);
+  allocator.Free(ptr1);
+  void* ptr2 = allocator.Allocate(kAllocSize);
+
+  EXPECT_EQ(ptr1, ptr2);
+}
+
+TEST(TlsfHeap, FreedBlocksAreMerged) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 256;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  TlsfHeapBuffer<N> allocator(buf);
+
+  void* ptr1 = allocator.Allocate(kAllocSize);
+  void* ptr2 = allocator.Allocate(kAllocSize);
+  void* ptr3 = allocator.Allocate(kAllocSize);
+  ASSERT_NE(ptr3, nullptr);
+
+  allocator.Free(ptr1);
+  allocator.Free(ptr3);
+  allocator.Free(ptr2);
+
+  // With every block merged back together, a large allocation fits again.
+  EXPECT_EQ(allocator.Allocate(N / 2), ptr1);
+}
+
+TEST(TlsfHeap, AllocateAlignedAndGrowInPlace) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAlignment = 128;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  TlsfHeapBuffer<N> allocator(buf);
+
+  ASSERT_NE(allocator.Allocate(8), nullptr);
+  void* ptr = allocator.AllocateAligned(64, kAlignment);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) & (kAlignment - 1), 0u);
+
+  // Growing in place keeps the alignment.
+  EXPECT_EQ(allocator.Realloc(ptr, 512), ptr);
+}
+
+TEST(TlsfHeap, ReturnsNullWhenFull) {
+  constexpr size_t N = 2048;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  TlsfHeapBuffer<N> allocator(buf);
+
+  EXPECT_NE(
+      allocator.Allocate(N - sizeof(Block) - 2 * PW_ALLOCATOR_POISON_OFFSET),
+      nullptr);
+  EXPECT_EQ(allocator.Allocate(1), nullptr);
+}
+
+TEST(FreeListHeap, MetricsTrackBytesInUse) {
+  constexpr size_t N = 2048;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+  HeapMetrics metrics;
+  allocator.set_metrics(&metrics);
+  EXPECT_EQ(metrics.bytes_in_use(), 0u);
+  EXPECT_EQ(metrics.free_bytes(),
+            N - sizeof(Block) - 2 * PW_ALLOCATOR_POISON_OFFSET);
+
+  void* ptr1 = allocator.Allocate(64);
+  void* ptr2 = allocator.Allocate(512);
+  ASSERT_NE(ptr2, nullptr);
+  EXPECT_EQ(metrics.allocations(), 2u);
+  EXPECT_EQ(metrics.bytes_in_use(), 64u + 512u);
+  EXPECT_EQ(metrics.allocations_up_to_64(), 1u);
+  EXPECT_EQ(metrics.allocations_up_to_512(), 1u);
+
+  allocator.Free(ptr2);
+  EXPECT_EQ(metrics.bytes_in_use(), 64u);
+  EXPECT_EQ(metrics.peak_bytes_in_use(), 64u + 512u);
+  allocator.Free(ptr1);
+  EXPECT_EQ(metrics.bytes_in_use(), 0u);
+}
+
+TEST(FreeListHeap, MetricsStartFromCurrentState) {
+  constexpr size_t N = 2048;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+  void* ptr = allocator.Allocate(128);
+  ASSERT_NE(ptr, nullptr);
+
+  HeapMetrics metrics;
+  allocator.set_metrics(&metrics);
+  EXPECT_EQ(metrics.bytes_in_use(), 128u);
+  EXPECT_EQ(metrics.allocations(), 0u);
+
+  allocator.Free(ptr);
+  EXPECT_EQ(metrics.bytes_in_use(), 0u);
+}
+
+TEST(FreeListHeap, MetricsReportFragmentation) {
+  constexpr size_t N = 2048;
+  constexpr size_t kAllocSize = 256;
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+
+  FreeListHeapBuffer allocator(buf);
+  HeapMetrics metrics;
+  allocator.set_metrics(&metrics);
+  EXPECT_EQ(metrics.fragmentation(), 0.0f);
+
+  // Free every other block so that the free memory is split up.
+  void* ptrs[6];
+  for (void*& ptr : ptrs) {
+    ptr = allocator.Allocate(kAllocSize);
+    ASSERT_NE(ptr, nullptr);
+  }
+  allocator.Free(ptrs[0]);
+  allocator.Free(ptrs[2]);
+  allocator.Free(ptrs[4]);
+
+  EXPECT_EQ(allocator.Allocate(N / 2), nullptr);
+  EXPECT_EQ(metrics.allocation_failures(), 1u);
+  EXPECT_GE(metrics.free_bytes(), 3 * kAllocSize);
+  EXPECT_LT(metrics.largest_free_block(), N / 2);
+  EXPECT_GT(metrics.fragmentation(), 0.5f);
+}
+
 }  // namespace pw::allocator
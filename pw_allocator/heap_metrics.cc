@@ -0,0 +1,64 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/heap_metrics.h"
+
+namespace pw::allocator {
+
+void HeapMetrics::RecordAllocation(size_t size) {
+  allocations_.Increment();
+
+  if (size <= 16u) {
+    allocations_up_to_16_.Increment();
+  } else if (size <= 32u) {
+    allocations_up_to_32_.Increment();
+  } else if (size <= 64u) {
+    allocations_up_to_64_.Increment();
+  } else if (size <= 128u) {
+    allocations_up_to_128_.Increment();
+  } else if (size <= 256u) {
+    allocations_up_to_256_.Increment();
+  } else if (size <= 512u) {
+    allocations_up_to_512_.Increment();
+  } else {
+    allocations_over_512_.Increment();
+  }
+
+  SetBytesInUse(bytes_in_use_.value() + size);
+}
+
+void HeapMetrics::RecordFree(size_t size) {
+  SetBytesInUse(bytes_in_use_.value() - size);
+}
+
+void HeapMetrics::RecordFreeBlocks(size_t free_bytes,
+                                   size_t largest_free_block) {
+  free_bytes_.Set(static_cast<uint32_t>(free_bytes));
+  largest_free_block_.Set(static_cast<uint32_t>(largest_free_block));
+  if (free_bytes == 0u) {
+    fragmentation_.Set(0.0f);
+  } else {
+    fragmentation_.Set(1.0f - static_cast<float>(largest_free_block) /
+                                  static_cast<float>(free_bytes));
+  }
+}
+
+void HeapMetrics::SetBytesInUse(size_t size) {
+  bytes_in_use_.Set(static_cast<uint32_t>(size));
+  if (bytes_in_use_.value() > peak_bytes_in_use_.value()) {
+    peak_bytes_in_use_.Set(bytes_in_use_.value());
+  }
+}
+
+}  // namespace pw::allocator
@@ -0,0 +1,68 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pw::allocator {
+
+// A common interface for allocators, so that code which builds temporary
+// structures can take memory from a heap or an arena without knowing which.
+class Allocator {
+ public:
+  virtual ~Allocator() = default;
+
+  // Allocates size bytes aligned to alignment, which must be a power of two.
+  // Returns null if the allocation fails.
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    return DoAllocate(size, alignment);
+  }
+
+  // Releases memory returned by Allocate(). Deallocating null does nothing.
+  void Deallocate(void* ptr) {
+    if (ptr != nullptr) {
+      DoDeallocate(ptr);
+    }
+  }
+
+ private:
+  virtual void* DoAllocate(size_t size, size_t alignment) = 0;
+  virtual void DoDeallocate(void* ptr) = 0;
+};
+
+// An Allocator that uses a heap with Allocate(size) and Free(ptr) functions,
+// such as FreeListHeap or SlabHeap. Since these heaps only guarantee the
+// alignment of Block, allocations with larger alignments fail.
+template <typename Heap>
+class HeapAllocator final : public Allocator {
+ public:
+  constexpr HeapAllocator(Heap& heap) : heap_(heap) {}
+
+ private:
+  void* DoAllocate(size_t size, size_t alignment) override {
+    void* ptr = heap_.Allocate(size);
+    if (ptr != nullptr && reinterpret_cast<uintptr_t>(ptr) % alignment != 0u) {
+      heap_.Free(ptr);
+      return nullptr;
+    }
+    return ptr;
+  }
+
+  void DoDeallocate(void* ptr) override { heap_.Free(ptr); }
+
+  Heap& heap_;
+};
+
+}  // namespace pw::allocator
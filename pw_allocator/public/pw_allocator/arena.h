@@ -0,0 +1,116 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_allocator/allocator.h"
+#include "pw_bytes/span.h"
+
+namespace pw::allocator {
+
+// A monotonic allocator for temporary structures that are released together.
+//
+// Allocations are taken from the front of a buffer by advancing a pointer, so
+// they cost only an alignment adjustment. Deallocate() does nothing; memory is
+// reclaimed by rewinding the arena to a checkpoint, or resetting it entirely.
+//
+// If the arena is given a parent allocator, it allocates chunks of at least
+// chunk_size bytes from the parent when the buffer is exhausted. Rewinding and
+// resetting return chunks allocated after the checkpoint to the parent.
+class Arena final : public Allocator {
+ public:
+  // A position in the arena that it can be rewound to.
+  class Checkpoint {
+   private:
+    friend class Arena;
+
+    constexpr Checkpoint(void* chunk, std::byte* position)
+        : chunk_(chunk), position_(position) {}
+
+    void* chunk_;
+    std::byte* position_;
+  };
+
+  // Rewinds the arena to where it was when the scope was created, releasing
+  // everything allocated within the scope.
+  class Scope {
+   public:
+    explicit Scope(Arena& arena)
+        : arena_(arena), checkpoint_(arena.checkpoint()) {}
+
+    ~Scope() { arena_.Rewind(checkpoint_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    Arena& arena_;
+    const Checkpoint checkpoint_;
+  };
+
+  // Allocates from the buffer only.
+  constexpr Arena(ByteSpan buffer) : Arena(buffer, nullptr, 0) {}
+
+  // Allocates from the buffer, then from chunks of at least chunk_size bytes
+  // from the parent. The buffer may be empty.
+  constexpr Arena(ByteSpan buffer, Allocator* parent, size_t chunk_size)
+      : buffer_(buffer),
+        parent_(parent),
+        chunk_size_(chunk_size),
+        chunks_(nullptr),
+        position_(buffer.data()),
+        end_(buffer.data() + buffer.size()) {}
+
+  ~Arena() { Reset(); }
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  Checkpoint checkpoint() const { return Checkpoint(chunks_, position_); }
+
+  // Releases everything allocated after the checkpoint was taken. Rewinding to
+  // a checkpoint that was taken before an earlier rewind or reset is undefined.
+  void Rewind(Checkpoint checkpoint);
+
+  // Releases all allocations and returns every chunk to the parent.
+  void Reset() { Rewind(Checkpoint(nullptr, buffer_.data())); }
+
+ private:
+  // Header at the start of each chunk from the parent. Chunks are released in
+  // the reverse order of their allocation.
+  struct Chunk {
+    Chunk* previous;
+    std::byte* end;
+  };
+
+  void* DoAllocate(size_t size, size_t alignment) override;
+
+  // Individual allocations are released by Rewind() and Reset().
+  void DoDeallocate(void*) override {}
+
+  // Makes a new chunk from the parent the current region. Returns false if
+  // there is no parent or the parent is out of memory.
+  bool AddChunk(size_t size, size_t alignment);
+
+  const ByteSpan buffer_;
+  Allocator* const parent_;
+  const size_t chunk_size_;
+
+  Chunk* chunks_;  // The most recent chunk, or null if using buffer_.
+  std::byte* position_;
+  std::byte* end_;
+};
+
+}  // namespace pw::allocator
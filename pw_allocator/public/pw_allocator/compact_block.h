@@ -0,0 +1,326 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <span>
+#include <type_traits>
+
+#include "pw_assert/check.h"
+#include "pw_status/status.h"
+
+namespace pw::allocator {
+
+// CompactBlock is a variant of Block with a smaller header, for heaps that
+// make many small allocations. Instead of pointers, the header stores the
+// distances to the next and previous blocks in units of kAlignment, in
+// OffsetType integers. The "used" and "last" flags are stored in the low two
+// bits of the next offset, as with Block.
+//
+//   +-------------------------+------------+---------------------------+
+//   |  Next offset            | Prev       |   usable space            |
+//   +------------+------+-----+ offset     |                           |
+//   | Units      | Last | Used|            |                           |
+//   +------------+------+-----+------------+---------------------------+
+//   ^                                      ^
+//   block address                          aligned to kAlignment
+//
+// With the default uint16_t offsets, the header is 4 bytes, compared with 8
+// bytes for Block on 32-bit targets and 16 bytes on 64-bit hosts. The header
+// is placed just before a kAlignment boundary, so the usable space of every
+// block is aligned to kAlignment, and blocks are sized in whole units. The
+// largest region is kMaxRegionSize. With uint16_t offsets, that is just under
+// 256 KiB for the 16-byte default alignment of 64-bit hosts, or 128 KiB for
+// 8-byte alignment. Use uint32_t offsets for larger heaps.
+//
+// Splitting, merging, and walking the blocks work as for Block. Since the
+// headers are small, more of them share each cache line when a heap walks its
+// blocks. Poisoning is not supported; IsValid() checks the headers only.
+//
+// This class must be constructed using the static Init call.
+template <typename OffsetType = uint16_t,
+          size_t kAlignment = alignof(std::max_align_t)>
+class CompactBlock final {
+ public:
+  static_assert(std::is_unsigned_v<OffsetType>,
+                "CompactBlock offsets must be unsigned integers");
+  static_assert((kAlignment & (kAlignment - 1)) == 0,
+                "CompactBlock alignment must be a power of two");
+  static_assert(kAlignment % alignof(OffsetType) == 0,
+                "CompactBlock alignment must align the offsets");
+  static_assert(kAlignment >= 2 * sizeof(OffsetType),
+                "CompactBlock alignment must fit the block header");
+
+  // The size of the header before each block's usable space.
+  static constexpr size_t kHeaderSize = 2 * sizeof(OffsetType);
+
+  // The largest offset, in units of kAlignment. The two low bits of the next
+  // offset hold the flags.
+  static constexpr uintmax_t kMaxOffset =
+      uintmax_t{std::numeric_limits<OffsetType>::max()} >> 2;
+
+  // The largest region that can be managed by a chain of blocks.
+  static constexpr size_t kMaxRegionSize = static_cast<size_t>(
+      kMaxOffset > std::numeric_limits<size_t>::max() / kAlignment
+          ? std::numeric_limits<size_t>::max()
+          : kMaxOffset * kAlignment);
+
+  // No copy/move
+  CompactBlock(const CompactBlock& other) = delete;
+  CompactBlock& operator=(const CompactBlock& other) = delete;
+  CompactBlock(CompactBlock&& other) = delete;
+  CompactBlock& operator=(CompactBlock&& other) = delete;
+
+  // Create the first block for a given memory region. The start and end of
+  // the region are trimmed so that the block's usable space is aligned to
+  // kAlignment and its size is a whole number of units.
+  // Returns:
+  //   INVALID_ARGUMENT if the region is too small for a block, or larger
+  //   than kMaxRegionSize after trimming, or OK otherwise.
+  static Status Init(const std::span<std::byte> region, CompactBlock** block) {
+    const uintptr_t start =
+        AlignUp(reinterpret_cast<uintptr_t>(region.data()) + kHeaderSize) -
+        kHeaderSize;
+    const uintptr_t end =
+        AlignDown(reinterpret_cast<uintptr_t>(region.data()) + region.size() +
+                  kHeaderSize) -
+        kHeaderSize;
+    if (end <= start || end - start > kMaxRegionSize) {
+      return Status::InvalidArgument();
+    }
+
+    CompactBlock* first = new (reinterpret_cast<void*>(start)) CompactBlock();
+    first->SetNextOffset((end - start) / kAlignment);
+    first->MarkLast();
+    first->prev_ = 0;
+    *block = first;
+    return OkStatus();
+  }
+
+  // Returns a pointer to a CompactBlock, given a pointer to the start of the
+  // usable space inside the block (i.e. the opposite operation to
+  // UsableSpace()). This does not do any checking.
+  static CompactBlock* FromUsableSpace(std::byte* usable_space) {
+    return reinterpret_cast<CompactBlock*>(usable_space - kHeaderSize);
+  }
+
+  // Size including the header.
+  size_t OuterSize() const { return NextOffset() * kAlignment; }
+
+  // Usable bytes inside the block.
+  size_t InnerSize() const { return OuterSize() - kHeaderSize; }
+
+  // Return the usable space inside this block.
+  std::byte* UsableSpace() {
+    return reinterpret_cast<std::byte*>(this) + kHeaderSize;
+  }
+
+  // Split this block, such that this block has an inner size of at least
+  // `head_block_inner_size`, and return a new block in the remainder of the
+  // space in `new_block`. The head block's size is rounded up to a whole
+  // number of units.
+  //
+  // This may return the following:
+  //   OK: The split completed successfully.
+  //   INVALID_ARGUMENT: new_block is null
+  //   FAILED_PRECONDITION: This block is in use and cannot be split.
+  //   OUT_OF_RANGE: The requested size for "this" block is greater than the
+  //                 current inner_size.
+  //   RESOURCE_EXHAUSTED: The split cannot occur because no space is left
+  //                       for the "remainder" block after rounding.
+  Status Split(size_t head_block_inner_size, CompactBlock** new_block) {
+    if (new_block == nullptr) {
+      return Status::InvalidArgument();
+    }
+    if (Used()) {
+      return Status::FailedPrecondition();
+    }
+    if (head_block_inner_size > InnerSize()) {
+      return Status::OutOfRange();
+    }
+
+    const size_t head_units =
+        AlignUp(head_block_inner_size + kHeaderSize) / kAlignment;
+    if (head_units == NextOffset()) {
+      return Status::ResourceExhausted();
+    }
+    const size_t tail_units = NextOffset() - head_units;
+
+    CompactBlock* tail = new (reinterpret_cast<std::byte*>(this) +
+                              head_units * kAlignment) CompactBlock();
+    tail->next_ = next_;
+    tail->SetNextOffset(tail_units);
+    tail->prev_ = static_cast<OffsetType>(head_units);
+    if (!tail->Last()) {
+      tail->Next()->prev_ = static_cast<OffsetType>(tail_units);
+    }
+
+    SetNextOffset(head_units);
+    ClearLast();
+    *new_block = tail;
+    return OkStatus();
+  }
+
+  // Merge this block with the one that comes after it.
+  // This function will not merge blocks if either are in use.
+  //
+  // This may return the following:
+  //   OK: Merge was successful.
+  //   OUT_OF_RANGE: Attempting to merge the "last" block.
+  //   FAILED_PRECONDITION: The blocks could not be merged because one of them
+  //                        was in use.
+  Status MergeNext() {
+    if (Last()) {
+      return Status::OutOfRange();
+    }
+    CompactBlock* next = Next();
+    if (Used() || next->Used()) {
+      return Status::FailedPrecondition();
+    }
+
+    // Taking the next block's flags also copies its "last" status.
+    const size_t units = NextOffset() + next->NextOffset();
+    next_ = next->next_;
+    SetNextOffset(units);
+    if (!Last()) {
+      Next()->prev_ = static_cast<OffsetType>(units);
+    }
+    return OkStatus();
+  }
+
+  // Merge this block with the one that comes before it.
+  // This function will not merge blocks if either are in use.
+  //
+  // Warning: merging with a previous block will invalidate this block instance.
+  // do not perform any operations on this instance after merging.
+  //
+  // This may return the following:
+  //   OK: Merge was successful.
+  //   OUT_OF_RANGE: Attempting to merge the "first" block.
+  //   FAILED_PRECONDITION: The blocks could not be merged because one of them
+  //                        was in use.
+  Status MergePrev() {
+    if (prev_ == 0) {
+      return Status::OutOfRange();
+    }
+    return Prev()->MergeNext();
+  }
+
+  // Returns whether this block is in-use or not
+  bool Used() const { return (next_ & kInUseFlag) == kInUseFlag; }
+
+  // Returns whether this block is the last block or not (i.e. whether Next()
+  // points to a valid block or just to the end of this block).
+  bool Last() const { return (next_ & kLastFlag) == kLastFlag; }
+
+  void MarkUsed() { next_ |= kInUseFlag; }
+  void MarkFree() { next_ &= static_cast<OffsetType>(~kInUseFlag); }
+  void MarkLast() { next_ |= kLastFlag; }
+  void ClearLast() { next_ &= static_cast<OffsetType>(~kLastFlag); }
+
+  // Fetch the block immediately after this one.
+  // Note: you should also check Last(); this function may return a valid
+  // block, even if one does not exist.
+  CompactBlock* Next() const {
+    return reinterpret_cast<CompactBlock*>(reinterpret_cast<uintptr_t>(this) +
+                                           OuterSize());
+  }
+
+  // Return the block immediately before this one. This will return nullptr
+  // if this is the "first" block.
+  CompactBlock* Prev() const {
+    if (prev_ == 0) {
+      return nullptr;
+    }
+    return reinterpret_cast<CompactBlock*>(reinterpret_cast<uintptr_t>(this) -
+                                           size_t{prev_} * kAlignment);
+  }
+
+  // Return true if the usable space is aligned, and the offsets match with the
+  // previous and next block. Otherwise, return false to indicate this block is
+  // corrupted.
+  bool IsValid() const { return CheckStatus() == BlockStatus::VALID; }
+
+  // Uses PW_DCHECK to log information about the reason if a block is invalid.
+  // This function will do nothing if the block is valid.
+  void CrashIfInvalid() const {
+    switch (CheckStatus()) {
+      case VALID:
+        break;
+      case MISALIGNED:
+        PW_DCHECK(false, "The block at address %p is not aligned.", this);
+        break;
+      case NEXT_MISMATCHED:
+        PW_DCHECK(false,
+                  "The 'prev' offset of the next block (%p) does not match "
+                  "the size of the current block (%p).",
+                  Next(),
+                  this);
+        break;
+      case PREV_MISMATCHED:
+        PW_DCHECK(false,
+                  "The 'next' offset of the previous block (%p) does not "
+                  "match the address of the current block (%p).",
+                  Prev(),
+                  this);
+        break;
+    }
+  }
+
+ private:
+  static constexpr OffsetType kInUseFlag = 0x1;
+  static constexpr OffsetType kLastFlag = 0x2;
+  static constexpr unsigned kFlagBits = 2;
+
+  enum BlockStatus { VALID, MISALIGNED, PREV_MISMATCHED, NEXT_MISMATCHED };
+
+  CompactBlock() = default;
+
+  static constexpr uintptr_t AlignDown(uintptr_t value) {
+    return value & ~uintptr_t{kAlignment - 1};
+  }
+  static constexpr uintptr_t AlignUp(uintptr_t value) {
+    return AlignDown(value + kAlignment - 1);
+  }
+
+  size_t NextOffset() const { return next_ >> kFlagBits; }
+
+  // Sets the offset of the next block, keeping the flags.
+  void SetNextOffset(size_t units) {
+    next_ = static_cast<OffsetType>((units << kFlagBits) |
+                                    (next_ & (kInUseFlag | kLastFlag)));
+  }
+
+  BlockStatus CheckStatus() const {
+    if ((reinterpret_cast<uintptr_t>(this) + kHeaderSize) % kAlignment != 0) {
+      return BlockStatus::MISALIGNED;
+    }
+    if (NextOffset() == 0 ||
+        (!Last() && Next()->prev_ != static_cast<OffsetType>(NextOffset()))) {
+      return BlockStatus::NEXT_MISMATCHED;
+    }
+    if (prev_ != 0 && (Prev()->Last() || Prev()->Next() != this)) {
+      return BlockStatus::PREV_MISMATCHED;
+    }
+    return BlockStatus::VALID;
+  }
+
+  OffsetType next_;
+  OffsetType prev_;
+};
+
+}  // namespace pw::allocator
@@ -19,13 +19,20 @@
 
 #include "pw_allocator/block.h"
 #include "pw_allocator/freelist.h"
+#include "pw_allocator/heap_metrics.h"
+#include "pw_allocator/tlsf_freelist.h"
 
 namespace pw::allocator {
 
-class FreeListHeap {
+// A heap that tracks its free blocks in a freelist. FreeListType is FreeList
+// or TlsfFreeList; use the FreeListHeap and TlsfHeap aliases below.
+template <typename FreeListType>
+class BasicFreeListHeap {
  public:
   template <size_t kNumBuckets>
   friend class FreeListHeapBuffer;
+  template <size_t kMaxChunkSize>
+  friend class TlsfHeapBuffer;
   struct HeapStats {
     size_t total_bytes;
     size_t bytes_allocated;
@@ -34,27 +41,63 @@ class FreeListHeap {
     size_t total_allocate_calls;
     size_t total_free_calls;
   };
-  FreeListHeap(std::span<std::byte> region, FreeList& freelist);
+  BasicFreeListHeap(std::span<std::byte> region, FreeListType& freelist);
 
   void* Allocate(size_t size);
+  // Allocates size bytes whose address is a multiple of alignment, which must
+  // be a power of two. Splits a pad block off the front of a larger free block
+  // if needed, so the pad stays available to other allocations.
+  void* AllocateAligned(size_t size, size_t alignment);
   void Free(void* ptr);
+  // Resizes the block in place if it shrinks, or if the block after it is free
+  // and large enough. Otherwise, moves the contents to a new block.
   void* Realloc(void* ptr, size_t size);
   void* Calloc(size_t num, size_t size);
 
   void LogHeapStats();
 
+  // Records allocations in the given metrics, or stops recording if metrics is
+  // null. The metrics start from the heap's current state.
+  void set_metrics(HeapMetrics* metrics);
+
+  // Walks the heap's blocks to update the free block metrics. Does nothing if
+  // no metrics are set.
+  void UpdateFreeBlockMetrics();
+
  private:
+  static constexpr size_t kBlockOverhead =
+      sizeof(Block) + 2 * PW_ALLOCATOR_POISON_OFFSET;
+
   std::span<std::byte> BlockToSpan(Block* block) {
     return std::span<std::byte>(block->UsableSpace(), block->InnerSize());
   }
 
+  // Splits size bytes off a block that was removed from the freelist, and
+  // marks it used.
+  void* AllocateBlock(Block* chunk_block, size_t size);
+
+  // Returns false if the block can't be resized without moving it.
+  bool ResizeInPlace(Block* chunk_block, size_t size);
+
+  void RecordFailure();
+
   void InvalidFreeCrash();
 
   std::span<std::byte> region_;
-  FreeList& freelist_;
+  FreeListType& freelist_;
   HeapStats heap_stats_;
+  HeapMetrics* metrics_;
 };
 
+// The bucketed freelist searches its buckets linearly, and may walk the chunks
+// in a bucket. TlsfHeap finds and removes chunks in constant time instead; see
+// TlsfFreeList.
+using FreeListHeap = BasicFreeListHeap<FreeList>;
+using TlsfHeap = BasicFreeListHeap<TlsfFreeList>;
+
+extern template class BasicFreeListHeap<FreeList>;
+extern template class BasicFreeListHeap<TlsfFreeList>;
+
 template <size_t kNumBuckets = 6>
 class FreeListHeapBuffer {
  public:
@@ -65,6 +108,9 @@ class FreeListHeapBuffer {
       : freelist_(defaultBuckets), heap_(region, freelist_) {}
 
   void* Allocate(size_t size) { return heap_.Allocate(size); }
+  void* AllocateAligned(size_t size, size_t alignment) {
+    return heap_.AllocateAligned(size, alignment);
+  }
   void Free(void* ptr) { heap_.Free(ptr); }
   void* Realloc(void* ptr, size_t size) { return heap_.Realloc(ptr, size); }
   void* Calloc(size_t num, size_t size) { return heap_.Calloc(num, size); }
@@ -75,9 +121,39 @@ class FreeListHeapBuffer {
 
   void LogHeapStats() { heap_.LogHeapStats(); }
 
+  void set_metrics(HeapMetrics* metrics) { heap_.set_metrics(metrics); }
+  void UpdateFreeBlockMetrics() { heap_.UpdateFreeBlockMetrics(); }
+
  private:
   FreeListBuffer<kNumBuckets> freelist_;
   FreeListHeap heap_;
 };
 
+// A TlsfHeap that holds its own freelist storage. The region may be at most
+// kMaxChunkSize bytes.
+template <size_t kMaxChunkSize>
+class TlsfHeapBuffer {
+ public:
+  TlsfHeapBuffer(std::span<std::byte> region) : heap_(region, freelist_) {}
+
+  void* Allocate(size_t size) { return heap_.Allocate(size); }
+  void* AllocateAligned(size_t size, size_t alignment) {
+    return heap_.AllocateAligned(size, alignment);
+  }
+  void Free(void* ptr) { heap_.Free(ptr); }
+  void* Realloc(void* ptr, size_t size) { return heap_.Realloc(ptr, size); }
+  void* Calloc(size_t num, size_t size) { return heap_.Calloc(num, size); }
+
+  const TlsfHeap::HeapStats& heap_stats() const { return heap_.heap_stats_; }
+
+  void LogHeapStats() { heap_.LogHeapStats(); }
+
+  void set_metrics(HeapMetrics* metrics) { heap_.set_metrics(metrics); }
+  void UpdateFreeBlockMetrics() { heap_.UpdateFreeBlockMetrics(); }
+
+ private:
+  TlsfFreeListBuffer<kMaxChunkSize> freelist_;
+  TlsfHeap heap_;
+};
+
 }  // namespace pw::allocator
@@ -0,0 +1,111 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_metric/metric.h"
+
+namespace pw::allocator {
+
+template <typename FreeListType>
+class BasicFreeListHeap;
+
+// pw_metric metrics for a FreeListHeap. Register them with the heap's
+// set_metrics(); heaps without metrics don't pay for them. Like pw_metric,
+// HeapMetrics is not synchronized, so it must be protected by the same lock as
+// the heap.
+//
+// Sizes are the inner sizes of blocks, which may be larger than the requested
+// allocation sizes.
+class HeapMetrics {
+ public:
+  HeapMetrics() = default;
+
+  HeapMetrics(const HeapMetrics&) = delete;
+  HeapMetrics& operator=(const HeapMetrics&) = delete;
+
+  uint32_t bytes_in_use() const { return bytes_in_use_.value(); }
+  uint32_t peak_bytes_in_use() const { return peak_bytes_in_use_.value(); }
+
+  uint32_t allocations() const { return allocations_.value(); }
+  uint32_t allocation_failures() const {
+    return allocation_failures_.value();
+  }
+
+  // Free block metrics are computed by walking the heap's blocks, which is
+  // done when an allocation fails and when the heap's UpdateFreeBlockMetrics()
+  // is called.
+  uint32_t free_bytes() const { return free_bytes_.value(); }
+  uint32_t largest_free_block() const { return largest_free_block_.value(); }
+
+  // The fraction of free memory that is not in the largest free block, from 0
+  // (all free memory is in one block) to nearly 1 (badly fragmented).
+  float fragmentation() const { return fragmentation_.value(); }
+
+  // Allocation size histogram buckets. The bounds match the buckets of
+  // FreeListHeapBuffer's default freelist.
+  uint32_t allocations_up_to_16() const {
+    return allocations_up_to_16_.value();
+  }
+  uint32_t allocations_up_to_32() const {
+    return allocations_up_to_32_.value();
+  }
+  uint32_t allocations_up_to_64() const {
+    return allocations_up_to_64_.value();
+  }
+  uint32_t allocations_up_to_128() const {
+    return allocations_up_to_128_.value();
+  }
+  uint32_t allocations_up_to_256() const {
+    return allocations_up_to_256_.value();
+  }
+  uint32_t allocations_up_to_512() const {
+    return allocations_up_to_512_.value();
+  }
+  uint32_t allocations_over_512() const {
+    return allocations_over_512_.value();
+  }
+
+  metric::Group& metrics() { return metrics_; }
+
+ private:
+  template <typename FreeListType>
+  friend class BasicFreeListHeap;
+
+  void RecordAllocation(size_t size);
+  void RecordFailure() { allocation_failures_.Increment(); }
+  void RecordFree(size_t size);
+  void RecordFreeBlocks(size_t free_bytes, size_t largest_free_block);
+  void SetBytesInUse(size_t size);
+
+  PW_METRIC_GROUP(metrics_, "heap");
+  PW_METRIC(metrics_, bytes_in_use_, "bytes_in_use", 0u);
+  PW_METRIC(metrics_, peak_bytes_in_use_, "peak_bytes_in_use", 0u);
+  PW_METRIC(metrics_, allocations_, "allocations", 0u);
+  PW_METRIC(metrics_, allocation_failures_, "allocation_failures", 0u);
+  PW_METRIC(metrics_, free_bytes_, "free_bytes", 0u);
+  PW_METRIC(metrics_, largest_free_block_, "largest_free_block", 0u);
+  PW_METRIC(metrics_, fragmentation_, "fragmentation", 0.0f);
+  PW_METRIC(metrics_, allocations_up_to_16_, "allocations_up_to_16", 0u);
+  PW_METRIC(metrics_, allocations_up_to_32_, "allocations_up_to_32", 0u);
+  PW_METRIC(metrics_, allocations_up_to_64_, "allocations_up_to_64", 0u);
+  PW_METRIC(metrics_, allocations_up_to_128_, "allocations_up_to_128", 0u);
+  PW_METRIC(metrics_, allocations_up_to_256_, "allocations_up_to_256", 0u);
+  PW_METRIC(metrics_, allocations_up_to_512_, "allocations_up_to_512", 0u);
+  PW_METRIC(metrics_, allocations_over_512_, "allocations_over_512", 0u);
+};
+
+}  // namespace pw::allocator
@@ -0,0 +1,128 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "pw_allocator/block.h"
+#include "pw_allocator/freelist.h"
+#include "pw_allocator/freelist_heap.h"
+
+namespace pw::allocator {
+
+// A heap that serves small allocations from slabs of fixed-size slots, and
+// larger allocations from a FreeListHeap.
+//
+// Each slab is a Block carved from the front of the heap region and divided
+// into equally sized slots, one slab per size class. Free slots are kept in a
+// list that is stored in the slots themselves, so allocating and freeing a slot
+// takes constant time and slots never fragment. The rest of the region is
+// managed by a FreeListHeap.
+//
+// An allocation is served by the smallest size class that fits it and has a
+// free slot. Allocations larger than the largest slot size, or for which all
+// size classes that fit are full, fall through to the FreeListHeap.
+class SlabHeap {
+ public:
+  // A size class with slot_count slots of slot_size bytes. The slot size is
+  // rounded up so that every slot is aligned like a Block.
+  class Slab {
+   public:
+    constexpr Slab(size_t slot_size, size_t slot_count)
+        : slot_size_(slot_size),
+          slot_count_(slot_count),
+          slots_used_(0),
+          begin_(nullptr),
+          end_(nullptr),
+          free_slots_(nullptr) {}
+
+    size_t slot_size() const { return slot_size_; }
+    size_t slot_count() const { return slot_count_; }
+    size_t slots_used() const { return slots_used_; }
+
+   private:
+    friend class SlabHeap;
+
+    struct FreeSlot {
+      FreeSlot* next;
+    };
+
+    bool Contains(const std::byte* ptr) const {
+      return ptr >= begin_ && ptr < end_;
+    }
+
+    size_t slot_size_;
+    size_t slot_count_;
+    size_t slots_used_;
+    std::byte* begin_;
+    std::byte* end_;
+    FreeSlot* free_slots_;
+  };
+
+  // Carves the slabs from the start of the region and passes the rest of it to
+  // a FreeListHeap that uses the provided freelist. The slabs must be sorted by
+  // increasing slot size and must outlive the SlabHeap.
+  SlabHeap(std::span<std::byte> region,
+           std::span<Slab> slabs,
+           FreeList& freelist);
+
+  void* Allocate(size_t size);
+  void Free(void* ptr);
+  void* Realloc(void* ptr, size_t size);
+  void* Calloc(size_t num, size_t size);
+
+  std::span<const Slab> slabs() const { return slabs_; }
+
+  // The heap that serves allocations which do not fit in a slab.
+  FreeListHeap& heap() { return heap_; }
+
+ private:
+  // Initializes the slabs and returns the remaining region for the heap.
+  static std::span<std::byte> CarveSlabs(std::span<std::byte> region,
+                                         std::span<Slab> slabs);
+
+  // Returns the slab that contains ptr, or nullptr if it is not in a slab.
+  Slab* FindSlab(const void* ptr);
+
+  std::span<Slab> slabs_;
+  FreeListHeap heap_;
+};
+
+// A SlabHeap that holds its own slabs and freelist storage.
+template <size_t kNumSlabs>
+class SlabHeapBuffer {
+ public:
+  SlabHeapBuffer(std::span<std::byte> region,
+                 const std::array<SlabHeap::Slab, kNumSlabs>& slabs)
+      : slabs_(slabs),
+        freelist_(FreeListHeapBuffer<>::defaultBuckets),
+        heap_(region, slabs_, freelist_) {}
+
+  void* Allocate(size_t size) { return heap_.Allocate(size); }
+  void Free(void* ptr) { heap_.Free(ptr); }
+  void* Realloc(void* ptr, size_t size) { return heap_.Realloc(ptr, size); }
+  void* Calloc(size_t num, size_t size) { return heap_.Calloc(num, size); }
+
+  std::span<const SlabHeap::Slab> slabs() const { return heap_.slabs(); }
+  FreeListHeap& heap() { return heap_.heap(); }
+
+ private:
+  std::array<SlabHeap::Slab, kNumSlabs> slabs_;
+  FreeListBuffer<FreeListHeapBuffer<>::defaultBuckets.size()> freelist_;
+  SlabHeap heap_;
+};
+
+}  // namespace pw::allocator
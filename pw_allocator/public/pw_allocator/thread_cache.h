@@ -0,0 +1,236 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+
+#include "pw_allocator/block.h"
+#include "pw_allocator/freelist_heap.h"
+
+namespace pw::allocator {
+
+// A cache of recently freed allocations that sits in front of a FreeListHeap
+// shared by several threads. Each thread (or core) uses its own ThreadCache,
+// while the heap is protected by a lock that all of the caches share.
+//
+// Small allocations are sorted into power-of-two size classes. Each class has
+// a magazine of up to kMagazineSize free blocks, linked together through the
+// blocks themselves. Allocating from a class with a cached block, and freeing
+// into a class whose magazine is not full, does not touch the heap or take its
+// lock. An empty magazine is refilled with half a magazine of blocks under a
+// single lock, and a full magazine returns half of its blocks the same way.
+//
+// Cached blocks stay allocated in the heap until they are returned, so memory
+// held by one thread's cache cannot be used by other threads. Flush() returns
+// every cached block to the heap; the destructor calls it.
+//
+// Lock is any type with lock() and unlock(), such as pw::sync::Mutex.
+template <typename Lock, size_t kMagazineSize = 8>
+class ThreadCache {
+ public:
+  static constexpr size_t kMinSizeClass = 16;
+  static constexpr size_t kMaxSizeClass = 128;
+
+  constexpr ThreadCache(FreeListHeap& heap, Lock& lock)
+      : heap_(heap), lock_(lock), magazines_{} {}
+
+  ~ThreadCache() { Flush(); }
+
+  ThreadCache(const ThreadCache&) = delete;
+  ThreadCache& operator=(const ThreadCache&) = delete;
+
+  void* Allocate(size_t size) {
+    if (size == 0 || size > kMaxSizeClass) {
+      std::lock_guard lock(lock_);
+      return heap_.Allocate(size);
+    }
+
+    const size_t index = ClassForAllocation(size);
+    Magazine& magazine = magazines_[index];
+    if (magazine.head == nullptr) {
+      Refill(magazine, ClassSize(index));
+    }
+    return Pop(magazine);
+  }
+
+  // ptr must have been returned by this cache or another cache that shares
+  // the same heap.
+  void Free(void* ptr) {
+    if (ptr == nullptr) {
+      return;
+    }
+
+    const size_t index = ClassForBlock(ptr);
+    if (index == kNumSizeClasses) {
+      std::lock_guard lock(lock_);
+      heap_.Free(ptr);
+      return;
+    }
+
+    Magazine& magazine = magazines_[index];
+    if (magazine.count == kMagazineSize) {
+      std::lock_guard lock(lock_);
+      for (size_t i = 0; i < kBatchSize; ++i) {
+        heap_.Free(Pop(magazine));
+      }
+    }
+    Push(magazine, ptr);
+  }
+
+  // Follows the contract of the C standard realloc() function.
+  void* Realloc(void* ptr, size_t size) {
+    if (size == 0) {
+      Free(ptr);
+      return nullptr;
+    }
+
+    if (ptr == nullptr) {
+      return Allocate(size);
+    }
+
+    const size_t old_size = InnerSize(ptr);
+    if (old_size >= size) {
+      return ptr;
+    }
+
+    void* new_ptr = Allocate(size);
+    // Don't invalidate ptr if the allocation fails.
+    if (new_ptr == nullptr) {
+      return nullptr;
+    }
+    std::memcpy(new_ptr, ptr, old_size);
+
+    Free(ptr);
+    return new_ptr;
+  }
+
+  void* Calloc(size_t num, size_t size) {
+    void* ptr = Allocate(num * size);
+    if (ptr != nullptr) {
+      std::memset(ptr, 0, num * size);
+    }
+    return ptr;
+  }
+
+  // Returns every cached block to the heap.
+  void Flush() {
+    std::lock_guard lock(lock_);
+    for (Magazine& magazine : magazines_) {
+      while (magazine.head != nullptr) {
+        heap_.Free(Pop(magazine));
+      }
+    }
+  }
+
+  // The number of free blocks cached for allocations of the given size.
+  size_t cached_count(size_t size) const {
+    if (size == 0 || size > kMaxSizeClass) {
+      return 0;
+    }
+    return magazines_[ClassForAllocation(size)].count;
+  }
+
+ private:
+  static constexpr size_t kBatchSize = kMagazineSize / 2;
+  static_assert(kBatchSize > 0, "Magazines must hold at least two blocks");
+
+  static constexpr size_t CountSizeClasses() {
+    size_t count = 1;
+    for (size_t size = kMinSizeClass; size < kMaxSizeClass; size *= 2) {
+      count += 1;
+    }
+    return count;
+  }
+
+  static constexpr size_t kNumSizeClasses = CountSizeClasses();
+
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct Magazine {
+    FreeBlock* head;
+    size_t count;
+  };
+
+  static constexpr size_t ClassSize(size_t index) {
+    return kMinSizeClass << index;
+  }
+
+  // Returns the smallest size class that holds size bytes.
+  static size_t ClassForAllocation(size_t size) {
+    size_t index = 0;
+    while (ClassSize(index) < size) {
+      index += 1;
+    }
+    return index;
+  }
+
+  // Returns the largest size class that fits in the block holding ptr, or
+  // kNumSizeClasses if the block is too large to cache. Blocks that are not in
+  // use are also not cached, so the heap reports freeing them.
+  static size_t ClassForBlock(void* ptr) {
+    Block* block = Block::FromUsableSpace(static_cast<std::byte*>(ptr));
+    const size_t size = block->InnerSize();
+    if (!block->Used() || size >= 2 * kMaxSizeClass) {
+      return kNumSizeClasses;
+    }
+
+    size_t index = 0;
+    while (index + 1 < kNumSizeClasses && ClassSize(index + 1) <= size) {
+      index += 1;
+    }
+    return index;
+  }
+
+  static size_t InnerSize(void* ptr) {
+    return Block::FromUsableSpace(static_cast<std::byte*>(ptr))->InnerSize();
+  }
+
+  void Refill(Magazine& magazine, size_t class_size) {
+    std::lock_guard lock(lock_);
+    for (size_t i = 0; i < kBatchSize; ++i) {
+      void* ptr = heap_.Allocate(class_size);
+      if (ptr == nullptr) {
+        return;
+      }
+      Push(magazine, ptr);
+    }
+  }
+
+  static void Push(Magazine& magazine, void* ptr) {
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = magazine.head;
+    magazine.head = block;
+    magazine.count += 1;
+  }
+
+  static void* Pop(Magazine& magazine) {
+    FreeBlock* block = magazine.head;
+    if (block != nullptr) {
+      magazine.head = block->next;
+      magazine.count -= 1;
+    }
+    return block;
+  }
+
+  FreeListHeap& heap_;
+  Lock& lock_;
+  std::array<Magazine, kNumSizeClasses> magazines_;
+};
+
+}  // namespace pw::allocator
@@ -0,0 +1,149 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_status/status.h"
+
+namespace pw::allocator {
+
+// A two-level segregated fit (TLSF) freelist, with the same interface as
+// FreeList. All operations take constant time, so a FreeListHeap that uses it
+// has a bounded allocation and free cost.
+//
+// Chunks are sorted into lists by size. The first level divides sizes into
+// powers of two, and the second level divides each power of two into
+// kSecondLevelCount equally sized ranges. A bitmap records which lists are not
+// empty, so the first list that can hold an allocation is found with a couple
+// of bit scans instead of walking the lists. Lists are doubly linked so that a
+// chunk can be removed without searching for it.
+//
+// FindChunk() rounds the requested size up to the start of the next list, so
+// any chunk in the list it selects is large enough. This means an allocation
+// may be served by a larger chunk than necessary. If no larger list has a
+// chunk, only the first chunk in the list for the size itself is checked, so a
+// chunk that fits may go unused.
+//
+// Like FreeList, this class keeps its storage outside of the class to avoid
+// specializing its logic for every size. TlsfFreeListBuffer provides the
+// storage.
+class TlsfFreeList {
+ public:
+  // Each power of two of chunk sizes is split into this many lists.
+  static constexpr size_t kSecondLevelBits = 3;
+  static constexpr size_t kSecondLevelCount = size_t(1) << kSecondLevelBits;
+
+  TlsfFreeList(const TlsfFreeList& other) = delete;
+  TlsfFreeList(TlsfFreeList&& other) = delete;
+  TlsfFreeList& operator=(const TlsfFreeList& other) = delete;
+  TlsfFreeList& operator=(TlsfFreeList&& other) = delete;
+
+  // Adds a chunk to this freelist. Returns:
+  //   OK: The chunk was added successfully
+  //   OUT_OF_RANGE: The chunk could not be added for size reasons (e.g. if
+  //                 the chunk is too small to store the FreeListNode, or is
+  //                 larger than the maximum chunk size).
+  Status AddChunk(std::span<std::byte> chunk);
+
+  // Finds an eligible chunk for an allocation of size `size`. Returns a
+  // std::span representing the chunk. This will be "valid" on success, and
+  // will have size = 0 on failure (if there were no chunks available for that
+  // allocation).
+  std::span<std::byte> FindChunk(size_t size) const;
+
+  // Remove a chunk from this freelist. Returns:
+  //   OK: The chunk was removed successfully
+  //   NOT_FOUND: The chunk is not in this freelist.
+  Status RemoveChunk(std::span<std::byte> chunk);
+
+  // The number of first level lists needed for chunks of up to
+  // max_chunk_size bytes.
+  static constexpr size_t FirstLevelCount(size_t max_chunk_size) {
+    return MapSize(max_chunk_size).first_level + 1;
+  }
+
+ protected:
+  struct FreeListNode {
+    FreeListNode* next;
+    FreeListNode* prev;
+    size_t size;
+  };
+
+  constexpr TlsfFreeList(std::span<FreeListNode*> lists,
+                         std::span<uint32_t> second_level_bitmaps,
+                         size_t max_chunk_size)
+      : lists_(lists),
+        second_level_bitmaps_(second_level_bitmaps),
+        max_chunk_size_(max_chunk_size),
+        first_level_bitmap_(0) {}
+
+ private:
+  struct Index {
+    size_t first_level;
+    size_t second_level;
+  };
+
+  // Returns the list that holds chunks of the given size.
+  static constexpr Index MapSize(size_t size) {
+    if (size < kSecondLevelCount) {
+      return Index{0, size};
+    }
+    const size_t msb = MostSignificantBit(size);
+    return Index{msb - kSecondLevelBits + 1,
+                 (size >> (msb - kSecondLevelBits)) - kSecondLevelCount};
+  }
+
+  static constexpr size_t MostSignificantBit(size_t value) {
+    return 63 - __builtin_clzll(value);
+  }
+
+  // Finds the first non-empty list in which every chunk holds at least size
+  // bytes. Returns false if there is no such list.
+  bool FindList(size_t size, Index& index) const;
+
+  FreeListNode*& List(Index index) const {
+    return lists_[index.first_level * kSecondLevelCount + index.second_level];
+  }
+
+  std::span<FreeListNode*> lists_;
+  std::span<uint32_t> second_level_bitmaps_;
+  size_t max_chunk_size_;
+  uint32_t first_level_bitmap_;
+};
+
+// Holder for TlsfFreeList's storage. Chunks of up to kMaxChunkSize bytes may be
+// added to the list; this is typically the size of the heap.
+template <size_t kMaxChunkSize>
+class TlsfFreeListBuffer : public TlsfFreeList {
+ public:
+  // Like FreeListBuffer, the base class is given the storage before it is
+  // initialized. This is safe because the base constructor does not access it.
+  TlsfFreeListBuffer()
+      : TlsfFreeList(lists_, second_level_bitmaps_, kMaxChunkSize),
+        lists_{},
+        second_level_bitmaps_{} {}
+
+ private:
+  static constexpr size_t kFirstLevelCount = FirstLevelCount(kMaxChunkSize);
+  static_assert(kFirstLevelCount < 32, "kMaxChunkSize is too large");
+
+  std::array<FreeListNode*, kFirstLevelCount * kSecondLevelCount> lists_;
+  std::array<uint32_t, kFirstLevelCount> second_level_bitmaps_;
+};
+
+}  // namespace pw::allocator
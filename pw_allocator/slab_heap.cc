@@ -0,0 +1,158 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/slab_heap.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/check.h"
+
+namespace pw::allocator {
+
+SlabHeap::SlabHeap(std::span<std::byte> region,
+                   std::span<Slab> slabs,
+                   FreeList& freelist)
+    : slabs_(slabs), heap_(CarveSlabs(region, slabs), freelist) {}
+
+std::span<std::byte> SlabHeap::CarveSlabs(std::span<std::byte> region,
+                                          std::span<Slab> slabs) {
+  Block* block;
+  PW_CHECK_OK(Block::Init(region, &block),
+              "Failed to initialize SlabHeap region; misaligned or too small");
+
+  size_t previous_slot_size = 0;
+  for (Slab& slab : slabs) {
+    PW_CHECK_UINT_GT(slab.slot_size_,
+                     previous_slot_size,
+                     "Slabs must be sorted by increasing slot size");
+    previous_slot_size = slab.slot_size_;
+
+    // Every slot must be able to hold a free list node, and must be aligned so
+    // that it can hold any object the heap could.
+    constexpr size_t kAlignMask = alignof(Block) - 1;
+    slab.slot_size_ = std::max(slab.slot_size_, sizeof(Slab::FreeSlot));
+    slab.slot_size_ = (slab.slot_size_ + kAlignMask) & ~kAlignMask;
+
+    Block* rest;
+    PW_CHECK_OK(block->Split(slab.slot_size_ * slab.slot_count_, &rest),
+                "The SlabHeap region is too small for its slabs");
+    block->MarkUsed();
+
+    slab.begin_ = block->UsableSpace();
+    slab.end_ = slab.begin_ + slab.slot_size_ * slab.slot_count_;
+    slab.slots_used_ = 0;
+
+    // Thread the slots into a free list, with the first slot at the front.
+    slab.free_slots_ = nullptr;
+    for (size_t i = slab.slot_count_; i > 0; --i) {
+      auto* slot = reinterpret_cast<Slab::FreeSlot*>(
+          slab.begin_ + (i - 1) * slab.slot_size_);
+      slot->next = slab.free_slots_;
+      slab.free_slots_ = slot;
+    }
+
+    block = rest;
+  }
+
+  // The last block holds the FreeListHeap, which divides it into its own
+  // blocks.
+  block->MarkUsed();
+  return std::span(block->UsableSpace(), block->InnerSize());
+}
+
+void* SlabHeap::Allocate(size_t size) {
+  for (Slab& slab : slabs_) {
+    if (size <= slab.slot_size_ && slab.free_slots_ != nullptr) {
+      Slab::FreeSlot* slot = slab.free_slots_;
+      slab.free_slots_ = slot->next;
+      slab.slots_used_ += 1;
+      return slot;
+    }
+  }
+  return heap_.Allocate(size);
+}
+
+void SlabHeap::Free(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+
+  Slab* slab = FindSlab(ptr);
+  if (slab == nullptr) {
+    heap_.Free(ptr);
+    return;
+  }
+
+  std::byte* bytes = static_cast<std::byte*>(ptr);
+  const size_t slot_offset = (bytes - slab->begin_) % slab->slot_size_;
+  PW_DCHECK_UINT_EQ(slot_offset, 0u, "You tried to free an invalid pointer!");
+
+  auto* slot = reinterpret_cast<Slab::FreeSlot*>(bytes);
+  slot->next = slab->free_slots_;
+  slab->free_slots_ = slot;
+  slab->slots_used_ -= 1;
+}
+
+// Follows the contract of the C standard realloc() function.
+void* SlabHeap::Realloc(void* ptr, size_t size) {
+  if (size == 0) {
+    Free(ptr);
+    return nullptr;
+  }
+
+  if (ptr == nullptr) {
+    return Allocate(size);
+  }
+
+  Slab* slab = FindSlab(ptr);
+  if (slab == nullptr) {
+    return heap_.Realloc(ptr, size);
+  }
+
+  // Slots are not resized, so keep the slot if the new size still fits.
+  if (size <= slab->slot_size_) {
+    return ptr;
+  }
+
+  void* new_ptr = Allocate(size);
+  // Don't invalidate ptr if the allocation fails.
+  if (new_ptr == nullptr) {
+    return nullptr;
+  }
+  std::memcpy(new_ptr, ptr, slab->slot_size_);
+
+  Free(ptr);
+  return new_ptr;
+}
+
+void* SlabHeap::Calloc(size_t num, size_t size) {
+  void* ptr = Allocate(num * size);
+  if (ptr != nullptr) {
+    std::memset(ptr, 0, num * size);
+  }
+  return ptr;
+}
+
+SlabHeap::Slab* SlabHeap::FindSlab(const void* ptr) {
+  const std::byte* bytes = static_cast<const std::byte*>(ptr);
+  for (Slab& slab : slabs_) {
+    if (slab.Contains(bytes)) {
+      return &slab;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace pw::allocator
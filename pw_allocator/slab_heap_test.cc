@@ -0,0 +1,168 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/slab_heap.h"
+
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+namespace {
+
+constexpr size_t N = 2048;
+
+constexpr std::array<SlabHeap::Slab, 3> kSlabs = {
+    SlabHeap::Slab(32, 4),
+    SlabHeap::Slab(64, 2),
+    SlabHeap::Slab(128, 2),
+};
+
+TEST(SlabHeap, SmallAllocationsUseSmallestFittingSlab) {
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  void* ptr1 = allocator.Allocate(1);
+  void* ptr2 = allocator.Allocate(32);
+  void* ptr3 = allocator.Allocate(33);
+  void* ptr4 = allocator.Allocate(100);
+
+  // The slabs are carved from the start of the buffer, in order.
+  const std::byte* slab_32 =
+      &buf[0] + sizeof(Block) + PW_ALLOCATOR_POISON_OFFSET;
+  ASSERT_EQ(ptr1, slab_32);
+  EXPECT_EQ(ptr2, slab_32 + 32);
+  EXPECT_GT(ptr3, ptr2);
+  EXPECT_GT(ptr4, ptr3);
+
+  EXPECT_EQ(allocator.slabs()[0].slots_used(), 2u);
+  EXPECT_EQ(allocator.slabs()[1].slots_used(), 1u);
+  EXPECT_EQ(allocator.slabs()[2].slots_used(), 1u);
+}
+
+TEST(SlabHeap, FreedSlotIsReused) {
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  void* ptr1 = allocator.Allocate(16);
+  void* ptr2 = allocator.Allocate(16);
+  allocator.Free(ptr1);
+  EXPECT_EQ(allocator.slabs()[0].slots_used(), 1u);
+
+  EXPECT_EQ(allocator.Allocate(16), ptr1);
+  EXPECT_NE(ptr1, ptr2);
+  EXPECT_EQ(allocator.slabs()[0].slots_used(), 2u);
+}
+
+TEST(SlabHeap, FullSlabFallsThroughToLargerSlab) {
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  for (size_t i = 0; i < kSlabs[0].slot_count(); ++i) {
+    ASSERT_NE(allocator.Allocate(32), nullptr);
+  }
+  EXPECT_EQ(allocator.slabs()[1].slots_used(), 0u);
+
+  ASSERT_NE(allocator.Allocate(32), nullptr);
+  EXPECT_EQ(allocator.slabs()[1].slots_used(), 1u);
+}
+
+TEST(SlabHeap, LargeAllocationsUseHeap) {
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  void* ptr = allocator.Allocate(512);
+  ASSERT_NE(ptr, nullptr);
+  for (const SlabHeap::Slab& slab : allocator.slabs()) {
+    EXPECT_EQ(slab.slots_used(), 0u);
+  }
+
+  // The heap's allocation comes after all of the slabs.
+  const SlabHeap::Slab& last_slab = allocator.slabs().back();
+  void* last_slot = allocator.Allocate(last_slab.slot_size());
+  EXPECT_GT(ptr, last_slot);
+
+  allocator.Free(ptr);
+  EXPECT_EQ(allocator.heap().Allocate(512), ptr);
+}
+
+TEST(SlabHeap, SlotsAreAligned) {
+  constexpr std::array<SlabHeap::Slab, 2> kOddSlabs = {
+      SlabHeap::Slab(1, 3),
+      SlabHeap::Slab(13, 3),
+  };
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kOddSlabs);
+
+  for (size_t i = 0; i < 6; ++i) {
+    void* ptr = allocator.Allocate(1);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % alignof(Block), 0u);
+  }
+  EXPECT_GE(allocator.slabs()[0].slot_size(), sizeof(void*));
+  EXPECT_EQ(allocator.slabs()[1].slot_size() % alignof(Block), 0u);
+}
+
+TEST(SlabHeap, ReallocWithinSlotKeepsPointer) {
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  void* ptr = allocator.Allocate(8);
+  EXPECT_EQ(allocator.Realloc(ptr, 32), ptr);
+}
+
+TEST(SlabHeap, ReallocToLargerSlotCopiesData) {
+  constexpr char kData[] = "slab heap data";
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  void* ptr1 = allocator.Allocate(sizeof(kData));
+  std::memcpy(ptr1, kData, sizeof(kData));
+
+  void* ptr2 = allocator.Realloc(ptr1, 300);
+  ASSERT_NE(ptr2, nullptr);
+  EXPECT_NE(ptr2, ptr1);
+  EXPECT_EQ(std::memcmp(ptr2, kData, sizeof(kData)), 0);
+  EXPECT_EQ(allocator.slabs()[0].slots_used(), 0u);
+}
+
+TEST(SlabHeap, CallocZeroesSlot) {
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  // Dirty a slot, then free it so Calloc reuses it.
+  void* ptr = allocator.Allocate(32);
+  std::memset(ptr, 0xff, 32);
+  allocator.Free(ptr);
+
+  std::byte* zeroed = static_cast<std::byte*>(allocator.Calloc(4, 8));
+  ASSERT_EQ(zeroed, ptr);
+  for (size_t i = 0; i < 32; ++i) {
+    EXPECT_EQ(zeroed[i], std::byte(0));
+  }
+}
+
+TEST(SlabHeap, FreeNullIsNoOp) {
+  alignas(Block) std::byte buf[N] = {std::byte(0)};
+  SlabHeapBuffer allocator(buf, kSlabs);
+
+  allocator.Free(nullptr);
+  for (const SlabHeap::Slab& slab : allocator.slabs()) {
+    EXPECT_EQ(slab.slots_used(), 0u);
+  }
+}
+
+}  // namespace
+}  // namespace pw::allocator
@@ -0,0 +1,155 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/thread_cache.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+namespace {
+
+constexpr size_t N = 2048;
+
+// Counts how often the shared heap is locked.
+class CountingLock {
+ public:
+  void lock() {
+    EXPECT_FALSE(locked_);
+    locked_ = true;
+    lock_count_ += 1;
+  }
+  void unlock() {
+    EXPECT_TRUE(locked_);
+    locked_ = false;
+  }
+
+  size_t lock_count() const { return lock_count_; }
+
+ private:
+  bool locked_ = false;
+  size_t lock_count_ = 0;
+};
+
+class ThreadCacheTest : public ::testing::Test {
+ protected:
+  ThreadCacheTest()
+      : freelist_(FreeListHeapBuffer<>::defaultBuckets),
+        heap_(buffer_, freelist_),
+        cache_(heap_, lock_) {}
+
+  alignas(Block) std::byte buffer_[N] = {};
+  FreeListBuffer<FreeListHeapBuffer<>::defaultBuckets.size()> freelist_;
+  FreeListHeap heap_;
+  CountingLock lock_;
+  ThreadCache<CountingLock, 4> cache_;
+};
+
+TEST_F(ThreadCacheTest, RefillsMagazineInBatches) {
+  void* ptr1 = cache_.Allocate(24);
+  ASSERT_NE(ptr1, nullptr);
+  EXPECT_EQ(lock_.lock_count(), 1u);
+  EXPECT_EQ(cache_.cached_count(24), 1u);
+
+  // The second block of the batch is served without locking the heap.
+  void* ptr2 = cache_.Allocate(32);
+  ASSERT_NE(ptr2, nullptr);
+  EXPECT_NE(ptr1, ptr2);
+  EXPECT_EQ(lock_.lock_count(), 1u);
+  EXPECT_EQ(cache_.cached_count(32), 0u);
+}
+
+TEST_F(ThreadCacheTest, FreedBlockIsReusedWithoutLocking) {
+  void* ptr = cache_.Allocate(64);
+  ASSERT_NE(ptr, nullptr);
+  const size_t lock_count = lock_.lock_count();
+
+  cache_.Free(ptr);
+  EXPECT_EQ(cache_.Allocate(64), ptr);
+  EXPECT_EQ(lock_.lock_count(), lock_count);
+}
+
+TEST_F(ThreadCacheTest, FullMagazineReturnsBatchToHeap) {
+  // Allocate whole batches, so that the magazine ends up empty.
+  void* ptrs[6];
+  for (void*& ptr : ptrs) {
+    ptr = cache_.Allocate(16);
+    ASSERT_NE(ptr, nullptr);
+  }
+  const size_t lock_count = lock_.lock_count();
+
+  for (size_t i = 0; i < 4; ++i) {
+    cache_.Free(ptrs[i]);
+  }
+  EXPECT_EQ(lock_.lock_count(), lock_count);
+  EXPECT_EQ(cache_.cached_count(16), 4u);
+
+  cache_.Free(ptrs[4]);
+  EXPECT_EQ(lock_.lock_count(), lock_count + 1);
+  EXPECT_EQ(cache_.cached_count(16), 3u);
+}
+
+TEST_F(ThreadCacheTest, LargeAllocationsUseHeap) {
+  void* ptr = cache_.Allocate(512);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(lock_.lock_count(), 1u);
+
+  cache_.Free(ptr);
+  EXPECT_EQ(lock_.lock_count(), 2u);
+  EXPECT_EQ(heap_.Allocate(512), ptr);
+}
+
+TEST_F(ThreadCacheTest, FlushReturnsBlocksToHeap) {
+  void* ptr = cache_.Allocate(128);
+  ASSERT_NE(ptr, nullptr);
+  cache_.Free(ptr);
+  EXPECT_EQ(cache_.cached_count(128), 2u);
+
+  cache_.Flush();
+  EXPECT_EQ(cache_.cached_count(128), 0u);
+
+  // With the cached blocks merged back, the whole heap is available.
+  EXPECT_NE(
+      heap_.Allocate(N - sizeof(Block) - 2 * PW_ALLOCATOR_POISON_OFFSET),
+      nullptr);
+}
+
+TEST_F(ThreadCacheTest, ReallocCopiesData) {
+  constexpr char kData[] = "thread cache";
+  void* ptr1 = cache_.Allocate(sizeof(kData));
+  ASSERT_NE(ptr1, nullptr);
+  std::memcpy(ptr1, kData, sizeof(kData));
+
+  void* ptr2 = cache_.Realloc(ptr1, 100);
+  ASSERT_NE(ptr2, nullptr);
+  EXPECT_EQ(std::memcmp(ptr2, kData, sizeof(kData)), 0);
+  EXPECT_EQ(cache_.cached_count(sizeof(kData)), 2u);
+}
+
+TEST_F(ThreadCacheTest, CallocZeroesCachedBlock) {
+  void* ptr = cache_.Allocate(32);
+  ASSERT_NE(ptr, nullptr);
+  std::memset(ptr, 0xff, 32);
+  cache_.Free(ptr);
+
+  std::byte* zeroed = static_cast<std::byte*>(cache_.Calloc(4, 8));
+  ASSERT_EQ(zeroed, ptr);
+  for (size_t i = 0; i < 32; ++i) {
+    EXPECT_EQ(zeroed[i], std::byte(0));
+  }
+}
+
+}  // namespace
+}  // namespace pw::allocator
@@ -0,0 +1,134 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/tlsf_freelist.h"
+
+namespace pw::allocator {
+
+Status TlsfFreeList::AddChunk(std::span<std::byte> chunk) {
+  // Check that the size is enough to actually store what we need
+  if (chunk.size() < sizeof(FreeListNode) || chunk.size() > max_chunk_size_) {
+    return Status::OutOfRange();
+  }
+
+  const Index index = MapSize(chunk.size());
+  FreeListNode*& head = List(index);
+
+  FreeListNode* node = reinterpret_cast<FreeListNode*>(chunk.data());
+  node->size = chunk.size();
+  node->prev = nullptr;
+  node->next = head;
+  if (head != nullptr) {
+    head->prev = node;
+  }
+  head = node;
+
+  first_level_bitmap_ |= uint32_t(1) << index.first_level;
+  second_level_bitmaps_[index.first_level] |= uint32_t(1)
+                                              << index.second_level;
+  return OkStatus();
+}
+
+std::span<std::byte> TlsfFreeList::FindChunk(size_t size) const {
+  if (size == 0 || size > max_chunk_size_) {
+    return std::span<std::byte>();
+  }
+
+  Index index;
+  FreeListNode* node = nullptr;
+  if (FindList(size, index)) {
+    node = List(index);
+  } else {
+    // There are no chunks in larger lists, but the first chunk in the list for
+    // the size itself may still be large enough.
+    FreeListNode* head = List(MapSize(size));
+    if (head != nullptr && head->size >= size) {
+      node = head;
+    }
+  }
+
+  if (node == nullptr) {
+    return std::span<std::byte>();
+  }
+  return std::span<std::byte>(reinterpret_cast<std::byte*>(node), node->size);
+}
+
+Status TlsfFreeList::RemoveChunk(std::span<std::byte> chunk) {
+  if (chunk.size() < sizeof(FreeListNode) || chunk.size() > max_chunk_size_) {
+    return Status::NotFound();
+  }
+
+  const Index index = MapSize(chunk.size());
+  FreeListNode*& head = List(index);
+  FreeListNode* node = reinterpret_cast<FreeListNode*>(chunk.data());
+
+  // The node's links are only trusted if its neighbours agree with them, which
+  // is not the case for a chunk that was never added.
+  if (head == nullptr || node->size != chunk.size()) {
+    return Status::NotFound();
+  }
+  if (node->prev == nullptr ? head != node : node->prev->next != node) {
+    return Status::NotFound();
+  }
+
+  if (node->prev == nullptr) {
+    head = node->next;
+  } else {
+    node->prev->next = node->next;
+  }
+  if (node->next != nullptr) {
+    node->next->prev = node->prev;
+  }
+
+  if (head == nullptr) {
+    uint32_t& second_level_bitmap = second_level_bitmaps_[index.first_level];
+    second_level_bitmap &= ~(uint32_t(1) << index.second_level);
+    if (second_level_bitmap == 0) {
+      first_level_bitmap_ &= ~(uint32_t(1) << index.first_level);
+    }
+  }
+  return OkStatus();
+}
+
+bool TlsfFreeList::FindList(size_t size, Index& index) const {
+  // Round the size up to the first size of the next list, so that every chunk
+  // in the list that is found is large enough. Sizes in the lowest lists are
+  // exact, so they need no rounding.
+  if (size >= kSecondLevelCount) {
+    size += (size_t(1) << (MostSignificantBit(size) - kSecondLevelBits)) - 1;
+  }
+  index = MapSize(size);
+  if (index.first_level >= second_level_bitmaps_.size()) {
+    return false;
+  }
+
+  // Look for a larger list within the same power of two first, then for the
+  // smallest list in the next non-empty power of two.
+  uint32_t second_level_bitmap = second_level_bitmaps_[index.first_level] &
+                                 (~uint32_t(0) << index.second_level);
+  if (second_level_bitmap == 0) {
+    const uint32_t first_level_bitmap =
+        first_level_bitmap_ & (~uint32_t(0) << (index.first_level + 1));
+    if (first_level_bitmap == 0) {
+      return false;
+    }
+    index.first_level = __builtin_ctz(first_level_bitmap);
+    second_level_bitmap = second_level_bitmaps_[index.first_level];
+  }
+
+  index.second_level = __builtin_ctz(second_level_bitmap);
+  return true;
+}
+
+}  // namespace pw::allocator
@@ -0,0 +1,148 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_allocator/tlsf_freelist.h"
+
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_status/status.h"
+
+using std::byte;
+
+namespace pw::allocator {
+namespace {
+
+constexpr size_t kMaxChunkSize = 4096;
+
+TEST(TlsfFreeList, EmptyListHasNoMembers) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+
+  EXPECT_EQ(list.FindChunk(4).size(), 0u);
+  EXPECT_EQ(list.FindChunk(128).size(), 0u);
+}
+
+TEST(TlsfFreeList, CanRetrieveAddedMember) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte data[512] = {};
+
+  EXPECT_EQ(list.AddChunk(data), OkStatus());
+
+  auto item = list.FindChunk(sizeof(data));
+  EXPECT_EQ(item.size(), sizeof(data));
+  EXPECT_EQ(item.data(), data);
+}
+
+TEST(TlsfFreeList, CanRetrieveAddedMemberForSmallerSize) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte data[512] = {};
+
+  ASSERT_EQ(list.AddChunk(data), OkStatus());
+
+  auto item = list.FindChunk(1);
+  EXPECT_EQ(item.size(), sizeof(data));
+  EXPECT_EQ(item.data(), data);
+}
+
+TEST(TlsfFreeList, CanRemoveItem) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte data[512] = {};
+
+  ASSERT_EQ(list.AddChunk(data), OkStatus());
+  EXPECT_EQ(list.RemoveChunk(data), OkStatus());
+
+  EXPECT_EQ(list.FindChunk(sizeof(data)).size(), 0u);
+}
+
+TEST(TlsfFreeList, CanRemoveItemsInAnyOrder) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte data1[256] = {};
+  alignas(void*) byte data2[256] = {};
+  alignas(void*) byte data3[256] = {};
+
+  ASSERT_EQ(list.AddChunk(data1), OkStatus());
+  ASSERT_EQ(list.AddChunk(data2), OkStatus());
+  ASSERT_EQ(list.AddChunk(data3), OkStatus());
+
+  // Remove from the middle, the end and the front of the list.
+  EXPECT_EQ(list.RemoveChunk(data2), OkStatus());
+  EXPECT_EQ(list.RemoveChunk(data1), OkStatus());
+  EXPECT_EQ(list.FindChunk(256).data(), data3);
+  EXPECT_EQ(list.RemoveChunk(data3), OkStatus());
+  EXPECT_EQ(list.FindChunk(1).size(), 0u);
+}
+
+TEST(TlsfFreeList, FoundChunkIsLargeEnough) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte data1[200] = {};
+  alignas(void*) byte data2[300] = {};
+
+  ASSERT_EQ(list.AddChunk(data1), OkStatus());
+  ASSERT_EQ(list.AddChunk(data2), OkStatus());
+
+  EXPECT_EQ(list.FindChunk(150).data(), data1);
+  EXPECT_EQ(list.FindChunk(250).data(), data2);
+  EXPECT_EQ(list.FindChunk(301).size(), 0u);
+}
+
+TEST(TlsfFreeList, FindsChunkInLargerPowerOfTwo) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte data[2048] = {};
+
+  ASSERT_EQ(list.AddChunk(data), OkStatus());
+
+  for (size_t size = 1; size <= 1024; size *= 2) {
+    EXPECT_EQ(list.FindChunk(size).data(), data);
+  }
+}
+
+TEST(TlsfFreeList, ChecksFirstChunkInListForSize) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  // 200 and 201 bytes share a list. Only the first chunk in that list is
+  // checked if no larger list has a chunk.
+  alignas(void*) byte data1[201] = {};
+  alignas(void*) byte data2[200] = {};
+
+  ASSERT_EQ(list.AddChunk(data1), OkStatus());
+  EXPECT_EQ(list.FindChunk(201).data(), data1);
+
+  ASSERT_EQ(list.AddChunk(data2), OkStatus());
+  EXPECT_EQ(list.FindChunk(200).data(), data2);
+  EXPECT_EQ(list.FindChunk(201).size(), 0u);
+}
+
+TEST(TlsfFreeList, CantAddOrFindChunksOfInvalidSize) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte small[3] = {};
+  alignas(void*) byte large[kMaxChunkSize + 1] = {};
+
+  EXPECT_EQ(list.AddChunk(small), Status::OutOfRange());
+  EXPECT_EQ(list.AddChunk(large), Status::OutOfRange());
+  EXPECT_EQ(list.FindChunk(kMaxChunkSize + 1).size(), 0u);
+}
+
+TEST(TlsfFreeList, RemoveUnknownChunkReturnsNotFound) {
+  TlsfFreeListBuffer<kMaxChunkSize> list;
+  alignas(void*) byte data1[128] = {};
+  alignas(void*) byte data2[128] = {};
+
+  EXPECT_EQ(list.RemoveChunk(data1), Status::NotFound());
+
+  ASSERT_EQ(list.AddChunk(data1), OkStatus());
+  EXPECT_EQ(list.RemoveChunk(data2), Status::NotFound());
+  EXPECT_EQ(list.FindChunk(128).data(), data1);
+}
+
+}  // namespace
+}  // namespace pw::allocator
@@ -0,0 +1,127 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_analog/continuous_input.h"
+
+#include <array>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::analog {
+namespace {
+
+// Fake ADC that fills the buffer from the test instead of with DMA.
+class TestContinuousInput : public ContinuousInput {
+ public:
+  AnalogInput::Limits GetLimits() const override { return {0, 4095}; }
+
+  // Writes the next half of the buffer with value and signals it.
+  void FillNextHalf(int32_t value) {
+    const size_t half_size = buffer_.size() / 2;
+    for (size_t i = 0; i < half_size; ++i) {
+      buffer_[next_half_ * half_size + i] = value;
+    }
+    HalfFull(next_half_);
+    next_half_ ^= 1;
+  }
+
+  Status start_status = OkStatus();
+  bool stopped = false;
+
+ private:
+  Status DoStart(std::span<int32_t> buffer) override {
+    buffer_ = buffer;
+    next_half_ = 0;
+    return start_status;
+  }
+
+  void DoStop() override { stopped = true; }
+
+  std::span<int32_t> buffer_;
+  int next_half_ = 0;
+};
+
+struct Received {
+  const int32_t* data = nullptr;
+  size_t size = 0;
+  int32_t first = 0;
+  int calls = 0;
+};
+
+TEST(ContinuousInput, RejectsBadBuffers) {
+  TestContinuousInput input;
+  std::array<int32_t, 3> odd;
+  EXPECT_EQ(input.Start(std::span<int32_t>(), [](auto) {}),
+            Status::InvalidArgument());
+  EXPECT_EQ(input.Start(odd, [](auto) {}), Status::InvalidArgument());
+  EXPECT_FALSE(input.running());
+}
+
+TEST(ContinuousInput, AlternatesHalves) {
+  TestContinuousInput input;
+  std::array<int32_t, 8> buffer{};
+  Received received;
+
+  ASSERT_EQ(input.Start(buffer,
+                        [&received](std::span<const int32_t> samples) {
+                          received.data = samples.data();
+                          received.size = samples.size();
+                          received.first = samples[0];
+                          received.calls += 1;
+                        }),
+            OkStatus());
+  EXPECT_TRUE(input.running());
+
+  input.FillNextHalf(100);
+  EXPECT_EQ(received.calls, 1);
+  EXPECT_EQ(received.data, buffer.data());
+  EXPECT_EQ(received.size, 4u);
+  EXPECT_EQ(received.first, 100);
+
+  input.FillNextHalf(200);
+  EXPECT_EQ(received.calls, 2);
+  EXPECT_EQ(received.data, buffer.data() + 4);
+  EXPECT_EQ(received.first, 200);
+
+  input.FillNextHalf(300);
+  EXPECT_EQ(received.data, buffer.data());
+  EXPECT_EQ(received.first, 300);
+}
+
+TEST(ContinuousInput, StartWhileRunning) {
+  TestContinuousInput input;
+  std::array<int32_t, 4> buffer;
+  ASSERT_EQ(input.Start(buffer, [](auto) {}), OkStatus());
+  EXPECT_EQ(input.Start(buffer, [](auto) {}), Status::FailedPrecondition());
+
+  input.Stop();
+  EXPECT_TRUE(input.stopped);
+  EXPECT_FALSE(input.running());
+  EXPECT_EQ(input.Start(buffer, [](auto) {}), OkStatus());
+}
+
+TEST(ContinuousInput, BackendStartFailure) {
+  TestContinuousInput input;
+  input.start_status = Status::Unavailable();
+  std::array<int32_t, 4> buffer;
+  EXPECT_EQ(input.Start(buffer, [](auto) {}), Status::Unavailable());
+  EXPECT_FALSE(input.running());
+
+  input.Stop();
+  EXPECT_FALSE(input.stopped);
+}
+
+}  // namespace
+}  // namespace pw::analog
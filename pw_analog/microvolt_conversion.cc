@@ -0,0 +1,98 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_analog/microvolt_conversion.h"
+
+#include <algorithm>
+
+#include "pw_assert/assert.h"
+
+namespace pw::analog {
+namespace {
+
+// Number of bits needed to represent value.
+int BitWidth(uint64_t value) {
+  int bits = 0;
+  while (value != 0) {
+    bits += 1;
+    value >>= 1;
+  }
+  return bits;
+}
+
+}  // namespace
+
+void ConvertToMicrovolts(AnalogInput::Limits limits,
+                         MicrovoltReferences references,
+                         std::span<const int32_t> samples,
+                         std::span<int32_t> microvolts) {
+  PW_ASSERT(microvolts.size() >= samples.size());
+
+  const int64_t limits_range = int64_t{limits.max} - limits.min;
+  const int64_t voltage_range =
+      int64_t{references.max_voltage_uv} - references.min_voltage_uv;
+
+  if (limits_range == 0) {
+    std::fill_n(microvolts.begin(), samples.size(), references.min_voltage_uv);
+    return;
+  }
+
+  // Work with the offset from limits.min as a distance towards limits.max, so
+  // that everything below is unsigned. Samples are clamped to the limits so
+  // the intermediate products cannot overflow.
+  const bool inverted_limits = limits_range < 0;
+  const uint64_t range = static_cast<uint64_t>(
+      inverted_limits ? -limits_range : limits_range);
+  const int32_t low = std::min(limits.min, limits.max);
+  const int32_t high = std::max(limits.min, limits.max);
+
+  const int64_t sign = voltage_range < 0 ? -1 : 1;
+  const uint64_t volts = static_cast<uint64_t>(voltage_range * sign);
+
+  auto distance = [&](int32_t sample) -> uint64_t {
+    const int64_t clamped = std::clamp(sample, low, high);
+    return static_cast<uint64_t>(inverted_limits ? limits.min - clamped
+                                                 : clamped - limits.min);
+  };
+
+  // The conversion is floor(distance * volts / range). Rather than dividing
+  // each sample, multiply by volts / range as a fixed-point number with
+  // kShift fractional bits, rounded up. With range^2 <= 2^kShift the error is
+  // below 1 / range, which is too small to change the floor, so the result is
+  // exact. kShift is as large as possible without overflowing distance *
+  // scale, since distance <= range.
+  const int shift = 63 - BitWidth(volts);
+  if (2 * BitWidth(range) <= shift) {
+    const uint64_t scale = ((volts << shift) + range - 1) / range;
+    for (size_t i = 0; i < samples.size(); ++i) {
+      const uint64_t magnitude = (distance(samples[i]) * scale) >> shift;
+      microvolts[i] = static_cast<int32_t>(references.min_voltage_uv +
+                                           sign * int64_t(magnitude));
+    }
+    return;
+  }
+
+  // Wide ADC ranges: split volts / range into a quotient and remainder so that
+  // no product overflows 64 bits, and divide each sample.
+  const uint64_t quotient = volts / range;
+  const uint64_t remainder = volts % range;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const uint64_t d = distance(samples[i]);
+    const uint64_t magnitude = d * quotient + (d * remainder) / range;
+    microvolts[i] = static_cast<int32_t>(references.min_voltage_uv +
+                                         sign * int64_t(magnitude));
+  }
+}
+
+}  // namespace pw::analog
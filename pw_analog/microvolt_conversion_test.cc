@@ -0,0 +1,130 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_analog/microvolt_conversion.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace pw::analog {
+namespace {
+
+// The per-sample conversion, which the batch conversion must match.
+int32_t Reference(AnalogInput::Limits limits,
+                  MicrovoltReferences references,
+                  int32_t sample) {
+  return static_cast<int32_t>(
+      (int64_t{sample} - limits.min) *
+          (int64_t{references.max_voltage_uv} - references.min_voltage_uv) /
+          (int64_t{limits.max} - limits.min) +
+      references.min_voltage_uv);
+}
+
+void ExpectMatchesReference(AnalogInput::Limits limits,
+                            MicrovoltReferences references) {
+  // Spread the samples over the whole range, including both ends.
+  const int64_t low = std::min(limits.min, limits.max);
+  const int64_t high = std::max(limits.min, limits.max);
+  std::array<int32_t, 1000> samples;
+  for (size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<int32_t>(low + (high - low) * int64_t(i) /
+                                                int64_t(samples.size() - 1));
+  }
+
+  std::array<int32_t, samples.size()> microvolts;
+  ConvertToMicrovolts(limits, references, samples, microvolts);
+  for (size_t i = 0; i < samples.size(); ++i) {
+    ASSERT_EQ(microvolts[i], Reference(limits, references, samples[i]));
+  }
+}
+
+TEST(ConvertToMicrovolts, Unipolar12Bit) {
+  ExpectMatchesReference({.min = 0, .max = 4095},
+                         {.max_voltage_uv = 3300000, .min_voltage_uv = 0});
+}
+
+TEST(ConvertToMicrovolts, Bipolar16Bit) {
+  ExpectMatchesReference(
+      {.min = -32768, .max = 32767},
+      {.max_voltage_uv = 5000000, .min_voltage_uv = -5000000});
+}
+
+TEST(ConvertToMicrovolts, InvertedReferences) {
+  ExpectMatchesReference({.min = 0, .max = 65535},
+                         {.max_voltage_uv = -2500000, .min_voltage_uv = 0});
+}
+
+TEST(ConvertToMicrovolts, InvertedLimits) {
+  ExpectMatchesReference({.min = 1023, .max = 0},
+                         {.max_voltage_uv = 1800000, .min_voltage_uv = 0});
+}
+
+TEST(ConvertToMicrovolts, Wide24Bit) {
+  ExpectMatchesReference(
+      {.min = -8388608, .max = 8388607},
+      {.max_voltage_uv = 2500000, .min_voltage_uv = -2500000});
+}
+
+TEST(ConvertToMicrovolts, FullRange) {
+  constexpr int32_t kMin = std::numeric_limits<int32_t>::min();
+  constexpr int32_t kMax = std::numeric_limits<int32_t>::max();
+  const std::array<int32_t, 3> samples = {kMin, 0, kMax};
+  std::array<int32_t, 3> microvolts;
+
+  ConvertToMicrovolts({.min = kMin, .max = kMax},
+                      {.max_voltage_uv = kMax, .min_voltage_uv = kMin},
+                      samples,
+                      microvolts);
+  EXPECT_EQ(microvolts[0], kMin);
+  EXPECT_EQ(microvolts[1], 0);
+  EXPECT_EQ(microvolts[2], kMax);
+
+  ConvertToMicrovolts({.min = kMin, .max = kMax},
+                      {.max_voltage_uv = kMin, .min_voltage_uv = kMax},
+                      samples,
+                      microvolts);
+  EXPECT_EQ(microvolts[0], kMax);
+  EXPECT_EQ(microvolts[1], -1);
+  EXPECT_EQ(microvolts[2], kMin);
+}
+
+TEST(ConvertToMicrovolts, ClampsOutOfRangeSamples) {
+  const std::array<int32_t, 2> samples = {-1, 4096};
+  std::array<int32_t, 2> microvolts;
+  ConvertToMicrovolts({.min = 0, .max = 4095},
+                      {.max_voltage_uv = 3300000, .min_voltage_uv = 0},
+                      samples,
+                      microvolts);
+  EXPECT_EQ(microvolts[0], 0);
+  EXPECT_EQ(microvolts[1], 3300000);
+}
+
+TEST(ConvertToMicrovolts, InPlace) {
+  std::array<int32_t, 4> samples = {0, 1024, 2048, 4096};
+  ConvertToMicrovolts({.min = 0, .max = 4096},
+                      {.max_voltage_uv = 4096000, .min_voltage_uv = 0},
+                      samples,
+                      samples);
+  EXPECT_EQ(samples[0], 0);
+  EXPECT_EQ(samples[1], 1024000);
+  EXPECT_EQ(samples[2], 2048000);
+  EXPECT_EQ(samples[3], 4096000);
+}
+
+}  // namespace
+}  // namespace pw::analog
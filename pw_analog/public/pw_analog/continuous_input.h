@@ -0,0 +1,110 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <utility>
+
+#include "pw_analog/analog_input.h"
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+
+namespace pw::analog {
+
+// Interface for ADC channels that sample continuously into memory, e.g. with a
+// timer-triggered ADC and a circular DMA transfer. This avoids a blocking call
+// per sample at high sample rates.
+//
+// The caller provides one buffer, which is used as two halves. While the ADC
+// fills one half, the caller processes the other:
+//
+//   std::array<int32_t, 2 * kBlockSize> samples;
+//   adc.Start(samples, [](std::span<const int32_t> block) {
+//     ProcessBlock(block);  // Must finish before the other half fills.
+//   });
+//
+// Implementers start the hardware in DoStart() and call HalfFull() from the
+// DMA half-transfer and transfer-complete interrupts.
+class ContinuousInput {
+ public:
+  // Called with each half of the buffer once it is full, usually from
+  // interrupt context. The samples are valid until the ADC wraps around to
+  // that half again, one half-buffer period later.
+  using Callback = Function<void(std::span<const int32_t> samples)>;
+
+  virtual ~ContinuousInput() = default;
+
+  // Starts sampling into buffer, calling on_half_full as each half fills. The
+  // buffer must remain valid until Stop() is called.
+  //
+  // Returns:
+  //   Ok: Sampling started.
+  //   InvalidArgument: The buffer is empty or has an odd number of samples.
+  //   FailedPrecondition: Sampling is already running.
+  //   Other statuses left up to the implementer.
+  Status Start(std::span<int32_t> buffer, Callback&& on_half_full) {
+    if (buffer.empty() || buffer.size() % 2 != 0) {
+      return Status::InvalidArgument();
+    }
+    if (running_) {
+      return Status::FailedPrecondition();
+    }
+    buffer_ = buffer;
+    on_half_full_ = std::move(on_half_full);
+    if (Status status = DoStart(buffer); !status.ok()) {
+      on_half_full_ = nullptr;
+      return status;
+    }
+    running_ = true;
+    return OkStatus();
+  }
+
+  // Stops sampling. No callbacks are made once this returns.
+  void Stop() {
+    if (!running_) {
+      return;
+    }
+    DoStop();
+    running_ = false;
+    on_half_full_ = nullptr;
+  }
+
+  bool running() const { return running_; }
+
+  // Returns the range of the ADC samples.
+  // These values do not change at run time.
+  virtual AnalogInput::Limits GetLimits() const = 0;
+
+ protected:
+  // Called by the implementer when half 0 (the first half) or half 1 of the
+  // buffer has been filled.
+  void HalfFull(int half) {
+    const size_t half_size = buffer_.size() / 2;
+    on_half_full_(buffer_.subspan(half == 0 ? 0 : half_size, half_size));
+  }
+
+ private:
+  // Starts continuous sampling into buffer, wrapping around at its end.
+  virtual Status DoStart(std::span<int32_t> buffer) = 0;
+
+  // Stops sampling and disables the interrupts that call HalfFull().
+  virtual void DoStop() = 0;
+
+  std::span<int32_t> buffer_;
+  Callback on_half_full_;
+  bool running_ = false;
+};
+
+}  // namespace pw::analog
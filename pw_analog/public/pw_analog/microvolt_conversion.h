@@ -0,0 +1,45 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "pw_analog/analog_input.h"
+
+namespace pw::analog {
+
+// Specifies the max and min microvolt range of an analog input.
+// * Inversion of min/max is supported.
+struct MicrovoltReferences {
+  int32_t max_voltage_uv;  // Microvolts at AnalogInput::Limits::max
+  int32_t min_voltage_uv;  // Microvolts at AnalogInput::Limits::min.
+};
+
+// Converts a block of ADC samples to microvolts, using the same linear mapping
+// as MicrovoltInput. microvolts must be at least as large as samples, and may
+// be the same span to convert in place. Samples outside the limits are clamped.
+//
+// The scaling factor is computed once per call, so each sample costs a
+// multiply and a shift rather than a 64-bit division. The loop has no branches
+// and may be vectorized by the compiler. The results are still exact: the same
+// as converting each sample with a 64-bit division, rounded toward zero. For
+// ADCs whose range is too wide for the fixed-point factor to be exact (roughly
+// 20 bits or more, depending on the voltage range), each sample is divided.
+void ConvertToMicrovolts(AnalogInput::Limits limits,
+                         MicrovoltReferences references,
+                         std::span<const int32_t> samples,
+                         std::span<int32_t> microvolts);
+
+}  // namespace pw::analog
@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 #include "pw_analog/analog_input.h"
+#include "pw_analog/microvolt_conversion.h"
 #include "pw_chrono/system_clock.h"
 #include "pw_result/result.h"
 #include "pw_status/try.h"
@@ -31,10 +32,7 @@ class MicrovoltInput : public AnalogInput {
   // Specifies the max and min microvolt range the analog input can measure.
   // * These values do not change at run time.
   // * Inversion of min/max is supported.
-  struct References {
-    int32_t max_voltage_uv;  // Microvolts at AnalogInput::Limits::max
-    int32_t min_voltage_uv;  // Microvolts at AnalogInput::Limits::min.
-  };
+  using References = MicrovoltReferences;
 
   virtual ~MicrovoltInput() = default;
 
@@ -0,0 +1,28 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// The PW_ASSERT handler, which is kept apart from the PW_CHECK handler so that
+// tests can use the PW_CHECK handler alongside another assert backend.
+
+#include "pw_assert/options.h"
+#include "pw_assert_tokenized/assert_tokenized.h"
+#include "pw_assert_tokenized/handler.h"
+
+extern "C" void pw_assert_HandleFailure(void) {
+#if PW_ASSERT_ENABLE_DEBUG
+  PW_HANDLE_CRASH("PW_ASSERT() or PW_DASSERT() failure");
+#else
+  PW_HANDLE_CRASH("PW_ASSERT() failure. Note: PW_DASSERT disabled");
+#endif  // PW_ASSERT_ENABLE_DEBUG
+}
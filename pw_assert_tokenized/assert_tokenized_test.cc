@@ -0,0 +1,122 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_assert_tokenized/assert_tokenized.h"
+
+#include <csetjmp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "pw_assert/internal/check_impl.h"
+#include "pw_assert_tokenized/handler.h"
+#include "pw_tokenizer/hash.h"
+
+namespace pw::assert_tokenized {
+namespace {
+
+std::jmp_buf return_from_failure;
+uint8_t last_message[64];
+size_t last_message_size;
+
+}  // namespace
+}  // namespace pw::assert_tokenized
+
+// Captures the encoded message and returns to the test instead of crashing.
+extern "C" void pw_assert_tokenized_HandleEncodedFailure(
+    const uint8_t encoded_message[], size_t size_bytes) {
+  using namespace pw::assert_tokenized;
+  last_message_size = std::min(size_bytes, sizeof(last_message));
+  std::memcpy(last_message, encoded_message, last_message_size);
+  std::longjmp(return_from_failure, 1);
+}
+
+namespace pw::assert_tokenized {
+namespace {
+
+// Runs the function and returns true if it failed an assertion.
+template <typename Function>
+bool Fails(Function function) {
+  last_message_size = 0;
+  if (setjmp(return_from_failure) == 0) {
+    function();
+    return false;
+  }
+  return true;
+}
+
+uint32_t TokenFor(int line, const char* message) {
+  return tokenizer::Hash(std::string(__FILE__) + ":" + std::to_string(line) +
+                         ": " + message);
+}
+
+uint32_t LastToken() {
+  uint32_t token;
+  std::memcpy(&token, last_message, sizeof(token));
+  return token;
+}
+
+TEST(AssertTokenized, PassingChecksDoNotCallHandler) {
+  int five = 5;
+  EXPECT_FALSE(Fails([&] { PW_CHECK(five == 5); }));
+  EXPECT_FALSE(Fails([&] { PW_CHECK_INT_GT(five, 3); }));
+  EXPECT_EQ(last_message_size, 0u);
+}
+
+TEST(AssertTokenized, Crash) {
+  // clang-format off
+  const int line = __LINE__; EXPECT_TRUE(Fails([] { PW_CRASH("Oh no"); }));
+  // clang-format on
+  ASSERT_EQ(last_message_size, sizeof(uint32_t));
+  EXPECT_EQ(LastToken(), TokenFor(line, "Crash: Oh no"));
+}
+
+TEST(AssertTokenized, CheckWithArguments) {
+  int value = -1;
+  // clang-format off
+  const int line = __LINE__; const bool failed = Fails([&] { PW_CHECK(value > 0, "value=%d", value); });
+  // clang-format on
+  EXPECT_TRUE(failed);
+  ASSERT_EQ(last_message_size, sizeof(uint32_t) + 1);
+  EXPECT_EQ(LastToken(),
+            TokenFor(line, "Check failed: value > 0. value=%d"));
+  EXPECT_EQ(last_message[4], 0x01);  // ZigZag encoded -1
+}
+
+TEST(AssertTokenized, BinaryCompareEncodesBothValues) {
+  int five = 5;
+  // clang-format off
+  const int line = __LINE__; EXPECT_TRUE(Fails([&] { PW_CHECK_INT_LE(five, 3); }));
+  // clang-format on
+  ASSERT_EQ(last_message_size, sizeof(uint32_t) + 2);
+  EXPECT_EQ(LastToken(),
+            TokenFor(line, "Check failed: five (=%d) <= 3 (=%d). "));
+  EXPECT_EQ(last_message[4], 0x0a);  // ZigZag encoded 5
+  EXPECT_EQ(last_message[5], 0x06);  // ZigZag encoded 3
+}
+
+TEST(AssertTokenized, BinaryCompareWithMessageArguments) {
+  unsigned size = 10;
+  const bool failed =
+      Fails([&] { PW_CHECK_UINT_LT(size, 4u, "too big by %u", size - 4); });
+  EXPECT_TRUE(failed);
+  ASSERT_EQ(last_message_size, sizeof(uint32_t) + 3);
+  EXPECT_EQ(last_message[4], 20);
+  EXPECT_EQ(last_message[5], 8);
+  EXPECT_EQ(last_message[6], 12);
+}
+
+}  // namespace
+}  // namespace pw::assert_tokenized
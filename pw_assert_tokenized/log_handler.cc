@@ -0,0 +1,37 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// A pw_assert_tokenized handler that logs the tokenized failure message as
+// Base64, then aborts.
+
+#include <cstdlib>
+#include <span>
+
+#include "pw_assert_tokenized/handler.h"
+#include "pw_log/log.h"
+#include "pw_tokenizer/base64.h"
+
+extern "C" void pw_assert_tokenized_HandleEncodedFailure(
+    const uint8_t encoded_message[], size_t size_bytes) {
+  char base64[pw::tokenizer::kDefaultBase64EncodedBufferSize];
+  const size_t base64_size = pw::tokenizer::PrefixedBase64Encode(
+      std::span(encoded_message, size_bytes), base64);
+
+  PW_LOG(PW_LOG_LEVEL_FATAL,
+         PW_LOG_DEFAULT_FLAGS,
+         "%.*s",
+         static_cast<int>(base64_size),
+         base64);
+  std::abort();
+}
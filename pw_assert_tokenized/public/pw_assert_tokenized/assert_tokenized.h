@@ -0,0 +1,80 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <stdint.h>
+
+#include "pw_preprocessor/arguments.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_preprocessor/util.h"
+#include "pw_tokenizer/tokenize.h"
+
+// Each failure message is tokenized along with the file and line, so no strings
+// are stored in the binary. The failure path at each check is one call to a
+// cold, non-returning function with the token and the values to report.
+//
+// Sample assert failure message, once detokenized:
+//
+//   foo.cc:25: Check failed: old_x (=610) < new_x (=50). Details: foo=10, bar.
+
+PW_EXTERN_C_START
+
+// Encodes the arguments of a failed check and passes the tokenized message to
+// pw_assert_tokenized_HandleEncodedFailure(). This is called by the macros
+// below; do not call it directly.
+void _pw_assert_tokenized_HandleFailure(pw_tokenizer_Token token,
+                                        pw_tokenizer_ArgTypes types,
+                                        ...) PW_NO_RETURN PW_COLD;
+
+PW_EXTERN_C_END
+
+#define _PW_ASSERT_TOKENIZED_LOCATION __FILE__ ":" PW_STRINGIFY(__LINE__) ": "
+
+#define _PW_ASSERT_TOKENIZED_FAILURE(format, ...)                           \
+  do {                                                                      \
+    PW_TOKENIZE_FORMAT_STRING(                                              \
+        PW_TOKENIZER_DEFAULT_DOMAIN, UINT32_MAX, format, __VA_ARGS__);      \
+    _pw_assert_tokenized_HandleFailure(                                     \
+        _pw_tokenizer_token,                                                \
+        PW_TOKENIZER_ARG_TYPES(__VA_ARGS__) PW_COMMA_ARGS(__VA_ARGS__));    \
+  } while (0)
+
+#define PW_HANDLE_CRASH(message, ...)                                  \
+  _PW_ASSERT_TOKENIZED_FAILURE(                                        \
+      _PW_ASSERT_TOKENIZED_LOCATION "Crash: " message, __VA_ARGS__)
+
+#define PW_HANDLE_ASSERT_FAILURE(condition_string, message, ...)        \
+  _PW_ASSERT_TOKENIZED_FAILURE(_PW_ASSERT_TOKENIZED_LOCATION            \
+                               "Check failed: " condition_string ". " \
+                               message,                               \
+                               __VA_ARGS__)
+
+// clang-format off
+// This is too hairy for clang format to handle and retain readability.
+#define PW_HANDLE_ASSERT_BINARY_COMPARE_FAILURE(arg_a_str,         \
+                                                arg_a_val,         \
+                                                comparison_op_str, \
+                                                arg_b_str,         \
+                                                arg_b_val,         \
+                                                type_fmt,          \
+                                                message, ...)      \
+  _PW_ASSERT_TOKENIZED_FAILURE(                                    \
+      _PW_ASSERT_TOKENIZED_LOCATION                                \
+          "Check failed: "                                         \
+          arg_a_str " (=" type_fmt ") "                            \
+          comparison_op_str " "                                    \
+          arg_b_str " (=" type_fmt ")"                             \
+          ". " message,                                            \
+      arg_a_val, arg_b_val PW_COMMA_ARGS(__VA_ARGS__))
+// clang-format on
@@ -0,0 +1,34 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pw_preprocessor/compiler.h"
+#include "pw_preprocessor/util.h"
+
+PW_EXTERN_C_START
+
+// Handles a failed check or crash. encoded_message is a tokenized message: the
+// 4-byte token of the failure message, followed by its encoded arguments. The
+// message can be stored or sent as is, or Base64 encoded and logged; either
+// way, it is detokenized off the device.
+//
+// This function is provided by the pw_assert_tokenized_HANDLER_BACKEND. It must
+// not return.
+void pw_assert_tokenized_HandleEncodedFailure(const uint8_t encoded_message[],
+                                              size_t size_bytes) PW_NO_RETURN;
+
+PW_EXTERN_C_END
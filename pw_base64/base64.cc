@@ -14,7 +14,11 @@
 
 #include "pw_base64/base64.h"
 
+#include <array>
 #include <cstdint>
+#include <cstring>
+
+#include "pw_base64/config.h"
 
 namespace pw::base64 {
 namespace {
@@ -46,37 +50,101 @@ constexpr char BitGroup3Char(uint8_t byte2) {
   return encode_bits[byte2 & 0b00111111];
 }
 
+#if PW_BASE64_CFG_ENCODE_WITH_PAIR_TABLE
+
+// Table that encodes a 12-bit pattern as a pair of Base64 characters, so a
+// 3-byte group is encoded with two lookups.
+constexpr std::array<char, 2 * 4096> MakePairTable() {
+  std::array<char, 2 * 4096> pairs{};
+  for (size_t bits = 0; bits < 4096u; ++bits) {
+    pairs[2 * bits] = encode_bits[bits >> 6];
+    pairs[2 * bits + 1] = encode_bits[bits & 0b111111];
+  }
+  return pairs;
+}
+
+constexpr std::array<char, 2 * 4096> encode_pairs = MakePairTable();
+
+void EncodeGroup(const uint8_t* bytes, char* output) {
+  const uint32_t group = uint32_t(bytes[0]) << 16 | uint32_t(bytes[1]) << 8 |
+                         uint32_t(bytes[2]);
+  std::memcpy(&output[0], &encode_pairs[2 * (group >> 12)], 2);
+  std::memcpy(&output[2], &encode_pairs[2 * (group & 0xfff)], 2);
+}
+
+#else
+
+void EncodeGroup(const uint8_t* bytes, char* output) {
+  output[0] = BitGroup0Char(bytes[0]);
+  output[1] = BitGroup1Char(bytes[0], bytes[1]);
+  output[2] = BitGroup2Char(bytes[1], bytes[2]);
+  output[3] = BitGroup3Char(bytes[2]);
+}
+
+#endif  // PW_BASE64_CFG_ENCODE_WITH_PAIR_TABLE
+
 // Decoding functions
-constexpr char kMinValidChar = '+';
-constexpr char kMaxValidChar = 'z';
 constexpr uint8_t kX = 0xff;  // Value used for invalid characters
 
 // Table that decodes a Base64 character to its 6-bit value. Supports the
-// standard (+/) and URL-safe (-_) alphabets. Starts from the lowest-value valid
-// character, which is +.
-constexpr uint8_t decode_char[] = {
-    62, kX, 62, kX, 63, 52, 53, 54, 55, 56,  //  0 - 09
-    57, 58, 59, 60, 61, kX, kX, kX, 0,  kX,  // 10 - 19
-    kX, kX, 0,  1,  2,  3,  4,  5,  6,  7,   // 20 - 29
-    8,  9,  10, 11, 12, 13, 14, 15, 16, 17,  // 30 - 39
-    18, 19, 20, 21, 22, 23, 24, 25, kX, kX,  // 40 - 49
-    kX, kX, 63, kX, 26, 27, 28, 29, 30, 31,  // 50 - 59
-    32, 33, 34, 35, 36, 37, 38, 39, 40, 41,  // 60 - 69
-    42, 43, 44, 45, 46, 47, 48, 49, 50, 51,  // 70 - 79
-};
+// standard (+/) and URL-safe (-_) alphabets. The table covers every character
+// value, so characters are decoded and validated with a single lookup. All
+// invalid characters decode to kX, which has its high bit set.
+constexpr std::array<uint8_t, 256> MakeDecodeTable() {
+  std::array<uint8_t, 256> table{};
+  for (uint8_t& value : table) {
+    value = kX;
+  }
+  for (uint8_t bits = 0; bits < 64u; ++bits) {
+    table[static_cast<uint8_t>(encode_bits[bits])] = bits;
+  }
+  table['-'] = 62;
+  table['_'] = 63;
+  table[static_cast<uint8_t>(kPadding)] = 0;  // Padding decodes to 0 bits.
+  return table;
+}
+
+constexpr std::array<uint8_t, 256> decode_char = MakeDecodeTable();
 
 constexpr uint8_t CharToBits(char ch) {
-  return decode_char[ch - kMinValidChar];
+  return decode_char[static_cast<uint8_t>(ch)];
 }
 
-constexpr uint8_t Byte0(uint8_t bits0, uint8_t bits1) {
-  return (bits0 << 2) | ((bits1 & 0b110000) >> 4);
-}
-constexpr uint8_t Byte1(uint8_t bits1, uint8_t bits2) {
-  return ((bits1 & 0b001111) << 4) | ((bits2 & 0b111100) >> 2);
+// Decodes 4-character groups to 3-byte groups. If kValidate is true, returns
+// false if any character is invalid; the output is still written.
+template <bool kValidate>
+bool DecodeGroups(const char* base64, size_t groups, uint8_t* binary) {
+  uint8_t invalid = 0;
+
+  for (size_t i = 0; i < groups; ++i, base64 += 4, binary += 3) {
+    const uint8_t bits0 = CharToBits(base64[0]);
+    const uint8_t bits1 = CharToBits(base64[1]);
+    const uint8_t bits2 = CharToBits(base64[2]);
+    const uint8_t bits3 = CharToBits(base64[3]);
+
+    if constexpr (kValidate) {
+      invalid |= bits0 | bits1 | bits2 | bits3;
+    }
+
+    const uint32_t group = uint32_t(bits0) << 18 | uint32_t(bits1) << 12 |
+                           uint32_t(bits2) << 6 | uint32_t(bits3);
+    binary[0] = static_cast<uint8_t>(group >> 16);
+    binary[1] = static_cast<uint8_t>(group >> 8);
+    binary[2] = static_cast<uint8_t>(group);
+  }
+
+  // Valid characters are 6 bits, so any high bit indicates an invalid one.
+  return (invalid & 0b11000000) == 0u;
 }
-constexpr uint8_t Byte2(uint8_t bits2, uint8_t bits3) {
-  return ((bits2 & 0b000011) << 6) | bits3;
+
+size_t DecodedSize(const char* base64, size_t base64_size_bytes) {
+  size_t pad = 0;
+  if (base64[base64_size_bytes - 2] == kPadding) {
+    pad = 2;
+  } else if (base64[base64_size_bytes - 1] == kPadding) {
+    pad = 1;
+  }
+  return base64_size_bytes / kEncodedGroupSize * 3 - pad;
 }
 
 }  // namespace
@@ -88,11 +156,8 @@ extern "C" void pw_Base64Encode(const void* binary_data,
 
   // Encode groups of 3 source bytes into 4 output characters.
   size_t remaining = binary_size_bytes;
-  for (; remaining >= 3u; remaining -= 3u, bytes += 3) {
-    *output++ = BitGroup0Char(bytes[0]);
-    *output++ = BitGroup1Char(bytes[0], bytes[1]);
-    *output++ = BitGroup2Char(bytes[1], bytes[2]);
-    *output++ = BitGroup3Char(bytes[2]);
+  for (; remaining >= 3u; remaining -= 3u, bytes += 3, output += 4) {
+    EncodeGroup(bytes, output);
   }
 
   // If the source data length isn't a multiple of 3, pad the end with either 1
@@ -118,26 +183,10 @@ extern "C" size_t pw_Base64Decode(const char* base64,
     return 0;
   }
 
-  uint8_t* binary = static_cast<uint8_t*>(output);
-  for (size_t ch = 0; ch < base64_size_bytes; ch += kEncodedGroupSize) {
-    const uint8_t char0 = CharToBits(base64[ch + 0]);
-    const uint8_t char1 = CharToBits(base64[ch + 1]);
-    const uint8_t char2 = CharToBits(base64[ch + 2]);
-    const uint8_t char3 = CharToBits(base64[ch + 3]);
-
-    *binary++ = Byte0(char0, char1);
-    *binary++ = Byte1(char1, char2);
-    *binary++ = Byte2(char2, char3);
-  }
-
-  size_t pad = 0;
-  if (base64[base64_size_bytes - 2] == kPadding) {
-    pad = 2;
-  } else if (base64[base64_size_bytes - 1] == kPadding) {
-    pad = 1;
-  }
-
-  return binary - static_cast<uint8_t*>(output) - pad;
+  DecodeGroups<false>(base64,
+                      base64_size_bytes / kEncodedGroupSize,
+                      static_cast<uint8_t*>(output));
+  return DecodedSize(base64, base64_size_bytes);
 }
 
 extern "C" bool pw_Base64IsValid(const char* base64_data, size_t base64_size) {
@@ -146,8 +195,7 @@ extern "C" bool pw_Base64IsValid(const char* base64_data, size_t base64_size) {
   }
 
   for (size_t i = 0; i < base64_size; ++i) {
-    if (base64_data[i] < kMinValidChar || base64_data[i] > kMaxValidChar ||
-        CharToBits(base64_data[i]) == kX /* invalid char */) {
+    if (CharToBits(base64_data[i]) == kX) {
       return false;
     }
   }
@@ -166,10 +214,18 @@ size_t Encode(std::span<const std::byte> binary,
 
 size_t Decode(std::string_view base64, std::span<std::byte> output_buffer) {
   if (output_buffer.size_bytes() < MaxDecodedSize(base64.size()) ||
-      !IsValid(base64)) {
+      base64.size() % kEncodedGroupSize != 0u || base64.empty()) {
+    return 0;
+  }
+
+  // Validate while decoding, rather than checking the input separately first.
+  // Invalid data is decoded into the output buffer, but 0 is returned.
+  if (!DecodeGroups<true>(base64.data(),
+                          base64.size() / kEncodedGroupSize,
+                          reinterpret_cast<uint8_t*>(output_buffer.data()))) {
     return 0;
   }
-  return Decode(base64, output_buffer.data());
+  return DecodedSize(base64.data(), base64.size());
 }
 
 }  // namespace pw::base64
@@ -342,6 +342,18 @@ TEST(Base64, Decode_BoundaryCheck) {
   EXPECT_STREQ("hi", reinterpret_cast<const char*>(output));
 }
 
+TEST(Base64, Decode_InvalidCharacters) {
+  std::byte output[6] = {};
+
+  EXPECT_EQ(0u, Decode("aGk#", std::span(output)));
+  EXPECT_EQ(0u, Decode("aGk=aG~=", std::span(output)));
+  EXPECT_EQ(0u, Decode("a Gk", std::span(output)));
+  EXPECT_EQ(0u, Decode("aGk\x80", std::span(output)));
+  EXPECT_EQ(0u, Decode("\xffGk=", std::span(output)));
+  EXPECT_EQ(0u, Decode("aGk=aGk", std::span(output)));  // incorrect size
+  EXPECT_EQ(2u, Decode("aGk=", std::span(output)));
+}
+
 TEST(Base64, Decode_InPlace) {
   constexpr const char expected[] = "This is a secret message";
   char buf[] = "VGhpcyBpcyBhIHNlY3JldCBtZXNzYWdl";
@@ -461,6 +473,15 @@ TEST(Base64, IsValid_InvalidCharacters) {
   EXPECT_FALSE(IsValid(std::string_view(kBase64, 12)));
 }
 
+TEST(Base64, IsValid_CharactersOutsideAlphabetRange) {
+  EXPECT_FALSE(IsValid("aaa "));
+  EXPECT_FALSE(IsValid("aaa{"));
+  EXPECT_FALSE(IsValid("aaa\x7f"));
+  EXPECT_FALSE(IsValid("aaa\x80"));
+  EXPECT_FALSE(IsValid("aaa\xff"));
+  EXPECT_FALSE(IsValid(std::string_view("aaa\0", 4)));
+}
+
 TEST(Base64CLinkage, IsValid_Ok) {
   EXPECT_TRUE(pw_Base64CallIsValid(kBase64, 4));
   EXPECT_TRUE(pw_Base64CallIsValid(kBase64, 8));
@@ -115,7 +115,8 @@ inline size_t Decode(std::string_view base64, void* output) {
 
 // Decodes the provided Base64 data, if the data is valid and fits in the output
 // buffer. Returns the number of bytes written, which will be 0 if the data is
-// invalid or doesn't fit.
+// invalid or doesn't fit. The data is validated as it is decoded, so the output
+// buffer may be modified even if the data turns out to be invalid.
 size_t Decode(std::string_view base64, std::span<std::byte> output_buffer);
 
 // Returns true if the provided string is valid Base64 encoded data. Accepts
@@ -0,0 +1,24 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the pw_base64 module.
+#pragma once
+
+// If true, Base64 encoding uses a table of Base64 character pairs for every
+// 12-bit pattern, so each 3-byte group is encoded with two lookups instead of
+// four. This encodes faster but adds 8 KB of read-only data. The output is
+// identical either way.
+#ifndef PW_BASE64_CFG_ENCODE_WITH_PAIR_TABLE
+#define PW_BASE64_CFG_ENCODE_WITH_PAIR_TABLE 0
+#endif  // PW_BASE64_CFG_ENCODE_WITH_PAIR_TABLE
@@ -0,0 +1,98 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Stream adapters that Base64 encode or decode data as it passes through them.
+// Data is processed incrementally, so large blobs can be encoded or decoded
+// without buffering the entire input or output.
+//
+//   pw::base64::Base64EncodingWriter base64(console_writer);
+//   PW_TRY(base64.Write(crash_dump_chunk_1));
+//   PW_TRY(base64.Write(crash_dump_chunk_2));
+//   PW_TRY(base64.Finish());
+//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::base64 {
+
+// Writer that Base64 encodes data and writes it to another Writer. Up to two
+// bytes that do not complete a 3-byte group are held between calls to Write.
+// Call Finish to write the final, padded group.
+//
+// A Write that fails may have written some of its data to the output.
+class Base64EncodingWriter final : public stream::Writer {
+ public:
+  constexpr Base64EncodingWriter(stream::Writer& output)
+      : output_(output), leftover_{}, leftover_size_(0) {}
+
+  // Encodes any bytes held from previous calls to Write with padding and
+  // writes them to the output. The writer may then be used to start a new
+  // Base64 message.
+  Status Finish();
+
+  size_t ConservativeWriteLimit() const override;
+
+ private:
+  Status DoWrite(ConstByteSpan data) override;
+
+  stream::Writer& output_;
+  std::array<std::byte, 2> leftover_;
+  uint8_t leftover_size_;
+};
+
+// Reader that reads Base64 text from another Reader and decodes it. Up to three
+// characters that do not complete a 4-character group and up to two decoded
+// bytes that did not fit in the caller's buffer are held between calls to Read.
+// The underlying reader is never read beyond what is needed to fill the
+// caller's buffer.
+//
+// In addition to the errors returned by the underlying reader, Read returns
+// DATA_LOSS if the text is not valid Base64 or if the input ends partway
+// through a 4-character group.
+class Base64DecodingReader final : public stream::Reader {
+ public:
+  constexpr Base64DecodingReader(stream::Reader& input)
+      : input_(input),
+        pending_{},
+        pending_size_(0),
+        leftover_{},
+        leftover_offset_(0),
+        leftover_size_(0) {}
+
+  size_t ConservativeReadLimit() const override;
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override;
+
+  stream::Reader& input_;
+
+  // Characters read from the input that do not yet form a complete group.
+  std::array<char, 3> pending_;
+  uint8_t pending_size_;
+
+  // Bytes from the last decoded group that did not fit in the read buffer.
+  std::array<std::byte, 3> leftover_;
+  uint8_t leftover_offset_;
+  uint8_t leftover_size_;
+};
+
+}  // namespace pw::base64
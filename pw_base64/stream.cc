@@ -0,0 +1,182 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_base64/stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+#include "pw_base64/base64.h"
+#include "pw_status/try.h"
+
+namespace pw::base64 {
+namespace {
+
+constexpr size_t kGroupSizeBytes = 3;
+constexpr size_t kEncodedGroupSize = 4;
+
+// Data is encoded and decoded through a stack buffer of this many characters.
+constexpr size_t kChunkSizeChars = 16 * kEncodedGroupSize;
+
+}  // namespace
+
+Status Base64EncodingWriter::DoWrite(ConstByteSpan data) {
+  std::array<char, kChunkSizeChars> chunk;
+  size_t encoded = 0;
+
+  // Complete the group started by a previous write, if there is one.
+  if (leftover_size_ != 0u) {
+    const size_t copied =
+        std::min(kGroupSizeBytes - leftover_size_, data.size());
+
+    if (leftover_size_ + copied < kGroupSizeBytes) {
+      std::memcpy(&leftover_[leftover_size_], data.data(), copied);
+      leftover_size_ += copied;
+      return OkStatus();
+    }
+
+    std::array<std::byte, kGroupSizeBytes> group;
+    std::memcpy(group.data(), leftover_.data(), leftover_size_);
+    std::memcpy(&group[leftover_size_], data.data(), copied);
+    Encode(group, chunk.data());
+
+    encoded = kEncodedGroupSize;
+    data = data.subspan(copied);
+    leftover_size_ = 0;
+  }
+
+  while (data.size() >= kGroupSizeBytes) {
+    const size_t groups =
+        std::min(data.size() / kGroupSizeBytes,
+                 (chunk.size() - encoded) / kEncodedGroupSize);
+    Encode(data.first(groups * kGroupSizeBytes), &chunk[encoded]);
+
+    encoded += groups * kEncodedGroupSize;
+    data = data.subspan(groups * kGroupSizeBytes);
+
+    if (encoded == chunk.size()) {
+      PW_TRY(output_.Write(chunk.data(), encoded));
+      encoded = 0;
+    }
+  }
+
+  if (encoded != 0u) {
+    PW_TRY(output_.Write(chunk.data(), encoded));
+  }
+
+  std::memcpy(leftover_.data(), data.data(), data.size());
+  leftover_size_ = data.size();
+  return OkStatus();
+}
+
+Status Base64EncodingWriter::Finish() {
+  if (leftover_size_ == 0u) {
+    return OkStatus();
+  }
+
+  std::array<char, kEncodedGroupSize> group;
+  Encode(std::span(leftover_.data(), leftover_size_), group.data());
+  leftover_size_ = 0;
+
+  return output_.Write(group.data(), group.size());
+}
+
+size_t Base64EncodingWriter::ConservativeWriteLimit() const {
+  const size_t limit = output_.ConservativeWriteLimit();
+  if (limit == std::numeric_limits<size_t>::max()) {
+    return limit;
+  }
+
+  const size_t bytes = limit / kEncodedGroupSize * kGroupSizeBytes;
+  return bytes > leftover_size_ ? bytes - leftover_size_ : 0;
+}
+
+StatusWithSize Base64DecodingReader::DoRead(ByteSpan dest) {
+  size_t written = std::min<size_t>(leftover_size_, dest.size());
+  std::memcpy(dest.data(), &leftover_[leftover_offset_], written);
+  leftover_offset_ += written;
+  leftover_size_ -= written;
+
+  std::array<char, kChunkSizeChars> chunk;
+
+  while (written < dest.size()) {
+    // Only read as many characters as are needed to fill dest, so that no more
+    // than 2 decoded bytes are left over.
+    const size_t groups_needed =
+        (dest.size() - written + kGroupSizeBytes - 1) / kGroupSizeBytes;
+    const size_t to_read =
+        std::min(groups_needed * kEncodedGroupSize, chunk.size()) -
+        pending_size_;
+
+    std::memcpy(chunk.data(), pending_.data(), pending_size_);
+    const Result<ByteSpan> read = input_.Read(&chunk[pending_size_], to_read);
+
+    if (!read.ok()) {
+      if (written != 0u) {
+        break;  // Return what was decoded; the error is reported next time.
+      }
+      if (read.status().IsOutOfRange() && pending_size_ != 0u) {
+        return StatusWithSize::DataLoss();  // The input ended mid-group.
+      }
+      return StatusWithSize(read.status(), 0);
+    }
+
+    const size_t chars = pending_size_ + read.value().size();
+    const size_t groups = chars / kEncodedGroupSize;
+    const std::string_view text(chunk.data(), groups * kEncodedGroupSize);
+
+    pending_size_ = chars % kEncodedGroupSize;
+    std::memcpy(pending_.data(), &chunk[text.size()], pending_size_);
+
+    if (!IsValid(text)) {
+      return StatusWithSize::DataLoss();
+    }
+
+    for (size_t i = 0; i < text.size(); i += kEncodedGroupSize) {
+      const std::string_view group = text.substr(i, kEncodedGroupSize);
+
+      // Decode directly into dest if the group fits; otherwise, save the bytes
+      // that do not fit for the next read.
+      if (dest.size() - written >= kGroupSizeBytes) {
+        written += Decode(group, &dest[written]);
+        continue;
+      }
+
+      const size_t decoded = Decode(group, leftover_.data());
+      const size_t copied = std::min(decoded, dest.size() - written);
+      std::memcpy(&dest[written], leftover_.data(), copied);
+      written += copied;
+      leftover_offset_ = copied;
+      leftover_size_ = decoded - copied;
+    }
+  }
+
+  return StatusWithSize(written);
+}
+
+size_t Base64DecodingReader::ConservativeReadLimit() const {
+  const size_t limit = input_.ConservativeReadLimit();
+  if (limit == std::numeric_limits<size_t>::max()) {
+    return limit;
+  }
+
+  // Padding may make the decoded data up to 2 bytes shorter.
+  const size_t groups = (pending_size_ + limit) / kEncodedGroupSize;
+  const size_t bytes = groups * kGroupSizeBytes;
+  return leftover_size_ + (bytes > 2u ? bytes - 2u : 0u);
+}
+
+}  // namespace pw::base64
@@ -0,0 +1,245 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_base64/stream.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_base64/base64.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::base64 {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+std::string_view AsString(ConstByteSpan data) {
+  return std::string_view(reinterpret_cast<const char*>(data.data()),
+                          data.size());
+}
+
+ConstByteSpan AsBytes(std::string_view text) {
+  return std::as_bytes(std::span(text));
+}
+
+// Binary data that is larger than the adapters' internal buffers.
+constexpr auto kBinary = [] {
+  std::array<std::byte, 200> data{};
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::byte(i * 37 + 11);
+  }
+  return data;
+}();
+
+// Reader that returns at most max_read bytes from its source per call.
+class TrickleReader final : public stream::Reader {
+ public:
+  TrickleReader(std::string_view source, size_t max_read)
+      : source_(source), max_read_(max_read) {}
+
+  size_t bytes_read() const { return bytes_read_; }
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    if (bytes_read_ == source_.size()) {
+      return StatusWithSize::OutOfRange();
+    }
+    const size_t size =
+        std::min({dest.size(), max_read_, source_.size() - bytes_read_});
+    std::memcpy(dest.data(), &source_[bytes_read_], size);
+    bytes_read_ += size;
+    return StatusWithSize(size);
+  }
+
+  std::string_view source_;
+  size_t max_read_;
+  size_t bytes_read_ = 0;
+};
+
+TEST(Base64EncodingWriter, SingleWrite) {
+  stream::MemoryWriterBuffer<64> output;
+  Base64EncodingWriter writer(output);
+
+  ASSERT_EQ(OkStatus(), writer.Write(AsBytes("Hello")));
+  EXPECT_EQ("SGVs"sv, AsString(output.WrittenData()));
+
+  ASSERT_EQ(OkStatus(), writer.Finish());
+  EXPECT_EQ("SGVsbG8="sv, AsString(output.WrittenData()));
+}
+
+TEST(Base64EncodingWriter, Finish_NothingLeftOver_WritesNothing) {
+  stream::MemoryWriterBuffer<64> output;
+  Base64EncodingWriter writer(output);
+
+  ASSERT_EQ(OkStatus(), writer.Write(AsBytes("abc")));
+  ASSERT_EQ(OkStatus(), writer.Finish());
+  EXPECT_EQ("YWJj"sv, AsString(output.WrittenData()));
+}
+
+TEST(Base64EncodingWriter, ByteAtATime_MatchesEncode) {
+  stream::MemoryWriterBuffer<EncodedSize(kBinary.size())> output;
+  Base64EncodingWriter writer(output);
+
+  for (std::byte b : kBinary) {
+    ASSERT_EQ(OkStatus(), writer.Write(b));
+  }
+  ASSERT_EQ(OkStatus(), writer.Finish());
+
+  std::array<char, EncodedSize(kBinary.size())> expected;
+  Encode(kBinary, expected.data());
+  EXPECT_EQ(std::string_view(expected.data(), expected.size()),
+            AsString(output.WrittenData()));
+}
+
+TEST(Base64EncodingWriter, VaryingWriteSizes_MatchesEncode) {
+  for (size_t write_size = 1; write_size <= kBinary.size(); ++write_size) {
+    stream::MemoryWriterBuffer<EncodedSize(kBinary.size())> output;
+    Base64EncodingWriter writer(output);
+
+    for (size_t i = 0; i < kBinary.size(); i += write_size) {
+      ASSERT_EQ(OkStatus(),
+                writer.Write(std::span(kBinary).subspan(
+                    i, std::min(write_size, kBinary.size() - i))));
+    }
+    ASSERT_EQ(OkStatus(), writer.Finish());
+
+    std::array<char, EncodedSize(kBinary.size())> expected;
+    Encode(kBinary, expected.data());
+    ASSERT_EQ(std::string_view(expected.data(), expected.size()),
+              AsString(output.WrittenData()));
+  }
+}
+
+TEST(Base64EncodingWriter, OutputFull_ReturnsError) {
+  stream::MemoryWriterBuffer<3> output;
+  Base64EncodingWriter writer(output);
+
+  EXPECT_EQ(0u, writer.ConservativeWriteLimit());
+  EXPECT_EQ(Status::ResourceExhausted(), writer.Write(AsBytes("abc")));
+}
+
+TEST(Base64EncodingWriter, ConservativeWriteLimit) {
+  stream::MemoryWriterBuffer<9> output;
+  Base64EncodingWriter writer(output);
+
+  EXPECT_EQ(6u, writer.ConservativeWriteLimit());
+  ASSERT_EQ(OkStatus(), writer.Write(AsBytes("a")));
+  EXPECT_EQ(5u, writer.ConservativeWriteLimit());
+}
+
+TEST(Base64DecodingReader, SingleRead) {
+  stream::MemoryReader input(AsBytes("SGVsbG8="));
+  Base64DecodingReader reader(input);
+
+  std::array<std::byte, 16> buffer;
+  Result<ByteSpan> result = reader.Read(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ("Hello"sv, AsString(result.value()));
+
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(buffer).status());
+}
+
+TEST(Base64DecodingReader, ByteAtATime_ReadsOnlyWhatIsNeeded) {
+  stream::MemoryReader input(AsBytes("SGVsbG8="));
+  Base64DecodingReader reader(input);
+
+  std::array<std::byte, 1> buffer;
+  ASSERT_EQ(OkStatus(), reader.Read(buffer).status());
+  EXPECT_EQ(std::byte{'H'}, buffer[0]);
+  EXPECT_EQ(4u, input.bytes_read());
+
+  ASSERT_EQ(OkStatus(), reader.Read(buffer).status());
+  EXPECT_EQ(std::byte{'e'}, buffer[0]);
+  ASSERT_EQ(OkStatus(), reader.Read(buffer).status());
+  EXPECT_EQ(std::byte{'l'}, buffer[0]);
+  EXPECT_EQ(4u, input.bytes_read());
+
+  ASSERT_EQ(OkStatus(), reader.Read(buffer).status());
+  EXPECT_EQ(std::byte{'l'}, buffer[0]);
+  ASSERT_EQ(OkStatus(), reader.Read(buffer).status());
+  EXPECT_EQ(std::byte{'o'}, buffer[0]);
+
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(buffer).status());
+}
+
+TEST(Base64DecodingReader, VaryingReadSizes_MatchesBinary) {
+  std::array<char, EncodedSize(kBinary.size())> encoded;
+  Encode(kBinary, encoded.data());
+  const std::string_view text(encoded.data(), encoded.size());
+
+  for (size_t max_read : {1u, 3u, 5u, 64u, 1000u}) {
+    for (size_t read_size : {1u, 2u, 3u, 7u, 48u, 200u}) {
+      TrickleReader input(text, max_read);
+      Base64DecodingReader reader(input);
+
+      std::array<std::byte, kBinary.size()> decoded{};
+      size_t total = 0;
+      while (total < decoded.size()) {
+        Result<ByteSpan> result = reader.Read(std::span(decoded).subspan(
+            total, std::min(read_size, decoded.size() - total)));
+        ASSERT_EQ(OkStatus(), result.status());
+        total += result.value().size();
+      }
+
+      EXPECT_EQ(0, std::memcmp(kBinary.data(), decoded.data(), total));
+      EXPECT_EQ(Status::OutOfRange(), reader.Read(decoded).status());
+    }
+  }
+}
+
+TEST(Base64DecodingReader, InvalidCharacter_DataLoss) {
+  stream::MemoryReader input(AsBytes("SGV*bG8="));
+  Base64DecodingReader reader(input);
+
+  std::array<std::byte, 16> buffer;
+  EXPECT_EQ(Status::DataLoss(), reader.Read(buffer).status());
+}
+
+TEST(Base64DecodingReader, EndsMidGroup_DataLoss) {
+  stream::MemoryReader input(AsBytes("SGVsbG"));
+  Base64DecodingReader reader(input);
+
+  std::array<std::byte, 16> buffer;
+  Result<ByteSpan> result = reader.Read(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ("Hel"sv, AsString(result.value()));
+
+  EXPECT_EQ(Status::DataLoss(), reader.Read(buffer).status());
+}
+
+TEST(Base64DecodingReader, RoundTripThroughWriter) {
+  stream::MemoryWriterBuffer<EncodedSize(kBinary.size())> encoded;
+  Base64EncodingWriter writer(encoded);
+  ASSERT_EQ(OkStatus(), writer.Write(kBinary));
+  ASSERT_EQ(OkStatus(), writer.Finish());
+
+  stream::MemoryReader input(encoded.WrittenData());
+  Base64DecodingReader reader(input);
+
+  std::array<std::byte, kBinary.size()> decoded{};
+  size_t total = 0;
+  while (total < decoded.size()) {
+    Result<ByteSpan> result = reader.Read(std::span(decoded).subspan(total));
+    ASSERT_EQ(OkStatus(), result.status());
+    total += result.value().size();
+  }
+  EXPECT_EQ(0, std::memcmp(kBinary.data(), decoded.data(), decoded.size()));
+}
+
+}  // namespace
+}  // namespace pw::base64
@@ -0,0 +1,235 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Generates a report card of stack depth and static RAM for binaries.
+
+For each binary;base pair, the report compares the worst-case stack depth of
+each thread entry function and the .bss and .data bytes of each module, using
+the same tables as the size reports. The text report also lists the functions
+with the deepest stacks in each binary.
+"""
+
+import argparse
+import logging
+import os
+import subprocess
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional, Set
+
+import pw_cli.log
+
+from pw_bloat import bloat_output, static_ram
+from pw_bloat.binary_diff import BinaryDiff, DiffSegment
+from pw_bloat.stack_usage import CallGraph, StackDepth, find_callgraph_info
+
+_LOG = logging.getLogger(__name__)
+
+# Marks stack depths which are only lower bounds.
+_LOWER_BOUND = '*'
+
+
+def parse_args() -> argparse.Namespace:
+    """Parses the script's arguments."""
+    def semicolon_list(arg: str) -> List[str]:
+        return [item for item in arg.split(';') if item]
+
+    def diff_target(arg: str) -> List[str]:
+        items = arg.split(';')
+        if len(items) != 2:
+            raise argparse.ArgumentTypeError(
+                f'Argument must be a ;-delimited binary;base pair: "{arg}"')
+        return items
+
+    parser = argparse.ArgumentParser(
+        'Generate a stack and static RAM report card for binaries')
+    parser.add_argument('--callgraph-info-dirs',
+                        type=semicolon_list,
+                        default=[],
+                        help=('Directories to search for the .ci files from '
+                              '-fcallgraph-info=su'))
+    parser.add_argument('--thread-entries',
+                        type=semicolon_list,
+                        default=[],
+                        help='Functions whose stack depth to report')
+    parser.add_argument('--functions',
+                        type=int,
+                        default=10,
+                        help='Number of deepest functions to list')
+    parser.add_argument('--nm', help='Path to nm for the target toolchain')
+    parser.add_argument('--labels',
+                        type=semicolon_list,
+                        default=[],
+                        help='Labels for output binaries')
+    parser.add_argument('--out-dir',
+                        type=str,
+                        required=True,
+                        help='Directory in which to write output files')
+    parser.add_argument('--target',
+                        type=str,
+                        required=True,
+                        help='Build target name')
+    parser.add_argument('--title',
+                        type=str,
+                        default='pw_bloat',
+                        help='Report title')
+    parser.add_argument('diff_targets',
+                        type=diff_target,
+                        nargs='+',
+                        metavar='DIFF_TARGET',
+                        help='Binary;base pairs to process')
+
+    return parser.parse_args()
+
+
+def defined_symbols(binary: str, nm: Optional[str]) -> Set[str]:
+    """Lists the symbols defined in a binary."""
+    nm_path = nm or os.getenv('NM_PATH', 'nm')
+    output = subprocess.check_output([nm_path, '--defined-only', binary])
+    return {
+        line.split()[-1]
+        for line in output.decode(errors='replace').splitlines()
+        if len(line.split()) == 3
+    }
+
+
+class Footprint:
+    """The stack depths and static RAM of one binary."""
+    def __init__(self, binary: str, graph: CallGraph,
+                 thread_entries: List[str], nm: Optional[str]):
+        symbols = defined_symbols(binary, nm)
+        self.functions = {
+            title: graph.stack_depth(title)
+            for title, function in graph.functions.items()
+            if function.frame_size is not None and function.symbol in symbols
+        }
+
+        self.threads: Dict[str, StackDepth] = {}
+        for entry in thread_entries:
+            depths = [
+                self.functions[function.title]
+                for function in graph.find(entry)
+                if function.title in self.functions
+            ]
+            if depths:
+                self.threads[entry] = max(depths, key=lambda d: d.bytes)
+
+        self.ram = static_ram.ram_by_module(
+            static_ram.read_ram_symbols(binary, nm))
+
+    def deepest(self, count: int) -> List[StackDepth]:
+        return sorted(self.functions.values(),
+                      key=lambda depth: depth.bytes,
+                      reverse=True)[:count]
+
+
+def footprint_diff(label: str, binary: Footprint,
+                   base: Footprint) -> BinaryDiff:
+    """Compares the thread stacks and module RAM of two binaries."""
+    diff = BinaryDiff(label)
+
+    for entry in sorted(set(binary.threads) | set(base.threads)):
+        before = base.threads.get(entry)
+        after = binary.threads.get(entry)
+        marker = _LOWER_BOUND if after and not after.bounded else ''
+        before_bytes = before.bytes if before else 0
+        after_bytes = after.bytes if after else 0
+        diff.add_segment(
+            DiffSegment(f'stack: {entry}{marker}', before_bytes, after_bytes,
+                        after_bytes - before_bytes, 0))
+
+    for module in sorted(set(binary.ram) | set(base.ram)):
+        before_bytes = base.ram.get(module, 0)
+        after_bytes = binary.ram.get(module, 0)
+        diff.add_segment(
+            DiffSegment(f'RAM: {module}', before_bytes, after_bytes,
+                        after_bytes - before_bytes, 0))
+
+    return diff
+
+
+def deepest_functions(label: str, footprint: Footprint, count: int) -> str:
+    """Lists the functions with the deepest stacks in a binary."""
+    lines = [label, '-' * len(label)]
+    for depth in footprint.deepest(count):
+        marker = _LOWER_BOUND if not depth.bounded else ''
+        lines.append(f'{depth.bytes:>8,}{marker:1} {depth.path[0]}')
+        for callee in depth.path[1:]:
+            lines.append(f'{"":10}-> {callee}')
+        if not depth.bounded:
+            lines.append(f'{"":10}{_LOWER_BOUND} Lower bound: {depth.notes()}')
+    return '\n'.join(lines)
+
+
+def main() -> int:
+    """Program entry point."""
+
+    args = parse_args()
+
+    graph = CallGraph.from_files(
+        find_callgraph_info(Path(d) for d in args.callgraph_info_dirs))
+    if not graph.functions:
+        _LOG.warning('%s: no call graph info found; compile with '
+                     '-fcallgraph-info=su to report stack depths', sys.argv[0])
+
+    diffs: List[BinaryDiff] = []
+    listings: List[str] = []
+
+    for i, (binary, base) in enumerate(args.diff_targets):
+        label = (args.labels[i]
+                 if i < len(args.labels) else os.path.basename(binary))
+        try:
+            binary_footprint = Footprint(binary, graph, args.thread_entries,
+                                         args.nm)
+            base_footprint = Footprint(base, graph, args.thread_entries,
+                                       args.nm)
+        except subprocess.CalledProcessError:
+            _LOG.error('%s: failed to read symbols from %s', sys.argv[0],
+                       binary)
+            return 1
+
+        for entry in args.thread_entries:
+            if entry not in binary_footprint.threads:
+                _LOG.warning('%s: no call graph info for %s in %s',
+                             sys.argv[0], entry, binary)
+
+        diffs.append(footprint_diff(label, binary_footprint, base_footprint))
+        listings.append(
+            deepest_functions(label, binary_footprint, args.functions))
+
+    def write_file(filename: str, contents: str) -> None:
+        path = os.path.join(args.out_dir, filename)
+        with open(path, 'w') as output_file:
+            output_file.write(contents)
+        _LOG.debug('Output written to %s', path)
+
+    report = [
+        bloat_output.TableOutput(args.title,
+                                 diffs,
+                                 charset=bloat_output.LineCharset).diff(),
+        f'{_LOWER_BOUND} Stack depth is a lower bound.',
+        *listings,
+    ]
+
+    write_file(f'{args.target}', bloat_output.RstOutput(diffs).diff())
+
+    complete_output = '\n\n'.join(report) + '\n'
+    write_file(f'{args.target}.txt', complete_output)
+    print(complete_output)
+
+    return 0
+
+
+if __name__ == '__main__':
+    pw_cli.log.install()
+    sys.exit(main())
@@ -0,0 +1,188 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Computes worst-case stack depth from GCC call graph information.
+
+Compiling with -fcallgraph-info=su makes GCC write a .ci file next to each
+object file. It lists the stack frame size of each function the translation
+unit defines (the same numbers as -fstack-usage) and the calls each function
+makes. Merging the files of all translation units gives the program's call
+graph. The worst-case stack depth of a function is the largest sum of frame
+sizes along any call path starting at it.
+"""
+
+import dataclasses
+import re
+from pathlib import Path
+from typing import Dict, Iterable, List, Optional, Set
+
+# Title of the node GCC uses as the target of calls through function pointers.
+INDIRECT_CALL = '__indirect_call'
+
+_NODE = re.compile(r'^node: \{ title: "(?P<title>[^"]+)" '
+                   r'label: "(?P<label>[^"]*)"')
+_EDGE = re.compile(r'^edge: \{ sourcename: "(?P<source>[^"]+)" '
+                   r'targetname: "(?P<target>[^"]+)"')
+_FRAME = re.compile(r'^(?P<size>\d+) bytes \((?P<qualifier>[^)]+)\)$')
+
+
+@dataclasses.dataclass
+class Function:
+    """A function in the call graph."""
+    title: str  # Mangled name, prefixed with the file name if static.
+    name: str  # Declaration as written in the source.
+    frame_size: Optional[int] = None  # None if not compiled with call info.
+    dynamic: bool = False  # Frame size depends on runtime values (alloca).
+    callees: Set[str] = dataclasses.field(default_factory=set)
+
+    @property
+    def symbol(self) -> str:
+        """The symbol name of the function in the binary."""
+        return self.title.rsplit(':', 1)[-1]
+
+
+@dataclasses.dataclass(frozen=True)
+class StackDepth:
+    """The worst-case stack depth of a call to a function.
+
+    If any of the flags are set, the depth is a lower bound.
+    """
+    bytes: int
+    path: List[str]  # Function names along the deepest call path.
+    recursive: bool = False
+    indirect_calls: bool = False
+    dynamic_frames: bool = False
+    unknown_functions: bool = False
+
+    @property
+    def bounded(self) -> bool:
+        return not (self.recursive or self.indirect_calls
+                    or self.dynamic_frames or self.unknown_functions)
+
+    def notes(self) -> str:
+        """Lists the reasons the depth is only a lower bound."""
+        reasons = []
+        if self.recursive:
+            reasons.append('recursion')
+        if self.indirect_calls:
+            reasons.append('indirect calls')
+        if self.dynamic_frames:
+            reasons.append('dynamic frames')
+        if self.unknown_functions:
+            reasons.append('functions without call graph info')
+        return ', '.join(reasons)
+
+
+class CallGraph:
+    """The call graph of a program, merged from .ci files."""
+    def __init__(self) -> None:
+        self.functions: Dict[str, Function] = {}
+        self._depths: Dict[str, StackDepth] = {}
+
+    @classmethod
+    def from_files(cls, paths: Iterable[Path]) -> 'CallGraph':
+        graph = cls()
+        for path in paths:
+            graph.add(path.read_text())
+        return graph
+
+    def add(self, callgraph_info: str) -> None:
+        """Adds the contents of a .ci file to the graph."""
+        self._depths.clear()
+
+        for line in callgraph_info.splitlines():
+            node = _NODE.match(line)
+            if node:
+                self._add_node(node['title'], node['label'].split('\\n'))
+                continue
+
+            edge = _EDGE.match(line)
+            if edge:
+                self._function(edge['source']).callees.add(edge['target'])
+
+    def _function(self, title: str) -> Function:
+        if title not in self.functions:
+            self.functions[title] = Function(title, title)
+        return self.functions[title]
+
+    def _add_node(self, title: str, label: List[str]) -> None:
+        function = self._function(title)
+        function.name = label[0]
+
+        # Functions that are only declared in a translation unit have no frame.
+        frame = _FRAME.match(label[-1])
+        if frame:
+            function.frame_size = int(frame['size'])
+            function.dynamic = frame['qualifier'] == 'dynamic'
+
+    def find(self, name: str) -> List[Function]:
+        """Finds functions by title, symbol, or name without parameters."""
+        return [
+            function for function in self.functions.values()
+            if name in (function.title, function.symbol)
+            or f' {name}(' in f' {function.name}'
+        ]
+
+    def stack_depth(self, title: str) -> StackDepth:
+        """Returns the worst-case stack depth of a call to a function."""
+        return self._stack_depth(title, set())
+
+    def _stack_depth(self, title: str, active: Set[str]) -> StackDepth:
+        if title in self._depths:
+            return self._depths[title]
+
+        if title == INDIRECT_CALL:
+            return StackDepth(0, [], indirect_calls=True)
+
+        function = self.functions.get(title)
+        if function is None or function.frame_size is None:
+            name = function.name if function else title
+            return StackDepth(0, [name], unknown_functions=True)
+
+        # A call back into a function on the current path is recursion, whose
+        # depth cannot be bounded from the call graph.
+        if title in active:
+            return StackDepth(0, [], recursive=True)
+
+        active.add(title)
+        deepest = StackDepth(0, [])
+        flags = dict(recursive=False,
+                     indirect_calls=False,
+                     dynamic_frames=function.dynamic,
+                     unknown_functions=False)
+
+        for callee in sorted(function.callees):
+            depth = self._stack_depth(callee, active)
+            if depth.bytes > deepest.bytes or not deepest.path:
+                deepest = depth
+            for flag in flags:
+                flags[flag] = flags[flag] or getattr(depth, flag)
+
+        active.remove(title)
+
+        result = StackDepth(function.frame_size + deepest.bytes,
+                            [function.name] + deepest.path, **flags)
+
+        # Depths computed while part of a cycle is active depend on the path
+        # taken to reach them, so only cache the others.
+        if not result.recursive:
+            self._depths[title] = result
+        return result
+
+
+def find_callgraph_info(directories: Iterable[Path]) -> List[Path]:
+    """Lists the .ci files under the directories."""
+    files: List[Path] = []
+    for directory in directories:
+        files.extend(sorted(directory.rglob('*.ci')))
+    return files
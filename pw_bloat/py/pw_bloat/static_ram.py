@@ -0,0 +1,79 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Attributes a binary's statically allocated RAM to Pigweed modules.
+
+The .bss and .data symbols are read with nm, which reports the source file of
+each symbol when the binary has debug information. Each symbol is attributed to
+the first pw_* directory in its source path, or to the directory under
+third_party for third-party code.
+"""
+
+import collections
+import os
+import re
+import subprocess
+from pathlib import PurePath
+from typing import Dict, Iterable, NamedTuple, Optional
+
+# Symbol types that nm reports for .bss and .data.
+_RAM_SYMBOL_TYPES = frozenset('bBdD')
+
+_NM_LINE = re.compile(r'^[0-9a-fA-F]+ (?P<size>[0-9a-fA-F]+) (?P<type>\w) '
+                      r'(?P<name>[^\t]+)(\t(?P<source>.+):\d+)?$')
+
+UNKNOWN_MODULE = '(other)'
+
+
+class RamSymbol(NamedTuple):
+    name: str
+    size: int
+    zero_initialized: bool  # .bss rather than .data
+    source: Optional[str]
+
+
+def module_for_source(source: Optional[str]) -> str:
+    """Returns the module or third-party library a source file is in."""
+    if source is None:
+        return UNKNOWN_MODULE
+
+    parts = PurePath(source).parts
+    for i, part in enumerate(parts):
+        if re.fullmatch(r'pw_\w+', part):
+            return part
+        if part == 'third_party' and i + 1 < len(parts) - 1:
+            return f'third_party/{parts[i + 1]}'
+
+    return UNKNOWN_MODULE
+
+
+def read_ram_symbols(binary: str,
+                     nm: Optional[str] = None) -> Iterable[RamSymbol]:
+    """Lists the .bss and .data symbols in a binary."""
+    nm_path = nm or os.getenv('NM_PATH', 'nm')
+    output = subprocess.check_output(
+        [nm_path, '--print-size', '--line-numbers', '--defined-only', binary])
+
+    for line in output.decode(errors='replace').splitlines():
+        match = _NM_LINE.match(line)
+        if match and match['type'] in _RAM_SYMBOL_TYPES:
+            yield RamSymbol(match['name'], int(match['size'], 16),
+                            match['type'] in 'bB', match['source'])
+
+
+def ram_by_module(symbols: Iterable[RamSymbol]) -> Dict[str, int]:
+    """Sums the sizes of the symbols in each module."""
+    totals: Dict[str, int] = collections.defaultdict(int)
+    for symbol in symbols:
+        totals[module_for_source(symbol.source)] += symbol.size
+    return dict(totals)
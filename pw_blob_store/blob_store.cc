@@ -15,6 +15,8 @@
 #include "pw_blob_store/blob_store.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstring>
 
 #include "pw_assert/check.h"
 #include "pw_log/log.h"
@@ -64,7 +66,14 @@ Status BlobStore::Init() {
 }
 
 Status BlobStore::LoadMetadata() {
-  if (!kvs_.Get(MetadataKey(), &metadata_).ok()) {
+  // Metadata stored before the uncompressed size was added is shorter, and
+  // leaves the remaining fields zeroed.
+  metadata_.reset();
+  const StatusWithSize result =
+      kvs_.Get(MetadataKey(), as_writable_bytes(std::span(&metadata_, 1)));
+  if (!result.ok() ||
+      (result.size() != sizeof(metadata_) &&
+       result.size() != offsetof(BlobMetadata, uncompressed_size_bytes))) {
     // If no metadata was read, make sure the metadata is reset.
     metadata_.reset();
     return Status::NotFound();
@@ -81,6 +90,20 @@ Status BlobStore::LoadMetadata() {
 
 size_t BlobStore::MaxDataSizeBytes() const { return partition_.size_bytes(); }
 
+void BlobStore::EnableWriteCheckpoints(std::string_view checkpoint_key,
+                                       size_t interval_bytes) {
+  const size_t sector_size = partition_.sector_size_bytes();
+  const size_t interval_alignment = interval_bytes % sector_size;
+  const size_t sector_alignment = sector_size % flash_write_size_bytes_;
+  PW_CHECK(!checkpoint_key.empty());
+  PW_CHECK_UINT_NE(interval_bytes, 0);
+  PW_CHECK_UINT_EQ(interval_alignment, 0);
+  PW_CHECK_UINT_EQ(sector_alignment, 0);
+
+  checkpoint_key_ = checkpoint_key;
+  checkpoint_interval_bytes_ = interval_bytes;
+}
+
 Status BlobStore::OpenWrite() {
   if (!initialized_) {
     return Status::FailedPrecondition();
@@ -101,6 +124,43 @@ Status BlobStore::OpenWrite() {
   return OkStatus();
 }
 
+Status BlobStore::ResumeWrite() {
+  if (!initialized_) {
+    return Status::FailedPrecondition();
+  }
+
+  if (writer_open_ || readers_open_ != 0) {
+    return Status::Unavailable();
+  }
+
+  if (checkpoint_key_.empty()) {
+    return Status::NotFound();
+  }
+
+  WriteCheckpoint checkpoint;
+  if (!kvs_.Get(checkpoint_key_, &checkpoint).ok()) {
+    return Status::NotFound();
+  }
+
+  // A checkpoint left by a write that completed is stale.
+  if (metadata_.data_size_bytes != 0) {
+    kvs_.Delete(checkpoint_key_).IgnoreError();
+    return Status::NotFound();
+  }
+
+  if (!RestoreCheckpoint(checkpoint).ok()) {
+    PW_LOG_ERROR("Blob write checkpoint does not match flash, discarding it");
+    Invalidate().IgnoreError();
+    return Status::DataLoss();
+  }
+
+  PW_LOG_INFO("Blob writer resumed at %u bytes",
+              static_cast<unsigned>(flash_address_));
+
+  writer_open_ = true;
+  return OkStatus();
+}
+
 Status BlobStore::OpenRead() {
   if (!initialized_) {
     return Status::FailedPrecondition();
@@ -122,7 +182,8 @@ Status BlobStore::OpenRead() {
   return OkStatus();
 }
 
-Status BlobStore::CloseWrite() {
+Status BlobStore::CloseWrite(size_t uncompressed_size_bytes,
+                             ChecksumValue uncompressed_checksum) {
   auto do_close_write = [&]() -> Status {
     // If not valid to write, there was data loss and the close will result in a
     // not valid blob. Don't need to flush any write buffered bytes.
@@ -153,7 +214,10 @@ Status BlobStore::CloseWrite() {
     PW_DCHECK(WriteBufferEmpty());
 
     // If things are still good, save the blob metadata.
-    metadata_ = {.checksum = 0, .data_size_bytes = flash_address_};
+    metadata_ = {.checksum = 0,
+                 .data_size_bytes = flash_address_,
+                 .uncompressed_size_bytes = uncompressed_size_bytes,
+                 .uncompressed_checksum = uncompressed_checksum};
     if (checksum_algo_ != nullptr) {
       ConstByteSpan checksum = checksum_algo_->Finish();
       std::memcpy(&metadata_.checksum,
@@ -170,6 +234,10 @@ Status BlobStore::CloseWrite() {
       return Status::DataLoss();
     }
 
+    if (!checkpoint_key_.empty()) {
+      kvs_.Delete(checkpoint_key_).IgnoreError();
+    }
+
     return OkStatus();
   };
 
@@ -360,9 +428,18 @@ Status BlobStore::FlushFinalPartialChunk() {
 }
 
 Status BlobStore::CommitToFlash(ConstByteSpan source, size_t data_bytes) {
+  // Only the final, padded chunk of a blob specifies data_bytes.
+  const bool final_chunk = data_bytes != 0;
   if (data_bytes == 0) {
     data_bytes = source.size_bytes();
   }
+
+  // Once sectors have been erased ahead of the data, the rest are erased as
+  // the data reaches them.
+  if (erased_address_ != 0) {
+    PW_TRY(EraseAhead(source.size_bytes()));
+  }
+
   flash_erased_ = false;
   StatusWithSize result = partition_.Write(flash_address_, source);
   flash_address_ += data_bytes;
@@ -372,6 +449,11 @@ Status BlobStore::CommitToFlash(ConstByteSpan source, size_t data_bytes) {
 
   if (!result.status().ok()) {
     valid_data_ = false;
+  } else if (!checkpoint_key_.empty()) {
+    committed_crc_.Update(source.first(data_bytes));
+    if (!final_chunk && flash_address_ % checkpoint_interval_bytes_ == 0) {
+      SaveCheckpoint();
+    }
   }
 
   return result.status();
@@ -391,13 +473,50 @@ size_t BlobStore::WriteBufferBytesFree() const {
 }
 
 Status BlobStore::EraseIfNeeded() {
-  if (flash_address_ == 0) {
+  if (flash_address_ == 0 && erased_address_ == 0) {
     // Always just erase. Erase is smart enough to only erase if needed.
     return Erase();
   }
   return OkStatus();
 }
 
+Status BlobStore::EraseAhead(size_t size_bytes) {
+  if (flash_address_ == 0 && erased_address_ == 0) {
+    // Nothing needs to be erased if the whole partition already is.
+    if (flash_erased_) {
+      erased_address_ = partition_.size_bytes();
+    }
+
+    // Blob data is considered valid as soon as the sectors it is written to
+    // are erased.
+    valid_data_ = true;
+  }
+
+  const kvs::FlashPartition::Address end =
+      std::min(flash_address_ + size_bytes, partition_.size_bytes());
+  while (erased_address_ < end) {
+    const Status status = partition_.Erase(erased_address_, 1);
+    if (!status.ok()) {
+      valid_data_ = false;
+      return status;
+    }
+    erased_address_ += partition_.sector_size_bytes();
+  }
+  return OkStatus();
+}
+
+size_t BlobStore::ErasedBytesAhead() const {
+  if (erased_address_ == 0) {
+    // Unless erasing ahead, the whole partition is erased before the first
+    // write to flash.
+    if (flash_erased_ || flash_address_ != 0) {
+      return partition_.size_bytes() - flash_address_;
+    }
+    return 0;
+  }
+  return erased_address_ - flash_address_;
+}
+
 StatusWithSize BlobStore::Read(size_t offset, ByteSpan dest) const {
   if (!ValidToRead()) {
     return StatusWithSize::FailedPrecondition();
@@ -412,6 +531,51 @@ StatusWithSize BlobStore::Read(size_t offset, ByteSpan dest) const {
   return partition_.Read(offset, dest.first(read_size));
 }
 
+StatusWithSize BlobStore::BlobReader::DoRead(ByteSpan dest) {
+  PW_DASSERT(open_);
+  if (read_ahead_buffer_.empty()) {
+    StatusWithSize status = store_.Read(offset_, dest);
+    if (status.ok()) {
+      offset_ += status.size();
+    }
+    return status;
+  }
+
+  size_t bytes_read = 0;
+  while (bytes_read < dest.size_bytes()) {
+    ByteSpan remaining = dest.subspan(bytes_read);
+
+    if (!BufferHolds(offset_)) {
+      // Filling the buffer would only add a copy to large reads.
+      ByteSpan read_dest = remaining.size_bytes() >= read_ahead_buffer_.size()
+                               ? remaining
+                               : read_ahead_buffer_;
+      StatusWithSize status = store_.Read(offset_, read_dest);
+      if (!status.ok()) {
+        // Return the bytes already read, and the error on the next read.
+        return bytes_read == 0 ? status : StatusWithSize(bytes_read);
+      }
+
+      if (read_dest.data() == remaining.data()) {
+        offset_ += status.size();
+        bytes_read += status.size();
+        continue;
+      }
+      buffer_offset_ = offset_;
+      buffer_size_ = status.size();
+    }
+
+    const size_t buffered = offset_ - buffer_offset_;
+    const size_t copy_size =
+        std::min(remaining.size_bytes(), buffer_size_ - buffered);
+    std::memcpy(
+        remaining.data(), read_ahead_buffer_.data() + buffered, copy_size);
+    offset_ += copy_size;
+    bytes_read += copy_size;
+  }
+  return StatusWithSize(bytes_read);
+}
+
 Result<ConstByteSpan> BlobStore::GetMemoryMappedBlob() const {
   if (!ValidToRead()) {
     return Status::FailedPrecondition();
@@ -466,6 +630,15 @@ Status BlobStore::Invalidate() {
   ResetChecksum();
   write_address_ = 0;
   flash_address_ = 0;
+  erased_address_ = 0;
+  committed_crc_.clear();
+
+  if (!checkpoint_key_.empty()) {
+    Status status = kvs_.Delete(checkpoint_key_);
+    if (!status.ok() && !status.IsNotFound()) {
+      return Status::Internal();
+    }
+  }
 
   Status status = kvs_.Delete(MetadataKey());
 
@@ -526,4 +699,67 @@ Status BlobStore::CalculateChecksumFromFlash(size_t bytes_to_check) {
   return OkStatus();
 }
 
+void BlobStore::SaveCheckpoint() {
+  const WriteCheckpoint checkpoint = {
+      .committed_bytes = flash_address_,
+      .committed_crc32 = committed_crc_.value(),
+  };
+  // A write can continue without checkpoints, so a failure is not an error.
+  // Resuming uses the previous checkpoint instead.
+  if (!kvs_.Put(checkpoint_key_, checkpoint).ok()) {
+    PW_LOG_WARN("Failed to save blob write checkpoint");
+  }
+}
+
+Status BlobStore::RestoreCheckpoint(const WriteCheckpoint& checkpoint) {
+  const size_t sector_size = partition_.sector_size_bytes();
+  if (checkpoint.committed_bytes == 0 ||
+      checkpoint.committed_bytes > MaxDataSizeBytes() ||
+      checkpoint.committed_bytes % sector_size != 0) {
+    return Status::DataLoss();
+  }
+
+  // Rebuild the checksum state from the data in flash, and check the data
+  // against the CRC32 saved in the checkpoint.
+  ResetChecksum();
+  committed_crc_.clear();
+
+  kvs::FlashPartition::Address address = 0;
+  const kvs::FlashPartition::Address end = checkpoint.committed_bytes;
+
+  constexpr size_t kReadBufferSizeBytes = 32;
+  std::array<std::byte, kReadBufferSizeBytes> buffer;
+  while (address < end) {
+    const size_t read_size = std::min(size_t(end - address), buffer.size());
+    ByteSpan data = std::span(buffer).first(read_size);
+    PW_TRY(partition_.Read(address, data));
+
+    if (checksum_algo_ != nullptr) {
+      checksum_algo_->Update(data);
+    }
+    committed_crc_.Update(data);
+    address += read_size;
+  }
+
+  if (committed_crc_.value() != checkpoint.committed_crc32) {
+    return Status::DataLoss();
+  }
+
+  // Data written after the checkpoint may be in any of the following sectors.
+  for (; address < MaxDataSizeBytes(); address += sector_size) {
+    bool erased = false;
+    PW_TRY(partition_.IsRegionErased(address, sector_size, &erased));
+    if (!erased) {
+      PW_TRY(partition_.Erase(address, 1));
+    }
+  }
+
+  valid_data_ = true;
+  flash_erased_ = false;
+  write_address_ = checkpoint.committed_bytes;
+  flash_address_ = checkpoint.committed_bytes;
+  erased_address_ = MaxDataSizeBytes();
+  return OkStatus();
+}
+
 }  // namespace pw::blob_store
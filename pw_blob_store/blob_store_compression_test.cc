@@ -0,0 +1,229 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_blob_store/compression.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kBlobDataSize = kSectorSize * kSectorCount;
+constexpr size_t kBufferSize = 64;
+
+class BlobStoreCompressionTest : public ::testing::Test {
+ protected:
+  BlobStoreCompressionTest()
+      : flash_(kFlashAlignment),
+        partition_(&flash_),
+        blob_("Compressed",
+              partition_,
+              &checksum_,
+              kvs::TestKvs(),
+              kBufferSize) {}
+
+  void SetUp() override {
+    ASSERT_EQ(OkStatus(), partition_.Erase());
+    ASSERT_EQ(OkStatus(), blob_.Init());
+  }
+
+  // Fills the source with a pattern that repeats every 100 bytes, with every
+  // 32nd byte random.
+  void InitSourceToCompressible() {
+    random::XorShiftStarRng64 rng(0x600d);
+    for (size_t i = 0; i < source_.size(); ++i) {
+      source_[i] = std::byte(i % 100);
+    }
+    for (size_t i = 0; i < source_.size(); i += 32) {
+      rng.Get(std::span(source_).subspan(i, 1));
+    }
+  }
+
+  void WriteCompressed(size_t size, size_t chunk_size) {
+    CompressingWriter writer(blob_);
+    ASSERT_EQ(OkStatus(), writer.Open());
+    ConstByteSpan data = std::span(source_).first(size);
+    while (!data.empty()) {
+      const size_t write_size = std::min(data.size(), chunk_size);
+      ASSERT_EQ(OkStatus(), writer.Write(data.first(write_size)));
+      data = data.subspan(write_size);
+    }
+    EXPECT_EQ(writer.CurrentSizeBytes(), size);
+    ASSERT_EQ(OkStatus(), writer.Close());
+  }
+
+  void VerifyDecompressed(size_t size, size_t chunk_size) {
+    DecompressingReader reader(blob_);
+    ASSERT_EQ(OkStatus(), reader.Open());
+    EXPECT_EQ(reader.UncompressedSizeBytes(), size);
+
+    std::array<std::byte, kBlobDataSize> read_buffer{};
+    ByteSpan read_span = std::span(read_buffer).first(size);
+    while (!read_span.empty()) {
+      ASSERT_EQ(reader.ConservativeReadLimit(), read_span.size());
+      const size_t read_size = std::min(read_span.size(), chunk_size);
+      Result<ByteSpan> result = reader.Read(read_span.first(read_size));
+      ASSERT_EQ(OkStatus(), result.status());
+      ASSERT_EQ(result.value().size(), read_size);
+      read_span = read_span.subspan(read_size);
+    }
+    EXPECT_EQ(Status::OutOfRange(), reader.Read(read_buffer).status());
+    EXPECT_EQ(OkStatus(), reader.Close());
+
+    EXPECT_EQ(std::memcmp(read_buffer.data(), source_.data(), size), 0);
+  }
+
+  // Size of the data stored in flash.
+  size_t StoredSizeBytes() {
+    BlobStore::BlobReader reader(blob_);
+    EXPECT_EQ(OkStatus(), reader.Open());
+    const size_t size = reader.ConservativeReadLimit();
+    EXPECT_EQ(OkStatus(), reader.Close());
+    return size;
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  BlobStoreBuffer<kBufferSize> blob_;
+  std::array<std::byte, kBlobDataSize> source_;
+};
+
+TEST_F(BlobStoreCompressionTest, CompressibleData_StoredSmaller) {
+  InitSourceToCompressible();
+  WriteCompressed(kBlobDataSize, 50);
+
+  EXPECT_LT(StoredSizeBytes(), kBlobDataSize / 2);
+  VerifyDecompressed(kBlobDataSize, 33);
+}
+
+TEST_F(BlobStoreCompressionTest, UncompressedBlob_ReadUnchanged) {
+  InitSourceToCompressible();
+  BlobStore::BlobWriter writer(blob_);
+  ASSERT_EQ(OkStatus(), writer.Open());
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).first(1000)));
+  ASSERT_EQ(OkStatus(), writer.Close());
+
+  DecompressingReader reader(blob_);
+  ASSERT_EQ(OkStatus(), reader.Open());
+  EXPECT_FALSE(reader.IsCompressed());
+  reader.Close().IgnoreError();
+  VerifyDecompressed(1000, 64);
+}
+
+TEST_F(BlobStoreCompressionTest, Reinit_KeepsUncompressedSize) {
+  InitSourceToCompressible();
+  WriteCompressed(3000, 3000);
+
+  BlobStoreBuffer<kBufferSize> reloaded(
+      "Compressed", partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+
+  DecompressingReader reader(reloaded);
+  ASSERT_EQ(OkStatus(), reader.Open());
+  EXPECT_TRUE(reader.IsCompressed());
+  EXPECT_EQ(reader.UncompressedSizeBytes(), 3000u);
+
+  std::array<std::byte, 3000> read_buffer;
+  Result<ByteSpan> result = reader.Read(read_buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(result.value().size(), 3000u);
+  EXPECT_EQ(std::memcmp(read_buffer.data(), source_.data(), 3000), 0);
+}
+
+TEST_F(BlobStoreCompressionTest, LegacyMetadata_LoadsAsUncompressed) {
+  InitSourceToCompressible();
+  BlobStoreBuffer<kBufferSize> blob(
+      "Legacy", partition_, nullptr, kvs::TestKvs(), kBufferSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+  BlobStore::BlobWriter writer(blob);
+  ASSERT_EQ(OkStatus(), writer.Open());
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).first(1000)));
+  ASSERT_EQ(OkStatus(), writer.Close());
+
+  // Metadata from before the uncompressed size was added.
+  struct {
+    uint32_t checksum;
+    size_t data_size_bytes;
+  } legacy_metadata = {.checksum = 0, .data_size_bytes = 1000};
+  ASSERT_EQ(OkStatus(), kvs::TestKvs().Put("Legacy", legacy_metadata));
+
+  BlobStoreBuffer<kBufferSize> reloaded(
+      "Legacy", partition_, nullptr, kvs::TestKvs(), kBufferSize);
+  ASSERT_EQ(OkStatus(), reloaded.Init());
+  DecompressingReader reader(reloaded);
+  ASSERT_EQ(OkStatus(), reader.Open());
+  EXPECT_FALSE(reader.IsCompressed());
+  EXPECT_EQ(reader.UncompressedSizeBytes(), 1000u);
+}
+
+TEST_F(BlobStoreCompressionTest, IncompressibleData_TooLarge) {
+  random::XorShiftStarRng64 rng(0xbad);
+  rng.Get(source_);
+
+  CompressingWriter writer(blob_);
+  ASSERT_EQ(OkStatus(), writer.Open());
+  EXPECT_EQ(writer.ConservativeWriteLimit(), kBlobDataSize / 9 * 8);
+
+  // Random data grows when compressed, so a partition's worth doesn't fit.
+  Status status = OkStatus();
+  for (size_t i = 0; i < source_.size() && status.ok(); i += 256) {
+    status = writer.Write(std::span(source_).subspan(i, 256));
+  }
+  EXPECT_EQ(Status::DataLoss(), status);
+  EXPECT_EQ(Status::DataLoss(), writer.Close());
+
+  DecompressingReader reader(blob_);
+  EXPECT_EQ(Status::FailedPrecondition(), reader.Open());
+}
+
+TEST_F(BlobStoreCompressionTest, CorruptedData_DataLoss) {
+  InitSourceToCompressible();
+
+  // Without a flash checksum, only the uncompressed CRC32 catches corruption.
+  BlobStoreBuffer<kBufferSize> blob(
+      "Unchecked", partition_, nullptr, kvs::TestKvs(), kBufferSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+  CompressingWriter writer(blob);
+  ASSERT_EQ(OkStatus(), writer.Open());
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).first(2000)));
+  ASSERT_EQ(OkStatus(), writer.Close());
+
+  DecompressingReader reader(blob);
+  ASSERT_EQ(OkStatus(), reader.Open());
+  flash_.buffer()[100] ^= std::byte(0x01);
+
+  Status status = OkStatus();
+  std::array<std::byte, 100> read_buffer;
+  while (status.ok()) {
+    status = reader.Read(read_buffer).status();
+  }
+  EXPECT_EQ(Status::DataLoss(), status);
+}
+
+}  // namespace
+}  // namespace pw::blob_store
@@ -0,0 +1,172 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 2;
+constexpr size_t kBlobDataSize = 1000;
+constexpr size_t kBufferSize = 64;
+
+// Counts the reads that reach flash.
+class CountingFlash : public kvs::FakeFlashMemoryBuffer<kSectorSize,
+                                                        kSectorCount> {
+ public:
+  CountingFlash() : FakeFlashMemoryBuffer(kFlashAlignment) {}
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override {
+    read_count_ += 1;
+    return FakeFlashMemoryBuffer::Read(address, output);
+  }
+
+  size_t read_count() const { return read_count_; }
+
+ private:
+  size_t read_count_ = 0;
+};
+
+class BlobStoreReadAheadTest : public ::testing::Test {
+ protected:
+  BlobStoreReadAheadTest()
+      : partition_(&flash_),
+        blob_("ReadAhead",
+              partition_,
+              &checksum_,
+              kvs::TestKvs(),
+              kBufferSize) {}
+
+  void SetUp() override {
+    random::XorShiftStarRng64 rng(0x7ead);
+    rng.Get(source_);
+
+    ASSERT_EQ(OkStatus(), partition_.Erase());
+    ASSERT_EQ(OkStatus(), blob_.Init());
+    BlobStore::BlobWriter writer(blob_);
+    ASSERT_EQ(OkStatus(), writer.Open());
+    ASSERT_EQ(OkStatus(), writer.Write(source_));
+    ASSERT_EQ(OkStatus(), writer.Close());
+  }
+
+  // Reads size bytes and checks that they match the blob at offset.
+  void ReadAndVerify(BlobStore::BlobReader& reader,
+                     size_t offset,
+                     size_t size) {
+    std::array<std::byte, kBlobDataSize> read_buffer;
+    Result<ByteSpan> result = reader.Read(std::span(read_buffer).first(size));
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(result.value().size(), size);
+    EXPECT_EQ(std::memcmp(read_buffer.data(), &source_[offset], size), 0);
+  }
+
+  CountingFlash flash_;
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  BlobStoreBuffer<kBufferSize> blob_;
+  std::array<std::byte, kBlobDataSize> source_;
+};
+
+TEST_F(BlobStoreReadAheadTest, SmallReads_ReadFlashOncePerBuffer) {
+  std::array<std::byte, 100> read_ahead;
+  BlobStore::BlobReader reader(blob_, read_ahead);
+  ASSERT_EQ(OkStatus(), reader.Open());
+
+  const size_t read_count = flash_.read_count();
+  for (size_t offset = 0; offset < kBlobDataSize; offset += 4) {
+    ReadAndVerify(reader, offset, 4);
+  }
+  EXPECT_EQ(flash_.read_count() - read_count, kBlobDataSize / 100);
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(read_ahead).status());
+}
+
+TEST_F(BlobStoreReadAheadTest, ReadAcrossBuffer_Complete) {
+  std::array<std::byte, 100> read_ahead;
+  BlobStore::BlobReader reader(blob_, read_ahead);
+  ASSERT_EQ(OkStatus(), reader.Open());
+
+  ReadAndVerify(reader, 0, 30);
+  ReadAndVerify(reader, 30, 90);
+  EXPECT_EQ(reader.Tell(), 120u);
+}
+
+TEST_F(BlobStoreReadAheadTest, LargeRead_BypassesBuffer) {
+  std::array<std::byte, 100> read_ahead;
+  BlobStore::BlobReader reader(blob_, read_ahead);
+  ASSERT_EQ(OkStatus(), reader.Open());
+
+  const size_t read_count = flash_.read_count();
+  ReadAndVerify(reader, 0, 500);
+  EXPECT_EQ(flash_.read_count() - read_count, 1u);
+  ReadAndVerify(reader, 500, 500);
+  EXPECT_EQ(flash_.read_count() - read_count, 2u);
+}
+
+TEST_F(BlobStoreReadAheadTest, Seek_BackWithinBuffer_NoFlashRead) {
+  std::array<std::byte, 100> read_ahead;
+  BlobStore::BlobReader reader(blob_, read_ahead);
+  ASSERT_EQ(OkStatus(), reader.Open());
+
+  ASSERT_EQ(OkStatus(), reader.Seek(200));
+  ReadAndVerify(reader, 200, 10);
+  const size_t read_count = flash_.read_count();
+
+  ASSERT_EQ(OkStatus(), reader.Seek(250));
+  ReadAndVerify(reader, 250, 10);
+  ASSERT_EQ(OkStatus(), reader.Seek(205));
+  ReadAndVerify(reader, 205, 10);
+  EXPECT_EQ(flash_.read_count(), read_count);
+
+  ASSERT_EQ(OkStatus(), reader.Seek(20));
+  ReadAndVerify(reader, 20, 10);
+  EXPECT_EQ(flash_.read_count(), read_count + 1);
+}
+
+TEST_F(BlobStoreReadAheadTest, Seek_NoBuffer) {
+  BlobStore::BlobReader reader(blob_);
+  ASSERT_EQ(OkStatus(), reader.Open());
+
+  ASSERT_EQ(OkStatus(), reader.Seek(900));
+  EXPECT_EQ(reader.ConservativeReadLimit(), 100u);
+  ReadAndVerify(reader, 900, 100);
+  ASSERT_EQ(OkStatus(), reader.Seek(10));
+  ReadAndVerify(reader, 10, 10);
+}
+
+TEST_F(BlobStoreReadAheadTest, Seek_End) {
+  std::array<std::byte, 100> read_ahead;
+  BlobStore::BlobReader reader(blob_, read_ahead);
+  ASSERT_EQ(OkStatus(), reader.Open());
+
+  ASSERT_EQ(OkStatus(), reader.Seek(kBlobDataSize));
+  EXPECT_EQ(reader.ConservativeReadLimit(), 0u);
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(read_ahead).status());
+  EXPECT_EQ(Status::InvalidArgument(), reader.Seek(kBlobDataSize + 1));
+}
+
+}  // namespace
+}  // namespace pw::blob_store
@@ -0,0 +1,197 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kBlobDataSize = kSectorSize * kSectorCount;
+constexpr size_t kBufferSize = 64;
+
+constexpr char kBlobName[] = "Resumable";
+constexpr char kCheckpointKey[] = "Resumable.checkpoint";
+
+class BlobStoreResumeTest : public ::testing::Test {
+ protected:
+  BlobStoreResumeTest() : flash_(kFlashAlignment), partition_(&flash_) {
+    random::XorShiftStarRng64 rng(0x2e5e7);
+    rng.Get(source_);
+  }
+
+  void SetUp() override { ASSERT_EQ(OkStatus(), partition_.Erase()); }
+
+  // Writes the first size bytes of the source, then stops as if the device
+  // reset. The BlobStore and writer are never destroyed, so nothing is closed.
+  void WriteAndReset(size_t size) {
+    auto* blob = new (&interrupted_blob_) BlobStoreBuffer<kBufferSize>(
+        kBlobName, partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+    blob->EnableWriteCheckpoints(kCheckpointKey, kSectorSize);
+    ASSERT_EQ(OkStatus(), blob->Init());
+
+    auto* writer = new (&interrupted_writer_) BlobStore::BlobWriter(*blob);
+    ASSERT_EQ(OkStatus(), writer->Open());
+    for (size_t offset = 0; offset < size; offset += 100) {
+      const size_t write_size = std::min(size - offset, size_t{100});
+      ASSERT_EQ(OkStatus(),
+                writer->Write(std::span(source_).subspan(offset, write_size)));
+    }
+  }
+
+  void WriteFrom(BlobStore::BlobWriter& writer, size_t offset) {
+    ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).subspan(offset)));
+  }
+
+  void VerifyBlob(BlobStore& blob) {
+    BlobStore::BlobReader reader(blob);
+    ASSERT_EQ(OkStatus(), reader.Open());
+    Result<ConstByteSpan> result = reader.GetMemoryMappedBlob();
+    ASSERT_TRUE(result.ok());
+    ASSERT_EQ(result.value().size_bytes(), kBlobDataSize);
+    EXPECT_EQ(
+        std::memcmp(result.value().data(), source_.data(), kBlobDataSize), 0);
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  std::array<std::byte, kBlobDataSize> source_;
+
+  // Storage for the BlobStore and writer that are interrupted by a "reset".
+  alignas(BlobStoreBuffer<kBufferSize>) std::byte
+      interrupted_blob_[sizeof(BlobStoreBuffer<kBufferSize>)];
+  alignas(BlobStore::BlobWriter) std::byte
+      interrupted_writer_[sizeof(BlobStore::BlobWriter)];
+};
+
+TEST_F(BlobStoreResumeTest, Resume_ContinuesFromLastCheckpoint) {
+  WriteAndReset(2500);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobName, partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+  blob.EnableWriteCheckpoints(kCheckpointKey, kSectorSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::BlobWriter writer(blob);
+  ASSERT_EQ(OkStatus(), writer.Resume());
+  ASSERT_EQ(writer.CurrentSizeBytes(), 2 * kSectorSize);
+  WriteFrom(writer, writer.CurrentSizeBytes());
+  ASSERT_EQ(OkStatus(), writer.Close());
+
+  VerifyBlob(blob);
+
+  // The checkpoint is deleted once the blob is complete.
+  std::array<std::byte, 32> value;
+  EXPECT_EQ(Status::NotFound(),
+            kvs::TestKvs().Get(kCheckpointKey, value).status());
+  EXPECT_EQ(Status::NotFound(), writer.Resume());
+}
+
+TEST_F(BlobStoreResumeTest, Resume_DeferredWriter) {
+  WriteAndReset(1500);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobName, partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+  blob.EnableWriteCheckpoints(kCheckpointKey, kSectorSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::DeferredWriter writer(blob);
+  ASSERT_EQ(OkStatus(), writer.Resume());
+  ASSERT_EQ(writer.CurrentSizeBytes(), kSectorSize);
+  for (size_t offset = kSectorSize; offset < kBlobDataSize;
+       offset += kBufferSize) {
+    ASSERT_EQ(OkStatus(),
+              writer.Write(std::span(source_).subspan(offset, kBufferSize)));
+    ASSERT_EQ(OkStatus(), writer.Flush());
+  }
+  ASSERT_EQ(OkStatus(), writer.Close());
+
+  VerifyBlob(blob);
+}
+
+TEST_F(BlobStoreResumeTest, Resume_CorruptedData_DataLoss) {
+  WriteAndReset(2500);
+  flash_.buffer()[100] ^= std::byte(0x01);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobName, partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+  blob.EnableWriteCheckpoints(kCheckpointKey, kSectorSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::BlobWriter writer(blob);
+  EXPECT_EQ(Status::DataLoss(), writer.Resume());
+  EXPECT_FALSE(writer.IsOpen());
+  EXPECT_EQ(Status::NotFound(), writer.Resume());
+
+  // Starting over still works.
+  ASSERT_EQ(OkStatus(), writer.Open());
+  WriteFrom(writer, 0);
+  ASSERT_EQ(OkStatus(), writer.Close());
+  VerifyBlob(blob);
+}
+
+TEST_F(BlobStoreResumeTest, Resume_BeforeFirstCheckpoint_NotFound) {
+  WriteAndReset(kSectorSize - 1);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobName, partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+  blob.EnableWriteCheckpoints(kCheckpointKey, kSectorSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::BlobWriter writer(blob);
+  EXPECT_EQ(Status::NotFound(), writer.Resume());
+}
+
+TEST_F(BlobStoreResumeTest, Resume_CheckpointsDisabled_NotFound) {
+  WriteAndReset(2500);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobName, partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::BlobWriter writer(blob);
+  EXPECT_EQ(Status::NotFound(), writer.Resume());
+}
+
+TEST_F(BlobStoreResumeTest, Open_DiscardsCheckpoint) {
+  WriteAndReset(2500);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobName, partition_, &checksum_, kvs::TestKvs(), kBufferSize);
+  blob.EnableWriteCheckpoints(kCheckpointKey, kSectorSize);
+  ASSERT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::BlobWriter writer(blob);
+  ASSERT_EQ(OkStatus(), writer.Open());
+  ASSERT_EQ(OkStatus(), writer.Close());
+  EXPECT_EQ(Status::NotFound(), writer.Resume());
+}
+
+}  // namespace
+}  // namespace pw::blob_store
@@ -0,0 +1,141 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/compression.h"
+
+#include <algorithm>
+
+#include "pw_log/log.h"
+
+namespace pw::blob_store {
+
+Status CompressingWriter::Close() {
+  PW_DASSERT(open_);
+  open_ = false;
+
+  if (status_.ok()) {
+    status_ = encoder_.Finish(flash_writer_);
+  }
+
+  if (!status_.ok()) {
+    PW_LOG_ERROR("Compressed blob write failed");
+    // The compressed data is incomplete, so discard it rather than storing
+    // metadata for it.
+    store_.Invalidate().IgnoreError();
+    store_.CloseWrite().IgnoreError();
+    store_.valid_data_ = false;
+    return Status::DataLoss();
+  }
+
+  if (uncompressed_size_ == 0) {
+    return store_.CloseWrite();
+  }
+
+  PW_LOG_DEBUG("Compressed %u byte blob to %u bytes",
+               static_cast<unsigned>(uncompressed_size_),
+               static_cast<unsigned>(store_.write_address_));
+  return store_.CloseWrite(uncompressed_size_, crc_.value());
+}
+
+Status CompressingWriter::DoWrite(ConstByteSpan data) {
+  PW_DASSERT(open_);
+  if (!status_.ok()) {
+    return Status::DataLoss();
+  }
+
+  uncompressed_size_ += data.size();
+  crc_.Update(data);
+  status_ = encoder_.Write(data, flash_writer_);
+  return status_.ok() ? OkStatus() : Status::DataLoss();
+}
+
+Status DecompressingReader::Open() {
+  PW_DASSERT(!open_);
+  if (!store_.ValidToRead()) {
+    return Status::FailedPrecondition();
+  }
+
+  Status status = store_.OpenRead();
+  if (status.ok()) {
+    open_ = true;
+    offset_ = 0;
+    input_ = ConstByteSpan();
+    decoder_.Reset();
+    crc_.clear();
+  }
+  return status;
+}
+
+StatusWithSize DecompressingReader::DoRead(ByteSpan dest) {
+  PW_DASSERT(open_);
+  if (!IsCompressed()) {
+    StatusWithSize status = store_.Read(offset_, dest);
+    if (status.ok()) {
+      offset_ += status.size();
+    }
+    return status;
+  }
+
+  const size_t remaining = ConservativeReadLimit();
+  if (remaining == 0) {
+    return StatusWithSize::OutOfRange();
+  }
+  dest = dest.first(std::min(dest.size(), remaining));
+
+  StatusWithSize result = Decompress(dest);
+  if (!result.ok()) {
+    return result;
+  }
+
+  if (decoder_.output_size() == UncompressedSizeBytes() &&
+      crc_.value() != store_.metadata_.uncompressed_checksum) {
+    PW_LOG_ERROR("Decompressed blob failed CRC check");
+    return StatusWithSize::DataLoss(result.size());
+  }
+  return result;
+}
+
+StatusWithSize DecompressingReader::Decompress(ByteSpan dest) {
+  size_t written = 0;
+
+  while (true) {
+    ByteSpan output = dest.subspan(written);
+    StatusWithSize decoded = decoder_.Decode(input_, output);
+    crc_.Update(output.first(decoded.size()));
+    written += decoded.size();
+
+    if (!decoded.ok()) {
+      return StatusWithSize::DataLoss(written);
+    }
+    if (written == dest.size()) {
+      break;
+    }
+
+    // The decoder used up its input, so read more compressed data.
+    if (offset_ >= store_.ReadableDataBytes()) {
+      // The compressed data ended before the uncompressed size was reached.
+      return StatusWithSize::DataLoss(written);
+    }
+    StatusWithSize read = store_.Read(offset_, input_buffer_);
+    if (!read.ok()) {
+      return StatusWithSize(read.status(), written);
+    }
+    offset_ += read.size();
+    input_ = std::span(input_buffer_).first(read.size());
+  }
+
+  return StatusWithSize(written);
+}
+
+}  // namespace pw::blob_store
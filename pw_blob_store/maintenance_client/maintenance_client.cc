@@ -0,0 +1,43 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/maintenance_client.h"
+
+namespace pw::blob_store {
+
+size_t BlobStoreMaintenanceClient::FreeBytes() {
+  // Without an open writer there is nothing to prepare for.
+  if (!store_.writer_open_) {
+    return target_free_bytes();
+  }
+  return store_.ErasedBytesAhead();
+}
+
+Status BlobStoreMaintenanceClient::DoMaintenanceStep() {
+  if (!store_.writer_open_) {
+    return Status::NotFound();
+  }
+
+  const size_t erased_bytes = store_.ErasedBytesAhead();
+  if (erased_bytes >= target_free_bytes() ||
+      store_.flash_address_ + erased_bytes >= store_.partition_.size_bytes()) {
+    return Status::NotFound();
+  }
+
+  // Erase one more sector past the erased ones.
+  return store_.EraseAhead(erased_bytes +
+                           store_.partition_.sector_size_bytes());
+}
+
+}  // namespace pw::blob_store
@@ -0,0 +1,136 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/maintenance_client.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_maintenance_scheduler.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kWriteSize = 64;
+constexpr size_t kBufferSize = 256;
+
+constexpr std::byte kDirty{0x5a};
+
+class BlobStoreMaintenanceClientTest : public ::testing::Test {
+ protected:
+  BlobStoreMaintenanceClientTest()
+      : flash_(kFlashAlignment),
+        partition_(&flash_),
+        blob_("Scheduled",
+              partition_,
+              &checksum_,
+              kvs::TestKvs(),
+              kWriteSize),
+        client_(blob_, 2 * kSectorSize) {
+    // Start with flash that needs to be erased.
+    std::memset(flash_.buffer().data(),
+                static_cast<int>(kDirty),
+                flash_.buffer().size_bytes());
+    random::XorShiftStarRng64 rng(0x5eed1e55);
+    rng.Get(source_);
+    scheduler_.Register(client_);
+  }
+
+  ~BlobStoreMaintenanceClientTest() { scheduler_.Unregister(client_); }
+
+  bool SectorErased(size_t sector) const {
+    return flash_.buffer()[sector * kSectorSize] ==
+           flash_.erased_memory_content();
+  }
+
+  void RunScheduler() {
+    while (scheduler_.RunStep().ok()) {
+    }
+  }
+
+  void VerifyBlob(size_t size) {
+    BlobStore::BlobReader reader(blob_);
+    ASSERT_EQ(OkStatus(), reader.Open());
+    Result<ConstByteSpan> result = reader.GetMemoryMappedBlob();
+    ASSERT_TRUE(result.ok());
+    ASSERT_EQ(result.value().size_bytes(), size);
+    EXPECT_EQ(std::memcmp(result.value().data(), source_.data(), size), 0);
+    EXPECT_EQ(OkStatus(), reader.Close());
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  BlobStoreBuffer<kBufferSize> blob_;
+  kvs::FlashMaintenanceScheduler scheduler_;
+  BlobStoreMaintenanceClient client_;
+  std::array<std::byte, kSectorCount * kSectorSize> source_;
+};
+
+TEST_F(BlobStoreMaintenanceClientTest, NoWriterOpen_NothingToDo) {
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  EXPECT_EQ(Status::NotFound(), scheduler_.RunStep());
+  EXPECT_FALSE(SectorErased(0));
+}
+
+TEST_F(BlobStoreMaintenanceClientTest, ErasesTargetAheadOfWriter) {
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  BlobStore::BlobWriter writer(blob_);
+  ASSERT_EQ(OkStatus(), writer.Open());
+
+  RunScheduler();
+  EXPECT_TRUE(SectorErased(0));
+  EXPECT_TRUE(SectorErased(1));
+  EXPECT_FALSE(SectorErased(2));
+
+  // Writing into the second sector leaves less than the target erased.
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).first(kSectorSize)));
+  EXPECT_FALSE(SectorErased(2));
+
+  RunScheduler();
+  EXPECT_TRUE(SectorErased(2));
+  EXPECT_FALSE(SectorErased(3));
+  EXPECT_EQ(OkStatus(), writer.Close());
+}
+
+TEST_F(BlobStoreMaintenanceClientTest, WriterErasesSectorsNotErasedAhead) {
+  constexpr size_t kBlobSize = 3 * kSectorSize + 100;
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  BlobStore::BlobWriter writer(blob_);
+  ASSERT_EQ(OkStatus(), writer.Open());
+
+  // Erase one sector, then write past it without running the scheduler.
+  ASSERT_EQ(OkStatus(), scheduler_.RunStep());
+  ASSERT_TRUE(SectorErased(0));
+  ASSERT_FALSE(SectorErased(1));
+
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(source_).first(kBlobSize)));
+  ASSERT_EQ(OkStatus(), writer.Close());
+
+  VerifyBlob(kBlobSize);
+}
+
+}  // namespace
+}  // namespace pw::blob_store
@@ -0,0 +1,49 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_blob_store/blob_store.h"
+#include "pw_kvs/flash_maintenance_scheduler.h"
+#include "pw_status/status.h"
+
+namespace pw::blob_store {
+
+// Lets a kvs::FlashMaintenanceScheduler erase a BlobStore's partition ahead of
+// an open writer, one sector per step, until target_free_bytes are erased
+// ahead of the data written. Writes then rarely wait for an erase, and the
+// writer does not erase the whole partition when it first writes to flash.
+// Once sectors are erased ahead, the writer erases any further sectors one at a
+// time as the data reaches them.
+//
+// The client has nothing to do while no writer is open. The blob's writers and
+// readers must be used within a ForegroundOperation, like other stores on the
+// device. Because a PipelinedWriter writes from its own thread, it must not be
+// used with this client.
+class BlobStoreMaintenanceClient final
+    : public kvs::FlashMaintenanceScheduler::Client {
+ public:
+  BlobStoreMaintenanceClient(BlobStore& store, size_t target_free_bytes)
+      : Client(target_free_bytes), store_(store) {}
+
+ private:
+  size_t FreeBytes() override;
+
+  Status DoMaintenanceStep() override;
+
+  BlobStore& store_;
+};
+
+}  // namespace pw::blob_store
@@ -0,0 +1,178 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/pipelined_writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/check.h"
+#include "pw_status/try.h"
+
+namespace pw::blob_store {
+
+Status PipelinedWriter::Open() {
+  PW_DASSERT(!open_);
+  Prepare();
+  PW_TRY(store_.OpenWrite());
+  open_ = true;
+  return OkStatus();
+}
+
+Status PipelinedWriter::Resume() {
+  PW_DASSERT(!open_);
+  Prepare();
+  PW_TRY(store_.ResumeWrite());
+  open_ = true;
+  return OkStatus();
+}
+
+void PipelinedWriter::Prepare() {
+  // Each buffer holds a whole number of flash writes.
+  const size_t write_size = store_.flash_write_size_bytes_;
+  const size_t buffer_size =
+      store_.write_buffer_.size_bytes() / 2 / write_size * write_size;
+  PW_CHECK_UINT_GE(buffer_size, write_size);
+  buffers_ = {store_.write_buffer_.first(buffer_size),
+              store_.write_buffer_.subspan(buffer_size, buffer_size)};
+
+  fill_index_ = 0;
+  fill_size_ = 0;
+  in_flight_ = false;
+  commit_status_ = OkStatus();
+}
+
+Status PipelinedWriter::Close() {
+  PW_DASSERT(open_);
+
+  // If a commit failed, the blob is invalid and CloseWrite() reports the data
+  // loss.
+  if (WaitForCommit().ok() && fill_size_ > 0) {
+    // Move the remaining bytes to the start of the write buffer, where
+    // CloseWrite() flushes them from. Erase the sectors they are written to
+    // first, so that CloseWrite() doesn't erase the whole partition.
+    std::memmove(
+        store_.write_buffer_.data(), buffers_[fill_index_].data(), fill_size_);
+
+    const size_t write_size = store_.flash_write_size_bytes_;
+    store_.EraseAhead((fill_size_ + write_size - 1) / write_size * write_size)
+        .IgnoreError();
+  }
+
+  open_ = false;
+  return store_.CloseWrite();
+}
+
+Status PipelinedWriter::Erase() {
+  PW_DASSERT(open_);
+  WaitForCommit().IgnoreError();
+  fill_size_ = 0;
+  commit_status_ = OkStatus();
+  return store_.Erase();
+}
+
+Status PipelinedWriter::Discard() {
+  PW_DASSERT(open_);
+  WaitForCommit().IgnoreError();
+  fill_size_ = 0;
+  commit_status_ = OkStatus();
+  return store_.Invalidate();
+}
+
+void PipelinedWriter::ProcessPending() {
+  if (ready_.try_acquire()) {
+    Commit();
+  }
+}
+
+void PipelinedWriter::Run() {
+  while (true) {
+    ready_.acquire();
+    Commit();
+  }
+}
+
+void PipelinedWriter::Commit() {
+  Status status = store_.EraseAhead(commit_data_.size_bytes());
+  if (status.ok()) {
+    status = store_.CommitToFlash(commit_data_);
+  }
+
+  // Erase where the next buffer will be written while the caller fills it.
+  if (status.ok()) {
+    status = store_.EraseAhead(buffers_[0].size_bytes());
+  }
+
+  commit_status_ = status;
+  committed_.release();
+}
+
+Status PipelinedWriter::HandOffFillBuffer() {
+  PW_TRY(WaitForCommit());
+
+  commit_data_ = buffers_[fill_index_].first(fill_size_);
+  in_flight_ = true;
+  ready_.release();
+
+  fill_index_ ^= 1;
+  fill_size_ = 0;
+  return OkStatus();
+}
+
+Status PipelinedWriter::WaitForCommit() {
+  if (in_flight_) {
+    committed_.acquire();
+    in_flight_ = false;
+  }
+  return commit_status_.ok() ? OkStatus() : Status::DataLoss();
+}
+
+Status PipelinedWriter::DoWrite(ConstByteSpan data) {
+  PW_DASSERT(open_);
+
+  // Pick up the result of a finished commit without waiting for one.
+  if (in_flight_ && committed_.try_acquire()) {
+    in_flight_ = false;
+  }
+  if (!in_flight_ && !commit_status_.ok()) {
+    return Status::DataLoss();
+  }
+
+  if (data.size_bytes() == 0) {
+    return OkStatus();
+  }
+  if (store_.WriteBytesRemaining() == 0) {
+    return Status::OutOfRange();
+  }
+  if (store_.WriteBytesRemaining() < data.size_bytes()) {
+    return Status::ResourceExhausted();
+  }
+
+  while (data.size_bytes() > 0) {
+    ByteSpan buffer = buffers_[fill_index_];
+    const size_t add_bytes =
+        std::min(buffer.size_bytes() - fill_size_, data.size_bytes());
+    std::memcpy(buffer.data() + fill_size_, data.data(), add_bytes);
+    store_.write_address_ += add_bytes;
+    fill_size_ += add_bytes;
+    data = data.subspan(add_bytes);
+
+    if (fill_size_ == buffer.size_bytes()) {
+      PW_TRY(HandOffFillBuffer());
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::blob_store
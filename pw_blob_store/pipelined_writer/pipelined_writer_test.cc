@@ -0,0 +1,176 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_blob_store/pipelined_writer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kFlashAlignment = 16;
+constexpr size_t kSectorSize = 1024;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kWriteSize = 64;
+
+// Two buffers of 128 bytes.
+constexpr size_t kBufferSize = 256;
+constexpr size_t kPipelineBufferSize = kBufferSize / 2;
+
+constexpr std::byte kDirty{0x5a};
+
+class PipelinedWriterTest : public ::testing::Test {
+ protected:
+  PipelinedWriterTest()
+      : flash_(kFlashAlignment),
+        partition_(&flash_),
+        blob_("Pipelined",
+              partition_,
+              &checksum_,
+              kvs::TestKvs(),
+              kWriteSize),
+        writer_(blob_) {
+    // Start with flash that needs to be erased.
+    std::memset(flash_.buffer().data(),
+                static_cast<int>(kDirty),
+                flash_.buffer().size_bytes());
+    random::XorShiftStarRng64 rng(0x1234abcd);
+    rng.Get(source_);
+  }
+
+  // Writes the first size bytes of source_ in chunks, running the worker after
+  // each write.
+  void WriteInChunks(size_t size, size_t chunk_size) {
+    ConstByteSpan data = std::span(source_).first(size);
+    while (data.size_bytes() > 0) {
+      const size_t write_size = std::min(data.size_bytes(), chunk_size);
+      ASSERT_EQ(OkStatus(), writer_.Write(data.first(write_size)));
+      writer_.ProcessPending();
+      data = data.subspan(write_size);
+    }
+  }
+
+  void VerifyBlob(size_t size) {
+    BlobStore::BlobReader reader(blob_);
+    ASSERT_EQ(OkStatus(), reader.Open());
+    Result<ConstByteSpan> result = reader.GetMemoryMappedBlob();
+    ASSERT_TRUE(result.ok());
+    ASSERT_EQ(result.value().size_bytes(), size);
+    EXPECT_EQ(std::memcmp(result.value().data(), source_.data(), size), 0);
+    EXPECT_EQ(OkStatus(), reader.Close());
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  kvs::ChecksumCrc16 checksum_;
+  BlobStoreBuffer<kBufferSize> blob_;
+  PipelinedWriter writer_;
+  std::array<std::byte, kSectorCount * kSectorSize> source_;
+};
+
+TEST_F(PipelinedWriterTest, FullBufferIsCommittedByWorker) {
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  ASSERT_EQ(OkStatus(), writer_.Open());
+
+  ASSERT_EQ(OkStatus(),
+            writer_.Write(std::span(source_).first(kPipelineBufferSize)));
+  EXPECT_EQ(flash_.buffer()[0], kDirty);
+
+  writer_.ProcessPending();
+  EXPECT_EQ(std::memcmp(flash_.buffer().data(),
+                        source_.data(),
+                        kPipelineBufferSize),
+            0);
+  EXPECT_EQ(OkStatus(), writer_.Close());
+}
+
+TEST_F(PipelinedWriterTest, ErasesSectorsAheadOfWrites) {
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  ASSERT_EQ(OkStatus(), writer_.Open());
+
+  // Only the first sector is erased until the writes approach its end.
+  WriteInChunks(kSectorSize - kPipelineBufferSize, kPipelineBufferSize);
+  EXPECT_EQ(flash_.buffer()[kSectorSize], kDirty);
+
+  // Once the first sector is full, the next is erased before it is needed.
+  WriteInChunks(kPipelineBufferSize, kPipelineBufferSize);
+  EXPECT_EQ(flash_.buffer()[kSectorSize], flash_.erased_memory_content());
+  EXPECT_EQ(flash_.buffer()[2 * kSectorSize], kDirty);
+  EXPECT_EQ(OkStatus(), writer_.Close());
+}
+
+TEST_F(PipelinedWriterTest, WritesBlob) {
+  constexpr size_t kBlobSize = 3 * kSectorSize + 100;
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  ASSERT_EQ(OkStatus(), writer_.Open());
+
+  WriteInChunks(kBlobSize, 50);
+  EXPECT_EQ(writer_.CurrentSizeBytes(), kBlobSize);
+  ASSERT_EQ(OkStatus(), writer_.Close());
+
+  VerifyBlob(kBlobSize);
+}
+
+TEST_F(PipelinedWriterTest, WritesBlobSmallerThanBuffer) {
+  constexpr size_t kBlobSize = 10;
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  ASSERT_EQ(OkStatus(), writer_.Open());
+
+  WriteInChunks(kBlobSize, kBlobSize);
+  ASSERT_EQ(OkStatus(), writer_.Close());
+
+  VerifyBlob(kBlobSize);
+  // Only the sector that was written to was erased.
+  EXPECT_EQ(flash_.buffer()[kSectorSize], kDirty);
+}
+
+TEST_F(PipelinedWriterTest, DiscardStartsNewBlob) {
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  ASSERT_EQ(OkStatus(), writer_.Open());
+
+  WriteInChunks(300, 100);
+  ASSERT_EQ(OkStatus(), writer_.Discard());
+  EXPECT_EQ(writer_.CurrentSizeBytes(), 0u);
+
+  WriteInChunks(200, 100);
+  ASSERT_EQ(OkStatus(), writer_.Close());
+  VerifyBlob(200);
+}
+
+TEST_F(PipelinedWriterTest, FlashWriteErrorIsDataLoss) {
+  ASSERT_EQ(OkStatus(), blob_.Init());
+  ASSERT_EQ(OkStatus(), writer_.Open());
+
+  flash_.InjectWriteError(
+      kvs::FlashError::Unconditional(Status::Internal(), 1));
+  ASSERT_EQ(OkStatus(),
+            writer_.Write(std::span(source_).first(kPipelineBufferSize)));
+  writer_.ProcessPending();
+
+  EXPECT_EQ(Status::DataLoss(), writer_.Write(std::span(source_).first(1)));
+  EXPECT_EQ(Status::DataLoss(), writer_.Close());
+}
+
+}  // namespace
+}  // namespace pw::blob_store
@@ -0,0 +1,119 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "pw_blob_store/blob_store.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::blob_store {
+
+// A BlobWriter that writes to flash on a worker thread. The BlobStore's write
+// buffer is split into two halves. While the worker commits one half to flash,
+// Write() copies data into the other, so the caller waits for flash only when
+// it fills a buffer before the worker has finished with the previous one.
+//
+// Instead of erasing the whole partition before the first write, the worker
+// erases one sector at a time as the blob grows. After committing a buffer, it
+// also erases the sectors that the next buffer will be written to, so erasing
+// overlaps with the caller filling that buffer.
+//
+// The writer is a thread::ThreadCore that runs the worker, and must outlive
+// its thread:
+//
+//   pw::blob_store::BlobStoreBuffer<1024> blob(...);
+//   pw::blob_store::PipelinedWriter writer(blob);
+//
+//   pw::thread::Thread(worker_options, writer).detach();
+//
+//   // On the receive thread:
+//   writer.Open();
+//   writer.Write(data);
+//   writer.Close();
+//
+// The write buffer must hold at least two flash_write_size_bytes chunks.
+class PipelinedWriter final : public BlobStore::BlobWriter,
+                              public thread::ThreadCore {
+ public:
+  PipelinedWriter(BlobStore& store)
+      : BlobWriter(store),
+        fill_index_(0),
+        fill_size_(0),
+        in_flight_(false) {}
+  PipelinedWriter(const PipelinedWriter&) = delete;
+  PipelinedWriter& operator=(const PipelinedWriter&) = delete;
+  ~PipelinedWriter() {
+    if (open_) {
+      Close();
+    }
+  }
+
+  // Same as BlobWriter::Open() and BlobWriter::Resume().
+  Status Open();
+  Status Resume();
+
+  // Waits for the worker to finish writing, then finalizes the blob as
+  // BlobWriter::Close() does.
+  Status Close();
+
+  // Wait for the worker, then behave like the BlobWriter versions.
+  Status Erase();
+  Status Discard();
+
+  // Commits a buffer that is ready, if there is one, without blocking. This is
+  // an alternative to running the worker in a thread.
+  void ProcessPending();
+
+ private:
+  // Commits buffers as they are filled. Does not return.
+  void Run() override;
+
+  // Splits the write buffer in two and resets the pipeline, before opening.
+  void Prepare();
+
+  void Commit();
+
+  // Hands the fill buffer to the worker, after waiting for the worker to
+  // finish any previous buffer.
+  Status HandOffFillBuffer();
+
+  // Waits for the buffer in flight, if any. Returns DATA_LOSS if committing a
+  // buffer failed.
+  Status WaitForCommit();
+
+  Status DoWrite(ConstByteSpan data) override;
+
+  std::array<ByteSpan, 2> buffers_;
+  size_t fill_index_;
+  size_t fill_size_;
+
+  // Set whenever the worker has a buffer that the caller has not yet waited
+  // for. Only used by the caller.
+  bool in_flight_;
+
+  // The data being committed, and the result of committing it. Only accessed
+  // by the worker between ready_ and committed_ being released.
+  ConstByteSpan commit_data_;
+  Status commit_status_;
+
+  sync::BinarySemaphore ready_;
+  sync::BinarySemaphore committed_;
+};
+
+}  // namespace pw::blob_store
@@ -16,6 +16,7 @@
 #include <span>
 
 #include "pw_assert/assert.h"
+#include "pw_checksum/crc32.h"
 #include "pw_kvs/checksum.h"
 #include "pw_kvs/flash_memory.h"
 #include "pw_kvs/key_value_store.h"
@@ -24,6 +25,10 @@
 
 namespace pw::blob_store {
 
+class CompressingWriter;
+class DecompressingReader;
+class PipelinedWriter;
+
 // BlobStore is a storage container for a single blob of data. BlobStore is a
 // FlashPartition-backed persistent storage system with integrated data
 // integrity checking that serves as a lightweight alternative to a file
@@ -80,6 +85,27 @@ class BlobStore {
       return status;
     }
 
+    // Open a blob for writing, continuing a write that was interrupted by a
+    // reset from its last checkpoint. See BlobStore::EnableWriteCheckpoints().
+    // Data after the checkpoint is discarded, so writing continues with the
+    // byte at CurrentSizeBytes(). Returns:
+    //
+    // OK - success.
+    // NOT_FOUND - No checkpoint to resume from. Use Open() to start a new
+    //     blob.
+    // DATA_LOSS - The data in flash doesn't match the checkpoint. The
+    //     checkpoint is discarded.
+    // UNAVAILABLE - Unable to open, another writer or reader instance is
+    //     already open.
+    Status Resume() {
+      PW_DASSERT(!open_);
+      Status status = store_.ResumeWrite();
+      if (status.ok()) {
+        open_ = true;
+      }
+      return status;
+    }
+
     // Finalize a blob write. Flush all remaining buffered data to storage and
     // store blob metadata. Close fails in the closed state, do NOT retry Close
     // on error. An error may or may not result in an invalid blob stored.
@@ -180,10 +206,19 @@ class BlobStore {
 
   // Implement stream::Reader interface for BlobStore. Multiple readers may be
   // open at the same time, but readers may not be open with a writer open.
+  //
+  // An optional read-ahead buffer turns small reads into reads of the whole
+  // buffer, which are then served from RAM. Reads at least as large as the
+  // buffer go directly to flash.
   class BlobReader final : public stream::Reader {
    public:
-    constexpr BlobReader(BlobStore& store)
-        : store_(store), open_(false), offset_(0) {}
+    constexpr BlobReader(BlobStore& store, ByteSpan read_ahead_buffer = {})
+        : store_(store),
+          open_(false),
+          offset_(0),
+          read_ahead_buffer_(read_ahead_buffer),
+          buffer_offset_(0),
+          buffer_size_(0) {}
     BlobReader(const BlobReader&) = delete;
     BlobReader& operator=(const BlobReader&) = delete;
     ~BlobReader() {
@@ -210,6 +245,7 @@ class BlobStore {
       }
 
       offset_ = offset;
+      buffer_size_ = 0;
       Status status = store_.OpenRead();
       if (status.ok()) {
         open_ = true;
@@ -229,6 +265,27 @@ class BlobStore {
 
     bool IsOpen() { return open_; }
 
+    // Move to the given offset in to the blob. Seeking to the end of the blob
+    // is allowed, after which Read returns OUT_OF_RANGE. Data in the read-ahead
+    // buffer is kept, so seeking back within it doesn't read flash. Returns:
+    //
+    // OK - success.
+    // INVALID_ARGUMENT - Offset is past the end of the blob.
+    Status Seek(size_t offset) {
+      PW_DASSERT(open_);
+      if (offset > store_.ReadableDataBytes()) {
+        return Status::InvalidArgument();
+      }
+      offset_ = offset;
+      return OkStatus();
+    }
+
+    // Offset in to the blob of the next byte to read.
+    size_t Tell() const {
+      PW_DASSERT(open_);
+      return offset_;
+    }
+
     // Probable (not guaranteed) minimum number of bytes at this time that can
     // be read. Returns zero if, in the current state, Read would return status
     // other than OK. See stream.h for additional details.
@@ -248,18 +305,21 @@ class BlobStore {
     }
 
    private:
-    StatusWithSize DoRead(ByteSpan dest) override {
-      PW_DASSERT(open_);
-      StatusWithSize status = store_.Read(offset_, dest);
-      if (status.ok()) {
-        offset_ += status.size();
-      }
-      return status;
+    StatusWithSize DoRead(ByteSpan dest) override;
+
+    bool BufferHolds(size_t offset) const {
+      return offset >= buffer_offset_ && offset - buffer_offset_ < buffer_size_;
     }
 
     BlobStore& store_;
     bool open_;
     size_t offset_;
+
+    // The read-ahead buffer holds buffer_size_ bytes of the blob, starting at
+    // buffer_offset_.
+    ByteSpan read_ahead_buffer_;
+    size_t buffer_offset_;
+    size_t buffer_size_;
   };
 
   // BlobStore
@@ -294,7 +354,9 @@ class BlobStore {
         readers_open_(0),
         metadata_({}),
         write_address_(0),
-        flash_address_(0) {}
+        flash_address_(0),
+        erased_address_(0),
+        checkpoint_interval_bytes_(0) {}
 
   BlobStore(const BlobStore&) = delete;
   BlobStore& operator=(const BlobStore&) = delete;
@@ -308,7 +370,24 @@ class BlobStore {
   // Maximum number of data bytes this BlobStore is able to store.
   size_t MaxDataSizeBytes() const;
 
+  // Saves a checkpoint of blob writes in the KVS, so that a write interrupted
+  // by a reset can continue with BlobWriter::Resume() instead of starting
+  // over. A checkpoint holds the number of bytes written to flash and their
+  // CRC32, and is saved each time the bytes written to flash reach a multiple
+  // of interval_bytes. Checkpoints are stored under checkpoint_key, which must
+  // not be used by any other KVS entry.
+  //
+  // interval_bytes must be a multiple of the flash sector size, which must be
+  // a multiple of flash_write_size_bytes.
+  void EnableWriteCheckpoints(std::string_view checkpoint_key,
+                              size_t interval_bytes);
+
  private:
+  friend class CompressingWriter;
+  friend class DecompressingReader;
+  friend class PipelinedWriter;
+  friend class BlobStoreMaintenanceClient;
+
   typedef uint32_t ChecksumValue;
 
   Status LoadMetadata();
@@ -320,6 +399,16 @@ class BlobStore {
   //     already open.
   Status OpenWrite();
 
+  // Open to continue a blob write from its last checkpoint. Returns:
+  //
+  // OK - success.
+  // NOT_FOUND - Checkpoints are not enabled, or there is no checkpoint.
+  // DATA_LOSS - The checkpoint doesn't match the data in flash. The blob is
+  //     invalidated.
+  // UNAVAILABLE - Unable to open writer, another writer or reader instance is
+  //     already open.
+  Status ResumeWrite();
+
   // Open to do a blob read. Returns:
   //
   // OK - success.
@@ -327,12 +416,14 @@ class BlobStore {
   Status OpenRead();
 
   // Finalize a blob write. Flush all remaining buffered data to storage and
-  // store blob metadata. Returns:
+  // store blob metadata. A compressed blob passes its uncompressed size and
+  // checksum to store along with the metadata. Returns:
   //
   // OK - success, valid complete blob.
   // DATA_LOSS - Error during write (this close or previous write/flush). Blob
   //     is closed and marked as invalid.
-  Status CloseWrite();
+  Status CloseWrite(size_t uncompressed_size_bytes = 0,
+                    ChecksumValue uncompressed_checksum = 0);
   Status CloseRead();
 
   // Write/append data to the in-progress blob write. Data is written
@@ -405,6 +496,15 @@ class BlobStore {
 
   Status EraseIfNeeded();
 
+  // Erase the sectors from erased_address_ through at least size_bytes past
+  // flash_address_, rather than erasing the whole partition before the first
+  // write. Used by PipelinedWriter and BlobStoreMaintenanceClient to erase
+  // ahead of the data being written.
+  Status EraseAhead(size_t size_bytes);
+
+  // Number of erased bytes ready to write past the data written to flash.
+  size_t ErasedBytesAhead() const;
+
   // Blob is valid/OK and has data to read.
   bool ValidToRead() const { return (valid_data_ && ReadableDataBytes() > 0); }
 
@@ -449,10 +549,27 @@ class BlobStore {
 
   Status CalculateChecksumFromFlash(size_t bytes_to_check);
 
+  // The progress of a blob write, saved so the write can be resumed.
+  struct WriteCheckpoint {
+    // Number of blob data bytes written to flash.
+    size_t committed_bytes;
+
+    // CRC32 of the blob data written to flash.
+    ChecksumValue committed_crc32;
+  };
+
+  void SaveCheckpoint();
+
+  // Checks the data in flash against the checkpoint, restores the checksum
+  // state, and erases the sectors after the checkpoint.
+  Status RestoreCheckpoint(const WriteCheckpoint& checkpoint);
+
   const std::string_view MetadataKey() { return name_; }
 
   // Changes to the metadata format should also get a different key signature to
-  // avoid new code improperly reading old format metadata.
+  // avoid new code improperly reading old format metadata. The exception is
+  // fields added to the end that are zero in old metadata, which is loaded as
+  // if they were zero.
   struct BlobMetadata {
     // The checksum of the blob data stored in flash.
     ChecksumValue checksum;
@@ -460,10 +577,19 @@ class BlobStore {
     // Number of blob data bytes stored in flash.
     size_t data_size_bytes;
 
+    // Size in bytes of the blob before it was compressed, or 0 if the blob is
+    // not compressed.
+    size_t uncompressed_size_bytes;
+
+    // CRC32 of the blob before it was compressed.
+    ChecksumValue uncompressed_checksum;
+
     constexpr void reset() {
       *this = {
           .checksum = 0,
           .data_size_bytes = 0,
+          .uncompressed_size_bytes = 0,
+          .uncompressed_checksum = 0,
       };
     }
   };
@@ -511,6 +637,17 @@ class BlobStore {
   // Current index of end of data written to flash. Number of buffered data
   // bytes is write_address_ - flash_address_.
   kvs::FlashPartition::Address flash_address_;
+
+  // End of the sectors erased by EraseAhead(). Zero when the partition is
+  // erased all at once.
+  kvs::FlashPartition::Address erased_address_;
+
+  // KVS key for write checkpoints, or empty if checkpoints are disabled.
+  std::string_view checkpoint_key_;
+  size_t checkpoint_interval_bytes_;
+
+  // CRC32 of the data written to flash, for write checkpoints.
+  checksum::Crc32 committed_crc_;
 };
 
 // Creates a BlobStore with the buffer of kBufferSizeBytes.
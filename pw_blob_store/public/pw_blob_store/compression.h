@@ -0,0 +1,198 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "pw_assert/assert.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_checksum/crc32.h"
+#include "pw_kvs/internal/lz_codec.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::blob_store {
+
+// A BlobWriter that compresses the blob as it is written. The uncompressed size
+// and CRC32 of the blob are stored in its metadata. Data that doesn't compress
+// grows by at most one byte in eight.
+//
+// Compressed blobs are read with a DecompressingReader. A BlobReader reads the
+// compressed data.
+class CompressingWriter final : public BlobStore::BlobWriter {
+ public:
+  constexpr CompressingWriter(BlobStore& store)
+      : BlobWriter(store), flash_writer_(store), uncompressed_size_(0) {}
+  CompressingWriter(const CompressingWriter&) = delete;
+  CompressingWriter& operator=(const CompressingWriter&) = delete;
+  ~CompressingWriter() {
+    if (open_) {
+      Close();
+    }
+  }
+
+  // Open a blob for writing. See BlobWriter::Open().
+  Status Open() {
+    Reset();
+    return BlobWriter::Open();
+  }
+
+  // Compress any held data and finalize the blob write. Close fails in the
+  // closed state, do NOT retry Close on error. Returns:
+  //
+  // OK - success.
+  // DATA_LOSS - Error writing data, or the compressed blob did not fit. The
+  //     blob is closed and marked as invalid.
+  Status Close();
+
+  // Erase the blob partition and start a new blob. See BlobWriter::Erase().
+  Status Erase() {
+    PW_DASSERT(open_);
+    Reset();
+    return store_.Erase();
+  }
+
+  // Discard the current blob and start a new one. See BlobWriter::Discard().
+  Status Discard() {
+    PW_DASSERT(open_);
+    Reset();
+    return store_.Invalidate();
+  }
+
+  // Probable (not guaranteed) minimum number of uncompressed bytes at this time
+  // that can be written, assuming the data doesn't compress.
+  size_t ConservativeWriteLimit() const override {
+    PW_DASSERT(open_);
+    return store_.WriteBytesRemaining() / 9 * 8;
+  }
+
+  // Number of uncompressed bytes written.
+  size_t CurrentSizeBytes() {
+    PW_DASSERT(open_);
+    return uncompressed_size_;
+  }
+
+ private:
+  // Writes compressed data to the blob.
+  class FlashWriter final : public stream::Writer {
+   public:
+    constexpr FlashWriter(BlobStore& store) : store_(store) {}
+
+   private:
+    Status DoWrite(ConstByteSpan data) override { return store_.Write(data); }
+
+    BlobStore& store_;
+  };
+
+  void Reset() {
+    encoder_.Reset();
+    crc_.clear();
+    uncompressed_size_ = 0;
+    status_ = OkStatus();
+  }
+
+  Status DoWrite(ConstByteSpan data) override;
+
+  FlashWriter flash_writer_;
+  kvs::internal::LzEncoder encoder_;
+  checksum::Crc32 crc_;
+  size_t uncompressed_size_;
+
+  // Once writing compressed data fails, the blob is incomplete.
+  Status status_;
+};
+
+// Implement stream::Reader for blobs written by a CompressingWriter, returning
+// the uncompressed data. The size and CRC32 of the uncompressed data are
+// checked when the end of the blob is read. Blobs that are not compressed are
+// read unchanged.
+//
+// As with BlobReader, multiple readers may be open at the same time, but
+// readers may not be open with a writer open.
+class DecompressingReader final : public stream::Reader {
+ public:
+  constexpr DecompressingReader(BlobStore& store)
+      : store_(store),
+        open_(false),
+        offset_(0),
+        input_buffer_{},
+        input_() {}
+  DecompressingReader(const DecompressingReader&) = delete;
+  DecompressingReader& operator=(const DecompressingReader&) = delete;
+  ~DecompressingReader() {
+    if (open_) {
+      Close();
+    }
+  }
+
+  // Open to read the blob from the start. Returns:
+  //
+  // OK - success.
+  // FAILED_PRECONDITION - No readable blob available.
+  // UNAVAILABLE - Unable to open, a writer is open.
+  Status Open();
+
+  // Finish reading a blob. Close fails in the closed state, do NOT retry Close
+  // on error. Returns:
+  //
+  // OK - success.
+  Status Close() {
+    PW_DASSERT(open_);
+    open_ = false;
+    return store_.CloseRead();
+  }
+
+  bool IsOpen() { return open_; }
+
+  // True if the blob was written by a CompressingWriter.
+  bool IsCompressed() const {
+    return store_.metadata_.uncompressed_size_bytes != 0;
+  }
+
+  // Size in bytes of the blob once it is decompressed.
+  size_t UncompressedSizeBytes() const {
+    return IsCompressed() ? store_.metadata_.uncompressed_size_bytes
+                          : store_.ReadableDataBytes();
+  }
+
+  // Probable (not guaranteed) minimum number of uncompressed bytes at this time
+  // that can be read. Returns zero if, in the current state, Read would return
+  // status other than OK. See stream.h for additional details.
+  size_t ConservativeReadLimit() const override {
+    PW_DASSERT(open_);
+    const size_t read = IsCompressed() ? decoder_.output_size() : offset_;
+    return UncompressedSizeBytes() - read;
+  }
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override;
+
+  StatusWithSize Decompress(ByteSpan dest);
+
+  BlobStore& store_;
+  bool open_;
+
+  // Offset into the blob data of the next bytes to read.
+  size_t offset_;
+
+  // Compressed data read from the blob that is not yet decoded.
+  std::array<std::byte, 32> input_buffer_;
+  ConstByteSpan input_;
+
+  kvs::internal::LzDecoder decoder_;
+  checksum::Crc32 crc_;
+};
+
+}  // namespace pw::blob_store
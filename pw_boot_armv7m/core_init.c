@@ -44,7 +44,7 @@
 //   2. PC and SP set (from vector_table by SoC, or by bootloader)
 //   3. pw_boot_Entry()
 //     3.1. pw_boot_PreStaticMemoryInit();
-//     3.2. Static-init memory (.data, .bss)
+//     3.2. Static-init memory (.data, .bss, fast RAM code and data)
 //     3.3. pw_boot_PreStaticConstructorInit();
 //     3.4. Static C++ constructors
 //     3.5. pw_boot_PreMainInit()
@@ -65,24 +65,101 @@ extern uint8_t _pw_static_init_ram_end;
 extern uint8_t _pw_static_init_flash_start;
 extern uint8_t _pw_zero_init_ram_start;
 extern uint8_t _pw_zero_init_ram_end;
+extern uint8_t _pw_fast_code_flash_start;
+extern uint8_t _pw_fast_code_ram_start;
+extern uint8_t _pw_fast_code_ram_end;
+extern uint8_t _pw_fast_data_flash_start;
+extern uint8_t _pw_fast_data_ram_start;
+extern uint8_t _pw_fast_data_ram_end;
 
 // Functions called as part of firmware initialization.
 void __libc_init_array(void);
 
+// Returns true if the address is word aligned.
+static inline bool IsWordAligned(const void* address) {
+  return ((uintptr_t)address % sizeof(uint32_t)) == 0u;
+}
+
+// Copies a memory region from flash to RAM. The linker script aligns sections
+// to 8 bytes, so this copies four words at a time, which the compiler turns
+// into load and store multiple instructions. This is much faster for large
+// sections than a size-optimized libc memcpy, which may copy a byte at a time.
+// Falls back to memcpy if the region is not word aligned.
+static void CopyMemory(uint8_t* dest_start,
+                       const uint8_t* src_start,
+                       const uint8_t* dest_end) {
+  if (!IsWordAligned(dest_start) || !IsWordAligned(src_start) ||
+      !IsWordAligned(dest_end)) {
+    memcpy(dest_start, src_start, dest_end - dest_start);
+    return;
+  }
+
+  uint32_t* dest = (uint32_t*)dest_start;
+  const uint32_t* src = (const uint32_t*)src_start;
+  uint32_t* const end = (uint32_t*)dest_end;
+
+  while (end - dest >= 4) {
+    dest[0] = src[0];
+    dest[1] = src[1];
+    dest[2] = src[2];
+    dest[3] = src[3];
+    dest += 4;
+    src += 4;
+    // Prevent the compiler from replacing the loop with a call to memcpy.
+    __asm__ volatile("");
+  }
+  while (dest < end) {
+    *dest++ = *src++;
+  }
+}
+
+// Zeroes a memory region in RAM, four words at a time like CopyMemory().
+static void ZeroMemory(uint8_t* start, const uint8_t* end_bytes) {
+  if (!IsWordAligned(start) || !IsWordAligned(end_bytes)) {
+    memset(start, 0, end_bytes - start);
+    return;
+  }
+
+  uint32_t* dest = (uint32_t*)start;
+  uint32_t* const end = (uint32_t*)end_bytes;
+
+  while (end - dest >= 4) {
+    dest[0] = 0u;
+    dest[1] = 0u;
+    dest[2] = 0u;
+    dest[3] = 0u;
+    dest += 4;
+    // Prevent the compiler from replacing the loop with a call to memset.
+    __asm__ volatile("");
+  }
+  while (dest < end) {
+    *dest++ = 0u;
+  }
+}
+
 // WARNING: Be EXTREMELY careful when running code before this function
 // completes. The context before this function violates the C spec
 // (Section 6.7.8, paragraph 10 for example, which requires uninitialized static
 // values to be zero-initialized).
 void StaticMemoryInit(void) {
   // Static-init RAM (load static values into ram, .data section init).
-  memcpy(&_pw_static_init_ram_start,
-         &_pw_static_init_flash_start,
-         &_pw_static_init_ram_end - &_pw_static_init_ram_start);
-
-  // Zero-init RAM (.bss section init).
-  memset(&_pw_zero_init_ram_start,
-         0,
-         &_pw_zero_init_ram_end - &_pw_zero_init_ram_start);
+  CopyMemory(&_pw_static_init_ram_start,
+             &_pw_static_init_flash_start,
+             &_pw_static_init_ram_end);
+
+  // Zero-init RAM (.bss section init). The .no_init_ram section is skipped.
+  ZeroMemory(&_pw_zero_init_ram_start, &_pw_zero_init_ram_end);
+
+  // Load code and data placed in fast RAM (e.g. ITCM and DTCM) from flash.
+  CopyMemory(&_pw_fast_code_ram_start,
+             &_pw_fast_code_flash_start,
+             &_pw_fast_code_ram_end);
+  CopyMemory(&_pw_fast_data_ram_start,
+             &_pw_fast_data_flash_start,
+             &_pw_fast_data_ram_end);
+
+  // Ensure the copied code is written before any of it is fetched.
+  __asm__ volatile("dsb\n\tisb" ::: "memory");
 }
 
 // WARNING: This code is run immediately upon boot, and performs initialization
@@ -40,6 +40,9 @@ endmacro()
 #    - only a dependency on the main module library.
 #  - The module is not a facade.
 #
+# Tests that do not meet these requirements may be left out with EXCLUDE_TESTS
+# and declared separately, if they can be built with CMake.
+#
 # Modules that do not meet these requirements may not use
 # pw_auto_add_simple_module. Instead, define the module's libraries and tests
 # with pw_add_module_library, pw_add_facade, pw_add_test, and the standard CMake
@@ -57,12 +60,13 @@ endmacro()
 #   IMPLEMENTS_FACADE - this module implements the specified facade
 #   PUBLIC_DEPS - public target_link_libraries arguments
 #   PRIVATE_DEPS - private target_link_libraries arguments
+#   EXCLUDE_TESTS - _test.cc files for which not to declare tests
 #
 function(pw_auto_add_simple_module MODULE)
   _pw_parse_argv_strict(pw_auto_add_simple_module 1
       ""
       "IMPLEMENTS_FACADE"
-      "PUBLIC_DEPS;PRIVATE_DEPS;TEST_DEPS"
+      "PUBLIC_DEPS;PRIVATE_DEPS;TEST_DEPS;EXCLUDE_TESTS"
   )
 
   file(GLOB all_sources *.cc *.c)
@@ -105,6 +109,8 @@ function(pw_auto_add_simple_module MODULE)
       ${arg_TEST_DEPS}
     GROUPS
       ${groups}
+    EXCLUDE_TESTS
+      ${arg_EXCLUDE_TESTS}
   )
 endfunction(pw_auto_add_simple_module)
 
@@ -115,16 +121,21 @@ endfunction(pw_auto_add_simple_module)
 #
 #  PRIVATE_DEPS - dependencies to apply to all tests
 #  GROUPS - groups in addition to MODULE to which to add these tests
+#  EXCLUDE_TESTS - _test.cc files for which not to declare tests
 #
 function(pw_auto_add_module_tests MODULE)
   _pw_parse_argv_strict(pw_auto_add_module_tests 1
       ""
       ""
-      "PRIVATE_DEPS;GROUPS"
+      "PRIVATE_DEPS;GROUPS;EXCLUDE_TESTS"
   )
 
   file(GLOB cc_tests *_test.cc)
 
+  foreach(excluded IN LISTS arg_EXCLUDE_TESTS)
+    list(REMOVE_ITEM cc_tests "${CMAKE_CURRENT_SOURCE_DIR}/${excluded}")
+  endforeach()
+
   foreach(test IN LISTS cc_tests)
     get_filename_component(test_name "${test}" NAME_WE)
 
@@ -16,6 +16,7 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 #include "gtest/gtest.h"
 
@@ -862,5 +863,38 @@ TEST(ByteBuffer, Iterator_ReadValues_8Bytes) {
   EXPECT_EQ(it.ReadUint64(), uint64_t(0x000001E8A7A0D569));
   EXPECT_EQ(it.ReadInt64(std::endian::big), int64_t(0xFFFFFE17585F2A97));
 }
+
+TEST(ByteBuffer, PutArray_LittleAndBigEndian) {
+  constexpr std::array<uint16_t, 3> kValues = {0x0102, 0x0304, 0x0506};
+  ByteBuffer<12> bb;
+  bb.PutArray(std::span(kValues));
+  bb.PutArray(std::span(kValues), std::endian::big);
+
+  EXPECT_EQ(OkStatus(), bb.status());
+  constexpr auto kExpected = MakeBytes(
+      0x02, 0x01, 0x04, 0x03, 0x06, 0x05, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06);
+  ASSERT_EQ(kExpected.size(), bb.size());
+  EXPECT_EQ(0, std::memcmp(kExpected.data(), bb.data(), bb.size()));
+}
+
+TEST(ByteBuffer, PutArray_ReadBackWithIterator) {
+  const int32_t values[] = {-1, 0x12345678, -0x12345678};
+  ByteBuffer<12> bb;
+  bb.PutArray(std::span(values), std::endian::big);
+
+  auto it = bb.begin();
+  for (int32_t value : values) {
+    EXPECT_EQ(value, it.ReadInt32(std::endian::big));
+  }
+}
+
+TEST(ByteBuffer, PutArray_Exhausted_WritesNothing) {
+  constexpr std::array<uint32_t, 2> kValues = {1, 2};
+  ByteBuffer<7> bb;
+  bb.PutArray(std::span(kValues));
+  EXPECT_EQ(Status::ResourceExhausted(), bb.status());
+  EXPECT_EQ(0u, bb.size());
+}
+
 }  // namespace
 }  // namespace pw
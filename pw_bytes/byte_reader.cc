@@ -0,0 +1,40 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_bytes/byte_reader.h"
+
+#include <cstring>
+
+namespace pw {
+
+Status ByteReader::GetBytes(ByteSpan destination) {
+  const std::byte* data = Consume(destination.size());
+  if (ok() && !destination.empty()) {
+    std::memcpy(destination.data(), data, destination.size());
+  }
+  return status_;
+}
+
+const std::byte* ByteReader::Consume(size_t size_bytes) {
+  if (!status_.ok() || size_bytes > remaining()) {
+    status_ = Status::OutOfRange();
+    return nullptr;
+  }
+
+  const std::byte* data = buffer_.data() + position_;
+  position_ += size_bytes;
+  return data;
+}
+
+}  // namespace pw
@@ -0,0 +1,157 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_bytes/byte_reader.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_bytes/byte_builder.h"
+
+namespace pw {
+namespace {
+
+constexpr auto kData = bytes::Array<0x01,
+                                    0x02,
+                                    0x03,
+                                    0x04,
+                                    0x05,
+                                    0x06,
+                                    0x07,
+                                    0x08,
+                                    0x09,
+                                    0x0a,
+                                    0x0b,
+                                    0x0c,
+                                    0x0d,
+                                    0x0e,
+                                    0x0f>();
+
+TEST(ByteReader, EmptyBuffer) {
+  ByteReader reader(ConstByteSpan{});
+  EXPECT_TRUE(reader.empty());
+  EXPECT_EQ(0u, reader.remaining());
+  EXPECT_EQ(OkStatus(), reader.Skip(0));
+  EXPECT_EQ(0u, reader.GetUint8());
+  EXPECT_EQ(Status::OutOfRange(), reader.status());
+}
+
+TEST(ByteReader, GetValues_AdvancesPosition) {
+  ByteReader reader(kData);
+  EXPECT_EQ(0x01u, reader.GetUint8());
+  EXPECT_EQ(0x0302u, reader.GetUint16());
+  EXPECT_EQ(0x04050607u, reader.GetUint32(std::endian::big));
+  EXPECT_EQ(0x0f0e0d0c0b0a0908u, reader.GetUint64());
+
+  EXPECT_EQ(OkStatus(), reader.status());
+  EXPECT_EQ(kData.size(), reader.position());
+  EXPECT_TRUE(reader.empty());
+}
+
+TEST(ByteReader, GetSignedValues) {
+  constexpr auto kSigned = bytes::Array<0xff, 0xfe, 0xff, 0xff, 0xff, 0xff>();
+  ByteReader reader(kSigned);
+  EXPECT_EQ(-1, reader.GetInt8());
+  EXPECT_EQ(-2, reader.GetInt8());
+  EXPECT_EQ(-1, reader.GetInt32());
+}
+
+TEST(ByteReader, ReadPastEnd_FailsAndLeavesPosition) {
+  ByteReader reader(ConstByteSpan(kData).first(3));
+  EXPECT_EQ(0x0201u, reader.GetUint16());
+  EXPECT_EQ(0u, reader.GetUint16());
+  EXPECT_EQ(Status::OutOfRange(), reader.status());
+  EXPECT_EQ(2u, reader.position());
+
+  // Later reads fail too, even if they would fit.
+  EXPECT_EQ(0u, reader.GetUint8());
+  EXPECT_EQ(2u, reader.position());
+
+  reader.clear_status();
+  EXPECT_EQ(0x03u, reader.GetUint8());
+  EXPECT_EQ(OkStatus(), reader.status());
+}
+
+TEST(ByteReader, Get_MultipleValues) {
+  ByteReader reader(kData);
+  uint8_t a = 0;
+  uint16_t b = 0;
+  int32_t c = 0;
+  EXPECT_EQ(OkStatus(), reader.Get(std::endian::big, a, b, c));
+  EXPECT_EQ(0x01u, a);
+  EXPECT_EQ(0x0203u, b);
+  EXPECT_EQ(0x04050607, c);
+  EXPECT_EQ(7u, reader.position());
+}
+
+TEST(ByteReader, Get_DoesNotFit_ValuesUnchanged) {
+  ByteReader reader(kData);
+  uint64_t a = 1;
+  uint64_t b = 2;
+  EXPECT_EQ(Status::OutOfRange(), reader.Get(std::endian::little, a, b));
+  EXPECT_EQ(1u, a);
+  EXPECT_EQ(2u, b);
+  EXPECT_EQ(0u, reader.position());
+}
+
+TEST(ByteReader, GetArray) {
+  std::array<uint16_t, 3> little = {};
+  std::array<uint16_t, 3> big = {};
+  ByteReader reader(kData);
+  EXPECT_EQ(OkStatus(), reader.GetArray(std::span(little)));
+  EXPECT_EQ(OkStatus(), reader.GetArray(std::span(big), std::endian::big));
+
+  EXPECT_EQ((std::array<uint16_t, 3>{0x0201, 0x0403, 0x0605}), little);
+  EXPECT_EQ((std::array<uint16_t, 3>{0x0708, 0x090a, 0x0b0c}), big);
+  EXPECT_EQ(3u, reader.remaining());
+}
+
+TEST(ByteReader, GetArray_DoesNotFit_ArrayUnchanged) {
+  std::array<uint32_t, 4> values = {1, 2, 3, 4};
+  ByteReader reader(kData);
+  EXPECT_EQ(Status::OutOfRange(), reader.GetArray(std::span(values)));
+  EXPECT_EQ((std::array<uint32_t, 4>{1, 2, 3, 4}), values);
+}
+
+TEST(ByteReader, GetBytesAndSkip) {
+  std::array<std::byte, 4> bytes = {};
+  ByteReader reader(kData);
+  EXPECT_EQ(OkStatus(), reader.Skip(10));
+  EXPECT_EQ(OkStatus(), reader.GetBytes(bytes));
+  EXPECT_EQ((bytes::Array<0x0b, 0x0c, 0x0d, 0x0e>()), bytes);
+  EXPECT_EQ(Status::OutOfRange(), reader.GetBytes(bytes));
+  EXPECT_EQ(1u, reader.remaining_bytes().size());
+}
+
+TEST(ByteReader, RoundTripWithByteBuilder) {
+  constexpr std::array<int16_t, 4> kSamples = {-300, 0, 1, 32767};
+  ByteBuffer<32> frame;
+  frame.PutUint16(0xcafe, std::endian::big);
+  frame.PutUint32(123456, std::endian::big);
+  frame.PutArray(std::span(kSamples), std::endian::big);
+
+  ByteReader reader(std::span(frame.data(), frame.size()));
+  EXPECT_EQ(0xcafeu, reader.GetUint16(std::endian::big));
+  EXPECT_EQ(123456u, reader.GetUint32(std::endian::big));
+  std::array<int16_t, 4> samples = {};
+  EXPECT_EQ(OkStatus(), reader.GetArray(std::span(samples), std::endian::big));
+  EXPECT_EQ(kSamples, samples);
+  EXPECT_TRUE(reader.empty());
+}
+
+}  // namespace
+}  // namespace pw
@@ -18,6 +18,8 @@
 #include <bit>
 #include <cstddef>
 #include <cstring>
+#include <span>
+#include <type_traits>
 
 #include "pw_bytes/endian.h"
 #include "pw_bytes/span.h"
@@ -326,6 +328,22 @@ class ByteBuilder {
     return PutUint64(static_cast<uint64_t>(value), order);
   }
 
+  // Appends an array of integers in the specified byte order. Either the whole
+  // array is appended or, if it does not fit, nothing is and the status is set
+  // to RESOURCE_EXHAUSTED. Swapping a whole array at once is much faster than
+  // appending each value separately.
+  template <typename T, size_t kExtent>
+  ByteBuilder& PutArray(std::span<T, kExtent> values,
+                        std::endian order = std::endian::little) {
+    static_assert(std::is_integral_v<T>, "PutArray requires integers");
+    std::byte* const append_destination = buffer_.data() + size_;
+    if (ResizeForAppend(values.size_bytes()) != 0u) {
+      bytes::internal::CopyArrayInOrder(
+          order, values.data(), values.size(), append_destination);
+    }
+    return *this;
+  }
+
  protected:
   // Functions to support ByteBuffer copies.
   constexpr ByteBuilder(const ByteSpan& buffer, const ByteBuilder& other)
@@ -0,0 +1,161 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "pw_bytes/endian.h"
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+
+namespace pw {
+
+// ByteReader reads integers and bytes from a buffer, such as one written with a
+// ByteBuilder. It is a cursor that advances through the buffer and checks the
+// bounds of every read.
+//
+// Like ByteBuilder, ByteReader tracks its status instead of requiring a check
+// after each read. A read past the end of the buffer reads nothing, returns 0
+// for single values, and sets the status to OUT_OF_RANGE. After a read fails,
+// all later reads fail too, so a whole message can be parsed and then checked
+// once:
+//
+//   ByteReader reader(frame);
+//   const uint16_t id = reader.GetUint16(std::endian::big);
+//   uint32_t timestamp;
+//   int16_t x, y, z;
+//   reader.Get(std::endian::big, timestamp, x, y, z);
+//   std::array<uint16_t, 8> samples;
+//   reader.GetArray(std::span(samples), std::endian::big);
+//
+//   if (!reader.ok()) {
+//     return reader.status();  // The frame was too short.
+//   }
+//
+class ByteReader {
+ public:
+  constexpr ByteReader(ConstByteSpan buffer) : buffer_(buffer), position_(0) {}
+
+  // OK if all reads succeeded, or OUT_OF_RANGE if a read went past the end.
+  Status status() const { return status_; }
+
+  // True if status() is OkStatus().
+  bool ok() const { return status_.ok(); }
+
+  // Resets the status to OK, so that reads may continue after a failure.
+  void clear_status() { status_ = OkStatus(); }
+
+  // The number of bytes read so far.
+  size_t position() const { return position_; }
+
+  // The number of bytes that have not been read.
+  size_t remaining() const { return buffer_.size() - position_; }
+
+  // True if every byte has been read.
+  bool empty() const { return remaining() == 0u; }
+
+  // The bytes that have not been read.
+  ConstByteSpan remaining_bytes() const { return buffer_.subspan(position_); }
+
+  uint8_t GetUint8() { return GetInOrder<uint8_t>(std::endian::little); }
+
+  int8_t GetInt8() { return static_cast<int8_t>(GetUint8()); }
+
+  uint16_t GetUint16(std::endian order = std::endian::little) {
+    return GetInOrder<uint16_t>(order);
+  }
+
+  int16_t GetInt16(std::endian order = std::endian::little) {
+    return static_cast<int16_t>(GetUint16(order));
+  }
+
+  uint32_t GetUint32(std::endian order = std::endian::little) {
+    return GetInOrder<uint32_t>(order);
+  }
+
+  int32_t GetInt32(std::endian order = std::endian::little) {
+    return static_cast<int32_t>(GetUint32(order));
+  }
+
+  uint64_t GetUint64(std::endian order = std::endian::little) {
+    return GetInOrder<uint64_t>(order);
+  }
+
+  int64_t GetInt64(std::endian order = std::endian::little) {
+    return static_cast<int64_t>(GetUint64(order));
+  }
+
+  // Reads several integers of any size in the specified byte order, with a
+  // single bounds check. If they do not all fit, none of the values are
+  // changed and OUT_OF_RANGE is returned.
+  template <typename... T>
+  Status Get(std::endian order, T&... values) {
+    static_assert((std::is_integral_v<T> && ...), "Get requires integers");
+    const std::byte* data = Consume((sizeof(T) + ... + 0));
+    if (!ok()) {
+      return status_;
+    }
+    ((values = bytes::ReadInOrder<T>(order, data), data += sizeof(T)), ...);
+    return OkStatus();
+  }
+
+  // Fills an array of integers in the specified byte order. If the whole array
+  // cannot be read, it is not changed and OUT_OF_RANGE is returned. Reading a
+  // whole array at once is much faster than reading each value separately.
+  template <typename T, size_t kExtent>
+  Status GetArray(std::span<T, kExtent> values,
+                  std::endian order = std::endian::little) {
+    static_assert(std::is_integral_v<T> && !std::is_const_v<T>,
+                  "GetArray requires a span of mutable integers");
+    const std::byte* data = Consume(values.size_bytes());
+    if (!ok()) {
+      return status_;
+    }
+    bytes::internal::ReadArrayInOrder(
+        order, data, values.data(), values.size());
+    return OkStatus();
+  }
+
+  // Copies destination.size() bytes. If there are not enough bytes, nothing is
+  // copied and OUT_OF_RANGE is returned.
+  Status GetBytes(ByteSpan destination);
+
+  // Advances past bytes without reading them.
+  Status Skip(size_t size_bytes) {
+    Consume(size_bytes);
+    return status_;
+  }
+
+ private:
+  template <typename T>
+  T GetInOrder(std::endian order) {
+    const std::byte* data = Consume(sizeof(T));
+    return ok() ? bytes::ReadInOrder<T>(order, data) : T(0);
+  }
+
+  // Returns the next size_bytes bytes and advances past them. If they are not
+  // available, or an earlier read failed, the status is set to OUT_OF_RANGE and
+  // the result must not be used.
+  const std::byte* Consume(size_t size_bytes);
+
+  const ConstByteSpan buffer_;
+  size_t position_;
+  Status status_;
+};
+
+}  // namespace pw
@@ -15,6 +15,7 @@
 
 #include <array>
 #include <bit>
+#include <cstddef>
 #include <cstring>
 #include <span>
 #include <type_traits>
@@ -104,6 +105,45 @@ constexpr T ReverseBytes(T value) {
   }
 }
 
+// Copies count integers to an unaligned buffer in the specified byte order.
+// When the order differs from the native order, the loop is a simple
+// load-swap-store over the array, which compilers can vectorize.
+template <typename T>
+void CopyArrayInOrder(std::endian order,
+                      const T* values,
+                      size_t count,
+                      std::byte* buffer) {
+  if (count == 0u) {
+    return;
+  }
+  if (sizeof(T) == 1u || order == std::endian::native) {
+    std::memcpy(buffer, values, count * sizeof(T));
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    const T value = ReverseBytes(values[i]);
+    std::memcpy(buffer + i * sizeof(T), &value, sizeof(T));
+  }
+}
+
+// Reads count integers in the specified byte order from an unaligned buffer.
+template <typename T>
+void ReadArrayInOrder(std::endian order,
+                      const std::byte* buffer,
+                      T* values,
+                      size_t count) {
+  if (count == 0u) {
+    return;
+  }
+  std::memcpy(values, buffer, count * sizeof(T));
+  if (sizeof(T) == 1u || order == std::endian::native) {
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = ReverseBytes(values[i]);
+  }
+}
+
 }  // namespace internal
 
 // Functions for reordering bytes in the provided integral value to match the
@@ -0,0 +1,120 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program measures the throughput of each CRC32 and CRC-16-CCITT
+// implementation in pw_checksum. Build the checksum_benchmark target for the
+// target of interest and run it; results are logged with pw_log.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_checksum/crc16_ccitt.h"
+#include "pw_checksum/crc32.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+// Runs a checksum over the data, starting from and returning its state.
+using ChecksumFunction = uint32_t (*)(const void* data,
+                                      size_t size_bytes,
+                                      uint32_t state);
+
+struct Implementation {
+  const char* name;
+  ChecksumFunction function;
+  uint32_t initial_state;
+};
+
+template <uint16_t (*kFunction)(const void*, size_t, uint16_t)>
+uint32_t Crc16(const void* data, size_t size_bytes, uint32_t state) {
+  return kFunction(data, size_bytes, uint16_t(state));
+}
+
+constexpr uint32_t kCrc32State = _PW_CHECKSUM_CRC32_INITIAL_STATE;
+constexpr uint32_t kCrc16State = pw::checksum::Crc16Ccitt::kInitialValue;
+
+constexpr Implementation kImplementations[] = {
+    {"CRC32 selected (_pw_checksum_InternalCrc32)",
+     _pw_checksum_InternalCrc32,
+     kCrc32State},
+    {"CRC32 byte table", _pw_checksum_InternalCrc32ByteTable, kCrc32State},
+    {"CRC32 slicing-by-8", _pw_checksum_InternalCrc32SlicingBy8, kCrc32State},
+#if defined(__ARM_FEATURE_CRC32) && __ARM_FEATURE_CRC32
+    {"CRC32 ARMv8 CRC32 instructions",
+     _pw_checksum_InternalCrc32Armv8,
+     kCrc32State},
+#endif  // __ARM_FEATURE_CRC32
+    {"CRC-16-CCITT selected (pw_checksum_Crc16Ccitt)",
+     Crc16<pw_checksum_Crc16Ccitt>,
+     kCrc16State},
+    {"CRC-16-CCITT nibble table",
+     Crc16<_pw_checksum_InternalCrc16CcittNibbleTable>,
+     kCrc16State},
+    {"CRC-16-CCITT byte table",
+     Crc16<_pw_checksum_InternalCrc16CcittByteTable>,
+     kCrc16State},
+    {"CRC-16-CCITT slicing-by-8",
+     Crc16<_pw_checksum_InternalCrc16CcittSlicingBy8>,
+     kCrc16State},
+};
+
+constexpr size_t kBufferSizeBytes = 4096;
+constexpr size_t kIterations = 256;
+
+std::array<std::byte, kBufferSizeBytes> buffer;
+
+// Stores the results so the calculations are not optimized out.
+volatile uint32_t result;
+
+void RunBenchmark(const Implementation& implementation) {
+  uint32_t state = implementation.initial_state;
+
+  const SystemClock::time_point start = SystemClock::now();
+  for (size_t i = 0; i < kIterations; ++i) {
+    state = implementation.function(buffer.data(), buffer.size(), state);
+  }
+  const SystemClock::duration elapsed = SystemClock::now() - start;
+
+  result = state;
+
+  const int64_t elapsed_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  const uint64_t total_bytes = uint64_t(kBufferSizeBytes) * kIterations;
+
+  PW_LOG_INFO("%s: %u bytes in %u us (%u KiB/s)",
+              implementation.name,
+              unsigned(total_bytes),
+              unsigned(elapsed_us),
+              elapsed_us > 0
+                  ? unsigned(total_bytes * 1'000'000 / 1024 / elapsed_us)
+                  : 0u);
+}
+
+}  // namespace
+
+int main() {
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = std::byte(i * 131 + 7);
+  }
+
+  for (const Implementation& implementation : kImplementations) {
+    RunBenchmark(implementation);
+  }
+  return 0;
+}
@@ -14,6 +14,10 @@
 
 #include "pw_checksum/crc16_ccitt.h"
 
+#include <array>
+
+#include "pw_checksum_private/config.h"
+
 namespace pw::checksum {
 namespace {
 
@@ -52,11 +56,54 @@ constexpr uint16_t kCrc16CcittTable[256]{
     0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,  // 256
 };
 
+// Table for processing four bits at a time. Entry i is the CRC of the nibble i
+// shifted into an empty CRC, which matches the first 16 entries of the byte
+// table.
+constexpr uint16_t kCrc16CcittNibbleTable[16]{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef,
+};
+
+// Tables for slicing-by-8. Table 0 is the byte table, and each following table
+// advances the CRC through one more zero byte. This allows processing 8 bytes
+// with 8 independent table lookups.
+using SlicingTables = std::array<std::array<uint16_t, 256>, 8>;
+
+constexpr SlicingTables GenerateSlicingTables() {
+  SlicingTables tables{};
+  for (size_t i = 0; i < 256; ++i) {
+    tables[0][i] = kCrc16CcittTable[i];
+  }
+  for (size_t table = 1; table < tables.size(); ++table) {
+    for (size_t i = 0; i < 256; ++i) {
+      const uint16_t previous = tables[table - 1][i];
+      tables[table][i] = kCrc16CcittTable[previous >> 8] ^ (previous << 8);
+    }
+  }
+  return tables;
+}
+
+constexpr SlicingTables kCrc16CcittSlicingTables = GenerateSlicingTables();
+
 }  // namespace
 
-extern "C" uint16_t pw_checksum_Crc16Ccitt(const void* data,
-                                           size_t size_bytes,
-                                           uint16_t value) {
+extern "C" uint16_t _pw_checksum_InternalCrc16CcittNibbleTable(
+    const void* data, size_t size_bytes, uint16_t value) {
+  const uint8_t* const array = static_cast<const uint8_t*>(data);
+
+  for (size_t i = 0; i < size_bytes; ++i) {
+    value = kCrc16CcittNibbleTable[((value >> 12) ^ (array[i] >> 4)) & 0xfu] ^
+            (value << 4);
+    value = kCrc16CcittNibbleTable[((value >> 12) ^ array[i]) & 0xfu] ^
+            (value << 4);
+  }
+
+  return value;
+}
+
+extern "C" uint16_t _pw_checksum_InternalCrc16CcittByteTable(const void* data,
+                                                             size_t size_bytes,
+                                                             uint16_t value) {
   const uint8_t* const array = static_cast<const uint8_t*>(data);
 
   for (size_t i = 0; i < size_bytes; ++i) {
@@ -66,4 +113,33 @@ extern "C" uint16_t pw_checksum_Crc16Ccitt(const void* data,
   return value;
 }
 
+extern "C" uint16_t _pw_checksum_InternalCrc16CcittSlicingBy8(
+    const void* data, size_t size_bytes, uint16_t value) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const SlicingTables& tables = kCrc16CcittSlicingTables;
+
+  // The CRC is most significant bit first, so only the first two bytes of each
+  // block combine with the current value.
+  for (; size_bytes >= 8u; size_bytes -= 8u, array += 8) {
+    value = tables[7][(value >> 8) ^ array[0]] ^
+            tables[6][(value & 0xffu) ^ array[1]] ^ tables[5][array[2]] ^
+            tables[4][array[3]] ^ tables[3][array[4]] ^ tables[2][array[5]] ^
+            tables[1][array[6]] ^ tables[0][array[7]];
+  }
+
+  return _pw_checksum_InternalCrc16CcittByteTable(array, size_bytes, value);
+}
+
+extern "C" uint16_t pw_checksum_Crc16Ccitt(const void* data,
+                                           size_t size_bytes,
+                                           uint16_t value) {
+#if PW_CHECKSUM_CRC16_CCITT_IMPL == PW_CHECKSUM_CRC16_CCITT_IMPL_NIBBLE_TABLE
+  return _pw_checksum_InternalCrc16CcittNibbleTable(data, size_bytes, value);
+#elif PW_CHECKSUM_CRC16_CCITT_IMPL == PW_CHECKSUM_CRC16_CCITT_IMPL_BYTE_TABLE
+  return _pw_checksum_InternalCrc16CcittByteTable(data, size_bytes, value);
+#elif PW_CHECKSUM_CRC16_CCITT_IMPL == PW_CHECKSUM_CRC16_CCITT_IMPL_SLICING_BY_8
+  return _pw_checksum_InternalCrc16CcittSlicingBy8(data, size_bytes, value);
+#endif  // PW_CHECKSUM_CRC16_CCITT_IMPL
+}
+
 }  // namespace pw::checksum
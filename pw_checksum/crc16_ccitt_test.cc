@@ -14,6 +14,8 @@
 
 #include "pw_checksum/crc16_ccitt.h"
 
+#include <array>
+#include <span>
 #include <string_view>
 
 #include "gtest/gtest.h"
@@ -69,6 +71,51 @@ TEST(Crc16Class, String) {
   EXPECT_EQ(crc16.value(), kStringCrc);
 }
 
+using Crc16CcittImplFunction = uint16_t (*)(const void*, size_t, uint16_t);
+
+constexpr Crc16CcittImplFunction kImplementations[] = {
+    _pw_checksum_InternalCrc16CcittNibbleTable,
+    _pw_checksum_InternalCrc16CcittByteTable,
+    _pw_checksum_InternalCrc16CcittSlicingBy8,
+};
+
+uint16_t CalculateWith(Crc16CcittImplFunction impl,
+                       std::span<const std::byte> data) {
+  return impl(data.data(), data.size(), Crc16Ccitt::kInitialValue);
+}
+
+TEST(Crc16Implementations, Buffer) {
+  for (Crc16CcittImplFunction impl : kImplementations) {
+    EXPECT_EQ(CalculateWith(impl, std::as_bytes(std::span(kBytes))),
+              kBufferCrc);
+  }
+}
+
+TEST(Crc16Implementations, String) {
+  for (Crc16CcittImplFunction impl : kImplementations) {
+    EXPECT_EQ(CalculateWith(impl, std::as_bytes(std::span(kString))),
+              kStringCrc);
+  }
+}
+
+TEST(Crc16Implementations, MatchByteTable_UnalignedSizesAndOffsets) {
+  std::array<std::byte, 64> data;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::byte(i * 37 + 11);
+  }
+
+  for (Crc16CcittImplFunction impl : kImplementations) {
+    for (size_t offset = 0; offset < 8; ++offset) {
+      for (size_t size = 0; size + offset <= data.size(); ++size) {
+        const auto chunk = std::span(data).subspan(offset, size);
+        EXPECT_EQ(
+            CalculateWith(_pw_checksum_InternalCrc16CcittByteTable, chunk),
+            CalculateWith(impl, chunk));
+      }
+    }
+  }
+}
+
 extern "C" uint16_t CallChecksumCrc16Ccitt(const void* data, size_t size_bytes);
 
 TEST(Crc16FromC, Buffer) {
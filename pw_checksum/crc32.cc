@@ -14,6 +14,15 @@
 
 #include "pw_checksum/crc32.h"
 
+#include <array>
+#include <cstring>
+
+#include "pw_checksum_private/config.h"
+
+#if PW_CHECKSUM_CRC32_ARMV8_AVAILABLE
+#include <arm_acle.h>
+#endif  // PW_CHECKSUM_CRC32_ARMV8_AVAILABLE
+
 namespace pw::checksum {
 namespace {
 
@@ -62,11 +71,39 @@ constexpr uint32_t kCrc32Table[] = {
     0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
     0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
+// Tables for slicing-by-8. Table 0 is the byte table, and each following table
+// advances the CRC through one more zero byte. This allows processing 8 bytes
+// with 8 independent table lookups.
+using SlicingTables = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr SlicingTables GenerateSlicingTables() {
+  SlicingTables tables{};
+  for (size_t i = 0; i < 256; ++i) {
+    tables[0][i] = kCrc32Table[i];
+  }
+  for (size_t table = 1; table < tables.size(); ++table) {
+    for (size_t i = 0; i < 256; ++i) {
+      const uint32_t previous = tables[table - 1][i];
+      tables[table][i] = kCrc32Table[previous & 0xFFu] ^ (previous >> 8);
+    }
+  }
+  return tables;
+}
+
+constexpr SlicingTables kCrc32SlicingTables = GenerateSlicingTables();
+
+// Reads a little-endian uint32_t. Compilers reduce this to a single load on
+// little-endian targets.
+constexpr uint32_t ReadLittleEndian(const uint8_t* bytes) {
+  return uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) |
+         (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+}
+
 }  // namespace
 
-extern "C" uint32_t _pw_checksum_InternalCrc32(const void* data,
-                                               size_t size_bytes,
-                                               uint32_t state) {
+extern "C" uint32_t _pw_checksum_InternalCrc32ByteTable(const void* data,
+                                                        size_t size_bytes,
+                                                        uint32_t state) {
   const uint8_t* array = static_cast<const uint8_t*>(data);
 
   for (size_t i = 0; i < size_bytes; ++i) {
@@ -76,4 +113,76 @@ extern "C" uint32_t _pw_checksum_InternalCrc32(const void* data,
   return state;
 }
 
+extern "C" uint32_t _pw_checksum_InternalCrc32SlicingBy8(const void* data,
+                                                         size_t size_bytes,
+                                                         uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const SlicingTables& tables = kCrc32SlicingTables;
+
+  for (; size_bytes >= 8u; size_bytes -= 8u, array += 8) {
+    const uint32_t low = ReadLittleEndian(array) ^ state;
+    const uint32_t high = ReadLittleEndian(array + 4);
+
+    state = tables[7][low & 0xFFu] ^ tables[6][(low >> 8) & 0xFFu] ^
+            tables[5][(low >> 16) & 0xFFu] ^ tables[4][low >> 24] ^
+            tables[3][high & 0xFFu] ^ tables[2][(high >> 8) & 0xFFu] ^
+            tables[1][(high >> 16) & 0xFFu] ^ tables[0][high >> 24];
+  }
+
+  return _pw_checksum_InternalCrc32ByteTable(array, size_bytes, state);
+}
+
+#if PW_CHECKSUM_CRC32_ARMV8_AVAILABLE
+
+extern "C" uint32_t _pw_checksum_InternalCrc32Armv8(const void* data,
+                                                    size_t size_bytes,
+                                                    uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+
+  for (; size_bytes != 0u && (uintptr_t(array) % sizeof(uint32_t)) != 0u;
+       --size_bytes) {
+    state = __crc32b(state, *array++);
+  }
+
+#if defined(__aarch64__)
+  for (; size_bytes >= sizeof(uint64_t); size_bytes -= sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, array, sizeof(word));
+    state = __crc32d(state, word);
+    array += sizeof(word);
+  }
+#endif  // defined(__aarch64__)
+
+  for (; size_bytes >= sizeof(uint32_t); size_bytes -= sizeof(uint32_t)) {
+    uint32_t word;
+    std::memcpy(&word, array, sizeof(word));
+    state = __crc32w(state, word);
+    array += sizeof(word);
+  }
+
+  for (; size_bytes != 0u; --size_bytes) {
+    state = __crc32b(state, *array++);
+  }
+
+  return state;
+}
+
+#endif  // PW_CHECKSUM_CRC32_ARMV8_AVAILABLE
+
+#if PW_CHECKSUM_CRC32_IMPL != PW_CHECKSUM_CRC32_IMPL_EXTERNAL
+
+extern "C" uint32_t _pw_checksum_InternalCrc32(const void* data,
+                                               size_t size_bytes,
+                                               uint32_t state) {
+#if PW_CHECKSUM_CRC32_IMPL == PW_CHECKSUM_CRC32_IMPL_BYTE_TABLE
+  return _pw_checksum_InternalCrc32ByteTable(data, size_bytes, state);
+#elif PW_CHECKSUM_CRC32_IMPL == PW_CHECKSUM_CRC32_IMPL_SLICING_BY_8
+  return _pw_checksum_InternalCrc32SlicingBy8(data, size_bytes, state);
+#elif PW_CHECKSUM_CRC32_IMPL == PW_CHECKSUM_CRC32_IMPL_ARMV8
+  return _pw_checksum_InternalCrc32Armv8(data, size_bytes, state);
+#endif  // PW_CHECKSUM_CRC32_IMPL
+}
+
+#endif  // PW_CHECKSUM_CRC32_IMPL != PW_CHECKSUM_CRC32_IMPL_EXTERNAL
+
 }  // namespace pw::checksum
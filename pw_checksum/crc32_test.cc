@@ -13,6 +13,7 @@
 // the License.
 #include "pw_checksum/crc32.h"
 
+#include <array>
 #include <span>
 #include <string_view>
 
@@ -77,6 +78,54 @@ TEST(Crc32Class, String) {
   EXPECT_EQ(crc32.value(), kStringCrc);
 }
 
+using Crc32ImplFunction = uint32_t (*)(const void*, size_t, uint32_t);
+
+constexpr Crc32ImplFunction kImplementations[] = {
+    _pw_checksum_InternalCrc32,
+    _pw_checksum_InternalCrc32ByteTable,
+    _pw_checksum_InternalCrc32SlicingBy8,
+#if defined(__ARM_FEATURE_CRC32) && __ARM_FEATURE_CRC32
+    _pw_checksum_InternalCrc32Armv8,
+#endif  // __ARM_FEATURE_CRC32
+};
+
+// Runs a CRC32 implementation on the data and finalizes the result.
+uint32_t CalculateWith(Crc32ImplFunction impl,
+                       std::span<const std::byte> data) {
+  return ~impl(data.data(), data.size(), _PW_CHECKSUM_CRC32_INITIAL_STATE);
+}
+
+TEST(Crc32Implementations, Buffer) {
+  for (Crc32ImplFunction impl : kImplementations) {
+    EXPECT_EQ(CalculateWith(impl, std::as_bytes(std::span(kBytes))),
+              kBufferCrc);
+  }
+}
+
+TEST(Crc32Implementations, String) {
+  for (Crc32ImplFunction impl : kImplementations) {
+    EXPECT_EQ(CalculateWith(impl, std::as_bytes(std::span(kString))),
+              kStringCrc);
+  }
+}
+
+TEST(Crc32Implementations, MatchByteTable_UnalignedSizesAndOffsets) {
+  std::array<std::byte, 64> data;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::byte(i * 37 + 11);
+  }
+
+  for (Crc32ImplFunction impl : kImplementations) {
+    for (size_t offset = 0; offset < 8; ++offset) {
+      for (size_t size = 0; size + offset <= data.size(); ++size) {
+        const auto chunk = std::span(data).subspan(offset, size);
+        EXPECT_EQ(CalculateWith(_pw_checksum_InternalCrc32ByteTable, chunk),
+                  CalculateWith(impl, chunk));
+      }
+    }
+  }
+}
+
 extern "C" uint32_t CallChecksumCrc32(const void* data, size_t size_bytes);
 extern "C" uint32_t CallChecksumCrc32Append(const void* data,
                                             size_t size_bytes,
@@ -32,6 +32,21 @@ uint16_t pw_checksum_Crc16Ccitt(const void* data,
                                 size_t size_bytes,
                                 uint16_t initial_value);
 
+// Internal CRC-16-CCITT implementations, one of which is selected with
+// PW_CHECKSUM_CRC16_CCITT_IMPL. They are always available for testing and
+// benchmarking. Do not call them directly.
+uint16_t _pw_checksum_InternalCrc16CcittNibbleTable(const void* data,
+                                                    size_t size_bytes,
+                                                    uint16_t initial_value);
+
+uint16_t _pw_checksum_InternalCrc16CcittByteTable(const void* data,
+                                                  size_t size_bytes,
+                                                  uint16_t initial_value);
+
+uint16_t _pw_checksum_InternalCrc16CcittSlicingBy8(const void* data,
+                                                   size_t size_bytes,
+                                                   uint16_t initial_value);
+
 #ifdef __cplusplus
 }  // extern "C"
 
@@ -33,10 +33,30 @@ extern "C" {
 #define _PW_CHECKSUM_CRC32_INITIAL_STATE 0xFFFFFFFFu
 
 // Internal implementation function for CRC32. Do not call it directly.
+//
+// The implementation is selected with PW_CHECKSUM_CRC32_IMPL. If it is
+// PW_CHECKSUM_CRC32_IMPL_EXTERNAL, this function must be provided by another
+// library, for example one that uses a CRC peripheral.
 uint32_t _pw_checksum_InternalCrc32(const void* data,
                                     size_t size_bytes,
                                     uint32_t state);
 
+// Internal CRC32 implementations, which are always available for testing and
+// benchmarking. Do not call them directly.
+uint32_t _pw_checksum_InternalCrc32ByteTable(const void* data,
+                                             size_t size_bytes,
+                                             uint32_t state);
+
+uint32_t _pw_checksum_InternalCrc32SlicingBy8(const void* data,
+                                              size_t size_bytes,
+                                              uint32_t state);
+
+#if defined(__ARM_FEATURE_CRC32) && __ARM_FEATURE_CRC32
+uint32_t _pw_checksum_InternalCrc32Armv8(const void* data,
+                                         size_t size_bytes,
+                                         uint32_t state);
+#endif  // __ARM_FEATURE_CRC32
+
 // Calculates the CRC32 for the provided data.
 static inline uint32_t pw_checksum_Crc32(const void* data, size_t size_bytes) {
   return ~_pw_checksum_InternalCrc32(
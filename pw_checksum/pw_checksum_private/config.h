@@ -0,0 +1,84 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration options for pw_checksum.
+#pragma once
+
+// Implementations available for _pw_checksum_InternalCrc32, which is used by
+// pw_checksum_Crc32 and pw::checksum::Crc32.
+//
+// Processes one byte at a time with a 1 KiB table.
+#define PW_CHECKSUM_CRC32_IMPL_BYTE_TABLE 1
+
+// Processes eight bytes at a time with 8 KiB of tables. Faster than the byte
+// table on most targets with a data cache.
+#define PW_CHECKSUM_CRC32_IMPL_SLICING_BY_8 2
+
+// Uses the ARMv8 CRC32 instructions. Only available if the compiler targets
+// them (__ARM_FEATURE_CRC32).
+#define PW_CHECKSUM_CRC32_IMPL_ARMV8 3
+
+// _pw_checksum_InternalCrc32 is not defined by pw_checksum. Another library
+// must provide it, for example to use an MCU's CRC peripheral.
+#define PW_CHECKSUM_CRC32_IMPL_EXTERNAL 4
+
+#if defined(__ARM_FEATURE_CRC32) && __ARM_FEATURE_CRC32
+#define PW_CHECKSUM_CRC32_ARMV8_AVAILABLE 1
+#else
+#define PW_CHECKSUM_CRC32_ARMV8_AVAILABLE 0
+#endif  // __ARM_FEATURE_CRC32
+
+// Which implementation to use for CRC32. Defaults to the ARMv8 instructions if
+// available, and otherwise to the byte table, which is the smallest.
+#ifndef PW_CHECKSUM_CRC32_IMPL
+#if PW_CHECKSUM_CRC32_ARMV8_AVAILABLE
+#define PW_CHECKSUM_CRC32_IMPL PW_CHECKSUM_CRC32_IMPL_ARMV8
+#else
+#define PW_CHECKSUM_CRC32_IMPL PW_CHECKSUM_CRC32_IMPL_BYTE_TABLE
+#endif  // PW_CHECKSUM_CRC32_ARMV8_AVAILABLE
+#endif  // PW_CHECKSUM_CRC32_IMPL
+
+#if PW_CHECKSUM_CRC32_IMPL < PW_CHECKSUM_CRC32_IMPL_BYTE_TABLE || \
+    PW_CHECKSUM_CRC32_IMPL > PW_CHECKSUM_CRC32_IMPL_EXTERNAL
+#error "PW_CHECKSUM_CRC32_IMPL must be one of the PW_CHECKSUM_CRC32_IMPL_* values"
+#endif  // PW_CHECKSUM_CRC32_IMPL
+
+#if PW_CHECKSUM_CRC32_IMPL == PW_CHECKSUM_CRC32_IMPL_ARMV8 && \
+    !PW_CHECKSUM_CRC32_ARMV8_AVAILABLE
+#error "PW_CHECKSUM_CRC32_IMPL_ARMV8 requires the ARMv8 CRC32 extension"
+#endif  // PW_CHECKSUM_CRC32_IMPL
+
+// Implementations available for pw_checksum_Crc16Ccitt, which is used by
+// pw::checksum::Crc16Ccitt.
+//
+// Processes four bits at a time with a 32 B table. This is the smallest
+// implementation, but is about half as fast as the byte table.
+#define PW_CHECKSUM_CRC16_CCITT_IMPL_NIBBLE_TABLE 1
+
+// Processes one byte at a time with a 512 B table.
+#define PW_CHECKSUM_CRC16_CCITT_IMPL_BYTE_TABLE 2
+
+// Processes eight bytes at a time with 4 KiB of tables. Faster than the byte
+// table on most targets with a data cache.
+#define PW_CHECKSUM_CRC16_CCITT_IMPL_SLICING_BY_8 3
+
+// Which implementation to use for CRC-16-CCITT. Defaults to the byte table.
+#ifndef PW_CHECKSUM_CRC16_CCITT_IMPL
+#define PW_CHECKSUM_CRC16_CCITT_IMPL PW_CHECKSUM_CRC16_CCITT_IMPL_BYTE_TABLE
+#endif  // PW_CHECKSUM_CRC16_CCITT_IMPL
+
+#if PW_CHECKSUM_CRC16_CCITT_IMPL < PW_CHECKSUM_CRC16_CCITT_IMPL_NIBBLE_TABLE || \
+    PW_CHECKSUM_CRC16_CCITT_IMPL > PW_CHECKSUM_CRC16_CCITT_IMPL_SLICING_BY_8
+#error "PW_CHECKSUM_CRC16_CCITT_IMPL must be a PW_CHECKSUM_CRC16_CCITT_IMPL_* value"
+#endif  // PW_CHECKSUM_CRC16_CCITT_IMPL
@@ -0,0 +1,59 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono/high_resolution_clock.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+namespace pw::chrono {
+namespace {
+
+// As in the SystemClock facade test, bound the busy loop by assuming the clock
+// is checked at no more than 6GHz and waiting for up to 1/10th of a second.
+constexpr uint64_t kMaxIterations = 6'000'000'000 / 10;
+
+TEST(HighResolutionClock, Now) {
+  const HighResolutionClock::time_point start_time =
+      HighResolutionClock::now();
+  // Verify the clock moves forward.
+  bool clock_moved_forward = false;
+  for (uint64_t i = 0; i < kMaxIterations; ++i) {
+    if (HighResolutionClock::now() > start_time) {
+      clock_moved_forward = true;
+      break;
+    }
+  }
+  EXPECT_TRUE(clock_moved_forward);
+}
+
+TEST(HighResolutionClock, Monotonic) {
+  HighResolutionClock::time_point last = HighResolutionClock::now();
+  for (int i = 0; i < 10000; ++i) {
+    const HighResolutionClock::time_point now = HighResolutionClock::now();
+    ASSERT_GE(now, last);
+    last = now;
+  }
+}
+
+TEST(HighResolutionClock, ResolvesMicroseconds) {
+  // The clock must at least resolve microseconds to be of use for profiling.
+  static_assert(std::ratio_less_equal_v<HighResolutionClock::period,
+                                        std::micro>);
+  EXPECT_TRUE(HighResolutionClock::is_monotonic);
+}
+
+}  // namespace
+}  // namespace pw::chrono
@@ -0,0 +1,108 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <stdint.h>
+
+// The backend implements this header to provide the following
+// HighResolutionClock parameters, see the HighResolutionClock usage of them
+// below for more detail:
+//   PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_NUMERATOR
+//   PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_DENOMINATOR
+//   constexpr pw::chrono::Epoch pw::chrono::backend::kHighResolutionClockEpoch;
+//   constexpr bool pw::chrono::backend::kHighResolutionClockFreeRunning;
+//   constexpr bool pw::chrono::backend::kHighResolutionClockNmiSafe;
+#include "pw_chrono_backend/high_resolution_clock_config.h"
+
+#ifdef __cplusplus
+
+#include <chrono>
+#include <ratio>
+
+namespace pw::chrono {
+namespace backend {
+
+// A HighResolutionClock tick has the units of one HighResolutionClock::period
+// duration. This must be thread and IRQ safe and provided by the backend.
+int64_t GetHighResolutionClockTickCount();
+
+}  // namespace backend
+
+// The HighResolutionClock is a monotonic clock for measuring short intervals,
+// typically backed by a CPU cycle counter. Unlike the SystemClock, which
+// usually ticks at the RTOS tick rate, it resolves microsecond and shorter code
+// paths, so it is meant for profiling, trace timestamps and latency metrics
+// rather than for timeouts.
+//
+// HighResolutionClock is compatible with C++'s Clock & TrivialClock including:
+//   HighResolutionClock::rep
+//   HighResolutionClock::period
+//   HighResolutionClock::duration
+//   HighResolutionClock::time_point
+//   HighResolutionClock::is_steady
+//   HighResolutionClock::now()
+//
+// Example:
+//
+//   const HighResolutionClock::time_point start = HighResolutionClock::now();
+//   Checksum(data);
+//   const std::chrono::nanoseconds elapsed =
+//       std::chrono::duration_cast<std::chrono::nanoseconds>(
+//           HighResolutionClock::now() - start);
+//
+// Hardware counters are often only 32 bits wide, so backends may extend them to
+// 64 bits in software. Such backends document how often now() must be called
+// for a wrap to be noticed.
+//
+// This code is thread & IRQ safe, it may be NMI safe depending on is_nmi_safe.
+struct HighResolutionClock {
+  using rep = int64_t;
+  // The period must be provided by the backend.
+  using period =
+      std::ratio<PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_NUMERATOR,
+                 PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_DENOMINATOR>;
+  using duration = std::chrono::duration<rep, period>;
+  using time_point = std::chrono::time_point<HighResolutionClock>;
+  // The epoch must be provided by the backend.
+  static constexpr Epoch epoch = backend::kHighResolutionClockEpoch;
+
+  // The time points of this clock cannot decrease. A cycle counter's rate may
+  // change with the CPU frequency, so the clock is not steady.
+  static constexpr bool is_monotonic = true;
+  static constexpr bool is_steady = false;
+
+  // Whether now() moves forward while in a critical section or interrupt. This
+  // must be provided by the backend.
+  static constexpr bool is_free_running =
+      backend::kHighResolutionClockFreeRunning;
+
+  // The now() function may work in non-masking interrupts, depending on the
+  // backend. This must be provided by the backend.
+  static constexpr bool is_nmi_safe = backend::kHighResolutionClockNmiSafe;
+
+  // This is thread and IRQ safe. This must be provided by the backend.
+  static time_point now() noexcept {
+    return time_point(duration(backend::GetHighResolutionClockTickCount()));
+  }
+};
+
+}  // namespace pw::chrono
+
+// The backend can opt to include an inlined implementation of the following:
+//   int64_t GetHighResolutionClockTickCount();
+#if __has_include("pw_chrono_backend/high_resolution_clock_inline.h")
+#include "pw_chrono_backend/high_resolution_clock_inline.h"
+#endif  // __has_include("pw_chrono_backend/high_resolution_clock_inline.h")
+
+#endif  // __cplusplus
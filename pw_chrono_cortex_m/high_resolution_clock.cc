@@ -0,0 +1,81 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono/high_resolution_clock.h"
+
+#include <cstdint>
+
+#include "pw_assert/check.h"
+
+namespace pw::chrono::backend {
+namespace {
+
+// ARMv7-M Architecture Reference Manual, C1.6.5 and C1.8.
+volatile uint32_t& demcr = *reinterpret_cast<volatile uint32_t*>(0xE000EDFC);
+volatile uint32_t& dwt_ctrl = *reinterpret_cast<volatile uint32_t*>(0xE0001000);
+volatile uint32_t& dwt_cyccnt =
+    *reinterpret_cast<volatile uint32_t*>(0xE0001004);
+// The Cortex-M7 locks the DWT registers until this CoreSight lock access
+// register is written. It is ignored by cores without the lock.
+volatile uint32_t& dwt_lar = *reinterpret_cast<volatile uint32_t*>(0xE0001FB0);
+
+constexpr uint32_t kDemcrTraceEnable = 1u << 24;
+constexpr uint32_t kDwtCtrlCycleCounterEnable = 1u << 0;
+constexpr uint32_t kDwtCtrlNoCycleCounter = 1u << 25;
+constexpr uint32_t kDwtLarUnlock = 0xC5ACCE55;
+
+// The upper 32 bits of the extended count, and the counter value the last time
+// it was read. Only accessed with interrupts masked.
+uint32_t cycle_count_high = 0;
+uint32_t last_cycle_count = 0;
+
+void EnableCycleCounter() {
+  demcr = demcr | kDemcrTraceEnable;
+  PW_CHECK((dwt_ctrl & kDwtCtrlNoCycleCounter) == 0,
+           "This core does not implement the DWT cycle counter");
+  dwt_lar = kDwtLarUnlock;
+  dwt_cyccnt = 0;
+  dwt_ctrl = dwt_ctrl | kDwtCtrlCycleCounterEnable;
+}
+
+}  // namespace
+
+int64_t GetHighResolutionClockTickCount() {
+  // Mask interrupts so that the read and the wrap check are atomic with respect
+  // to other readers.
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n"
+               "cpsid i"
+               : "=r"(primask)::"memory");
+
+  if ((dwt_ctrl & kDwtCtrlCycleCounterEnable) == 0) {
+    EnableCycleCounter();
+  }
+
+  // The hardware counter is 32 bits wide, so it wraps every 2^32 cycles (about
+  // 43 seconds at 100MHz). A wrap is noticed as long as the clock is read at
+  // least once per wrap period.
+  const uint32_t cycle_count = dwt_cyccnt;
+  if (cycle_count < last_cycle_count) {
+    ++cycle_count_high;
+  }
+  last_cycle_count = cycle_count;
+  const int64_t ticks = static_cast<int64_t>(
+      (static_cast<uint64_t>(cycle_count_high) << 32) | cycle_count);
+
+  asm volatile("msr primask, %0" ::"r"(primask) : "memory");
+  return ticks;
+}
+
+}  // namespace pw::chrono::backend
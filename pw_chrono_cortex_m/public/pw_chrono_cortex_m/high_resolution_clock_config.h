@@ -0,0 +1,51 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// The DWT cycle counter counts CPU cycles, so its period depends on the core
+// clock frequency, which must be provided by the build. For example, on a
+// 168MHz STM32F4:
+//
+//   defines = [ "PW_CHRONO_CORTEX_M_CYCLE_COUNTER_HZ=168000000" ]
+//
+// If the core clock is changed at run time, the clock's period is wrong for as
+// long as the frequency differs from this value.
+#ifndef PW_CHRONO_CORTEX_M_CYCLE_COUNTER_HZ
+#error "PW_CHRONO_CORTEX_M_CYCLE_COUNTER_HZ must be set to the core clock rate"
+#endif  // PW_CHRONO_CORTEX_M_CYCLE_COUNTER_HZ
+
+#define PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_NUMERATOR 1
+#define PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_DENOMINATOR \
+  PW_CHRONO_CORTEX_M_CYCLE_COUNTER_HZ
+
+#ifdef __cplusplus
+
+#include "pw_chrono/epoch.h"
+
+namespace pw::chrono::backend {
+
+// The cycle counter starts counting when it is first read.
+constexpr inline Epoch kHighResolutionClockEpoch = pw::chrono::Epoch::kUnknown;
+
+// The 32 bit counter is extended in software with interrupts masked, which a
+// non-maskable interrupt could preempt.
+constexpr inline bool kHighResolutionClockNmiSafe = false;
+
+// The cycle counter is hardware and keeps counting in interrupts and critical
+// sections.
+constexpr inline bool kHighResolutionClockFreeRunning = true;
+
+}  // namespace pw::chrono::backend
+
+#endif  // __cplusplus
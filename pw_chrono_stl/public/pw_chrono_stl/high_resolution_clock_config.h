@@ -0,0 +1,40 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// The std::chrono::steady_clock is used, which is backed by
+// clock_gettime(CLOCK_MONOTONIC) on Linux and resolves nanoseconds. As with the
+// SystemClock, nanosecond compatibility is assumed and implicit conversion
+// checks it at compile time.
+#define PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_NUMERATOR 1
+#define PW_CHRONO_HIGH_RESOLUTION_CLOCK_PERIOD_SECONDS_DENOMINATOR 1'000'000'000
+
+#ifdef __cplusplus
+
+#include "pw_chrono/epoch.h"
+
+namespace pw::chrono::backend {
+
+// The std::chrono::steady_clock does not have a defined epoch.
+constexpr inline Epoch kHighResolutionClockEpoch = pw::chrono::Epoch::kUnknown;
+
+// The std::chrono::steady_clock can be used by signal handlers.
+constexpr inline bool kHighResolutionClockNmiSafe = true;
+
+// The std::chrono::steady_clock ticks while in a signal handler.
+constexpr inline bool kHighResolutionClockFreeRunning = true;
+
+}  // namespace pw::chrono::backend
+
+#endif  // __cplusplus
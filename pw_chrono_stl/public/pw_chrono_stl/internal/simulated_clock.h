@@ -0,0 +1,26 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pw::chrono::stl::internal {
+
+// State of the simulated clock, which SystemClock::now() reads while simulated
+// time is enabled. See pw_chrono_stl/simulated_time.h.
+inline std::atomic<bool> simulated_time_enabled{false};
+inline std::atomic<int64_t> simulated_tick_count{0};
+
+}  // namespace pw::chrono::stl::internal
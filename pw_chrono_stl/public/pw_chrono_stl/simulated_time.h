@@ -0,0 +1,93 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <thread>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_chrono_stl/internal/simulated_clock.h"
+#include "pw_function/function_ref.h"
+
+namespace pw::chrono::stl {
+
+// Simulated time runs host simulations as a discrete-event simulation. While it
+// is enabled, SystemClock::now() returns a virtual time, and the timed waits of
+// the STL backends for pw_sync and pw_thread wait for that time instead of real
+// time. Whenever every thread is blocked, the clock jumps straight to the
+// earliest deadline of a waiting thread and wakes it, so hours of simulated
+// device time pass as fast as the threads can run:
+//
+//   TEST(Soak, RunsForAnHour) {
+//     pw::chrono::stl::EnableSimulatedTime();
+//     pw::thread::Thread worker(options, Worker);  // Sleeps and waits
+//     pw::this_thread::sleep_for(std::chrono::hours(1));
+//     StopWorker();
+//     worker.join();
+//     pw::chrono::stl::DisableSimulatedTime();
+//   }
+//
+// The scheduler only knows about threads that it can see blocking:
+//
+//   - Enable simulated time before starting threads. The enabling thread and
+//     threads started with pw::thread::Thread while it is enabled take part.
+//   - BinarySemaphore, CountingSemaphore, ThreadNotification, Mutex and
+//     TimedMutex waits, sleep_for/sleep_until, and Thread::join() are
+//     simulated. A thread blocked in anything else, such as a std::mutex or a
+//     socket, counts as running, so the clock does not advance until it
+//     returns.
+//
+// Simulated time starts at the current SystemClock time. Disabling it returns
+// to real time, which may be earlier than the simulated time; only disable it
+// once no other threads are waiting.
+void EnableSimulatedTime();
+void DisableSimulatedTime();
+
+inline bool SimulatedTimeEnabled() {
+  return internal::simulated_time_enabled.load(std::memory_order_relaxed);
+}
+
+namespace internal {
+
+// Hooks for the STL backends, which call these instead of blocking while
+// simulated time is enabled. The ready functions are called with the
+// scheduler's lock held, so they must not block or call into the scheduler.
+
+// Blocks until ready() returns true or the simulated time reaches the
+// deadline. Returns the final result of ready().
+bool SimulatedWaitUntil(SystemClock::time_point deadline,
+                        FunctionRef<bool()> ready);
+
+// Blocks until ready() returns true.
+void SimulatedWait(FunctionRef<bool()> ready);
+
+// Wakes blocked threads to check their ready() functions again. Must be called
+// after anything that could make a ready() function return true.
+void SimulatedNotify();
+
+// Called by a thread before and after it starts a thread, and by the new
+// thread when it starts running and when it exits.
+void SimulatedThreadCreating();
+void SimulatedThreadCreated(std::thread::id thread);
+void SimulatedThreadEntered();
+void SimulatedThreadExiting();
+
+// If the thread takes part in the simulation, blocks until it calls
+// SimulatedThreadExiting(), after which joining it does not block for long.
+void SimulatedJoin(std::thread::id thread);
+
+// Forgets a thread that will not be joined.
+void SimulatedDetach(std::thread::id thread);
+
+}  // namespace internal
+}  // namespace pw::chrono::stl
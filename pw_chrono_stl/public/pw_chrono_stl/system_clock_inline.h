@@ -16,10 +16,14 @@
 #include <chrono>
 
 #include "pw_chrono/system_clock.h"
+#include "pw_chrono_stl/internal/simulated_clock.h"
 
 namespace pw::chrono::backend {
 
 inline int64_t GetSystemClockTickCount() {
+  if (stl::internal::simulated_time_enabled.load(std::memory_order_relaxed)) {
+    return stl::internal::simulated_tick_count.load(std::memory_order_relaxed);
+  }
   // Note that no conversion is necessary since the steady_clock's period and
   // epoch are directly used.
   return std::chrono::steady_clock::now().time_since_epoch().count();
@@ -0,0 +1,241 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono_stl/simulated_time.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace pw::chrono::stl {
+namespace {
+
+constexpr int64_t kNoDeadline = std::numeric_limits<int64_t>::max();
+
+// A thread blocked in a simulated wait.
+struct Waiter {
+  int64_t deadline;
+
+  // Set when the thread should check whether it can stop waiting. While set,
+  // the thread counts as running.
+  bool woken;
+
+  // Whether the thread takes part in the simulation, so that the clock only
+  // advances while it is blocked.
+  bool counted;
+};
+
+std::mutex scheduler_mutex;
+std::condition_variable condition;
+
+// The number of threads taking part in the simulation that are not blocked.
+int running_threads = 0;
+
+std::vector<Waiter*> waiters;
+
+// Threads taking part in the simulation that have not exited, threads that
+// exited but have not been joined, and threads that were detached but have not
+// exited.
+std::vector<std::thread::id> live_threads;
+std::vector<std::thread::id> exited_threads;
+std::vector<std::thread::id> detached_threads;
+
+thread_local bool taking_part = false;
+
+int64_t Now() {
+  return internal::simulated_tick_count.load(std::memory_order_relaxed);
+}
+
+bool Contains(const std::vector<std::thread::id>& threads,
+              std::thread::id thread) {
+  return std::find(threads.begin(), threads.end(), thread) != threads.end();
+}
+
+bool Remove(std::vector<std::thread::id>& threads, std::thread::id thread) {
+  const auto it = std::find(threads.begin(), threads.end(), thread);
+  if (it == threads.end()) {
+    return false;
+  }
+  threads.erase(it);
+  return true;
+}
+
+void Wake(Waiter& waiter) {
+  if (!waiter.woken) {
+    waiter.woken = true;
+    running_threads += waiter.counted ? 1 : 0;
+  }
+}
+
+void WakeAll() {
+  for (Waiter* waiter : waiters) {
+    Wake(*waiter);
+  }
+  condition.notify_all();
+}
+
+// If every thread is blocked, jumps to the earliest deadline and wakes the
+// threads waiting for it.
+void AdvanceIfIdle() {
+  if (running_threads > 0) {
+    return;
+  }
+
+  int64_t next = kNoDeadline;
+  for (const Waiter* waiter : waiters) {
+    if (!waiter->woken) {
+      next = std::min(next, waiter->deadline);
+    }
+  }
+  if (next == kNoDeadline) {
+    return;  // Only a thread that is not taking part can wake the others.
+  }
+
+  if (next > Now()) {
+    internal::simulated_tick_count.store(next, std::memory_order_relaxed);
+  }
+  for (Waiter* waiter : waiters) {
+    if (waiter->deadline <= next) {
+      Wake(*waiter);
+    }
+  }
+  condition.notify_all();
+}
+
+void Block(Waiter& waiter) {
+  running_threads -= waiter.counted ? 1 : 0;
+  AdvanceIfIdle();
+}
+
+bool WaitLocked(std::unique_lock<std::mutex>& lock,
+                int64_t deadline,
+                FunctionRef<bool()> ready) {
+  if (ready()) {
+    return true;
+  }
+  if (deadline <= Now()) {
+    return false;
+  }
+
+  Waiter waiter = {deadline, false, taking_part};
+  waiters.push_back(&waiter);
+  Block(waiter);
+
+  while (true) {
+    condition.wait(lock, [&waiter] { return waiter.woken; });
+    waiter.woken = false;
+
+    const bool is_ready = ready();
+    if (is_ready || deadline <= Now() || !SimulatedTimeEnabled()) {
+      waiters.erase(std::find(waiters.begin(), waiters.end(), &waiter));
+      return is_ready;
+    }
+    Block(waiter);
+  }
+}
+
+}  // namespace
+
+void EnableSimulatedTime() {
+  std::lock_guard lock(scheduler_mutex);
+  internal::simulated_tick_count.store(
+      std::chrono::steady_clock::now().time_since_epoch().count(),
+      std::memory_order_relaxed);
+  running_threads = 1;
+  taking_part = true;
+  live_threads.clear();
+  exited_threads.clear();
+  detached_threads.clear();
+  internal::simulated_time_enabled.store(true, std::memory_order_relaxed);
+}
+
+void DisableSimulatedTime() {
+  std::lock_guard lock(scheduler_mutex);
+  internal::simulated_time_enabled.store(false, std::memory_order_relaxed);
+  taking_part = false;
+  WakeAll();
+  running_threads = 0;
+}
+
+namespace internal {
+
+bool SimulatedWaitUntil(SystemClock::time_point deadline,
+                        FunctionRef<bool()> ready) {
+  std::unique_lock lock(scheduler_mutex);
+  return WaitLocked(lock, deadline.time_since_epoch().count(), ready);
+}
+
+void SimulatedWait(FunctionRef<bool()> ready) {
+  std::unique_lock lock(scheduler_mutex);
+  WaitLocked(lock, kNoDeadline, ready);
+}
+
+void SimulatedNotify() {
+  std::lock_guard lock(scheduler_mutex);
+  WakeAll();
+}
+
+void SimulatedThreadCreating() {
+  std::lock_guard lock(scheduler_mutex);
+  running_threads += 1;
+}
+
+void SimulatedThreadCreated(std::thread::id thread) {
+  std::lock_guard lock(scheduler_mutex);
+  if (!Contains(exited_threads, thread)) {
+    live_threads.push_back(thread);
+  }
+}
+
+void SimulatedThreadEntered() { taking_part = true; }
+
+void SimulatedThreadExiting() {
+  std::lock_guard lock(scheduler_mutex);
+  const std::thread::id thread = std::this_thread::get_id();
+  Remove(live_threads, thread);
+  if (!Remove(detached_threads, thread)) {
+    exited_threads.push_back(thread);
+  }
+  taking_part = false;
+  running_threads -= 1;
+
+  // Wake threads joining this one before checking whether all are blocked.
+  WakeAll();
+  AdvanceIfIdle();
+}
+
+void SimulatedJoin(std::thread::id thread) {
+  std::unique_lock lock(scheduler_mutex);
+  if (!Contains(live_threads, thread) && !Contains(exited_threads, thread)) {
+    return;
+  }
+  WaitLocked(lock, kNoDeadline, [thread] {
+    return Contains(exited_threads, thread);
+  });
+  Remove(exited_threads, thread);
+}
+
+void SimulatedDetach(std::thread::id thread) {
+  std::lock_guard lock(scheduler_mutex);
+  if (!Remove(exited_threads, thread) && Contains(live_threads, thread)) {
+    detached_threads.push_back(thread);
+  }
+}
+
+}  // namespace internal
+}  // namespace pw::chrono::stl
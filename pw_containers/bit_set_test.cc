@@ -0,0 +1,186 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/bit_set.h"
+
+#include <bitset>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+constexpr BitSet<40> MakeConstexprBitSet() {
+  BitSet<40> bits;
+  bits.set(3).set(39).set_range(10, 5);
+  return bits;
+}
+
+constexpr BitSet<40> kConstexprBits = MakeConstexprBitSet();
+static_assert(kConstexprBits.count() == 7u);
+static_assert(kConstexprBits.find_first_set() == 3u);
+static_assert(kConstexprBits.find_next_set(4) == 10u);
+static_assert(kConstexprBits.find_last_set() == 39u);
+static_assert(kConstexprBits.find_first_clear() == 0u);
+
+TEST(BitSet, DefaultIsEmpty) {
+  BitSet<100> bits;
+  EXPECT_EQ(bits.size(), 100u);
+  EXPECT_EQ(bits.count(), 0u);
+  EXPECT_TRUE(bits.none());
+  EXPECT_FALSE(bits.any());
+  EXPECT_FALSE(bits.all());
+  EXPECT_EQ(bits.find_first_set(), bits.size());
+  EXPECT_EQ(bits.find_last_set(), bits.size());
+  EXPECT_EQ(bits.find_first_clear(), 0u);
+}
+
+TEST(BitSet, SetResetFlipSingleBits) {
+  BitSet<70> bits;
+  bits.set(0).set(31).set(32).set(69);
+  EXPECT_TRUE(bits.test(0));
+  EXPECT_TRUE(bits[31]);
+  EXPECT_TRUE(bits[32]);
+  EXPECT_TRUE(bits[69]);
+  EXPECT_FALSE(bits[1]);
+  EXPECT_EQ(bits.count(), 4u);
+
+  bits.reset(31).flip(32).flip(33).set(1, true).set(0, false);
+  EXPECT_FALSE(bits[0]);
+  EXPECT_TRUE(bits[1]);
+  EXPECT_FALSE(bits[31]);
+  EXPECT_FALSE(bits[32]);
+  EXPECT_TRUE(bits[33]);
+  EXPECT_EQ(bits.count(), 3u);
+}
+
+TEST(BitSet, SetAllKeepsUnusedBitsClear) {
+  BitSet<37> bits;
+  bits.set();
+  EXPECT_TRUE(bits.all());
+  EXPECT_EQ(bits.count(), 37u);
+  EXPECT_EQ(bits.find_first_clear(), bits.size());
+  EXPECT_EQ(bits.find_last_set(), 36u);
+
+  bits.flip();
+  EXPECT_TRUE(bits.none());
+  EXPECT_EQ((~bits).count(), 37u);
+  EXPECT_EQ(~bits, BitSet<37>().set());
+}
+
+TEST(BitSet, ExactMultipleOfWordSize) {
+  BitSet<64> bits;
+  bits.set();
+  EXPECT_TRUE(bits.all());
+  EXPECT_EQ(bits.count(), 64u);
+  bits.reset(63);
+  EXPECT_EQ(bits.find_first_clear(), 63u);
+  EXPECT_EQ(bits.find_last_set(), 62u);
+}
+
+TEST(BitSet, FindNextSetAcrossWords) {
+  BitSet<200> bits;
+  bits.set(5).set(64).set(199);
+  EXPECT_EQ(bits.find_first_set(), 5u);
+  EXPECT_EQ(bits.find_next_set(5), 5u);
+  EXPECT_EQ(bits.find_next_set(6), 64u);
+  EXPECT_EQ(bits.find_next_set(65), 199u);
+  EXPECT_EQ(bits.find_next_set(200), bits.size());
+  EXPECT_EQ(bits.find_last_set(), 199u);
+}
+
+TEST(BitSet, FindNextClearAcrossWords) {
+  BitSet<100> bits;
+  bits.set_range(0, 96);
+  EXPECT_EQ(bits.find_first_clear(), 96u);
+  EXPECT_EQ(bits.find_next_clear(97), 97u);
+
+  bits.set_range(96, 4);
+  EXPECT_EQ(bits.find_first_clear(), bits.size());
+  EXPECT_EQ(bits.find_next_clear(99), bits.size());
+
+  bits.reset(40);
+  EXPECT_EQ(bits.find_next_clear(10), 40u);
+  EXPECT_EQ(bits.find_next_clear(41), bits.size());
+}
+
+TEST(BitSet, Ranges) {
+  BitSet<130> bits;
+  bits.set_range(3, 0);
+  EXPECT_TRUE(bits.none());
+
+  bits.set_range(5, 3);
+  EXPECT_EQ(bits.count(), 3u);
+  EXPECT_EQ(bits.find_first_set(), 5u);
+  EXPECT_EQ(bits.find_last_set(), 7u);
+
+  bits.set_range(30, 100);
+  EXPECT_EQ(bits.count(), 103u);
+  EXPECT_EQ(bits.find_next_set(8), 30u);
+  EXPECT_EQ(bits.find_last_set(), 129u);
+
+  bits.reset_range(31, 98);
+  EXPECT_EQ(bits.count(), 5u);
+  EXPECT_TRUE(bits[30]);
+  EXPECT_FALSE(bits[31]);
+  EXPECT_FALSE(bits[128]);
+  EXPECT_TRUE(bits[129]);
+}
+
+TEST(BitSet, BitwiseOperators) {
+  BitSet<50> a;
+  BitSet<50> b;
+  a.set(1).set(2).set(45);
+  b.set(2).set(3).set(45);
+
+  EXPECT_EQ((a & b).count(), 2u);
+  EXPECT_EQ((a | b).count(), 4u);
+  EXPECT_EQ((a ^ b).count(), 2u);
+  EXPECT_TRUE((a ^ b)[1]);
+  EXPECT_TRUE((a ^ b)[3]);
+  EXPECT_NE(a, b);
+
+  b.reset(3).set(1);
+  EXPECT_EQ(a, b);
+}
+
+TEST(BitSet, MatchesStdBitset) {
+  constexpr size_t kSize = 77;
+  BitSet<kSize> bits;
+  std::bitset<kSize> expected;
+
+  uint32_t state = 1;
+  for (int i = 0; i < 500; ++i) {
+    state = state * 1664525u + 1013904223u;
+    const size_t pos = (state >> 8) % kSize;
+    bits.flip(pos);
+    expected.flip(pos);
+
+    ASSERT_EQ(bits.count(), expected.count());
+    size_t next_set = pos;
+    while (next_set < kSize && !expected[next_set]) {
+      ++next_set;
+    }
+    size_t next_clear = pos;
+    while (next_clear < kSize && expected[next_clear]) {
+      ++next_clear;
+    }
+    ASSERT_EQ(bits.find_next_set(pos), next_set);
+    ASSERT_EQ(bits.find_next_clear(pos), next_clear);
+  }
+}
+
+}  // namespace
+}  // namespace pw
@@ -14,6 +14,7 @@
 
 #include "pw_containers/flat_map.h"
 
+#include <array>
 #include <limits>
 
 #include "gtest/gtest.h"
@@ -178,4 +179,101 @@ TEST(FlatMap, MapsWithUnsortedKeys) {
   EXPECT_EQ(too_short.begin()->first, 0);
 }
 
+namespace {
+
+constexpr EytzingerFlatMap<int, char, 5> kOddEytzingerMap({{
+    {50, 'd'},
+    {-3, 'a'},
+    {100, 'e'},
+    {0, 'b'},
+    {1, 'c'},
+}});
+
+// Keys 0, 3, 6, ..., with the values counting down.
+template <size_t kSize>
+constexpr auto Items() {
+  std::array<typename FlatMap<int, int, kSize>::value_type, kSize> items{};
+  for (size_t i = 0; i < kSize; ++i) {
+    items[i] = {static_cast<int>(3 * i), static_cast<int>(kSize - i)};
+  }
+  return items;
+}
+
+template <size_t kSize>
+void ExpectSameLookups() {
+  constexpr FlatMap<int, int, kSize> kMap(Items<kSize>());
+  constexpr EytzingerFlatMap<int, int, kSize> kEytzinger(Items<kSize>());
+
+  for (int key = -1; key <= static_cast<int>(3 * kSize); ++key) {
+    const bool found = kMap.find(key) != kMap.end();
+    ASSERT_EQ(found, kEytzinger.contains(key));
+    if (found) {
+      EXPECT_EQ(kMap.find(key)->second, kEytzinger.find(key)->second);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(EytzingerFlatMap, Empty) {
+  constexpr EytzingerFlatMap<int, char, 0> kEmpty({{}});
+  EXPECT_TRUE(kEmpty.empty());
+  EXPECT_EQ(kEmpty.end(), kEmpty.find(0));
+  EXPECT_FALSE(kEmpty.contains(0));
+}
+
+TEST(EytzingerFlatMap, Size) { EXPECT_EQ(5u, kOddEytzingerMap.size()); }
+
+TEST(EytzingerFlatMap, LayoutIsBreadthFirst) {
+  // The root is the middle key, followed by the middle of each half.
+  EXPECT_EQ(50, kOddEytzingerMap.begin()[0].first);
+  EXPECT_EQ(0, kOddEytzingerMap.begin()[1].first);
+  EXPECT_EQ(100, kOddEytzingerMap.begin()[2].first);
+  EXPECT_EQ(-3, kOddEytzingerMap.begin()[3].first);
+  EXPECT_EQ(1, kOddEytzingerMap.begin()[4].first);
+}
+
+TEST(EytzingerFlatMap, Find) {
+  static_assert(kOddEytzingerMap.find(50)->second == 'd');
+
+  for (const auto& item : kOddMap) {
+    auto it = kOddEytzingerMap.find(item.first);
+    ASSERT_NE(kOddEytzingerMap.end(), it);
+    EXPECT_EQ(item.first, it->first);
+    EXPECT_EQ(item.second, it->second);
+  }
+}
+
+TEST(EytzingerFlatMap, FindMissing) {
+  EXPECT_EQ(kOddEytzingerMap.end(),
+            kOddEytzingerMap.find(std::numeric_limits<int>::min()));
+  EXPECT_EQ(kOddEytzingerMap.end(), kOddEytzingerMap.find(-1));
+  EXPECT_EQ(kOddEytzingerMap.end(), kOddEytzingerMap.find(2));
+  EXPECT_EQ(kOddEytzingerMap.end(), kOddEytzingerMap.find(101));
+  EXPECT_EQ(kOddEytzingerMap.end(),
+            kOddEytzingerMap.find(std::numeric_limits<int>::max()));
+}
+
+TEST(EytzingerFlatMap, Contains) {
+  EXPECT_TRUE(kOddEytzingerMap.contains(0));
+  EXPECT_FALSE(kOddEytzingerMap.contains(10));
+}
+
+TEST(EytzingerFlatMap, MatchesFlatMap) {
+  ExpectSameLookups<1>();
+  ExpectSameLookups<2>();
+  ExpectSameLookups<3>();
+  ExpectSameLookups<7>();
+  ExpectSameLookups<8>();
+  ExpectSameLookups<70>();
+}
+
+TEST(EytzingerFlatMap, RepeatedKeysFindSameItemAsFlatMap) {
+  constexpr FlatMap<int, char, 4> kMap(
+      {{{2, 'a'}, {1, 'b'}, {2, 'c'}, {2, 'd'}}});
+  constexpr EytzingerFlatMap<int, char, 4> kEytzinger(
+      {{{2, 'a'}, {1, 'b'}, {2, 'c'}, {2, 'd'}}});
+  EXPECT_EQ(kMap.find(2)->second, kEytzinger.find(2)->second);
+}
+
 }  // namespace pw::containers
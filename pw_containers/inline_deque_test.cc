@@ -0,0 +1,197 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/inline_deque.h"
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+// Counts how many instances are alive.
+struct Counter {
+  static int created;
+  static int destroyed;
+
+  static void Reset() { created = destroyed = 0; }
+
+  Counter(int val = 0) : value(val) { created += 1; }
+  Counter(const Counter& other) : value(other.value) { created += 1; }
+  ~Counter() { destroyed += 1; }
+
+  int value;
+};
+
+int Counter::created = 0;
+int Counter::destroyed = 0;
+
+static_assert(std::is_trivially_destructible_v<InlineDeque<int, 4>>);
+static_assert(!std::is_trivially_destructible_v<InlineDeque<Counter, 4>>);
+
+template <typename Deque>
+void ExpectValues(const Deque& deque, std::initializer_list<int> values) {
+  ASSERT_EQ(values.size(), deque.size());
+  auto it = deque.begin();
+  for (int value : values) {
+    EXPECT_EQ(value, *it);
+    ++it;
+  }
+  EXPECT_EQ(deque.end(), it);
+}
+
+TEST(InlineDeque, Construct_Empty) {
+  InlineDeque<int, 3> deque;
+  EXPECT_TRUE(deque.empty());
+  EXPECT_FALSE(deque.full());
+  EXPECT_EQ(0u, deque.size());
+  EXPECT_EQ(3u, deque.max_size());
+  EXPECT_EQ(deque.begin(), deque.end());
+}
+
+TEST(InlineDeque, Construct_ZeroCapacity) {
+  InlineDeque<int, 0> deque;
+  EXPECT_TRUE(deque.empty());
+  EXPECT_TRUE(deque.full());
+}
+
+TEST(InlineDeque, Construct_InitializerList) {
+  InlineDeque<int, 4> deque = {1, 2, 3};
+  ExpectValues(deque, {1, 2, 3});
+}
+
+TEST(InlineDeque, Construct_CopyFromOtherCapacity) {
+  InlineDeque<int, 4> deque = {1, 2, 3};
+  InlineDeque<int, 8> copy(deque);
+  ExpectValues(copy, {1, 2, 3});
+  EXPECT_EQ(deque, copy);
+}
+
+TEST(InlineDeque, PushBackAndPopFront_WrapsAround) {
+  InlineDeque<int, 3> deque;
+  for (int i = 0; i < 10; ++i) {
+    deque.push_back(i);
+    if (deque.full()) {
+      EXPECT_EQ(i - 2, deque.front());
+      deque.pop_front();
+    }
+  }
+  ExpectValues(deque, {8, 9});
+}
+
+TEST(InlineDeque, PushFrontAndPopBack) {
+  InlineDeque<int, 3> deque;
+  deque.push_front(1);
+  deque.push_front(2);
+  deque.push_back(0);
+  EXPECT_TRUE(deque.full());
+  ExpectValues(deque, {2, 1, 0});
+
+  deque.pop_back();
+  ExpectValues(deque, {2, 1});
+  deque.push_front(3);
+  ExpectValues(deque, {3, 2, 1});
+  EXPECT_EQ(3, deque.front());
+  EXPECT_EQ(1, deque.back());
+}
+
+TEST(InlineDeque, Index) {
+  InlineDeque<int, 4> deque = {0, 1, 2, 3};
+  deque.pop_front();
+  deque.pop_front();
+  deque.push_back(4);
+  deque.push_back(5);
+
+  for (size_t i = 0; i < deque.size(); ++i) {
+    EXPECT_EQ(static_cast<int>(i + 2), deque[i]);
+    EXPECT_EQ(static_cast<int>(i + 2), deque.at(i));
+  }
+}
+
+TEST(InlineDeque, ContiguousData_NotWrapped) {
+  InlineDeque<int, 4> deque = {1, 2, 3};
+  auto [first, second] = deque.contiguous_data();
+  ASSERT_EQ(3u, first.size());
+  EXPECT_EQ(1, first[0]);
+  EXPECT_EQ(3, first[2]);
+  EXPECT_TRUE(second.empty());
+}
+
+TEST(InlineDeque, ContiguousData_Wrapped) {
+  InlineDeque<int, 4> deque = {1, 2, 3};
+  deque.push_front(0);
+  deque.pop_back();
+  deque.pop_back();
+  deque.push_front(-1);  // -1, 0, 1 with -1 and 0 at the end of the buffer.
+
+  auto [first, second] = deque.contiguous_data();
+  ASSERT_EQ(2u, first.size());
+  EXPECT_EQ(-1, first[0]);
+  EXPECT_EQ(0, first[1]);
+  ASSERT_EQ(1u, second.size());
+  EXPECT_EQ(1, second[0]);
+}
+
+TEST(InlineDeque, EmptyDequeRestartsAtBeginning) {
+  InlineDeque<int, 4> deque = {1, 2, 3};
+  deque.pop_front();
+  deque.pop_front();
+  deque.pop_front();
+
+  deque.assign({4, 5, 6, 7});
+  EXPECT_EQ(4u, deque.contiguous_data().first.size());
+  EXPECT_TRUE(deque.contiguous_data().second.empty());
+}
+
+TEST(InlineDeque, IterateBackward) {
+  InlineDeque<int, 4> deque = {1, 2, 3};
+  int expected = 3;
+  for (auto it = std::make_reverse_iterator(deque.end());
+       it != std::make_reverse_iterator(deque.begin());
+       ++it) {
+    EXPECT_EQ(expected--, *it);
+  }
+  EXPECT_EQ(0, expected);
+}
+
+TEST(InlineDeque, GenericCapacity) {
+  InlineDeque<int, 4> deque;
+  InlineDeque<int>& generic = deque;
+  generic.push_back(1);
+  generic.push_front(0);
+  EXPECT_EQ(4u, generic.max_size());
+  ExpectValues(deque, {0, 1});
+}
+
+TEST(InlineDeque, DestroysItems) {
+  Counter::Reset();
+  {
+    InlineDeque<Counter, 4> deque;
+    deque.emplace_back(1);
+    deque.emplace_front(2);
+    deque.emplace_back(3);
+    EXPECT_EQ(3, Counter::created);
+
+    deque.pop_front();
+    EXPECT_EQ(1, Counter::destroyed);
+    EXPECT_EQ(1, deque.front().value);
+  }
+  EXPECT_EQ(3, Counter::destroyed);
+}
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,80 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/inline_queue.h"
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+TEST(InlineQueue, Construct_Empty) {
+  InlineQueue<int, 3> queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(0u, queue.size());
+  EXPECT_EQ(3u, queue.capacity());
+}
+
+TEST(InlineQueue, Construct_InitializerList) {
+  InlineQueue<int, 3> queue = {1, 2, 3};
+  EXPECT_TRUE(queue.full());
+  EXPECT_EQ(1, queue.front());
+  EXPECT_EQ(3, queue.back());
+}
+
+TEST(InlineQueue, FirstInFirstOut) {
+  InlineQueue<int, 3> queue;
+  for (int i = 0; i < 10; ++i) {
+    queue.push(i);
+    if (queue.full()) {
+      EXPECT_EQ(i - 2, queue.front());
+      queue.pop();
+    }
+  }
+
+  int expected = 8;
+  for (int value : queue) {
+    EXPECT_EQ(expected++, value);
+  }
+  EXPECT_EQ(10, expected);
+}
+
+TEST(InlineQueue, ContiguousData) {
+  InlineQueue<int, 3> queue = {1, 2, 3};
+  queue.pop();
+  queue.push(4);
+
+  auto [first, second] = queue.contiguous_data();
+  ASSERT_EQ(2u, first.size());
+  EXPECT_EQ(2, first[0]);
+  EXPECT_EQ(3, first[1]);
+  ASSERT_EQ(1u, second.size());
+  EXPECT_EQ(4, second[0]);
+}
+
+TEST(InlineQueue, GenericCapacity) {
+  InlineQueue<int, 4> queue;
+  InlineQueue<int>& generic = queue;
+  generic.emplace(1);
+  generic.push(2);
+  EXPECT_EQ(4u, generic.max_size());
+  EXPECT_EQ(2u, queue.size());
+  EXPECT_EQ(1, queue.front());
+
+  generic.clear();
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,54 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_dlist.h"
+
+#include "pw_assert/check.h"
+
+namespace pw::intrusive_dlist_impl {
+
+void List::Item::unlist() {
+  prev_->next_ = next_;
+  next_->prev_ = prev_;
+
+  // Retain the invariant that unlisted items are self-cycles.
+  next_ = this;
+  prev_ = this;
+}
+
+void List::insert_before(Item* pos, Item& item) {
+  PW_CHECK(
+      item.unlisted(),
+      "Cannot add an item to a pw::IntrusiveDList that is already in a list");
+  item.next_ = pos;
+  item.prev_ = pos->prev_;
+  pos->prev_->next_ = &item;
+  pos->prev_ = &item;
+}
+
+void List::clear() {
+  while (!empty()) {
+    erase(*begin());
+  }
+}
+
+size_t List::CountItems() const {
+  size_t total = 0;
+  for (const Item* item = head_.next_; item != &head_; item = item->next_) {
+    total++;
+  }
+  return total;
+}
+
+}  // namespace pw::intrusive_dlist_impl
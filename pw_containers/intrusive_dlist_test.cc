@@ -0,0 +1,200 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_dlist.h"
+
+#include <array>
+#include <iterator>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+class TestItem : public IntrusiveDList<TestItem>::Item {
+ public:
+  constexpr TestItem(int number = 0) : number_(number) {}
+
+  int number() const { return number_; }
+
+ private:
+  int number_;
+};
+
+class CountedItem : public IntrusiveDList<CountedItem, true>::Item {};
+
+template <typename List>
+void ExpectNumbers(List& list, std::initializer_list<int> numbers) {
+  ASSERT_EQ(numbers.size(), list.size());
+  auto it = list.begin();
+  for (int number : numbers) {
+    EXPECT_EQ(number, it->number());
+    ++it;
+  }
+  EXPECT_EQ(list.end(), it);
+}
+
+TEST(IntrusiveDList, Construct_Empty) {
+  IntrusiveDList<TestItem> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(list.begin(), list.end());
+  EXPECT_EQ(0u, list.size());
+}
+
+TEST(IntrusiveDList, Construct_InitializerList) {
+  TestItem one(1), two(2), three(3);
+  IntrusiveDList<TestItem> list({&one, &two, &three});
+  ExpectNumbers(list, {1, 2, 3});
+  list.clear();
+}
+
+TEST(IntrusiveDList, Construct_Array) {
+  std::array<TestItem, 3> items{TestItem(1), TestItem(2), TestItem(3)};
+  IntrusiveDList<TestItem> list(items.begin(), items.end());
+  ExpectNumbers(list, {1, 2, 3});
+  list.clear();
+}
+
+TEST(IntrusiveDList, PushFrontAndBack) {
+  TestItem one(1), two(2), three(3);
+  IntrusiveDList<TestItem> list;
+  list.push_back(two);
+  list.push_front(one);
+  list.push_back(three);
+
+  ExpectNumbers(list, {1, 2, 3});
+  EXPECT_EQ(&one, &list.front());
+  EXPECT_EQ(&three, &list.back());
+  list.clear();
+}
+
+TEST(IntrusiveDList, PopFrontAndBack) {
+  TestItem one(1), two(2), three(3);
+  IntrusiveDList<TestItem> list({&one, &two, &three});
+
+  list.pop_back();
+  ExpectNumbers(list, {1, 2});
+  list.pop_front();
+  ExpectNumbers(list, {2});
+  list.pop_back();
+  EXPECT_TRUE(list.empty());
+
+  // Popped items can be added to a list again.
+  list.push_back(three);
+  ExpectNumbers(list, {3});
+  list.clear();
+}
+
+TEST(IntrusiveDList, Insert) {
+  TestItem one(1), two(2), three(3);
+  IntrusiveDList<TestItem> list({&one, &three});
+
+  auto it = list.insert(std::next(list.begin()), two);
+  EXPECT_EQ(&two, &(*it));
+  ExpectNumbers(list, {1, 2, 3});
+  list.clear();
+}
+
+TEST(IntrusiveDList, Erase) {
+  TestItem one(1), two(2), three(3);
+  IntrusiveDList<TestItem> list({&one, &two, &three});
+
+  auto it = list.erase(std::next(list.begin()));
+  EXPECT_EQ(&three, &(*it));
+  ExpectNumbers(list, {1, 3});
+  list.clear();
+}
+
+TEST(IntrusiveDList, Remove) {
+  TestItem one(1), two(2), three(3);
+  IntrusiveDList<TestItem> list({&one, &two, &three});
+
+  EXPECT_TRUE(list.remove(two));
+  ExpectNumbers(list, {1, 3});
+  EXPECT_FALSE(list.remove(two));
+
+  EXPECT_TRUE(list.remove(three));
+  EXPECT_TRUE(list.remove(one));
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(IntrusiveDList, IterateBackward) {
+  TestItem one(1), two(2), three(3);
+  IntrusiveDList<TestItem> list({&one, &two, &three});
+
+  int expected = 3;
+  for (auto it = std::make_reverse_iterator(list.end());
+       it != std::make_reverse_iterator(list.begin());
+       ++it) {
+    EXPECT_EQ(expected--, it->number());
+  }
+  EXPECT_EQ(0, expected);
+  list.clear();
+}
+
+TEST(IntrusiveDList, ConstIteration) {
+  TestItem one(1), two(2);
+  IntrusiveDList<TestItem> list({&one, &two});
+  const IntrusiveDList<TestItem>& const_list = list;
+
+  int sum = 0;
+  for (const TestItem& item : const_list) {
+    sum += item.number();
+  }
+  EXPECT_EQ(3, sum);
+  list.clear();
+}
+
+TEST(IntrusiveDList, DestroyedItemUnlistsItself) {
+  TestItem one(1), three(3);
+  IntrusiveDList<TestItem> list({&one});
+  {
+    TestItem two(2);
+    list.push_back(two);
+    list.push_back(three);
+    ExpectNumbers(list, {1, 2, 3});
+  }
+  ExpectNumbers(list, {1, 3});
+  list.clear();
+}
+
+TEST(IntrusiveDList, CachedSize) {
+  CountedItem items[3];
+  IntrusiveDList<CountedItem, true> list;
+  EXPECT_EQ(0u, list.size());
+
+  list.push_back(items[0]);
+  list.push_front(items[1]);
+  list.insert(list.end(), items[2]);
+  EXPECT_EQ(3u, list.size());
+
+  EXPECT_TRUE(list.remove(items[1]));
+  EXPECT_FALSE(list.remove(items[1]));
+  EXPECT_EQ(2u, list.size());
+
+  list.pop_back();
+  EXPECT_EQ(1u, list.size());
+
+  list.erase(list.begin());
+  EXPECT_EQ(0u, list.size());
+  EXPECT_TRUE(list.empty());
+
+  list.assign({&items[0], &items[1]});
+  EXPECT_EQ(2u, list.size());
+  list.clear();
+  EXPECT_EQ(0u, list.size());
+}
+
+}  // namespace
+}  // namespace pw
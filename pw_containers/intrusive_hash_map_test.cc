@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_hash_map.h"
+
+#include <array>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+class TestItem : public IntrusiveHashMap<uint32_t, TestItem>::Item {
+ public:
+  constexpr TestItem(uint32_t id, int value = 0) : Item(id), value_(value) {}
+
+  int value() const { return value_; }
+
+ private:
+  int value_;
+};
+
+class IntrusiveHashMapTest : public ::testing::Test {
+ protected:
+  // Keys 1 and 5 share a bucket.
+  IntrusiveHashMapBuffer<uint32_t, TestItem, 4> map_;
+};
+
+TEST_F(IntrusiveHashMapTest, Empty) {
+  EXPECT_TRUE(map_.empty());
+  EXPECT_EQ(0u, map_.size());
+  EXPECT_EQ(4u, map_.bucket_count());
+  EXPECT_EQ(nullptr, map_.find(1));
+  EXPECT_EQ(map_.begin(), map_.end());
+}
+
+TEST_F(IntrusiveHashMapTest, InsertAndFind) {
+  TestItem one(1, 100), two(2, 200), five(5, 500);
+  EXPECT_TRUE(map_.insert(one));
+  EXPECT_TRUE(map_.insert(two));
+  EXPECT_TRUE(map_.insert(five));
+
+  EXPECT_EQ(3u, map_.size());
+  EXPECT_EQ(&one, map_.find(1));
+  EXPECT_EQ(&two, map_.find(2));
+  EXPECT_EQ(&five, map_.find(5));
+  EXPECT_EQ(500, map_.find(5)->value());
+  EXPECT_FALSE(map_.contains(3));
+  EXPECT_FALSE(map_.contains(9));  // Same bucket as 1 and 5.
+  map_.clear();
+}
+
+TEST_F(IntrusiveHashMapTest, InsertDuplicateKey) {
+  TestItem first(7, 1), second(7, 2);
+  EXPECT_TRUE(map_.insert(first));
+  EXPECT_FALSE(map_.insert(second));
+  EXPECT_EQ(&first, map_.find(7));
+  EXPECT_EQ(1u, map_.size());
+  map_.clear();
+}
+
+TEST_F(IntrusiveHashMapTest, Remove) {
+  TestItem one(1), five(5), nine(9);
+  map_.insert(one);
+  map_.insert(five);
+  map_.insert(nine);
+
+  EXPECT_TRUE(map_.remove(five));
+  EXPECT_FALSE(map_.remove(five));
+  EXPECT_EQ(nullptr, map_.find(5));
+  EXPECT_EQ(&one, map_.find(1));
+  EXPECT_EQ(&nine, map_.find(9));
+
+  // Removed items can be added again.
+  EXPECT_TRUE(map_.insert(five));
+  EXPECT_EQ(&five, map_.find(5));
+  map_.clear();
+}
+
+TEST_F(IntrusiveHashMapTest, DestroyedItemLeavesMap) {
+  TestItem one(1);
+  map_.insert(one);
+  {
+    TestItem five(5);
+    map_.insert(five);
+    EXPECT_EQ(2u, map_.size());
+  }
+  EXPECT_EQ(1u, map_.size());
+  EXPECT_EQ(nullptr, map_.find(5));
+  map_.clear();
+}
+
+TEST_F(IntrusiveHashMapTest, Iterate) {
+  std::array<TestItem, 6> items{TestItem(0, 0),
+                                TestItem(3, 3),
+                                TestItem(4, 4),
+                                TestItem(8, 8),
+                                TestItem(10, 10),
+                                TestItem(13, 13)};
+  for (TestItem& item : items) {
+    ASSERT_TRUE(map_.insert(item));
+  }
+
+  int sum = 0;
+  size_t count = 0;
+  for (TestItem& item : map_) {
+    sum += item.value();
+    count += 1;
+  }
+  EXPECT_EQ(6u, count);
+  EXPECT_EQ(0 + 3 + 4 + 8 + 10 + 13, sum);
+  map_.clear();
+}
+
+TEST_F(IntrusiveHashMapTest, Clear) {
+  TestItem one(1), two(2);
+  map_.insert(one);
+  map_.insert(two);
+  map_.clear();
+  EXPECT_TRUE(map_.empty());
+
+  IntrusiveHashMapBuffer<uint32_t, TestItem, 2> other;
+  EXPECT_TRUE(other.insert(one));
+  other.clear();
+}
+
+}  // namespace
+}  // namespace pw
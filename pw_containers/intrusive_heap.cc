@@ -0,0 +1,132 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_heap.h"
+
+#include "pw_assert/check.h"
+
+namespace pw::intrusive_heap_impl {
+
+// Removing an item requires the heap's comparison function, so items cannot
+// remove themselves like IntrusiveList items do.
+Heap::Item::~Item() {
+  PW_DCHECK(!in_heap(), "Items must be removed from an IntrusiveHeap first");
+}
+
+void Heap::push(Item& item) {
+  PW_CHECK(!item.in_heap(),
+           "Cannot add an item to a pw::IntrusiveHeap that is already in one");
+  item.Reset();
+  SetTop(empty() ? &item : Meld(top(), &item));
+}
+
+void Heap::pop() { remove(*top()); }
+
+bool Heap::remove(Item& item) {
+  if (!item.in_heap()) {
+    return false;
+  }
+
+  // Unlink the item from its parent or previous sibling. The top item's parent
+  // is head_.
+  if (item.prev_->child_ == &item) {
+    item.prev_->child_ = item.next_;
+  } else {
+    item.prev_->next_ = item.next_;
+  }
+  if (item.next_ != nullptr) {
+    item.next_->prev_ = item.prev_;
+  }
+
+  // The item's children form a heap of their own. Meld it back in.
+  Item* children = MergePairs(item.child_);
+  item.Reset();
+
+  if (children != nullptr) {
+    SetTop(empty() ? children : Meld(top(), children));
+  }
+  return true;
+}
+
+void Heap::clear() {
+  // Reset every item. Children are appended to the list of items to visit, so
+  // each item is visited once.
+  Item* pending = top();
+  Item* last = pending;
+  while (pending != nullptr) {
+    Item* item = pending;
+    if (item->child_ != nullptr) {
+      last->next_ = item->child_;
+      while (last->next_ != nullptr) {
+        last = last->next_;
+      }
+    }
+    pending = item->next_;
+    item->Reset();
+  }
+  head_.child_ = nullptr;
+}
+
+Heap::Item* Heap::Meld(Item* first, Item* second) {
+  if (less_(*second, *first)) {
+    Item* temp = first;
+    first = second;
+    second = temp;
+  }
+
+  // Make second the first child of first.
+  second->prev_ = first;
+  second->next_ = first->child_;
+  if (first->child_ != nullptr) {
+    first->child_->prev_ = second;
+  }
+  first->child_ = second;
+  return first;
+}
+
+Heap::Item* Heap::MergePairs(Item* first) {
+  if (first == nullptr) {
+    return nullptr;
+  }
+
+  // First pass: meld the items in pairs from left to right. The results are
+  // linked through next_ in reverse order.
+  Item* pairs = nullptr;
+  while (first != nullptr) {
+    Item* second = first->next_;
+    Item* rest = second == nullptr ? nullptr : second->next_;
+    Item* pair = second == nullptr ? first : Meld(first, second);
+    pair->next_ = pairs;
+    pairs = pair;
+    first = rest;
+  }
+
+  // Second pass: meld the pairs from right to left.
+  Item* result = pairs;
+  pairs = pairs->next_;
+  while (pairs != nullptr) {
+    Item* next = pairs->next_;
+    result = Meld(result, pairs);
+    pairs = next;
+  }
+  return result;
+}
+
+void Heap::SetTop(Item* item) {
+  head_.child_ = item;
+  item->prev_ = &head_;
+  item->next_ = nullptr;
+}
+
+}  // namespace pw::intrusive_heap_impl
@@ -0,0 +1,179 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_containers/intrusive_heap.h"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+class Deadline : public IntrusiveHeap<Deadline>::Item {
+ public:
+  constexpr Deadline(int64_t time = 0) : time_(time) {}
+
+  int64_t time() const { return time_; }
+  void set_time(int64_t time) { time_ = time; }
+
+  bool operator<(const Deadline& other) const { return time_ < other.time_; }
+
+ private:
+  int64_t time_;
+};
+
+class IntrusiveHeapTest : public ::testing::Test {
+ protected:
+  // Pops every item and checks that they come out in order.
+  void ExpectPopsInOrder(size_t expected_count) {
+    size_t count = 0;
+    int64_t previous = INT64_MIN;
+    while (!heap_.empty()) {
+      EXPECT_LE(previous, heap_.top().time());
+      previous = heap_.top().time();
+      heap_.pop();
+      count += 1;
+    }
+    EXPECT_EQ(expected_count, count);
+  }
+
+  IntrusiveHeap<Deadline> heap_;
+};
+
+TEST_F(IntrusiveHeapTest, Empty) { EXPECT_TRUE(heap_.empty()); }
+
+TEST_F(IntrusiveHeapTest, PushAndTop) {
+  Deadline a(30), b(10), c(20);
+  heap_.push(a);
+  EXPECT_EQ(&a, &heap_.top());
+  heap_.push(b);
+  EXPECT_EQ(&b, &heap_.top());
+  heap_.push(c);
+  EXPECT_EQ(&b, &heap_.top());
+  EXPECT_FALSE(heap_.empty());
+  heap_.clear();
+}
+
+TEST_F(IntrusiveHeapTest, PopsInOrder) {
+  // A fixed pseudorandom sequence of times, including repeats.
+  std::array<Deadline, 64> items;
+  uint32_t state = 12345;
+  for (Deadline& item : items) {
+    state = state * 1103515245u + 12345u;
+    item.set_time((state >> 16) % 100);
+    heap_.push(item);
+  }
+  ExpectPopsInOrder(items.size());
+}
+
+TEST_F(IntrusiveHeapTest, RemoveTop) {
+  Deadline a(1), b(2), c(3);
+  heap_.push(a);
+  heap_.push(b);
+  heap_.push(c);
+  EXPECT_TRUE(heap_.remove(a));
+  EXPECT_EQ(&b, &heap_.top());
+  ExpectPopsInOrder(2);
+}
+
+TEST_F(IntrusiveHeapTest, RemoveAnyItem) {
+  std::array<Deadline, 32> items;
+  for (size_t i = 0; i < items.size(); ++i) {
+    items[i].set_time((i * 7) % 32);
+    heap_.push(items[i]);
+  }
+  // Pop a few so the heap has more structure than a list of children.
+  heap_.pop();
+  heap_.pop();
+
+  size_t removed = 0;
+  for (size_t i = 0; i < items.size(); i += 3) {
+    if (heap_.remove(items[i])) {
+      removed += 1;
+    }
+  }
+  EXPECT_GT(removed, 0u);
+  ExpectPopsInOrder(items.size() - 2 - removed);
+}
+
+TEST_F(IntrusiveHeapTest, RemoveItemNotInHeap) {
+  Deadline a(1), b(2);
+  heap_.push(a);
+  EXPECT_FALSE(heap_.remove(b));
+  EXPECT_TRUE(heap_.remove(a));
+  EXPECT_FALSE(heap_.remove(a));
+  EXPECT_TRUE(heap_.empty());
+}
+
+TEST_F(IntrusiveHeapTest, Reschedule) {
+  Deadline a(10), b(20);
+  heap_.push(a);
+  heap_.push(b);
+
+  heap_.remove(a);
+  a.set_time(30);
+  heap_.push(a);
+  EXPECT_EQ(&b, &heap_.top());
+  heap_.pop();
+  EXPECT_EQ(&a, &heap_.top());
+  heap_.pop();
+}
+
+TEST_F(IntrusiveHeapTest, Clear) {
+  std::array<Deadline, 8> items;
+  for (size_t i = 0; i < items.size(); ++i) {
+    items[i].set_time(i);
+    heap_.push(items[i]);
+  }
+  heap_.pop();
+
+  heap_.clear();
+  EXPECT_TRUE(heap_.empty());
+
+  // Cleared items can be added again.
+  heap_.push(items[3]);
+  EXPECT_EQ(&items[3], &heap_.top());
+  heap_.pop();
+}
+
+class Priority : public IntrusiveHeap<Priority, std::greater<>>::Item {
+ public:
+  constexpr Priority(int priority) : value(priority) {}
+
+  bool operator>(const Priority& other) const { return value > other.value; }
+
+  int value;
+};
+
+TEST(IntrusiveHeap, CustomCompare) {
+  Priority low(1), high(9), medium(5);
+  IntrusiveHeap<Priority, std::greater<>> heap;
+  heap.push(low);
+  heap.push(high);
+  heap.push(medium);
+
+  EXPECT_EQ(9, heap.top().value);
+  heap.pop();
+  EXPECT_EQ(5, heap.top().value);
+  heap.pop();
+  EXPECT_EQ(1, heap.top().value);
+  heap.pop();
+  EXPECT_TRUE(heap.empty());
+}
+
+}  // namespace
+}  // namespace pw
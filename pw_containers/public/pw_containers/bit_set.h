@@ -0,0 +1,297 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "pw_assert/assert.h"
+
+namespace pw {
+
+// BitSet is a fixed-size set of bits, like std::bitset, that can also search
+// for set and clear bits. The bits are stored in 32-bit words, and searches,
+// counts, and range updates handle a whole word at a time with the compiler's
+// count-trailing-zeros, count-leading-zeros, and population count builtins, so
+// finding the first free slot in a 1024-entry bitmap takes at most 32 word
+// loads rather than 1024 bit tests.
+//
+//   pw::BitSet<256> in_use;
+//   size_t slot = in_use.find_first_clear();
+//   if (slot == in_use.size()) {
+//     return Status::ResourceExhausted();
+//   }
+//   in_use.set(slot);
+//
+// The find functions return size() if there is no matching bit. All functions
+// are constexpr, so a BitSet can be initialized at compile time.
+template <size_t kBits>
+class BitSet {
+ public:
+  using Word = uint32_t;
+
+  static_assert(kBits > 0u, "A BitSet must hold at least one bit");
+  static_assert(std::is_same_v<Word, unsigned>,
+                "The word builtins take unsigned int");
+
+  constexpr BitSet() : words_{} {}
+
+  constexpr BitSet(const BitSet&) = default;
+  constexpr BitSet& operator=(const BitSet&) = default;
+
+  static constexpr size_t size() { return kBits; }
+
+  constexpr bool test(size_t pos) const {
+    PW_DASSERT(pos < kBits);
+    return (words_[pos / kWordBits] & BitMask(pos)) != 0u;
+  }
+
+  constexpr bool operator[](size_t pos) const { return test(pos); }
+
+  constexpr BitSet& set(size_t pos) {
+    PW_DASSERT(pos < kBits);
+    words_[pos / kWordBits] |= BitMask(pos);
+    return *this;
+  }
+
+  constexpr BitSet& set(size_t pos, bool value) {
+    return value ? set(pos) : reset(pos);
+  }
+
+  constexpr BitSet& reset(size_t pos) {
+    PW_DASSERT(pos < kBits);
+    words_[pos / kWordBits] &= ~BitMask(pos);
+    return *this;
+  }
+
+  constexpr BitSet& flip(size_t pos) {
+    PW_DASSERT(pos < kBits);
+    words_[pos / kWordBits] ^= BitMask(pos);
+    return *this;
+  }
+
+  // Sets, clears, or flips every bit.
+  constexpr BitSet& set() {
+    for (Word& word : words_) {
+      word = kAllOnes;
+    }
+    ClearUnusedBits();
+    return *this;
+  }
+
+  constexpr BitSet& reset() {
+    for (Word& word : words_) {
+      word = 0u;
+    }
+    return *this;
+  }
+
+  constexpr BitSet& flip() {
+    for (Word& word : words_) {
+      word = ~word;
+    }
+    ClearUnusedBits();
+    return *this;
+  }
+
+  // Sets or clears the count bits starting at first. Whole words in the range
+  // are written directly, and the partial words at each end are masked.
+  constexpr BitSet& set_range(size_t first, size_t count) {
+    return UpdateRange(first, count, true);
+  }
+
+  constexpr BitSet& reset_range(size_t first, size_t count) {
+    return UpdateRange(first, count, false);
+  }
+
+  // Returns the number of set bits.
+  constexpr size_t count() const {
+    size_t total = 0;
+    for (Word word : words_) {
+      total += static_cast<size_t>(__builtin_popcount(word));
+    }
+    return total;
+  }
+
+  constexpr bool any() const {
+    for (Word word : words_) {
+      if (word != 0u) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  constexpr bool none() const { return !any(); }
+
+  constexpr bool all() const { return find_first_clear() == kBits; }
+
+  // Returns the index of the first set bit, or size() if no bits are set.
+  constexpr size_t find_first_set() const { return find_next_set(0); }
+
+  // Returns the index of the first set bit at or after pos, or size() if there
+  // is none.
+  constexpr size_t find_next_set(size_t pos) const {
+    if (pos >= kBits) {
+      return kBits;
+    }
+    size_t index = pos / kWordBits;
+    Word word = words_[index] & (kAllOnes << (pos % kWordBits));
+    while (word == 0u) {
+      if (++index == kWords) {
+        return kBits;
+      }
+      word = words_[index];
+    }
+    return index * kWordBits + static_cast<size_t>(__builtin_ctz(word));
+  }
+
+  // Returns the index of the first clear bit, or size() if all bits are set.
+  constexpr size_t find_first_clear() const { return find_next_clear(0); }
+
+  // Returns the index of the first clear bit at or after pos, or size() if
+  // there is none.
+  constexpr size_t find_next_clear(size_t pos) const {
+    if (pos >= kBits) {
+      return kBits;
+    }
+    size_t index = pos / kWordBits;
+    Word word = ~words_[index] & (kAllOnes << (pos % kWordBits));
+    while (word == 0u) {
+      if (++index == kWords) {
+        return kBits;
+      }
+      word = ~words_[index];
+    }
+    // The unused bits of the last word are always clear, so the search may
+    // land past the end.
+    const size_t found =
+        index * kWordBits + static_cast<size_t>(__builtin_ctz(word));
+    return found < kBits ? found : kBits;
+  }
+
+  // Returns the index of the last set bit, or size() if no bits are set.
+  constexpr size_t find_last_set() const {
+    for (size_t index = kWords; index > 0u; --index) {
+      const Word word = words_[index - 1];
+      if (word != 0u) {
+        return index * kWordBits - 1 - static_cast<size_t>(__builtin_clz(word));
+      }
+    }
+    return kBits;
+  }
+
+  constexpr BitSet& operator&=(const BitSet& other) {
+    for (size_t i = 0; i < kWords; ++i) {
+      words_[i] &= other.words_[i];
+    }
+    return *this;
+  }
+
+  constexpr BitSet& operator|=(const BitSet& other) {
+    for (size_t i = 0; i < kWords; ++i) {
+      words_[i] |= other.words_[i];
+    }
+    return *this;
+  }
+
+  constexpr BitSet& operator^=(const BitSet& other) {
+    for (size_t i = 0; i < kWords; ++i) {
+      words_[i] ^= other.words_[i];
+    }
+    return *this;
+  }
+
+  constexpr BitSet operator~() const { return BitSet(*this).flip(); }
+
+  friend constexpr BitSet operator&(BitSet lhs, const BitSet& rhs) {
+    return lhs &= rhs;
+  }
+
+  friend constexpr BitSet operator|(BitSet lhs, const BitSet& rhs) {
+    return lhs |= rhs;
+  }
+
+  friend constexpr BitSet operator^(BitSet lhs, const BitSet& rhs) {
+    return lhs ^= rhs;
+  }
+
+  friend constexpr bool operator==(const BitSet& lhs, const BitSet& rhs) {
+    for (size_t i = 0; i < kWords; ++i) {
+      if (lhs.words_[i] != rhs.words_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  friend constexpr bool operator!=(const BitSet& lhs, const BitSet& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  static constexpr size_t kWordBits = std::numeric_limits<Word>::digits;
+  static constexpr size_t kWords = (kBits + kWordBits - 1) / kWordBits;
+  static constexpr Word kAllOnes = ~Word{0};
+
+  // Bits of the last word that are past the end. These are always zero so that
+  // count(), all(), and comparisons can work on whole words.
+  static constexpr Word kLastWordMask =
+      kBits % kWordBits == 0u ? kAllOnes
+                              : kAllOnes >> (kWordBits - kBits % kWordBits);
+
+  static constexpr Word BitMask(size_t pos) {
+    return Word{1} << (pos % kWordBits);
+  }
+
+  constexpr void ClearUnusedBits() { words_[kWords - 1] &= kLastWordMask; }
+
+  constexpr BitSet& UpdateRange(size_t first, size_t count, bool value) {
+    PW_ASSERT(first <= kBits && count <= kBits - first);
+    if (count == 0u) {
+      return *this;
+    }
+    const size_t last = first + count - 1;
+    size_t index = first / kWordBits;
+    const size_t last_index = last / kWordBits;
+    const Word first_mask = kAllOnes << (first % kWordBits);
+    const Word last_mask = kAllOnes >> (kWordBits - 1 - last % kWordBits);
+
+    if (index == last_index) {
+      UpdateWord(index, first_mask & last_mask, value);
+      return *this;
+    }
+    UpdateWord(index, first_mask, value);
+    for (++index; index < last_index; ++index) {
+      words_[index] = value ? kAllOnes : Word{0};
+    }
+    UpdateWord(last_index, last_mask, value);
+    return *this;
+  }
+
+  constexpr void UpdateWord(size_t index, Word mask, bool value) {
+    if (value) {
+      words_[index] |= mask;
+    } else {
+      words_[index] &= ~mask;
+    }
+  }
+
+  std::array<Word, kWords> words_;
+};
+
+}  // namespace pw
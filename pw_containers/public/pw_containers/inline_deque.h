@@ -0,0 +1,417 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_polyfill/language_feature_macros.h"
+
+namespace pw {
+namespace inline_deque_impl {
+
+template <typename I>
+using IsIterator = std::negation<
+    std::is_same<typename std::iterator_traits<I>::value_type, void>>;
+
+// Used as the capacity in the generic-capacity InlineDeque<T> interface.
+PW_INLINE_VARIABLE constexpr size_t kGeneric = size_t(-1);
+
+// Makes InlineDeque<T> trivially destructible if T is, as in Vector.
+template <typename DequeClass, bool kIsTriviallyDestructible>
+class DestructorHelper;
+
+template <typename DequeClass>
+class DestructorHelper<DequeClass, true> {
+ public:
+  ~DestructorHelper() = default;
+};
+
+template <typename DequeClass>
+class DestructorHelper<DequeClass, false> {
+ public:
+  ~DestructorHelper() { static_cast<DequeClass*>(this)->clear(); }
+};
+
+// Iterates over an InlineDeque in order from front to back.
+template <typename DequeClass, typename ValueType>
+class Iterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::remove_cv_t<ValueType>;
+  using pointer = ValueType*;
+  using reference = ValueType&;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  constexpr Iterator() : deque_(nullptr), position_(0) {}
+
+  constexpr Iterator(DequeClass* deque, size_t position)
+      : deque_(deque), position_(position) {}
+
+  Iterator& operator++() {
+    position_ += 1;
+    return *this;
+  }
+
+  Iterator operator++(int) {
+    Iterator previous_value = *this;
+    operator++();
+    return previous_value;
+  }
+
+  Iterator& operator--() {
+    position_ -= 1;
+    return *this;
+  }
+
+  Iterator operator--(int) {
+    Iterator previous_value = *this;
+    operator--();
+    return previous_value;
+  }
+
+  reference operator*() const { return (*deque_)[Index()]; }
+  pointer operator->() const { return &(*deque_)[Index()]; }
+
+  constexpr bool operator==(const Iterator& rhs) const {
+    return deque_ == rhs.deque_ && position_ == rhs.position_;
+  }
+  constexpr bool operator!=(const Iterator& rhs) const {
+    return !(*this == rhs);
+  }
+
+ private:
+  typename DequeClass::size_type Index() const {
+    return static_cast<typename DequeClass::size_type>(position_);
+  }
+
+  DequeClass* deque_;
+  size_t position_;
+};
+
+}  // namespace inline_deque_impl
+
+// InlineDeque is a double-ended queue backed by a fixed-size circular buffer.
+// Items can be pushed and popped at either end in O(1), without moving the
+// other items. InlineDeques must be declared with an explicit capacity (e.g.
+// InlineDeque<int, 10>), but can be used and referred to without it (e.g.
+// InlineDeque<int>), in the same way as pw::Vector.
+//
+// Since the buffer is circular, the items are not always contiguous.
+// contiguous_data() returns the items as two spans, the second of which is
+// empty when the items do not wrap around the end of the buffer.
+template <typename T, size_t kCapacity = inline_deque_impl::kGeneric>
+class InlineDeque : public InlineDeque<T, inline_deque_impl::kGeneric> {
+ private:
+  using Base = InlineDeque<T, inline_deque_impl::kGeneric>;
+
+ public:
+  using typename Base::const_iterator;
+  using typename Base::const_pointer;
+  using typename Base::const_reference;
+  using typename Base::difference_type;
+  using typename Base::iterator;
+  using typename Base::pointer;
+  using typename Base::reference;
+  using typename Base::size_type;
+  using typename Base::value_type;
+
+  // Construct
+  InlineDeque() noexcept : Base(kCapacity) {}
+
+  InlineDeque(size_type count, const T& value) : Base(kCapacity) {
+    this->assign(count, value);
+  }
+
+  InlineDeque(const InlineDeque& other) : Base(kCapacity) {
+    this->assign(other.begin(), other.end());
+  }
+
+  template <size_t kOtherCapacity>
+  InlineDeque(const InlineDeque<T, kOtherCapacity>& other) : Base(kCapacity) {
+    this->assign(other.begin(), other.end());
+  }
+
+  InlineDeque(std::initializer_list<T> list) : Base(kCapacity) {
+    this->assign(list.begin(), list.end());
+  }
+
+  InlineDeque& operator=(const InlineDeque& other) {
+    this->assign(other.begin(), other.end());
+    return *this;
+  }
+
+  template <size_t kOtherCapacity>
+  InlineDeque& operator=(const InlineDeque<T, kOtherCapacity>& other) {
+    this->assign(other.begin(), other.end());
+    return *this;
+  }
+
+  InlineDeque& operator=(std::initializer_list<T> list) {
+    this->assign(list.begin(), list.end());
+    return *this;
+  }
+
+  // All other methods are implemented on the InlineDeque<T> base class.
+
+ private:
+  friend class InlineDeque<T, inline_deque_impl::kGeneric>;
+
+  static_assert(kCapacity <= std::numeric_limits<size_type>::max());
+
+  // Provides access to the underlying array as an array of T.
+#ifdef __cpp_lib_launder
+  pointer array() { return std::launder(reinterpret_cast<T*>(&array_)); }
+  const_pointer array() const {
+    return std::launder(reinterpret_cast<const T*>(&array_));
+  }
+#else
+  pointer array() { return reinterpret_cast<T*>(&array_); }
+  const_pointer array() const { return reinterpret_cast<const T*>(&array_); }
+#endif  // __cpp_lib_launder
+
+  // Items are stored as uninitialized memory blocks aligned correctly for the
+  // type and initialized on demand with placement new, as in Vector.
+  alignas(T) std::array<std::aligned_storage_t<sizeof(T), alignof(T)>,
+                        kCapacity> array_;
+};
+
+// Defines the generic-capacity InlineDeque<T> specialization, which serves as
+// the base class for InlineDeque<T> of any capacity. Except for constructors,
+// all InlineDeque methods are implemented on this class.
+template <typename T>
+class InlineDeque<T, inline_deque_impl::kGeneric>
+    : public inline_deque_impl::DestructorHelper<
+          InlineDeque<T, inline_deque_impl::kGeneric>,
+          std::is_trivially_destructible<T>::value> {
+ public:
+  using value_type = T;
+
+  // As in Vector, 65535 items is a reasonable limit for a statically
+  // allocated container, and a short keeps the overhead small.
+  using size_type = unsigned short;
+
+  using difference_type = ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using iterator = inline_deque_impl::Iterator<InlineDeque, T>;
+  using const_iterator =
+      inline_deque_impl::Iterator<const InlineDeque, const T>;
+
+  // An InlineDeque without an explicit capacity (InlineDeque<T>) cannot be
+  // constructed directly. Instead, construct an InlineDeque<T, kCapacity>.
+
+  InlineDeque& operator=(const InlineDeque& other) {
+    assign(other.begin(), other.end());
+    return *this;
+  }
+
+  void assign(size_type count, const T& value) {
+    clear();
+    for (size_type i = 0; i < count; ++i) {
+      push_back(value);
+    }
+  }
+
+  template <typename Iterator,
+            typename...,
+            typename = std::enable_if_t<
+                inline_deque_impl::IsIterator<Iterator>::value>>
+  void assign(Iterator first, Iterator last) {
+    clear();
+    while (first != last) {
+      push_back(*first++);
+    }
+  }
+
+  void assign(std::initializer_list<T> list) {
+    assign(list.begin(), list.end());
+  }
+
+  // Access
+
+  reference at(size_type index) {
+    PW_ASSERT(index < size());
+    return data()[BufferIndex(index)];
+  }
+  const_reference at(size_type index) const {
+    PW_ASSERT(index < size());
+    return data()[BufferIndex(index)];
+  }
+
+  reference operator[](size_type index) {
+    PW_DASSERT(index < size());
+    return data()[BufferIndex(index)];
+  }
+  const_reference operator[](size_type index) const {
+    PW_DASSERT(index < size());
+    return data()[BufferIndex(index)];
+  }
+
+  reference front() { return operator[](0); }
+  const_reference front() const { return operator[](0); }
+
+  reference back() { return operator[](size() - 1); }
+  const_reference back() const { return operator[](size() - 1); }
+
+  // Returns the items in order as two spans. The second span is empty unless
+  // the items wrap around the end of the buffer.
+  std::pair<std::span<T>, std::span<T>> contiguous_data() {
+    const size_t first_size = FirstSpanSize();
+    return {std::span(data() + head_, first_size),
+            std::span(data(), size() - first_size)};
+  }
+  std::pair<std::span<const T>, std::span<const T>> contiguous_data() const {
+    const size_t first_size = FirstSpanSize();
+    return {std::span(data() + head_, first_size),
+            std::span(data(), size() - first_size)};
+  }
+
+  // Iterate
+
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return cbegin(); }
+  const_iterator cbegin() const noexcept { return const_iterator(this, 0); }
+
+  iterator end() noexcept { return iterator(this, size()); }
+  const_iterator end() const noexcept { return cend(); }
+  const_iterator cend() const noexcept {
+    return const_iterator(this, size());
+  }
+
+  // Size
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0u; }
+
+  // True if there is no free space. Adding an item to a full InlineDeque
+  // fails an assert.
+  [[nodiscard]] bool full() const noexcept { return size() == max_size(); }
+
+  size_t size() const noexcept { return count_; }
+
+  size_t max_size() const noexcept { return capacity_; }
+
+  size_t capacity() const noexcept { return max_size(); }
+
+  // Modify
+
+  void clear() noexcept {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+
+  void push_back(const T& value) { emplace_back(value); }
+
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  template <typename... Args>
+  void emplace_back(Args&&... args) {
+    PW_ASSERT(!full());
+    new (&data()[BufferIndex(count_)]) T(std::forward<Args>(args)...);
+    count_ += 1;
+  }
+
+  void push_front(const T& value) { emplace_front(value); }
+
+  void push_front(T&& value) { emplace_front(std::move(value)); }
+
+  template <typename... Args>
+  void emplace_front(Args&&... args) {
+    PW_ASSERT(!full());
+    const size_type new_head = head_ == 0u ? capacity_ - 1 : head_ - 1;
+    new (&data()[new_head]) T(std::forward<Args>(args)...);
+    head_ = new_head;
+    count_ += 1;
+  }
+
+  // Removes the last item. The InlineDeque must not be empty.
+  void pop_back() {
+    PW_ASSERT(!empty());
+    back().~T();
+    count_ -= 1;
+    ResetHeadIfEmpty();
+  }
+
+  // Removes the first item. The InlineDeque must not be empty.
+  void pop_front() {
+    PW_ASSERT(!empty());
+    front().~T();
+    head_ = BufferIndex(1);
+    count_ -= 1;
+    ResetHeadIfEmpty();
+  }
+
+ protected:
+  explicit constexpr InlineDeque(size_type capacity) noexcept
+      : capacity_(capacity) {}
+
+ private:
+  // The underlying data is in the derived class from which this instance was
+  // constructed, at the same offset for every capacity; see Vector::data().
+  T* data() noexcept { return static_cast<InlineDeque<T, 0>*>(this)->array(); }
+  const T* data() const noexcept {
+    return static_cast<const InlineDeque<T, 0>*>(this)->array();
+  }
+
+  // Converts an index from the front of the deque to an index in the buffer.
+  size_type BufferIndex(size_t index) const {
+    const size_t buffer_index = head_ + index;
+    return static_cast<size_type>(
+        buffer_index < capacity_ ? buffer_index : buffer_index - capacity_);
+  }
+
+  size_t FirstSpanSize() const {
+    const size_t to_end = capacity_ - head_;
+    return count_ < to_end ? count_ : to_end;
+  }
+
+  // Starting over at the beginning of the buffer keeps the items contiguous
+  // for as long as possible.
+  void ResetHeadIfEmpty() {
+    if (count_ == 0u) {
+      head_ = 0;
+    }
+  }
+
+  const size_type capacity_;
+  size_type head_ = 0;
+  size_type count_ = 0;
+};
+
+template <typename T, size_t kLhsCapacity, size_t kRhsCapacity>
+bool operator==(const InlineDeque<T, kLhsCapacity>& lhs,
+                const InlineDeque<T, kRhsCapacity>& rhs) {
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename T, size_t kLhsCapacity, size_t kRhsCapacity>
+bool operator!=(const InlineDeque<T, kLhsCapacity>& lhs,
+                const InlineDeque<T, kRhsCapacity>& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace pw
@@ -0,0 +1,128 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <utility>
+
+#include "pw_containers/inline_deque.h"
+
+namespace pw {
+
+// InlineQueue is a first-in, first-out queue backed by a fixed-size circular
+// buffer, like std::queue on top of an InlineDeque. Items are pushed to the
+// back and popped from the front in O(1). As with InlineDeque, InlineQueues are
+// declared with a capacity (e.g. InlineQueue<int, 10>) and can be referred to
+// without it (e.g. InlineQueue<int>).
+template <typename T, size_t kCapacity = inline_deque_impl::kGeneric>
+class InlineQueue : public InlineQueue<T, inline_deque_impl::kGeneric> {
+ public:
+  InlineQueue() = default;
+
+  InlineQueue(std::initializer_list<T> list) : deque_(list) {}
+
+  // All other methods are implemented on the InlineQueue<T> base class.
+
+ private:
+  friend class InlineQueue<T, inline_deque_impl::kGeneric>;
+
+  InlineDeque<T, kCapacity> deque_;
+};
+
+// The generic-capacity InlineQueue<T> specialization, which serves as the base
+// class for InlineQueue<T> of any capacity.
+template <typename T>
+class InlineQueue<T, inline_deque_impl::kGeneric> {
+ public:
+  using value_type = T;
+  using size_type = typename InlineDeque<T>::size_type;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using iterator = typename InlineDeque<T>::iterator;
+  using const_iterator = typename InlineDeque<T>::const_iterator;
+
+  InlineQueue(const InlineQueue&) = delete;
+  InlineQueue& operator=(const InlineQueue&) = delete;
+
+  // Access
+
+  reference front() { return deque().front(); }
+  const_reference front() const { return deque().front(); }
+
+  reference back() { return deque().back(); }
+  const_reference back() const { return deque().back(); }
+
+  // Returns the items from front to back as two spans. The second span is
+  // empty unless the items wrap around the end of the buffer.
+  std::pair<std::span<const T>, std::span<const T>> contiguous_data() const {
+    return deque().contiguous_data();
+  }
+
+  // Iterate, from front to back.
+
+  iterator begin() noexcept { return deque().begin(); }
+  const_iterator begin() const noexcept { return deque().begin(); }
+  const_iterator cbegin() const noexcept { return deque().cbegin(); }
+
+  iterator end() noexcept { return deque().end(); }
+  const_iterator end() const noexcept { return deque().end(); }
+  const_iterator cend() const noexcept { return deque().cend(); }
+
+  // Size
+
+  [[nodiscard]] bool empty() const noexcept { return deque().empty(); }
+
+  // True if there is no free space. Pushing to a full InlineQueue fails an
+  // assert.
+  [[nodiscard]] bool full() const noexcept { return deque().full(); }
+
+  size_t size() const noexcept { return deque().size(); }
+
+  size_t max_size() const noexcept { return deque().max_size(); }
+
+  size_t capacity() const noexcept { return deque().capacity(); }
+
+  // Modify
+
+  void clear() noexcept { deque().clear(); }
+
+  void push(const T& value) { deque().push_back(value); }
+
+  void push(T&& value) { deque().push_back(std::move(value)); }
+
+  template <typename... Args>
+  void emplace(Args&&... args) {
+    deque().emplace_back(std::forward<Args>(args)...);
+  }
+
+  // Removes the first item. The InlineQueue must not be empty.
+  void pop() { deque().pop_front(); }
+
+ protected:
+  constexpr InlineQueue() = default;
+
+ private:
+  // The deque is the only member of every InlineQueue<T, kCapacity>, so it is
+  // at the same offset for every capacity; see Vector::data().
+  InlineDeque<T>& deque() {
+    return static_cast<InlineQueue<T, 0>*>(this)->deque_;
+  }
+  const InlineDeque<T>& deque() const {
+    return static_cast<const InlineQueue<T, 0>*>(this)->deque_;
+  }
+};
+
+}  // namespace pw
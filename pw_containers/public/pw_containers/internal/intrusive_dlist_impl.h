@@ -0,0 +1,143 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace pw {
+
+template <typename, bool>
+class IntrusiveDList;
+
+namespace intrusive_dlist_impl {
+
+template <typename T, typename I>
+class Iterator {
+ public:
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::remove_cv_t<T>;
+  using pointer = T*;
+  using reference = T&;
+  using iterator_category = std::bidirectional_iterator_tag;
+
+  constexpr explicit Iterator() : item_(nullptr) {}
+
+  constexpr Iterator& operator++() {
+    item_ = static_cast<I*>(item_->next_);
+    return *this;
+  }
+
+  constexpr Iterator operator++(int) {
+    Iterator previous_value(item_);
+    operator++();
+    return previous_value;
+  }
+
+  constexpr Iterator& operator--() {
+    item_ = static_cast<I*>(item_->prev_);
+    return *this;
+  }
+
+  constexpr Iterator operator--(int) {
+    Iterator previous_value(item_);
+    operator--();
+    return previous_value;
+  }
+
+  constexpr const T& operator*() const { return *static_cast<T*>(item_); }
+  constexpr T& operator*() { return *static_cast<T*>(item_); }
+
+  constexpr const T* operator->() const { return static_cast<T*>(item_); }
+  constexpr T* operator->() { return static_cast<T*>(item_); }
+
+  constexpr bool operator==(const Iterator& rhs) const {
+    return item_ == rhs.item_;
+  }
+  constexpr bool operator!=(const Iterator& rhs) const {
+    return item_ != rhs.item_;
+  }
+
+ private:
+  template <typename, bool>
+  friend class ::pw::IntrusiveDList;
+
+  // Only allow IntrusiveDList to create iterators that point to something.
+  constexpr explicit Iterator(I* item) : item_{item} {}
+
+  I* item_;
+};
+
+class List {
+ public:
+  class Item {
+   protected:
+    constexpr Item() : Item(this) {}
+
+    bool unlisted() const { return this == next_; }
+
+    // Unlinks this from the list it is a part of, if any. O(1).
+    void unlist();
+
+    ~Item() { unlist(); }
+
+   private:
+    friend class List;
+
+    template <typename T, typename I>
+    friend class Iterator;
+
+    constexpr Item(Item* self) : next_(self), prev_(self) {}
+
+    // Unlisted items must be self-cycles (next_ == prev_ == this).
+    Item* next_;
+    Item* prev_;
+  };
+
+  constexpr List() : head_() {}
+
+  // Intrusive lists cannot be copied, since each Item can only be in one list.
+  List(const List&) = delete;
+  List& operator=(const List&) = delete;
+
+  bool empty() const noexcept { return begin() == end(); }
+
+  static void insert_before(Item* pos, Item& item);
+
+  static void erase(Item& item) { item.unlist(); }
+
+  void clear();
+
+  constexpr Item* begin() noexcept { return head_.next_; }
+  constexpr const Item* begin() const noexcept { return head_.next_; }
+
+  constexpr Item* before_end() noexcept { return head_.prev_; }
+  constexpr const Item* before_end() const noexcept { return head_.prev_; }
+
+  constexpr Item* end() noexcept { return &head_; }
+  constexpr const Item* end() const noexcept { return &head_; }
+
+  // O(n), since it counts the items.
+  size_t CountItems() const;
+
+ private:
+  // The head is an Item whose next_ is the first item and prev_ is the last,
+  // so inserting or unlinking never needs to special case the ends. &head_ is
+  // end(), which is unique to each List.
+  Item head_;
+};
+
+}  // namespace intrusive_dlist_impl
+}  // namespace pw
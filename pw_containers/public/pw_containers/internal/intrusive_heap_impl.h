@@ -0,0 +1,85 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+namespace pw::intrusive_heap_impl {
+
+// A pairing heap. Each item points to its first child and to its next sibling.
+// Each item also points back to its previous sibling, or to its parent if it is
+// the first child, which allows removing any item without a search.
+//
+// The algorithms are not templated, so they are shared by every IntrusiveHeap.
+// Items are compared with a function pointer.
+class Heap {
+ public:
+  class Item {
+   protected:
+    constexpr Item() : child_(nullptr), next_(nullptr), prev_(nullptr) {}
+
+    bool in_heap() const { return prev_ != nullptr; }
+
+    ~Item();
+
+   private:
+    friend class Heap;
+
+    void Reset() {
+      child_ = nullptr;
+      next_ = nullptr;
+      prev_ = nullptr;
+    }
+
+    Item* child_;
+    Item* next_;
+    Item* prev_;  // nullptr if not in a heap.
+  };
+
+  // Returns true if lhs should be closer to the top of the heap than rhs.
+  using LessFunction = bool (*)(const Item& lhs, const Item& rhs);
+
+  constexpr explicit Heap(LessFunction less) : head_(), less_(less) {}
+
+  Heap(const Heap&) = delete;
+  Heap& operator=(const Heap&) = delete;
+
+  bool empty() const { return top() == nullptr; }
+
+  Item* top() { return head_.child_; }
+  const Item* top() const { return head_.child_; }
+
+  void push(Item& item);
+
+  void pop();
+
+  bool remove(Item& item);
+
+  void clear();
+
+ private:
+  // Combines two heaps and returns the root of the result.
+  Item* Meld(Item* first, Item* second);
+
+  // Melds a list of sibling heaps into one with the standard two-pass pairing,
+  // which keeps pop and remove O(log n) amortized.
+  Item* MergePairs(Item* first);
+
+  void SetTop(Item* item);
+
+  // The root of the heap is head_'s child, so every item in the heap has a
+  // prev_ and removing the root needs no special case.
+  Item head_;
+  LessFunction less_;
+};
+
+}  // namespace pw::intrusive_heap_impl
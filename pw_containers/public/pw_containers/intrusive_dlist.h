@@ -0,0 +1,206 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+
+#include "pw_assert/assert.h"
+#include "pw_containers/internal/intrusive_dlist_impl.h"
+
+namespace pw {
+
+// IntrusiveDList is a doubly-linked version of IntrusiveList. Each item stores
+// a pointer to the previous item as well as the next, so push_back, pop_back,
+// erase, and remove are O(1) rather than O(n). Use it for lists that items are
+// frequently added to at the end or removed from the middle of.
+//
+// Items inherit from IntrusiveDList<T>::Item and follow the same rules as
+// IntrusiveList items: an item must outlive the list it is in, and can only be
+// in one list at a time.
+//
+// If kCacheSize is true, the list counts its items so that size() is O(1).
+// Items in such a list must be removed from the list before they are
+// destroyed, since the list cannot tell when an item unlinks itself.
+//
+// Usage:
+//
+//   class Call : public IntrusiveDList<Call>::Item {};
+//
+//   IntrusiveDList<Call> calls;
+//
+//   Call call;
+//   calls.push_back(call);
+//   ...
+//   calls.remove(call);  // O(1)
+//
+template <typename T, bool kCacheSize = false>
+class IntrusiveDList {
+ public:
+  class Item : public intrusive_dlist_impl::List::Item {
+   protected:
+    constexpr Item() = default;
+
+    ~Item() {
+      if constexpr (kCacheSize) {
+        PW_DASSERT(this->unlisted());
+      }
+    }
+
+   private:
+    friend class IntrusiveDList;
+  };
+
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using pointer = T*;
+  using reference = T&;
+  using iterator = intrusive_dlist_impl::Iterator<T, Item>;
+  using const_iterator =
+      intrusive_dlist_impl::Iterator<std::add_const_t<T>, const Item>;
+
+  constexpr IntrusiveDList() : size_(0) { CheckItemType(); }
+
+  // Constructs an IntrusiveDList from an iterator over Items. The iterator may
+  // dereference as either Item& (e.g. from std::array<Item>) or Item* (e.g.
+  // from std::initializer_list<Item*>).
+  template <typename Iterator>
+  IntrusiveDList(Iterator first, Iterator last) : IntrusiveDList() {
+    assign(first, last);
+  }
+
+  // Constructs an IntrusiveDList from a std::initializer_list of pointers to
+  // items.
+  IntrusiveDList(std::initializer_list<Item*> items)
+      : IntrusiveDList(items.begin(), items.end()) {}
+
+  template <typename Iterator>
+  void assign(Iterator first, Iterator last) {
+    clear();
+    for (Iterator it = first; it != last; ++it) {
+      if constexpr (std::is_pointer<std::remove_reference_t<decltype(*it)>>()) {
+        Insert(list_.end(), **it);
+      } else {
+        Insert(list_.end(), *it);
+      }
+    }
+  }
+
+  void assign(std::initializer_list<Item*> items) {
+    assign(items.begin(), items.end());
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return list_.empty(); }
+
+  void push_front(T& item) { Insert(list_.begin(), item); }
+
+  void push_back(T& item) { Insert(list_.end(), item); }
+
+  // Inserts item before pos and returns an iterator to it.
+  iterator insert(iterator pos, T& item) {
+    Insert(pos.item_, item);
+    return iterator(&item);
+  }
+
+  // Removes the first item in the list. The list must not be empty.
+  void pop_front() { Erase(*list_.begin()); }
+
+  // Removes the last item in the list. The list must not be empty.
+  void pop_back() { Erase(*list_.before_end()); }
+
+  // Removes the item at pos from the list and returns an iterator to the item
+  // after it. The item is not destructed.
+  iterator erase(iterator pos) {
+    iterator next = std::next(pos);
+    Erase(*pos.item_);
+    return next;
+  }
+
+  // Removes all items from the list. The items themselves are not destructed.
+  void clear() {
+    list_.clear();
+    size_ = 0;
+  }
+
+  // Removes this specific item from the list in O(1). The item must be in this
+  // list or in no list. Returns true if the item was removed; false if it was
+  // not in a list.
+  bool remove(T& item) {
+    Item& list_item = item;
+    if (list_item.unlisted()) {
+      return false;
+    }
+    Erase(list_item);
+    return true;
+  }
+
+  // Reference to the first element in the list. Undefined behavior if empty().
+  T& front() { return *static_cast<T*>(list_.begin()); }
+
+  // Reference to the last element in the list. Undefined behavior if empty().
+  T& back() { return *static_cast<T*>(list_.before_end()); }
+
+  iterator begin() noexcept {
+    return iterator(static_cast<Item*>(list_.begin()));
+  }
+  const_iterator begin() const noexcept {
+    return const_iterator(static_cast<const Item*>(list_.begin()));
+  }
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  iterator end() noexcept { return iterator(static_cast<Item*>(list_.end())); }
+  const_iterator end() const noexcept {
+    return const_iterator(static_cast<const Item*>(list_.end()));
+  }
+  const_iterator cend() const noexcept { return end(); }
+
+  // O(1) if kCacheSize is true; otherwise O(size).
+  size_t size() const {
+    if constexpr (kCacheSize) {
+      return size_;
+    } else {
+      return list_.CountItems();
+    }
+  }
+
+ private:
+  // Check that T is an Item in a function, since the class T will not be fully
+  // defined when the IntrusiveDList<T> class is instantiated.
+  static constexpr void CheckItemType() {
+    static_assert(
+        std::is_base_of<Item, T>(),
+        "IntrusiveDList items must be derived from IntrusiveDList<T>::Item");
+  }
+
+  void Insert(intrusive_dlist_impl::List::Item* pos,
+              intrusive_dlist_impl::List::Item& item) {
+    list_.insert_before(pos, item);
+    if constexpr (kCacheSize) {
+      size_ += 1;
+    }
+  }
+
+  void Erase(intrusive_dlist_impl::List::Item& item) {
+    list_.erase(item);
+    if constexpr (kCacheSize) {
+      size_ -= 1;
+    }
+  }
+
+  intrusive_dlist_impl::List list_;
+  size_t size_;  // Only used if kCacheSize is true.
+};
+
+}  // namespace pw
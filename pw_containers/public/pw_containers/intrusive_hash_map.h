@@ -0,0 +1,227 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <type_traits>
+
+#include "pw_containers/intrusive_list.h"
+
+namespace pw {
+
+// IntrusiveHashMap is a hash map of items that embed their own hook, like
+// IntrusiveList. Items inherit from IntrusiveHashMap<Key, T>::Item, which holds
+// the item's key and a next pointer. The map is an array of buckets, each an
+// IntrusiveList of the items whose keys hash to it, so it needs no dynamic
+// allocation. With enough buckets, find, insert, and remove are O(1).
+//
+// IntrusiveHashMap<Key, T> can be used without knowing the bucket count.
+// Declare maps as IntrusiveHashMapBuffer<Key, T, kBucketCount>.
+//
+// The same rules as IntrusiveList apply: an item must outlive the map it is in,
+// and can only be in one map or list at a time. Keys must not change while an
+// item is in a map.
+//
+//   class Service : public IntrusiveHashMap<uint32_t, Service>::Item {
+//    public:
+//     constexpr Service(uint32_t id) : Item(id) {}
+//   };
+//
+//   IntrusiveHashMapBuffer<uint32_t, Service, 8> services;
+//
+//   Service echo(0x1234);
+//   services.insert(echo);
+//   Service* service = services.find(0x1234);
+//
+template <typename Key, typename T, typename Hash = std::hash<Key>>
+class IntrusiveHashMap {
+ public:
+  class Item : public IntrusiveList<Item>::Item {
+   public:
+    constexpr const Key& key() const { return key_; }
+
+   protected:
+    constexpr Item(const Key& key) : key_(key) {}
+
+   private:
+    const Key key_;
+  };
+
+  using key_type = Key;
+  using mapped_type = T;
+  using Bucket = IntrusiveList<Item>;
+
+  // Iterates over all items in the map, in no particular order.
+  class iterator {
+   public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = T;
+    using pointer = T*;
+    using reference = T&;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator& operator++() {
+      ++item_;
+      SkipEmptyBuckets();
+      return *this;
+    }
+
+    iterator operator++(int) {
+      iterator previous_value = *this;
+      operator++();
+      return previous_value;
+    }
+
+    T& operator*() const {
+      // IntrusiveList's const iterators only return const items.
+      typename Bucket::iterator item = item_;
+      return static_cast<T&>(*item);
+    }
+    T* operator->() const { return &operator*(); }
+
+    bool operator==(const iterator& rhs) const {
+      return bucket_ == rhs.bucket_ && item_ == rhs.item_;
+    }
+    bool operator!=(const iterator& rhs) const { return !(*this == rhs); }
+
+   private:
+    friend class IntrusiveHashMap;
+
+    iterator(std::span<Bucket> buckets, size_t bucket)
+        : buckets_(buckets), bucket_(bucket), item_(buckets[bucket].begin()) {
+      SkipEmptyBuckets();
+    }
+
+    void SkipEmptyBuckets() {
+      while (item_ == buckets_[bucket_].end() &&
+             bucket_ + 1 < buckets_.size()) {
+        bucket_ += 1;
+        item_ = buckets_[bucket_].begin();
+      }
+    }
+
+    std::span<Bucket> buckets_;
+    size_t bucket_;
+    typename Bucket::iterator item_;
+  };
+
+  // Maps cannot be copied, since each Item can only be in one map.
+  IntrusiveHashMap(const IntrusiveHashMap&) = delete;
+  IntrusiveHashMap& operator=(const IntrusiveHashMap&) = delete;
+
+  // Adds an item to the map. Returns false and does not add the item if an item
+  // with the same key is already in the map.
+  bool insert(T& item) {
+    CheckItemType();
+    Bucket& bucket = BucketFor(item.key());
+    if (Find(bucket, item.key()) != nullptr) {
+      return false;
+    }
+    bucket.push_front(item);
+    return true;
+  }
+
+  // Returns the item with this key, or nullptr if there is none.
+  T* find(const Key& key) { return Find(BucketFor(key), key); }
+
+  bool contains(const Key& key) { return find(key) != nullptr; }
+
+  // Removes this specific item from the map, if it is present. Returns true if
+  // the item was removed.
+  bool remove(T& item) { return BucketFor(item.key()).remove(item); }
+
+  // Removes all items from the map. The items are not destructed.
+  void clear() {
+    for (Bucket& bucket : buckets_) {
+      bucket.clear();
+    }
+  }
+
+  [[nodiscard]] bool empty() const {
+    for (const Bucket& bucket : buckets_) {
+      if (!bucket.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // O(bucket_count() + size()).
+  size_t size() const {
+    size_t total = 0;
+    for (const Bucket& bucket : buckets_) {
+      total += bucket.size();
+    }
+    return total;
+  }
+
+  size_t bucket_count() const { return buckets_.size(); }
+
+  iterator begin() { return iterator(buckets_, 0); }
+  iterator end() {
+    iterator end_it(buckets_, buckets_.size() - 1);
+    end_it.item_ = buckets_.back().end();
+    return end_it;
+  }
+
+ protected:
+  constexpr IntrusiveHashMap(std::span<Bucket> buckets) : buckets_(buckets) {}
+
+ private:
+  // Check that T is an Item in a function, since the class T will not be fully
+  // defined when the IntrusiveHashMap<T> class is instantiated.
+  static constexpr void CheckItemType() {
+    static_assert(
+        std::is_base_of<Item, T>(),
+        "IntrusiveHashMap items must be derived from IntrusiveHashMap::Item");
+  }
+
+  Bucket& BucketFor(const Key& key) {
+    return buckets_[Hash()(key) % buckets_.size()];
+  }
+
+  static T* Find(Bucket& bucket, const Key& key) {
+    for (Item& item : bucket) {
+      if (item.key() == key) {
+        return static_cast<T*>(&item);
+      }
+    }
+    return nullptr;
+  }
+
+  std::span<Bucket> buckets_;
+};
+
+// An IntrusiveHashMap with a fixed number of buckets. More buckets make for
+// shorter chains; each bucket costs one pointer.
+template <typename Key,
+          typename T,
+          size_t kBucketCount,
+          typename Hash = std::hash<Key>>
+class IntrusiveHashMapBuffer : public IntrusiveHashMap<Key, T, Hash> {
+ public:
+  static_assert(kBucketCount > 0u, "IntrusiveHashMaps need at least 1 bucket");
+
+  IntrusiveHashMapBuffer() : IntrusiveHashMap<Key, T, Hash>(buckets_) {}
+
+ private:
+  std::array<typename IntrusiveHashMap<Key, T, Hash>::Bucket, kBucketCount>
+      buckets_;
+};
+
+}  // namespace pw
@@ -0,0 +1,107 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+#include "pw_containers/internal/intrusive_heap_impl.h"
+
+namespace pw {
+
+// IntrusiveHeap is a priority queue of items that embed their own hook, like
+// IntrusiveList. The top() item is the smallest according to Compare, which
+// defaults to std::less<T>.
+//
+// The heap is a pairing heap: push is O(1), and pop and remove are O(log n)
+// amortized. remove takes out any item, not just the top, so it suits
+// deadlines and timers that are often cancelled before they expire. To change
+// an item's priority, remove it, update it, and push it again.
+//
+// Items inherit from IntrusiveHeap<T>::Item, which is three pointers. An item
+// must be removed from its heap before it is destroyed, and can only be in one
+// heap at a time.
+//
+//   struct Timer : public IntrusiveHeap<Timer>::Item {
+//     bool operator<(const Timer& other) const {
+//       return deadline < other.deadline;
+//     }
+//
+//     chrono::SystemClock::time_point deadline;
+//   };
+//
+//   IntrusiveHeap<Timer> timers;
+//
+//   while (!timers.empty() && timers.top().deadline <= now) {
+//     Timer& timer = timers.top();
+//     timers.pop();
+//     Fire(timer);
+//   }
+//
+template <typename T, typename Compare = std::less<T>>
+class IntrusiveHeap {
+ public:
+  class Item : public intrusive_heap_impl::Heap::Item {
+   protected:
+    constexpr Item() = default;
+  };
+
+  using value_type = T;
+  using reference = T&;
+  using const_reference = const T&;
+  using value_compare = Compare;
+
+  constexpr IntrusiveHeap() : heap_(&Less) {}
+
+  [[nodiscard]] bool empty() const { return heap_.empty(); }
+
+  // The smallest item. Undefined behavior if empty().
+  T& top() { return *static_cast<T*>(heap_.top()); }
+  const T& top() const { return *static_cast<const T*>(heap_.top()); }
+
+  // Adds an item to the heap. O(1).
+  void push(T& item) {
+    CheckItemType();
+    heap_.push(item);
+  }
+
+  // Removes the top item. The heap must not be empty. O(log n) amortized.
+  void pop() { heap_.pop(); }
+
+  // Removes this specific item from the heap, if it is present. Returns true
+  // if the item was removed. O(log n) amortized.
+  bool remove(T& item) { return heap_.remove(item); }
+
+  // Removes all items from the heap. The items themselves are not destructed.
+  // O(n).
+  void clear() { heap_.clear(); }
+
+ private:
+  // Check that T is an Item in a function, since the class T will not be fully
+  // defined when the IntrusiveHeap<T> class is instantiated.
+  static constexpr void CheckItemType() {
+    static_assert(
+        std::is_base_of<Item, T>(),
+        "IntrusiveHeap items must be derived from IntrusiveHeap<T>::Item");
+  }
+
+  static bool Less(const intrusive_heap_impl::Heap::Item& lhs,
+                   const intrusive_heap_impl::Heap::Item& rhs) {
+    return Compare()(static_cast<const T&>(lhs), static_cast<const T&>(rhs));
+  }
+
+  intrusive_heap_impl::Heap heap_;
+};
+
+}  // namespace pw
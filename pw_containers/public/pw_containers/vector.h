@@ -16,9 +16,11 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstring>
 #include <initializer_list>
 #include <iterator>
 #include <limits>
+#include <memory>
 #include <new>
 #include <type_traits>
 #include <utility>
@@ -36,6 +38,13 @@ using IsIterator = std::negation<
 // Used as max_size in the generic-size Vector<T> interface.
 PW_INLINE_VARIABLE constexpr size_t kGeneric = size_t(-1);
 
+// True if elements can be copied from an Iterator into a Vector<T> with
+// memcpy or memmove rather than one at a time.
+template <typename T, typename Iterator>
+PW_INLINE_VARIABLE constexpr bool kCanCopyBytes =
+    std::is_trivially_copyable_v<T> && std::is_pointer_v<Iterator> &&
+    std::is_same_v<std::remove_cv_t<std::remove_pointer_t<Iterator>>, T>;
+
 // The DestructorHelper is used to make Vector<T> trivially destructible if T
 // is. This could be replaced with a C++20 constraint.
 template <typename VectorClass, bool kIsTriviallyDestructible>
@@ -314,15 +323,23 @@ class Vector<T, vector_impl::kGeneric>
 
   void clear() noexcept;
 
-  // TODO(hepler): insert, emplace, and erase are not yet implemented.
-  //    Currently, items can only be added to or removed from the end.
+  // Inserting or erasing elements before the end shifts the following
+  // elements. For trivially copyable types, elements are shifted and copied
+  // with memmove and memcpy rather than one at a time. Inserting more elements
+  // than fit is a fatal error.
   iterator insert(const_iterator index, const T& value);
 
   iterator insert(const_iterator index, T&& value);
 
   iterator insert(const_iterator index, size_type count, const T& value);
 
-  template <typename Iterator>
+  // Inserts the range [first, last), shifting the following elements only
+  // once. Use insert(end(), first, last) to append a range. The range must not
+  // be part of this vector.
+  template <
+      typename Iterator,
+      typename...,
+      typename = std::enable_if_t<vector_impl::IsIterator<Iterator>::value>>
   iterator insert(const_iterator index, Iterator first, Iterator last);
 
   iterator insert(const_iterator index, std::initializer_list<T> list);
@@ -388,6 +405,10 @@ class Vector<T, vector_impl::kGeneric>
 
   void Append(size_type count, const T& value);
 
+  // Moves the elements from index to the end up by count, leaving count
+  // uninitialized elements at index. Does not update the size.
+  iterator ShiftUp(const_iterator index, size_type count);
+
   const size_type max_size_;
   size_type size_ = 0;
 };
@@ -433,12 +454,105 @@ bool operator>=(const Vector<T, kLhsSize>& lhs,
 
 template <typename T>
 void Vector<T, vector_impl::kGeneric>::clear() noexcept {
-  for (auto& item : *this) {
-    item.~T();
-  }
+  std::destroy(begin(), end());
   size_ = 0;
 }
 
+template <typename T>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::insert(
+    const_iterator index, const T& value) {
+  return emplace(index, value);
+}
+
+template <typename T>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::insert(
+    const_iterator index, T&& value) {
+  return emplace(index, std::move(value));
+}
+
+template <typename T>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::insert(
+    const_iterator index, size_type count, const T& value) {
+  PW_ASSERT(size() + count <= max_size());
+
+  // The value may be an element of this vector, so copy it before shifting.
+  const T copy(value);
+  const iterator position = ShiftUp(index, count);
+  std::uninitialized_fill_n(position, count, copy);
+  size_ += count;
+  return position;
+}
+
+template <typename T>
+template <typename Iterator, typename..., typename>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::insert(
+    const_iterator index, Iterator first, Iterator last) {
+  const auto count = static_cast<size_type>(std::distance(first, last));
+  PW_ASSERT(size() + count <= max_size());
+
+  const iterator position = ShiftUp(index, count);
+  if constexpr (vector_impl::kCanCopyBytes<T, Iterator>) {
+    std::memcpy(position, first, count * sizeof(T));
+  } else {
+    std::uninitialized_copy(first, last, position);
+  }
+  size_ += count;
+  return position;
+}
+
+template <typename T>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::insert(
+    const_iterator index, std::initializer_list<T> list) {
+  return insert(index, list.begin(), list.end());
+}
+
+template <typename T>
+template <typename... Args>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::emplace(
+    const_iterator index, Args&&... args) {
+  PW_ASSERT(!full());
+
+  if (index == cend()) {
+    emplace_back(std::forward<Args>(args)...);
+    return &back();
+  }
+
+  // The arguments may refer to elements of this vector, so construct the new
+  // element before shifting.
+  T value(std::forward<Args>(args)...);
+  const iterator position = ShiftUp(index, 1);
+  new (position) T(std::move(value));
+  size_ += 1;
+  return position;
+}
+
+template <typename T>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::erase(
+    const_iterator index) {
+  return erase(index, index + 1);
+}
+
+template <typename T>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::erase(
+    const_iterator first, const_iterator last) {
+  const iterator position = begin() + (first - cbegin());
+  const auto count = static_cast<size_type>(last - first);
+
+  std::destroy(position, position + count);
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    std::memmove(static_cast<void*>(position),
+                 position + count,
+                 (end() - position - count) * sizeof(T));
+  } else {
+    for (iterator source = position + count; source != end(); ++source) {
+      new (source - count) T(std::move(*source));
+      source->~T();
+    }
+  }
+  size_ -= count;
+  return position;
+}
+
 template <typename T>
 template <typename... Args>
 void Vector<T, vector_impl::kGeneric>::emplace_back(Args&&... args) {
@@ -471,15 +585,29 @@ void Vector<T, vector_impl::kGeneric>::resize(size_type new_size,
 template <typename T>
 template <typename Iterator>
 void Vector<T, vector_impl::kGeneric>::CopyFrom(Iterator first, Iterator last) {
-  while (first != last) {
-    push_back(*first++);
+  if constexpr (vector_impl::kCanCopyBytes<T, Iterator>) {
+    // As with push_back, elements that do not fit are dropped. The range may
+    // be this vector's own elements, so use memmove.
+    const size_t count = std::min(size_t(last - first), max_size() - size());
+    std::memmove(static_cast<void*>(end()), first, count * sizeof(T));
+    size_ += count;
+  } else {
+    while (first != last) {
+      push_back(*first++);
+    }
   }
 }
 
 template <typename T>
 void Vector<T, vector_impl::kGeneric>::MoveFrom(Vector& other) noexcept {
-  for (auto&& item : other) {
-    emplace_back(std::move(item));
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    const size_t count = std::min(other.size(), max_size() - size());
+    std::memcpy(static_cast<void*>(end()), other.data(), count * sizeof(T));
+    size_ += count;
+  } else {
+    for (auto&& item : other) {
+      emplace_back(std::move(item));
+    }
   }
   other.clear();
 }
@@ -491,4 +619,22 @@ void Vector<T, vector_impl::kGeneric>::Append(size_type count, const T& value) {
   }
 }
 
+template <typename T>
+typename Vector<T>::iterator Vector<T, vector_impl::kGeneric>::ShiftUp(
+    const_iterator index, size_type count) {
+  const iterator position = begin() + (index - cbegin());
+  if constexpr (std::is_trivially_copyable_v<T>) {
+    std::memmove(static_cast<void*>(position + count),
+                 position,
+                 (end() - position) * sizeof(T));
+  } else {
+    for (iterator source = end(); source != position;) {
+      --source;
+      new (source + count) T(std::move(*source));
+      source->~T();
+    }
+  }
+  return position;
+}
+
 }  // namespace pw
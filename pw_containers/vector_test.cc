@@ -407,6 +407,146 @@ TEST(Vector, Modify_Resize_Zero) {
   EXPECT_EQ(vector.size(), 0u);
 }
 
+TEST(Vector, Modify_Insert_Middle) {
+  Vector<int, 10> vector{1, 2, 4};
+  auto it = vector.insert(vector.begin() + 2, 3);
+
+  EXPECT_EQ(*it, 3);
+  EXPECT_EQ(vector, (Vector<int, 4>{1, 2, 3, 4}));
+}
+
+TEST(Vector, Modify_Insert_Front) {
+  Vector<int, 10> vector{2, 3};
+  auto it = vector.insert(vector.begin(), 1);
+
+  EXPECT_EQ(it, vector.begin());
+  EXPECT_EQ(vector, (Vector<int, 3>{1, 2, 3}));
+}
+
+TEST(Vector, Modify_Insert_CopiesOfValue) {
+  Vector<int, 10> vector{1, 5};
+  vector.insert(vector.begin() + 1, 3, 7);
+
+  EXPECT_EQ(vector, (Vector<int, 5>{1, 7, 7, 7, 5}));
+}
+
+TEST(Vector, Modify_Insert_CopyOfOwnElement) {
+  Vector<int, 10> vector{1, 2};
+  vector.insert(vector.begin(), 2, vector.back());
+
+  EXPECT_EQ(vector, (Vector<int, 4>{2, 2, 1, 2}));
+}
+
+TEST(Vector, Modify_Insert_Range) {
+  constexpr int kValues[] = {2, 3, 4};
+  Vector<int, 10> vector{1, 5};
+  auto it = vector.insert(
+      vector.begin() + 1, std::begin(kValues), std::end(kValues));
+
+  EXPECT_EQ(it, vector.begin() + 1);
+  EXPECT_EQ(vector, (Vector<int, 5>{1, 2, 3, 4, 5}));
+}
+
+TEST(Vector, Modify_Insert_RangeAtEnd) {
+  Vector<int, 10> vector{1};
+  const Vector<int, 3> other{2, 3, 4};
+  vector.insert(vector.end(), other.begin(), other.end());
+  vector.insert(vector.end(), {5, 6});
+
+  EXPECT_EQ(vector, (Vector<int, 6>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST(Vector, Modify_Insert_NonTrivialType) {
+  Vector<Counter, 10> vector({Counter(1), Counter(3)});
+  Counter::Reset();
+
+  const Counter counters[] = {Counter(2), Counter(2)};
+  vector.insert(vector.begin() + 1, std::begin(counters), std::end(counters));
+
+  ASSERT_EQ(vector.size(), 4u);
+  EXPECT_EQ(vector[0].value, 1);
+  EXPECT_EQ(vector[1].value, 2);
+  EXPECT_EQ(vector[2].value, 2);
+  EXPECT_EQ(vector[3].value, 3);
+
+  // The last element was moved once, and its old location destroyed.
+  EXPECT_EQ(Counter::moved, 1);
+  EXPECT_EQ(Counter::created, 4);
+  EXPECT_EQ(Counter::destroyed, 1);
+}
+
+TEST(Vector, Modify_Insert_MoveOnly) {
+  Vector<MoveOnly, 10> vector;
+  vector.emplace_back(1);
+  vector.emplace_back(3);
+  vector.insert(vector.begin() + 1, MoveOnly(2));
+
+  ASSERT_EQ(vector.size(), 3u);
+  EXPECT_EQ(vector[0].value, 1);
+  EXPECT_EQ(vector[1].value, 2);
+  EXPECT_EQ(vector[2].value, 3);
+}
+
+TEST(Vector, Modify_Emplace) {
+  Vector<Counter, 10> vector({Counter(1), Counter(3)});
+  auto it = vector.emplace(vector.begin() + 1, 2);
+  EXPECT_EQ(it->value, 2);
+
+  it = vector.emplace(vector.end(), 4);
+  EXPECT_EQ(it->value, 4);
+
+  ASSERT_EQ(vector.size(), 4u);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(vector[i].value, i + 1);
+  }
+}
+
+TEST(Vector, Modify_Erase) {
+  Vector<int, 10> vector{1, 2, 3, 4};
+  auto it = vector.erase(vector.begin() + 1);
+
+  EXPECT_EQ(*it, 3);
+  EXPECT_EQ(vector, (Vector<int, 3>{1, 3, 4}));
+
+  it = vector.erase(vector.end() - 1);
+  EXPECT_EQ(it, vector.end());
+  EXPECT_EQ(vector, (Vector<int, 2>{1, 3}));
+}
+
+TEST(Vector, Modify_Erase_Range) {
+  Vector<int, 10> vector{1, 2, 3, 4, 5};
+  auto it = vector.erase(vector.begin() + 1, vector.begin() + 4);
+
+  EXPECT_EQ(*it, 5);
+  EXPECT_EQ(vector, (Vector<int, 2>{1, 5}));
+
+  vector.erase(vector.begin(), vector.begin());
+  EXPECT_EQ(vector.size(), 2u);
+}
+
+TEST(Vector, Modify_Erase_NonTrivialType) {
+  Vector<Counter, 10> vector({Counter(1), Counter(2), Counter(3), Counter(4)});
+  Counter::Reset();
+
+  vector.erase(vector.begin(), vector.begin() + 2);
+
+  ASSERT_EQ(vector.size(), 2u);
+  EXPECT_EQ(vector[0].value, 3);
+  EXPECT_EQ(vector[1].value, 4);
+
+  // Two elements were erased, and two moved down and destroyed.
+  EXPECT_EQ(Counter::created, 0);
+  EXPECT_EQ(Counter::moved, 2);
+  EXPECT_EQ(Counter::destroyed, 4);
+}
+
+TEST(Vector, Assign_Copy_TooLarge) {
+  const Vector<int, 5> source{1, 2, 3, 4, 5};
+  Vector<int, 3> vector(source.begin(), source.end());
+
+  EXPECT_EQ(vector, (Vector<int, 3>{1, 2, 3}));
+}
+
 TEST(Vector, Generic) {
   Vector<int, 10> vector{1, 2, 3, 4, 5};
 
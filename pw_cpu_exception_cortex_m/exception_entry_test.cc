@@ -21,6 +21,7 @@
 #include "pw_cpu_exception/handler.h"
 #include "pw_cpu_exception/support.h"
 #include "pw_cpu_exception_cortex_m/cpu_state.h"
+#include "pw_cpu_exception_cortex_m/fast_entry.h"
 
 namespace pw::cpu_exception {
 namespace {
@@ -182,6 +183,29 @@ InterruptVectorTable ram_vector_table;
 // Forward declaration of the exception handler.
 void TestingExceptionHandler(pw_cpu_exception_State*);
 
+// Counter that is incremented if the fast handler handles an exception.
+size_t fast_exceptions_handled = 0;
+
+// Whether the fast handler handles exceptions or escalates them.
+bool fast_handler_handles = false;
+
+// The frame and CFSR passed to the fast handler.
+CortexMExceptionRegisters fast_captured_frame = {};
+uint32_t fast_captured_cfsr = 0;
+
+bool TestingFastHandler(MinimalCpuState& state) {
+  fast_captured_frame = *state.frame;
+  fast_captured_cfsr = state.cfsr;
+  if (!fast_handler_handles) {
+    return false;
+  }
+
+  // Disable divide-by-zero trapping to "handle" exception.
+  cortex_m_ccr &= ~kDivByZeroTrapEnableMask;
+  fast_exceptions_handled++;
+  return true;
+}
+
 // Populate the device's registers with testable values, then trigger exception.
 void BeginBaseFaultTest() {
   // Make sure divide by zero causes a fault.
@@ -328,22 +352,18 @@ void BeginExtendedFaultUnalignedStackTest() {
   EXPECT_EQ(static_cast<uint32_t>(captured_state.extended.psp), local_psp);
 }
 
-void InstallVectorTableEntries() {
+void InstallVectorTableEntries(void (*entry)(void) = pw_cpu_exception_Entry) {
   uint32_t prev_state = BeginCriticalSection();
-  // If vector table is installed already, this is done.
-  if (cortex_m_vtor == reinterpret_cast<uint32_t>(&ram_vector_table)) {
-    EndCriticalSection(prev_state);
-    return;
-  }
   // Copy table to new location since it's not guaranteed that we can write to
-  // the original one.
-  std::memcpy(&ram_vector_table,
-              reinterpret_cast<uint32_t*>(cortex_m_vtor),
-              sizeof(ram_vector_table));
+  // the original one. This is only needed the first time.
+  if (cortex_m_vtor != reinterpret_cast<uint32_t>(&ram_vector_table)) {
+    std::memcpy(&ram_vector_table,
+                reinterpret_cast<uint32_t*>(cortex_m_vtor),
+                sizeof(ram_vector_table));
+  }
 
   // Override exception handling vector table entries.
-  uint32_t* exception_entry_addr =
-      reinterpret_cast<uint32_t*>(pw_cpu_exception_Entry);
+  uint32_t* exception_entry_addr = reinterpret_cast<uint32_t*>(entry);
   uint32_t** interrupts = reinterpret_cast<uint32_t**>(&ram_vector_table);
   interrupts[kHardFaultIsrNum] = exception_entry_addr;
   interrupts[kMemFaultIsrNum] = exception_entry_addr;
@@ -374,6 +394,10 @@ void Setup(bool use_fpu) {
   captured_state = {};
   float_test_value = 0.0f;
   trigger_nested_fault = false;
+  fast_exceptions_handled = 0;
+  fast_handler_handles = false;
+  fast_captured_frame = {};
+  fast_captured_cfsr = 0;
 }
 
 TEST(FaultEntry, BasicFault) {
@@ -392,6 +416,44 @@ TEST(FaultEntry, BasicFault) {
             static_cast<uint32_t>(captured_state.base.lr));
 }
 
+TEST(FastEntry, HandledFault) {
+  Setup(/*use_fpu=*/false);
+  SetFastHandler(TestingFastHandler);
+  fast_handler_handles = true;
+  InstallVectorTableEntries(pw_cpu_exception_FastEntry);
+  BeginBaseFaultTest();
+
+  // The fault was handled without capturing the full state.
+  ASSERT_EQ(fast_exceptions_handled, 1u);
+  EXPECT_EQ(exceptions_handled, 0u);
+  EXPECT_EQ(static_cast<uint32_t>(fast_captured_frame.r0), kMagicPattern);
+  int32_t captured_pc_distance =
+      fast_captured_frame.pc - fast_captured_frame.r2;
+  EXPECT_LT(captured_pc_distance, kMaxPcDistance);
+  EXPECT_NE(fast_captured_cfsr & kDivByZeroFaultMask, 0u);
+  EXPECT_EQ(cortex_m_cfsr & kDivByZeroFaultMask, 0u);
+}
+
+TEST(FastEntry, EscalatedFault) {
+  Setup(/*use_fpu=*/false);
+  SetFastHandler(TestingFastHandler);
+  InstallVectorTableEntries(pw_cpu_exception_FastEntry);
+  BeginBaseFaultTest();
+
+  // The fast handler declined the fault, so the full state was captured as if
+  // pw_cpu_exception_Entry() had been called directly.
+  EXPECT_EQ(fast_exceptions_handled, 0u);
+  EXPECT_EQ(static_cast<uint32_t>(fast_captured_frame.r0), kMagicPattern);
+  ASSERT_EQ(exceptions_handled, 1u);
+  EXPECT_EQ(static_cast<uint32_t>(captured_state.base.r0), kMagicPattern);
+  EXPECT_EQ(static_cast<uint32_t>(captured_state.base.r1), 0u);
+  int32_t captured_pc_distance =
+      captured_state.base.pc - captured_state.base.r2;
+  EXPECT_LT(captured_pc_distance, kMaxPcDistance);
+  EXPECT_EQ(static_cast<uint32_t>(captured_state.base.r3),
+            static_cast<uint32_t>(captured_state.base.lr));
+}
+
 TEST(FaultEntry, BasicUnalignedStackFault) {
   Setup(/*use_fpu=*/false);
   BeginBaseFaultUnalignedStackTest();
@@ -0,0 +1,145 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_cpu_exception_cortex_m/fast_entry.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "pw_cpu_exception/entry.h"
+#include "pw_cpu_exception_cortex_m_private/cortex_m_constants.h"
+#include "pw_preprocessor/compiler.h"
+
+namespace pw::cpu_exception {
+namespace {
+
+bool (*fast_handler)(MinimalCpuState&) = nullptr;
+
+}  // namespace
+
+bool MinimalCpuState::psp_was_active() const {
+  return exc_return & kExcReturnStackMask;
+}
+
+bool MinimalCpuState::fpu_frame_pushed() const {
+  return !(exc_return & kExcReturnBasicFrameMask);
+}
+
+bool CaptureFpuState(const MinimalCpuState& state,
+                     CortexMExceptionRegistersFpu& fpu) {
+#if defined(PW_ARMV7M_ENABLE_FPU) && PW_ARMV7M_ENABLE_FPU == 1
+  if (!state.fpu_frame_pushed()) {
+    return false;
+  }
+
+  // If lazy state preservation is pending, any FPU instruction makes the CPU
+  // write the registers to the space it reserved in the frame.
+  uint32_t fpscr;
+  asm volatile("vmrs %0, fpscr" : "=r"(fpscr) : : "memory");
+  static_cast<void>(fpscr);
+
+  std::memcpy(&fpu,
+              reinterpret_cast<const std::byte*>(state.frame) +
+                  sizeof(CortexMExceptionRegisters),
+              sizeof(fpu));
+  return true;
+#else
+  static_cast<void>(state);
+  static_cast<void>(fpu);
+  return false;
+#endif  // defined(PW_ARMV7M_ENABLE_FPU) && PW_ARMV7M_ENABLE_FPU == 1
+}
+
+void SetFastHandler(bool (*handler)(MinimalCpuState& state)) {
+  fast_handler = handler;
+}
+
+extern "C" {
+
+// Reads the fault status registers and calls the fast handler. Returns true if
+// the fault was handled.
+PW_USED bool pw_cpu_exception_HandleFastException(
+    CortexMExceptionRegisters* frame, uint32_t exc_return) {
+  if (fast_handler == nullptr) {
+    return false;
+  }
+
+  const uint32_t cfsr = cortex_m_cfsr;
+  MinimalCpuState state = {
+      .frame = frame,
+      .exc_return = exc_return,
+      .cfsr = cfsr,
+      .mmfar = cortex_m_mmfar,
+      .bfar = cortex_m_bfar,
+      .hfsr = cortex_m_hfsr,
+  };
+  if (!fast_handler(state)) {
+    return false;
+  }
+
+  // The status bits are write-one-to-clear.
+  cortex_m_cfsr = cfsr;
+  return true;
+}
+
+// Calls the fast handler with the CPU-pushed frame, then either returns from
+// the exception or escalates to the full capture in pw_cpu_exception_Entry().
+void pw_cpu_exception_FastEntry(void) {
+  asm volatile(
+      // clang-format off
+      // If the CPU failed to push a frame, there is nothing for the fast
+      // handler to look at, so go straight to the full capture. r0 and r1 are
+      // restored first, since pw_cpu_exception_Entry() captures them.
+      " push {r0, r1}                                         \n"
+      " ldr r0, =%c[cfsr_addr]                                \n"
+      " ldr r0, [r0]                                          \n"
+      " ldr r1, =%c[stacking_error_mask]                      \n"
+      " tst r0, r1                                            \n"
+      " pop {r0, r1}                                          \n"
+      " it ne                                                 \n"
+      " bne pw_cpu_exception_Entry                            \n"
+
+      // Pass the frame, which is on the stack that was active at the time of
+      // the fault, and exc_return to the handler. r4 is pushed along with lr
+      // to keep the main stack 8-byte aligned.
+      " tst lr, #(1 << 2)                                     \n"
+      " ite eq                                                \n"
+      " mrseq r0, msp                                         \n"
+      " mrsne r0, psp                                         \n"
+      " mov r1, lr                                            \n"
+      " push {r4, lr}                                         \n"
+      " ldr r3, =pw_cpu_exception_HandleFastException         \n"
+      " blx r3                                                \n"
+      " pop {r4, lr}                                          \n"
+
+      // If the fault was handled, return from the exception. The CPU restores
+      // the frame, including any changes the handler made.
+      " cmp r0, #0                                            \n"
+      " it ne                                                 \n"
+      " bxne lr                                               \n"
+
+      // Otherwise capture the full state. r0-r3 and r12 no longer hold their
+      // values from the time of the fault, but the frame does, and that is
+      // where pw_cpu_exception_Entry() takes them from when the frame was
+      // pushed successfully.
+      " b pw_cpu_exception_Entry                              \n"
+      : /*output=*/
+      : /*input=*/[cfsr_addr]"i"(0xE000ED28u),
+                  [stacking_error_mask]"i"(kCfsrStkerrMask | kCfsrMstkerrMask)
+      // clang-format on
+  );
+}
+
+}  // extern "C"
+}  // namespace pw::cpu_exception
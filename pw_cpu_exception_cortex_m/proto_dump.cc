@@ -11,12 +11,57 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <array>
+
 #include "pw_cpu_exception_cortex_m/cpu_state.h"
+#include "pw_cpu_exception_cortex_m/proto_dump.h"
 #include "pw_cpu_exception_cortex_m_protos/cpu_state.pwpb.h"
 #include "pw_preprocessor/compiler.h"
 #include "pw_protobuf/encoder.h"
+#include "pw_protobuf/serialized_size.h"
 
 namespace pw::cpu_exception {
+namespace {
+
+struct Register {
+  cortex_m::ArmV7mCpuState::Fields field;
+  uint32_t value;
+};
+
+// The registers in the order DumpCpuStateProto(protobuf::Encoder&) writes them.
+std::array<Register, 26> Registers(const pw_cpu_exception_State& cpu_state) {
+  using Field = cortex_m::ArmV7mCpuState::Fields;
+  return {{
+      {Field::PC, cpu_state.base.pc},
+      {Field::LR, cpu_state.base.lr},
+      {Field::PSR, cpu_state.base.psr},
+      {Field::MSP, cpu_state.extended.msp},
+      {Field::PSP, cpu_state.extended.psp},
+      {Field::EXC_RETURN, cpu_state.extended.exc_return},
+      {Field::CFSR, cpu_state.extended.cfsr},
+      {Field::MMFAR, cpu_state.extended.mmfar},
+      {Field::BFAR, cpu_state.extended.bfar},
+      {Field::ICSR, cpu_state.extended.icsr},
+      {Field::HFSR, cpu_state.extended.hfsr},
+      {Field::SHCSR, cpu_state.extended.shcsr},
+      {Field::CONTROL, cpu_state.extended.control},
+      {Field::R0, cpu_state.base.r0},
+      {Field::R1, cpu_state.base.r1},
+      {Field::R2, cpu_state.base.r2},
+      {Field::R3, cpu_state.base.r3},
+      {Field::R4, cpu_state.extended.r4},
+      {Field::R5, cpu_state.extended.r5},
+      {Field::R6, cpu_state.extended.r6},
+      {Field::R7, cpu_state.extended.r7},
+      {Field::R8, cpu_state.extended.r8},
+      {Field::R9, cpu_state.extended.r9},
+      {Field::R10, cpu_state.extended.r10},
+      {Field::R11, cpu_state.extended.r11},
+      {Field::R12, cpu_state.base.r12},
+  }};
+}
+
+}  // namespace
 
 Status DumpCpuStateProto(protobuf::Encoder& dest,
                          const pw_cpu_exception_State& cpu_state) {
@@ -61,4 +106,24 @@ Status DumpCpuStateProto(protobuf::Encoder& dest,
   return OkStatus();
 }
 
+Status DumpCpuStateProto(protobuf::StreamingEncoder& dest,
+                         uint32_t field_number,
+                         const pw_cpu_exception_State& cpu_state) {
+  const std::array<Register, 26> registers = Registers(cpu_state);
+
+  size_t size = 0;
+  for (const Register& reg : registers) {
+    size += protobuf::SizeOfVarintField(static_cast<uint32_t>(reg.field),
+                                        reg.value);
+  }
+
+  protobuf::StreamingEncoder state_encoder =
+      dest.GetNestedEncoder(field_number, size);
+  for (const Register& reg : registers) {
+    state_encoder.WriteUint32(static_cast<uint32_t>(reg.field), reg.value);
+  }
+  state_encoder.Finalize();
+  return dest.status();
+}
+
 }  // namespace pw::cpu_exception
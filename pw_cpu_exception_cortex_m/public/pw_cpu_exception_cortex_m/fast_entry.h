@@ -0,0 +1,81 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_cpu_exception_cortex_m/cpu_state.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_preprocessor/util.h"
+
+namespace pw::cpu_exception {
+
+// The state captured by pw_cpu_exception_FastEntry(): the register frame the
+// CPU pushed on exception entry and the fault status registers. This is enough
+// to decide whether a fault can be handled, and to handle it, without the cost
+// of capturing and dumping the full pw_cpu_exception_State.
+struct MinimalCpuState {
+  // The register frame the CPU pushed to the stack that was active at the time
+  // of the fault. Changes made to it, such as moving pc past the faulting
+  // instruction, take effect when the exception returns.
+  CortexMExceptionRegisters* frame;
+
+  uint32_t exc_return;
+  uint32_t cfsr;
+  uint32_t mmfar;
+  uint32_t bfar;
+  uint32_t hfsr;
+
+  // Whether the faulting code was running on the process stack (PSP), e.g. in
+  // a thread, rather than the main stack.
+  bool psp_was_active() const;
+
+  // Whether the CPU reserved space for the FPU registers after the frame.
+  bool fpu_frame_pushed() const;
+};
+
+// Copies the faulting code's FPU registers from the extended frame into fpu.
+// With lazy FPU state preservation enabled (the default), the CPU only reserves
+// the space on exception entry, so this first executes an FPU instruction to
+// make the CPU write the registers. Handlers that don't need the FPU state
+// don't pay for saving it.
+//
+// Returns false if no FPU frame was pushed, or the FPU is not enabled in this
+// build (PW_ARMV7M_ENABLE_FPU).
+bool CaptureFpuState(const MinimalCpuState& state,
+                     CortexMExceptionRegistersFpu& fpu);
+
+// Sets the handler called by pw_cpu_exception_FastEntry(). The handler returns
+// true if it handled the fault, in which case the fault status bits it was
+// given are cleared and execution resumes from the (possibly modified) frame.
+// If it returns false, or no handler is set, the fault escalates to
+// pw_cpu_exception_Entry(), which captures the full CPU state and calls the
+// regular exception handler.
+//
+// The handler runs in the exception context, so it must be short and must not
+// block.
+void SetFastHandler(bool (*handler)(MinimalCpuState& state));
+
+}  // namespace pw::cpu_exception
+
+// Exception entry for faults that are expected to be recoverable, such as
+// MemManage faults from sandboxed tasks. Only the CPU-pushed frame and fault
+// status registers are captured before the fast handler runs; the full state
+// capture of pw_cpu_exception_Entry() is deferred until the handler decides the
+// fault is fatal. If the CPU failed to push a frame (a stacking error), this
+// goes straight to pw_cpu_exception_Entry().
+//
+// Install this in the vector table in place of pw_cpu_exception_Entry() for the
+// faults the fast handler deals with.
+PW_EXTERN_C PW_NO_PROLOGUE void pw_cpu_exception_FastEntry(void);
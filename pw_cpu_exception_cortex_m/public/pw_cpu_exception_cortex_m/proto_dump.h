@@ -15,6 +15,7 @@
 
 #include "pw_cpu_exception_cortex_m/cpu_state.h"
 #include "pw_protobuf/encoder.h"
+#include "pw_protobuf/streaming_encoder.h"
 #include "pw_status/status.h"
 
 namespace pw::cpu_exception {
@@ -30,4 +31,14 @@ namespace pw::cpu_exception {
 Status DumpCpuStateProto(protobuf::Encoder& dest,
                          const pw_cpu_exception_State& cpu_state);
 
+// Dumps the cpu state as an ArmV7mCpuState submessage in field field_number of
+// dest, e.g. the armv7m_cpu_state field of a pw.snapshot.Snapshot. The
+// submessage's size is calculated first, so it is streamed straight to dest's
+// writer without using a scratch buffer.
+//
+// Returns the status of dest.
+Status DumpCpuStateProto(protobuf::StreamingEncoder& dest,
+                         uint32_t field_number,
+                         const pw_cpu_exception_State& cpu_state);
+
 }  // namespace pw::cpu_exception
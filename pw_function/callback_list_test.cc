@@ -0,0 +1,157 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_function/callback_list.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+TEST(CallbackList, Empty_InvokeDoesNothing) {
+  CallbackList<void(int), 4> callbacks;
+  EXPECT_TRUE(callbacks.empty());
+  EXPECT_EQ(callbacks.size(), 0u);
+  EXPECT_EQ(callbacks.capacity(), 4u);
+  callbacks(1);
+}
+
+TEST(CallbackList, Register_AllCallbacksInvoked) {
+  CallbackList<void(int), 4> callbacks;
+  int sum = 0;
+  int count = 0;
+
+  auto first = callbacks.Register([&sum](int value) { sum += value; });
+  auto second = callbacks.Register([&count](int) { count += 1; });
+  EXPECT_TRUE(first.valid());
+  EXPECT_TRUE(second.valid());
+  EXPECT_EQ(callbacks.size(), 2u);
+
+  callbacks(5);
+  callbacks(6);
+  EXPECT_EQ(sum, 11);
+  EXPECT_EQ(count, 2);
+}
+
+TEST(CallbackList, Full_RegisterFails) {
+  CallbackList<void(), 2> callbacks;
+  auto first = callbacks.Register([] {});
+  auto second = callbacks.Register([] {});
+  EXPECT_TRUE(first.valid() && second.valid());
+  EXPECT_TRUE(callbacks.full());
+
+  auto third = callbacks.Register([] {});
+  EXPECT_FALSE(third.valid());
+  EXPECT_EQ(callbacks.size(), 2u);
+}
+
+TEST(CallbackList, NullCallback_RegisterFails) {
+  CallbackList<void(), 2> callbacks;
+  auto handle = callbacks.Register(nullptr);
+  EXPECT_FALSE(handle.valid());
+  EXPECT_TRUE(callbacks.empty());
+}
+
+TEST(CallbackList, Unregister_CallbackNoLongerInvoked) {
+  CallbackList<void(), 4> callbacks;
+  std::array<int, 3> calls{};
+
+  auto a = callbacks.Register([&calls] { calls[0] += 1; });
+  auto b = callbacks.Register([&calls] { calls[1] += 1; });
+  auto c = callbacks.Register([&calls] { calls[2] += 1; });
+
+  EXPECT_TRUE(callbacks.Unregister(a));
+  EXPECT_FALSE(a.valid());
+  EXPECT_EQ(callbacks.size(), 2u);
+
+  callbacks();
+  EXPECT_EQ(calls[0], 0);
+  EXPECT_EQ(calls[1], 1);
+  EXPECT_EQ(calls[2], 1);
+
+  // The handle of the moved callback still refers to it.
+  EXPECT_TRUE(callbacks.Unregister(c));
+  callbacks();
+  EXPECT_EQ(calls[1], 2);
+  EXPECT_EQ(calls[2], 1);
+
+  EXPECT_TRUE(callbacks.Unregister(b));
+  EXPECT_TRUE(callbacks.empty());
+}
+
+TEST(CallbackList, UnregisterTwice_SecondFails) {
+  CallbackList<void(), 2> callbacks;
+  auto handle = callbacks.Register([] {});
+  EXPECT_TRUE(callbacks.Unregister(handle));
+  EXPECT_FALSE(callbacks.Unregister(handle));
+  EXPECT_TRUE(callbacks.empty());
+}
+
+TEST(CallbackList, SlotsReused) {
+  CallbackList<void(int&), 3> callbacks;
+  int total = 0;
+
+  for (int round = 0; round < 10; ++round) {
+    auto a = callbacks.Register([](int& value) { value += 1; });
+    auto b = callbacks.Register([](int& value) { value += 10; });
+    auto c = callbacks.Register([](int& value) { value += 100; });
+    ASSERT_TRUE(c.valid());
+    ASSERT_TRUE(callbacks.full());
+
+    callbacks.Unregister(b);
+    auto d = callbacks.Register([](int& value) { value += 1000; });
+    ASSERT_TRUE(d.valid());
+
+    callbacks(total);
+
+    callbacks.Unregister(c);
+    callbacks.Unregister(a);
+    callbacks.Unregister(d);
+    ASSERT_TRUE(callbacks.empty());
+  }
+  EXPECT_EQ(total, 11010);
+}
+
+TEST(CallbackList, ValueArguments_EachCallbackGetsCopy) {
+  CallbackList<void(int), 2> callbacks;
+  int first = 0;
+  int second = 0;
+  auto a = callbacks.Register([&first](int value) { first = ++value; });
+  auto b = callbacks.Register([&second](int value) { second = ++value; });
+  ASSERT_TRUE(a.valid() && b.valid());
+
+  callbacks(7);
+  EXPECT_EQ(first, 8);
+  EXPECT_EQ(second, 8);
+}
+
+TEST(CallbackList, HandleMove_TransfersOwnership) {
+  CallbackList<void(), 2> callbacks;
+  auto handle = callbacks.Register([] {});
+  decltype(callbacks)::Handle moved = std::move(handle);
+  EXPECT_TRUE(moved.valid());
+
+// Ignore use-after-move.
+#ifndef __clang_analyzer__
+  EXPECT_FALSE(handle.valid());
+#endif  // __clang_analyzer__
+
+  EXPECT_TRUE(callbacks.Unregister(moved));
+  EXPECT_TRUE(callbacks.empty());
+}
+
+}  // namespace
+}  // namespace pw
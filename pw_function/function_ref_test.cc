@@ -0,0 +1,110 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_function/function_ref.h"
+
+#include "gtest/gtest.h"
+#include "pw_function/function.h"
+
+namespace pw {
+namespace {
+
+static_assert(sizeof(FunctionRef<void()>) == 2 * sizeof(void*));
+
+int Multiply(int a, int b) { return a * b; }
+
+int CallWith3And7(FunctionRef<int(int, int)> function) {
+  return function(3, 7);
+}
+
+TEST(FunctionRef, FreeFunction) { EXPECT_EQ(21, CallWith3And7(Multiply)); }
+
+TEST(FunctionRef, FunctionPointer) {
+  int (*pointer)(int, int) = Multiply;
+  FunctionRef<int(int, int)> function = pointer;
+  pointer = nullptr;  // Function pointers are stored by value.
+  EXPECT_EQ(21, function(3, 7));
+}
+
+TEST(FunctionRef, NonCapturingLambda) {
+  EXPECT_EQ(10, CallWith3And7([](int a, int b) { return a + b; }));
+}
+
+TEST(FunctionRef, CapturingLambda_ModifiesCapturedState) {
+  int calls = 0;
+  auto count = [&calls](int a, int b) {
+    calls += 1;
+    return a - b;
+  };
+  EXPECT_EQ(-4, CallWith3And7(count));
+  EXPECT_EQ(-4, CallWith3And7(count));
+  EXPECT_EQ(2, calls);
+}
+
+class Accumulator {
+ public:
+  int operator()(int a, int b) {
+    total_ += a * b;
+    return total_;
+  }
+
+  int total() const { return total_; }
+
+ private:
+  int total_ = 0;
+};
+
+TEST(FunctionRef, CallableObject_IsNotCopied) {
+  Accumulator accumulator;
+  EXPECT_EQ(21, CallWith3And7(accumulator));
+  EXPECT_EQ(42, CallWith3And7(accumulator));
+  EXPECT_EQ(42, accumulator.total());
+}
+
+TEST(FunctionRef, ConstCallableObject) {
+  const auto add = [](int a, int b) { return a + b; };
+  EXPECT_EQ(10, CallWith3And7(add));
+}
+
+TEST(FunctionRef, PwFunction) {
+  Function<int(int, int)> function = Multiply;
+  EXPECT_EQ(21, CallWith3And7(function));
+}
+
+TEST(FunctionRef, Copy_RefersToSameCallable) {
+  int calls = 0;
+  auto count = [&calls] { calls += 1; };
+  FunctionRef<void()> first = count;
+  FunctionRef<void()> second = first;
+  first();
+  second();
+  EXPECT_EQ(2, calls);
+}
+
+TEST(FunctionRef, ReturnValueDiscarded) {
+  FunctionRef<void(int, int)> function = Multiply;
+  function(1, 2);
+}
+
+TEST(FunctionRef, ReferenceArguments) {
+  int value = 1;
+  const auto increment = [](int& number) { number += 1; };
+  FunctionRef<void(int&)> function = increment;
+  function(value);
+  function(value);
+  EXPECT_EQ(3, value);
+}
+
+}  // namespace
+}  // namespace pw
@@ -0,0 +1,187 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "pw_function/function.h"
+
+namespace pw {
+
+template <typename Signature, size_t kCapacity>
+class CallbackList;
+
+// pw::CallbackList is a fixed-capacity list of pw::Function callbacks that are
+// all invoked when an event occurs. It replaces the hand-written arrays of
+// callbacks and registration handles used for event fan-out.
+//
+//   pw::CallbackList<void(const Event&), 4> listeners;
+//
+//   auto handle = listeners.Register([](const Event& event) { ... });
+//   listeners(event);  // Calls every registered callback.
+//   listeners.Unregister(handle);
+//
+// Registering and unregistering are O(1). The callbacks are kept packed at the
+// front of the list, so invoking them is a loop over exactly size() Functions
+// with no empty slots to skip. Unregistering moves the last callback into the
+// removed callback's place, so callbacks are not necessarily invoked in the
+// order they were registered.
+//
+// Callbacks are stored inline in pw::Function objects, so the usual
+// pw::Function size limits apply. Arguments are passed to each callback as if
+// by value or by reference, according to the signature; rvalue reference
+// arguments are not supported since they would be consumed by the first
+// callback.
+//
+// CallbackList is not synchronized. Callbacks must not be registered or
+// unregistered while the list is being invoked, including from a callback.
+template <typename... Args, size_t kCapacity>
+class CallbackList<void(Args...), kCapacity> {
+ private:
+  static_assert(kCapacity > 0u, "A CallbackList must have a capacity");
+  static_assert(kCapacity < std::numeric_limits<uint16_t>::max(),
+                "CallbackList capacity is limited to 65534 callbacks");
+  static_assert((!std::is_rvalue_reference_v<Args> && ...),
+                "CallbackList signatures cannot take rvalue references, since "
+                "each argument is passed to multiple callbacks");
+
+  // The smallest type that indexes every slot, plus one for "no slot".
+  using Index =
+      std::conditional_t<(kCapacity < std::numeric_limits<uint8_t>::max()),
+                         uint8_t,
+                         uint16_t>;
+
+  static constexpr Index kNoSlot = std::numeric_limits<Index>::max();
+
+ public:
+  using Callback = Function<void(Args...)>;
+
+  // Identifies a registered callback so it can be unregistered. Handles are
+  // move-only, and Unregister() invalidates the handle, so a callback cannot
+  // be unregistered twice through copies of its handle.
+  class Handle {
+   public:
+    constexpr Handle() : slot_(kNoSlot) {}
+
+    constexpr Handle(Handle&& other) : slot_(other.slot_) {
+      other.slot_ = kNoSlot;
+    }
+
+    constexpr Handle& operator=(Handle&& other) {
+      slot_ = other.slot_;
+      other.slot_ = kNoSlot;
+      return *this;
+    }
+
+    Handle(const Handle&) = delete;
+    Handle& operator=(const Handle&) = delete;
+
+    // False if registration failed or the callback was unregistered.
+    constexpr bool valid() const { return slot_ != kNoSlot; }
+
+   private:
+    friend class CallbackList;
+
+    explicit constexpr Handle(Index slot) : slot_(slot) {}
+
+    Index slot_;
+  };
+
+  CallbackList() : size_(0), free_slot_(0) {
+    // Every slot starts out on the free list.
+    for (size_t slot = 0; slot < kCapacity; ++slot) {
+      index_of_slot_[slot] = static_cast<Index>(slot + 1);
+    }
+  }
+
+  CallbackList(const CallbackList&) = delete;
+  CallbackList& operator=(const CallbackList&) = delete;
+
+  // Adds a callback to the list. Returns an invalid handle if the list is full
+  // or the callback is null.
+  [[nodiscard]] Handle Register(Callback&& callback) {
+    if (full() || !callback) {
+      return Handle();
+    }
+
+    const Index slot = free_slot_;
+    free_slot_ = index_of_slot_[slot];
+
+    callbacks_[size_] = std::move(callback);
+    slot_of_index_[size_] = slot;
+    index_of_slot_[slot] = size_;
+    size_ += 1;
+    return Handle(slot);
+  }
+
+  // Removes the callback registered with the handle and invalidates the handle.
+  // Returns false if the handle was already invalid. The handle must have been
+  // returned by this list.
+  bool Unregister(Handle& handle) {
+    if (!handle.valid()) {
+      return false;
+    }
+
+    const Index slot = handle.slot_;
+    const Index index = index_of_slot_[slot];
+    const Index last = static_cast<Index>(size_ - 1);
+
+    // Keep the callbacks packed by moving the last one into the hole.
+    if (index != last) {
+      callbacks_[index] = std::move(callbacks_[last]);
+      slot_of_index_[index] = slot_of_index_[last];
+      index_of_slot_[slot_of_index_[index]] = index;
+    }
+    callbacks_[last] = nullptr;
+    size_ = last;
+
+    index_of_slot_[slot] = free_slot_;
+    free_slot_ = slot;
+
+    handle = Handle();
+    return true;
+  }
+
+  // Invokes every registered callback with the arguments.
+  void operator()(Args... args) const {
+    for (size_t i = 0; i < size_; ++i) {
+      callbacks_[i](static_cast<Args>(args)...);
+    }
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0u; }
+  bool full() const { return size_ == kCapacity; }
+  static constexpr size_t capacity() { return kCapacity; }
+
+ private:
+  // Registered callbacks, packed into [0, size_).
+  Callback callbacks_[kCapacity];
+
+  // The slot (handle) of the callback at each index in callbacks_.
+  Index slot_of_index_[kCapacity];
+
+  // For a registered slot, the index of its callback in callbacks_. For a free
+  // slot, the next free slot, which forms the free list.
+  Index index_of_slot_[kCapacity];
+
+  Index size_;
+  Index free_slot_;
+};
+
+}  // namespace pw
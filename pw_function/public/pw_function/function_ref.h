@@ -0,0 +1,116 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace pw {
+
+template <typename Signature>
+class FunctionRef;
+
+// pw::FunctionRef is a non-owning reference to a callable object. It is two
+// pointers: one to the callable and one to a function that invokes it. Unlike
+// pw::Function, it never copies or moves the callable, has no inline storage
+// size limit, and has no manager to call when it goes out of scope.
+//
+// FunctionRef is intended for callbacks that are only used for the duration of
+// a call, such as visitors and output functions. The referenced callable must
+// outlive the FunctionRef. A lambda passed directly as an argument lives until
+// the end of the full expression, so this is safe:
+//
+//   void ForEachFrame(ConstByteSpan data,
+//                     pw::FunctionRef<void(const Frame&)> callback);
+//
+//   ForEachFrame(data, [&](const Frame& frame) { count += 1; });
+//
+// Do NOT store a FunctionRef that refers to a temporary:
+//
+//   pw::FunctionRef<void()> callback = [&] { count += 1; };  // Dangles!
+//
+// Function pointers are stored by value, so a FunctionRef made from a function
+// or function pointer can be kept as long as needed.
+//
+// A FunctionRef always refers to a callable; it cannot be null.
+template <typename Return, typename... Args>
+class FunctionRef<Return(Args...)> {
+ public:
+  // Refers to any callable that can be invoked with Args and returns something
+  // convertible to Return.
+  template <typename Callable,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::remove_cv_t<std::remove_reference_t<
+                                    Callable>>,
+                                FunctionRef> &&
+                std::is_invocable_r_v<Return, Callable&, Args...>>>
+  FunctionRef(Callable&& callable) noexcept {
+    using Decayed = std::decay_t<Callable>;
+
+    if constexpr (std::is_function_v<std::remove_pointer_t<Decayed>>) {
+      callable_.function = reinterpret_cast<void (*)()>(
+          static_cast<Decayed>(callable));
+      invoker_ = &InvokeFunction<Decayed>;
+    } else {
+      callable_.object = const_cast<void*>(
+          static_cast<const void*>(std::addressof(callable)));
+      invoker_ = &InvokeObject<std::remove_reference_t<Callable>>;
+    }
+  }
+
+  constexpr FunctionRef(const FunctionRef&) = default;
+  constexpr FunctionRef& operator=(const FunctionRef&) = default;
+
+  Return operator()(Args... args) const {
+    return invoker_(callable_, std::forward<Args>(args)...);
+  }
+
+ private:
+  // Pointers to objects cannot portably hold function pointers, so the two are
+  // stored in a union.
+  union Storage {
+    void* object;
+    void (*function)();
+  };
+
+  using Invoker = Return (*)(Storage, Args...);
+
+  template <typename T>
+  static Return InvokeObject(Storage callable, Args... args) {
+    if constexpr (std::is_void_v<Return>) {
+      std::invoke(*static_cast<T*>(callable.object),
+                  std::forward<Args>(args)...);
+    } else {
+      return std::invoke(*static_cast<T*>(callable.object),
+                         std::forward<Args>(args)...);
+    }
+  }
+
+  template <typename FunctionPointer>
+  static Return InvokeFunction(Storage callable, Args... args) {
+    const auto function = reinterpret_cast<FunctionPointer>(callable.function);
+    if constexpr (std::is_void_v<Return>) {
+      std::invoke(function, std::forward<Args>(args)...);
+    } else {
+      return std::invoke(function, std::forward<Args>(args)...);
+    }
+  }
+
+  Storage callable_;
+  Invoker invoker_;
+};
+
+}  // namespace pw
@@ -0,0 +1,138 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_fuzzer/execution_timer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace pw::fuzzer {
+namespace {
+
+// Number of slowest inputs to keep and report.
+constexpr size_t kSlowestInputs = 10;
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+class ExecutionReport {
+ public:
+  void Record(const uint8_t* data, size_t size, int64_t duration_ns) {
+    executions_ += 1;
+    total_ns_ += duration_ns;
+
+    if (slowest_.size() == kSlowestInputs) {
+      if (duration_ns <= slowest_.back().duration_ns) {
+        return;
+      }
+      slowest_.pop_back();
+    }
+
+    // Only inputs that are among the slowest are copied, which is rare once
+    // the fuzzer has run for a while.
+    auto position = std::find_if(
+        slowest_.begin(), slowest_.end(), [duration_ns](const SlowInput& s) {
+          return s.duration_ns < duration_ns;
+        });
+    slowest_.insert(
+        position,
+        SlowInput{duration_ns, std::vector<uint8_t>(data, data + size)});
+  }
+
+  void Print() const {
+    if (executions_ == 0) {
+      return;
+    }
+    const double seconds = static_cast<double>(total_ns_) / 1e9;
+    std::fprintf(stderr,
+                 "==== pw_fuzzer execution report ====\n"
+                 "%" PRIu64 " executions, %.3f s in the fuzz target, "
+                 "%.0f exec/s\n",
+                 executions_,
+                 seconds,
+                 seconds > 0 ? static_cast<double>(executions_) / seconds : 0);
+
+    const char* dir = std::getenv("PW_FUZZER_SLOW_INPUT_DIR");
+    std::fprintf(stderr, "Slowest inputs:\n");
+    for (size_t i = 0; i < slowest_.size(); ++i) {
+      const SlowInput& input = slowest_[i];
+      std::fprintf(stderr,
+                   "  %2zu. %10" PRId64 " ns, %8zu bytes, %8" PRId64
+                   " ns/byte",
+                   i + 1,
+                   input.duration_ns,
+                   input.data.size(),
+                   input.duration_ns / static_cast<int64_t>(std::max<size_t>(
+                                           input.data.size(), 1)));
+      if (dir != nullptr) {
+        const std::string path =
+            std::string(dir) + "/slow-input-" + std::to_string(i + 1);
+        if (WriteFile(path, input.data)) {
+          std::fprintf(stderr, "  %s", path.c_str());
+        }
+      }
+      std::fprintf(stderr, "\n");
+    }
+  }
+
+ private:
+  struct SlowInput {
+    int64_t duration_ns;
+    std::vector<uint8_t> data;
+  };
+
+  static bool WriteFile(const std::string& path,
+                        const std::vector<uint8_t>& data) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+      return false;
+    }
+    const bool ok = std::fwrite(data.data(), 1, data.size(), file) ==
+                    data.size();
+    return std::fclose(file) == 0 && ok;
+  }
+
+  uint64_t executions_ = 0;
+  int64_t total_ns_ = 0;
+  std::vector<SlowInput> slowest_;  // Sorted from slowest to fastest.
+};
+
+// The report is never destroyed, so it is still valid when it is printed at
+// exit.
+ExecutionReport& Report() {
+  static ExecutionReport* const report = [] {
+    std::atexit([] { Report().Print(); });
+    return new ExecutionReport();
+  }();
+  return *report;
+}
+
+}  // namespace
+
+ScopedExecutionTimer::ScopedExecutionTimer(const uint8_t* data, size_t size)
+    : data_(data), size_(size), start_ns_(NowNs()) {}
+
+ScopedExecutionTimer::~ScopedExecutionTimer() {
+  Report().Record(data_, size_, NowNs() - start_ns_);
+}
+
+}  // namespace pw::fuzzer
@@ -0,0 +1,52 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pw::fuzzer {
+
+// Times executions of a fuzz target. Declare one at the start of the fuzz
+// target function:
+//
+//   extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+//     pw::fuzzer::ScopedExecutionTimer timer(data, size);
+//     ...
+//   }
+//
+// When the fuzzer exits, a report is printed to stderr with the number of
+// executions, the executions per second spent in the fuzz target itself, and
+// the slowest inputs with their sizes and time per byte. A performance cliff,
+// such as quadratic handling of some input, shows up as a slow input with a
+// high time per byte.
+//
+// If the PW_FUZZER_SLOW_INPUT_DIR environment variable is set, the slowest
+// inputs are also written to files named slow-input-<rank> in that directory,
+// so they can be rerun or profiled.
+class ScopedExecutionTimer {
+ public:
+  ScopedExecutionTimer(const uint8_t* data, size_t size);
+  ~ScopedExecutionTimer();
+
+  ScopedExecutionTimer(const ScopedExecutionTimer&) = delete;
+  ScopedExecutionTimer& operator=(const ScopedExecutionTimer&) = delete;
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  int64_t start_ns_;
+};
+
+}  // namespace pw::fuzzer
@@ -24,6 +24,20 @@
 
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
 
+// Fuzzers with structure-aware mutators define this. It is declared weak so
+// that fuzzers without one still link.
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t* data,
+                                          size_t size,
+                                          size_t max_size,
+                                          unsigned int seed)
+    __attribute__((weak));
+
+// libFuzzer provides this to custom mutators to apply its own mutations. This
+// stand-in leaves the data unchanged.
+extern "C" size_t LLVMFuzzerMutate(uint8_t*, size_t size, size_t) {
+  return size;
+}
+
 TEST(Fuzzer, EmptyInput) {
   PW_LOG_INFO("Fuzzing is disabled for the current platform and/or compiler.");
   PW_LOG_INFO("Executing the fuzz target function as a unit test instead.");
@@ -32,4 +46,20 @@ TEST(Fuzzer, EmptyInput) {
   EXPECT_EQ(LLVMFuzzerTestOneInput(nullptr, 0), 0);
 }
 
+TEST(Fuzzer, CustomMutator) {
+  if (LLVMFuzzerCustomMutator == nullptr) {
+    return;
+  }
+
+  // Check that the mutator's output is accepted by the fuzz target, starting
+  // from an empty input.
+  uint8_t data[256] = {};
+  size_t size = 0;
+  for (unsigned int seed = 0; seed < 100; ++seed) {
+    size = LLVMFuzzerCustomMutator(data, size, sizeof(data), seed);
+    ASSERT_LE(size, sizeof(data));
+    EXPECT_EQ(LLVMFuzzerTestOneInput(data, size), 0);
+  }
+}
+
 // TODO(pwbug/178): Add support for testing a seed corpus.
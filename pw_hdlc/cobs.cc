@@ -0,0 +1,216 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/cobs.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#include "pw_bytes/endian.h"
+#include "pw_checksum/crc32.h"
+#include "pw_hdlc/internal/protocol.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+
+using std::byte;
+
+namespace pw::hdlc {
+namespace {
+
+// The largest number of data bytes in a COBS block, and the code of a block
+// with that many bytes, which is not followed by a zero.
+constexpr size_t kMaxBlockSize = 254;
+constexpr byte kFullBlockCode = byte{0xFF};
+
+// Returns the length of the data before the first zero byte, or the size of the
+// data if it has none.
+size_t FindDelimiter(ConstByteSpan data) {
+  const void* found = std::memchr(data.data(), 0, data.size());
+  return found == nullptr ? data.size()
+                          : static_cast<const byte*>(found) - data.data();
+}
+
+// Encodes data into COBS blocks, which are collected in a buffer and written
+// whole.
+class CobsEncoder {
+ public:
+  constexpr CobsEncoder(stream::Writer& writer)
+      : writer_(writer), block_{}, block_size_(0) {}
+
+  Status WriteData(ConstByteSpan data) {
+    while (!data.empty()) {
+      const size_t run = FindDelimiter(
+          data.first(std::min(data.size(), kMaxBlockSize - block_size_)));
+      std::memcpy(&block_[1 + block_size_], data.data(), run);
+      block_size_ += run;
+      data = data.subspan(run);
+
+      if (block_size_ == kMaxBlockSize) {
+        PW_TRY(WriteBlock(kFullBlockCode));
+      } else if (!data.empty()) {
+        // The run ended at a zero, which the block's code replaces.
+        PW_TRY(WriteBlock(static_cast<byte>(block_size_ + 1)));
+        data = data.subspan(1);
+      }
+    }
+    return OkStatus();
+  }
+
+  // Writes the last block, which is never followed by a zero, together with
+  // the closing delimiter.
+  Status FinishFrame() {
+    block_[0] = static_cast<byte>(block_size_ + 1);
+    block_[1 + block_size_] = kCobsDelimiter;
+    return writer_.Write(std::span(block_).first(block_size_ + 2));
+  }
+
+ private:
+  Status WriteBlock(byte code) {
+    block_[0] = code;
+    const size_t size = block_size_ + 1;
+    block_size_ = 0;
+    return writer_.Write(std::span(block_).first(size));
+  }
+
+  stream::Writer& writer_;
+
+  // The code byte, up to 254 data bytes, and room for the closing delimiter.
+  std::array<byte, 1 + kMaxBlockSize + 1> block_;
+  size_t block_size_;
+};
+
+}  // namespace
+
+Status WriteCobsUIFrame(uint64_t address,
+                        ConstByteSpan payload,
+                        stream::Writer& writer) {
+  std::array<byte, varint::kMaxVarint64SizeBytes + 1> metadata;
+  size_t metadata_size = varint::Encode(address, metadata, kAddressFormat);
+  if (metadata_size == 0) {
+    return Status::InvalidArgument();
+  }
+  metadata[metadata_size++] = UFrameControl::UnnumberedInformation().data();
+
+  // The contents, one code byte per full block plus the last block's, and the
+  // two delimiters.
+  const size_t contents_size =
+      metadata_size + payload.size() + sizeof(uint32_t);
+  if (contents_size + contents_size / kMaxBlockSize + 3 >
+      writer.ConservativeWriteLimit()) {
+    return Status::ResourceExhausted();
+  }
+
+  checksum::Crc32 fcs;
+  fcs.Update(std::span(metadata).first(metadata_size));
+  fcs.Update(payload);
+
+  CobsEncoder encoder(writer);
+  PW_TRY(writer.Write(kCobsDelimiter));
+  PW_TRY(encoder.WriteData(std::span(metadata).first(metadata_size)));
+  PW_TRY(encoder.WriteData(payload));
+  PW_TRY(encoder.WriteData(
+      bytes::CopyInOrder(std::endian::little, fcs.value())));
+  return encoder.FinishFrame();
+}
+
+Result<Frame> CobsDecoder::Process(const byte new_byte) {
+  if (new_byte == kCobsDelimiter) {
+    return FinishFrame();
+  }
+
+  if (block_remaining_ == 0u) {
+    StartBlock(new_byte);
+  } else {
+    AppendBytes(std::span(&new_byte, 1));
+    block_remaining_ -= 1;
+  }
+  return Status::Unavailable();
+}
+
+void CobsDecoder::Process(ConstByteSpan data,
+                          FunctionRef<void(const Result<Frame>&)> callback) {
+  while (true) {
+    // Copy the rest of the current block, up to a delimiter.
+    const size_t run = FindDelimiter(
+        data.first(std::min<size_t>(data.size(), block_remaining_)));
+    AppendBytes(data.first(run));
+    block_remaining_ -= run;
+    data = data.subspan(run);
+
+    if (data.empty()) {
+      return;
+    }
+
+    const Result<Frame> result = Process(data.front());
+    data = data.subspan(1);
+    if (result.status() != Status::Unavailable()) {
+      callback(result);
+    }
+  }
+}
+
+Result<Frame> CobsDecoder::FinishFrame() {
+  const size_t frame_size = current_frame_size_;
+  const bool complete = block_remaining_ == 0u;
+  const bool empty = frame_size == 0u && complete && !zero_pending_;
+  Reset();
+
+  // Repeated delimiters are not an error.
+  if (empty) {
+    return Status::Unavailable();
+  }
+
+  if (!complete || frame_size < Frame::kMinSizeBytes) {
+    PW_LOG_ERROR("Received incomplete or %lu-byte COBS frame",
+                 static_cast<unsigned long>(frame_size));
+    return Status::DataLoss();
+  }
+
+  if (frame_size > max_size()) {
+    return Status::ResourceExhausted();
+  }
+
+  const ConstByteSpan frame = buffer_.first(frame_size);
+  const size_t fcs_offset = frame_size - sizeof(uint32_t);
+  if (checksum::Crc32::Calculate(frame.first(fcs_offset)) !=
+      bytes::ReadInOrder<uint32_t>(std::endian::little, &frame[fcs_offset])) {
+    PW_LOG_ERROR("Frame check sequence verification failed");
+    return Status::DataLoss();
+  }
+
+  return Frame::Parse(frame);
+}
+
+void CobsDecoder::StartBlock(byte code) {
+  if (zero_pending_) {
+    const byte zero = byte{0};
+    AppendBytes(std::span(&zero, 1));
+  }
+  block_remaining_ = static_cast<uint8_t>(code) - 1;
+  zero_pending_ = code != kFullBlockCode;
+}
+
+void CobsDecoder::AppendBytes(ConstByteSpan data) {
+  if (current_frame_size_ < max_size()) {
+    std::memcpy(&buffer_[current_frame_size_],
+                data.data(),
+                std::min(data.size(), max_size() - current_frame_size_));
+  }
+
+  // Always increase size: if it is larger than the buffer, overflow occurred.
+  current_frame_size_ += data.size();
+}
+
+}  // namespace pw::hdlc
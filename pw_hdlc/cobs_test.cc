@@ -0,0 +1,263 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/cobs.h"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_stream/memory_stream.h"
+
+using std::byte;
+
+namespace pw::hdlc {
+namespace {
+
+constexpr uint8_t kAddress = 0x7B;  // 123
+constexpr uint8_t kEncodedAddress = (kAddress << 1) | 1;
+constexpr byte kControl = byte{0x3};  // UI-frame control sequence.
+
+// Returns a payload of the given size with zeros at every kZeroInterval bytes.
+template <size_t kZeroInterval>
+std::array<byte, 600> TestPayload() {
+  std::array<byte, 600> payload;
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] =
+        i % kZeroInterval == 0 ? byte{0} : static_cast<byte>(i % 251 + 1);
+  }
+  return payload;
+}
+
+TEST(WriteCobsUIFrame, NoZeros) {
+  stream::MemoryWriterBuffer<32> writer;
+  ASSERT_EQ(OkStatus(),
+            WriteCobsUIFrame(kAddress, bytes::String("A"), writer));
+
+  constexpr auto expected = bytes::Concat(byte{0},
+                                          byte{8},
+                                          kEncodedAddress,
+                                          kControl,
+                                          'A',
+                                          uint32_t{0x653c9e82},
+                                          byte{0});
+  ASSERT_EQ(writer.bytes_written(), expected.size());
+  EXPECT_EQ(std::memcmp(writer.data(), expected.data(), expected.size()), 0);
+}
+
+TEST(WriteCobsUIFrame, ZerosReplacedWithCodes) {
+  stream::MemoryWriterBuffer<32> writer;
+  ASSERT_EQ(OkStatus(),
+            WriteCobsUIFrame(
+                kAddress, bytes::Array<0x00, 0x11, 0x00, 0x00>(), writer));
+
+  const ConstByteSpan data = writer.WrittenData();
+  ASSERT_EQ(data.size(), 2u + 2 + 4 + 1 + 4);
+  EXPECT_EQ(data[0], byte{0});
+  EXPECT_EQ(data[1], byte{3});  // Address, control, then zero
+  EXPECT_EQ(data[4], byte{2});  // 0x11, then zero
+  EXPECT_EQ(data[5], byte{0x11});
+  EXPECT_EQ(data[6], byte{1});  // Zero
+  EXPECT_EQ(data[7], byte{5});  // FCS, with no zeros in this case
+  EXPECT_EQ(data[data.size() - 1], byte{0});
+
+  for (byte b : data.subspan(1, data.size() - 2)) {
+    EXPECT_NE(b, byte{0});
+  }
+}
+
+TEST(WriteCobsUIFrame, OverheadBoundedForLongRuns) {
+  std::array<byte, 1000> payload;
+  payload.fill(byte{0x55});
+  stream::MemoryWriterBuffer<MaxCobsEncodedFrameSize(1000)> writer;
+  ASSERT_EQ(OkStatus(), WriteCobsUIFrame(kAddress, payload, writer));
+
+  // 1006 bytes of contents need four full blocks and a final block.
+  EXPECT_LE(writer.bytes_written(), 2u + 1006 + 5);
+}
+
+TEST(WriteCobsUIFrame, WriterTooSmall) {
+  stream::MemoryWriterBuffer<10> writer;
+  EXPECT_EQ(Status::ResourceExhausted(),
+            WriteCobsUIFrame(kAddress, bytes::String("AB"), writer));
+  EXPECT_EQ(writer.bytes_written(), 0u);
+}
+
+class CobsRoundTrip : public ::testing::Test {
+ protected:
+  // Encodes the payload and decodes it in bulk and byte by byte.
+  void RoundTrip(ConstByteSpan payload) {
+    stream::MemoryWriterBuffer<MaxCobsEncodedFrameSize(600)> writer;
+    ASSERT_EQ(OkStatus(), WriteCobsUIFrame(kAddress, payload, writer));
+    ASSERT_LE(writer.bytes_written(), MaxCobsEncodedFrameSize(payload.size()));
+
+    int frames = 0;
+    decoder_.Process(writer.WrittenData(), [&](const Result<Frame>& result) {
+      ASSERT_EQ(OkStatus(), result.status());
+      ExpectFrame(result.value(), payload);
+      frames += 1;
+    });
+    EXPECT_EQ(frames, 1);
+
+    for (byte b : writer.WrittenData()) {
+      const Result<Frame> result = decoder_.Process(b);
+      if (result.status() != Status::Unavailable()) {
+        ASSERT_EQ(OkStatus(), result.status());
+        ExpectFrame(result.value(), payload);
+        frames += 1;
+      }
+    }
+    EXPECT_EQ(frames, 2);
+  }
+
+  static void ExpectFrame(const Frame& frame, ConstByteSpan payload) {
+    EXPECT_EQ(frame.address(), kAddress);
+    EXPECT_EQ(frame.control(), kControl);
+    ASSERT_EQ(frame.data().size(), payload.size());
+    EXPECT_EQ(
+        std::memcmp(frame.data().data(), payload.data(), payload.size()), 0);
+  }
+
+  CobsDecoderBuffer<700> decoder_;
+};
+
+TEST_F(CobsRoundTrip, EmptyPayload) { RoundTrip(ConstByteSpan()); }
+
+TEST_F(CobsRoundTrip, AllZeros) {
+  constexpr std::array<byte, 300> kZeros = {};
+  for (size_t size = 0; size <= kZeros.size(); ++size) {
+    RoundTrip(std::span(kZeros).first(size));
+  }
+}
+
+TEST_F(CobsRoundTrip, BlockBoundaries) {
+  const auto payload = TestPayload<600>();
+
+  // Runs of non-zero bytes around the 254-byte block size, ending with and
+  // without a zero.
+  for (size_t size = 245; size <= 262; ++size) {
+    RoundTrip(std::span(payload).subspan(1, size));
+    RoundTrip(std::span(payload).first(size));
+  }
+  for (size_t size = 500; size <= 516; ++size) {
+    RoundTrip(std::span(payload).subspan(1, size));
+  }
+}
+
+TEST_F(CobsRoundTrip, MixedZeros) {
+  const auto sparse = TestPayload<97>();
+  const auto dense = TestPayload<3>();
+  for (size_t size = 0; size <= sparse.size(); size += 7) {
+    RoundTrip(std::span(sparse).first(size));
+    RoundTrip(std::span(dense).first(size));
+  }
+}
+
+TEST(CobsDecoder, RepeatedDelimiters_NoFrames) {
+  CobsDecoderBuffer<32> decoder;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(Status::Unavailable(), decoder.Process(byte{0}).status());
+  }
+}
+
+TEST(CobsDecoder, ConsecutiveFramesShareDelimiters) {
+  stream::MemoryWriterBuffer<64> writer;
+  ASSERT_EQ(OkStatus(), WriteCobsUIFrame(kAddress, bytes::String("1"), writer));
+  ASSERT_EQ(OkStatus(), WriteCobsUIFrame(kAddress, bytes::String("2"), writer));
+
+  CobsDecoderBuffer<32> decoder;
+  int frames = 0;
+  decoder.Process(writer.WrittenData(), [&](const Result<Frame>& result) {
+    ASSERT_EQ(OkStatus(), result.status());
+    EXPECT_EQ(result.value().data()[0], static_cast<byte>('1' + frames));
+    frames += 1;
+  });
+  EXPECT_EQ(frames, 2);
+}
+
+TEST(CobsDecoder, TruncatedBlock_DataLoss) {
+  stream::MemoryWriterBuffer<32> writer;
+  ASSERT_EQ(OkStatus(),
+            WriteCobsUIFrame(kAddress, bytes::String("hello"), writer));
+
+  // Drop the last byte of the encoded data, so the final block is incomplete.
+  CobsDecoderBuffer<32> decoder;
+  const ConstByteSpan data = writer.WrittenData();
+  for (byte b : data.first(data.size() - 2)) {
+    EXPECT_EQ(Status::Unavailable(), decoder.Process(b).status());
+  }
+  EXPECT_EQ(Status::DataLoss(), decoder.Process(byte{0}).status());
+}
+
+TEST(CobsDecoder, BadFcs_DataLoss) {
+  stream::MemoryWriterBuffer<32> writer;
+  ASSERT_EQ(OkStatus(),
+            WriteCobsUIFrame(kAddress, bytes::String("hello"), writer));
+
+  std::array<byte, 32> data;
+  std::memcpy(data.data(), writer.data(), writer.bytes_written());
+  data[4] ^= byte{0x01};  // Corrupt a payload byte.
+
+  CobsDecoderBuffer<32> decoder;
+  int frames = 0;
+  decoder.Process(std::span(data).first(writer.bytes_written()),
+                  [&](const Result<Frame>& result) {
+                    EXPECT_EQ(Status::DataLoss(), result.status());
+                    frames += 1;
+                  });
+  EXPECT_EQ(frames, 1);
+}
+
+TEST(CobsDecoder, GarbageBeforeFrame_DataLoss) {
+  CobsDecoderBuffer<32> decoder;
+  int errors = 0;
+  int frames = 0;
+  auto callback = [&](const Result<Frame>& result) {
+    if (result.ok()) {
+      frames += 1;
+    } else {
+      EXPECT_EQ(Status::DataLoss(), result.status());
+      errors += 1;
+    }
+  };
+
+  decoder.Process(bytes::String("\x03junk"), callback);
+
+  stream::MemoryWriterBuffer<32> writer;
+  ASSERT_EQ(OkStatus(), WriteCobsUIFrame(kAddress, bytes::String("A"), writer));
+  decoder.Process(writer.WrittenData(), callback);
+
+  EXPECT_EQ(errors, 1);
+  EXPECT_EQ(frames, 1);
+}
+
+TEST(CobsDecoder, FrameTooLarge_ResourceExhausted) {
+  stream::MemoryWriterBuffer<64> writer;
+  ASSERT_EQ(OkStatus(),
+            WriteCobsUIFrame(
+                kAddress, bytes::String("this frame is too large"), writer));
+
+  CobsDecoderBuffer<16> decoder;
+  int frames = 0;
+  decoder.Process(writer.WrittenData(), [&](const Result<Frame>& result) {
+    EXPECT_EQ(Status::ResourceExhausted(), result.status());
+    frames += 1;
+  });
+  EXPECT_EQ(frames, 1);
+}
+
+}  // namespace
+}  // namespace pw::hdlc
@@ -0,0 +1,171 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/cut_through_router.h"
+
+#include <algorithm>
+
+#include "pw_hdlc/internal/protocol.h"
+#include "pw_varint/varint.h"
+
+namespace pw::hdlc {
+
+void CutThroughRouter::Process(ConstByteSpan data) {
+  while (!data.empty()) {
+    const auto flag = std::find(data.begin(), data.end(), kFlag);
+    const size_t run_size = std::distance(data.begin(), flag);
+
+    ProcessFrameBytes(data.first(run_size));
+
+    if (flag == data.end()) {
+      return;
+    }
+
+    EndFrame(decoder_.Process(kFlag).status());
+    data = data.subspan(run_size + 1);
+  }
+}
+
+void CutThroughRouter::ProcessFrameBytes(ConstByteSpan data) {
+  if (data.empty()) {
+    return;
+  }
+
+  // The run contains no flags, so the decoder only updates its frame check
+  // sequence and never calls the callback.
+  decoder_.Process(data, [](const Result<Frame>&) {});
+
+  while (state_ == State::kAddress && !data.empty()) {
+    const bool address_complete = AddAddressByte(data.front());
+    data = data.subspan(1);
+    if (address_complete) {
+      StartForwarding();
+    }
+  }
+
+  if (state_ == State::kForwarding && !data.empty()) {
+    Forward(data);
+  }
+}
+
+void CutThroughRouter::EndFrame(Status frame_status) {
+  // RESOURCE_EXHAUSTED only means the frame did not fit in the decoder's
+  // buffer, which is expected.
+  const bool valid = frame_status.ok() || frame_status.IsResourceExhausted();
+
+  switch (state_) {
+    case State::kInterFrame:
+      break;
+    case State::kAddress:
+      // A frame that ends before its address is complete is invalid. Repeated
+      // flags are not a frame.
+      if (pending_size_ != 0u) {
+        fcs_errors_ += 1;
+      }
+      break;
+    case State::kForwarding:
+      Forward(std::span(&kFlag, 1));
+      if (state_ != State::kForwarding) {
+        break;  // The output failed, so the frame was not forwarded.
+      }
+      if (valid) {
+        forwarded_frames_ += 1;
+      } else {
+        fcs_errors_ += 1;
+      }
+      break;
+    case State::kDiscarding:
+      break;
+  }
+
+  state_ = State::kAddress;
+  pending_size_ = 0;
+  address_size_ = 0;
+  escape_ = false;
+  output_ = nullptr;
+}
+
+bool CutThroughRouter::AddAddressByte(std::byte b) {
+  if (pending_size_ == pending_.size()) {
+    fcs_errors_ += 1;  // The address is too long to be valid.
+    state_ = State::kDiscarding;
+    return false;
+  }
+  pending_[pending_size_++] = b;
+
+  if (b == kEscape) {
+    escape_ = true;
+    return false;
+  }
+  if (escape_) {
+    b = Escape(b);
+    escape_ = false;
+  }
+
+  if (address_size_ == address_.size()) {
+    fcs_errors_ += 1;
+    state_ = State::kDiscarding;
+    return false;
+  }
+  address_[address_size_++] = b;
+
+  // In the one-terminated format, the last byte of the address has its least
+  // significant bit set.
+  return (b & std::byte{0x1}) == std::byte{0x1};
+}
+
+void CutThroughRouter::StartForwarding() {
+  uint64_t address;
+  if (varint::Decode(std::span(address_.data(), address_size_),
+                     &address,
+                     kAddressFormat) == 0u) {
+    fcs_errors_ += 1;
+    state_ = State::kDiscarding;
+    return;
+  }
+
+  const Route* route = FindRoute(address);
+  if (route == nullptr) {
+    route_errors_ += 1;
+    state_ = State::kDiscarding;
+    return;
+  }
+
+  output_ = &route->output;
+  state_ = State::kForwarding;
+  Forward(std::span(&kFlag, 1));
+  Forward(std::span(pending_.data(), pending_size_));
+}
+
+void CutThroughRouter::Forward(ConstByteSpan data) {
+  if (state_ != State::kForwarding) {
+    return;
+  }
+  if (!output_->Write(data).ok()) {
+    egress_errors_ += 1;
+    state_ = State::kDiscarding;
+  }
+}
+
+const CutThroughRouter::Route* CutThroughRouter::FindRoute(
+    uint64_t address) const {
+  for (const Route& route : routes_) {
+    if (route.address == address) {
+      return &route;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace pw::hdlc
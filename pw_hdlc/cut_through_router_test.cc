@@ -0,0 +1,194 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/cut_through_router.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_hdlc/internal/protocol.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::hdlc {
+namespace {
+
+constexpr uint64_t kAddressA = 1;
+constexpr uint64_t kAddressB = 0x3fff;
+
+// Encodes a frame into the writer, as it would appear on the wire.
+void Encode(uint64_t address, ConstByteSpan payload, stream::Writer& out) {
+  ASSERT_EQ(OkStatus(), WriteUIFrame(address, payload, out));
+}
+
+bool Equal(ConstByteSpan a, ConstByteSpan b) {
+  return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+class FailingWriter : public stream::Writer {
+ private:
+  Status DoWrite(ConstByteSpan) override { return Status::Unavailable(); }
+};
+
+class CutThroughRouterTest : public ::testing::Test {
+ protected:
+  CutThroughRouterTest()
+      : buffer_a_{},
+        buffer_b_{},
+        output_a_(buffer_a_),
+        output_b_(buffer_b_),
+        routes_{{
+            {kAddressA, output_a_},
+            {kAddressB, output_b_},
+        }},
+        router_(routes_) {}
+
+  std::array<std::byte, 128> buffer_a_;
+  std::array<std::byte, 128> buffer_b_;
+  stream::MemoryWriter output_a_;
+  stream::MemoryWriter output_b_;
+  std::array<CutThroughRouter::Route, 2> routes_;
+  CutThroughRouter router_;
+};
+
+TEST_F(CutThroughRouterTest, ForwardsFrameUnchanged) {
+  stream::MemoryWriterBuffer<64> frame;
+  Encode(kAddressA, std::as_bytes(std::span("hello")), frame);
+
+  router_.Process(frame.WrittenData());
+
+  EXPECT_TRUE(Equal(output_a_.WrittenData(), frame.WrittenData()));
+  EXPECT_EQ(output_b_.bytes_written(), 0u);
+  EXPECT_EQ(router_.forwarded_frames(), 1u);
+  EXPECT_EQ(router_.fcs_errors(), 0u);
+}
+
+TEST_F(CutThroughRouterTest, RoutesByAddress) {
+  stream::MemoryWriterBuffer<64> frame_a;
+  stream::MemoryWriterBuffer<64> frame_b;
+  stream::MemoryWriterBuffer<128> input;
+  Encode(kAddressA, std::as_bytes(std::span("to a")), frame_a);
+  Encode(kAddressB, std::as_bytes(std::span("to b")), frame_b);
+  ASSERT_EQ(OkStatus(), input.Write(frame_a.WrittenData()));
+  ASSERT_EQ(OkStatus(), input.Write(frame_b.WrittenData()));
+
+  router_.Process(input.WrittenData());
+
+  EXPECT_TRUE(Equal(output_a_.WrittenData(), frame_a.WrittenData()));
+  EXPECT_TRUE(Equal(output_b_.WrittenData(), frame_b.WrittenData()));
+  EXPECT_EQ(router_.forwarded_frames(), 2u);
+}
+
+TEST_F(CutThroughRouterTest, ForwardsFrameSplitAcrossCalls) {
+  stream::MemoryWriterBuffer<64> frame;
+  Encode(kAddressB, std::as_bytes(std::span("split up")), frame);
+
+  for (std::byte b : frame.WrittenData()) {
+    router_.Process(std::span(&b, 1));
+  }
+
+  EXPECT_TRUE(Equal(output_b_.WrittenData(), frame.WrittenData()));
+  EXPECT_EQ(router_.forwarded_frames(), 1u);
+}
+
+TEST_F(CutThroughRouterTest, ForwardsBeforeFrameEnds) {
+  stream::MemoryWriterBuffer<64> frame;
+  Encode(kAddressA, std::as_bytes(std::span("payload")), frame);
+  ConstByteSpan data = frame.WrittenData();
+
+  // The address and control fields are enough to start forwarding.
+  router_.Process(data.first(4));
+  EXPECT_TRUE(Equal(output_a_.WrittenData(), data.first(4)));
+  EXPECT_EQ(router_.forwarded_frames(), 0u);
+
+  router_.Process(data.subspan(4));
+  EXPECT_TRUE(Equal(output_a_.WrittenData(), data));
+  EXPECT_EQ(router_.forwarded_frames(), 1u);
+}
+
+TEST_F(CutThroughRouterTest, EscapedAddress) {
+  // 0x3e encodes as 0x7d, which must be escaped.
+  std::array<std::byte, 128> buffer;
+  stream::MemoryWriter output(buffer);
+  const CutThroughRouter::Route routes[] = {{0x3e, output}};
+  CutThroughRouter router(routes);
+
+  stream::MemoryWriterBuffer<64> frame;
+  Encode(0x3e, std::as_bytes(std::span("escaped")), frame);
+  ASSERT_EQ(frame.WrittenData()[1], kEscape);
+
+  router.Process(frame.WrittenData());
+
+  EXPECT_TRUE(Equal(output.WrittenData(), frame.WrittenData()));
+  EXPECT_EQ(router.forwarded_frames(), 1u);
+}
+
+TEST_F(CutThroughRouterTest, UnknownAddress_Dropped) {
+  stream::MemoryWriterBuffer<64> frame;
+  Encode(123, std::as_bytes(std::span("nowhere")), frame);
+
+  router_.Process(frame.WrittenData());
+
+  EXPECT_EQ(output_a_.bytes_written(), 0u);
+  EXPECT_EQ(output_b_.bytes_written(), 0u);
+  EXPECT_EQ(router_.route_errors(), 1u);
+  EXPECT_EQ(router_.forwarded_frames(), 0u);
+}
+
+TEST_F(CutThroughRouterTest, BadFcs_ForwardedAndCounted) {
+  stream::MemoryWriterBuffer<64> frame;
+  Encode(kAddressA, std::as_bytes(std::span("corrupt")), frame);
+  std::array<std::byte, 64> corrupted;
+  ConstByteSpan data = frame.WrittenData();
+  std::copy(data.begin(), data.end(), corrupted.begin());
+  corrupted[4] ^= std::byte{0x01};
+
+  router_.Process(std::span(corrupted).first(data.size()));
+
+  EXPECT_EQ(output_a_.bytes_written(), data.size());
+  EXPECT_EQ(router_.forwarded_frames(), 0u);
+  EXPECT_EQ(router_.fcs_errors(), 1u);
+}
+
+TEST_F(CutThroughRouterTest, RepeatedFlags_Ignored) {
+  router_.Process(bytes::Concat(kFlag, kFlag, kFlag));
+
+  EXPECT_EQ(output_a_.bytes_written(), 0u);
+  EXPECT_EQ(router_.forwarded_frames(), 0u);
+  EXPECT_EQ(router_.fcs_errors(), 0u);
+}
+
+TEST_F(CutThroughRouterTest, OutputFails_RestOfFrameDropped) {
+  FailingWriter failing;
+  const CutThroughRouter::Route routes[] = {{kAddressA, failing},
+                                            {kAddressB, output_b_}};
+  CutThroughRouter router(routes);
+
+  stream::MemoryWriterBuffer<64> frame_a;
+  stream::MemoryWriterBuffer<64> frame_b;
+  Encode(kAddressA, std::as_bytes(std::span("fails")), frame_a);
+  Encode(kAddressB, std::as_bytes(std::span("works")), frame_b);
+
+  router.Process(frame_a.WrittenData());
+  router.Process(frame_b.WrittenData());
+
+  EXPECT_EQ(router.egress_errors(), 1u);
+  EXPECT_EQ(router.forwarded_frames(), 1u);
+  EXPECT_TRUE(Equal(output_b_.WrittenData(), frame_b.WrittenData()));
+}
+
+}  // namespace
+}  // namespace pw::hdlc
@@ -14,6 +14,9 @@
 
 #include "pw_hdlc/decoder.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "pw_assert/check.h"
 #include "pw_bytes/endian.h"
 #include "pw_hdlc/internal/protocol.h"
@@ -99,6 +102,87 @@ Result<Frame> Decoder::Process(const byte new_byte) {
   PW_CRASH("Bad decoder state");
 }
 
+void Decoder::Process(ConstByteSpan data,
+                      FunctionRef<void(const Result<Frame>&)> callback) {
+  while (true) {
+    data = data.subspan(ProcessRun(data));
+    if (data.empty()) {
+      return;
+    }
+
+    const Result<Frame> result = Process(data.front());
+    data = data.subspan(1);
+    if (result.status() != Status::Unavailable()) {
+      callback(result);
+    }
+  }
+}
+
+namespace {
+
+// Returns the length of the data before the first occurrence of value, or the
+// size of the data if it does not contain value.
+size_t FindByte(ConstByteSpan data, byte value) {
+  const void* found = std::memchr(data.data(), int(value), data.size());
+  return found == nullptr ? data.size()
+                          : static_cast<const byte*>(found) - data.data();
+}
+
+}  // namespace
+
+size_t Decoder::ProcessRun(ConstByteSpan data) {
+  switch (state_) {
+    case State::kInterFrame: {
+      // Bytes before a flag are discarded, but counted.
+      const size_t run_size = FindByte(data, kFlag);
+      current_frame_size_ += run_size;
+      return run_size;
+    }
+    case State::kFrame: {
+      const size_t run_size =
+          FindByte(data.first(FindByte(data, kFlag)), kEscape);
+      AppendBytes(data.first(run_size));
+      return run_size;
+    }
+    case State::kFrameEscape:
+      return 0;
+  }
+  PW_CRASH("Bad decoder state");
+}
+
+void Decoder::AppendBytes(ConstByteSpan data) {
+  // Short runs are not worth the bookkeeping below.
+  if (data.size() < last_read_bytes_.size()) {
+    for (byte b : data) {
+      AppendByte(b);
+    }
+    return;
+  }
+
+  if (current_frame_size_ < max_size()) {
+    const size_t to_copy =
+        std::min(data.size(), max_size() - current_frame_size_);
+    std::memcpy(&buffer_[current_frame_size_], data.data(), to_copy);
+  }
+
+  // All bytes in the ring buffer are ejected, oldest first, followed by all
+  // but the last four bytes of the data. Until the ring buffer has filled, its
+  // bytes start at index 0.
+  if (current_frame_size_ >= last_read_bytes_.size()) {
+    fcs_.Update(std::span(last_read_bytes_).subspan(last_read_bytes_index_));
+  }
+  fcs_.Update(std::span(last_read_bytes_).first(last_read_bytes_index_));
+
+  const size_t ejected = data.size() - last_read_bytes_.size();
+  fcs_.Update(data.first(ejected));
+  std::memcpy(
+      last_read_bytes_.data(), &data[ejected], last_read_bytes_.size());
+  last_read_bytes_index_ = 0;
+
+  // Always increase size: if it is larger than the buffer, overflow occurred.
+  current_frame_size_ += data.size();
+}
+
 void Decoder::AppendByte(byte new_byte) {
   if (current_frame_size_ < max_size()) {
     buffer_[current_frame_size_] = new_byte;
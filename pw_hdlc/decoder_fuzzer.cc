@@ -0,0 +1,180 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file implements a fuzz test for the HDLC Decoder. The fuzz data is
+// decoded both one byte at a time and in bulk, which must produce the same
+// frames and errors.
+//
+// Random bytes rarely form a frame with a valid frame check sequence, so a
+// custom mutator keeps most inputs made of valid frames. It decodes the frames
+// in the input, changes one of them, and encodes them again with correct
+// escapes and frame check sequences.
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "pw_assert/assert.h"
+#include "pw_bytes/span.h"
+#include "pw_fuzzer/execution_timer.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_stream/memory_stream.h"
+
+extern "C" size_t LLVMFuzzerMutate(uint8_t* data, size_t size, size_t max_size);
+
+namespace pw::hdlc {
+namespace {
+
+// Large enough for most mutated frames, small enough that some overflow it.
+constexpr size_t kDecoderBufferSize = 256;
+
+// The maximum payload size created by the mutator.
+constexpr size_t kMaxPayloadSize = 300;
+
+// A decoded frame or decoding error.
+struct DecodeResult {
+  Status status;
+  uint64_t address = 0;
+  std::byte control{};
+  std::vector<std::byte> data;
+
+  bool operator==(const DecodeResult& other) const {
+    return status == other.status && address == other.address &&
+           control == other.control && data == other.data;
+  }
+};
+
+DecodeResult ToDecodeResult(const Result<Frame>& result) {
+  DecodeResult decoded{.status = result.status()};
+  if (result.ok()) {
+    decoded.address = result.value().address();
+    decoded.control = result.value().control();
+    decoded.data.assign(result.value().data().begin(),
+                        result.value().data().end());
+  }
+  return decoded;
+}
+
+struct UiFrame {
+  uint64_t address;
+  std::vector<std::byte> payload;
+};
+
+std::vector<UiFrame> DecodeFrames(ConstByteSpan data) {
+  std::vector<UiFrame> frames;
+  DecoderBuffer<kMaxPayloadSize + Frame::kMinSizeBytes> decoder;
+  decoder.Process(data, [&frames](const Result<Frame>& result) {
+    if (result.ok()) {
+      frames.push_back(UiFrame{
+          result.value().address(),
+          std::vector<std::byte>(result.value().data().begin(),
+                                 result.value().data().end())});
+    }
+  });
+  return frames;
+}
+
+// Returns a random address, with small addresses as likely as large ones.
+uint64_t RandomAddress(std::minstd_rand& random) {
+  const uint64_t value = (uint64_t(random()) << 32) | random();
+  return value >> (random() % 64);
+}
+
+std::vector<std::byte> RandomPayload(std::minstd_rand& random) {
+  std::vector<std::byte> payload(random() % 32);
+  for (std::byte& b : payload) {
+    b = std::byte(random());
+  }
+  return payload;
+}
+
+void MutatePayload(std::vector<std::byte>& payload) {
+  const size_t size = payload.size();
+  payload.resize(kMaxPayloadSize);
+  payload.resize(LLVMFuzzerMutate(
+      reinterpret_cast<uint8_t*>(payload.data()), size, payload.size()));
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  fuzzer::ScopedExecutionTimer timer(data, size);
+  const ConstByteSpan input = std::as_bytes(std::span(data, size));
+
+  std::vector<DecodeResult> byte_results;
+  DecoderBuffer<kDecoderBufferSize> byte_decoder;
+  for (std::byte b : input) {
+    const Result<Frame> result = byte_decoder.Process(b);
+    if (!result.status().IsUnavailable()) {
+      byte_results.push_back(ToDecodeResult(result));
+    }
+  }
+
+  std::vector<DecodeResult> bulk_results;
+  DecoderBuffer<kDecoderBufferSize> bulk_decoder;
+  bulk_decoder.Process(input, [&bulk_results](const Result<Frame>& result) {
+    bulk_results.push_back(ToDecodeResult(result));
+  });
+
+  PW_ASSERT(byte_results == bulk_results);
+  for (const DecodeResult& result : byte_results) {
+    PW_ASSERT(result.data.size() <= kDecoderBufferSize);
+  }
+  return 0;
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t* data,
+                                          size_t size,
+                                          size_t max_size,
+                                          unsigned int seed) {
+  std::minstd_rand random(seed);
+  std::vector<UiFrame> frames =
+      DecodeFrames(std::as_bytes(std::span(data, size)));
+
+  // Sometimes mutate the raw bytes instead, to explore invalid frames, bad
+  // escapes, and data between frames.
+  if (!frames.empty() && random() % 4 == 0) {
+    return LLVMFuzzerMutate(data, size, max_size);
+  }
+
+  switch (frames.empty() ? 0 : random() % 4) {
+    case 0:  // Add a frame.
+      frames.insert(frames.begin() + random() % (frames.size() + 1),
+                    UiFrame{RandomAddress(random), RandomPayload(random)});
+      break;
+    case 1:  // Remove a frame.
+      frames.erase(frames.begin() + random() % frames.size());
+      break;
+    case 2:  // Change a frame's address.
+      frames[random() % frames.size()].address = RandomAddress(random);
+      break;
+    case 3:  // Change a frame's payload.
+      MutatePayload(frames[random() % frames.size()].payload);
+      break;
+  }
+
+  // Writes stop when the output is full, which may leave a truncated frame.
+  stream::MemoryWriter writer(
+      std::as_writable_bytes(std::span(data, max_size)));
+  for (const UiFrame& frame : frames) {
+    if (!WriteUIFrame(frame.address, frame.payload, writer).ok()) {
+      break;
+    }
+  }
+  return writer.bytes_written();
+}
+
+}  // namespace pw::hdlc
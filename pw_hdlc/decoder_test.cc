@@ -16,10 +16,14 @@
 
 #include <array>
 #include <cstddef>
+#include <cstring>
 
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
+#include "pw_containers/vector.h"
+#include "pw_hdlc/encoder.h"
 #include "pw_hdlc/internal/protocol.h"
+#include "pw_stream/memory_stream.h"
 
 namespace pw::hdlc {
 namespace {
@@ -152,5 +156,131 @@ TEST(Decoder, TooLargeForBuffer_DecodesNextFrame) {
   EXPECT_EQ(OkStatus(), decoder.Process(kFlag).status());
 }
 
+// Records the results of decoding a stream, for comparing the span and
+// single-byte Process functions.
+struct DecodedFrame {
+  Status status;
+  uint64_t address;
+  size_t size;
+  std::array<byte, 64> data;
+};
+
+template <size_t kBufferSize>
+class DecodeBothWays {
+ public:
+  void Decode(ConstByteSpan stream) {
+    DecoderBuffer<kBufferSize> decoder;
+    for (byte b : stream) {
+      Record(decoder.Process(b), by_byte_);
+    }
+
+    DecoderBuffer<kBufferSize> span_decoder;
+    span_decoder.Process(stream, [this](const Result<Frame>& result) {
+      Record(result, by_span_);
+    });
+  }
+
+  void ExpectSameResults(size_t expected_frames) const {
+    ASSERT_EQ(expected_frames, by_byte_.size());
+    ASSERT_EQ(by_byte_.size(), by_span_.size());
+    for (size_t i = 0; i < by_byte_.size(); ++i) {
+      EXPECT_EQ(by_byte_[i].status, by_span_[i].status);
+      EXPECT_EQ(by_byte_[i].address, by_span_[i].address);
+      ASSERT_EQ(by_byte_[i].size, by_span_[i].size);
+      EXPECT_EQ(0,
+                std::memcmp(by_byte_[i].data.data(),
+                            by_span_[i].data.data(),
+                            by_byte_[i].size));
+    }
+  }
+
+  const Vector<DecodedFrame, 16>& results() const { return by_byte_; }
+
+ private:
+  static void Record(const Result<Frame>& result,
+                     Vector<DecodedFrame, 16>& frames) {
+    if (result.status() == Status::Unavailable()) {
+      return;
+    }
+    frames.emplace_back();
+    DecodedFrame& frame = frames.back();
+    frame.status = result.status();
+    frame.address = result.ok() ? result.value().address() : 0;
+    frame.size = result.ok() ? result.value().data().size() : 0;
+    if (result.ok()) {
+      std::memcpy(frame.data.data(), result.value().data().data(), frame.size);
+    }
+  }
+
+  Vector<DecodedFrame, 16> by_byte_;
+  Vector<DecodedFrame, 16> by_span_;
+};
+
+class ProcessSpan : public ::testing::Test {
+ protected:
+  ProcessSpan() : writer_(stream_) {}
+
+  void WriteFrame(uint64_t address, size_t size, size_t escape_every) {
+    std::array<byte, 64> payload;
+    for (size_t i = 0; i < size; ++i) {
+      payload[i] = (escape_every != 0u && i % escape_every == 0u)
+                       ? (i % 2 == 0u ? kFlag : kEscape)
+                       : byte(i + 1);
+    }
+    ASSERT_EQ(OkStatus(),
+              WriteUIFrame(address, std::span(payload).first(size), writer_));
+  }
+
+  void WriteRaw(ConstByteSpan data) {
+    ASSERT_EQ(OkStatus(), writer_.Write(data));
+  }
+
+  std::array<byte, 1024> stream_;
+  stream::MemoryWriter writer_;
+};
+
+TEST_F(ProcessSpan, ValidFrames_SameAsByteByByte) {
+  WriteFrame(1, 0, 0);
+  WriteFrame(2, 1, 0);
+  WriteFrame(3, 40, 0);
+  WriteFrame(4, 40, 7);
+  WriteFrame(0x7d, 64, 1);
+  WriteFrame(12345, 3, 2);
+
+  DecodeBothWays<80> decode;
+  decode.Decode(writer_.WrittenData());
+  decode.ExpectSameResults(6);
+  for (const DecodedFrame& frame : decode.results()) {
+    EXPECT_EQ(OkStatus(), frame.status);
+  }
+}
+
+TEST_F(ProcessSpan, InvalidFrames_SameAsByteByByte) {
+  WriteRaw(bytes::String("garbage before a frame"));
+  WriteFrame(1, 20, 0);
+  WriteRaw(bytes::String("~short~"));
+  WriteRaw(bytes::String("~123456789abcdef~"));  // Bad FCS
+  WriteRaw(bytes::String("~1234\x7d\x7d" "5678~"));  // Double escape
+  WriteRaw(bytes::String("~1234\x7d~"));                // Escaped flag
+  WriteFrame(2, 40, 5);
+
+  DecodeBothWays<80> decode;
+  decode.Decode(writer_.WrittenData());
+  decode.ExpectSameResults(7);
+}
+
+TEST_F(ProcessSpan, FrameTooLargeForBuffer_SameAsByteByByte) {
+  WriteFrame(1, 50, 0);
+  WriteFrame(1, 50, 3);
+  WriteFrame(1, 4, 0);
+
+  DecodeBothWays<16> decode;
+  decode.Decode(writer_.WrittenData());
+  decode.ExpectSameResults(3);
+  EXPECT_EQ(Status::ResourceExhausted(), decode.results()[0].status);
+  EXPECT_EQ(Status::ResourceExhausted(), decode.results()[1].status);
+  EXPECT_EQ(OkStatus(), decode.results()[2].status);
+}
+
 }  // namespace
 }  // namespace pw::hdlc
@@ -0,0 +1,65 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/demux.h"
+
+namespace pw::hdlc {
+
+Status Demux::Register(FrameHandler& handler) {
+  if (FindHandler(handler.address()) != nullptr) {
+    return Status::AlreadyExists();
+  }
+  handlers_.push_front(handler);
+  return OkStatus();
+}
+
+void Demux::Process(ConstByteSpan data) {
+  decoder_.Process(data,
+                   [this](const Result<Frame>& result) { Dispatch(result); });
+}
+
+Status Demux::ReadAndProcess(stream::Reader& reader, ByteSpan read_buffer) {
+  while (true) {
+    Result<ByteSpan> data = reader.Read(read_buffer);
+    if (!data.ok()) {
+      return data.status();
+    }
+    Process(data.value());
+  }
+}
+
+FrameHandler* Demux::FindHandler(uint64_t address) {
+  for (FrameHandler& handler : handlers_) {
+    if (handler.address() == address) {
+      return &handler;
+    }
+  }
+  return nullptr;
+}
+
+void Demux::Dispatch(const Result<Frame>& result) {
+  if (!result.ok()) {
+    decode_errors_ += 1;
+    return;
+  }
+
+  FrameHandler* handler = FindHandler(result.value().address());
+  if (handler == nullptr) {
+    unhandled_frames_ += 1;
+    return;
+  }
+  handler->HandleFrame(result.value());
+}
+
+}  // namespace pw::hdlc
@@ -0,0 +1,152 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/demux.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::hdlc {
+namespace {
+
+class RecordingHandler : public FrameHandler {
+ public:
+  constexpr RecordingHandler(uint64_t address)
+      : FrameHandler(address), frames_(0), last_{}, last_size_(0) {}
+
+  void HandleFrame(const Frame& frame) override {
+    frames_ += 1;
+    last_size_ = frame.data().size();
+    std::memcpy(last_.data(), frame.data().data(), last_size_);
+  }
+
+  int frames() const { return frames_; }
+
+  std::string_view last() const {
+    return std::string_view(reinterpret_cast<const char*>(last_.data()),
+                            last_size_);
+  }
+
+ private:
+  int frames_;
+  std::array<std::byte, 64> last_;
+  size_t last_size_;
+};
+
+// Appends an encoded frame to the writer.
+void Encode(uint64_t address, std::string_view data, stream::Writer& out) {
+  ASSERT_EQ(OkStatus(),
+            WriteUIFrame(address, std::as_bytes(std::span(data)), out));
+}
+
+class DemuxTest : public ::testing::Test {
+ protected:
+  DemuxTest() : buffer_{}, demux_(buffer_), rpc_(1), logs_(2) {
+    EXPECT_EQ(OkStatus(), demux_.Register(rpc_));
+    EXPECT_EQ(OkStatus(), demux_.Register(logs_));
+  }
+
+  std::array<std::byte, 64> buffer_;
+  Demux demux_;
+  RecordingHandler rpc_;
+  RecordingHandler logs_;
+  stream::MemoryWriterBuffer<256> input_;
+};
+
+TEST_F(DemuxTest, DispatchesByAddress) {
+  Encode(1, "rpc packet", input_);
+  Encode(2, "log entry", input_);
+  Encode(1, "another rpc", input_);
+
+  demux_.Process(input_.WrittenData());
+
+  EXPECT_EQ(rpc_.frames(), 2);
+  EXPECT_EQ(rpc_.last(), "another rpc");
+  EXPECT_EQ(logs_.frames(), 1);
+  EXPECT_EQ(logs_.last(), "log entry");
+  EXPECT_EQ(demux_.unhandled_frames(), 0u);
+  EXPECT_EQ(demux_.decode_errors(), 0u);
+}
+
+TEST_F(DemuxTest, FrameSplitAcrossCalls) {
+  Encode(2, "split", input_);
+
+  for (std::byte b : input_.WrittenData()) {
+    demux_.Process(std::span(&b, 1));
+  }
+
+  EXPECT_EQ(logs_.frames(), 1);
+  EXPECT_EQ(logs_.last(), "split");
+}
+
+TEST_F(DemuxTest, UnhandledAddress_Counted) {
+  Encode(3, "nobody", input_);
+
+  demux_.Process(input_.WrittenData());
+
+  EXPECT_EQ(rpc_.frames(), 0);
+  EXPECT_EQ(logs_.frames(), 0);
+  EXPECT_EQ(demux_.unhandled_frames(), 1u);
+}
+
+TEST_F(DemuxTest, FrameTooLarge_Counted) {
+  const std::array<char, 80> large{};
+  Encode(1, std::string_view(large.data(), large.size()), input_);
+  Encode(1, "fits", input_);
+
+  demux_.Process(input_.WrittenData());
+
+  EXPECT_EQ(demux_.decode_errors(), 1u);
+  EXPECT_EQ(rpc_.frames(), 1);
+  EXPECT_EQ(rpc_.last(), "fits");
+}
+
+TEST_F(DemuxTest, Register_DuplicateAddress) {
+  RecordingHandler duplicate(1);
+  EXPECT_EQ(Status::AlreadyExists(), demux_.Register(duplicate));
+}
+
+TEST_F(DemuxTest, Unregister) {
+  demux_.Unregister(logs_);
+  Encode(2, "log entry", input_);
+
+  demux_.Process(input_.WrittenData());
+
+  EXPECT_EQ(logs_.frames(), 0);
+  EXPECT_EQ(demux_.unhandled_frames(), 1u);
+
+  RecordingHandler new_logs(2);
+  EXPECT_EQ(OkStatus(), demux_.Register(new_logs));
+  demux_.Unregister(new_logs);
+}
+
+TEST_F(DemuxTest, ReadAndProcess) {
+  Encode(1, "rpc packet", input_);
+  Encode(2, "log entry", input_);
+  stream::MemoryReader reader(input_.WrittenData());
+  std::array<std::byte, 7> read_buffer;
+
+  EXPECT_EQ(Status::OutOfRange(), demux_.ReadAndProcess(reader, read_buffer));
+
+  EXPECT_EQ(rpc_.frames(), 1);
+  EXPECT_EQ(logs_.frames(), 1);
+}
+
+}  // namespace
+}  // namespace pw::hdlc
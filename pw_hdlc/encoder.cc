@@ -22,40 +22,109 @@
 
 #include "pw_bytes/endian.h"
 #include "pw_hdlc/internal/encoder.h"
+#include "pw_status/try.h"
 #include "pw_varint/varint.h"
 
 using std::byte;
 
 namespace pw::hdlc {
 namespace internal {
-
-Status EscapeAndWrite(const byte b, stream::Writer& writer) {
-  if (b == kFlag) {
-    return writer.Write(kEscapedFlag);
+namespace {
+
+// Returns a pointer to the first byte in [begin, end) that needs escaping, or
+// end if there is none. Bytes that need escaping are rare in most data, so this
+// checks a word at a time and only checks individual bytes in the word with the
+// match.
+const byte* FindByteToEscape(const byte* begin, const byte* end) {
+  using Word = size_t;
+  constexpr Word kOnes = ~Word{0} / 0xFF;  // 0x01 in every byte
+  constexpr Word kHighBits = kOnes * 0x80;
+  constexpr Word kFlags = kOnes * static_cast<uint8_t>(kFlag);
+  constexpr Word kEscapes = kOnes * static_cast<uint8_t>(kEscape);
+
+  for (; static_cast<size_t>(end - begin) >= sizeof(Word);
+       begin += sizeof(Word)) {
+    Word word;
+    std::memcpy(&word, begin, sizeof(word));
+
+    // A byte of word ^ kFlags is zero where the word has a flag. The expression
+    // (x - kOnes) & ~x sets the high bit of some byte if and only if x has a
+    // zero byte.
+    const Word flags = word ^ kFlags;
+    const Word escapes = word ^ kEscapes;
+    if ((((flags - kOnes) & ~flags) | ((escapes - kOnes) & ~escapes)) &
+        kHighBits) {
+      break;
+    }
   }
-  if (b == kEscape) {
-    return writer.Write(kEscapedEscape);
+
+  return std::find_if(begin, end, NeedsEscaping);
+}
+
+size_t CountBytesToEscape(ConstByteSpan data) {
+  const byte* const end = data.data() + data.size();
+  size_t count = 0;
+
+  for (const byte* b = FindByteToEscape(data.data(), end); b != end;
+       b = FindByteToEscape(b + 1, end)) {
+    count += 1;
   }
-  return writer.Write(b);
+  return count;
 }
 
-Status Encoder::WriteData(ConstByteSpan data) {
-  auto begin = data.begin();
-  while (true) {
-    auto end = std::find_if(begin, data.end(), NeedsEscaping);
+}  // namespace
 
-    if (Status status = writer_.Write(std::span(begin, end)); !status.ok()) {
-      return status;
+Status Encoder::WriteData(ConstByteSpan data) {
+  // Short runs and escaped bytes are collected in this buffer, so that data
+  // with many escapes does not require a write for every run. Runs that do not
+  // fit are written along with the buffer in one vectored write.
+  std::array<byte, 32> buffer;
+  size_t buffered = 0;
+
+  auto flush = [&]() {
+    const Status status = writer_.Write(std::span(buffer).first(buffered));
+    buffered = 0;
+    return status;
+  };
+
+  const byte* begin = data.data();
+  const byte* const end = begin + data.size();
+
+  while (begin != end) {
+    const byte* const run_end = FindByteToEscape(begin, end);
+    const size_t run_size = run_end - begin;
+
+    // The FCS is calculated over the unescaped data, including the byte that is
+    // escaped, while the data is in cache.
+    fcs_.Update(std::span(begin, run_end == end ? run_end : run_end + 1));
+
+    if (run_size >= buffer.size()) {
+      // Write the buffered bytes and the run with a single vectored write.
+      const std::array<ConstByteSpan, 2> chunks = {
+          std::span(buffer).first(buffered), std::span(begin, run_end)};
+      buffered = 0;
+      PW_TRY(writer_.Write(std::span(chunks)));
+    } else {
+      if (run_size > buffer.size() - buffered) {
+        PW_TRY(flush());
+      }
+      std::copy(begin, run_end, buffer.begin() + buffered);
+      buffered += run_size;
     }
-    if (end == data.end()) {
-      fcs_.Update(data);
-      return OkStatus();
+
+    if (run_end == end) {
+      break;
     }
-    if (Status status = EscapeAndWrite(*end, writer_); !status.ok()) {
-      return status;
+
+    if (buffer.size() - buffered < kEscapedFlag.size()) {
+      PW_TRY(flush());
     }
-    begin = end + 1;
+    buffer[buffered++] = kEscape;
+    buffer[buffered++] = Escape(*run_end);
+    begin = run_end + 1;
   }
+
+  return buffered == 0u ? OkStatus() : flush();
 }
 
 Status Encoder::FinishFrame() {
@@ -71,8 +140,7 @@ size_t Encoder::MaxEncodedSize(uint64_t address, ConstByteSpan payload) {
   constexpr size_t kFcsMaxSize = 8;  // Worst case FCS: 0x7e7e7e7e.
   size_t max_encoded_address_size = varint::EncodedSize(address) * 2;
   size_t encoded_payload_size =
-      payload.size() +
-      std::count_if(payload.begin(), payload.end(), NeedsEscaping);
+      payload.size() + CountBytesToEscape(payload);
 
   return max_encoded_address_size + sizeof(kUnusedControl) +
          encoded_payload_size + kFcsMaxSize;
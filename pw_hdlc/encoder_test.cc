@@ -20,6 +20,7 @@
 
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
+#include "pw_hdlc/decoder.h"
 #include "pw_hdlc/internal/encoder.h"
 #include "pw_hdlc/internal/protocol.h"
 #include "pw_stream/memory_stream.h"
@@ -181,6 +182,42 @@ TEST_F(WriteUnnumberedFrame, PayloadTooLarge_WritesNothing) {
   EXPECT_EQ(0u, writer_.bytes_written());
 }
 
+// Checks escaping at every position in the data, relative to word boundaries
+// and to the encoder's internal buffer, by decoding the encoded frame.
+TEST(WriteUnnumberedFrame, EscapesAtEveryOffset_RoundTrip) {
+  std::array<byte, 80> payload;
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = byte(i);
+  }
+
+  for (size_t escape = 0; escape < payload.size(); ++escape) {
+    for (size_t size = 1; size <= payload.size(); ++size) {
+      // Put flags and escapes at several positions to mix short and long runs.
+      std::array<byte, 80> data = payload;
+      data[escape] = kFlag;
+      data[(escape * 7) % size] = kEscape;
+      const auto input = std::span(data).first(size);
+
+      std::array<byte, 2 * 80 + 16> buffer;
+      stream::MemoryWriter writer(buffer);
+      ASSERT_EQ(OkStatus(), WriteUIFrame(kAddress, input, writer));
+      DecoderBuffer<96> decoder;
+      size_t frames = 0;
+      for (byte b : writer.WrittenData()) {
+        Result<Frame> frame = decoder.Process(b);
+        if (frame.ok()) {
+          frames += 1;
+          EXPECT_EQ(kAddress, frame.value().address());
+          ASSERT_EQ(size, frame.value().data().size());
+          EXPECT_EQ(0,
+                    std::memcmp(input.data(), frame.value().data().data(), size));
+        }
+      }
+      EXPECT_EQ(1u, frames);
+    }
+  }
+}
+
 class ErrorWriter : public stream::Writer {
  private:
   Status DoWrite(ConstByteSpan) override { return Status::Unimplemented(); }
@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_function/function_ref.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_varint/varint.h"
+
+namespace pw::hdlc {
+
+// COBS (Consistent Overhead Byte Stuffing) framing, an alternative to HDLC
+// byte stuffing for fast links. A COBS frame carries the same contents as an
+// HDLC UI-frame (address, control byte, payload, and CRC-32 frame check
+// sequence), so decoded frames are the same Frame class, but the contents are
+// encoded with COBS and delimited by zero bytes:
+//
+//   - Delimiter (0x00)
+//   - COBS-encoded address, control, payload, and frame check sequence
+//   - Delimiter (0x00)
+//
+// COBS removes the zero bytes by splitting the data into blocks. Each block
+// starts with a code byte that gives the offset of the next zero, which is
+// dropped from the data. A code of 0xFF marks a block of 254 non-zero bytes
+// that is not followed by a zero. The overhead is at most one byte per 254
+// bytes, plus one, where HDLC escaping can double the size of the data.
+inline constexpr std::byte kCobsDelimiter = std::byte{0x00};
+
+// Writes a COBS-framed UI-frame to the provided writer.
+Status WriteCobsUIFrame(uint64_t address,
+                        ConstByteSpan payload,
+                        stream::Writer& writer);
+
+// The largest size of an encoded COBS frame with the given payload size, for
+// sizing buffers.
+constexpr size_t MaxCobsEncodedFrameSize(size_t payload_size) {
+  constexpr size_t kDelimitersSize = 2;
+  constexpr size_t kControlSize = 1;
+  constexpr size_t kFcsSize = sizeof(uint32_t);
+  const size_t contents_size =
+      varint::kMaxVarint64SizeBytes + kControlSize + payload_size + kFcsSize;
+  return kDelimitersSize + contents_size + contents_size / 254 + 1;
+}
+
+// Decodes COBS frames, with the same interface as Decoder. Data between code
+// bytes is copied in bulk, so Process(ConstByteSpan, ...) only examines the
+// code bytes and delimiters individually.
+//
+// The frame check sequence is verified once a frame is complete. Frames that
+// are too large for the buffer are reported as RESOURCE_EXHAUSTED without
+// verifying the frame check sequence.
+class CobsDecoder {
+ public:
+  constexpr CobsDecoder(ByteSpan buffer)
+      : buffer_(buffer),
+        current_frame_size_(0),
+        block_remaining_(0),
+        zero_pending_(false) {}
+
+  CobsDecoder(const CobsDecoder&) = delete;
+  CobsDecoder& operator=(const CobsDecoder&) = delete;
+
+  // Parses a single byte of a COBS stream. Returns the same statuses as
+  // Decoder::Process.
+  Result<Frame> Process(std::byte b);
+
+  // Processes a span of data and calls the provided callback with each frame or
+  // error.
+  void Process(ConstByteSpan data,
+               FunctionRef<void(const Result<Frame>&)> callback);
+
+  // Returns the maximum size of the decoder's frame buffer.
+  size_t max_size() const { return buffer_.size(); }
+
+  // Clears and resets the decoder.
+  void Clear() { Reset(); }
+
+ private:
+  void Reset() {
+    current_frame_size_ = 0;
+    block_remaining_ = 0;
+    zero_pending_ = false;
+  }
+
+  Result<Frame> FinishFrame();
+
+  void StartBlock(std::byte code);
+
+  void AppendBytes(ConstByteSpan data);
+
+  const ByteSpan buffer_;
+
+  // Size of the decoded frame so far. This may exceed the buffer's size, in
+  // which case the frame overflowed.
+  size_t current_frame_size_;
+
+  // Number of data bytes left in the current block. A code byte is next when
+  // this is zero.
+  uint8_t block_remaining_;
+
+  // Whether the current block is followed by a zero. The zero is appended when
+  // the next block starts, since the last block in a frame has no zero.
+  bool zero_pending_;
+};
+
+// CobsDecoderBuffers declare a buffer along with a CobsDecoder.
+template <size_t kSizeBytes>
+class CobsDecoderBuffer : public CobsDecoder {
+ public:
+  CobsDecoderBuffer() : CobsDecoder(frame_buffer_) {}
+
+  // Returns the maximum length of the bytes that can be inserted in the bytes
+  // buffer.
+  static constexpr size_t max_size() { return kSizeBytes; }
+
+ private:
+  static_assert(kSizeBytes >= Frame::kMinSizeBytes);
+
+  std::array<std::byte, kSizeBytes> frame_buffer_;
+};
+
+}  // namespace pw::hdlc
@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::hdlc {
+
+// Routes HDLC frames from a byte stream to output streams by their address,
+// without decoding and re-encoding them.
+//
+// WirePacketParser needs a complete frame before it can be routed, so the
+// frame has to be buffered. CutThroughRouter instead reads the address from
+// the first bytes of each frame, then forwards the frame's escaped wire bytes
+// to the route's output as they are processed, starting with the opening flag.
+// Only the bytes before the address is known are copied.
+//
+// The frame check sequence is verified as the frame passes through, but the
+// frame has already been forwarded by the time it is checked. Since the bytes
+// are forwarded unchanged, the receiver also rejects a corrupt frame; the
+// router counts it in fcs_errors().
+//
+// Frames with no route are dropped. If an output fails to write, the rest of
+// the frame is dropped; the receiver rejects the truncated frame.
+class CutThroughRouter {
+ public:
+  struct Route {
+    uint64_t address;
+    stream::Writer& output;
+  };
+
+  constexpr CutThroughRouter(std::span<const Route> routes)
+      : routes_(routes),
+        decoder_buffer_{},
+        decoder_(decoder_buffer_),
+        pending_{},
+        address_{},
+        state_(State::kInterFrame),
+        pending_size_(0),
+        address_size_(0),
+        escape_(false),
+        output_(nullptr),
+        forwarded_frames_(0),
+        route_errors_(0),
+        fcs_errors_(0),
+        egress_errors_(0) {}
+
+  CutThroughRouter(const CutThroughRouter&) = delete;
+  CutThroughRouter& operator=(const CutThroughRouter&) = delete;
+
+  // Processes bytes from the input stream, forwarding frames as their
+  // addresses are read.
+  void Process(ConstByteSpan data);
+
+  // Frames forwarded with a valid frame check sequence.
+  uint32_t forwarded_frames() const { return forwarded_frames_; }
+
+  // Frames dropped because there was no route for their address.
+  uint32_t route_errors() const { return route_errors_; }
+
+  // Frames that were invalid, including ones forwarded before the frame check
+  // sequence failed.
+  uint32_t fcs_errors() const { return fcs_errors_; }
+
+  // Frames that an output failed to write.
+  uint32_t egress_errors() const { return egress_errors_; }
+
+ private:
+  enum class State {
+    kInterFrame,  // Waiting for a flag.
+    kAddress,     // Reading the address of a frame.
+    kForwarding,  // Writing the frame to output_.
+    kDiscarding,  // Dropping the rest of the frame.
+  };
+
+  // Processes bytes that contain no flags.
+  void ProcessFrameBytes(ConstByteSpan data);
+
+  // Handles a flag, which ends the current frame and starts the next one.
+  void EndFrame(Status frame_status);
+
+  // Adds a wire byte to the frame's address. Returns true when the address is
+  // complete.
+  bool AddAddressByte(std::byte b);
+
+  // Looks up the route for the frame's address and starts forwarding to it.
+  void StartForwarding();
+
+  // Writes bytes to the current route, discarding the frame if it fails.
+  void Forward(ConstByteSpan data);
+
+  const Route* FindRoute(uint64_t address) const;
+
+  // A varint address is at most 10 bytes, each of which may be escaped.
+  static constexpr size_t kMaxAddressBytes = 10;
+
+  const std::span<const Route> routes_;
+
+  // Only used to check the frame check sequence, so the buffer is too small to
+  // hold frames.
+  std::array<std::byte, Frame::kMinSizeBytes> decoder_buffer_;
+  Decoder decoder_;
+
+  // The wire bytes of the current frame before its address is known.
+  std::array<std::byte, 2 * kMaxAddressBytes> pending_;
+  // The unescaped address bytes.
+  std::array<std::byte, kMaxAddressBytes> address_;
+
+  State state_;
+  size_t pending_size_;
+  size_t address_size_;
+  bool escape_;
+  stream::Writer* output_;
+
+  uint32_t forwarded_frames_;
+  uint32_t route_errors_;
+  uint32_t fcs_errors_;
+  uint32_t egress_errors_;
+};
+
+}  // namespace pw::hdlc
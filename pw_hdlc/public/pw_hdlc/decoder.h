@@ -17,11 +17,11 @@
 #include <array>
 #include <cstddef>
 #include <cstring>
-#include <functional>  // std::invoke
 
 #include "pw_assert/assert.h"
 #include "pw_bytes/span.h"
 #include "pw_checksum/crc32.h"
+#include "pw_function/function_ref.h"
 #include "pw_result/result.h"
 #include "pw_status/status.h"
 
@@ -96,17 +96,10 @@ class Decoder {
   Result<Frame> Process(std::byte b);
 
   // Processes a span of data and calls the provided callback with each frame or
-  // error.
-  template <typename F, typename... Args>
-  void Process(ConstByteSpan data, F&& callback, Args&&... args) {
-    for (std::byte b : data) {
-      auto result = Process(b);
-      if (result.status() != Status::Unavailable()) {
-        std::invoke(
-            std::forward<F>(callback), std::forward<Args>(args)..., result);
-      }
-    }
-  }
+  // error. Produces the same results as calling Process for each byte, but
+  // handles runs of bytes without flags or escapes in bulk.
+  void Process(ConstByteSpan data,
+               FunctionRef<void(const Result<Frame>&)> callback);
 
   // Returns the maximum size of the Decoder's frame buffer.
   size_t max_size() const { return buffer_.size(); }
@@ -131,8 +124,14 @@ class Decoder {
     fcs_.clear();
   }
 
+  // Processes bytes from the start of the data that cannot change the state or
+  // complete a frame. Returns the number of bytes processed, which may be 0.
+  size_t ProcessRun(ConstByteSpan data);
+
   void AppendByte(std::byte new_byte);
 
+  void AppendBytes(ConstByteSpan data);
+
   Status CheckFrame() const;
 
   bool VerifyFrameCheckSequence() const;
@@ -0,0 +1,98 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::hdlc {
+
+// Receives the frames sent to one HDLC address. Register handlers with a
+// Demux.
+class FrameHandler : public IntrusiveList<FrameHandler>::Item {
+ public:
+  FrameHandler(const FrameHandler&) = delete;
+  FrameHandler& operator=(const FrameHandler&) = delete;
+
+  virtual ~FrameHandler() = default;
+
+  uint64_t address() const { return address_; }
+
+  // Called for each valid frame sent to this handler's address. The frame's
+  // data is only valid until HandleFrame returns, so handlers that keep it must
+  // copy it to their own buffer.
+  virtual void HandleFrame(const Frame& frame) = 0;
+
+ protected:
+  constexpr FrameHandler(uint64_t address) : address_(address) {}
+
+ private:
+  const uint64_t address_;
+};
+
+// Decodes an HDLC stream once and dispatches each frame to the handler
+// registered for its address, so one link can carry RPC, logs, and other data
+// without a decode loop per protocol.
+//
+// Frames are decoded into a single buffer, which must be large enough for the
+// largest frame on the link, and handlers are called synchronously as each
+// frame completes.
+class Demux {
+ public:
+  constexpr Demux(ByteSpan decode_buffer)
+      : decoder_(decode_buffer),
+        unhandled_frames_(0),
+        decode_errors_(0) {}
+
+  Demux(const Demux&) = delete;
+  Demux& operator=(const Demux&) = delete;
+
+  // Registers a handler for its address. Returns ALREADY_EXISTS if another
+  // handler is registered for that address.
+  Status Register(FrameHandler& handler);
+
+  // Removes a registered handler.
+  void Unregister(FrameHandler& handler) { handlers_.remove(handler); }
+
+  // Decodes data and dispatches the frames it completes.
+  void Process(ConstByteSpan data);
+
+  // Reads from the reader into read_buffer and processes the data until a read
+  // fails, then returns the read's status.
+  Status ReadAndProcess(stream::Reader& reader, ByteSpan read_buffer);
+
+  // Valid frames sent to addresses with no handler.
+  uint32_t unhandled_frames() const { return unhandled_frames_; }
+
+  // Frames that were invalid or too large for the decode buffer.
+  uint32_t decode_errors() const { return decode_errors_; }
+
+ private:
+  FrameHandler* FindHandler(uint64_t address);
+
+  void Dispatch(const Result<Frame>& result);
+
+  Decoder decoder_;
+  IntrusiveList<FrameHandler> handlers_;
+
+  uint32_t unhandled_frames_;
+  uint32_t decode_errors_;
+};
+
+}  // namespace pw::hdlc
@@ -13,9 +13,12 @@
 // the License.
 #pragma once
 
+#include <cstddef>
+
 #include "pw_bytes/span.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
+#include "pw_varint/varint.h"
 
 namespace pw::hdlc {
 
@@ -33,4 +36,14 @@ Status WriteUIFrame(uint64_t address,
                     ConstByteSpan payload,
                     stream::Writer& writer);
 
+// The largest size of an encoded UI-frame with the given payload size, for
+// sizing buffers. Assumes every byte after the opening flag is escaped.
+constexpr size_t MaxEncodedFrameSize(size_t payload_size) {
+  constexpr size_t kFlagsSize = 2;
+  constexpr size_t kControlSize = 1;
+  constexpr size_t kFcsSize = sizeof(uint32_t);
+  return kFlagsSize + 2 * (varint::kMaxVarint64SizeBytes + kControlSize +
+                           payload_size + kFcsSize);
+}
+
 }  // namespace pw::hdlc
@@ -17,8 +17,11 @@
 #include <span>
 
 #include "pw_assert/assert.h"
+#include "pw_hdlc/cobs.h"
 #include "pw_hdlc/encoder.h"
 #include "pw_rpc/channel.h"
+#include "pw_status/try.h"
+#include "pw_stream/memory_stream.h"
 #include "pw_stream/stream.h"
 
 namespace pw::hdlc {
@@ -86,4 +89,158 @@ class RpcChannelOutputBuffer : public rpc::ChannelOutput {
   const uint64_t address_;
 };
 
+// ChannelOutput that sends packets as COBS frames instead of HDLC frames. See
+// pw_hdlc/cobs.h.
+//
+// WARNING: This ChannelOutput is not thread-safe. If thread-safety is required,
+// wrap this in a pw::rpc::SynchronizedChannelOutput.
+class CobsRpcChannelOutput : public rpc::ChannelOutput {
+ public:
+  constexpr CobsRpcChannelOutput(stream::Writer& writer,
+                                 std::span<std::byte> buffer,
+                                 uint64_t address,
+                                 const char* channel_name)
+      : ChannelOutput(channel_name),
+        writer_(writer),
+        buffer_(buffer),
+        address_(address) {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    PW_DASSERT(buffer.data() == buffer_.data());
+    if (buffer.empty()) {
+      return OkStatus();
+    }
+    return hdlc::WriteCobsUIFrame(address_, buffer, writer_);
+  }
+
+ private:
+  stream::Writer& writer_;
+  const std::span<std::byte> buffer_;
+  const uint64_t address_;
+};
+
+// CobsRpcChannelOutput with its own buffer.
+//
+// WARNING: This ChannelOutput is not thread-safe. If thread-safety is required,
+// wrap this in a pw::rpc::SynchronizedChannelOutput.
+template <size_t kBufferSize>
+class CobsRpcChannelOutputBuffer : public CobsRpcChannelOutput {
+ public:
+  constexpr CobsRpcChannelOutputBuffer(stream::Writer& writer,
+                                       uint64_t address,
+                                       const char* channel_name)
+      : CobsRpcChannelOutput(writer, buffer_, address, channel_name),
+        buffer_{} {}
+
+ private:
+  std::array<std::byte, kBufferSize> buffer_;
+};
+
+// Sends data in the background, typically with a DMA-driven UART.
+class DmaWriter {
+ public:
+  virtual ~DmaWriter() = default;
+
+  // Starts sending data and returns without waiting for it to be sent. The data
+  // stays valid until WaitUntilIdle() returns. Only called while idle.
+  virtual Status StartWrite(ConstByteSpan data) = 0;
+
+  // Blocks until the write started by StartWrite() completes, and returns its
+  // status.
+  virtual Status WaitUntilIdle() = 0;
+};
+
+// HDLC ChannelOutput that overlaps encoding RPC packets with sending them.
+//
+// Each packet is encoded into one of two TX buffers, which is handed to a
+// DmaWriter. SendAndReleaseBuffer returns as soon as the write has started, so
+// the RPC layer can encode the next packet into the buffer from AcquireBuffer
+// while the frame is sent. The next SendAndReleaseBuffer encodes into the other
+// TX buffer and only then waits for the previous frame to finish.
+//
+// Writes complete in the background, so a failed write is reported by the next
+// SendAndReleaseBuffer or Flush call.
+//
+// WARNING: This ChannelOutput is not thread-safe. If thread-safety is required,
+// wrap this in a pw::rpc::SynchronizedChannelOutput.
+class DoubleBufferedRpcChannelOutput : public rpc::ChannelOutput {
+ public:
+  // The TX buffers must hold an encoded frame of the largest packet; see
+  // MaxEncodedFrameSize.
+  constexpr DoubleBufferedRpcChannelOutput(DmaWriter& writer,
+                                           std::span<std::byte> buffer,
+                                           std::span<std::byte> tx_buffer_0,
+                                           std::span<std::byte> tx_buffer_1,
+                                           uint64_t address,
+                                           const char* channel_name)
+      : ChannelOutput(channel_name),
+        writer_(writer),
+        buffer_(buffer),
+        tx_buffers_{tx_buffer_0, tx_buffer_1},
+        address_(address),
+        next_tx_buffer_(0),
+        writing_(false) {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    PW_DASSERT(buffer.data() == buffer_.data());
+    if (buffer.empty()) {
+      return OkStatus();
+    }
+
+    // The other TX buffer may still be sending, so this one is free to use.
+    stream::MemoryWriter frame(tx_buffers_[next_tx_buffer_]);
+    PW_TRY(hdlc::WriteUIFrame(address_, buffer, frame));
+
+    const Status previous_write = Flush();
+    PW_TRY(writer_.StartWrite(frame.WrittenData()));
+    writing_ = true;
+    next_tx_buffer_ ^= 1;
+    return previous_write;
+  }
+
+  // Waits for the frame being sent, if any, and returns the write's status.
+  Status Flush() {
+    if (!writing_) {
+      return OkStatus();
+    }
+    writing_ = false;
+    return writer_.WaitUntilIdle();
+  }
+
+ private:
+  DmaWriter& writer_;
+  const std::span<std::byte> buffer_;
+  const std::array<std::span<std::byte>, 2> tx_buffers_;
+  const uint64_t address_;
+  uint8_t next_tx_buffer_;
+  bool writing_;
+};
+
+// DoubleBufferedRpcChannelOutput with its own buffers.
+template <size_t kBufferSize>
+class DoubleBufferedRpcChannelOutputBuffer
+    : public DoubleBufferedRpcChannelOutput {
+ public:
+  constexpr DoubleBufferedRpcChannelOutputBuffer(DmaWriter& writer,
+                                                 uint64_t address,
+                                                 const char* channel_name)
+      : DoubleBufferedRpcChannelOutput(writer,
+                                       buffer_,
+                                       tx_buffers_[0],
+                                       tx_buffers_[1],
+                                       address,
+                                       channel_name),
+        buffer_{},
+        tx_buffers_{} {}
+
+ private:
+  std::array<std::byte, kBufferSize> buffer_;
+  std::array<std::array<std::byte, MaxEncodedFrameSize(kBufferSize)>, 2>
+      tx_buffers_;
+};
+
 }  // namespace pw::hdlc
@@ -16,6 +16,7 @@
 #include <cstdint>
 
 #include "pw_hdlc/decoder.h"
+#include "pw_hdlc/demux.h"
 #include "pw_rpc/channel.h"
 #include "pw_rpc/server.h"
 #include "pw_status/status.h"
@@ -24,11 +25,30 @@ namespace pw::hdlc {
 
 inline constexpr uint8_t kDefaultRpcAddress = 'R';
 
-// Reads HDLC frames with sys_io::ReadByte, using decode_buffer to store frames.
+// Reads HDLC frames from sys_io, using decode_buffer to store frames. Bytes that
+// have already arrived are read and decoded in chunks with sys_io::TryReadBytes.
 // HDLC frames sent to rpc_address are passed to the RPC server.
 Status ReadAndProcessPackets(rpc::Server& server,
                              rpc::ChannelOutput& output,
                              std::span<std::byte> decode_buffer,
                              unsigned rpc_address = kDefaultRpcAddress);
 
+// Passes the frames sent to an HDLC address to an RPC server. Register it with
+// a Demux to serve RPCs on a link that carries other protocols too.
+class RpcFrameHandler final : public FrameHandler {
+ public:
+  constexpr RpcFrameHandler(rpc::Server& server,
+                            rpc::ChannelOutput& output,
+                            uint64_t rpc_address = kDefaultRpcAddress)
+      : FrameHandler(rpc_address), server_(server), output_(output) {}
+
+  void HandleFrame(const Frame& frame) override {
+    server_.ProcessPacket(frame.data(), output_);
+  }
+
+ private:
+  rpc::Server& server_;
+  rpc::ChannelOutput& output_;
+};
+
 }  // namespace pw::hdlc
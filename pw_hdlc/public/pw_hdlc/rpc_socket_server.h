@@ -0,0 +1,158 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <poll.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/rpc_packets.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/server.h"
+#include "pw_status/status.h"
+#include "pw_stream/socket_stream.h"
+
+namespace pw::hdlc {
+
+// Serves RPCs over HDLC to many socket connections from a single thread.
+//
+// RpcSocketServer listens on a port and waits on the listening socket and all
+// of its connections with poll(). Each connection has its own HDLC decoder and
+// channel output. Data that arrives on a connection is decoded, and frames sent
+// to the RPC address are passed to the RPC server, which replies on the same
+// connection.
+//
+// The RPC server routes packets by channel ID, so each client must use its own
+// channel ID. Dynamic channels are assigned to the connection that first uses
+// the ID.
+//
+// Use RpcSocketServerBuffer, which allocates the connections.
+class RpcSocketServer {
+ public:
+  // A client connection, which is also the RPC channel output for the client.
+  class Connection : public rpc::ChannelOutput {
+   public:
+    Connection(ByteSpan decode_buffer, ByteSpan packet_buffer)
+        : ChannelOutput("socket connection"),
+          decoder_(decode_buffer),
+          packet_buffer_(packet_buffer),
+          address_(kDefaultRpcAddress) {}
+
+    std::span<std::byte> AcquireBuffer() override { return packet_buffer_; }
+
+    Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override;
+
+   private:
+    friend class RpcSocketServer;
+
+    stream::SocketStream stream_;
+    Decoder decoder_;
+    const ByteSpan packet_buffer_;
+    uint64_t address_;
+  };
+
+  RpcSocketServer(const RpcSocketServer&) = delete;
+  RpcSocketServer& operator=(const RpcSocketServer&) = delete;
+
+  virtual ~RpcSocketServer() = default;
+
+  // Listens for connections on the port. If the port is 0, one is chosen; see
+  // port().
+  Status Listen(uint16_t port) { return listener_.Listen(port); }
+
+  uint16_t port() const { return listener_.port(); }
+
+  // Waits up to timeout_ms milliseconds (forever if negative) for activity,
+  // then accepts new connections and processes the data that has arrived.
+  // Returns an error if waiting fails.
+  Status Poll(int timeout_ms);
+
+  // Serves RPCs until polling fails.
+  Status Run();
+
+  size_t open_connections() const { return open_connections_; }
+
+  // Connections refused because all connections were in use.
+  uint32_t refused_connections() const { return refused_connections_; }
+
+  // Frames that failed to decode, across all connections.
+  uint32_t decode_errors() const { return decode_errors_; }
+
+ protected:
+  RpcSocketServer(rpc::Server& server,
+                  std::span<Connection> connections,
+                  std::span<struct pollfd> poll_fds,
+                  uint64_t rpc_address)
+      : server_(server),
+        connections_(connections),
+        poll_fds_(poll_fds),
+        rpc_address_(rpc_address),
+        open_connections_(0),
+        refused_connections_(0),
+        decode_errors_(0) {}
+
+ private:
+  void Accept();
+
+  // Reads and processes data from a connection. Closes it if reading fails.
+  void Service(Connection& connection);
+
+  void CloseConnection(Connection& connection);
+
+  rpc::Server& server_;
+  stream::ServerSocket listener_;
+  const std::span<Connection> connections_;
+  const std::span<struct pollfd> poll_fds_;
+  const uint64_t rpc_address_;
+
+  size_t open_connections_;
+  uint32_t refused_connections_;
+  uint32_t decode_errors_;
+};
+
+// RpcSocketServer with room for kMaxConnections connections. Each connection
+// has kBufferSize-byte buffers for decoding frames and for encoding packets.
+template <size_t kMaxConnections, size_t kBufferSize>
+class RpcSocketServerBuffer : public RpcSocketServer {
+ public:
+  RpcSocketServerBuffer(rpc::Server& server,
+                        uint64_t rpc_address = kDefaultRpcAddress)
+      : RpcSocketServer(server, connections_, poll_fds_, rpc_address),
+        connections_(MakeConnections(
+            buffers_, std::make_index_sequence<kMaxConnections>())) {}
+
+ private:
+  struct Buffers {
+    std::array<std::byte, kBufferSize> decode;
+    std::array<std::byte, kBufferSize> packet;
+  };
+
+  template <size_t... kIndices>
+  static std::array<Connection, kMaxConnections> MakeConnections(
+      std::array<Buffers, kMaxConnections>& buffers,
+      std::index_sequence<kIndices...>) {
+    return {Connection(buffers[kIndices].decode, buffers[kIndices].packet)...};
+  }
+
+  std::array<Buffers, kMaxConnections> buffers_;
+  std::array<Connection, kMaxConnections> connections_;
+  std::array<struct pollfd, kMaxConnections + 1> poll_fds_;
+};
+
+}  // namespace pw::hdlc
@@ -151,5 +151,187 @@ TEST(RpcChannelOutputBuffer, MultibyteAddress) {
       0);
 }
 
+TEST(CobsRpcChannelOutputBuffer, 1BytePayload) {
+  stream::MemoryWriterBuffer<kSinkBufferSize> memory_writer;
+
+  CobsRpcChannelOutputBuffer<kSinkBufferSize> output(
+      memory_writer, kAddress, "CobsRpcChannelOutput");
+
+  constexpr byte test_data = byte{'A'};
+  auto buffer = output.AcquireBuffer();
+  std::memcpy(buffer.data(), &test_data, sizeof(test_data));
+
+  constexpr auto expected = bytes::Concat(byte{0},
+                                          byte{8},
+                                          kEncodedAddress,
+                                          kControl,
+                                          'A',
+                                          uint32_t{0x653c9e82},
+                                          byte{0});
+
+  EXPECT_EQ(OkStatus(),
+            output.SendAndReleaseBuffer(buffer.first(sizeof(test_data))));
+
+  ASSERT_EQ(memory_writer.bytes_written(), expected.size());
+  EXPECT_EQ(
+      std::memcmp(
+          memory_writer.data(), expected.data(), memory_writer.bytes_written()),
+      0);
+}
+
+TEST(CobsRpcChannelOutput, ZerosInPayload) {
+  std::array<byte, kSinkBufferSize> channel_output_buffer;
+  stream::MemoryWriterBuffer<kSinkBufferSize> memory_writer;
+
+  CobsRpcChannelOutput output(memory_writer,
+                              channel_output_buffer,
+                              kAddress,
+                              "CobsRpcChannelOutput");
+
+  constexpr auto test_data = bytes::Array<0x00, 0x00>();
+  auto buffer = output.AcquireBuffer();
+  std::memcpy(buffer.data(), test_data.data(), test_data.size());
+
+  EXPECT_EQ(OkStatus(),
+            output.SendAndReleaseBuffer(buffer.first(test_data.size())));
+
+  CobsDecoderBuffer<kSinkBufferSize> decoder;
+  int frames = 0;
+  decoder.Process(memory_writer.WrittenData(),
+                  [&](const Result<Frame>& result) {
+                    ASSERT_EQ(OkStatus(), result.status());
+                    EXPECT_EQ(result.value().address(), kAddress);
+                    ASSERT_EQ(result.value().data().size(), 2u);
+                    EXPECT_EQ(result.value().data()[0], byte{0});
+                    EXPECT_EQ(result.value().data()[1], byte{0});
+                    frames += 1;
+                  });
+  EXPECT_EQ(frames, 1);
+}
+
+// Records the frames it is given, checking that a write is only started when
+// the previous one has been waited for.
+class FakeDmaWriter : public DmaWriter {
+ public:
+  Status StartWrite(ConstByteSpan data) override {
+    EXPECT_FALSE(busy_);
+    busy_ = true;
+    last_write_ = data;
+    writes_ += 1;
+    return OkStatus();
+  }
+
+  Status WaitUntilIdle() override {
+    EXPECT_TRUE(busy_);
+    busy_ = false;
+    return write_status_;
+  }
+
+  bool busy() const { return busy_; }
+  int writes() const { return writes_; }
+  ConstByteSpan last_write() const { return last_write_; }
+  void set_write_status(Status status) { write_status_ = status; }
+
+ private:
+  bool busy_ = false;
+  int writes_ = 0;
+  ConstByteSpan last_write_;
+  Status write_status_;
+};
+
+TEST(DoubleBufferedRpcChannelOutput, 1BytePayload) {
+  FakeDmaWriter writer;
+  DoubleBufferedRpcChannelOutputBuffer<kSinkBufferSize> output(
+      writer, kAddress, "RpcChannelOutput");
+
+  auto buffer = output.AcquireBuffer();
+  buffer[0] = byte{'A'};
+
+  constexpr auto expected = bytes::Concat(
+      kFlag, kEncodedAddress, kControl, 'A', uint32_t{0x653c9e82}, kFlag);
+
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer.first(1)));
+
+  EXPECT_TRUE(writer.busy());
+  ASSERT_EQ(writer.last_write().size(), expected.size());
+  EXPECT_EQ(std::memcmp(writer.last_write().data(),
+                        expected.data(),
+                        writer.last_write().size()),
+            0);
+
+  EXPECT_EQ(OkStatus(), output.Flush());
+  EXPECT_FALSE(writer.busy());
+}
+
+TEST(DoubleBufferedRpcChannelOutput, AlternatesTxBuffers) {
+  FakeDmaWriter writer;
+  DoubleBufferedRpcChannelOutputBuffer<kSinkBufferSize> output(
+      writer, kAddress, "RpcChannelOutput");
+
+  auto buffer = output.AcquireBuffer();
+  buffer[0] = byte{'A'};
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer.first(1)));
+  const ConstByteSpan first = writer.last_write();
+
+  // The first frame is still being sent while the second is encoded.
+  buffer = output.AcquireBuffer();
+  buffer[0] = byte{'B'};
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer.first(1)));
+  const ConstByteSpan second = writer.last_write();
+
+  EXPECT_EQ(writer.writes(), 2);
+  EXPECT_NE(first.data(), second.data());
+  EXPECT_EQ(first[3], byte{'A'});
+  EXPECT_EQ(second[3], byte{'B'});
+
+  buffer = output.AcquireBuffer();
+  buffer[0] = byte{'C'};
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer.first(1)));
+  EXPECT_EQ(writer.last_write().data(), first.data());
+  EXPECT_EQ(writer.last_write()[3], byte{'C'});
+}
+
+TEST(DoubleBufferedRpcChannelOutput, EmptyBuffer_NotSent) {
+  FakeDmaWriter writer;
+  DoubleBufferedRpcChannelOutputBuffer<kSinkBufferSize> output(
+      writer, kAddress, "RpcChannelOutput");
+
+  auto buffer = output.AcquireBuffer();
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer.first(0)));
+  EXPECT_EQ(writer.writes(), 0);
+  EXPECT_EQ(OkStatus(), output.Flush());
+}
+
+TEST(DoubleBufferedRpcChannelOutput, WriteError_ReportedByNextSend) {
+  FakeDmaWriter writer;
+  DoubleBufferedRpcChannelOutputBuffer<kSinkBufferSize> output(
+      writer, kAddress, "RpcChannelOutput");
+
+  auto buffer = output.AcquireBuffer();
+  buffer[0] = byte{'A'};
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer.first(1)));
+
+  writer.set_write_status(Status::Unavailable());
+  buffer = output.AcquireBuffer();
+  buffer[0] = byte{'B'};
+  EXPECT_EQ(Status::Unavailable(),
+            output.SendAndReleaseBuffer(buffer.first(1)));
+
+  // The new frame was still sent.
+  EXPECT_EQ(writer.writes(), 2);
+  EXPECT_EQ(Status::Unavailable(), output.Flush());
+  EXPECT_EQ(OkStatus(), output.Flush());
+}
+
+TEST(DoubleBufferedRpcChannelOutput, WorstCaseFrameFits) {
+  FakeDmaWriter writer;
+  DoubleBufferedRpcChannelOutputBuffer<kSinkBufferSize> output(
+      writer, 0xffffffffffffffff, "RpcChannelOutput");
+
+  auto buffer = output.AcquireBuffer();
+  std::fill(buffer.begin(), buffer.end(), byte{0x7e});
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(buffer));
+}
+
 }  // namespace
 }  // namespace pw::hdlc
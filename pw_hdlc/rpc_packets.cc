@@ -14,27 +14,41 @@
 
 #include "pw_hdlc/rpc_packets.h"
 
+#include <array>
+
 #include "pw_status/try.h"
 #include "pw_sys_io/sys_io.h"
 
 namespace pw::hdlc {
+namespace {
+
+// Bytes read from sys_io in one go. This is on the stack, so it is kept small;
+// most of the benefit comes from handing the decoder more than one byte.
+constexpr size_t kReadChunkSizeBytes = 32;
+
+}  // namespace
 
 Status ReadAndProcessPackets(rpc::Server& server,
                              rpc::ChannelOutput& output,
                              std::span<std::byte> decode_buffer,
                              unsigned rpc_address) {
   Decoder decoder(decode_buffer);
+  std::array<std::byte, kReadChunkSizeBytes> chunk;
 
   while (true) {
-    std::byte data;
-    PW_TRY(sys_io::ReadByte(&data));
-
-    if (auto result = decoder.Process(data); result.ok()) {
-      Frame& frame = result.value();
-      if (frame.address() == rpc_address) {
-        server.ProcessPacket(frame.data(), output);
-      }
-    }
+    // Block for one byte, then take whatever else has already arrived so the
+    // decoder can handle it in bulk.
+    PW_TRY(sys_io::ReadByte(&chunk[0]));
+    const size_t size =
+        1 + sys_io::TryReadBytes(std::span(chunk).subspan(1)).size();
+
+    decoder.Process(std::span(chunk).first(size),
+                    [&](const Result<Frame>& result) {
+                      if (result.ok() &&
+                          result.value().address() == rpc_address) {
+                        server.ProcessPacket(result.value().data(), output);
+                      }
+                    });
   }
 }
 
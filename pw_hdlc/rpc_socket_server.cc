@@ -0,0 +1,133 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/rpc_socket_server.h"
+
+#include "pw_hdlc/encoder.h"
+#include "pw_log/log.h"
+
+namespace pw::hdlc {
+
+Status RpcSocketServer::Connection::SendAndReleaseBuffer(
+    std::span<const std::byte> buffer) {
+  PW_DASSERT(buffer.data() == packet_buffer_.data());
+  if (buffer.empty()) {
+    return OkStatus();
+  }
+  return WriteUIFrame(address_, buffer, stream_);
+}
+
+Status RpcSocketServer::Poll(int timeout_ms) {
+  // The listening socket is always polled first, followed by the open
+  // connections in the order of connections_.
+  size_t count = 0;
+  poll_fds_[count++] = {listener_.fd(), POLLIN, 0};
+  for (Connection& connection : connections_) {
+    if (connection.stream_.is_open()) {
+      poll_fds_[count++] = {connection.stream_.connection_fd(), POLLIN, 0};
+    }
+  }
+
+  const int ready = poll(poll_fds_.data(), count, timeout_ms);
+  if (ready < 0) {
+    return Status::Internal();
+  }
+  if (ready == 0) {
+    return OkStatus();
+  }
+
+  size_t index = 1;
+  for (Connection& connection : connections_) {
+    if (!connection.stream_.is_open()) {
+      continue;
+    }
+    // Connections accepted below were not polled, so stop at count.
+    if (index == count) {
+      break;
+    }
+    if (poll_fds_[index++].revents != 0) {
+      Service(connection);
+    }
+  }
+
+  if (poll_fds_[0].revents != 0) {
+    Accept();
+  }
+  return OkStatus();
+}
+
+Status RpcSocketServer::Run() {
+  while (true) {
+    if (Status status = Poll(-1); !status.ok()) {
+      return status;
+    }
+  }
+}
+
+void RpcSocketServer::Accept() {
+  for (Connection& connection : connections_) {
+    if (connection.stream_.is_open()) {
+      continue;
+    }
+    if (!listener_.Accept(connection.stream_).ok()) {
+      return;
+    }
+    connection.stream_.set_nonblocking(true);
+    connection.decoder_.Clear();
+    connection.address_ = rpc_address_;
+    open_connections_ += 1;
+    return;
+  }
+
+  // All connections are in use. Accept the connection to close it, rather than
+  // leaving it pending.
+  stream::SocketStream refused;
+  if (listener_.Accept(refused).ok()) {
+    refused_connections_ += 1;
+    PW_LOG_WARN("Refused socket connection; all %u connections are in use",
+                static_cast<unsigned>(connections_.size()));
+  }
+}
+
+void RpcSocketServer::Service(Connection& connection) {
+  std::array<std::byte, 256> data;
+
+  // The stream is non-blocking, so read until no data is left.
+  while (true) {
+    Result<ByteSpan> result = connection.stream_.Read(data);
+    if (result.status().IsResourceExhausted()) {
+      return;
+    }
+    if (!result.ok()) {
+      CloseConnection(connection);
+      return;
+    }
+
+    connection.decoder_.Process(
+        result.value(), [this, &connection](const Result<Frame>& frame) {
+          if (!frame.ok()) {
+            decode_errors_ += 1;
+          } else if (frame.value().address() == rpc_address_) {
+            server_.ProcessPacket(frame.value().data(), connection);
+          }
+        });
+  }
+}
+
+void RpcSocketServer::CloseConnection(Connection& connection) {
+  connection.stream_.Close();
+  open_connections_ -= 1;
+}
+
+}  // namespace pw::hdlc
@@ -0,0 +1,118 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_hdlc/rpc_socket_server.h"
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_hdlc/internal/protocol.h"
+
+namespace pw::hdlc {
+namespace {
+
+constexpr int kPollTimeoutMs = 100;
+
+class RpcSocketServerTest : public ::testing::Test {
+ protected:
+  RpcSocketServerTest() : server_(channels_) {}
+
+  // Polls until the condition is true, up to a limit.
+  template <typename Condition>
+  bool PollUntil(RpcSocketServer& socket_server, Condition condition) {
+    for (int i = 0; i < 20 && !condition(); ++i) {
+      EXPECT_EQ(OkStatus(), socket_server.Poll(kPollTimeoutMs));
+    }
+    return condition();
+  }
+
+  rpc::Channel channels_[2];
+  rpc::Server server_;
+};
+
+TEST_F(RpcSocketServerTest, AcceptsConnections) {
+  RpcSocketServerBuffer<2, 64> socket_server(server_);
+  ASSERT_EQ(OkStatus(), socket_server.Listen(0));
+  ASSERT_NE(socket_server.port(), 0u);
+
+  stream::SocketStream client_1;
+  stream::SocketStream client_2;
+  ASSERT_EQ(OkStatus(), client_1.Connect(nullptr, socket_server.port()));
+  ASSERT_EQ(OkStatus(), client_2.Connect(nullptr, socket_server.port()));
+
+  EXPECT_TRUE(PollUntil(socket_server,
+                        [&] { return socket_server.open_connections() == 2; }));
+  EXPECT_EQ(socket_server.refused_connections(), 0u);
+}
+
+TEST_F(RpcSocketServerTest, RefusesConnectionsWhenFull) {
+  RpcSocketServerBuffer<1, 64> socket_server(server_);
+  ASSERT_EQ(OkStatus(), socket_server.Listen(0));
+
+  stream::SocketStream client_1;
+  stream::SocketStream client_2;
+  ASSERT_EQ(OkStatus(), client_1.Connect(nullptr, socket_server.port()));
+  ASSERT_EQ(OkStatus(), client_2.Connect(nullptr, socket_server.port()));
+
+  EXPECT_TRUE(PollUntil(socket_server, [&] {
+    return socket_server.refused_connections() == 1u;
+  }));
+  EXPECT_EQ(socket_server.open_connections(), 1u);
+}
+
+TEST_F(RpcSocketServerTest, ClosesConnectionWhenClientCloses) {
+  RpcSocketServerBuffer<1, 64> socket_server(server_);
+  ASSERT_EQ(OkStatus(), socket_server.Listen(0));
+
+  stream::SocketStream client;
+  ASSERT_EQ(OkStatus(), client.Connect(nullptr, socket_server.port()));
+  ASSERT_TRUE(PollUntil(socket_server,
+                        [&] { return socket_server.open_connections() == 1; }));
+
+  client.Close();
+  EXPECT_TRUE(PollUntil(socket_server,
+                        [&] { return socket_server.open_connections() == 0; }));
+
+  // The connection can be reused.
+  stream::SocketStream new_client;
+  ASSERT_EQ(OkStatus(), new_client.Connect(nullptr, socket_server.port()));
+  EXPECT_TRUE(PollUntil(socket_server,
+                        [&] { return socket_server.open_connections() == 1; }));
+}
+
+TEST_F(RpcSocketServerTest, DecodesEachConnectionSeparately) {
+  RpcSocketServerBuffer<2, 64> socket_server(server_);
+  ASSERT_EQ(OkStatus(), socket_server.Listen(0));
+
+  stream::SocketStream client_1;
+  stream::SocketStream client_2;
+  ASSERT_EQ(OkStatus(), client_1.Connect(nullptr, socket_server.port()));
+  ASSERT_EQ(OkStatus(), client_2.Connect(nullptr, socket_server.port()));
+  ASSERT_TRUE(PollUntil(socket_server,
+                        [&] { return socket_server.open_connections() == 2; }));
+
+  // Only client 1 completes a frame, which is invalid. Client 2's partial frame
+  // must not affect it.
+  ASSERT_EQ(OkStatus(),
+            client_1.Write(bytes::Concat(kFlag, bytes::String("ab"))));
+  ASSERT_EQ(OkStatus(),
+            client_2.Write(bytes::Concat(kFlag, bytes::String("xyz"))));
+  ASSERT_EQ(OkStatus(),
+            client_1.Write(bytes::Concat(bytes::String("cdefg"), kFlag)));
+
+  EXPECT_TRUE(PollUntil(socket_server,
+                        [&] { return socket_server.decode_errors() == 1; }));
+}
+
+}  // namespace
+}  // namespace pw::hdlc
@@ -14,11 +14,12 @@
 
 #include "pw_hex_dump/hex_dump.h"
 
-#include <cctype>
 #include <cstddef>
+#include <cstring>
 #include <string_view>
 
 #include "pw_status/status_with_size.h"
+#include "pw_status/try.h"
 #include "pw_string/string_builder.h"
 #include "pw_string/type_to_string.h"
 
@@ -37,11 +38,23 @@ constexpr const std::string_view kAsciiHeader("Text");
 // Minimum number of hex characters to use when displaying dump offset.
 constexpr const size_t kMinOffsetChars = 4;
 
-char PrintableChar(std::byte b) {
-  if (std::isprint(std::to_integer<char>(b)) == 0) {
-    return '.';
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Same result as std::isprint() in the "C" locale, without the library call.
+char PrintableChar(uint8_t c) { return c >= 0x20 && c < 0x7f ? c : '.'; }
+
+// Writes value as exactly width zero-padded hex digits.
+char* WriteHex(char* out, uint64_t value, size_t width) {
+  for (size_t i = width; i > 0; --i) {
+    out[i - 1] = kHexDigits[value & 0xF];
+    value >>= 4;
   }
-  return std::to_integer<char>(b);
+  return out + width;
+}
+
+char* WriteString(char* out, std::string_view string) {
+  std::memcpy(out, string.data(), string.size());
+  return out + string.size();
 }
 
 }  // namespace
@@ -60,7 +73,7 @@ Status DumpAddr(std::span<char> dest, uintptr_t addr) {
   return IntToHexString(addr, dest.subspan(2), sizeof(uintptr_t) * 2).status();
 }
 
-Status FormattedHexDumper::PrintFormatHeader() {
+StatusWithSize FormattedHexDumper::PrintFormatHeader() {
   StringBuilder builder(dest_);
 
   if (flags.prefix_mode != AddressMode::kDisabled) {
@@ -68,16 +81,7 @@ Status FormattedHexDumper::PrintFormatHeader() {
                                 ? kOffsetHeader
                                 : kAddressHeader);
     // Pad to align to address width.
-    size_t padding = 0;
-    if (flags.prefix_mode == AddressMode::kOffset) {
-      size_t offs_width =
-          HexDigitCount(source_data_.size_bytes() + current_offset_);
-      padding = std::max(offs_width, kMinOffsetChars);
-    } else {
-      padding = kHexAddrStringSize;
-    }
-
-    padding += kAddressSeparator.length();
+    size_t padding = PrefixWidth() + kAddressSeparator.length();
     padding -= header.size();
 
     builder << header;
@@ -118,7 +122,89 @@ Status FormattedHexDumper::PrintFormatHeader() {
     builder << kAsciiHeader;
   }
 
-  return builder.status();
+  return builder.status_with_size();
+}
+
+size_t FormattedHexDumper::PrefixWidth() const {
+  if (flags.prefix_mode == AddressMode::kAbsolute) {
+    return kHexAddrStringSize;
+  }
+  if (flags.prefix_mode == AddressMode::kOffset) {
+    // The offset of the last byte sets the width for the whole dump.
+    return std::max<size_t>(
+        HexDigitCount(source_data_.size_bytes() + current_offset_),
+        kMinOffsetChars);
+  }
+  return 0;
+}
+
+size_t FormattedHexDumper::MaxLineLength() const {
+  size_t length = flags.bytes_per_line * 2;
+  if (flags.group_every != 0 && flags.bytes_per_line != 0) {
+    length += (flags.bytes_per_line - 1) / flags.group_every;
+  }
+  if (flags.prefix_mode != AddressMode::kDisabled) {
+    length += PrefixWidth() + kAddressSeparator.length();
+  }
+  if (flags.show_ascii) {
+    length += kSectionSeparator.length();
+    length += flags.show_header
+                  ? std::max<size_t>(flags.bytes_per_line, kAsciiHeader.size())
+                  : flags.bytes_per_line;
+  }
+  return length;
+}
+
+size_t FormattedHexDumper::FormatLine(char* const line) {
+  char* out = line;
+
+  if (flags.prefix_mode == AddressMode::kAbsolute) {
+    *out++ = '0';
+    *out++ = 'x';
+    out = WriteHex(out,
+                   reinterpret_cast<uintptr_t>(source_data_.data()),
+                   kHexAddrStringSize - 2);
+    out = WriteString(out, kAddressSeparator);
+  } else if (flags.prefix_mode == AddressMode::kOffset) {
+    out = WriteHex(out, current_offset_, PrefixWidth());
+    out = WriteString(out, kAddressSeparator);
+  }
+
+  const size_t bytes_in_line = std::min(
+      source_data_.size_bytes(), static_cast<size_t>(flags.bytes_per_line));
+  const uint8_t* const bytes =
+      reinterpret_cast<const uint8_t*>(source_data_.data());
+
+  // When the text column is shown, short lines are padded to keep it aligned.
+  const size_t columns =
+      flags.show_ascii ? flags.bytes_per_line : bytes_in_line;
+  size_t until_group = flags.group_every;
+  for (size_t i = 0; i < columns; ++i) {
+    if (until_group == 0 && flags.group_every != 0) {
+      *out++ = ' ';
+      until_group = flags.group_every;
+    }
+    until_group -= 1;
+
+    if (i < bytes_in_line) {
+      *out++ = kHexDigits[bytes[i] >> 4];
+      *out++ = kHexDigits[bytes[i] & 0xF];
+    } else {
+      *out++ = ' ';
+      *out++ = ' ';
+    }
+  }
+
+  if (flags.show_ascii) {
+    out = WriteString(out, kSectionSeparator);
+    for (size_t i = 0; i < bytes_in_line; ++i) {
+      *out++ = PrintableChar(bytes[i]);
+    }
+  }
+
+  source_data_ = source_data_.subspan(bytes_in_line);
+  current_offset_ += bytes_in_line;
+  return out - line;
 }
 
 Status FormattedHexDumper::DumpLine() {
@@ -132,82 +218,42 @@ Status FormattedHexDumper::DumpLine() {
 
   if (dest_[0] == 0 && flags.show_header) {
     // First line, print out dump format header.
-    return PrintFormatHeader();
+    return PrintFormatHeader().status();
   }
 
-  StringBuilder builder(dest_);
-  // Dump address/offset prefix.
-  // TODO(amontanez): This block can be much nicer if StringBuilder exposed an
-  // easy way to control zero padding for hex address.
-  if (flags.prefix_mode != AddressMode::kDisabled) {
-    uintptr_t val;
-    if (flags.prefix_mode == AddressMode::kAbsolute) {
-      val = reinterpret_cast<uintptr_t>(source_data_.data());
-      builder << "0x";
-      uint8_t significant = HexDigitCount(val);
-      builder.append(sizeof(uintptr_t) * 2 - significant, '0');
-    } else {
-      val = current_offset_;
-      size_t significant =
-          HexDigitCount(source_data_.size_bytes() + current_offset_);
-      if (significant < kMinOffsetChars) {
-        builder.append(kMinOffsetChars - significant, '0');
-      }
-    }
-    if (val != 0) {
-      builder << reinterpret_cast<void*>(val);
-    } else {
-      builder.append(2, '0');
-    }
-    builder << kAddressSeparator;
-  }
+  // ValidateBufferSize() ensured that a full line and terminator fit.
+  dest_[FormatLine(dest_.data())] = '\0';
+  return OkStatus();
+}
 
-  size_t bytes_in_line = std::min(source_data_.size_bytes(),
-                                  static_cast<size_t>(flags.bytes_per_line));
-  // Convert raw bytes to hex characters.
-  for (size_t i = 0; i < bytes_in_line; ++i) {
-    // Early loop termination for when bytes_remaining <
-    // bytes_per_line.
-    uint8_t c = std::to_integer<uint8_t>(source_data_[i]);
-    // TODO(amontanez): Maybe StringBuilder can be augmented to support full-
-    // width bytes? (`04` instead of `4`, for example)
-    builder << std::byte(c >> 4);
-    builder << std::byte(c & 0xF);
-    if (flags.group_every != 0 && (i + 1) % flags.group_every == 0) {
-      builder << ' ';
-    }
-  }
-  // Add padding spaces to ensure lines are aligned.
-  if (flags.show_ascii) {
-    for (size_t i = bytes_in_line;
-         i < static_cast<size_t>(flags.bytes_per_line);
-         ++i) {
-      builder.append(2, ' ');
-      if (flags.group_every != 0 && (i + 1) % flags.group_every == 0) {
-        builder << ' ';
-      }
-    }
+Status FormattedHexDumper::DumpTo(stream::Writer& writer) {
+  if (!ValidateBufferSize().ok() || dest_.data() == nullptr) {
+    return Status::FailedPrecondition();
   }
 
-  // Removes extraneous space from end when bytes_per_line is divisible by
-  // group_every. kSectionSeparator includes a space, so it's unnecessary.
-  // Ommitting the space from the section separator actually makes for more
-  // workarounds and code duplication, so this is better.
-  if (flags.group_every != 0 && flags.bytes_per_line % flags.group_every == 0) {
-    builder.pop_back();
+  size_t used = 0;
+  if (dest_[0] == 0 && flags.show_header && !source_data_.empty()) {
+    const StatusWithSize header = PrintFormatHeader();
+    PW_TRY(header.status());
+    dest_[header.size()] = '\n';
+    used = header.size() + 1;
   }
 
-  // Interpret bytes as characters.
-  if (flags.show_ascii) {
-    builder << kSectionSeparator;
-    for (size_t i = 0; i < bytes_in_line; ++i) {
-      builder << PrintableChar(source_data_[i]);
+  // Pack as many lines into the line buffer as fit before each write.
+  const size_t max_line_size = MaxLineLength() + 1;
+  while (!source_data_.empty()) {
+    if (dest_.size() - used < max_line_size) {
+      PW_TRY(writer.Write(std::as_bytes(dest_.first(used))));
+      used = 0;
     }
+    used += FormatLine(dest_.data() + used);
+    dest_[used++] = '\n';
   }
 
-  source_data_ = source_data_.subspan(bytes_in_line);
-  current_offset_ += bytes_in_line;
-  return builder.status();
+  if (used != 0) {
+    PW_TRY(writer.Write(std::as_bytes(dest_.first(used))));
+  }
+  return OkStatus();
 }
 
 Status FormattedHexDumper::SetLineBuffer(std::span<char> dest) {
@@ -231,25 +277,12 @@ Status FormattedHexDumper::BeginDump(ConstByteSpan data) {
 }
 
 Status FormattedHexDumper::ValidateBufferSize() {
-  // Minimum size is number of bytes per line as hex pairs plus the null
-  // terminator.
-  size_t required_size = flags.bytes_per_line * 2 + 1;
-  if (flags.show_ascii) {
-    required_size += kSectionSeparator.length() + flags.bytes_per_line;
-  }
-  if (flags.prefix_mode == AddressMode::kAbsolute) {
-    required_size += kHexAddrStringSize;
-    required_size += kAddressSeparator.length();
-  } else if (flags.prefix_mode == AddressMode::kOffset) {
-    required_size +=
-        HexDigitCount(std::max(source_data_.size_bytes(), kMinOffsetChars));
-    required_size += kAddressSeparator.length();
-  }
-  if (flags.group_every != 0) {
-    required_size += (flags.bytes_per_line - 1) / flags.group_every;
+  if (flags.bytes_per_line == 0) {
+    return Status::FailedPrecondition();
   }
 
-  if (dest_.size_bytes() < required_size) {
+  // A full line, plus the null terminator or newline.
+  if (dest_.size_bytes() < MaxLineLength() + 1) {
     return Status::ResourceExhausted();
   }
 
@@ -19,10 +19,12 @@
 #include <cstdint>
 #include <cstring>
 #include <span>
+#include <string>
 #include <string_view>
 
 #include "gtest/gtest.h"
 #include "pw_log/log.h"
+#include "pw_stream/memory_stream.h"
 
 namespace pw::dump {
 namespace {
@@ -333,6 +335,87 @@ TEST_F(HexDump, FormattedHexDump_AbsolutePrefix) {
   EXPECT_STREQ(expected2.data(), dest_.data());
 }
 
+TEST_F(HexDump, FormattedHexDump_OffsetPrefixPaddedToDumpWidth) {
+  // The last offset needs five digits, so every offset gets five.
+  static std::array<std::byte, 0x10010> data{};
+
+  default_flags_.prefix_mode = FormattedHexDumper::AddressMode::kOffset;
+  dumper_ = FormattedHexDumper(dest_, default_flags_);
+
+  EXPECT_TRUE(dumper_.BeginDump(data).ok());
+  EXPECT_TRUE(dumper_.DumpLine().ok());
+  EXPECT_EQ(std::string_view(dest_.data(), 7), "00000: ");
+  EXPECT_TRUE(dumper_.DumpLine().ok());
+  EXPECT_EQ(std::string_view(dest_.data(), 7), "00010: ");
+}
+
+TEST_F(HexDump, FormattedHexDump_ShortLastLineGrouped) {
+  constexpr const char* expected = "6d792074 65737420 737472";
+
+  default_flags_.bytes_per_line = 16;
+  default_flags_.group_every = 4;
+  dumper_ = FormattedHexDumper(dest_, default_flags_);
+
+  EXPECT_TRUE(dumper_.BeginDump(std::span(short_string).first(11)).ok());
+  EXPECT_TRUE(dumper_.DumpLine().ok());
+  EXPECT_STREQ(expected, dest_.data());
+}
+
+TEST_F(HexDump, DumpTo_MatchesDumpLine) {
+  default_flags_.show_ascii = true;
+  default_flags_.show_header = true;
+  default_flags_.prefix_mode = FormattedHexDumper::AddressMode::kOffset;
+
+  std::string expected;
+  dumper_ = FormattedHexDumper(dest_, default_flags_);
+  EXPECT_TRUE(dumper_.BeginDump(source_data).ok());
+  while (dumper_.DumpLine().ok()) {
+    expected += dest_.data();
+    expected += '\n';
+  }
+
+  stream::MemoryWriterBuffer<512> writer;
+  EXPECT_TRUE(dumper_.BeginDump(source_data).ok());
+  EXPECT_EQ(dumper_.DumpTo(writer), OkStatus());
+  EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(writer.data()),
+                             writer.bytes_written()),
+            expected);
+  EXPECT_EQ(dumper_.DumpLine(), Status::ResourceExhausted());
+}
+
+class CountingWriter : public stream::Writer {
+ public:
+  stream::MemoryWriterBuffer<1024> memory;
+  int writes = 0;
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    writes += 1;
+    return memory.Write(data);
+  }
+};
+
+TEST_F(HexDump, DumpTo_PacksLinesIntoBuffer) {
+  // Each line is 16 * 3 - 1 = 47 characters, plus a newline.
+  std::array<char, 48 * 4> buffer;
+  CountingWriter writer;
+
+  FormattedHexDumper dumper(buffer, default_flags_);
+  std::array<std::byte, 16 * 10> data{};
+  EXPECT_TRUE(dumper.BeginDump(data).ok());
+  EXPECT_EQ(dumper.DumpTo(writer), OkStatus());
+
+  EXPECT_EQ(writer.memory.bytes_written(), 48u * 10);
+  EXPECT_EQ(writer.writes, 3);  // 4 + 4 + 2 lines
+}
+
+TEST_F(HexDump, DumpTo_WriterError) {
+  stream::MemoryWriterBuffer<20> writer;
+  std::array<std::byte, 16 * 10> data{};
+  EXPECT_TRUE(dumper_.BeginDump(data).ok());
+  EXPECT_EQ(dumper_.DumpTo(writer), Status::ResourceExhausted());
+}
+
 TEST_F(SmallBuffer, TinyHexDump) {
   constexpr const char* expected = "a4cc32";
 
@@ -395,6 +478,16 @@ TEST(BadBuffer, NullPtrDest) {
   EXPECT_EQ(dumper.DumpLine(), Status::FailedPrecondition());
 }
 
+TEST_F(SmallBuffer, DumpToTooManyBytesPerLine) {
+  stream::MemoryWriterBuffer<64> writer;
+  default_flags_.bytes_per_line = 13;
+  dumper_ = FormattedHexDumper(dest_, default_flags_);
+
+  EXPECT_EQ(dumper_.BeginDump(source_data), Status::FailedPrecondition());
+  EXPECT_EQ(dumper_.DumpTo(writer), Status::FailedPrecondition());
+  EXPECT_EQ(writer.bytes_written(), 0u);
+}
+
 TEST(BadBuffer, NullPtrSrc) {
   char buffer[24] = {static_cast<char>(0)};
   FormattedHexDumper dumper(buffer);
@@ -19,6 +19,8 @@
 
 #include "pw_bytes/span.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
 
 namespace pw::dump {
 
@@ -142,9 +144,39 @@ class FormattedHexDumper {
   //     formatting configuration.
   Status DumpLine();
 
+  // Dumps the rest of the data to a writer, with each line followed by a
+  // newline. Lines are packed into the line buffer until the next one might not
+  // fit, then written together, so a larger line buffer means fewer writes.
+  // Lines are not null terminated. The header is written first if no lines
+  // have been dumped yet.
+  //
+  // Example usage:
+  //
+  //   std::array<char, 512> buffer;
+  //   FormattedHexDumper hex_dumper(buffer);
+  //   hex_dumper.BeginDump(crash_buffer);
+  //   hex_dumper.DumpTo(uart_writer);
+  //
+  // Returns:
+  //   OK - All remaining data was written.
+  //   FAILED_PRECONDITION - Destination line buffer is too small to fit current
+  //     formatting configuration.
+  //   Any error from the writer, in which case the dump stops.
+  Status DumpTo(stream::Writer& writer);
+
  private:
   Status ValidateBufferSize();
-  Status PrintFormatHeader();
+  StatusWithSize PrintFormatHeader();
+
+  // Number of characters in the address or offset prefix.
+  size_t PrefixWidth() const;
+
+  // Length of the longest line with the current flags, without terminator.
+  size_t MaxLineLength() const;
+
+  // Formats the next line at line, without a terminator, and advances past it.
+  // There must be room for MaxLineLength() characters. Returns the length.
+  size_t FormatLine(char* line);
 
   size_t current_offset_;
   std::span<char> dest_;
@@ -0,0 +1,88 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_i2c/async_initiator.h"
+
+#include <mutex>
+#include <utility>
+
+namespace pw::i2c {
+
+Status AsyncInitiator::WriteRead(Address device_address,
+                                 ConstByteSpan tx_buffer,
+                                 ByteSpan rx_buffer,
+                                 AsyncTransaction::Callback&& on_complete) {
+  if (tx_buffer.empty() && rx_buffer.empty()) {
+    return Status::InvalidArgument();
+  }
+
+  AsyncTransaction* to_start = nullptr;
+  {
+    std::lock_guard lock(lock_);
+    if (count_ == queue_.size()) {
+      return Status::ResourceExhausted();
+    }
+    AsyncTransaction& transaction = slot(count_);
+    transaction.address = device_address;
+    transaction.tx_buffer = tx_buffer;
+    transaction.rx_buffer = rx_buffer;
+    transaction.on_complete = std::move(on_complete);
+    count_ += 1;
+
+    if (!busy_) {
+      busy_ = true;
+      to_start = &transaction;
+    }
+  }
+
+  // Started outside the lock, since the backend may take a while to set up the
+  // hardware. The transaction stays at the head of the queue until Complete().
+  if (to_start != nullptr) {
+    DoStart(*to_start);
+  }
+  return OkStatus();
+}
+
+size_t AsyncInitiator::pending() const {
+  std::lock_guard lock(lock_);
+  return count_;
+}
+
+void AsyncInitiator::Complete(Status status) {
+  AsyncTransaction::Callback on_complete;
+  AsyncTransaction* next = nullptr;
+  {
+    std::lock_guard lock(lock_);
+    AsyncTransaction& done = slot(0);
+    on_complete = std::move(done.on_complete);
+    done.on_complete = nullptr;
+    head_ = (head_ + 1) % queue_.size();
+    count_ -= 1;
+
+    if (count_ == 0) {
+      busy_ = false;
+    } else {
+      next = &slot(0);
+    }
+  }
+
+  if (next != nullptr) {
+    DoStart(*next);
+  }
+  if (on_complete != nullptr) {
+    on_complete(std::move(status));
+  }
+}
+
+}  // namespace pw::i2c
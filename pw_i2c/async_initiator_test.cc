@@ -0,0 +1,182 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_i2c/async_initiator.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_containers/vector.h"
+
+namespace pw::i2c {
+namespace {
+
+constexpr Address kAddress1 = Address::SevenBit<0x01>();
+constexpr Address kAddress2 = Address::SevenBit<0x02>();
+constexpr Address kAddress3 = Address::SevenBit<0x03>();
+
+// Records the transactions it is asked to start. Tests complete them by calling
+// FinishTransaction(), as an interrupt handler would.
+class FakeAsyncInitiator : public AsyncInitiator {
+ public:
+  FakeAsyncInitiator() : AsyncInitiator(queue_) {}
+
+  void FinishTransaction(Status status) { Complete(status); }
+
+  const Vector<const AsyncTransaction*, 8>& started() const { return started_; }
+
+ private:
+  void DoStart(const AsyncTransaction& transaction) override {
+    started_.push_back(&transaction);
+  }
+
+  std::array<AsyncTransaction, 3> queue_;
+  Vector<const AsyncTransaction*, 8> started_;
+};
+
+TEST(AsyncInitiator, SubmitStartsTransactionImmediately) {
+  FakeAsyncInitiator initiator;
+  std::array<std::byte, 2> tx = {std::byte{1}, std::byte{2}};
+  std::array<std::byte, 4> rx = {};
+
+  EXPECT_EQ(OkStatus(), initiator.WriteRead(kAddress1, tx, rx, nullptr));
+
+  ASSERT_EQ(initiator.started().size(), 1u);
+  const AsyncTransaction& started = *initiator.started()[0];
+  EXPECT_EQ(started.address.GetTenBit(), kAddress1.GetTenBit());
+  EXPECT_EQ(started.tx_buffer.data(), tx.data());
+  EXPECT_EQ(started.tx_buffer.size(), tx.size());
+  EXPECT_EQ(started.rx_buffer.data(), rx.data());
+  EXPECT_EQ(started.rx_buffer.size(), rx.size());
+  EXPECT_EQ(initiator.pending(), 1u);
+}
+
+TEST(AsyncInitiator, EmptyTransaction_InvalidArgument) {
+  FakeAsyncInitiator initiator;
+  EXPECT_EQ(
+      Status::InvalidArgument(),
+      initiator.WriteRead(kAddress1, ConstByteSpan(), ByteSpan(), nullptr));
+  EXPECT_EQ(initiator.pending(), 0u);
+  EXPECT_TRUE(initiator.started().empty());
+}
+
+TEST(AsyncInitiator, QueuedTransactionsRunInOrder) {
+  FakeAsyncInitiator initiator;
+  std::array<std::byte, 1> buffer = {};
+  Vector<int, 3> completed;
+
+  ASSERT_EQ(OkStatus(),
+            initiator.Read(kAddress1, buffer, [&](Status status) {
+              EXPECT_EQ(OkStatus(), status);
+              completed.push_back(1);
+            }));
+  ASSERT_EQ(OkStatus(),
+            initiator.Write(kAddress2, buffer, [&](Status status) {
+              EXPECT_EQ(Status::Unavailable(), status);
+              completed.push_back(2);
+            }));
+  ASSERT_EQ(OkStatus(),
+            initiator.Read(kAddress3, buffer, [&](Status status) {
+              EXPECT_EQ(OkStatus(), status);
+              completed.push_back(3);
+            }));
+
+  // Only the first transaction is on the bus.
+  ASSERT_EQ(initiator.started().size(), 1u);
+  EXPECT_EQ(initiator.pending(), 3u);
+
+  initiator.FinishTransaction(OkStatus());
+  ASSERT_EQ(initiator.started().size(), 2u);
+  EXPECT_EQ(initiator.started()[1]->address.GetTenBit(),
+            kAddress2.GetTenBit());
+
+  initiator.FinishTransaction(Status::Unavailable());
+  ASSERT_EQ(initiator.started().size(), 3u);
+  EXPECT_EQ(initiator.started()[2]->address.GetTenBit(),
+            kAddress3.GetTenBit());
+
+  initiator.FinishTransaction(OkStatus());
+  EXPECT_EQ(initiator.started().size(), 3u);
+  EXPECT_EQ(initiator.pending(), 0u);
+
+  ASSERT_EQ(completed.size(), 3u);
+  EXPECT_EQ(completed[0], 1);
+  EXPECT_EQ(completed[1], 2);
+  EXPECT_EQ(completed[2], 3);
+}
+
+TEST(AsyncInitiator, QueueFull_ResourceExhausted) {
+  FakeAsyncInitiator initiator;
+  std::array<std::byte, 1> buffer = {};
+
+  for (size_t i = 0; i < initiator.capacity(); ++i) {
+    EXPECT_EQ(OkStatus(), initiator.Read(kAddress1, buffer, nullptr));
+  }
+  EXPECT_EQ(Status::ResourceExhausted(),
+            initiator.Read(kAddress1, buffer, nullptr));
+
+  // Completing a transaction frees its slot.
+  initiator.FinishTransaction(OkStatus());
+  EXPECT_EQ(OkStatus(), initiator.Read(kAddress2, buffer, nullptr));
+  EXPECT_EQ(initiator.pending(), initiator.capacity());
+}
+
+TEST(AsyncInitiator, NextTransactionStartsBeforeCallback) {
+  FakeAsyncInitiator initiator;
+  std::array<std::byte, 1> buffer = {};
+
+  struct {
+    FakeAsyncInitiator& initiator;
+    size_t started_in_callback;
+  } context{initiator, 0};
+
+  ASSERT_EQ(OkStatus(), initiator.Read(kAddress1, buffer, [&context](Status) {
+    context.started_in_callback = context.initiator.started().size();
+  }));
+  ASSERT_EQ(OkStatus(), initiator.Read(kAddress2, buffer, nullptr));
+
+  initiator.FinishTransaction(OkStatus());
+  EXPECT_EQ(context.started_in_callback, 2u);
+}
+
+TEST(AsyncInitiator, CallbackCanSubmit) {
+  FakeAsyncInitiator initiator;
+  std::array<std::byte, 1> buffer = {};
+
+  struct {
+    FakeAsyncInitiator& initiator;
+    ByteSpan buffer;
+    Status resubmit_status;
+  } context{initiator, buffer, Status::Unknown()};
+
+  ASSERT_EQ(OkStatus(), initiator.Read(kAddress1, buffer, [&context](Status) {
+    context.resubmit_status =
+        context.initiator.Read(kAddress2, context.buffer, nullptr);
+  }));
+
+  // The queue is empty when the callback runs, so its transaction starts
+  // straight away.
+  initiator.FinishTransaction(OkStatus());
+  EXPECT_EQ(OkStatus(), context.resubmit_status);
+  EXPECT_EQ(initiator.pending(), 1u);
+  ASSERT_EQ(initiator.started().size(), 2u);
+  EXPECT_EQ(initiator.started()[1]->address.GetTenBit(),
+            kAddress2.GetTenBit());
+
+  initiator.FinishTransaction(OkStatus());
+  EXPECT_EQ(initiator.pending(), 0u);
+}
+
+}  // namespace
+}  // namespace pw::i2c
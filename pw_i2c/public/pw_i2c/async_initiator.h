@@ -0,0 +1,123 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include "pw_bytes/span.h"
+#include "pw_function/function.h"
+#include "pw_i2c/address.h"
+#include "pw_status/status.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::i2c {
+
+// One queued write, read, or write + read transaction, with the same bus
+// semantics as Initiator::WriteReadFor. The buffers must stay valid until the
+// transaction completes.
+struct AsyncTransaction {
+  // Called once the transaction finishes, with the same statuses as
+  // Initiator::WriteReadFor. This is typically called from the backend's
+  // interrupt handler, so it must not block.
+  using Callback = Function<void(Status)>;
+
+  Address address = Address::SevenBit<0>();
+  ConstByteSpan tx_buffer;
+  ByteSpan rx_buffer;
+  Callback on_complete;
+};
+
+// Base class for I2C initiators that run transactions asynchronously, e.g.
+// driven by interrupts or DMA. Transactions are queued in a fixed-capacity
+// queue and run back to back on the bus, so the caller does not block while
+// each one is in progress. Other documentation sources may call this style of
+// interface an I2C "master", "central" or "controller".
+// inclusive-language: ignore
+//
+// Backends implement DoStart() to begin a transaction on the bus, and call
+// Complete() when it is done, usually from an interrupt handler. Complete()
+// starts the next queued transaction before invoking the callback of the
+// finished one, so the bus is not left idle while callbacks run.
+//
+// Submit() and Complete() are interrupt safe.
+class AsyncInitiator {
+ public:
+  AsyncInitiator(const AsyncInitiator&) = delete;
+  AsyncInitiator& operator=(const AsyncInitiator&) = delete;
+
+  virtual ~AsyncInitiator() = default;
+
+  // Queues a write + read transaction. Either buffer may be empty, but not
+  // both. on_complete is called with the transaction's result.
+  //
+  // Returns:
+  // Ok - The transaction was queued.
+  // InvalidArgument - Both buffers are empty.
+  // ResourceExhausted - The queue is full.
+  Status WriteRead(Address device_address,
+                   ConstByteSpan tx_buffer,
+                   ByteSpan rx_buffer,
+                   AsyncTransaction::Callback&& on_complete);
+
+  Status Write(Address device_address,
+               ConstByteSpan tx_buffer,
+               AsyncTransaction::Callback&& on_complete) {
+    return WriteRead(
+        device_address, tx_buffer, ByteSpan(), std::move(on_complete));
+  }
+
+  Status Read(Address device_address,
+              ByteSpan rx_buffer,
+              AsyncTransaction::Callback&& on_complete) {
+    return WriteRead(
+        device_address, ConstByteSpan(), rx_buffer, std::move(on_complete));
+  }
+
+  // Number of transactions queued, including the one in progress.
+  size_t pending() const PW_LOCKS_EXCLUDED(lock_);
+
+  size_t capacity() const { return queue_.size(); }
+
+ protected:
+  // The queue holds the transactions that have not yet completed. A backend
+  // typically declares a std::array<AsyncTransaction, N> member for it.
+  explicit constexpr AsyncInitiator(std::span<AsyncTransaction> queue)
+      : queue_(queue), head_(0), count_(0), busy_(false) {}
+
+  // Called by the backend when the transaction passed to DoStart() finishes.
+  void Complete(Status status) PW_LOCKS_EXCLUDED(lock_);
+
+ private:
+  // Begins the transaction on the bus without blocking. The backend must call
+  // Complete() once it finishes, but not from within DoStart(). The transaction
+  // is not modified or removed from the queue until then.
+  virtual void DoStart(const AsyncTransaction& transaction) = 0;
+
+  AsyncTransaction& slot(size_t index) PW_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    return queue_[(head_ + index) % queue_.size()];
+  }
+
+  mutable sync::InterruptSpinLock lock_;
+  const std::span<AsyncTransaction> queue_;
+  size_t head_ PW_GUARDED_BY(lock_);
+  size_t count_ PW_GUARDED_BY(lock_);
+
+  // True from when a transaction is started until the queue empties.
+  bool busy_ PW_GUARDED_BY(lock_);
+};
+
+}  // namespace pw::i2c
@@ -0,0 +1,253 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_i2c/register_device.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_status/try.h"
+
+namespace pw::i2c {
+
+// Write-back cache of a range of registers on a RegisterDevice. Reads are
+// served from the cache once a register has been read, and writes only update
+// the cache until Flush() writes them to the device. This avoids the bus reads
+// of read-modify-write sequences and combines writes to nearby registers into
+// burst writes.
+//
+// Only cache registers that have no side effects and that the device does not
+// change by itself, such as configuration registers. Status and data registers
+// must be accessed through the RegisterDevice directly.
+//
+// The registers are at consecutive addresses, starting at
+// first_register_address. RegisterType is the size of each register: uint8_t,
+// uint16_t, or uint32_t.
+//
+// RegisterCache is not thread safe.
+template <typename RegisterType, size_t kRegisterCount>
+class RegisterCache {
+ public:
+  static_assert(std::is_same_v<RegisterType, uint8_t> ||
+                    std::is_same_v<RegisterType, uint16_t> ||
+                    std::is_same_v<RegisterType, uint32_t>,
+                "Registers must be uint8_t, uint16_t, or uint32_t");
+  static_assert(kRegisterCount > 0);
+
+  constexpr RegisterCache(RegisterDevice& device,
+                          uint32_t first_register_address)
+      : device_(device),
+        first_register_address_(first_register_address),
+        values_{} {}
+
+  RegisterCache(const RegisterCache&) = delete;
+  RegisterCache& operator=(const RegisterCache&) = delete;
+
+  // Returns a register's value, reading it from the device only if it is not
+  // already cached.
+  //
+  // Returns:
+  //   OutOfRange: The register is not in the cached range.
+  //   Otherwise, the same statuses as RegisterDevice::ReadRegisters.
+  Result<RegisterType> Read(uint32_t register_address,
+                            chrono::SystemClock::duration for_at_least);
+
+  // Sets a register's value in the cache. The device is not written until
+  // Flush() is called.
+  //
+  // Returns:
+  //   Ok: The value was cached.
+  //   OutOfRange: The register is not in the cached range.
+  Status Write(uint32_t register_address, RegisterType value);
+
+  // Replaces the bits in mask with those in value. The register is read from
+  // the device only if it is not already cached; the write is deferred until
+  // Flush().
+  Status Modify(uint32_t register_address,
+                RegisterType mask,
+                RegisterType value,
+                chrono::SystemClock::duration for_at_least);
+
+  // Reads every register in the range from the device in one transaction.
+  // Registers with unflushed writes keep their cached values.
+  Status Fetch(chrono::SystemClock::duration for_at_least);
+
+  // Writes all registers with unflushed writes to the device. Runs of written
+  // registers are sent as single burst writes. Clean registers between them
+  // whose values are cached are rewritten with those values, rather than
+  // splitting the burst, so each run of cached registers takes at most one
+  // transaction.
+  //
+  // On error, the registers that were not written remain dirty.
+  Status Flush(chrono::SystemClock::duration for_at_least);
+
+  // Forgets all cached values, including any unflushed writes. Call this if
+  // the device may have been reset.
+  void Invalidate() {
+    valid_.reset();
+    dirty_.reset();
+  }
+
+  // True if there are writes that have not been flushed.
+  bool dirty() const { return dirty_.any(); }
+
+ private:
+  // Returns the index of the register in values_, or kRegisterCount if it is
+  // outside the cached range.
+  size_t Index(uint32_t register_address) const {
+    const uint32_t offset = register_address - first_register_address_;
+    return register_address < first_register_address_ ||
+                   offset >= kRegisterCount
+               ? kRegisterCount
+               : offset;
+  }
+
+  Status ReadFromDevice(size_t index,
+                        std::span<RegisterType> values,
+                        chrono::SystemClock::duration for_at_least);
+
+  Status WriteToDevice(size_t index,
+                       size_t count,
+                       chrono::SystemClock::duration for_at_least);
+
+  RegisterDevice& device_;
+  const uint32_t first_register_address_;
+  std::array<RegisterType, kRegisterCount> values_;
+  std::bitset<kRegisterCount> valid_;
+  std::bitset<kRegisterCount> dirty_;
+};
+
+template <typename RegisterType, size_t kRegisterCount>
+Result<RegisterType> RegisterCache<RegisterType, kRegisterCount>::Read(
+    uint32_t register_address, chrono::SystemClock::duration for_at_least) {
+  const size_t index = Index(register_address);
+  if (index == kRegisterCount) {
+    return Status::OutOfRange();
+  }
+  if (!valid_[index]) {
+    PW_TRY(ReadFromDevice(
+        index, std::span(values_).subspan(index, 1), for_at_least));
+    valid_.set(index);
+  }
+  return values_[index];
+}
+
+template <typename RegisterType, size_t kRegisterCount>
+Status RegisterCache<RegisterType, kRegisterCount>::Write(
+    uint32_t register_address, RegisterType value) {
+  const size_t index = Index(register_address);
+  if (index == kRegisterCount) {
+    return Status::OutOfRange();
+  }
+  values_[index] = value;
+  valid_.set(index);
+  dirty_.set(index);
+  return OkStatus();
+}
+
+template <typename RegisterType, size_t kRegisterCount>
+Status RegisterCache<RegisterType, kRegisterCount>::Modify(
+    uint32_t register_address,
+    RegisterType mask,
+    RegisterType value,
+    chrono::SystemClock::duration for_at_least) {
+  PW_TRY_ASSIGN(const RegisterType current,
+                Read(register_address, for_at_least));
+  return Write(register_address,
+               static_cast<RegisterType>((current & ~mask) | (value & mask)));
+}
+
+template <typename RegisterType, size_t kRegisterCount>
+Status RegisterCache<RegisterType, kRegisterCount>::Fetch(
+    chrono::SystemClock::duration for_at_least) {
+  std::array<RegisterType, kRegisterCount> values;
+  PW_TRY(ReadFromDevice(0, values, for_at_least));
+
+  for (size_t i = 0; i < kRegisterCount; ++i) {
+    if (!dirty_[i]) {
+      values_[i] = values[i];
+    }
+  }
+  valid_.set();
+  return OkStatus();
+}
+
+template <typename RegisterType, size_t kRegisterCount>
+Status RegisterCache<RegisterType, kRegisterCount>::Flush(
+    chrono::SystemClock::duration for_at_least) {
+  size_t start = 0;
+  while (start < kRegisterCount) {
+    if (!dirty_[start]) {
+      start += 1;
+      continue;
+    }
+
+    // Extend the burst over cached registers, ending at the last dirty one.
+    size_t last_dirty = start;
+    for (size_t i = start + 1; i < kRegisterCount && valid_[i]; ++i) {
+      if (dirty_[i]) {
+        last_dirty = i;
+      }
+    }
+
+    PW_TRY(WriteToDevice(start, last_dirty + 1 - start, for_at_least));
+    for (size_t i = start; i <= last_dirty; ++i) {
+      dirty_.reset(i);
+    }
+    start = last_dirty + 1;
+  }
+  return OkStatus();
+}
+
+template <typename RegisterType, size_t kRegisterCount>
+Status RegisterCache<RegisterType, kRegisterCount>::ReadFromDevice(
+    size_t index,
+    std::span<RegisterType> values,
+    chrono::SystemClock::duration for_at_least) {
+  const uint32_t address = first_register_address_ + index;
+  if constexpr (std::is_same_v<RegisterType, uint8_t>) {
+    return device_.ReadRegisters8(address, values, for_at_least);
+  } else if constexpr (std::is_same_v<RegisterType, uint16_t>) {
+    return device_.ReadRegisters16(address, values, for_at_least);
+  } else {
+    return device_.ReadRegisters32(address, values, for_at_least);
+  }
+}
+
+template <typename RegisterType, size_t kRegisterCount>
+Status RegisterCache<RegisterType, kRegisterCount>::WriteToDevice(
+    size_t index, size_t count, chrono::SystemClock::duration for_at_least) {
+  // Room for the largest register address followed by every register.
+  std::array<std::byte, sizeof(uint32_t) + sizeof(values_)> buffer;
+  const uint32_t address = first_register_address_ + index;
+  const auto values =
+      std::span<const RegisterType>(values_).subspan(index, count);
+
+  if constexpr (std::is_same_v<RegisterType, uint8_t>) {
+    return device_.WriteRegisters8(address, values, buffer, for_at_least);
+  } else if constexpr (std::is_same_v<RegisterType, uint16_t>) {
+    return device_.WriteRegisters16(address, values, buffer, for_at_least);
+  } else {
+    return device_.WriteRegisters32(address, values, buffer, for_at_least);
+  }
+}
+
+}  // namespace pw::i2c
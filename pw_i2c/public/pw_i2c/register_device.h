@@ -13,6 +13,9 @@
 // the License.
 #pragma once
 
+#include <cstring>
+#include <type_traits>
+
 #include "pw_bytes/endian.h"
 #include "pw_bytes/span.h"
 #include "pw_chrono/system_clock.h"
@@ -56,6 +59,10 @@ enum class RegisterAddressSize {
 //  - ReadRegister*
 //       Read data to a register where the max register size is 4 bytes.
 //       Endianness will be applied to data that's read or written.
+//
+//  - ReadRegisterBlock
+//       Read a set of registers into a struct in a single transaction.
+//       Endianness will be applied to each register.
 class RegisterDevice : public Device {
  public:
   // Args:
@@ -216,6 +223,28 @@ class RegisterDevice : public Device {
   Result<uint32_t> ReadRegister32(uint32_t register_address,
                                   chrono::SystemClock::duration for_at_least);
 
+  // Reads a block of contiguous registers into a struct in one transaction.
+  // T must be trivially copyable and made up only of RegisterType members
+  // (uint8_t, uint16_t, or uint32_t) in register order, with no padding. Each
+  // register is converted from the device's endianness.
+  //
+  //   struct AccelSample {
+  //     uint16_t x;
+  //     uint16_t y;
+  //     uint16_t z;
+  //   };
+  //   Result<AccelSample> sample =
+  //       device.ReadRegisterBlock<uint16_t, AccelSample>(kOutX, kTimeout);
+  //
+  // Args:
+  //   register_address: Address of the first register in the block.
+  //   for_at_least: Timeout that's used for both lock and transaction (ms).
+  // Returns:
+  //   The same statuses as ReadRegisters.
+  template <typename RegisterType, typename T>
+  Result<T> ReadRegisterBlock(uint32_t register_address,
+                              chrono::SystemClock::duration for_at_least);
+
  private:
   // Helper write registers.
   Status WriteRegisters(uint32_t register_address,
@@ -398,6 +427,31 @@ inline Result<uint32_t> RegisterDevice::ReadRegister32(
   return data[0];
 }
 
+template <typename RegisterType, typename T>
+Result<T> RegisterDevice::ReadRegisterBlock(
+    uint32_t register_address, chrono::SystemClock::duration for_at_least) {
+  static_assert(std::is_same_v<RegisterType, uint8_t> ||
+                    std::is_same_v<RegisterType, uint16_t> ||
+                    std::is_same_v<RegisterType, uint32_t>,
+                "Registers must be uint8_t, uint16_t, or uint32_t");
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(sizeof(T) % sizeof(RegisterType) == 0,
+                "The block must be a whole number of registers");
+
+  T block;
+  const ByteSpan data = std::as_writable_bytes(std::span(&block, 1));
+  PW_TRY(ReadRegisters(register_address, data, for_at_least));
+
+  if constexpr (sizeof(RegisterType) > 1) {
+    for (size_t i = 0; i < data.size(); i += sizeof(RegisterType)) {
+      const RegisterType value =
+          bytes::ReadInOrder<RegisterType>(order_, &data[i]);
+      std::memcpy(&data[i], &value, sizeof(value));
+    }
+  }
+  return block;
+}
+
 }  // namespace i2c
 }  // namespace pw
 
@@ -0,0 +1,197 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_i2c/register_cache.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+
+namespace pw::i2c {
+namespace {
+
+using namespace std::literals::chrono_literals;
+
+constexpr Address kDeviceAddress = Address::SevenBit<0x3F>();
+
+constexpr chrono::SystemClock::duration kTimeout =
+    std::chrono::duration_cast<chrono::SystemClock::duration>(100ms);
+
+// Simulates a device with byte-wide registers and a 1 byte register address
+// that auto-increments during burst reads and writes.
+class FakeRegisterFile : public Initiator {
+ public:
+  std::array<uint8_t, 32> registers = {};
+  int reads = 0;
+  int writes = 0;
+
+ private:
+  Status DoWriteReadFor(Address,
+                        ConstByteSpan tx_data,
+                        ByteSpan rx_data,
+                        chrono::SystemClock::duration) override {
+    if (tx_data.empty()) {
+      return Status::InvalidArgument();
+    }
+    size_t address = static_cast<uint8_t>(tx_data[0]);
+
+    if (!rx_data.empty()) {
+      reads += 1;
+      for (std::byte& b : rx_data) {
+        b = std::byte{registers.at(address++)};
+      }
+    } else {
+      writes += 1;
+      for (std::byte b : tx_data.subspan(1)) {
+        registers.at(address++) = static_cast<uint8_t>(b);
+      }
+    }
+    return OkStatus();
+  }
+};
+
+class RegisterCacheTest : public ::testing::Test {
+ protected:
+  RegisterCacheTest()
+      : device_(bus_,
+                kDeviceAddress,
+                std::endian::little,
+                RegisterAddressSize::k1Byte),
+        cache_(device_, kFirstRegister) {}
+
+  static constexpr uint32_t kFirstRegister = 0x10;
+
+  FakeRegisterFile bus_;
+  RegisterDevice device_;
+  RegisterCache<uint8_t, 8> cache_;
+};
+
+TEST_F(RegisterCacheTest, Read_OnlyReadsDeviceOnce) {
+  bus_.registers[0x12] = 0xAB;
+
+  Result<uint8_t> value = cache_.Read(0x12, kTimeout);
+  ASSERT_EQ(OkStatus(), value.status());
+  EXPECT_EQ(value.value(), 0xAB);
+
+  bus_.registers[0x12] = 0xCD;
+  value = cache_.Read(0x12, kTimeout);
+  ASSERT_EQ(OkStatus(), value.status());
+  EXPECT_EQ(value.value(), 0xAB);
+  EXPECT_EQ(bus_.reads, 1);
+}
+
+TEST_F(RegisterCacheTest, OutsideRange_OutOfRange) {
+  EXPECT_EQ(Status::OutOfRange(), cache_.Read(0x0F, kTimeout).status());
+  EXPECT_EQ(Status::OutOfRange(), cache_.Read(0x18, kTimeout).status());
+  EXPECT_EQ(Status::OutOfRange(), cache_.Write(0x18, 1));
+  EXPECT_EQ(bus_.reads, 0);
+}
+
+TEST_F(RegisterCacheTest, Write_DeferredUntilFlush) {
+  EXPECT_EQ(OkStatus(), cache_.Write(0x11, 0x42));
+  EXPECT_TRUE(cache_.dirty());
+  EXPECT_EQ(bus_.registers[0x11], 0);
+  EXPECT_EQ(bus_.writes, 0);
+
+  // Written values are readable without touching the bus.
+  Result<uint8_t> value = cache_.Read(0x11, kTimeout);
+  ASSERT_EQ(OkStatus(), value.status());
+  EXPECT_EQ(value.value(), 0x42);
+  EXPECT_EQ(bus_.reads, 0);
+
+  EXPECT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_FALSE(cache_.dirty());
+  EXPECT_EQ(bus_.registers[0x11], 0x42);
+  EXPECT_EQ(bus_.writes, 1);
+
+  // Nothing left to write.
+  EXPECT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(bus_.writes, 1);
+}
+
+TEST_F(RegisterCacheTest, Modify_ReadsOnlyOnce) {
+  bus_.registers[0x13] = 0b1010'0000;
+
+  EXPECT_EQ(OkStatus(), cache_.Modify(0x13, 0b0000'0011, 0b01, kTimeout));
+  EXPECT_EQ(OkStatus(), cache_.Modify(0x13, 0b1000'0000, 0, kTimeout));
+  EXPECT_EQ(bus_.reads, 1);
+
+  EXPECT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(bus_.registers[0x13], 0b0010'0001);
+  EXPECT_EQ(bus_.writes, 1);
+}
+
+TEST_F(RegisterCacheTest, Fetch_ReadsAllInOneBurstAndKeepsWrites) {
+  for (uint8_t i = 0; i < 8; ++i) {
+    bus_.registers[kFirstRegister + i] = 0x80 + i;
+  }
+  EXPECT_EQ(OkStatus(), cache_.Write(0x12, 0x01));
+
+  EXPECT_EQ(OkStatus(), cache_.Fetch(kTimeout));
+  EXPECT_EQ(bus_.reads, 1);
+
+  for (uint8_t i = 0; i < 8; ++i) {
+    Result<uint8_t> value = cache_.Read(kFirstRegister + i, kTimeout);
+    ASSERT_EQ(OkStatus(), value.status());
+    EXPECT_EQ(value.value(), i == 2 ? 0x01 : 0x80 + i);
+  }
+  EXPECT_EQ(bus_.reads, 1);
+}
+
+TEST_F(RegisterCacheTest, Flush_CoalescesOverCachedRegisters) {
+  ASSERT_EQ(OkStatus(), cache_.Fetch(kTimeout));
+  EXPECT_EQ(OkStatus(), cache_.Write(0x10, 1));
+  EXPECT_EQ(OkStatus(), cache_.Write(0x13, 2));
+  EXPECT_EQ(OkStatus(), cache_.Write(0x15, 3));
+
+  // All registers are cached, so one burst covers 0x10 to 0x15.
+  EXPECT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(bus_.writes, 1);
+  EXPECT_EQ(bus_.registers[0x10], 1);
+  EXPECT_EQ(bus_.registers[0x13], 2);
+  EXPECT_EQ(bus_.registers[0x15], 3);
+}
+
+TEST_F(RegisterCacheTest, Flush_SplitsAtUncachedRegisters) {
+  EXPECT_EQ(OkStatus(), cache_.Write(0x10, 1));
+  EXPECT_EQ(OkStatus(), cache_.Write(0x11, 2));
+  EXPECT_EQ(OkStatus(), cache_.Write(0x14, 3));
+  bus_.registers[0x12] = 0x77;
+
+  // 0x12 and 0x13 were never read, so they must not be overwritten.
+  EXPECT_EQ(OkStatus(), cache_.Flush(kTimeout));
+  EXPECT_EQ(bus_.writes, 2);
+  EXPECT_EQ(bus_.registers[0x10], 1);
+  EXPECT_EQ(bus_.registers[0x11], 2);
+  EXPECT_EQ(bus_.registers[0x12], 0x77);
+  EXPECT_EQ(bus_.registers[0x14], 3);
+}
+
+TEST_F(RegisterCacheTest, Invalidate_RereadsDevice) {
+  bus_.registers[0x10] = 5;
+  ASSERT_EQ(OkStatus(), cache_.Read(0x10, kTimeout).status());
+  EXPECT_EQ(OkStatus(), cache_.Write(0x11, 1));
+
+  cache_.Invalidate();
+  EXPECT_FALSE(cache_.dirty());
+
+  bus_.registers[0x10] = 6;
+  Result<uint8_t> value = cache_.Read(0x10, kTimeout);
+  ASSERT_EQ(OkStatus(), value.status());
+  EXPECT_EQ(value.value(), 6);
+  EXPECT_EQ(bus_.reads, 2);
+}
+
+}  // namespace
+}  // namespace pw::i2c
@@ -751,6 +751,43 @@ TEST(RegisterDevice, ReadRegister16With2ByteAddressAndBigEndian) {
   }
 }
 
+struct TestBlock {
+  uint16_t first;
+  uint16_t second;
+  uint16_t third;
+};
+
+TEST(RegisterDevice, ReadRegisterBlock16With1ByteAddressAndBigEndian) {
+  TestInitiator initiator;
+  RegisterDevice device(initiator,
+                        kDummyDeviceAddress,
+                        std::endian::big,
+                        RegisterAddressSize::k1Byte);
+
+  std::array<std::byte, 6> register_data = {std::byte{0x12},
+                                            std::byte{0x34},
+                                            std::byte{0x56},
+                                            std::byte{0x78},
+                                            std::byte{0x9A},
+                                            std::byte{0xBC}};
+  initiator.SetReadData(register_data);
+
+  constexpr uint32_t kRegisterAddress = 0xAB;
+  Result<TestBlock> result =
+      device.ReadRegisterBlock<uint16_t, TestBlock>(kRegisterAddress, kTimeout);
+  ASSERT_EQ(result.status(), pw::OkStatus());
+
+  // Check address. The whole block is read in one transaction.
+  ByteBuilder& address_buffer = initiator.GetWriteBuffer();
+  ASSERT_EQ(1u, address_buffer.size());
+  EXPECT_EQ(kRegisterAddress, static_cast<uint32_t>(address_buffer.data()[0]));
+
+  // Check data.
+  EXPECT_EQ(result.value().first, 0x1234u);
+  EXPECT_EQ(result.value().second, 0x5678u);
+  EXPECT_EQ(result.value().third, 0x9ABCu);
+}
+
 }  // namespace
 }  // namespace i2c
 }  // namespace pw
@@ -0,0 +1,75 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_interrupt/instrumentation.h"
+
+#include <chrono>
+#include <limits>
+
+namespace pw::interrupt {
+namespace {
+
+uint32_t ToNanoseconds(chrono::HighResolutionClock::duration duration) {
+  const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  if (ns <= 0) {
+    return 0;
+  }
+  if (static_cast<uint64_t>(ns) > std::numeric_limits<uint32_t>::max()) {
+    return std::numeric_limits<uint32_t>::max();
+  }
+  return static_cast<uint32_t>(ns);
+}
+
+uint32_t SaturatingAdd(uint32_t a, uint32_t b) {
+  const uint32_t sum = a + b;
+  return sum < a ? std::numeric_limits<uint32_t>::max() : sum;
+}
+
+}  // namespace
+
+uint32_t InterruptMetrics::mean_duration_ns() const {
+  const uint32_t runs = count();
+  if (runs == 0u) {
+    return 0;
+  }
+  const uint64_t total_ns = uint64_t{total_duration_us()} * 1000u + pending_ns_;
+  const uint64_t mean = total_ns / runs;
+  return mean > std::numeric_limits<uint32_t>::max()
+             ? std::numeric_limits<uint32_t>::max()
+             : static_cast<uint32_t>(mean);
+}
+
+void InterruptMetrics::Stop() {
+  const uint32_t duration_ns =
+      ToNanoseconds(chrono::HighResolutionClock::now() - started_at_);
+
+  count_.Increment();
+  duration_ns_.Record(duration_ns);
+
+  // Add whole microseconds to the total and carry the remainder, using only
+  // 32-bit division so this stays cheap in interrupt handlers.
+  uint32_t whole_us = duration_ns / 1000u;
+  uint32_t remainder_ns = pending_ns_ + duration_ns % 1000u;
+  if (remainder_ns >= 1000u) {
+    whole_us += 1;
+    remainder_ns -= 1000u;
+  }
+  pending_ns_ = remainder_ns;
+  if (whole_us != 0u) {
+    total_duration_us_.Set(SaturatingAdd(total_duration_us_.value(), whole_us));
+  }
+}
+
+}  // namespace pw::interrupt
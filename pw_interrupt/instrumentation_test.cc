@@ -0,0 +1,129 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_interrupt/instrumentation.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+namespace pw::interrupt {
+namespace {
+
+constexpr metric::Token kName = 0x49525130;
+
+void BusyWait(std::chrono::nanoseconds duration) {
+  const auto deadline = chrono::HighResolutionClock::now() + duration;
+  while (chrono::HighResolutionClock::now() < deadline) {
+  }
+}
+
+// Stands in for a lock that masks interrupts.
+class FakeLock {
+ public:
+  void lock() { locked_ = true; }
+  bool try_lock() {
+    if (locked_) {
+      return false;
+    }
+    locked_ = true;
+    return true;
+  }
+  void unlock() { locked_ = false; }
+
+ private:
+  bool locked_ = false;
+};
+
+TEST(InterruptMetrics, InitialState) {
+  InterruptMetrics metrics(kName);
+  EXPECT_EQ(metrics.count(), 0u);
+  EXPECT_EQ(metrics.total_duration_us(), 0u);
+  EXPECT_EQ(metrics.max_duration_ns(), 0u);
+  EXPECT_EQ(metrics.mean_duration_ns(), 0u);
+  EXPECT_EQ(metrics.group().name(), kName);
+  EXPECT_EQ(metrics.group().metrics().size(), 2u);
+  EXPECT_EQ(metrics.group().histograms().size(), 1u);
+}
+
+TEST(InterruptMetrics, Scope_RecordsDuration) {
+  InterruptMetrics metrics(kName);
+  {
+    InterruptMetrics::Scope scope(metrics);
+    BusyWait(200us);
+  }
+
+  EXPECT_EQ(metrics.count(), 1u);
+  EXPECT_GE(metrics.max_duration_ns(), 200'000u);
+  EXPECT_GE(metrics.total_duration_us(), 200u);
+  EXPECT_EQ(metrics.durations().count(), 1u);
+}
+
+TEST(InterruptMetrics, MeanAndMax) {
+  InterruptMetrics metrics(kName);
+  metrics.Start();
+  BusyWait(1ms);
+  metrics.Stop();
+  const uint32_t longest_ns = metrics.max_duration_ns();
+
+  for (int i = 0; i < 3; ++i) {
+    metrics.Start();
+    metrics.Stop();
+  }
+
+  EXPECT_EQ(metrics.count(), 4u);
+  EXPECT_EQ(metrics.max_duration_ns(), longest_ns);
+  EXPECT_LT(metrics.mean_duration_ns(), longest_ns);
+  EXPECT_GE(metrics.mean_duration_ns(), longest_ns / 4);
+}
+
+TEST(InterruptMetrics, ShortDurationsAddUpInTotal) {
+  InterruptMetrics metrics(kName);
+  for (int i = 0; i < 100; ++i) {
+    metrics.Start();
+    BusyWait(20us);
+    metrics.Stop();
+  }
+
+  // Durations under a microsecond are carried rather than dropped, so the
+  // total is at least the sum of the waits.
+  EXPECT_GE(metrics.total_duration_us(), 2000u);
+  EXPECT_GE(metrics.mean_duration_ns(), 20'000u);
+}
+
+TEST(InstrumentedInterruptLock, RecordsHoldTime) {
+  InstrumentedInterruptLock<FakeLock> lock(kName);
+  lock.lock();
+  BusyWait(100us);
+  lock.unlock();
+
+  {
+    std::lock_guard guard(lock);
+  }
+
+  ASSERT_TRUE(lock.try_lock());
+  EXPECT_FALSE(lock.try_lock());
+  lock.unlock();
+
+  const InterruptMetrics& metrics = lock.interrupt_metrics();
+  EXPECT_EQ(metrics.count(), 3u);
+  EXPECT_GE(metrics.max_duration_ns(), 100'000u);
+  EXPECT_EQ(lock.metrics().name(), kName);
+}
+
+}  // namespace
+}  // namespace pw::interrupt
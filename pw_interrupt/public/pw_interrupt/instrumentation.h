@@ -0,0 +1,152 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_chrono/high_resolution_clock.h"
+#include "pw_metric/metric.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw::interrupt {
+
+// Timing statistics for an interrupt handler or for a section of code that runs
+// with interrupts masked, recorded as a pw_metric group:
+//
+//   count              Number of times the handler or section ran.
+//   total_duration_us  Total time spent, in microseconds.
+//   duration_ns        Histogram of durations, in nanoseconds. Its max is the
+//                      longest single duration.
+//
+// Durations are measured with pw::chrono::HighResolutionClock. The total
+// saturates at UINT32_MAX. A handler's duration includes the time spent in any
+// higher priority interrupts that preempt it.
+//
+// Only one context may use an InterruptMetrics at a time, which holds for an
+// interrupt handler or a lock that masks interrupts.
+class InterruptMetrics {
+ public:
+  // Durations of 2^22 ns (about 4 ms) and longer share the last bucket.
+  static constexpr size_t kDurationBuckets = 24;
+
+  explicit InterruptMetrics(metric::Token name) : group_(name) {}
+
+  InterruptMetrics(const InterruptMetrics&) = delete;
+  InterruptMetrics& operator=(const InterruptMetrics&) = delete;
+
+  metric::Group& group() { return group_; }
+  const metric::Group& group() const { return group_; }
+
+  uint32_t count() const { return count_.value(); }
+  uint32_t total_duration_us() const { return total_duration_us_.value(); }
+  uint32_t max_duration_ns() const { return duration_ns_.max(); }
+  const metric::Histogram& durations() const { return duration_ns_; }
+
+  // The mean duration in nanoseconds, or 0 if nothing was recorded.
+  uint32_t mean_duration_ns() const;
+
+  // Marks the start of the handler or section.
+  void Start() { started_at_ = chrono::HighResolutionClock::now(); }
+
+  // Marks the end of the handler or section and records its duration.
+  void Stop();
+
+  // Records the duration of a scope, such as an interrupt handler:
+  //
+  //   void UART0_IRQHandler() {
+  //     pw::interrupt::InterruptMetrics::Scope scope(uart0_irq_metrics);
+  //     ...
+  //   }
+  //
+  class Scope {
+   public:
+    explicit Scope(InterruptMetrics& metrics) : metrics_(metrics) {
+      metrics_.Start();
+    }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope() { metrics_.Stop(); }
+
+   private:
+    InterruptMetrics& metrics_;
+  };
+
+ private:
+  metric::Group group_;
+  PW_METRIC(group_, count_, "count", 0u);
+  PW_METRIC(group_, total_duration_us_, "total_duration_us", 0u);
+  PW_METRIC_HISTOGRAM(group_, duration_ns_, "duration_ns", kDurationBuckets);
+
+  // Nanoseconds not yet added to total_duration_us_, so that short durations
+  // are not lost to rounding.
+  uint32_t pending_ns_ = 0;
+
+  chrono::HighResolutionClock::time_point started_at_;
+};
+
+// InstrumentedInterruptLock wraps a lock that masks interrupts while it is
+// held, such as pw::sync::InterruptSpinLock, and records how long interrupts
+// are masked by it. It has the same API as the wrapped lock, so it can replace
+// a lock to find critical sections that delay interrupt handling:
+//
+//   pw::interrupt::InstrumentedInterruptLock<pw::sync::InterruptSpinLock>
+//       uart_lock(PW_TOKENIZE_STRING_DOMAIN("metrics", "uart_lock"));
+//
+//   parent_metrics.Add(uart_lock.metrics());
+//
+// The time spent waiting for the lock is not included, only the time it is
+// held.
+template <typename Lock>
+class PW_LOCKABLE("pw::interrupt::InstrumentedInterruptLock")
+    InstrumentedInterruptLock {
+ public:
+  explicit InstrumentedInterruptLock(metric::Token name) : metrics_(name) {}
+
+  InstrumentedInterruptLock(const InstrumentedInterruptLock&) = delete;
+  InstrumentedInterruptLock& operator=(const InstrumentedInterruptLock&) =
+      delete;
+
+  void lock() PW_EXCLUSIVE_LOCK_FUNCTION() PW_NO_LOCK_SAFETY_ANALYSIS {
+    lock_.lock();
+    metrics_.Start();
+  }
+
+  bool try_lock() PW_EXCLUSIVE_TRYLOCK_FUNCTION(true)
+      PW_NO_LOCK_SAFETY_ANALYSIS {
+    if (!lock_.try_lock()) {
+      return false;
+    }
+    metrics_.Start();
+    return true;
+  }
+
+  void unlock() PW_UNLOCK_FUNCTION() PW_NO_LOCK_SAFETY_ANALYSIS {
+    metrics_.Stop();
+    lock_.unlock();
+  }
+
+  // The metric group, to add to a parent group or dump.
+  metric::Group& metrics() { return metrics_.group(); }
+
+  // The recorded statistics.
+  const InterruptMetrics& interrupt_metrics() const { return metrics_; }
+
+ private:
+  Lock lock_;
+  InterruptMetrics metrics_;
+};
+
+}  // namespace pw::interrupt
@@ -0,0 +1,247 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/async_flash_memory.h"
+
+#include <array>
+#include <cstring>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+// An AsyncFlashMemory backed by a FakeFlashMemory. Operations either complete
+// before the Start function returns or, if deferred, when Complete is called.
+class FakeAsyncFlashMemory final : public AsyncFlashMemory {
+ public:
+  FakeAsyncFlashMemory()
+      : AsyncFlashMemory(512, 4, 16), flash_(16), deferred_(false) {}
+
+  Status Enable() override { return OkStatus(); }
+  Status Disable() override { return OkStatus(); }
+  bool IsEnabled() const override { return true; }
+
+  Status StartErase(Address address,
+                    size_t num_sectors,
+                    Callback&& callback) override {
+    return Start(Operation{.type = Operation::kErase,
+                           .address = address,
+                           .num_sectors = num_sectors,
+                           .read = {},
+                           .write = {}},
+                 std::move(callback));
+  }
+
+  Status StartRead(Address address,
+                   std::span<std::byte> output,
+                   Callback&& callback) override {
+    return Start(Operation{.type = Operation::kRead,
+                           .address = address,
+                           .num_sectors = 0,
+                           .read = output,
+                           .write = {}},
+                 std::move(callback));
+  }
+
+  Status StartWrite(Address address,
+                    std::span<const std::byte> data,
+                    Callback&& callback) override {
+    return Start(Operation{.type = Operation::kWrite,
+                           .address = address,
+                           .num_sectors = 0,
+                           .read = {},
+                           .write = data},
+                 std::move(callback));
+  }
+
+  // Runs the pending operation and calls its callback.
+  void Complete() {
+    StatusWithSize result;
+    switch (pending_.type) {
+      case Operation::kErase:
+        result = StatusWithSize(
+            flash_.Erase(pending_.address, pending_.num_sectors), 0);
+        break;
+      case Operation::kRead:
+        result = flash_.Read(pending_.address, pending_.read);
+        break;
+      case Operation::kWrite:
+        result = flash_.Write(pending_.address, pending_.write);
+        break;
+    }
+    Callback callback = std::move(callback_);
+    callback_ = nullptr;
+    callback(std::move(result));
+  }
+
+  bool busy() const { return callback_ != nullptr; }
+
+  void set_deferred(bool deferred) { deferred_ = deferred; }
+
+  std::span<std::byte> buffer() { return flash_.buffer(); }
+
+ private:
+  struct Operation {
+    enum { kErase, kRead, kWrite } type;
+    Address address;
+    size_t num_sectors;
+    std::span<std::byte> read;
+    std::span<const std::byte> write;
+  };
+
+  Status Start(const Operation& operation, Callback&& callback) {
+    if (busy()) {
+      return Status::Unavailable();
+    }
+    pending_ = operation;
+    callback_ = std::move(callback);
+    if (!deferred_) {
+      Complete();
+    }
+    return OkStatus();
+  }
+
+  FakeFlashMemoryBuffer<512, 4> flash_;
+  bool deferred_;
+  Operation pending_;
+  Callback callback_;
+};
+
+class AsyncFlash : public ::testing::Test {
+ protected:
+  AsyncFlash() : partition_(&flash_) {}
+
+  FakeAsyncFlashMemory flash_;
+  AsyncFlashPartition partition_;
+};
+
+TEST_F(AsyncFlash, BlockingOperations) {
+  ASSERT_EQ(OkStatus(), partition_.Erase());
+
+  std::array<std::byte, 32> data;
+  data.fill(std::byte{0x5a});
+  StatusWithSize result = partition_.Write(512, data);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(data.size(), result.size());
+
+  std::array<std::byte, 32> read{};
+  result = partition_.Read(512, read);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(data.size(), result.size());
+  EXPECT_EQ(data, read);
+}
+
+TEST_F(AsyncFlash, BlockingOperation_FailsIfBusy) {
+  flash_.set_deferred(true);
+  ASSERT_EQ(OkStatus(), partition_.StartErase(0, 1, [](StatusWithSize) {}));
+
+  std::array<std::byte, 16> read;
+  EXPECT_EQ(Status::Unavailable(), partition_.Read(0, read).status());
+  flash_.Complete();
+}
+
+TEST_F(AsyncFlash, StartWrite_CompletesLater) {
+  ASSERT_EQ(OkStatus(), partition_.Erase());
+  flash_.set_deferred(true);
+
+  std::array<std::byte, 16> data;
+  data.fill(std::byte{0x42});
+
+  std::optional<StatusWithSize> write_result;
+  ASSERT_EQ(OkStatus(),
+            partition_.StartWrite(1024, data, [&](StatusWithSize result) {
+              write_result = result;
+            }));
+  EXPECT_FALSE(write_result.has_value());
+  EXPECT_EQ(std::byte{0xff}, flash_.buffer()[1024]);
+
+  flash_.Complete();
+  ASSERT_TRUE(write_result.has_value());
+  EXPECT_EQ(OkStatus(), write_result->status());
+  EXPECT_EQ(data.size(), write_result->size());
+  EXPECT_EQ(0, std::memcmp(&flash_.buffer()[1024], data.data(), data.size()));
+}
+
+TEST_F(AsyncFlash, StartErase_CompletesLater) {
+  ASSERT_EQ(OkStatus(), partition_.Erase());
+  std::array<std::byte, 16> data{};
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data).status());
+  flash_.set_deferred(true);
+
+  Status erase_status = Status::Unknown();
+  ASSERT_EQ(OkStatus(),
+            partition_.StartErase(0, 1, [&](StatusWithSize result) {
+              erase_status = result.status();
+            }));
+  EXPECT_EQ(std::byte{0}, flash_.buffer()[0]);
+
+  flash_.Complete();
+  EXPECT_EQ(OkStatus(), erase_status);
+  EXPECT_EQ(std::byte{0xff}, flash_.buffer()[0]);
+}
+
+TEST_F(AsyncFlash, Start_ChecksArguments) {
+  std::array<std::byte, 16> data{};
+  const auto unused = [](StatusWithSize) { FAIL(); };
+
+  EXPECT_EQ(Status::OutOfRange(), partition_.StartRead(2040, data, unused));
+  EXPECT_EQ(Status::OutOfRange(), partition_.StartErase(0, 5, unused));
+  EXPECT_EQ(Status::InvalidArgument(), partition_.StartErase(16, 1, unused));
+  EXPECT_EQ(Status::InvalidArgument(), partition_.StartWrite(8, data, unused));
+  EXPECT_EQ(Status::InvalidArgument(),
+            partition_.StartWrite(0, std::span(data).first(8), unused));
+  EXPECT_FALSE(flash_.busy());
+}
+
+TEST_F(AsyncFlash, Start_ReadOnlyPartition) {
+  AsyncFlashPartition read_only(
+      &flash_, 0, 4, 16, PartitionPermission::kReadOnly);
+  std::array<std::byte, 16> data{};
+  const auto unused = [](StatusWithSize) { FAIL(); };
+
+  EXPECT_EQ(Status::PermissionDenied(), read_only.StartErase(0, 1, unused));
+  EXPECT_EQ(Status::PermissionDenied(), read_only.StartWrite(0, data, unused));
+  EXPECT_EQ(Status::PermissionDenied(), read_only.Erase());
+}
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x1e73b9c5, .checksum = &checksum};
+
+TEST_F(AsyncFlash, KeyValueStore) {
+  ASSERT_EQ(OkStatus(), partition_.Erase());
+  KeyValueStoreBuffer<8, 4> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  std::array<std::byte, 200> value;
+  for (int i = 0; i < 20; ++i) {
+    value.fill(std::byte(i));
+    ASSERT_EQ(OkStatus(), kvs.Put("key", value));
+  }
+  ASSERT_EQ(OkStatus(), kvs.FullMaintenance());
+
+  std::array<std::byte, 200> read{};
+  ASSERT_EQ(OkStatus(), kvs.Get("key", read).status());
+  EXPECT_EQ(value, read);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,273 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program runs random Put and Get workloads against KeyValueStores of
+// several sizes on a TimedFlashMemory, which models the time each flash
+// operation takes. For each workload it logs Put and Get throughput and
+// latency, write amplification, and garbage collection time. All times are
+// modeled flash time; CPU time is not included.
+//
+// Edit kTiming to match the flash part of interest.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_kvs/timed_flash_memory.h"
+#include "pw_log/log.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::kvs {
+namespace {
+
+// Roughly a quad SPI NOR flash: 256-byte pages and 4 KiB sectors.
+constexpr FlashTiming kTiming{
+    .read_op_ns = 1'000,
+    .read_byte_ns = 40,
+    .write_op_ns = 1'000,
+    .page_size_bytes = 256,
+    .page_program_ns = 700'000,
+    .sector_erase_ns = 45'000'000,
+};
+
+constexpr size_t kSectorSize = 4096;
+constexpr size_t kSectorCount = 16;
+constexpr size_t kAlignment = 16;
+constexpr size_t kMaxEntries = 64;
+constexpr size_t kMaxValueSize = 512;
+
+constexpr size_t kOperations = 2000;
+
+struct Workload {
+  size_t key_count;
+  size_t value_size;
+  size_t redundancy;
+};
+
+constexpr Workload kWorkloads[] = {
+    {.key_count = 16, .value_size = 16, .redundancy = 1},
+    {.key_count = 16, .value_size = 128, .redundancy = 1},
+    {.key_count = 16, .value_size = 512, .redundancy = 1},
+    {.key_count = 64, .value_size = 16, .redundancy = 1},
+    {.key_count = 64, .value_size = 128, .redundancy = 1},
+    {.key_count = 16, .value_size = 16, .redundancy = 2},
+    {.key_count = 16, .value_size = 128, .redundancy = 2},
+    {.key_count = 64, .value_size = 128, .redundancy = 2},
+};
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x3c8a5e12, .checksum = &checksum};
+
+FakeFlashMemoryBuffer<kSectorSize, kSectorCount> fake_flash(kAlignment);
+TimedFlashMemory flash(fake_flash, kTiming);
+FlashPartition partition(&flash);
+
+// Per-operation latencies in modeled nanoseconds.
+std::array<uint32_t, kOperations> put_latencies;
+std::array<uint32_t, kOperations> get_latencies;
+std::array<uint32_t, kOperations> gc_put_latencies;
+
+std::array<std::byte, kMaxValueSize> value_buffer;
+
+struct Results {
+  size_t puts;
+  size_t gets;
+  uint64_t put_ns;
+  uint64_t get_ns;
+  size_t gc_puts;
+  size_t user_bytes_written;
+  size_t flash_bytes_written;
+};
+
+constexpr const char* kKeys[kMaxEntries] = {
+    "k00", "k01", "k02", "k03", "k04", "k05", "k06", "k07", "k08", "k09",
+    "k10", "k11", "k12", "k13", "k14", "k15", "k16", "k17", "k18", "k19",
+    "k20", "k21", "k22", "k23", "k24", "k25", "k26", "k27", "k28", "k29",
+    "k30", "k31", "k32", "k33", "k34", "k35", "k36", "k37", "k38", "k39",
+    "k40", "k41", "k42", "k43", "k44", "k45", "k46", "k47", "k48", "k49",
+    "k50", "k51", "k52", "k53", "k54", "k55", "k56", "k57", "k58", "k59",
+    "k60", "k61", "k62", "k63",
+};
+
+constexpr size_t kKeyLength = 3;
+
+uint32_t Percentile(std::span<uint32_t> latencies, size_t percent) {
+  if (latencies.empty()) {
+    return 0;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  return latencies[(latencies.size() - 1) * percent / 100];
+}
+
+// Puts a value. Puts that run out of space garbage collect a sector, which is
+// the only time the KVS erases flash; these Puts are recorded separately so
+// the cost of garbage collection can be determined.
+Status TimedPut(KeyValueStore& kvs,
+                Key key,
+                std::span<const std::byte> value,
+                Results& results) {
+  const uint64_t start_ns = flash.elapsed_ns();
+  const size_t start_erases = flash.stats().sectors_erased;
+
+  const Status status = kvs.Put(key, value);
+
+  const uint32_t latency_ns = flash.elapsed_ns() - start_ns;
+  put_latencies[results.puts] = latency_ns;
+  results.put_ns += latency_ns;
+  results.puts += 1;
+  results.user_bytes_written += kKeyLength + value.size();
+
+  if (flash.stats().sectors_erased != start_erases) {
+    gc_put_latencies[results.gc_puts] = latency_ns;
+    results.gc_puts += 1;
+  }
+  return status;
+}
+
+void TimedGet(KeyValueStore& kvs, Key key, Results& results) {
+  const uint64_t start_ns = flash.elapsed_ns();
+  kvs.Get(key, value_buffer).IgnoreError();
+
+  get_latencies[results.gets] = flash.elapsed_ns() - start_ns;
+  results.get_ns += get_latencies[results.gets];
+  results.gets += 1;
+}
+
+void LogLatencies(const char* operation,
+                  uint64_t total_ns,
+                  std::span<uint32_t> latencies) {
+  const unsigned ops_per_second =
+      total_ns == 0u ? 0u
+                     : unsigned(latencies.size() * 1'000'000'000ull / total_ns);
+  PW_LOG_INFO("  %s: %u ops/s, p50 %u us, p99 %u us",
+              operation,
+              ops_per_second,
+              unsigned(Percentile(latencies, 50) / 1000),
+              unsigned(Percentile(latencies, 99) / 1000));
+}
+
+void Report(const Workload& workload, const Results& results) {
+  const size_t flash_bytes = results.flash_bytes_written;
+  const size_t user_bytes = results.user_bytes_written;
+
+  PW_LOG_INFO("%u keys, %u B values, redundancy %u:",
+              unsigned(workload.key_count),
+              unsigned(workload.value_size),
+              unsigned(workload.redundancy));
+  LogLatencies("Put",
+               results.put_ns,
+               std::span(put_latencies).first(results.puts));
+  LogLatencies("Get",
+               results.get_ns,
+               std::span(get_latencies).first(results.gets));
+  PW_LOG_INFO("  Write amplification: %u.%02u (%u B to flash, %u B of data)",
+              unsigned(flash_bytes / user_bytes),
+              unsigned(flash_bytes * 100 / user_bytes % 100),
+              unsigned(flash_bytes),
+              unsigned(user_bytes));
+
+  // Garbage collection time is estimated as the time Puts that garbage
+  // collected took beyond the typical Put. Puts that do not garbage collect
+  // all do the same flash operations, so their median is the typical cost.
+  uint64_t gc_ns = 0;
+  const uint32_t typical_put_ns =
+      Percentile(std::span(put_latencies).first(results.puts), 50);
+  for (uint32_t latency_ns :
+       std::span(gc_put_latencies).first(results.gc_puts)) {
+    gc_ns += latency_ns > typical_put_ns ? latency_ns - typical_put_ns : 0u;
+  }
+
+  PW_LOG_INFO("  Garbage collection: %u Puts, %u ms (%u%% of Put time)",
+              unsigned(results.gc_puts),
+              unsigned(gc_ns / 1'000'000),
+              results.put_ns == 0u ? 0u
+                                   : unsigned(gc_ns * 100 / results.put_ns));
+}
+
+template <size_t kRedundancy>
+void Run(const Workload& workload) {
+  static KeyValueStoreBuffer<kMaxEntries, kSectorCount, kRedundancy> kvs(
+      &partition, kFormat);
+
+  if (!partition.Erase().ok() || !kvs.Init().ok()) {
+    PW_LOG_ERROR("Failed to initialize the KVS");
+    return;
+  }
+
+  Results results{};
+  const std::span value = std::span(value_buffer).first(workload.value_size);
+  random::XorShiftStarRng64 rng(workload.key_count * 1000 +
+                                workload.value_size);
+
+  // Write every key once so that Gets find values.
+  for (size_t i = 0; i < workload.key_count; ++i) {
+    if (!kvs.Put(kKeys[i], value).ok()) {
+      PW_LOG_ERROR("Failed to write the initial values");
+      return;
+    }
+  }
+
+  flash.ResetStats();
+
+  for (size_t i = 0; i < kOperations; ++i) {
+    uint32_t random = 0;
+    rng.GetInt(random);
+    const Key key = kKeys[(random >> 1) % workload.key_count];
+
+    if ((random & 1u) == 0u) {
+      std::fill(value.begin(), value.end(), std::byte(random >> 8));
+      if (!TimedPut(kvs, key, value, results).ok()) {
+        PW_LOG_ERROR("Put failed; the workload does not fit in the KVS");
+        return;
+      }
+    } else {
+      TimedGet(kvs, key, results);
+    }
+  }
+
+  results.flash_bytes_written = flash.stats().bytes_written;
+  Report(workload, results);
+}
+
+}  // namespace
+}  // namespace pw::kvs
+
+int main() {
+  PW_LOG_INFO("KVS benchmark: %u operations per workload",
+              unsigned(pw::kvs::kOperations));
+
+  for (const pw::kvs::Workload& workload : pw::kvs::kWorkloads) {
+    switch (workload.redundancy) {
+      case 1:
+        pw::kvs::Run<1>(workload);
+        break;
+      case 2:
+        pw::kvs::Run<2>(workload);
+        break;
+      default:
+        PW_LOG_ERROR("Unsupported redundancy %u",
+                     unsigned(workload.redundancy));
+    }
+  }
+  return 0;
+}
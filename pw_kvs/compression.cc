@@ -0,0 +1,66 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_LOG_MODULE_NAME "KVS"
+#define PW_LOG_LEVEL PW_KVS_LOG_LEVEL
+
+#include "pw_kvs/compression.h"
+
+#include <cstring>
+
+#include "pw_kvs_private/config.h"
+#include "pw_log/log.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::kvs {
+
+Result<ConstByteSpan> ValueCompressor::Encode(ConstByteSpan value) {
+  if (value.size() > max_value_size_bytes()) {
+    return Status::ResourceExhausted();
+  }
+
+  internal::CompressedValueHeader header{
+      .value_size = static_cast<uint16_t>(value.size()),
+      .method = 1,
+      .reserved = 0,
+  };
+
+  // Compress into no more space than the value itself uses. If the compressed
+  // value does not fit, store the value as is instead.
+  const ByteSpan stored = buffer_.subspan(sizeof(header), value.size());
+  const size_t max_compressed_size = value.empty() ? 0 : value.size() - 1;
+  stream::MemoryWriter writer(stored.first(max_compressed_size));
+
+  encoder_.Reset();
+  Status status = encoder_.Write(value, writer);
+  if (status.ok()) {
+    status = encoder_.Finish(writer);
+  }
+
+  size_t stored_size = writer.bytes_written();
+  if (!status.ok()) {
+    header.method = 0;
+    std::memcpy(stored.data(), value.data(), value.size());
+    stored_size = value.size();
+  }
+
+  PW_LOG_DEBUG("Encoded %u B value as %u B",
+               unsigned(value.size()),
+               unsigned(stored_size));
+
+  std::memcpy(buffer_.data(), &header, sizeof(header));
+  return ConstByteSpan(buffer_.first(sizeof(header) + stored_size));
+}
+
+}  // namespace pw::kvs
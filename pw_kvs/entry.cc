@@ -20,6 +20,7 @@
 #include <cinttypes>
 #include <cstring>
 
+#include "pw_kvs/compression.h"
 #include "pw_kvs_private/config.h"
 #include "pw_log/log.h"
 #include "pw_status/try.h"
@@ -45,8 +46,16 @@ Status Entry::Read(FlashPartition& partition,
   if (partition.AppearsErased(std::as_bytes(std::span(&header.magic, 1)))) {
     return Status::NotFound();
   }
-  if (header.key_length_bytes > kMaxKeyLength) {
-    return Status::DataLoss();
+  if ((header.key_length_bytes & kSectorSummaryFlag) != 0u) {
+    const bool valid_summary =
+        header.key_length_bytes == kSectorSummaryFlag &&
+        header.value_size_bytes % sizeof(SectorSummaryItem) == 0u;
+    const bool valid_erase_count =
+        header.key_length_bytes == kEraseCountFlags &&
+        header.value_size_bytes == sizeof(uint32_t);
+    if (!valid_summary && !valid_erase_count) {
+      return Status::DataLoss();
+    }
   }
 
   const EntryFormat* format = formats.Find(header.magic);
@@ -61,6 +70,47 @@ Status Entry::Read(FlashPartition& partition,
   return OkStatus();
 }
 
+Status Entry::FromBuffer(FlashPartition& partition,
+                         std::span<const byte> buffer,
+                         const internal::EntryFormats& formats,
+                         Entry* entry,
+                         Key* key,
+                         std::span<const byte>* value) {
+  EntryHeader header;
+  if (buffer.size() < sizeof(header)) {
+    return Status::DataLoss();
+  }
+  std::memcpy(&header, buffer.data(), sizeof(header));
+
+  const size_t key_length = header.key_length_bytes & kKeyLengthMask;
+  if ((header.key_length_bytes & kSectorSummaryFlag) != 0u ||
+      key_length == 0u) {
+    return Status::DataLoss();
+  }
+
+  const EntryFormat* format = formats.Find(header.magic);
+  if (format == nullptr) {
+    return Status::InvalidArgument();
+  }
+
+  Entry parsed(&partition, 0, *format, header);
+  if (buffer.size() < parsed.size()) {
+    return Status::DataLoss();
+  }
+
+  const Key parsed_key(
+      reinterpret_cast<const char*>(buffer.data() + sizeof(header)),
+      key_length);
+  const std::span<const byte> parsed_value =
+      buffer.subspan(sizeof(header) + key_length, parsed.value_size());
+  PW_TRY(parsed.VerifyChecksum(parsed_key, parsed_value));
+
+  *entry = parsed;
+  *key = parsed_key;
+  *value = parsed_value;
+  return OkStatus();
+}
+
 Status Entry::ReadKey(FlashPartition& partition,
                       Address address,
                       size_t key_length,
@@ -79,7 +129,8 @@ Entry::Entry(FlashPartition& partition,
              Key key,
              std::span<const byte> value,
              uint16_t value_size_bytes,
-             uint32_t transaction_id)
+             uint32_t transaction_id,
+             bool batch_pending)
     : Entry(&partition,
             address,
             format,
@@ -87,7 +138,8 @@ Entry::Entry(FlashPartition& partition,
              .checksum = 0,
              .alignment_units =
                  alignment_bytes_to_units(partition.alignment_bytes()),
-             .key_length_bytes = static_cast<uint8_t>(key.size()),
+             .key_length_bytes = static_cast<uint8_t>(
+                 key.size() | (batch_pending ? kBatchPendingFlag : 0u)),
              .value_size_bytes = value_size_bytes,
              .transaction_id = transaction_id}) {
   if (checksum_algo_ != nullptr) {
@@ -99,17 +151,81 @@ Entry::Entry(FlashPartition& partition,
 }
 
 StatusWithSize Entry::Write(Key key, std::span<const byte> value) const {
-  FlashPartition::Output flash(partition(), address_);
-  return AlignedWrite<kWriteBufferSize>(flash,
-                                        alignment_bytes(),
-                                        {std::as_bytes(std::span(&header_, 1)),
-                                         std::as_bytes(std::span(key)),
-                                         value});
+  StatusWithSize result;
+  WriteCopies(key, value, std::span(&address_, 1), std::span(&result, 1));
+  return result;
+}
+
+void Entry::WriteCopies(Key key,
+                        std::span<const byte> value,
+                        std::span<const Address> addresses,
+                        std::span<StatusWithSize> results) const {
+  // The padding is less than the alignment, so it always fits in kPadding.
+  static constexpr std::array<byte, kMaxFlashAlignment> kPadding{};
+  const size_t padding = Padding(content_size(), alignment_bytes());
+
+  const ConstByteSpan data[] = {std::as_bytes(std::span(&header_, 1)),
+                                std::as_bytes(std::span(key)),
+                                value,
+                                std::span(kPadding).first(padding)};
+  partition().WriteCopies(addresses, data, results);
+}
+
+StatusWithSize Entry::WriteSectorSummary(SummaryItems& items) {
+  SectorSummaryItem item;
+
+  if (checksum_algo_ != nullptr) {
+    checksum_algo_->Reset();
+    checksum_algo_->Update(&header_, sizeof(header_));
+
+    items.Reset();
+    for (size_t i = 0; i < summary_item_count(); ++i) {
+      if (!items.Next(item)) {
+        return StatusWithSize::Internal();
+      }
+      checksum_algo_->Update(&item, sizeof(item));
+    }
+
+    AddPaddingBytesToChecksum();
+
+    std::span checksum = checksum_algo_->Finish();
+    std::memcpy(&header_.checksum,
+                checksum.data(),
+                std::min(checksum.size(), sizeof(header_.checksum)));
+  }
+
+  FlashPartition::Output output(partition(), address_);
+  AlignedWriterBuffer<kWriteBufferSize> writer(alignment_bytes(), output);
+
+  PW_TRY_WITH_SIZE(writer.Write(&header_, sizeof(header_)));
+
+  items.Reset();
+  for (size_t i = 0; i < summary_item_count(); ++i) {
+    if (!items.Next(item)) {
+      return StatusWithSize::Internal();
+    }
+    PW_TRY_WITH_SIZE(writer.Write(&item, sizeof(item)));
+  }
+  return writer.Flush();
+}
+
+StatusWithSize Entry::WriteEraseCount(uint32_t erase_count) {
+  const std::span<const byte> value =
+      std::as_bytes(std::span(&erase_count, 1));
+
+  if (checksum_algo_ != nullptr) {
+    std::span<const byte> checksum = CalculateChecksum({}, value);
+    std::memcpy(&header_.checksum,
+                checksum.data(),
+                std::min(checksum.size(), sizeof(header_.checksum)));
+  }
+  return Write({}, value);
 }
 
 Status Entry::Update(const EntryFormat& new_format,
                      uint32_t new_transaction_id) {
   checksum_algo_ = new_format.checksum;
+  compression_ = new_format.compression;
   header_.magic = new_format.magic;
   header_.alignment_units =
       alignment_bytes_to_units(partition_->alignment_bytes());
@@ -122,6 +238,11 @@ Status Entry::Update(const EntryFormat& new_format,
   return CalculateChecksumFromFlash();
 }
 
+Status Entry::ClearBatchPending() {
+  header_.key_length_bytes &= kKeyLengthMask;
+  return CalculateChecksumFromFlash();
+}
+
 StatusWithSize Entry::Copy(Address new_address) const {
   PW_LOG_DEBUG("Copying entry from %u to %u as ID %" PRIu32,
                unsigned(address()),
@@ -161,6 +282,46 @@ StatusWithSize Entry::ReadValue(std::span<byte> buffer,
   return StatusWithSize(read_size);
 }
 
+StatusWithSize Entry::ReadDecompressedValue(std::span<byte> buffer,
+                                            size_t offset_bytes) const {
+  if (!compressed()) {
+    return ReadValue(buffer, offset_bytes);
+  }
+
+  CompressedValueHeader value_header;
+  PW_TRY_WITH_SIZE(ReadCompressedValueHeader(value_header));
+
+  if (offset_bytes > value_header.value_size) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  const size_t remaining_bytes = value_header.value_size - offset_bytes;
+  const std::span<byte> output =
+      buffer.first(std::min(buffer.size(), remaining_bytes));
+
+  if (value_header.method == 0u) {
+    PW_TRY_WITH_SIZE(partition().Read(
+        value_address() + sizeof(value_header) + offset_bytes, output));
+  } else {
+    PW_TRY_WITH_SIZE(Decompress(output, offset_bytes));
+  }
+
+  if (output.size() != remaining_bytes) {
+    return StatusWithSize::ResourceExhausted(output.size());
+  }
+  return StatusWithSize(output.size());
+}
+
+StatusWithSize Entry::DecompressedValueSize() const {
+  if (!compressed()) {
+    return StatusWithSize(value_size());
+  }
+
+  CompressedValueHeader value_header;
+  PW_TRY_WITH_SIZE(ReadCompressedValueHeader(value_header));
+  return StatusWithSize(value_header.value_size);
+}
+
 Status Entry::ValueMatches(std::span<const std::byte> value) const {
   if (value_size() != value.size_bytes()) {
     return Status::NotFound();
@@ -245,6 +406,65 @@ Status Entry::VerifyChecksumInFlash() const {
   return checksum_algo_->Verify(checksum_bytes());
 }
 
+Status Entry::ReadCompressedValueHeader(CompressedValueHeader& header) const {
+  if (value_size() < sizeof(header)) {
+    return Status::DataLoss();
+  }
+  PW_TRY(partition().Read(value_address(), sizeof(header), &header));
+
+  // A value stored as is must fill the rest of the entry.
+  if (header.method > 1u ||
+      (header.method == 0u &&
+       value_size() != sizeof(header) + header.value_size)) {
+    return Status::DataLoss();
+  }
+  return OkStatus();
+}
+
+// Decompresses the value into output, starting offset_bytes into the
+// decompressed value. The compressed value is read from flash in small chunks.
+Status Entry::Decompress(std::span<byte> output, size_t offset_bytes) const {
+  LzDecoder& decoder = compression_->decoder_;
+  decoder.Reset();
+
+  Address address = value_address() + sizeof(CompressedValueHeader);
+  const Address end = value_address() + value_size();
+
+  std::array<byte, 2 * kMinAlignmentBytes> buffer;
+  std::array<byte, 2 * kMinAlignmentBytes> skipped;
+  ConstByteSpan input;
+  size_t written = 0;
+
+  while (written < output.size()) {
+    // Bytes before the offset are decoded into a scratch buffer and dropped.
+    const bool skipping = decoder.output_size() < offset_bytes;
+    const std::span<byte> dest =
+        skipping ? std::span(skipped).first(std::min(
+                       skipped.size(), offset_bytes - decoder.output_size()))
+                 : output.subspan(written);
+
+    const StatusWithSize result = decoder.Decode(input, dest);
+    if (!result.ok()) {
+      return Status::DataLoss();
+    }
+    if (!skipping) {
+      written += result.size();
+    }
+
+    // The decoder stops early only if it needs more input.
+    if (result.size() < dest.size()) {
+      if (address == end) {
+        return Status::DataLoss();  // The compressed value ended early.
+      }
+      const size_t read_size = std::min(size_t(end - address), buffer.size());
+      PW_TRY(partition_->Read(address, std::span(buffer).first(read_size)));
+      input = std::span(buffer).first(read_size);
+      address += read_size;
+    }
+  }
+  return OkStatus();
+}
+
 void Entry::DebugLog() const {
   PW_LOG_DEBUG("Entry [%s]: ", deleted() ? "tombstone" : "present");
   PW_LOG_DEBUG("   Address      = 0x%x", unsigned(address_));
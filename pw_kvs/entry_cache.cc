@@ -17,7 +17,9 @@
 
 #include "pw_kvs/internal/entry_cache.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 
 #include "pw_kvs/flash_memory.h"
 #include "pw_kvs/internal/entry.h"
@@ -30,6 +32,12 @@ namespace {
 
 constexpr FlashPartition::Address kNoAddress = FlashPartition::Address(-1);
 
+// Marks a key prefix slot whose key has not been read from flash. Keys are
+// never longer than Entry::kMaxKeyLength, so this is not a valid length.
+constexpr char kUnknownKeyLength = char(0xff);
+
+static_assert(Entry::kMaxKeyLength < 0x7f);
+
 }  // namespace
 
 void EntryMetadata::RemoveAddress(Address address_to_remove) {
@@ -50,7 +58,7 @@ void EntryMetadata::RemoveAddress(Address address_to_remove) {
 }
 
 void EntryMetadata::Reset(const KeyDescriptor& descriptor, Address address) {
-  *descriptor_ = descriptor;
+  descriptors_->set(index_, descriptor);
 
   addresses_[0] = address;
   for (size_t i = 1; i < addresses_.size(); ++i) {
@@ -68,70 +76,85 @@ StatusWithSize EntryCache::Find(FlashPartition& partition,
   Entry::KeyBuffer key_buffer;
   bool error_detected = false;
 
-  for (size_t i = 0; i < descriptors_.size(); ++i) {
-    if (descriptors_[i].key_hash == hash) {
-      bool key_found = false;
-      Key read_key;
-
-      for (Address address : addresses(i)) {
-        Status read_result =
-            Entry::ReadKey(partition, address, key.size(), key_buffer.data());
-
-        read_key = Key(key_buffer.data(), key.size());
-
-        if (read_result.ok() && hash == internal::Hash(read_key)) {
-          key_found = true;
-          break;
-        } else {
-          // A hash mismatch can be caused by reading invalid data or a key hash
-          // collision of keys with differing size. To verify the data read from
-          // flash is good, validate the entry.
-          Entry entry;
-          read_result = Entry::Read(partition, address, formats, &entry);
-          if (read_result.ok() && entry.VerifyChecksumInFlash().ok()) {
-            key_found = true;
-            break;
-          }
-
-          PW_LOG_WARN(
-              "   Found corrupt entry, invalidating this copy of the key");
-          error_detected = true;
-          sectors.FromAddress(address).mark_corrupt();
-        }
-      }
-      size_t error_val = error_detected ? 1 : 0;
-
-      if (!key_found) {
-        PW_LOG_ERROR("No valid entries for key. Data has been lost!");
-        return StatusWithSize::DataLoss(error_val);
-      } else if (key == read_key) {
-        PW_LOG_DEBUG("Found match for key hash 0x%08" PRIx32, hash);
-        *metadata = EntryMetadata(descriptors_[i], addresses(i));
-        return StatusWithSize(error_val);
-      } else {
-        PW_LOG_WARN("Found key hash collision for 0x%08" PRIx32, hash);
-        return StatusWithSize::AlreadyExists(error_val);
+  // Key hashes are unique within the cache, so at most one descriptor matches.
+  const int index = FindIndex(hash);
+  if (index == -1) {
+    return StatusWithSize::NotFound();
+  }
+
+  const size_t i = index;
+  bool key_found = false;
+  Key read_key;
+
+  for (Address address : addresses(i)) {
+    Status read_result =
+        Entry::ReadKey(partition, address, key.size(), key_buffer.data());
+
+    read_key = Key(key_buffer.data(), key.size());
+
+    if (read_result.ok() && hash == internal::Hash(read_key)) {
+      key_found = true;
+      break;
+    } else {
+      // A hash mismatch can be caused by reading invalid data or a key hash
+      // collision of keys with differing size. To verify the data read from
+      // flash is good, validate the entry.
+      Entry entry;
+      read_result = Entry::Read(partition, address, formats, &entry);
+      if (read_result.ok() && entry.VerifyChecksumInFlash().ok()) {
+        key_found = true;
+        break;
       }
+
+      PW_LOG_WARN("   Found corrupt entry, invalidating this copy of the key");
+      error_detected = true;
+      sectors.FromAddress(address).mark_corrupt();
     }
   }
-  return StatusWithSize::NotFound();
+  size_t error_val = error_detected ? 1 : 0;
+
+  if (!key_found) {
+    PW_LOG_ERROR("No valid entries for key. Data has been lost!");
+    return StatusWithSize::DataLoss(error_val);
+  } else if (key == read_key) {
+    PW_LOG_DEBUG("Found match for key hash 0x%08" PRIx32, hash);
+    *metadata = EntryMetadata(descriptors_, i, addresses(i));
+    return StatusWithSize(error_val);
+  } else {
+    PW_LOG_WARN("Found key hash collision for 0x%08" PRIx32, hash);
+    return StatusWithSize::AlreadyExists(error_val);
+  }
+}
+
+void EntryCache::Reset() const {
+  descriptors_.clear();
+  std::fill_n(hash_index_, hash_index_slots_, HashIndexSlot(0));
 }
 
 EntryMetadata EntryCache::AddNew(const KeyDescriptor& descriptor,
-                                 Address entry_address) const {
+                                 Address entry_address,
+                                 Key key) const {
   // TODO(hepler): DCHECK(!full());
-  Address* first_address = ResetAddresses(descriptors_.size(), entry_address);
+  if (hash_indexed()) {
+    FindHashIndexSlot(descriptor.key_hash) =
+        HashIndexSlot(descriptors_.size() + 1);
+  }
+
+  StoreKeyPrefix(descriptors_.size(), key);
+
+  const size_t index = descriptors_.size();
+  Address* first_address = ResetAddresses(index, entry_address);
   descriptors_.push_back(descriptor);
-  return EntryMetadata(descriptors_.back(), std::span(first_address, 1));
+  return EntryMetadata(descriptors_, index, std::span(first_address, 1));
 }
 
-// TODO: This method is the trigger of the O(valid_entries * all_entries) time
-// complexity for reading. At some cost to memory, this could be optimized by
-// using a hash table instead of scanning, but in practice this should be fine
-// for a small number of keys
+// Without a hash index, this method is the trigger of the
+// O(valid_entries * all_entries) time complexity for reading. This is fine for
+// a small number of keys; KVSs with many keys should configure a hash index.
 Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
                                           Address address,
-                                          size_t sector_size_bytes) const {
+                                          size_t sector_size_bytes,
+                                          Key key) const {
   // With the new key descriptor, either add it to the descriptor table or
   // overwrite an existing entry with an older version of the key.
   const int index = FindIndex(descriptor.key_hash);
@@ -141,21 +164,26 @@ Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
     if (full()) {
       return Status::ResourceExhausted();
     }
-    AddNew(descriptor, address);
+    AddNew(descriptor, address, key);
     return OkStatus();
   }
 
+  // The descriptor's key may not have been known when it was added.
+  if (!key.empty()) {
+    StoreKeyPrefix(index, key);
+  }
+
   // Existing entry is old; replace the existing entry with the new one.
-  if (descriptor.transaction_id > descriptors_[index].transaction_id) {
-    descriptors_[index] = descriptor;
+  if (descriptor.transaction_id > descriptors_.transaction_id(index)) {
+    descriptors_.set(index, descriptor);
     ResetAddresses(index, address);
     return OkStatus();
   }
 
   // If the entries have a duplicate transaction ID, add the new (redundant)
   // entry to the existing descriptor.
-  if (descriptors_[index].transaction_id == descriptor.transaction_id) {
-    if (descriptors_[index].key_hash != descriptor.key_hash) {
+  if (descriptors_.transaction_id(index) == descriptor.transaction_id) {
+    if (descriptors_.key_hash(index) != descriptor.key_hash) {
       PW_LOG_ERROR("Duplicate entry for key 0x%08" PRIx32
                    " with transaction ID %" PRIu32 " has non-matching hash",
                    descriptor.key_hash,
@@ -180,11 +208,53 @@ Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
   return OkStatus();
 }
 
+void EntryCache::SetKeyPrefix(const EntryMetadata& metadata, Key key) const {
+  StoreKeyPrefix(index(metadata), key);
+}
+
+EntryCache::PrefixMatch EntryCache::MatchKeyPrefix(
+    const EntryMetadata& metadata, Key prefix) const {
+  if (!key_prefixes_cached()) {
+    return PrefixMatch::kUnknown;
+  }
+
+  const char* const slot = key_prefix_slot(index(metadata));
+  if (slot[0] == kUnknownKeyLength) {
+    return PrefixMatch::kUnknown;
+  }
+
+  const size_t key_length = size_t(slot[0]);
+  if (prefix.size() > key_length) {
+    return PrefixMatch::kNoMatch;
+  }
+
+  const size_t compare_bytes = std::min(prefix.size(), key_prefix_bytes_);
+  if (std::memcmp(&slot[1], prefix.data(), compare_bytes) != 0) {
+    return PrefixMatch::kNoMatch;
+  }
+
+  // Only the cached bytes could be compared if the prefix is longer.
+  return compare_bytes == prefix.size() ? PrefixMatch::kMatch
+                                        : PrefixMatch::kUnknown;
+}
+
+Key EntryCache::CachedKey(const EntryMetadata& metadata) const {
+  if (!key_prefixes_cached()) {
+    return Key();
+  }
+
+  const char* const slot = key_prefix_slot(index(metadata));
+  if (slot[0] == kUnknownKeyLength || size_t(slot[0]) > key_prefix_bytes_) {
+    return Key();
+  }
+  return Key(&slot[1], size_t(slot[0]));
+}
+
 size_t EntryCache::present_entries() const {
   size_t present_entries = 0;
 
-  for (const KeyDescriptor& descriptor : descriptors_) {
-    if (descriptor.state != EntryState::kDeleted) {
+  for (size_t i = 0; i < descriptors_.size(); ++i) {
+    if (descriptors_.state(i) != EntryState::kDeleted) {
       present_entries += 1;
     }
   }
@@ -193,14 +263,35 @@ size_t EntryCache::present_entries() const {
 }
 
 int EntryCache::FindIndex(uint32_t key_hash) const {
-  for (size_t i = 0; i < descriptors_.size(); ++i) {
-    if (descriptors_[i].key_hash == key_hash) {
+  if (hash_indexed()) {
+    return int(FindHashIndexSlot(key_hash)) - 1;
+  }
+
+  // The hashes are contiguous, so this loop reads only the hashes.
+  const std::span<const uint32_t> hashes = descriptors_.key_hashes();
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    if (hashes[i] == key_hash) {
       return i;
     }
   }
   return -1;
 }
 
+EntryCache::HashIndexSlot& EntryCache::FindHashIndexSlot(
+    uint32_t key_hash) const {
+  // Linear probing. Descriptors are never removed from the cache (deleted keys
+  // are kept as tombstones), so no deletion markers are needed. The index has
+  // more slots than there are descriptors, so an empty slot is always found.
+  const size_t mask = hash_index_slots_ - 1;
+
+  for (size_t slot = key_hash & mask;; slot = (slot + 1) & mask) {
+    HashIndexSlot& entry = hash_index_[slot];
+    if (entry == 0u || descriptors_.key_hash(entry - 1) == key_hash) {
+      return entry;
+    }
+  }
+}
+
 void EntryCache::AddAddressIfRoom(size_t descriptor_index,
                                   Address address) const {
   Address* const existing = first_address(descriptor_index);
@@ -238,4 +329,19 @@ EntryCache::Address* EntryCache::ResetAddresses(size_t descriptor_index,
   return first;
 }
 
+void EntryCache::StoreKeyPrefix(size_t descriptor_index, Key key) const {
+  if (!key_prefixes_cached()) {
+    return;
+  }
+
+  char* const slot = key_prefix_slot(descriptor_index);
+  if (key.empty()) {
+    slot[0] = kUnknownKeyLength;
+    return;
+  }
+
+  slot[0] = char(key.size());
+  std::memcpy(&slot[1], key.data(), std::min(key.size(), key_prefix_bytes_));
+}
+
 }  // namespace pw::kvs::internal
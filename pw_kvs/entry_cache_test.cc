@@ -33,7 +33,7 @@ class EmptyEntryCache : public ::testing::Test {
 
   EmptyEntryCache() : entries_(descriptors_, addresses_, kRedundancy) {}
 
-  Vector<KeyDescriptor, kMaxEntries> descriptors_;
+  KeyDescriptorListBuffer<kMaxEntries> descriptors_;
   EntryCache::AddressList<kMaxEntries, kRedundancy> addresses_;
 
   EntryCache entries_;
@@ -45,6 +45,61 @@ constexpr KeyDescriptor kDescriptor = {.key_hash = Hash(kTheKey),
                                        .transaction_id = 123,
                                        .state = EntryState::kValid};
 
+TEST(KeyDescriptorList, PushBackAndGet) {
+  KeyDescriptorListBuffer<2> descriptors;
+  EXPECT_TRUE(descriptors.empty());
+
+  descriptors.push_back(kDescriptor);
+  descriptors.push_back({.key_hash = 1,
+                         .transaction_id = 2,
+                         .state = EntryState::kDeleted});
+  EXPECT_TRUE(descriptors.full());
+
+  EXPECT_EQ(kDescriptor.key_hash, descriptors.get(0).key_hash);
+  EXPECT_EQ(kDescriptor.transaction_id, descriptors.get(0).transaction_id);
+  EXPECT_EQ(EntryState::kValid, descriptors.get(0).state);
+  EXPECT_EQ(1u, descriptors.key_hash(1));
+  EXPECT_EQ(2u, descriptors.transaction_id(1));
+  EXPECT_EQ(EntryState::kDeleted, descriptors.state(1));
+
+  descriptors.clear();
+  EXPECT_TRUE(descriptors.empty());
+}
+
+TEST(KeyDescriptorList, StatesAreIndependent) {
+  KeyDescriptorListBuffer<40> descriptors;
+  for (uint32_t i = 0; i < 40; ++i) {
+    descriptors.push_back(
+        {.key_hash = i,
+         .transaction_id = i,
+         .state = i % 3 == 0 ? EntryState::kDeleted : EntryState::kValid});
+  }
+
+  descriptors.set(
+      33,
+      {.key_hash = 33, .transaction_id = 33, .state = EntryState::kDeleted});
+  descriptors.set(
+      30, {.key_hash = 30, .transaction_id = 30, .state = EntryState::kValid});
+
+  for (size_t i = 0; i < 40; ++i) {
+    const bool deleted = (i % 3 == 0 && i != 30) || i == 33;
+    EXPECT_EQ(deleted ? EntryState::kDeleted : EntryState::kValid,
+              descriptors.state(i));
+  }
+}
+
+TEST(KeyDescriptorList, KeyHashesAreContiguous) {
+  KeyDescriptorListBuffer<4> descriptors;
+  descriptors.push_back(
+      {.key_hash = 7, .transaction_id = 1, .state = EntryState::kValid});
+  descriptors.push_back(
+      {.key_hash = 9, .transaction_id = 2, .state = EntryState::kValid});
+
+  ASSERT_EQ(2u, descriptors.key_hashes().size());
+  EXPECT_EQ(7u, descriptors.key_hashes()[0]);
+  EXPECT_EQ(9u, descriptors.key_hashes()[1]);
+}
+
 TEST_F(EmptyEntryCache, AddNew) {
   EntryMetadata metadata = entries_.AddNew(kDescriptor, 5);
   EXPECT_EQ(kDescriptor.key_hash, metadata.hash());
@@ -194,6 +249,95 @@ TEST_F(EmptyEntryCache, Iterator_Const_CanBeAssignedFromMutable) {
   EXPECT_EQ(99u, it->first_address());
 }
 
+class HashIndexedEntryCache : public ::testing::Test {
+ protected:
+  static constexpr size_t kMaxEntries = 32;
+  static constexpr size_t kRedundancy = 1;
+  static constexpr size_t kHashIndexSlots = 64;
+
+  static_assert(EntryCache::ValidHashIndexSize(kHashIndexSlots, kMaxEntries));
+
+  HashIndexedEntryCache()
+      : hash_index_{},
+        entries_(descriptors_,
+                 addresses_,
+                 kRedundancy,
+                 hash_index_.data(),
+                 hash_index_.size()) {}
+
+  KeyDescriptorListBuffer<kMaxEntries> descriptors_;
+  EntryCache::AddressList<kMaxEntries, kRedundancy> addresses_;
+  std::array<EntryCache::HashIndexSlot, kHashIndexSlots> hash_index_;
+
+  EntryCache entries_;
+};
+
+TEST(EntryCache, ValidHashIndexSize) {
+  EXPECT_TRUE(EntryCache::ValidHashIndexSize(0, 100));
+  EXPECT_TRUE(EntryCache::ValidHashIndexSize(128, 100));
+  EXPECT_FALSE(EntryCache::ValidHashIndexSize(64, 100));
+  EXPECT_FALSE(EntryCache::ValidHashIndexSize(100, 64));
+  EXPECT_FALSE(EntryCache::ValidHashIndexSize(128, 128));
+}
+
+TEST_F(HashIndexedEntryCache, AddNewOrUpdateExisting_UpdatedEntry) {
+  ASSERT_TRUE(entries_.hash_indexed());
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(kDescriptor, 1000, 2000));
+
+  KeyDescriptor kd = kDescriptor;
+  kd.transaction_id += 3;
+  ASSERT_EQ(OkStatus(), entries_.AddNewOrUpdateExisting(kd, 3210, 2000));
+
+  EXPECT_EQ(1u, entries_.total_entries());
+  EXPECT_EQ(3210u, entries_.begin()->first_address());
+  EXPECT_EQ(kDescriptor.transaction_id + 3, entries_.begin()->transaction_id());
+}
+
+TEST_F(HashIndexedEntryCache, AddNewOrUpdateExisting_CollidingSlots) {
+  // Every hash in this loop maps to the same hash index slot, which exercises
+  // probing past occupied slots.
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    const uint32_t hash = 7 + i * kHashIndexSlots;
+    ASSERT_EQ(OkStatus(),
+              entries_.AddNewOrUpdateExisting(
+                  {hash, 1, EntryState::kValid}, 10 * i, 1));
+  }
+  ASSERT_TRUE(entries_.full());
+
+  // Update each entry in reverse order; no new descriptors should be added.
+  for (uint32_t i = kMaxEntries; i > 0u; --i) {
+    const uint32_t hash = 7 + (i - 1) * kHashIndexSlots;
+    ASSERT_EQ(OkStatus(),
+              entries_.AddNewOrUpdateExisting(
+                  {hash, 2, EntryState::kValid}, 1000 + i, 1));
+  }
+  EXPECT_EQ(kMaxEntries, entries_.total_entries());
+
+  uint32_t i = 0;
+  for (const EntryMetadata& entry : entries_) {
+    EXPECT_EQ(7 + i * kHashIndexSlots, entry.hash());
+    EXPECT_EQ(2u, entry.transaction_id());
+    EXPECT_EQ(1000 + i + 1, entry.first_address());
+    i += 1;
+  }
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            entries_.AddNewOrUpdateExisting(kDescriptor, 1000, 1));
+}
+
+TEST_F(HashIndexedEntryCache, Reset_ClearsIndex) {
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(kDescriptor, 1000, 2000));
+  entries_.Reset();
+  EXPECT_EQ(0u, entries_.total_entries());
+
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(kDescriptor, 2000, 2000));
+  EXPECT_EQ(1u, entries_.total_entries());
+  EXPECT_EQ(2000u, entries_.begin()->first_address());
+}
+
 constexpr size_t kSectorSize = 64;
 constexpr uint32_t kMagic = 0xa14ae726;
 // For KVS entry magic value always use a random 32 bit integer rather than a
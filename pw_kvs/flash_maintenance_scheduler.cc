@@ -0,0 +1,100 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/flash_maintenance_scheduler.h"
+
+#include <mutex>
+
+namespace pw {
+namespace kvs {
+
+FlashMaintenanceScheduler::ForegroundOperation::ForegroundOperation(
+    FlashMaintenanceScheduler& scheduler)
+    : scheduler_(scheduler) {
+  scheduler_.foreground_waiting_.fetch_add(1, std::memory_order_relaxed);
+  scheduler_.lock_.lock();
+  scheduler_.foreground_waiting_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+FlashMaintenanceScheduler::ForegroundOperation::~ForegroundOperation() {
+  // The operation may have written to a store or freed space in it, so give
+  // idle clients another chance.
+  for (Client& client : scheduler_.clients_) {
+    client.idle_ = false;
+  }
+  scheduler_.lock_.unlock();
+}
+
+void FlashMaintenanceScheduler::Register(Client& client) {
+  std::lock_guard lock(lock_);
+  client.idle_ = false;
+  clients_.push_front(client);
+}
+
+void FlashMaintenanceScheduler::Unregister(Client& client) {
+  std::lock_guard lock(lock_);
+  clients_.remove(client);
+}
+
+Status FlashMaintenanceScheduler::RunStep() {
+  // Leave the device to foreground operations that are using or waiting for
+  // it.
+  if (foreground_waiting_.load(std::memory_order_relaxed) != 0u) {
+    return Status::Unavailable();
+  }
+  if (!lock_.try_lock()) {
+    return Status::Unavailable();
+  }
+
+  const Status status = RunStepLocked();
+  lock_.unlock();
+  return status;
+}
+
+Status FlashMaintenanceScheduler::RunStepLocked() {
+  Client* neediest = nullptr;
+  size_t largest_shortfall = 0;
+
+  for (Client& client : clients_) {
+    if (client.idle_) {
+      continue;
+    }
+    const size_t free_bytes = client.FreeBytes();
+    if (free_bytes >= client.target_free_bytes_) {
+      continue;
+    }
+    const size_t shortfall = client.target_free_bytes_ - free_bytes;
+    if (shortfall > largest_shortfall) {
+      neediest = &client;
+      largest_shortfall = shortfall;
+    }
+  }
+
+  if (neediest == nullptr) {
+    return Status::NotFound();
+  }
+
+  const Status status = neediest->DoMaintenanceStep();
+  if (status.ok()) {
+    return OkStatus();
+  }
+
+  // Skip this client until a foreground operation changes the stores. If it
+  // had nothing to do, another client may still need a step.
+  neediest->idle_ = true;
+  return status.IsNotFound() ? OkStatus() : status;
+}
+
+}  // namespace kvs
+}  // namespace pw
@@ -0,0 +1,176 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/flash_maintenance_scheduler.h"
+
+#include <array>
+#include <cstddef>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+// A client whose steps each free step_bytes, or return step_status.
+class FakeClient final : public FlashMaintenanceScheduler::Client {
+ public:
+  FakeClient(size_t target_free_bytes, size_t free_bytes)
+      : Client(target_free_bytes),
+        free_bytes_(free_bytes),
+        steps_(0),
+        step_status_(OkStatus()) {}
+
+  size_t steps() const { return steps_; }
+  size_t free_bytes() const { return free_bytes_; }
+
+  void set_step_status(Status status) { step_status_ = status; }
+
+ private:
+  static constexpr size_t kStepBytes = 100;
+
+  size_t FreeBytes() override { return free_bytes_; }
+
+  Status DoMaintenanceStep() override {
+    steps_ += 1;
+    if (step_status_.ok()) {
+      free_bytes_ += kStepBytes;
+    }
+    return step_status_;
+  }
+
+  size_t free_bytes_;
+  size_t steps_;
+  Status step_status_;
+};
+
+TEST(FlashMaintenanceScheduler, NoClients_NotFound) {
+  FlashMaintenanceScheduler scheduler;
+  EXPECT_EQ(Status::NotFound(), scheduler.RunStep());
+}
+
+TEST(FlashMaintenanceScheduler, ClientAtTarget_NotRun) {
+  FlashMaintenanceScheduler scheduler;
+  FakeClient client(500, 500);
+  scheduler.Register(client);
+
+  EXPECT_EQ(Status::NotFound(), scheduler.RunStep());
+  EXPECT_EQ(client.steps(), 0u);
+}
+
+TEST(FlashMaintenanceScheduler, RunsClientFurthestBelowTarget) {
+  FlashMaintenanceScheduler scheduler;
+  FakeClient kvs(1000, 800);
+  FakeClient blob(500, 100);
+  scheduler.Register(kvs);
+  scheduler.Register(blob);
+
+  // The blob is 400 bytes short and the KVS 200, so the blob is served until
+  // it is as close to its target as the KVS.
+  EXPECT_EQ(OkStatus(), scheduler.RunStep());
+  EXPECT_EQ(OkStatus(), scheduler.RunStep());
+  EXPECT_EQ(blob.steps(), 2u);
+  EXPECT_EQ(kvs.steps(), 0u);
+
+  while (scheduler.RunStep().ok()) {
+  }
+  EXPECT_EQ(blob.free_bytes(), 500u);
+  EXPECT_EQ(kvs.free_bytes(), 1000u);
+  EXPECT_EQ(blob.steps(), 4u);
+  EXPECT_EQ(kvs.steps(), 2u);
+}
+
+TEST(FlashMaintenanceScheduler, ClientWithNothingToDo_IdleUntilForeground) {
+  FlashMaintenanceScheduler scheduler;
+  FakeClient client(500, 100);
+  client.set_step_status(Status::NotFound());
+  scheduler.Register(client);
+
+  EXPECT_EQ(OkStatus(), scheduler.RunStep());
+  EXPECT_EQ(Status::NotFound(), scheduler.RunStep());
+  EXPECT_EQ(client.steps(), 1u);
+
+  // A foreground operation may have made work for the client.
+  { FlashMaintenanceScheduler::ForegroundOperation op(scheduler); }
+  client.set_step_status(OkStatus());
+
+  EXPECT_EQ(OkStatus(), scheduler.RunStep());
+  EXPECT_EQ(client.steps(), 2u);
+}
+
+TEST(FlashMaintenanceScheduler, FailedStep_ReturnsErrorAndSkipsClient) {
+  FlashMaintenanceScheduler scheduler;
+  FakeClient failing(1000, 0);
+  FakeClient other(500, 400);
+  failing.set_step_status(Status::Internal());
+  scheduler.Register(failing);
+  scheduler.Register(other);
+
+  EXPECT_EQ(Status::Internal(), scheduler.RunStep());
+  EXPECT_EQ(OkStatus(), scheduler.RunStep());
+  EXPECT_EQ(Status::NotFound(), scheduler.RunStep());
+  EXPECT_EQ(failing.steps(), 1u);
+  EXPECT_EQ(other.steps(), 1u);
+}
+
+TEST(FlashMaintenanceScheduler, Unregister) {
+  FlashMaintenanceScheduler scheduler;
+  FakeClient client(500, 0);
+  scheduler.Register(client);
+  scheduler.Unregister(client);
+
+  EXPECT_EQ(Status::NotFound(), scheduler.RunStep());
+  EXPECT_EQ(client.steps(), 0u);
+}
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x2c5e8f13, .checksum = &checksum};
+
+TEST(KeyValueStoreMaintenanceClient, CollectsUntilTargetIsFree) {
+  FakeFlashMemoryBuffer<512, 4> flash(16);
+  FlashPartition partition(&flash);
+  KeyValueStoreBuffer<8, 4> kvs(&partition, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  // Fill the KVS with stale copies of one key.
+  std::array<std::byte, 96> value{};
+  for (int i = 0; i < 12; ++i) {
+    value[0] = std::byte(i);
+    ASSERT_EQ(OkStatus(), kvs.Put("key", value));
+  }
+  const size_t writable_bytes = kvs.GetStorageStats().writable_bytes;
+  ASSERT_LT(writable_bytes, 1024u);
+
+  FlashMaintenanceScheduler scheduler;
+  KeyValueStoreMaintenanceClient client(kvs, 1024, 128);
+  scheduler.Register(client);
+
+  while (scheduler.RunStep().ok()) {
+  }
+
+  EXPECT_GE(kvs.GetStorageStats().writable_bytes, 1024u);
+
+  std::array<std::byte, 96> read{};
+  EXPECT_EQ(OkStatus(), kvs.Get("key", read).status());
+  EXPECT_EQ(read[0], std::byte(11));
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -31,6 +31,48 @@ namespace pw::kvs {
 
 using std::byte;
 
+namespace {
+
+// Writes to consecutive FlashMemory addresses.
+class FlashMemoryOutput final : public pw::Output {
+ public:
+  constexpr FlashMemoryOutput(FlashMemory& flash, FlashMemory::Address address)
+      : flash_(flash), address_(address) {}
+
+ private:
+  StatusWithSize DoWrite(std::span<const byte> data) override {
+    PW_TRY_WITH_SIZE(flash_.Write(address_, data));
+    address_ += data.size();
+    return StatusWithSize(data.size());
+  }
+
+  FlashMemory& flash_;
+  FlashMemory::Address address_;
+};
+
+constexpr size_t kGatherBufferSize = std::max(kMaxFlashAlignment, size_t(64));
+
+size_t TotalSize(std::span<const ConstByteSpan> data) {
+  size_t total = 0;
+  for (const ConstByteSpan& chunk : data) {
+    total += chunk.size();
+  }
+  return total;
+}
+
+}  // namespace
+
+StatusWithSize FlashMemory::Write(Address destination_flash_address,
+                                  std::span<const ConstByteSpan> data) {
+  if (destination_flash_address % alignment_bytes() != 0u ||
+      TotalSize(data) % alignment_bytes() != 0u) {
+    return StatusWithSize::InvalidArgument();
+  }
+
+  FlashMemoryOutput output(*this, destination_flash_address);
+  return AlignedWrite<kGatherBufferSize>(output, alignment_bytes(), data);
+}
+
 StatusWithSize FlashPartition::Output::DoWrite(std::span<const byte> data) {
   PW_TRY_WITH_SIZE(flash_.Write(address_, data));
   address_ += data.size();
@@ -95,6 +137,68 @@ StatusWithSize FlashPartition::Write(Address address,
   return flash_.Write(PartitionToFlashAddress(address), data);
 }
 
+StatusWithSize FlashPartition::Write(Address address,
+                                     std::span<const ConstByteSpan> data) {
+  if (permission_ == PartitionPermission::kReadOnly) {
+    return StatusWithSize::PermissionDenied();
+  }
+  const size_t size = TotalSize(data);
+  PW_TRY_WITH_SIZE(CheckBounds(address, size));
+  const size_t address_alignment_offset = address % alignment_bytes();
+  PW_CHECK_UINT_EQ(address_alignment_offset, 0u);
+  const size_t size_alignment_offset = size % alignment_bytes();
+  PW_CHECK_UINT_EQ(size_alignment_offset, 0u);
+
+  if (write_combining_buffer_.empty()) {
+    return flash_.Write(PartitionToFlashAddress(address), data);
+  }
+
+  // Gather the data into the buffer, writing it out whenever it reaches the end
+  // of a page and at the end of the data. The first write runs from the
+  // address to the end of its page, so that the rest are page aligned.
+  const size_t page_size = write_combining_buffer_.size();
+  Address write_address = address;
+  size_t buffered = 0;
+  size_t remaining = size;
+
+  for (ConstByteSpan chunk : data) {
+    while (!chunk.empty()) {
+      const size_t page_remaining =
+          page_size -
+          PartitionToFlashAddress(write_address + buffered) % page_size;
+      const size_t to_copy = std::min(chunk.size(), page_remaining);
+      std::memcpy(&write_combining_buffer_[buffered], chunk.data(), to_copy);
+      buffered += to_copy;
+      remaining -= to_copy;
+      chunk = chunk.subspan(to_copy);
+
+      if (to_copy == page_remaining || remaining == 0u) {
+        const Status status =
+            flash_
+                .Write(PartitionToFlashAddress(write_address),
+                       write_combining_buffer_.first(buffered))
+                .status();
+        if (!status.ok()) {
+          return StatusWithSize(status, write_address - address);
+        }
+        write_address += buffered;
+        buffered = 0;
+      }
+    }
+  }
+
+  return StatusWithSize(size);
+}
+
+void FlashPartition::WriteCopies(std::span<const Address> addresses,
+                                 std::span<const ConstByteSpan> data,
+                                 std::span<StatusWithSize> results) {
+  PW_DCHECK_UINT_EQ(addresses.size(), results.size());
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    results[i] = Write(addresses[i], data);
+  }
+}
+
 Status FlashPartition::IsRegionErased(Address source_flash_address,
                                       size_t length,
                                       bool* is_erased) {
@@ -0,0 +1,179 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_kvs/timed_flash_memory.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kAlignment = 16;
+constexpr size_t kPageSize = 64;
+
+// Counts pages programmed and writes, so use one nanosecond per page.
+constexpr FlashTiming kTiming{.page_size_bytes = kPageSize,
+                              .page_program_ns = 1};
+
+class GatherWrite : public ::testing::Test {
+ protected:
+  GatherWrite()
+      : fake_flash_(kAlignment),
+        flash_(fake_flash_, kTiming),
+        partition_(&flash_) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    flash_.ResetStats();
+
+    for (size_t i = 0; i < data_.size(); ++i) {
+      data_[i] = std::byte(i);
+    }
+  }
+
+  ConstByteSpan flash_contents(size_t address, size_t size) const {
+    return std::span(fake_flash_.buffer()).subspan(address, size);
+  }
+
+  bool FlashMatchesData(size_t address, size_t size) const {
+    return std::memcmp(flash_contents(address, size).data(),
+                       data_.data(),
+                       size) == 0;
+  }
+
+  FakeFlashMemoryBuffer<512, 4> fake_flash_;
+  TimedFlashMemory flash_;
+  FlashPartition partition_;
+  std::array<std::byte, 256> data_;
+};
+
+TEST_F(GatherWrite, UnalignedChunks) {
+  const ConstByteSpan data(data_);
+  const StatusWithSize result = partition_.Write(
+      32, {data.subspan(0, 3), data.subspan(3, 20), data.subspan(23, 9)});
+
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(32u, result.size());
+  EXPECT_TRUE(FlashMatchesData(32, 32));
+}
+
+TEST_F(GatherWrite, EmptyChunks) {
+  const ConstByteSpan data(data_);
+  const StatusWithSize result =
+      partition_.Write(0, {ConstByteSpan(), data.first(16), ConstByteSpan()});
+
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(16u, result.size());
+  EXPECT_TRUE(FlashMatchesData(0, 16));
+}
+
+TEST_F(GatherWrite, FlashMemoryRejectsUnalignedSize) {
+  const ConstByteSpan data(data_);
+  const ConstByteSpan chunks[] = {data.first(10)};
+  EXPECT_EQ(Status::InvalidArgument(), fake_flash_.Write(0, chunks).status());
+}
+
+TEST_F(GatherWrite, ReadOnlyPartition) {
+  FlashPartition read_only(&flash_,
+                           0,
+                           flash_.sector_count(),
+                           0,
+                           PartitionPermission::kReadOnly);
+  EXPECT_EQ(Status::PermissionDenied(),
+            read_only.Write(0, {ConstByteSpan(data_).first(16)}).status());
+}
+
+TEST_F(GatherWrite, OutOfBounds) {
+  const StatusWithSize result =
+      partition_.Write(partition_.size_bytes() - 16, {ConstByteSpan(data_)});
+  EXPECT_EQ(Status::OutOfRange(), result.status());
+}
+
+class WriteCombining : public GatherWrite {
+ protected:
+  WriteCombining() { partition_.set_write_combining_buffer(buffer_); }
+
+  std::array<std::byte, kPageSize> buffer_;
+};
+
+TEST_F(WriteCombining, WritesEachPageOnce) {
+  const ConstByteSpan data(data_);
+  const StatusWithSize result =
+      partition_.Write(0,
+                       {data.subspan(0, 5),
+                        data.subspan(5, 50),
+                        data.subspan(55, 70),
+                        data.subspan(125, 3)});
+
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(128u, result.size());
+  EXPECT_TRUE(FlashMatchesData(0, 128));
+  EXPECT_EQ(2u, flash_.stats().writes);
+  EXPECT_EQ(2u, flash_.stats().pages_programmed);
+}
+
+TEST_F(WriteCombining, SplitsAtPageBoundaries) {
+  const ConstByteSpan data(data_);
+  const StatusWithSize result =
+      partition_.Write(48, {data.subspan(0, 7), data.subspan(7, 89)});
+
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(96u, result.size());
+  EXPECT_TRUE(FlashMatchesData(48, 96));
+
+  // 48-64, 64-128, and 128-144: three writes, each within one page.
+  EXPECT_EQ(3u, flash_.stats().writes);
+  EXPECT_EQ(3u, flash_.stats().pages_programmed);
+}
+
+TEST_F(WriteCombining, PartitionOffsetUsesFlashPages) {
+  FlashPartition partition(&flash_, 1, 2);
+  partition.set_write_combining_buffer(buffer_);
+
+  // Page boundaries are at flash addresses, so the first write ends at
+  // partition address 64 (flash address 576).
+  ASSERT_EQ(OkStatus(),
+            partition.Write(16, {ConstByteSpan(data_).first(64)}).status());
+  EXPECT_EQ(0,
+            std::memcmp(
+                flash_contents(512 + 16, 64).data(), data_.data(), 64));
+  EXPECT_EQ(2u, flash_.stats().writes);
+  EXPECT_EQ(2u, flash_.stats().pages_programmed);
+}
+
+TEST_F(WriteCombining, KeyValueStore) {
+  ChecksumCrc16 checksum;
+  const EntryFormat format{.magic = 0x6e2f9b10, .checksum = &checksum};
+  KeyValueStoreBuffer<8, 4> kvs(&partition_, format);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  flash_.ResetStats();
+  ASSERT_EQ(OkStatus(), kvs.Put("key", data_[5]));
+  EXPECT_EQ(1u, flash_.stats().writes);
+
+  std::byte value{};
+  ASSERT_EQ(OkStatus(), kvs.Get("key", &value));
+  EXPECT_EQ(data_[5], value);
+
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.Get("key", &value));
+  EXPECT_EQ(data_[5], value);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -17,13 +17,40 @@
 
 #include "pw_kvs/flash_partition_with_stats.h"
 
+#include <chrono>
 #include <cstdio>
 
+#include "pw_chrono/system_clock.h"
 #include "pw_kvs/flash_memory.h"
 #include "pw_kvs_private/config.h"
 #include "pw_log/log.h"
 
 namespace pw::kvs {
+namespace {
+
+using chrono::SystemClock;
+
+void Record(FlashPartitionWithStats::OperationStats& stats,
+            size_t bytes,
+            SystemClock::time_point start) {
+  const uint32_t latency_us = static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          SystemClock::now() - start)
+          .count());
+
+  size_t bucket = 0;
+  while (bucket + 1 < stats.latency_histogram.size() &&
+         (latency_us >> bucket) != 0u) {
+    bucket += 1;
+  }
+
+  stats.calls += 1;
+  stats.bytes += bytes;
+  stats.max_latency_us = std::max(stats.max_latency_us, latency_us);
+  stats.latency_histogram[bucket] += 1;
+}
+
+}  // namespace
 
 Status FlashPartitionWithStats::SaveStorageStats(const KeyValueStore& kvs,
                                                  const char* label) {
@@ -79,7 +106,46 @@ Status FlashPartitionWithStats::Erase(Address address, size_t num_sectors) {
     }
   }
 
-  return FlashPartition::Erase(address, num_sectors);
+  if (!recording()) {
+    return FlashPartition::Erase(address, num_sectors);
+  }
+  const SystemClock::time_point start = SystemClock::now();
+  const Status status = FlashPartition::Erase(address, num_sectors);
+  Record(erase_stats_, num_sectors * sector_size_bytes(), start);
+  return status;
+}
+
+StatusWithSize FlashPartitionWithStats::Read(Address address,
+                                             std::span<std::byte> output) {
+  if (!recording()) {
+    return FlashPartition::Read(address, output);
+  }
+  const SystemClock::time_point start = SystemClock::now();
+  const StatusWithSize result = FlashPartition::Read(address, output);
+  Record(read_stats_, result.size(), start);
+  return result;
+}
+
+StatusWithSize FlashPartitionWithStats::Write(Address address,
+                                              std::span<const std::byte> data) {
+  if (!recording()) {
+    return FlashPartition::Write(address, data);
+  }
+  const SystemClock::time_point start = SystemClock::now();
+  const StatusWithSize result = FlashPartition::Write(address, data);
+  Record(write_stats_, result.size(), start);
+  return result;
+}
+
+StatusWithSize FlashPartitionWithStats::Write(
+    Address address, std::span<const ConstByteSpan> data) {
+  if (!recording()) {
+    return FlashPartition::Write(address, data);
+  }
+  const SystemClock::time_point start = SystemClock::now();
+  const StatusWithSize result = FlashPartition::Write(address, data);
+  Record(write_stats_, result.size(), start);
+  return result;
 }
 
 }  // namespace pw::kvs
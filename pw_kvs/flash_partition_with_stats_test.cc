@@ -0,0 +1,127 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Always use stats, these tests depend on it.
+#define PW_KVS_RECORD_PARTITION_STATS 1
+
+#include "pw_kvs/flash_partition_with_stats.h"
+
+#include <array>
+#include <numeric>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_kvs_private/config.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectors = 4;
+
+size_t HistogramTotal(const FlashPartitionWithStats::OperationStats& stats) {
+  return std::accumulate(
+      stats.latency_histogram.begin(), stats.latency_histogram.end(), 0u);
+}
+
+class FlashPartitionWithStatsTest : public ::testing::Test {
+ protected:
+  FlashPartitionWithStatsTest() : flash_(16), partition_(&flash_) {
+    partition_.ResetCounters();
+  }
+
+  FakeFlashMemoryBuffer<512, kSectors> flash_;
+  FlashPartitionWithStatsBuffer<kSectors> partition_;
+};
+
+TEST_F(FlashPartitionWithStatsTest, CountsCallsAndBytes) {
+  ASSERT_EQ(OkStatus(), partition_.Erase(0, 2));
+
+  std::array<std::byte, 32> data{};
+  ASSERT_EQ(OkStatus(), partition_.Write(0, data).status());
+  ASSERT_EQ(OkStatus(), partition_.Write(32, data).status());
+  ASSERT_EQ(OkStatus(), partition_.Read(0, data).status());
+
+  EXPECT_EQ(1u, partition_.erase_stats().calls);
+  EXPECT_EQ(1024u, partition_.erase_stats().bytes);
+  EXPECT_EQ(2u, partition_.write_stats().calls);
+  EXPECT_EQ(64u, partition_.write_stats().bytes);
+  EXPECT_EQ(1u, partition_.read_stats().calls);
+  EXPECT_EQ(32u, partition_.read_stats().bytes);
+
+  EXPECT_EQ(1u, partition_.max_erase_count());
+  EXPECT_EQ(2u, partition_.total_erase_count());
+}
+
+TEST_F(FlashPartitionWithStatsTest, HistogramCountsEveryCall) {
+  std::array<std::byte, 16> data{};
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(OkStatus(), partition_.Read(0, data).status());
+  }
+
+  const FlashPartitionWithStats::OperationStats& stats =
+      partition_.read_stats();
+  EXPECT_EQ(10u, stats.calls);
+  EXPECT_EQ(10u, HistogramTotal(stats));
+}
+
+TEST_F(FlashPartitionWithStatsTest, ResetCounters) {
+  ASSERT_EQ(OkStatus(), partition_.Erase());
+  std::array<std::byte, 16> data{};
+  ASSERT_EQ(OkStatus(), partition_.Read(0, data).status());
+
+  partition_.ResetCounters();
+  EXPECT_EQ(0u, partition_.erase_stats().calls);
+  EXPECT_EQ(0u, partition_.read_stats().calls);
+  EXPECT_EQ(0u, HistogramTotal(partition_.read_stats()));
+  EXPECT_EQ(0u, partition_.max_erase_count());
+}
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x4d27c0e9, .checksum = &checksum};
+
+TEST_F(FlashPartitionWithStatsTest, KeyValueStoreLatencyStats) {
+  ASSERT_EQ(OkStatus(), partition_.Erase());
+  KeyValueStoreBuffer<8, kSectors> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  // Large enough that every write after the first few garbage collects.
+  std::array<std::byte, 400> value{};
+  for (int i = 0; i < 10; ++i) {
+    value[0] = std::byte(i);
+    ASSERT_EQ(OkStatus(), kvs.Put("key", value));
+  }
+
+  const KeyValueStore::LatencyStats& stats = kvs.latency_stats();
+  if (PW_KVS_RECORD_LATENCY_STATS) {
+    EXPECT_EQ(10u, stats.write.count);
+    EXPECT_GT(stats.inline_garbage_collection.count, 0u);
+    EXPECT_GE(stats.checksum.count, 10u);
+    EXPECT_GE(stats.write.total_us, stats.inline_garbage_collection.total_us);
+  } else {
+    EXPECT_EQ(0u, stats.write.count);
+    EXPECT_EQ(0u, stats.inline_garbage_collection.count);
+    EXPECT_EQ(0u, stats.checksum.count);
+  }
+
+  kvs.ResetLatencyStats();
+  EXPECT_EQ(0u, kvs.latency_stats().write.count);
+}
+
+}  // namespace
+}  // namespace pw::kvs
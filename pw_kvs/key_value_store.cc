@@ -20,13 +20,20 @@
 #include <algorithm>
 #include <cinttypes>
 #include <cstring>
+#include <limits>
+#include <optional>
 #include <type_traits>
 
 #include "pw_assert/check.h"
+#include "pw_kvs/compression.h"
 #include "pw_kvs_private/config.h"
 #include "pw_log/shorter.h"
 #include "pw_status/try.h"
 
+#if PW_KVS_RECORD_LATENCY_STATS
+#include "pw_chrono/system_clock.h"
+#endif  // PW_KVS_RECORD_LATENCY_STATS
+
 namespace pw::kvs {
 namespace {
 
@@ -36,6 +43,32 @@ constexpr bool InvalidKey(Key key) {
   return key.empty() || (key.size() > internal::Entry::kMaxKeyLength);
 }
 
+// Adds the time between its construction and destruction to a LatencyStats
+// phase. Does nothing if PW_KVS_RECORD_LATENCY_STATS is disabled.
+class ScopedLatency {
+ public:
+#if PW_KVS_RECORD_LATENCY_STATS
+  explicit ScopedLatency(KeyValueStore::LatencyStats::Phase& phase)
+      : phase_(phase), start_(chrono::SystemClock::now()) {}
+
+  ~ScopedLatency() {
+    const uint32_t elapsed_us = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            chrono::SystemClock::now() - start_)
+            .count());
+    phase_.count += 1;
+    phase_.total_us += elapsed_us;
+    phase_.max_us = std::max(phase_.max_us, elapsed_us);
+  }
+
+ private:
+  KeyValueStore::LatencyStats::Phase& phase_;
+  const chrono::SystemClock::time_point start_;
+#else
+  explicit constexpr ScopedLatency(KeyValueStore::LatencyStats::Phase&) {}
+#endif  // PW_KVS_RECORD_LATENCY_STATS
+};
+
 }  // namespace
 
 KeyValueStore::KeyValueStore(FlashPartition* partition,
@@ -44,17 +77,34 @@ KeyValueStore::KeyValueStore(FlashPartition* partition,
                              size_t redundancy,
                              Vector<SectorDescriptor>& sector_descriptor_list,
                              const SectorDescriptor** temp_sectors_to_skip,
-                             Vector<KeyDescriptor>& key_descriptor_list,
-                             Address* addresses)
+                             StatusWithSize* temp_write_results,
+                             internal::KeyDescriptorList& key_descriptor_list,
+                             Address* addresses,
+                             internal::EntryCache::HashIndexSlot* hash_index,
+                             size_t hash_index_slots,
+                             std::span<std::byte> value_cache,
+                             char* key_prefixes,
+                             size_t key_prefix_bytes)
     : partition_(*partition),
       formats_(formats),
       sectors_(sector_descriptor_list, *partition, temp_sectors_to_skip),
-      entry_cache_(key_descriptor_list, addresses, redundancy),
+      entry_cache_(key_descriptor_list,
+                   addresses,
+                   redundancy,
+                   hash_index,
+                   hash_index_slots,
+                   key_prefixes,
+                   key_prefix_bytes),
+      temp_write_results_(temp_write_results),
       options_(options),
       initialized_(InitializationState::kNotInitialized),
       error_detected_(false),
+      value_cache_(value_cache),
       internal_stats_({}),
-      last_transaction_id_(0) {}
+      latency_stats_{},
+      last_transaction_id_(0),
+      incremental_gc_{},
+      next_sector_to_scrub_(0) {}
 
 Status KeyValueStore::Init() {
   initialized_ = InitializationState::kNotInitialized;
@@ -141,6 +191,12 @@ Status KeyValueStore::InitializeMetadata() {
 
   sectors_.Reset();
   entry_cache_.Reset();
+  value_cache_.Reset();
+  incremental_gc_ = {};
+
+  if (options_.persist_erase_counts) {
+    LoadEraseCounts();
+  }
 
   DBG("First pass: Read all entries from all sectors");
   Address sector_address = 0;
@@ -151,10 +207,29 @@ Status KeyValueStore::InitializeMetadata() {
   size_t entry_copies_missing = 0;
 
   for (SectorDescriptor& sector : sectors_) {
+    if (options_.sector_summaries) {
+      const Status summary_status = LoadSectorSummary(sector);
+      if (!summary_status.IsNotFound()) {
+        if (!summary_status.ok()) {
+          error_detected_ = true;
+          corrupt_entries++;
+          sector.mark_corrupt();
+          WRN("Sector %u summary could not be loaded",
+              sectors_.Index(sector));
+        }
+        sector_address += sector_size_bytes;
+        continue;
+      }
+    }
+
     Address entry_address = sector_address;
 
     size_t sector_corrupt_bytes = 0;
 
+    // Batches are written contiguously within a sector, so a batch that is
+    // still pending at the end of the sector was never committed.
+    PendingBatch pending_batch;
+
     for (int num_entries_in_sector = 0; true; num_entries_in_sector++) {
       DBG("Load entry: sector=%u, entry#=%d, address=%u",
           unsigned(sector_address),
@@ -167,7 +242,8 @@ Status KeyValueStore::InitializeMetadata() {
       }
 
       Address next_entry_address;
-      Status status = LoadEntry(entry_address, &next_entry_address);
+      Status status =
+          LoadEntry(entry_address, &next_entry_address, pending_batch);
       if (status.IsNotFound()) {
         DBG("Hit un-written data in sector; moving to the next sector");
         break;
@@ -179,6 +255,10 @@ Status KeyValueStore::InitializeMetadata() {
         error_detected_ = true;
         corrupt_entries++;
 
+        // A corrupt entry breaks up any pending batch, so it cannot be
+        // committed.
+        pending_batch.Clear();
+
         status = ScanForEntry(sector,
                               entry_address + Entry::kMinAlignmentBytes,
                               &next_entry_address);
@@ -306,9 +386,20 @@ KeyValueStore::StorageStats KeyValueStore::GetStorageStats() const {
   stats.missing_redundant_entries_recovered =
       internal_stats_.missing_redundant_entries_recovered;
 
+  stats.value_cache_hits = value_cache_.hits();
+  stats.value_cache_misses = value_cache_.misses();
+  stats.unchanged_writes_skipped = internal_stats_.unchanged_writes_skipped;
+
+  stats.min_sector_erase_count = UINT32_MAX;
+  stats.max_sector_erase_count = 0;
+
   for (const SectorDescriptor& sector : sectors_) {
     stats.in_use_bytes += sector.valid_bytes();
     stats.reclaimable_bytes += sector.RecoverableBytes(sector_size);
+    stats.min_sector_erase_count =
+        std::min(stats.min_sector_erase_count, sector.erase_count());
+    stats.max_sector_erase_count =
+        std::max(stats.max_sector_erase_count, sector.erase_count());
 
     if (!found_empty_sector && sector.Empty(sector_size)) {
       // The KVS tries to always keep an empty sector for GC, so don't count
@@ -351,10 +442,19 @@ bool KeyValueStore::CheckForErrors() {
 }
 
 Status KeyValueStore::LoadEntry(Address entry_address,
-                                Address* next_entry_address) {
+                                Address* next_entry_address,
+                                PendingBatch& pending_batch) {
   Entry entry;
   PW_TRY(Entry::Read(partition_, entry_address, formats_, &entry));
 
+  // Sector summaries are not needed when reading every entry, so skip them.
+  // Erase counts are loaded separately, by LoadEraseCounts.
+  if (entry.sector_summary() || entry.erase_count_record()) {
+    PW_TRY(entry.VerifyChecksumInFlash());
+    *next_entry_address = entry.next_address();
+    return OkStatus();
+  }
+
   // Read the key from flash & validate the entry (which reads the value).
   Entry::KeyBuffer key_buffer;
   PW_TRY_ASSIGN(size_t key_length, entry.ReadKey(key_buffer));
@@ -365,8 +465,56 @@ Status KeyValueStore::LoadEntry(Address entry_address,
   // A valid entry was found, so update the next entry address before doing any
   // of the checks that happen in AddNewOrUpdateExisting.
   *next_entry_address = entry.next_address();
-  return entry_cache_.AddNewOrUpdateExisting(
-      entry.descriptor(key), entry.address(), partition_.sector_size_bytes());
+
+  // Entries in a batch are not loaded until the batch's final entry is found.
+  if (entry.batch_pending()) {
+    if (!pending_batch.active() ||
+        pending_batch.transaction_id != entry.transaction_id()) {
+      if (pending_batch.active()) {
+        DBG("Discarding uncommitted batch with transaction ID %u",
+            unsigned(pending_batch.transaction_id));
+      }
+      pending_batch.start = entry.address();
+      pending_batch.transaction_id = entry.transaction_id();
+    }
+    return OkStatus();
+  }
+
+  if (pending_batch.active()) {
+    if (pending_batch.transaction_id == entry.transaction_id()) {
+      PW_TRY(LoadBatchEntries(pending_batch.start, entry.address()));
+    } else {
+      DBG("Discarding uncommitted batch with transaction ID %u",
+          unsigned(pending_batch.transaction_id));
+    }
+    pending_batch.Clear();
+  }
+
+  return entry_cache_.AddNewOrUpdateExisting(entry.descriptor(key),
+                                             entry.address(),
+                                             partition_.sector_size_bytes(),
+                                             key);
+}
+
+// Loads the pending entries of a committed batch. The entries were verified
+// when they were first scanned.
+Status KeyValueStore::LoadBatchEntries(Address start_address,
+                                       Address end_address) {
+  for (Address address = start_address; address < end_address;) {
+    Entry entry;
+    PW_TRY(Entry::Read(partition_, address, formats_, &entry));
+
+    Entry::KeyBuffer key_buffer;
+    PW_TRY_ASSIGN(size_t key_length, entry.ReadKey(key_buffer));
+    const Key key(key_buffer.data(), key_length);
+
+    PW_TRY(entry_cache_.AddNewOrUpdateExisting(entry.descriptor(key),
+                                               entry.address(),
+                                               partition_.sector_size_bytes(),
+                                               key));
+    address = entry.next_address();
+  }
+  return OkStatus();
 }
 
 // Scans flash memory within a sector to find a KVS entry magic.
@@ -400,6 +548,262 @@ Status KeyValueStore::ScanForEntry(const SectorDescriptor& sector,
   return Status::NotFound();
 }
 
+// Loads a sector's entries from its summary record, if it has one. Returns
+// NOT_FOUND if the sector has no usable summary, in which case the entry cache
+// was not modified and the sector's entries must be read instead.
+Status KeyValueStore::LoadSectorSummary(SectorDescriptor& sector) {
+  Entry summary;
+  PW_TRY(FindSectorSummary(sector, &summary));
+
+  const Address sector_address = sectors_.BaseAddress(sector);
+  const size_t item_count = summary.summary_item_count();
+  std::array<SectorSummaryItem, 8> items;
+
+  for (size_t i = 0; i < item_count; i += items.size()) {
+    const std::span chunk =
+        std::span(items).first(std::min(items.size(), item_count - i));
+    PW_TRY(summary
+               .ReadValue(std::as_writable_bytes(chunk),
+                          i * sizeof(SectorSummaryItem))
+               .status());
+
+    for (const SectorSummaryItem& item : chunk) {
+      // Items may only refer to entries that precede the summary.
+      if (sector_address + item.offset >= summary.address() ||
+          item.state > uint8_t(EntryState::kDeleted)) {
+        ERR("Sector %u summary has an invalid item", sectors_.Index(sector));
+        return Status::DataLoss();
+      }
+
+      PW_TRY(entry_cache_.AddNewOrUpdateExisting(
+          {.key_hash = item.key_hash,
+           .transaction_id = item.transaction_id,
+           .state = EntryState(item.state)},
+          sector_address + item.offset,
+          partition_.sector_size_bytes()));
+    }
+  }
+
+  DBG("Loaded %u entries from sector %u summary",
+      unsigned(item_count),
+      sectors_.Index(sector));
+
+  // Nothing is written to a sector after its summary.
+  sector.set_writable_bytes(0);
+  return OkStatus();
+}
+
+// Finds a sector's summary record by reading the header of each entry in the
+// sector. The summary is only used if it verifies and is the last record in the
+// sector.
+Status KeyValueStore::FindSectorSummary(const SectorDescriptor& sector,
+                                        Entry* summary) {
+  Address address = sectors_.BaseAddress(sector);
+
+  while (sectors_.AddressInSector(sector, address)) {
+    Entry entry;
+    if (!Entry::Read(partition_, address, formats_, &entry).ok()) {
+      return Status::NotFound();
+    }
+    address = entry.next_address();
+
+    if (!entry.sector_summary()) {
+      continue;
+    }
+
+    Entry next_entry;
+    if (sectors_.AddressInSector(sector, address) &&
+        !Entry::Read(partition_, address, formats_, &next_entry)
+             .IsNotFound()) {
+      continue;  // Entries were written after this summary.
+    }
+
+    if (!entry.VerifyChecksumInFlash().ok()) {
+      return Status::NotFound();
+    }
+
+    *summary = entry;
+    return OkStatus();
+  }
+  return Status::NotFound();
+}
+
+// Summary items store entry offsets in 16 bits. Init rejects partitions with
+// sectors too large for a SectorDescriptor, which also keeps every offset in
+// range.
+static_assert(internal::SectorDescriptor::max_sector_size() <=
+                  std::numeric_limits<uint16_t>::max(),
+              "Sector summary offsets must hold any offset in a sector");
+
+class KeyValueStore::SectorSummaryItems final : public Entry::SummaryItems {
+ public:
+  SectorSummaryItems(const KeyValueStore& kvs, const SectorDescriptor& sector)
+      : kvs_(kvs),
+        sector_(sector),
+        metadata_(kvs.entry_cache_.cbegin()),
+        address_index_(0) {}
+
+  void Reset() override {
+    metadata_ = kvs_.entry_cache_.cbegin();
+    address_index_ = 0;
+  }
+
+  bool Next(SectorSummaryItem& item) override {
+    for (; metadata_ != kvs_.entry_cache_.cend(); ++metadata_) {
+      while (address_index_ < metadata_->addresses().size()) {
+        const Address address = metadata_->addresses()[address_index_++];
+        if (kvs_.sectors_.AddressInSector(sector_, address)) {
+          const Address offset = address - kvs_.sectors_.BaseAddress(sector_);
+          PW_DCHECK_UINT_LE(offset, std::numeric_limits<uint16_t>::max());
+          item = {
+              .key_hash = metadata_->hash(),
+              .transaction_id = metadata_->transaction_id(),
+              .offset = static_cast<uint16_t>(offset),
+              .state = static_cast<uint8_t>(metadata_->state()),
+              .reserved = 0,
+          };
+          return true;
+        }
+      }
+      address_index_ = 0;
+    }
+    return false;
+  }
+
+ private:
+  const KeyValueStore& kvs_;
+  const SectorDescriptor& sector_;
+  internal::EntryCache::const_iterator metadata_;
+  size_t address_index_;
+};
+
+// Writes a summary record listing the entries in a sector. No further entries
+// are written to the sector.
+Status KeyValueStore::WriteSectorSummary(SectorDescriptor& sector) {
+  const size_t item_count = EntriesInSector(sector);
+  const Address address = sectors_.NextWritableAddress(sector);
+
+  DBG("Writing summary of %u entries to sector %u",
+      unsigned(item_count),
+      sectors_.Index(sector));
+
+  Entry summary = Entry::SectorSummary(partition_,
+                                       address,
+                                       formats_.primary(),
+                                       item_count,
+                                       last_transaction_id_);
+  SectorSummaryItems items(*this, sector);
+
+  PW_TRY(MarkSectorCorruptIfNotOk(summary.WriteSectorSummary(items).status(),
+                                  &sector));
+
+  if (options_.verify_on_write) {
+    PW_TRY(MarkSectorCorruptIfNotOk(summary.VerifyChecksumInFlash(), &sector));
+  }
+
+  sector.set_writable_bytes(0);
+  return OkStatus();
+}
+
+// Loads each sector's erase count from its erase count record. Sectors without
+// a record, such as sectors that were erased and not written to since, are
+// assumed to be as worn as the most erased sector.
+void KeyValueStore::LoadEraseCounts() {
+  uint32_t max_erase_count = 0;
+
+  for (SectorDescriptor& sector : sectors_) {
+    Entry record;
+    uint32_t erase_count;
+    if (!Entry::Read(partition_, sectors_.BaseAddress(sector), formats_, &record)
+             .ok() ||
+        !record.erase_count_record() || !record.VerifyChecksumInFlash().ok() ||
+        !record.ReadValue(std::as_writable_bytes(std::span(&erase_count, 1)))
+             .ok()) {
+      continue;
+    }
+    sector.set_erase_count(erase_count);
+    sector.set_overhead_bytes(record.size());
+    max_erase_count = std::max(max_erase_count, erase_count);
+  }
+
+  for (SectorDescriptor& sector : sectors_) {
+    if (sector.overhead_bytes() == 0u) {
+      sector.set_erase_count(max_erase_count);
+    }
+  }
+}
+
+Status KeyValueStore::WriteEraseCountIfEmpty(SectorDescriptor& sector,
+                                             size_t entry_size) {
+  const size_t record_size = Entry::erase_count_size(partition_);
+  if (!options_.persist_erase_counts ||
+      !sector.Empty(partition_.sector_size_bytes()) ||
+      !sector.HasSpace(entry_size + record_size)) {
+    return OkStatus();
+  }
+
+  DBG("Writing erase count %u to sector %u",
+      unsigned(sector.erase_count()),
+      sectors_.Index(sector));
+
+  Entry record = Entry::EraseCount(partition_,
+                                   sectors_.BaseAddress(sector),
+                                   formats_.primary(),
+                                   last_transaction_id_);
+  PW_TRY(MarkSectorCorruptIfNotOk(
+      record.WriteEraseCount(sector.erase_count()).status(), &sector));
+
+  if (options_.verify_on_write) {
+    PW_TRY(MarkSectorCorruptIfNotOk(record.VerifyChecksumInFlash(), &sector));
+  }
+
+  sector.RemoveWritableBytes(record_size);
+  sector.set_overhead_bytes(record_size);
+  return OkStatus();
+}
+
+bool KeyValueStore::NeedsSectorSummary(const SectorDescriptor& sector,
+                                       size_t entry_size,
+                                       size_t entry_count) const {
+  const size_t sector_size_bytes = partition_.sector_size_bytes();
+
+  // Empty sectors have nothing to summarize.
+  if (!options_.sector_summaries || sector.Empty(sector_size_bytes)) {
+    return false;
+  }
+
+  // Avoid counting the entries in the sector if there is room for the summary
+  // even if the sector were filled with minimum-size entries.
+  constexpr size_t kMinEntrySize = 2 * Entry::kMinAlignmentBytes;
+  const size_t max_entries =
+      (sector_size_bytes - sector.writable_bytes()) / kMinEntrySize;
+  if (sector.writable_bytes() >=
+      entry_size +
+          Entry::sector_summary_size(partition_, max_entries + entry_count)) {
+    return false;
+  }
+
+  // If the sector was filled without room for a summary, it is not summarized.
+  const size_t entries = EntriesInSector(sector);
+  return sector.writable_bytes() >=
+             Entry::sector_summary_size(partition_, entries) &&
+         sector.writable_bytes() <
+             entry_size +
+                 Entry::sector_summary_size(partition_, entries + entry_count);
+}
+
+size_t KeyValueStore::EntriesInSector(const SectorDescriptor& sector) const {
+  size_t entries = 0;
+  for (const EntryMetadata& metadata : entry_cache_) {
+    for (Address address : metadata.addresses()) {
+      if (sectors_.AddressInSector(sector, address)) {
+        entries += 1;
+      }
+    }
+  }
+  return entries;
+}
+
 StatusWithSize KeyValueStore::Get(Key key,
                                   std::span<byte> value_buffer,
                                   size_t offset_bytes) const {
@@ -412,17 +816,22 @@ StatusWithSize KeyValueStore::Get(Key key,
 }
 
 Status KeyValueStore::PutBytes(Key key, std::span<const byte> value) {
+  ScopedLatency latency(latency_stats_.write);
   PW_TRY(CheckWriteOperation(key));
   DBG("Writing key/value; key length=%u, value length=%u",
       unsigned(key.size()),
       unsigned(value.size()));
 
-  if (Entry::size(partition_, key, value) > partition_.sector_size_bytes()) {
+  const Result<std::span<const byte>> stored_value = StoredValue(value);
+  if (!stored_value.ok() ||
+      Entry::size(partition_, key, stored_value.value()) >
+          partition_.sector_size_bytes()) {
     DBG("%u B value with %u B key cannot fit in one sector",
         unsigned(value.size()),
         unsigned(key.size()));
     return Status::InvalidArgument();
   }
+  value = stored_value.value();
 
   EntryMetadata metadata;
   Status status = FindEntry(key, &metadata);
@@ -444,6 +853,7 @@ Status KeyValueStore::PutBytes(Key key, std::span<const byte> value) {
 }
 
 Status KeyValueStore::Delete(Key key) {
+  ScopedLatency latency(latency_stats_.write);
   PW_TRY(CheckWriteOperation(key));
 
   EntryMetadata metadata;
@@ -457,31 +867,300 @@ Status KeyValueStore::Delete(Key key) {
   return WriteEntryForExistingKey(metadata, EntryState::kDeleted, key, {});
 }
 
+Status KeyValueStore::Batch::Add(Key key,
+                                 std::span<const byte> value,
+                                 EntryState state,
+                                 bool value_is_stored) {
+  if (InvalidKey(key)) {
+    return Status::InvalidArgument();
+  }
+
+  const uint32_t hash = internal::Hash(key);
+  for (Operation& operation : operations_) {
+    if (operation.key == key) {
+      operation.value = value;
+      operation.state = state;
+      operation.value_is_stored = value_is_stored;
+      return OkStatus();
+    }
+    if (internal::Hash(operation.key) == hash) {
+      return Status::AlreadyExists();
+    }
+  }
+
+  if (operations_.full()) {
+    return Status::ResourceExhausted();
+  }
+
+  operations_.push_back({.key = key,
+                         .value = value,
+                         .state = state,
+                         .has_prior_entry = false,
+                         .prior_size = 0,
+                         .metadata = {},
+                         .entry_size = 0,
+                         .value_is_stored = value_is_stored});
+  return OkStatus();
+}
+
+Status KeyValueStore::Commit(Batch& batch) {
+  ScopedLatency latency(latency_stats_.write);
+  if (!initialized()) {
+    return Status::FailedPrecondition();
+  }
+  if (batch.empty()) {
+    return OkStatus();
+  }
+
+  // Look up every key in the batch and check that the whole batch can be
+  // applied before writing anything.
+  size_t batch_size = 0;
+  size_t new_keys = 0;
+
+  for (Batch::Operation& operation : batch.operations_) {
+    Status status = FindEntry(operation.key, &operation.metadata);
+
+    if (status.ok()) {
+      if (operation.state == EntryState::kDeleted &&
+          operation.metadata.state() == EntryState::kDeleted) {
+        return Status::NotFound();
+      }
+      Entry prior_entry;
+      PW_TRY(ReadEntry(operation.metadata, prior_entry));
+      operation.has_prior_entry = true;
+      operation.prior_size = prior_entry.size();
+    } else if (status.IsNotFound()) {
+      if (operation.state == EntryState::kDeleted) {
+        return Status::NotFound();
+      }
+      operation.has_prior_entry = false;
+      new_keys += 1;
+    } else {
+      return status;
+    }
+
+    // Values are encoded again when the batch is written, since only one
+    // encoded value is held at a time.
+    if (operation.state == EntryState::kDeleted) {
+      operation.entry_size = Entry::size(partition_, operation.key, {});
+    } else if (operation.value_is_stored) {
+      operation.entry_size =
+          Entry::size(partition_, operation.key, operation.value);
+    } else {
+      const Result<std::span<const byte>> stored_value =
+          StoredValue(operation.value);
+      if (!stored_value.ok()) {
+        return Status::InvalidArgument();
+      }
+      operation.entry_size =
+          Entry::size(partition_, operation.key, stored_value.value());
+    }
+    batch_size += operation.entry_size;
+  }
+
+  if (batch_size > partition_.sector_size_bytes()) {
+    DBG("%u B batch cannot fit in one sector", unsigned(batch_size));
+    return Status::InvalidArgument();
+  }
+
+  if (new_keys > entry_cache_.max_entries() - entry_cache_.total_entries()) {
+    WRN("KVS full: trying to store %u new entries, but can't. Have %u entries",
+        unsigned(new_keys),
+        unsigned(entry_cache_.total_entries()));
+    return Status::ResourceExhausted();
+  }
+
+  // List of addresses for sectors with space for this batch.
+  Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
+
+  // Find addresses to write the batch to. This may involve garbage collecting
+  // one or more sectors.
+  PW_TRY(GetAddressesForWrite(reserved_addresses, batch_size, batch.size()));
+
+  // The whole batch shares a transaction ID. As with single entries, the ID is
+  // burned even if the write fails.
+  last_transaction_id_ += 1;
+  const uint32_t transaction_id = last_transaction_id_;
+
+  PW_TRY(AppendBatch(batch, reserved_addresses[0], transaction_id));
+
+  // The first copy of the batch is committed, so update the key descriptors.
+  Address address = reserved_addresses[0];
+  for (Batch::Operation& operation : batch.operations_) {
+    const KeyDescriptor descriptor{internal::Hash(operation.key),
+                                   transaction_id,
+                                   operation.state};
+    if (operation.has_prior_entry) {
+      for (Address prior_address : operation.metadata.addresses()) {
+        sectors_.FromAddress(prior_address)
+            .RemoveValidBytes(operation.prior_size);
+      }
+      operation.metadata.Reset(descriptor, address);
+      value_cache_.Remove(descriptor.key_hash);
+    } else {
+      operation.metadata =
+          entry_cache_.AddNew(descriptor, address, operation.key);
+    }
+    address += operation.entry_size;
+  }
+
+  // Write the additional copies of the batch, if redundancy is greater than 1.
+  for (size_t i = 1; i < redundancy(); ++i) {
+    PW_TRY(AppendBatch(batch, reserved_addresses[i], transaction_id));
+
+    address = reserved_addresses[i];
+    for (Batch::Operation& operation : batch.operations_) {
+      operation.metadata.AddNewAddress(address);
+      address += operation.entry_size;
+    }
+  }
+
+  batch.clear();
+  return OkStatus();
+}
+
+StatusWithSize KeyValueStore::ImportRawEntries(
+    std::span<const std::byte> entries, Batch& batch) {
+  if (!initialized()) {
+    return StatusWithSize::FailedPrecondition();
+  }
+
+  size_t imported = 0;
+  while (!entries.empty()) {
+    Entry entry;
+    Key key;
+    std::span<const byte> value;
+    Status status =
+        Entry::FromBuffer(partition_, entries, formats_, &entry, &key, &value);
+    if (!status.ok()) {
+      batch.clear();
+      return StatusWithSize(status, 0);
+    }
+    entries = entries.subspan(entry.size());
+
+    if (entry.deleted()) {
+      continue;
+    }
+
+    // Values in the primary format are written exactly as they are stored.
+    // Values in other formats are only accepted if they are not compressed, in
+    // which case they are encoded for the primary format like any other put.
+    const bool primary = entry.magic() == formats_.primary().magic;
+    if (!primary && entry.compressed()) {
+      batch.clear();
+      return StatusWithSize::InvalidArgument();
+    }
+
+    status = batch.Add(key, value, EntryState::kValid, primary);
+    if (!status.ok()) {
+      batch.clear();
+      return StatusWithSize(status, 0);
+    }
+    imported += 1;
+  }
+
+  const Status status = Commit(batch);
+  if (!status.ok()) {
+    batch.clear();
+    return StatusWithSize(status, 0);
+  }
+  return StatusWithSize(imported);
+}
+
 void KeyValueStore::Item::ReadKey() {
   key_buffer_.fill('\0');
 
-  Entry entry;
-  if (kvs_.ReadEntry(*iterator_, entry).ok()) {
-    entry.ReadKey(key_buffer_);
+  Entry::KeyBuffer key;
+  const StatusWithSize result = kvs_.ReadKey(*iterator_, key);
+  if (result.ok()) {
+    std::copy_n(key.begin(), result.size(), key_buffer_.begin());
   }
 }
 
 KeyValueStore::iterator& KeyValueStore::iterator::operator++() {
-  // Skip to the next entry that is valid (not deleted).
-  while (++item_.iterator_ != item_.kvs_.entry_cache_.end() &&
-         item_.iterator_->state() != EntryState::kValid) {
-  }
+  ++item_.iterator_;
+  SkipNonMatching();
   return *this;
 }
 
-KeyValueStore::iterator KeyValueStore::begin() const {
-  internal::EntryCache::const_iterator cache_iterator = entry_cache_.begin();
-  // Skip over any deleted entries at the start of the descriptor list.
-  while (cache_iterator != entry_cache_.end() &&
-         cache_iterator->state() != EntryState::kValid) {
-    ++cache_iterator;
+void KeyValueStore::iterator::SkipNonMatching() {
+  // Skip entries that are deleted or do not match the prefix.
+  const KeyValueStore& kvs = item_.kvs_;
+  while (item_.iterator_ != kvs.entry_cache_.end() &&
+         (item_.iterator_->state() != EntryState::kValid ||
+          !kvs.KeyHasPrefix(*item_.iterator_, prefix_))) {
+    ++item_.iterator_;
+  }
+}
+
+KeyValueStore::iterator KeyValueStore::begin() const { return begin(Key()); }
+
+KeyValueStore::iterator KeyValueStore::begin(Key prefix) const {
+  iterator it(*this, entry_cache_.begin(), prefix);
+  it.SkipNonMatching();
+  return it;
+}
+
+StatusWithSize KeyValueStore::ReadKey(const EntryMetadata& metadata,
+                                      Entry::KeyBuffer& key_buffer) const {
+  const Key cached_key = entry_cache_.CachedKey(metadata);
+  if (!cached_key.empty()) {
+    std::copy(cached_key.begin(), cached_key.end(), key_buffer.begin());
+    return StatusWithSize(cached_key.size());
+  }
+
+  Entry entry;
+  PW_TRY_WITH_SIZE(ReadEntry(metadata, entry));
+  StatusWithSize result = entry.ReadKey(key_buffer);
+  if (result.ok()) {
+    // Fill in the key prefix cache for entries loaded without their keys.
+    entry_cache_.SetKeyPrefix(metadata, Key(key_buffer.data(), result.size()));
+  }
+  return result;
+}
+
+bool KeyValueStore::KeyHasPrefix(const EntryMetadata& metadata,
+                                 Key prefix) const {
+  if (prefix.empty()) {
+    return true;
+  }
+
+  switch (entry_cache_.MatchKeyPrefix(metadata, prefix)) {
+    case internal::EntryCache::PrefixMatch::kMatch:
+      return true;
+    case internal::EntryCache::PrefixMatch::kNoMatch:
+      return false;
+    case internal::EntryCache::PrefixMatch::kUnknown:
+      break;
+  }
+
+  Entry::KeyBuffer key_buffer;
+  const StatusWithSize result = ReadKey(metadata, key_buffer);
+  return result.ok() && result.size() >= prefix.size() &&
+         std::memcmp(key_buffer.data(), prefix.data(), prefix.size()) == 0;
+}
+
+Result<ConstByteSpan> KeyValueStore::GetMapped(Key key,
+                                               bool verify_checksum) const {
+  PW_TRY(CheckReadOperation(key));
+
+  EntryMetadata metadata;
+  PW_TRY(FindExisting(key, &metadata));
+
+  Entry entry;
+  PW_TRY(ReadEntry(metadata, entry));
+
+  const std::byte* value =
+      partition_.PartitionAddressToMcuAddress(entry.value_address());
+  if (value == nullptr || entry.compressed()) {
+    return Status::Unimplemented();
   }
-  return iterator(*this, cache_iterator);
+
+  const ConstByteSpan mapped_value(value, entry.value_size());
+  if (verify_checksum) {
+    PW_TRY(entry.VerifyChecksum(key, mapped_value));
+  }
+  return mapped_value;
 }
 
 StatusWithSize KeyValueStore::ValueSize(Key key) const {
@@ -512,6 +1191,17 @@ Status KeyValueStore::ReadEntry(const EntryMetadata& metadata,
   return read_result;
 }
 
+StatusWithSize KeyValueStore::ReadRawEntry(const EntryMetadata& metadata,
+                                           std::span<std::byte> buffer) const {
+  Entry entry;
+  PW_TRY_WITH_SIZE(ReadEntry(metadata, entry));
+
+  if (buffer.size() < entry.size()) {
+    return StatusWithSize::ResourceExhausted();
+  }
+  return partition_.Read(entry.address(), buffer.first(entry.size()));
+}
+
 Status KeyValueStore::FindEntry(Key key, EntryMetadata* found_entry) const {
   StatusWithSize find_result =
       entry_cache_.Find(partition_, sectors_, formats_, key, found_entry);
@@ -538,20 +1228,57 @@ StatusWithSize KeyValueStore::Get(Key key,
                                   const EntryMetadata& metadata,
                                   std::span<std::byte> value_buffer,
                                   size_t offset_bytes) const {
+  StatusWithSize result = value_cache_.Get(metadata.hash(),
+                                           metadata.transaction_id(),
+                                           value_buffer,
+                                           offset_bytes);
+  if (!result.IsNotFound()) {
+    return result;
+  }
+
   Entry entry;
 
   PW_TRY_WITH_SIZE(ReadEntry(metadata, entry));
 
-  StatusWithSize result = entry.ReadValue(value_buffer, offset_bytes);
-  if (result.ok() && options_.verify_on_read && offset_bytes == 0u) {
-    Status verify_result =
-        entry.VerifyChecksum(key, value_buffer.first(result.size()));
-    if (!verify_result.ok()) {
-      std::memset(value_buffer.data(), 0, result.size());
-      return StatusWithSize(verify_result, 0);
+  if (entry.compressed()) {
+    result = GetCompressed(entry, value_buffer, offset_bytes);
+  } else {
+    result = entry.ReadValue(value_buffer, offset_bytes);
+    if (result.ok() && options_.verify_on_read && offset_bytes == 0u) {
+      ScopedLatency latency(latency_stats_.checksum);
+      Status verify_result =
+          entry.VerifyChecksum(key, value_buffer.first(result.size()));
+      if (!verify_result.ok()) {
+        std::memset(value_buffer.data(), 0, result.size());
+        return StatusWithSize(verify_result, 0);
+      }
     }
+  }
+
+  // Only complete values are cached.
+  if (result.ok() && offset_bytes == 0u && value_cache_.enabled()) {
+    value_cache_.Put(metadata.hash(),
+                     metadata.transaction_id(),
+                     value_buffer.first(result.size()));
+  }
+  return result;
+}
+
+// Reads a compressed value. The decompressed value cannot be checked against
+// the entry's checksum, so the compressed value is verified in flash instead.
+StatusWithSize KeyValueStore::GetCompressed(const Entry& entry,
+                                            std::span<std::byte> value_buffer,
+                                            size_t offset_bytes) const {
+  if (options_.verify_on_read && offset_bytes == 0u) {
+    ScopedLatency latency(latency_stats_.checksum);
+    PW_TRY_WITH_SIZE(entry.VerifyChecksumInFlash());
+  }
 
-    return StatusWithSize(verify_result, result.size());
+  StatusWithSize result =
+      entry.ReadDecompressedValue(value_buffer, offset_bytes);
+  if (result.IsDataLoss()) {
+    std::memset(value_buffer.data(), 0, value_buffer.size());
+    return StatusWithSize::DataLoss();
   }
   return result;
 }
@@ -589,10 +1316,16 @@ Status KeyValueStore::FixedSizeGet(Key key,
 }
 
 StatusWithSize KeyValueStore::ValueSize(const EntryMetadata& metadata) const {
+  const StatusWithSize cached_size =
+      value_cache_.ValueSize(metadata.hash(), metadata.transaction_id());
+  if (cached_size.ok()) {
+    return cached_size;
+  }
+
   Entry entry;
   PW_TRY_WITH_SIZE(ReadEntry(metadata, entry));
 
-  return StatusWithSize(entry.value_size());
+  return entry.DecompressedValueSize();
 }
 
 Status KeyValueStore::CheckWriteOperation(Key key) const {
@@ -650,14 +1383,22 @@ Status KeyValueStore::WriteEntry(Key key,
   // If new entry and prior entry have matching value size, state, and checksum,
   // check if the values match. Directly compare the prior and new values
   // because the checksum can not be depended on to establish equality, it can
-  // only be depended on to establish inequality.
-  if (prior_entry != nullptr && prior_entry->value_size() == value.size() &&
+  // only be depended on to establish inequality. Checking the checksum first
+  // avoids reading the prior value from flash when the value changed.
+  // The values are only compared if they are stored the same way.
+  const bool compressed = new_state == EntryState::kValid &&
+                          formats_.primary().compression != nullptr;
+  if (options_.skip_unchanged_writes && prior_entry != nullptr &&
+      prior_entry->value_size() == value.size() &&
       prior_metadata->state() == new_state &&
+      prior_entry->compressed() == compressed &&
+      prior_entry->VerifyChecksum(key, value).ok() &&
       prior_entry->ValueMatches(value).ok()) {
     // The new value matches the prior value, don't need to write anything. Just
     // keep the existing entry.
     DBG("Write for key 0x%08x with matching value skipped",
         unsigned(prior_metadata->hash()));
+    internal_stats_.unchanged_writes_skipped += 1;
     return OkStatus();
   }
 
@@ -669,23 +1410,33 @@ Status KeyValueStore::WriteEntry(Key key,
   const size_t entry_size = Entry::size(partition_, key, value);
   PW_TRY(GetAddressesForWrite(reserved_addresses, entry_size));
 
-  // Write the entry at the first address that was found.
-  Entry entry = CreateEntry(reserved_addresses[0], key, value, new_state);
-  PW_TRY(AppendEntry(entry, key, value));
-
-  // After writing the first entry successfully, update the key descriptors.
-  // Once a single new the entry is written, the old entries are invalidated.
-  size_t prior_size = prior_entry != nullptr ? prior_entry->size() : 0;
-  EntryMetadata new_metadata =
-      CreateOrUpdateKeyDescriptor(entry, key, prior_metadata, prior_size);
-
-  // Write the additional copies of the entry, if redundancy is greater than 1.
-  for (size_t i = 1; i < redundancy(); ++i) {
-    entry.set_address(reserved_addresses[i]);
-    PW_TRY(AppendEntry(entry, key, value));
-    new_metadata.AddNewAddress(reserved_addresses[i]);
+  // Write every copy of the entry. Copies in different flash banks may be
+  // written at the same time.
+  const std::span<const Address> addresses(reserved_addresses, redundancy());
+  const std::span<StatusWithSize> results(temp_write_results_, redundancy());
+  Entry entry = CreateEntry(addresses[0], key, value, new_state);
+  entry.WriteCopies(key, value, addresses, results);
+
+  // Once a single new entry is written, the old entries are invalidated, so
+  // update the key descriptor for the first copy that was written and add the
+  // other copies to it.
+  const size_t prior_size = prior_entry != nullptr ? prior_entry->size() : 0;
+  std::optional<EntryMetadata> new_metadata;
+  Status status;
+
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    entry.set_address(addresses[i]);
+    const Status copy_status = FinishAppendEntry(entry, results[i]);
+    if (!copy_status.ok()) {
+      status.Update(copy_status);
+    } else if (!new_metadata.has_value()) {
+      new_metadata =
+          CreateOrUpdateKeyDescriptor(entry, key, prior_metadata, prior_size);
+    } else {
+      new_metadata->AddNewAddress(addresses[i]);
+    }
   }
-  return OkStatus();
+  return status;
 }
 
 KeyValueStore::EntryMetadata KeyValueStore::CreateOrUpdateKeyDescriptor(
@@ -695,7 +1446,7 @@ KeyValueStore::EntryMetadata KeyValueStore::CreateOrUpdateKeyDescriptor(
     size_t prior_size) {
   // If there is no prior descriptor, create a new one.
   if (prior_metadata == nullptr) {
-    return entry_cache_.AddNew(entry.descriptor(key), entry.address());
+    return entry_cache_.AddNew(entry.descriptor(key), entry.address(), key);
   }
 
   return UpdateKeyDescriptor(
@@ -711,17 +1462,19 @@ KeyValueStore::EntryMetadata KeyValueStore::UpdateKeyDescriptor(
   for (Address address : prior_metadata->addresses()) {
     sectors_.FromAddress(address).RemoveValidBytes(prior_size);
   }
+  value_cache_.Remove(prior_metadata->hash());
 
   prior_metadata->Reset(entry.descriptor(prior_metadata->hash()), new_address);
   return *prior_metadata;
 }
 
 Status KeyValueStore::GetAddressesForWrite(Address* write_addresses,
-                                           size_t write_size) {
+                                           size_t write_size,
+                                           size_t entry_count) {
   for (size_t i = 0; i < redundancy(); i++) {
     SectorDescriptor* sector;
-    PW_TRY(
-        GetSectorForWrite(&sector, write_size, std::span(write_addresses, i)));
+    PW_TRY(GetSectorForWrite(
+        &sector, write_size, std::span(write_addresses, i), entry_count));
     write_addresses[i] = sectors_.NextWritableAddress(*sector);
 
     DBG("Found space for entry in sector %u at address %u",
@@ -739,8 +1492,9 @@ Status KeyValueStore::GetAddressesForWrite(Address* write_addresses,
 // RESOURCE_EXHAUSTED: No sector available with the needed space.
 Status KeyValueStore::GetSectorForWrite(SectorDescriptor** sector,
                                         size_t entry_size,
-                                        std::span<const Address> reserved) {
-  Status result = sectors_.FindSpace(sector, entry_size, reserved);
+                                        std::span<const Address> reserved,
+                                        size_t entry_count) {
+  Status result = FindSpace(sector, entry_size, entry_count, reserved);
 
   size_t gc_sector_count = 0;
   bool do_auto_gc = options_.gc_on_write != GargbageCollectOnWrite::kDisabled;
@@ -753,7 +1507,11 @@ Status KeyValueStore::GetSectorForWrite(SectorDescriptor** sector,
       do_auto_gc = false;
     }
     // Garbage collect and then try again to find the best sector.
-    Status gc_status = GarbageCollect(reserved);
+    Status gc_status;
+    {
+      ScopedLatency latency(latency_stats_.inline_garbage_collection);
+      gc_status = GarbageCollect(reserved);
+    }
     if (!gc_status.ok()) {
       if (gc_status.IsNotFound()) {
         // Not enough space, and no reclaimable bytes, this KVS is full!
@@ -762,7 +1520,7 @@ Status KeyValueStore::GetSectorForWrite(SectorDescriptor** sector,
       return gc_status;
     }
 
-    result = sectors_.FindSpace(sector, entry_size, reserved);
+    result = FindSpace(sector, entry_size, entry_count, reserved);
 
     gc_sector_count++;
     // Allow total sectors + 2 number of GC cycles so that once reclaimable
@@ -781,6 +1539,21 @@ Status KeyValueStore::GetSectorForWrite(SectorDescriptor** sector,
   return result;
 }
 
+// Finds a sector with space for a write. If sector summaries are enabled,
+// sectors that the write would fill are summarized instead of written to.
+Status KeyValueStore::FindSpace(SectorDescriptor** sector,
+                                size_t entry_size,
+                                size_t entry_count,
+                                std::span<const Address> reserved) {
+  while (true) {
+    PW_TRY(sectors_.FindSpace(sector, entry_size, reserved));
+    if (!NeedsSectorSummary(**sector, entry_size, entry_count)) {
+      return WriteEraseCountIfEmpty(**sector, entry_size);
+    }
+    PW_TRY(WriteSectorSummary(**sector));
+  }
+}
+
 Status KeyValueStore::MarkSectorCorruptIfNotOk(Status status,
                                                SectorDescriptor* sector) {
   if (!status.ok()) {
@@ -794,8 +1567,12 @@ Status KeyValueStore::MarkSectorCorruptIfNotOk(Status status,
 Status KeyValueStore::AppendEntry(const Entry& entry,
                                   Key key,
                                   std::span<const byte> value) {
-  const StatusWithSize result = entry.Write(key, value);
+  return FinishAppendEntry(entry, entry.Write(key, value));
+}
 
+// Checks the result of writing an entry and updates its sector's accounting.
+Status KeyValueStore::FinishAppendEntry(const Entry& entry,
+                                        StatusWithSize result) {
   SectorDescriptor& sector = sectors_.FromAddress(entry.address());
 
   if (!result.ok()) {
@@ -807,6 +1584,7 @@ Status KeyValueStore::AppendEntry(const Entry& entry,
   }
 
   if (options_.verify_on_write) {
+    ScopedLatency latency(latency_stats_.checksum);
     PW_TRY(MarkSectorCorruptIfNotOk(entry.VerifyChecksumInFlash(), &sector));
   }
 
@@ -815,9 +1593,50 @@ Status KeyValueStore::AppendEntry(const Entry& entry,
   return OkStatus();
 }
 
+// Writes all entries in a batch contiguously, starting at the provided address.
+// Every entry but the last is marked as pending; the batch is committed once
+// the last entry is written.
+Status KeyValueStore::AppendBatch(const Batch& batch,
+                                  Address address,
+                                  uint32_t transaction_id) {
+  const Address start_address = address;
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const Batch::Operation& operation = batch.operations_[i];
+    const bool batch_pending = i + 1 < batch.size();
+
+    std::span<const byte> value = operation.value;
+    if (operation.state != EntryState::kDeleted && !operation.value_is_stored) {
+      PW_TRY_ASSIGN(value, StoredValue(value));
+    }
+
+    Entry entry = CreateEntry(address,
+                              operation.key,
+                              value,
+                              operation.state,
+                              transaction_id,
+                              batch_pending);
+    Status status = AppendEntry(entry, operation.key, value);
+    if (!status.ok()) {
+      // This copy of the batch was not committed, so the entries that were
+      // written are not valid.
+      sectors_.FromAddress(start_address)
+          .RemoveValidBytes(address - start_address);
+      return status;
+    }
+    address = entry.next_address();
+  }
+  return OkStatus();
+}
+
 StatusWithSize KeyValueStore::CopyEntryToSector(Entry& entry,
                                                 SectorDescriptor* new_sector,
                                                 Address new_address) {
+  // A copied entry is not followed by the rest of its batch.
+  if (entry.batch_pending()) {
+    PW_TRY_WITH_SIZE(entry.ClearBatchPending());
+  }
+
   const StatusWithSize result = entry.Copy(new_address);
 
   PW_TRY_WITH_SIZE(MarkSectorCorruptIfNotOk(result.status(), new_sector));
@@ -854,8 +1673,15 @@ Status KeyValueStore::RelocateEntry(
   // an immediate extra relocation).
   SectorDescriptor* new_sector;
 
-  PW_TRY(sectors_.FindSpaceDuringGarbageCollection(
-      &new_sector, entry.size(), metadata.addresses(), reserved_addresses));
+  while (true) {
+    PW_TRY(sectors_.FindSpaceDuringGarbageCollection(
+        &new_sector, entry.size(), metadata.addresses(), reserved_addresses));
+    if (!NeedsSectorSummary(*new_sector, entry.size(), 1)) {
+      break;
+    }
+    PW_TRY(WriteSectorSummary(*new_sector));
+  }
+  PW_TRY(WriteEraseCountIfEmpty(*new_sector, entry.size()));
 
   Address new_address = sectors_.NextWritableAddress(*new_sector);
   PW_TRY_ASSIGN(const size_t result_size,
@@ -942,6 +1768,179 @@ Status KeyValueStore::PartialMaintenance() {
   return GarbageCollect(std::span<const Address>());
 }
 
+StatusWithSize KeyValueStore::MaintenanceStep(size_t max_bytes_relocated) {
+  if (initialized_ == InitializationState::kNotInitialized) {
+    return StatusWithSize::FailedPrecondition();
+  }
+
+  const size_t sector_size_bytes = partition_.sector_size_bytes();
+
+  // The sector may have been garbage collected by another operation since the
+  // last step.
+  if (incremental_gc_.sector != nullptr &&
+      incremental_gc_.sector->Empty(sector_size_bytes)) {
+    incremental_gc_ = {};
+  }
+
+  if (incremental_gc_.sector == nullptr) {
+    CheckForErrors();
+    // Do automatic repair, if KVS options allow for it.
+    if (error_detected_ && options_.recovery != ErrorRecovery::kManual) {
+      PW_TRY_WITH_SIZE(Repair());
+    }
+
+    SectorDescriptor* sector_to_gc =
+        sectors_.FindSectorToGarbageCollect(std::span<const Address>());
+
+    // Only collect sectors with reclaimable space. Moving entries out of a
+    // sector without any would never finish.
+    if (sector_to_gc == nullptr ||
+        sector_to_gc->RecoverableBytes(sector_size_bytes) == 0u) {
+      return StatusWithSize::NotFound();
+    }
+
+    DBG("Starting incremental garbage collection of sector %u",
+        sectors_.Index(sector_to_gc));
+
+    // Prevent new entries from being written to the sector while its entries
+    // are relocated. Its free space is reclaimed when it is erased.
+    sector_to_gc->set_writable_bytes(0);
+    incremental_gc_.sector = sector_to_gc;
+    incremental_gc_.next_entry_index = 0;
+  }
+
+  SectorDescriptor& sector = *incremental_gc_.sector;
+
+  internal::EntryCache::iterator metadata = entry_cache_.begin();
+  for (size_t i = 0; i < incremental_gc_.next_entry_index; ++i) {
+    ++metadata;
+  }
+
+  size_t bytes_relocated = 0;
+  while (metadata != entry_cache_.end() && sector.valid_bytes() != 0u &&
+         (bytes_relocated == 0u || bytes_relocated < max_bytes_relocated)) {
+    const size_t valid_bytes = sector.valid_bytes();
+    PW_TRY_WITH_SIZE(RelocateKeyAddressesInSector(
+        sector, *metadata, std::span<const Address>()));
+    bytes_relocated += valid_bytes - sector.valid_bytes();
+
+    incremental_gc_.next_entry_index += 1;
+    ++metadata;
+  }
+
+  if (sector.valid_bytes() == 0u || metadata == entry_cache_.end()) {
+    // All entries have been visited, so finish up with a regular sector GC.
+    // This erases the sector, and relocates any entries that are still in the
+    // sector (there should not be any).
+    incremental_gc_ = {};
+    PW_TRY_WITH_SIZE(GarbageCollectSector(sector, std::span<const Address>()));
+  }
+
+  return StatusWithSize(bytes_relocated);
+}
+
+StatusWithSize KeyValueStore::ScrubStep() {
+  if (initialized_ == InitializationState::kNotInitialized) {
+    return StatusWithSize::FailedPrecondition();
+  }
+
+  if (next_sector_to_scrub_ >= sectors_.size()) {
+    next_sector_to_scrub_ = 0;
+  }
+  SectorDescriptor& sector = *(sectors_.begin() + next_sector_to_scrub_);
+  next_sector_to_scrub_ += 1;
+
+  DBG("Scrubbing sector %u", sectors_.Index(sector));
+
+  size_t corrupt_entries = 0;
+  size_t intact_bytes = 0;
+  bool intact_bytes_known = true;
+  bool data_lost = false;
+
+  for (EntryMetadata& metadata : entry_cache_) {
+    // Dropping an address moves the last address into its slot, so only
+    // advance past addresses that are kept.
+    size_t i = 0;
+    while (i < metadata.addresses().size()) {
+      const Address address = metadata.addresses()[i];
+      if (!sectors_.AddressInSector(sector, address)) {
+        i += 1;
+        continue;
+      }
+
+      Entry entry;
+      const Status read_status =
+          Entry::Read(partition_, address, formats_, &entry);
+      Status status = read_status;
+      if (status.ok()) {
+        status = entry.VerifyChecksumInFlash();
+      }
+
+      if (status.ok()) {
+        intact_bytes += entry.size();
+        i += 1;
+        continue;
+      }
+
+      ERR("Scrub found corrupt entry for key 0x%08" PRIx32
+          " at address %u: %s",
+          metadata.hash(),
+          unsigned(address),
+          status.str());
+      corrupt_entries += 1;
+
+      if (metadata.addresses().size() > 1u) {
+        // Drop the corrupt copy; it is restored from one of the others.
+        metadata.RemoveAddress(address);
+        continue;
+      }
+
+      // This is the only copy, so keep it. Its size is unknown if the header
+      // could not be read.
+      data_lost = true;
+      if (read_status.ok()) {
+        intact_bytes += entry.size();
+      } else {
+        intact_bytes_known = false;
+      }
+      i += 1;
+    }
+  }
+
+  if (corrupt_entries == 0u) {
+    return StatusWithSize(0);
+  }
+
+  // The dropped copies no longer count as valid, so the sector can be garbage
+  // collected without relocating them.
+  if (intact_bytes_known && intact_bytes < sector.valid_bytes()) {
+    sector.RemoveValidBytes(sector.valid_bytes() - intact_bytes);
+  }
+  sector.mark_corrupt();
+
+  const bool earlier_error_detected = error_detected_;
+  error_detected_ = true;
+
+  if (options_.recovery != ErrorRecovery::kManual) {
+    // A sector with lost data cannot be garbage collected, but the keys whose
+    // copies were dropped can still have them rewritten.
+    if (!data_lost) {
+      PW_TRY_WITH_SIZE(
+          GarbageCollectSector(sector, std::span<const Address>()));
+      internal_stats_.corrupt_sectors_recovered += 1;
+    }
+    PW_TRY_WITH_SIZE(EnsureEntryRedundancy());
+    if (!data_lost) {
+      error_detected_ = earlier_error_detected;
+    }
+  }
+
+  if (data_lost) {
+    return StatusWithSize::DataLoss(corrupt_entries);
+  }
+  return StatusWithSize(corrupt_entries);
+}
+
 Status KeyValueStore::GarbageCollect(
     std::span<const Address> reserved_addresses) {
   DBG("Garbage Collect a single sector");
@@ -1003,7 +2002,7 @@ Status KeyValueStore::GarbageCollectSector(
     sector_to_gc.mark_corrupt();
     internal_stats_.sector_erase_count++;
     PW_TRY(partition_.Erase(sectors_.BaseAddress(sector_to_gc), 1));
-    sector_to_gc.set_writable_bytes(partition_.sector_size_bytes());
+    sector_to_gc.MarkErased(partition_.sector_size_bytes());
   }
 
   DBG("  Garbage Collect sector %u complete", sectors_.Index(sector_to_gc));
@@ -1019,6 +2018,12 @@ StatusWithSize KeyValueStore::UpdateEntriesToPrimaryFormat() {
       // Ignore entries that are already on the primary format.
       continue;
     }
+    if (!entry.deleted() &&
+        entry.compressed() != (formats_.primary().compression != nullptr)) {
+      // The value would have to be rewritten, so leave the entry in its
+      // format, which is still readable, until the key is next written.
+      continue;
+    }
 
     DBG("Updating entry 0x%08x from old format [0x%08x] to new format "
         "[0x%08x]",
@@ -1212,6 +2217,17 @@ Status KeyValueStore::Repair() {
   return FixErrors();
 }
 
+// Returns a value as it is stored in an entry of the primary format. The
+// value is compressed if the format has a compressor.
+Result<std::span<const byte>> KeyValueStore::StoredValue(
+    std::span<const byte> value) const {
+  ValueCompressor* compression = formats_.primary().compression;
+  if (compression == nullptr) {
+    return value;
+  }
+  return compression->Encode(value);
+}
+
 KeyValueStore::Entry KeyValueStore::CreateEntry(Address address,
                                                 Key key,
                                                 std::span<const byte> value,
@@ -1230,16 +2246,32 @@ KeyValueStore::Entry KeyValueStore::CreateEntry(Address address,
   // By always burning transaction IDs, the above problem can't happen.
   last_transaction_id_ += 1;
 
+  return CreateEntry(address, key, value, state, last_transaction_id_, false);
+}
+
+KeyValueStore::Entry KeyValueStore::CreateEntry(Address address,
+                                                Key key,
+                                                std::span<const byte> value,
+                                                EntryState state,
+                                                uint32_t transaction_id,
+                                                bool batch_pending) {
+  // Creating an entry calculates its checksum.
+  ScopedLatency latency(latency_stats_.checksum);
   if (state == EntryState::kDeleted) {
-    return Entry::Tombstone(
-        partition_, address, formats_.primary(), key, last_transaction_id_);
+    return Entry::Tombstone(partition_,
+                            address,
+                            formats_.primary(),
+                            key,
+                            transaction_id,
+                            batch_pending);
   }
   return Entry::Valid(partition_,
                       address,
                       formats_.primary(),
                       key,
                       value,
-                      last_transaction_id_);
+                      transaction_id,
+                      batch_pending);
 }
 
 void KeyValueStore::LogDebugInfo() const {
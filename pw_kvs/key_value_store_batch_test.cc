@@ -0,0 +1,306 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <algorithm>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 4;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x3c5d8e1a, .checksum = &checksum};
+
+class KvsBatch : public ::testing::Test {
+ protected:
+  KvsBatch()
+      : flash_(16),
+        partition_(&flash_),
+        kvs_(&partition_, kFormat),
+        other_kvs_(&partition_, kFormat) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    EXPECT_EQ(OkStatus(), kvs_.Init());
+  }
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs_;
+
+  // A second KVS on the same partition, to check what is committed to flash.
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> other_kvs_;
+
+  KeyValueStore::BatchBuffer<4> batch_;
+};
+
+TEST_F(KvsBatch, Commit_Empty) {
+  EXPECT_EQ(OkStatus(), kvs_.Commit(batch_));
+  EXPECT_EQ(0u, kvs_.transaction_count());
+}
+
+TEST_F(KvsBatch, Commit_NotInitialized) {
+  ASSERT_EQ(OkStatus(), batch_.Put("key", uint32_t(1)));
+  EXPECT_EQ(Status::FailedPrecondition(), other_kvs_.Commit(batch_));
+}
+
+TEST_F(KvsBatch, Commit_PutsShareOneTransaction) {
+  ASSERT_EQ(OkStatus(), batch_.Put("one", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), batch_.Put("two", uint32_t(2)));
+  ASSERT_EQ(OkStatus(), batch_.Put("three", uint32_t(3)));
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch_));
+
+  EXPECT_TRUE(batch_.empty());
+  EXPECT_EQ(3u, kvs_.size());
+  EXPECT_EQ(1u, kvs_.transaction_count());
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs_.Get("one", &value));
+  EXPECT_EQ(1u, value);
+  ASSERT_EQ(OkStatus(), kvs_.Get("two", &value));
+  EXPECT_EQ(2u, value);
+  ASSERT_EQ(OkStatus(), kvs_.Get("three", &value));
+  EXPECT_EQ(3u, value);
+}
+
+TEST_F(KvsBatch, Commit_ReadBackAfterInit) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("existing", uint32_t(10)));
+  ASSERT_EQ(OkStatus(), kvs_.Put("doomed", uint32_t(11)));
+
+  ASSERT_EQ(OkStatus(), batch_.Put("existing", uint32_t(20)));
+  ASSERT_EQ(OkStatus(), batch_.Put("new", uint32_t(21)));
+  ASSERT_EQ(OkStatus(), batch_.Delete("doomed"));
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch_));
+
+  ASSERT_EQ(OkStatus(), other_kvs_.Init());
+  EXPECT_EQ(2u, other_kvs_.size());
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), other_kvs_.Get("existing", &value));
+  EXPECT_EQ(20u, value);
+  ASSERT_EQ(OkStatus(), other_kvs_.Get("new", &value));
+  EXPECT_EQ(21u, value);
+  EXPECT_EQ(Status::NotFound(), other_kvs_.Get("doomed", &value));
+}
+
+TEST_F(KvsBatch, Put_SameKeyReplacesOperation) {
+  ASSERT_EQ(OkStatus(), batch_.Put("key", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), batch_.Put("key", uint32_t(2)));
+  EXPECT_EQ(1u, batch_.size());
+
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch_));
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", &value));
+  EXPECT_EQ(2u, value);
+}
+
+TEST_F(KvsBatch, Put_Full) {
+  ASSERT_EQ(OkStatus(), batch_.Put("a", uint32_t(0)));
+  ASSERT_EQ(OkStatus(), batch_.Put("b", uint32_t(0)));
+  ASSERT_EQ(OkStatus(), batch_.Put("c", uint32_t(0)));
+  ASSERT_EQ(OkStatus(), batch_.Delete("d"));
+  ASSERT_EQ(batch_.max_size(), batch_.size());
+
+  EXPECT_EQ(Status::ResourceExhausted(), batch_.Put("z", uint32_t(0)));
+  EXPECT_EQ(OkStatus(), batch_.Put("a", uint32_t(1)));
+}
+
+TEST_F(KvsBatch, Put_InvalidKey) {
+  EXPECT_EQ(Status::InvalidArgument(), batch_.Put("", uint32_t(0)));
+  EXPECT_TRUE(batch_.empty());
+}
+
+TEST_F(KvsBatch, Commit_DeleteMissingKey_WritesNothing) {
+  ASSERT_EQ(OkStatus(), batch_.Put("key", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), batch_.Delete("not_there"));
+  EXPECT_EQ(Status::NotFound(), kvs_.Commit(batch_));
+
+  EXPECT_EQ(0u, kvs_.size());
+  EXPECT_EQ(0u, kvs_.transaction_count());
+  EXPECT_EQ(2u, batch_.size());
+}
+
+TEST_F(KvsBatch, Commit_TooLargeForSector) {
+  std::array<std::byte, 200> value{};
+  ASSERT_EQ(OkStatus(), batch_.Put("one", value));
+  ASSERT_EQ(OkStatus(), batch_.Put("two", value));
+  ASSERT_EQ(OkStatus(), batch_.Put("three", value));
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.Commit(batch_));
+  EXPECT_EQ(0u, kvs_.size());
+}
+
+TEST_F(KvsBatch, Commit_Interrupted_NoneOfBatchIsLoaded) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("one", uint32_t(1)));
+
+  ASSERT_EQ(OkStatus(), batch_.Put("one", uint32_t(100)));
+  ASSERT_EQ(OkStatus(), batch_.Put("two", uint32_t(200)));
+  ASSERT_EQ(OkStatus(), batch_.Put("three", uint32_t(300)));
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch_));
+
+  // Simulate losing power before the batch's final entry was written by
+  // erasing that entry.
+  const std::span<std::byte> memory = flash_.buffer();
+  constexpr std::string_view kFinalKey = "three";
+  const auto final_key = std::search(
+      memory.begin(),
+      memory.end(),
+      reinterpret_cast<const std::byte*>(kFinalKey.data()),
+      reinterpret_cast<const std::byte*>(kFinalKey.data() + kFinalKey.size()));
+  ASSERT_NE(final_key, memory.end());
+  // 16 B header + 5 B key + 4 B value, padded to the 16 B alignment.
+  constexpr size_t kFinalEntrySize = 32;
+  std::fill_n(final_key - sizeof(internal::EntryHeader),
+              kFinalEntrySize,
+              FakeFlashMemory::kErasedValue);
+
+  ASSERT_EQ(OkStatus(), other_kvs_.Init());
+  EXPECT_EQ(1u, other_kvs_.size());
+
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), other_kvs_.Get("one", &value));
+  EXPECT_EQ(1u, value);
+  EXPECT_EQ(Status::NotFound(), other_kvs_.Get("two", &value));
+  EXPECT_EQ(Status::NotFound(), other_kvs_.Get("three", &value));
+}
+
+TEST_F(KvsBatch, GarbageCollect_RelocatedBatchEntriesRemainValid) {
+  ASSERT_EQ(OkStatus(), batch_.Put("one", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), batch_.Put("two", uint32_t(2)));
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch_));
+
+  // Supersede only the batch's final entry, then move everything.
+  ASSERT_EQ(OkStatus(), kvs_.Put("two", uint32_t(22)));
+  ASSERT_EQ(OkStatus(), kvs_.HeavyMaintenance());
+
+  ASSERT_EQ(OkStatus(), other_kvs_.Init());
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), other_kvs_.Get("one", &value));
+  EXPECT_EQ(1u, value);
+  ASSERT_EQ(OkStatus(), other_kvs_.Get("two", &value));
+  EXPECT_EQ(22u, value);
+}
+
+// Exports every entry of a KVS, concatenated, into the buffer.
+size_t ExportAll(const KeyValueStore& kvs, std::span<std::byte> buffer) {
+  size_t size = 0;
+  for (const KeyValueStore::Item& item : kvs) {
+    const StatusWithSize result = item.ReadRawEntry(buffer.subspan(size));
+    EXPECT_EQ(OkStatus(), result.status());
+    size += result.size();
+  }
+  return size;
+}
+
+TEST_F(KvsBatch, ImportRawEntries_CopiesEntriesFromAnotherKvs) {
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> source_flash(16);
+  FlashPartition source_partition(&source_flash);
+  ASSERT_EQ(OkStatus(), source_partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> source(&source_partition,
+                                                             kFormat);
+  ASSERT_EQ(OkStatus(), source.Init());
+  ASSERT_EQ(OkStatus(), source.Put("one", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), source.Put("two", uint32_t(2)));
+  ASSERT_EQ(OkStatus(), source.Put("three", uint32_t(3)));
+  ASSERT_EQ(OkStatus(), source.Delete("three"));
+
+  std::array<std::byte, 256> exported;
+  const size_t exported_size = ExportAll(source, exported);
+
+  ASSERT_EQ(OkStatus(), kvs_.Put("two", uint32_t(22)));
+  const StatusWithSize result =
+      kvs_.ImportRawEntries(std::span(exported).first(exported_size), batch_);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(2u, result.size());
+  EXPECT_TRUE(batch_.empty());
+
+  ASSERT_EQ(OkStatus(), other_kvs_.Init());
+  EXPECT_EQ(2u, other_kvs_.size());
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), other_kvs_.Get("one", &value));
+  EXPECT_EQ(1u, value);
+  ASSERT_EQ(OkStatus(), other_kvs_.Get("two", &value));
+  EXPECT_EQ(2u, value);
+}
+
+TEST_F(KvsBatch, ImportRawEntries_CorruptEntry_ImportsNothing) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("one", uint32_t(1)));
+  ASSERT_EQ(OkStatus(), kvs_.Put("two", uint32_t(2)));
+
+  std::array<std::byte, 256> exported;
+  const size_t exported_size = ExportAll(kvs_, exported);
+
+  // Corrupt the first entry's key, which directly follows its header.
+  exported[sizeof(internal::EntryHeader)] ^= std::byte{0x01};
+
+  EXPECT_EQ(Status::DataLoss(),
+            kvs_.ImportRawEntries(std::span(exported).first(exported_size),
+                                  batch_)
+                .status());
+  EXPECT_TRUE(batch_.empty());
+  EXPECT_EQ(2u, kvs_.transaction_count());
+}
+
+TEST_F(KvsBatch, ImportRawEntries_Truncated) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(1)));
+
+  std::array<std::byte, 64> exported;
+  const size_t exported_size = ExportAll(kvs_, exported);
+
+  EXPECT_EQ(Status::DataLoss(),
+            kvs_.ImportRawEntries(std::span(exported).first(exported_size - 1),
+                                  batch_)
+                .status());
+}
+
+TEST_F(KvsBatch, ImportRawEntries_UnknownFormat) {
+  constexpr EntryFormat kOtherFormat{.magic = 0x8b2f63d4,
+                                     .checksum = &checksum};
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> source_flash(16);
+  FlashPartition source_partition(&source_flash);
+  ASSERT_EQ(OkStatus(), source_partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> source(&source_partition,
+                                                             kOtherFormat);
+  ASSERT_EQ(OkStatus(), source.Init());
+  ASSERT_EQ(OkStatus(), source.Put("key", uint32_t(1)));
+
+  std::array<std::byte, 64> exported;
+  const size_t exported_size = ExportAll(source, exported);
+
+  EXPECT_EQ(Status::InvalidArgument(),
+            kvs_.ImportRawEntries(std::span(exported).first(exported_size),
+                                  batch_)
+                .status());
+  EXPECT_EQ(0u, kvs_.size());
+}
+
+TEST_F(KvsBatch, ReadRawEntry_BufferTooSmall) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", uint32_t(1)));
+
+  std::array<std::byte, 8> buffer;
+  for (const KeyValueStore::Item& item : kvs_) {
+    EXPECT_EQ(Status::ResourceExhausted(), item.ReadRawEntry(buffer).status());
+  }
+}
+
+}  // namespace
+}  // namespace pw::kvs
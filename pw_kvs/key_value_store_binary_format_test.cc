@@ -375,6 +375,29 @@ TEST_F(KvsErrorHandling, Put_WriteFailure_EntryNotAddedButBytesMarkedWritten) {
   EXPECT_EQ(stats.writable_bytes, 512u * 2 - (32 * kvs_.redundancy()));
 }
 
+TEST_F(KvsErrorHandling, ScrubStep_NotInitialized) {
+  EXPECT_EQ(Status::FailedPrecondition(), kvs_.ScrubStep().status());
+}
+
+TEST_F(KvsErrorHandling, ScrubStep_CorruptOnlyCopy_ReturnsDataLoss) {
+  InitFlashTo(bytes::Concat(kEntry1, kEntry2));
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+
+  // Corrupt the value of k2, which is only detected by the checksum.
+  flash_.buffer()[kEntry1.size() + sizeof(internal::EntryHeader) + 2] =
+      byte('V');
+
+  StatusWithSize result = kvs_.ScrubStep();
+  EXPECT_EQ(Status::DataLoss(), result.status());
+  EXPECT_EQ(1u, result.size());
+  EXPECT_EQ(true, kvs_.error_detected());
+
+  // With manual recovery, the sector is left for FullMaintenance to repair.
+  auto stats = kvs_.GetStorageStats();
+  EXPECT_EQ(stats.corrupt_sectors_recovered, 0u);
+  EXPECT_EQ(stats.writable_bytes, 512u * 2);
+}
+
 class KvsErrorRecovery : public ::testing::Test {
  protected:
   KvsErrorRecovery()
@@ -1014,6 +1037,52 @@ TEST_F(InitializedRedundantLazyRecoveryKvs, TwoSectorsCorruptWithGoodEntries) {
   EXPECT_EQ(stats.missing_redundant_entries_recovered, 4u);
 }
 
+TEST_F(InitializedRedundantMultiMagicKvs, ScrubStep_RepairsCorruptCopy) {
+  // Corrupt the value of the first copy of key1. Reads do not verify the
+  // checksum of the other entries in the sector, so only a scrub finds it.
+  flash_.buffer()[kNoChecksumEntry.size() + sizeof(internal::EntryHeader) +
+                  4] = byte('V');
+
+  StatusWithSize result = kvs_.ScrubStep();
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(1u, result.size());
+  EXPECT_EQ(false, kvs_.error_detected());
+
+  auto stats = kvs_.GetStorageStats();
+  EXPECT_EQ(stats.in_use_bytes, (192u * kvs_.redundancy()));
+  EXPECT_EQ(stats.reclaimable_bytes, 0u);
+  EXPECT_EQ(stats.corrupt_sectors_recovered, 1u);
+  EXPECT_EQ(stats.missing_redundant_entries_recovered, 1u);
+
+  ASSERT_CONTAINS_ENTRY("key1", "value1");
+  ASSERT_CONTAINS_ENTRY("k2", "value2");
+  ASSERT_CONTAINS_ENTRY("k3y", "value3");
+  ASSERT_CONTAINS_ENTRY("A Key", "XD");
+  ASSERT_CONTAINS_ENTRY("kee", "O_o");
+
+  // A full pass over the remaining sectors finds nothing else.
+  for (size_t i = 1; i < partition_.sector_count(); ++i) {
+    result = kvs_.ScrubStep();
+    EXPECT_EQ(OkStatus(), result.status());
+    EXPECT_EQ(0u, result.size());
+  }
+}
+
+TEST_F(InitializedRedundantMultiMagicKvs, ScrubStep_ScrubsOneSectorPerStep) {
+  EXPECT_EQ(0u, kvs_.ScrubStep().size());
+
+  flash_.buffer()[kNoChecksumEntry.size() + sizeof(internal::EntryHeader) +
+                  4] = byte('V');
+
+  // The corrupt sector was just scrubbed, so it is only visited again after
+  // every other sector.
+  for (size_t i = 1; i < partition_.sector_count(); ++i) {
+    EXPECT_EQ(0u, kvs_.ScrubStep().size());
+  }
+  EXPECT_EQ(1u, kvs_.ScrubStep().size());
+  ASSERT_CONTAINS_ENTRY("key1", "value1");
+}
+
 class InitializedLazyRecoveryKvs : public ::testing::Test {
  protected:
   static constexpr auto kInitialContents =
@@ -0,0 +1,287 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/compression.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 4;
+constexpr size_t kValueSize = 1500;
+
+ChecksumCrc16 checksum;
+ValueCompressorBuffer<2048> compressor;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kCompressedFormat{
+    .magic = 0x3e9a71c2, .checksum = &checksum, .compression = &compressor};
+constexpr EntryFormat kPlainFormat{.magic = 0x81d0f5b3, .checksum = &checksum};
+
+constexpr std::array<EntryFormat, 2> kBothFormats{kCompressedFormat,
+                                                  kPlainFormat};
+
+// Fills a buffer with repetitive, JSON-like text.
+template <size_t kSize>
+std::array<std::byte, kSize> Compressible(char id) {
+  constexpr std::string_view kRecord =
+      "{\"name\": \"sensor_?\", \"value\": 42}, ";
+  std::array<std::byte, kSize> value;
+  for (size_t i = 0; i < kSize; ++i) {
+    const char c = kRecord[i % kRecord.size()];
+    value[i] = std::byte(c == '?' ? id : c);
+  }
+  return value;
+}
+
+// Fills a buffer with bytes that do not compress.
+template <size_t kSize>
+std::array<std::byte, kSize> Incompressible() {
+  std::array<std::byte, kSize> value;
+  uint32_t state = 0x12345678;
+  for (std::byte& b : value) {
+    state = state * 1664525 + 1013904223;
+    b = std::byte(state >> 24);
+  }
+  return value;
+}
+
+// The flash is too large for the test fixture, which is allocated from the
+// test memory pool.
+FakeFlashMemoryBuffer<4096, kMaxUsableSectors> flash(16);
+
+class KvsCompression : public ::testing::Test {
+ protected:
+  KvsCompression() : partition_(&flash), kvs_(&partition_, kCompressedFormat) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    EXPECT_EQ(OkStatus(), kvs_.Init());
+  }
+
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs_;
+};
+
+TEST_F(KvsCompression, CompressibleValue_StoredSmaller) {
+  const auto value = Compressible<kValueSize>('a');
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+
+  EXPECT_LT(kvs_.GetStorageStats().in_use_bytes, kValueSize / 2);
+
+  const StatusWithSize size = kvs_.ValueSize("key");
+  ASSERT_EQ(OkStatus(), size.status());
+  EXPECT_EQ(kValueSize, size.size());
+
+  std::array<std::byte, kValueSize> read;
+  const StatusWithSize result = kvs_.Get("key", read);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(kValueSize, result.size());
+  EXPECT_EQ(0, std::memcmp(value.data(), read.data(), kValueSize));
+}
+
+TEST_F(KvsCompression, IncompressibleValue_StoredAsIs) {
+  const auto value = Incompressible<200>();
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+
+  EXPECT_EQ(200u, kvs_.ValueSize("key").size());
+
+  std::array<std::byte, 200> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(value, read);
+}
+
+TEST_F(KvsCompression, Get_WithOffsetAndSmallBuffer) {
+  const auto value = Compressible<kValueSize>('b');
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+
+  std::array<std::byte, 100> read;
+  const StatusWithSize result = kvs_.Get("key", read, 1000);
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(read.size(), result.size());
+  EXPECT_EQ(0, std::memcmp(value.data() + 1000, read.data(), read.size()));
+
+  const StatusWithSize end = kvs_.Get("key", read, kValueSize - 10);
+  EXPECT_EQ(OkStatus(), end.status());
+  EXPECT_EQ(10u, end.size());
+  EXPECT_EQ(0, std::memcmp(value.data() + kValueSize - 10, read.data(), 10));
+}
+
+TEST_F(KvsCompression, GetFixedSize) {
+  struct Settings {
+    uint32_t values[64];
+  } settings = {};
+  settings.values[63] = 123;
+  ASSERT_EQ(OkStatus(), kvs_.Put("settings", settings));
+
+  Settings read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("settings", &read));
+  EXPECT_EQ(123u, read.values[63]);
+}
+
+TEST_F(KvsCompression, ValueTooLargeForCompressor) {
+  std::array<std::byte, 2049> value{};
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.Put("key", value));
+}
+
+TEST_F(KvsCompression, Init_ReadsCompressedValues) {
+  const auto value = Compressible<kValueSize>('c');
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> other_kvs(
+      &partition_, kCompressedFormat);
+  ASSERT_EQ(OkStatus(), other_kvs.Init());
+
+  std::array<std::byte, kValueSize> read;
+  ASSERT_EQ(OkStatus(), other_kvs.Get("key", read).status());
+  EXPECT_EQ(value, read);
+}
+
+TEST_F(KvsCompression, Batch_CompressesValues) {
+  const auto value_1 = Compressible<kValueSize>('d');
+  const auto value_2 = Compressible<kValueSize>('e');
+
+  KeyValueStore::BatchBuffer<2> batch;
+  ASSERT_EQ(OkStatus(), batch.Put("key1", value_1));
+  ASSERT_EQ(OkStatus(), batch.Put("key2", value_2));
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch));
+
+  EXPECT_LT(kvs_.GetStorageStats().in_use_bytes, kValueSize);
+
+  std::array<std::byte, kValueSize> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key1", read).status());
+  EXPECT_EQ(value_1, read);
+  ASSERT_EQ(OkStatus(), kvs_.Get("key2", read).status());
+  EXPECT_EQ(value_2, read);
+}
+
+TEST_F(KvsCompression, GarbageCollect_KeepsCompressedValues) {
+  const auto value = Compressible<kValueSize>('f');
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+    ASSERT_EQ(OkStatus(), kvs_.Put("other", Compressible<kValueSize>('g' + i)));
+  }
+  ASSERT_EQ(OkStatus(), kvs_.HeavyMaintenance());
+
+  std::array<std::byte, kValueSize> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(value, read);
+}
+
+TEST_F(KvsCompression, PlainEntries_ReadableAfterFormatChange) {
+  const auto value = Compressible<kValueSize>('h');
+  {
+    KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> plain_kvs(
+        &partition_, kPlainFormat);
+    ASSERT_EQ(OkStatus(), plain_kvs.Init());
+    ASSERT_EQ(OkStatus(), plain_kvs.Put("old", value));
+    ASSERT_EQ(OkStatus(), plain_kvs.Put("new", value));
+  }
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors, 1, 2> kvs(&partition_,
+                                                                kBothFormats);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.FullMaintenance());
+
+  // Writing the same value again stores it compressed.
+  const size_t in_use_bytes = kvs.GetStorageStats().in_use_bytes;
+  ASSERT_EQ(OkStatus(), kvs.Put("new", value));
+  EXPECT_LT(kvs.GetStorageStats().in_use_bytes, in_use_bytes);
+
+  std::array<std::byte, kValueSize> read;
+  ASSERT_EQ(OkStatus(), kvs.Get("old", read).status());
+  EXPECT_EQ(value, read);
+  ASSERT_EQ(OkStatus(), kvs.Get("new", read).status());
+  EXPECT_EQ(value, read);
+}
+
+TEST_F(KvsCompression, ImportRawEntries_KeepsCompressedValues) {
+  const auto value = Compressible<kValueSize>('j');
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+  const size_t in_use_bytes = kvs_.GetStorageStats().in_use_bytes;
+
+  std::array<std::byte, kValueSize> exported;
+  size_t exported_size = 0;
+  for (const KeyValueStore::Item& item : kvs_) {
+    const StatusWithSize result = item.ReadRawEntry(exported);
+    ASSERT_EQ(OkStatus(), result.status());
+    exported_size = result.size();
+  }
+  ASSERT_EQ(in_use_bytes, exported_size);
+
+  ASSERT_EQ(OkStatus(), partition_.Erase());
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  KeyValueStore::BatchBuffer<1> batch;
+  const StatusWithSize result =
+      kvs_.ImportRawEntries(std::span(exported).first(exported_size), batch);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(1u, result.size());
+  EXPECT_EQ(in_use_bytes, kvs_.GetStorageStats().in_use_bytes);
+
+  std::array<std::byte, kValueSize> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(value, read);
+}
+
+TEST_F(KvsCompression, ImportRawEntries_CompressedOtherFormat) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Compressible<kValueSize>('k')));
+
+  std::array<std::byte, kValueSize> exported;
+  size_t exported_size = 0;
+  for (const KeyValueStore::Item& item : kvs_) {
+    exported_size = item.ReadRawEntry(exported).size();
+  }
+
+  // A KVS that only reads the compressed format cannot decompress the value.
+  constexpr std::array<EntryFormat, 2> kPlainFirst{kPlainFormat,
+                                                   kCompressedFormat};
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors, 1, 2> plain_kvs(
+      &partition_, kPlainFirst);
+  ASSERT_EQ(OkStatus(), plain_kvs.Init());
+  KeyValueStore::BatchBuffer<1> batch;
+  EXPECT_EQ(
+      Status::InvalidArgument(),
+      plain_kvs
+          .ImportRawEntries(std::span(exported).first(exported_size), batch)
+          .status());
+}
+
+TEST_F(KvsCompression, CorruptCompressedValue_DataLoss) {
+  const auto value = Compressible<kValueSize>('i');
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+
+  // Corrupt a byte of the compressed value, just past the key.
+  const std::span<std::byte> memory = flash.buffer();
+  for (size_t i = 0; i + 3 < memory.size(); ++i) {
+    if (std::memcmp(&memory[i], "key", 3) == 0) {
+      memory[i + 3 + sizeof(internal::CompressedValueHeader) + 1] ^=
+          std::byte{0xFF};
+      break;
+    }
+  }
+
+  std::array<std::byte, kValueSize> read;
+  EXPECT_EQ(Status::DataLoss(), kvs_.Get("key", read).status());
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,118 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 8;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x5a4e2d71, .checksum = &checksum};
+
+constexpr Options kEraseCountOptions{.persist_erase_counts = true};
+
+class KvsEraseCount : public ::testing::Test {
+ protected:
+  KvsEraseCount()
+      : flash_(16),
+        partition_(&flash_),
+        kvs_(&partition_, kFormat, kEraseCountOptions) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    EXPECT_EQ(OkStatus(), kvs_.Init());
+  }
+
+  // Writes a value large enough that only one entry and the erase count record
+  // fit in a 512 B sector, so every write garbage collects a sector.
+  void WriteLargeEntry(size_t times) {
+    std::array<std::byte, 400> value{};
+    for (size_t i = 0; i < times; ++i) {
+      value[0] = std::byte(i);
+      ASSERT_EQ(OkStatus(), kvs_.Put("large_entry", value));
+    }
+  }
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs_;
+};
+
+TEST_F(KvsEraseCount, FreshPartition_AllCountsZero) {
+  const KeyValueStore::StorageStats stats = kvs_.GetStorageStats();
+  EXPECT_EQ(0u, stats.min_sector_erase_count);
+  EXPECT_EQ(0u, stats.max_sector_erase_count);
+}
+
+TEST_F(KvsEraseCount, RepeatedWrites_WearIsEven) {
+  WriteLargeEntry(kMaxUsableSectors * 10);
+
+  const KeyValueStore::StorageStats stats = kvs_.GetStorageStats();
+  EXPECT_GE(stats.min_sector_erase_count, 8u);
+  EXPECT_LE(stats.max_sector_erase_count, stats.min_sector_erase_count + 1u);
+}
+
+TEST_F(KvsEraseCount, Init_RestoresCounts) {
+  WriteLargeEntry(kMaxUsableSectors * 10);
+  const KeyValueStore::StorageStats before = kvs_.GetStorageStats();
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(
+      &partition_, kFormat, kEraseCountOptions);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  // The erase from the last garbage collection is not recorded until the
+  // sector is written, and sectors without a record count as erased the most
+  // times of the recorded sectors, so counts are restored to within one.
+  const KeyValueStore::StorageStats after = kvs.GetStorageStats();
+  EXPECT_GE(after.min_sector_erase_count + 1u, before.min_sector_erase_count);
+  EXPECT_GE(after.max_sector_erase_count + 1u, before.max_sector_erase_count);
+  EXPECT_LE(after.max_sector_erase_count, before.max_sector_erase_count);
+
+  std::array<std::byte, 400> value{};
+  ASSERT_EQ(OkStatus(), kvs.Get("large_entry", value).status());
+  EXPECT_EQ(std::byte(kMaxUsableSectors * 10 - 1), value[0]);
+}
+
+TEST_F(KvsEraseCount, Init_WithoutOption_CountsStartAtZero) {
+  WriteLargeEntry(kMaxUsableSectors * 10);
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition_,
+                                                          kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  EXPECT_EQ(0u, kvs.GetStorageStats().max_sector_erase_count);
+
+  std::array<std::byte, 400> value{};
+  ASSERT_EQ(OkStatus(), kvs.Get("large_entry", value).status());
+  EXPECT_EQ(std::byte(kMaxUsableSectors * 10 - 1), value[0]);
+}
+
+TEST_F(KvsEraseCount, Record_NotCountedAsReclaimable) {
+  WriteLargeEntry(1);
+
+  const KeyValueStore::StorageStats stats = kvs_.GetStorageStats();
+  EXPECT_EQ(0u, stats.reclaimable_bytes);
+}
+
+}  // namespace
+}  // namespace pw::kvs
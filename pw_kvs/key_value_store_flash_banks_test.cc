@@ -0,0 +1,254 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <algorithm>
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/async_flash_memory.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 8;
+constexpr size_t kSectorsPerBank = 4;
+constexpr size_t kAlignment = 16;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x1d84b3a5, .checksum = &checksum};
+
+bool SectorErased(std::span<const std::byte> flash, size_t sector) {
+  const auto contents = flash.subspan(sector * kSectorSize, kSectorSize);
+  return std::all_of(contents.begin(), contents.end(), [](std::byte b) {
+    return b == std::byte{0xff};
+  });
+}
+
+// A FakeFlashMemory made of two banks of four sectors.
+class TwoBankFlash final
+    : public FakeFlashMemoryBuffer<kSectorSize, kSectorCount> {
+ public:
+  TwoBankFlash() : FakeFlashMemoryBuffer(kAlignment) {}
+
+  size_t sectors_per_bank() const override { return kSectorsPerBank; }
+};
+
+// An AsyncFlashMemory with two banks of four sectors. Erases and reads
+// complete immediately. Writes are held until writes_to_hold writes are in
+// progress, then complete together, which shows that they were in progress at
+// the same time.
+class TwoBankAsyncFlash final : public AsyncFlashMemory {
+ public:
+  TwoBankAsyncFlash()
+      : AsyncFlashMemory(kSectorSize, kSectorCount, kAlignment),
+        writes_to_hold_(1),
+        pending_count_(0),
+        max_pending_count_(0) {}
+
+  Status Enable() override { return OkStatus(); }
+  Status Disable() override { return OkStatus(); }
+  bool IsEnabled() const override { return true; }
+
+  size_t sectors_per_bank() const override { return kSectorsPerBank; }
+
+  Status StartErase(Address address,
+                    size_t num_sectors,
+                    Callback&& callback) override {
+    callback(StatusWithSize(flash_.Erase(address, num_sectors), 0));
+    return OkStatus();
+  }
+
+  Status StartRead(Address address,
+                   std::span<std::byte> output,
+                   Callback&& callback) override {
+    callback(flash_.Read(address, output));
+    return OkStatus();
+  }
+
+  Status StartWrite(Address address,
+                    std::span<const std::byte> data,
+                    Callback&& callback) override {
+    PendingWrite& write = pending_[address / kSectorSize / kSectorsPerBank];
+    if (write.callback != nullptr) {
+      return Status::Unavailable();  // One operation per bank at a time.
+    }
+    write = {.address = address, .data = data, .callback = std::move(callback)};
+    pending_count_ += 1;
+    max_pending_count_ = std::max(max_pending_count_, pending_count_);
+
+    if (pending_count_ >= writes_to_hold_) {
+      for (PendingWrite& pending : pending_) {
+        if (pending.callback != nullptr) {
+          Callback done = std::move(pending.callback);
+          pending.callback = nullptr;
+          pending_count_ -= 1;
+          done(flash_.Write(pending.address, pending.data));
+        }
+      }
+    }
+    return OkStatus();
+  }
+
+  void set_writes_to_hold(size_t writes) { writes_to_hold_ = writes; }
+
+  size_t max_pending_count() const { return max_pending_count_; }
+
+  std::span<const std::byte> buffer() { return flash_.buffer(); }
+
+ private:
+  struct PendingWrite {
+    Address address;
+    std::span<const std::byte> data;
+    Callback callback;
+  };
+
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_{kAlignment};
+  std::array<PendingWrite, kSectorCount / kSectorsPerBank> pending_;
+  size_t writes_to_hold_;
+  size_t pending_count_;
+  size_t max_pending_count_;
+};
+
+TEST(FlashBanks, PartitionBank) {
+  TwoBankFlash flash;
+  FlashPartition partition(&flash);
+  EXPECT_EQ(0u, partition.bank(0));
+  EXPECT_EQ(0u, partition.bank(4 * kSectorSize - 1));
+  EXPECT_EQ(1u, partition.bank(4 * kSectorSize));
+
+  FlashPartition offset_partition(&flash, 2, 4);
+  EXPECT_EQ(0u, offset_partition.bank(kSectorSize));
+  EXPECT_EQ(1u, offset_partition.bank(2 * kSectorSize));
+}
+
+TEST(FlashBanks, RedundantCopiesInDifferentBanks) {
+  TwoBankFlash flash;
+  FlashPartition partition(&flash);
+  ASSERT_EQ(OkStatus(), partition.Erase());
+
+  KeyValueStoreBuffer<8, kSectorCount, 2> kvs(&partition, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.Put("key", uint32_t(123)));
+
+  // The first copy goes in sector 1. Without banks, the second copy would go
+  // in sector 2; with them, it goes in the other bank.
+  EXPECT_FALSE(SectorErased(flash.buffer(), 1));
+  EXPECT_TRUE(SectorErased(flash.buffer(), 2));
+  EXPECT_TRUE(SectorErased(flash.buffer(), 3));
+  EXPECT_FALSE(SectorErased(flash.buffer(), 4) &&
+               SectorErased(flash.buffer(), 5) &&
+               SectorErased(flash.buffer(), 6) &&
+               SectorErased(flash.buffer(), 7));
+
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs.Get("key", &value));
+  EXPECT_EQ(123u, value);
+}
+
+TEST(FlashBanks, SingleBankUnchanged) {
+  FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash(kAlignment);
+  FlashPartition partition(&flash);
+  ASSERT_EQ(OkStatus(), partition.Erase());
+
+  KeyValueStoreBuffer<8, kSectorCount, 2> kvs(&partition, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.Put("key", uint32_t(123)));
+
+  EXPECT_FALSE(SectorErased(flash.buffer(), 1));
+  EXPECT_FALSE(SectorErased(flash.buffer(), 2));
+}
+
+class AsyncFlashBanks : public ::testing::Test {
+ protected:
+  AsyncFlashBanks() : partition_(&flash_) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    data_.fill(std::byte{0x5a});
+  }
+
+  TwoBankAsyncFlash flash_;
+  AsyncFlashPartition partition_;
+  std::array<std::byte, 48> data_;
+};
+
+TEST_F(AsyncFlashBanks, WriteCopies_DifferentBanksInParallel) {
+  flash_.set_writes_to_hold(2);
+
+  const ConstByteSpan data[] = {std::span(data_).first(5),
+                                std::span(data_).subspan(5)};
+  const FlashPartition::Address addresses[] = {32, 4 * kSectorSize + 64};
+  std::array<StatusWithSize, 2> results;
+  partition_.WriteCopies(addresses, data, results);
+
+  EXPECT_EQ(OkStatus(), results[0].status());
+  EXPECT_EQ(48u, results[0].size());
+  EXPECT_EQ(OkStatus(), results[1].status());
+  EXPECT_EQ(48u, results[1].size());
+  EXPECT_EQ(2u, flash_.max_pending_count());
+
+  EXPECT_EQ(std::byte{0x5a}, flash_.buffer()[32]);
+  EXPECT_EQ(std::byte{0x5a}, flash_.buffer()[32 + 47]);
+  EXPECT_EQ(std::byte{0x5a}, flash_.buffer()[4 * kSectorSize + 64 + 47]);
+}
+
+TEST_F(AsyncFlashBanks, WriteCopies_SameBankOneAtATime) {
+  const FlashPartition::Address addresses[] = {0, kSectorSize};
+  std::array<StatusWithSize, 2> results;
+  const ConstByteSpan data[] = {std::span(data_)};
+  partition_.WriteCopies(addresses, data, results);
+
+  EXPECT_EQ(OkStatus(), results[0].status());
+  EXPECT_EQ(OkStatus(), results[1].status());
+  EXPECT_EQ(1u, flash_.max_pending_count());
+  EXPECT_EQ(std::byte{0x5a}, flash_.buffer()[kSectorSize]);
+}
+
+TEST_F(AsyncFlashBanks, WriteCopies_FailedCopyDoesNotStopOthers) {
+  const FlashPartition::Address addresses[] = {16, 4 * kSectorSize + 8};
+  std::array<StatusWithSize, 2> results;
+  const ConstByteSpan data[] = {std::span(data_)};
+  partition_.WriteCopies(addresses, data, results);
+
+  EXPECT_EQ(OkStatus(), results[0].status());
+  EXPECT_EQ(48u, results[0].size());
+  EXPECT_EQ(Status::InvalidArgument(), results[1].status());
+  EXPECT_EQ(0u, results[1].size());
+  EXPECT_EQ(std::byte{0x5a}, flash_.buffer()[16 + 47]);
+}
+
+TEST_F(AsyncFlashBanks, KeyValueStore_WritesCopiesInParallel) {
+  KeyValueStoreBuffer<8, kSectorCount, 2> kvs(&partition_, kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  flash_.set_writes_to_hold(2);
+  ASSERT_EQ(OkStatus(), kvs.Put("key", uint32_t(0xfeedbeef)));
+  EXPECT_EQ(2u, flash_.max_pending_count());
+
+  flash_.set_writes_to_hold(1);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  uint32_t value = 0;
+  ASSERT_EQ(OkStatus(), kvs.Get("key", &value));
+  EXPECT_EQ(0xfeedbeef, value);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,186 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file implements a fuzz test for KeyValueStore::Init, which reads and
+// validates all of the entries and metadata in a partition. The first byte of
+// the fuzz data selects the KVS options, and the rest is the contents of the
+// flash partition. After Init, every entry found is read, and a new entry is
+// written, which must still be found when the KVS is initialized again.
+//
+// Random flash contents rarely contain entries with valid checksums, so a
+// custom mutator keeps most inputs realistic. It initializes a KVS from the
+// input's flash contents, writes and deletes entries with the KVS itself, and
+// returns the resulting flash contents.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+
+#include "pw_assert/assert.h"
+#include "pw_fuzzer/execution_timer.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+extern "C" size_t LLVMFuzzerMutate(uint8_t* data, size_t size, size_t max_size);
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 512;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+constexpr size_t kFlashSize = kSectorSize * kSectorCount;
+constexpr size_t kMaxEntries = 32;
+
+constexpr std::array<const char*, 4> kKeys = {"a", "key", "another key", "k4"};
+
+ChecksumCrc16 checksum;
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x31c4b5e7, .checksum = &checksum};
+
+// The options selector byte chooses the error recovery mode and the optional
+// metadata that Init reads.
+Options OptionsFor(uint8_t selector) {
+  constexpr ErrorRecovery kRecovery[] = {
+      ErrorRecovery::kImmediate, ErrorRecovery::kLazy, ErrorRecovery::kManual};
+  return Options{
+      .gc_on_write = GargbageCollectOnWrite::kOneSector,
+      .recovery = kRecovery[(selector & 0x3) % 3],
+      .verify_on_read = true,
+      .verify_on_write = true,
+      .sector_summaries = (selector & 0x4) != 0,
+      .persist_erase_counts = (selector & 0x8) != 0,
+  };
+}
+
+// A KVS on a fake flash partition loaded with fuzz data.
+class FuzzedKvs {
+ public:
+  FuzzedKvs(uint8_t selector, std::span<const uint8_t> contents)
+      : flash_(flash_buffer_, kSectorSize, kSectorCount, kAlignment),
+        partition_(&flash_, 0, kSectorCount),
+        kvs_(&partition_, kFormat, OptionsFor(selector)) {
+    flash_buffer_.fill(FakeFlashMemory::kErasedValue);
+    if (!contents.empty()) {
+      std::memcpy(flash_buffer_.data(),
+                  contents.data(),
+                  std::min(contents.size(), flash_buffer_.size()));
+    }
+  }
+
+  KeyValueStore& kvs() { return kvs_; }
+
+  // Returns the flash contents without the erased bytes at the end, which are
+  // restored when the contents are loaded.
+  std::span<const std::byte> contents() const {
+    size_t size = flash_buffer_.size();
+    while (size > 0 &&
+           flash_buffer_[size - 1] == FakeFlashMemory::kErasedValue) {
+      size -= 1;
+    }
+    return std::span(flash_buffer_.data(), size);
+  }
+
+ private:
+  std::array<std::byte, kFlashSize> flash_buffer_;
+  FakeFlashMemory flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kSectorCount> kvs_;
+};
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  fuzzer::ScopedExecutionTimer timer(data, size);
+  if (size == 0) {
+    return 0;
+  }
+
+  FuzzedKvs fuzzed(data[0], std::span(data + 1, size - 1));
+  KeyValueStore& kvs = fuzzed.kvs();
+  kvs.Init().IgnoreError();
+  if (!kvs.initialized()) {
+    return 0;
+  }
+
+  std::array<std::byte, kFlashSize> value;
+  for (const auto& item : kvs) {
+    item.ValueSize().IgnoreError();
+    item.Get(value).IgnoreError();
+  }
+
+  // A successful write must be found after the KVS is initialized again.
+  constexpr uint32_t kValue = 0x600dc0de;
+  if (kvs.Put("fuzz", kValue).ok()) {
+    kvs.Init().IgnoreError();
+    uint32_t read_value = 0;
+    PW_ASSERT(kvs.Get("fuzz", &read_value).ok());
+    PW_ASSERT(read_value == kValue);
+  }
+  return 0;
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t* data,
+                                          size_t size,
+                                          size_t max_size,
+                                          unsigned int seed) {
+  std::minstd_rand random(seed);
+
+  // Sometimes mutate the raw bytes instead, to corrupt entries and metadata.
+  if (size > 1 && random() % 4 == 0) {
+    return LLVMFuzzerMutate(data, size, max_size);
+  }
+  if (max_size < 1) {
+    return 0;
+  }
+
+  const uint8_t selector = size > 0 ? data[0] : uint8_t(random());
+  FuzzedKvs fuzzed(selector,
+                   size > 0 ? std::span(data + 1, size - 1)
+                            : std::span<const uint8_t>());
+  KeyValueStore& kvs = fuzzed.kvs();
+  kvs.Init().IgnoreError();
+
+  if (kvs.initialized()) {
+    for (size_t i = random() % 4; i <= 4; ++i) {
+      const char* key = kKeys[random() % kKeys.size()];
+      if (random() % 4 == 0) {
+        kvs.Delete(key).IgnoreError();
+        continue;
+      }
+
+      std::array<std::byte, 64> value;
+      for (std::byte& b : value) {
+        b = std::byte(random());
+      }
+      kvs.Put(key, std::span(value).first(1 + random() % value.size()))
+          .IgnoreError();
+    }
+  }
+
+  const std::span<const std::byte> contents = fuzzed.contents();
+  const size_t contents_size = std::min(contents.size(), max_size - 1);
+  data[0] = selector;
+  std::memcpy(data + 1, contents.data(), contents_size);
+  return 1 + contents_size;
+}
+
+}  // namespace pw::kvs
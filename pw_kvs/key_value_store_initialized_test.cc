@@ -36,7 +36,9 @@ using internal::EntryHeader;
 using std::byte;
 
 constexpr size_t kMaxEntries = 256;
-constexpr size_t kMaxUsableSectors = 1024;
+// The test partitions have at most a few sectors. Keep this small so that the
+// EmptyInitializedKvs fixture fits in the pw_unit_test memory pool.
+constexpr size_t kMaxUsableSectors = 256;
 
 FlashPartition& test_partition = FlashTestPartition();
 
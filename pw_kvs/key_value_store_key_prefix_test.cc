@@ -0,0 +1,175 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "pw_containers/vector.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 16;
+constexpr size_t kMaxUsableSectors = 4;
+constexpr size_t kKeyPrefixBytes = 8;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x53d7a1e2, .checksum = &checksum};
+
+// A FlashPartition that counts reads.
+class CountingPartition : public FlashPartition {
+ public:
+  using FlashPartition::FlashPartition;
+
+  using FlashPartition::Read;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override {
+    reads_ += 1;
+    return FlashPartition::Read(address, output);
+  }
+
+  size_t reads() const { return reads_; }
+  void ResetReads() { reads_ = 0; }
+
+ private:
+  size_t reads_ = 0;
+};
+
+template <typename Range>
+Vector<std::string, kMaxEntries> Keys(const Range& range) {
+  Vector<std::string, kMaxEntries> keys;
+  for (auto& item : range) {
+    keys.push_back(item.key());
+  }
+  return keys;
+}
+
+class KvsKeyPrefix : public ::testing::Test {
+ protected:
+  KvsKeyPrefix()
+      : flash_(16),
+        partition_(&flash_),
+        kvs_(&partition_, kFormat),
+        uncached_kvs_(&partition_, kFormat) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    EXPECT_EQ(OkStatus(), kvs_.Init());
+
+    for (const char* key :
+         {"net/addr", "net/mask", "net/gateway", "log/level"}) {
+      EXPECT_EQ(OkStatus(), kvs_.Put(key, uint32_t(1)));
+    }
+    partition_.ResetReads();
+  }
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> flash_;
+  CountingPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries,
+                      kMaxUsableSectors,
+                      1,
+                      1,
+                      0,
+                      0,
+                      kKeyPrefixBytes>
+      kvs_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> uncached_kvs_;
+};
+
+TEST_F(KvsKeyPrefix, IteratePrefix_FindsMatchingKeys) {
+  auto keys = Keys(kvs_.IteratePrefix("net/"));
+  ASSERT_EQ(3u, keys.size());
+  EXPECT_EQ("net/addr", keys[0]);
+  EXPECT_EQ("net/mask", keys[1]);
+  EXPECT_EQ("net/gateway", keys[2]);
+
+  keys = Keys(kvs_.IteratePrefix("log/"));
+  ASSERT_EQ(1u, keys.size());
+  EXPECT_EQ("log/level", keys[0]);
+
+  EXPECT_TRUE(Keys(kvs_.IteratePrefix("none")).empty());
+  EXPECT_EQ(4u, Keys(kvs_.IteratePrefix("")).size());
+}
+
+TEST_F(KvsKeyPrefix, IteratePrefix_NonMatchingKeysNotReadFromFlash) {
+  EXPECT_TRUE(Keys(kvs_.IteratePrefix("sys/")).empty());
+  EXPECT_EQ(0u, partition_.reads());
+}
+
+TEST_F(KvsKeyPrefix, IteratePrefix_ShortKeysServedFromRam) {
+  // "net/addr" and "net/mask" fit in the cache; "net/gateway" does not.
+  EXPECT_EQ(3u, Keys(kvs_.IteratePrefix("net/")).size());
+  EXPECT_GT(partition_.reads(), 0u);
+
+  partition_.ResetReads();
+  EXPECT_EQ(1u, Keys(kvs_.IteratePrefix("net/m")).size());
+  EXPECT_EQ(0u, partition_.reads());
+}
+
+TEST_F(KvsKeyPrefix, IteratePrefix_LongerThanCachedBytes) {
+  auto keys = Keys(kvs_.IteratePrefix("net/gateway"));
+  ASSERT_EQ(1u, keys.size());
+  EXPECT_EQ("net/gateway", keys[0]);
+
+  EXPECT_TRUE(Keys(kvs_.IteratePrefix("net/gateways")).empty());
+  EXPECT_TRUE(Keys(kvs_.IteratePrefix("net/addr/")).empty());
+}
+
+TEST_F(KvsKeyPrefix, IteratePrefix_SkipsDeletedKeys) {
+  ASSERT_EQ(OkStatus(), kvs_.Delete("net/mask"));
+
+  auto keys = Keys(kvs_.IteratePrefix("net/"));
+  ASSERT_EQ(2u, keys.size());
+  EXPECT_EQ("net/addr", keys[0]);
+  EXPECT_EQ("net/gateway", keys[1]);
+}
+
+TEST_F(KvsKeyPrefix, Init_CachesKeyPrefixes) {
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  partition_.ResetReads();
+
+  EXPECT_EQ(1u, Keys(kvs_.IteratePrefix("net/a")).size());
+  EXPECT_EQ(0u, partition_.reads());
+}
+
+TEST_F(KvsKeyPrefix, Commit_CachesKeyPrefixes) {
+  KeyValueStore::BatchBuffer<2> batch;
+  ASSERT_EQ(OkStatus(), batch.Put("sys/a", uint32_t(2)));
+  ASSERT_EQ(OkStatus(), batch.Put("sys/b", uint32_t(3)));
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch));
+  partition_.ResetReads();
+
+  EXPECT_EQ(2u, Keys(kvs_.IteratePrefix("sys/")).size());
+  EXPECT_EQ(0u, partition_.reads());
+}
+
+TEST_F(KvsKeyPrefix, IteratePrefix_WithoutCache) {
+  ASSERT_EQ(OkStatus(), uncached_kvs_.Init());
+
+  auto keys = Keys(uncached_kvs_.IteratePrefix("net/"));
+  ASSERT_EQ(3u, keys.size());
+  EXPECT_EQ("net/addr", keys[0]);
+  EXPECT_EQ("net/mask", keys[1]);
+  EXPECT_EQ("net/gateway", keys[2]);
+  EXPECT_TRUE(Keys(uncached_kvs_.IteratePrefix("sys/")).empty());
+}
+
+}  // namespace
+}  // namespace pw::kvs
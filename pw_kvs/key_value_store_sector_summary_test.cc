@@ -0,0 +1,191 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/internal/entry.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 4;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x7bf19895, .checksum = &checksum};
+
+constexpr Options kSummaryOptions{.sector_summaries = true};
+
+// Options for reporting, rather than repairing, errors found by Init.
+constexpr Options kManualRecoveryOptions{.recovery = ErrorRecovery::kManual};
+constexpr Options kManualRecoverySummaryOptions{
+    .recovery = ErrorRecovery::kManual, .sector_summaries = true};
+
+constexpr std::array<const char*, 10> kKeys{
+    "key0", "key1", "key2", "key3", "key4",
+    "key5", "key6", "key7", "key8", "key9",
+};
+
+class KvsSectorSummary : public ::testing::Test {
+ protected:
+  KvsSectorSummary()
+      : flash_(16),
+        partition_(&flash_),
+        kvs_(&partition_, kFormat, kSummaryOptions) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    EXPECT_EQ(OkStatus(), kvs_.Init());
+  }
+
+  // Writes each key with a 32 B value, so each entry is 64 B. A 512 B sector
+  // holds six entries and its summary.
+  void WriteKeys() {
+    for (size_t i = 0; i < kKeys.size(); ++i) {
+      std::array<std::byte, 32> value{};
+      value[0] = std::byte(i);
+      ASSERT_EQ(OkStatus(), kvs_.Put(kKeys[i], value));
+    }
+  }
+
+  void ExpectKeys(KeyValueStore& kvs) {
+    EXPECT_EQ(kKeys.size(), kvs.size());
+    for (size_t i = 0; i < kKeys.size(); ++i) {
+      std::array<std::byte, 32> value{};
+      ASSERT_EQ(OkStatus(), kvs.Get(kKeys[i], value).status());
+      EXPECT_EQ(std::byte(i), value[0]);
+    }
+  }
+
+  // Returns the offset in flash of the first occurrence of a key.
+  size_t FindKey(std::string_view key) {
+    const std::span<std::byte> memory = flash_.buffer();
+    const auto found = std::search(
+        memory.begin(),
+        memory.end(),
+        reinterpret_cast<const std::byte*>(key.data()),
+        reinterpret_cast<const std::byte*>(key.data() + key.size()));
+    EXPECT_NE(found, memory.end());
+    return found - memory.begin();
+  }
+
+  // Returns the address of the summary of the sector with the first key. The
+  // first six keys fill that sector, so it is summarized first.
+  size_t SummaryAddress() {
+    return FindKey(kKeys[0]) / flash_.sector_size_bytes() *
+               flash_.sector_size_bytes() +
+           6 * 64;
+  }
+
+  // Corrupts the value of the entry for a key.
+  void CorruptValue(std::string_view key) {
+    flash_.buffer()[FindKey(key) + key.size()] ^= std::byte{0xFF};
+  }
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs_;
+};
+
+TEST_F(KvsSectorSummary, FullSectorIsSummarized) {
+  WriteKeys();
+
+  // The first sector's summary follows its six entries.
+  internal::Entry summary;
+  ASSERT_EQ(OkStatus(),
+            internal::Entry::Read(partition_,
+                                  SummaryAddress(),
+                                  internal::EntryFormats(kFormat),
+                                  &summary));
+  EXPECT_TRUE(summary.sector_summary());
+  EXPECT_EQ(6u, summary.summary_item_count());
+  EXPECT_EQ(OkStatus(), summary.VerifyChecksumInFlash());
+
+  const KeyValueStore::StorageStats stats = kvs_.GetStorageStats();
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> other_kvs(
+      &partition_, kFormat, kSummaryOptions);
+  ASSERT_EQ(OkStatus(), other_kvs.Init());
+  ExpectKeys(other_kvs);
+  EXPECT_EQ(stats.reclaimable_bytes,
+            other_kvs.GetStorageStats().reclaimable_bytes);
+}
+
+TEST_F(KvsSectorSummary, Init_DoesNotReadSummarizedEntries) {
+  WriteKeys();
+  CorruptValue(kKeys[0]);
+
+  // The corrupt entry is in the summarized sector, so Init does not find it.
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> other_kvs(
+      &partition_, kFormat, kSummaryOptions);
+  ASSERT_EQ(OkStatus(), other_kvs.Init());
+  EXPECT_EQ(kKeys.size(), other_kvs.size());
+
+  // The corruption is found when the entry is read.
+  std::array<std::byte, 32> value;
+  EXPECT_EQ(Status::DataLoss(), other_kvs.Get(kKeys[0], value).status());
+}
+
+TEST_F(KvsSectorSummary, Init_WithoutSummaries_ReadsAllEntries) {
+  WriteKeys();
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> other_kvs(
+      &partition_, kFormat, kManualRecoveryOptions);
+  ASSERT_EQ(OkStatus(), other_kvs.Init());
+  ExpectKeys(other_kvs);
+
+  CorruptValue(kKeys[0]);
+  EXPECT_EQ(Status::DataLoss(), other_kvs.Init());
+}
+
+TEST_F(KvsSectorSummary, Init_CorruptSummary_ReadsEntries) {
+  WriteKeys();
+
+  // Corrupt the summary's checksum, which is the sector's last record.
+  flash_.buffer()[SummaryAddress() + sizeof(uint32_t)] ^= std::byte{0xFF};
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> other_kvs(
+      &partition_, kFormat, kManualRecoverySummaryOptions);
+  EXPECT_EQ(Status::DataLoss(), other_kvs.Init());
+  ExpectKeys(other_kvs);
+}
+
+TEST_F(KvsSectorSummary, GarbageCollect_SummarizedSector) {
+  WriteKeys();
+
+  // Overwrite the keys in the summarized sector, then garbage collect.
+  for (size_t i = 0; i < 6; ++i) {
+    std::array<std::byte, 32> value{};
+    value[0] = std::byte(i);
+    ASSERT_EQ(OkStatus(), kvs_.Put(kKeys[i], value));
+  }
+  ASSERT_EQ(OkStatus(), kvs_.HeavyMaintenance());
+  ExpectKeys(kvs_);
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> other_kvs(
+      &partition_, kFormat, kSummaryOptions);
+  ASSERT_EQ(OkStatus(), other_kvs.Init());
+  ExpectKeys(other_kvs);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -236,6 +236,43 @@ TEST(InMemoryKvs, WritingMultipleKeysIncreasesSize) {
   flash.Dump("WritingMultipleKeysIncreasesSize.bin");
 }
 
+TEST(InMemoryKvs, HashIndexed_WriteAndReadManyKeys) {
+  // Create and erase the fake flash.
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+
+  // Create and initialize a KVS with a hash index over its keys.
+  KeyValueStoreBuffer<64, kMaxUsableSectors, 1, 1, 128> kvs(&flash.partition,
+                                                            default_format);
+  ASSERT_OK(kvs.Init());
+
+  constexpr size_t kNumKeys = 40;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    ASSERT_OK(kvs.Put(key.view(), uint32_t(i + 77)));
+  }
+  EXPECT_EQ(kvs.size(), kNumKeys);
+
+  // Reinitialize to rebuild the index from flash, then read everything back.
+  ASSERT_OK(kvs.Init());
+  EXPECT_EQ(kvs.size(), kNumKeys);
+
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    StringBuffer<16> key;
+    key << "key_" << i;
+    uint32_t value = 0;
+    ASSERT_OK(kvs.Get(key.view(), &value));
+    EXPECT_EQ(value, uint32_t(i + 77));
+  }
+
+  ASSERT_OK(kvs.Delete("key_3"));
+  EXPECT_EQ(kvs.size(), kNumKeys - 1);
+  uint32_t value = 0;
+  EXPECT_EQ(Status::NotFound(), kvs.Get("key_3", &value));
+  EXPECT_EQ(Status::NotFound(), kvs.Get("not_a_key", &value));
+}
+
 TEST(InMemoryKvs, WriteAndReadOneKey) {
   // Create and erase the fake flash.
   Flash flash;
@@ -411,6 +448,86 @@ TEST_F(LargeEmptyInitializedKvs, FullMaintenance) {
   EXPECT_EQ(stats.reclaimable_bytes, 0u);
 }
 
+TEST_F(LargeEmptyInitializedKvs, GetMapped) {
+  std::array<std::byte, 300> value;
+  for (size_t i = 0; i < value.size(); ++i) {
+    value[i] = std::byte(i);
+  }
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], value));
+
+  Result<ConstByteSpan> mapped = kvs_.GetMapped(keys[0]);
+  ASSERT_EQ(OkStatus(), mapped.status());
+  ASSERT_EQ(value.size(), mapped.value().size());
+  EXPECT_EQ(0, std::memcmp(value.data(), mapped.value().data(), value.size()));
+
+  // The span refers directly to the flash memory.
+  const std::span<std::byte> memory = large_test_flash.buffer();
+  EXPECT_GE(mapped.value().data(), memory.data());
+  EXPECT_LT(mapped.value().data(), memory.data() + memory.size());
+
+  EXPECT_EQ(Status::NotFound(), kvs_.GetMapped(keys[1]).status());
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.GetMapped("").status());
+}
+
+TEST_F(LargeEmptyInitializedKvs, GetMapped_Corrupt) {
+  std::array<std::byte, 32> value{};
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], value));
+
+  Result<ConstByteSpan> mapped = kvs_.GetMapped(keys[0]);
+  ASSERT_EQ(OkStatus(), mapped.status());
+  const_cast<std::byte&>(mapped.value()[0]) = std::byte{0x55};
+
+  EXPECT_EQ(Status::DataLoss(), kvs_.GetMapped(keys[0]).status());
+
+  mapped = kvs_.GetMapped(keys[0], /* verify_checksum= */ false);
+  ASSERT_EQ(OkStatus(), mapped.status());
+  EXPECT_EQ(std::byte{0x55}, mapped.value()[0]);
+}
+
+TEST_F(LargeEmptyInitializedKvs, MaintenanceStep) {
+  EXPECT_EQ(Status::NotFound(), kvs_.MaintenanceStep(1).status());
+
+  // Write several keys, then rewrite the first, so that the sector with the
+  // other keys' entries has a stale entry.
+  std::array<std::byte, 100> value{};
+  for (size_t i = 0; i < keys.size(); ++i) {
+    value[0] = std::byte(i);
+    ASSERT_EQ(OkStatus(), kvs_.Put(keys[i], value));
+  }
+  value[0] = std::byte{0xAB};
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], value));
+
+  KeyValueStore::StorageStats stats = kvs_.GetStorageStats();
+  ASSERT_GT(stats.reclaimable_bytes, 0u);
+  const size_t in_use_bytes = stats.in_use_bytes;
+
+  // With a 1 B budget, each step relocates a single entry.
+  size_t steps = 0;
+  StatusWithSize result;
+  while ((result = kvs_.MaintenanceStep(1)).ok()) {
+    EXPECT_LE(result.size(), 128u);
+    steps += 1;
+    ASSERT_LT(steps, 10u);
+
+    // Writes between steps do not go to the sector being collected.
+    ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], value));
+  }
+  EXPECT_EQ(Status::NotFound(), result.status());
+  EXPECT_GE(steps, 2u);
+
+  stats = kvs_.GetStorageStats();
+  EXPECT_GE(stats.sector_erase_count, 1u);
+  EXPECT_EQ(in_use_bytes, stats.in_use_bytes);
+
+  for (size_t i = 1; i < keys.size(); ++i) {
+    std::array<std::byte, 100> read_value{};
+    ASSERT_EQ(OkStatus(), kvs_.Get(keys[i], read_value).status());
+    EXPECT_EQ(std::byte(i), read_value[0]);
+  }
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  EXPECT_EQ(keys.size(), kvs_.size());
+}
+
 TEST(InMemoryKvs, Put_MaxValueSize) {
   // Create and erase the fake flash.
   Flash flash;
@@ -0,0 +1,115 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 8;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x3bd0c68e, .checksum = &checksum};
+
+constexpr Options kAlwaysWriteOptions{.skip_unchanged_writes = false};
+
+class KvsUnchangedWrite : public ::testing::Test {
+ protected:
+  KvsUnchangedWrite() : flash_(16), partition_(&flash_) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+  }
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> flash_;
+  FlashPartition partition_;
+};
+
+TEST_F(KvsUnchangedWrite, SameValue_WriteSkipped) {
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition_,
+                                                          kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  const std::array<std::byte, 24> value{std::byte{1}, std::byte{2}};
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+  const KeyValueStore::StorageStats before = kvs.GetStorageStats();
+
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+
+  const KeyValueStore::StorageStats after = kvs.GetStorageStats();
+  EXPECT_EQ(2u, after.unchanged_writes_skipped);
+  EXPECT_EQ(before.in_use_bytes, after.in_use_bytes);
+  EXPECT_EQ(0u, after.reclaimable_bytes);
+}
+
+TEST_F(KvsUnchangedWrite, ChangedValueOfSameSize_Written) {
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition_,
+                                                          kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  std::array<std::byte, 24> value{};
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+  value[23] = std::byte{1};
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+
+  const KeyValueStore::StorageStats stats = kvs.GetStorageStats();
+  EXPECT_EQ(0u, stats.unchanged_writes_skipped);
+  EXPECT_NE(0u, stats.reclaimable_bytes);
+
+  std::array<std::byte, 24> read{};
+  ASSERT_EQ(OkStatus(), kvs.Get("settings", read).status());
+  EXPECT_EQ(value, read);
+}
+
+TEST_F(KvsUnchangedWrite, SameValueAfterInit_WriteSkipped) {
+  const std::array<std::byte, 8> value{std::byte{0xab}};
+  {
+    KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition_,
+                                                            kFormat);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+    ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+  }
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition_,
+                                                          kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+  EXPECT_EQ(1u, kvs.GetStorageStats().unchanged_writes_skipped);
+}
+
+TEST_F(KvsUnchangedWrite, OptionDisabled_SameValueWritten) {
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(
+      &partition_, kFormat, kAlwaysWriteOptions);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  const std::array<std::byte, 24> value{std::byte{1}, std::byte{2}};
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+  ASSERT_EQ(OkStatus(), kvs.Put("settings", value));
+
+  const KeyValueStore::StorageStats stats = kvs.GetStorageStats();
+  EXPECT_EQ(0u, stats.unchanged_writes_skipped);
+  EXPECT_NE(0u, stats.reclaimable_bytes);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,238 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/internal/value_cache.h"
+#include "pw_kvs/key_value_store.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 4;
+
+// Room for two 32-byte values.
+constexpr size_t kCacheBytes = 2 * (internal::ValueCache::kOverheadBytes + 32);
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x6b2f81d4, .checksum = &checksum};
+
+std::array<std::byte, 32> Value(char fill) {
+  std::array<std::byte, 32> value;
+  value.fill(std::byte(fill));
+  return value;
+}
+
+class KvsValueCache : public ::testing::Test {
+ protected:
+  KvsValueCache()
+      : flash_(16), partition_(&flash_), kvs_(&partition_, kFormat) {
+    EXPECT_EQ(OkStatus(), partition_.Erase());
+    EXPECT_EQ(OkStatus(), kvs_.Init());
+  }
+
+  size_t hits() const { return kvs_.GetStorageStats().value_cache_hits; }
+  size_t misses() const { return kvs_.GetStorageStats().value_cache_misses; }
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> flash_;
+  FlashPartition partition_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors, 1, 1, 0, kCacheBytes>
+      kvs_;
+};
+
+TEST_F(KvsValueCache, Get_SecondReadHits) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(0u, hits());
+  EXPECT_EQ(1u, misses());
+
+  read.fill(std::byte{0});
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(Value('a'), read);
+  EXPECT_EQ(1u, hits());
+  EXPECT_EQ(1u, misses());
+}
+
+TEST_F(KvsValueCache, Get_ServedFromRamNotFlash) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+
+  // Change the value in flash. The cached value is returned without reading
+  // the value from flash.
+  const std::span<std::byte> memory = flash_.buffer();
+  for (size_t i = 0; i + 3 < memory.size(); ++i) {
+    if (std::memcmp(&memory[i], "key", 3) == 0) {
+      memory[i + 3] = std::byte{'z'};
+      break;
+    }
+  }
+  read.fill(std::byte{0});
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(Value('a'), read);
+}
+
+TEST_F(KvsValueCache, Get_OffsetAndSmallBuffer) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+
+  std::array<std::byte, 10> small;
+  StatusWithSize result = kvs_.Get("key", small, 4);
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(10u, result.size());
+
+  result = kvs_.Get("key", small, 30);
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(2u, result.size());
+
+  EXPECT_EQ(Status::OutOfRange(), kvs_.Get("key", small, 33).status());
+  EXPECT_EQ(3u, hits());
+}
+
+TEST_F(KvsValueCache, PartialRead_NotCached) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 10> small;
+  EXPECT_EQ(Status::ResourceExhausted(), kvs_.Get("key", small).status());
+  EXPECT_EQ(Status::ResourceExhausted(), kvs_.Get("key", small).status());
+  EXPECT_EQ(0u, hits());
+  EXPECT_EQ(2u, misses());
+}
+
+TEST_F(KvsValueCache, Put_InvalidatesCachedValue) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('b')));
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(Value('b'), read);
+  EXPECT_EQ(0u, hits());
+}
+
+TEST_F(KvsValueCache, Delete_InvalidatesCachedValue) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+
+  ASSERT_EQ(OkStatus(), kvs_.Delete("key"));
+  EXPECT_EQ(Status::NotFound(), kvs_.Get("key", read).status());
+}
+
+TEST_F(KvsValueCache, Batch_InvalidatesCachedValues) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+
+  KeyValueStore::BatchBuffer<1> batch;
+  ASSERT_EQ(OkStatus(), batch.Put("key", Value('b')));
+  ASSERT_EQ(OkStatus(), kvs_.Commit(batch));
+
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(Value('b'), read);
+  EXPECT_EQ(0u, hits());
+}
+
+TEST_F(KvsValueCache, GarbageCollect_CachedValuesStillCorrect) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+
+  for (int i = 0; i < 40; ++i) {
+    ASSERT_EQ(OkStatus(), kvs_.Put("other", Value('c' + i % 20)));
+  }
+  ASSERT_EQ(OkStatus(), kvs_.FullMaintenance());
+
+  read.fill(std::byte{0});
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(Value('a'), read);
+}
+
+TEST_F(KvsValueCache, LeastRecentlyUsedValueEvicted) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("k1", Value('1')));
+  ASSERT_EQ(OkStatus(), kvs_.Put("k2", Value('2')));
+  ASSERT_EQ(OkStatus(), kvs_.Put("k3", Value('3')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("k1", read).status());
+  ASSERT_EQ(OkStatus(), kvs_.Get("k2", read).status());
+  ASSERT_EQ(OkStatus(), kvs_.Get("k1", read).status());  // k2 is now oldest.
+  ASSERT_EQ(OkStatus(), kvs_.Get("k3", read).status());  // Evicts k2.
+  EXPECT_EQ(1u, hits());
+  EXPECT_EQ(3u, misses());
+
+  ASSERT_EQ(OkStatus(), kvs_.Get("k1", read).status());
+  EXPECT_EQ(Value('1'), read);
+  EXPECT_EQ(2u, hits());
+
+  ASSERT_EQ(OkStatus(), kvs_.Get("k2", read).status());
+  EXPECT_EQ(Value('2'), read);
+  EXPECT_EQ(4u, misses());
+}
+
+TEST_F(KvsValueCache, ValueTooLargeForCache_NotCached) {
+  std::array<std::byte, kCacheBytes> value{};
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", value));
+
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", value).status());
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", value).status());
+  EXPECT_EQ(0u, hits());
+}
+
+TEST_F(KvsValueCache, Init_ClearsCache) {
+  ASSERT_EQ(OkStatus(), kvs_.Put("key", Value('a')));
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  ASSERT_EQ(OkStatus(), kvs_.Get("key", read).status());
+  EXPECT_EQ(0u, hits());
+  EXPECT_EQ(2u, misses());
+}
+
+TEST_F(KvsValueCache, Disabled_NoStats) {
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition_,
+                                                          kFormat);
+  ASSERT_EQ(OkStatus(), kvs.Init());
+
+  std::array<std::byte, 32> read;
+  ASSERT_EQ(OkStatus(), kvs.Put("key", Value('a')));
+  ASSERT_EQ(OkStatus(), kvs.Get("key", read).status());
+  ASSERT_EQ(OkStatus(), kvs.Get("key", read).status());
+
+  EXPECT_EQ(0u, kvs.GetStorageStats().value_cache_hits);
+  EXPECT_EQ(0u, kvs.GetStorageStats().value_cache_misses);
+}
+
+}  // namespace
+}  // namespace pw::kvs
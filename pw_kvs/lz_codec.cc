@@ -0,0 +1,180 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/internal/lz_codec.h"
+
+#include <algorithm>
+
+#include "pw_status/try.h"
+
+namespace pw::kvs::internal {
+
+void LzEncoder::Reset() {
+  hash_table_.fill(0);
+  position_ = 0;
+  end_ = 0;
+  group_[0] = std::byte(0);
+  group_size_ = 1;
+  item_count_ = 0;
+}
+
+Status LzEncoder::Write(ConstByteSpan data, stream::Writer& output) {
+  for (std::byte b : data) {
+    // Keep a full match of lookahead, so every match is as long as it can be.
+    if (end_ - position_ == kLzMaxMatchBytes) {
+      PW_TRY(EncodeNext(output));
+    }
+    buffer_[end_ % kBufferSizeBytes] = b;
+    end_ += 1;
+  }
+  return OkStatus();
+}
+
+Status LzEncoder::Finish(stream::Writer& output) {
+  while (position_ != end_) {
+    PW_TRY(EncodeNext(output));
+  }
+  if (item_count_ != 0) {
+    PW_TRY(FlushGroup(output));
+  }
+  return OkStatus();
+}
+
+size_t LzEncoder::Hash(uint32_t position) const {
+  const uint32_t bytes = static_cast<uint32_t>(At(position)) << 16 |
+                         static_cast<uint32_t>(At(position + 1)) << 8 |
+                         static_cast<uint32_t>(At(position + 2));
+  return (bytes * 2654435761u) >> 24;
+}
+
+Status LzEncoder::EncodeNext(stream::Writer& output) {
+  const size_t available = end_ - position_;
+  size_t length = 0;
+  uint32_t distance = 0;
+
+  // Only the most recent position with the same hash is checked, which keeps
+  // each byte's cost constant.
+  if (available >= kLzMinMatchBytes) {
+    const size_t hash = Hash(position_);
+    const uint32_t candidate = hash_table_[hash];
+    hash_table_[hash] = position_ + 1;
+
+    if (candidate != 0 && position_ - (candidate - 1) <= kLzWindowSizeBytes) {
+      distance = position_ - (candidate - 1);
+      const size_t max_length = std::min(available, kLzMaxMatchBytes);
+      while (length < max_length &&
+             At(position_ - distance + length) == At(position_ + length)) {
+        length += 1;
+      }
+    }
+  }
+
+  if (length < kLzMinMatchBytes) {
+    group_[group_size_++] = At(position_);
+    position_ += 1;
+  } else {
+    const uint32_t encoded_distance = distance - 1;
+    group_[0] |= std::byte(1 << item_count_);
+    group_[group_size_++] = std::byte(encoded_distance & 0xff);
+    group_[group_size_++] = std::byte((encoded_distance >> 8) << 6 |
+                                      (length - kLzMinMatchBytes));
+
+    // Index the positions inside the match, so later data can refer to them.
+    for (size_t i = 1; i < length; ++i) {
+      if (available - i >= kLzMinMatchBytes) {
+        hash_table_[Hash(position_ + i)] = position_ + i + 1;
+      }
+    }
+    position_ += length;
+  }
+
+  item_count_ += 1;
+  if (item_count_ == 8) {
+    return FlushGroup(output);
+  }
+  return OkStatus();
+}
+
+Status LzEncoder::FlushGroup(stream::Writer& output) {
+  const Status status = output.Write(std::span(group_).first(group_size_));
+  group_[0] = std::byte(0);
+  group_size_ = 1;
+  item_count_ = 0;
+  return status;
+}
+
+void LzDecoder::Reset() {
+  output_position_ = 0;
+  flags_ = 0;
+  flags_remaining_ = 0;
+  match_remaining_ = 0;
+  have_partial_match_ = false;
+}
+
+StatusWithSize LzDecoder::Decode(ConstByteSpan& input, ByteSpan output) {
+  size_t written = 0;
+
+  while (written < output.size()) {
+    if (match_remaining_ != 0) {
+      const uint32_t source = output_position_ - match_distance_;
+      Emit(window_[source % kLzWindowSizeBytes], output, written);
+      match_remaining_ -= 1;
+      continue;
+    }
+
+    if (input.empty()) {
+      break;
+    }
+    const uint8_t b = static_cast<uint8_t>(input[0]);
+    input = input.subspan(1);
+
+    if (have_partial_match_) {
+      have_partial_match_ = false;
+      match_distance_ =
+          (partial_match_ | static_cast<uint32_t>(b >> 6) << 8) + 1;
+      if (match_distance_ > output_position_) {
+        return StatusWithSize::DataLoss(written);
+      }
+      match_remaining_ = (b & 0x3f) + kLzMinMatchBytes;
+      continue;
+    }
+
+    if (flags_remaining_ == 0) {
+      flags_ = b;
+      flags_remaining_ = 8;
+      continue;
+    }
+
+    const bool is_match = (flags_ & 1) != 0;
+    flags_ >>= 1;
+    flags_remaining_ -= 1;
+
+    if (is_match) {
+      partial_match_ = b;
+      have_partial_match_ = true;
+    } else {
+      Emit(std::byte(b), output, written);
+    }
+  }
+
+  return StatusWithSize(written);
+}
+
+void LzDecoder::Emit(std::byte b, ByteSpan output, size_t& written) {
+  window_[output_position_ % kLzWindowSizeBytes] = b;
+  output[written++] = b;
+  output_position_ += 1;
+}
+
+}  // namespace pw::kvs::internal
@@ -0,0 +1,148 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/internal/lz_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_random/xor_shift.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::kvs::internal {
+namespace {
+
+constexpr size_t kDataSize = 4096;
+
+class LzCodecTest : public ::testing::Test {
+ protected:
+  LzCodecTest() : compressed_{}, compressed_writer_(compressed_) {}
+
+  // Compresses data in chunks of chunk_size bytes.
+  void Compress(ConstByteSpan data, size_t chunk_size = kDataSize) {
+    encoder_.Reset();
+    while (!data.empty()) {
+      const size_t size = std::min(data.size(), chunk_size);
+      ASSERT_EQ(OkStatus(),
+                encoder_.Write(data.first(size), compressed_writer_));
+      data = data.subspan(size);
+    }
+    ASSERT_EQ(OkStatus(), encoder_.Finish(compressed_writer_));
+  }
+
+  // Decompresses the compressed data, feeding the decoder input_chunk_size
+  // bytes at a time, and checks that it matches data.
+  void VerifyDecompress(ConstByteSpan data, size_t input_chunk_size) {
+    LzDecoder decoder;
+    std::array<std::byte, kDataSize> output{};
+    size_t output_size = 0;
+
+    ConstByteSpan compressed = compressed_writer_.WrittenData();
+    while (!compressed.empty()) {
+      ConstByteSpan input =
+          compressed.first(std::min(compressed.size(), input_chunk_size));
+      compressed = compressed.subspan(input.size());
+      // Decode into small pieces of output, so matches are split.
+      while (!input.empty()) {
+        ByteSpan piece = std::span(output).subspan(output_size);
+        piece = piece.first(std::min(piece.size(), size_t{7}));
+        StatusWithSize result = decoder.Decode(input, piece);
+        ASSERT_EQ(OkStatus(), result.status());
+        output_size += result.size();
+      }
+    }
+
+    // Finish any match at the end of the input.
+    StatusWithSize result = decoder.Decode(
+        compressed, std::span(output).subspan(output_size));
+    ASSERT_EQ(OkStatus(), result.status());
+    output_size += result.size();
+
+    ASSERT_EQ(output_size, data.size());
+    EXPECT_EQ(decoder.output_size(), data.size());
+    EXPECT_EQ(std::memcmp(output.data(), data.data(), data.size()), 0);
+  }
+
+  LzEncoder encoder_;
+  std::array<std::byte, kDataSize * 2> compressed_;
+  stream::MemoryWriter compressed_writer_;
+};
+
+TEST_F(LzCodecTest, RepeatedData_Shrinks) {
+  std::array<std::byte, kDataSize> data;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::byte(i % 37);
+  }
+
+  Compress(data);
+  EXPECT_LT(compressed_writer_.bytes_written(), data.size() / 10);
+  VerifyDecompress(data, 1);
+  VerifyDecompress(data, 100);
+}
+
+TEST_F(LzCodecTest, RandomData_GrowsByAtMostOneInEight) {
+  std::array<std::byte, kDataSize> data;
+  random::XorShiftStarRng64 rng(0x5eed);
+  rng.Get(data);
+
+  Compress(data, 13);
+  EXPECT_LE(compressed_writer_.bytes_written(), data.size() / 8 * 9);
+  VerifyDecompress(data, 5);
+}
+
+TEST_F(LzCodecTest, MixedData_RoundTrips) {
+  constexpr char kText[] =
+      "The quick brown fox jumps over the lazy dog. The lazy dog sleeps. ";
+  std::array<std::byte, kDataSize> data;
+  random::XorShiftStarRng64 rng(0x1234);
+  rng.Get(data);
+  for (size_t i = 0; i + sizeof(kText) < data.size(); i += 3 * sizeof(kText)) {
+    std::memcpy(&data[i], kText, sizeof(kText));
+  }
+
+  Compress(data, 1);
+  EXPECT_LT(compressed_writer_.bytes_written(), data.size());
+  VerifyDecompress(data, 3);
+}
+
+TEST_F(LzCodecTest, ShortData_RoundTrips) {
+  constexpr std::array<std::byte, 2> kData = {std::byte(1), std::byte(2)};
+
+  Compress(kData);
+  EXPECT_EQ(compressed_writer_.bytes_written(), 3u);
+  VerifyDecompress(kData, 1);
+}
+
+TEST_F(LzCodecTest, Empty_HasNoCompressedData) {
+  Compress(ConstByteSpan());
+  EXPECT_EQ(compressed_writer_.bytes_written(), 0u);
+}
+
+TEST_F(LzCodecTest, MatchBeforeStart_DataLoss) {
+  // A match with a distance of 1 as the first item.
+  constexpr std::array<std::byte, 3> kCompressed = {
+      std::byte(0x01), std::byte(0x00), std::byte(0x00)};
+  std::array<std::byte, 16> output;
+
+  LzDecoder decoder;
+  ConstByteSpan input = kCompressed;
+  EXPECT_EQ(Status::DataLoss(), decoder.Decode(input, output).status());
+}
+
+}  // namespace
+}  // namespace pw::kvs::internal
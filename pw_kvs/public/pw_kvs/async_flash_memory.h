@@ -0,0 +1,286 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <utility>
+
+#include "pw_function/function.h"
+#include "pw_kvs/alignment.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_status/try.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/thread_notification.h"
+
+namespace pw {
+namespace kvs {
+
+// Flash memory whose operations run in the background, such as QSPI flash
+// driven by DMA. Drivers implement the Start functions, which begin an
+// operation and return without waiting for it to finish.
+//
+// An AsyncFlashMemory is also a FlashMemory. The blocking Erase, Read, and
+// Write start an operation and then block the calling thread on a
+// ThreadNotification until it completes, so other threads run while the flash
+// is busy instead of the CPU spinning. This lets FlashPartition, the KVS, and
+// BlobStore use asynchronous flash without changes.
+class AsyncFlashMemory : public FlashMemory {
+ public:
+  using FlashMemory::FlashMemory;
+
+  // Called once when an operation finishes, with the operation's status and
+  // the number of bytes read or written. May be called from an interrupt.
+  using Callback = Function<void(StatusWithSize)>;
+
+  // Each Start function returns OK if the operation was started, in which case
+  // the callback is called when it completes. The callback may be called before
+  // the Start function returns. If the operation could not be started, the
+  // callback is not called and an error is returned:
+  //
+  // UNAVAILABLE - another operation is in progress
+  // INVALID_ARGUMENT - address or size is not aligned
+  // OUT_OF_RANGE - the operation does not fit in the memory
+  //
+  // Only one operation may be in progress at a time, except that memories with
+  // several banks (see sectors_per_bank()) may run one operation in each bank
+  // at the same time. The memory referred to by a read or write must remain
+  // valid until the callback is called.
+  virtual Status StartErase(Address flash_address,
+                            size_t num_sectors,
+                            Callback&& callback) = 0;
+
+  virtual Status StartRead(Address address,
+                           std::span<std::byte> output,
+                           Callback&& callback) = 0;
+
+  virtual Status StartWrite(Address destination_flash_address,
+                            std::span<const std::byte> data,
+                            Callback&& callback) = 0;
+
+  // Blocking operations. Only one thread may use these at a time.
+  Status Erase(Address flash_address, size_t num_sectors) final {
+    return Wait(StartErase(flash_address, num_sectors, NotifyWhenDone()))
+        .status();
+  }
+
+  using FlashMemory::Read;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) final {
+    return Wait(StartRead(address, output, NotifyWhenDone()));
+  }
+
+  using FlashMemory::Write;
+
+  StatusWithSize Write(Address destination_flash_address,
+                       std::span<const std::byte> data) final {
+    return Wait(StartWrite(destination_flash_address, data, NotifyWhenDone()));
+  }
+
+ private:
+  Callback NotifyWhenDone() {
+    return [this](StatusWithSize result) {
+      result_ = result;
+      done_.release();
+    };
+  }
+
+  StatusWithSize Wait(Status start_status) {
+    if (!start_status.ok()) {
+      return StatusWithSize(start_status, 0);
+    }
+    done_.acquire();
+    return result_;
+  }
+
+  sync::ThreadNotification done_;
+  StatusWithSize result_;
+};
+
+// A FlashPartition on an AsyncFlashMemory. In addition to the blocking
+// FlashPartition API, it can start operations that complete in the background.
+// The Start functions check arguments like the blocking versions, but return
+// INVALID_ARGUMENT for misaligned addresses or sizes instead of crashing.
+//
+// If the memory has several banks, WriteCopies writes copies that are in
+// different banks at the same time, so writing redundant KVS entries takes
+// about as long as writing one.
+class AsyncFlashPartition : public FlashPartition {
+ public:
+  using Callback = AsyncFlashMemory::Callback;
+
+  // WriteCopies writes up to kMaxParallelCopies copies at once and gathers the
+  // data through a buffer of kWriteCopiesBufferSize bytes. Copies are written
+  // one after another if there are more copies or the alignment is larger.
+  static constexpr size_t kMaxParallelCopies = 4;
+  static constexpr size_t kWriteCopiesBufferSize = 256;
+
+  AsyncFlashPartition(
+      AsyncFlashMemory* flash,
+      uint32_t start_sector_index,
+      uint32_t sector_count,
+      uint32_t alignment_bytes = 0,  // Defaults to flash alignment
+      PartitionPermission permission = PartitionPermission::kReadAndWrite)
+      : FlashPartition(flash,
+                       start_sector_index,
+                       sector_count,
+                       alignment_bytes,
+                       permission),
+        async_flash_(*flash) {}
+
+  // Creates an AsyncFlashPartition that uses the entire flash.
+  AsyncFlashPartition(AsyncFlashMemory* flash)
+      : AsyncFlashPartition(
+            flash, 0, flash->sector_count(), flash->alignment_bytes()) {}
+
+  Status StartErase(Address address, size_t num_sectors, Callback&& callback) {
+    if (!writable()) {
+      return Status::PermissionDenied();
+    }
+    PW_TRY(CheckBounds(address, num_sectors * sector_size_bytes()));
+    if (address % sector_size_bytes() != 0u) {
+      return Status::InvalidArgument();
+    }
+    return async_flash_.StartErase(
+        PartitionToFlashAddress(address), num_sectors, std::move(callback));
+  }
+
+  Status StartRead(Address address,
+                   std::span<std::byte> output,
+                   Callback&& callback) {
+    PW_TRY(CheckBounds(address, output.size()));
+    return async_flash_.StartRead(
+        PartitionToFlashAddress(address), output, std::move(callback));
+  }
+
+  Status StartWrite(Address address,
+                    std::span<const std::byte> data,
+                    Callback&& callback) {
+    if (!writable()) {
+      return Status::PermissionDenied();
+    }
+    PW_TRY(CheckBounds(address, data.size()));
+    if (address % alignment_bytes() != 0u ||
+        data.size() % alignment_bytes() != 0u) {
+      return Status::InvalidArgument();
+    }
+    return async_flash_.StartWrite(
+        PartitionToFlashAddress(address), data, std::move(callback));
+  }
+
+  void WriteCopies(std::span<const Address> addresses,
+                   std::span<const ConstByteSpan> data,
+                   std::span<StatusWithSize> results) override {
+    if (addresses.size() > kMaxParallelCopies || !InDifferentBanks(addresses) ||
+        alignment_bytes() > kWriteCopiesBufferSize) {
+      FlashPartition::WriteCopies(addresses, data, results);
+      return;
+    }
+
+    std::fill(results.begin(), results.end(), StatusWithSize());
+    CopiesOutput output(*this, addresses, results);
+    const StatusWithSize result = AlignedWrite<kWriteCopiesBufferSize>(
+        output, alignment_bytes(), data);
+
+    for (StatusWithSize& copy_result : results) {
+      if (copy_result.ok()) {
+        copy_result = result;
+      }
+    }
+  }
+
+ private:
+  // Starts a write of each block of data to every copy that has not failed,
+  // then waits for them all to finish.
+  class CopiesOutput final : public pw::Output {
+   public:
+    CopiesOutput(AsyncFlashPartition& partition,
+                 std::span<const Address> addresses,
+                 std::span<StatusWithSize> results)
+        : partition_(partition), addresses_(addresses), offset_(0) {
+      for (size_t i = 0; i < addresses.size(); ++i) {
+        copies_[i] = Copy{.output = this, .result = &results[i]};
+      }
+    }
+
+   private:
+    // Each write's callback refers to its copy with a single pointer, so that
+    // it fits in a pw::Function without allocating.
+    struct Copy {
+      CopiesOutput* output;
+      StatusWithSize* result;
+    };
+
+    StatusWithSize DoWrite(std::span<const std::byte> data) override {
+      size_t started = 0;
+      for (size_t i = 0; i < addresses_.size(); ++i) {
+        Copy* copy = &copies_[i];
+        if (!copy->result->ok()) {
+          continue;
+        }
+        const Status status = partition_.StartWrite(
+            addresses_[i] + offset_, data, [copy](StatusWithSize result) {
+              if (!result.ok()) {
+                *copy->result = StatusWithSize(
+                    result.status(), copy->output->offset_ + result.size());
+              }
+              copy->output->done_.release();
+            });
+        if (status.ok()) {
+          started += 1;
+        } else {
+          *copy->result = StatusWithSize(status, offset_);
+        }
+      }
+
+      for (; started > 0u; --started) {
+        done_.acquire();
+      }
+      offset_ += data.size();
+
+      // Keep going as long as any copy is still being written.
+      for (size_t i = 0; i < addresses_.size(); ++i) {
+        if (copies_[i].result->ok()) {
+          return StatusWithSize(data.size());
+        }
+      }
+      return StatusWithSize(copies_[0].result->status(), 0);
+    }
+
+    AsyncFlashPartition& partition_;
+    std::span<const Address> addresses_;
+    Copy copies_[kMaxParallelCopies];
+    size_t offset_;
+    sync::CountingSemaphore done_;
+  };
+
+  bool InDifferentBanks(std::span<const Address> addresses) const {
+    for (size_t i = 0; i < addresses.size(); ++i) {
+      for (size_t j = 0; j < i; ++j) {
+        if (bank(addresses[i]) == bank(addresses[j])) {
+          return false;
+        }
+      }
+    }
+    return addresses.size() > 1u;
+  }
+
+  AsyncFlashMemory& async_flash_;
+};
+
+}  // namespace kvs
+}  // namespace pw
@@ -0,0 +1,83 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "pw_bytes/span.h"
+#include "pw_kvs/format.h"
+#include "pw_kvs/internal/lz_codec.h"
+#include "pw_result/result.h"
+
+namespace pw {
+namespace kvs {
+namespace internal {
+
+class Entry;
+
+}  // namespace internal
+
+// Compresses the values of entries written with an EntryFormat that refers to
+// it, and decompresses them when they are read. Values are compressed with the
+// LZ codec in pw_kvs/internal/lz_codec.h, which has a 1 KiB window.
+//
+// Like a ChecksumAlgorithm, a ValueCompressor holds state that is used while
+// reading or writing an entry, so it must not be shared by KVS instances that
+// are used from different threads.
+class ValueCompressor {
+ public:
+  // Encodes a value for storage: a CompressedValueHeader, followed by the value
+  // compressed or, if compression would not make it smaller, as is. The
+  // returned span refers to this object's buffer and is valid until the next
+  // call to Encode. Returns RESOURCE_EXHAUSTED if the value is larger than the
+  // buffer allows.
+  Result<ConstByteSpan> Encode(ConstByteSpan value);
+
+  // The largest value that can be encoded.
+  size_t max_value_size_bytes() const {
+    return buffer_.size() - sizeof(internal::CompressedValueHeader);
+  }
+
+ protected:
+  explicit constexpr ValueCompressor(ByteSpan buffer)
+      : encoder_(), decoder_(), buffer_(buffer) {}
+
+  // Protected destructor prevents deleting ValueCompressors from the base
+  // class, so that it is safe to have a non-virtual destructor.
+  ~ValueCompressor() = default;
+
+ private:
+  friend class internal::Entry;
+
+  internal::LzEncoder encoder_;
+  internal::LzDecoder decoder_;
+  ByteSpan buffer_;
+};
+
+// A ValueCompressor with a buffer for values of up to kMaxValueBytes. Uses
+// about 3 KiB for the encoder and 1 KiB for the decoder, plus the buffer.
+template <size_t kMaxValueBytes>
+class ValueCompressorBuffer final : public ValueCompressor {
+ public:
+  constexpr ValueCompressorBuffer() : ValueCompressor(buffer_), buffer_{} {}
+
+ private:
+  std::array<std::byte,
+             sizeof(internal::CompressedValueHeader) + kMaxValueBytes>
+      buffer_;
+};
+
+}  // namespace kvs
+}  // namespace pw
@@ -109,6 +109,8 @@ class FakeFlashMemory : public FlashMemory {
   // Reads bytes from flash into buffer.
   StatusWithSize Read(Address address, std::span<std::byte> output) override;
 
+  using FlashMemory::Write;
+
   // Writes bytes to flash.
   StatusWithSize Write(Address address,
                        std::span<const std::byte> data) override;
@@ -0,0 +1,162 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "pw_containers/intrusive_list.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace pw {
+namespace kvs {
+
+// Schedules the background maintenance, garbage collection and erases, of the
+// stores that share one flash device, such as several KVSs and BlobStores on
+// one external SPI flash. Without coordination, each store garbage collects and
+// erases on its own, and a long erase for one store can hold up a foreground
+// read or write of another.
+//
+// Each store registers a Client that keeps a target number of bytes free ahead
+// of the store's writes. RunStep() runs one bounded step of maintenance, a
+// garbage collection step or a sector erase, for the client furthest below its
+// target. Call it periodically from a low-priority thread:
+//
+//   while (true) {
+//     if (!scheduler.RunStep().ok()) {
+//       pw::this_thread::sleep_for(kIdleInterval);
+//     }
+//   }
+//
+// Foreground operations on every store on the device are done while holding a
+// ForegroundOperation, which serializes them with the maintenance steps so that
+// they never collide on the bus. Foreground operations take priority: RunStep()
+// does not start a step while one is in progress or waiting, so a foreground
+// operation waits for at most one step.
+class FlashMaintenanceScheduler {
+ public:
+  // A store whose maintenance is run by the scheduler.
+  class Client : public IntrusiveList<Client>::Item {
+   public:
+    Client(const Client&) = delete;
+    Client& operator=(const Client&) = delete;
+
+    size_t target_free_bytes() const { return target_free_bytes_; }
+
+   protected:
+    explicit constexpr Client(size_t target_free_bytes)
+        : target_free_bytes_(target_free_bytes), idle_(false) {}
+
+    virtual ~Client() = default;
+
+   private:
+    friend class FlashMaintenanceScheduler;
+
+    // Returns the number of bytes the store can write without maintenance.
+    virtual size_t FreeBytes() = 0;
+
+    // Performs one bounded step of maintenance. Returns NOT_FOUND if there is
+    // nothing to do.
+    virtual Status DoMaintenanceStep() = 0;
+
+    const size_t target_free_bytes_;
+
+    // Set when the last step had nothing to do or failed, so that the client
+    // is not retried until a foreground operation changes the store.
+    bool idle_;
+  };
+
+  // Holds the flash device for a foreground operation. Create one around each
+  // read, write, or other operation on a store that shares the device:
+  //
+  //   {
+  //     FlashMaintenanceScheduler::ForegroundOperation op(scheduler);
+  //     kvs.Put("key", value);
+  //   }
+  //
+  class PW_SCOPED_LOCKABLE ForegroundOperation {
+   public:
+    explicit ForegroundOperation(FlashMaintenanceScheduler& scheduler)
+        PW_EXCLUSIVE_LOCK_FUNCTION(scheduler.lock_) PW_NO_LOCK_SAFETY_ANALYSIS;
+
+    ~ForegroundOperation() PW_UNLOCK_FUNCTION() PW_NO_LOCK_SAFETY_ANALYSIS;
+
+    ForegroundOperation(const ForegroundOperation&) = delete;
+    ForegroundOperation& operator=(const ForegroundOperation&) = delete;
+
+   private:
+    FlashMaintenanceScheduler& scheduler_;
+  };
+
+  FlashMaintenanceScheduler() : foreground_waiting_(0) {}
+
+  FlashMaintenanceScheduler(const FlashMaintenanceScheduler&) = delete;
+  FlashMaintenanceScheduler& operator=(const FlashMaintenanceScheduler&) =
+      delete;
+
+  // Adds a client. A client may only be registered with one scheduler.
+  void Register(Client& client) PW_LOCKS_EXCLUDED(lock_);
+
+  void Unregister(Client& client) PW_LOCKS_EXCLUDED(lock_);
+
+  // Runs one maintenance step for the client with the most bytes missing from
+  // its target. Returns:
+  //
+  // OK - a step was run; call again to continue.
+  // NOT_FOUND - every client has its target free bytes, or has nothing to do.
+  // UNAVAILABLE - a foreground operation is in progress or waiting.
+  //
+  // Errors from the step are also returned.
+  Status RunStep() PW_LOCKS_EXCLUDED(lock_);
+
+ private:
+  Status RunStepLocked() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  sync::Mutex lock_;
+
+  // Foreground operations waiting for the lock. Maintenance steps are not
+  // started while this is nonzero.
+  std::atomic<size_t> foreground_waiting_;
+
+  IntrusiveList<Client> clients_ PW_GUARDED_BY(lock_);
+};
+
+// Runs KeyValueStore::MaintenanceStep while the KVS has fewer writable bytes
+// than the target. max_bytes_relocated bounds the work done in each step.
+class KeyValueStoreMaintenanceClient final
+    : public FlashMaintenanceScheduler::Client {
+ public:
+  KeyValueStoreMaintenanceClient(KeyValueStore& kvs,
+                                 size_t target_free_bytes,
+                                 size_t max_bytes_relocated)
+      : Client(target_free_bytes),
+        kvs_(kvs),
+        max_bytes_relocated_(max_bytes_relocated) {}
+
+ private:
+  size_t FreeBytes() override { return kvs_.GetStorageStats().writable_bytes; }
+
+  Status DoMaintenanceStep() override {
+    return kvs_.MaintenanceStep(max_bytes_relocated_).status();
+  }
+
+  KeyValueStore& kvs_;
+  const size_t max_bytes_relocated_;
+};
+
+}  // namespace kvs
+}  // namespace pw
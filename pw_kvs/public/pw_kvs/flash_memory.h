@@ -19,6 +19,7 @@
 #include <span>
 
 #include "pw_assert/assert.h"
+#include "pw_bytes/span.h"
 #include "pw_kvs/alignment.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
@@ -100,6 +101,17 @@ class FlashMemory {
         std::span<const std::byte>(static_cast<const std::byte*>(data), len));
   }
 
+  // Writes several buffers to consecutive addresses, as if they were a single
+  // buffer. The address and the total size must be aligned, but the individual
+  // buffers need not be. Returns the same as Write.
+  //
+  // By default, the buffers are copied through a small aligned buffer and
+  // written in several writes. Drivers that can program from several buffers
+  // at once, such as with scatter-gather DMA, may override this to program the
+  // data in a single operation.
+  virtual StatusWithSize Write(Address destination_flash_address,
+                               std::span<const ConstByteSpan> data);
+
   // Convert an Address to an MCU pointer, this can be used for memory
   // mapped reads. Return NULL if the memory is not memory mapped.
   virtual std::byte* FlashAddressToMcuAddress(Address) const { return nullptr; }
@@ -113,6 +125,12 @@ class FlashMemory {
 
   constexpr size_t sector_count() const { return flash_sector_count_; }
 
+  // Flash may be made of banks that can be programmed at the same time, such as
+  // the two banks of a dual-bank MCU or an internal and an external flash.
+  // Banks are consecutive runs of sectors_per_bank() sectors. By default, the
+  // whole memory is a single bank.
+  virtual size_t sectors_per_bank() const { return sector_count(); }
+
   constexpr size_t alignment_bytes() const { return alignment_; }
 
   constexpr size_t size_bytes() const {
@@ -223,6 +241,41 @@ class FlashPartition {
   virtual StatusWithSize Write(Address address,
                                std::span<const std::byte> data);
 
+  // Writes several buffers to consecutive addresses, as if they were a single
+  // buffer. The address and the total size must be multiples of
+  // alignment_bytes(), but the individual buffers need not be. Returns the same
+  // as Write.
+  //
+  // If a write combining buffer is set, the data is gathered into it and
+  // written in writes that each fill a page. Otherwise, the buffers are passed
+  // to the FlashMemory's scatter-gather Write.
+  virtual StatusWithSize Write(Address address,
+                               std::span<const ConstByteSpan> data);
+
+  StatusWithSize Write(Address address,
+                       std::initializer_list<ConstByteSpan> data) {
+    return Write(address, std::span(data.begin(), data.size()));
+  }
+
+  // Writes the same data to each address and stores each write's result in the
+  // corresponding element of results, which must be as large as addresses.
+  // Each result is the same as Write would return. By default, the copies are
+  // written one after another. Partitions on flash with independent banks may
+  // override this to write copies in different banks at the same time.
+  virtual void WriteCopies(std::span<const Address> addresses,
+                           std::span<const ConstByteSpan> data,
+                           std::span<StatusWithSize> results);
+
+  // Sets a buffer for combining scatter-gather writes into whole pages, which
+  // is worthwhile for flash with a high cost per program operation. The
+  // buffer's size is the page size; it must be a multiple of alignment_bytes().
+  // Writes are split at page boundaries, so each write fills at most one page.
+  // An empty buffer disables write combining.
+  void set_write_combining_buffer(std::span<std::byte> buffer) {
+    PW_ASSERT(buffer.size() % alignment_bytes() == 0u);
+    write_combining_buffer_ = buffer;
+  }
+
   // Check to see if chunk of flash partition is erased. Address and len need to
   // be aligned with FlashMemory. Returns:
   //
@@ -260,6 +313,13 @@ class FlashPartition {
 
   size_t sector_count() const { return sector_count_; }
 
+  // Returns the index of the flash bank that contains the address. See
+  // FlashMemory::sectors_per_bank().
+  size_t bank(Address address) const {
+    return (PartitionToFlashAddress(address) - flash_.start_address()) /
+           flash_.sector_size_bytes() / flash_.sectors_per_bank();
+  }
+
   // Convert a FlashMemory::Address to an MCU pointer, this can be used for
   // memory mapped reads. Return NULL if the memory is not memory mapped.
   std::byte* PartitionAddressToMcuAddress(Address address) const {
@@ -296,6 +356,7 @@ class FlashPartition {
   const uint32_t sector_count_;
   const uint32_t alignment_bytes_;
   const PartitionPermission permission_;
+  std::span<std::byte> write_combining_buffer_;
 };
 
 }  // namespace kvs
@@ -14,6 +14,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <numeric>
 
 #include "pw_containers/vector.h"
@@ -28,8 +30,24 @@
 
 namespace pw::kvs {
 
+// A FlashPartition that records statistics about its use: erase counts for
+// each sector, and the number of calls, bytes, and latencies of reads, writes,
+// and erases. Latencies are measured with pw_chrono's SystemClock. Nothing is
+// recorded unless PW_KVS_RECORD_PARTITION_STATS is enabled.
 class FlashPartitionWithStats : public FlashPartition {
  public:
+  // Latencies are counted in power-of-two buckets of microseconds. Bucket 0
+  // counts operations that took under 1 us, bucket i operations that took
+  // [2^(i-1), 2^i) us, and the last bucket all longer operations.
+  static constexpr size_t kLatencyBuckets = 16;
+
+  struct OperationStats {
+    size_t calls;
+    size_t bytes;
+    uint32_t max_latency_us;
+    std::array<size_t, kLatencyBuckets> latency_histogram;
+  };
+
   // Save flash partition and KVS storage stats. Does not save if
   // sector_counters_ is zero.
   Status SaveStorageStats(const KeyValueStore& kvs, const char* label);
@@ -38,6 +56,24 @@ class FlashPartitionWithStats : public FlashPartition {
 
   Status Erase(Address address, size_t num_sectors) override;
 
+  using FlashPartition::Read;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override;
+
+  using FlashPartition::Write;
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override;
+
+  StatusWithSize Write(Address address,
+                       std::span<const ConstByteSpan> data) override;
+
+  const OperationStats& read_stats() const { return read_stats_; }
+  const OperationStats& write_stats() const { return write_stats_; }
+
+  // Bytes are counted as the number of bytes in the erased sectors.
+  const OperationStats& erase_stats() const { return erase_stats_; }
+
   std::span<size_t> sector_erase_counters() {
     return std::span(sector_counters_.data(), sector_counters_.size());
   }
@@ -66,7 +102,12 @@ class FlashPartitionWithStats : public FlashPartition {
     return std::accumulate(sector_counters_.begin(), sector_counters_.end(), 0);
   }
 
-  void ResetCounters() { sector_counters_.assign(sector_count(), 0); }
+  void ResetCounters() {
+    sector_counters_.assign(sector_count(), 0);
+    read_stats_ = {};
+    write_stats_ = {};
+    erase_stats_ = {};
+  }
 
  protected:
   FlashPartitionWithStats(
@@ -81,12 +122,21 @@ class FlashPartitionWithStats : public FlashPartition {
                        sector_count,
                        alignment_bytes,
                        permission),
-        sector_counters_(sector_counters) {
+        sector_counters_(sector_counters),
+        read_stats_{},
+        write_stats_{},
+        erase_stats_{} {
     sector_counters_.assign(FlashPartition::sector_count(), 0);
   }
 
  private:
+  // Stats are recorded if the buffer for erase counters has room.
+  bool recording() const { return sector_counters_.max_size() != 0u; }
+
   Vector<size_t>& sector_counters_;
+  OperationStats read_stats_;
+  OperationStats write_stats_;
+  OperationStats erase_stats_;
 };
 
 template <size_t kMaxSectors>
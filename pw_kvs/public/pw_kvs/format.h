@@ -22,6 +22,7 @@ namespace pw {
 namespace kvs {
 
 struct EntryFormat;
+class ValueCompressor;
 
 namespace internal {
 
@@ -43,7 +44,15 @@ struct EntryHeader {
 
   // The length of the key in bytes. The key is not null terminated.
   //  6 bits, 0:5 - key length - maximum 64 characters
-  //  2 bits, 6:7 - reserved
+  //  1 bit,    6 - batch pending - this entry is part of a batch and is only
+  //                valid if the batch's final entry, which has the same
+  //                transaction ID, directly follows the batch's entries
+  //  1 bit,    7 - sector record - this record describes its sector instead
+  //                of storing a key and value; the key length bits are 0. If
+  //                bit 6 is 0, the record is a sector summary that lists the
+  //                entries in the sector (see SectorSummaryItem). If bit 6 is
+  //                1, the record is the sector's first record, and its value
+  //                is the uint32_t number of times the sector was erased.
   uint8_t key_length_bytes;
 
   // Byte length of the value; maximum of 65534. The max uint16_t value (65535
@@ -56,6 +65,44 @@ struct EntryHeader {
 
 static_assert(sizeof(EntryHeader) == 16, "EntryHeader must not have padding");
 
+// Disk format of an item in a sector summary record. A sector summary is
+// written after the last entry in a sector, once the sector is full. The
+// summary lists the sector's entries, so the entries do not have to be read
+// when initializing the KVS.
+struct SectorSummaryItem {
+  // The hash of the entry's key.
+  uint32_t key_hash;
+
+  // The entry's transaction ID.
+  uint32_t transaction_id;
+
+  // Byte offset of the entry from the start of the sector.
+  uint16_t offset;
+
+  // Whether the entry is valid (0) or a tombstone (1).
+  uint8_t state;
+
+  uint8_t reserved;
+};
+
+static_assert(sizeof(SectorSummaryItem) == 12,
+              "SectorSummaryItem must not have padding");
+
+// Disk format of the start of the value of an entry written with an EntryFormat
+// that has a compressor. The header is followed by the stored value.
+struct CompressedValueHeader {
+  // Byte length of the value before it was compressed.
+  uint16_t value_size;
+
+  // How the value is stored: as is (0) or compressed with the LZ codec (1).
+  uint8_t method;
+
+  uint8_t reserved;
+};
+
+static_assert(sizeof(CompressedValueHeader) == 4,
+              "CompressedValueHeader must not have padding");
+
 // This class wraps EntryFormat instances to support having multiple
 // simultaneously supported formats.
 class EntryFormats {
@@ -103,6 +150,11 @@ struct EntryFormat {
   // The checksum algorithm is used to calculate checksums for KVS entries. If
   // it is null, no checksum is used.
   ChecksumAlgorithm* checksum;
+
+  // The compressor is used to compress the values of KVS entries. If it is
+  // null, values are stored as is. The magic must differ from that of formats
+  // with no compressor, since it is what tells readers a value is compressed.
+  ValueCompressor* compression = nullptr;
 };
 
 }  // namespace kvs
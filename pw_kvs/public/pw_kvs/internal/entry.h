@@ -55,21 +55,46 @@ class Entry {
                      const internal::EntryFormats& formats,
                      Entry* entry);
 
+  // Initializes an Entry from a copy of a key-value entry held in memory, such
+  // as one read with KeyValueStore::Item::ReadRawEntry, and verifies its
+  // checksum. The key and value are set to point into the buffer. The entry's
+  // address is 0; its size, including padding, is entry->size().
+  //
+  //                 OK: the buffer starts with a valid key-value entry
+  //          DATA_LOSS: the entry is truncated, is not a key-value entry, or
+  //                     has an invalid checksum
+  //   INVALID_ARGUMENT: the entry's magic does not match any of the formats
+  //
+  static Status FromBuffer(FlashPartition& partition,
+                           std::span<const std::byte> buffer,
+                           const internal::EntryFormats& formats,
+                           Entry* entry,
+                           Key* key,
+                           std::span<const std::byte>* value);
+
   // Reads a key into a buffer, which must be at least key_length bytes.
   static Status ReadKey(FlashPartition& partition,
                         Address address,
                         size_t key_length,
                         char* key);
 
-  // Creates a new Entry for a valid (non-deleted) entry.
+  // Creates a new Entry for a valid (non-deleted) entry. If batch_pending is
+  // true, the entry is only valid once the rest of its batch is written.
   static Entry Valid(FlashPartition& partition,
                      Address address,
                      const EntryFormat& format,
                      Key key,
                      std::span<const std::byte> value,
-                     uint32_t transaction_id) {
-    return Entry(
-        partition, address, format, key, value, value.size(), transaction_id);
+                     uint32_t transaction_id,
+                     bool batch_pending = false) {
+    return Entry(partition,
+                 address,
+                 format,
+                 key,
+                 value,
+                 value.size(),
+                 transaction_id,
+                 batch_pending);
   }
 
   // Creates a new Entry for a tombstone entry, which marks a deleted key.
@@ -77,16 +102,69 @@ class Entry {
                          Address address,
                          const EntryFormat& format,
                          Key key,
-                         uint32_t transaction_id) {
+                         uint32_t transaction_id,
+                         bool batch_pending = false) {
     return Entry(partition,
                  address,
                  format,
                  key,
                  {},
                  kDeletedValueLength,
-                 transaction_id);
+                 transaction_id,
+                 batch_pending);
+  }
+
+  // Creates a new Entry for a sector summary record with item_count items.
+  // Summary records are written with WriteSectorSummary.
+  static Entry SectorSummary(FlashPartition& partition,
+                             Address address,
+                             const EntryFormat& format,
+                             size_t item_count,
+                             uint32_t transaction_id) {
+    return Entry(&partition,
+                 address,
+                 format,
+                 {.magic = format.magic,
+                  .checksum = 0,
+                  .alignment_units =
+                      alignment_bytes_to_units(partition.alignment_bytes()),
+                  .key_length_bytes = kSectorSummaryFlag,
+                  .value_size_bytes = static_cast<uint16_t>(
+                      item_count * sizeof(SectorSummaryItem)),
+                  .transaction_id = transaction_id});
   }
 
+  // Creates a new Entry for an erase count record, which stores the number of
+  // times its sector was erased. The record is written with WriteEraseCount.
+  static Entry EraseCount(FlashPartition& partition,
+                          Address address,
+                          const EntryFormat& format,
+                          uint32_t transaction_id) {
+    return Entry(&partition,
+                 address,
+                 format,
+                 {.magic = format.magic,
+                  .checksum = 0,
+                  .alignment_units =
+                      alignment_bytes_to_units(partition.alignment_bytes()),
+                  .key_length_bytes = kEraseCountFlags,
+                  .value_size_bytes = sizeof(uint32_t),
+                  .transaction_id = transaction_id});
+  }
+
+  // Provides the items of a sector summary record to WriteSectorSummary.
+  class SummaryItems {
+   public:
+    // Restarts iteration from the first item.
+    virtual void Reset() = 0;
+
+    // Sets item to the next item. Returns false if there are no more items.
+    virtual bool Next(SectorSummaryItem& item) = 0;
+
+   protected:
+    ~SummaryItems() = default;
+  };
+
   Entry() = default;
 
   KeyDescriptor descriptor(Key key) const { return descriptor(Hash(key)); }
@@ -99,11 +177,32 @@ class Entry {
 
   StatusWithSize Write(Key key, std::span<const std::byte> value) const;
 
+  // Writes this entry at each of the addresses, ignoring the entry's address,
+  // and stores each write's result in results. Copies in different flash banks
+  // may be written at the same time.
+  void WriteCopies(Key key,
+                   std::span<const std::byte> value,
+                   std::span<const Address> addresses,
+                   std::span<StatusWithSize> results) const;
+
+  // Writes a sector summary record. The items are read twice: once to
+  // calculate the checksum, then to write them. items must provide exactly
+  // summary_item_count() items.
+  StatusWithSize WriteSectorSummary(SummaryItems& items);
+
+  // Writes an erase count record. The erase count is read with ReadValue.
+  StatusWithSize WriteEraseCount(uint32_t erase_count);
+
   // Changes the format and transcation ID for this entry. In order to calculate
   // the new checksum, the entire entry is read into a small stack-allocated
   // buffer. The updated entry may be written to flash using the Copy function.
   Status Update(const EntryFormat& new_format, uint32_t new_transaction_id);
 
+  // Clears the batch pending flag and recalculates the checksum. Entries that
+  // are copied out of their batch must not be marked as pending, since they are
+  // no longer followed by the batch's final entry.
+  Status ClearBatchPending();
+
   // Writes this entry at a new address. The key and value are read from the
   // entry's current address. The Entry object's header, which may be newer than
   // what is in flash, is used.
@@ -119,9 +218,18 @@ class Entry {
         ReadKey(partition(), address_, key_length(), key.data()), key_length());
   }
 
+  // Reads the value as it is stored in flash.
   StatusWithSize ReadValue(std::span<std::byte> buffer,
                            size_t offset_bytes = 0) const;
 
+  // Reads the value, decompressing it if this entry's format has a compressor.
+  // offset_bytes is an offset into the decompressed value.
+  StatusWithSize ReadDecompressedValue(std::span<std::byte> buffer,
+                                       size_t offset_bytes = 0) const;
+
+  // The size of the value once it is decompressed.
+  StatusWithSize DecompressedValueSize() const;
+
   Status ValueMatches(std::span<const std::byte> value) const;
 
   Status VerifyChecksum(Key key, std::span<const std::byte> value) const;
@@ -136,6 +244,19 @@ class Entry {
                    std::max(partition.alignment_bytes(), kMinAlignmentBytes));
   }
 
+  // Calculates the total size of an erase count record, including padding.
+  static size_t erase_count_size(const FlashPartition& partition) {
+    return AlignUp(sizeof(EntryHeader) + sizeof(uint32_t),
+                   std::max(partition.alignment_bytes(), kMinAlignmentBytes));
+  }
+
+  // Calculates the total size of a sector summary record, including padding.
+  static size_t sector_summary_size(const FlashPartition& partition,
+                                    size_t item_count) {
+    return AlignUp(sizeof(EntryHeader) + item_count * sizeof(SectorSummaryItem),
+                   std::max(partition.alignment_bytes(), kMinAlignmentBytes));
+  }
+
   // Byte size of overhead (not-key, not-value) in an entry. Does not include
   // any paddding used to get proper size alignment.
   static constexpr size_t entry_overhead() { return sizeof(EntryHeader); }
@@ -144,6 +265,11 @@ class Entry {
 
   void set_address(Address address) { address_ = address; }
 
+  // The address of the entry's value, which directly follows the key.
+  Address value_address() const {
+    return address() + sizeof(EntryHeader) + key_length();
+  }
+
   // The address at which the next possible entry could be located.
   Address next_address() const { return address() + size(); }
 
@@ -151,7 +277,9 @@ class Entry {
   size_t size() const { return AlignUp(content_size(), alignment_bytes()); }
 
   // The length of the key in bytes. Keys are not null terminated.
-  size_t key_length() const { return header_.key_length_bytes; }
+  size_t key_length() const {
+    return header_.key_length_bytes & kKeyLengthMask;
+  }
 
   // The size of the value, without padding. The size is 0 if this is a
   // tombstone entry.
@@ -163,23 +291,53 @@ class Entry {
 
   uint32_t transaction_id() const { return header_.transaction_id; }
 
+  // True if this entry's value is stored with a CompressedValueHeader.
+  bool compressed() const { return compression_ != nullptr && !deleted(); }
+
   // True if this is a tombstone entry.
   bool deleted() const {
     return header_.value_size_bytes == kDeletedValueLength;
   }
 
+  // True if this entry is part of a batch and is not the batch's final entry.
+  bool batch_pending() const {
+    return (header_.key_length_bytes & kEraseCountFlags) == kBatchPendingFlag;
+  }
+
+  // True if this is a sector summary record rather than a key-value entry.
+  bool sector_summary() const {
+    return header_.key_length_bytes == kSectorSummaryFlag;
+  }
+
+  // True if this is an erase count record rather than a key-value entry.
+  bool erase_count_record() const {
+    return header_.key_length_bytes == kEraseCountFlags;
+  }
+
+  // The number of items in a sector summary record.
+  size_t summary_item_count() const {
+    return value_size() / sizeof(SectorSummaryItem);
+  }
+
   void DebugLog() const;
 
  private:
   static constexpr uint16_t kDeletedValueLength = 0xFFFF;
 
+  static constexpr uint8_t kKeyLengthMask = 0b111111;
+  static constexpr uint8_t kBatchPendingFlag = 0b1000000;
+  static constexpr uint8_t kSectorSummaryFlag = 0b10000000;
+  static constexpr uint8_t kEraseCountFlags =
+      kSectorSummaryFlag | kBatchPendingFlag;
+
   Entry(FlashPartition& partition,
         Address address,
         const EntryFormat& format,
         Key key,
         std::span<const std::byte> value,
         uint16_t value_size_bytes,
-        uint32_t transaction_id);
+        uint32_t transaction_id,
+        bool batch_pending);
 
   constexpr Entry(FlashPartition* partition,
                   Address address,
@@ -188,6 +346,7 @@ class Entry {
       : partition_(partition),
         address_(address),
         checksum_algo_(format.checksum),
+        compression_(format.compression),
         header_(header) {}
 
   FlashPartition& partition() const { return *partition_; }
@@ -208,6 +367,10 @@ class Entry {
 
   Status CalculateChecksumFromFlash();
 
+  Status ReadCompressedValueHeader(CompressedValueHeader& header) const;
+
+  Status Decompress(std::span<std::byte> output, size_t offset_bytes) const;
+
   // Update the checksum with 0s to pad the entry to its alignment boundary.
   void AddPaddingBytesToChecksum() const;
 
@@ -218,6 +381,7 @@ class Entry {
   FlashPartition* partition_;
   Address address_;
   ChecksumAlgorithm* checksum_algo_;
+  ValueCompressor* compression_;
   EntryHeader header_;
 };
 
@@ -15,6 +15,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <span>
 #include <type_traits>
 
@@ -37,11 +38,13 @@ class EntryMetadata {
 
   EntryMetadata() = default;
 
-  uint32_t hash() const { return descriptor_->key_hash; }
+  uint32_t hash() const { return descriptors_->key_hash(index_); }
 
-  uint32_t transaction_id() const { return descriptor_->transaction_id; }
+  uint32_t transaction_id() const {
+    return descriptors_->transaction_id(index_);
+  }
 
-  EntryState state() const { return descriptor_->state; }
+  EntryState state() const { return descriptors_->state(index_); }
 
   // The first known address of this entry.
   uint32_t first_address() const { return addresses_[0]; }
@@ -72,11 +75,13 @@ class EntryMetadata {
  private:
   friend class EntryCache;
 
-  constexpr EntryMetadata(KeyDescriptor& descriptor,
+  constexpr EntryMetadata(KeyDescriptorList& descriptors,
+                          size_t index,
                           std::span<Address> addresses)
-      : descriptor_(&descriptor), addresses_(addresses) {}
+      : descriptors_(&descriptors), index_(index), addresses_(addresses) {}
 
-  KeyDescriptor* descriptor_;
+  KeyDescriptorList* descriptors_;
+  size_t index_;
   std::span<Address> addresses_;
 };
 
@@ -94,36 +99,36 @@ class EntryCache {
         std::conditional_t<kIsConst, const EntryMetadata, EntryMetadata>;
 
     Iterator& operator++() {
-      ++metadata_.descriptor_;
+      ++metadata_.index_;
       return *this;
     }
     Iterator& operator++(int) { return operator++(); }
 
     // Updates the internal EntryMetadata object.
     value_type& operator*() const {
-      metadata_.addresses_ = entry_cache_->addresses(
-          metadata_.descriptor_ - entry_cache_->descriptors_.begin());
+      metadata_.addresses_ = entry_cache_->addresses(metadata_.index_);
       return metadata_;
     }
     value_type* operator->() const { return &operator*(); }
 
     constexpr bool operator==(const Iterator& rhs) const {
-      return metadata_.descriptor_ == rhs.metadata_.descriptor_;
+      return metadata_.index_ == rhs.metadata_.index_;
     }
     constexpr bool operator!=(const Iterator& rhs) const {
-      return metadata_.descriptor_ != rhs.metadata_.descriptor_;
+      return metadata_.index_ != rhs.metadata_.index_;
     }
 
     // Allow non-const to convert to const.
     operator Iterator<kConst>() const {
-      return {entry_cache_, metadata_.descriptor_};
+      return {entry_cache_, metadata_.index_};
     }
 
    private:
     friend class EntryCache;
 
-    constexpr Iterator(const EntryCache* entry_cache, KeyDescriptor* descriptor)
-        : entry_cache_(entry_cache), metadata_(*descriptor, {}) {}
+    constexpr Iterator(const EntryCache* entry_cache, size_t index)
+        : entry_cache_(entry_cache),
+          metadata_(entry_cache->descriptors_, index, {}) {}
 
     const EntryCache* entry_cache_;
 
@@ -144,15 +149,56 @@ class EntryCache {
   template <size_t kMaxEntries, size_t kRedundancy>
   using AddressList = Address[kMaxEntries * kRedundancy + kRedundancy];
 
-  constexpr EntryCache(Vector<KeyDescriptor>& descriptors,
+  // Slot in the optional open-addressed hash index over the descriptors. Each
+  // slot holds a descriptor index plus one; zero marks an empty slot, so a
+  // zero-initialized array is a valid empty index.
+  using HashIndexSlot = uint16_t;
+
+  // The largest number of entries that can be tracked by the hash index.
+  static constexpr size_t kMaxHashIndexedEntries =
+      std::numeric_limits<HashIndexSlot>::max() - 1;
+
+  // The hash index must have a power-of-two number of slots, and more slots
+  // than entries so that a probe always terminates at an empty slot.
+  static constexpr bool ValidHashIndexSize(size_t index_slots,
+                                           size_t max_entries) {
+    return index_slots == 0u ||
+           ((index_slots & (index_slots - 1)) == 0u &&
+            index_slots > max_entries &&
+            max_entries <= kMaxHashIndexedEntries);
+  }
+
+  // The optional key prefix cache stores the first bytes of each key, plus
+  // the key's length, in a parallel array. Each slot is one byte longer than
+  // the number of cached key bytes.
+  template <size_t kMaxEntries, size_t kKeyPrefixBytes>
+  using KeyPrefixList = char[kMaxEntries * (kKeyPrefixBytes + 1)];
+
+  // Result of comparing a prefix with an entry's cached key prefix.
+  enum class PrefixMatch { kMatch, kNoMatch, kUnknown };
+
+  // Creates an EntryCache. If hash_index_slots is non-zero, Find and
+  // AddNewOrUpdateExisting look up descriptors through the hash index instead
+  // of scanning all descriptors. The hash index must be zero-initialized or
+  // cleared with Reset() before use. If key_prefix_bytes is non-zero, the
+  // first key_prefix_bytes of each key are kept in key_prefixes.
+  constexpr EntryCache(KeyDescriptorList& descriptors,
                        Address* addresses,
-                       size_t redundancy)
+                       size_t redundancy,
+                       HashIndexSlot* hash_index = nullptr,
+                       size_t hash_index_slots = 0,
+                       char* key_prefixes = nullptr,
+                       size_t key_prefix_bytes = 0)
       : descriptors_(descriptors),
         addresses_(addresses),
-        redundancy_(redundancy) {}
+        redundancy_(redundancy),
+        hash_index_(hash_index),
+        hash_index_slots_(hash_index_slots),
+        key_prefixes_(key_prefixes),
+        key_prefix_bytes_(key_prefix_bytes) {}
 
   // Clears all KeyDescriptors.
-  void Reset() const { descriptors_.clear(); }
+  void Reset() const;
 
   // Finds the metadata for an entry matching a particular key. Searches for a
   // KeyDescriptor that matches this key and sets *metadata to point to it if
@@ -173,15 +219,32 @@ class EntryCache {
                       EntryMetadata* metadata) const;
 
   // Adds a new descriptor to the descriptor list. The entry MUST be unique and
-  // the EntryCache must NOT be full!
-  EntryMetadata AddNew(const KeyDescriptor& entry, Address address) const;
+  // the EntryCache must NOT be full! The key is stored in the key prefix
+  // cache; it may be empty if it is not known.
+  EntryMetadata AddNew(const KeyDescriptor& entry,
+                       Address address,
+                       Key key = {}) const;
 
   // Adds a new descriptor, overwrites an existing one, or adds an additional
   // redundant address to one. The sector size is included for checking that
-  // redundant entries are in different sectors.
+  // redundant entries are in different sectors. The key may be empty if it is
+  // not known.
   Status AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
                                 Address address,
-                                size_t sector_size_bytes) const;
+                                size_t sector_size_bytes,
+                                Key key = {}) const;
+
+  // Stores the entry's key in the key prefix cache, if it is enabled. Used to
+  // fill in keys that were unknown when the entry was added.
+  void SetKeyPrefix(const EntryMetadata& metadata, Key key) const;
+
+  // Checks whether the entry's key starts with prefix using only the key
+  // prefix cache. Returns kUnknown if the key must be read from flash to tell.
+  PrefixMatch MatchKeyPrefix(const EntryMetadata& metadata, Key prefix) const;
+
+  // Returns the entry's full key if it fits in the key prefix cache, or an
+  // empty key if it does not. The key is not null-terminated.
+  Key CachedKey(const EntryMetadata& metadata) const;
 
   // Returns a pointer to an array of redundancy() addresses for temporary use.
   // This is used by the KeyValueStore to track reserved addresses when finding
@@ -205,15 +268,25 @@ class EntryCache {
   // The maximum number of entries supported by this EntryCache.
   size_t max_entries() const { return descriptors_.max_size(); }
 
-  iterator begin() const { return {this, descriptors_.begin()}; }
-  const_iterator cbegin() const { return {this, descriptors_.begin()}; }
+  // True if lookups use the hash index rather than a linear scan.
+  bool hash_indexed() const { return hash_index_slots_ != 0u; }
+
+  // True if the first bytes of each key are kept in RAM.
+  bool key_prefixes_cached() const { return key_prefix_bytes_ != 0u; }
+
+  iterator begin() const { return {this, 0}; }
+  const_iterator cbegin() const { return {this, 0}; }
 
-  iterator end() const { return {this, descriptors_.end()}; }
-  const_iterator cend() const { return {this, descriptors_.end()}; }
+  iterator end() const { return {this, descriptors_.size()}; }
+  const_iterator cend() const { return {this, descriptors_.size()}; }
 
  private:
   int FindIndex(uint32_t key_hash) const;
 
+  // Returns the hash index slot that holds key_hash, or the empty slot where it
+  // would be inserted. Only valid if hash_indexed().
+  HashIndexSlot& FindHashIndexSlot(uint32_t key_hash) const;
+
   // Adds the address to the descriptor at the specified index if there is an
   // address slot available.
   void AddAddressIfRoom(size_t descriptor_index, Address address) const;
@@ -227,9 +300,26 @@ class EntryCache {
 
   Address* ResetAddresses(size_t descriptor_index, Address address) const;
 
-  Vector<KeyDescriptor>& descriptors_;
+  size_t index(const EntryMetadata& metadata) const { return metadata.index_; }
+
+  // Returns the key prefix slot for the descriptor. The first byte is the key
+  // length, or kUnknownKeyLength, followed by up to key_prefix_bytes_ of the
+  // key.
+  char* key_prefix_slot(size_t descriptor_index) const {
+    return &key_prefixes_[descriptor_index * (key_prefix_bytes_ + 1)];
+  }
+
+  void StoreKeyPrefix(size_t descriptor_index, Key key) const;
+
+  KeyDescriptorList& descriptors_;
   FlashPartition::Address* const addresses_;
   const size_t redundancy_;
+
+  HashIndexSlot* const hash_index_;
+  const size_t hash_index_slots_;
+
+  char* const key_prefixes_;
+  const size_t key_prefix_bytes_;
 };
 
 }  // namespace internal
@@ -13,7 +13,9 @@
 // the License.
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 namespace pw {
 namespace kvs {
@@ -27,7 +29,108 @@ struct KeyDescriptor {
   uint32_t key_hash;
   uint32_t transaction_id;
 
-  EntryState state;  // TODO: Pack into transaction ID? or something?
+  EntryState state;
+};
+
+// A list of KeyDescriptors, stored as parallel arrays rather than an array of
+// structs. Key hashes are contiguous, so searching for a hash reads only the
+// hashes, four bytes per entry, in a loop the compiler can vectorize. States
+// are packed into a bitmap. Each descriptor uses just over 8 bytes, rather than
+// the 12 bytes of a KeyDescriptor.
+//
+// Declare instances as KeyDescriptorListBuffer<kMaxEntries>.
+class KeyDescriptorList {
+ public:
+  KeyDescriptorList(const KeyDescriptorList&) = delete;
+  KeyDescriptorList& operator=(const KeyDescriptorList&) = delete;
+
+  size_t size() const { return size_; }
+  size_t max_size() const { return max_size_; }
+  bool empty() const { return size_ == 0u; }
+  bool full() const { return size_ == max_size_; }
+
+  void clear() { size_ = 0; }
+
+  // Adds a descriptor to the end of the list. The list must not be full.
+  void push_back(const KeyDescriptor& descriptor) {
+    size_ += 1;
+    set(size_ - 1, descriptor);
+  }
+
+  KeyDescriptor get(size_t index) const {
+    return KeyDescriptor{
+        key_hashes_[index], transaction_ids_[index], state(index)};
+  }
+
+  void set(size_t index, const KeyDescriptor& descriptor) {
+    key_hashes_[index] = descriptor.key_hash;
+    transaction_ids_[index] = descriptor.transaction_id;
+
+    const uint32_t bit = uint32_t(1) << (index % 32);
+    if (descriptor.state == EntryState::kDeleted) {
+      deleted_[index / 32] |= bit;
+    } else {
+      deleted_[index / 32] &= ~bit;
+    }
+  }
+
+  uint32_t key_hash(size_t index) const { return key_hashes_[index]; }
+
+  uint32_t transaction_id(size_t index) const {
+    return transaction_ids_[index];
+  }
+
+  EntryState state(size_t index) const {
+    return (deleted_[index / 32] >> (index % 32)) & 1u ? EntryState::kDeleted
+                                                        : EntryState::kValid;
+  }
+
+  // The key hashes of all descriptors, in order.
+  std::span<const uint32_t> key_hashes() const {
+    return std::span(key_hashes_, size_);
+  }
+
+ protected:
+  // The number of words in the state bitmap for max_size descriptors.
+  static constexpr size_t StateWords(size_t max_size) {
+    return (max_size + 31) / 32;
+  }
+
+  constexpr KeyDescriptorList(uint32_t* key_hashes,
+                              uint32_t* transaction_ids,
+                              uint32_t* deleted,
+                              size_t max_size)
+      : key_hashes_(key_hashes),
+        transaction_ids_(transaction_ids),
+        deleted_(deleted),
+        max_size_(max_size),
+        size_(0) {}
+
+ private:
+  uint32_t* const key_hashes_;
+  uint32_t* const transaction_ids_;
+  uint32_t* const deleted_;  // Bit set for each deleted entry.
+  const size_t max_size_;
+  size_t size_;
+};
+
+// A KeyDescriptorList with storage for kMaxEntries descriptors.
+template <size_t kMaxEntries>
+class KeyDescriptorListBuffer : public KeyDescriptorList {
+ public:
+  constexpr KeyDescriptorListBuffer()
+      : KeyDescriptorList(
+            key_hashes_, transaction_ids_, deleted_, kMaxEntries),
+        key_hashes_{},
+        transaction_ids_{},
+        deleted_{} {}
+
+ private:
+  static_assert(kMaxEntries > 0u);
+
+  uint32_t key_hashes_[kMaxEntries];
+  uint32_t transaction_ids_[kMaxEntries];
+  uint32_t deleted_[StateWords(kMaxEntries)];
 };
 
 }  // namespace internal
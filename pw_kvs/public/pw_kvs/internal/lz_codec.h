@@ -0,0 +1,144 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::kvs::internal {
+
+// A small LZSS codec for compressing KVS values and blobs as they are streamed
+// to and from flash, using a fixed amount of RAM.
+//
+// Compressed data is a sequence of groups. Each group starts with a flag byte
+// that describes up to eight items, starting from its least significant bit. A
+// 0 bit is a literal byte. A 1 bit is a two byte match, which repeats earlier
+// output:
+//
+//   byte 0: bits 0-7 of (distance - 1)
+//   byte 1: bits 8-9 of (distance - 1) in bits 6-7, (length - 3) in bits 0-5
+//
+// The number of items in the last group is not encoded, so the decoder must be
+// given exactly the compressed data.
+inline constexpr size_t kLzWindowSizeBytes = 1024;
+inline constexpr size_t kLzMinMatchBytes = 3;
+inline constexpr size_t kLzMaxMatchBytes = 66;
+
+class LzEncoder {
+ public:
+  constexpr LzEncoder()
+      : buffer_{},
+        hash_table_{},
+        group_{},
+        position_(0),
+        end_(0),
+        group_size_(1),
+        item_count_(0) {}
+
+  // Starts a new compressed stream.
+  void Reset();
+
+  // Compresses data and writes complete groups to output. The last bytes are
+  // held until more data is written or Finish() is called. Returns the status
+  // of the first failed output write.
+  Status Write(ConstByteSpan data, stream::Writer& output);
+
+  // Compresses the bytes held by Write() and writes the last group.
+  Status Finish(stream::Writer& output);
+
+ private:
+  // A power of two with room for the window and the next match.
+  static constexpr size_t kBufferSizeBytes = 2048;
+  static constexpr size_t kHashTableSize = 256;
+
+  static_assert(kBufferSizeBytes >= kLzWindowSizeBytes + kLzMaxMatchBytes);
+
+  std::byte At(uint32_t position) const {
+    return buffer_[position % kBufferSizeBytes];
+  }
+
+  size_t Hash(uint32_t position) const;
+
+  Status EncodeNext(stream::Writer& output);
+
+  Status FlushGroup(stream::Writer& output);
+
+  // The last kBufferSizeBytes bytes written, indexed by absolute position.
+  std::array<std::byte, kBufferSizeBytes> buffer_;
+
+  // The most recent position + 1 of each three byte hash, or 0 if none.
+  std::array<uint32_t, kHashTableSize> hash_table_;
+
+  // The flag byte and up to eight items of two bytes each.
+  std::array<std::byte, 17> group_;
+
+  // The next byte to encode, and the end of the data written so far.
+  uint32_t position_;
+  uint32_t end_;
+
+  size_t group_size_;
+  size_t item_count_;
+};
+
+class LzDecoder {
+ public:
+  constexpr LzDecoder()
+      : window_{},
+        output_position_(0),
+        flags_(0),
+        flags_remaining_(0),
+        match_distance_(0),
+        match_remaining_(0),
+        partial_match_(0),
+        have_partial_match_(false) {}
+
+  // Starts decoding a new compressed stream.
+  void Reset();
+
+  // Decodes bytes from the front of input into output, until output is full or
+  // input is used up. Consumed bytes are removed from input, which may end in
+  // the middle of an item. Returns:
+  //
+  // OK with size - number of decompressed bytes written to output.
+  // DATA_LOSS - a match refers to data before the start of the stream.
+  StatusWithSize Decode(ConstByteSpan& input, ByteSpan output);
+
+  // Total number of decompressed bytes produced since Reset().
+  size_t output_size() const { return output_position_; }
+
+ private:
+  void Emit(std::byte b, ByteSpan output, size_t& written);
+
+  std::array<std::byte, kLzWindowSizeBytes> window_;
+  uint32_t output_position_;
+
+  uint8_t flags_;
+  uint8_t flags_remaining_;
+
+  // The match being copied to output.
+  uint32_t match_distance_;
+  size_t match_remaining_;
+
+  // The first byte of a match whose second byte has not been received.
+  uint8_t partial_match_;
+  bool have_partial_match_;
+};
+
+}  // namespace pw::kvs::internal
@@ -78,7 +78,27 @@ class SectorDescriptor {
   // Returns the number of bytes that would be recovered if this sector is
   // garbage collected.
   size_t RecoverableBytes(size_t sector_size_bytes) const {
-    return sector_size_bytes - valid_bytes_ - writable_bytes();
+    return sector_size_bytes - valid_bytes_ - overhead_bytes_ -
+           writable_bytes();
+  }
+
+  // The number of bytes used by the sector's erase count record. These bytes
+  // are neither valid nor recoverable, since the record is rewritten after the
+  // sector is erased.
+  size_t overhead_bytes() const { return overhead_bytes_; }
+
+  void set_overhead_bytes(uint16_t bytes) { overhead_bytes_ = bytes; }
+
+  // The number of times this sector has been erased.
+  uint32_t erase_count() const { return erase_count_; }
+
+  void set_erase_count(uint32_t erase_count) { erase_count_ = erase_count; }
+
+  // Updates the descriptor after the sector is erased.
+  void MarkErased(uint16_t sector_size_bytes) {
+    tail_free_bytes_ = sector_size_bytes;
+    overhead_bytes_ = 0;
+    erase_count_ += 1;
   }
 
   static constexpr size_t max_sector_size() { return kMaxSectorSize; }
@@ -90,10 +110,15 @@ class SectorDescriptor {
   static constexpr size_t kMaxSectorSize = UINT16_MAX - 1;
 
   explicit constexpr SectorDescriptor(uint16_t sector_size_bytes)
-      : tail_free_bytes_(sector_size_bytes), valid_bytes_(0) {}
+      : tail_free_bytes_(sector_size_bytes),
+        valid_bytes_(0),
+        overhead_bytes_(0),
+        erase_count_(0) {}
 
   uint16_t tail_free_bytes_;  // writable bytes at the end of the sector
   uint16_t valid_bytes_;      // sum of sizes of valid entries
+  uint16_t overhead_bytes_;   // size of the erase count record, if any
+  uint32_t erase_count_;      // number of times the sector was erased
 };
 
 // Represents a list of sectors usable by the KVS.
@@ -158,12 +183,15 @@ class Sectors {
 
   // Finds either an existing sector with enough space that is not the sector to
   // skip, or an empty sector. Maintains the invariant that there is always at
-  // least 1 empty sector. Addresses in reserved_addresses are avoided.
+  // least 1 empty sector. Addresses in reserved_addresses are avoided. Of the
+  // empty sectors, the one that was erased the fewest times is used.
+  //
+  // If the partition spans several flash banks, sectors in banks other than
+  // those of reserved_addresses are preferred, so that redundant copies of an
+  // entry are in different banks.
   Status FindSpace(SectorDescriptor** found_sector,
                    size_t size,
-                   std::span<const Address> reserved_addresses) {
-    return Find(kAppendEntry, found_sector, size, {}, reserved_addresses);
-  }
+                   std::span<const Address> reserved_addresses);
 
   // Same as FindSpace, except that the 1 empty sector invariant is ignored.
   // Both addresses_to_skip and reserved_addresses are avoided.
@@ -180,7 +208,8 @@ class Sectors {
   }
 
   // Finds a sector that is ready to be garbage collected. Returns nullptr if no
-  // sectors can / need to be garbage collected.
+  // sectors can / need to be garbage collected. Ties between candidates are
+  // broken in favor of the sector that was erased the fewest times.
   SectorDescriptor* FindSectorToGarbageCollect(
       std::span<const Address> addresses_to_avoid) const;
 
@@ -208,12 +237,18 @@ class Sectors {
 
  private:
   enum FindMode { kAppendEntry, kGarbageCollect };
+  enum BankMode { kAnyBank, kOtherBanks };
 
   Status Find(FindMode find_mode,
               SectorDescriptor** found_sector,
               size_t size,
               std::span<const Address> addresses_to_skip,
-              std::span<const Address> reserved_addresses);
+              std::span<const Address> reserved_addresses,
+              BankMode bank_mode = kAnyBank);
+
+  // True if the sector is in the same flash bank as any of the addresses.
+  bool InSameBank(const SectorDescriptor& sector,
+                  std::span<const Address> addresses) const;
 
   SectorDescriptor& WearLeveledSectorFromIndex(size_t idx) const;
 
@@ -0,0 +1,108 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_status/status_with_size.h"
+
+namespace pw {
+namespace kvs {
+namespace internal {
+
+// Caches recently read values in a fixed-size RAM buffer, so that reading a
+// hot value does not require reading (and decompressing) it from flash.
+//
+// Values are identified by key hash and transaction ID. A cached value whose
+// transaction ID does not match the key's current transaction ID is stale and
+// is never returned. When the buffer is full, the least recently used values
+// are evicted to make room for new ones.
+//
+// Values are stored back to back in the buffer, each preceded by a small
+// header, so the number of values that fit depends on their sizes.
+class ValueCache {
+ public:
+  explicit constexpr ValueCache(std::span<std::byte> buffer)
+      : buffer_(buffer), used_bytes_(0), last_use_(0), hits_(0), misses_(0) {}
+
+  // True if the cache has a buffer to store values in.
+  bool enabled() const { return !buffer_.empty(); }
+
+  // Removes all values from the cache. The hit and miss counts are kept.
+  void Reset() { used_bytes_ = 0; }
+
+  // Reads a cached value, with the same semantics as KeyValueStore::Get.
+  // Returns NOT_FOUND if the value is not cached.
+  StatusWithSize Get(uint32_t key_hash,
+                     uint32_t transaction_id,
+                     std::span<std::byte> value_buffer,
+                     size_t offset_bytes);
+
+  // Returns the size of a cached value, or NOT_FOUND if it is not cached. Does
+  // not affect the hit and miss counts.
+  StatusWithSize ValueSize(uint32_t key_hash, uint32_t transaction_id) const;
+
+  // Adds a value to the cache, replacing any value for the same key and
+  // evicting the least recently used values if necessary. Values too large for
+  // the buffer are not cached.
+  void Put(uint32_t key_hash,
+           uint32_t transaction_id,
+           std::span<const std::byte> value);
+
+  // Removes the value for a key, if it is cached.
+  void Remove(uint32_t key_hash);
+
+  size_t hits() const { return hits_; }
+  size_t misses() const { return misses_; }
+
+  // Bytes of buffer used per value, in addition to the value itself.
+  static constexpr size_t kOverheadBytes = 16;
+
+ private:
+  struct Header {
+    uint32_t key_hash;
+    uint32_t transaction_id;
+    uint32_t value_size;
+    uint32_t last_use;
+  };
+  static_assert(sizeof(Header) == kOverheadBytes);
+
+  static constexpr size_t RecordSize(size_t value_size) {
+    return sizeof(Header) + value_size;
+  }
+
+  // Returns the offset of the record for a key, or used_bytes_ if none.
+  size_t Find(uint32_t key_hash) const;
+
+  Header ReadHeader(size_t offset) const;
+  void WriteHeader(size_t offset, const Header& header);
+
+  void RemoveAt(size_t offset);
+  void EvictLeastRecentlyUsed();
+
+  uint32_t NextUse() { return ++last_use_; }
+
+  std::span<std::byte> buffer_;
+  size_t used_bytes_;
+  uint32_t last_use_;
+
+  size_t hits_;
+  size_t misses_;
+};
+
+}  // namespace internal
+}  // namespace kvs
+}  // namespace pw
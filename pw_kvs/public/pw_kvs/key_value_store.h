@@ -19,6 +19,7 @@
 #include <span>
 #include <type_traits>
 
+#include "pw_bytes/span.h"
 #include "pw_containers/vector.h"
 #include "pw_kvs/checksum.h"
 #include "pw_kvs/flash_memory.h"
@@ -28,7 +29,9 @@
 #include "pw_kvs/internal/key_descriptor.h"
 #include "pw_kvs/internal/sectors.h"
 #include "pw_kvs/internal/span_traits.h"
+#include "pw_kvs/internal/value_cache.h"
 #include "pw_kvs/key.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
 
@@ -77,6 +80,25 @@ struct Options {
 
   // Verify an in-flash entry's checksum after writing it.
   bool verify_on_write = true;
+
+  // Write a summary record at the end of each sector as it fills, and use the
+  // summaries to load entries in Init. Entries listed in a summary are not
+  // read or checksummed by Init, which reduces Init time for large partitions.
+  // Each summary uses 12 bytes per entry in its sector, plus a 16-byte header.
+  bool sector_summaries = false;
+
+  // Store each sector's erase count in a record at the start of the sector, so
+  // that garbage collection spreads wear evenly across reboots. The record is
+  // written before the first entry after the sector is erased, and uses a
+  // 16-byte header plus 4 bytes, padded to the flash alignment. Without this
+  // option, erase counts start from zero in Init.
+  bool persist_erase_counts = false;
+
+  // Skip Put calls that would write the value the key already has. The new
+  // value is checked against the current entry's checksum first, which needs
+  // no flash reads, and only compared with the stored bytes if the checksum
+  // matches. Skipped writes are counted in StorageStats.
+  bool skip_unchanged_writes = true;
 };
 
 class KeyValueStore {
@@ -120,6 +142,24 @@ class KeyValueStore {
                      std::span<std::byte> value,
                      size_t offset_bytes = 0) const;
 
+  // Returns the value of an entry as a span of memory-mapped flash, without
+  // copying it. This is only supported if the flash is memory mapped (e.g. XIP
+  // flash). The span remains valid until the entry is overwritten, deleted, or
+  // relocated by garbage collection.
+  //
+  // If verify_checksum is true, the entry's checksum is verified against the
+  // mapped value. Skipping verification speeds up frequent reads of large
+  // values that were already verified, e.g. by Init.
+  //
+  //                    OK: the span refers to the value in flash
+  //             NOT_FOUND: the key is not present in the KVS
+  //             DATA_LOSS: found the entry, but the data was corrupted
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: key is empty or too long
+  //         UNIMPLEMENTED: the flash is not memory mapped
+  //
+  Result<ConstByteSpan> GetMapped(Key key, bool verify_checksum = true) const;
+
   // This overload of Get accepts a pointer to a trivially copyable object.
   // If the value is an array, call Get with
   // std::as_writable_bytes(std::span(array)), or pass a pointer to the array
@@ -173,6 +213,54 @@ class KeyValueStore {
   //
   Status Delete(Key key);
 
+  // Collects several puts and deletes to write as a single transaction. See
+  // KeyValueStore::Batch, below.
+  class Batch;
+
+  template <size_t kMaxOperations>
+  class BatchBuffer;
+
+  // Writes all puts and deletes in the batch under one transaction ID. The
+  // batch's entries are written contiguously within one sector. The batch is
+  // atomic: if the KVS is reinitialized after an interrupted commit, either
+  // all of the batch's changes are present, or none of them are. The batch is
+  // cleared if the commit succeeds.
+  //
+  //                    OK: all changes in the batch were applied
+  //             NOT_FOUND: the batch deletes a key that is not in the KVS
+  //             DATA_LOSS: checksum validation failed after writing the data
+  //    RESOURCE_EXHAUSTED: there is not enough space for the batch
+  //        ALREADY_EXISTS: a key in the batch could not be added because a
+  //                        different key with the same hash is in the KVS
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: the batch's entries do not fit in one sector
+  //
+  Status Commit(Batch& batch);
+
+  // Imports entries in the raw format read by Item::ReadRawEntry, such as
+  // entries exported from another KVS, by adding them to the batch and
+  // committing it. The entries are concatenated in the buffer. Each entry's
+  // checksum is verified, but values stored in the primary format are written
+  // as they are, without decompressing or recompressing them. Values in other
+  // formats must not be compressed. Deleted entries are skipped.
+  //
+  // The batch must be empty. Since all of the entries are committed as one
+  // batch, they must fit in one sector.
+  //
+  // Returns the number of entries imported.
+  //
+  //                    OK: all of the entries were imported
+  //             DATA_LOSS: an entry is truncated or its checksum is invalid
+  //    RESOURCE_EXHAUSTED: there are more entries than fit in the batch, or
+  //                        there is not enough space for them
+  //      INVALID_ARGUMENT: an entry has an unknown format or a compressed
+  //                        value in a format other than the primary format,
+  //                        or the entries do not fit in one sector
+  //
+  // Other errors are returned as from Commit.
+  StatusWithSize ImportRawEntries(std::span<const std::byte> entries,
+                                  Batch& batch);
+
   // Returns the size of the value corresponding to the key.
   //
   //                    OK: the size was returned successfully
@@ -211,6 +299,44 @@ class KeyValueStore {
   // that makes sense for the KVS implementation.
   Status PartialMaintenance();
 
+  // Performs a bounded step of incremental garbage collection, suitable for
+  // calling periodically from a low-priority thread so that writes rarely
+  // have to garbage collect inline. Each step relocates valid entries out of
+  // the sector being garbage collected until about max_bytes_relocated bytes
+  // have been moved; the sector is erased by the step that empties it. At
+  // least one entry is relocated per step, so a step may exceed the budget by
+  // up to one entry. If configured for at least lazy recovery, needed repairs
+  // are done before starting on a new sector.
+  //
+  // Returns the number of bytes relocated.
+  //
+  //                    OK: progress was made; call again to continue
+  //             NOT_FOUND: there is no reclaimable space to garbage collect
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //
+  StatusWithSize MaintenanceStep(size_t max_bytes_relocated);
+
+  // Scrubs one sector, verifying the checksum of every entry stored in it, so
+  // that corruption is found before the data is needed rather than on a read.
+  // Each call scrubs the sector after the one scrubbed by the previous call,
+  // wrapping around at the end of the partition, so calling it periodically
+  // from a low-priority thread scrubs the whole KVS a sector at a time.
+  //
+  // A corrupt entry with an intact copy elsewhere is dropped and the sector is
+  // marked corrupt. If configured for at least lazy recovery, the sector is
+  // then garbage collected and the missing copies are rewritten right away;
+  // otherwise the repair is left for FullMaintenance.
+  //
+  // Returns the number of corrupt entries found in the sector.
+  //
+  //                    OK: the sector was scrubbed; corrupt entries, if any,
+  //                        were repaired or marked for repair
+  //             DATA_LOSS: an entry has no intact copy left
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //
+  // Other errors are returned if the repair fails.
+  StatusWithSize ScrubStep();
+
   void LogDebugInfo() const;
 
   // Classes and functions to support STL-style iteration.
@@ -240,6 +366,13 @@ class KeyValueStore {
     // KeyValueStore::ValueSize.
     StatusWithSize ValueSize() const { return kvs_.ValueSize(*iterator_); }
 
+    // Reads the whole entry as it is stored in flash, including its header,
+    // key, value, and padding, for KeyValueStore::ImportRawEntries. Returns
+    // RESOURCE_EXHAUSTED if the entry does not fit in the buffer.
+    StatusWithSize ReadRawEntry(std::span<std::byte> buffer) const {
+      return kvs_.ReadRawEntry(*iterator_, buffer);
+    }
+
    private:
     friend class iterator;
 
@@ -256,6 +389,8 @@ class KeyValueStore {
     std::array<char, internal::Entry::kMaxKeyLength + 1> key_buffer_;
   };
 
+  // Iterates over the valid entries whose keys start with a prefix. An empty
+  // prefix matches every key.
   class iterator {
    public:
     iterator& operator++();
@@ -285,10 +420,15 @@ class KeyValueStore {
 
     constexpr iterator(
         const KeyValueStore& kvs,
-        const internal::EntryCache::const_iterator& item_iterator)
-        : item_(kvs, item_iterator) {}
+        const internal::EntryCache::const_iterator& item_iterator,
+        Key prefix = {})
+        : item_(kvs, item_iterator), prefix_(prefix) {}
+
+    // Advances item_ to the first matching entry at or after its position.
+    void SkipNonMatching();
 
     Item item_;
+    Key prefix_;
   };
 
   using const_iterator = iterator;  // Standard alias for iterable types.
@@ -296,6 +436,31 @@ class KeyValueStore {
   iterator begin() const;
   iterator end() const { return iterator(*this, entry_cache_.end()); }
 
+  // A range of the entries whose keys start with a prefix.
+  class PrefixRange {
+   public:
+    iterator begin() const { return kvs_.begin(prefix_); }
+    iterator end() const { return kvs_.end(); }
+
+   private:
+    friend class KeyValueStore;
+
+    constexpr PrefixRange(const KeyValueStore& kvs, Key prefix)
+        : kvs_(kvs), prefix_(prefix) {}
+
+    const KeyValueStore& kvs_;
+    Key prefix_;
+  };
+
+  // Iterates over the entries whose keys start with prefix. The prefix is not
+  // copied and must remain valid while iterating.
+  //
+  // Checking whether a key matches requires reading it from flash, unless the
+  // KVS caches key prefixes (see kKeyPrefixBytes in KeyValueStoreBuffer). With
+  // the cache, keys that differ from the prefix within the cached bytes are
+  // skipped without any flash reads.
+  PrefixRange IteratePrefix(Key prefix) const { return {*this, prefix}; }
+
   // Returns the number of valid entries in the KeyValueStore.
   size_t size() const { return entry_cache_.present_entries(); }
 
@@ -315,10 +480,47 @@ class KeyValueStore {
     size_t sector_erase_count;
     size_t corrupt_sectors_recovered;
     size_t missing_redundant_entries_recovered;
+
+    // The fewest and most times a sector was erased. Sectors that were erased
+    // but not written to since Init count as erased the most times.
+    uint32_t min_sector_erase_count;
+    uint32_t max_sector_erase_count;
+
+    // Reads served from and missed by the value cache, if it is enabled.
+    size_t value_cache_hits;
+    size_t value_cache_misses;
+
+    // Put calls that were skipped because the value was unchanged.
+    size_t unchanged_writes_skipped;
   };
 
   StorageStats GetStorageStats() const;
 
+  // Time spent in parts of the KVS, in microseconds. Only recorded if
+  // PW_KVS_RECORD_LATENCY_STATS is enabled; otherwise all zero.
+  struct LatencyStats {
+    struct Phase {
+      size_t count;
+      uint64_t total_us;
+      uint32_t max_us;
+    };
+
+    // Put, Delete, and Commit calls, including any garbage collection and
+    // checksums they do.
+    Phase write;
+
+    // Garbage collection done by writes to free space.
+    Phase inline_garbage_collection;
+
+    // Checksum calculations for new entries and checksum verification on
+    // reads and writes.
+    Phase checksum;
+  };
+
+  const LatencyStats& latency_stats() const { return latency_stats_; }
+
+  void ResetLatencyStats() { latency_stats_ = {}; }
+
   // Level of redundancy to use for writing entries.
   size_t redundancy() const { return entry_cache_.redundancy(); }
 
@@ -354,12 +556,19 @@ class KeyValueStore {
                 size_t redundancy,
                 Vector<SectorDescriptor>& sector_descriptor_list,
                 const SectorDescriptor** temp_sectors_to_skip,
-                Vector<KeyDescriptor>& key_descriptor_list,
-                Address* addresses);
+                StatusWithSize* temp_write_results,
+                internal::KeyDescriptorList& key_descriptor_list,
+                Address* addresses,
+                internal::EntryCache::HashIndexSlot* hash_index = nullptr,
+                size_t hash_index_slots = 0,
+                std::span<std::byte> value_cache = {},
+                char* key_prefixes = nullptr,
+                size_t key_prefix_bytes = 0);
 
  private:
   using EntryMetadata = internal::EntryMetadata;
   using EntryState = internal::EntryState;
+  using SectorSummaryItem = internal::SectorSummaryItem;
 
   template <typename T>
   static constexpr void CheckThatObjectCanBePutOrGet() {
@@ -371,18 +580,73 @@ class KeyValueStore {
         "std::as_writable_bytes(std::span(&value, 1)).");
   }
 
+  // Tracks a run of batch pending entries while loading entries from a sector.
+  // The run is only loaded once the batch's final entry is found.
+  struct PendingBatch {
+    bool active() const { return start != kNoAddress; }
+    void Clear() { start = kNoAddress; }
+
+    static constexpr Address kNoAddress = Address(-1);
+
+    Address start = kNoAddress;
+    uint32_t transaction_id = 0;
+  };
+
   Status InitializeMetadata();
-  Status LoadEntry(Address entry_address, Address* next_entry_address);
+  Status LoadEntry(Address entry_address,
+                   Address* next_entry_address,
+                   PendingBatch& pending_batch);
+  Status LoadBatchEntries(Address start_address, Address end_address);
   Status ScanForEntry(const SectorDescriptor& sector,
                       Address start_address,
                       Address* next_entry_address);
 
+  Status LoadSectorSummary(SectorDescriptor& sector);
+  Status FindSectorSummary(const SectorDescriptor& sector, Entry* summary);
+
+  // Provides the entries in a sector as sector summary items.
+  class SectorSummaryItems;
+
+  Status WriteSectorSummary(SectorDescriptor& sector);
+
+  // True if a write of entry_count entries totaling entry_size bytes would not
+  // leave room for the sector's summary record, so the summary should be
+  // written first.
+  bool NeedsSectorSummary(const SectorDescriptor& sector,
+                          size_t entry_size,
+                          size_t entry_count) const;
+
+  void LoadEraseCounts();
+
+  // Writes the erase count record to a sector that was not written to since it
+  // was erased, if there is room for it and an entry of entry_size bytes.
+  Status WriteEraseCountIfEmpty(SectorDescriptor& sector, size_t entry_size);
+
+  // The number of entries in the entry cache with an address in the sector.
+  size_t EntriesInSector(const SectorDescriptor& sector) const;
+
   Status PutBytes(Key key, std::span<const std::byte> value);
 
   StatusWithSize ValueSize(const EntryMetadata& metadata) const;
 
   Status ReadEntry(const EntryMetadata& metadata, Entry& entry) const;
 
+  StatusWithSize ReadRawEntry(const EntryMetadata& metadata,
+                              std::span<std::byte> buffer) const;
+
+  // Returns an iterator to the first valid entry whose key starts with prefix.
+  iterator begin(Key prefix) const;
+
+  // Reads the entry's key into key_buffer, from the key prefix cache if the
+  // whole key is cached or from flash otherwise. Returns the key's length. The
+  // key is not null terminated.
+  StatusWithSize ReadKey(const EntryMetadata& metadata,
+                         Entry::KeyBuffer& key_buffer) const;
+
+  // True if the entry's key starts with prefix. Reads the key from flash only
+  // if the key prefix cache cannot decide.
+  bool KeyHasPrefix(const EntryMetadata& metadata, Key prefix) const;
+
   // Finds the metadata for an entry matching a particular key. Searches for a
   // KeyDescriptor that matches this key and sets *metadata to point to it if
   // one is found.
@@ -410,6 +674,10 @@ class KeyValueStore {
                      std::span<std::byte> value_buffer,
                      size_t offset_bytes) const;
 
+  StatusWithSize GetCompressed(const Entry& entry,
+                               std::span<std::byte> value_buffer,
+                               size_t offset_bytes) const;
+
   Status FixedSizeGet(Key key, void* value, size_t size_bytes) const;
 
   Status FixedSizeGet(Key key,
@@ -443,11 +711,19 @@ class KeyValueStore {
                                     EntryMetadata* prior_metadata,
                                     size_t prior_size);
 
-  Status GetAddressesForWrite(Address* write_addresses, size_t write_size);
+  Status GetAddressesForWrite(Address* write_addresses,
+                              size_t write_size,
+                              size_t entry_count = 1);
 
   Status GetSectorForWrite(SectorDescriptor** sector,
                            size_t entry_size,
-                           std::span<const Address> addresses_to_skip);
+                           std::span<const Address> addresses_to_skip,
+                           size_t entry_count = 1);
+
+  Status FindSpace(SectorDescriptor** sector,
+                   size_t entry_size,
+                   size_t entry_count,
+                   std::span<const Address> reserved);
 
   Status MarkSectorCorruptIfNotOk(Status status, SectorDescriptor* sector);
 
@@ -455,6 +731,12 @@ class KeyValueStore {
                      Key key,
                      std::span<const std::byte> value);
 
+  Status FinishAppendEntry(const Entry& entry, StatusWithSize write_result);
+
+  Status AppendBatch(const Batch& batch,
+                     Address address,
+                     uint32_t transaction_id);
+
   StatusWithSize CopyEntryToSector(Entry& entry,
                                    SectorDescriptor* new_sector,
                                    Address new_address);
@@ -508,11 +790,21 @@ class KeyValueStore {
 
   Status Repair();
 
+  Result<std::span<const std::byte>> StoredValue(
+      std::span<const std::byte> value) const;
+
   internal::Entry CreateEntry(Address address,
                               Key key,
                               std::span<const std::byte> value,
                               EntryState state);
 
+  internal::Entry CreateEntry(Address address,
+                              Key key,
+                              std::span<const std::byte> value,
+                              EntryState state,
+                              uint32_t transaction_id,
+                              bool batch_pending);
+
   void LogSectors() const;
   void LogKeyDescriptor() const;
 
@@ -522,10 +814,14 @@ class KeyValueStore {
   // List of sectors used by this KVS.
   internal::Sectors sectors_;
 
-  // Unordered list of KeyDescriptors. Finding a key requires scanning and
-  // verifying a match by reading the actual entry.
+  // Unordered list of KeyDescriptors. Finding a key requires scanning (or a
+  // hash index lookup, if configured) and verifying a match by reading the
+  // actual entry.
   internal::EntryCache entry_cache_;
 
+  // The result of writing each copy of an entry; redundancy() elements.
+  StatusWithSize* const temp_write_results_;
+
   Options options_;
 
   // Threshold value for when to garbage collect all stale data. Above the
@@ -552,20 +848,150 @@ class KeyValueStore {
   // make it mutable.
   mutable bool error_detected_;
 
+  // Recently read values. The cache is updated by const KVS methods (such as
+  // Get), so make it mutable.
+  mutable internal::ValueCache value_cache_;
+
   struct InternalStats {
     size_t sector_erase_count;
     size_t corrupt_sectors_recovered;
     size_t missing_redundant_entries_recovered;
+    size_t unchanged_writes_skipped;
   };
   InternalStats internal_stats_;
 
+  // Updated by const KVS methods (such as Get) that verify checksums, so make
+  // it mutable.
+  mutable LatencyStats latency_stats_;
+
   uint32_t last_transaction_id_;
+
+  // Incremental garbage collection progress for MaintenanceStep.
+  struct IncrementalGc {
+    // The sector being garbage collected, or nullptr if none is in progress.
+    SectorDescriptor* sector = nullptr;
+
+    // Index of the next entry in the entry cache to relocate.
+    size_t next_entry_index = 0;
+  };
+  IncrementalGc incremental_gc_;
+
+  // Index of the next sector to verify with ScrubStep. This is not reset by
+  // Init, so a repair does not restart the scrub from the first sector.
+  size_t next_sector_to_scrub_;
 };
 
+// A list of puts and deletes to apply to a KeyValueStore as one transaction
+// with KeyValueStore::Commit. Batches are declared as instances of
+// KeyValueStore::BatchBuffer<kMaxOperations>.
+//
+// The batch refers to the caller's keys and values; they must remain valid
+// until the batch is committed or cleared.
+class KeyValueStore::Batch {
+ public:
+  Batch(const Batch&) = delete;
+  Batch& operator=(const Batch&) = delete;
+
+  // Adds a put to the batch. If the batch already contains an operation for
+  // this key, it is replaced.
+  //
+  //                    OK: the put was added to the batch
+  //    RESOURCE_EXHAUSTED: the batch is full
+  //        ALREADY_EXISTS: a different key in the batch has the same hash
+  //      INVALID_ARGUMENT: key is empty or too long
+  //
+  template <typename T,
+            typename std::enable_if_t<ConvertsToSpan<T>::value>* = nullptr>
+  Status Put(const Key& key, const T& value) {
+    return Add(key,
+               std::as_bytes(internal::make_span(value)),
+               EntryState::kValid);
+  }
+
+  template <typename T,
+            typename std::enable_if_t<!ConvertsToSpan<T>::value>* = nullptr>
+  Status Put(const Key& key, const T& value) {
+    CheckThatObjectCanBePutOrGet<T>();
+    return Add(key,
+               std::as_bytes(std::span<const T>(&value, 1)),
+               EntryState::kValid);
+  }
+
+  // Adds a delete to the batch. Returns the same statuses as Put.
+  Status Delete(Key key) { return Add(key, {}, EntryState::kDeleted); }
+
+  // Removes all operations from the batch.
+  void clear() { operations_.clear(); }
+
+  // The number of operations in the batch.
+  size_t size() const { return operations_.size(); }
+
+  bool empty() const { return operations_.empty(); }
+
+  size_t max_size() const { return operations_.max_size(); }
+
+ protected:
+  struct Operation {
+    Key key;
+    std::span<const std::byte> value;
+    EntryState state;
+
+    // Set by Commit for keys already in the KVS.
+    bool has_prior_entry;
+    size_t prior_size;
+    internal::EntryMetadata metadata;
+
+    // Set by Commit. The size of the entry, with its value as stored.
+    size_t entry_size;
+
+    // True if the value is already in the form it is stored in, so it is not
+    // compressed when it is written.
+    bool value_is_stored;
+  };
+
+  constexpr Batch(Vector<Operation>& operations) : operations_(operations) {}
+
+ private:
+  friend class KeyValueStore;
+
+  Status Add(Key key,
+             std::span<const std::byte> value,
+             EntryState state,
+             bool value_is_stored = false);
+
+  Vector<Operation>& operations_;
+};
+
+template <size_t kMaxOperations>
+class KeyValueStore::BatchBuffer : public KeyValueStore::Batch {
+ public:
+  constexpr BatchBuffer() : Batch(operations_) {}
+
+ private:
+  static_assert(kMaxOperations > 0u);
+
+  Vector<Operation, kMaxOperations> operations_;
+};
+
+// kHashIndexSlots optionally sets the number of slots in a hash index over the
+// keys, which makes key lookups O(1) instead of O(kMaxEntries) at a cost of two
+// bytes of RAM per slot. It must be 0 (no index) or a power of two larger than
+// kMaxEntries; about twice kMaxEntries is a good size.
+//
+// kValueCacheBytes optionally sets the size of a RAM cache of recently read
+// values. Each cached value uses its size plus 16 bytes of the cache.
+//
+// kKeyPrefixBytes optionally keeps the first kKeyPrefixBytes of every key in
+// RAM, at a cost of kKeyPrefixBytes + 1 bytes per entry. Iterating with
+// IteratePrefix skips non-matching keys without reading flash, and keys no
+// longer than kKeyPrefixBytes are never read from flash while iterating.
 template <size_t kMaxEntries,
           size_t kMaxUsableSectors,
           size_t kRedundancy = 1,
-          size_t kEntryFormats = 1>
+          size_t kEntryFormats = 1,
+          size_t kHashIndexSlots = 0,
+          size_t kValueCacheBytes = 0,
+          size_t kKeyPrefixBytes = 0>
 class KeyValueStoreBuffer : public KeyValueStore {
  public:
   // Constructs a KeyValueStore on the partition, with support for one
@@ -593,8 +1019,14 @@ class KeyValueStoreBuffer : public KeyValueStore {
                       kRedundancy,
                       sectors_,
                       temp_sectors_to_skip_,
+                      temp_write_results_,
                       key_descriptors_,
-                      addresses_) {
+                      addresses_,
+                      hash_index_,
+                      kHashIndexSlots,
+                      std::span(value_cache_).first(kValueCacheBytes),
+                      key_prefixes_,
+                      kKeyPrefixBytes) {
     std::copy(formats.begin(), formats.end(), formats_.begin());
   }
 
@@ -603,6 +1035,12 @@ class KeyValueStoreBuffer : public KeyValueStore {
   static_assert(kMaxUsableSectors > 0u);
   static_assert(kRedundancy > 0u);
   static_assert(kEntryFormats > 0u);
+  static_assert(internal::EntryCache::ValidHashIndexSize(kHashIndexSlots,
+                                                         kMaxEntries),
+                "kHashIndexSlots must be 0 or a power of two larger than "
+                "kMaxEntries");
+  static_assert(kKeyPrefixBytes <= internal::Entry::kMaxKeyLength,
+                "kKeyPrefixBytes cannot exceed the maximum key length");
 
   Vector<SectorDescriptor, kMaxUsableSectors> sectors_;
 
@@ -614,8 +1052,11 @@ class KeyValueStoreBuffer : public KeyValueStore {
   // maximum of 2 * kRedundancy - 1 sectors to avoid.
   const SectorDescriptor* temp_sectors_to_skip_[2 * kRedundancy - 1];
 
+  // Results of writing the kRedundancy copies of an entry.
+  StatusWithSize temp_write_results_[kRedundancy];
+
   // KeyDescriptors for use by the KVS's EntryCache.
-  Vector<KeyDescriptor, kMaxEntries> key_descriptors_;
+  internal::KeyDescriptorListBuffer<kMaxEntries> key_descriptors_;
 
   // An array of addresses associated with the KeyDescriptors for use with the
   // EntryCache. To support having KeyValueStores with different redundancies,
@@ -623,6 +1064,21 @@ class KeyValueStoreBuffer : public KeyValueStore {
   // KeyDescriptors.
   internal::EntryCache::AddressList<kRedundancy, kMaxEntries> addresses_;
 
+  // Optional hash index over the KeyDescriptors. The EntryCache initializes it
+  // in Init(). Unused if kHashIndexSlots is 0.
+  internal::EntryCache::HashIndexSlot
+      hash_index_[kHashIndexSlots == 0u ? 1 : kHashIndexSlots];
+
+  // Optional buffer for the value cache. Unused if kValueCacheBytes is 0.
+  std::byte value_cache_[kValueCacheBytes == 0u ? 1 : kValueCacheBytes];
+
+  // Optional cache of the start of each key. Unused if kKeyPrefixBytes is 0.
+  std::conditional_t<
+      kKeyPrefixBytes == 0u,
+      char[1],
+      internal::EntryCache::KeyPrefixList<kMaxEntries, kKeyPrefixBytes>>
+      key_prefixes_;
+
   // EntryFormats that can be read by this KeyValueStore.
   std::array<EntryFormat, kEntryFormats> formats_;
 };
@@ -0,0 +1,125 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw {
+namespace kvs {
+
+// The time each flash operation takes, in nanoseconds.
+struct FlashTiming {
+  // Fixed cost of each read, such as sending a command to an external flash.
+  uint32_t read_op_ns = 0;
+
+  // Cost of each byte read.
+  uint32_t read_byte_ns = 0;
+
+  // Fixed cost of each write.
+  uint32_t write_op_ns = 0;
+
+  // Flash is programmed in pages. A write costs page_program_ns for every page
+  // it touches, even if it only touches part of a page. If page_size_bytes is
+  // 0, the page size is the flash's alignment.
+  uint32_t page_size_bytes = 0;
+  uint32_t page_program_ns = 0;
+
+  // Cost of erasing each sector.
+  uint32_t sector_erase_ns = 0;
+};
+
+// A FlashMemory that passes operations through to another FlashMemory and adds
+// up the time they would take according to a FlashTiming. No time actually
+// passes; elapsed_ns() reports the modeled time. This is for measuring how
+// flash-bound code, such as the KVS, performs on a particular flash part.
+class TimedFlashMemory : public FlashMemory {
+ public:
+  // Operation counts and modeled time since the last ResetStats().
+  struct Stats {
+    uint64_t elapsed_ns;
+    size_t reads;
+    size_t bytes_read;
+    size_t writes;
+    size_t bytes_written;
+    size_t pages_programmed;
+    size_t sectors_erased;
+  };
+
+  TimedFlashMemory(FlashMemory& flash, const FlashTiming& timing)
+      : FlashMemory(flash.sector_size_bytes(),
+                    flash.sector_count(),
+                    flash.alignment_bytes(),
+                    flash.start_address(),
+                    flash.start_sector(),
+                    flash.erased_memory_content()),
+        flash_(flash),
+        timing_(timing),
+        stats_{} {}
+
+  Status Enable() override { return flash_.Enable(); }
+
+  Status Disable() override { return flash_.Disable(); }
+
+  bool IsEnabled() const override { return flash_.IsEnabled(); }
+
+  Status Erase(Address address, size_t num_sectors) override;
+
+  using FlashMemory::Read;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override;
+
+  using FlashMemory::Write;
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override;
+
+  // Models a flash that programs scatter-gather writes in one operation.
+  StatusWithSize Write(Address address,
+                       std::span<const ConstByteSpan> data) override;
+
+  // Memory-mapped reads bypass the model, as they do on real hardware.
+  std::byte* FlashAddressToMcuAddress(Address address) const override {
+    return flash_.FlashAddressToMcuAddress(address);
+  }
+
+  const FlashTiming& timing() const { return timing_; }
+
+  const Stats& stats() const { return stats_; }
+
+  // The total modeled time of all operations since the last ResetStats().
+  uint64_t elapsed_ns() const { return stats_.elapsed_ns; }
+
+  void ResetStats() { stats_ = {}; }
+
+ private:
+  size_t page_size_bytes() const {
+    return timing_.page_size_bytes != 0u ? timing_.page_size_bytes
+                                         : alignment_bytes();
+  }
+
+  void RecordWrite(Address address, size_t size);
+
+  FlashMemory& flash_;
+  const FlashTiming timing_;
+  Stats stats_;
+};
+
+}  // namespace kvs
+}  // namespace pw
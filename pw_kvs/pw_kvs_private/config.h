@@ -30,6 +30,14 @@
 static_assert((PW_KVS_MAX_FLASH_ALIGNMENT >= 16UL),
               "Max flash alignment is required to be at least 16");
 
+// Whether the KVS times writes, inline garbage collection, and checksums, as
+// reported by KeyValueStore::latency_stats(). Timing uses pw_chrono's
+// SystemClock, so the config target must depend on a system clock backend when
+// this is enabled.
+#ifndef PW_KVS_RECORD_LATENCY_STATS
+#define PW_KVS_RECORD_LATENCY_STATS 0
+#endif  // PW_KVS_RECORD_LATENCY_STATS
+
 namespace pw::kvs {
 
 inline constexpr size_t kMaxFlashAlignment = PW_KVS_MAX_FLASH_ALIGNMENT;
@@ -0,0 +1,114 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/key_value_store_service.h"
+
+#include <cstring>
+
+#include "pw_kvs_protos/key_value_store_service.pwpb.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_varint/varint.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr uint32_t kEntriesKey =
+    protobuf::MakeKey(static_cast<uint32_t>(RawEntries::Fields::ENTRIES),
+                      protobuf::WireType::kDelimited);
+
+}  // namespace
+
+void KeyValueStoreService::Export(ServerContext&,
+                                  ConstByteSpan,
+                                  rpc::RawServerWriter& writer) {
+  KeyValueStore::iterator it = kvs_.begin();
+
+  while (it != kvs_.end()) {
+    // The entries are read directly into the payload buffer, after room for
+    // the largest possible field key and length.
+    const ByteSpan payload = writer.PayloadBuffer();
+    const size_t reserved =
+        varint::EncodedSize(kEntriesKey) + varint::EncodedSize(payload.size());
+    if (payload.size() <= reserved) {
+      writer.Finish(Status::ResourceExhausted());
+      return;
+    }
+    const ByteSpan entries = payload.subspan(reserved);
+
+    size_t entries_size = 0;
+    for (; it != kvs_.end(); ++it) {
+      const StatusWithSize result =
+          (*it).ReadRawEntry(entries.subspan(entries_size));
+
+      // An entry that does not fit starts the next response.
+      if (result.IsResourceExhausted() && entries_size != 0u) {
+        break;
+      }
+      if (!result.ok()) {
+        writer.Finish(result.status());
+        return;
+      }
+      entries_size += result.size();
+    }
+
+    // Encode the field key and length, then move the entries down if the
+    // length took fewer bytes than were reserved for it.
+    size_t header_size = varint::Encode(kEntriesKey, payload);
+    header_size += varint::Encode(entries_size, payload.subspan(header_size));
+    std::memmove(payload.data() + header_size, entries.data(), entries_size);
+
+    const Status status =
+        writer.Write(payload.first(header_size + entries_size));
+    if (!status.ok()) {
+      writer.Finish(status);
+      return;
+    }
+  }
+
+  writer.Finish();
+}
+
+StatusWithSize KeyValueStoreService::Import(ServerContext&,
+                                            ConstByteSpan request,
+                                            ByteSpan response) {
+  ConstByteSpan entries;
+  protobuf::Decoder decoder(request);
+  while (decoder.Next().ok()) {
+    if (static_cast<RawEntries::Fields>(decoder.FieldNumber()) ==
+        RawEntries::Fields::ENTRIES) {
+      if (!decoder.ReadBytes(&entries).ok()) {
+        return StatusWithSize::InvalidArgument();
+      }
+    }
+  }
+
+  const StatusWithSize imported = kvs_.ImportRawEntries(entries, import_batch_);
+  if (!imported.ok()) {
+    return StatusWithSize(imported.status(), 0);
+  }
+
+  protobuf::NestedEncoder encoder(response);
+  ImportResponse::Encoder import_response(&encoder);
+  import_response.WriteEntriesImported(imported.size());
+
+  const Result<ConstByteSpan> encoded = encoder.Encode();
+  if (!encoded.ok()) {
+    return StatusWithSize(encoded.status(), 0);
+  }
+  return StatusWithSize(encoded.value().size());
+}
+
+}  // namespace pw::kvs
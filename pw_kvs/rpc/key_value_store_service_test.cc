@@ -0,0 +1,172 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/key_value_store_service.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs_protos/key_value_store_service.pwpb.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_rpc/raw_test_method_context.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kMaxEntries = 32;
+constexpr size_t kMaxUsableSectors = 4;
+
+ChecksumCrc16 checksum;
+
+// For KVS magic value always use a random 32 bit integer rather than a
+// human readable 4 bytes. See pw_kvs/format.h for more information.
+constexpr EntryFormat kFormat{.magic = 0x5b9e0c27, .checksum = &checksum};
+
+constexpr const char* kKeys[] = {"one", "two", "three", "four", "five"};
+
+class KeyValueStoreServiceTest : public ::testing::Test {
+ protected:
+  KeyValueStoreServiceTest()
+      : source_flash_(16),
+        source_partition_(&source_flash_),
+        source_(&source_partition_, kFormat),
+        destination_flash_(16),
+        destination_partition_(&destination_flash_),
+        destination_(&destination_partition_, kFormat) {
+    EXPECT_EQ(OkStatus(), source_partition_.Erase());
+    EXPECT_EQ(OkStatus(), source_.Init());
+    EXPECT_EQ(OkStatus(), destination_partition_.Erase());
+    EXPECT_EQ(OkStatus(), destination_.Init());
+  }
+
+  // Appends the entries in an encoded RawEntries message to exported_.
+  void AppendEntries(ConstByteSpan response) {
+    protobuf::Decoder decoder(response);
+    ASSERT_EQ(OkStatus(), decoder.Next());
+    ConstByteSpan entries;
+    ASSERT_EQ(OkStatus(), decoder.ReadBytes(&entries));
+    ASSERT_LE(exported_size_ + entries.size(), exported_.size());
+    std::memcpy(&exported_[exported_size_], entries.data(), entries.size());
+    exported_size_ += entries.size();
+  }
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> source_flash_;
+  FlashPartition source_partition_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> source_;
+
+  FakeFlashMemoryBuffer<512, kMaxUsableSectors> destination_flash_;
+  FlashPartition destination_partition_;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> destination_;
+
+  std::array<std::byte, 512> exported_;
+  size_t exported_size_ = 0;
+};
+
+TEST_F(KeyValueStoreServiceTest, Export_Empty) {
+  KeyValueStore::BatchBuffer<1> batch;
+  PW_RAW_TEST_METHOD_CONTEXT(KeyValueStoreService, Export)
+  context(source_, batch);
+  context.call({});
+
+  ASSERT_TRUE(context.done());
+  EXPECT_EQ(OkStatus(), context.status());
+  EXPECT_EQ(0u, context.total_responses());
+}
+
+TEST_F(KeyValueStoreServiceTest, ExportThenImport_CopiesEveryEntry) {
+  for (uint32_t i = 0; i < std::size(kKeys); ++i) {
+    ASSERT_EQ(OkStatus(), source_.Put(kKeys[i], i));
+  }
+
+  KeyValueStore::BatchBuffer<1> unused_batch;
+  PW_RAW_TEST_METHOD_CONTEXT(KeyValueStoreService, Export, 8)
+  export_context(source_, unused_batch);
+  export_context.call({});
+
+  ASSERT_TRUE(export_context.done());
+  ASSERT_EQ(OkStatus(), export_context.status());
+
+  // Several entries are packed into each response.
+  EXPECT_GT(export_context.total_responses(), 1u);
+  EXPECT_LT(export_context.total_responses(), std::size(kKeys));
+  for (ConstByteSpan response : export_context.responses()) {
+    AppendEntries(response);
+  }
+
+  std::array<std::byte, 512> request;
+  protobuf::NestedEncoder encoder(request);
+  RawEntries::Encoder raw_entries(&encoder);
+  raw_entries.WriteEntries(std::span(exported_).first(exported_size_));
+
+  KeyValueStore::BatchBuffer<8> batch;
+  PW_RAW_TEST_METHOD_CONTEXT(KeyValueStoreService, Import)
+  import_context(destination_, batch);
+  ASSERT_EQ(OkStatus(), import_context.call(encoder.Encode().value()).status());
+
+  protobuf::Decoder decoder(import_context.response());
+  ASSERT_EQ(OkStatus(), decoder.Next());
+  uint32_t imported = 0;
+  ASSERT_EQ(OkStatus(), decoder.ReadUint32(&imported));
+  EXPECT_EQ(std::size(kKeys), imported);
+
+  EXPECT_EQ(std::size(kKeys), destination_.size());
+  EXPECT_EQ(1u, destination_.transaction_count());
+  for (uint32_t i = 0; i < std::size(kKeys); ++i) {
+    uint32_t value = 0;
+    ASSERT_EQ(OkStatus(), destination_.Get(kKeys[i], &value));
+    EXPECT_EQ(i, value);
+  }
+}
+
+TEST_F(KeyValueStoreServiceTest, Export_EntryLargerThanResponse) {
+  std::array<std::byte, 200> value{};
+  ASSERT_EQ(OkStatus(), source_.Put("big", value));
+
+  KeyValueStore::BatchBuffer<1> batch;
+  PW_RAW_TEST_METHOD_CONTEXT(KeyValueStoreService, Export)
+  context(source_, batch);
+  context.call({});
+
+  ASSERT_TRUE(context.done());
+  EXPECT_EQ(Status::ResourceExhausted(), context.status());
+  EXPECT_EQ(0u, context.total_responses());
+}
+
+TEST_F(KeyValueStoreServiceTest, Import_CorruptEntries) {
+  ASSERT_EQ(OkStatus(), source_.Put("key", uint32_t(1)));
+  for (const KeyValueStore::Item& item : source_) {
+    exported_size_ = item.ReadRawEntry(exported_).size();
+  }
+  exported_[sizeof(internal::EntryHeader)] ^= std::byte{0x01};
+
+  std::array<std::byte, 64> request;
+  protobuf::NestedEncoder encoder(request);
+  RawEntries::Encoder raw_entries(&encoder);
+  raw_entries.WriteEntries(std::span(exported_).first(exported_size_));
+
+  KeyValueStore::BatchBuffer<1> batch;
+  PW_RAW_TEST_METHOD_CONTEXT(KeyValueStoreService, Import)
+  context(destination_, batch);
+  EXPECT_EQ(Status::DataLoss(),
+            context.call(encoder.Encode().value()).status());
+  EXPECT_EQ(0u, destination_.size());
+}
+
+}  // namespace
+}  // namespace pw::kvs
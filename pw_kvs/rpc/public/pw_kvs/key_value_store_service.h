@@ -0,0 +1,68 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_bytes/span.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_kvs_protos/key_value_store_service.raw_rpc.pb.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::kvs {
+
+// RPC service for backing up and provisioning a KeyValueStore in bulk, instead
+// of with one RPC per key. Entries are transferred in the raw format in which
+// they are stored in flash, so they are neither decoded nor re-encoded.
+//
+// Export() streams every entry in the KVS, packing as many whole entries into
+// each response as fit. It finishes with RESOURCE_EXHAUSTED if an entry does
+// not fit in an empty response.
+//
+// Import() writes the entries in one request as a single batch with
+// KeyValueStore::ImportRawEntries, so a request is applied entirely or not at
+// all. The entries in a request must fit in the batch and in one sector; a
+// large import is split across several requests.
+//
+// The KVS must not be modified by other threads during an export or import.
+class KeyValueStoreService final
+    : public generated::KeyValueStoreService<KeyValueStoreService> {
+ public:
+  KeyValueStoreService(KeyValueStore& kvs, KeyValueStore::Batch& import_batch)
+      : kvs_(kvs), import_batch_(import_batch) {}
+
+  void Export(ServerContext&, ConstByteSpan, rpc::RawServerWriter& writer);
+
+  StatusWithSize Import(ServerContext&,
+                        ConstByteSpan request,
+                        ByteSpan response);
+
+ private:
+  KeyValueStore& kvs_;
+  KeyValueStore::Batch& import_batch_;
+};
+
+// Allocates a batch for imports of up to kMaxImportEntries entries per request
+// along with the service.
+template <size_t kMaxImportEntries>
+class KeyValueStoreServiceBuffer {
+ public:
+  KeyValueStoreServiceBuffer(KeyValueStore& kvs) : service_(kvs, batch_) {}
+
+  KeyValueStoreService& service() { return service_; }
+
+ private:
+  KeyValueStore::BatchBuffer<kMaxImportEntries> batch_;
+  KeyValueStoreService service_;
+};
+
+}  // namespace pw::kvs
@@ -31,15 +31,50 @@ bool Contains(const Container& container, const T& value) {
          std::end(container);
 }
 
+// Returns true if a sector is a better candidate than the current one: it has
+// a higher score, or the same score and fewer erases.
+bool IsBetterCandidate(const SectorDescriptor& sector,
+                       size_t score,
+                       const SectorDescriptor* candidate,
+                       size_t candidate_score) {
+  if (candidate == nullptr) {
+    return true;
+  }
+  if (score != candidate_score) {
+    return score > candidate_score;
+  }
+  return sector.erase_count() < candidate->erase_count();
+}
+
 }  // namespace
 
+Status Sectors::FindSpace(SectorDescriptor** found_sector,
+                          size_t size,
+                          std::span<const Address> reserved_addresses) {
+  if (!reserved_addresses.empty() &&
+      partition_.bank(0) != partition_.bank(partition_.size_bytes() - 1)) {
+    if (Find(kAppendEntry,
+             found_sector,
+             size,
+             {},
+             reserved_addresses,
+             kOtherBanks)
+            .ok()) {
+      return OkStatus();
+    }
+    DBG("  No space in other banks; allowing any bank");
+  }
+  return Find(kAppendEntry, found_sector, size, {}, reserved_addresses);
+}
+
 Status Sectors::Find(FindMode find_mode,
                      SectorDescriptor** found_sector,
                      size_t size,
                      std::span<const Address> addresses_to_skip,
-                     std::span<const Address> reserved_addresses) {
-  SectorDescriptor* first_empty_sector = nullptr;
-  bool at_least_two_empty_sectors = (find_mode == kGarbageCollect);
+                     std::span<const Address> reserved_addresses,
+                     BankMode bank_mode) {
+  SectorDescriptor* least_erased_empty_sector = nullptr;
+  size_t empty_sectors = 0;
 
   // Used for the GC reclaimable bytes check
   SectorDescriptor* non_empty_least_reclaimable_sector = nullptr;
@@ -88,8 +123,9 @@ Status Sectors::Find(FindMode find_mode,
   // sector that is found.
   //
   // Tier 2 is find sectors that are empty/erased. While scanning for a partial
-  // sector, keep track of the first empty sector and if a second empty sector
-  // was seen. If during GC then count the second empty sector as always seen.
+  // sector, keep track of the empty sector with the fewest erases (the first
+  // one found if there is a tie) and if a second empty sector was seen. If
+  // during GC then count the second empty sector as always seen.
   //
   // Tier 3 is during garbage collection, find sectors with enough space that
   // are not empty but have recoverable bytes. Pick the sector with the least
@@ -106,7 +142,13 @@ Status Sectors::Find(FindMode find_mode,
       continue;
     }
 
-    if (!sector->Empty(sector_size_bytes) && sector->HasSpace(size)) {
+    // Sectors in the banks to avoid are not used, but still count as empty
+    // sectors for the 1 empty sector invariant.
+    const bool usable_bank = bank_mode == kAnyBank ||
+                             !InSameBank(*sector, reserved_addresses);
+
+    if (usable_bank && !sector->Empty(sector_size_bytes) &&
+        sector->HasSpace(size)) {
       if ((find_mode == kAppendEntry) ||
           (sector->RecoverableBytes(sector_size_bytes) == 0)) {
         *found_sector = sector;
@@ -122,23 +164,27 @@ Status Sectors::Find(FindMode find_mode,
     }
 
     if (sector->Empty(sector_size_bytes)) {
-      if (first_empty_sector == nullptr) {
-        first_empty_sector = sector;
-      } else {
-        at_least_two_empty_sectors = true;
+      empty_sectors += 1;
+      if (usable_bank && (least_erased_empty_sector == nullptr ||
+                          sector->erase_count() <
+                              least_erased_empty_sector->erase_count())) {
+        least_erased_empty_sector = sector;
       }
     }
   }
 
+  const bool at_least_two_empty_sectors =
+      find_mode == kGarbageCollect || empty_sectors >= 2u;
+
   // Tier 2 check: If the scan for a partial sector does not find a suitable
-  // sector, use the first empty sector that was found. Normally it is required
+  // sector, use the least erased empty sector. Normally it is required
   // to keep 1 empty sector after the sector found here, but that rule does not
   // apply during GC.
-  if (first_empty_sector != nullptr && at_least_two_empty_sectors) {
-    DBG("  Found a usable empty sector; returning the first found (%u)",
-        Index(first_empty_sector));
-    last_new_ = first_empty_sector;
-    *found_sector = first_empty_sector;
+  if (least_erased_empty_sector != nullptr && at_least_two_empty_sectors) {
+    DBG("  Found a usable empty sector; returning the least erased (%u)",
+        Index(least_erased_empty_sector));
+    last_new_ = least_erased_empty_sector;
+    *found_sector = least_erased_empty_sector;
     return OkStatus();
   }
 
@@ -158,16 +204,24 @@ Status Sectors::Find(FindMode find_mode,
   return Status::ResourceExhausted();
 }
 
+bool Sectors::InSameBank(const SectorDescriptor& sector,
+                         std::span<const Address> addresses) const {
+  const size_t sector_bank = partition_.bank(BaseAddress(sector));
+  for (Address address : addresses) {
+    if (partition_.bank(address) == sector_bank) {
+      return true;
+    }
+  }
+  return false;
+}
+
 SectorDescriptor& Sectors::WearLeveledSectorFromIndex(size_t idx) const {
   return descriptors_[(Index(last_new_) + 1 + idx) % descriptors_.size()];
 }
 
-// TODO: Consider breaking this function into smaller sub-chunks.
 SectorDescriptor* Sectors::FindSectorToGarbageCollect(
     std::span<const Address> reserved_addresses) const {
   const size_t sector_size_bytes = partition_.sector_size_bytes();
-  SectorDescriptor* sector_candidate = nullptr;
-  size_t candidate_bytes = 0;
 
   // Build a vector of sectors to avoid.
   for (size_t i = 0; i < reserved_addresses.size(); ++i) {
@@ -177,50 +231,66 @@ SectorDescriptor* Sectors::FindSectorToGarbageCollect(
   const std::span sectors_to_skip(temp_sectors_to_skip_,
                                   reserved_addresses.size());
 
+  // The candidates for each of the steps below are found in a single pass.
+  //
   // Step 1: Try to find a sectors with stale keys and no valid keys (no
-  // relocation needed). Use the first such sector found, as that will help the
-  // KVS "rotate" around the partition. Initially this would select the sector
-  // with the most reclaimable space, but that can cause GC sector selection to
-  // "ping-pong" between two sectors when updating large keys.
-  for (size_t i = 0; i < descriptors_.size(); ++i) {
-    SectorDescriptor& sector = WearLeveledSectorFromIndex(i);
-    if ((sector.valid_bytes() == 0) &&
-        (sector.RecoverableBytes(sector_size_bytes) > 0) &&
-        !Contains(sectors_to_skip, &sector)) {
-      sector_candidate = &sector;
-      break;
-    }
-  }
+  // relocation needed). Use the least erased such sector, starting from the
+  // last new sector, as that will help the KVS "rotate" around the partition.
+  // Initially this would select the sector with the most reclaimable space,
+  // but that can cause GC sector selection to "ping-pong" between two sectors
+  // when updating large keys.
+  SectorDescriptor* stale_candidate = nullptr;
 
   // Step 2: If step 1 yields no sectors, just find the sector with the most
   // reclaimable bytes but no addresses to avoid.
-  if (sector_candidate == nullptr) {
-    for (size_t i = 0; i < descriptors_.size(); ++i) {
-      SectorDescriptor& sector = WearLeveledSectorFromIndex(i);
-      if ((sector.RecoverableBytes(sector_size_bytes) > candidate_bytes) &&
-          !Contains(sectors_to_skip, &sector)) {
-        sector_candidate = &sector;
-        candidate_bytes = sector.RecoverableBytes(sector_size_bytes);
-      }
-    }
-  }
+  SectorDescriptor* recoverable_candidate = nullptr;
+  size_t most_recoverable_bytes = 0;
 
   // Step 3: If no sectors with reclaimable bytes, select the sector with the
   // most free bytes. This at least will allow entries of existing keys to get
   // spread to other sectors, including sectors that already have copies of the
   // current key being written.
-  if (sector_candidate == nullptr) {
-    for (size_t i = 0; i < descriptors_.size(); ++i) {
-      SectorDescriptor& sector = WearLeveledSectorFromIndex(i);
-      if ((sector.valid_bytes() > candidate_bytes) &&
-          !Contains(sectors_to_skip, &sector)) {
-        sector_candidate = &sector;
-        candidate_bytes = sector.valid_bytes();
-        DBG("    Doing GC on sector with no reclaimable bytes!");
+  SectorDescriptor* valid_candidate = nullptr;
+  size_t most_valid_bytes = 0;
+
+  for (size_t i = 0; i < descriptors_.size(); ++i) {
+    SectorDescriptor& sector = WearLeveledSectorFromIndex(i);
+    if (Contains(sectors_to_skip, &sector)) {
+      continue;
+    }
+
+    const size_t recoverable_bytes = sector.RecoverableBytes(sector_size_bytes);
+    if (recoverable_bytes > 0) {
+      if (sector.valid_bytes() == 0 &&
+          IsBetterCandidate(sector, 0, stale_candidate, 0)) {
+        stale_candidate = &sector;
+      }
+      if (IsBetterCandidate(sector,
+                            recoverable_bytes,
+                            recoverable_candidate,
+                            most_recoverable_bytes)) {
+        recoverable_candidate = &sector;
+        most_recoverable_bytes = recoverable_bytes;
       }
+    } else if (sector.valid_bytes() > 0 &&
+               IsBetterCandidate(sector,
+                                 sector.valid_bytes(),
+                                 valid_candidate,
+                                 most_valid_bytes)) {
+      valid_candidate = &sector;
+      most_valid_bytes = sector.valid_bytes();
     }
   }
 
+  SectorDescriptor* sector_candidate = stale_candidate;
+  if (sector_candidate == nullptr) {
+    sector_candidate = recoverable_candidate;
+  }
+  if (sector_candidate == nullptr && valid_candidate != nullptr) {
+    DBG("    Doing GC on sector with no reclaimable bytes!");
+    sector_candidate = valid_candidate;
+  }
+
   if (sector_candidate != nullptr) {
     DBG("Found sector %u to Garbage Collect, %u recoverable bytes",
         Index(sector_candidate),
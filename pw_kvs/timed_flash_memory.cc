@@ -0,0 +1,66 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/timed_flash_memory.h"
+
+namespace pw::kvs {
+
+// Operations are timed whether or not they succeed, since a failed operation
+// still occupies the flash.
+Status TimedFlashMemory::Erase(Address address, size_t num_sectors) {
+  stats_.sectors_erased += num_sectors;
+  stats_.elapsed_ns += uint64_t(timing_.sector_erase_ns) * num_sectors;
+  return flash_.Erase(address, num_sectors);
+}
+
+StatusWithSize TimedFlashMemory::Read(Address address,
+                                      std::span<std::byte> output) {
+  stats_.reads += 1;
+  stats_.bytes_read += output.size();
+  stats_.elapsed_ns +=
+      timing_.read_op_ns + uint64_t(timing_.read_byte_ns) * output.size();
+  return flash_.Read(address, output);
+}
+
+StatusWithSize TimedFlashMemory::Write(Address address,
+                                       std::span<const std::byte> data) {
+  RecordWrite(address, data.size());
+  return flash_.Write(address, data);
+}
+
+StatusWithSize TimedFlashMemory::Write(Address address,
+                                       std::span<const ConstByteSpan> data) {
+  size_t size = 0;
+  for (const ConstByteSpan& chunk : data) {
+    size += chunk.size();
+  }
+  RecordWrite(address, size);
+  return flash_.Write(address, data);
+}
+
+void TimedFlashMemory::RecordWrite(Address address, size_t size) {
+  const size_t page_size = page_size_bytes();
+  const size_t pages =
+      size == 0u
+          ? 0
+          : (address + size - 1) / page_size - address / page_size + 1;
+
+  stats_.writes += 1;
+  stats_.bytes_written += size;
+  stats_.pages_programmed += pages;
+  stats_.elapsed_ns +=
+      timing_.write_op_ns + uint64_t(timing_.page_program_ns) * pages;
+}
+
+}  // namespace pw::kvs
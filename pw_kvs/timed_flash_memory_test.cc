@@ -0,0 +1,107 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/timed_flash_memory.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr FlashTiming kTiming{
+    .read_op_ns = 100,
+    .read_byte_ns = 2,
+    .write_op_ns = 50,
+    .page_size_bytes = 64,
+    .page_program_ns = 1000,
+    .sector_erase_ns = 20000,
+};
+
+class TimedFlash : public ::testing::Test {
+ protected:
+  TimedFlash() : fake_flash_(16), flash_(fake_flash_, kTiming) {}
+
+  FakeFlashMemoryBuffer<512, 4> fake_flash_;
+  TimedFlashMemory flash_;
+};
+
+TEST_F(TimedFlash, MatchesWrappedFlash) {
+  EXPECT_EQ(512u, flash_.sector_size_bytes());
+  EXPECT_EQ(4u, flash_.sector_count());
+  EXPECT_EQ(16u, flash_.alignment_bytes());
+}
+
+TEST_F(TimedFlash, Read) {
+  std::array<std::byte, 32> data;
+  ASSERT_EQ(OkStatus(), flash_.Read(0, data).status());
+  ASSERT_EQ(OkStatus(), flash_.Read(32, data).status());
+
+  EXPECT_EQ(2 * (100u + 2u * 32u), flash_.elapsed_ns());
+  EXPECT_EQ(2u, flash_.stats().reads);
+  EXPECT_EQ(64u, flash_.stats().bytes_read);
+}
+
+TEST_F(TimedFlash, Write_ChargesEveryPageTouched) {
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1));
+  flash_.ResetStats();
+
+  std::array<std::byte, 32> data{};
+  ASSERT_EQ(OkStatus(), flash_.Write(0, data).status());  // Page 0
+  EXPECT_EQ(50u + 1000u, flash_.elapsed_ns());
+
+  ASSERT_EQ(OkStatus(), flash_.Write(48, data).status());  // Pages 0 and 1
+  EXPECT_EQ(2 * 50u + 3 * 1000u, flash_.elapsed_ns());
+
+  EXPECT_EQ(2u, flash_.stats().writes);
+  EXPECT_EQ(64u, flash_.stats().bytes_written);
+  EXPECT_EQ(3u, flash_.stats().pages_programmed);
+}
+
+TEST_F(TimedFlash, Write_DefaultPageSizeIsAlignment) {
+  TimedFlashMemory flash(fake_flash_, {.page_program_ns = 10});
+  ASSERT_EQ(OkStatus(), flash.Erase(0, 1));
+
+  std::array<std::byte, 48> data{};
+  ASSERT_EQ(OkStatus(), flash.Write(0, data).status());
+  EXPECT_EQ(3u, flash.stats().pages_programmed);
+  EXPECT_EQ(30u, flash.elapsed_ns());
+}
+
+TEST_F(TimedFlash, Erase) {
+  ASSERT_EQ(OkStatus(), flash_.Erase(512, 2));
+  EXPECT_EQ(2 * 20000u, flash_.elapsed_ns());
+  EXPECT_EQ(2u, flash_.stats().sectors_erased);
+
+  flash_.ResetStats();
+  EXPECT_EQ(0u, flash_.elapsed_ns());
+  EXPECT_EQ(0u, flash_.stats().sectors_erased);
+}
+
+TEST_F(TimedFlash, OperationsReachWrappedFlash) {
+  ASSERT_EQ(OkStatus(), flash_.Erase(0, 1));
+  std::array<std::byte, 16> data;
+  data.fill(std::byte{0x3c});
+  ASSERT_EQ(OkStatus(), flash_.Write(16, data).status());
+  EXPECT_EQ(std::byte{0x3c}, fake_flash_.buffer()[16]);
+
+  std::array<std::byte, 16> read{};
+  ASSERT_EQ(OkStatus(), flash_.Read(16, read).status());
+  EXPECT_EQ(data, read);
+}
+
+}  // namespace
+}  // namespace pw::kvs
@@ -0,0 +1,160 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/internal/value_cache.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace pw::kvs::internal {
+
+StatusWithSize ValueCache::Get(uint32_t key_hash,
+                               uint32_t transaction_id,
+                               std::span<std::byte> value_buffer,
+                               size_t offset_bytes) {
+  if (!enabled()) {
+    return StatusWithSize::NotFound();
+  }
+
+  const size_t offset = Find(key_hash);
+  if (offset == used_bytes_) {
+    misses_ += 1;
+    return StatusWithSize::NotFound();
+  }
+
+  Header header = ReadHeader(offset);
+  if (header.transaction_id != transaction_id) {
+    // The key was rewritten without the cache seeing it; drop the old value.
+    RemoveAt(offset);
+    misses_ += 1;
+    return StatusWithSize::NotFound();
+  }
+
+  hits_ += 1;
+  header.last_use = NextUse();
+  WriteHeader(offset, header);
+
+  if (offset_bytes > header.value_size) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  const size_t remaining_bytes = header.value_size - offset_bytes;
+  const size_t read_size = std::min(value_buffer.size(), remaining_bytes);
+  std::memcpy(value_buffer.data(),
+              &buffer_[offset + sizeof(Header) + offset_bytes],
+              read_size);
+
+  if (read_size != remaining_bytes) {
+    return StatusWithSize::ResourceExhausted(read_size);
+  }
+  return StatusWithSize(read_size);
+}
+
+StatusWithSize ValueCache::ValueSize(uint32_t key_hash,
+                                     uint32_t transaction_id) const {
+  const size_t offset = Find(key_hash);
+  if (offset == used_bytes_) {
+    return StatusWithSize::NotFound();
+  }
+
+  const Header header = ReadHeader(offset);
+  if (header.transaction_id != transaction_id) {
+    return StatusWithSize::NotFound();
+  }
+  return StatusWithSize(header.value_size);
+}
+
+void ValueCache::Put(uint32_t key_hash,
+                     uint32_t transaction_id,
+                     std::span<const std::byte> value) {
+  Remove(key_hash);
+
+  const size_t record_size = RecordSize(value.size());
+  if (record_size > buffer_.size()) {
+    return;
+  }
+
+  while (used_bytes_ + record_size > buffer_.size()) {
+    EvictLeastRecentlyUsed();
+  }
+
+  WriteHeader(used_bytes_,
+              Header{.key_hash = key_hash,
+                     .transaction_id = transaction_id,
+                     .value_size = static_cast<uint32_t>(value.size()),
+                     .last_use = NextUse()});
+  std::memcpy(
+      &buffer_[used_bytes_ + sizeof(Header)], value.data(), value.size());
+  used_bytes_ += record_size;
+}
+
+void ValueCache::Remove(uint32_t key_hash) {
+  const size_t offset = Find(key_hash);
+  if (offset != used_bytes_) {
+    RemoveAt(offset);
+  }
+}
+
+size_t ValueCache::Find(uint32_t key_hash) const {
+  size_t offset = 0;
+  while (offset < used_bytes_) {
+    const Header header = ReadHeader(offset);
+    if (header.key_hash == key_hash) {
+      return offset;
+    }
+    offset += RecordSize(header.value_size);
+  }
+  return used_bytes_;
+}
+
+// Headers are copied in and out of the buffer, since records are not aligned.
+ValueCache::Header ValueCache::ReadHeader(size_t offset) const {
+  Header header;
+  std::memcpy(&header, &buffer_[offset], sizeof(header));
+  return header;
+}
+
+void ValueCache::WriteHeader(size_t offset, const Header& header) {
+  std::memcpy(&buffer_[offset], &header, sizeof(header));
+}
+
+// Removes a record by moving the records after it down, which keeps the free
+// space in one contiguous block at the end of the buffer.
+void ValueCache::RemoveAt(size_t offset) {
+  const size_t record_size = RecordSize(ReadHeader(offset).value_size);
+  const size_t next = offset + record_size;
+  std::memmove(&buffer_[offset], &buffer_[next], used_bytes_ - next);
+  used_bytes_ -= record_size;
+}
+
+void ValueCache::EvictLeastRecentlyUsed() {
+  size_t oldest_offset = 0;
+  uint32_t oldest_age = 0;
+
+  for (size_t offset = 0; offset < used_bytes_;) {
+    const Header header = ReadHeader(offset);
+    // Ages are computed with unsigned arithmetic, so they are correct even if
+    // the use counter wraps around.
+    const uint32_t age = last_use_ - header.last_use;
+    if (age >= oldest_age) {
+      oldest_age = age;
+      oldest_offset = offset;
+    }
+    offset += RecordSize(header.value_size);
+  }
+
+  RemoveAt(oldest_offset);
+}
+
+}  // namespace pw::kvs::internal
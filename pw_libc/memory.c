@@ -0,0 +1,225 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_libc/memory.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Words are accessed through types that may alias any object. UnalignedWord
+// allows loads from addresses that are not word aligned.
+typedef uint32_t Word __attribute__((may_alias));
+typedef uint32_t UnalignedWord __attribute__((may_alias, aligned(1)));
+
+// Regions shorter than this are handled a byte at a time, since aligning them
+// costs more than it saves.
+#define SMALL_SIZE 16u
+
+// Placed in loops to keep the compiler from replacing them with calls to the
+// very functions they implement, which would recurse once these functions are
+// linked as memcpy and friends. It does not otherwise affect code generation.
+#define PREVENT_LIBCALL() __asm__ volatile("")
+
+static inline bool IsWordAligned(const void* address) {
+  return ((uintptr_t)address % sizeof(Word)) == 0u;
+}
+
+// Copies forward. This is also correct for overlapping regions when dest is
+// below src, since every word is read before any write that could overlap it.
+static void CopyForward(unsigned char* dest,
+                        const unsigned char* src,
+                        size_t size) {
+  if (size >= SMALL_SIZE) {
+    while (!IsWordAligned(dest)) {
+      *dest++ = *src++;
+      size -= 1;
+    }
+
+    Word* dest_words = (Word*)dest;
+    if (IsWordAligned(src)) {
+      const Word* src_words = (const Word*)src;
+      for (; size >= 4 * sizeof(Word); size -= 4 * sizeof(Word)) {
+        const Word w0 = src_words[0];
+        const Word w1 = src_words[1];
+        const Word w2 = src_words[2];
+        const Word w3 = src_words[3];
+        dest_words[0] = w0;
+        dest_words[1] = w1;
+        dest_words[2] = w2;
+        dest_words[3] = w3;
+        dest_words += 4;
+        src_words += 4;
+        PREVENT_LIBCALL();
+      }
+      for (; size >= sizeof(Word); size -= sizeof(Word)) {
+        *dest_words++ = *src_words++;
+      }
+      src = (const unsigned char*)src_words;
+    } else {
+      const UnalignedWord* src_words = (const UnalignedWord*)src;
+      for (; size >= 4 * sizeof(Word); size -= 4 * sizeof(Word)) {
+        const Word w0 = src_words[0];
+        const Word w1 = src_words[1];
+        const Word w2 = src_words[2];
+        const Word w3 = src_words[3];
+        dest_words[0] = w0;
+        dest_words[1] = w1;
+        dest_words[2] = w2;
+        dest_words[3] = w3;
+        dest_words += 4;
+        src_words += 4;
+        PREVENT_LIBCALL();
+      }
+      for (; size >= sizeof(Word); size -= sizeof(Word)) {
+        *dest_words++ = *src_words++;
+      }
+      src = (const unsigned char*)src_words;
+    }
+    dest = (unsigned char*)dest_words;
+  }
+
+  for (; size > 0u; size -= 1) {
+    *dest++ = *src++;
+    PREVENT_LIBCALL();
+  }
+}
+
+// Copies backward, for overlapping regions where dest is above src. The
+// pointers start one past the end of each region.
+static void CopyBackward(unsigned char* dest_end,
+                         const unsigned char* src_end,
+                         size_t size) {
+  if (size >= SMALL_SIZE) {
+    while (!IsWordAligned(dest_end)) {
+      *--dest_end = *--src_end;
+      size -= 1;
+    }
+
+    Word* dest_words = (Word*)dest_end;
+    const UnalignedWord* src_words = (const UnalignedWord*)src_end;
+    for (; size >= 4 * sizeof(Word); size -= 4 * sizeof(Word)) {
+      dest_words -= 4;
+      src_words -= 4;
+      const Word w3 = src_words[3];
+      const Word w2 = src_words[2];
+      const Word w1 = src_words[1];
+      const Word w0 = src_words[0];
+      dest_words[3] = w3;
+      dest_words[2] = w2;
+      dest_words[1] = w1;
+      dest_words[0] = w0;
+      PREVENT_LIBCALL();
+    }
+    for (; size >= sizeof(Word); size -= sizeof(Word)) {
+      *--dest_words = *--src_words;
+    }
+    dest_end = (unsigned char*)dest_words;
+    src_end = (const unsigned char*)src_words;
+  }
+
+  for (; size > 0u; size -= 1) {
+    *--dest_end = *--src_end;
+    PREVENT_LIBCALL();
+  }
+}
+
+void* pw_libc_Memcpy(void* dest, const void* src, size_t size) {
+  CopyForward((unsigned char*)dest, (const unsigned char*)src, size);
+  return dest;
+}
+
+void* pw_libc_Memmove(void* dest, const void* src, size_t size) {
+  unsigned char* const dest_bytes = (unsigned char*)dest;
+  const unsigned char* const src_bytes = (const unsigned char*)src;
+
+  // Copy backward only if dest starts within the source region.
+  if ((uintptr_t)dest_bytes - (uintptr_t)src_bytes < size) {
+    CopyBackward(dest_bytes + size, src_bytes + size, size);
+  } else {
+    CopyForward(dest_bytes, src_bytes, size);
+  }
+  return dest;
+}
+
+void* pw_libc_Memset(void* dest, int value, size_t size) {
+  unsigned char* bytes = (unsigned char*)dest;
+  const unsigned char byte = (unsigned char)value;
+
+  if (size >= SMALL_SIZE) {
+    while (!IsWordAligned(bytes)) {
+      *bytes++ = byte;
+      size -= 1;
+    }
+
+    const Word pattern = byte * UINT32_C(0x01010101);
+    Word* words = (Word*)bytes;
+    for (; size >= 4 * sizeof(Word); size -= 4 * sizeof(Word)) {
+      words[0] = pattern;
+      words[1] = pattern;
+      words[2] = pattern;
+      words[3] = pattern;
+      words += 4;
+      PREVENT_LIBCALL();
+    }
+    for (; size >= sizeof(Word); size -= sizeof(Word)) {
+      *words++ = pattern;
+    }
+    bytes = (unsigned char*)words;
+  }
+
+  for (; size > 0u; size -= 1) {
+    *bytes++ = byte;
+    PREVENT_LIBCALL();
+  }
+  return dest;
+}
+
+int pw_libc_Memcmp(const void* lhs, const void* rhs, size_t size) {
+  const unsigned char* left = (const unsigned char*)lhs;
+  const unsigned char* right = (const unsigned char*)rhs;
+
+  if (size >= SMALL_SIZE) {
+    while (!IsWordAligned(left)) {
+      if (*left != *right) {
+        return *left - *right;
+      }
+      left += 1;
+      right += 1;
+      size -= 1;
+    }
+
+    // Skip past equal words. The first differing word, if any, is compared a
+    // byte at a time below to find the order.
+    const Word* left_words = (const Word*)left;
+    const UnalignedWord* right_words = (const UnalignedWord*)right;
+    for (; size >= sizeof(Word); size -= sizeof(Word)) {
+      if (*left_words != *right_words) {
+        break;
+      }
+      left_words += 1;
+      right_words += 1;
+    }
+    left = (const unsigned char*)left_words;
+    right = (const unsigned char*)right_words;
+  }
+
+  for (; size > 0u; size -= 1) {
+    if (*left != *right) {
+      return *left - *right;
+    }
+    left += 1;
+    right += 1;
+  }
+  return 0;
+}
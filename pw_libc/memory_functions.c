@@ -0,0 +1,36 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Provides the libc memory functions using the implementations in memory.c.
+// Each compiles to a single branch.
+
+#include <string.h>
+
+#include "pw_libc/memory.h"
+
+void* memcpy(void* dest, const void* src, size_t size) {
+  return pw_libc_Memcpy(dest, src, size);
+}
+
+void* memmove(void* dest, const void* src, size_t size) {
+  return pw_libc_Memmove(dest, src, size);
+}
+
+void* memset(void* dest, int value, size_t size) {
+  return pw_libc_Memset(dest, value, size);
+}
+
+int memcmp(const void* lhs, const void* rhs, size_t size) {
+  return pw_libc_Memcmp(lhs, rhs, size);
+}
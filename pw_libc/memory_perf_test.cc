@@ -0,0 +1,163 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares the pw_libc memory functions with the toolchain's libc at several
+// sizes. On a target that links pw_libc:memory_functions, the libc functions
+// are the pw_libc implementations, so build this test without it to compare
+// against the toolchain's libc (e.g. newlib-nano).
+
+#include <cstring>
+
+#include "pw_libc/memory.h"
+#include "pw_unit_test/perf_test.h"
+
+namespace pw {
+namespace {
+
+using unit_test::DoNotOptimize;
+using unit_test::PerfState;
+
+constexpr size_t kMaxSize = 4096;
+
+// One extra byte so unaligned copies stay in bounds.
+alignas(8) unsigned char source[kMaxSize + 1];
+alignas(8) unsigned char destination[kMaxSize + 1];
+
+template <void* (*kCopy)(void*, const void*, size_t)>
+void BenchmarkCopy(PerfState& state, size_t size, size_t src_offset) {
+  while (state.KeepRunning()) {
+    DoNotOptimize(kCopy(destination, &source[src_offset], size));
+  }
+}
+
+template <void* (*kSet)(void*, int, size_t)>
+void BenchmarkSet(PerfState& state, size_t size) {
+  while (state.KeepRunning()) {
+    DoNotOptimize(kSet(destination, 0x5a, size));
+  }
+}
+
+template <int (*kCompare)(const void*, const void*, size_t)>
+void BenchmarkCompare(PerfState& state, size_t size) {
+  std::memcpy(destination, source, size);
+  while (state.KeepRunning()) {
+    DoNotOptimize(kCompare(destination, source, size));
+  }
+}
+
+// Call the libc functions through volatile pointers so the compiler calls them
+// rather than expanding them inline for constant sizes.
+void* (*volatile libc_memcpy)(void*, const void*, size_t) = std::memcpy;
+void* (*volatile libc_memmove)(void*, const void*, size_t) = std::memmove;
+void* (*volatile libc_memset)(void*, int, size_t) = std::memset;
+int (*volatile libc_memcmp)(const void*, const void*, size_t) = std::memcmp;
+
+void* LibcMemcpy(void* dest, const void* src, size_t size) {
+  return libc_memcpy(dest, src, size);
+}
+
+void* LibcMemmove(void* dest, const void* src, size_t size) {
+  return libc_memmove(dest, src, size);
+}
+
+void* LibcMemset(void* dest, int value, size_t size) {
+  return libc_memset(dest, value, size);
+}
+
+int LibcMemcmp(const void* lhs, const void* rhs, size_t size) {
+  return libc_memcmp(lhs, rhs, size);
+}
+
+PERF_TEST(Memcpy, Libc_16, state) {
+  BenchmarkCopy<LibcMemcpy>(state, 16, 0);
+}
+
+PERF_TEST(Memcpy, PwLibc_16, state) {
+  BenchmarkCopy<pw_libc_Memcpy>(state, 16, 0);
+}
+
+PERF_TEST(Memcpy, Libc_256, state) {
+  BenchmarkCopy<LibcMemcpy>(state, 256, 0);
+}
+
+PERF_TEST(Memcpy, PwLibc_256, state) {
+  BenchmarkCopy<pw_libc_Memcpy>(state, 256, 0);
+}
+
+PERF_TEST(Memcpy, Libc_4096, state) {
+  BenchmarkCopy<LibcMemcpy>(state, 4096, 0);
+}
+
+PERF_TEST(Memcpy, PwLibc_4096, state) {
+  BenchmarkCopy<pw_libc_Memcpy>(state, 4096, 0);
+}
+
+PERF_TEST(Memcpy, Libc_Unaligned_256, state) {
+  BenchmarkCopy<LibcMemcpy>(state, 256, 1);
+}
+
+PERF_TEST(Memcpy, PwLibc_Unaligned_256, state) {
+  BenchmarkCopy<pw_libc_Memcpy>(state, 256, 1);
+}
+
+PERF_TEST(Memmove, Libc_256, state) {
+  BenchmarkCopy<LibcMemmove>(state, 256, 0);
+}
+
+PERF_TEST(Memmove, PwLibc_256, state) {
+  BenchmarkCopy<pw_libc_Memmove>(state, 256, 0);
+}
+
+PERF_TEST(Memset, Libc_16, state) {
+  BenchmarkSet<LibcMemset>(state, 16);
+}
+
+PERF_TEST(Memset, PwLibc_16, state) {
+  BenchmarkSet<pw_libc_Memset>(state, 16);
+}
+
+PERF_TEST(Memset, Libc_256, state) {
+  BenchmarkSet<LibcMemset>(state, 256);
+}
+
+PERF_TEST(Memset, PwLibc_256, state) {
+  BenchmarkSet<pw_libc_Memset>(state, 256);
+}
+
+PERF_TEST(Memset, Libc_4096, state) {
+  BenchmarkSet<LibcMemset>(state, 4096);
+}
+
+PERF_TEST(Memset, PwLibc_4096, state) {
+  BenchmarkSet<pw_libc_Memset>(state, 4096);
+}
+
+PERF_TEST(Memcmp, Libc_256, state) {
+  BenchmarkCompare<LibcMemcmp>(state, 256);
+}
+
+PERF_TEST(Memcmp, PwLibc_256, state) {
+  BenchmarkCompare<pw_libc_Memcmp>(state, 256);
+}
+
+PERF_TEST(Memcmp, Libc_4096, state) {
+  BenchmarkCompare<LibcMemcmp>(state, 4096);
+}
+
+PERF_TEST(Memcmp, PwLibc_4096, state) {
+  BenchmarkCompare<pw_libc_Memcmp>(state, 4096);
+}
+
+}  // namespace
+}  // namespace pw
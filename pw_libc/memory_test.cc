@@ -0,0 +1,145 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_libc/memory.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw {
+namespace {
+
+// Tests every size up to kMaxSize at every combination of source and
+// destination offsets within a word, comparing against the expected contents
+// of the whole buffer so that writes outside the region are caught.
+constexpr size_t kMaxSize = 80;
+constexpr size_t kMaxOffset = 8;
+constexpr size_t kBufferSize = kMaxSize + 2 * kMaxOffset;
+
+using Buffer = std::array<unsigned char, kBufferSize>;
+
+Buffer Pattern(unsigned char seed) {
+  Buffer buffer;
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = static_cast<unsigned char>(seed + i * 37u);
+  }
+  return buffer;
+}
+
+TEST(Memcpy, AllSizesAndAlignments) {
+  const Buffer source = Pattern(1);
+
+  for (size_t dest_offset = 0; dest_offset < kMaxOffset; ++dest_offset) {
+    for (size_t src_offset = 0; src_offset < kMaxOffset; ++src_offset) {
+      for (size_t size = 0; size <= kMaxSize; ++size) {
+        Buffer actual = Pattern(100);
+        Buffer expected = Pattern(100);
+        std::memcpy(&expected[dest_offset], &source[src_offset], size);
+
+        void* result =
+            pw_libc_Memcpy(&actual[dest_offset], &source[src_offset], size);
+        ASSERT_EQ(result, &actual[dest_offset]);
+        ASSERT_EQ(actual, expected);
+      }
+    }
+  }
+}
+
+TEST(Memmove, NonOverlapping) {
+  const Buffer source = Pattern(2);
+  Buffer actual = Pattern(50);
+
+  void* result = pw_libc_Memmove(&actual[3], &source[1], kMaxSize);
+  EXPECT_EQ(result, &actual[3]);
+  EXPECT_EQ(0, std::memcmp(&actual[3], &source[1], kMaxSize));
+}
+
+TEST(Memmove, OverlappingInBothDirections) {
+  for (size_t dest = 0; dest < 2 * kMaxOffset; ++dest) {
+    for (size_t src = 0; src < 2 * kMaxOffset; ++src) {
+      for (size_t size = 0; size <= kMaxSize; ++size) {
+        Buffer actual = Pattern(7);
+        Buffer expected = Pattern(7);
+        std::memmove(&expected[dest], &expected[src], size);
+
+        void* result = pw_libc_Memmove(&actual[dest], &actual[src], size);
+        ASSERT_EQ(result, &actual[dest]);
+        ASSERT_EQ(actual, expected);
+      }
+    }
+  }
+}
+
+TEST(Memset, AllSizesAndAlignments) {
+  for (size_t offset = 0; offset < kMaxOffset; ++offset) {
+    for (size_t size = 0; size <= kMaxSize; ++size) {
+      Buffer actual = Pattern(3);
+      Buffer expected = Pattern(3);
+      std::memset(&expected[offset], 0xA5, size);
+
+      void* result = pw_libc_Memset(&actual[offset], 0xA5, size);
+      ASSERT_EQ(result, &actual[offset]);
+      ASSERT_EQ(actual, expected);
+    }
+  }
+}
+
+TEST(Memset, OnlyLowByteOfValueUsed) {
+  std::array<unsigned char, 32> buffer{};
+  pw_libc_Memset(buffer.data(), 0x1234, buffer.size());
+  for (unsigned char byte : buffer) {
+    EXPECT_EQ(byte, 0x34u);
+  }
+}
+
+int Sign(int value) { return (value > 0) - (value < 0); }
+
+TEST(Memcmp, EqualRegions) {
+  const Buffer lhs = Pattern(4);
+  const Buffer rhs = Pattern(4);
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    EXPECT_EQ(0, pw_libc_Memcmp(lhs.data(), rhs.data(), size));
+  }
+}
+
+TEST(Memcmp, DifferenceAtEachPosition) {
+  for (size_t lhs_offset = 0; lhs_offset < kMaxOffset; ++lhs_offset) {
+    for (size_t rhs_offset = 0; rhs_offset < kMaxOffset; ++rhs_offset) {
+      for (size_t size = 1; size <= kMaxSize; ++size) {
+        for (size_t diff = 0; diff < size; ++diff) {
+          Buffer lhs = Pattern(5);
+          Buffer rhs{};
+          std::memcpy(&rhs[rhs_offset], &lhs[lhs_offset], size);
+
+          // Make the bytes differ in both directions, including in the sign
+          // bit, which must be compared as unsigned.
+          rhs[rhs_offset + diff] = static_cast<unsigned char>(
+              lhs[lhs_offset + diff] ^ (diff % 2 == 0 ? 0x80 : 0x01));
+
+          const int expected =
+              std::memcmp(&lhs[lhs_offset], &rhs[rhs_offset], size);
+          const int actual =
+              pw_libc_Memcmp(&lhs[lhs_offset], &rhs[rhs_offset], size);
+          ASSERT_EQ(Sign(actual), Sign(expected));
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace pw
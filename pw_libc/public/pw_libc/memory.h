@@ -0,0 +1,41 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <stddef.h>
+
+#include "pw_preprocessor/util.h"
+
+// Word-oriented implementations of the libc memory functions. They copy, set,
+// and compare four words per loop iteration once the destination is word
+// aligned, which compilers for ARMv7-M turn into LDM/STM instructions. Sources
+// that are not aligned with the destination are read with unaligned word loads,
+// which ARMv7-M supports in hardware.
+//
+// These are several times faster than byte-oriented implementations, such as
+// newlib-nano's, for all but the smallest sizes. They have the same semantics
+// as the standard functions. Link the pw_libc:memory_functions target to use
+// them as memcpy, memmove, memset, and memcmp.
+
+PW_EXTERN_C_START
+
+void* pw_libc_Memcpy(void* dest, const void* src, size_t size);
+
+void* pw_libc_Memmove(void* dest, const void* src, size_t size);
+
+void* pw_libc_Memset(void* dest, int value, size_t size);
+
+int pw_libc_Memcmp(const void* lhs, const void* rhs, size_t size);
+
+PW_EXTERN_C_END
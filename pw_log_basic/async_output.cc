@@ -0,0 +1,109 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_basic/async_output.h"
+
+#include <array>
+#include <mutex>
+
+#include "pw_log_basic/log_basic.h"
+#include "pw_log_basic_private/config.h"
+#include "pw_string/string_builder.h"
+
+namespace pw::log_basic {
+namespace {
+
+AsyncOutput* installed_output = nullptr;
+
+}  // namespace
+
+AsyncOutput::AsyncOutput(std::span<std::byte> buffer,
+                         void (*log_output)(std::string_view log))
+    : log_output_(log_output) {
+  // An empty buffer leaves the queue uninitialized, so every line is dropped.
+  queue_.SetBuffer(buffer).IgnoreError();
+}
+
+void AsyncOutput::Install() {
+  installed_output = this;
+  SetOutput([](std::string_view log) { installed_output->Write(log); });
+}
+
+void AsyncOutput::Write(std::string_view log) {
+  if (log.empty()) {
+    return;
+  }
+  {
+    std::lock_guard lock(lock_);
+    if (!queue_.TryPushBack(std::as_bytes(std::span(log))).ok()) {
+      dropped_ += 1;
+      return;
+    }
+  }
+  lines_queued_.release();
+}
+
+void AsyncOutput::Flush() {
+  while (WriteOne()) {
+  }
+}
+
+uint32_t AsyncOutput::dropped() {
+  std::lock_guard lock(lock_);
+  return dropped_;
+}
+
+void AsyncOutput::Run() {
+  while (true) {
+    lines_queued_.acquire();
+    Flush();
+  }
+}
+
+bool AsyncOutput::WriteOne() {
+  std::array<std::byte, PW_LOG_BASIC_ENTRY_SIZE> line;
+  size_t line_size = 0;
+  uint32_t unreported_dropped = 0;
+  {
+    std::lock_guard lock(lock_);
+    // Lines longer than the entry size can only come from calling Write()
+    // directly. They are truncated.
+    const Status status = queue_.PeekFront(line, &line_size);
+    if (!status.ok() && !status.IsResourceExhausted()) {
+      unreported_dropped = dropped_ - reported_dropped_;
+      reported_dropped_ = dropped_;
+      line_size = 0;
+    } else {
+      queue_.PopFront().IgnoreError();
+    }
+  }
+
+  if (line_size != 0) {
+    log_output_(std::string_view(reinterpret_cast<const char*>(line.data()),
+                                 line_size));
+    return true;
+  }
+
+  // The queue is empty, so any dropped lines came after all of the lines that
+  // were written.
+  if (unreported_dropped != 0) {
+    StringBuffer<48> message;
+    message.Format("%u log lines dropped",
+                   static_cast<unsigned>(unreported_dropped));
+    log_output_(message);
+  }
+  return false;
+}
+
+}  // namespace pw::log_basic
@@ -0,0 +1,76 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_log_basic/async_output.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace pw::log_basic {
+namespace {
+
+std::vector<std::string> written_lines;
+
+void CaptureLine(std::string_view log) { written_lines.emplace_back(log); }
+
+class AsyncOutputTest : public ::testing::Test {
+ protected:
+  AsyncOutputTest() : output_(buffer_, CaptureLine) { written_lines.clear(); }
+
+  std::byte buffer_[32];
+  AsyncOutput output_;
+};
+
+TEST_F(AsyncOutputTest, WritesLinesOnFlush) {
+  output_.Write("hello");
+  output_.Write("world");
+  EXPECT_TRUE(written_lines.empty());
+
+  output_.Flush();
+  ASSERT_EQ(written_lines.size(), 2u);
+  EXPECT_EQ(written_lines[0], "hello");
+  EXPECT_EQ(written_lines[1], "world");
+  EXPECT_EQ(output_.dropped(), 0u);
+}
+
+TEST_F(AsyncOutputTest, FlushWithNothingQueued) {
+  output_.Flush();
+  EXPECT_TRUE(written_lines.empty());
+}
+
+TEST_F(AsyncOutputTest, DropsLinesWhenFull) {
+  // Each 9 character line takes 10 bytes, so 3 fit in the 32 byte buffer.
+  for (int i = 0; i < 5; ++i) {
+    output_.Write("log line!");
+  }
+  EXPECT_EQ(output_.dropped(), 2u);
+
+  output_.Flush();
+  ASSERT_EQ(written_lines.size(), 4u);
+  EXPECT_EQ(written_lines[2], "log line!");
+  EXPECT_EQ(written_lines[3], "2 log lines dropped");
+
+  // Drops are only reported once.
+  output_.Write("again");
+  output_.Flush();
+  ASSERT_EQ(written_lines.size(), 5u);
+  EXPECT_EQ(written_lines[4], "again");
+  EXPECT_EQ(output_.dropped(), 2u);
+}
+
+}  // namespace
+}  // namespace pw::log_basic
@@ -99,7 +99,7 @@ extern "C" void pw_Log(int level,
                        const char* message,
                        ...) {
   // Accumulate the log message in this buffer, then output it.
-  pw::StringBuffer<150> buffer;
+  pw::StringBuffer<PW_LOG_BASIC_ENTRY_SIZE> buffer;
 
   // Column: Timestamp
   // Note that this macro method defaults to a no-op.
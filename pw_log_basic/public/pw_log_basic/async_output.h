@@ -0,0 +1,88 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::log_basic {
+
+// Queues formatted log lines in a buffer and writes them from a separate
+// thread, so that a slow output such as a UART does not block the thread that
+// logs. Log messages are still formatted in the logging thread; only the output
+// is deferred.
+//
+//   std::byte log_buffer[1024];
+//   pw::log_basic::AsyncOutput async_output(
+//       log_buffer, [](std::string_view log) { pw::sys_io::WriteLine(log); });
+//
+//   int main() {
+//     async_output.Install();
+//     pw::thread::Thread(low_priority_options, async_output).detach();
+//     ...
+//   }
+//
+// If the buffer is full, new log lines are dropped rather than blocking the
+// logging thread. The number of dropped lines is written to the output once
+// the lines queued before them have been written.
+class AsyncOutput : public thread::ThreadCore {
+ public:
+  // Lines are written to log_output from the thread that runs this object.
+  AsyncOutput(std::span<std::byte> buffer,
+              void (*log_output)(std::string_view log));
+
+  AsyncOutput(const AsyncOutput&) = delete;
+  AsyncOutput& operator=(const AsyncOutput&) = delete;
+
+  // Sends pw_log_basic's output to this object with SetOutput(). Only one
+  // AsyncOutput can be installed at a time.
+  void Install();
+
+  // Queues a log line without blocking. This may be called from threads and
+  // interrupts.
+  void Write(std::string_view log);
+
+  // Writes all queued log lines from the calling thread, for example before a
+  // reboot. This may be called while the output thread is running.
+  void Flush();
+
+  // The total number of log lines dropped because the buffer was full.
+  uint32_t dropped();
+
+ private:
+  // Waits for log lines and writes them. Does not return.
+  void Run() override;
+
+  // Writes the oldest queued line, if any. Returns false if no lines are
+  // queued.
+  bool WriteOne();
+
+  void (*const log_output_)(std::string_view log);
+  sync::ThreadNotification lines_queued_;
+
+  sync::InterruptSpinLock lock_;
+  ring_buffer::PrefixedEntryRingBuffer queue_ PW_GUARDED_BY(lock_);
+  uint32_t dropped_ PW_GUARDED_BY(lock_) = 0;
+  uint32_t reported_dropped_ PW_GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace pw::log_basic
@@ -53,6 +53,12 @@
 #define PW_LOG_SHOW_MODULE 0
 #endif  // PW_LOG_SHOW_MODULE
 
+// The size of the buffer used to format each log line, including the null
+// terminator. Longer log lines are truncated.
+#ifndef PW_LOG_BASIC_ENTRY_SIZE
+#define PW_LOG_BASIC_ENTRY_SIZE 150
+#endif  // PW_LOG_BASIC_ENTRY_SIZE
+
 // Optional user provided macro to append a prefixing timestamp string.
 // For example this could be implemented as:
 // #define PW_LOG_APPEND_TIMESTAMP(buffer) AppendSecSinceEpoch(buffer)
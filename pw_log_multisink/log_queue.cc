@@ -14,11 +14,15 @@
 
 #include "pw_log_multisink/log_queue.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "pw_assert/check.h"
 #include "pw_log/levels.h"
 #include "pw_log/proto/log.pwpb.h"
 #include "pw_protobuf/wire_format.h"
 #include "pw_status/try.h"
+#include "pw_varint/varint.h"
 
 namespace pw::log_rpc {
 namespace {
@@ -28,21 +32,39 @@ constexpr uint32_t kLogKey = pw::protobuf::MakeKey(
     static_cast<uint32_t>(pw::log::LogEntries::Fields::ENTRIES),
     WireType::kDelimited);
 
-}  // namespace
+// The largest compact entry header: line_level and flags varints, and the
+// ZigZag-encoded timestamp delta.
+constexpr size_t kMaxCompactHeaderSizeBytes =
+    varint::kMaxVarint32SizeBytes * 2 + varint::kMaxVarint64SizeBytes;
 
-Status LogQueue::PushTokenizedMessage(ConstByteSpan message,
-                                      uint32_t flags,
-                                      uint32_t level,
-                                      uint32_t line,
-                                      uint32_t /* thread */,
-                                      int64_t timestamp) {
-  pw::protobuf::NestedEncoder nested_encoder(encode_buffer_);
+uint32_t LineLevel(uint32_t level, uint32_t line) {
+  return (level & PW_LOG_LEVEL_BITMASK) |
+         ((line << PW_LOG_LEVEL_BITS) & ~PW_LOG_LEVEL_BITMASK);
+}
+
+// Returns the size of the pw.log.LogEntry that EncodeLogEntry produces, without
+// encoding it. Every field is a single-byte key followed by its value.
+size_t LogEntrySize(ConstByteSpan message,
+                    uint32_t line_level,
+                    uint32_t flags,
+                    int64_t timestamp) {
+  return 1 + varint::EncodedSize(message.size_bytes()) + message.size_bytes() +
+         1 + varint::EncodedSize(line_level) +  //
+         1 + varint::EncodedSize(flags) +       //
+         1 + varint::EncodedSize(static_cast<uint64_t>(timestamp));
+}
+
+Status EncodeLogEntry(ByteSpan encode_buffer,
+                      ConstByteSpan message,
+                      uint32_t line_level,
+                      uint32_t flags,
+                      int64_t timestamp,
+                      ConstByteSpan& log_entry_out) {
+  pw::protobuf::NestedEncoder nested_encoder(encode_buffer);
   pw::log::LogEntry::Encoder encoder(&nested_encoder);
-  Status status;
 
   encoder.WriteMessage(message);
-  encoder.WriteLineLevel((level & PW_LOG_LEVEL_BITMASK) |
-                         ((line << PW_LOG_LEVEL_BITS) & ~PW_LOG_LEVEL_BITMASK));
+  encoder.WriteLineLevel(line_level);
   encoder.WriteFlags(flags);
   // TODO(prashanthsw): Update when the thread_name field is added.
   // encoder.WriteThreadName(bytes::CopyInOrder(std::endian::little, &thread));
@@ -55,20 +77,39 @@ Status LogQueue::PushTokenizedMessage(ConstByteSpan message,
   //   encoder.WriteDropped(dropped_entries_);
   // }
 
-  ConstByteSpan log_entry;
-  status = nested_encoder.Encode(&log_entry);
-  if (!status.ok() || log_entry.size_bytes() > max_log_entry_size_) {
-    // If an encoding failure occurs or the constructed log entry is larger
-    // than the configured max size, map the error to INTERNAL. If the
-    // underlying allocation of this encode buffer or the nested encoding
-    // sequencing are at fault, they are not the caller's responsibility. If
-    // the log entry is larger than the max allowed size, the log is dropped
-    // intentionally, and it is expected that the caller accepts this
-    // possibility.
-    status = PW_STATUS_INTERNAL;
+  return nested_encoder.Encode(&log_entry_out);
+}
+
+}  // namespace
+
+Status LogQueue::PushTokenizedMessage(ConstByteSpan message,
+                                      uint32_t flags,
+                                      uint32_t level,
+                                      uint32_t line,
+                                      uint32_t /* thread */,
+                                      int64_t timestamp) {
+  const uint32_t line_level = LineLevel(level, line);
+  Status status;
+
+  if (format_ == StorageFormat::kCompact) {
+    status = PushCompactMessage(message, line_level, flags, timestamp);
   } else {
-    // Try to push back the encoded log entry.
-    status = ring_buffer_.TryPushBack(log_entry, kLogKey);
+    ConstByteSpan log_entry;
+    status = EncodeLogEntry(
+        encode_buffer_, message, line_level, flags, timestamp, log_entry);
+    if (!status.ok() || log_entry.size_bytes() > max_log_entry_size_) {
+      // If an encoding failure occurs or the constructed log entry is larger
+      // than the configured max size, map the error to INTERNAL. If the
+      // underlying allocation of this encode buffer or the nested encoding
+      // sequencing are at fault, they are not the caller's responsibility. If
+      // the log entry is larger than the max allowed size, the log is dropped
+      // intentionally, and it is expected that the caller accepts this
+      // possibility.
+      status = PW_STATUS_INTERNAL;
+    } else {
+      // Try to push back the encoded log entry.
+      status = ring_buffer_.TryPushBack(log_entry, kLogKey);
+    }
   }
 
   if (!status.ok()) {
@@ -84,12 +125,48 @@ Status LogQueue::PushTokenizedMessage(ConstByteSpan message,
   return OkStatus();
 }
 
+Status LogQueue::PushCompactMessage(ConstByteSpan message,
+                                    uint32_t line_level,
+                                    uint32_t flags,
+                                    int64_t timestamp) {
+  // The entry is encoded when it is popped, so the same limits as for the
+  // proto format are checked now.
+  if (LogEntrySize(message, line_level, flags, timestamp) >
+          std::min(max_log_entry_size_, encode_buffer_.size_bytes()) ||
+      kMaxCompactHeaderSizeBytes + message.size_bytes() >
+          encode_buffer_.size_bytes()) {
+    return Status::Internal();
+  }
+
+  // The header and message are staged in the encode buffer so that they can
+  // be pushed as a single entry.
+  size_t size = 0;
+  size += varint::Encode(line_level, encode_buffer_.subspan(size));
+  size += varint::Encode(flags, encode_buffer_.subspan(size));
+  size += varint::Encode(timestamp - latest_pushed_timestamp_,
+                         encode_buffer_.subspan(size));
+  std::memcpy(encode_buffer_.data() + size, message.data(), message.size());
+  size += message.size();
+
+  PW_TRY(ring_buffer_.TryPushBack(encode_buffer_.first(size)));
+  latest_pushed_timestamp_ = timestamp;
+  return OkStatus();
+}
+
 Result<LogEntries> LogQueue::Pop(LogEntriesBuffer entry_buffer) {
-  size_t ring_buffer_entry_size = 0;
   PW_TRY(pop_status_for_test_);
   // The caller must provide a buffer that is at minimum max_log_entry_size, to
   // ensure that the front entry of the ring buffer can be popped.
   PW_DCHECK_UINT_GE(entry_buffer.size_bytes(), max_log_entry_size_);
+
+  return PopEntry(entry_buffer);
+}
+
+Result<LogEntries> LogQueue::PopEntry(LogEntriesBuffer entry_buffer) {
+  size_t ring_buffer_entry_size = 0;
+  if (format_ == StorageFormat::kCompact) {
+    return PopCompact(entry_buffer);
+  }
   PW_TRY(ring_buffer_.PeekFrontWithPreamble(entry_buffer,
                                             &ring_buffer_entry_size));
   PW_DCHECK_OK(ring_buffer_.PopFront());
@@ -99,6 +176,56 @@ Result<LogEntries> LogQueue::Pop(LogEntriesBuffer entry_buffer) {
       .entry_count = 1};
 }
 
+Result<LogEntries> LogQueue::PopCompact(LogEntriesBuffer entry_buffer) {
+  // Read the compact entry into the start of the entry buffer, then decode its
+  // header.
+  size_t entry_size = 0;
+  PW_TRY(ring_buffer_.PeekFront(entry_buffer, &entry_size));
+  ConstByteSpan entry = entry_buffer.first(entry_size);
+
+  uint64_t line_level;
+  uint64_t flags;
+  int64_t timestamp_delta;
+  size_t bytes = varint::Decode(entry, &line_level);
+  if (bytes != 0) {
+    entry = entry.subspan(bytes);
+    bytes = varint::Decode(entry, &flags);
+  }
+  if (bytes != 0) {
+    entry = entry.subspan(bytes);
+    bytes = varint::Decode(entry, &timestamp_delta);
+  }
+  if (bytes == 0) {
+    return Status::DataLoss();
+  }
+  const ConstByteSpan message = entry.subspan(bytes);
+  const int64_t timestamp = latest_popped_timestamp_ + timestamp_delta;
+
+  // Encode the LogEntry, then frame it as a LogEntries field in the entry
+  // buffer, like the entries stored in the proto format.
+  ConstByteSpan log_entry;
+  PW_TRY(EncodeLogEntry(encode_buffer_,
+                        message,
+                        static_cast<uint32_t>(line_level),
+                        static_cast<uint32_t>(flags),
+                        timestamp,
+                        log_entry));
+
+  size_t size = varint::Encode(kLogKey, entry_buffer);
+  size += varint::Encode(log_entry.size_bytes(), entry_buffer.subspan(size));
+  if (entry_buffer.size_bytes() - size < log_entry.size_bytes()) {
+    return Status::ResourceExhausted();
+  }
+  std::memcpy(entry_buffer.data() + size, log_entry.data(), log_entry.size());
+  size += log_entry.size();
+
+  PW_DCHECK_OK(ring_buffer_.PopFront());
+  latest_popped_timestamp_ = timestamp;
+
+  return LogEntries{.entries = ConstByteSpan(entry_buffer.first(size)),
+                    .entry_count = 1};
+}
+
 LogEntries LogQueue::PopMultiple(LogEntriesBuffer entries_buffer) {
   size_t offset = 0;
   size_t entry_count = 0;
@@ -107,9 +234,16 @@ LogEntries LogQueue::PopMultiple(LogEntriesBuffer entries_buffer) {
   // ensure that the front entry of the ring buffer can be popped.
   PW_DCHECK_UINT_GE(entries_buffer.size_bytes(), max_log_entry_size_);
 
+  if (!pop_status_for_test_.ok()) {
+    return LogEntries{.entries = ConstByteSpan(), .entry_count = 0};
+  }
+
+  // Keep popping until the front entry does not fit in the remaining space.
+  // Entries that do not fit are left in the queue, so the buffer is filled as
+  // much as possible rather than only while a maximum sized entry would fit.
   while (ring_buffer_.EntryCount() > 0 &&
-         (entries_buffer.size_bytes() - offset) > max_log_entry_size_) {
-    const Result<LogEntries> result = Pop(entries_buffer.subspan(offset));
+         offset < entries_buffer.size_bytes()) {
+    const Result<LogEntries> result = PopEntry(entries_buffer.subspan(offset));
     if (!result.ok()) {
       break;
     }
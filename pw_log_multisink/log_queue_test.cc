@@ -180,6 +180,52 @@ TEST(LogQueue, PopMultiple) {
   }
 }
 
+TEST(LogQueue, PopMultiple_FillsBufferAndKeepsRemainingEntries) {
+  constexpr size_t kEntryCount = 10;
+
+  std::byte log_buffer[kLogBufferSize];
+  LogQueueWithEncodeBuffer<kEncodeBufferSize> log_queue(log_buffer);
+
+  for (size_t i = 0; i < kEntryCount; i++) {
+    EXPECT_EQ(OkStatus(),
+              log_queue.PushTokenizedMessage(
+                  std::as_bytes(std::span(kTokenizedMessage)),
+                  kFlags,
+                  kLevel,
+                  kLine,
+                  kTokenizedThread,
+                  kTimestamp + i));
+  }
+
+  // A buffer of the maximum entry size holds several small entries. Entries
+  // that do not fit stay queued for the following calls.
+  std::byte log_entries[kLogEntryMaxSize];
+  size_t popped_entries = 0;
+  size_t calls = 0;
+  while (popped_entries < kEntryCount) {
+    LogEntries entries = log_queue.PopMultiple(log_entries);
+    ASSERT_GT(entries.entry_count, 1u);
+    EXPECT_LE(entries.entries.size_bytes(), sizeof(log_entries));
+
+    pw::protobuf::Decoder log_decoder(entries.entries);
+    for (size_t i = 0; i < entries.entry_count; i++) {
+      VerifyLogEntry(log_decoder,
+                     kTokenizedMessage,
+                     kFlags,
+                     kLevel,
+                     kLine,
+                     kTokenizedThread,
+                     kTimestamp + popped_entries + i);
+    }
+    popped_entries += entries.entry_count;
+    calls++;
+  }
+
+  EXPECT_EQ(popped_entries, kEntryCount);
+  EXPECT_GT(calls, 1u);
+  EXPECT_EQ(log_queue.PopMultiple(log_entries).entry_count, 0u);
+}
+
 TEST(LogQueue, TooSmallEncodeBuffer) {
   constexpr size_t kSmallBuffer = 1;
 
@@ -233,4 +279,117 @@ TEST(LogQueue, TooSmallLogBuffer) {
                 kTimestamp));
 }
 
+TEST(LogQueue, CompactFormat_PushPop) {
+  constexpr size_t kEntryCount = 4;
+  constexpr int64_t kTimestamps[kEntryCount] = {1000, 1002, 5, 1 << 20};
+
+  std::byte log_buffer[kLogBufferSize];
+  LogQueueWithEncodeBuffer<kEncodeBufferSize> log_queue(
+      log_buffer, LogQueue::StorageFormat::kCompact);
+
+  for (size_t i = 0; i < kEntryCount; i++) {
+    EXPECT_EQ(OkStatus(),
+              log_queue.PushTokenizedMessage(
+                  std::as_bytes(std::span(kTokenizedMessage)),
+                  kFlags + i,
+                  kLevel,
+                  kLine + (i << 3),
+                  kTokenizedThread,
+                  kTimestamps[i]));
+  }
+
+  std::byte log_entry[kEncodeBufferSize];
+  for (size_t i = 0; i < kEntryCount; i++) {
+    Result<LogEntries> pop_result = log_queue.Pop(std::span(log_entry));
+    ASSERT_TRUE(pop_result.ok());
+
+    pw::protobuf::Decoder log_decoder(pop_result.value().entries);
+    EXPECT_EQ(pop_result.value().entry_count, 1U);
+    VerifyLogEntry(log_decoder,
+                   kTokenizedMessage,
+                   kFlags + i,
+                   kLevel,
+                   kLine + (i << 3),
+                   kTokenizedThread,
+                   kTimestamps[i]);
+  }
+  EXPECT_EQ(log_queue.Pop(std::span(log_entry)).status(),
+            Status::OutOfRange());
+}
+
+TEST(LogQueue, CompactFormat_PopMultiple) {
+  constexpr size_t kEntryCount = 3;
+
+  std::byte log_buffer[kLogBufferSize];
+  LogQueueWithEncodeBuffer<kEncodeBufferSize> log_queue(
+      log_buffer, LogQueue::StorageFormat::kCompact);
+
+  for (size_t i = 0; i < kEntryCount; i++) {
+    EXPECT_EQ(OkStatus(),
+              log_queue.PushTokenizedMessage(
+                  std::as_bytes(std::span(kTokenizedMessage)),
+                  kFlags,
+                  kLevel,
+                  kLine + (i << 3),
+                  kTokenizedThread,
+                  kTimestamp + i));
+  }
+
+  std::byte log_entries[kLogBufferSize];
+  Result<LogEntries> pop_result = log_queue.PopMultiple(log_entries);
+  EXPECT_TRUE(pop_result.ok());
+
+  pw::protobuf::Decoder log_decoder(pop_result.value().entries);
+  EXPECT_EQ(pop_result.value().entry_count, kEntryCount);
+  for (size_t i = 0; i < kEntryCount; i++) {
+    VerifyLogEntry(log_decoder,
+                   kTokenizedMessage,
+                   kFlags,
+                   kLevel,
+                   kLine + (i << 3),
+                   kTokenizedThread,
+                   kTimestamp + i);
+  }
+}
+
+size_t CountEntriesThatFit(LogQueue& log_queue) {
+  size_t count = 0;
+  while (log_queue
+             .PushTokenizedMessage(std::as_bytes(std::span(kTokenizedMessage)),
+                                   kFlags,
+                                   kLevel,
+                                   kLine,
+                                   kTokenizedThread,
+                                   kTimestamp + count)
+             .ok()) {
+    count++;
+  }
+  return count;
+}
+
+TEST(LogQueue, CompactFormat_UsesLessSpace) {
+  std::byte proto_log_buffer[kLogBufferSize];
+  LogQueueWithEncodeBuffer<kEncodeBufferSize> proto_log_queue(
+      proto_log_buffer);
+  std::byte compact_log_buffer[kLogBufferSize];
+  LogQueueWithEncodeBuffer<kEncodeBufferSize> compact_log_queue(
+      compact_log_buffer, LogQueue::StorageFormat::kCompact);
+
+  EXPECT_GT(CountEntriesThatFit(compact_log_queue),
+            CountEntriesThatFit(proto_log_queue));
+}
+
+TEST(LogQueue, CompactFormat_TooLargeEntry) {
+  std::byte log_buffer[kLogBufferSize];
+  LogQueueWithEncodeBuffer<kEncodeBufferSize> log_queue(
+      log_buffer, LogQueue::StorageFormat::kCompact);
+
+  // The entry is rejected if its encoded LogEntry would exceed the maximum
+  // entry size, even though it is not encoded when it is pushed.
+  std::byte message[kLogEntryMaxSize] = {};
+  EXPECT_EQ(Status::Internal(),
+            log_queue.PushTokenizedMessage(
+                message, kFlags, kLevel, kLine, kTokenizedThread, kTimestamp));
+}
+
 }  // namespace pw::log_rpc
@@ -50,18 +50,39 @@ struct LogEntries {
 
 class LogQueue {
  public:
+  // How log entries are stored in the queue's ring buffer. Both formats
+  // produce the same pw.log.LogEntries output when popped.
+  enum class StorageFormat {
+    // Entries are encoded as pw.log.LogEntry protos when they are pushed.
+    kProto,
+
+    // Entries are stored as a compact header of varints (line and level,
+    // flags, and the timestamp delta from the previous entry) followed by the
+    // raw tokenized message. They are encoded as protos when they are popped,
+    // which removes the encoding from the logging call site and uses less
+    // space in the queue.
+    kCompact,
+  };
+
   // Constructs a LogQueue. Callers can optionally supply a maximum log entry
   // size, which limits the size of messages that can be pushed into this log
   // queue. When such an entry arrives, the queue increments its drop counter.
   // Calls to Pop and PopMultiple should be provided a buffer of at least the
   // configured max size.
+  //
+  // The encode buffer is used to encode entries when they are pushed in the
+  // kProto format, and when they are popped in the kCompact format.
   LogQueue(ByteSpan log_buffer,
            ByteSpan encode_buffer,
-           size_t max_log_entry_size = kLogEntryMaxSize)
+           size_t max_log_entry_size = kLogEntryMaxSize,
+           StorageFormat format = StorageFormat::kProto)
       : pop_status_for_test_(OkStatus()),
         max_log_entry_size_(max_log_entry_size),
+        format_(format),
+        latest_pushed_timestamp_(0),
+        latest_popped_timestamp_(0),
         encode_buffer_(encode_buffer),
-        ring_buffer_(true) {
+        ring_buffer_(format == StorageFormat::kProto) {
     ring_buffer_.SetBuffer(log_buffer);
   }
 
@@ -99,7 +120,8 @@ class LogQueue {
   Result<LogEntries> Pop(LogEntriesBuffer entry_buffer);
 
   // Pop entries from the queue into the provided buffer. The provided buffer is
-  // filled until there is insufficient space for the next log entry.
+  // filled until there is insufficient space for the next log entry, which
+  // remains in the queue for the next call.
   // Returns:
   //
   // LogEntries - contains an encoded protobuf byte span of pw.log.LogEntries.
@@ -111,12 +133,33 @@ class LogQueue {
   Status pop_status_for_test_;
 
  private:
+  // Pushes an entry in the kCompact format.
+  Status PushCompactMessage(ConstByteSpan message,
+                            uint32_t line_level,
+                            uint32_t flags,
+                            int64_t timestamp);
+
+  // Pops the front entry into the provided buffer. Unlike Pop(), the buffer
+  // may be smaller than the maximum entry size; if the entry does not fit, it
+  // is left in the queue and RESOURCE_EXHAUSTED is returned.
+  Result<LogEntries> PopEntry(LogEntriesBuffer entry_buffer);
+
+  // Pops an entry in the kCompact format, encoding it as a LogEntries proto.
+  Result<LogEntries> PopCompact(LogEntriesBuffer entry_buffer);
+
   const size_t max_log_entry_size_;
+  const StorageFormat format_;
   size_t dropped_entries_;
   int64_t latest_dropped_timestamp_;
 
+  // The compact format stores timestamps relative to the previous entry. The
+  // ring buffer never evicts entries, so entries are popped in the order they
+  // were pushed.
+  int64_t latest_pushed_timestamp_;
+  int64_t latest_popped_timestamp_;
+
   ByteSpan encode_buffer_;
-  pw::ring_buffer::PrefixedEntryRingBuffer ring_buffer_{true};
+  pw::ring_buffer::PrefixedEntryRingBuffer ring_buffer_;
 };
 
 // LogQueueWithEncodeBuffer is a LogQueue where the internal encode buffer is
@@ -124,8 +167,9 @@ class LogQueue {
 template <size_t kEncodeBufferSize>
 class LogQueueWithEncodeBuffer : public LogQueue {
  public:
-  LogQueueWithEncodeBuffer(ByteSpan log_buffer)
-      : LogQueue(log_buffer, encode_buffer_) {}
+  LogQueueWithEncodeBuffer(ByteSpan log_buffer,
+                           StorageFormat format = StorageFormat::kProto)
+      : LogQueue(log_buffer, encode_buffer_, kLogEntryMaxSize, format) {}
 
  private:
   std::byte encode_buffer_[kEncodeBufferSize];
@@ -14,64 +14,157 @@
 
 #include "pw_log_rpc/logs_rpc.h"
 
-#include "pw_log/log.h"
+#include <array>
+#include <cstring>
+
 #include "pw_log/proto/log.pwpb.h"
+#include "pw_protobuf/wire_format.h"
 #include "pw_status/try.h"
+#include "pw_varint/varint.h"
 
 namespace pw::log_rpc {
 namespace {
 
-// TODO(prashanthsw): Handle dropped messages.
-// Result<ConstByteSpan> GenerateDroppedEntryMessage(ByteSpan encode_buffer,
-//                                                   size_t dropped_entries) {
-//   pw::protobuf::NestedEncoder nested_encoder(encode_buffer);
-//   pw::log::LogEntry::Encoder encoder(&nested_encoder);
-//   encoder.WriteDropped(dropped_entries);
-//   return nested_encoder.Encode();
-// }
+// Each log entry in the multisink is an encoded pw.log.LogEntry, which is sent
+// as an element of the repeated entries field of pw.log.LogEntries.
+constexpr uint32_t kLogKey = protobuf::MakeKey(
+    static_cast<uint32_t>(log::LogEntries::Fields::ENTRIES),
+    protobuf::WireType::kDelimited);
 
 }  // namespace
 
-void Logs::Get(ServerContext&, ConstByteSpan, rpc::RawServerWriter& writer) {
-  response_writer_ = std::move(writer);
+Logs::~Logs() {
+  for (Subscriber& subscriber : subscribers_) {
+    Detach(subscriber);
+  }
 }
 
-Status Logs::Flush() {
-  // If the response writer was not initialized or has since been closed,
-  // ignore the flush operation.
-  if (!response_writer_.open()) {
+Status Logs::AddStream(rpc::RawServerWriter&& writer) {
+  for (Subscriber& subscriber : subscribers_) {
+    if (subscriber.writer_.open()) {
+      continue;
+    }
+
+    // Reattach the drain so that the new client starts with the latest logs
+    // rather than those left over from the subscriber's previous stream.
+    Detach(subscriber);
+    multisink_.AttachDrain(subscriber.drain_);
+    subscriber.attached_ = true;
+    subscriber.entries_dropped_ = 0;
+    subscriber.writer_ = std::move(writer);
     return OkStatus();
   }
 
-  // If previous calls to flush resulted in dropped entries, generate a
-  // dropped entry message and write it before further log messages.
-  // TODO(prashanthsw): Handle dropped messages.
-  // if (dropped_entries_ > 0) {
-  //   ByteSpan payload = response_writer_.PayloadBuffer();
-  //   Result dropped_log = GenerateDroppedEntryMessage(payload,
-  //   dropped_entries_); PW_TRY(dropped_log.status());
-  //   PW_TRY(response_writer_.Write(dropped_log.value()));
-  //   dropped_entries_ = 0;
-  // }
-
-  // Write logs to the response writer. An important limitation of this
-  // implementation is that if this RPC call fails, the logs are lost -
-  // a subsequent call to the RPC will produce a drop count message.
-  ByteSpan payload = response_writer_.PayloadBuffer();
-  Result possible_logs = log_queue_.PopMultiple(payload);
-  PW_TRY(possible_logs.status());
-  if (possible_logs.value().entry_count == 0) {
-    return OkStatus();
+  streams_rejected_.Increment();
+  writer.Finish(Status::ResourceExhausted());
+  return Status::ResourceExhausted();
+}
+
+Status Logs::Flush() {
+  Status status;
+  for (Subscriber& subscriber : subscribers_) {
+    // If the stream was never opened or has since been closed, free the
+    // subscriber's drain so the multisink does not hold entries for it.
+    if (!subscriber.writer_.open()) {
+      Detach(subscriber);
+      continue;
+    }
+
+    const Status flush_status = FlushSubscriber(subscriber);
+    if (status.ok()) {
+      status = flush_status;
+    }
   }
+  return status;
+}
 
-  Status status = response_writer_.Write(possible_logs.value().entries);
-  if (!status.ok()) {
-    // On a failure to send logs, track the dropped entries.
-    dropped_entries_ = possible_logs.value().entry_count;
-    return status;
+void Logs::Finish() {
+  for (Subscriber& subscriber : subscribers_) {
+    subscriber.writer_.Finish();
+    Detach(subscriber);
   }
+}
+
+Status Logs::FlushSubscriber(Subscriber& subscriber) {
+  const Status status = WritePackets(subscriber);
+
+  // Logs are read straight into the writer's payload buffer. If writing stopped
+  // before that buffer was sent, release it so the channel is not held until
+  // the next write.
+  subscriber.writer_.ReleaseBuffer();
+  return status;
+}
+
+Status Logs::WritePackets(Subscriber& subscriber) {
+  rpc::RawServerWriter& writer = subscriber.writer_;
+
+  // TODO(prashanthsw): Send drop counts to the client once the LogEntry proto
+  // has a field for them. For now, they are only counted.
+
+  // Write logs to the response writer. Each packet is filled with as many
+  // entries as fit in the payload buffer, and packets are written until the
+  // drain has no more entries. If writing a packet fails, the entries read for
+  // it are lost and counted as dropped.
+  while (true) {
+    // If the client has not granted credit for more logs, leave them in the
+    // multisink.
+    if (writer.flow_controlled() && writer.available_credit() == 0u) {
+      flushes_held_back_.Increment();
+      return Status::Unavailable();
+    }
+
+    // The entries are read into the payload buffer after room for the key
+    // and length of each, then moved forward as they are framed, so they are
+    // never copied through another buffer.
+    ByteSpan payload = writer.PayloadBuffer();
+    const size_t frame_size = varint::EncodedSize(kLogKey) +
+                              varint::EncodedSize(payload.size_bytes());
+    const size_t headroom = frame_size * kMaxEntriesPerPacket;
+    if (payload.size_bytes() <= headroom) {
+      return Status::ResourceExhausted();
+    }
+
+    std::array<ConstByteSpan, kMaxEntriesPerPacket> entries;
+    uint32_t drop_count = 0;
+    const StatusWithSize read = subscriber.drain_.GetEntries(
+        payload.subspan(headroom), entries, drop_count);
+    RecordDrops(subscriber, drop_count);
+    if (read.IsOutOfRange()) {
+      return OkStatus();
+    }
+    PW_TRY(read.status());
+
+    size_t size = 0;
+    for (size_t i = 0; i < read.size(); ++i) {
+      const ConstByteSpan entry = entries[i];
+      size += varint::Encode(kLogKey, payload.subspan(size));
+      size += varint::Encode(entry.size_bytes(), payload.subspan(size));
+      std::memmove(payload.data() + size, entry.data(), entry.size_bytes());
+      size += entry.size_bytes();
+    }
+
+    const uint32_t entry_count = static_cast<uint32_t>(read.size());
+    Status status = writer.Write(payload.first(size));
+    if (!status.ok()) {
+      RecordDrops(subscriber, entry_count);
+      return status;
+    }
+
+    entries_sent_.Increment(entry_count);
+    packets_sent_.Increment();
+  }
+}
+
+void Logs::Detach(Subscriber& subscriber) {
+  if (subscriber.attached_) {
+    multisink_.DetachDrain(subscriber.drain_);
+    subscriber.attached_ = false;
+  }
+}
 
-  return OkStatus();
+void Logs::RecordDrops(Subscriber& subscriber, uint32_t drop_count) {
+  subscriber.entries_dropped_ += drop_count;
+  entries_dropped_.Increment(drop_count);
 }
 
 }  // namespace pw::log_rpc
@@ -14,8 +14,12 @@
 
 #include "pw_log_rpc/logs_rpc.h"
 
+#include <array>
+#include <cstring>
+
 #include "gtest/gtest.h"
-#include "pw_log/log.h"
+#include "pw_log/proto/log.pwpb.h"
+#include "pw_protobuf/decoder.h"
 #include "pw_rpc/raw_test_method_context.h"
 
 namespace pw::log_rpc {
@@ -23,50 +27,88 @@ namespace {
 
 #define LOGS_METHOD_CONTEXT PW_RAW_TEST_METHOD_CONTEXT(Logs, Get)
 
-constexpr size_t kEncodeBufferSize = 128;
-constexpr size_t kLogBufferSize = 4096;
+constexpr size_t kMultiSinkBufferSize = 4096;
+constexpr size_t kSubscriberCount = 2;
+
+// The Logs service treats entries as opaque encoded LogEntry protos, so the
+// tests push short byte strings and check that they are framed correctly.
+constexpr char kEntry[] = "entry";
+constexpr char kOtherEntry[] = "other";
 
-class LogQueueTester : public LogQueueWithEncodeBuffer<kLogBufferSize> {
+// Accepts only entries that start with the given character.
+class FirstByteFilter : public multisink::MultiSink::Filter {
  public:
-  LogQueueTester(ByteSpan log_queue)
-      : LogQueueWithEncodeBuffer<kLogBufferSize>(log_queue) {}
+  constexpr FirstByteFilter(char first_byte) : first_byte_(first_byte) {}
 
-  void SetPopStatus(Status error_status) {
-    pop_status_for_test_ = error_status;
+ private:
+  bool Accept(ConstByteSpan entry) override {
+    return !entry.empty() && entry[0] == std::byte(first_byte_);
   }
+
+  char first_byte_;
 };
 
 class LogsService : public ::testing::Test {
  public:
-  LogsService() : log_queue_(log_queue_buffer_) {}
+  LogsService()
+      : multisink_(multisink_buffer_), other_multisink_(other_buffer_) {}
 
  protected:
-  void AddLogs(const size_t log_count = 1) {
-    constexpr char kTokenizedMessage[] = "message";
+  void AddLogs(size_t log_count = 1, const char* entry = kEntry) {
     for (size_t i = 0; i < log_count; i++) {
-      EXPECT_EQ(
-          OkStatus(),
-          log_queue_.PushTokenizedMessage(
-              std::as_bytes(std::span(kTokenizedMessage)), 0, 0, 0, 0, 0));
+      multisink_.HandleEntry(
+          std::as_bytes(std::span(entry, std::strlen(entry))));
+    }
+  }
+
+  // Counts the LogEntries entries in a response, checking that each is one of
+  // the entries pushed by AddLogs().
+  static size_t CountEntries(ConstByteSpan response) {
+    protobuf::Decoder decoder(response);
+    size_t count = 0;
+    while (decoder.Next().ok()) {
+      EXPECT_EQ(static_cast<uint32_t>(log::LogEntries::Fields::ENTRIES),
+                decoder.FieldNumber());
+      ConstByteSpan entry;
+      EXPECT_EQ(OkStatus(), decoder.ReadBytes(&entry));
+      EXPECT_EQ(std::strlen(kEntry), entry.size());
+      count += 1;
     }
+    return count;
+  }
+
+  static size_t CountEntries(LOGS_METHOD_CONTEXT& context) {
+    size_t count = 0;
+    for (ConstByteSpan response : context.responses()) {
+      count += CountEntries(response);
+    }
+    return count;
   }
 
   static Logs& GetLogs(LOGS_METHOD_CONTEXT& context) {
     return (Logs&)(context.service());
   }
 
-  std::array<std::byte, kEncodeBufferSize> log_queue_buffer_;
-  LogQueueWithEncodeBuffer<kLogBufferSize> log_queue_;
+  std::array<std::byte, kMultiSinkBufferSize> multisink_buffer_ = {};
+  multisink::MultiSink multisink_;
+  std::array<Logs::Subscriber, kSubscriberCount> subscribers_;
+
+  // Other clients' streams are recorded by contexts with their own service,
+  // which is not flushed.
+  std::array<std::byte, 64> other_buffer_ = {};
+  multisink::MultiSink other_multisink_;
+  std::array<Logs::Subscriber, 1> other_subscribers_;
 };
 
 TEST_F(LogsService, Get) {
   constexpr size_t kLogEntryCount = 3;
   std::array<std::byte, 1> rpc_buffer;
-  LOGS_METHOD_CONTEXT context(log_queue_);
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
 
   context.call(rpc_buffer);
+  EXPECT_TRUE(subscribers_[0].active());
 
-  // Flush all logs from the buffer, then close the RPC.
+  // Flush all logs from the multisink, then close the RPC.
   AddLogs(kLogEntryCount);
   GetLogs(context).Flush();
   GetLogs(context).Finish();
@@ -74,16 +116,17 @@ TEST_F(LogsService, Get) {
   EXPECT_TRUE(context.done());
   EXPECT_EQ(OkStatus(), context.status());
 
-  // Although |kLogEntryCount| messages were in the queue, they are batched
+  // Although |kLogEntryCount| messages were in the multisink, they are batched
   // before being written to the client, so there is only one response.
-  EXPECT_EQ(1U, context.total_responses());
+  ASSERT_EQ(1U, context.total_responses());
+  EXPECT_EQ(kLogEntryCount, CountEntries(context.responses()[0]));
 }
 
 TEST_F(LogsService, GetMultiple) {
   constexpr size_t kLogEntryCount = 1;
   constexpr size_t kFlushCount = 3;
   std::array<std::byte, 1> rpc_buffer;
-  LOGS_METHOD_CONTEXT context(log_queue_);
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
 
   context.call(rpc_buffer);
 
@@ -98,11 +141,35 @@ TEST_F(LogsService, GetMultiple) {
   EXPECT_EQ(kFlushCount, context.total_responses());
 }
 
-TEST_F(LogsService, NoEntriesOnEmptyQueue) {
+TEST_F(LogsService, FlushFillsPackets) {
+  constexpr size_t kLogEntryCount = 20;
   std::array<std::byte, 1> rpc_buffer;
-  LOGS_METHOD_CONTEXT context(log_queue_);
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
 
-  // Invoking flush with no logs in the queue should behave like a no-op.
+  context.call(rpc_buffer);
+
+  // A single flush writes every new entry, packing several entries into each
+  // packet.
+  AddLogs(kLogEntryCount);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  EXPECT_GT(context.total_responses(), 1u);
+  EXPECT_LT(context.total_responses(), kLogEntryCount);
+  EXPECT_EQ(kLogEntryCount, GetLogs(context).entries_sent());
+  EXPECT_EQ(context.total_responses(), GetLogs(context).packets_sent());
+  EXPECT_EQ(0u, GetLogs(context).entries_dropped());
+
+  // There are no new entries, so another flush sends nothing.
+  const size_t responses = context.total_responses();
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  EXPECT_EQ(responses, context.total_responses());
+}
+
+TEST_F(LogsService, NoEntriesOnEmptyMultiSink) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+
+  // Invoking flush with no logs in the multisink should behave like a no-op.
   context.call(rpc_buffer);
   GetLogs(context).Flush();
   GetLogs(context).Finish();
@@ -112,20 +179,176 @@ TEST_F(LogsService, NoEntriesOnEmptyQueue) {
   EXPECT_EQ(0U, context.total_responses());
 }
 
-TEST_F(LogsService, QueueError) {
+TEST_F(LogsService, NoStreamFlushIsNoOp) {
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+
+  AddLogs(3);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  EXPECT_EQ(0u, GetLogs(context).entries_sent());
+  EXPECT_EQ(0u, GetLogs(context).entries_dropped());
+}
+
+TEST_F(LogsService, OnlyLogsAfterGetAreSent) {
   std::array<std::byte, 1> rpc_buffer;
-  LogQueueTester log_queue_tester(log_queue_buffer_);
-  LOGS_METHOD_CONTEXT context(log_queue_tester);
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+
+  AddLogs(2);
+  context.call(rpc_buffer);
+  AddLogs(1);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  ASSERT_EQ(1u, context.total_responses());
+  EXPECT_EQ(1u, CountEntries(context.responses()[0]));
+}
+
+TEST_F(LogsService, MultipleSubscribersEachGetAllEntries) {
+  constexpr size_t kLogEntryCount = 3;
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+
+  LOGS_METHOD_CONTEXT other_context(other_multisink_, other_subscribers_);
+
+  context.call(rpc_buffer);
+  EXPECT_EQ(OkStatus(), GetLogs(context).AddStream(other_context.writer()));
+  EXPECT_TRUE(subscribers_[0].active());
+  EXPECT_TRUE(subscribers_[1].active());
+
+  AddLogs(kLogEntryCount);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  EXPECT_EQ(kLogEntryCount, CountEntries(context));
+  EXPECT_EQ(kLogEntryCount, CountEntries(other_context));
+  EXPECT_EQ(2 * kLogEntryCount, GetLogs(context).entries_sent());
+}
+
+TEST_F(LogsService, SubscribersHaveIndependentPositions) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+  LOGS_METHOD_CONTEXT other_context(other_multisink_, other_subscribers_);
+
+  context.call(rpc_buffer);
+  AddLogs(2);
+
+  // The second client joins after the first entries, so it only receives the
+  // entries that arrive after it.
+  EXPECT_EQ(OkStatus(), GetLogs(context).AddStream(other_context.writer()));
+  AddLogs(1);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  EXPECT_EQ(3u, CountEntries(context));
+  EXPECT_EQ(1u, CountEntries(other_context));
+}
+
+TEST_F(LogsService, FilterPerSubscriber) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+  LOGS_METHOD_CONTEXT other_context(other_multisink_, other_subscribers_);
+
+  // The second subscriber only accepts entries that start with 'e'.
+  FirstByteFilter filter(kEntry[0]);
+  subscribers_[1].SetFilter(&filter);
+
+  context.call(rpc_buffer);
+  EXPECT_EQ(OkStatus(), GetLogs(context).AddStream(other_context.writer()));
+  AddLogs(2, kEntry);
+  AddLogs(3, kOtherEntry);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  EXPECT_EQ(7u, GetLogs(context).entries_sent());
+  EXPECT_EQ(2u, CountEntries(other_context));
+
+  // Filtered entries are not counted as dropped.
+  EXPECT_EQ(0u, subscribers_[1].entries_dropped());
+}
+
+TEST_F(LogsService, AllSubscribersInUse) {
+  std::array<std::byte, 1> rpc_buffer;
+  std::array<Logs::Subscriber, 1> subscribers;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers);
+  LOGS_METHOD_CONTEXT other_context(other_multisink_, other_subscribers_);
+
+  context.call(rpc_buffer);
+  EXPECT_EQ(Status::ResourceExhausted(),
+            GetLogs(context).AddStream(other_context.writer()));
+  EXPECT_EQ(1u, GetLogs(context).streams_rejected());
+
+  // The rejected stream is closed with the error.
+  EXPECT_TRUE(other_context.done());
+  EXPECT_EQ(Status::ResourceExhausted(), other_context.status());
+
+  // The first stream is unaffected.
+  AddLogs(1);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  EXPECT_EQ(1u, context.total_responses());
+}
+
+TEST_F(LogsService, SubscriberFreedWhenStreamCloses) {
+  std::array<std::byte, 1> rpc_buffer;
+  std::array<Logs::Subscriber, 1> subscribers;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers);
 
-  // Generate failure on log queue.
-  log_queue_tester.SetPopStatus(Status::Internal());
   context.call(rpc_buffer);
-  GetLogs(context).Flush();
   GetLogs(context).Finish();
+  EXPECT_FALSE(subscribers[0].active());
 
-  EXPECT_TRUE(context.done());
-  EXPECT_EQ(OkStatus(), context.status());
-  EXPECT_EQ(0U, context.total_responses());
+  // Entries that arrive while no stream is open are not sent to the next one.
+  AddLogs(2);
+  context.call(rpc_buffer);
+  EXPECT_TRUE(subscribers[0].active());
+  AddLogs(1);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  ASSERT_EQ(1u, context.total_responses());
+  EXPECT_EQ(1u, CountEntries(context.responses()[0]));
+  EXPECT_EQ(0u, subscribers[0].entries_dropped());
+}
+
+TEST_F(LogsService, DropsCountedPerSubscriber) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+
+  context.call(rpc_buffer);
+  AddLogs(1);
+  multisink_.HandleDropped(3);
+  AddLogs(1);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+
+  EXPECT_EQ(2u, GetLogs(context).entries_sent());
+  EXPECT_EQ(3u, subscribers_[0].entries_dropped());
+  EXPECT_EQ(3u, GetLogs(context).entries_dropped());
+}
+
+TEST_F(LogsService, BufferReleasedWhenOnlyDropsAreRead) {
+  std::array<std::byte, 1> rpc_buffer;
+  LOGS_METHOD_CONTEXT context(multisink_, subscribers_);
+
+  context.call(rpc_buffer);
+  multisink_.HandleDropped(2);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  EXPECT_EQ(0u, context.total_responses());
+  EXPECT_EQ(2u, subscribers_[0].entries_dropped());
+  EXPECT_FALSE(context.buffer_held());
+
+  // The stream still writes new entries.
+  AddLogs(1);
+  EXPECT_EQ(OkStatus(), GetLogs(context).Flush());
+  ASSERT_EQ(1u, context.total_responses());
+  EXPECT_EQ(1u, CountEntries(context.responses()[0]));
+  EXPECT_FALSE(context.buffer_held());
+}
+
+TEST_F(LogsService, BufferReleasedWhenPayloadBufferTooSmall) {
+  std::array<std::byte, 1> rpc_buffer;
+  // The packet buffer leaves no room for entries after the packet header.
+  using SmallBufferContext = PW_RAW_TEST_METHOD_CONTEXT(Logs, Get, 4, 24);
+  SmallBufferContext context(multisink_, subscribers_);
+
+  context.call(rpc_buffer);
+  AddLogs(1);
+  EXPECT_EQ(Status::ResourceExhausted(),
+            static_cast<Logs&>(context.service()).Flush());
+  EXPECT_EQ(0u, context.total_responses());
+  EXPECT_FALSE(context.buffer_held());
 }
 
 }  // namespace
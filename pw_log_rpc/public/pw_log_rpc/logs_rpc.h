@@ -14,39 +14,147 @@
 
 #pragma once
 
-#include "pw_log/log.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
 #include "pw_log/proto/log.raw_rpc.pb.h"
-#include "pw_log_multisink/log_queue.h"
+#include "pw_metric/metric.h"
+#include "pw_multisink/multisink.h"
+#include "pw_status/status.h"
 
 namespace pw::log_rpc {
 
-// The Logs RPC service will send logs when requested by Get(). For now, Get()
-// requests result in a stream of responses, containing all log entries from
-// the attached log queue.
+// The Logs RPC service streams logs from a MultiSink to its clients. Each
+// Get() request is assigned one of the service's subscribers, which reads the
+// multisink through its own drain. Every client therefore has its own position
+// in the log stream, drop count, and filter, while the entries are stored only
+// once in the multisink.
 //
-// The Get() method will return logs in the current queue immediately, but
-// someone else is responsible for pumping the log queue using Flush().
+// The Get() method returns immediately; someone else is responsible for
+// sending the logs to the clients using Flush().
 class Logs final : public pw::log::generated::Logs<Logs> {
  public:
-  Logs(LogQueue& log_queue) : log_queue_(log_queue), dropped_entries_(0) {}
+  // The maximum number of log entries sent in one packet.
+  static constexpr size_t kMaxEntriesPerPacket = 8;
+
+  // The state of one client's log stream. The service is given a fixed set of
+  // subscribers, which limits how many clients can stream logs at once. A
+  // subscriber becomes free again when its stream is closed.
+  class Subscriber {
+   public:
+    Subscriber() = default;
+
+    Subscriber(const Subscriber&) = delete;
+    Subscriber& operator=(const Subscriber&) = delete;
+
+    // Sets the filter for the entries sent by this subscriber, or removes it
+    // if `filter` is null. The filter applies to every stream that is assigned
+    // this subscriber, and must outlive its use.
+    void SetFilter(multisink::MultiSink::Filter* filter) {
+      drain_.SetFilter(filter);
+    }
+
+    // True if a client is streaming logs through this subscriber.
+    bool active() const { return writer_.open(); }
+
+    // Entries that were not sent to the current client, either because the
+    // multisink dropped them before they were read, or because writing them
+    // failed.
+    uint32_t entries_dropped() const { return entries_dropped_; }
+
+   private:
+    friend class Logs;
+
+    multisink::MultiSink::Drain drain_;
+    rpc::RawServerWriter writer_;
+    bool attached_ = false;
+    uint32_t entries_dropped_ = 0;
+  };
+
+  Logs(multisink::MultiSink& multisink, std::span<Subscriber> subscribers)
+      : multisink_(multisink), subscribers_(subscribers) {}
+
+  ~Logs();
 
   // RPC API for the Logs that produces a log stream. This method will
   // return immediately, another class must call Flush() to push logs from
-  // the queue to this stream.
-  void Get(ServerContext&, ConstByteSpan, rpc::RawServerWriter& writer);
+  // the multisink to this stream. Only logs that arrive after the call are
+  // sent. If all subscribers are in use, the stream is finished with
+  // RESOURCE_EXHAUSTED.
+  void Get(ServerContext&, ConstByteSpan, rpc::RawServerWriter& writer) {
+    AddStream(std::move(writer)).IgnoreError();
+  }
+
+  // Assigns an open writer to a free subscriber, as if it had called Get().
+  //
+  // Returns:
+  //
+  //  OK - the writer was assigned a subscriber.
+  //  RESOURCE_EXHAUSTED - all subscribers are in use. The writer is finished
+  //  with this status.
+  Status AddStream(rpc::RawServerWriter&& writer);
 
-  // Interface for the owner of the service instance to flush all existing
-  // logs to the writer, if one is attached.
+  // Interface for the owner of the service instance to flush all new logs to
+  // each open stream. Logs are batched into as few packets as possible, each
+  // filled up to the writer's payload buffer size.
+  //
+  // If a client uses flow control, packets are only sent to it while credit is
+  // available; its remaining logs stay in the multisink for a later flush.
+  //
+  // Returns:
+  //
+  //  OK - all logs were written to every stream, or no stream is open.
+  //  UNAVAILABLE - a client has not granted credit for its remaining logs.
+  //  Other errors from the multisink or writer. Logs that failed to be
+  //  written are counted as dropped.
+  //
+  // If several streams fail, the first error is returned. The other streams
+  // are still flushed.
   Status Flush();
 
-  // Interface for the owner of the service instance to close the RPC, if
-  // one is attached.
-  void Finish() { response_writer_.Finish(); }
+  // Interface for the owner of the service instance to close all open
+  // streams.
+  void Finish();
+
+  uint32_t entries_sent() const { return entries_sent_.value(); }
+  uint32_t packets_sent() const { return packets_sent_.value(); }
+
+  // Entries that were not sent to a client, summed over all subscribers.
+  uint32_t entries_dropped() const { return entries_dropped_.value(); }
+
+  // Flushes of a stream that stopped because the client had not granted
+  // credit.
+  uint32_t flushes_held_back() const { return flushes_held_back_.value(); }
+
+  // Streams that were rejected because all subscribers were in use.
+  uint32_t streams_rejected() const { return streams_rejected_.value(); }
+
+  metric::Group& metrics() { return metrics_; }
 
  private:
-  LogQueue& log_queue_;
-  rpc::RawServerWriter response_writer_;
-  size_t dropped_entries_;
+  // Writes the subscriber's new logs to its stream.
+  Status FlushSubscriber(Subscriber& subscriber);
+
+  // Writes packets of logs until the drain is empty or a write fails. May
+  // return with the writer's payload buffer still held.
+  Status WritePackets(Subscriber& subscriber);
+
+  // Detaches the subscriber's drain from the multisink, if it is attached.
+  void Detach(Subscriber& subscriber);
+
+  void RecordDrops(Subscriber& subscriber, uint32_t drop_count);
+
+  multisink::MultiSink& multisink_;
+  std::span<Subscriber> subscribers_;
+
+  PW_METRIC_GROUP(metrics_, "log_rpc");
+  PW_METRIC(metrics_, entries_sent_, "entries_sent", 0u);
+  PW_METRIC(metrics_, packets_sent_, "packets_sent", 0u);
+  PW_METRIC(metrics_, entries_dropped_, "entries_dropped", 0u);
+  PW_METRIC(metrics_, flushes_held_back_, "flushes_held_back", 0u);
+  PW_METRIC(metrics_, streams_rejected_, "streams_rejected", 0u);
 };
 
 }  // namespace pw::log_rpc
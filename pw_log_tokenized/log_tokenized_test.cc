@@ -49,7 +49,7 @@ TEST(LogTokenized, LogMetadata_LevelTooLarge_Clamps) {
     EXPECT_EQ(metadata.level(), 7u);
     EXPECT_EQ(metadata.flags(), 0u);
     EXPECT_EQ(metadata.module(), kModuleToken);
-    EXPECT_TRUE(metadata.line_number() == 55u || metadata.line_number() == 45u);
+    EXPECT_TRUE(metadata.line_number() == 55u || metadata.line_number() == 52u);
   };
 
   PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(8, 0, "hello");
@@ -65,7 +65,7 @@ TEST(LogTokenized, LogMetadata_TooManyFlags_Truncates) {
     EXPECT_EQ(metadata.level(), 1u);
     EXPECT_EQ(metadata.flags(), 0b11u);
     EXPECT_EQ(metadata.module(), kModuleToken);
-    EXPECT_TRUE(metadata.line_number() == 71u || metadata.line_number() == 49u);
+    EXPECT_TRUE(metadata.line_number() == 71u || metadata.line_number() == 56u);
   };
 
   PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(1, 0xFFFFFFFF, "hello");
@@ -82,7 +82,7 @@ TEST(LogTokenized, LogMetadata_VariousValues) {
     EXPECT_EQ(metadata.flags(), 3u);
     EXPECT_EQ(metadata.module(), kModuleToken);
     EXPECT_EQ(last_log.arg_count, 1u);
-    EXPECT_TRUE(metadata.line_number() == 88u || metadata.line_number() == 53u);
+    EXPECT_TRUE(metadata.line_number() == 88u || metadata.line_number() == 60u);
   };
 
   PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(6, 3, "hello%s", "?");
@@ -100,7 +100,7 @@ TEST(LogTokenized, LogMetadata_Zero) {
     EXPECT_EQ(metadata.module(), kModuleToken);
     EXPECT_EQ(last_log.arg_count, 0u);
     EXPECT_TRUE(metadata.line_number() == 106u ||
-                metadata.line_number() == 57u);
+                metadata.line_number() == 64u);
   };
 
   PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(0, 0, "hello");
@@ -136,5 +136,79 @@ TEST(LogTokenized, LogMetadata_LineNumberTooLarge_IsZero) {
   EXPECT_EQ(Metadata(last_log.metadata).line_number(), 0u);
 }
 
+TEST(LogTokenized, EveryN) {
+  captured_log_count = 0;
+  for (int i = 0; i < 10; ++i) {
+    PW_LOG_TOKENIZED_EVERY_N(3, 1, 0, "hello %d", i);
+  }
+  EXPECT_EQ(captured_log_count, 4u);
+
+  captured_log_count = 0;
+  for (int i = 0; i < 4; ++i) {
+    pw_log_tokenized_Test_EveryN();
+  }
+  EXPECT_EQ(captured_log_count, 2u);
+}
+
+TEST(LogTokenized, EveryN_ArgumentsOnlyEvaluatedWhenLogged) {
+  int evaluated = 0;
+  for (int i = 0; i < 6; ++i) {
+    PW_LOG_TOKENIZED_EVERY_N(2, 1, 0, "hello %d", ++evaluated);
+  }
+  EXPECT_EQ(evaluated, 3);
+}
+
+TEST(LogTokenized, RateLimited) {
+  captured_log_count = 0;
+  rate_limit_time_ms = 1000;
+  auto log = [] { PW_LOG_TOKENIZED_RATE_LIMITED(2, 100, 1, 3, "hello %d", 1); };
+
+  for (int i = 0; i < 5; ++i) {
+    log();
+  }
+  EXPECT_EQ(captured_log_count, 2u);
+
+  rate_limit_time_ms += 99;
+  log();
+  EXPECT_EQ(captured_log_count, 2u);
+
+  // In the next period, the suppressed count is logged before the message.
+  rate_limit_time_ms += 1;
+  log();
+  ASSERT_EQ(captured_log_count, 4u);
+  EXPECT_STREQ(previous_log.format_string,
+               "■msg♦Suppressed %u messages■module♦log module name!■file♦"
+               __FILE__);
+  EXPECT_EQ(previous_log.arg_count, 1u);
+  EXPECT_EQ(Metadata(previous_log.metadata).flags(), 3u);
+  EXPECT_STREQ(last_log.format_string,
+               "■msg♦hello %d■module♦log module name!■file♦" __FILE__);
+
+  // Nothing was suppressed, so the count is not logged again.
+  log();
+  EXPECT_EQ(captured_log_count, 5u);
+}
+
+TEST(LogTokenized, RateLimited_ArgumentsOnlyEvaluatedWhenLogged) {
+  rate_limit_time_ms = 5000;
+  int evaluated = 0;
+  for (int i = 0; i < 6; ++i) {
+    PW_LOG_TOKENIZED_RATE_LIMITED(1, 10, 1, 0, "hello %d", ++evaluated);
+  }
+  EXPECT_EQ(evaluated, 1);
+}
+
+TEST(LogTokenized, RateLimited_C) {
+  rate_limit_time_ms = 2000;
+  captured_log_count = 0;
+  pw_log_tokenized_Test_RateLimited();
+  pw_log_tokenized_Test_RateLimited();
+  EXPECT_EQ(captured_log_count, 1u);
+
+  rate_limit_time_ms += 10;
+  pw_log_tokenized_Test_RateLimited();
+  EXPECT_EQ(captured_log_count, 3u);
+}
+
 }  // namespace
 }  // namespace pw::log_tokenized
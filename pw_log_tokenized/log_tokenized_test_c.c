@@ -29,16 +29,23 @@
 #include "pw_log_tokenized_private/test_utils.h"
 
 pw_log_tokenized_CapturedLog last_log;
+pw_log_tokenized_CapturedLog previous_log;
+size_t captured_log_count;
+uint32_t rate_limit_time_ms;
 
 void pw_log_tokenized_CaptureArgs(uintptr_t payload,
                                   size_t arg_count,
                                   const char* message,
                                   ...) {
+  previous_log = last_log;
+  captured_log_count += 1;
   last_log.metadata = payload;
   last_log.format_string = message;
   last_log.arg_count = arg_count;
 }
 
+uint32_t pw_log_tokenized_RateLimitTimeMs(void) { return rate_limit_time_ms; }
+
 // These functions correspond to tests in log_tokenized_test.cc. The tests call
 // these functions and check the results.
 void pw_log_tokenized_Test_LogMetadata_LevelTooLarge_Clamps(void) {
@@ -56,3 +63,11 @@ void pw_log_tokenized_Test_LogMetadata_LogMetadata_VariousValues(void) {
 void pw_log_tokenized_Test_LogMetadata_LogMetadata_Zero(void) {
   PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(0, 0, "hello");
 }
+
+void pw_log_tokenized_Test_EveryN(void) {
+  PW_LOG_TOKENIZED_EVERY_N(2, 1, 0, "hello");
+}
+
+void pw_log_tokenized_Test_RateLimited(void) {
+  PW_LOG_TOKENIZED_RATE_LIMITED(1, 10, 1, 0, "hello %d", 1);
+}
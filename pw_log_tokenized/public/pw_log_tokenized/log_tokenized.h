@@ -16,6 +16,7 @@
 #include <stdint.h>
 
 #include "pw_log_tokenized/config.h"
+#include "pw_preprocessor/util.h"
 #include "pw_tokenizer/tokenize_to_global_handler_with_payload.h"
 
 // TODO(hepler): Remove this include.
@@ -63,6 +64,76 @@
         __VA_ARGS__);                                                        \
   } while (0)
 
+// Logs only the first of every n calls from this call site. This is useful for
+// logs in tight loops. The number of skipped calls is always n - 1, so it is
+// not reported. The log's arguments are only evaluated for calls that are
+// logged.
+//
+// Each call site uses two bytes of static storage, so n may be up to 65535.
+// The count is not synchronized; calls from multiple threads may occasionally
+// log more or less often than once every n calls.
+#define PW_LOG_TOKENIZED_EVERY_N(n, level, flags, message, ...)              \
+  do {                                                                       \
+    static uint16_t _pw_log_tokenized_calls = 0;                             \
+    if (_pw_log_tokenized_calls == 0u) {                                     \
+      PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(                       \
+          level, flags, message, __VA_ARGS__);                               \
+    }                                                                        \
+    if (++_pw_log_tokenized_calls >= (n)) {                                  \
+      _pw_log_tokenized_calls = 0;                                           \
+    }                                                                        \
+  } while (0)
+
+// Logs at most max_count messages from this call site per period_ms
+// milliseconds. Calls beyond that are suppressed, and their arguments are not
+// evaluated. The next call that is logged is preceded by a message with the
+// same level and flags that reports how many messages were suppressed, so
+// suppressed messages are not lost silently.
+//
+// Each call site uses eight bytes of static storage. Counts are saturated at
+// 65535. The state is not synchronized; calls from multiple threads may
+// occasionally miscount.
+//
+// Time is read from pw_log_tokenized_RateLimitTimeMs(), which must be
+// implemented by the application to use this macro.
+#define PW_LOG_TOKENIZED_RATE_LIMITED(                                       \
+    max_count, period_ms, level, flags, message, ...)                        \
+  do {                                                                       \
+    static uint32_t _pw_log_tokenized_period_start = 0;                      \
+    static uint16_t _pw_log_tokenized_logged = 0;                            \
+    static uint16_t _pw_log_tokenized_suppressed = 0;                        \
+    const uint32_t _pw_log_tokenized_now =                                   \
+        pw_log_tokenized_RateLimitTimeMs();                                  \
+    if (_pw_log_tokenized_now - _pw_log_tokenized_period_start >=            \
+        (uint32_t)(period_ms)) {                                             \
+      _pw_log_tokenized_period_start = _pw_log_tokenized_now;                \
+      _pw_log_tokenized_logged = 0;                                          \
+    }                                                                        \
+    if (_pw_log_tokenized_logged < (max_count)) {                            \
+      _pw_log_tokenized_logged += 1;                                         \
+      if (_pw_log_tokenized_suppressed != 0u) {                              \
+        PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(                     \
+            level,                                                           \
+            flags,                                                           \
+            "Suppressed %u messages",                                        \
+            (unsigned)_pw_log_tokenized_suppressed);                         \
+        _pw_log_tokenized_suppressed = 0;                                    \
+      }                                                                      \
+      PW_LOG_TOKENIZED_TO_GLOBAL_HANDLER_WITH_PAYLOAD(                       \
+          level, flags, message, __VA_ARGS__);                               \
+    } else if (_pw_log_tokenized_suppressed != UINT16_MAX) {                 \
+      _pw_log_tokenized_suppressed += 1;                                     \
+    }                                                                        \
+  } while (0)
+
+PW_EXTERN_C_START
+
+// Returns the current time in milliseconds for PW_LOG_TOKENIZED_RATE_LIMITED.
+// The time must increase monotonically, but may wrap around.
+uint32_t pw_log_tokenized_RateLimitTimeMs(void);
+
+PW_EXTERN_C_END
+
 // If the level field is present, clamp it to the maximum value.
 #if PW_LOG_TOKENIZED_LEVEL_BITS == 0
 #define _PW_LOG_TOKENIZED_LEVEL(value) ((uintptr_t)0)
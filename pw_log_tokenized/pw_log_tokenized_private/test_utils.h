@@ -37,6 +37,11 @@ typedef struct {
 } pw_log_tokenized_CapturedLog;
 
 extern pw_log_tokenized_CapturedLog last_log;
+extern pw_log_tokenized_CapturedLog previous_log;
+extern size_t captured_log_count;
+
+// Time returned by pw_log_tokenized_RateLimitTimeMs().
+extern uint32_t rate_limit_time_ms;
 
 void pw_log_tokenized_CaptureArgs(uintptr_t payload,
                                   size_t arg_count,
@@ -48,5 +53,7 @@ void pw_log_tokenized_Test_LogMetadata_LevelTooLarge_Clamps(void);
 void pw_log_tokenized_Test_LogMetadata_TooManyFlags_Truncates(void);
 void pw_log_tokenized_Test_LogMetadata_LogMetadata_VariousValues(void);
 void pw_log_tokenized_Test_LogMetadata_LogMetadata_Zero(void);
+void pw_log_tokenized_Test_EveryN(void);
+void pw_log_tokenized_Test_RateLimited(void);
 
 PW_EXTERN_C_END
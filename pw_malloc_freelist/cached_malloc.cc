@@ -0,0 +1,100 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <span>
+
+#include "pw_allocator/freelist.h"
+#include "pw_allocator/freelist_heap.h"
+#include "pw_boot_armv7m/boot.h"
+#include "pw_malloc/malloc.h"
+#include "pw_malloc_freelist/cached_malloc.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_preprocessor/util.h"
+#include "pw_sync/mutex.h"
+
+namespace {
+using pw::allocator::FreeListHeap;
+using pw::allocator::FreeListHeapBuffer;
+using FreeList = pw::allocator::FreeListBuffer<
+    FreeListHeapBuffer<>::defaultBuckets.size()>;
+
+std::aligned_storage_t<sizeof(FreeList), alignof(FreeList)> freelist_buf;
+std::aligned_storage_t<sizeof(FreeListHeap), alignof(FreeListHeap)> heap_buf;
+std::aligned_storage_t<sizeof(pw::sync::Mutex), alignof(pw::sync::Mutex)>
+    lock_buf;
+pw::sync::Mutex* heap_lock;
+}  // namespace
+FreeListHeap* pw_cached_heap;
+
+// Each thread gets its own cache, which returns its blocks to the heap when the
+// thread exits.
+PwMallocThreadCache& pw_MallocThreadCache() {
+  thread_local PwMallocThreadCache cache(*pw_cached_heap, *heap_lock);
+  return cache;
+}
+
+#if __cplusplus
+extern "C" {
+#endif  // __cplusplus
+// Define the global heap variables.
+void pw_MallocInit() {
+  // pw_boot_heap_low_addr and pw_boot_heap_high_addr specifies the heap region
+  // from the linker script in "pw_boot_armv7m".
+  std::span<std::byte> pw_allocator_cached_raw_heap =
+      std::span(reinterpret_cast<std::byte*>(&pw_boot_heap_low_addr),
+                &pw_boot_heap_high_addr - &pw_boot_heap_low_addr);
+  FreeList* freelist =
+      new (&freelist_buf) FreeList(FreeListHeapBuffer<>::defaultBuckets);
+  pw_cached_heap =
+      new (&heap_buf) FreeListHeap(pw_allocator_cached_raw_heap, *freelist);
+  heap_lock = new (&lock_buf) pw::sync::Mutex();
+}
+
+// Wrapper functions for malloc, free, realloc and calloc.
+// With linker options "-Wl --wrap=<function name>", linker will link
+// "__wrap_<function name>" with "<function_name>", and calling
+// "<function name>" will call "__wrap_<function name>" instead
+// Linker options are set in a config in "pw_malloc:pw_malloc_config".
+void* __wrap_malloc(size_t size) {
+  return pw_MallocThreadCache().Allocate(size);
+}
+
+void __wrap_free(void* ptr) { pw_MallocThreadCache().Free(ptr); }
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  return pw_MallocThreadCache().Realloc(ptr, size);
+}
+
+void* __wrap_calloc(size_t num, size_t size) {
+  return pw_MallocThreadCache().Calloc(num, size);
+}
+
+void* __wrap__malloc_r(struct _reent*, size_t size) {
+  return pw_MallocThreadCache().Allocate(size);
+}
+
+void __wrap__free_r(struct _reent*, void* ptr) {
+  pw_MallocThreadCache().Free(ptr);
+}
+
+void* __wrap__realloc_r(struct _reent*, void* ptr, size_t size) {
+  return pw_MallocThreadCache().Realloc(ptr, size);
+}
+
+void* __wrap__calloc_r(struct _reent*, size_t num, size_t size) {
+  return pw_MallocThreadCache().Calloc(num, size);
+}
+#if __cplusplus
+}
+#endif  // __cplusplus
@@ -0,0 +1,45 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_malloc_freelist/cached_malloc.h"
+
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+
+TEST(CachedMalloc, FreedBlockIsCachedForThread) {
+  constexpr size_t kSmallSize = 48;
+
+  void* ptr = malloc(kSmallSize);
+  ASSERT_NE(ptr, nullptr);
+  const size_t cached = pw_MallocThreadCache().cached_count(kSmallSize);
+
+  free(ptr);
+  EXPECT_EQ(pw_MallocThreadCache().cached_count(kSmallSize), cached + 1);
+  EXPECT_EQ(malloc(kSmallSize), ptr);
+  free(ptr);
+}
+
+TEST(CachedMalloc, LargeAllocationsAreNotCached) {
+  constexpr size_t kLargeSize = 512;
+
+  void* ptr = malloc(kLargeSize);
+  ASSERT_NE(ptr, nullptr);
+  free(ptr);
+  EXPECT_EQ(pw_MallocThreadCache().cached_count(kLargeSize), 0u);
+}
+
+}  // namespace pw::allocator
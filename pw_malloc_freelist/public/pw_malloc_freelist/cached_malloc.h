@@ -0,0 +1,26 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_allocator/freelist_heap.h"
+#include "pw_allocator/thread_cache.h"
+#include "pw_sync/mutex.h"
+
+using PwMallocThreadCache = pw::allocator::ThreadCache<pw::sync::Mutex>;
+
+// Global variables to initialize a heap shared by per-thread caches.
+extern pw::allocator::FreeListHeap* pw_cached_heap;
+
+// Returns the calling thread's cache, creating it on first use.
+PwMallocThreadCache& pw_MallocThreadCache();
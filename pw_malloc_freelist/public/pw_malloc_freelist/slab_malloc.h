@@ -0,0 +1,26 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_allocator/slab_heap.h"
+
+// The size classes of the slab heap used by the slab malloc backend.
+inline constexpr std::array<pw::allocator::SlabHeap::Slab, 3> kPwMallocSlabs = {
+    pw::allocator::SlabHeap::Slab(32, 16),
+    pw::allocator::SlabHeap::Slab(64, 16),
+    pw::allocator::SlabHeap::Slab(128, 8),
+};
+
+// Global variables to initialize a slab heap.
+extern pw::allocator::SlabHeapBuffer<kPwMallocSlabs.size()>* pw_slab_heap;
@@ -0,0 +1,57 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_malloc_freelist/slab_malloc.h"
+
+#include <cstdlib>
+
+#include "gtest/gtest.h"
+
+namespace pw::allocator {
+
+TEST(SlabMalloc, SmallAllocationsUseSlabs) {
+  constexpr size_t kSmallSize = 48;
+
+  void* ptr = malloc(kSmallSize);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(pw_slab_heap->slabs()[1].slots_used(), 1u);
+
+  free(ptr);
+  EXPECT_EQ(pw_slab_heap->slabs()[1].slots_used(), 0u);
+}
+
+TEST(SlabMalloc, LargeAllocationsUseFreeListHeap) {
+  constexpr size_t kLargeSize = 512;
+
+  void* ptr = malloc(kLargeSize);
+  ASSERT_NE(ptr, nullptr);
+  for (const SlabHeap::Slab& slab : pw_slab_heap->slabs()) {
+    EXPECT_EQ(slab.slots_used(), 0u);
+  }
+  free(ptr);
+}
+
+TEST(SlabMalloc, ReallocMovesToLargerSlot) {
+  void* ptr1 = malloc(16);
+  ASSERT_NE(ptr1, nullptr);
+  EXPECT_EQ(pw_slab_heap->slabs()[0].slots_used(), 1u);
+
+  void* ptr2 = realloc(ptr1, 100);
+  ASSERT_NE(ptr2, nullptr);
+  EXPECT_EQ(pw_slab_heap->slabs()[0].slots_used(), 0u);
+  EXPECT_EQ(pw_slab_heap->slabs()[2].slots_used(), 1u);
+  free(ptr2);
+}
+
+}  // namespace pw::allocator
@@ -15,6 +15,8 @@
 #include "pw_metric/metric.h"
 
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <span>
 
 #include "pw_assert/check.h"
@@ -42,6 +44,58 @@ struct Base64EncodedToken {
   std::array<char, 16> data;
 };
 
+// ARMv6-M (Cortex-M0/M0+) has no exclusive load/store instructions, so atomic
+// read-modify-writes are made by masking interrupts instead. This is atomic on
+// single core parts, which is all ARMv6-M supports.
+#if defined(__ARM_ARCH_6M__)
+
+uint32_t AtomicAdd(std::atomic<uint32_t>& value, uint32_t amount) {
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n"
+               "cpsid i"
+               : "=r"(primask)::"memory");
+  const uint32_t old_value = value.load(std::memory_order_relaxed);
+  value.store(old_value + amount, std::memory_order_relaxed);
+  asm volatile("msr primask, %0" ::"r"(primask) : "memory");
+  return old_value;
+}
+
+void AtomicMax(std::atomic<uint32_t>& max, uint32_t value) {
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n"
+               "cpsid i"
+               : "=r"(primask)::"memory");
+  if (value > max.load(std::memory_order_relaxed)) {
+    max.store(value, std::memory_order_relaxed);
+  }
+  asm volatile("msr primask, %0" ::"r"(primask) : "memory");
+}
+
+#else
+
+uint32_t AtomicAdd(std::atomic<uint32_t>& value, uint32_t amount) {
+  return value.fetch_add(amount, std::memory_order_relaxed);
+}
+
+void AtomicMax(std::atomic<uint32_t>& max, uint32_t value) {
+  uint32_t current = max.load(std::memory_order_relaxed);
+  while (value > current &&
+         !max.compare_exchange_weak(
+             current, value, std::memory_order_relaxed)) {
+  }
+}
+
+#endif  // defined(__ARM_ARCH_6M__)
+
+// Each thread is given the next shard index the first time it increments a
+// sharded counter, so threads spread evenly across the shards.
+size_t ThreadShardIndex() {
+  static std::atomic<size_t> next_index(0);
+  thread_local const size_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
 const char* Indent(int level) {
   static const char* kWhitespace8 = "        ";
   level = std::min(level, 4);
@@ -62,27 +116,30 @@ Metric::Metric(Token name, uint32_t value, IntrusiveList<Metric>& metrics)
 
 float Metric::as_float() const {
   PW_DCHECK(is_float());
-  return float_;
+  const uint32_t bits = value_.load(std::memory_order_relaxed);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
 }
 
 uint32_t Metric::as_int() const {
   PW_DCHECK(is_int());
-  return uint_;
+  return value_.load(std::memory_order_relaxed);
 }
 
 void Metric::Increment(uint32_t amount) {
   PW_DCHECK(is_int());
-  uint_ += amount;
+  AtomicAdd(value_, amount);
 }
 
 void Metric::SetInt(uint32_t value) {
   PW_DCHECK(is_int());
-  uint_ = value;
+  value_.store(value, std::memory_order_relaxed);
 }
 
 void Metric::SetFloat(float value) {
   PW_DCHECK(is_float());
-  float_ = value;
+  value_.store(FloatToBits(value), std::memory_order_relaxed);
 }
 
 void Metric::Dump(int level) {
@@ -104,6 +161,82 @@ void Metric::Dump(IntrusiveList<Metric>& metrics, int level) {
   }
 }
 
+Histogram::Histogram(Token name,
+                     std::span<std::atomic<uint32_t>> buckets,
+                     IntrusiveList<Histogram>& histograms)
+    : Histogram(name, buckets) {
+  histograms.push_front(*this);
+}
+
+uint32_t Histogram::count() const {
+  uint32_t total = 0;
+  for (const std::atomic<uint32_t>& bucket : buckets_) {
+    total += bucket.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void Histogram::Record(uint32_t value) {
+  AtomicAdd(buckets_[BucketIndex(value, buckets_.size())], 1);
+  AtomicMax(max_, value);
+}
+
+void Histogram::Dump(int level) {
+  Base64EncodedToken encoded_name(name());
+  const char* indent = Indent(level);
+  PW_LOG_INFO("%s \"%s\": {", indent, encoded_name.value());
+  // Only list the buckets that have values, keyed by their lower bound.
+  for (size_t i = 0; i < bucket_count(); ++i) {
+    if (bucket(i) != 0u) {
+      PW_LOG_INFO("%s   \"%u\": %u,",
+                  indent,
+                  static_cast<unsigned int>(BucketLowerBound(i)),
+                  static_cast<unsigned int>(bucket(i)));
+    }
+  }
+  PW_LOG_INFO("%s   \"max\": %u,", indent, static_cast<unsigned int>(max()));
+  PW_LOG_INFO("%s }", indent);
+}
+
+void Histogram::Dump(IntrusiveList<Histogram>& histograms, int level) {
+  for (auto& h : histograms) {
+    h.Dump(level);
+  }
+}
+
+ShardedCounter::ShardedCounter(Token name,
+                               std::span<Shard> shards,
+                               IntrusiveList<ShardedCounter>& counters)
+    : ShardedCounter(name, shards) {
+  counters.push_front(*this);
+}
+
+void ShardedCounter::Increment(uint32_t amount) {
+  AtomicAdd(shards_[ThreadShardIndex() % shards_.size()].value, amount);
+}
+
+uint32_t ShardedCounter::value() const {
+  uint32_t total = 0;
+  for (const Shard& shard : shards_) {
+    total += shard.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void ShardedCounter::Dump(int level) {
+  Base64EncodedToken encoded_name(name());
+  PW_LOG_INFO("%s \"%s\": %u,",
+              Indent(level),
+              encoded_name.value(),
+              static_cast<unsigned int>(value()));
+}
+
+void ShardedCounter::Dump(IntrusiveList<ShardedCounter>& counters, int level) {
+  for (auto& c : counters) {
+    c.Dump(level);
+  }
+}
+
 Group::Group(Token name) : name_(name) {}
 
 Group::Group(Token name, IntrusiveList<Group>& groups) : name_(name) {
@@ -116,6 +249,8 @@ void Group::Dump(int level) {
   PW_LOG_INFO("%s \"%s\": {", indent, encoded_name.value());
   Group::Dump(children(), level + 1);
   Metric::Dump(metrics(), level + 1);
+  Histogram::Dump(histograms(), level + 1);
+  ShardedCounter::Dump(sharded_counters(), level + 1);
   PW_LOG_INFO("%s }", indent);
 }
 
@@ -15,7 +15,9 @@
 #include "pw_metric/metric_service_nanopb.h"
 
 #include <cstring>
+#include <iterator>
 #include <span>
+#include <utility>
 
 #include "pw_assert/check.h"
 #include "pw_containers/vector.h"
@@ -35,6 +37,64 @@ class MetricWriter {
   // on transport MTU, rather than having this as a static knob. For example,
   // some transports may be able to fit 30 metrics; others, only 5.
   void Write(const Metric& metric, const Vector<Token>& path) {
+    pw_metric_Metric& proto_metric = NextMetric(path);
+
+    // Copy the metric value.
+    if (metric.is_float()) {
+      proto_metric.value.as_float = metric.as_float();
+      proto_metric.which_value = pw_metric_Metric_as_float_tag;
+    } else {
+      proto_metric.value.as_int = metric.as_int();
+      proto_metric.which_value = pw_metric_Metric_as_int_tag;
+    }
+
+    FinishMetric();
+  }
+
+  // Sharded counters are sent as int metrics.
+  void Write(const ShardedCounter& counter, const Vector<Token>& path) {
+    pw_metric_Metric& proto_metric = NextMetric(path);
+    proto_metric.value.as_int = counter.value();
+    proto_metric.which_value = pw_metric_Metric_as_int_tag;
+    FinishMetric();
+  }
+
+  void Write(const Histogram& histogram, const Vector<Token>& path) {
+    std::span<pw_metric_Histogram> histograms(response_.histograms);
+    PW_CHECK_INT_LT(response_.histograms_count, histograms.size());
+
+    pw_metric_Histogram& proto_histogram =
+        response_.histograms[response_.histograms_count];
+
+    std::span<Token> proto_path(proto_histogram.token_path);
+    PW_CHECK_INT_LE(path.size(), proto_path.size());
+    std::copy(path.begin(), path.end(), proto_path.begin());
+    proto_histogram.token_path_count = path.size();
+
+    std::span<uint32_t> proto_buckets(proto_histogram.bucket_counts);
+    PW_CHECK_INT_LE(histogram.bucket_count(), proto_buckets.size());
+    for (size_t i = 0; i < histogram.bucket_count(); ++i) {
+      proto_buckets[i] = histogram.bucket(i);
+    }
+    proto_histogram.bucket_counts_count = histogram.bucket_count();
+    proto_histogram.max = histogram.max();
+
+    response_.histograms_count++;
+    if (response_.histograms_count == histograms.size()) {
+      Flush();
+    }
+  }
+
+  void Flush() {
+    if (response_.metrics_count || response_.histograms_count) {
+      response_writer_.Write(response_);
+      response_ = pw_metric_MetricResponse_init_zero;
+    }
+  }
+
+ private:
+  // Returns the next Metric slot in the response, with its path filled in.
+  pw_metric_Metric& NextMetric(const Vector<Token>& path) {
     // Nanopb doesn't offer an easy way to do bounds checking, so use span's
     // type deduction magic to figure out the max size.
     std::span<pw_metric_Metric> metrics(response_.metrics);
@@ -48,37 +108,69 @@ class MetricWriter {
     PW_CHECK_INT_LE(path.size(), proto_path.size());
     std::copy(path.begin(), path.end(), proto_path.begin());
     proto_metric.token_path_count = path.size();
+    return proto_metric;
+  }
 
-    // Copy the metric value.
-    if (metric.is_float()) {
-      proto_metric.value.as_float = metric.as_float();
-      proto_metric.which_value = pw_metric_Metric_as_float_tag;
-    } else {
-      proto_metric.value.as_int = metric.as_int();
-      proto_metric.which_value = pw_metric_Metric_as_int_tag;
-    }
-
+  void FinishMetric() {
     // Move write head to the next slot.
     response_.metrics_count++;
 
     // If the metric response object is full, send the response and reset.
     // TODO(keir): Support runtime batch sizes < max proto size.
-    if (response_.metrics_count == metrics.size()) {
+    if (response_.metrics_count == std::size(response_.metrics)) {
       Flush();
     }
   }
 
-  void Flush() {
-    if (response_.metrics_count) {
-      response_writer_.Write(response_);
-      response_ = pw_metric_MetricResponse_init_zero;
+  pw_metric_MetricResponse response_;
+  // This RPC stream writer handle must be valid for the metric writer lifetime.
+  rpc::ServerWriter<pw_metric_MetricResponse>& response_writer_;
+};
+
+// Finds the metrics and histograms that changed since they were last sent, by
+// comparing a value for each against the buffer of last sent values. The
+// values are visited in the same order on every walk since the tree does not
+// change after initialization.
+class ChangeTracker {
+ public:
+  ChangeTracker(std::span<uint32_t> last_sent_values, bool send_all)
+      : last_sent_values_(last_sent_values), send_all_(send_all) {}
+
+  bool Changed(const Metric& metric) {
+    if (metric.is_float()) {
+      const float value = metric.as_float();
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return Changed(bits);
     }
+    return Changed(metric.as_int());
+  }
+
+  bool Changed(const ShardedCounter& counter) {
+    return Changed(counter.value());
+  }
+
+  // Every Record() increments the count, so it changes if anything did.
+  bool Changed(const Histogram& histogram) {
+    return Changed(histogram.count());
   }
 
  private:
-  pw_metric_MetricResponse response_;
-  // This RPC stream writer handle must be valid for the metric writer lifetime.
-  rpc::ServerWriter<pw_metric_MetricResponse>& response_writer_;
+  bool Changed(uint32_t value) {
+    const size_t index = next_index_++;
+    if (index >= last_sent_values_.size()) {
+      return true;  // Untracked values are always sent.
+    }
+    if (!send_all_ && last_sent_values_[index] == value) {
+      return false;
+    }
+    last_sent_values_[index] = value;
+    return true;
+  }
+
+  std::span<uint32_t> last_sent_values_;
+  size_t next_index_ = 0;
+  const bool send_all_;
 };
 
 // Walk a metric tree recursively; passing metrics with their path (names) to a
@@ -87,12 +179,34 @@ class MetricWriter {
 // TODO(keir): Generalize this to support a generic visitor.
 class MetricWalker {
  public:
-  MetricWalker(MetricWriter& writer) : writer_(writer) {}
+  // If a change tracker is given, only changed metrics are written.
+  MetricWalker(MetricWriter& writer, ChangeTracker* changes = nullptr)
+      : writer_(writer), changes_(changes) {}
 
   void Walk(const IntrusiveList<Metric>& metrics) {
     for (const auto& m : metrics) {
-      ScopedName scoped_name(m.name(), *this);
-      writer_.Write(m, path_);
+      if (changes_ == nullptr || changes_->Changed(m)) {
+        ScopedName scoped_name(m.name(), *this);
+        writer_.Write(m, path_);
+      }
+    }
+  }
+
+  void Walk(const IntrusiveList<Histogram>& histograms) {
+    for (const auto& h : histograms) {
+      if (changes_ == nullptr || changes_->Changed(h)) {
+        ScopedName scoped_name(h.name(), *this);
+        writer_.Write(h, path_);
+      }
+    }
+  }
+
+  void Walk(const IntrusiveList<ShardedCounter>& counters) {
+    for (const auto& c : counters) {
+      if (changes_ == nullptr || changes_->Changed(c)) {
+        ScopedName scoped_name(c.name(), *this);
+        writer_.Write(c, path_);
+      }
     }
   }
 
@@ -106,6 +220,8 @@ class MetricWalker {
     ScopedName scoped_name(group.name(), *this);
     Walk(group.children());
     Walk(group.metrics());
+    Walk(group.histograms());
+    Walk(group.sharded_counters());
   }
 
  private:
@@ -123,6 +239,7 @@ class MetricWalker {
 
   Vector<Token, 4 /* max depth */> path_;
   MetricWriter& writer_;
+  ChangeTracker* changes_;
 };
 
 }  // namespace
@@ -146,4 +263,26 @@ void MetricService::Get(ServerContext&,
   writer.Flush();
 }
 
+void MetricService::Subscribe(ServerContext&,
+                              const pw_metric_MetricRequest& /* request */,
+                              ServerWriter<pw_metric_MetricResponse>& writer) {
+  // For now, ignore the request and subscribe to all the metrics.
+  subscriber_ = std::move(writer);
+  send_all_ = true;
+}
+
+void MetricService::SendChangedMetrics() {
+  if (!subscriber_.open()) {
+    return;
+  }
+
+  MetricWriter writer(subscriber_);
+  ChangeTracker changes(last_sent_values_, send_all_);
+  MetricWalker walker(writer, &changes);
+  walker.Walk(metrics_);
+  walker.Walk(groups_);
+  writer.Flush();
+  send_all_ = false;
+}
+
 }  // namespace pw::metric
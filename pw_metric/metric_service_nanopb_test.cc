@@ -14,6 +14,8 @@
 
 #include "pw_metric/metric_service_nanopb.h"
 
+#include <array>
+
 #include "gtest/gtest.h"
 #include "pw_log/log.h"
 #include "pw_rpc/nanopb_test_method_context.h"
@@ -25,6 +27,10 @@ namespace {
   PW_NANOPB_TEST_METHOD_CONTEXT( \
       MetricService, Get, 4, sizeof(pw_metric_MetricResponse))
 
+#define SubscribeMethodContext   \
+  PW_NANOPB_TEST_METHOD_CONTEXT( \
+      MetricService, Subscribe, 4, sizeof(pw_metric_MetricResponse))
+
 TEST(MetricService, EmptyGroupAndNoMetrics) {
   // Empty root group.
   PW_METRIC_GROUP(root, "/");
@@ -203,5 +209,125 @@ TEST(MetricService, TokenPaths) {
   }
 }
 
+TEST(MetricService, Histograms) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+
+  PW_METRIC_GROUP(inner, "inner");
+  PW_METRIC_HISTOGRAM(inner, latency, "latency", 8);
+  root.Add(inner);
+
+  latency.Record(3);
+  latency.Record(3);
+  latency.Record(200);
+
+  MetricMethodContext context(root.metrics(), root.children());
+  context.call({});
+  EXPECT_TRUE(context.done());
+  EXPECT_EQ(OkStatus(), context.status());
+
+  ASSERT_EQ(1u, context.responses().size());
+  const pw_metric_MetricResponse& response = context.responses()[0];
+  EXPECT_EQ(1, response.metrics_count);
+  ASSERT_EQ(1, response.histograms_count);
+
+  const pw_metric_Histogram& histogram = response.histograms[0];
+  ASSERT_EQ(2, histogram.token_path_count);
+  EXPECT_EQ(inner_token, histogram.token_path[0]);
+  EXPECT_EQ(latency_token, histogram.token_path[1]);
+
+  ASSERT_EQ(8, histogram.bucket_counts_count);
+  EXPECT_EQ(2u, histogram.bucket_counts[2]);
+  EXPECT_EQ(1u, histogram.bucket_counts[7]);
+  EXPECT_EQ(200u, histogram.max);
+}
+
+TEST(MetricService, SubscribeSendsOnlyChangedMetrics) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2.0f);
+
+  PW_METRIC_GROUP(inner, "inner");
+  PW_METRIC_HISTOGRAM(inner, latency, "latency", 8);
+  root.Add(inner);
+
+  std::array<uint32_t, 3> last_sent_values;
+  SubscribeMethodContext context(
+      root.metrics(), root.children(), last_sent_values);
+
+  // Nothing is sent until there is a subscriber.
+  context.service().SendChangedMetrics();
+  context.call({});
+  EXPECT_FALSE(context.done());
+  EXPECT_EQ(0u, context.responses().size());
+
+  // The first update sends everything.
+  context.service().SendChangedMetrics();
+  ASSERT_EQ(1u, context.responses().size());
+  EXPECT_EQ(2, context.responses()[0].metrics_count);
+  EXPECT_EQ(1, context.responses()[0].histograms_count);
+
+  // Nothing changed, so nothing is sent.
+  context.service().SendChangedMetrics();
+  EXPECT_EQ(1u, context.responses().size());
+
+  a.Increment();
+  latency.Record(10);
+  context.service().SendChangedMetrics();
+  ASSERT_EQ(2u, context.responses().size());
+  const pw_metric_MetricResponse& update = context.responses()[1];
+  ASSERT_EQ(1, update.metrics_count);
+  EXPECT_EQ(a_token, update.metrics[0].token_path[0]);
+  EXPECT_EQ(2u, update.metrics[0].value.as_int);
+  ASSERT_EQ(1, update.histograms_count);
+  EXPECT_EQ(latency_token, update.histograms[0].token_path[1]);
+
+  b.Set(2.5f);
+  context.service().SendChangedMetrics();
+  ASSERT_EQ(3u, context.responses().size());
+  ASSERT_EQ(1, context.responses()[2].metrics_count);
+  EXPECT_EQ(2.5f, context.responses()[2].metrics[0].value.as_float);
+  EXPECT_EQ(0, context.responses()[2].histograms_count);
+}
+
+TEST(MetricService, SubscribeSendsUntrackedMetricsEveryUpdate) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+
+  // Only one of the two metrics is tracked.
+  std::array<uint32_t, 1> last_sent_values;
+  SubscribeMethodContext context(
+      root.metrics(), root.children(), last_sent_values);
+  context.call({});
+
+  context.service().SendChangedMetrics();
+  context.service().SendChangedMetrics();
+  ASSERT_EQ(2u, context.responses().size());
+  EXPECT_EQ(2, context.responses()[0].metrics_count);
+  EXPECT_EQ(1, context.responses()[1].metrics_count);
+}
+
+TEST(MetricService, ShardedCountersAreIntMetrics) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC_GROUP(inner, "inner");
+  PW_METRIC_SHARDED_COUNTER(inner, packets, "packets", 4);
+  root.Add(inner);
+
+  packets.Increment(5u);
+
+  MetricMethodContext context(root.metrics(), root.children());
+  context.call({});
+  EXPECT_TRUE(context.done());
+  EXPECT_EQ(OkStatus(), context.status());
+
+  ASSERT_EQ(1u, context.responses().size());
+  const pw_metric_MetricResponse& response = context.responses()[0];
+  ASSERT_EQ(1, response.metrics_count);
+  EXPECT_EQ(pw_metric_Metric_as_int_tag, response.metrics[0].which_value);
+  EXPECT_EQ(5u, response.metrics[0].value.as_int);
+  EXPECT_EQ(packets_token, response.metrics[0].token_path[1]);
+}
+
 }  // namespace
 }  // namespace pw::metric
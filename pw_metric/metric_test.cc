@@ -14,6 +14,8 @@
 
 #include "pw_metric/metric.h"
 
+#include <limits>
+
 #include "gtest/gtest.h"
 #include "pw_log/log.h"
 
@@ -55,6 +57,18 @@ TEST(Metric, IntFromObject) {
   EXPECT_EQ(m.value(), 426u);
 }
 
+TEST(Metric, IncrementWraps) {
+  TypedMetric<uint32_t> m(0x1234, std::numeric_limits<uint32_t>::max());
+  m.Increment(2u);
+  EXPECT_EQ(m.value(), 1u);
+}
+
+TEST(Metric, SizeUnchanged) {
+  // The atomic value must not grow metrics beyond next, name, and value.
+  EXPECT_EQ(sizeof(TypedMetric<uint32_t>),
+            sizeof(void*) + 2 * sizeof(uint32_t));
+}
+
 TEST(m, IntFromMacroLocal) {
   PW_METRIC(m, "some_metric", 14u);
   EXPECT_TRUE(m.is_int());
@@ -237,4 +251,79 @@ TEST(Metric, StaticWithinAFunction) {
   EXPECT_EQ(metric->as_int(), 2u);
 }
 
+TEST(Histogram, BucketIndex) {
+  EXPECT_EQ(Histogram::BucketIndex(0u, 33), 0u);
+  EXPECT_EQ(Histogram::BucketIndex(1u, 33), 1u);
+  EXPECT_EQ(Histogram::BucketIndex(2u, 33), 2u);
+  EXPECT_EQ(Histogram::BucketIndex(3u, 33), 2u);
+  EXPECT_EQ(Histogram::BucketIndex(4u, 33), 3u);
+  EXPECT_EQ(Histogram::BucketIndex(0x8000'0000u, 33), 32u);
+  EXPECT_EQ(Histogram::BucketIndex(0xffff'ffffu, 33), 32u);
+
+  // Large values go in the last bucket.
+  EXPECT_EQ(Histogram::BucketIndex(1000u, 4), 3u);
+
+  EXPECT_EQ(Histogram::BucketLowerBound(0), 0u);
+  EXPECT_EQ(Histogram::BucketLowerBound(1), 1u);
+  EXPECT_EQ(Histogram::BucketLowerBound(5), 16u);
+}
+
+TEST(Histogram, Record) {
+  PW_METRIC_HISTOGRAM(latency, "latency", 8);
+  EXPECT_EQ(latency.bucket_count(), 8u);
+  EXPECT_EQ(latency.count(), 0u);
+  EXPECT_EQ(latency.max(), 0u);
+
+  latency.Record(0);
+  latency.Record(5);
+  latency.Record(6);
+  latency.Record(100000);
+
+  EXPECT_EQ(latency.bucket(0), 1u);
+  EXPECT_EQ(latency.bucket(3), 2u);
+  EXPECT_EQ(latency.bucket(7), 1u);
+  EXPECT_EQ(latency.count(), 4u);
+  EXPECT_EQ(latency.max(), 100000u);
+}
+
+TEST(Histogram, InGroup) {
+  PW_METRIC_GROUP(group, "group");
+  PW_METRIC(group, errors, "errors", 0u);
+  PW_METRIC_HISTOGRAM(group, latency, "latency", 16);
+
+  latency.Record(42);
+  errors.Increment();
+
+  EXPECT_EQ(group.histograms().size(), 1u);
+  EXPECT_EQ(&group.histograms().front(), &latency);
+  EXPECT_EQ(group.histograms().front().name(), latency_token);
+  group.Dump();
+}
+
+TEST(ShardedCounter, IncrementAndSum) {
+  PW_METRIC_SHARDED_COUNTER(packets, "packets", 4);
+  EXPECT_EQ(packets.shard_count(), 4u);
+  EXPECT_EQ(packets.value(), 0u);
+
+  packets.Increment();
+  packets.Increment(10u);
+  EXPECT_EQ(packets.value(), 11u);
+}
+
+TEST(ShardedCounter, ShardsOnSeparateCacheLines) {
+  EXPECT_EQ(sizeof(ShardedCounter::Shard), ShardedCounter::kCacheLineBytes);
+  EXPECT_EQ(alignof(ShardedCounter::Shard), ShardedCounter::kCacheLineBytes);
+}
+
+TEST(ShardedCounter, InGroup) {
+  PW_METRIC_GROUP(group, "group");
+  PW_METRIC_SHARDED_COUNTER(group, packets, "packets", 2);
+  packets.Increment(3u);
+
+  EXPECT_EQ(group.sharded_counters().size(), 1u);
+  EXPECT_EQ(group.sharded_counters().front().name(), packets_token);
+  EXPECT_EQ(group.sharded_counters().front().value(), 3u);
+  group.Dump();
+}
+
 }  // namespace pw::metric
@@ -14,8 +14,14 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <initializer_list>
 #include <limits>
+#include <span>
 
 #include "pw_containers/intrusive_list.h"
 #include "pw_preprocessor/arguments.h"
@@ -35,7 +41,8 @@ using tokenizer::Token;
 //
 // Size: 12 bytes / 96 bits - next, name, value.
 //
-// TODO(keir): Implement Set() and Increment() using atomics.
+// The value is atomic, so Set() and Increment() may be called from several
+// threads and interrupts without a lock. The float is stored as its bits.
 // TODO(keir): Consider an alternative structure where metrics have pointers to
 // parent groups, which would enable (1) safe destruction and (2) safe static
 // initialization, but at the cost of an additional 4 bytes per metric and 4
@@ -66,10 +73,11 @@ class Metric : public IntrusiveList<Metric>::Item {
 
  protected:
   Metric(Token name, float value)
-      : name_and_type_((name & kTokenMask) | kTypeFloat), float_(value) {}
+      : name_and_type_((name & kTokenMask) | kTypeFloat),
+        value_(FloatToBits(value)) {}
 
   Metric(Token name, uint32_t value)
-      : name_and_type_((name & kTokenMask) | kTypeInt), uint_(value) {}
+      : name_and_type_((name & kTokenMask) | kTypeInt), value_(value) {}
 
   Metric(Token name, float value, IntrusiveList<Metric>& metrics);
   Metric(Token name, uint32_t value, IntrusiveList<Metric>& metrics);
@@ -88,10 +96,15 @@ class Metric : public IntrusiveList<Metric>::Item {
   // Last bit of the token is used to store int or float; 0 == int, 1 == float.
   Token name_and_type_;
 
-  union {
-    float float_;
-    uint32_t uint_;
-  };
+  static uint32_t FloatToBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  // The uint32_t value, or the bits of the float value. Only relaxed ordering
+  // is used; metrics do not order other memory accesses.
+  std::atomic<uint32_t> value_;
 
   enum : uint32_t {
     kTokenMask = _PW_METRIC_TOKEN_MASK,  // 0x7fff'ffff
@@ -143,9 +156,169 @@ class TypedMetric<uint32_t> : public Metric {
   uint32_t as_int() const { return 0; }
 };
 
-// A metric tree; consisting of children groups and leaf metrics.
+// A histogram of uint32_t values, such as latencies, with exponential buckets.
+// Bucket 0 counts zeros, and bucket i counts values in [2^(i-1), 2^i). The last
+// bucket also counts all larger values, so 33 buckets cover every uint32_t.
+// The largest recorded value is tracked as well.
+//
+// Record() is O(1): the bucket is found by counting leading zeros, then
+// incremented atomically like Metric::Increment(). Histograms can be recorded
+// from several threads and interrupts without a lock.
 //
-// Size: 16 bytes/128 bits - next, name, metrics, children.
+// Declare histograms with PW_METRIC_HISTOGRAM(), which allocates the buckets.
+//
+// Size: 16 bytes + 4 bytes per bucket - next, name, buckets, max.
+class Histogram : public IntrusiveList<Histogram>::Item {
+ public:
+  Token name() const { return name_; }
+
+  // Records one value.
+  void Record(uint32_t value);
+
+  size_t bucket_count() const { return buckets_.size(); }
+  uint32_t bucket(size_t index) const {
+    return buckets_[index].load(std::memory_order_relaxed);
+  }
+
+  // The total number of recorded values, which is the sum of the buckets.
+  uint32_t count() const;
+
+  // The largest recorded value, or 0 if nothing was recorded.
+  uint32_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  // The bucket that counts value in a histogram with bucket_count buckets.
+  static constexpr size_t BucketIndex(uint32_t value, size_t bucket_count) {
+    const size_t index =
+        value == 0u ? 0u : 32u - static_cast<size_t>(__builtin_clz(value));
+    return std::min(index, bucket_count - 1);
+  }
+
+  // The smallest value counted by a bucket.
+  static constexpr uint32_t BucketLowerBound(size_t index) {
+    return index == 0u ? 0u : uint32_t(1) << (index - 1);
+  }
+
+  // Dump a histogram or histograms to logs, listing the non-empty buckets by
+  // their lower bound. Example output:
+  //
+  //   "$ZnJh9Q==": {
+  //     "8": 3,
+  //     "16": 1,
+  //     "max": 17,
+  //   }
+  void Dump(int indent_level = 0);
+  static void Dump(IntrusiveList<Histogram>& histograms, int indent_level = 0);
+
+  // Disallow copy and assign.
+  Histogram(Histogram const&) = delete;
+  void operator=(const Histogram&) = delete;
+
+ protected:
+  Histogram(Token name, std::span<std::atomic<uint32_t>> buckets)
+      : name_(name), buckets_(buckets), max_(0) {}
+
+  Histogram(Token name,
+            std::span<std::atomic<uint32_t>> buckets,
+            IntrusiveList<Histogram>& histograms);
+
+ private:
+  Token name_;
+  std::span<std::atomic<uint32_t>> buckets_;
+  std::atomic<uint32_t> max_;
+};
+
+// A Histogram with storage for kBucketCount buckets.
+template <size_t kBucketCount>
+class HistogramWithBuckets : public Histogram {
+ public:
+  static_assert(kBucketCount >= 2u && kBucketCount <= 33u,
+                "Histograms have 2 to 33 buckets");
+
+  HistogramWithBuckets(Token name) : Histogram(name, storage_) {}
+  HistogramWithBuckets(Token name, IntrusiveList<Histogram>& histograms)
+      : Histogram(name, storage_, histograms) {}
+
+ private:
+  // The base class only keeps a span of the storage, so this may be
+  // initialized after it.
+  std::array<std::atomic<uint32_t>, kBucketCount> storage_{};
+};
+
+// A uint32_t counter for values incremented at high rates from several cores.
+// Increments from different threads go to different shards, each on its own
+// cache line, so the cores do not contend for one line. Threads are assigned
+// shards round-robin when they first increment a counter; with more threads
+// than shards, some threads share a shard, which is still exact but may
+// contend. Reading the value sums the shards.
+//
+// Dump() and MetricService report sharded counters as int metrics. They are
+// meant for host builds with several cores; on a single core, use a Metric.
+//
+// Declare sharded counters with PW_METRIC_SHARDED_COUNTER(), which allocates
+// the shards.
+//
+// Size: 12 bytes + kCacheLineBytes per shard - next, name, shards.
+class ShardedCounter : public IntrusiveList<ShardedCounter>::Item {
+ public:
+  // Shards are padded to this size to keep them on separate cache lines.
+  static constexpr size_t kCacheLineBytes = 64;
+
+  struct alignas(kCacheLineBytes) Shard {
+    std::atomic<uint32_t> value;
+  };
+
+  Token name() const { return name_; }
+
+  void Increment(uint32_t amount = 1u);
+
+  // The sum of the shards. Increments made concurrently may not be included.
+  uint32_t value() const;
+
+  size_t shard_count() const { return shards_.size(); }
+
+  // Dump a sharded counter or counters to logs, like an int Metric.
+  void Dump(int indent_level = 0);
+  static void Dump(IntrusiveList<ShardedCounter>& counters,
+                   int indent_level = 0);
+
+  // Disallow copy and assign.
+  ShardedCounter(ShardedCounter const&) = delete;
+  void operator=(const ShardedCounter&) = delete;
+
+ protected:
+  ShardedCounter(Token name, std::span<Shard> shards)
+      : name_(name), shards_(shards) {}
+
+  ShardedCounter(Token name,
+                 std::span<Shard> shards,
+                 IntrusiveList<ShardedCounter>& counters);
+
+ private:
+  Token name_;
+  std::span<Shard> shards_;
+};
+
+// A ShardedCounter with storage for kShardCount shards.
+template <size_t kShardCount>
+class ShardedCounterWithShards : public ShardedCounter {
+ public:
+  static_assert(kShardCount >= 1u, "Sharded counters need a shard");
+
+  ShardedCounterWithShards(Token name) : ShardedCounter(name, storage_) {}
+  ShardedCounterWithShards(Token name, IntrusiveList<ShardedCounter>& counters)
+      : ShardedCounter(name, storage_, counters) {}
+
+ private:
+  // The base class only keeps a span of the storage, so this may be
+  // initialized after it.
+  std::array<Shard, kShardCount> storage_{};
+};
+
+// A metric tree; consisting of children groups, leaf metrics, histograms, and
+// sharded counters.
+//
+// Size: 24 bytes/192 bits - next, name, metrics, children, histograms,
+// sharded counters.
 class Group : public IntrusiveList<Group>::Item {
  public:
   Group(Token name);
@@ -155,12 +328,22 @@ class Group : public IntrusiveList<Group>::Item {
 
   void Add(Metric& metric) { metrics_.push_front(metric); }
   void Add(Group& group) { children_.push_front(group); }
+  void Add(Histogram& histogram) { histograms_.push_front(histogram); }
+  void Add(ShardedCounter& counter) { sharded_counters_.push_front(counter); }
 
   IntrusiveList<Metric>& metrics() { return metrics_; }
   IntrusiveList<Group>& children() { return children_; }
+  IntrusiveList<Histogram>& histograms() { return histograms_; }
+  IntrusiveList<ShardedCounter>& sharded_counters() {
+    return sharded_counters_;
+  }
 
   const IntrusiveList<Metric>& metrics() const { return metrics_; }
   const IntrusiveList<Group>& children() const { return children_; }
+  const IntrusiveList<Histogram>& histograms() const { return histograms_; }
+  const IntrusiveList<ShardedCounter>& sharded_counters() const {
+    return sharded_counters_;
+  }
 
   // Dump a metric group or groups to logs. Level determines the indentation
   // indent_level up to a maximum of 4. Example output:
@@ -191,6 +374,8 @@ class Group : public IntrusiveList<Group>::Item {
 
   IntrusiveList<Metric> metrics_;
   IntrusiveList<Group> children_;
+  IntrusiveList<Histogram> histograms_;
+  IntrusiveList<ShardedCounter> sharded_counters_;
 };
 
 // Declare a metric, optionally adding it to a group. Use:
@@ -306,4 +491,62 @@ class Group : public IntrusiveList<Group>::Item {
   static_def ::pw::metric::Group variable_name = {variable_name##_token,  \
                                                   parent.children()};
 
+// Declare a histogram, optionally adding it to a group. Works like PW_METRIC,
+// and works in the same contexts. Use:
+//
+//   PW_METRIC_HISTOGRAM(variable_name, histogram_name, bucket_count)
+//   PW_METRIC_HISTOGRAM(group, variable_name, histogram_name, bucket_count)
+//
+// For example, to record write latencies from 1us up to about 1s in 21
+// buckets:
+//
+//   PW_METRIC_HISTOGRAM(metrics_, write_latency_us_, "write_latency_us", 21);
+//
+//   write_latency_us_.Record(elapsed_us);
+#define PW_METRIC_HISTOGRAM(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_HISTOGRAM_, , __VA_ARGS__)
+#define PW_METRIC_HISTOGRAM_STATIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_HISTOGRAM_, static, __VA_ARGS__)
+
+#define _PW_METRIC_HISTOGRAM_4(static_def, variable_name, name, count)   \
+  static constexpr uint32_t variable_name##_token =                      \
+      PW_TOKENIZE_STRING_DOMAIN("metrics", name);                        \
+  static_def ::pw::metric::HistogramWithBuckets<count> variable_name = { \
+      variable_name##_token}
+
+#define _PW_METRIC_HISTOGRAM_5(static_def, group, variable_name, name, count) \
+  static constexpr uint32_t variable_name##_token =                           \
+      PW_TOKENIZE_STRING_DOMAIN("metrics", name);                             \
+  static_def ::pw::metric::HistogramWithBuckets<count> variable_name = {      \
+      variable_name##_token, group.histograms()}
+
+// Declare a sharded counter, optionally adding it to a group. Works like
+// PW_METRIC, and works in the same contexts. Use:
+//
+//   PW_METRIC_SHARDED_COUNTER(variable_name, counter_name, shard_count)
+//   PW_METRIC_SHARDED_COUNTER(group, variable_name, counter_name, shard_count)
+//
+// For example, with a shard for each of 8 cores:
+//
+//   PW_METRIC_SHARDED_COUNTER(metrics_, packets_, "packets", 8);
+//
+//   packets_.Increment();
+#define PW_METRIC_SHARDED_COUNTER(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_SHARDED_COUNTER_, , __VA_ARGS__)
+#define PW_METRIC_SHARDED_COUNTER_STATIC(...) \
+  PW_DELEGATE_BY_ARG_COUNT(_PW_METRIC_SHARDED_COUNTER_, static, __VA_ARGS__)
+
+#define _PW_METRIC_SHARDED_COUNTER_4(static_def, variable_name, name, count) \
+  static constexpr uint32_t variable_name##_token =                          \
+      PW_TOKENIZE_STRING_DOMAIN("metrics", name);                            \
+  static_def ::pw::metric::ShardedCounterWithShards<count> variable_name = { \
+      variable_name##_token}
+
+#define _PW_METRIC_SHARDED_COUNTER_5(                                        \
+    static_def, group, variable_name, name, count)                           \
+  static constexpr uint32_t variable_name##_token =                          \
+      PW_TOKENIZE_STRING_DOMAIN("metrics", name);                            \
+  static_def ::pw::metric::ShardedCounterWithShards<count> variable_name = { \
+      variable_name##_token, group.sharded_counters()}
+
 }  // namespace pw::metric
@@ -31,19 +31,48 @@ namespace pw::metric {
 // method is blocking, and sends all metrics at once (though batched). In the
 // future, we may switch to offering an async version where the Get() method
 // returns immediately, and someone else is responsible for pumping the queue.
+//
+// A client that polls metrics often can instead call Subscribe(), after which
+// SendChangedMetrics() sends only the metrics and histograms that changed since
+// they were last sent. The first update after subscribing sends everything.
+// Changes are found by comparing against the last sent values, which are kept
+// in a buffer with one uint32_t per metric or histogram, in tree order.
+// Metrics past the end of the buffer are sent in every update.
 class MetricService final : public generated::MetricService<MetricService> {
  public:
   MetricService(const IntrusiveList<Metric>& metrics,
                 const IntrusiveList<Group>& groups)
-      : metrics_(metrics), groups_(groups) {}
+      : MetricService(metrics, groups, std::span<uint32_t>()) {}
+
+  MetricService(const IntrusiveList<Metric>& metrics,
+                const IntrusiveList<Group>& groups,
+                std::span<uint32_t> last_sent_values)
+      : metrics_(metrics),
+        groups_(groups),
+        last_sent_values_(last_sent_values) {}
 
   void Get(ServerContext&,
            const pw_metric_MetricRequest& request,
            ServerWriter<pw_metric_MetricResponse>& response);
 
+  // Starts streaming changed metrics to the caller, replacing any previous
+  // subscription. The stream stays open until the client cancels it.
+  void Subscribe(ServerContext&,
+                 const pw_metric_MetricRequest& request,
+                 ServerWriter<pw_metric_MetricResponse>& writer);
+
+  // Sends the metrics that changed since the last update to the subscriber,
+  // if there is one. Call this at the interval updates are wanted, from the
+  // thread that handles RPCs or with calls to the RPC server synchronized.
+  void SendChangedMetrics();
+
  private:
   const IntrusiveList<Metric>& metrics_;
   const IntrusiveList<Group>& groups_;
+
+  std::span<uint32_t> last_sent_values_;
+  ServerWriter<pw_metric_MetricResponse> subscriber_;
+  bool send_all_ = true;
 };
 
 }  // namespace pw::metric
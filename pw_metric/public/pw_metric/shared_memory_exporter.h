@@ -0,0 +1,175 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "pw_containers/intrusive_list.h"
+#include "pw_metric/metric.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::metric {
+namespace internal {
+
+struct SharedMemoryRegion;
+
+}  // namespace internal
+
+// The kinds of entries in an exported metric table.
+enum class ExportedType : uint8_t {
+  kGroup = 0,            // value is 0
+  kInt = 1,              // int Metric or ShardedCounter
+  kFloat = 2,            // value holds the bits of the float
+  kHistogramBucket = 3,  // bucket is the bucket index
+  kHistogramMax = 4,     // the largest value recorded in the histogram
+};
+
+// One entry of an exported metric table. Entries are listed depth first, so a
+// group's entry comes before the entries of its members.
+struct ExportedMetric {
+  // The parent of entries that are not in a group.
+  static constexpr uint16_t kNoParent = 0xffff;
+
+  Token token;
+  uint16_t parent;  // Index of the group's entry, or kNoParent.
+  ExportedType type;
+  uint8_t bucket;
+  uint32_t value;
+
+  float as_float() const {
+    float value_as_float;
+    std::memcpy(&value_as_float, &value, sizeof(value_as_float));
+    return value_as_float;
+  }
+};
+
+// Mirrors a metric tree into a named POSIX shared memory region, so tools on
+// the same host can sample the metrics of a simulated device at high rates
+// without RPC and without any work on the device's threads.
+//
+// The region is a 32-byte header followed by a fixed table of 12-byte entries,
+// all little-endian 32-bit words:
+//
+//   Header:  magic "pWMX" (0x584d5770), version (1), capacity, sequence,
+//            entry count, 3 reserved words
+//   Entry:   token, parent | type << 16 | bucket << 24, value
+//
+// The sequence is a seqlock: it is odd while Update() is writing the table. A
+// reader reads the sequence, copies the entries, then reads the sequence again,
+// and retries if it was odd or changed. SharedMemoryMetricReader does this.
+//
+// Update() copies the current values into the region. Call it from a thread of
+// the simulator's own, such as a timer at the sampling rate; it reads the
+// metrics with relaxed atomic loads, so it does not disturb the threads that
+// update them. The metric tree may change between updates, but must not change
+// during one, as with MetricService.
+//
+// Only available on hosts with POSIX shared memory.
+class SharedMemoryExporter {
+ public:
+  // The longest region name, including the leading '/'.
+  static constexpr size_t kMaxNameLength = 63;
+
+  // The largest table. Indices must fit in ExportedMetric::parent.
+  static constexpr size_t kMaxCapacity = ExportedMetric::kNoParent;
+
+  SharedMemoryExporter(const IntrusiveList<Metric>& metrics,
+                       const IntrusiveList<Group>& groups)
+      : metrics_(metrics), groups_(groups) {}
+
+  ~SharedMemoryExporter() { Close(); }
+
+  SharedMemoryExporter(const SharedMemoryExporter&) = delete;
+  SharedMemoryExporter& operator=(const SharedMemoryExporter&) = delete;
+
+  // Creates the region, replacing any region with the same name, with room
+  // for capacity entries. The name should start with '/', as in
+  // "/my_simulator_metrics". Returns:
+  //
+  //   OK - the region was created and the metrics exported.
+  //   INVALID_ARGUMENT - the name or capacity is too long or zero.
+  //   FAILED_PRECONDITION - the exporter is already open.
+  //   INTERNAL - the region could not be created.
+  //   RESOURCE_EXHAUSTED - the metrics did not all fit; see Update().
+  //
+  Status Open(const char* name, size_t capacity);
+
+  // Copies the metrics into the region. Returns RESOURCE_EXHAUSTED if they did
+  // not all fit, in which case the entries that fit are exported, or
+  // FAILED_PRECONDITION if the exporter is not open.
+  Status Update();
+
+  // Unmaps and removes the region. Readers that have it mapped keep the last
+  // values.
+  void Close();
+
+ private:
+  void Write(Token token,
+             uint16_t parent,
+             ExportedType type,
+             uint8_t bucket,
+             uint32_t value);
+  void Write(const IntrusiveList<Metric>& metrics, uint16_t parent);
+  void Write(const IntrusiveList<Group>& groups, uint16_t parent);
+  void Write(const Group& group, uint16_t parent);
+
+  const IntrusiveList<Metric>& metrics_;
+  const IntrusiveList<Group>& groups_;
+
+  internal::SharedMemoryRegion* region_ = nullptr;
+  size_t region_size_ = 0;
+  char name_[kMaxNameLength + 1] = {};
+
+  // The number of entries written by the current Update().
+  size_t count_ = 0;
+};
+
+// Reads consistent snapshots of a region written by a SharedMemoryExporter,
+// possibly in another process.
+class SharedMemoryMetricReader {
+ public:
+  SharedMemoryMetricReader() = default;
+  ~SharedMemoryMetricReader() { Close(); }
+
+  SharedMemoryMetricReader(const SharedMemoryMetricReader&) = delete;
+  SharedMemoryMetricReader& operator=(const SharedMemoryMetricReader&) =
+      delete;
+
+  // Maps the named region. Returns NOT_FOUND if it does not exist, DATA_LOSS
+  // if it is not an exported metric table, or FAILED_PRECONDITION if the
+  // reader is already open.
+  Status Open(const char* name);
+
+  // Copies the current table into entries and returns the number of entries.
+  // Returns:
+  //
+  //   OK - the entries are a consistent snapshot.
+  //   RESOURCE_EXHAUSTED - entries is too small; the size is the entry count.
+  //   UNAVAILABLE - the exporter kept updating the table while it was copied.
+  //   FAILED_PRECONDITION - the reader is not open.
+  //
+  StatusWithSize Read(std::span<ExportedMetric> entries) const;
+
+  void Close();
+
+ private:
+  const internal::SharedMemoryRegion* region_ = nullptr;
+  size_t region_size_ = 0;
+};
+
+}  // namespace pw::metric
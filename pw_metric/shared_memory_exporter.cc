@@ -0,0 +1,314 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_metric/shared_memory_exporter.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <thread>
+
+namespace pw::metric {
+namespace internal {
+
+struct SharedMemoryEntry {
+  std::atomic<uint32_t> token;
+  std::atomic<uint32_t> info;  // parent | type << 16 | bucket << 24
+  std::atomic<uint32_t> value;
+};
+
+struct SharedMemoryRegion {
+  static constexpr uint32_t kMagic = 0x584d5770;  // "pWMX"
+  static constexpr uint32_t kVersion = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint32_t capacity;
+  std::atomic<uint32_t> sequence;
+  std::atomic<uint32_t> entry_count;
+  uint32_t reserved[3];
+
+  // The entries follow the header.
+  SharedMemoryEntry* entries() {
+    return reinterpret_cast<SharedMemoryEntry*>(this + 1);
+  }
+  const SharedMemoryEntry* entries() const {
+    return reinterpret_cast<const SharedMemoryEntry*>(this + 1);
+  }
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free,
+              "Shared memory needs lock-free atomics");
+static_assert(sizeof(SharedMemoryEntry) == 12u);
+static_assert(sizeof(SharedMemoryRegion) == 32u);
+
+}  // namespace internal
+
+using internal::SharedMemoryEntry;
+using internal::SharedMemoryRegion;
+
+namespace {
+
+constexpr size_t RegionSize(size_t capacity) {
+  return sizeof(SharedMemoryRegion) + capacity * sizeof(SharedMemoryEntry);
+}
+
+// A reader retries this many times before giving up on a busy exporter. It
+// yields between attempts, in case the exporter was preempted mid-update.
+constexpr int kMaxReadAttempts = 1000;
+
+}  // namespace
+
+Status SharedMemoryExporter::Open(const char* name, size_t capacity) {
+  if (region_ != nullptr) {
+    return Status::FailedPrecondition();
+  }
+  const size_t name_length = strnlen(name, kMaxNameLength + 1);
+  if (name_length == 0u || name_length > kMaxNameLength || capacity == 0u ||
+      capacity > kMaxCapacity) {
+    return Status::InvalidArgument();
+  }
+
+  // Replace any stale region, such as one left by a simulator that crashed,
+  // since its size may differ.
+  shm_unlink(name);
+  const int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) {
+    return Status::Internal();
+  }
+
+  const size_t size = RegionSize(capacity);
+  void* mapping = MAP_FAILED;
+  if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+    mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    shm_unlink(name);
+    return Status::Internal();
+  }
+
+  std::memcpy(name_, name, name_length + 1);
+  region_size_ = size;
+
+  // The new region is zero-filled, which is a valid empty table once the
+  // header is filled in. Readers check the magic, so write it last.
+  region_ = new (mapping) SharedMemoryRegion{};
+  region_->version = SharedMemoryRegion::kVersion;
+  region_->capacity = static_cast<uint32_t>(capacity);
+  std::atomic_thread_fence(std::memory_order_release);
+  region_->magic = SharedMemoryRegion::kMagic;
+
+  return Update();
+}
+
+Status SharedMemoryExporter::Update() {
+  if (region_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+
+  // Make the sequence odd before changing the entries, so readers that see any
+  // of the changes see that the table was being written.
+  const uint32_t sequence =
+      region_->sequence.load(std::memory_order_relaxed);
+  region_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  count_ = 0;
+  Write(metrics_, ExportedMetric::kNoParent);
+  Write(groups_, ExportedMetric::kNoParent);
+
+  const size_t written = std::min<size_t>(count_, region_->capacity);
+  region_->entry_count.store(static_cast<uint32_t>(written),
+                             std::memory_order_relaxed);
+  region_->sequence.store(sequence + 2, std::memory_order_release);
+
+  return count_ <= written ? OkStatus() : Status::ResourceExhausted();
+}
+
+void SharedMemoryExporter::Close() {
+  if (region_ == nullptr) {
+    return;
+  }
+  munmap(region_, region_size_);
+  shm_unlink(name_);
+  region_ = nullptr;
+}
+
+void SharedMemoryExporter::Write(Token token,
+                                 uint16_t parent,
+                                 ExportedType type,
+                                 uint8_t bucket,
+                                 uint32_t value) {
+  // Keep counting past the capacity, to report how much did not fit.
+  const size_t index = count_++;
+  if (index >= region_->capacity) {
+    return;
+  }
+  SharedMemoryEntry& entry = region_->entries()[index];
+  entry.token.store(token, std::memory_order_relaxed);
+  entry.info.store(parent | (uint32_t(type) << 16) | (uint32_t(bucket) << 24),
+                   std::memory_order_relaxed);
+  entry.value.store(value, std::memory_order_relaxed);
+}
+
+void SharedMemoryExporter::Write(const IntrusiveList<Metric>& metrics,
+                                 uint16_t parent) {
+  for (const Metric& metric : metrics) {
+    if (metric.is_float()) {
+      const float value = metric.as_float();
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      Write(metric.name(), parent, ExportedType::kFloat, 0, bits);
+    } else {
+      Write(metric.name(), parent, ExportedType::kInt, 0, metric.as_int());
+    }
+  }
+}
+
+void SharedMemoryExporter::Write(const IntrusiveList<Group>& groups,
+                                 uint16_t parent) {
+  for (const Group& group : groups) {
+    Write(group, parent);
+  }
+}
+
+void SharedMemoryExporter::Write(const Group& group, uint16_t parent) {
+  // Members of a group that did not fit have no parent to refer to, and would
+  // not fit either.
+  if (count_ >= region_->capacity) {
+    count_ += 1;
+    return;
+  }
+  const uint16_t index = static_cast<uint16_t>(count_);
+  Write(group.name(), parent, ExportedType::kGroup, 0, 0);
+
+  Write(group.metrics(), index);
+  for (const Histogram& histogram : group.histograms()) {
+    for (size_t i = 0; i < histogram.bucket_count(); ++i) {
+      Write(histogram.name(),
+            index,
+            ExportedType::kHistogramBucket,
+            static_cast<uint8_t>(i),
+            histogram.bucket(i));
+    }
+    Write(histogram.name(), index, ExportedType::kHistogramMax, 0,
+          histogram.max());
+  }
+  for (const ShardedCounter& counter : group.sharded_counters()) {
+    Write(counter.name(), index, ExportedType::kInt, 0, counter.value());
+  }
+  Write(group.children(), index);
+}
+
+Status SharedMemoryMetricReader::Open(const char* name) {
+  if (region_ != nullptr) {
+    return Status::FailedPrecondition();
+  }
+  const int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) {
+    return Status::NotFound();
+  }
+
+  struct stat info;
+  void* mapping = MAP_FAILED;
+  if (fstat(fd, &info) == 0 &&
+      static_cast<size_t>(info.st_size) >= sizeof(SharedMemoryRegion)) {
+    mapping = mmap(nullptr,
+                   static_cast<size_t>(info.st_size),
+                   PROT_READ,
+                   MAP_SHARED,
+                   fd,
+                   0);
+  }
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return Status::DataLoss();
+  }
+
+  const auto* region = static_cast<const SharedMemoryRegion*>(mapping);
+  const size_t size = static_cast<size_t>(info.st_size);
+  if (region->magic != SharedMemoryRegion::kMagic ||
+      region->version != SharedMemoryRegion::kVersion ||
+      RegionSize(region->capacity) > size) {
+    munmap(mapping, size);
+    return Status::DataLoss();
+  }
+
+  region_ = region;
+  region_size_ = size;
+  return OkStatus();
+}
+
+StatusWithSize SharedMemoryMetricReader::Read(
+    std::span<ExportedMetric> entries) const {
+  if (region_ == nullptr) {
+    return StatusWithSize::FailedPrecondition();
+  }
+
+  for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    if (attempt != 0) {
+      std::this_thread::yield();
+    }
+
+    const uint32_t sequence =
+        region_->sequence.load(std::memory_order_acquire);
+    if (sequence % 2u != 0u) {
+      continue;  // An update is in progress.
+    }
+
+    const size_t count = std::min<size_t>(
+        region_->entry_count.load(std::memory_order_relaxed),
+        region_->capacity);
+    const size_t copied = std::min(count, entries.size());
+    for (size_t i = 0; i < copied; ++i) {
+      const SharedMemoryEntry& entry = region_->entries()[i];
+      const uint32_t info = entry.info.load(std::memory_order_relaxed);
+      entries[i] = {
+          .token = entry.token.load(std::memory_order_relaxed),
+          .parent = static_cast<uint16_t>(info & 0xffff),
+          .type = static_cast<ExportedType>((info >> 16) & 0xff),
+          .bucket = static_cast<uint8_t>(info >> 24),
+          .value = entry.value.load(std::memory_order_relaxed),
+      };
+    }
+
+    // The copy is consistent if no update started while it was made.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (region_->sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+    if (copied < count) {
+      return StatusWithSize::ResourceExhausted(count);
+    }
+    return StatusWithSize(count);
+  }
+  return StatusWithSize::Unavailable();
+}
+
+void SharedMemoryMetricReader::Close() {
+  if (region_ == nullptr) {
+    return;
+  }
+  munmap(const_cast<internal::SharedMemoryRegion*>(region_), region_size_);
+  region_ = nullptr;
+}
+
+}  // namespace pw::metric
@@ -0,0 +1,190 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_metric/shared_memory_exporter.h"
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+namespace pw::metric {
+namespace {
+
+// Regions are named per process so that tests running in parallel do not
+// share them.
+class SharedMemoryExporterTest : public ::testing::Test {
+ protected:
+  SharedMemoryExporterTest() {
+    std::snprintf(name_,
+                  sizeof(name_),
+                  "/pw_metric_test_%ld",
+                  static_cast<long>(getpid()));
+  }
+
+  char name_[32];
+  std::array<ExportedMetric, 64> entries_;
+};
+
+TEST_F(SharedMemoryExporterTest, ExportsTree) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, root_metric, "root", 7u);
+  PW_METRIC_GROUP(root, group, "group");
+  PW_METRIC(group, count, "count", 3u);
+  PW_METRIC(group, ratio, "ratio", 0.5f);
+  PW_METRIC_GROUP(group, child, "child");
+  PW_METRIC(child, nested, "nested", 9u);
+
+  SharedMemoryExporter exporter(root.metrics(), root.children());
+  ASSERT_EQ(exporter.Open(name_, 16), OkStatus());
+
+  SharedMemoryMetricReader reader;
+  ASSERT_EQ(reader.Open(name_), OkStatus());
+  const StatusWithSize result = reader.Read(entries_);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 6u);
+
+  EXPECT_EQ(entries_[0].token, root_metric.name());
+  EXPECT_EQ(entries_[0].parent, ExportedMetric::kNoParent);
+  EXPECT_EQ(entries_[0].type, ExportedType::kInt);
+  EXPECT_EQ(entries_[0].value, 7u);
+
+  EXPECT_EQ(entries_[1].token, group.name());
+  EXPECT_EQ(entries_[1].parent, ExportedMetric::kNoParent);
+  EXPECT_EQ(entries_[1].type, ExportedType::kGroup);
+
+  // Members are listed after their group, most recently added first.
+  EXPECT_EQ(entries_[2].token, ratio.name());
+  EXPECT_EQ(entries_[2].parent, 1u);
+  EXPECT_EQ(entries_[2].type, ExportedType::kFloat);
+  EXPECT_EQ(entries_[2].as_float(), 0.5f);
+
+  EXPECT_EQ(entries_[3].token, count.name());
+  EXPECT_EQ(entries_[3].parent, 1u);
+  EXPECT_EQ(entries_[3].value, 3u);
+
+  EXPECT_EQ(entries_[4].token, child.name());
+  EXPECT_EQ(entries_[4].parent, 1u);
+  EXPECT_EQ(entries_[4].type, ExportedType::kGroup);
+
+  EXPECT_EQ(entries_[5].token, nested.name());
+  EXPECT_EQ(entries_[5].parent, 4u);
+  EXPECT_EQ(entries_[5].value, 9u);
+}
+
+TEST_F(SharedMemoryExporterTest, UpdateCopiesNewValues) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, counter, "counter", 0u);
+
+  SharedMemoryExporter exporter(root.metrics(), root.children());
+  ASSERT_EQ(exporter.Open(name_, 4), OkStatus());
+  SharedMemoryMetricReader reader;
+  ASSERT_EQ(reader.Open(name_), OkStatus());
+
+  counter.Increment(5);
+  ASSERT_EQ(reader.Read(entries_).size(), 1u);
+  EXPECT_EQ(entries_[0].value, 0u);  // Not exported until Update().
+
+  ASSERT_EQ(exporter.Update(), OkStatus());
+  ASSERT_EQ(reader.Read(entries_).size(), 1u);
+  EXPECT_EQ(entries_[0].value, 5u);
+}
+
+TEST_F(SharedMemoryExporterTest, ExportsHistogramsAndShardedCounters) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC_GROUP(root, group, "group");
+  PW_METRIC_HISTOGRAM(group, latency, "latency", 3);
+  PW_METRIC_SHARDED_COUNTER(group, events, "events", 2);
+  latency.Record(0);
+  latency.Record(1);
+  latency.Record(100);
+  events.Increment(4);
+
+  SharedMemoryExporter exporter(root.metrics(), root.children());
+  ASSERT_EQ(exporter.Open(name_, 16), OkStatus());
+  SharedMemoryMetricReader reader;
+  ASSERT_EQ(reader.Open(name_), OkStatus());
+  ASSERT_EQ(reader.Read(entries_).size(), 6u);
+
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(entries_[1 + i].token, latency.name());
+    EXPECT_EQ(entries_[1 + i].type, ExportedType::kHistogramBucket);
+    EXPECT_EQ(entries_[1 + i].bucket, i);
+    EXPECT_EQ(entries_[1 + i].value, 1u);
+  }
+  EXPECT_EQ(entries_[4].type, ExportedType::kHistogramMax);
+  EXPECT_EQ(entries_[4].value, 100u);
+
+  EXPECT_EQ(entries_[5].token, events.name());
+  EXPECT_EQ(entries_[5].type, ExportedType::kInt);
+  EXPECT_EQ(entries_[5].value, 4u);
+}
+
+TEST_F(SharedMemoryExporterTest, ExportsWhatFits) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+  PW_METRIC(root, c, "c", 3u);
+
+  SharedMemoryExporter exporter(root.metrics(), root.children());
+  EXPECT_EQ(exporter.Open(name_, 2), Status::ResourceExhausted());
+
+  SharedMemoryMetricReader reader;
+  ASSERT_EQ(reader.Open(name_), OkStatus());
+  ASSERT_EQ(reader.Read(entries_).size(), 2u);
+  EXPECT_EQ(entries_[0].token, c.name());
+  EXPECT_EQ(entries_[1].token, b.name());
+}
+
+TEST_F(SharedMemoryExporterTest, ReadIntoSmallBuffer) {
+  PW_METRIC_GROUP(root, "/");
+  PW_METRIC(root, a, "a", 1u);
+  PW_METRIC(root, b, "b", 2u);
+
+  SharedMemoryExporter exporter(root.metrics(), root.children());
+  ASSERT_EQ(exporter.Open(name_, 4), OkStatus());
+  SharedMemoryMetricReader reader;
+  ASSERT_EQ(reader.Open(name_), OkStatus());
+
+  const StatusWithSize result = reader.Read(std::span(entries_).first(1));
+  EXPECT_EQ(result.status(), Status::ResourceExhausted());
+  EXPECT_EQ(result.size(), 2u);
+}
+
+TEST_F(SharedMemoryExporterTest, CloseRemovesRegion) {
+  PW_METRIC_GROUP(root, "/");
+  SharedMemoryExporter exporter(root.metrics(), root.children());
+  ASSERT_EQ(exporter.Open(name_, 4), OkStatus());
+  EXPECT_EQ(exporter.Open(name_, 4), Status::FailedPrecondition());
+  exporter.Close();
+  EXPECT_EQ(exporter.Update(), Status::FailedPrecondition());
+
+  SharedMemoryMetricReader reader;
+  EXPECT_EQ(reader.Open(name_), Status::NotFound());
+  EXPECT_EQ(reader.Read(entries_).status(), Status::FailedPrecondition());
+}
+
+TEST_F(SharedMemoryExporterTest, InvalidArguments) {
+  PW_METRIC_GROUP(root, "/");
+  SharedMemoryExporter exporter(root.metrics(), root.children());
+  EXPECT_EQ(exporter.Open("", 4), Status::InvalidArgument());
+  EXPECT_EQ(exporter.Open(name_, 0), Status::InvalidArgument());
+  EXPECT_EQ(exporter.Open(name_, SharedMemoryExporter::kMaxCapacity + 1),
+            Status::InvalidArgument());
+}
+
+}  // namespace
+}  // namespace pw::metric
@@ -23,8 +23,40 @@ namespace pw {
 namespace multisink {
 
 void MultiSink::HandleEntry(ConstByteSpan entry) {
+  // The entry is copied without holding the lock, so that writers in other
+  // contexts are not blocked for the duration of the copy.
+  Reservation reservation;
+  if (!ReserveEntry(entry.size_bytes(), reservation).ok()) {
+    return;
+  }
+  std::memcpy(
+      reservation.first.data(), entry.data(), reservation.first.size_bytes());
+  std::memcpy(reservation.second.data(),
+              entry.data() + reservation.first.size_bytes(),
+              reservation.second.size_bytes());
+  CommitEntry(reservation);
+}
+
+Status MultiSink::ReserveEntry(size_t size_bytes,
+                               Reservation& reservation_out) {
+  std::lock_guard lock(lock_);
+  const Status status =
+      ring_buffer_.ReserveBack(size_bytes, reservation_out, sequence_id_++);
+  PW_DCHECK(status.ok() || status.IsResourceExhausted(),
+            "Invalid entry size %u",
+            static_cast<unsigned>(size_bytes));
+
+  // A failed reservation is a dropped entry, so readers are notified of the
+  // updated drop count.
+  if (!status.ok()) {
+    NotifyListeners();
+  }
+  return status;
+}
+
+void MultiSink::CommitEntry(Reservation& reservation) {
   std::lock_guard lock(lock_);
-  PW_DCHECK_OK(ring_buffer_.PushBack(entry, sequence_id_++));
+  PW_DCHECK_OK(ring_buffer_.CommitReservation(reservation));
   NotifyListeners();
 }
 
@@ -38,46 +70,103 @@ Result<ConstByteSpan> MultiSink::GetEntry(Drain& drain,
                                           ByteSpan buffer,
                                           uint32_t& drop_count_out) {
   size_t bytes_read = 0;
-  uint32_t entry_sequence_id = 0;
   drop_count_out = 0;
 
   std::lock_guard lock(lock_);
   PW_DCHECK_PTR_EQ(drain.multisink_, this);
 
-  const Status peek_status = drain.reader_.PeekFrontWithPreamble(
-      buffer, entry_sequence_id, bytes_read);
-  if (peek_status.IsOutOfRange()) {
-    // If the drain has caught up, report the last handled sequence ID so that
-    // it can still process any dropped entries.
-    entry_sequence_id = sequence_id_ - 1;
-  } else if (!peek_status.ok()) {
-    // Exit immediately if the result isn't OK or OUT_OF_RANGE, as the
-    // entry_entry_sequence_id cannot be used for computation. Later invocations
-    // to GetEntry will permit readers to determine how far the sequence ID
-    // moved forward.
-    return peek_status;
-  }
+  PW_TRY(ReadEntry(drain, buffer, bytes_read, drop_count_out));
+  return std::as_bytes(buffer.first(bytes_read));
+}
+
+StatusWithSize MultiSink::GetEntries(Drain& drain,
+                                     ByteSpan buffer,
+                                     std::span<ConstByteSpan> entries_out,
+                                     uint32_t& drop_count_out) {
+  size_t offset = 0;
+  size_t entry_count = 0;
+  drop_count_out = 0;
+
+  std::lock_guard lock(lock_);
+  PW_DCHECK_PTR_EQ(drain.multisink_, this);
 
-  // Compute the drop count delta by comparing this entry's sequence ID with the
-  // last sequence ID this drain successfully read.
-  //
-  // The drop count calculation simply computes the difference between the
-  // current and last sequence IDs. Consecutive successful reads will always
-  // differ by one at least, so it is subtracted out. If the read was not
-  // successful, the difference is not adjusted.
-  drop_count_out = entry_sequence_id - drain.last_handled_sequence_id_ -
-                   (peek_status.ok() ? 1 : 0);
-  drain.last_handled_sequence_id_ = entry_sequence_id;
-
-  // The Peek above may have failed due to OutOfRange, now that we've set the
-  // drop count see if we should return before attempting to pop.
-  if (peek_status.IsOutOfRange()) {
-    return peek_status;
+  while (entry_count < entries_out.size()) {
+    size_t bytes_read = 0;
+    const Status status =
+        ReadEntry(drain, buffer.subspan(offset), bytes_read, drop_count_out);
+    if (!status.ok()) {
+      // The entries that were read are still returned. An entry that did not
+      // fit in the rest of the buffer is left for the next call.
+      if (entry_count == 0) {
+        return StatusWithSize(status, 0);
+      }
+      break;
+    }
+    entries_out[entry_count++] = buffer.subspan(offset, bytes_read);
+    offset += bytes_read;
   }
+  return StatusWithSize(entry_count);
+}
 
-  // Success, pop the oldest entry!
-  PW_CHECK(drain.reader_.PopFront().ok());
-  return std::as_bytes(buffer.first(bytes_read));
+Status MultiSink::ReadEntry(Drain& drain,
+                            ByteSpan buffer,
+                            size_t& bytes_read_out,
+                            uint32_t& drop_count_out) {
+  while (true) {
+    size_t bytes_read = 0;
+    uint32_t entry_sequence_id = 0;
+
+    const Status peek_status = drain.reader_.PeekFrontWithPreamble(
+        buffer, entry_sequence_id, bytes_read);
+    if (peek_status.IsOutOfRange()) {
+      // The drain has caught up, so listeners are notified of the next entry.
+      listeners_notified_ = false;
+
+      // Entries that are still being written have sequence IDs, but cannot be
+      // read yet. Drops are reported once those entries are read.
+      if (ring_buffer_.PendingEntryCount() != 0) {
+        return peek_status;
+      }
+
+      // If the drain has caught up, report the last handled sequence ID so
+      // that it can still process any dropped entries.
+      entry_sequence_id = sequence_id_ - 1;
+    } else if (!peek_status.ok()) {
+      // Exit immediately if the result isn't OK or OUT_OF_RANGE, as the
+      // entry_sequence_id cannot be used for computation. Later invocations to
+      // GetEntry will permit readers to determine how far the sequence ID
+      // moved forward.
+      return peek_status;
+    }
+
+    // Compute the drop count delta by comparing this entry's sequence ID with
+    // the last sequence ID this drain successfully read.
+    //
+    // The drop count calculation simply computes the difference between the
+    // current and last sequence IDs. Consecutive successful reads will always
+    // differ by one at least, so it is subtracted out. If the read was not
+    // successful, the difference is not adjusted.
+    drop_count_out += entry_sequence_id - drain.last_handled_sequence_id_ -
+                      (peek_status.ok() ? 1 : 0);
+    drain.last_handled_sequence_id_ = entry_sequence_id;
+
+    // The Peek above may have failed due to OutOfRange, now that we've set the
+    // drop count see if we should return before attempting to pop.
+    if (peek_status.IsOutOfRange()) {
+      return peek_status;
+    }
+
+    // Success, pop the oldest entry!
+    PW_CHECK(drain.reader_.PopFront().ok());
+
+    // Entries rejected by the filter were handled, so they are not counted as
+    // dropped; the buffer is reused for the next entry.
+    if (drain.filter_ == nullptr ||
+        drain.filter_->Accept(buffer.first(bytes_read))) {
+      bytes_read_out = bytes_read;
+      return OkStatus();
+    }
+  }
 }
 
 void MultiSink::AttachDrain(Drain& drain) {
@@ -99,6 +188,8 @@ void MultiSink::DetachDrain(Drain& drain) {
 void MultiSink::AttachListener(Listener& listener) {
   std::lock_guard lock(lock_);
   listeners_.push_back(listener);
+  // Make sure the new listener is notified of the next entry.
+  listeners_notified_ = false;
 }
 
 void MultiSink::DetachListener(Listener& listener) {
@@ -107,12 +198,27 @@ void MultiSink::DetachListener(Listener& listener) {
   PW_DCHECK(was_detached, "The listener was already attached.");
 }
 
+void MultiSink::SetNotificationWatermark(uint32_t watermark) {
+  std::lock_guard lock(lock_);
+  notify_watermark_ = watermark;
+}
+
 void MultiSink::Clear() {
   std::lock_guard lock(lock_);
   ring_buffer_.Clear();
+  listeners_notified_ = false;
 }
 
 void MultiSink::NotifyListeners() {
+  // Listeners that were already notified are scheduled to read the entry, so
+  // they are only notified again once the watermark is reached.
+  if (listeners_notified_ &&
+      (notify_watermark_ == 0 || ++unnotified_events_ < notify_watermark_)) {
+    return;
+  }
+  listeners_notified_ = true;
+  unnotified_events_ = 0;
+
   for (auto& listener : listeners_) {
     listener.OnNewEntryAvailable();
   }
@@ -124,5 +230,22 @@ Result<ConstByteSpan> MultiSink::Drain::GetEntry(ByteSpan buffer,
   return multisink_->GetEntry(*this, buffer, drop_count_out);
 }
 
+StatusWithSize MultiSink::Drain::GetEntries(
+    ByteSpan buffer,
+    std::span<ConstByteSpan> entries_out,
+    uint32_t& drop_count_out) {
+  PW_DCHECK_NOTNULL(multisink_);
+  return multisink_->GetEntries(*this, buffer, entries_out, drop_count_out);
+}
+
+void MultiSink::Drain::SetFilter(Filter* filter) {
+  if (multisink_ == nullptr) {
+    filter_ = filter;
+    return;
+  }
+  std::lock_guard lock(multisink_->lock_);
+  filter_ = filter;
+}
+
 }  // namespace multisink
 }  // namespace pw
@@ -14,6 +14,8 @@
 
 #include "pw_multisink/multisink.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
 namespace pw::multisink {
@@ -194,4 +196,186 @@ TEST_F(MultiSinkTest, TooSmallBuffer) {
   ExpectMessageAndDropCount(drains_[0], {}, 0u);
 }
 
+TEST_F(MultiSinkTest, ReserveEntry) {
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.AttachListener(listeners_[0]);
+
+  // Reserve an entry, then handle another one while it is being written, as
+  // an interrupt would.
+  MultiSink::Reservation reservation;
+  ASSERT_EQ(multisink_.ReserveEntry(sizeof(kMessage), reservation),
+            OkStatus());
+  ASSERT_EQ(reservation.size(), sizeof(kMessage));
+  ExpectNotificationCount(listeners_[0], 0u);
+
+  constexpr std::byte kOtherMessage[] = {(std::byte)0x01, (std::byte)0x02};
+  multisink_.HandleEntry(kOtherMessage);
+  ExpectNotificationCount(listeners_[0], 1u);
+
+  // Neither entry is available until the reserved entry is committed.
+  ExpectMessageAndDropCount(drains_[0], {}, 0u);
+
+  std::memcpy(reservation.first.data(), kMessage, sizeof(kMessage));
+  multisink_.CommitEntry(reservation);
+  ExpectNotificationCount(listeners_[0], 1u);
+
+  ExpectMessageAndDropCount(drains_[0], kMessage, 0u);
+  ExpectMessageAndDropCount(drains_[0], kOtherMessage, 0u);
+  ExpectMessageAndDropCount(drains_[0], {}, 0u);
+}
+
+TEST_F(MultiSinkTest, ReserveEntry_FailureCountsAsDrop) {
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.AttachListener(listeners_[0]);
+
+  // Reserve most of the buffer, so that there is no space for other entries
+  // until it is committed.
+  MultiSink::Reservation reservation;
+  ASSERT_EQ(multisink_.ReserveEntry(kEntryBufferSize, reservation),
+            OkStatus());
+  MultiSink::Reservation other_reservation;
+  EXPECT_EQ(multisink_.ReserveEntry(kBufferSize - kEntryBufferSize,
+                                    other_reservation),
+            Status::ResourceExhausted());
+  ExpectNotificationCount(listeners_[0], 1u);
+
+  std::memset(reservation.first.data(), 0, reservation.first.size());
+  multisink_.CommitEntry(reservation);
+  multisink_.HandleEntry(kMessage);
+
+  uint32_t drop_count = 0;
+  Result<ConstByteSpan> result = drains_[0].GetEntry(entry_buffer_, drop_count);
+  ASSERT_TRUE(result.ok());
+  EXPECT_EQ(result.value().size(), kEntryBufferSize);
+  EXPECT_EQ(drop_count, 0u);
+  ExpectMessageAndDropCount(drains_[0], kMessage, 1u);
+}
+
+TEST_F(MultiSinkTest, GetEntries) {
+  multisink_.AttachDrain(drains_[0]);
+
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleDropped();
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kMessage);
+
+  ConstByteSpan entries[2];
+  uint32_t drop_count = 0;
+  StatusWithSize result =
+      drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(drop_count, 1u);
+  for (ConstByteSpan entry : entries) {
+    ASSERT_EQ(entry.size(), sizeof(kMessage));
+    EXPECT_EQ(memcmp(entry.data(), kMessage, sizeof(kMessage)), 0);
+  }
+  EXPECT_EQ(entries[1].data(), entries[0].data() + sizeof(kMessage));
+
+  // Reading stops at an entry that does not fit in the buffer.
+  multisink_.HandleEntry(kMessage);
+  result = drains_[0].GetEntries(
+      std::span(entry_buffer_, sizeof(kMessage) + 1), entries, drop_count);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), 1u);
+  EXPECT_EQ(drop_count, 0u);
+
+  result = drains_[0].GetEntries(
+      std::span(entry_buffer_, sizeof(kMessage) - 1), entries, drop_count);
+  EXPECT_EQ(result.status(), Status::ResourceExhausted());
+  EXPECT_EQ(result.size(), 0u);
+
+  result = drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), 1u);
+
+  multisink_.HandleDropped();
+  result = drains_[0].GetEntries(entry_buffer_, entries, drop_count);
+  EXPECT_EQ(result.status(), Status::OutOfRange());
+  EXPECT_EQ(result.size(), 0u);
+  EXPECT_EQ(drop_count, 1u);
+}
+
+class FirstByteFilter : public MultiSink::Filter {
+ public:
+  constexpr FirstByteFilter(std::byte first_byte) : first_byte_(first_byte) {}
+
+ protected:
+  bool Accept(ConstByteSpan entry) override {
+    return entry.front() == first_byte_;
+  }
+
+ private:
+  std::byte first_byte_;
+};
+
+TEST_F(MultiSinkTest, Filter) {
+  FirstByteFilter filter(kMessage[0]);
+  drains_[0].SetFilter(&filter);
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.AttachDrain(drains_[1]);
+
+  constexpr std::byte kOtherMessage[] = {(std::byte)0x01, (std::byte)0x02};
+  multisink_.HandleEntry(kOtherMessage);
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kOtherMessage);
+  multisink_.HandleDropped();
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kOtherMessage);
+
+  // Filtered entries are skipped without being reported as drops.
+  ExpectMessageAndDropCount(drains_[0], kMessage, 0u);
+  ExpectMessageAndDropCount(drains_[0], kMessage, 1u);
+  ExpectMessageAndDropCount(drains_[0], {}, 0u);
+
+  // Other drains are not affected.
+  ExpectMessageAndDropCount(drains_[1], kOtherMessage, 0u);
+  ExpectMessageAndDropCount(drains_[1], kMessage, 0u);
+
+  drains_[1].SetFilter(&filter);
+  ExpectMessageAndDropCount(drains_[1], kMessage, 1u);
+  drains_[1].SetFilter(nullptr);
+  ExpectMessageAndDropCount(drains_[1], kOtherMessage, 0u);
+}
+
+TEST_F(MultiSinkTest, NotificationWatermark) {
+  multisink_.AttachDrain(drains_[0]);
+  multisink_.AttachListener(listeners_[0]);
+  multisink_.SetNotificationWatermark(3);
+
+  // After the first notification, listeners are notified once every three
+  // entries or drops until the drain catches up.
+  for (size_t i = 0; i < 7u; ++i) {
+    multisink_.HandleEntry(kMessage);
+  }
+  multisink_.HandleDropped();
+  ExpectNotificationCount(listeners_[0], 3u);
+
+  // Reading does not resume notifications until the drain has caught up.
+  ExpectMessageAndDropCount(drains_[0], kMessage, 0u);
+  multisink_.HandleEntry(kMessage);
+  ExpectNotificationCount(listeners_[0], 0u);
+
+  for (size_t i = 0; i < 7u; ++i) {
+    ExpectMessageAndDropCount(drains_[0], kMessage, i == 6u ? 1u : 0u);
+  }
+  ExpectMessageAndDropCount(drains_[0], {}, 0u);
+  multisink_.HandleEntry(kMessage);
+  multisink_.HandleEntry(kMessage);
+  ExpectNotificationCount(listeners_[0], 1u);
+
+  // With a zero watermark, listeners are only notified after catching up.
+  multisink_.SetNotificationWatermark(0);
+  for (size_t i = 0; i < 10u; ++i) {
+    multisink_.HandleEntry(kMessage);
+  }
+  ExpectNotificationCount(listeners_[0], 0u);
+
+  // A newly attached listener is notified of the next entry.
+  multisink_.AttachListener(listeners_[1]);
+  multisink_.HandleEntry(kMessage);
+  ExpectNotificationCount(listeners_[0], 1u);
+  ExpectNotificationCount(listeners_[1], 1u);
+}
+
 }  // namespace pw::multisink
@@ -0,0 +1,166 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_multisink/partitioned_multisink.h"
+
+#include <cstring>
+#include <mutex>
+
+#include "pw_assert/check.h"
+
+namespace pw {
+namespace multisink {
+
+PartitionedMultiSink::PartitionedMultiSink(std::span<const ByteSpan> buffers)
+    : partition_count_(buffers.size()) {
+  PW_CHECK_UINT_GT(buffers.size(), 0);
+  PW_CHECK_UINT_LE(buffers.size(), kMaxPartitions);
+  for (size_t i = 0; i < partition_count_; ++i) {
+    PW_CHECK_OK(partitions_[i].ring_buffer.SetBuffer(buffers[i]));
+  }
+}
+
+void PartitionedMultiSink::HandleEntry(size_t partition, ConstByteSpan entry) {
+  PW_DCHECK_UINT_LT(partition, partition_count_);
+  ring_buffer::PrefixedEntryRingBufferMulti& ring_buffer =
+      partitions_[partition].ring_buffer;
+
+  // As in MultiSink, the entry is copied without holding the lock, so that
+  // writers in other contexts are not blocked for the duration of the copy.
+  MultiSink::Reservation reservation;
+  {
+    std::lock_guard lock(lock_);
+    const Status status = ring_buffer.ReserveBack(
+        entry.size_bytes(), reservation, partitions_[partition].sequence_id++);
+    PW_DCHECK(status.ok() || status.IsResourceExhausted(),
+              "Invalid entry size %u",
+              static_cast<unsigned>(entry.size_bytes()));
+    if (!status.ok()) {
+      NotifyListeners();
+      return;
+    }
+  }
+
+  std::memcpy(
+      reservation.first.data(), entry.data(), reservation.first.size_bytes());
+  std::memcpy(reservation.second.data(),
+              entry.data() + reservation.first.size_bytes(),
+              reservation.second.size_bytes());
+
+  std::lock_guard lock(lock_);
+  PW_DCHECK_OK(ring_buffer.CommitReservation(reservation));
+  NotifyListeners();
+}
+
+void PartitionedMultiSink::HandleDropped(size_t partition,
+                                         uint32_t drop_count) {
+  PW_DCHECK_UINT_LT(partition, partition_count_);
+  std::lock_guard lock(lock_);
+  partitions_[partition].sequence_id += drop_count;
+  NotifyListeners();
+}
+
+Result<ConstByteSpan> PartitionedMultiSink::GetEntry(Drain& drain,
+                                                     ByteSpan buffer,
+                                                     uint32_t& drop_count_out) {
+  drop_count_out = 0;
+
+  std::lock_guard lock(lock_);
+  PW_DCHECK_PTR_EQ(drain.multisink_, this);
+
+  // Partitions are read in order of priority. Drops in each partition are
+  // found from its own sequence IDs, as in MultiSink, and summed.
+  for (size_t i = 0; i < partition_count_; ++i) {
+    const Partition& partition = partitions_[i];
+    ring_buffer::PrefixedEntryRingBufferMulti::Reader& reader =
+        drain.readers_[i];
+    uint32_t& last_handled_sequence_id = drain.last_handled_sequence_ids_[i];
+
+    size_t bytes_read = 0;
+    uint32_t entry_sequence_id = 0;
+    const Status status =
+        reader.PeekFrontWithPreamble(buffer, entry_sequence_id, bytes_read);
+    if (status.IsOutOfRange()) {
+      // Entries that are still being written have sequence IDs, but cannot be
+      // read yet. Drops are reported once those entries are read.
+      if (partition.ring_buffer.PendingEntryCount() == 0) {
+        drop_count_out += partition.sequence_id - 1 - last_handled_sequence_id;
+        last_handled_sequence_id = partition.sequence_id - 1;
+      }
+      continue;
+    }
+    if (!status.ok()) {
+      return status;
+    }
+
+    drop_count_out += entry_sequence_id - last_handled_sequence_id - 1;
+    last_handled_sequence_id = entry_sequence_id;
+    PW_CHECK(reader.PopFront().ok());
+    return std::as_bytes(buffer.first(bytes_read));
+  }
+  return Status::OutOfRange();
+}
+
+void PartitionedMultiSink::AttachDrain(Drain& drain) {
+  std::lock_guard lock(lock_);
+  PW_DCHECK_PTR_EQ(drain.multisink_, nullptr);
+  drain.multisink_ = this;
+  for (size_t i = 0; i < partition_count_; ++i) {
+    drain.last_handled_sequence_ids_[i] = partitions_[i].sequence_id - 1;
+    PW_CHECK_OK(partitions_[i].ring_buffer.AttachReader(drain.readers_[i]));
+  }
+}
+
+void PartitionedMultiSink::DetachDrain(Drain& drain) {
+  std::lock_guard lock(lock_);
+  PW_DCHECK_PTR_EQ(drain.multisink_, this);
+  drain.multisink_ = nullptr;
+  for (size_t i = 0; i < partition_count_; ++i) {
+    PW_CHECK_OK(partitions_[i].ring_buffer.DetachReader(drain.readers_[i]),
+                "The drain wasn't already attached.");
+  }
+}
+
+void PartitionedMultiSink::AttachListener(Listener& listener) {
+  std::lock_guard lock(lock_);
+  listeners_.push_back(listener);
+}
+
+void PartitionedMultiSink::DetachListener(Listener& listener) {
+  std::lock_guard lock(lock_);
+  [[maybe_unused]] bool was_detached = listeners_.remove(listener);
+  PW_DCHECK(was_detached, "The listener was already attached.");
+}
+
+void PartitionedMultiSink::Clear() {
+  std::lock_guard lock(lock_);
+  for (size_t i = 0; i < partition_count_; ++i) {
+    partitions_[i].ring_buffer.Clear();
+  }
+}
+
+void PartitionedMultiSink::NotifyListeners() {
+  for (auto& listener : listeners_) {
+    listener.OnNewEntryAvailable();
+  }
+}
+
+Result<ConstByteSpan> PartitionedMultiSink::Drain::GetEntry(
+    ByteSpan buffer, uint32_t& drop_count_out) {
+  PW_DCHECK_NOTNULL(multisink_);
+  return multisink_->GetEntry(*this, buffer, drop_count_out);
+}
+
+}  // namespace multisink
+}  // namespace pw
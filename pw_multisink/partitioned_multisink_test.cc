@@ -0,0 +1,167 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_multisink/partitioned_multisink.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::multisink {
+namespace {
+
+using Drain = PartitionedMultiSink::Drain;
+
+class CountingListener : public PartitionedMultiSink::Listener {
+ public:
+  void OnNewEntryAvailable() override { notification_count_++; }
+
+  size_t notification_count() const { return notification_count_; }
+
+ private:
+  size_t notification_count_ = 0;
+};
+
+class PartitionedMultiSinkTest : public ::testing::Test {
+ protected:
+  static constexpr std::byte kError[] = {std::byte{0xEE}, std::byte{1}};
+  static constexpr std::byte kInfo[] = {std::byte{0x11}, std::byte{2}};
+  static constexpr std::byte kDebug[] = {std::byte{0xDD}, std::byte{3}};
+
+  PartitionedMultiSinkTest()
+      : buffers_{high_buffer_, low_buffer_}, multisink_(buffers_) {}
+
+  void ExpectEntry(Drain& drain,
+                   std::span<const std::byte> expected_entry,
+                   uint32_t expected_drop_count) {
+    uint32_t drop_count = 0;
+    Result<ConstByteSpan> result = drain.GetEntry(entry_buffer_, drop_count);
+    if (expected_entry.empty()) {
+      EXPECT_EQ(Status::OutOfRange(), result.status());
+    } else {
+      ASSERT_TRUE(result.ok());
+      ASSERT_EQ(result.value().size(), expected_entry.size());
+      EXPECT_EQ(std::memcmp(result.value().data(),
+                            expected_entry.data(),
+                            expected_entry.size_bytes()),
+                0);
+    }
+    EXPECT_EQ(drop_count, expected_drop_count);
+  }
+
+  // Each partition holds a few small entries.
+  std::byte high_buffer_[16];
+  std::byte low_buffer_[16];
+  const ByteSpan buffers_[2];
+  std::byte entry_buffer_[16];
+  Drain drain_;
+  PartitionedMultiSink multisink_;
+};
+
+TEST_F(PartitionedMultiSinkTest, ReadsHighestPriorityFirst) {
+  EXPECT_EQ(multisink_.partition_count(), 2u);
+  multisink_.AttachDrain(drain_);
+
+  multisink_.HandleEntry(1, kDebug);
+  multisink_.HandleEntry(0, kError);
+  multisink_.HandleEntry(1, kInfo);
+
+  ExpectEntry(drain_, kError, 0);
+  ExpectEntry(drain_, kDebug, 0);
+  ExpectEntry(drain_, kInfo, 0);
+  ExpectEntry(drain_, {}, 0);
+}
+
+TEST_F(PartitionedMultiSinkTest, LowPriorityBurstKeepsHighPriorityEntries) {
+  multisink_.AttachDrain(drain_);
+
+  multisink_.HandleEntry(0, kError);
+  // Each entry takes 4 bytes with its preamble, so only 4 fit in a partition.
+  for (int i = 0; i < 10; ++i) {
+    multisink_.HandleEntry(1, kDebug);
+  }
+
+  ExpectEntry(drain_, kError, 0);
+  // The six oldest low priority entries were pushed out.
+  ExpectEntry(drain_, kDebug, 6);
+  ExpectEntry(drain_, kDebug, 0);
+  ExpectEntry(drain_, kDebug, 0);
+  ExpectEntry(drain_, kDebug, 0);
+  ExpectEntry(drain_, {}, 0);
+}
+
+TEST_F(PartitionedMultiSinkTest, DropsAreMergedAcrossPartitions) {
+  multisink_.AttachDrain(drain_);
+
+  multisink_.HandleDropped(0, 2);
+  multisink_.HandleEntry(0, kError);
+  multisink_.HandleDropped(1, 3);
+  multisink_.HandleEntry(1, kInfo);
+
+  ExpectEntry(drain_, kError, 2);
+  ExpectEntry(drain_, kInfo, 3);
+
+  // Drops that are not followed by an entry are reported once the drain has
+  // read everything.
+  multisink_.HandleDropped(0);
+  multisink_.HandleDropped(1);
+  ExpectEntry(drain_, {}, 2);
+  ExpectEntry(drain_, {}, 0);
+}
+
+TEST_F(PartitionedMultiSinkTest, MultipleDrains) {
+  Drain other_drain;
+  multisink_.AttachDrain(drain_);
+  multisink_.AttachDrain(other_drain);
+
+  multisink_.HandleEntry(1, kInfo);
+  multisink_.HandleEntry(0, kError);
+
+  ExpectEntry(drain_, kError, 0);
+  ExpectEntry(drain_, kInfo, 0);
+  ExpectEntry(drain_, {}, 0);
+
+  ExpectEntry(other_drain, kError, 0);
+  ExpectEntry(other_drain, kInfo, 0);
+  ExpectEntry(other_drain, {}, 0);
+
+  multisink_.DetachDrain(other_drain);
+}
+
+TEST_F(PartitionedMultiSinkTest, ListenersAreNotified) {
+  CountingListener listener;
+  multisink_.AttachListener(listener);
+
+  multisink_.HandleEntry(0, kError);
+  multisink_.HandleEntry(1, kInfo);
+  multisink_.HandleDropped(1);
+  EXPECT_EQ(listener.notification_count(), 3u);
+
+  multisink_.DetachListener(listener);
+  multisink_.HandleEntry(0, kError);
+  EXPECT_EQ(listener.notification_count(), 3u);
+}
+
+TEST_F(PartitionedMultiSinkTest, ClearReportsDrops) {
+  multisink_.AttachDrain(drain_);
+
+  multisink_.HandleEntry(0, kError);
+  multisink_.HandleEntry(1, kInfo);
+  multisink_.Clear();
+
+  ExpectEntry(drain_, {}, 2);
+}
+
+}  // namespace
+}  // namespace pw::multisink
@@ -22,6 +22,13 @@
 #define PW_MULTISINK_CONFIG_LOCK_INTERRUPT_SAFE 1
 #endif  // !defined(PW_MULTISINK_CONFIG_LOCK_INTERRUPT_SAFE)
 
+// PW_MULTISINK_CONFIG_MAX_PARTITIONS is the largest number of priority
+// partitions of a PartitionedMultiSink. Each drain of a PartitionedMultiSink
+// holds a ring buffer reader for this many partitions.
+#if !defined(PW_MULTISINK_CONFIG_MAX_PARTITIONS)
+#define PW_MULTISINK_CONFIG_MAX_PARTITIONS 4
+#endif  // !defined(PW_MULTISINK_CONFIG_MAX_PARTITIONS)
+
 #if PW_MULTISINK_CONFIG_LOCK_INTERRUPT_SAFE
 #include "pw_sync/interrupt_spin_lock.h"
 #else  // !PW_MULTISINK_CONFIG_LOCK_INTERRUPT_SAFE
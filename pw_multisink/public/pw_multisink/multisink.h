@@ -14,31 +14,61 @@
 #pragma once
 
 #include <mutex>
+#include <span>
 
 #include "pw_bytes/span.h"
 #include "pw_multisink/config.h"
 #include "pw_result/result.h"
 #include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 #include "pw_sync/lock_annotations.h"
 
 namespace pw {
 namespace multisink {
 
+class PartitionedMultiSink;
+
 // An asynchronous single-writer multi-reader queue that ensures readers can
 // poll for dropped message counts, which is useful for logging or similar
 // scenarios where readers need to be aware of the input message sequence.
 //
 // This class is thread-safe but NOT IRQ-safe when
-// PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled.
+// PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled. Entries are copied into the
+// multisink without holding the lock, which is only held while space for an
+// entry is reserved and while the entry is committed.
 class MultiSink {
  public:
+  // Space reserved for an entry by ReserveEntry(). The entry is written to
+  // `first`, and continues in `second` if the space wraps around the end of
+  // the multisink's buffer.
+  using Reservation = ring_buffer::PrefixedEntryRingBufferMulti::Reservation;
+
+  // A pure-virtual filter of the entries read by a drain, set via
+  // Drain::SetFilter. Entries that are not accepted are removed from the drain
+  // without being returned, and are not counted as dropped.
+  class Filter {
+   public:
+    constexpr Filter() {}
+    virtual ~Filter() = default;
+
+   protected:
+    friend MultiSink;
+
+    // Invoked by the multisink for each entry read by a drain the filter is
+    // set on. Returns true if the drain should return the entry. The multisink
+    // lock is held during this call, so neither the multisink nor its drains
+    // can be used during this callback.
+    virtual bool Accept(ConstByteSpan entry) = 0;
+  };
+
   // An asynchronous reader which is attached to a MultiSink via AttachDrain.
   // Each Drain holds a PrefixedEntryRingBufferMulti::Reader and abstracts away
   // entry sequence information for clients.
   class Drain {
    public:
-    constexpr Drain() : last_handled_sequence_id_(0), multisink_(nullptr) {}
+    constexpr Drain()
+        : last_handled_sequence_id_(0), multisink_(nullptr), filter_(nullptr) {}
 
     // Returns the next available entry if it exists and acquires the latest
     // drop count in parallel.
@@ -106,6 +136,33 @@ class MultiSink {
     Result<ConstByteSpan> GetEntry(ByteSpan buffer, uint32_t& drop_count_out)
         PW_LOCKS_EXCLUDED(multisink_->lock_);
 
+    // Reads as many of the available entries as fit in the buffer, up to the
+    // size of `entries_out`, while acquiring the multisink's lock only once.
+    // The entries are copied into consecutive regions of `buffer`, and
+    // `entries_out` is set to refer to them. The size is the number of entries
+    // read.
+    //
+    // The `drop_count_out` is set to the total number of entries that were
+    // dropped before or between the entries that were read, following the
+    // same rules as GetEntry.
+    //
+    // Return values:
+    // Ok - At least one entry was read. Reading stops early if the next entry
+    // does not fit in the remaining buffer, or no more entries are available.
+    // OutOfRange - No entries were available.
+    // FailedPrecondition - The drain must be attached to a sink.
+    // ResourceExhausted - The provided buffer was not large enough to store
+    // the next available entry.
+    // DataLoss - An entry was read but did not match the expected format.
+    StatusWithSize GetEntries(ByteSpan buffer,
+                              std::span<ConstByteSpan> entries_out,
+                              uint32_t& drop_count_out)
+        PW_LOCKS_EXCLUDED(multisink_->lock_);
+
+    // Sets the filter applied to entries read by this drain, or removes it if
+    // `filter` is null. The filter must outlive its use by the drain.
+    void SetFilter(Filter* filter) PW_LOCKS_EXCLUDED(multisink_->lock_);
+
     // Drains are not copyable or movable.
     Drain(const Drain&) = delete;
     Drain& operator=(const Drain&) = delete;
@@ -115,11 +172,12 @@ class MultiSink {
    protected:
     friend MultiSink;
 
-    // The `reader_` and `last_handled_sequence_id_` are managed by attached
-    // multisink and are guarded by `multisink_->lock_` when used.
+    // The `reader_`, `last_handled_sequence_id_`, and `filter_` are managed by
+    // attached multisink and are guarded by `multisink_->lock_` when used.
     ring_buffer::PrefixedEntryRingBufferMulti::Reader reader_;
     uint32_t last_handled_sequence_id_;
     MultiSink* multisink_;
+    Filter* filter_;
   };
 
   // A pure-virtual listener of a MultiSink, attached via AttachListener.
@@ -138,6 +196,7 @@ class MultiSink {
 
    protected:
     friend MultiSink;
+    friend PartitionedMultiSink;
 
     // Invoked by the attached multisink when a new entry or drop count is
     // available. The multisink lock is held during this call, so neither the
@@ -146,7 +205,12 @@ class MultiSink {
   };
 
   // Constructs a multisink using a ring buffer backed by the provided buffer.
-  MultiSink(ByteSpan buffer) : ring_buffer_(true), sequence_id_(0) {
+  MultiSink(ByteSpan buffer)
+      : ring_buffer_(true),
+        sequence_id_(0),
+        notify_watermark_(1),
+        unnotified_events_(0),
+        listeners_notified_(false) {
     ring_buffer_.SetBuffer(buffer);
   }
 
@@ -155,6 +219,8 @@ class MultiSink {
   // out to make space, so long as the entry is not larger than the buffer.
   // The sequence ID of the multisink will always increment as a result of
   // calling HandleEntry, regardless of whether pushing the entry succeeds.
+  // Pushing the entry fails if entries that are still being written in other
+  // contexts occupy the space it needs; see ReserveEntry().
   //
   // Precondition: If PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled, this
   // function must not be called from an interrupt context.
@@ -162,6 +228,38 @@ class MultiSink {
   // Precondition: entry.size() <= `ring_buffer_` size
   void HandleEntry(ConstByteSpan entry) PW_LOCKS_EXCLUDED(lock_);
 
+  // Reserves space for an entry of `size_bytes` in the multisink, pushing the
+  // oldest entries out as needed like HandleEntry(). The caller writes the
+  // entry into the reservation without holding the multisink's lock, then
+  // calls CommitEntry(). Entries are seen by drains in the order they were
+  // reserved, once all entries reserved before them are committed, so every
+  // reservation must be committed promptly. The sequence ID of the multisink
+  // always increments, so a failed reservation is seen by drains as a dropped
+  // entry.
+  //
+  // This allows an interrupt to write an entry while a thread is writing
+  // another, instead of waiting for it or disabling interrupts for the
+  // duration of the copy.
+  //
+  // Precondition: If PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled, this
+  // function must not be called from an interrupt context.
+  // Precondition: size_bytes > 0
+  // Precondition: size_bytes <= `ring_buffer_` size
+  //
+  // Return values:
+  // Ok - Space was reserved for the entry.
+  // ResourceExhausted - Entries that are still being written occupy the space
+  // needed for the entry.
+  Status ReserveEntry(size_t size_bytes, Reservation& reservation_out)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Commits an entry that was reserved with ReserveEntry() once it has been
+  // written, and notifies listeners. The reservation is cleared.
+  //
+  // Precondition: The reservation was returned by ReserveEntry() and has not
+  // been committed.
+  void CommitEntry(Reservation& reservation) PW_LOCKS_EXCLUDED(lock_);
+
   // Notifies the multisink of messages dropped before ingress. The writer
   // may use this to signal to readers that an entry (or entries) failed
   // before being sent to the multisink (e.g. the writer failed to encode
@@ -195,6 +293,17 @@ class MultiSink {
   // Precondition: The listener must be attached to this multisink.
   void DetachListener(Listener& listener) PW_LOCKS_EXCLUDED(lock_);
 
+  // Sets how often listeners are notified. Listeners are always notified of
+  // the first new entry or drop after a drain has read all available entries.
+  // Until a drain catches up again, they are then only notified once every
+  // `watermark` entries or drops, instead of for each one. A watermark of zero
+  // notifies listeners only after a drain catches up.
+  //
+  // The default watermark of one notifies listeners of every entry and drop.
+  // Larger watermarks reduce wakeups of draining threads for chatty writers,
+  // since a drain that has not caught up yet is already scheduled to read.
+  void SetNotificationWatermark(uint32_t watermark) PW_LOCKS_EXCLUDED(lock_);
+
   // Removes all data from the internal buffer. The multisink's sequence ID is
   // not modified, so readers may interpret this event as droppping entries.
   void Clear() PW_LOCKS_EXCLUDED(lock_);
@@ -217,13 +326,36 @@ class MultiSink {
                                  uint32_t& drop_count_out)
       PW_LOCKS_EXCLUDED(lock_);
 
+  // Gets the available entries that fit in the buffer from the provided drain.
+  // Returns the same values as Drain::GetEntries.
+  StatusWithSize GetEntries(Drain& drain,
+                            ByteSpan buffer,
+                            std::span<ConstByteSpan> entries_out,
+                            uint32_t& drop_count_out) PW_LOCKS_EXCLUDED(lock_);
+
  private:
-  // Notifies attached listeners of new entries or an updated drop count.
+  // Reads the next entry accepted by the drain's filter into the buffer and
+  // pops it, adding the number of entries dropped before it to
+  // `drop_count_out`. Entries rejected by the filter are popped and skipped.
+  // Returns the same values as GetEntry.
+  Status ReadEntry(Drain& drain,
+                   ByteSpan buffer,
+                   size_t& bytes_read_out,
+                   uint32_t& drop_count_out) PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Notifies attached listeners of new entries or an updated drop count,
+  // unless the notification is coalesced with an earlier one.
   void NotifyListeners() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   IntrusiveList<Listener> listeners_ PW_GUARDED_BY(lock_);
   ring_buffer::PrefixedEntryRingBufferMulti ring_buffer_ PW_GUARDED_BY(lock_);
   uint32_t sequence_id_ PW_GUARDED_BY(lock_);
+
+  // Notification coalescing state. `listeners_notified_` is set when listeners
+  // are notified, and cleared when a drain reads all available entries.
+  uint32_t notify_watermark_ PW_GUARDED_BY(lock_);
+  uint32_t unnotified_events_ PW_GUARDED_BY(lock_);
+  bool listeners_notified_ PW_GUARDED_BY(lock_);
   LockType lock_;
 };
 
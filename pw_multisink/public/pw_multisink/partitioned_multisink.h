@@ -0,0 +1,185 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_multisink/config.h"
+#include "pw_multisink/multisink.h"
+#include "pw_result/result.h"
+#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
+#include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+
+namespace pw {
+namespace multisink {
+
+// A multisink with a separate ring buffer for each priority class, so that a
+// burst of low priority entries cannot push out higher priority entries before
+// a slow drain reads them. Each partition only overwrites its own oldest
+// entries, and drains read every entry available in a higher priority
+// partition before any entry in a lower priority one.
+//
+// Partition 0 has the highest priority. Writers choose the partition of each
+// entry, for example from its log level:
+//
+//   std::byte error_buffer[512];
+//   std::byte info_buffer[2048];
+//   std::byte debug_buffer[1024];
+//   const pw::ByteSpan buffers[] = {error_buffer, info_buffer, debug_buffer};
+//   pw::multisink::PartitionedMultiSink multisink(buffers);
+//
+//   size_t PartitionForLevel(int level) {
+//     if (level >= PW_LOG_LEVEL_ERROR) {
+//       return 0;
+//     }
+//     return level >= PW_LOG_LEVEL_INFO ? 1 : 2;
+//   }
+//
+//   multisink.HandleEntry(PartitionForLevel(level), entry);
+//
+// Every partition numbers its entries and drops separately, so drains find
+// the entries dropped from each partition exactly. A drain merges them into a
+// single drop count, as for a MultiSink.
+//
+// This class is thread-safe but NOT IRQ-safe when
+// PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled. As with a MultiSink, entries
+// are copied without holding the lock.
+class PartitionedMultiSink {
+ public:
+  static constexpr size_t kMaxPartitions = PW_MULTISINK_CONFIG_MAX_PARTITIONS;
+
+  // Listeners are shared with MultiSink. They are notified of every new entry
+  // and drop in any partition.
+  using Listener = MultiSink::Listener;
+
+  // An asynchronous reader which is attached to a PartitionedMultiSink via
+  // AttachDrain. Each Drain holds a reader for every partition.
+  class Drain {
+   public:
+    constexpr Drain() : last_handled_sequence_ids_{}, multisink_(nullptr) {}
+
+    // Returns the next available entry of the highest priority partition that
+    // has one, and the number of entries dropped from any partition since the
+    // last call to GetEntry.
+    //
+    // The `drop_count_out` is always set, and should be processed even if an
+    // error is returned, since drops found in higher priority partitions are
+    // reported before an error in a lower priority one.
+    //
+    // Return values:
+    // Ok - An entry was successfully read from the multisink.
+    // OutOfRange - No entries were available.
+    // FailedPrecondition - The drain must be attached to a sink.
+    // ResourceExhausted - The provided buffer was not large enough to store
+    // the next available entry.
+    // DataLoss - An entry was read but did not match the expected format.
+    Result<ConstByteSpan> GetEntry(ByteSpan buffer, uint32_t& drop_count_out)
+        PW_LOCKS_EXCLUDED(multisink_->lock_);
+
+    // Drains are not copyable or movable.
+    Drain(const Drain&) = delete;
+    Drain& operator=(const Drain&) = delete;
+    Drain(Drain&&) = delete;
+    Drain& operator=(Drain&&) = delete;
+
+   private:
+    friend PartitionedMultiSink;
+
+    // Managed by the attached multisink and guarded by `multisink_->lock_`.
+    std::array<ring_buffer::PrefixedEntryRingBufferMulti::Reader,
+               kMaxPartitions>
+        readers_;
+    std::array<uint32_t, kMaxPartitions> last_handled_sequence_ids_;
+    PartitionedMultiSink* multisink_;
+  };
+
+  // Constructs a multisink with one partition for each buffer, in order of
+  // decreasing priority.
+  //
+  // Precondition: 0 < buffers.size() <= kMaxPartitions
+  PartitionedMultiSink(std::span<const ByteSpan> buffers);
+
+  size_t partition_count() const { return partition_count_; }
+
+  // Writes an entry to a partition. If the partition's available space is
+  // less than the size of the entry, its oldest entries are pushed out to make
+  // space; the other partitions are not affected. The partition's sequence ID
+  // always increments, so an entry that could not be written is seen by
+  // drains as a dropped entry.
+  //
+  // Precondition: If PW_MULTISINK_LOCK_INTERRUPT_SAFE is disabled, this
+  // function must not be called from an interrupt context.
+  // Precondition: partition < partition_count()
+  // Precondition: entry.size() > 0
+  // Precondition: entry.size() <= the partition's buffer size
+  void HandleEntry(size_t partition, ConstByteSpan entry)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Notifies the multisink of entries of a partition that were dropped before
+  // ingress.
+  //
+  // Precondition: partition < partition_count()
+  void HandleDropped(size_t partition, uint32_t drop_count = 1)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Attaches a drain to every partition. Entries pushed before the drain was
+  // attached are not seen by the drain.
+  //
+  // Precondition: The drain must not be attached to a multisink.
+  void AttachDrain(Drain& drain) PW_LOCKS_EXCLUDED(lock_);
+
+  // Detaches a drain from the multisink.
+  //
+  // Precondition: The drain must be attached to this multisink.
+  void DetachDrain(Drain& drain) PW_LOCKS_EXCLUDED(lock_);
+
+  // Precondition: The listener must not be attached to a multisink.
+  void AttachListener(Listener& listener) PW_LOCKS_EXCLUDED(lock_);
+
+  // Precondition: The listener must be attached to this multisink.
+  void DetachListener(Listener& listener) PW_LOCKS_EXCLUDED(lock_);
+
+  // Removes all entries from every partition. Sequence IDs are not modified,
+  // so readers may interpret this event as dropping entries.
+  void Clear() PW_LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Partition {
+    Partition() : ring_buffer(true), sequence_id(0) {}
+
+    ring_buffer::PrefixedEntryRingBufferMulti ring_buffer;
+    uint32_t sequence_id;
+  };
+
+  Result<ConstByteSpan> GetEntry(Drain& drain,
+                                 ByteSpan buffer,
+                                 uint32_t& drop_count_out)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  void NotifyListeners() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  IntrusiveList<Listener> listeners_ PW_GUARDED_BY(lock_);
+  std::array<Partition, kMaxPartitions> partitions_ PW_GUARDED_BY(lock_);
+  const size_t partition_count_;
+  LockType lock_;
+};
+
+}  // namespace multisink
+}  // namespace pw
@@ -15,9 +15,23 @@
 
 #include "pw_bytes/span.h"
 #include "pw_checksum/crc16_ccitt.h"
+#include "pw_checksum/crc32.h"
 #include "pw_status/status.h"
 
 namespace pw::persistent_ram {
+namespace internal {
+
+uint32_t UpdateChecksum(PersistentBufferChecksum type,
+                        ConstByteSpan data,
+                        uint32_t previous) {
+  if (type == PersistentBufferChecksum::kCrc32) {
+    return pw_checksum_Crc32Append(data.data(), data.size_bytes(), previous);
+  }
+  return checksum::Crc16Ccitt::Calculate(data,
+                                         static_cast<uint16_t>(previous));
+}
+
+}  // namespace internal
 
 Status PersistentBufferWriter::DoWrite(ConstByteSpan data) {
   if (ConservativeWriteLimit() == 0) {
@@ -33,8 +47,10 @@ Status PersistentBufferWriter::DoWrite(ConstByteSpan data) {
   std::memcpy(buffer_.data() + size_, data.data(), data.size_bytes());
 
   // Only checksum newly written data.
-  checksum_ = checksum::Crc16Ccitt::Calculate(
-      ByteSpan(buffer_.data() + size_, data.size_bytes()), checksum_);
+  checksum_ = internal::UpdateChecksum(
+      checksum_type_,
+      ConstByteSpan(buffer_.data() + size_, data.size_bytes()),
+      checksum_);
   size_ += data.size_bytes();
 
   return OkStatus();
@@ -38,8 +38,12 @@ class PersistentTest : public ::testing::Test {
     ASSERT_EQ(sws.size(), sizeof(buffer_));
   }
 
-  PersistentBuffer<kBufferSize>& GetPersistentBuffer() {
-    return *(new (buffer_) PersistentBuffer<kBufferSize>());
+  template <PersistentBufferChecksum kChecksum =
+                PersistentBufferChecksum::kCrc16Ccitt>
+  PersistentBuffer<kBufferSize, kChecksum>& GetPersistentBuffer() {
+    static_assert(sizeof(PersistentBuffer<kBufferSize, kChecksum>) <=
+                  sizeof(buffer_));
+    return *(new (buffer_) PersistentBuffer<kBufferSize, kChecksum>());
   }
 
   // Allocate a chunk of aligned storage that can be independently controlled.
@@ -154,5 +158,90 @@ TEST_F(PersistentTest, AppendingData) {
   }
 }
 
+TEST_F(PersistentTest, Crc32AppendingData) {
+  constexpr std::string_view kTestString("Test string one!");
+  constexpr uint32_t kTestNumber = 42;
+
+  {  // Initialize the buffer.
+    RandomFillMemory();
+    auto& persistent =
+        GetPersistentBuffer<PersistentBufferChecksum::kCrc32>();
+    ASSERT_FALSE(persistent.has_value());
+
+    auto writer = persistent.GetWriter();
+    writer.Write(std::as_bytes(std::span(&kTestNumber, 1)));
+    ASSERT_TRUE(persistent.has_value());
+
+    persistent.~PersistentBuffer();  // Emulate shutdown / global destructors.
+  }
+
+  {  // Append after a reboot.
+    auto& persistent =
+        GetPersistentBuffer<PersistentBufferChecksum::kCrc32>();
+    ASSERT_TRUE(persistent.has_value());
+    auto writer = persistent.GetWriter();
+    writer.Write(std::as_bytes(std::span<const char>(kTestString)));
+
+    persistent.~PersistentBuffer();  // Emulate shutdown / global destructors.
+  }
+
+  {  // Ensure data was appended.
+    auto& persistent =
+        GetPersistentBuffer<PersistentBufferChecksum::kCrc32>();
+    ASSERT_TRUE(persistent.has_value());
+    EXPECT_EQ(persistent.size(), sizeof(kTestNumber) + kTestString.length());
+
+    // Corrupt the stored data.
+    const_cast<std::byte*>(persistent.data())[1] ^= std::byte{0x10};
+    EXPECT_FALSE(persistent.has_value());
+  }
+}
+
+TEST_F(PersistentTest, DeferredValidationAppends) {
+  constexpr uint32_t kTestNumber = 42;
+
+  {  // Initialize the buffer from random memory.
+    RandomFillMemory();
+    auto& persistent = GetPersistentBuffer();
+    auto writer = persistent.GetWriter(PersistentBufferValidation::kDeferred);
+    writer.Write(std::as_bytes(std::span(&kTestNumber, 1)));
+    ASSERT_TRUE(persistent.has_value());
+
+    persistent.~PersistentBuffer();  // Emulate shutdown / global destructors.
+  }
+
+  {  // Append after a reboot without validating first.
+    auto& persistent = GetPersistentBuffer();
+    auto writer = persistent.GetWriter(PersistentBufferValidation::kDeferred);
+    writer.Write(std::as_bytes(std::span(&kTestNumber, 1)));
+
+    ASSERT_TRUE(persistent.has_value());
+    EXPECT_EQ(persistent.size(), 2 * sizeof(kTestNumber));
+  }
+}
+
+TEST_F(PersistentTest, DeferredValidationDetectsCorruption) {
+  constexpr uint32_t kTestNumber = 42;
+
+  {  // Initialize the buffer.
+    auto& persistent = GetPersistentBuffer();
+    auto writer = persistent.GetWriter();
+    writer.Write(std::as_bytes(std::span(&kTestNumber, 1)));
+    ASSERT_TRUE(persistent.has_value());
+
+    // Corrupt the stored data.
+    const_cast<std::byte*>(persistent.data())[0] ^= std::byte{0x01};
+    persistent.~PersistentBuffer();  // Emulate shutdown / global destructors.
+  }
+
+  {  // The corruption is only detected when the data is read.
+    auto& persistent = GetPersistentBuffer();
+    auto writer = persistent.GetWriter(PersistentBufferValidation::kDeferred);
+    writer.Write(std::as_bytes(std::span(&kTestNumber, 1)));
+    EXPECT_FALSE(persistent.has_value());
+    EXPECT_EQ(persistent.size(), 0u);
+  }
+}
+
 }  // namespace
 }  // namespace pw::persistent_ram
@@ -0,0 +1,271 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_persistent_ram/persistent_ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+
+#include "pw_checksum/crc16_ccitt.h"
+
+namespace pw::persistent_ram {
+namespace internal {
+namespace {
+
+uint16_t HeaderChecksum(size_t read, size_t write, size_t entry_count) {
+  const uint32_t fields[] = {static_cast<uint32_t>(read),
+                             static_cast<uint32_t>(write),
+                             static_cast<uint32_t>(entry_count)};
+  return checksum::Crc16Ccitt::Calculate(std::as_bytes(std::span(fields)));
+}
+
+}  // namespace
+
+Status PersistentRing::Recover() {
+  if (!HeaderValid()) {
+    Clear();
+    return Status::DataLoss();
+  }
+
+  // Follow the chain of entry prefixes. It must reach the write offset after
+  // exactly entry_count entries; otherwise, keep the entries before the break.
+  // The entry data is checked when it is read.
+  const size_t read = header_.read;
+  const size_t entry_count = header_.entry_count;
+  size_t offset = read;
+  size_t remaining = TotalUsedBytes();
+  for (size_t i = 0; i < entry_count; ++i) {
+    Prefix prefix;
+    const size_t entry_bytes = ReadPrefix(offset, remaining, prefix);
+    if (entry_bytes == 0) {
+      CommitHeader(read, offset, i);
+      return Status::DataLoss();
+    }
+    offset = Wrap(offset + entry_bytes);
+    remaining -= entry_bytes;
+  }
+
+  if (remaining != 0) {
+    CommitHeader(read, offset, entry_count);
+    return Status::DataLoss();
+  }
+  return OkStatus();
+}
+
+Status PersistentRing::PushBack(ConstByteSpan data) {
+  if (data.empty()) {
+    return Status::InvalidArgument();
+  }
+  const size_t entry_bytes = kEntryPrefixBytes + data.size_bytes();
+  if (data.size_bytes() > kMaxEntrySizeBytes ||
+      entry_bytes > buffer_.size()) {
+    return Status::OutOfRange();
+  }
+  if (!HeaderValid()) {
+    Clear();
+  }
+
+  size_t read = header_.read;
+  const size_t write = header_.write;
+  size_t entry_count = header_.entry_count;
+  size_t used = TotalUsedBytes();
+
+  // Drop the oldest entries until the new one fits. The header is committed
+  // before their space is overwritten.
+  if (buffer_.size() - used < entry_bytes) {
+    while (buffer_.size() - used < entry_bytes) {
+      Prefix prefix;
+      const size_t dropped_bytes = ReadPrefix(read, used, prefix);
+      if (dropped_bytes == 0) {
+        // The oldest entry can't be followed, so drop everything.
+        read = write;
+        entry_count = 0;
+        used = 0;
+        break;
+      }
+      read = Wrap(read + dropped_bytes);
+      entry_count -= 1;
+      used -= dropped_bytes;
+    }
+    CommitHeader(read, write, entry_count);
+  }
+
+  const uint16_t size = static_cast<uint16_t>(data.size_bytes());
+  const uint16_t prefix_fields[] = {size,
+                                    static_cast<uint16_t>(~size),
+                                    checksum::Crc16Ccitt::Calculate(data)};
+  CopyIn(write, std::as_bytes(std::span(prefix_fields)));
+  CopyIn(Wrap(write + kEntryPrefixBytes), data);
+
+  CommitHeader(read, Wrap(write + entry_bytes), entry_count + 1);
+  return OkStatus();
+}
+
+Status PersistentRing::PopFront() {
+  if (EntryCount() == 0) {
+    return Status::OutOfRange();
+  }
+  const size_t read = header_.read;
+  Prefix prefix;
+  const size_t entry_bytes = ReadPrefix(read, TotalUsedBytes(), prefix);
+  if (entry_bytes == 0) {
+    Clear();
+    return Status::DataLoss();
+  }
+  CommitHeader(
+      Wrap(read + entry_bytes), header_.write, header_.entry_count - 1);
+  return OkStatus();
+}
+
+StatusWithSize PersistentRing::PeekFront(ByteSpan dest) const {
+  return GetReader().ReadNext(dest);
+}
+
+PersistentRingBufferReader PersistentRing::GetReader() const {
+  if (!HeaderValid()) {
+    return PersistentRingBufferReader(*this, 0, 0, 0);
+  }
+  return PersistentRingBufferReader(
+      *this, header_.read, TotalUsedBytes(), header_.entry_count);
+}
+
+size_t PersistentRing::EntryCount() const {
+  return HeaderValid() ? header_.entry_count : 0;
+}
+
+size_t PersistentRing::TotalUsedBytes() const {
+  if (!HeaderValid()) {
+    return 0;
+  }
+  return UsedBytes(header_.read, header_.write, header_.entry_count);
+}
+
+void PersistentRing::Clear() { CommitHeader(0, 0, 0); }
+
+bool PersistentRing::HeaderValid() const {
+  const size_t read = header_.read;
+  const size_t write = header_.write;
+  const size_t entry_count = header_.entry_count;
+  return read < buffer_.size() && write < buffer_.size() &&
+         (entry_count != 0 || read == write) &&
+         header_.checksum == HeaderChecksum(read, write, entry_count);
+}
+
+void PersistentRing::CommitHeader(size_t read,
+                                  size_t write,
+                                  size_t entry_count) {
+  header_.read = read;
+  header_.write = write;
+  header_.entry_count = entry_count;
+  header_.checksum = HeaderChecksum(read, write, entry_count);
+}
+
+size_t PersistentRing::UsedBytes(size_t read,
+                                 size_t write,
+                                 size_t entry_count) const {
+  if (entry_count == 0) {
+    return 0;
+  }
+  return write > read ? write - read : buffer_.size() - read + write;
+}
+
+size_t PersistentRing::ReadPrefix(size_t offset,
+                                  size_t available,
+                                  Prefix& prefix) const {
+  if (available < kEntryPrefixBytes) {
+    return 0;
+  }
+  uint16_t prefix_fields[3];
+  CopyOut(offset, std::as_writable_bytes(std::span(prefix_fields)));
+  prefix = Prefix{prefix_fields[0], prefix_fields[1], prefix_fields[2]};
+
+  const size_t entry_bytes = kEntryPrefixBytes + prefix.size;
+  if (prefix.size == 0 ||
+      prefix.size != static_cast<uint16_t>(~prefix.size_complement) ||
+      entry_bytes > available) {
+    return 0;
+  }
+  return entry_bytes;
+}
+
+StatusWithSize PersistentRing::ReadEntry(size_t offset,
+                                         size_t available,
+                                         ByteSpan dest,
+                                         size_t& entry_bytes) const {
+  Prefix prefix;
+  entry_bytes = ReadPrefix(offset, available, prefix);
+  if (entry_bytes == 0) {
+    return StatusWithSize::DataLoss();
+  }
+  if (dest.size_bytes() < prefix.size) {
+    return StatusWithSize::ResourceExhausted(prefix.size);
+  }
+
+  const size_t data_offset = Wrap(offset + kEntryPrefixBytes);
+  CopyOut(data_offset, dest.first(prefix.size));
+  if (checksum::Crc16Ccitt::Calculate(dest.first(prefix.size)) !=
+      prefix.checksum) {
+    return StatusWithSize::DataLoss();
+  }
+  return StatusWithSize(prefix.size);
+}
+
+void PersistentRing::CopyOut(size_t offset, ByteSpan dest) const {
+  const size_t first = std::min(dest.size_bytes(), buffer_.size() - offset);
+  std::memcpy(dest.data(), buffer_.data() + offset, first);
+  std::memcpy(dest.data() + first, buffer_.data(), dest.size_bytes() - first);
+}
+
+void PersistentRing::CopyIn(size_t offset, ConstByteSpan data) {
+  const size_t first = std::min(data.size_bytes(), buffer_.size() - offset);
+  std::memcpy(buffer_.data() + offset, data.data(), first);
+  std::memcpy(buffer_.data(), data.data() + first, data.size_bytes() - first);
+}
+
+}  // namespace internal
+
+PersistentRingBufferReader::PersistentRingBufferReader(
+    internal::PersistentRing ring,
+    size_t offset,
+    size_t remaining_bytes,
+    size_t remaining_entries)
+    : ring_(ring),
+      offset_(offset),
+      remaining_bytes_(remaining_bytes),
+      remaining_entries_(remaining_entries) {}
+
+StatusWithSize PersistentRingBufferReader::ReadNext(ByteSpan dest) {
+  if (remaining_entries_ == 0) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  size_t entry_bytes;
+  const StatusWithSize result =
+      ring_.ReadEntry(offset_, remaining_bytes_, dest, entry_bytes);
+  if (result.IsResourceExhausted()) {
+    return result;
+  }
+
+  if (entry_bytes == 0) {
+    // The entry can't be skipped, so stop reading.
+    remaining_entries_ = 0;
+    return result;
+  }
+  offset_ = ring_.Wrap(offset_ + entry_bytes);
+  remaining_bytes_ -= entry_bytes;
+  remaining_entries_ -= 1;
+  return result;
+}
+
+}  // namespace pw::persistent_ram
@@ -0,0 +1,239 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_persistent_ram/persistent_ring_buffer.h"
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::persistent_ram {
+namespace {
+
+class PersistentRingBufferTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kBufferSize = 64;
+  using RingBuffer = PersistentRingBuffer<kBufferSize>;
+
+  PersistentRingBufferTest() { ZeroPersistentMemory(); }
+
+  // Emulate invalidation of persistent section(s).
+  void ZeroPersistentMemory() { memset(buffer_, 0, sizeof(buffer_)); }
+  void RandomFillMemory() {
+    random::XorShiftStarRng64 rng(0x9ad75);
+    StatusWithSize sws = rng.Get(buffer_);
+    ASSERT_TRUE(sws.ok());
+    ASSERT_EQ(sws.size(), sizeof(buffer_));
+  }
+
+  // Emulate a boot, returning a ring buffer that was not constructed.
+  RingBuffer& GetRingBuffer() { return *(new (buffer_) RingBuffer()); }
+
+  // Locates data in the persistent memory so that it can be corrupted.
+  std::byte* Find(std::string_view data) {
+    for (size_t i = 0; i + data.size() <= sizeof(buffer_); ++i) {
+      if (std::memcmp(&buffer_[i], data.data(), data.size()) == 0) {
+        return &buffer_[i];
+      }
+    }
+    return nullptr;
+  }
+
+  static ConstByteSpan AsBytes(std::string_view data) {
+    return std::as_bytes(std::span(data));
+  }
+
+  // Reads all entries into a string, separated by commas. Corrupt entries are
+  // read as "!".
+  static std::string_view ReadAll(const RingBuffer& ring) {
+    static char result[kBufferSize * 2];
+    size_t length = 0;
+    std::byte entry[kBufferSize];
+    auto reader = ring.GetReader();
+    while (true) {
+      StatusWithSize sws = reader.ReadNext(entry);
+      if (sws.status().IsOutOfRange()) {
+        break;
+      }
+      if (length != 0) {
+        result[length++] = ',';
+      }
+      if (sws.ok()) {
+        std::memcpy(&result[length], entry, sws.size());
+        length += sws.size();
+      } else {
+        result[length++] = '!';
+      }
+    }
+    return std::string_view(result, length);
+  }
+
+  // Allocate a chunk of aligned storage that can be independently controlled.
+  alignas(RingBuffer) std::byte buffer_[sizeof(RingBuffer)];
+};
+
+TEST_F(PersistentRingBufferTest, ZeroedMemoryIsEmpty) {
+  auto& ring = GetRingBuffer();
+  EXPECT_EQ(ring.Recover(), Status::DataLoss());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+  EXPECT_EQ(ring.TotalUsedBytes(), 0u);
+  EXPECT_EQ(ring.PopFront(), Status::OutOfRange());
+}
+
+TEST_F(PersistentRingBufferTest, RandomMemoryIsEmpty) {
+  RandomFillMemory();
+  auto& ring = GetRingBuffer();
+  EXPECT_EQ(ring.EntryCount(), 0u);
+  EXPECT_EQ(ring.Recover(), Status::DataLoss());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+}
+
+TEST_F(PersistentRingBufferTest, EntriesPersistAcrossBoots) {
+  {
+    auto& ring = GetRingBuffer();
+    ring.Recover();
+    EXPECT_EQ(ring.PushBack(AsBytes("boot1")), OkStatus());
+    ring.~PersistentRingBuffer();  // Emulate shutdown / global destructors.
+  }
+  {
+    auto& ring = GetRingBuffer();
+    EXPECT_EQ(ring.Recover(), OkStatus());
+    EXPECT_EQ(ring.PushBack(AsBytes("boot2")), OkStatus());
+    ring.~PersistentRingBuffer();  // Emulate shutdown / global destructors.
+  }
+  {
+    auto& ring = GetRingBuffer();
+    EXPECT_EQ(ring.Recover(), OkStatus());
+    EXPECT_EQ(ring.EntryCount(), 2u);
+    EXPECT_EQ(ReadAll(ring), "boot1,boot2");
+
+    std::byte entry[8];
+    StatusWithSize sws = ring.PeekFront(entry);
+    ASSERT_TRUE(sws.ok());
+    EXPECT_EQ(sws.size(), 5u);
+    EXPECT_EQ(ring.PopFront(), OkStatus());
+    EXPECT_EQ(ReadAll(ring), "boot2");
+  }
+}
+
+TEST_F(PersistentRingBufferTest, OldestEntriesAreDropped) {
+  auto& ring = GetRingBuffer();
+  ring.Recover();
+
+  // Each entry takes 16 bytes including its prefix, so the entries wrap around
+  // the end of the buffer.
+  constexpr std::string_view kEntries[] = {
+      "entry-0000", "entry-0001", "entry-0002", "entry-0003", "entry-0004",
+      "entry-0005", "entry-0006", "entry-0007", "entry-0008", "entry-0009"};
+  for (std::string_view entry : kEntries) {
+    ASSERT_EQ(ring.PushBack(AsBytes(entry)), OkStatus());
+  }
+  EXPECT_EQ(ring.EntryCount(), 4u);
+  EXPECT_EQ(ring.TotalUsedBytes(), 64u);
+  EXPECT_EQ(ReadAll(ring), "entry-0006,entry-0007,entry-0008,entry-0009");
+
+  // Entries of a different size also wrap.
+  ASSERT_EQ(ring.PushBack(AsBytes("a-longer-entry-with-more-data")), OkStatus());
+  EXPECT_EQ(ReadAll(ring), "entry-0009,a-longer-entry-with-more-data");
+
+  ring.~PersistentRingBuffer();  // Emulate shutdown / global destructors.
+  auto& rebooted = GetRingBuffer();
+  EXPECT_EQ(rebooted.Recover(), OkStatus());
+  EXPECT_EQ(ReadAll(rebooted), "entry-0009,a-longer-entry-with-more-data");
+}
+
+TEST_F(PersistentRingBufferTest, InvalidEntries) {
+  auto& ring = GetRingBuffer();
+  ring.Recover();
+  EXPECT_EQ(ring.PushBack({}), Status::InvalidArgument());
+
+  std::byte too_large[kBufferSize] = {};
+  EXPECT_EQ(ring.PushBack(too_large), Status::OutOfRange());
+  EXPECT_EQ(
+      ring.PushBack(std::span(too_large).first(RingBuffer::kMaxEntrySizeBytes)),
+      OkStatus());
+  EXPECT_EQ(ring.TotalUsedBytes(), kBufferSize);
+
+  std::byte small[4];
+  StatusWithSize sws = ring.PeekFront(small);
+  EXPECT_EQ(sws.status(), Status::ResourceExhausted());
+  EXPECT_EQ(sws.size(), RingBuffer::kMaxEntrySizeBytes);
+}
+
+TEST_F(PersistentRingBufferTest, CorruptDataLosesOnlyThatEntry) {
+  {
+    auto& ring = GetRingBuffer();
+    ring.Recover();
+    ring.PushBack(AsBytes("first"));
+    ring.PushBack(AsBytes("second"));
+    ring.PushBack(AsBytes("third"));
+
+    // Emulate a brownout corrupting the data of the second entry.
+    *Find("second") = std::byte{'S'};
+    ring.~PersistentRingBuffer();  // Emulate shutdown / global destructors.
+  }
+
+  auto& ring = GetRingBuffer();
+  // Recovery only follows the prefixes, so the entry is found when read.
+  EXPECT_EQ(ring.Recover(), OkStatus());
+  EXPECT_EQ(ReadAll(ring), "first,!,third");
+}
+
+TEST_F(PersistentRingBufferTest, CorruptPrefixKeepsEarlierEntries) {
+  {
+    auto& ring = GetRingBuffer();
+    ring.Recover();
+    ring.PushBack(AsBytes("first"));
+    ring.PushBack(AsBytes("second"));
+    ring.PushBack(AsBytes("third"));
+
+    // Corrupt the size of the second entry, which is stored just before the
+    // size complement and checksum that precede its data.
+    std::byte* data = Find("second");
+    ASSERT_NE(data, nullptr);
+    *(data - RingBuffer::kEntryPrefixBytes) ^= std::byte{0x40};
+    ring.~PersistentRingBuffer();  // Emulate shutdown / global destructors.
+  }
+
+  auto& ring = GetRingBuffer();
+  EXPECT_EQ(ring.Recover(), Status::DataLoss());
+  EXPECT_EQ(ring.EntryCount(), 1u);
+  EXPECT_EQ(ReadAll(ring), "first");
+
+  // Appending continues after the entries that were kept.
+  EXPECT_EQ(ring.PushBack(AsBytes("fourth")), OkStatus());
+  EXPECT_EQ(ReadAll(ring), "first,fourth");
+}
+
+TEST_F(PersistentRingBufferTest, InterruptedHeaderUpdateIsDetected) {
+  {
+    auto& ring = GetRingBuffer();
+    ring.Recover();
+    ring.PushBack(AsBytes("first"));
+    ring.~PersistentRingBuffer();  // Emulate shutdown / global destructors.
+  }
+
+  // The header is at the start of the ring buffer. Corrupt its write offset.
+  buffer_[4] ^= std::byte{0x01};
+
+  auto& ring = GetRingBuffer();
+  EXPECT_EQ(ring.Recover(), Status::DataLoss());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+}
+
+}  // namespace
+}  // namespace pw::persistent_ram
@@ -21,12 +21,47 @@
 
 #include "pw_bytes/span.h"
 #include "pw_checksum/crc16_ccitt.h"
+#include "pw_checksum/crc32.h"
 #include "pw_preprocessor/compiler.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
 
 namespace pw::persistent_ram {
 
+// The checksum used to validate a PersistentBuffer. CRC16 is cheaper to store
+// and compute, but CRC32 detects corruption more reliably in large buffers.
+enum class PersistentBufferChecksum {
+  kCrc16Ccitt,
+  kCrc32,
+};
+
+// How much of a PersistentBuffer's stored data GetWriter() validates.
+enum class PersistentBufferValidation {
+  // Checksum all of the stored data and clear it if it is invalid.
+  kFull,
+
+  // Only check that the stored size is in range. The checksum is not verified
+  // until the data is read with has_value() or size(). Use this to open a
+  // writer early in boot without checksumming the whole buffer. If the stored
+  // data turns out to be corrupt, data appended to it is discarded with it.
+  kDeferred,
+};
+
+namespace internal {
+
+constexpr uint32_t InitialChecksum(PersistentBufferChecksum type) {
+  return type == PersistentBufferChecksum::kCrc32
+             ? uint32_t{PW_CHECKSUM_EMPTY_CRC32}
+             : uint32_t{checksum::Crc16Ccitt::kInitialValue};
+}
+
+// Extends a checksum of previously written data with data.
+uint32_t UpdateChecksum(PersistentBufferChecksum type,
+                        ConstByteSpan data,
+                        uint32_t previous);
+
+}  // namespace internal
+
 // A PersistentBufferWriter implements the pw::stream::Writer interface and
 // provides handles to mutate and access the underlying data of a
 // PersistentBuffer. This object should NOT be stored in persistent RAM.
@@ -41,20 +76,27 @@ class PersistentBufferWriter : public stream::Writer {
   }
 
  private:
-  template <size_t>
+  template <size_t, PersistentBufferChecksum>
   friend class PersistentBuffer;
 
   PersistentBufferWriter(ByteSpan buffer,
                          volatile size_t& size,
-                         volatile uint16_t& checksum)
-      : buffer_(buffer), size_(size), checksum_(checksum) {}
-
-  // Implementation for writing data to this stream.
+                         volatile uint32_t& checksum,
+                         PersistentBufferChecksum checksum_type)
+      : buffer_(buffer),
+        size_(size),
+        checksum_(checksum),
+        checksum_type_(checksum_type) {}
+
+  // Implementation for writing data to this stream. Only the newly written data
+  // is checksummed, so the cost of a write does not depend on how much data the
+  // buffer already holds.
   Status DoWrite(ConstByteSpan data) override;
 
   ByteSpan buffer_;
   volatile size_t& size_;
-  volatile uint16_t& checksum_;
+  volatile uint32_t& checksum_;
+  PersistentBufferChecksum checksum_type_;
 };
 
 // The PersistentBuffer class intentionally uses uninitialized memory, which
@@ -74,7 +116,14 @@ PW_MODIFY_DIAGNOSTIC_GCC(ignored, "-Wmaybe-uninitialized");
 // instead, as data is validated on creation of the PersistentBufferWriter,
 // which allows access to the underlying data without needing to validate the
 // data's integrity with each call to PersistentBufferWriter functions.
-template <size_t kMaxSizeBytes>
+//
+// The checksum is kept up to date incrementally as data is written, and is
+// stored with the data so it carries across boots. kChecksum selects the
+// algorithm; prefer PersistentBufferChecksum::kCrc32 for buffers larger than a
+// few KiB.
+template <size_t kMaxSizeBytes,
+          PersistentBufferChecksum kChecksum =
+              PersistentBufferChecksum::kCrc16Ccitt>
 class PersistentBuffer {
  public:
   // The default constructor intentionally does not initialize anything. This
@@ -99,14 +148,21 @@ class PersistentBuffer {
   // Explicit no-op destructor.
   ~PersistentBuffer() {}
 
-  PersistentBufferWriter GetWriter() {
-    if (!has_value()) {
+  // Returns a writer that appends to the stored data. If the stored data is
+  // invalid, it is cleared first. See PersistentBufferValidation for how
+  // thoroughly the stored data is checked.
+  PersistentBufferWriter GetWriter(
+      PersistentBufferValidation validation =
+          PersistentBufferValidation::kFull) {
+    if (validation == PersistentBufferValidation::kFull ? !has_value()
+                                                        : !size_in_range()) {
       clear();
     }
     return PersistentBufferWriter(
         ByteSpan(const_cast<std::byte*>(buffer_), kMaxSizeBytes),
         size_,
-        checksum_);
+        checksum_,
+        kChecksum);
   }
 
   size_t size() const {
@@ -120,22 +176,27 @@ class PersistentBuffer {
 
   void clear() {
     size_ = 0;
-    checksum_ = checksum::Crc16Ccitt::kInitialValue;
+    checksum_ = internal::InitialChecksum(kChecksum);
   }
 
   bool has_value() const {
-    if (size_ > kMaxSizeBytes || size_ == 0) {
+    if (!size_in_range()) {
       return false;
     }
 
     // Check checksum. This is more costly.
-    return checksum_ == checksum::Crc16Ccitt::Calculate(ConstByteSpan(
-                            const_cast<std::byte*>(buffer_), size_));
+    return checksum_ ==
+           internal::UpdateChecksum(
+               kChecksum,
+               ConstByteSpan(const_cast<std::byte*>(buffer_), size_),
+               internal::InitialChecksum(kChecksum));
   }
 
  private:
+  bool size_in_range() const { return size_ != 0 && size_ <= kMaxSizeBytes; }
+
   // None of these members are initialized by the constructor by design.
-  volatile uint16_t checksum_;
+  volatile uint32_t checksum_;
   volatile size_t size_;
   volatile std::byte buffer_[kMaxSizeBytes];
 };
@@ -0,0 +1,227 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::persistent_ram {
+
+class PersistentRingBufferReader;
+
+namespace internal {
+
+// The header of a PersistentRingBuffer. It is only updated after the entries it
+// describes have been written, so a reset in the middle of a write leaves the
+// buffer in its previous state.
+struct PersistentRingHeader {
+  uint32_t read;   // Offset of the oldest entry.
+  uint32_t write;  // Offset following the newest entry.
+  uint32_t entry_count;
+  uint32_t checksum;  // CRC16 of the fields above.
+};
+
+// Implements PersistentRingBuffer on top of its persistent storage. This
+// object should NOT be stored in persistent RAM.
+class PersistentRing {
+ public:
+  // Each entry is prefixed with its size, the size's complement, and the CRC16
+  // of its data.
+  static constexpr size_t kEntryPrefixBytes = 3 * sizeof(uint16_t);
+  static constexpr size_t kMaxEntrySizeBytes = UINT16_MAX;
+
+  PersistentRing(volatile PersistentRingHeader& header, ByteSpan buffer)
+      : header_(header), buffer_(buffer) {}
+
+  Status Recover();
+  Status PushBack(ConstByteSpan data);
+  Status PopFront();
+  StatusWithSize PeekFront(ByteSpan dest) const;
+  PersistentRingBufferReader GetReader() const;
+  size_t EntryCount() const;
+  size_t TotalUsedBytes() const;
+  void Clear();
+
+ private:
+  friend class persistent_ram::PersistentRingBufferReader;
+
+  struct Prefix {
+    uint16_t size;
+    uint16_t size_complement;
+    uint16_t checksum;
+  };
+
+  bool HeaderValid() const;
+  void CommitHeader(size_t read, size_t write, size_t entry_count);
+  size_t UsedBytes(size_t read, size_t write, size_t entry_count) const;
+  size_t Wrap(size_t offset) const { return offset % buffer_.size(); }
+
+  // Reads the prefix of the entry at offset. Returns the total size of the
+  // entry, or 0 if the prefix is corrupt or the entry would extend past
+  // available bytes.
+  size_t ReadPrefix(size_t offset, size_t available, Prefix& prefix) const;
+
+  // Copies the entry at offset into dest and checks its checksum. Sets
+  // entry_bytes to the total size of the entry, or 0 if it cannot be skipped.
+  StatusWithSize ReadEntry(size_t offset,
+                           size_t available,
+                           ByteSpan dest,
+                           size_t& entry_bytes) const;
+
+  void CopyOut(size_t offset, ByteSpan dest) const;
+  void CopyIn(size_t offset, ConstByteSpan data);
+
+  volatile PersistentRingHeader& header_;
+  ByteSpan buffer_;
+};
+
+}  // namespace internal
+
+// Reads the entries of a PersistentRingBuffer from oldest to newest without
+// removing them. This object should NOT be stored in persistent RAM, and is
+// invalidated by any change to the ring buffer.
+class PersistentRingBufferReader {
+ public:
+  PersistentRingBufferReader() = delete;
+
+  // Copies the next entry into dest and returns its size.
+  //
+  // Returns:
+  //   OK - The entry was read.
+  //   OUT_OF_RANGE - There are no more entries.
+  //   RESOURCE_EXHAUSTED - dest is too small for the entry. The size of the
+  //       entry is returned, and the entry is not consumed.
+  //   DATA_LOSS - The entry is corrupt. It is skipped if possible; otherwise
+  //       the following reads return OUT_OF_RANGE.
+  StatusWithSize ReadNext(ByteSpan dest);
+
+ private:
+  friend class internal::PersistentRing;
+
+  PersistentRingBufferReader(internal::PersistentRing ring,
+                             size_t offset,
+                             size_t remaining_bytes,
+                             size_t remaining_entries);
+
+  internal::PersistentRing ring_;
+  size_t offset_;
+  size_t remaining_bytes_;
+  size_t remaining_entries_;
+};
+
+// The PersistentRingBuffer class intentionally uses uninitialized memory, which
+// triggers compiler warnings. Disable those warnings for this file.
+PW_MODIFY_DIAGNOSTICS_PUSH();
+PW_MODIFY_DIAGNOSTIC(ignored, "-Wuninitialized");
+PW_MODIFY_DIAGNOSTIC_GCC(ignored, "-Wmaybe-uninitialized");
+
+// A ring buffer of variable-length entries that persists across soft resets,
+// such as a log that keeps the last few boots' messages. When an entry does not
+// fit, the oldest entries are dropped to make room, so an append costs
+// O(entry size).
+//
+// Each entry has its own checksum. Corrupting one entry, for example by a
+// brownout while it was written, loses that entry rather than the whole buffer.
+// Like PersistentBuffer, the constructor and destructor are no-ops and zeroed
+// memory holds no entries.
+//
+// Call Recover() once on boot, before static constructors or any other use.
+// It walks the entry prefixes, without checksumming the data, and drops any
+// entries it cannot follow. Entry data is checked as it is read.
+template <size_t kSizeBytes>
+class PersistentRingBuffer {
+ public:
+  static_assert(kSizeBytes > internal::PersistentRing::kEntryPrefixBytes);
+  static_assert(kSizeBytes <= UINT32_MAX);
+
+  // The default constructor intentionally does not initialize anything, see
+  // PersistentBuffer.
+  PersistentRingBuffer() {}
+  // Disable copy and move constructors.
+  PersistentRingBuffer(const PersistentRingBuffer&) = delete;
+  PersistentRingBuffer(PersistentRingBuffer&&) = delete;
+  // Explicit no-op destructor.
+  ~PersistentRingBuffer() {}
+
+  // Checks the buffer's state after a reset, dropping entries that cannot be
+  // followed.
+  //
+  // Returns:
+  //   OK - All entries were kept.
+  //   DATA_LOSS - Some or all of the entries were dropped.
+  Status Recover() { return ring().Recover(); }
+
+  // Appends an entry, dropping the oldest entries if necessary.
+  //
+  // Returns:
+  //   OK - The entry was added.
+  //   INVALID_ARGUMENT - data is empty.
+  //   OUT_OF_RANGE - data does not fit in the buffer, or is larger than
+  //       kMaxEntrySizeBytes.
+  Status PushBack(ConstByteSpan data) { return ring().PushBack(data); }
+
+  // Removes the oldest entry.
+  //
+  // Returns:
+  //   OK - The entry was removed.
+  //   OUT_OF_RANGE - There are no entries.
+  //   DATA_LOSS - The entry was corrupt, so all entries were removed.
+  Status PopFront() { return ring().PopFront(); }
+
+  // Copies the oldest entry into dest. Returns the same statuses as
+  // PersistentRingBufferReader::ReadNext().
+  StatusWithSize PeekFront(ByteSpan dest) const {
+    return ring().PeekFront(dest);
+  }
+
+  // Returns a reader for the entries, oldest first.
+  PersistentRingBufferReader GetReader() const { return ring().GetReader(); }
+
+  size_t EntryCount() const { return ring().EntryCount(); }
+
+  // The bytes used by the entries, including their prefixes.
+  size_t TotalUsedBytes() const { return ring().TotalUsedBytes(); }
+
+  void Clear() { ring().Clear(); }
+
+  // Each entry takes kEntryPrefixBytes in addition to its data.
+  static constexpr size_t kEntryPrefixBytes =
+      internal::PersistentRing::kEntryPrefixBytes;
+
+  static constexpr size_t kMaxEntrySizeBytes =
+      kSizeBytes - kEntryPrefixBytes <
+              internal::PersistentRing::kMaxEntrySizeBytes
+          ? kSizeBytes - kEntryPrefixBytes
+          : internal::PersistentRing::kMaxEntrySizeBytes;
+
+ private:
+  internal::PersistentRing ring() const {
+    return internal::PersistentRing(
+        const_cast<volatile internal::PersistentRingHeader&>(header_),
+        ByteSpan(const_cast<std::byte*>(buffer_), kSizeBytes));
+  }
+
+  // None of these members are initialized by the constructor by design.
+  volatile internal::PersistentRingHeader header_;
+  volatile std::byte buffer_[kSizeBytes];
+};
+
+PW_MODIFY_DIAGNOSTICS_POP();
+
+}  // namespace pw::persistent_ram
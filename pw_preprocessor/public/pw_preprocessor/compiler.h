@@ -79,6 +79,53 @@
 // Prevents the compiler from inlining a fuction.
 #define PW_NO_INLINE __attribute__((noinline))
 
+// Indicate to the compiler that the annotated function is rarely called, such
+// as an error handler. The function is optimized for size and placed apart from
+// other code, and branches that lead to calls to it are treated as unlikely.
+#define PW_COLD __attribute__((cold))
+
+// Places a function in fast RAM, such as instruction TCM, if the target's
+// linker script supports it. This is intended for hot code that stalls on
+// flash wait states, such as interrupt handlers and checksum or decoding loops.
+// The function is not inlined, so that all of its code runs from fast RAM.
+//
+//   PW_PLACE_IN_FAST_RAM void DMA1_Stream0_IRQHandler(void) { ... }
+//
+// Linker scripts that support fast RAM, such as pw_boot_armv7m's, collect
+// functions from the .pw_fast_ram.text sections, store them in flash, and copy
+// them to RAM at boot. Other linker scripts link the functions with the rest of
+// the code.
+#ifdef __APPLE__
+#define PW_PLACE_IN_FAST_RAM PW_NO_INLINE
+#else
+#define PW_PLACE_IN_FAST_RAM \
+  __attribute__((section(".pw_fast_ram.text"), noinline))
+#endif  // __APPLE__
+
+// Places a variable in fast data RAM, such as data TCM, if the target's linker
+// script supports it. The variable is initialized from flash at boot, like
+// other initialized static data.
+#ifdef __APPLE__
+#define PW_PLACE_IN_FAST_DATA
+#else
+#define PW_PLACE_IN_FAST_DATA __attribute__((section(".pw_fast_ram.data")))
+#endif  // __APPLE__
+
+// Places a variable in RAM that is not zeroed or initialized at boot, if the
+// target's linker script supports it. This avoids the boot time cost of
+// clearing large buffers, such as log or trace buffers, that are always written
+// before they are read. The variable's contents are undefined until written.
+// C++ constructors still run, so this is intended for plain buffers.
+//
+//   PW_PLACE_IN_NO_INIT_RAM std::byte trace_buffer[32768];
+//
+// Other linker scripts zero-initialize the variable as usual.
+#ifdef __APPLE__
+#define PW_PLACE_IN_NO_INIT_RAM
+#else
+#define PW_PLACE_IN_NO_INIT_RAM __attribute__((section(".pw_no_init_ram")))
+#endif  // __APPLE__
+
 // Indicate to the compiler that the given section of code will not be reached.
 // Example:
 //
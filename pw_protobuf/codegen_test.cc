@@ -11,10 +11,13 @@
 // WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
 // License for the specific language governing permissions and limitations under
 // the License.
+#include <limits>
 #include <span>
+#include <string_view>
 
 #include "gtest/gtest.h"
 #include "pw_protobuf/encoder.h"
+#include "pw_protobuf/serialized_size.h"
 #include "pw_stream/memory_stream.h"
 
 // These header files contain the code generated by the pw_protobuf plugin.
@@ -353,6 +356,209 @@ TEST(Codegen, Import) {
   EXPECT_EQ(encoder.Encode().status(), OkStatus());
 }
 
+TEST(Codegen, NestedWithKnownSize) {
+  constexpr uint32_t kSeconds = 1589501841;
+  constexpr uint32_t kNanoseconds = 490367432;
+  constexpr size_t kTimestampSize =
+      SizeOfVarintField(
+          static_cast<uint32_t>(imported::Timestamp::Fields::SECONDS),
+          kSeconds) +
+      SizeOfVarintField(
+          static_cast<uint32_t>(imported::Timestamp::Fields::NANOSECONDS),
+          kNanoseconds);
+
+  std::byte encode_buffer[64];
+  stream::MemoryWriter writer(encode_buffer);
+
+  // No scratch buffer is needed, since the submessage size is known.
+  Period::StreamEncoder period(writer, ByteSpan());
+  {
+    imported::Timestamp::StreamEncoder end =
+        period.GetEndEncoder(kTimestampSize);
+    end.WriteSeconds(kSeconds);
+    end.WriteNanoseconds(kNanoseconds);
+  }
+  ASSERT_EQ(period.status(), OkStatus());
+
+  Period::Message message;
+  ASSERT_EQ(Period::Decode(writer.WrittenData(), message), OkStatus());
+  EXPECT_EQ(message.end.seconds, kSeconds);
+  EXPECT_EQ(message.end.nanoseconds, kNanoseconds);
+}
+
+TEST(CodegenTableDecoder, Message) {
+  std::byte encode_buffer[128];
+  std::byte temp_buffer[128];
+  stream::MemoryWriter writer(encode_buffer);
+
+  Pigweed::StreamEncoder pigweed(writer, temp_buffer);
+  pigweed.WriteMagicNumber(73);
+  pigweed.WriteZiggy(-111);
+  pigweed.WriteCycles(0x1234567890abcdef);
+  pigweed.WriteRatio(0.5f);
+  pigweed.WriteErrorMessage("not a typewriter");
+  pigweed.WriteBin(Pigweed::Protobuf::Binary::ZERO);
+
+  {
+    Proto::StreamEncoder proto = pigweed.GetProtoEncoder();
+    proto.WriteBin(Proto::Binary::ON);
+
+    {
+      Pigweed::Protobuf::Compiler::StreamEncoder meta = proto.GetMetaEncoder();
+      meta.WriteFileName("/etc/passwd");
+      meta.WriteStatus(Pigweed::Protobuf::Compiler::Status::FUBAR);
+    }
+  }
+
+  {
+    DeviceInfo::StreamEncoder device_info = pigweed.GetDeviceInfoEncoder();
+    device_info.WriteDeviceId(0xcafe);
+
+    // Repeated fields are not in the struct, so this is skipped.
+    KeyValuePair::StreamEncoder attributes =
+        device_info.GetAttributesEncoder();
+    attributes.WriteKey("version");
+  }
+  ASSERT_EQ(pigweed.status(), OkStatus());
+
+  Pigweed::Message message;
+  ASSERT_EQ(Pigweed::Decode(writer.WrittenData(), message), OkStatus());
+
+  EXPECT_EQ(message.magic_number, 73u);
+  EXPECT_EQ(message.ziggy, -111);
+  EXPECT_EQ(message.cycles, 0x1234567890abcdefu);
+  EXPECT_EQ(message.ratio, 0.5f);
+  EXPECT_EQ(message.error_message, "not a typewriter");
+  EXPECT_EQ(message.bin, Pigweed::Protobuf::Binary::ZERO);
+  EXPECT_EQ(message.proto.bin, Proto::Binary::ON);
+  EXPECT_EQ(message.proto.meta.file_name, "/etc/passwd");
+  EXPECT_EQ(message.proto.meta.status,
+            Pigweed::Protobuf::Compiler::Status::FUBAR);
+  EXPECT_EQ(message.device_info.device_id, 0xcafeu);
+  EXPECT_EQ(message.device_info.device_name, "");
+  EXPECT_EQ(message.pigweed.status, Bool::TRUE);
+}
+
+TEST(CodegenTableDecoder, Proto2) {
+  constexpr uint8_t proto[] = {0x08, 0x03, 0x12, 0x03, 'a', 'b', 'c'};
+
+  Foo::Message foo;
+  ASSERT_EQ(Foo::Decode(std::as_bytes(std::span(proto)), foo), OkStatus());
+
+  // C++ keywords get a trailing underscore.
+  EXPECT_EQ(foo.int_, 3u);
+  EXPECT_EQ(foo.str, "abc");
+}
+
+TEST(CodegenTableDecoder, Import) {
+  std::byte encode_buffer[64];
+  NestedEncoder<1, 3> encoder(encode_buffer);
+
+  Period::Encoder period(&encoder);
+  {
+    imported::Timestamp::Encoder end = period.GetEndEncoder();
+    end.WriteSeconds(1589501841);
+    end.WriteNanoseconds(490367432);
+  }
+
+  Result result = encoder.Encode();
+  ASSERT_EQ(result.status(), OkStatus());
+
+  Period::Message message;
+  ASSERT_EQ(Period::Decode(result.value(), message), OkStatus());
+  EXPECT_EQ(message.start.seconds, 0u);
+  EXPECT_EQ(message.end.seconds, 1589501841u);
+  EXPECT_EQ(message.end.nanoseconds, 490367432u);
+}
+
+// Messages without repeated, string, or bytes fields have a maximum size.
+static_assert(Proto::ID::kMaxEncodedSizeBytes == 1 + kMaxSizeBytesUint32);
+static_assert(Pigweed::Pigweed::kMaxEncodedSizeBytes == 1 + kMaxSizeBytesInt32);
+static_assert(imported::Timestamp::kMaxEncodedSizeBytes ==
+              SizeOfFieldKey(1) + kMaxSizeBytesUint64 + SizeOfFieldKey(2) +
+                  kMaxSizeBytesUint32);
+static_assert(Period::kMaxEncodedSizeBytes ==
+              2 * SizeOfDelimitedField(
+                      1, imported::Timestamp::kMaxEncodedSizeBytes));
+static_assert(Nothing::kMaxEncodedSizeBytes == SizeOfDelimitedField(1, 0));
+
+TEST(CodegenEncodedSize, MaxValues_MatchesMaxEncodedSize) {
+  std::byte encode_buffer[Period::kMaxEncodedSizeBytes];
+  stream::MemoryWriter writer(encode_buffer);
+
+  Period::StreamEncoder period(writer, ByteSpan());
+  constexpr size_t kTimestampSize = imported::Timestamp::kMaxEncodedSizeBytes;
+  {
+    imported::Timestamp::StreamEncoder start =
+        period.GetStartEncoder(kTimestampSize);
+    start.WriteSeconds(std::numeric_limits<uint64_t>::max());
+    start.WriteNanoseconds(std::numeric_limits<uint32_t>::max());
+  }
+  {
+    imported::Timestamp::StreamEncoder end =
+        period.GetEndEncoder(kTimestampSize);
+    end.WriteSeconds(std::numeric_limits<uint64_t>::max());
+    end.WriteNanoseconds(std::numeric_limits<uint32_t>::max());
+  }
+  ASSERT_EQ(period.status(), OkStatus());
+  EXPECT_EQ(writer.bytes_written(), Period::kMaxEncodedSizeBytes);
+
+  Period::Message message;
+  ASSERT_EQ(Period::Decode(writer.WrittenData(), message), OkStatus());
+  EXPECT_EQ(Period::EncodedSize(message), Period::kMaxEncodedSizeBytes);
+}
+
+TEST(CodegenEncodedSize, Message) {
+  Pigweed::Message message;
+  message.magic_number = 300;
+  constexpr std::string_view kErrorMessage = "not a typewriter";
+  constexpr std::string_view kFileName = "/etc/passwd";
+  message.error_message = kErrorMessage;
+  message.proto.meta.file_name = kFileName;
+
+  std::byte encode_buffer[128];
+  stream::MemoryWriter writer(encode_buffer);
+
+  // Write every member of the struct, as EncodedSize() counts them all.
+  Pigweed::StreamEncoder pigweed(writer, ByteSpan());
+  pigweed.WriteMagicNumber(message.magic_number);
+  pigweed.WriteZiggy(message.ziggy);
+  pigweed.WriteCycles(message.cycles);
+  pigweed.WriteRatio(message.ratio);
+  pigweed.WriteErrorMessage(kErrorMessage.data(), kErrorMessage.size());
+  {
+    DeviceInfo::StreamEncoder device_info = pigweed.GetDeviceInfoEncoder(
+        DeviceInfo::EncodedSize(message.device_info));
+    device_info.WriteDeviceName("", 0);
+    device_info.WriteDeviceId(message.device_info.device_id);
+    device_info.WriteStatus(message.device_info.status);
+  }
+  {
+    Pigweed::Pigweed::StreamEncoder nested = pigweed.GetPigweedEncoder(
+        Pigweed::Pigweed::EncodedSize(message.pigweed));
+    nested.WriteStatus(message.pigweed.status);
+  }
+  pigweed.WriteBin(message.bin);
+  {
+    Proto::StreamEncoder proto =
+        pigweed.GetProtoEncoder(Proto::EncodedSize(message.proto));
+    proto.WriteBin(message.proto.bin);
+    proto.WritePigweedPigweedBin(message.proto.pigweed_pigweed_bin);
+    proto.WritePigweedProtobufBin(message.proto.pigweed_protobuf_bin);
+    {
+      Pigweed::Protobuf::Compiler::StreamEncoder meta = proto.GetMetaEncoder(
+          Pigweed::Protobuf::Compiler::EncodedSize(message.proto.meta));
+      meta.WriteFileName(kFileName.data(), kFileName.size());
+      meta.WriteStatus(message.proto.meta.status);
+      meta.WriteProtobufBin(message.proto.meta.protobuf_bin);
+      meta.WritePigweedBin(message.proto.meta.pigweed_bin);
+    }
+  }
+  ASSERT_EQ(pigweed.status(), OkStatus());
+
+  EXPECT_EQ(Pigweed::EncodedSize(message), writer.bytes_written());
+}
+
 TEST(Codegen, NonPigweedPackage) {
   using namespace non::pigweed::package::name;
   std::byte encode_buffer[64];
@@ -14,11 +14,64 @@
 
 #include "pw_protobuf/decoder.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cstring>
+#include <type_traits>
 
 #include "pw_varint/varint.h"
 
 namespace pw::protobuf {
+namespace {
+
+// Packed varints that are narrower than 64 bits are decoded through a stack
+// buffer of this many values.
+constexpr size_t kPackedVarintChunkSize = 16;
+
+// Decodes a packed varint field's data into `out`. DecodeMany produces values
+// of type Decoded (uint64_t, or int64_t for ZigZag encoding); these are
+// decoded directly into `out` if T is the same type, or through a stack buffer
+// and narrowed otherwise.
+template <typename Decoded, typename T>
+StatusWithSize DecodePackedVarints(std::span<const std::byte> data,
+                                   std::span<T> out) {
+  size_t count = 0;
+
+  while (!data.empty()) {
+    if (count == out.size()) {
+      return StatusWithSize::ResourceExhausted(count);
+    }
+
+    size_t bytes_read;
+    size_t decoded;
+
+    if constexpr (std::is_same_v<T, Decoded>) {
+      decoded = varint::DecodeMany(data, out.subspan(count), &bytes_read);
+    } else {
+      std::array<Decoded, kPackedVarintChunkSize> chunk;
+      decoded = varint::DecodeMany(
+          data,
+          std::span(chunk).first(std::min(chunk.size(), out.size() - count)),
+          &bytes_read);
+      std::transform(chunk.begin(),
+                     chunk.begin() + decoded,
+                     out.begin() + count,
+                     [](Decoded value) { return static_cast<T>(value); });
+    }
+
+    if (decoded == 0u) {
+      return StatusWithSize::DataLoss(count);
+    }
+
+    count += decoded;
+    data = data.subspan(bytes_read);
+  }
+
+  return StatusWithSize(count);
+}
+
+}  // namespace
 
 Status Decoder::Next() {
   if (!previous_field_consumed_) {
@@ -30,7 +83,8 @@ Status Decoder::Next() {
     return Status::OutOfRange();
   }
   previous_field_consumed_ = false;
-  return FieldSize() == 0 ? Status::DataLoss() : OkStatus();
+  field_size_ = FieldSize();
+  return field_size_ == 0 ? Status::DataLoss() : OkStatus();
 }
 
 Status Decoder::SkipField() {
@@ -38,12 +92,13 @@ Status Decoder::SkipField() {
     return Status::OutOfRange();
   }
 
-  size_t bytes_to_skip = FieldSize();
-  if (bytes_to_skip == 0) {
+  // The field's size was found when Next() validated it, so the field is
+  // skipped without decoding it again.
+  if (field_size_ == 0) {
     return Status::DataLoss();
   }
 
-  proto_ = proto_.subspan(bytes_to_skip);
+  proto_ = proto_.subspan(field_size_);
   return proto_.empty() ? Status::OutOfRange() : OkStatus();
 }
 
@@ -231,6 +286,70 @@ Status Decoder::ReadDelimited(std::span<const std::byte>* out) {
   return OkStatus();
 }
 
+StatusWithSize Decoder::ReadPackedVarints(std::span<uint32_t> out) {
+  std::span<const std::byte> data;
+  if (Status status = ReadDelimited(&data); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  return DecodePackedVarints<uint64_t>(data, out);
+}
+
+StatusWithSize Decoder::ReadPackedVarints(std::span<uint64_t> out) {
+  std::span<const std::byte> data;
+  if (Status status = ReadDelimited(&data); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  return DecodePackedVarints<uint64_t>(data, out);
+}
+
+StatusWithSize Decoder::ReadPackedZigZag(std::span<int32_t> out) {
+  std::span<const std::byte> data;
+  if (Status status = ReadDelimited(&data); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  return DecodePackedVarints<int64_t>(data, out);
+}
+
+StatusWithSize Decoder::ReadPackedZigZag(std::span<int64_t> out) {
+  std::span<const std::byte> data;
+  if (Status status = ReadDelimited(&data); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  return DecodePackedVarints<int64_t>(data, out);
+}
+
+StatusWithSize Decoder::ReadPackedFixed(std::span<std::byte> out,
+                                        size_t elem_size) {
+  std::span<const std::byte> data;
+  if (Status status = ReadDelimited(&data); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+
+  if (data.size() % elem_size != 0u) {
+    return StatusWithSize::DataLoss();
+  }
+
+  const size_t size = std::min(data.size(), out.size());
+
+  // On little-endian targets, the values are copied directly; otherwise, each
+  // value's bytes are reversed.
+  if (std::endian::native == std::endian::little) {
+    std::memcpy(out.data(), data.data(), size);
+  } else {
+    for (size_t i = 0; i < size; i += elem_size) {
+      std::reverse_copy(data.begin() + i,
+                        data.begin() + i + elem_size,
+                        out.begin() + i);
+    }
+  }
+
+  const size_t count = size / elem_size;
+  if (size < data.size()) {
+    return StatusWithSize::ResourceExhausted(count);
+  }
+  return StatusWithSize(count);
+}
+
 Status CallbackDecoder::Decode(std::span<const std::byte> proto) {
   if (handler_ == nullptr || state_ != kReady) {
     return Status::FailedPrecondition();
@@ -14,6 +14,8 @@
 
 #include "pw_protobuf/decoder.h"
 
+#include <array>
+
 #include "gtest/gtest.h"
 #include "pw_preprocessor/util.h"
 
@@ -156,6 +158,279 @@ TEST(Decoder, Decode_SkipsUnusedFields) {
   EXPECT_EQ(decoder.Next(), Status::OutOfRange());
 }
 
+TEST(Decoder, ReadMessage) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=uint32, k=1, v=7
+    0x08, 0x07,
+    // type=message, k=2, len=10
+    0x12, 0x0a,
+      // (nested) type=uint32, k=1, v=3
+      0x08, 0x03,
+      // (nested) type=message, k=2, len=2
+      0x12, 0x02,
+        // (nested) type=bool, k=1, v=true
+        0x08, 0x01,
+      // (nested) type=string, k=3, v="ab"
+      0x1a, 0x02, 'a', 'b',
+    // type=uint32, k=3, v=9
+    0x18, 0x09,
+  };
+  // clang-format on
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 1u);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 2u);
+  Decoder nested({});
+  ASSERT_EQ(decoder.ReadMessage(&nested), OkStatus());
+
+  uint32_t nested_uint32 = 0;
+  EXPECT_EQ(nested.Next(), OkStatus());
+  ASSERT_EQ(nested.FieldNumber(), 1u);
+  EXPECT_EQ(nested.ReadUint32(&nested_uint32), OkStatus());
+  EXPECT_EQ(nested_uint32, 3u);
+
+  // Skip the nested submessage without reading it.
+  std::string_view nested_string;
+  EXPECT_EQ(nested.Next(), OkStatus());
+  ASSERT_EQ(nested.FieldNumber(), 2u);
+  EXPECT_EQ(nested.Next(), OkStatus());
+  ASSERT_EQ(nested.FieldNumber(), 3u);
+  EXPECT_EQ(nested.ReadString(&nested_string), OkStatus());
+  EXPECT_EQ(nested_string, "ab");
+  EXPECT_EQ(nested.Next(), Status::OutOfRange());
+
+  uint32_t v3 = 0;
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 3u);
+  EXPECT_EQ(decoder.ReadUint32(&v3), OkStatus());
+  EXPECT_EQ(v3, 9u);
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(Decoder, ReadMessage_WrongWireType) {
+  constexpr uint8_t encoded_proto[] = {0x08, 0x07};
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+  Decoder nested({});
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadMessage(&nested), Status::FailedPrecondition());
+  EXPECT_EQ(nested.Next(), Status::OutOfRange());
+}
+
+TEST(Decoder, Next_SkipsLargeSubmessage) {
+  // A 200-byte submessage, whose contents are not valid protobuf data, followed
+  // by another field.
+  std::array<uint8_t, 3 + 200 + 2> encoded_proto;
+  encoded_proto.fill(0xff);
+  encoded_proto[0] = 0x0a;
+  encoded_proto[1] = 0xc8;
+  encoded_proto[2] = 0x01;
+  encoded_proto[203] = 0x10;
+  encoded_proto[204] = 0x05;
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t value = 0;
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 1u);
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 2u);
+  EXPECT_EQ(decoder.ReadUint32(&value), OkStatus());
+  EXPECT_EQ(value, 5u);
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(Decoder, ReadPackedVarints) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=repeated uint32, k=1, v={0, 50, 100, 150, 200}
+    0x0a, 0x07, 0x00, 0x32, 0x64, 0x96, 0x01, 0xc8, 0x01,
+    // type=repeated int32, k=2, v={-1, 1}
+    0x12, 0x0b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+    0x01,
+    // type=repeated sint32, k=3, v={-100, -1, 0, 1, 100}
+    0x1a, 0x07, 0xc7, 0x01, 0x01, 0x00, 0x02, 0xc8, 0x01,
+    // type=repeated uint64, k=4, v={1, 0xffffffffffffffff}
+    0x22, 0x0b, 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0x01,
+    // type=repeated sint64, k=5, v={-1000000000000}
+    0x2a, 0x06, 0xff, 0xbf, 0xa8, 0xca, 0x9a, 0x3a,
+  };
+  // clang-format on
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t uint32s[8] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedUint32(uint32s);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 5u);
+  EXPECT_EQ(uint32s[0], 0u);
+  EXPECT_EQ(uint32s[1], 50u);
+  EXPECT_EQ(uint32s[2], 100u);
+  EXPECT_EQ(uint32s[3], 150u);
+  EXPECT_EQ(uint32s[4], 200u);
+
+  int32_t int32s[2] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  result = decoder.ReadPackedInt32(int32s);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(int32s[0], -1);
+  EXPECT_EQ(int32s[1], 1);
+
+  int32_t sint32s[5] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  result = decoder.ReadPackedSint32(sint32s);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 5u);
+  EXPECT_EQ(sint32s[0], -100);
+  EXPECT_EQ(sint32s[1], -1);
+  EXPECT_EQ(sint32s[2], 0);
+  EXPECT_EQ(sint32s[3], 1);
+  EXPECT_EQ(sint32s[4], 100);
+
+  uint64_t uint64s[2] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  result = decoder.ReadPackedUint64(uint64s);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(uint64s[0], 1u);
+  EXPECT_EQ(uint64s[1], 0xffffffffffffffffu);
+
+  int64_t sint64s[1] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  result = decoder.ReadPackedSint64(sint64s);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(sint64s[0], -1000000000000);
+
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(Decoder, ReadPackedVarints_ManyValues) {
+  // More values than are decoded in one chunk.
+  std::array<uint8_t, 2 + 100> encoded_proto;
+  encoded_proto[0] = 0x0a;
+  encoded_proto[1] = 100;
+  for (size_t i = 0; i < 100; ++i) {
+    encoded_proto[2 + i] = static_cast<uint8_t>(i);
+  }
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t values[100] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedUint32(values);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 100u);
+  for (size_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+}
+
+TEST(Decoder, ReadPackedVarints_BufferTooSmall) {
+  constexpr uint8_t encoded_proto[] = {
+      0x0a, 0x07, 0x00, 0x32, 0x64, 0x96, 0x01, 0xc8, 0x01, 0x10, 0x05};
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t values[3] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedUint32(values);
+  EXPECT_EQ(result.status(), Status::ResourceExhausted());
+  ASSERT_EQ(result.size(), 3u);
+  EXPECT_EQ(values[0], 0u);
+  EXPECT_EQ(values[1], 50u);
+  EXPECT_EQ(values[2], 100u);
+
+  // The rest of the packed field is skipped.
+  uint32_t next = 0;
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 2u);
+  EXPECT_EQ(decoder.ReadUint32(&next), OkStatus());
+  EXPECT_EQ(next, 5u);
+}
+
+TEST(Decoder, ReadPackedVarints_Truncated) {
+  // The last varint in the packed field is incomplete.
+  constexpr uint8_t encoded_proto[] = {0x0a, 0x03, 0x01, 0x02, 0x80};
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t values[4] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedUint32(values);
+  EXPECT_EQ(result.status(), Status::DataLoss());
+  EXPECT_EQ(result.size(), 2u);
+}
+
+TEST(Decoder, ReadPackedFixed) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=repeated fixed32, k=1, v={0xdeadbeef, 1}
+    0x0a, 0x08, 0xef, 0xbe, 0xad, 0xde, 0x01, 0x00, 0x00, 0x00,
+    // type=repeated double, k=2, v={-2.25}
+    0x12, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xc0,
+    // type=repeated float, k=3, v={1.5, 0}
+    0x1a, 0x08, 0x00, 0x00, 0xc0, 0x3f, 0x00, 0x00, 0x00, 0x00,
+  };
+  // clang-format on
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t fixed32s[4] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedFixed32(fixed32s);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 2u);
+  EXPECT_EQ(fixed32s[0], 0xdeadbeef);
+  EXPECT_EQ(fixed32s[1], 1u);
+
+  double doubles[1] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  result = decoder.ReadPackedDouble(doubles);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(doubles[0], -2.25);
+
+  float floats[1] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  result = decoder.ReadPackedFloat(floats);
+  EXPECT_EQ(result.status(), Status::ResourceExhausted());
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(floats[0], 1.5f);
+
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(Decoder, ReadPackedFixed_InvalidSize) {
+  constexpr uint8_t encoded_proto[] = {0x0a, 0x03, 0x01, 0x02, 0x03};
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t values[4] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadPackedFixed32(values).status(), Status::DataLoss());
+}
+
+TEST(Decoder, ReadPacked_WrongWireType) {
+  constexpr uint8_t encoded_proto[] = {0x08, 0x01};
+
+  Decoder decoder(std::as_bytes(std::span(encoded_proto)));
+
+  uint32_t values[4] = {};
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadPackedUint32(values).status(),
+            Status::FailedPrecondition());
+}
+
 TEST(CallbackDecoder, Decode) {
   CallbackDecoder decoder;
   TestDecodeHandler handler;
@@ -14,7 +14,136 @@
 
 #include "pw_protobuf/find.h"
 
+#include "pw_assert/check.h"
+#include "pw_status/try.h"
+#include "pw_varint/varint.h"
+
 namespace pw::protobuf {
+namespace {
+
+struct FieldSearch {
+  std::span<const FieldPath> paths;
+  std::span<FoundField> fields;
+  size_t remaining;
+};
+
+// Searches a message for the paths in `candidates`, a bitmask of indices into
+// search.paths. The first `depth` field numbers of each candidate path lead to
+// this message.
+Status FindInMessage(std::span<const std::byte> message,
+                     size_t depth,
+                     uint32_t candidates,
+                     FieldSearch& search) {
+  while (!message.empty() && candidates != 0u) {
+    uint64_t key;
+    size_t bytes = varint::Decode(message, &key);
+    if (bytes == 0 || (key >> kFieldNumberShift) > kMaxFieldNumber) {
+      return Status::DataLoss();
+    }
+    message = message.subspan(bytes);
+
+    const uint32_t field_number = key >> kFieldNumberShift;
+    const WireType wire_type = static_cast<WireType>(key & kWireTypeMask);
+
+    uint64_t value = 0;
+    std::span<const std::byte> data;
+
+    switch (wire_type) {
+      case WireType::kVarint:
+        bytes = varint::Decode(message, &value);
+        if (bytes == 0) {
+          return Status::DataLoss();
+        }
+        break;
+
+      case WireType::kDelimited:
+        bytes = varint::Decode(message, &value);
+        if (bytes == 0 || message.size() - bytes < value) {
+          return Status::DataLoss();
+        }
+        data = message.subspan(bytes, value);
+        bytes += value;
+        value = 0;
+        break;
+
+      case WireType::kFixed32:
+      case WireType::kFixed64:
+        bytes = wire_type == WireType::kFixed32 ? sizeof(uint32_t)
+                                                : sizeof(uint64_t);
+        if (message.size() < bytes) {
+          return Status::DataLoss();
+        }
+        data = message.first(bytes);
+        break;
+
+      default:
+        return Status::DataLoss();
+    }
+    message = message.subspan(bytes);
+
+    // Paths that continue into this field, if it is a submessage.
+    uint32_t nested = 0;
+
+    for (size_t i = 0; i < search.paths.size(); ++i) {
+      const uint32_t bit = uint32_t(1) << i;
+      if ((candidates & bit) == 0u ||
+          search.paths[i][depth] != field_number) {
+        continue;
+      }
+
+      if (search.paths[i].size() == depth + 1) {
+        search.fields[i] = {true, wire_type, value, data};
+        candidates &= ~bit;
+        if (--search.remaining == 0u) {
+          return OkStatus();
+        }
+      } else if (wire_type == WireType::kDelimited) {
+        nested |= bit;
+      }
+    }
+
+    if (nested == 0u) {
+      continue;
+    }
+
+    PW_TRY(FindInMessage(data, depth + 1, nested, search));
+
+    // Stop searching for the paths that were found in the submessage.
+    for (size_t i = 0; i < search.paths.size(); ++i) {
+      if ((nested & (uint32_t(1) << i)) != 0u && search.fields[i].found) {
+        candidates &= ~(uint32_t(1) << i);
+      }
+    }
+  }
+
+  return OkStatus();
+}
+
+}  // namespace
+
+Status FindFields(std::span<const std::byte> message,
+                  std::span<const FieldPath> paths,
+                  std::span<FoundField> fields) {
+  PW_CHECK_UINT_EQ(paths.size(), fields.size());
+  PW_CHECK_UINT_LE(paths.size(), kMaxFindFields);
+
+  for (size_t i = 0; i < paths.size(); ++i) {
+    PW_CHECK(!paths[i].empty());
+    fields[i] = FoundField();
+  }
+
+  if (paths.empty()) {
+    return OkStatus();
+  }
+
+  FieldSearch search = {paths, fields, paths.size()};
+  const uint32_t all_paths = paths.size() == kMaxFindFields
+                                 ? ~uint32_t(0)
+                                 : (uint32_t(1) << paths.size()) - 1;
+
+  PW_TRY(FindInMessage(message, 0, all_paths, search));
+  return search.remaining == 0u ? OkStatus() : Status::NotFound();
+}
 
 Status FindDecodeHandler::ProcessField(CallbackDecoder& decoder,
                                        uint32_t field_number) {
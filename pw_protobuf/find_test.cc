@@ -14,6 +14,10 @@
 
 #include "pw_protobuf/find.h"
 
+#include <array>
+#include <cstring>
+#include <string_view>
+
 #include "gtest/gtest.h"
 
 namespace pw::protobuf {
@@ -88,5 +92,118 @@ TEST(FindDecodeHandler, MultiLevel_DoesntFindNonExistingNestedField) {
   EXPECT_FALSE(decoder.cancelled());
 }
 
+constexpr uint32_t kInt32Path[] = {1};
+constexpr uint32_t kDoublePath[] = {4};
+constexpr uint32_t kFixed32Path[] = {5};
+constexpr uint32_t kStringPath[] = {6};
+constexpr uint32_t kNestedUint32Path[] = {7, 1};
+constexpr uint32_t kMissingPath[] = {8};
+constexpr uint32_t kMissingNestedPath[] = {7, 2};
+
+std::span<const std::byte> EncodedProto() {
+  return std::as_bytes(std::span(encoded_proto));
+}
+
+TEST(FindFields, FindsAllFields) {
+  constexpr FieldPath kPaths[] = {
+      kNestedUint32Path, kStringPath, kInt32Path, kDoublePath, kFixed32Path};
+  std::array<FoundField, 5> fields;
+
+  ASSERT_EQ(FindFields(EncodedProto(), kPaths, fields), OkStatus());
+
+  ASSERT_TRUE(fields[0].found);
+  EXPECT_EQ(fields[0].wire_type, WireType::kVarint);
+  EXPECT_EQ(fields[0].value, 3u);
+
+  ASSERT_TRUE(fields[1].found);
+  EXPECT_EQ(fields[1].wire_type, WireType::kDelimited);
+  EXPECT_EQ(
+      std::string_view(reinterpret_cast<const char*>(fields[1].data.data()),
+                       fields[1].data.size()),
+      "Hello world");
+
+  ASSERT_TRUE(fields[2].found);
+  EXPECT_EQ(fields[2].value, 42u);
+
+  ASSERT_TRUE(fields[3].found);
+  EXPECT_EQ(fields[3].wire_type, WireType::kFixed64);
+  double value;
+  ASSERT_EQ(fields[3].data.size(), sizeof(value));
+  std::memcpy(&value, fields[3].data.data(), sizeof(value));
+  EXPECT_EQ(value, 3.14159);
+
+  ASSERT_TRUE(fields[4].found);
+  EXPECT_EQ(fields[4].wire_type, WireType::kFixed32);
+  EXPECT_EQ(fields[4].data.size(), sizeof(uint32_t));
+}
+
+TEST(FindFields, MissingFields_NotFound) {
+  constexpr FieldPath kPaths[] = {
+      kMissingPath, kInt32Path, kMissingNestedPath, kNestedUint32Path};
+  std::array<FoundField, 4> fields;
+
+  EXPECT_EQ(FindFields(EncodedProto(), kPaths, fields), Status::NotFound());
+
+  EXPECT_FALSE(fields[0].found);
+  EXPECT_TRUE(fields[1].found);
+  EXPECT_FALSE(fields[2].found);
+  ASSERT_TRUE(fields[3].found);
+  EXPECT_EQ(fields[3].value, 3u);
+}
+
+TEST(FindFields, FirstOccurrenceWins) {
+  constexpr uint8_t proto[] = {0x08, 0x01, 0x08, 0x02};
+  constexpr FieldPath kPaths[] = {kInt32Path};
+  std::array<FoundField, 1> fields;
+
+  ASSERT_EQ(FindFields(std::as_bytes(std::span(proto)), kPaths, fields),
+            OkStatus());
+  EXPECT_EQ(fields[0].value, 1u);
+}
+
+TEST(FindFields, StopsOnceAllFieldsAreFound) {
+  // The data after field 1 is invalid, but is never decoded.
+  constexpr uint8_t proto[] = {0x08, 0x01, 0xff, 0xff};
+  constexpr FieldPath kPaths[] = {kInt32Path};
+  std::array<FoundField, 1> fields;
+
+  EXPECT_EQ(FindFields(std::as_bytes(std::span(proto)), kPaths, fields),
+            OkStatus());
+}
+
+TEST(FindFields, DoesNotDecodeUnsearchedSubmessages) {
+  // Field 2 is not a valid message, but no paths lead into it.
+  constexpr uint8_t proto[] = {0x12, 0x02, 0xff, 0xff, 0x3a, 0x02, 0x08, 0x03};
+  constexpr FieldPath kPaths[] = {kNestedUint32Path};
+  std::array<FoundField, 1> fields;
+
+  ASSERT_EQ(FindFields(std::as_bytes(std::span(proto)), kPaths, fields),
+            OkStatus());
+  EXPECT_EQ(fields[0].value, 3u);
+}
+
+TEST(FindFields, RepeatedSubmessages_SearchesEach) {
+  // Two occurrences of submessage 7, with fields 1 and 2 in different ones.
+  constexpr uint8_t proto[] = {0x3a, 0x02, 0x08, 0x03, 0x3a, 0x02, 0x10, 0x04};
+  constexpr FieldPath kPaths[] = {kNestedUint32Path, kMissingNestedPath};
+  std::array<FoundField, 2> fields;
+
+  ASSERT_EQ(FindFields(std::as_bytes(std::span(proto)), kPaths, fields),
+            OkStatus());
+  EXPECT_EQ(fields[0].value, 3u);
+  EXPECT_EQ(fields[1].value, 4u);
+}
+
+TEST(FindFields, InvalidData_DataLoss) {
+  constexpr uint8_t proto[] = {0x08, 0x01, 0x3a, 0x05, 0x08};
+  constexpr FieldPath kPaths[] = {kInt32Path, kNestedUint32Path};
+  std::array<FoundField, 2> fields;
+
+  EXPECT_EQ(FindFields(std::as_bytes(std::span(proto)), kPaths, fields),
+            Status::DataLoss());
+  EXPECT_TRUE(fields[0].found);
+  EXPECT_FALSE(fields[1].found);
+}
+
 }  // namespace
 }  // namespace pw::protobuf
@@ -18,6 +18,7 @@
 
 #include "pw_protobuf/wire_format.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 #include "pw_varint/varint.h"
 
 // This file defines a low-level event-based protobuf wire format decoder.
@@ -45,7 +46,7 @@ namespace pw::protobuf {
 class Decoder {
  public:
   constexpr Decoder(std::span<const std::byte> proto)
-      : proto_(proto), previous_field_consumed_(true) {}
+      : proto_(proto), field_size_(0), previous_field_consumed_(true) {}
 
   Decoder(const Decoder& other) = delete;
   Decoder& operator=(const Decoder& other) = delete;
@@ -53,7 +54,9 @@ class Decoder {
   // Advances to the next field in the proto.
   //
   // If Next() returns OK, there is guaranteed to be a valid protobuf field at
-  // the current cursor position.
+  // the current cursor position. If the previous field was not read, it is
+  // skipped in a single step, regardless of its size; unread submessages are
+  // not decoded.
   //
   // Return values:
   //
@@ -133,9 +136,96 @@ class Decoder {
     return ReadDelimited(out);
   }
 
+  // Reads a proto submessage from the current cursor and resets `out` to
+  // decode it. `out` refers to the submessage within the raw protobuf data,
+  // which must outlive it; nothing is copied. The submessage's fields are only
+  // decoded as `out` is advanced. If the field is invalid, `out` is not
+  // modified.
+  //
+  //   Decoder nested({});
+  //   PW_TRY(decoder.ReadMessage(&nested));
+  //   while (nested.Next().ok()) {
+  //     // ...
+  //   }
+  //
+  Status ReadMessage(Decoder* out) {
+    std::span<const std::byte> submessage;
+    if (Status status = ReadDelimited(&submessage); !status.ok()) {
+      return status;
+    }
+    out->Reset(submessage);
+    return OkStatus();
+  }
+
+  // Reads a packed repeated field from the current cursor into `out`. Each
+  // function returns the number of values that were read.
+  //
+  // Return values:
+  //
+  //                  OK: All of the field's values were read into `out`.
+  //  RESOURCE_EXHAUSTED: `out` is too small to hold all of the field's values;
+  //                      the values that fit were read.
+  //           DATA_LOSS: The packed field is invalid.
+  // FAILED_PRECONDITION: The current field is not length-delimited.
+  //
+  StatusWithSize ReadPackedInt32(std::span<int32_t> out) {
+    return ReadPackedVarints(std::span(
+        reinterpret_cast<uint32_t*>(out.data()), out.size()));
+  }
+
+  StatusWithSize ReadPackedUint32(std::span<uint32_t> out) {
+    return ReadPackedVarints(out);
+  }
+
+  StatusWithSize ReadPackedInt64(std::span<int64_t> out) {
+    return ReadPackedVarints(std::span(
+        reinterpret_cast<uint64_t*>(out.data()), out.size()));
+  }
+
+  StatusWithSize ReadPackedUint64(std::span<uint64_t> out) {
+    return ReadPackedVarints(out);
+  }
+
+  StatusWithSize ReadPackedSint32(std::span<int32_t> out) {
+    return ReadPackedZigZag(out);
+  }
+
+  StatusWithSize ReadPackedSint64(std::span<int64_t> out) {
+    return ReadPackedZigZag(out);
+  }
+
+  StatusWithSize ReadPackedFixed32(std::span<uint32_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedFixed64(std::span<uint64_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedSfixed32(std::span<int32_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedSfixed64(std::span<int64_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedFloat(std::span<float> out) {
+    static_assert(sizeof(float) == sizeof(uint32_t),
+                  "Float and uint32_t must be the same size for protobufs");
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedDouble(std::span<double> out) {
+    static_assert(sizeof(double) == sizeof(uint64_t),
+                  "Double and uint64_t must be the same size for protobufs");
+    return ReadPackedFixed(out);
+  }
+
   // Resets the decoder to start reading a new proto message.
   void Reset(std::span<const std::byte> proto) {
     proto_ = proto;
+    field_size_ = 0;
     previous_field_consumed_ = true;
   }
 
@@ -164,7 +254,27 @@ class Decoder {
 
   Status ReadDelimited(std::span<const std::byte>* out);
 
+  // Reads a packed repeated varint field from the current cursor position.
+  StatusWithSize ReadPackedVarints(std::span<uint32_t> out);
+  StatusWithSize ReadPackedVarints(std::span<uint64_t> out);
+  StatusWithSize ReadPackedZigZag(std::span<int32_t> out);
+  StatusWithSize ReadPackedZigZag(std::span<int64_t> out);
+
+  // Reads a packed repeated fixed-size field from the current cursor position.
+  StatusWithSize ReadPackedFixed(std::span<std::byte> out, size_t elem_size);
+
+  template <typename T>
+  StatusWithSize ReadPackedFixed(std::span<T> out) {
+    static_assert(
+        sizeof(T) == sizeof(uint32_t) || sizeof(T) == sizeof(uint64_t),
+        "Protobuf fixed-size fields must be 32- or 64-bit");
+    return ReadPackedFixed(std::as_writable_bytes(out), sizeof(T));
+  }
+
   std::span<const std::byte> proto_;
+
+  // The size of the field at the cursor, as determined by Next().
+  size_t field_size_;
   bool previous_field_consumed_;
 };
 
@@ -277,6 +387,49 @@ class CallbackDecoder {
     return decoder_.ReadBytes(out);
   }
 
+  // Reads a packed repeated field from the current cursor into `out`. See the
+  // corresponding Decoder functions.
+  StatusWithSize ReadPackedInt32(std::span<int32_t> out) {
+    return decoder_.ReadPackedInt32(out);
+  }
+  StatusWithSize ReadPackedUint32(std::span<uint32_t> out) {
+    return decoder_.ReadPackedUint32(out);
+  }
+  StatusWithSize ReadPackedInt64(std::span<int64_t> out) {
+    return decoder_.ReadPackedInt64(out);
+  }
+  StatusWithSize ReadPackedUint64(std::span<uint64_t> out) {
+    return decoder_.ReadPackedUint64(out);
+  }
+  StatusWithSize ReadPackedSint32(std::span<int32_t> out) {
+    return decoder_.ReadPackedSint32(out);
+  }
+  StatusWithSize ReadPackedSint64(std::span<int64_t> out) {
+    return decoder_.ReadPackedSint64(out);
+  }
+  StatusWithSize ReadPackedFixed32(std::span<uint32_t> out) {
+    return decoder_.ReadPackedFixed32(out);
+  }
+  StatusWithSize ReadPackedFixed64(std::span<uint64_t> out) {
+    return decoder_.ReadPackedFixed64(out);
+  }
+  StatusWithSize ReadPackedSfixed32(std::span<int32_t> out) {
+    return decoder_.ReadPackedSfixed32(out);
+  }
+  StatusWithSize ReadPackedSfixed64(std::span<int64_t> out) {
+    return decoder_.ReadPackedSfixed64(out);
+  }
+  StatusWithSize ReadPackedFloat(std::span<float> out) {
+    return decoder_.ReadPackedFloat(out);
+  }
+  StatusWithSize ReadPackedDouble(std::span<double> out) {
+    return decoder_.ReadPackedDouble(out);
+  }
+
+  // Reads a proto submessage from the current cursor and resets `out` to
+  // decode it. See Decoder::ReadMessage.
+  Status ReadMessage(Decoder* out) { return decoder_.ReadMessage(out); }
+
   bool cancelled() const { return state_ == kDecodeCancelled; };
 
  private:
@@ -13,7 +13,13 @@
 // the License.
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
 #include "pw_protobuf/decoder.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_status/status.h"
 
 namespace pw::protobuf {
 
@@ -43,4 +49,56 @@ class FindDecodeHandler final : public DecodeHandler {
   FindDecodeHandler* nested_handler_;
 };
 
+// A path to a field, as the field numbers of each submessage containing it
+// followed by the number of the field itself. For example, {3, 2} refers to
+// field 2 of the message in field 3.
+using FieldPath = std::span<const uint32_t>;
+
+// The maximum number of fields that FindFields can search for at once.
+inline constexpr size_t kMaxFindFields = 32;
+
+// A field located by FindFields.
+struct FoundField {
+  bool found = false;
+  WireType wire_type = WireType::kVarint;
+
+  // For varint fields, the field's value.
+  uint64_t value = 0;
+
+  // For length-delimited fields, the field's contents. For fixed-size fields,
+  // the field's little-endian bytes.
+  std::span<const std::byte> data;
+};
+
+// Finds the fields at each of the given paths in a single pass over a message.
+// The result for each path is stored at the same index in `fields`. If a field
+// appears more than once, the first occurrence is used. The search stops as
+// soon as all of the fields have been found, and submessages are only decoded
+// if they may contain a field that has not yet been found.
+//
+//   constexpr uint32_t kAddress[] = {1};
+//   constexpr uint32_t kChannelId[] = {3, 2};
+//   constexpr FieldPath kPaths[] = {kAddress, kChannelId};
+//
+//   std::array<FoundField, 2> fields;
+//   PW_TRY(FindFields(packet, kPaths, fields));
+//   Route(fields[0].value, fields[1].value);
+//
+// Views in `fields` refer to the message, which must outlive them.
+//
+// Precondition: paths.size() == fields.size(), paths.size() <= kMaxFindFields,
+// and every path is non-empty.
+//
+// Returns:
+//
+//          OK: All of the fields were found.
+//   NOT_FOUND: Some of the fields are not in the message; the others were
+//              found.
+//   DATA_LOSS: The message is not a valid protobuf message. Fields found
+//              before the invalid data are stored in `fields`.
+//
+Status FindFields(std::span<const std::byte> message,
+                  std::span<const FieldPath> paths,
+                  std::span<FoundField> fields);
+
 }  // namespace pw::protobuf
@@ -0,0 +1,331 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_status/try.h"
+#include "pw_varint/varint.h"
+
+namespace pw::protobuf {
+
+// A protobuf encoder that writes a message from the end of its buffer toward
+// the start. Each field is prepended to the data written so far, so the fields
+// appear in the encoded message in the reverse of the order they were written.
+//
+// Writing back to front means that a nested message's contents are complete
+// before its length prefix is written. The length is varint encoded in front
+// of the contents with no placeholder, no fix-up pass, and no shifting of data,
+// no matter how deeply messages are nested. Unlike Encoder, the buffer needs no
+// room beyond the encoded message itself.
+//
+// To write a nested message, call Push(), write the nested message's fields,
+// then call Pop() with the field number of the nested message:
+//
+//   // message Point { uint32 x = 1; uint32 y = 2; }
+//   // message Line { Point start = 1; Point end = 2; }
+//   NestedReverseEncoder<1> encoder(buffer);
+//
+//   encoder.Push();  // Line.end, written first since it is encoded last.
+//   encoder.WriteUint32(2, end.y);
+//   encoder.WriteUint32(1, end.x);
+//   encoder.Pop(2);
+//
+//   encoder.Push();  // Line.start
+//   encoder.WriteUint32(2, start.y);
+//   encoder.WriteUint32(1, start.x);
+//   encoder.Pop(1);
+//
+//   Result<ConstByteSpan> line = encoder.Encode();
+//
+// Protobuf decoders accept fields in any order, but the values of a repeated
+// field are decoded in the order they appear, so repeated fields must be
+// written last value first. The WritePacked functions take care of this
+// themselves and encode the values in the order they are given.
+//
+// Like Encoder, the first error is latched and returned from every later call.
+class ReverseEncoder {
+ public:
+  // The stack holds the encoded size at each Push(); its size limits the
+  // nesting depth.
+  constexpr ReverseEncoder(ByteSpan buffer, std::span<size_t> stack)
+      : buffer_(buffer),
+        cursor_(buffer.data() + buffer.size()),
+        stack_(stack),
+        depth_(0),
+        encode_status_(OkStatus()) {}
+
+  // Disallow copy/assign to avoid confusion about who owns the buffer.
+  ReverseEncoder(const ReverseEncoder&) = delete;
+  ReverseEncoder& operator=(const ReverseEncoder&) = delete;
+
+  // Writes a proto uint32 key-value pair.
+  Status WriteUint32(uint32_t field_number, uint32_t value) {
+    return WriteUint64(field_number, value);
+  }
+
+  // Writes a repeated uint32 using packed encoding.
+  Status WritePackedUint32(uint32_t field_number,
+                           std::span<const uint32_t> values) {
+    return WritePackedVarints(field_number, values, /*zigzag=*/false);
+  }
+
+  // Writes a proto uint64 key-value pair.
+  Status WriteUint64(uint32_t field_number, uint64_t value) {
+    return WriteVarintField(field_number, value);
+  }
+
+  // Writes a repeated uint64 using packed encoding.
+  Status WritePackedUint64(uint32_t field_number,
+                           std::span<const uint64_t> values) {
+    return WritePackedVarints(field_number, values, /*zigzag=*/false);
+  }
+
+  // Writes a proto int32 key-value pair.
+  Status WriteInt32(uint32_t field_number, int32_t value) {
+    return WriteUint64(field_number, value);
+  }
+
+  // Writes a repeated int32 using packed encoding.
+  Status WritePackedInt32(uint32_t field_number,
+                          std::span<const int32_t> values) {
+    return WritePackedVarints(field_number, values, /*zigzag=*/false);
+  }
+
+  // Writes a proto int64 key-value pair.
+  Status WriteInt64(uint32_t field_number, int64_t value) {
+    return WriteUint64(field_number, value);
+  }
+
+  // Writes a repeated int64 using packed encoding.
+  Status WritePackedInt64(uint32_t field_number,
+                          std::span<const int64_t> values) {
+    return WritePackedVarints(field_number, values, /*zigzag=*/false);
+  }
+
+  // Writes a proto sint32 key-value pair.
+  Status WriteSint32(uint32_t field_number, int32_t value) {
+    return WriteUint64(field_number, varint::ZigZagEncode(value));
+  }
+
+  // Writes a repeated sint32 using packed encoding.
+  Status WritePackedSint32(uint32_t field_number,
+                           std::span<const int32_t> values) {
+    return WritePackedVarints(field_number, values, /*zigzag=*/true);
+  }
+
+  // Writes a proto sint64 key-value pair.
+  Status WriteSint64(uint32_t field_number, int64_t value) {
+    return WriteUint64(field_number, varint::ZigZagEncode(value));
+  }
+
+  // Writes a repeated sint64 using packed encoding.
+  Status WritePackedSint64(uint32_t field_number,
+                           std::span<const int64_t> values) {
+    return WritePackedVarints(field_number, values, /*zigzag=*/true);
+  }
+
+  // Writes a proto bool key-value pair.
+  Status WriteBool(uint32_t field_number, bool value) {
+    return WriteUint32(field_number, static_cast<uint32_t>(value));
+  }
+
+  // Writes a proto fixed32 key-value pair.
+  Status WriteFixed32(uint32_t field_number, uint32_t value) {
+    return WriteFixedField(field_number, WireType::kFixed32, value);
+  }
+
+  // Writes a repeated fixed32 field using packed encoding.
+  Status WritePackedFixed32(uint32_t field_number,
+                            std::span<const uint32_t> values) {
+    return WriteBytes(field_number, std::as_bytes(values));
+  }
+
+  // Writes a proto fixed64 key-value pair.
+  Status WriteFixed64(uint32_t field_number, uint64_t value) {
+    return WriteFixedField(field_number, WireType::kFixed64, value);
+  }
+
+  // Writes a repeated fixed64 field using packed encoding.
+  Status WritePackedFixed64(uint32_t field_number,
+                            std::span<const uint64_t> values) {
+    return WriteBytes(field_number, std::as_bytes(values));
+  }
+
+  // Writes a proto sfixed32 key-value pair.
+  Status WriteSfixed32(uint32_t field_number, int32_t value) {
+    return WriteFixed32(field_number, static_cast<uint32_t>(value));
+  }
+
+  // Writes a repeated sfixed32 field using packed encoding.
+  Status WritePackedSfixed32(uint32_t field_number,
+                             std::span<const int32_t> values) {
+    return WriteBytes(field_number, std::as_bytes(values));
+  }
+
+  // Writes a proto sfixed64 key-value pair.
+  Status WriteSfixed64(uint32_t field_number, int64_t value) {
+    return WriteFixed64(field_number, static_cast<uint64_t>(value));
+  }
+
+  // Writes a repeated sfixed64 field using packed encoding.
+  Status WritePackedSfixed64(uint32_t field_number,
+                             std::span<const int64_t> values) {
+    return WriteBytes(field_number, std::as_bytes(values));
+  }
+
+  // Writes a proto float key-value pair.
+  Status WriteFloat(uint32_t field_number, float value) {
+    static_assert(sizeof(float) == sizeof(uint32_t),
+                  "Float and uint32_t are not the same size");
+    return WriteFixedField(field_number, WireType::kFixed32, value);
+  }
+
+  // Writes a repeated float field using packed encoding.
+  Status WritePackedFloat(uint32_t field_number,
+                          std::span<const float> values) {
+    return WriteBytes(field_number, std::as_bytes(values));
+  }
+
+  // Writes a proto double key-value pair.
+  Status WriteDouble(uint32_t field_number, double value) {
+    static_assert(sizeof(double) == sizeof(uint64_t),
+                  "Double and uint64_t are not the same size");
+    return WriteFixedField(field_number, WireType::kFixed64, value);
+  }
+
+  // Writes a repeated double field using packed encoding.
+  Status WritePackedDouble(uint32_t field_number,
+                           std::span<const double> values) {
+    return WriteBytes(field_number, std::as_bytes(values));
+  }
+
+  // Writes a proto bytes key-value pair.
+  Status WriteBytes(uint32_t field_number, ConstByteSpan value);
+
+  // Writes a proto string key-value pair.
+  Status WriteString(uint32_t field_number, const char* value, size_t size) {
+    return WriteBytes(field_number, std::as_bytes(std::span(value, size)));
+  }
+
+  Status WriteString(uint32_t field_number, const char* value) {
+    return WriteString(field_number, value, std::strlen(value));
+  }
+
+  // Begins a nested message. The fields written until the matching Pop() make
+  // up the nested message.
+  Status Push();
+
+  // Finishes the nested message begun by the last Push(), prepending its
+  // length and the key for field_number.
+  Status Pop(uint32_t field_number);
+
+  // Returns the total encoded size of the proto message.
+  size_t EncodedSize() const {
+    return buffer_.data() + buffer_.size() - cursor_;
+  }
+
+  // Returns the number of bytes remaining in the buffer.
+  size_t RemainingSize() const { return cursor_ - buffer_.data(); }
+
+  // Discards everything written. This invalidates any spans obtained from
+  // Encode().
+  void Clear() {
+    cursor_ = buffer_.data() + buffer_.size();
+    depth_ = 0;
+    encode_status_ = OkStatus();
+  }
+
+  // Returns the encoded message, which occupies the end of the buffer. Returns
+  // FAILED_PRECONDITION if a Push() has not been matched by a Pop().
+  Result<ConstByteSpan> Encode() const;
+
+ private:
+  Status WriteVarintField(uint32_t field_number, uint64_t value);
+
+  template <typename T>
+  Status WriteFixedField(uint32_t field_number, WireType type, T value) {
+    return WriteFixedBytes(
+        field_number, type, std::as_bytes(std::span(&value, 1)));
+  }
+
+  Status WriteFixedBytes(uint32_t field_number,
+                         WireType type,
+                         ConstByteSpan value);
+
+  // Writes the values last to first, so they are encoded in order.
+  template <typename T>
+  Status WritePackedVarints(uint32_t field_number,
+                            std::span<const T> values,
+                            bool zigzag) {
+    PW_TRY(CheckFieldNumber(field_number));
+    const size_t end_size = EncodedSize();
+    for (auto value = values.rbegin(); value != values.rend(); ++value) {
+      if (zigzag) {
+        PW_TRY(WriteVarint(
+            varint::ZigZagEncode(static_cast<std::make_signed_t<T>>(*value))));
+      } else {
+        PW_TRY(WriteVarint(static_cast<uint64_t>(*value)));
+      }
+    }
+    return WriteLengthAndKey(field_number, EncodedSize() - end_size);
+  }
+
+  // Writes the length of a length-delimited field and then its key in front.
+  Status WriteLengthAndKey(uint32_t field_number, size_t length);
+
+  Status CheckFieldNumber(uint32_t field_number);
+
+  // Prepends a varint or raw bytes to the encoded data.
+  Status WriteVarint(uint64_t value);
+  Status WriteRawBytes(ConstByteSpan data);
+
+  // Moves the cursor back by size bytes, or sets RESOURCE_EXHAUSTED.
+  Status Reserve(size_t size);
+
+  ByteSpan buffer_;
+
+  // The start of the encoded data, which runs to the end of the buffer.
+  std::byte* cursor_;
+
+  // The EncodedSize() at each unmatched Push().
+  std::span<size_t> stack_;
+  size_t depth_;
+
+  Status encode_status_;
+};
+
+// A ReverseEncoder that allocates its own stack for nested messages.
+template <size_t kMaxNestedDepth = 1>
+class NestedReverseEncoder : public ReverseEncoder {
+ public:
+  NestedReverseEncoder(ByteSpan buffer) : ReverseEncoder(buffer, stack_) {}
+
+  // Disallow copy/assign to avoid confusion about who owns the buffer.
+  NestedReverseEncoder(const NestedReverseEncoder&) = delete;
+  NestedReverseEncoder& operator=(const NestedReverseEncoder&) = delete;
+
+ private:
+  std::array<size_t, kMaxNestedDepth> stack_;
+};
+
+}  // namespace pw::protobuf
@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 #include "pw_protobuf/wire_format.h"
@@ -49,4 +50,34 @@ constexpr size_t SizeOfFieldKey(uint32_t field_number) {
   return varint::EncodedSize(field_number << kFieldNumberShift);
 }
 
+// The following functions return the serialized size of a field, including its
+// key. These can be used to calculate the size of a submessage before encoding
+// it, as StreamingEncoder::GetNestedEncoder(field_number, size) requires.
+
+// Size of a uint32, uint64, int64, int32, enum, or bool field. Negative int32
+// and int64 values must be passed sign-extended to 64 bits.
+constexpr size_t SizeOfVarintField(uint32_t field_number, uint64_t value) {
+  return SizeOfFieldKey(field_number) + varint::EncodedSize(value);
+}
+
+// Size of a sint32 or sint64 field.
+constexpr size_t SizeOfZigZagField(uint32_t field_number, int64_t value) {
+  return SizeOfFieldKey(field_number) + varint::ZigZagEncodedSize(value);
+}
+
+// Size of a fixed32, sfixed32, or float field.
+constexpr size_t SizeOfFixed32Field(uint32_t field_number) {
+  return SizeOfFieldKey(field_number) + sizeof(uint32_t);
+}
+
+// Size of a fixed64, sfixed64, or double field.
+constexpr size_t SizeOfFixed64Field(uint32_t field_number) {
+  return SizeOfFieldKey(field_number) + sizeof(uint64_t);
+}
+
+// Size of a string, bytes, or submessage field with `length` bytes of data.
+constexpr size_t SizeOfDelimitedField(uint32_t field_number, size_t length) {
+  return SizeOfFieldKey(field_number) + varint::EncodedSize(length) + length;
+}
+
 }  // namespace pw::protobuf
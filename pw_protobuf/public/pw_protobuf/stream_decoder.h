@@ -0,0 +1,336 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::protobuf {
+
+// A protobuf decoder that reads an encoded message from a pw::stream::Reader,
+// pulling bytes only as fields are read. Unlike Decoder, the message does not
+// have to be in memory, so large messages, such as snapshots read from a blob
+// store or a socket, can be decoded with a few hundred bytes of RAM.
+//
+// Scalar fields are read like with Decoder. Strings and bytes are copied into
+// caller-provided buffers, or read through a BytesReader, which is a
+// stream::Reader bounded to the field. A submessage is decoded by a nested
+// StreamDecoder that reads from a BytesReader:
+//
+//   StreamDecoder decoder(blob_reader);
+//   while (decoder.Next().ok()) {
+//     switch (decoder.FieldNumber()) {
+//       case Snapshot::kVersion:
+//         decoder.ReadUint32(&version);
+//         break;
+//       case Snapshot::kMetadata: {
+//         StreamDecoder::BytesReader bytes = decoder.GetBytesReader();
+//         StreamDecoder metadata(bytes, bytes.field_size());
+//         while (metadata.Next().ok()) {
+//           // ...
+//         }
+//         break;
+//       }
+//       case Snapshot::kImage: {
+//         StreamDecoder::BytesReader image = decoder.GetBytesReader();
+//         CopyImage(image);
+//         break;
+//       }
+//     }
+//   }
+//
+// Bytes are read from the stream only once, in order, so fields must be read
+// in the order they are encoded. A BytesReader shares the decoder's stream and
+// must not be used after the decoder advances to another field. Unread parts
+// of fields are read and discarded when Next() is called.
+class StreamDecoder {
+ public:
+  // A stream::Reader that reads the contents of a length-delimited field from
+  // the decoder's stream. It reports OUT_OF_RANGE at the end of the field.
+  class BytesReader final : public stream::Reader {
+   public:
+    // The total size of the field, including any bytes already read.
+    size_t field_size() const { return field_size_; }
+
+    size_t ConservativeReadLimit() const override;
+
+   private:
+    friend class StreamDecoder;
+
+    constexpr BytesReader(StreamDecoder& decoder,
+                          size_t field_size,
+                          size_t end)
+        : decoder_(decoder), field_size_(field_size), end_(end) {}
+
+    StatusWithSize DoRead(ByteSpan destination) override;
+
+    StreamDecoder& decoder_;
+    const size_t field_size_;
+    const size_t end_;  // Position of the end of the field in the stream.
+  };
+
+  // Used as the message length when the message continues until the end of
+  // the stream.
+  static constexpr size_t kUnknownLength = std::numeric_limits<size_t>::max();
+
+  // Decodes a message of `length` bytes from `reader`. If the length is
+  // unknown, the message ends when the reader returns OUT_OF_RANGE.
+  constexpr StreamDecoder(stream::Reader& reader,
+                          size_t length = kUnknownLength)
+      : reader_(reader),
+        length_(length),
+        position_(0),
+        field_end_(0),
+        delimited_size_(0),
+        field_number_(0),
+        wire_type_(WireType::kVarint),
+        field_consumed_(true),
+        status_(OkStatus()) {}
+
+  StreamDecoder(const StreamDecoder& other) = delete;
+  StreamDecoder& operator=(const StreamDecoder& other) = delete;
+
+  // Advances to the next field in the message, reading and discarding any
+  // unread part of the current field.
+  //
+  // Return values:
+  //
+  //             OK: Advanced to a valid proto field.
+  //   OUT_OF_RANGE: Reached the end of the proto message.
+  //      DATA_LOSS: Invalid protobuf data, or the stream ended in a field.
+  //
+  // Other errors from the stream are returned as is. After an error, the
+  // position in the stream is unknown, so Next() returns the error again.
+  Status Next();
+
+  // Returns the field number of the field at the current cursor position.
+  uint32_t FieldNumber() const { return field_number_; }
+
+  // Returns the wire type of the field at the current cursor position.
+  WireType wire_type() const { return wire_type_; }
+
+  // Reads a proto int32 value from the current cursor.
+  Status ReadInt32(int32_t* out);
+
+  // Reads a proto uint32 value from the current cursor.
+  Status ReadUint32(uint32_t* out);
+
+  // Reads a proto int64 value from the current cursor.
+  Status ReadInt64(int64_t* out) {
+    return ReadVarintField(reinterpret_cast<uint64_t*>(out));
+  }
+
+  // Reads a proto uint64 value from the current cursor.
+  Status ReadUint64(uint64_t* out) { return ReadVarintField(out); }
+
+  // Reads a proto sint32 value from the current cursor.
+  Status ReadSint32(int32_t* out);
+
+  // Reads a proto sint64 value from the current cursor.
+  Status ReadSint64(int64_t* out);
+
+  // Reads a proto bool value from the current cursor.
+  Status ReadBool(bool* out);
+
+  // Reads a proto fixed32 value from the current cursor.
+  Status ReadFixed32(uint32_t* out) { return ReadFixedField(out); }
+
+  // Reads a proto fixed64 value from the current cursor.
+  Status ReadFixed64(uint64_t* out) { return ReadFixedField(out); }
+
+  // Reads a proto sfixed32 value from the current cursor.
+  Status ReadSfixed32(int32_t* out) { return ReadFixedField(out); }
+
+  // Reads a proto sfixed64 value from the current cursor.
+  Status ReadSfixed64(int64_t* out) { return ReadFixedField(out); }
+
+  // Reads a proto float value from the current cursor.
+  Status ReadFloat(float* out) {
+    static_assert(sizeof(float) == sizeof(uint32_t),
+                  "Float and uint32_t must be the same size for protobufs");
+    return ReadFixedField(out);
+  }
+
+  // Reads a proto double value from the current cursor.
+  Status ReadDouble(double* out) {
+    static_assert(sizeof(double) == sizeof(uint64_t),
+                  "Double and uint64_t must be the same size for protobufs");
+    return ReadFixedField(out);
+  }
+
+  // Copies a proto string value from the current cursor into `out` and returns
+  // its size. The string is not null-terminated.
+  //
+  // Return values:
+  //
+  //                  OK: The string was read.
+  //  RESOURCE_EXHAUSTED: `out` is too small. Nothing was read, so the field
+  //                      can still be read with GetBytesReader().
+  // FAILED_PRECONDITION: The current field is not length-delimited, or was
+  //                      already read.
+  //           DATA_LOSS: The stream ended in the field.
+  //
+  StatusWithSize ReadString(std::span<char> out) {
+    return ReadBytes(std::as_writable_bytes(out));
+  }
+
+  // Copies a proto bytes value from the current cursor into `out` and returns
+  // its size. Returns the same values as ReadString().
+  StatusWithSize ReadBytes(ByteSpan out);
+
+  // Returns a reader for the rest of the current length-delimited field, such
+  // as a large bytes field or a submessage. The reader reads from this
+  // decoder's stream, so it is invalidated when Next() is called.
+  //
+  // Precondition: The current field is length-delimited and has not been read
+  // with another function.
+  BytesReader GetBytesReader();
+
+  // Reads a packed repeated field from the current cursor into `out`. Each
+  // function returns the number of values that were read.
+  //
+  // Return values:
+  //
+  //                  OK: All of the field's values were read into `out`.
+  //  RESOURCE_EXHAUSTED: `out` is too small to hold all of the field's values;
+  //                      the values that fit were read, and the rest of the
+  //                      field is skipped by Next().
+  //           DATA_LOSS: The packed field is invalid.
+  // FAILED_PRECONDITION: The current field is not length-delimited.
+  //
+  StatusWithSize ReadPackedInt32(std::span<int32_t> out) {
+    return ReadPackedVarints(
+        std::span(reinterpret_cast<uint32_t*>(out.data()), out.size()));
+  }
+
+  StatusWithSize ReadPackedUint32(std::span<uint32_t> out) {
+    return ReadPackedVarints(out);
+  }
+
+  StatusWithSize ReadPackedInt64(std::span<int64_t> out) {
+    return ReadPackedVarints(
+        std::span(reinterpret_cast<uint64_t*>(out.data()), out.size()));
+  }
+
+  StatusWithSize ReadPackedUint64(std::span<uint64_t> out) {
+    return ReadPackedVarints(out);
+  }
+
+  StatusWithSize ReadPackedSint32(std::span<int32_t> out) {
+    return ReadPackedZigZag(out);
+  }
+
+  StatusWithSize ReadPackedSint64(std::span<int64_t> out) {
+    return ReadPackedZigZag(out);
+  }
+
+  StatusWithSize ReadPackedFixed32(std::span<uint32_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedFixed64(std::span<uint64_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedSfixed32(std::span<int32_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedSfixed64(std::span<int64_t> out) {
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedFloat(std::span<float> out) {
+    static_assert(sizeof(float) == sizeof(uint32_t),
+                  "Float and uint32_t must be the same size for protobufs");
+    return ReadPackedFixed(out);
+  }
+
+  StatusWithSize ReadPackedDouble(std::span<double> out) {
+    static_assert(sizeof(double) == sizeof(uint64_t),
+                  "Double and uint64_t must be the same size for protobufs");
+    return ReadPackedFixed(out);
+  }
+
+ private:
+  // Reads exactly destination.size() bytes. Returns DATA_LOSS if the stream
+  // ends first.
+  Status ReadExactly(ByteSpan destination);
+
+  // Reads a varint from the stream one byte at a time, so that no bytes after
+  // it are consumed.
+  Status ReadVarint(uint64_t* out);
+
+  // Reads and discards bytes up to the end of the current field.
+  Status SkipToFieldEnd();
+
+  // Checks that the current field has the expected wire type and is unread.
+  Status CheckField(WireType expected_type) const;
+
+  Status ReadVarintField(uint64_t* out);
+
+  Status ReadFixedField(std::byte* out, size_t size);
+
+  template <typename T>
+  Status ReadFixedField(T* out) {
+    static_assert(
+        sizeof(T) == sizeof(uint32_t) || sizeof(T) == sizeof(uint64_t),
+        "Protobuf fixed-size fields must be 32- or 64-bit");
+    return ReadFixedField(reinterpret_cast<std::byte*>(out), sizeof(T));
+  }
+
+  StatusWithSize ReadPackedVarints(std::span<uint32_t> out);
+  StatusWithSize ReadPackedVarints(std::span<uint64_t> out);
+  StatusWithSize ReadPackedZigZag(std::span<int32_t> out);
+  StatusWithSize ReadPackedZigZag(std::span<int64_t> out);
+
+  template <typename T>
+  StatusWithSize ReadPackedVarintField(std::span<T> out, bool zig_zag);
+
+  StatusWithSize ReadPackedFixed(ByteSpan out, size_t elem_size);
+
+  template <typename T>
+  StatusWithSize ReadPackedFixed(std::span<T> out) {
+    static_assert(
+        sizeof(T) == sizeof(uint32_t) || sizeof(T) == sizeof(uint64_t),
+        "Protobuf fixed-size fields must be 32- or 64-bit");
+    return ReadPackedFixed(std::as_writable_bytes(out), sizeof(T));
+  }
+
+  stream::Reader& reader_;
+  const size_t length_;
+
+  // Number of bytes of the message read from the stream.
+  size_t position_;
+
+  // For fixed and length-delimited fields, the position where the current
+  // field ends. Varint fields are skipped by reading the varint.
+  size_t field_end_;
+  size_t delimited_size_;
+
+  uint32_t field_number_;
+  WireType wire_type_;
+  bool field_consumed_;
+  Status status_;
+};
+
+}  // namespace pw::protobuf
@@ -77,6 +77,7 @@ class StreamingEncoder {
         status_(OkStatus()),
         parent_(nullptr),
         nested_field_number_(0),
+        bytes_remaining_(0),
         memory_writer_(scratch_buffer) {}
   ~StreamingEncoder() { Finalize(); }
 
@@ -89,11 +90,13 @@ class StreamingEncoder {
   StreamingEncoder& operator=(StreamingEncoder&& other) = delete;
 
   // Forwards the conservative write limit of the underlying pw::stream::Writer.
+  // For nested encoders created with a known size, this is also limited by the
+  // number of bytes of the submessage that remain to be written.
   //
   // Precondition: Encoder has no active child encoder.
   size_t ConservativeWriteLimit() const {
     PW_ASSERT(!nested_encoder_open());
-    return writer_.ConservativeWriteLimit();
+    return WriteLimit();
   }
 
   // Creates a nested encoder with the provided field number. Once this is
@@ -103,6 +106,20 @@ class StreamingEncoder {
   // Precondition: Encoder has no active child encoder.
   StreamingEncoder GetNestedEncoder(uint32_t field_number);
 
+  // Creates a nested encoder for a submessage whose encoded size is known in
+  // advance; the helpers in pw_protobuf/serialized_size.h may be used to
+  // calculate it. The submessage's key and size are written immediately, and
+  // the nested encoder writes the submessage directly to this encoder's writer
+  // instead of staging it in the scratch buffer. This saves the scratch space
+  // and the copy into the parent that GetNestedEncoder(field_number) requires.
+  //
+  // The nested encoder may write at most `size` bytes. If it writes fewer, the
+  // parent encoder's status is set to DATA_LOSS when the nested encoder is
+  // finalized, since the output has already been corrupted.
+  //
+  // Precondition: Encoder has no active child encoder.
+  StreamingEncoder GetNestedEncoder(uint32_t field_number, size_t size);
+
   // Closes the proto encoder. If this encoder is a nested one, the parent is
   // unlocked and proto encoding may resume on the parent. This is automatically
   // called on object destruction.
@@ -112,6 +129,8 @@ class StreamingEncoder {
   // Returns:
   //   OutOfRange: Insufficient space reserved for the submessage. This
   //     usually means config::kMaxVarintSize was set too small.
+  //   DataLoss: A nested encoder created with a known size wrote fewer bytes
+  //     than it was created with.
   Status Finalize();
 
   Status status() const {
@@ -386,6 +405,7 @@ class StreamingEncoder {
         status_(other.status_),
         parent_(other.parent_),
         nested_field_number_(other.nested_field_number_),
+        bytes_remaining_(other.bytes_remaining_),
         memory_writer_(std::move(other.memory_writer_)) {
     PW_ASSERT(nested_field_number_ == 0);
     // Make the nested encoder look like it has an open child to block writes
@@ -408,10 +428,41 @@ class StreamingEncoder {
                                        : OkStatus()),
         parent_(&parent),
         nested_field_number_(0),
+        bytes_remaining_(0),
+        memory_writer_(scratch_buffer) {}
+
+  // Constructs a nested encoder that writes a submessage of the given size
+  // directly to its parent's writer.
+  constexpr StreamingEncoder(StreamingEncoder& parent,
+                             ByteSpan scratch_buffer,
+                             size_t size)
+      : writer_(parent.writer_),
+        status_(parent.status_),
+        parent_(&parent),
+        nested_field_number_(0),
+        bytes_remaining_(size),
         memory_writer_(scratch_buffer) {}
 
   bool nested_encoder_open() const { return nested_field_number_ != 0; }
 
+  // True for nested encoders that write to their parent's writer rather than
+  // to a scratch buffer.
+  bool writes_directly() const {
+    return parent_ != nullptr && parent_ != this &&
+           &writer_ != &memory_writer_;
+  }
+
+  // The number of bytes that may be written, accounting for the submessage
+  // size of nested encoders that write directly.
+  size_t WriteLimit() const {
+    const size_t limit = writer_.ConservativeWriteLimit();
+    return writes_directly() ? std::min(limit, bytes_remaining_) : limit;
+  }
+
+  // Returns the part of the scratch buffer that is available to a nested
+  // encoder, after skipping `reserved_size` bytes past the data written to it.
+  ByteSpan UnusedScratchBuffer(size_t reserved_size);
+
   // Finalization logic for nested encoders that call Finalize(). While
   // Finalize() is called on the child encoder, FinalizeNestedMessage() is
   // called on the parent encoder.
@@ -433,6 +484,9 @@ class StreamingEncoder {
     return WriteVarint(varint::ZigZagEncode(value));
   }
 
+  // Packed varints are encoded through a stack buffer of this size.
+  static constexpr size_t kPackedVarintChunkSize = 64;
+
   // Writes a list of varints to the buffer in length-delimited packed encoding.
   template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
   Status WritePackedVarints(uint32_t field_number,
@@ -463,15 +517,33 @@ class StreamingEncoder {
     }
 
     WriteVarint(MakeKey(field_number, WireType::kDelimited));
-    WriteVarint(payload_size);
+    PW_TRY(WriteVarint(payload_size));
+
+    // Encode the values into a stack buffer and write them in chunks rather
+    // than issuing a separate write for each value.
+    std::array<std::byte, kPackedVarintChunkSize> chunk;
+    size_t encoded = 0;
     for (T value : values) {
+      if (chunk.size() - encoded < varint::kMaxVarint64SizeBytes) {
+        status_.Update(writer_.Write(std::span(chunk).first(encoded)));
+        PW_TRY(status_);
+        encoded = 0;
+      }
+
+      uint64_t integer;
       if (encode_type == VarintEncodeType::kZigZag) {
-        WriteZigzagVarint(static_cast<std::make_signed_t<T>>(value));
+        integer = varint::ZigZagEncode(
+            static_cast<int64_t>(static_cast<std::make_signed_t<T>>(value)));
       } else {
-        WriteVarint(value);
+        integer = static_cast<uint64_t>(value);
       }
+      encoded += varint::EncodeLittleEndianBase128(
+          integer, std::span(chunk).subspan(encoded));
     }
 
+    if (encoded != 0u) {
+      status_.Update(writer_.Write(std::span(chunk).first(encoded)));
+    }
     return status_;
   }
 
@@ -516,6 +588,10 @@ class StreamingEncoder {
   // submessage. Otherwise, this is 0 to indicate no child encoder is open.
   uint32_t nested_field_number_;
 
+  // For nested encoders that write directly to their parent's writer, the
+  // number of bytes of the submessage that have yet to be written.
+  size_t bytes_remaining_;
+
   // This memory writer is used for staging proto submessages to the
   // scratch_buffer.
   stream::MemoryWriter memory_writer_;
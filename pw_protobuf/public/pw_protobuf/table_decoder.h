@@ -0,0 +1,118 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_protobuf/wire_format.h"
+#include "pw_status/status.h"
+
+// This file defines a table-driven protobuf decoder, which decodes a serialized
+// message directly into a plain C++ struct. Each struct is described by a table
+// of its fields, which maps a field number to the member's offset within the
+// struct and the kind of value stored there. A single decode loop is shared by
+// all messages, so no per-message decoding code is needed.
+//
+// The pw_protobuf compiler plugin generates a Message struct, a kMessageFields
+// table, and a Decode function in the namespace of each message:
+//
+//   pw::protobuf::test::Pigweed::Message pigweed;
+//   if (Status status = Pigweed::Decode(proto, pigweed); !status.ok()) {
+//     return status;
+//   }
+//   LogMagicNumber(pigweed.magic_number);
+//
+// The same tables are used to compute the encoded size of a struct, which the
+// plugin exposes as an EncodedSize function:
+//
+//   const size_t size = Pigweed::EncodedSize(pigweed);
+//
+// Tables may also be written by hand for structs that are not generated.
+namespace pw::protobuf {
+
+// How a field's value is stored in a message struct.
+enum class FieldKind : uint8_t {
+  kInt32,    // int32_t or an enum; int32 and enum fields
+  kUint32,   // uint32_t; uint32 fields
+  kSint32,   // int32_t; ZigZag-encoded sint32 fields
+  kUint64,   // int64_t or uint64_t; int64 and uint64 fields
+  kSint64,   // int64_t; ZigZag-encoded sint64 fields
+  kBool,     // bool; bool fields
+  kFixed32,  // 4-byte value; fixed32, sfixed32, and float fields
+  kFixed64,  // 8-byte value; fixed64, sfixed64, and double fields
+  kString,   // std::string_view; string fields
+  kBytes,    // std::span<const std::byte>; bytes fields
+  kMessage,  // a nested message struct described by nested_fields
+};
+
+// Returns the wire type with which fields of the given kind are encoded.
+constexpr WireType WireTypeFor(FieldKind kind) {
+  switch (kind) {
+    case FieldKind::kFixed32:
+      return WireType::kFixed32;
+    case FieldKind::kFixed64:
+      return WireType::kFixed64;
+    case FieldKind::kString:
+    case FieldKind::kBytes:
+    case FieldKind::kMessage:
+      return WireType::kDelimited;
+    default:
+      return WireType::kVarint;
+  }
+}
+
+struct MessageField;
+
+// The fields of a message struct, sorted by field number.
+using MessageFields = std::span<const MessageField>;
+
+// Describes one member of a message struct.
+struct MessageField {
+  uint32_t field_number;
+  uint16_t offset;  // offsetof the member within the message struct
+  FieldKind kind;
+
+  // For kMessage fields, the fields of the nested struct; otherwise, null.
+  const MessageFields* nested_fields;
+};
+
+// Decodes a serialized protobuf message into the struct at `message`, which is
+// described by `fields`. Fields that appear in the data but not in the table
+// are skipped. Members for fields that do not appear in the data are not
+// modified. If a field appears more than once, the last value wins; nested
+// messages are merged.
+//
+// String and bytes members refer to the serialized data, which must outlive
+// the struct.
+//
+// Returns:
+//
+//          OK: The message was decoded.
+//   DATA_LOSS: The data is not a valid protobuf message, or a field's wire
+//              type does not match its kind. Some members may have been
+//              updated.
+//
+Status DecodeMessage(std::span<const std::byte> proto,
+                     MessageFields fields,
+                     void* message);
+
+// Returns the size of the struct at `message`, described by `fields`, when
+// encoded with each member written once as a field, including members with
+// default values. Negative int32 and enum values are counted as 10-byte
+// varints, as the protobuf specification requires.
+size_t EncodedMessageSize(MessageFields fields, const void* message);
+
+}  // namespace pw::protobuf
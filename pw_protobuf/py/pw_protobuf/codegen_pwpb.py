@@ -18,7 +18,7 @@ from datetime import datetime
 import enum
 import os
 import sys
-from typing import Dict, Iterable, List, Tuple
+from typing import Dict, Iterable, List, Optional, Tuple
 from typing import cast
 
 import google.protobuf.descriptor_pb2 as descriptor_pb2
@@ -132,8 +132,9 @@ class ProtoMethod(abc.ABC):
         later.
         """
 
-    def should_appear(self) -> bool:  # pylint: disable=no-self-use
-        """Whether the method should be generated."""
+    def should_appear(  # pylint: disable=no-self-use,unused-argument
+            self, encoder_type: EncoderType) -> bool:
+        """Whether the method should be generated for the encoder type."""
         return True
 
     def param_string(self) -> str:
@@ -194,6 +195,26 @@ class SubMessageMethod(ProtoMethod):
         return False
 
 
+class SizedSubMessageMethod(SubMessageMethod):
+    """Method which returns an encoder for a sub-message of a known size.
+
+    The sub-message is written directly to the parent's writer rather than
+    staged in its scratch buffer, so this is only generated for encoders that
+    support it.
+    """
+    def params(self) -> List[Tuple[str, str]]:
+        return [('size_t', 'size')]
+
+    def body(self, encoder_type: EncoderType) -> List[str]:
+        return [
+            'return {}::StreamEncoder(GetNestedEncoder({}, size));'.format(
+                self._relative_type_namespace(), self.field_cast())
+        ]
+
+    def should_appear(self, encoder_type: EncoderType) -> bool:
+        return encoder_type != EncoderType.LEGACY
+
+
 class WriteMethod(ProtoMethod):
     """Base class representing an encoder write method.
 
@@ -244,7 +265,7 @@ class PackedMethod(WriteMethod):
 
     Same as a WriteMethod, but is only generated for repeated fields.
     """
-    def should_appear(self) -> bool:
+    def should_appear(self, encoder_type: EncoderType) -> bool:
         return self._field.is_repeated()
 
     def _encoder_fn(self) -> str:
@@ -562,10 +583,57 @@ PROTO_FIELD_METHODS: Dict[int, List] = {
     descriptor_pb2.FieldDescriptorProto.TYPE_STRING: [
         StringLenMethod, StringMethod
     ],
-    descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE: [SubMessageMethod],
+    descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE: [
+        SubMessageMethod, SizedSubMessageMethod
+    ],
     descriptor_pb2.FieldDescriptorProto.TYPE_ENUM: [EnumMethod],
 }
 
+# Mapping of protobuf field types to the C++ type of their member in a message
+# struct and the pw::protobuf::FieldKind with which they are decoded. Enum and
+# message members use the field's generated type, so they have no fixed type.
+# Proto enums are generated as enum classes, which store int values.
+STRUCT_MEMBER_TYPES: Dict[int, Tuple[Optional[str], str]] = {
+    descriptor_pb2.FieldDescriptorProto.TYPE_DOUBLE: ('double', 'kFixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FLOAT: ('float', 'kFixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT32: ('int32_t', 'kInt32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT32: ('int32_t', 'kSint32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED32: ('int32_t', 'kFixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT64: ('int64_t', 'kUint64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT64: ('int64_t', 'kSint64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED64: ('int64_t', 'kFixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT32: ('uint32_t', 'kUint32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED32: ('uint32_t', 'kFixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT64: ('uint64_t', 'kUint64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED64: ('uint64_t', 'kFixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_BOOL: ('bool', 'kBool'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_BYTES:
+    ('std::span<const std::byte>', 'kBytes'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_STRING:
+    ('std::string_view', 'kString'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE: (None, 'kMessage'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_ENUM: (None, 'kInt32'),
+}
+
+# C++ keywords which may appear as proto field names. Struct members for these
+# fields have a trailing underscore appended to their names.
+CPP_KEYWORDS = frozenset([
+    'alignas', 'alignof', 'and', 'and_eq', 'asm', 'auto', 'bitand', 'bitor',
+    'bool', 'break', 'case', 'catch', 'char', 'char8_t', 'char16_t',
+    'char32_t', 'class', 'compl', 'concept', 'const', 'consteval',
+    'constexpr', 'constinit', 'const_cast', 'continue', 'co_await',
+    'co_return', 'co_yield', 'decltype', 'default', 'delete', 'do', 'double',
+    'dynamic_cast', 'else', 'enum', 'explicit', 'export', 'extern', 'false',
+    'float', 'for', 'friend', 'goto', 'if', 'inline', 'int', 'long',
+    'mutable', 'namespace', 'new', 'noexcept', 'not', 'not_eq', 'nullptr',
+    'operator', 'or', 'or_eq', 'private', 'protected', 'public', 'register',
+    'reinterpret_cast', 'requires', 'return', 'short', 'signed', 'sizeof',
+    'static', 'static_assert', 'static_cast', 'struct', 'switch', 'template',
+    'this', 'thread_local', 'throw', 'true', 'try', 'typedef', 'typeid',
+    'typename', 'union', 'unsigned', 'using', 'virtual', 'void', 'volatile',
+    'wchar_t', 'while', 'xor', 'xor_eq'
+])
+
 
 def generate_code_for_message(message: ProtoMessage, root: ProtoNode,
                               output: OutputFile,
@@ -600,7 +668,7 @@ def generate_code_for_message(message: ProtoMessage, root: ProtoNode,
         for field in message.fields():
             for method_class in PROTO_FIELD_METHODS[field.type()]:
                 method = method_class(field, message, root)
-                if not method.should_appear():
+                if not method.should_appear(encoder_type):
                     continue
 
                 output.write_line()
@@ -632,7 +700,8 @@ def define_not_in_class_methods(message: ProtoMessage, root: ProtoNode,
     for field in message.fields():
         for method_class in PROTO_FIELD_METHODS[field.type()]:
             method = method_class(field, message, root)
-            if not method.should_appear() or method.in_class_definition():
+            if (not method.should_appear(encoder_type)
+                    or method.in_class_definition()):
                 continue
 
             output.write_line()
@@ -661,7 +730,7 @@ def generate_code_for_enum(proto_enum: ProtoEnum, root: ProtoNode,
 
 
 def forward_declare(node: ProtoMessage, root: ProtoNode,
-                    output: OutputFile) -> None:
+                    max_sizes: Dict[str, int], output: OutputFile) -> None:
     """Generates code forward-declaring entities in a message's namespace."""
     namespace = node.cpp_namespace(root)
     output.write_line()
@@ -674,6 +743,14 @@ def forward_declare(node: ProtoMessage, root: ProtoNode,
             output.write_line(f'{field.enum_name()} = {field.number()},')
     output.write_line('};')
 
+    max_size = max_sizes.get(node.proto_path())
+    if max_size is not None:
+        output.write_line()
+        output.write_line('// The largest size of the message when encoded, '
+                          'with each field written once.')
+        output.write_line(
+            f'inline constexpr size_t kMaxEncodedSizeBytes = {max_size};')
+
     # Declare the message's encoder class and all of its enums.
     output.write_line()
     output.write_line('class Encoder;')
@@ -705,12 +782,242 @@ def generate_encoder_wrappers(package: ProtoNode, encoder_type: EncoderType,
                                         output, encoder_type)
 
 
+def _struct_member_name(field: ProtoMessageField) -> str:
+    """Returns the name of a field's member in its message struct."""
+    name = field.field_name()
+    return f'{name}_' if name in CPP_KEYWORDS else name
+
+
+def _struct_member_type(field: ProtoMessageField) -> str:
+    """Returns the C++ type of a field's member in its message struct."""
+    member_type, _ = STRUCT_MEMBER_TYPES[field.type()]
+    if member_type is not None:
+        return member_type
+
+    if field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE:
+        return f'{_type_namespace(field)}::Message'
+    return _type_namespace(field)
+
+
+def _type_namespace(field: ProtoMessageField) -> str:
+    """Returns the fully-qualified C++ namespace of a field's type.
+
+    Types are fully qualified, as a relative name could be shadowed by a nested
+    message or enum of the same name.
+    """
+    type_node = field.type_node()
+    assert type_node is not None
+    return f'::{type_node.cpp_namespace()}'
+
+
+def _message_struct_fields(
+        package: ProtoNode
+) -> List[Tuple[ProtoMessage, List[ProtoMessageField]]]:
+    """Determines which fields each message's struct has.
+
+    Returns the package's messages and their struct fields, ordered such that
+    each message appears after the messages its fields refer to, so its struct
+    can be defined after theirs.
+
+    Repeated fields are not represented in structs. Neither are fields which
+    would make a struct contain itself, directly or through other messages.
+    Messages with a nested message named Message, which would conflict with the
+    struct's name, do not have structs.
+    """
+    ordered: List[Tuple[ProtoMessage, List[ProtoMessageField]]] = []
+    visited: List[ProtoNode] = []
+    in_progress: List[ProtoNode] = []
+
+    def has_struct(message: ProtoNode) -> bool:
+        return all(child.name() != 'Message' for child in message.children())
+
+    def visit(message: ProtoMessage) -> None:
+        if message in visited or not has_struct(message):
+            return
+
+        visited.append(message)
+        in_progress.append(message)
+        fields: List[ProtoMessageField] = []
+
+        for field in message.fields():
+            if field.is_repeated() or field.type() not in STRUCT_MEMBER_TYPES:
+                continue
+
+            type_node = field.type_node()
+            if (field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE
+                    and type_node is not None
+                    and type_node.type() == ProtoNode.Type.MESSAGE):
+                if type_node in in_progress or not has_struct(type_node):
+                    continue
+
+                visit(cast(ProtoMessage, type_node))
+
+            fields.append(field)
+
+        in_progress.remove(message)
+        ordered.append((message, fields))
+
+    for node in package:
+        if node.type() == ProtoNode.Type.MESSAGE:
+            visit(cast(ProtoMessage, node))
+
+    return ordered
+
+
+def generate_message_struct(message: ProtoMessage,
+                            fields: List[ProtoMessageField], root: ProtoNode,
+                            output: OutputFile) -> None:
+    """Generates a message's struct, its field table, and functions using it."""
+    namespace = message.cpp_namespace(root)
+    output.write_line()
+    output.write_line(f'namespace {namespace} {{')
+
+    output.write_line('struct Message {')
+    with output.indent():
+        for field in fields:
+            output.write_line(f'{_struct_member_type(field)} '
+                              f'{_struct_member_name(field)} = {{}};')
+    output.write_line('};')
+    output.write_line()
+
+    # The table decoder requires the fields to be sorted by number.
+    if fields:
+        output.write_line('inline constexpr ::pw::protobuf::MessageField '
+                          'kMessageFieldArray[] = {')
+        with output.indent():
+            for field in sorted(fields, key=lambda field: field.number()):
+                _, kind = STRUCT_MEMBER_TYPES[field.type()]
+                if kind == 'kMessage':
+                    nested = f'&{_type_namespace(field)}::kMessageFields'
+                else:
+                    nested = 'nullptr'
+
+                output.write_line(
+                    f'{{{field.number()}, '
+                    f'offsetof(Message, {_struct_member_name(field)}), '
+                    f'::pw::protobuf::FieldKind::{kind}, {nested}}},')
+        output.write_line('};')
+        output.write_line('inline constexpr ::pw::protobuf::MessageFields '
+                          'kMessageFields(kMessageFieldArray);')
+    else:
+        output.write_line(
+            'inline constexpr ::pw::protobuf::MessageFields kMessageFields{};')
+
+    output.write_line()
+    output.write_line('inline ::pw::Status Decode(std::span<const std::byte> '
+                      'proto, Message& message) {')
+    with output.indent():
+        output.write_line('return ::pw::protobuf::DecodeMessage('
+                          'proto, kMessageFields, &message);')
+    output.write_line('}')
+
+    output.write_line()
+    output.write_line('inline size_t EncodedSize(const Message& message) {')
+    with output.indent():
+        output.write_line('return ::pw::protobuf::EncodedMessageSize('
+                          'kMessageFields, &message);')
+    output.write_line('}')
+
+    output.write_line(f'}}  // namespace {namespace}')
+
+
+# Largest encoded size of each fixed-size field type's value.
+MAX_VALUE_SIZES: Dict[int, int] = {
+    descriptor_pb2.FieldDescriptorProto.TYPE_DOUBLE: 8,
+    descriptor_pb2.FieldDescriptorProto.TYPE_FLOAT: 4,
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT32: 10,
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT32: 5,
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED32: 4,
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT64: 10,
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT64: 10,
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED64: 8,
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT32: 5,
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED32: 4,
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT64: 10,
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED64: 8,
+    descriptor_pb2.FieldDescriptorProto.TYPE_BOOL: 1,
+    descriptor_pb2.FieldDescriptorProto.TYPE_ENUM: 10,
+}
+
+
+def _varint_size(value: int) -> int:
+    size = 1
+    while value >= 0x80:
+        value >>= 7
+        size += 1
+    return size
+
+
+def max_encoded_sizes(proto_files: Iterable) -> Dict[str, int]:
+    """Determines the largest encoded size of each bounded message.
+
+    Returns a dict from each message's fully-qualified name, such as
+    'pw.protobuf.test.Pigweed', to its largest size when encoded with each field
+    written once. Messages with repeated, string, or bytes fields, or with
+    message fields for which the size cannot be determined, are unbounded and
+    are not included.
+    """
+    descriptors = {}
+
+    def add_messages(prefix: str, messages) -> None:
+        for message in messages:
+            name = f'{prefix}.{message.name}' if prefix else message.name
+            descriptors[name] = message
+            add_messages(name, message.nested_type)
+
+    for proto_file in proto_files:
+        add_messages(proto_file.package, proto_file.message_type)
+
+    sizes: Dict[str, Optional[int]] = {}
+
+    def max_size(name: str) -> Optional[int]:
+        if name in sizes:
+            return sizes[name]
+
+        # A message that contains itself is unbounded. Mark the message as such
+        # while its fields are visited to stop the recursion.
+        sizes[name] = None
+        total = 0
+
+        for field in descriptors[name].field:
+            if (field.label ==
+                    descriptor_pb2.FieldDescriptorProto.LABEL_REPEATED):
+                return None
+
+            if field.type == descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE:
+                type_name = field.type_name.lstrip('.')
+                if type_name not in descriptors:
+                    return None
+                nested = max_size(type_name)
+                if nested is None:
+                    return None
+                value_size = _varint_size(nested) + nested
+            elif field.type in MAX_VALUE_SIZES:
+                value_size = MAX_VALUE_SIZES[field.type]
+            else:
+                return None
+
+            total += _varint_size(field.number << 3) + value_size
+
+        sizes[name] = total
+        return total
+
+    for name in descriptors:
+        max_size(name)
+
+    return {
+        name: size
+        for name, size in sizes.items() if size is not None
+    }
+
+
 def _proto_filename_to_generated_header(proto_file: str) -> str:
     """Returns the generated C++ header name for a .proto file."""
     return os.path.splitext(proto_file)[0] + PROTO_H_EXTENSION
 
 
 def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
+                              max_sizes: Dict[str, int],
                               output: OutputFile) -> None:
     """Generates code for a single .pb.h file corresponding to a .proto file."""
 
@@ -722,9 +1029,12 @@ def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
     output.write_line('#pragma once\n')
     output.write_line('#include <cstddef>')
     output.write_line('#include <cstdint>')
-    output.write_line('#include <span>\n')
+    output.write_line('#include <span>')
+    output.write_line('#include <string_view>\n')
+    output.write_line('#include "pw_preprocessor/compiler.h"')
     output.write_line('#include "pw_protobuf/codegen.h"')
     output.write_line('#include "pw_protobuf/streaming_encoder.h"')
+    output.write_line('#include "pw_protobuf/table_decoder.h"')
 
     for imported_file in file_descriptor_proto.dependency:
         generated_header = _proto_filename_to_generated_header(imported_file)
@@ -739,7 +1049,8 @@ def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
 
     for node in package:
         if node.type() == ProtoNode.Type.MESSAGE:
-            forward_declare(cast(ProtoMessage, node), package, output)
+            forward_declare(cast(ProtoMessage, node), package, max_sizes,
+                            output)
 
     # Define all top-level enums.
     for node in package.children():
@@ -751,12 +1062,30 @@ def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
     generate_encoder_wrappers(package, EncoderType.STREAMING, output)
     generate_encoder_wrappers(package, EncoderType.MEMORY, output)
 
+    # Message structs may have std::span members, which are not standard-layout
+    # in all implementations. The compilers Pigweed supports handle offsetof
+    # for these structs as expected, but warn about it.
+    output.write_line()
+    output.write_line('PW_MODIFY_DIAGNOSTICS_PUSH();')
+    output.write_line('PW_MODIFY_DIAGNOSTIC(ignored, "-Winvalid-offsetof");')
+
+    for message, fields in _message_struct_fields(package):
+        generate_message_struct(message, fields, package, output)
+
+    output.write_line()
+    output.write_line('PW_MODIFY_DIAGNOSTICS_POP();')
+
     if package.cpp_namespace():
         output.write_line(f'\n}}  // namespace {package.cpp_namespace()}')
 
 
-def process_proto_file(proto_file) -> Iterable[OutputFile]:
-    """Generates code for a single .proto file."""
+def process_proto_file(proto_file,
+                       all_proto_files: Iterable = ()) -> Iterable[OutputFile]:
+    """Generates code for a single .proto file.
+
+    all_proto_files are the descriptors of the files the file imports, which
+    are needed to determine the sizes of imported message types.
+    """
 
     # Two passes are made through the file. The first builds the tree of all
     # message/enum nodes, then the second creates the fields in each. This is
@@ -766,6 +1095,8 @@ def process_proto_file(proto_file) -> Iterable[OutputFile]:
 
     output_filename = _proto_filename_to_generated_header(proto_file.name)
     output_file = OutputFile(output_filename)
-    generate_code_for_package(proto_file, package_root, output_file)
+    max_sizes = max_encoded_sizes([proto_file, *all_proto_files])
+    generate_code_for_package(proto_file, package_root, max_sizes,
+                              output_file)
 
     return [output_file]
@@ -37,7 +37,8 @@ def process_proto_request(req: plugin_pb2.CodeGeneratorRequest,
       res: A CodeGeneratorResponse to populate with the plugin's output.
     """
     for proto_file in req.proto_file:
-        output_files = codegen_pwpb.process_proto_file(proto_file)
+        output_files = codegen_pwpb.process_proto_file(
+            proto_file, req.proto_file)
         for output_file in output_files:
             fd = res.file.add()
             fd.name = output_file.name()
@@ -289,6 +289,9 @@ class ProtoMessageField:
         self._type_node: Optional[ProtoNode] = type_node
         self._repeated: bool = repeated
 
+    def field_name(self) -> str:
+        return self._field_name
+
     def name(self) -> str:
         return self.upper_camel_case(self._field_name)
 
@@ -0,0 +1,130 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/reverse_encoder.h"
+
+namespace pw::protobuf {
+
+Status ReverseEncoder::WriteBytes(uint32_t field_number, ConstByteSpan value) {
+  PW_TRY(CheckFieldNumber(field_number));
+  PW_TRY(WriteRawBytes(value));
+  return WriteLengthAndKey(field_number, value.size_bytes());
+}
+
+Status ReverseEncoder::Push() {
+  if (!encode_status_.ok()) {
+    return encode_status_;
+  }
+
+  if (depth_ == stack_.size()) {
+    encode_status_ = Status::ResourceExhausted();
+    return encode_status_;
+  }
+
+  stack_[depth_++] = EncodedSize();
+  return OkStatus();
+}
+
+Status ReverseEncoder::Pop(uint32_t field_number) {
+  if (!encode_status_.ok()) {
+    return encode_status_;
+  }
+
+  if (depth_ == 0) {
+    encode_status_ = Status::FailedPrecondition();
+    return encode_status_;
+  }
+
+  PW_TRY(CheckFieldNumber(field_number));
+
+  // Everything written since the Push() is the nested message.
+  const size_t nested_size = EncodedSize() - stack_[--depth_];
+  return WriteLengthAndKey(field_number, nested_size);
+}
+
+Result<ConstByteSpan> ReverseEncoder::Encode() const {
+  if (!encode_status_.ok()) {
+    return encode_status_;
+  }
+
+  if (depth_ != 0) {
+    return Status::FailedPrecondition();
+  }
+
+  return Result<ConstByteSpan>(buffer_.last(EncodedSize()));
+}
+
+Status ReverseEncoder::WriteVarintField(uint32_t field_number,
+                                        uint64_t value) {
+  PW_TRY(CheckFieldNumber(field_number));
+  PW_TRY(WriteVarint(value));
+  return WriteVarint(MakeKey(field_number, WireType::kVarint));
+}
+
+Status ReverseEncoder::WriteFixedBytes(uint32_t field_number,
+                                       WireType type,
+                                       ConstByteSpan value) {
+  PW_TRY(CheckFieldNumber(field_number));
+  PW_TRY(WriteRawBytes(value));
+  return WriteVarint(MakeKey(field_number, type));
+}
+
+Status ReverseEncoder::WriteLengthAndKey(uint32_t field_number,
+                                         size_t length) {
+  PW_TRY(WriteVarint(length));
+  return WriteVarint(MakeKey(field_number, WireType::kDelimited));
+}
+
+Status ReverseEncoder::CheckFieldNumber(uint32_t field_number) {
+  if (!encode_status_.ok()) {
+    return encode_status_;
+  }
+
+  if (!ValidFieldNumber(field_number)) {
+    encode_status_ = Status::InvalidArgument();
+  }
+  return encode_status_;
+}
+
+Status ReverseEncoder::WriteVarint(uint64_t value) {
+  const size_t size = varint::EncodedSize(value);
+  PW_TRY(Reserve(size));
+  varint::EncodeLittleEndianBase128(value, std::span(cursor_, size));
+  return OkStatus();
+}
+
+Status ReverseEncoder::WriteRawBytes(ConstByteSpan data) {
+  PW_TRY(Reserve(data.size_bytes()));
+
+  // Memmove the value into place as it's possible that it shares the encode
+  // buffer on a memory-constrained system.
+  std::memmove(cursor_, data.data(), data.size_bytes());
+  return OkStatus();
+}
+
+Status ReverseEncoder::Reserve(size_t size) {
+  if (!encode_status_.ok()) {
+    return encode_status_;
+  }
+
+  if (size > RemainingSize()) {
+    encode_status_ = Status::ResourceExhausted();
+    return encode_status_;
+  }
+
+  cursor_ -= size;
+  return OkStatus();
+}
+
+}  // namespace pw::protobuf
@@ -0,0 +1,328 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/reverse_encoder.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_protobuf/encoder.h"
+
+namespace pw::protobuf {
+namespace {
+
+// The tests in this file use the following proto message schemas.
+//
+//   message TestProto {
+//     uint32 magic_number = 1;
+//     sint32 ziggy = 2;
+//     fixed64 cycles = 3;
+//     float ratio = 4;
+//     string error_message = 5;
+//     NestedProto nested = 6;
+//   }
+//
+//   message NestedProto {
+//     string hello = 1;
+//     uint32 id = 2;
+//     repeated DoubleNestedProto pair = 3;
+//   }
+//
+//   message DoubleNestedProto {
+//     string key = 1;
+//     string value = 2;
+//   }
+//
+// Each test writes the fields in reverse and checks that the result matches
+// the forward encoding from the Encoder class.
+
+constexpr uint32_t kTestProtoMagicNumberField = 1;
+constexpr uint32_t kTestProtoZiggyField = 2;
+constexpr uint32_t kTestProtoCyclesField = 3;
+constexpr uint32_t kTestProtoRatioField = 4;
+constexpr uint32_t kTestProtoErrorMessageField = 5;
+constexpr uint32_t kTestProtoNestedField = 6;
+
+constexpr uint32_t kNestedProtoHelloField = 1;
+constexpr uint32_t kNestedProtoIdField = 2;
+constexpr uint32_t kNestedProtoPairField = 3;
+
+constexpr uint32_t kDoubleNestedProtoKeyField = 1;
+constexpr uint32_t kDoubleNestedProtoValueField = 2;
+
+void ExpectSame(Result<ConstByteSpan> expected, Result<ConstByteSpan> actual) {
+  ASSERT_EQ(expected.status(), OkStatus());
+  ASSERT_EQ(actual.status(), OkStatus());
+  ASSERT_EQ(expected.value().size(), actual.value().size());
+  EXPECT_EQ(std::memcmp(expected.value().data(),
+                        actual.value().data(),
+                        actual.value().size()),
+            0);
+}
+
+TEST(ReverseEncoder, EncodePrimitives) {
+  std::byte expected_buffer[64];
+  NestedEncoder expected(expected_buffer);
+  expected.WriteUint32(kTestProtoMagicNumberField, 42);
+  expected.WriteSint32(kTestProtoZiggyField, -13);
+  expected.WriteFixed64(kTestProtoCyclesField, 0xdeadbeef8badf00d);
+  expected.WriteFloat(kTestProtoRatioField, 1.618034f);
+  expected.WriteString(kTestProtoErrorMessageField, "broken 💩");
+
+  std::byte encode_buffer[64];
+  NestedReverseEncoder encoder(encode_buffer);
+  EXPECT_EQ(encoder.WriteString(kTestProtoErrorMessageField, "broken 💩"),
+            OkStatus());
+  EXPECT_EQ(encoder.WriteFloat(kTestProtoRatioField, 1.618034f), OkStatus());
+  EXPECT_EQ(encoder.WriteFixed64(kTestProtoCyclesField, 0xdeadbeef8badf00d),
+            OkStatus());
+  EXPECT_EQ(encoder.WriteSint32(kTestProtoZiggyField, -13), OkStatus());
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 42), OkStatus());
+
+  ExpectSame(expected.Encode(), encoder.Encode());
+}
+
+TEST(ReverseEncoder, EncodeOtherScalars) {
+  std::byte expected_buffer[96];
+  NestedEncoder expected(expected_buffer);
+  expected.WriteInt32(1, -1);
+  expected.WriteInt64(2, -1234567890123);
+  expected.WriteUint64(3, 0xffffffffffffffff);
+  expected.WriteSint64(4, -1234567890123);
+  expected.WriteBool(5, true);
+  expected.WriteFixed32(6, 0x12345678);
+  expected.WriteSfixed32(7, -2);
+  expected.WriteSfixed64(8, -3);
+  expected.WriteDouble(9, 3.14159);
+
+  std::byte encode_buffer[96];
+  NestedReverseEncoder encoder(encode_buffer);
+  encoder.WriteDouble(9, 3.14159);
+  encoder.WriteSfixed64(8, -3);
+  encoder.WriteSfixed32(7, -2);
+  encoder.WriteFixed32(6, 0x12345678);
+  encoder.WriteBool(5, true);
+  encoder.WriteSint64(4, -1234567890123);
+  encoder.WriteUint64(3, 0xffffffffffffffff);
+  encoder.WriteInt64(2, -1234567890123);
+  encoder.WriteInt32(1, -1);
+
+  ExpectSame(expected.Encode(), encoder.Encode());
+}
+
+TEST(ReverseEncoder, Nested) {
+  std::byte expected_buffer[128];
+  NestedEncoder<2, 4> expected(expected_buffer);
+  expected.WriteUint32(kTestProtoMagicNumberField, 42);
+  expected.Push(kTestProtoNestedField);
+  expected.WriteString(kNestedProtoHelloField, "world");
+  expected.WriteUint32(kNestedProtoIdField, 999);
+  expected.Push(kNestedProtoPairField);
+  expected.WriteString(kDoubleNestedProtoKeyField, "key");
+  expected.WriteString(kDoubleNestedProtoValueField, "value");
+  expected.Pop();
+  expected.Push(kNestedProtoPairField);
+  expected.WriteString(kDoubleNestedProtoKeyField, "version");
+  expected.WriteString(kDoubleNestedProtoValueField, "2.9.1");
+  expected.Pop();
+  expected.Pop();
+  expected.WriteSint32(kTestProtoZiggyField, -13);
+
+  std::byte encode_buffer[128];
+  NestedReverseEncoder<2> encoder(encode_buffer);
+  EXPECT_EQ(encoder.WriteSint32(kTestProtoZiggyField, -13), OkStatus());
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  encoder.WriteString(kDoubleNestedProtoValueField, "2.9.1");
+  encoder.WriteString(kDoubleNestedProtoKeyField, "version");
+  EXPECT_EQ(encoder.Pop(kNestedProtoPairField), OkStatus());
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  encoder.WriteString(kDoubleNestedProtoValueField, "value");
+  encoder.WriteString(kDoubleNestedProtoKeyField, "key");
+  EXPECT_EQ(encoder.Pop(kNestedProtoPairField), OkStatus());
+  encoder.WriteUint32(kNestedProtoIdField, 999);
+  encoder.WriteString(kNestedProtoHelloField, "world");
+  EXPECT_EQ(encoder.Pop(kTestProtoNestedField), OkStatus());
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 42), OkStatus());
+
+  ExpectSame(expected.Encode(), encoder.Encode());
+}
+
+TEST(ReverseEncoder, Nested_MultiByteLengths) {
+  std::array<std::byte, 200> payload;
+  payload.fill(std::byte{0x5a});
+
+  std::byte expected_buffer[256];
+  NestedEncoder<3, 3> expected(expected_buffer);
+  expected.Push(1);
+  expected.Push(2);
+  expected.Push(3);
+  expected.WriteBytes(4, payload);
+  expected.Pop();
+  expected.Pop();
+  expected.Pop();
+
+  std::byte encode_buffer[256];
+  NestedReverseEncoder<3> encoder(encode_buffer);
+  encoder.Push();
+  encoder.Push();
+  encoder.Push();
+  encoder.WriteBytes(4, payload);
+  encoder.Pop(3);
+  encoder.Pop(2);
+  encoder.Pop(1);
+
+  ExpectSame(expected.Encode(), encoder.Encode());
+}
+
+TEST(ReverseEncoder, EmptyNestedMessage) {
+  std::byte encode_buffer[8];
+  NestedReverseEncoder encoder(encode_buffer);
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  EXPECT_EQ(encoder.Pop(kTestProtoNestedField), OkStatus());
+
+  Result result = encoder.Encode();
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.value().size(), 2u);
+  EXPECT_EQ(result.value()[0], std::byte{0x32});
+  EXPECT_EQ(result.value()[1], std::byte{0x00});
+}
+
+TEST(ReverseEncoder, Packed) {
+  constexpr uint32_t kUint32s[] = {0, 50, 100, 150, 200};
+  constexpr int32_t kSint32s[] = {-1000, -1, 0, 1, 1000};
+  constexpr int64_t kInt64s[] = {-1, 1, 1ll << 40};
+  constexpr float kFloats[] = {1.5f, -2.25f};
+
+  std::byte expected_buffer[128];
+  NestedEncoder expected(expected_buffer);
+  expected.WritePackedUint32(1, kUint32s);
+  expected.WritePackedSint32(2, kSint32s);
+  expected.WritePackedInt64(3, kInt64s);
+  expected.WritePackedFloat(4, kFloats);
+
+  std::byte encode_buffer[128];
+  NestedReverseEncoder encoder(encode_buffer);
+  EXPECT_EQ(encoder.WritePackedFloat(4, kFloats), OkStatus());
+  EXPECT_EQ(encoder.WritePackedInt64(3, kInt64s), OkStatus());
+  EXPECT_EQ(encoder.WritePackedSint32(2, kSint32s), OkStatus());
+  EXPECT_EQ(encoder.WritePackedUint32(1, kUint32s), OkStatus());
+
+  ExpectSame(expected.Encode(), encoder.Encode());
+}
+
+TEST(ReverseEncoder, ExactSizeBuffer) {
+  // Three bytes of nested field data, plus a key and length.
+  std::byte encode_buffer[5];
+  NestedReverseEncoder encoder(encode_buffer);
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  EXPECT_EQ(encoder.WriteUint32(1, 300), OkStatus());
+  EXPECT_EQ(encoder.Pop(2), OkStatus());
+  EXPECT_EQ(encoder.RemainingSize(), 0u);
+
+  Result result = encoder.Encode();
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.value().data(), encode_buffer);
+  EXPECT_EQ(result.value().size(), sizeof(encode_buffer));
+}
+
+TEST(ReverseEncoder, InsufficientSpace) {
+  std::byte encode_buffer[12];
+  NestedReverseEncoder encoder(encode_buffer);
+
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 42), OkStatus());
+  EXPECT_EQ(encoder.WriteSint32(kTestProtoZiggyField, -13), OkStatus());
+  // 9 bytes; not enough space.
+  EXPECT_EQ(encoder.WriteFixed64(kTestProtoCyclesField, 0xdeadbeef8badf00d),
+            Status::ResourceExhausted());
+  // Any further write operations should fail.
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 1),
+            Status::ResourceExhausted());
+  EXPECT_EQ(encoder.Push(), Status::ResourceExhausted());
+
+  EXPECT_EQ(encoder.Encode().status(), Status::ResourceExhausted());
+}
+
+TEST(ReverseEncoder, InvalidFieldNumber) {
+  std::byte encode_buffer[16];
+  NestedReverseEncoder encoder(encode_buffer);
+
+  EXPECT_EQ(encoder.WriteUint32(0, 1337), Status::InvalidArgument());
+  EXPECT_EQ(encoder.EncodedSize(), 0u);
+
+  // Any further write operations should fail.
+  EXPECT_EQ(encoder.WriteUint32(1, 1), Status::InvalidArgument());
+  EXPECT_EQ(encoder.Encode().status(), Status::InvalidArgument());
+}
+
+TEST(ReverseEncoder, InvalidPopFieldNumber) {
+  std::byte encode_buffer[16];
+  NestedReverseEncoder encoder(encode_buffer);
+
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  EXPECT_EQ(encoder.WriteUint32(1, 1), OkStatus());
+  EXPECT_EQ(encoder.Pop(19091), Status::InvalidArgument());
+  EXPECT_EQ(encoder.Encode().status(), Status::InvalidArgument());
+}
+
+TEST(ReverseEncoder, PushTooDeep) {
+  std::byte encode_buffer[16];
+  NestedReverseEncoder<2> encoder(encode_buffer);
+
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  EXPECT_EQ(encoder.Push(), Status::ResourceExhausted());
+  EXPECT_EQ(encoder.Encode().status(), Status::ResourceExhausted());
+}
+
+TEST(ReverseEncoder, PopWithoutPush) {
+  std::byte encode_buffer[16];
+  NestedReverseEncoder encoder(encode_buffer);
+
+  EXPECT_EQ(encoder.Pop(1), Status::FailedPrecondition());
+  EXPECT_EQ(encoder.Encode().status(), Status::FailedPrecondition());
+}
+
+TEST(ReverseEncoder, UnmatchedPush) {
+  std::byte encode_buffer[16];
+  NestedReverseEncoder encoder(encode_buffer);
+
+  EXPECT_EQ(encoder.Push(), OkStatus());
+  EXPECT_EQ(encoder.WriteUint32(1, 1), OkStatus());
+  EXPECT_EQ(encoder.Encode().status(), Status::FailedPrecondition());
+
+  EXPECT_EQ(encoder.Pop(1), OkStatus());
+  EXPECT_EQ(encoder.Encode().status(), OkStatus());
+}
+
+TEST(ReverseEncoder, Clear) {
+  std::byte encode_buffer[16];
+  NestedReverseEncoder encoder(encode_buffer);
+
+  EXPECT_EQ(encoder.WriteUint32(0, 1), Status::InvalidArgument());
+  encoder.Clear();
+  EXPECT_EQ(encoder.EncodedSize(), 0u);
+  EXPECT_EQ(encoder.RemainingSize(), sizeof(encode_buffer));
+
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 42), OkStatus());
+  Result result = encoder.Encode();
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.value().size(), 2u);
+  EXPECT_EQ(result.value()[0], std::byte{0x08});
+  EXPECT_EQ(result.value()[1], std::byte{0x2a});
+}
+
+}  // namespace
+}  // namespace pw::protobuf
@@ -0,0 +1,376 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/stream_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+#include "pw_assert/check.h"
+#include "pw_status/try.h"
+#include "pw_varint/varint.h"
+
+namespace pw::protobuf {
+namespace {
+
+// Unread parts of fields are discarded through a stack buffer of this size.
+constexpr size_t kSkipBufferSize = 16;
+
+}  // namespace
+
+StatusWithSize StreamDecoder::BytesReader::DoRead(ByteSpan destination) {
+  if (!decoder_.status_.ok()) {
+    return StatusWithSize(decoder_.status_, 0);
+  }
+  if (decoder_.position_ >= end_) {
+    return StatusWithSize::OutOfRange();
+  }
+
+  const size_t to_read =
+      std::min(destination.size(), end_ - decoder_.position_);
+  Result<ByteSpan> result = decoder_.reader_.Read(destination.first(to_read));
+  if (!result.ok()) {
+    // A reader that is temporarily out of data can be retried; anything else
+    // leaves the decoder unusable.
+    if (result.status().IsResourceExhausted()) {
+      return StatusWithSize(result.status(), 0);
+    }
+    decoder_.status_ = result.status().IsOutOfRange() ? Status::DataLoss()
+                                                      : result.status();
+    return StatusWithSize(decoder_.status_, 0);
+  }
+
+  decoder_.position_ += result.value().size();
+  return StatusWithSize(result.value().size());
+}
+
+size_t StreamDecoder::BytesReader::ConservativeReadLimit() const {
+  if (!decoder_.status_.ok() || decoder_.position_ >= end_) {
+    return 0;
+  }
+  return std::min(end_ - decoder_.position_,
+                  decoder_.reader_.ConservativeReadLimit());
+}
+
+Status StreamDecoder::Next() {
+  if (!status_.ok()) {
+    return status_;
+  }
+
+  if (Status status = SkipToFieldEnd(); !status.ok()) {
+    status_ = status;
+    return status;
+  }
+
+  if (length_ != kUnknownLength && position_ >= length_) {
+    status_ = Status::OutOfRange();
+    return status_;
+  }
+
+  // The end of the stream is only the end of the message when it comes before
+  // a field's key and the message length is unknown.
+  const size_t key_start = position_;
+  uint64_t key;
+  if (Status status = ReadVarint(&key); !status.ok()) {
+    status_ = status.IsDataLoss() && position_ == key_start &&
+                      length_ == kUnknownLength
+                  ? Status::OutOfRange()
+                  : status;
+    return status_;
+  }
+
+  const uint64_t field_number = key >> kFieldNumberShift;
+  wire_type_ = static_cast<WireType>(key & kWireTypeMask);
+  if (field_number == 0u || field_number > kMaxFieldNumber) {
+    status_ = Status::DataLoss();
+    return status_;
+  }
+  field_number_ = static_cast<uint32_t>(field_number);
+
+  uint64_t field_size;
+  switch (wire_type_) {
+    case WireType::kVarint:
+      field_size = 0;  // Unknown until the varint is read.
+      break;
+    case WireType::kFixed32:
+      field_size = sizeof(uint32_t);
+      break;
+    case WireType::kFixed64:
+      field_size = sizeof(uint64_t);
+      break;
+    case WireType::kDelimited:
+      if (Status status = ReadVarint(&field_size); !status.ok()) {
+        status_ = status;
+        return status_;
+      }
+      break;
+    default:
+      status_ = Status::DataLoss();
+      return status_;
+  }
+
+  const size_t remaining = length_ == kUnknownLength
+                               ? std::numeric_limits<size_t>::max() - position_
+                               : length_ - position_;
+  if (field_size > remaining) {
+    status_ = Status::DataLoss();
+    return status_;
+  }
+
+  delimited_size_ = static_cast<size_t>(field_size);
+  field_end_ = position_ + delimited_size_;
+  field_consumed_ = false;
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadInt32(int32_t* out) {
+  // Negative int32 values are encoded as 64-bit varints.
+  int64_t value = 0;
+  PW_TRY(ReadInt64(&value));
+  if (value > std::numeric_limits<int32_t>::max() ||
+      value < std::numeric_limits<int32_t>::min()) {
+    return Status::OutOfRange();
+  }
+  *out = static_cast<int32_t>(value);
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadUint32(uint32_t* out) {
+  uint64_t value = 0;
+  PW_TRY(ReadUint64(&value));
+  if (value > std::numeric_limits<uint32_t>::max()) {
+    return Status::OutOfRange();
+  }
+  *out = static_cast<uint32_t>(value);
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadSint32(int32_t* out) {
+  int64_t value = 0;
+  PW_TRY(ReadSint64(&value));
+  if (value > std::numeric_limits<int32_t>::max() ||
+      value < std::numeric_limits<int32_t>::min()) {
+    return Status::OutOfRange();
+  }
+  *out = static_cast<int32_t>(value);
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadSint64(int64_t* out) {
+  uint64_t value = 0;
+  PW_TRY(ReadUint64(&value));
+  *out = varint::ZigZagDecode(value);
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadBool(bool* out) {
+  uint64_t value = 0;
+  PW_TRY(ReadUint64(&value));
+  *out = value;
+  return OkStatus();
+}
+
+StatusWithSize StreamDecoder::ReadBytes(ByteSpan out) {
+  if (Status status = CheckField(WireType::kDelimited); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  if (out.size() < delimited_size_) {
+    return StatusWithSize::ResourceExhausted();
+  }
+
+  if (Status status = ReadExactly(out.first(delimited_size_)); !status.ok()) {
+    status_ = status;
+    return StatusWithSize(status, 0);
+  }
+  field_consumed_ = true;
+  return StatusWithSize(delimited_size_);
+}
+
+StreamDecoder::BytesReader StreamDecoder::GetBytesReader() {
+  PW_CHECK_OK(CheckField(WireType::kDelimited),
+              "Only an unread length-delimited field can be read as bytes");
+
+  // The reader may stop anywhere in the field; Next() skips the rest.
+  field_consumed_ = true;
+  return BytesReader(*this, delimited_size_, field_end_);
+}
+
+Status StreamDecoder::ReadExactly(ByteSpan destination) {
+  while (!destination.empty()) {
+    Result<ByteSpan> result = reader_.Read(destination);
+    if (!result.ok()) {
+      return result.status().IsOutOfRange() ? Status::DataLoss()
+                                            : result.status();
+    }
+    position_ += result.value().size();
+    destination = destination.subspan(result.value().size());
+  }
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadVarint(uint64_t* out) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < varint::kMaxVarint64SizeBytes; ++i) {
+    if (length_ != kUnknownLength && position_ >= length_) {
+      return Status::DataLoss();
+    }
+
+    std::byte byte;
+    PW_TRY(ReadExactly(std::span(&byte, 1)));
+
+    value |= static_cast<uint64_t>(byte & std::byte{0x7f}) << (7 * i);
+    if ((byte & std::byte{0x80}) == std::byte{0}) {
+      *out = value;
+      return OkStatus();
+    }
+  }
+  return Status::DataLoss();
+}
+
+Status StreamDecoder::SkipToFieldEnd() {
+  if (wire_type_ == WireType::kVarint) {
+    if (field_consumed_) {
+      return OkStatus();
+    }
+    uint64_t unused;
+    return ReadVarint(&unused);
+  }
+
+  // Delimited fields may have been partially read by a BytesReader or a
+  // packed read that ran out of room.
+  std::array<std::byte, kSkipBufferSize> buffer;
+  while (position_ < field_end_) {
+    const size_t to_read = std::min(buffer.size(), field_end_ - position_);
+    PW_TRY(ReadExactly(std::span(buffer).first(to_read)));
+  }
+  return OkStatus();
+}
+
+Status StreamDecoder::CheckField(WireType expected_type) const {
+  if (!status_.ok()) {
+    return status_;
+  }
+  if (field_consumed_ || wire_type_ != expected_type) {
+    return Status::FailedPrecondition();
+  }
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadVarintField(uint64_t* out) {
+  PW_TRY(CheckField(WireType::kVarint));
+  if (Status status = ReadVarint(out); !status.ok()) {
+    status_ = status;
+    return status;
+  }
+  field_consumed_ = true;
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadFixedField(std::byte* out, size_t size) {
+  PW_TRY(CheckField(size == sizeof(uint32_t) ? WireType::kFixed32
+                                             : WireType::kFixed64));
+
+  if (Status status = ReadExactly(std::span(out, size)); !status.ok()) {
+    status_ = status;
+    return status;
+  }
+  if constexpr (std::endian::native != std::endian::little) {
+    std::reverse(out, out + size);
+  }
+  field_consumed_ = true;
+  return OkStatus();
+}
+
+StatusWithSize StreamDecoder::ReadPackedVarints(std::span<uint32_t> out) {
+  return ReadPackedVarintField(out, /*zig_zag=*/false);
+}
+
+StatusWithSize StreamDecoder::ReadPackedVarints(std::span<uint64_t> out) {
+  return ReadPackedVarintField(out, /*zig_zag=*/false);
+}
+
+StatusWithSize StreamDecoder::ReadPackedZigZag(std::span<int32_t> out) {
+  return ReadPackedVarintField(out, /*zig_zag=*/true);
+}
+
+StatusWithSize StreamDecoder::ReadPackedZigZag(std::span<int64_t> out) {
+  return ReadPackedVarintField(out, /*zig_zag=*/true);
+}
+
+template <typename T>
+StatusWithSize StreamDecoder::ReadPackedVarintField(std::span<T> out,
+                                                    bool zig_zag) {
+  if (Status status = CheckField(WireType::kDelimited); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  field_consumed_ = true;
+
+  size_t count = 0;
+  while (position_ < field_end_) {
+    if (count == out.size()) {
+      return StatusWithSize::ResourceExhausted(count);
+    }
+
+    // Varints may not extend past the end of the packed field.
+    const size_t varint_start = position_;
+    uint64_t value;
+    Status status = ReadVarint(&value);
+    if (status.ok() && position_ > field_end_) {
+      status = Status::DataLoss();
+    }
+    if (!status.ok()) {
+      // The field is only partially read, so the decoder cannot recover.
+      status_ = position_ == varint_start ? status : Status::DataLoss();
+      return StatusWithSize(status_, count);
+    }
+
+    out[count++] = zig_zag ? static_cast<T>(varint::ZigZagDecode(value))
+                           : static_cast<T>(value);
+  }
+  return StatusWithSize(count);
+}
+
+StatusWithSize StreamDecoder::ReadPackedFixed(ByteSpan out, size_t elem_size) {
+  if (Status status = CheckField(WireType::kDelimited); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+  if (delimited_size_ % elem_size != 0u) {
+    return StatusWithSize::DataLoss();
+  }
+  field_consumed_ = true;
+
+  const size_t size =
+      std::min(delimited_size_, out.size() / elem_size * elem_size);
+  if (Status status = ReadExactly(out.first(size)); !status.ok()) {
+    status_ = status;
+    return StatusWithSize(status, 0);
+  }
+
+  if constexpr (std::endian::native != std::endian::little) {
+    for (size_t i = 0; i < size; i += elem_size) {
+      std::reverse(out.begin() + i, out.begin() + i + elem_size);
+    }
+  }
+
+  const size_t count = size / elem_size;
+  if (size < delimited_size_) {
+    return StatusWithSize::ResourceExhausted(count);
+  }
+  return StatusWithSize(count);
+}
+
+}  // namespace pw::protobuf
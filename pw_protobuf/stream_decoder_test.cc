@@ -0,0 +1,353 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/stream_decoder.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::protobuf {
+namespace {
+
+// Returns at most one byte per read, so that every field straddles reads.
+class OneByteReader : public stream::Reader {
+ public:
+  explicit OneByteReader(ConstByteSpan data) : data_(data) {}
+
+ private:
+  StatusWithSize DoRead(ByteSpan destination) override {
+    if (data_.empty()) {
+      return StatusWithSize::OutOfRange();
+    }
+    destination[0] = data_[0];
+    data_ = data_.subspan(1);
+    return StatusWithSize(1);
+  }
+
+  ConstByteSpan data_;
+};
+
+// clang-format off
+constexpr uint8_t kEncodedProto[] = {
+  // type=int32, k=1, v=42
+  0x08, 0x2a,
+  // type=sint32, k=2, v=-13
+  0x10, 0x19,
+  // type=bool, k=3, v=false
+  0x18, 0x00,
+  // type=double, k=4, v=3.14159
+  0x21, 0x6e, 0x86, 0x1b, 0xf0, 0xf9, 0x21, 0x09, 0x40,
+  // type=fixed32, k=5, v=0xdeadbeef
+  0x2d, 0xef, 0xbe, 0xad, 0xde,
+  // type=string, k=6, v="Hello world"
+  0x32, 0x0b, 'H', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd',
+  // type=int32, k=7, v=-1
+  0x38, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+};
+// clang-format on
+
+void DecodeAllFields(stream::Reader& reader) {
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 1u);
+  int32_t v1 = 0;
+  EXPECT_EQ(decoder.ReadInt32(&v1), OkStatus());
+  EXPECT_EQ(v1, 42);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 2u);
+  int32_t v2 = 0;
+  EXPECT_EQ(decoder.ReadSint32(&v2), OkStatus());
+  EXPECT_EQ(v2, -13);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 3u);
+  bool v3 = true;
+  EXPECT_EQ(decoder.ReadBool(&v3), OkStatus());
+  EXPECT_FALSE(v3);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 4u);
+  double v4 = 0;
+  EXPECT_EQ(decoder.ReadDouble(&v4), OkStatus());
+  EXPECT_EQ(v4, 3.14159);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 5u);
+  uint32_t v5 = 0;
+  EXPECT_EQ(decoder.ReadFixed32(&v5), OkStatus());
+  EXPECT_EQ(v5, 0xdeadbeef);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 6u);
+  char v6[16];
+  StatusWithSize sws = decoder.ReadString(v6);
+  ASSERT_EQ(sws.status(), OkStatus());
+  EXPECT_EQ(std::string_view(v6, sws.size()), "Hello world");
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 7u);
+  int32_t v7 = 0;
+  EXPECT_EQ(decoder.ReadInt32(&v7), OkStatus());
+  EXPECT_EQ(v7, -1);
+
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, Decode) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  DecodeAllFields(reader);
+}
+
+TEST(StreamDecoder, Decode_OneByteReads) {
+  OneByteReader reader(std::as_bytes(std::span(kEncodedProto)));
+  DecodeAllFields(reader);
+}
+
+TEST(StreamDecoder, Decode_SkipsUnreadFields) {
+  OneByteReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  // Skip varint, fixed64, fixed32 and string fields without reading them.
+  for (uint32_t field = 1; field <= 6; ++field) {
+    ASSERT_EQ(decoder.Next(), OkStatus());
+    EXPECT_EQ(decoder.FieldNumber(), field);
+  }
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 7u);
+  int32_t value = 0;
+  EXPECT_EQ(decoder.ReadInt32(&value), OkStatus());
+  EXPECT_EQ(value, -1);
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, Decode_KnownLengthStopsEarly) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader, 4);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 1u);
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 2u);
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+
+  // Nothing after the message was read.
+  std::byte next;
+  ASSERT_EQ(reader.Read(std::span(&next, 1)).status(), OkStatus());
+  EXPECT_EQ(next, std::byte{0x18});
+}
+
+TEST(StreamDecoder, WrongWireType) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  uint32_t fixed = 0;
+  EXPECT_EQ(decoder.ReadFixed32(&fixed), Status::FailedPrecondition());
+  char buffer[8];
+  EXPECT_EQ(decoder.ReadString(buffer).status(), Status::FailedPrecondition());
+
+  // The field can still be read with the right type.
+  int32_t value = 0;
+  EXPECT_EQ(decoder.ReadInt32(&value), OkStatus());
+  EXPECT_EQ(value, 42);
+  EXPECT_EQ(decoder.ReadInt32(&value), Status::FailedPrecondition());
+}
+
+TEST(StreamDecoder, ReadBytes_BufferTooSmall) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok() && decoder.FieldNumber() != 6u) {
+  }
+  ASSERT_EQ(decoder.FieldNumber(), 6u);
+
+  std::array<std::byte, 4> small;
+  EXPECT_EQ(decoder.ReadBytes(small).status(), Status::ResourceExhausted());
+
+  // The field was not consumed, so it can still be read another way.
+  StreamDecoder::BytesReader bytes = decoder.GetBytesReader();
+  EXPECT_EQ(bytes.field_size(), 11u);
+  Result<ByteSpan> result = bytes.Read(small);
+  ASSERT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(std::memcmp(result.value().data(), "Hell", 4), 0);
+
+  // The rest of the field is skipped.
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 7u);
+}
+
+TEST(StreamDecoder, BytesReader_ReadsOnlyField) {
+  OneByteReader reader(std::as_bytes(std::span(kEncodedProto)));
+  StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok() && decoder.FieldNumber() != 6u) {
+  }
+  ASSERT_EQ(decoder.FieldNumber(), 6u);
+
+  StreamDecoder::BytesReader bytes = decoder.GetBytesReader();
+  std::array<char, 32> buffer{};
+  size_t total = 0;
+  while (true) {
+    Result<ByteSpan> result =
+        bytes.Read(std::as_writable_bytes(std::span(buffer)).subspan(total));
+    if (!result.ok()) {
+      EXPECT_EQ(result.status(), Status::OutOfRange());
+      break;
+    }
+    total += result.value().size();
+  }
+  EXPECT_EQ(std::string_view(buffer.data(), total), "Hello world");
+  EXPECT_EQ(bytes.ConservativeReadLimit(), 0u);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.FieldNumber(), 7u);
+}
+
+TEST(StreamDecoder, NestedMessage) {
+  // clang-format off
+  constexpr uint8_t encoded[] = {
+    // type=uint32, k=1, v=1
+    0x08, 0x01,
+    // type=message, k=2, len=7
+    0x12, 0x07,
+      // type=uint32, k=1, v=300
+      0x08, 0xac, 0x02,
+      // type=bytes, k=2, v="hi"
+      0x12, 0x02, 'h', 'i',
+    // type=uint32, k=3, v=3
+    0x18, 0x03,
+  };
+  // clang-format on
+
+  OneByteReader reader(std::as_bytes(std::span(encoded)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 2u);
+  {
+    StreamDecoder::BytesReader bytes = decoder.GetBytesReader();
+    StreamDecoder nested(bytes, bytes.field_size());
+
+    ASSERT_EQ(nested.Next(), OkStatus());
+    ASSERT_EQ(nested.FieldNumber(), 1u);
+    uint32_t value = 0;
+    EXPECT_EQ(nested.ReadUint32(&value), OkStatus());
+    EXPECT_EQ(value, 300u);
+
+    ASSERT_EQ(nested.Next(), OkStatus());
+    ASSERT_EQ(nested.FieldNumber(), 2u);
+    // Leave the bytes field unread.
+    EXPECT_EQ(nested.Next(), Status::OutOfRange());
+  }
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 3u);
+  uint32_t value = 0;
+  EXPECT_EQ(decoder.ReadUint32(&value), OkStatus());
+  EXPECT_EQ(value, 3u);
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, PackedFields) {
+  // clang-format off
+  constexpr uint8_t encoded[] = {
+    // type=repeated uint32, k=1, v={0, 50, 100, 150, 200}
+    0x0a, 0x07, 0x00, 0x32, 0x64, 0x96, 0x01, 0xc8, 0x01,
+    // type=repeated sint32, k=2, v={-1, 1}
+    0x12, 0x02, 0x01, 0x02,
+    // type=repeated fixed32, k=3, v={1, 2}
+    0x1a, 0x08, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+    // type=uint32, k=4, v=4
+    0x20, 0x04,
+  };
+  // clang-format on
+
+  OneByteReader reader(std::as_bytes(std::span(encoded)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  std::array<uint32_t, 8> uint32s{};
+  StatusWithSize sws = decoder.ReadPackedUint32(uint32s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 5u);
+  EXPECT_EQ(uint32s[0], 0u);
+  EXPECT_EQ(uint32s[3], 150u);
+  EXPECT_EQ(uint32s[4], 200u);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  std::array<int32_t, 2> sint32s{};
+  sws = decoder.ReadPackedSint32(sint32s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  EXPECT_EQ(sint32s[0], -1);
+  EXPECT_EQ(sint32s[1], 1);
+
+  // Only one value fits; the rest of the field is skipped by Next().
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  std::array<uint32_t, 1> fixed32s{};
+  sws = decoder.ReadPackedFixed32(fixed32s);
+  EXPECT_EQ(sws.status(), Status::ResourceExhausted());
+  EXPECT_EQ(sws.size(), 1u);
+  EXPECT_EQ(fixed32s[0], 1u);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), 4u);
+  uint32_t value = 0;
+  EXPECT_EQ(decoder.ReadUint32(&value), OkStatus());
+  EXPECT_EQ(value, 4u);
+}
+
+TEST(StreamDecoder, TruncatedField_DataLoss) {
+  // type=string, k=1, len=5, but only 2 bytes follow.
+  constexpr uint8_t encoded[] = {0x0a, 0x05, 'h', 'i'};
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded)));
+  StreamDecoder decoder(reader);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+}
+
+TEST(StreamDecoder, FieldPastKnownLength_DataLoss) {
+  stream::MemoryReader reader(std::as_bytes(std::span(kEncodedProto)));
+  // The message ends in the middle of the double field.
+  StreamDecoder decoder(reader, 10);
+
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+}
+
+TEST(StreamDecoder, InvalidFieldNumber_DataLoss) {
+  // Field number 0 is not valid.
+  constexpr uint8_t encoded[] = {0x00, 0x01};
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded)));
+  StreamDecoder decoder(reader);
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+}
+
+}  // namespace
+}  // namespace pw::protobuf
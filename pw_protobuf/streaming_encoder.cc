@@ -36,9 +36,12 @@ StreamingEncoder StreamingEncoder::GetNestedEncoder(uint32_t field_number) {
   // as their scratch buffer.
   size_t key_size =
       varint::EncodedSize(MakeKey(field_number, WireType::kDelimited));
-  size_t reserved_size = key_size + config::kMaxVarintSize;
+  // Nested encoders that write directly do not write to their scratch buffer,
+  // so the submessage's key and size need not be reserved in it.
+  size_t reserved_size =
+      writes_directly() ? 0 : key_size + config::kMaxVarintSize;
   size_t max_size = std::min(memory_writer_.ConservativeWriteLimit(),
-                             writer_.ConservativeWriteLimit());
+                             WriteLimit());
   // Account for reserved bytes.
   max_size = max_size > reserved_size ? max_size - reserved_size : 0;
   // Cap based on max varint size.
@@ -47,15 +50,43 @@ StreamingEncoder StreamingEncoder::GetNestedEncoder(uint32_t field_number) {
 
   ByteSpan nested_buffer;
   if (max_size > 0) {
-    nested_buffer = ByteSpan(
-        memory_writer_.data() + reserved_size + memory_writer_.bytes_written(),
-        max_size);
+    nested_buffer = UnusedScratchBuffer(reserved_size).first(max_size);
   } else {
     nested_buffer = ByteSpan();
   }
   return StreamingEncoder(*this, nested_buffer);
 }
 
+StreamingEncoder StreamingEncoder::GetNestedEncoder(uint32_t field_number,
+                                                    size_t size) {
+  PW_CHECK(!nested_encoder_open());
+
+  // Write the submessage's key and size now, so the nested encoder can write
+  // the submessage itself directly to the writer.
+  if (UpdateStatusForWrite(field_number, WireType::kDelimited, size).ok()) {
+    WriteVarint(MakeKey(field_number, WireType::kDelimited));
+    WriteVarint(size);
+  }
+  nested_field_number_ = field_number;
+
+  // If this encoder writes to its scratch buffer, the submessage is written
+  // there as well, so nested encoders of the submessage use the space after
+  // it. Otherwise, they may use all of the unused scratch buffer.
+  const bool writes_to_scratch = &writer_ == &memory_writer_;
+  return StreamingEncoder(
+      *this, UnusedScratchBuffer(writes_to_scratch ? size : 0), size);
+}
+
+ByteSpan StreamingEncoder::UnusedScratchBuffer(size_t reserved_size) {
+  const size_t offset = memory_writer_.bytes_written() + reserved_size;
+  const size_t unused = memory_writer_.bytes_written() +
+                        memory_writer_.ConservativeWriteLimit();
+  if (offset >= unused) {
+    return ByteSpan();
+  }
+  return ByteSpan(memory_writer_.data() + offset, unused - offset);
+}
+
 Status StreamingEncoder::Finalize() {
   // If an encoder has no parent, finalize is a no-op.
   if (parent_ == nullptr) {
@@ -96,6 +127,15 @@ Status StreamingEncoder::FinalizeNestedMessage(StreamingEncoder& nested) {
   status_.Update(nested.status_);
   PW_TRY(status_);
 
+  // A submessage of a known size has already been written to the writer, but
+  // it is only valid if it is exactly the size that was written before it.
+  if (&nested.writer_ != &nested.memory_writer_) {
+    if (nested.bytes_remaining_ != 0u) {
+      status_ = Status::DataLoss();
+    }
+    return status_;
+  }
+
   if (varint::EncodedSize(nested.memory_writer_.bytes_written()) >
       config::kMaxVarintSize) {
     status_ = Status::OutOfRange();
@@ -175,18 +215,21 @@ Status StreamingEncoder::WritePackedFixed(uint32_t field_number,
   PW_TRY(UpdateStatusForWrite(
       field_number, WireType::kDelimited, values.size_bytes()));
   WriteVarint(MakeKey(field_number, WireType::kDelimited));
-  WriteVarint(values.size_bytes());
+  PW_TRY(WriteVarint(values.size_bytes()));
+
+  // On little-endian targets, the values are already in wire format, so they
+  // are written with a single write.
+  if (std::endian::native == std::endian::little) {
+    status_.Update(writer_.Write(values));
+    return status_;
+  }
 
   for (auto val_start = values.begin(); val_start != values.end();
        val_start += elem_size) {
     // Allocates 8 bytes so both 4-byte and 8-byte types can be encoded as
     // little-endian for serialization.
     std::array<std::byte, sizeof(uint64_t)> data;
-    if (std::endian::native == std::endian::little) {
-      std::copy(val_start, val_start + elem_size, std::begin(data));
-    } else {
-      std::reverse_copy(val_start, val_start + elem_size, std::begin(data));
-    }
+    std::reverse_copy(val_start, val_start + elem_size, std::begin(data));
     status_.Update(writer_.Write(std::span(data).first(elem_size)));
     PW_TRY(status_);
   }
@@ -211,8 +254,13 @@ Status StreamingEncoder::UpdateStatusForWrite(uint32_t field_number,
   }
   size += data_size;
 
-  if (size > writer_.ConservativeWriteLimit()) {
+  if (size > WriteLimit()) {
     status_ = Status::ResourceExhausted();
+    return status_;
+  }
+
+  if (writes_directly()) {
+    bytes_remaining_ -= size;
   }
   return status_;
 }
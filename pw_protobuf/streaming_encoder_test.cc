@@ -14,10 +14,13 @@
 
 #include "pw_protobuf/streaming_encoder.h"
 
+#include <array>
 #include <span>
 
 #include "gtest/gtest.h"
 #include "pw_bytes/span.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/serialized_size.h"
 #include "pw_stream/memory_stream.h"
 
 namespace pw::protobuf {
@@ -247,6 +250,145 @@ TEST(StreamingEncoder, Nested) {
             0);
 }
 
+TEST(StreamingEncoder, NestedWithKnownSize_NoScratchBuffer) {
+  std::byte dest_buffer[64];
+  MemoryWriter writer(dest_buffer);
+  StreamingEncoder encoder(writer, ByteSpan());
+
+  constexpr size_t kPairSize =
+      SizeOfDelimitedField(kDoubleNestedProtoKeyField, 7) +
+      SizeOfDelimitedField(kDoubleNestedProtoValueField, 5);
+  constexpr size_t kNestedSize =
+      SizeOfDelimitedField(kNestedProtoHelloField, 5) +
+      SizeOfDelimitedField(kNestedProtoPairField, kPairSize) +
+      SizeOfVarintField(kNestedProtoIdField, 999);
+
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 42), OkStatus());
+
+  {
+    StreamingEncoder nested_proto =
+        encoder.GetNestedEncoder(kTestProtoNestedField, kNestedSize);
+    EXPECT_EQ(nested_proto.WriteString(kNestedProtoHelloField, "world"),
+              OkStatus());
+
+    {
+      StreamingEncoder double_nested_proto =
+          nested_proto.GetNestedEncoder(kNestedProtoPairField, kPairSize);
+      EXPECT_EQ(double_nested_proto.WriteString(kDoubleNestedProtoKeyField,
+                                                "version"),
+                OkStatus());
+      EXPECT_EQ(double_nested_proto.WriteString(kDoubleNestedProtoValueField,
+                                                "2.9.1"),
+                OkStatus());
+      EXPECT_EQ(double_nested_proto.ConservativeWriteLimit(), 0u);
+    }
+
+    EXPECT_EQ(nested_proto.WriteUint32(kNestedProtoIdField, 999), OkStatus());
+    EXPECT_EQ(nested_proto.Finalize(), OkStatus());
+  }
+
+  EXPECT_EQ(encoder.WriteSint32(kTestProtoZiggyField, -13), OkStatus());
+
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // magic_number
+    0x08, 0x2a,
+    // nested header (key, size)
+    0x32, 0x1c,
+    // nested.hello
+    0x0a, 0x05, 'w', 'o', 'r', 'l', 'd',
+    // nested.pair[0] header (key, size)
+    0x1a, 0x10,
+    // nested.pair[0].key
+    0x0a, 0x07, 'v', 'e', 'r', 's', 'i', 'o', 'n',
+    // nested.pair[0].value
+    0x12, 0x05, '2', '.', '9', '.', '1',
+    // nested.id
+    0x10, 0xe7, 0x07,
+    // ziggy
+    0x10, 0x19
+  };
+  // clang-format on
+
+  ASSERT_EQ(encoder.status(), OkStatus());
+  ConstByteSpan result = ConstByteSpan(writer.data(), writer.bytes_written());
+  EXPECT_EQ(result.size(), sizeof(encoded_proto));
+  EXPECT_EQ(std::memcmp(result.data(), encoded_proto, sizeof(encoded_proto)),
+            0);
+}
+
+TEST(StreamingEncoder, NestedWithKnownSize_MixedWithScratchBuffer) {
+  std::byte encode_buffer[64];
+  MemoryEncoder encoder(encode_buffer);
+
+  constexpr size_t kPairSize =
+      SizeOfDelimitedField(kDoubleNestedProtoKeyField, 1);
+  constexpr size_t kNestedSize =
+      SizeOfVarintField(kNestedProtoIdField, 1) +
+      SizeOfDelimitedField(kNestedProtoPairField, kPairSize);
+
+  {
+    // A known-size submessage written directly to the MemoryEncoder's buffer.
+    StreamingEncoder nested_proto =
+        encoder.GetNestedEncoder(kTestProtoNestedField, kNestedSize);
+    EXPECT_EQ(nested_proto.WriteUint32(kNestedProtoIdField, 1), OkStatus());
+
+    // A submessage of unknown size staged in the unused part of the buffer.
+    StreamingEncoder double_nested_proto =
+        nested_proto.GetNestedEncoder(kNestedProtoPairField);
+    EXPECT_EQ(
+        double_nested_proto.WriteString(kDoubleNestedProtoKeyField, "k"),
+        OkStatus());
+    EXPECT_EQ(double_nested_proto.Finalize(), OkStatus());
+  }
+  EXPECT_EQ(encoder.WriteUint32(kTestProtoMagicNumberField, 42), OkStatus());
+
+  constexpr uint8_t encoded_proto[] = {
+      0x32, 0x07, 0x10, 0x01, 0x1a, 0x03, 0x0a, 0x01, 'k', 0x08, 0x2a};
+
+  ASSERT_EQ(encoder.status(), OkStatus());
+  EXPECT_EQ(encoder.size(), sizeof(encoded_proto));
+  EXPECT_EQ(std::memcmp(encoder.data(), encoded_proto, sizeof(encoded_proto)),
+            0);
+}
+
+TEST(StreamingEncoder, NestedWithKnownSize_TooFewBytes) {
+  std::byte dest_buffer[32];
+  MemoryWriter writer(dest_buffer);
+  StreamingEncoder encoder(writer, ByteSpan());
+  {
+    StreamingEncoder child = encoder.GetNestedEncoder(kTestProtoNestedField, 4);
+    ASSERT_EQ(child.WriteUint32(kNestedProtoIdField, 1), OkStatus());
+  }
+  EXPECT_EQ(encoder.status(), Status::DataLoss());
+}
+
+TEST(StreamingEncoder, NestedWithKnownSize_TooManyBytes) {
+  std::byte dest_buffer[32];
+  MemoryWriter writer(dest_buffer);
+  StreamingEncoder encoder(writer, ByteSpan());
+  {
+    StreamingEncoder child = encoder.GetNestedEncoder(kTestProtoNestedField, 2);
+    ASSERT_EQ(child.WriteUint32(kNestedProtoIdField, 1), OkStatus());
+    EXPECT_EQ(child.WriteUint32(kNestedProtoIdField, 1),
+              Status::ResourceExhausted());
+  }
+  EXPECT_EQ(encoder.status(), Status::ResourceExhausted());
+}
+
+TEST(StreamingEncoder, NestedWithKnownSize_DoesNotFit) {
+  std::byte dest_buffer[8];
+  MemoryWriter writer(dest_buffer);
+  StreamingEncoder encoder(writer, ByteSpan());
+  {
+    StreamingEncoder child =
+        encoder.GetNestedEncoder(kTestProtoNestedField, 16);
+    EXPECT_EQ(child.status(), Status::ResourceExhausted());
+  }
+  EXPECT_EQ(encoder.status(), Status::ResourceExhausted());
+  EXPECT_EQ(writer.bytes_written(), 0u);
+}
+
 TEST(StreamingEncoder, RepeatedField) {
   std::byte encode_buffer[32];
   MemoryEncoder encoder(encode_buffer);
@@ -338,6 +480,50 @@ TEST(StreamingEncoder, PackedZigzag) {
             0);
 }
 
+TEST(StreamingEncoder, PackedVarint_ManyValues) {
+  // Enough values to fill the encoder's packed varint buffer several times.
+  std::array<uint32_t, 100> values;
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = i * 3;
+  }
+
+  std::byte encode_buffer[256];
+  MemoryEncoder encoder(encode_buffer);
+  encoder.WritePackedUint32(1, values);
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  ConstByteSpan result_bytes(encoder);
+  Decoder decoder(result_bytes);
+  std::array<uint32_t, 100> decoded;
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedUint32(decoded);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), values.size());
+  EXPECT_EQ(decoded, values);
+}
+
+TEST(StreamingEncoder, PackedZigzag_ManyValues) {
+  std::array<int64_t, 100> values;
+  for (size_t i = 0; i < values.size(); ++i) {
+    const int64_t magnitude = static_cast<int64_t>(uint64_t(i) << (i % 50));
+    values[i] = i % 2 == 0 ? -magnitude : magnitude;
+  }
+
+  std::byte encode_buffer[1024];
+  MemoryEncoder encoder(encode_buffer);
+  encoder.WritePackedSint64(1, values);
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  ConstByteSpan result_bytes(encoder);
+  Decoder decoder(result_bytes);
+  std::array<int64_t, 100> decoded;
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize result = decoder.ReadPackedSint64(decoded);
+  ASSERT_EQ(result.status(), OkStatus());
+  ASSERT_EQ(result.size(), values.size());
+  EXPECT_EQ(decoded, values);
+}
+
 TEST(StreamingEncoder, ParentUnavailable) {
   std::byte encode_buffer[32];
   MemoryEncoder parent(encode_buffer);
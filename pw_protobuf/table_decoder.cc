@@ -0,0 +1,223 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/table_decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+#include "pw_protobuf/serialized_size.h"
+#include "pw_varint/varint.h"
+
+namespace pw::protobuf {
+namespace {
+
+// Returns the field with the given number, or null if the table does not have
+// one. Fields are usually encoded in order, so the entry after the previously
+// found field is checked before searching the table.
+const MessageField* FindField(MessageFields fields,
+                              size_t& next,
+                              uint32_t field_number) {
+  if (next < fields.size() && fields[next].field_number == field_number) {
+    return &fields[next++];
+  }
+
+  const auto field = std::lower_bound(
+      fields.begin(),
+      fields.end(),
+      field_number,
+      [](const MessageField& entry, uint32_t number) {
+        return entry.field_number < number;
+      });
+
+  if (field == fields.end() || field->field_number != field_number) {
+    return nullptr;
+  }
+
+  next = (field - fields.begin()) + 1;
+  return &*field;
+}
+
+template <typename T>
+void Store(std::byte* member, T value) {
+  std::memcpy(member, &value, sizeof(value));
+}
+
+template <typename T>
+T Load(const std::byte* member) {
+  T value;
+  std::memcpy(&value, member, sizeof(value));
+  return value;
+}
+
+// Returns the encoded size of a field, including its key.
+size_t FieldSize(const MessageField& field, const std::byte* member) {
+  const uint32_t number = field.field_number;
+  switch (field.kind) {
+    case FieldKind::kInt32:
+      return SizeOfVarintField(
+          number, static_cast<uint64_t>(int64_t{Load<int32_t>(member)}));
+    case FieldKind::kUint32:
+      return SizeOfVarintField(number, Load<uint32_t>(member));
+    case FieldKind::kSint32:
+      return SizeOfZigZagField(number, Load<int32_t>(member));
+    case FieldKind::kUint64:
+      return SizeOfVarintField(number, Load<uint64_t>(member));
+    case FieldKind::kSint64:
+      return SizeOfZigZagField(number, Load<int64_t>(member));
+    case FieldKind::kBool:
+      return SizeOfVarintField(number, 1);
+    case FieldKind::kFixed32:
+      return SizeOfFixed32Field(number);
+    case FieldKind::kFixed64:
+      return SizeOfFixed64Field(number);
+    case FieldKind::kString:
+      return SizeOfDelimitedField(number,
+                                  Load<std::string_view>(member).size());
+    case FieldKind::kBytes:
+      return SizeOfDelimitedField(
+          number, Load<std::span<const std::byte>>(member).size());
+    case FieldKind::kMessage:
+      return SizeOfDelimitedField(
+          number, EncodedMessageSize(*field.nested_fields, member));
+  }
+  return 0;
+}
+
+// Stores a field's value in its struct member. Varint values are passed in
+// `value`; all other values are passed in `data`.
+Status StoreField(const MessageField& field,
+                  uint64_t value,
+                  std::span<const std::byte> data,
+                  std::byte* member) {
+  switch (field.kind) {
+    case FieldKind::kInt32:
+      Store(member, static_cast<int32_t>(value));
+      break;
+    case FieldKind::kUint32:
+      Store(member, static_cast<uint32_t>(value));
+      break;
+    case FieldKind::kSint32:
+      Store(member, static_cast<int32_t>(varint::ZigZagDecode(value)));
+      break;
+    case FieldKind::kUint64:
+      Store(member, value);
+      break;
+    case FieldKind::kSint64:
+      Store(member, varint::ZigZagDecode(value));
+      break;
+    case FieldKind::kBool:
+      Store(member, value != 0u);
+      break;
+    case FieldKind::kFixed32:
+    case FieldKind::kFixed64:
+      std::memcpy(member, data.data(), data.size());
+      break;
+    case FieldKind::kString:
+      Store(member,
+            std::string_view(reinterpret_cast<const char*>(data.data()),
+                             data.size()));
+      break;
+    case FieldKind::kBytes:
+      Store(member, data);
+      break;
+    case FieldKind::kMessage:
+      return DecodeMessage(data, *field.nested_fields, member);
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status DecodeMessage(std::span<const std::byte> proto,
+                     MessageFields fields,
+                     void* message) {
+  std::byte* const base = static_cast<std::byte*>(message);
+  size_t next = 0;
+
+  while (!proto.empty()) {
+    uint64_t key;
+    size_t bytes = varint::Decode(proto, &key);
+    if (bytes == 0 || (key >> kFieldNumberShift) > kMaxFieldNumber) {
+      return Status::DataLoss();
+    }
+    proto = proto.subspan(bytes);
+
+    const uint32_t field_number = key >> kFieldNumberShift;
+    const WireType wire_type = static_cast<WireType>(key & kWireTypeMask);
+
+    uint64_t value = 0;
+    std::span<const std::byte> data;
+
+    switch (wire_type) {
+      case WireType::kVarint:
+        bytes = varint::Decode(proto, &value);
+        if (bytes == 0) {
+          return Status::DataLoss();
+        }
+        break;
+
+      case WireType::kDelimited:
+        bytes = varint::Decode(proto, &value);
+        if (bytes == 0 || proto.size() - bytes < value) {
+          return Status::DataLoss();
+        }
+        data = proto.subspan(bytes, value);
+        bytes += value;
+        break;
+
+      case WireType::kFixed32:
+      case WireType::kFixed64:
+        bytes = wire_type == WireType::kFixed32 ? sizeof(uint32_t)
+                                                : sizeof(uint64_t);
+        if (proto.size() < bytes) {
+          return Status::DataLoss();
+        }
+        data = proto.first(bytes);
+        break;
+
+      default:
+        return Status::DataLoss();
+    }
+    proto = proto.subspan(bytes);
+
+    const MessageField* field = FindField(fields, next, field_number);
+    if (field == nullptr) {
+      continue;  // Skip fields that are not in the struct.
+    }
+
+    if (WireTypeFor(field->kind) != wire_type) {
+      return Status::DataLoss();
+    }
+
+    if (Status status = StoreField(*field, value, data, base + field->offset);
+        !status.ok()) {
+      return status;
+    }
+  }
+
+  return OkStatus();
+}
+
+size_t EncodedMessageSize(MessageFields fields, const void* message) {
+  const std::byte* const base = static_cast<const std::byte*>(message);
+  size_t size = 0;
+  for (const MessageField& field : fields) {
+    size += FieldSize(field, base + field.offset);
+  }
+  return size;
+}
+
+}  // namespace pw::protobuf
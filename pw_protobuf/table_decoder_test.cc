@@ -0,0 +1,231 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_protobuf/table_decoder.h"
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_preprocessor/compiler.h"
+
+namespace pw::protobuf {
+namespace {
+
+// std::span is not standard-layout in all implementations.
+PW_MODIFY_DIAGNOSTICS_PUSH();
+PW_MODIFY_DIAGNOSTIC(ignored, "-Winvalid-offsetof");
+
+struct Inner {
+  uint32_t id = 0;
+  std::string_view name;
+};
+
+constexpr MessageField kInnerFieldArray[] = {
+    {1, offsetof(Inner, id), FieldKind::kUint32, nullptr},
+    {2, offsetof(Inner, name), FieldKind::kString, nullptr},
+};
+constexpr MessageFields kInnerFields(kInnerFieldArray);
+
+struct Outer {
+  int32_t int32 = 0;
+  uint32_t uint32 = 0;
+  int32_t sint32 = 0;
+  int64_t int64 = 0;
+  int64_t sint64 = 0;
+  bool boolean = false;
+  float fixed32 = 0;
+  double fixed64 = 0;
+  std::span<const std::byte> bytes;
+  Inner inner;
+};
+
+constexpr MessageField kOuterFieldArray[] = {
+    {1, offsetof(Outer, int32), FieldKind::kInt32, nullptr},
+    {2, offsetof(Outer, uint32), FieldKind::kUint32, nullptr},
+    {3, offsetof(Outer, sint32), FieldKind::kSint32, nullptr},
+    {4, offsetof(Outer, int64), FieldKind::kUint64, nullptr},
+    {5, offsetof(Outer, sint64), FieldKind::kSint64, nullptr},
+    {6, offsetof(Outer, boolean), FieldKind::kBool, nullptr},
+    {7, offsetof(Outer, fixed32), FieldKind::kFixed32, nullptr},
+    {8, offsetof(Outer, fixed64), FieldKind::kFixed64, nullptr},
+    {9, offsetof(Outer, bytes), FieldKind::kBytes, nullptr},
+    {20, offsetof(Outer, inner), FieldKind::kMessage, &kInnerFields},
+};
+constexpr MessageFields kOuterFields(kOuterFieldArray);
+
+PW_MODIFY_DIAGNOSTICS_POP();
+
+template <size_t kSize>
+std::span<const std::byte> AsBytes(const uint8_t (&data)[kSize]) {
+  return std::as_bytes(std::span(data));
+}
+
+TEST(TableDecoder, AllKinds) {
+  // clang-format off
+  constexpr uint8_t proto[] = {
+    // int32 = -2, encoded as a 10-byte varint
+    0x08, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+    // uint32 = 300
+    0x10, 0xac, 0x02,
+    // sint32 = -3
+    0x18, 0x05,
+    // int64 = -1
+    0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+    // sint64 = -1000000000000
+    0x28, 0xff, 0xbf, 0xa8, 0xca, 0x9a, 0x3a,
+    // boolean = true
+    0x30, 0x01,
+    // fixed32 = 1.5f
+    0x3d, 0x00, 0x00, 0xc0, 0x3f,
+    // fixed64 = -2.25
+    0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xc0,
+    // bytes = {0xde, 0xad}
+    0x4a, 0x02, 0xde, 0xad,
+    // inner = {id: 7, name: "hi"}
+    0xa2, 0x01, 0x06, 0x08, 0x07, 0x12, 0x02, 'h', 'i',
+  };
+  // clang-format on
+
+  Outer outer;
+  ASSERT_EQ(DecodeMessage(AsBytes(proto), kOuterFields, &outer), OkStatus());
+
+  EXPECT_EQ(outer.int32, -2);
+  EXPECT_EQ(outer.uint32, 300u);
+  EXPECT_EQ(outer.sint32, -3);
+  EXPECT_EQ(outer.int64, -1);
+  EXPECT_EQ(outer.sint64, -1000000000000);
+  EXPECT_TRUE(outer.boolean);
+  EXPECT_EQ(outer.fixed32, 1.5f);
+  EXPECT_EQ(outer.fixed64, -2.25);
+  ASSERT_EQ(outer.bytes.size(), 2u);
+  EXPECT_EQ(outer.bytes[0], std::byte{0xde});
+  EXPECT_EQ(outer.bytes[1], std::byte{0xad});
+  EXPECT_EQ(outer.inner.id, 7u);
+  EXPECT_EQ(outer.inner.name, "hi");
+}
+
+TEST(TableDecoder, EncodedMessageSize_MatchesEncodedData) {
+  // Each field appears once, so the struct encodes to the same size.
+  // clang-format off
+  constexpr uint8_t proto[] = {
+    0x08, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+    0x10, 0xac, 0x02,
+    0x18, 0x05,
+    0x20, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01,
+    0x28, 0xff, 0xbf, 0xa8, 0xca, 0x9a, 0x3a,
+    0x30, 0x01,
+    0x3d, 0x00, 0x00, 0xc0, 0x3f,
+    0x41, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xc0,
+    0x4a, 0x02, 0xde, 0xad,
+    0xa2, 0x01, 0x06, 0x08, 0x07, 0x12, 0x02, 'h', 'i',
+  };
+  // clang-format on
+
+  Outer outer;
+  ASSERT_EQ(DecodeMessage(AsBytes(proto), kOuterFields, &outer), OkStatus());
+  EXPECT_EQ(EncodedMessageSize(kOuterFields, &outer), sizeof(proto));
+}
+
+TEST(TableDecoder, EncodedMessageSize_CountsDefaultValues) {
+  const Outer outer;
+  // Every member is counted, including the inner message's members. Each field
+  // has a 1-byte key, except the inner message, whose key is 2 bytes.
+  constexpr size_t kVarintsAndBool = 6 * 2;
+  constexpr size_t kFixed = (1 + 4) + (1 + 8);
+  constexpr size_t kBytes = 1 + 1;
+  constexpr size_t kInner = 2 + 1 + (2 + 2);
+  EXPECT_EQ(EncodedMessageSize(kOuterFields, &outer),
+            kVarintsAndBool + kFixed + kBytes + kInner);
+}
+
+TEST(TableDecoder, Empty_LeavesMembersUnchanged) {
+  Outer outer;
+  outer.uint32 = 123;
+
+  EXPECT_EQ(DecodeMessage({}, kOuterFields, &outer), OkStatus());
+  EXPECT_EQ(outer.uint32, 123u);
+}
+
+TEST(TableDecoder, OutOfOrderAndRepeatedFields_LastValueWins) {
+  constexpr uint8_t proto[] = {
+      0x10, 0x01, 0x08, 0x02, 0x10, 0x03, 0xa2, 0x01, 0x02, 0x08, 0x01,
+      0xa2, 0x01, 0x04, 0x12, 0x02, 'o', 'k'};
+
+  Outer outer;
+  ASSERT_EQ(DecodeMessage(AsBytes(proto), kOuterFields, &outer), OkStatus());
+
+  EXPECT_EQ(outer.int32, 2);
+  EXPECT_EQ(outer.uint32, 3u);
+
+  // Nested messages are merged.
+  EXPECT_EQ(outer.inner.id, 1u);
+  EXPECT_EQ(outer.inner.name, "ok");
+}
+
+TEST(TableDecoder, UnknownFields_Skipped) {
+  // clang-format off
+  constexpr uint8_t proto[] = {
+    // Unknown varint, fixed64, delimited, and fixed32 fields.
+    0x58, 0x96, 0x01,
+    0x61, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x6a, 0x03, 'a', 'b', 'c',
+    0x75, 0x01, 0x02, 0x03, 0x04,
+    // uint32 = 5
+    0x10, 0x05,
+  };
+  // clang-format on
+
+  Outer outer;
+  ASSERT_EQ(DecodeMessage(AsBytes(proto), kOuterFields, &outer), OkStatus());
+  EXPECT_EQ(outer.uint32, 5u);
+}
+
+TEST(TableDecoder, WrongWireType_DataLoss) {
+  // Field 2 (uint32) encoded as a fixed32.
+  constexpr uint8_t proto[] = {0x15, 0x01, 0x00, 0x00, 0x00};
+
+  Outer outer;
+  EXPECT_EQ(DecodeMessage(AsBytes(proto), kOuterFields, &outer),
+            Status::DataLoss());
+}
+
+TEST(TableDecoder, Truncated_DataLoss) {
+  constexpr uint8_t truncated_varint[] = {0x10, 0x80};
+  constexpr uint8_t truncated_fixed[] = {0x3d, 0x00, 0x00};
+  constexpr uint8_t truncated_delimited[] = {0x4a, 0x05, 0x01};
+  constexpr uint8_t truncated_nested[] = {0xa2, 0x01, 0x02, 0x12, 0x05};
+
+  Outer outer;
+  EXPECT_EQ(DecodeMessage(AsBytes(truncated_varint), kOuterFields, &outer),
+            Status::DataLoss());
+  EXPECT_EQ(DecodeMessage(AsBytes(truncated_fixed), kOuterFields, &outer),
+            Status::DataLoss());
+  EXPECT_EQ(DecodeMessage(AsBytes(truncated_delimited), kOuterFields, &outer),
+            Status::DataLoss());
+  EXPECT_EQ(DecodeMessage(AsBytes(truncated_nested), kOuterFields, &outer),
+            Status::DataLoss());
+}
+
+TEST(TableDecoder, InvalidWireType_DataLoss) {
+  constexpr uint8_t proto[] = {0x0b, 0x00};
+
+  Outer outer;
+  EXPECT_EQ(DecodeMessage(AsBytes(proto), kOuterFields, &outer),
+            Status::DataLoss());
+}
+
+}  // namespace
+}  // namespace pw::protobuf
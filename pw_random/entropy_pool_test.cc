@@ -0,0 +1,104 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_random/entropy_pool.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::random {
+namespace {
+
+TEST(EntropyPool, ExhaustedUntilSeeded) {
+  EntropyPool pool;
+  uint64_t value = 0;
+  StatusWithSize result = pool.GetInt(value);
+  EXPECT_EQ(result.status(), Status::ResourceExhausted());
+  EXPECT_EQ(result.size(), 0u);
+
+  pool.InjectEntropyBits(0x12345678, 32);
+  EXPECT_EQ(pool.GetInt(value).status(), Status::ResourceExhausted());
+  EXPECT_EQ(pool.seed_bits(), 32u);
+
+  pool.InjectEntropyBits(0x9abcdef0, 32);
+  EXPECT_EQ(pool.GetInt(value).status(), OkStatus());
+  EXPECT_EQ(pool.seed_bits(), EntropyPool::kMinSeedBits);
+}
+
+TEST(EntropyPool, SeedsFromSingleBits) {
+  EntropyPool pool;
+  for (size_t i = 0; i < EntropyPool::kMinSeedBits; ++i) {
+    pool.InjectEntropyBits(i % 3 == 0 ? 1 : 0, 1);
+  }
+
+  std::array<std::byte, 20> buffer;
+  StatusWithSize result = pool.Get(buffer);
+  EXPECT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), buffer.size());
+}
+
+TEST(EntropyPool, CreditIsLimitedToAccumulatorSize) {
+  EntropyPool pool;
+  for (int i = 0; i < 3; ++i) {
+    pool.InjectEntropyBits(0xffffffff, 32);
+  }
+  uint64_t value = 0;
+  EXPECT_EQ(pool.GetInt(value).status(), OkStatus());
+  EXPECT_EQ(pool.seed_bits(), EntropyPool::kMinSeedBits);
+}
+
+TEST(EntropyPool, ZeroBitsAreIgnored) {
+  EntropyPool pool;
+  pool.InjectEntropyBits(0xffffffff, 0);
+  uint64_t value = 0;
+  EXPECT_EQ(pool.GetInt(value).status(), Status::ResourceExhausted());
+  EXPECT_EQ(pool.seed_bits(), 0u);
+}
+
+TEST(EntropyPool, DifferentEntropyDifferentOutput) {
+  EntropyPool pool_1;
+  EntropyPool pool_2;
+  pool_1.InjectEntropyBits(1, 32);
+  pool_1.InjectEntropyBits(2, 32);
+  pool_2.InjectEntropyBits(1, 32);
+  pool_2.InjectEntropyBits(3, 32);
+
+  uint64_t first = 0;
+  uint64_t second = 0;
+  EXPECT_EQ(pool_1.GetInt(first).status(), OkStatus());
+  EXPECT_EQ(pool_2.GetInt(second).status(), OkStatus());
+  EXPECT_NE(first, second);
+}
+
+TEST(EntropyPool, LaterEntropyChangesOutput) {
+  EntropyPool pool_1;
+  EntropyPool pool_2;
+  for (EntropyPool* pool : {&pool_1, &pool_2}) {
+    pool->InjectEntropyBits(0xdeadbeef, 32);
+    pool->InjectEntropyBits(0xfeedface, 32);
+  }
+  pool_2.InjectEntropyBits(0x1, 1);
+
+  uint64_t first = 0;
+  uint64_t second = 0;
+  EXPECT_EQ(pool_1.GetInt(first).status(), OkStatus());
+  EXPECT_EQ(pool_2.GetInt(second).status(), OkStatus());
+  EXPECT_NE(first, second);
+}
+
+}  // namespace
+}  // namespace pw::random
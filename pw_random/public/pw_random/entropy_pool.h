@@ -0,0 +1,148 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "pw_bytes/span.h"
+#include "pw_random/random.h"
+#include "pw_status/status_with_size.h"
+
+namespace pw::random {
+
+// EntropyPool collects entropy from a hardware source, such as a true random
+// number generator (TRNG) peripheral, and serves random data from a generator
+// that is reseeded with it. The hardware feeds the pool whenever it has data,
+// typically from its interrupt handler, and Get() never waits on the hardware.
+//
+//   pw::random::EntropyPool entropy_pool;
+//
+//   extern "C" void HASH_RNG_IRQHandler() {
+//     if (RNG->SR & RNG_SR_DRDY) {
+//       entropy_pool.InjectEntropyBits(RNG->DR, 32);
+//     }
+//   }
+//
+// InjectEntropyBits() is lock-free and may be called from an interrupt while
+// another thread calls Get(). Injected bits are collected in a 64-bit
+// accumulator and mixed into the generator state on the next Get(). Get() must
+// not be called from more than one thread at a time.
+//
+// Get() returns RESOURCE_EXHAUSTED until at least kMinSeedBits bits of entropy
+// have been injected. After that, it always succeeds. It stretches the
+// injected entropy with xorshift*, so the output is NOT cryptographically
+// secure.
+class EntropyPool : public RandomGenerator {
+ public:
+  // Bits of entropy to collect before Get() returns data.
+  static constexpr size_t kMinSeedBits = 64;
+
+  constexpr EntropyPool() = default;
+
+  EntropyPool(const EntropyPool&) = delete;
+  EntropyPool& operator=(const EntropyPool&) = delete;
+
+  StatusWithSize Get(ByteSpan dest) final {
+    MixPendingEntropy();
+    if (seed_bits_ < kMinSeedBits) {
+      return StatusWithSize::ResourceExhausted(0);
+    }
+
+    const size_t bytes_written = dest.size_bytes();
+    while (!dest.empty()) {
+      const uint64_t random = Regenerate();
+      const size_t copy_size = std::min(dest.size_bytes(), sizeof(random));
+      std::memcpy(dest.data(), &random, copy_size);
+      dest = dest.subspan(copy_size);
+    }
+    return StatusWithSize(bytes_written);
+  }
+
+  // Safe to call from an interrupt handler.
+  void InjectEntropyBits(uint32_t data, uint_fast8_t num_bits) final {
+    if (num_bits == 0) {
+      return;
+    } else if (num_bits > 32) {
+      num_bits = 32;
+    }
+    const uint32_t entropy =
+        num_bits == 32 ? data : data & ((uint32_t(1) << num_bits) - 1);
+
+    // Fill the two words of the accumulator in turn, 32 bits each, rotating
+    // each word by the number of bits as XorShiftStarRng64 does.
+    const uint32_t position =
+        pending_bits_.fetch_add(num_bits, std::memory_order_relaxed);
+    std::atomic<uint32_t>& word = pending_[(position / 32) % pending_.size()];
+
+    uint32_t value = word.load(std::memory_order_relaxed);
+    while (!word.compare_exchange_weak(value,
+                                       Rotate(value, num_bits) ^ entropy,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  // Bits of entropy credited to the generator so far, up to kMinSeedBits. Only
+  // updated by Get().
+  size_t seed_bits() const { return seed_bits_; }
+
+ private:
+  static constexpr uint32_t Rotate(uint32_t value, uint_fast8_t bits) {
+    return bits == 32 ? value : (value << bits) | (value >> (32 - bits));
+  }
+
+  // Moves collected entropy into the generator state. The bit count is taken
+  // before the words, so bits injected in between are mixed in without being
+  // credited, rather than credited without being mixed in.
+  void MixPendingEntropy() {
+    const uint32_t bits = pending_bits_.exchange(0, std::memory_order_relaxed);
+    if (bits == 0) {
+      return;
+    }
+    const uint64_t entropy =
+        (uint64_t(pending_[1].exchange(0, std::memory_order_relaxed)) << 32) |
+        pending_[0].exchange(0, std::memory_order_relaxed);
+
+    state_ ^= entropy;
+    Regenerate();
+    seed_bits_ = std::min(kMinSeedBits,
+                          seed_bits_ + std::min<size_t>(bits, kPendingBits));
+  }
+
+  // The xorshift* step from XorShiftStarRng64.
+  uint64_t Regenerate() {
+    if (state_ == 0) {
+      state_--;
+    }
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * kMultConst;
+  }
+
+  static constexpr size_t kPendingBits = 64;
+  static constexpr uint64_t kMultConst = 0x2545F4914F6CDD1D;
+
+  std::array<std::atomic<uint32_t>, kPendingBits / 32> pending_{};
+  std::atomic<uint32_t> pending_bits_{0};
+
+  uint64_t state_ = 0;
+  size_t seed_bits_ = 0;
+};
+
+}  // namespace pw::random
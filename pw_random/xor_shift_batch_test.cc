@@ -0,0 +1,98 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_random/xor_shift_batch.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::random {
+namespace {
+
+constexpr uint64_t kSeed = 5;
+
+TEST(XorShiftStarBatchRng64, SameSeedSameOutput) {
+  XorShiftStarBatchRng64 rng_1(kSeed);
+  XorShiftStarBatchRng64 rng_2(kSeed);
+  std::array<std::byte, 100> first;
+  std::array<std::byte, 100> second;
+  EXPECT_EQ(rng_1.Get(first).status(), OkStatus());
+  EXPECT_EQ(rng_2.Get(second).status(), OkStatus());
+  EXPECT_EQ(first, second);
+}
+
+TEST(XorShiftStarBatchRng64, DifferentSeedsDifferentOutput) {
+  XorShiftStarBatchRng64 rng_1(kSeed);
+  XorShiftStarBatchRng64 rng_2(kSeed + 1);
+  uint64_t first = 0;
+  uint64_t second = 0;
+  EXPECT_EQ(rng_1.GetInt(first).status(), OkStatus());
+  EXPECT_EQ(rng_2.GetInt(second).status(), OkStatus());
+  EXPECT_NE(first, second);
+}
+
+TEST(XorShiftStarBatchRng64, LanesProduceDifferentValues) {
+  XorShiftStarBatchRng64 rng(kSeed);
+  std::array<uint64_t, XorShiftStarBatchRng64::kLanes> values;
+  EXPECT_EQ(rng.Get(std::as_writable_bytes(std::span(values))).size(),
+            sizeof(values));
+  for (size_t i = 1; i < values.size(); ++i) {
+    EXPECT_NE(values[0], values[i]);
+  }
+}
+
+TEST(XorShiftStarBatchRng64, FillsPartialBlock) {
+  XorShiftStarBatchRng64 rng(kSeed);
+  std::array<std::byte, 45> buffer{};
+  StatusWithSize result = rng.Get(std::span(buffer).first(43));
+  EXPECT_EQ(result.status(), OkStatus());
+  EXPECT_EQ(result.size(), 43u);
+
+  // The bytes past the requested size are untouched.
+  EXPECT_EQ(buffer[43], std::byte{0});
+  EXPECT_EQ(buffer[44], std::byte{0});
+}
+
+TEST(XorShiftStarBatchRng64, ZeroSeed) {
+  XorShiftStarBatchRng64 rng(0);
+  std::array<uint64_t, 16> values;
+  EXPECT_EQ(rng.Get(std::as_writable_bytes(std::span(values))).status(),
+            OkStatus());
+  for (uint64_t value : values) {
+    EXPECT_NE(value, 0u);
+  }
+}
+
+TEST(XorShiftStarBatchRng64, InjectEntropyBits) {
+  XorShiftStarBatchRng64 rng_1(kSeed);
+  XorShiftStarBatchRng64 rng_2(kSeed);
+  rng_2.InjectEntropyBits(0x1, 1);
+
+  std::array<uint64_t, XorShiftStarBatchRng64::kLanes> first;
+  std::array<uint64_t, XorShiftStarBatchRng64::kLanes> second;
+  rng_1.Get(std::as_writable_bytes(std::span(first)));
+  rng_2.Get(std::as_writable_bytes(std::span(second)));
+
+  // Only the first lane received entropy.
+  EXPECT_NE(first[0], second[0]);
+  for (size_t i = 1; i < first.size(); ++i) {
+    EXPECT_EQ(first[i], second[i]);
+  }
+}
+
+}  // namespace
+}  // namespace pw::random
@@ -0,0 +1,216 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_ring_buffer/fixed_entry_ring_buffer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::ring_buffer {
+namespace {
+
+constexpr size_t kEntrySize = 4;
+using RingBuffer = FixedEntryRingBuffer<kEntrySize>;
+
+std::array<std::byte, kEntrySize> MakeEntry(uint8_t value) {
+  std::array<std::byte, kEntrySize> entry;
+  entry.fill(std::byte(value));
+  return entry;
+}
+
+// Returns the value the entry was made with, or -1 if it is malformed.
+int EntryValue(std::span<const std::byte> entry) {
+  if (entry.size() != kEntrySize) {
+    return -1;
+  }
+  for (std::byte b : entry) {
+    if (b != entry[0]) {
+      return -1;
+    }
+  }
+  return static_cast<int>(entry[0]);
+}
+
+TEST(FixedEntryRingBuffer, SetBuffer) {
+  RingBuffer ring;
+  EXPECT_EQ(Status::FailedPrecondition(), ring.PushBack(MakeEntry(1)));
+
+  std::array<std::byte, kEntrySize - 1> too_small;
+  EXPECT_EQ(Status::InvalidArgument(), ring.SetBuffer(too_small));
+
+  // Bytes after the last whole entry are unused.
+  std::array<std::byte, kEntrySize * 3 + 2> buffer;
+  EXPECT_EQ(OkStatus(), ring.SetBuffer(buffer));
+  EXPECT_EQ(3u, ring.capacity());
+  EXPECT_EQ(kEntrySize, RingBuffer::entry_size_bytes());
+}
+
+TEST(FixedEntryRingBuffer, PushPeekPop) {
+  std::array<std::byte, kEntrySize * 4> buffer;
+  RingBuffer ring;
+  RingBuffer::Reader reader;
+  ASSERT_EQ(OkStatus(), ring.SetBuffer(buffer));
+  ASSERT_EQ(OkStatus(), ring.AttachReader(reader));
+
+  std::span<const std::byte> entry;
+  EXPECT_EQ(Status::OutOfRange(), reader.PeekFront(entry));
+  EXPECT_EQ(Status::OutOfRange(), reader.PopFront());
+
+  for (uint8_t i = 1; i <= 3; ++i) {
+    EXPECT_EQ(OkStatus(), ring.PushBack(MakeEntry(i)));
+  }
+  EXPECT_EQ(3u, reader.EntryCount());
+
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_EQ(OkStatus(), reader.PeekFront(entry));
+    EXPECT_EQ(i, EntryValue(entry));
+    EXPECT_EQ(OkStatus(), reader.PopFront());
+  }
+  EXPECT_EQ(0u, reader.EntryCount());
+}
+
+TEST(FixedEntryRingBuffer, PeekFrontCopy) {
+  std::array<std::byte, kEntrySize * 2> buffer;
+  RingBuffer ring;
+  RingBuffer::Reader reader;
+  ASSERT_EQ(OkStatus(), ring.SetBuffer(buffer));
+  ASSERT_EQ(OkStatus(), ring.AttachReader(reader));
+  ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(7)));
+
+  std::array<std::byte, kEntrySize - 1> too_small;
+  EXPECT_EQ(Status::ResourceExhausted(), reader.PeekFront(too_small));
+
+  std::array<std::byte, kEntrySize + 1> data = {};
+  EXPECT_EQ(OkStatus(), reader.PeekFront(data));
+  EXPECT_EQ(7, EntryValue(std::span(data).first(kEntrySize)));
+}
+
+TEST(FixedEntryRingBuffer, WrongSizeEntry) {
+  std::array<std::byte, kEntrySize * 2> buffer;
+  RingBuffer ring;
+  ASSERT_EQ(OkStatus(), ring.SetBuffer(buffer));
+
+  std::array<std::byte, kEntrySize + 1> too_large = {};
+  EXPECT_EQ(Status::InvalidArgument(), ring.PushBack(too_large));
+  EXPECT_EQ(Status::InvalidArgument(),
+            ring.PushBack(std::span(too_large).first(kEntrySize - 1)));
+}
+
+TEST(FixedEntryRingBuffer, RandomAccess) {
+  std::array<std::byte, kEntrySize * 5> buffer;
+  RingBuffer ring;
+  RingBuffer::Reader reader;
+  ASSERT_EQ(OkStatus(), ring.SetBuffer(buffer));
+  ASSERT_EQ(OkStatus(), ring.AttachReader(reader));
+
+  // Wrap the entries around the end of the buffer.
+  for (uint8_t i = 0; i < 8; ++i) {
+    ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(i)));
+  }
+  ASSERT_EQ(5u, reader.EntryCount());
+  for (size_t i = 0; i < reader.EntryCount(); ++i) {
+    EXPECT_EQ(static_cast<int>(i + 3), EntryValue(reader.entry(i)));
+  }
+
+  EXPECT_EQ(OkStatus(), reader.PopFrontN(2));
+  EXPECT_EQ(5, EntryValue(reader.entry(0)));
+  EXPECT_EQ(7, EntryValue(reader.entry(2)));
+  EXPECT_EQ(Status::OutOfRange(), reader.PopFrontN(4));
+  EXPECT_EQ(OkStatus(), reader.PopFrontN(3));
+  EXPECT_EQ(0u, reader.EntryCount());
+}
+
+TEST(FixedEntryRingBuffer, TryPushBackDoesNotEvict) {
+  std::array<std::byte, kEntrySize * 2> buffer;
+  RingBuffer ring;
+  RingBuffer::Reader reader;
+  ASSERT_EQ(OkStatus(), ring.SetBuffer(buffer));
+  ASSERT_EQ(OkStatus(), ring.AttachReader(reader));
+
+  EXPECT_EQ(OkStatus(), ring.TryPushBack(MakeEntry(1)));
+  EXPECT_EQ(OkStatus(), ring.TryPushBack(MakeEntry(2)));
+  EXPECT_EQ(Status::ResourceExhausted(), ring.TryPushBack(MakeEntry(3)));
+
+  EXPECT_EQ(OkStatus(), reader.PopFront());
+  EXPECT_EQ(OkStatus(), ring.TryPushBack(MakeEntry(3)));
+  EXPECT_EQ(2, EntryValue(reader.entry(0)));
+  EXPECT_EQ(3, EntryValue(reader.entry(1)));
+}
+
+TEST(FixedEntryRingBuffer, MultipleReaders) {
+  std::array<std::byte, kEntrySize * 3> buffer;
+  RingBuffer ring;
+  RingBuffer::Reader fast_reader;
+  RingBuffer::Reader slow_reader;
+  RingBuffer::Reader late_reader;
+  ASSERT_EQ(OkStatus(), ring.SetBuffer(buffer));
+  ASSERT_EQ(OkStatus(), ring.AttachReader(fast_reader));
+  ASSERT_EQ(OkStatus(), ring.AttachReader(slow_reader));
+  EXPECT_EQ(Status::InvalidArgument(), ring.AttachReader(slow_reader));
+
+  ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(1)));
+  ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(2)));
+  EXPECT_EQ(OkStatus(), fast_reader.PopFrontN(2));
+
+  // Readers only see entries pushed after they are attached.
+  ASSERT_EQ(OkStatus(), ring.AttachReader(late_reader));
+  for (uint8_t i = 3; i <= 5; ++i) {
+    ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(i)));
+  }
+
+  // The slow reader was moved forward past the evicted entries; the others
+  // lost nothing.
+  EXPECT_EQ(3u, fast_reader.EntryCount());
+  EXPECT_EQ(3, EntryValue(fast_reader.entry(0)));
+  EXPECT_EQ(3u, slow_reader.EntryCount());
+  EXPECT_EQ(3, EntryValue(slow_reader.entry(0)));
+  EXPECT_EQ(3u, late_reader.EntryCount());
+  EXPECT_EQ(3, EntryValue(late_reader.entry(0)));
+
+  // A reader with a full buffer of unread entries blocks TryPushBack().
+  EXPECT_EQ(OkStatus(), fast_reader.PopFront());
+  EXPECT_EQ(Status::ResourceExhausted(), ring.TryPushBack(MakeEntry(6)));
+
+  EXPECT_EQ(OkStatus(), ring.DetachReader(slow_reader));
+  EXPECT_EQ(Status::InvalidArgument(), ring.DetachReader(slow_reader));
+  EXPECT_EQ(Status::FailedPrecondition(), slow_reader.PopFront());
+  EXPECT_EQ(OkStatus(), ring.DetachReader(late_reader));
+  EXPECT_EQ(OkStatus(), ring.TryPushBack(MakeEntry(6)));
+  EXPECT_EQ(3u, fast_reader.EntryCount());
+  EXPECT_EQ(6, EntryValue(fast_reader.entry(2)));
+}
+
+TEST(FixedEntryRingBuffer, Clear) {
+  std::array<std::byte, kEntrySize * 3> buffer;
+  RingBuffer ring;
+  RingBuffer::Reader reader;
+  ASSERT_EQ(OkStatus(), ring.SetBuffer(buffer));
+  ASSERT_EQ(OkStatus(), ring.AttachReader(reader));
+
+  ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(1)));
+  ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(2)));
+  ring.Clear();
+  EXPECT_EQ(0u, reader.EntryCount());
+
+  ASSERT_EQ(OkStatus(), ring.PushBack(MakeEntry(3)));
+  EXPECT_EQ(1u, reader.EntryCount());
+  EXPECT_EQ(3, EntryValue(reader.entry(0)));
+}
+
+}  // namespace
+}  // namespace pw::ring_buffer
@@ -18,6 +18,7 @@
 #include <cstring>
 
 #include "pw_assert/assert.h"
+#include "pw_status/try.h"
 #include "pw_varint/varint.h"
 
 namespace pw {
@@ -27,9 +28,14 @@ using std::byte;
 using Reader = PrefixedEntryRingBufferMulti::Reader;
 
 void PrefixedEntryRingBufferMulti::Clear() {
-  write_idx_ = 0;
+  // Pending entries are kept, since the data of reserved entries may still be
+  // being written.
+  if (pending_entries_ == 0) {
+    write_idx_ = 0;
+    pending_idx_ = 0;
+  }
   for (Reader& reader : readers_) {
-    reader.read_idx = 0;
+    reader.read_idx = pending_idx_;
     reader.entry_count = 0;
   }
 }
@@ -43,6 +49,9 @@ Status PrefixedEntryRingBufferMulti::SetBuffer(std::span<byte> buffer) {
 
   buffer_ = buffer.data();
   buffer_bytes_ = buffer.size_bytes();
+  pending_bytes_ = 0;
+  pending_entries_ = 0;
+  uncommitted_entries_ = 0;
 
   Clear();
   return OkStatus();
@@ -55,8 +64,9 @@ Status PrefixedEntryRingBufferMulti::AttachReader(Reader& reader) {
   reader.buffer = this;
 
   // Note that a newly attached reader sees the buffer as empty,
-  // and is not privy to entries pushed before being attached.
-  reader.read_idx = write_idx_;
+  // and is not privy to entries pushed before being attached. Pending entries
+  // have not been seen by any reader yet, so the reader starts before them.
+  reader.read_idx = pending_entries_ != 0 ? pending_idx_ : write_idx_;
   reader.entry_count = 0;
   readers_.push_back(reader);
   return OkStatus();
@@ -74,13 +84,62 @@ Status PrefixedEntryRingBufferMulti::DetachReader(Reader& reader) {
 }
 
 Status PrefixedEntryRingBufferMulti::InternalPushBack(
-    std::span<const byte> data,
+    std::span<const std::span<const byte>> entries,
     uint32_t user_preamble_data,
     bool drop_elements_if_needed) {
   if (buffer_ == nullptr) {
     return Status::FailedPrecondition();
   }
-  if (data.size_bytes() == 0) {
+
+  // Prepare a single buffer that can hold both the user preamble and entry
+  // length. The user preamble is the same for every entry, so it is only
+  // encoded once.
+  byte preamble_buf[varint::kMaxVarint32SizeBytes * 2];
+  size_t user_preamble_bytes = 0;
+  if (user_preamble_) {
+    user_preamble_bytes =
+        varint::Encode<uint32_t>(user_preamble_data, preamble_buf);
+  }
+
+  size_t total_write_bytes = 0;
+  for (std::span<const byte> data : entries) {
+    if (data.size_bytes() == 0) {
+      return Status::InvalidArgument();
+    }
+    total_write_bytes += user_preamble_bytes +
+                         varint::EncodedSize(data.size_bytes()) +
+                         data.size_bytes();
+  }
+  if (buffer_bytes_ < total_write_bytes) {
+    return Status::OutOfRange();
+  }
+
+  PW_TRY(MakeSpace(total_write_bytes, drop_elements_if_needed));
+
+  // Write the new entries into the ring buffer.
+  const size_t entry_idx = write_idx_;
+  for (std::span<const byte> data : entries) {
+    size_t length_bytes = varint::Encode<uint32_t>(
+        data.size_bytes(),
+        std::span(preamble_buf).subspan(user_preamble_bytes));
+    RawWrite(std::span(preamble_buf, user_preamble_bytes + length_bytes));
+    RawWrite(data);
+  }
+
+  // Update all readers of the new count, unless the entries have to wait for
+  // reservations ahead of them to be committed.
+  AddPendingEntries(entry_idx, entries.size(), total_write_bytes);
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::ReserveBack(size_t size_bytes,
+                                                 Reservation& reservation_out,
+                                                 uint32_t user_preamble_data) {
+  reservation_out = {};
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (size_bytes == 0) {
     return Status::InvalidArgument();
   }
 
@@ -93,33 +152,90 @@ Status PrefixedEntryRingBufferMulti::InternalPushBack(
         varint::Encode<uint32_t>(user_preamble_data, preamble_buf);
   }
   size_t length_bytes = varint::Encode<uint32_t>(
-      data.size_bytes(), std::span(preamble_buf).subspan(user_preamble_bytes));
-  size_t total_write_bytes =
-      user_preamble_bytes + length_bytes + data.size_bytes();
+      size_bytes, std::span(preamble_buf).subspan(user_preamble_bytes));
+  size_t total_write_bytes = user_preamble_bytes + length_bytes + size_bytes;
   if (buffer_bytes_ < total_write_bytes) {
     return Status::OutOfRange();
   }
 
-  if (drop_elements_if_needed) {
-    // PushBack() case: evict items as needed.
-    // Drop old entries until we have space for the new entry.
-    while (RawAvailableBytes() < total_write_bytes) {
-      InternalPopFrontAll();
+  PW_TRY(MakeSpace(total_write_bytes, true));
+
+  // Write the preamble, then hand out the space for the data, which is split
+  // at the end of the buffer if it wraps.
+  const size_t entry_idx = write_idx_;
+  RawWrite(std::span(preamble_buf, user_preamble_bytes + length_bytes));
+
+  size_t bytes_until_wrap = buffer_bytes_ - write_idx_;
+  size_t first_bytes = std::min(size_bytes, bytes_until_wrap);
+  reservation_out.first = std::span(buffer_ + write_idx_, first_bytes);
+  reservation_out.second = std::span(buffer_, size_bytes - first_bytes);
+  write_idx_ = IncrementIndex(write_idx_, size_bytes);
+
+  uncommitted_entries_++;
+  AddPendingEntries(entry_idx, 1, total_write_bytes);
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::CommitReservation(
+    Reservation& reservation) {
+  if (reservation.size() == 0) {
+    return Status::InvalidArgument();
+  }
+  if (uncommitted_entries_ == 0) {
+    return Status::FailedPrecondition();
+  }
+
+  reservation = {};
+  uncommitted_entries_--;
+  PublishPendingEntries();
+  return OkStatus();
+}
+
+Status PrefixedEntryRingBufferMulti::MakeSpace(size_t total_write_bytes,
+                                               bool drop_elements_if_needed) {
+  if (readers_.size() == 0) {
+    // Without readers, only the pending entries have to be kept.
+    return RawAvailableBytes() < total_write_bytes
+               ? Status::ResourceExhausted()
+               : OkStatus();
+  }
+
+  // The slowest reader is found once. Popping the slowest readers leaves that
+  // reader the slowest, so it is not searched for again for each entry.
+  Reader& slowest_reader = GetSlowestReader();
+  while (RawAvailableBytes(slowest_reader) < total_write_bytes) {
+    // TryPushBack() case: don't evict items. Pending entries have not been
+    // seen by the readers, so they cannot be evicted either.
+    if (!drop_elements_if_needed || slowest_reader.entry_count == 0) {
+      return Status::ResourceExhausted();
     }
-  } else if (RawAvailableBytes() < total_write_bytes) {
-    // TryPushBack() case: don't evict items.
-    return Status::ResourceExhausted();
+    // PushBack() case: drop old entries until we have space for the new
+    // entries.
+    InternalPopFrontAll(slowest_reader);
   }
+  return OkStatus();
+}
 
-  // Write the new entry into the ring buffer.
-  RawWrite(std::span(preamble_buf, user_preamble_bytes + length_bytes));
-  RawWrite(data);
+void PrefixedEntryRingBufferMulti::AddPendingEntries(size_t entry_idx,
+                                                     size_t entry_count,
+                                                     size_t entry_bytes) {
+  if (pending_entries_ == 0) {
+    pending_idx_ = entry_idx;
+  }
+  pending_entries_ += entry_count;
+  pending_bytes_ += entry_bytes;
+  PublishPendingEntries();
+}
 
-  // Update all readers of the new count.
+void PrefixedEntryRingBufferMulti::PublishPendingEntries() {
+  if (uncommitted_entries_ != 0) {
+    return;
+  }
   for (Reader& reader : readers_) {
-    reader.entry_count++;
+    reader.entry_count += pending_entries_;
   }
-  return OkStatus();
+  pending_bytes_ = 0;
+  pending_entries_ = 0;
 }
 
 auto GetOutput(std::span<byte> data_out, size_t* write_index) {
@@ -166,6 +282,27 @@ Status PrefixedEntryRingBufferMulti::InternalRead(
     T read_output,
     bool include_preamble_in_output,
     uint32_t* user_preamble_out) {
+  EntrySpans entry;
+  Status status = InternalPeekFrontSpans(
+      reader, entry, include_preamble_in_output, user_preamble_out);
+  if (!status.ok()) {
+    return status;
+  }
+
+  status = read_output(entry.first);
+
+  // If the entry wrapped, read the remaining bytes.
+  if (status.ok() && !entry.second.empty()) {
+    status = read_output(entry.second);
+  }
+  return status;
+}
+
+Status PrefixedEntryRingBufferMulti::InternalPeekFrontSpans(
+    Reader& reader,
+    EntrySpans& entry_out,
+    bool include_preamble,
+    uint32_t* user_preamble_out) {
   if (buffer_ == nullptr) {
     return Status::FailedPrecondition();
   }
@@ -180,79 +317,67 @@ Status PrefixedEntryRingBufferMulti::InternalRead(
   if (user_preamble_out) {
     *user_preamble_out = info.user_preamble;
   }
-  if (include_preamble_in_output) {
+  if (include_preamble) {
     read_bytes += info.preamble_bytes;
   } else {
     data_read_idx = IncrementIndex(data_read_idx, info.preamble_bytes);
   }
 
-  // Read bytes, stopping at the end of the buffer if this entry wraps.
+  // The entry is split at the end of the buffer if it wraps.
   size_t bytes_until_wrap = buffer_bytes_ - data_read_idx;
-  size_t bytes_to_copy = std::min(read_bytes, bytes_until_wrap);
-  Status status =
-      read_output(std::span(buffer_ + data_read_idx, bytes_to_copy));
-
-  // If the entry wrapped, read the remaining bytes.
-  if (status.ok() && (bytes_to_copy < read_bytes)) {
-    status = read_output(std::span(buffer_, read_bytes - bytes_to_copy));
-  }
-  return status;
+  size_t first_bytes = std::min(read_bytes, bytes_until_wrap);
+  entry_out.first = std::span(buffer_ + data_read_idx, first_bytes);
+  entry_out.second = std::span(buffer_, read_bytes - first_bytes);
+  return OkStatus();
 }
 
-void PrefixedEntryRingBufferMulti::InternalPopFrontAll() {
-  // Forcefully pop all readers. Find the slowest reader, which must have
-  // the highest entry count, then pop all readers that have the same count.
+void PrefixedEntryRingBufferMulti::InternalPopFrontAll(
+    Reader& slowest_reader) {
+  // Forcefully pop all readers. The slowest reader must have the highest entry
+  // count; pop all readers that have the same count.
   //
   // It is expected that InternalPopFrontAll is called only when there is
-  // something to pop from at least one reader. If no readers exist, or all
-  // readers are caught up, this function will assert.
-  size_t entry_count = GetSlowestReader().entry_count;
+  // something to pop from at least one reader. If all readers are caught up,
+  // this function will assert.
+  const size_t entry_count = slowest_reader.entry_count;
   PW_DASSERT(entry_count != 0);
-  // Otherwise, pop the readers that have the largest value.
+
+  // The readers with the largest count are all at the same entry, so its size
+  // is only read once.
+  const size_t read_idx = slowest_reader.read_idx;
+  EntryInfo info = EntryInfoAt(read_idx);
+  const size_t next_read_idx =
+      IncrementIndex(read_idx, info.preamble_bytes + info.data_bytes);
+
   for (Reader& reader : readers_) {
     if (reader.entry_count == entry_count) {
-      reader.PopFront();
+      reader.read_idx = next_read_idx;
+      reader.entry_count--;
     }
   }
 }
 
 Reader& PrefixedEntryRingBufferMulti::GetSlowestReader() {
-  // Readers are guaranteed to be before the writer pointer (the class enforces
-  // this on every read/write operation that forces the write pointer ahead of
-  // an existing reader). To determine the slowest reader, we consider three
-  // scenarios:
+  // Every reader sees the same newest entries, so the reader with the most
+  // entries left to read is the furthest behind the writer. Readers with the
+  // same count are at the same position.
   //
-  // In all below cases, WH is the write-head, and R# are readers, with R1
-  // representing the slowest reader.
-  // [[R1 R2 R3 WH]] => Right-hand writer, slowest reader is left-most reader.
-  // [[WH R1 R2 R3]] => Left-hand writer, slowest reader is left-most reader.
-  // [[R3 WH R1 R2]] => Middle-writer, slowest reader is left-most reader after
-  // writer.
-  //
-  // Formally, choose the left-most reader after the writer (ex.2,3), but if
-  // that doesn't exist, choose the left-most reader before the writer (ex.1).
+  // The read index alone can't identify the slowest reader. A reader at the
+  // write head is either caught up or a full buffer behind, depending on its
+  // entry count.
   PW_DASSERT(readers_.size() > 0);
-  Reader* slowest_reader_after_writer = nullptr;
-  Reader* slowest_reader_before_writer = nullptr;
+  Reader* slowest_reader = &readers_.front();
   for (Reader& reader : readers_) {
-    if (reader.read_idx < write_idx_) {
-      if (!slowest_reader_before_writer ||
-          reader.read_idx < slowest_reader_before_writer->read_idx) {
-        slowest_reader_before_writer = &reader;
-      }
-    } else {
-      if (!slowest_reader_after_writer ||
-          reader.read_idx < slowest_reader_after_writer->read_idx) {
-        slowest_reader_after_writer = &reader;
-      }
+    if (reader.entry_count > slowest_reader->entry_count) {
+      slowest_reader = &reader;
     }
   }
-  return *(slowest_reader_after_writer ? slowest_reader_after_writer
-                                       : slowest_reader_before_writer);
+  return *slowest_reader;
 }
 
 Status PrefixedEntryRingBufferMulti::Dering() {
-  if (buffer_ == nullptr || readers_.size() == 0) {
+  // Reserved entries may be written at any time, so they must not be moved.
+  if (buffer_ == nullptr || readers_.size() == 0 || pending_entries_ != 0) {
     return Status::FailedPrecondition();
   }
 
@@ -305,6 +430,26 @@ Status PrefixedEntryRingBufferMulti::InternalPopFront(Reader& reader) {
   return OkStatus();
 }
 
+Status PrefixedEntryRingBufferMulti::InternalPopFrontN(Reader& reader,
+                                                       size_t count) {
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (reader.entry_count < count) {
+    return Status::OutOfRange();
+  }
+
+  // Advance past all of the entries, then update the reader once.
+  size_t read_idx = reader.read_idx;
+  for (size_t i = 0; i < count; ++i) {
+    EntryInfo info = EntryInfoAt(read_idx);
+    read_idx = IncrementIndex(read_idx, info.preamble_bytes + info.data_bytes);
+  }
+  reader.read_idx = read_idx;
+  reader.entry_count -= count;
+  return OkStatus();
+}
+
 size_t PrefixedEntryRingBufferMulti::InternalFrontEntryDataSizeBytes(
     Reader& reader) {
   if (reader.entry_count == 0) {
@@ -323,7 +468,7 @@ size_t PrefixedEntryRingBufferMulti::InternalFrontEntryTotalSizeBytes(
 }
 
 PrefixedEntryRingBufferMulti::EntryInfo
-PrefixedEntryRingBufferMulti::FrontEntryInfo(Reader& reader) {
+PrefixedEntryRingBufferMulti::EntryInfoAt(size_t read_idx) {
   // Entry headers consists of: (optional prefix byte, varint size, data...)
 
   // If a preamble exists, extract the varint and it's bytes in bytes.
@@ -331,14 +476,14 @@ PrefixedEntryRingBufferMulti::FrontEntryInfo(Reader& reader) {
   uint64_t user_preamble_data = 0;
   byte varint_buf[varint::kMaxVarint32SizeBytes];
   if (user_preamble_) {
-    RawRead(varint_buf, reader.read_idx, varint::kMaxVarint32SizeBytes);
+    RawRead(varint_buf, read_idx, varint::kMaxVarint32SizeBytes);
     user_preamble_bytes = varint::Decode(varint_buf, &user_preamble_data);
     PW_DASSERT(user_preamble_bytes != 0u);
   }
 
   // Read the entry header; extract the varint and it's bytes in bytes.
   RawRead(varint_buf,
-          IncrementIndex(reader.read_idx, user_preamble_bytes),
+          IncrementIndex(read_idx, user_preamble_bytes),
           varint::kMaxVarint32SizeBytes);
   uint64_t entry_bytes;
   size_t length_bytes = varint::Decode(varint_buf, &entry_bytes);
@@ -351,17 +496,21 @@ PrefixedEntryRingBufferMulti::FrontEntryInfo(Reader& reader) {
   return info;
 }
 
-// Comparisons ordered for more probable early exits, assuming the reader is
-// not far behind the writer compared to the size of the ring.
 size_t PrefixedEntryRingBufferMulti::RawAvailableBytes() {
   // Compute slowest reader.
   // TODO: Alternatively, the slowest reader could be actively mantained on
   // every read operation, but reads are more likely than writes.
   if (readers_.size() == 0) {
-    return buffer_bytes_;
+    return buffer_bytes_ - pending_bytes_;
   }
+  return RawAvailableBytes(GetSlowestReader());
+}
 
-  size_t read_idx = GetSlowestReader().read_idx;
+// Comparisons ordered for more probable early exits, assuming the reader is
+// not far behind the writer compared to the size of the ring.
+size_t PrefixedEntryRingBufferMulti::RawAvailableBytes(
+    const Reader& slowest_reader) {
+  size_t read_idx = slowest_reader.read_idx;
   // Case: Not wrapped.
   if (read_idx < write_idx_) {
     return buffer_bytes_ - (write_idx_ - read_idx);
@@ -371,6 +520,9 @@ size_t PrefixedEntryRingBufferMulti::RawAvailableBytes() {
     return read_idx - write_idx_;
   }
   // Case: Matched read and write heads; empty or full.
+  if (pending_bytes_ != 0) {
+    return 0;
+  }
   for (Reader& reader : readers_) {
     if (reader.read_idx == read_idx && reader.entry_count != 0) {
       return 0;
@@ -0,0 +1,290 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file implements a fuzz test for PrefixedEntryRingBufferMulti. The fuzz
+// data is a sequence of operations on a ring buffer with several readers, such
+// as pushing, reserving, peeking, and popping entries. A simple model of each
+// reader's entries is kept alongside the ring buffer, and every entry read from
+// the ring buffer must match the model.
+//
+// The ring buffer may evict the oldest entries to make room for new ones, which
+// the model does not predict. Instead, the model drops entries from the front
+// of each reader's queue to match the reader's entry count after each
+// operation, which checks that only the oldest entries are ever evicted.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "pw_assert/assert.h"
+#include "pw_fuzzer/execution_timer.h"
+#include "pw_fuzzer/fuzzed_data_provider.h"
+#include "pw_ring_buffer/prefixed_entry_ring_buffer.h"
+
+namespace pw::ring_buffer {
+namespace {
+
+constexpr size_t kMaxBufferSize = 256;
+constexpr size_t kMaxReaders = 3;
+constexpr size_t kMaxEntriesPerPush = 3;
+
+enum class Operation : uint8_t {
+  kPushBack,
+  kTryPushBack,
+  kPushBackMany,
+  kReserveAndCommit,
+  kPeekFront,
+  kPopFront,
+  kPopFrontN,
+  kDering,
+  kClear,
+  kMaxValue = kClear,
+};
+
+struct Entry {
+  std::vector<std::byte> data;
+  uint32_t preamble;
+};
+
+using Reader = PrefixedEntryRingBufferMulti::Reader;
+
+class RingBufferModel {
+ public:
+  RingBufferModel(FuzzedDataProvider& provider)
+      : provider_(provider),
+        user_preamble_(provider.ConsumeBool()),
+        ring_(user_preamble_),
+        reader_count_(provider.ConsumeIntegralInRange<size_t>(1, kMaxReaders)) {
+    buffer_size_ = provider.ConsumeIntegralInRange<size_t>(1, buffer_.size());
+    PW_ASSERT(ring_.SetBuffer(std::span(buffer_).first(buffer_size_)).ok());
+    for (size_t i = 0; i < reader_count_; ++i) {
+      PW_ASSERT(ring_.AttachReader(readers_[i]).ok());
+    }
+  }
+
+  void Run(Operation operation) {
+    switch (operation) {
+      case Operation::kPushBack:
+        Push({NextEntry()},
+             /*can_evict=*/true,
+             [this](const std::vector<Entry>& entries) {
+               return ring_.PushBack(entries[0].data, entries[0].preamble);
+             });
+        break;
+      case Operation::kTryPushBack:
+        Push({NextEntry()},
+             /*can_evict=*/false,
+             [this](const std::vector<Entry>& entries) {
+               return ring_.TryPushBack(entries[0].data, entries[0].preamble);
+             });
+        break;
+      case Operation::kPushBackMany:
+        PushMany();
+        break;
+      case Operation::kReserveAndCommit:
+        ReserveAndCommit();
+        break;
+      case Operation::kPeekFront:
+        CheckFront(NextReader());
+        break;
+      case Operation::kPopFront: {
+        const size_t reader = NextReader();
+        if (CheckFront(reader)) {
+          PW_ASSERT(readers_[reader].PopFront().ok());
+          entries_[reader].pop_front();
+        } else {
+          PW_ASSERT(readers_[reader].PopFront().IsOutOfRange());
+        }
+        break;
+      }
+      case Operation::kPopFrontN: {
+        const size_t reader = NextReader();
+        const size_t count = provider_.ConsumeIntegralInRange<size_t>(
+            0, entries_[reader].size());
+        PW_ASSERT(readers_[reader].PopFrontN(count).ok());
+        entries_[reader].erase(entries_[reader].begin(),
+                               entries_[reader].begin() + count);
+        break;
+      }
+      case Operation::kDering:
+        PW_ASSERT(ring_.Dering().ok());
+        break;
+      case Operation::kClear:
+        ring_.Clear();
+        for (std::deque<Entry>& entries : entries_) {
+          entries.clear();
+        }
+        break;
+    }
+    Sync();
+  }
+
+ private:
+  size_t NextReader() {
+    return provider_.ConsumeIntegralInRange<size_t>(0, reader_count_ - 1);
+  }
+
+  Entry NextEntry() {
+    // Occasionally create empty or oversized entries, which are rejected.
+    const size_t size = provider_.ConsumeIntegralInRange<size_t>(
+        0, buffer_size_ + 1);
+    std::vector<uint8_t> data = provider_.ConsumeBytes<uint8_t>(size);
+    Entry entry{std::vector<std::byte>(data.size()), 0};
+    std::memcpy(entry.data.data(), data.data(), data.size());
+    entry.preamble = user_preamble_ ? provider_.ConsumeIntegral<uint32_t>() : 0;
+    return entry;
+  }
+
+  template <typename Function>
+  void Push(const std::vector<Entry>& entries,
+            bool can_evict,
+            Function&& push) {
+    std::array<size_t, kMaxReaders> counts_before;
+    for (size_t i = 0; i < reader_count_; ++i) {
+      counts_before[i] = readers_[i].EntryCount();
+    }
+
+    if (!push(entries).ok()) {
+      // Failed pushes do not change the ring buffer.
+      for (size_t i = 0; i < reader_count_; ++i) {
+        PW_ASSERT(readers_[i].EntryCount() == counts_before[i]);
+      }
+      return;
+    }
+
+    for (size_t i = 0; i < reader_count_; ++i) {
+      if (!can_evict) {
+        PW_ASSERT(readers_[i].EntryCount() ==
+                  counts_before[i] + entries.size());
+      }
+      entries_[i].insert(entries_[i].end(), entries.begin(), entries.end());
+    }
+  }
+
+  void PushMany() {
+    const size_t count =
+        provider_.ConsumeIntegralInRange<size_t>(1, kMaxEntriesPerPush);
+    std::vector<Entry> entries;
+    for (size_t i = 0; i < count; ++i) {
+      entries.push_back(NextEntry());
+      // PushBackMany gives every entry the same preamble.
+      entries.back().preamble = entries.front().preamble;
+    }
+
+    const bool can_evict = provider_.ConsumeBool();
+    Push(
+        entries,
+        can_evict,
+        [this, can_evict](const std::vector<Entry>& entries) {
+          std::array<std::span<const std::byte>, kMaxEntriesPerPush> spans;
+          for (size_t i = 0; i < entries.size(); ++i) {
+            spans[i] = entries[i].data;
+          }
+          const auto data = std::span(spans).first(entries.size());
+          return can_evict
+                     ? ring_.PushBackMany(data, entries[0].preamble)
+                     : ring_.TryPushBackMany(data, entries[0].preamble);
+        });
+  }
+
+  void ReserveAndCommit() {
+    auto reserve_and_commit = [this](const std::vector<Entry>& entries) {
+      const Entry& entry = entries[0];
+      PrefixedEntryRingBufferMulti::Reservation reservation;
+      const Status status =
+          ring_.ReserveBack(entry.data.size(), reservation, entry.preamble);
+      if (!status.ok()) {
+        return status;
+      }
+      PW_ASSERT(reservation.size() == entry.data.size());
+      const auto split = entry.data.begin() + reservation.first.size();
+      std::copy(entry.data.begin(), split, reservation.first.begin());
+      std::copy(split, entry.data.end(), reservation.second.begin());
+      PW_ASSERT(ring_.CommitReservation(reservation).ok());
+      return OkStatus();
+    };
+    Push({NextEntry()}, /*can_evict=*/true, reserve_and_commit);
+  }
+
+  // Checks a reader's front entry against the model. Returns false if the
+  // reader has no entries.
+  bool CheckFront(size_t reader_index) {
+    Reader& reader = readers_[reader_index];
+    if (entries_[reader_index].empty()) {
+      PW_ASSERT(reader.EntryCount() == 0);
+      return false;
+    }
+    const Entry& expected = entries_[reader_index].front();
+    PW_ASSERT(reader.FrontEntryDataSizeBytes() == expected.data.size());
+
+    std::array<std::byte, kMaxBufferSize> data;
+    uint32_t preamble = 0;
+    size_t bytes_read = 0;
+    PW_ASSERT(reader.PeekFrontWithPreamble(data, preamble, bytes_read).ok());
+    PW_ASSERT(bytes_read == expected.data.size());
+    PW_ASSERT(std::memcmp(data.data(), expected.data.data(), bytes_read) == 0);
+    if (user_preamble_) {
+      PW_ASSERT(preamble == expected.preamble);
+    }
+
+    PrefixedEntryRingBufferMulti::EntrySpans spans;
+    PW_ASSERT(reader.PeekFront(spans).ok());
+    PW_ASSERT(spans.size() == expected.data.size());
+    PW_ASSERT(std::memcmp(spans.first.data(),
+                          expected.data.data(),
+                          spans.first.size()) == 0);
+    PW_ASSERT(std::memcmp(spans.second.data(),
+                          expected.data.data() + spans.first.size(),
+                          spans.second.size()) == 0);
+    return true;
+  }
+
+  // Drops evicted entries from the model and checks the entry counts.
+  void Sync() {
+    for (size_t i = 0; i < reader_count_; ++i) {
+      const size_t count = readers_[i].EntryCount();
+      PW_ASSERT(count <= entries_[i].size());
+      entries_[i].erase(entries_[i].begin(), entries_[i].end() - count);
+    }
+    PW_ASSERT(ring_.TotalUsedBytes() <= buffer_size_);
+  }
+
+  FuzzedDataProvider& provider_;
+  const bool user_preamble_;
+  std::array<std::byte, kMaxBufferSize> buffer_;
+  PrefixedEntryRingBufferMulti ring_;
+  std::array<Reader, kMaxReaders> readers_;
+  const size_t reader_count_;
+  size_t buffer_size_;
+  std::array<std::deque<Entry>, kMaxReaders> entries_;
+};
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  fuzzer::ScopedExecutionTimer timer(data, size);
+  FuzzedDataProvider provider(data, size);
+  RingBufferModel model(provider);
+
+  while (provider.remaining_bytes() != 0) {
+    model.Run(provider.ConsumeEnum<Operation>());
+  }
+  return 0;
+}
+
+}  // namespace pw::ring_buffer
@@ -16,6 +16,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "pw_assert/check.h"
 #include "pw_containers/vector.h"
@@ -557,6 +558,29 @@ TEST(PrefixedEntryRingBufferMulti, PushBack) {
   EXPECT_EQ(fast_reader.EntryCount(), total_items - 1);
 }
 
+TEST(PrefixedEntryRingBufferMulti, CaughtUpReaderIsNotSlowest) {
+  PrefixedEntryRingBufferMulti ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reader fast_reader;
+  PrefixedEntryRingBufferMulti::Reader slow_reader;
+  EXPECT_EQ(ring.AttachReader(fast_reader), OkStatus());
+  EXPECT_EQ(ring.AttachReader(slow_reader), OkStatus());
+
+  // The fast reader catches up, which leaves it at the write head.
+  EXPECT_EQ(PushBack<uint32_t>(ring, 1u), OkStatus());
+  EXPECT_EQ(fast_reader.PopFront(), OkStatus());
+  EXPECT_EQ(ring.TotalUsedBytes(), 1u + sizeof(uint32_t));
+
+  // Filling the buffer without evicting keeps the slow reader's entry.
+  while (TryPushBack<uint32_t>(ring, 2u).ok()) {
+  }
+  EXPECT_EQ(slow_reader.EntryCount(), fast_reader.EntryCount() + 1);
+  EXPECT_EQ(PeekFront<uint32_t>(slow_reader), 1u);
+  EXPECT_EQ(PeekFront<uint32_t>(fast_reader), 2u);
+}
+
 TEST(PrefixedEntryRingBufferMulti, ReaderAddRemove) {
   PrefixedEntryRingBufferMulti ring;
   byte test_buffer[kTestBufferSize];
@@ -611,6 +635,333 @@ TEST(PrefixedEntryRingBufferMulti, SingleBufferPerReader) {
   EXPECT_EQ(ring_one.AttachReader(reader), Status::InvalidArgument());
 }
 
+TEST(PrefixedEntryRingBufferMulti, PushBackMany) {
+  PrefixedEntryRingBufferMulti ring(true);
+  byte test_buffer[32];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reader reader;
+  EXPECT_EQ(ring.AttachReader(reader), OkStatus());
+
+  constexpr byte kFirst[] = {byte(1), byte(2)};
+  constexpr byte kSecond[] = {byte(3)};
+  constexpr byte kThird[] = {byte(4), byte(5), byte(6)};
+  const std::span<const byte> entries[] = {kFirst, kSecond, kThird};
+
+  ASSERT_EQ(ring.PushBackMany(entries, 7), OkStatus());
+  EXPECT_EQ(reader.EntryCount(), 3u);
+  EXPECT_EQ(ring.TotalUsedBytes(), 3u * 2u + 6u);
+
+  for (std::span<const byte> expected : entries) {
+    byte read[4];
+    uint32_t user_preamble = 0;
+    size_t bytes_read = 0;
+    ASSERT_EQ(reader.PeekFrontWithPreamble(read, user_preamble, bytes_read),
+              OkStatus());
+    EXPECT_EQ(user_preamble, 7u);
+    ASSERT_EQ(bytes_read, expected.size());
+    EXPECT_EQ(std::memcmp(read, expected.data(), expected.size()), 0);
+    ASSERT_EQ(reader.PopFront(), OkStatus());
+  }
+}
+
+TEST(PrefixedEntryRingBufferMulti, PushBackMany_InvalidEntries) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[8];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  constexpr byte kData[] = {byte(1), byte(2), byte(3)};
+  const std::span<const byte> with_empty[] = {kData, {}};
+  EXPECT_EQ(ring.PushBackMany(with_empty), Status::InvalidArgument());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+
+  const std::span<const byte> too_large[] = {kData, kData, kData};
+  EXPECT_EQ(ring.PushBackMany(too_large), Status::OutOfRange());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+}
+
+TEST(PrefixedEntryRingBufferMulti, PushBackMany_EvictsOldEntries) {
+  PrefixedEntryRingBufferMulti ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reader fast_reader;
+  PrefixedEntryRingBufferMulti::Reader slow_reader;
+  EXPECT_EQ(ring.AttachReader(fast_reader), OkStatus());
+  EXPECT_EQ(ring.AttachReader(slow_reader), OkStatus());
+
+  // Fill up the ring buffer with an increasing count.
+  uint32_t total_items = 0;
+  while (TryPushBack<uint32_t>(ring, total_items).ok()) {
+    total_items++;
+  }
+  EXPECT_EQ(fast_reader.PopFront(), OkStatus());
+
+  // Push two entries; each 5-byte entry requires evicting one of the existing
+  // entries.
+  constexpr uint32_t kValues[] = {100, 101};
+  const std::span<const byte> entries[] = {
+      std::as_bytes(std::span(kValues).first(1)),
+      std::as_bytes(std::span(kValues).last(1))};
+  EXPECT_EQ(ring.TryPushBackMany(entries), Status::ResourceExhausted());
+  ASSERT_EQ(ring.PushBackMany(entries), OkStatus());
+
+  EXPECT_EQ(PeekFront<uint32_t>(slow_reader), 2u);
+  EXPECT_EQ(PeekFront<uint32_t>(fast_reader), 2u);
+  EXPECT_EQ(slow_reader.EntryCount(), total_items);
+  EXPECT_EQ(fast_reader.EntryCount(), total_items);
+}
+
+TEST(PrefixedEntryRingBufferMulti, PopFrontN) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // Push enough entries that they wrap around the end of the buffer.
+  for (uint32_t i = 0; i < 30u; ++i) {
+    ASSERT_EQ(PushBack<uint32_t>(ring, i), OkStatus());
+  }
+  EXPECT_EQ(ring.PopFrontN(25), OkStatus());
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 25u);
+  for (uint32_t i = 30; i < 40u; ++i) {
+    ASSERT_EQ(PushBack<uint32_t>(ring, i), OkStatus());
+  }
+
+  EXPECT_EQ(ring.EntryCount(), 15u);
+  EXPECT_EQ(ring.PopFrontN(16), Status::OutOfRange());
+  EXPECT_EQ(ring.EntryCount(), 15u);
+
+  EXPECT_EQ(ring.PopFrontN(14), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 1u);
+  EXPECT_EQ(PeekFront<uint32_t>(ring), 39u);
+
+  EXPECT_EQ(ring.PopFrontN(0), OkStatus());
+  EXPECT_EQ(ring.PopFrontN(1), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+}
+
+TEST(PrefixedEntryRingBuffer, PeekFrontSpans) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[16];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::EntrySpans entry;
+  EXPECT_EQ(ring.PeekFront(entry), Status::OutOfRange());
+
+  constexpr byte kFirst[] = {byte(1), byte(2), byte(3), byte(4), byte(5)};
+  constexpr byte kSecond[] = {
+      byte(6), byte(7), byte(8), byte(9), byte(10), byte(11), byte(12)};
+
+  // The first entry occupies bytes 0-5 and does not wrap.
+  ASSERT_EQ(ring.PushBack(kFirst), OkStatus());
+  ASSERT_EQ(ring.PeekFront(entry), OkStatus());
+  ASSERT_EQ(entry.size(), sizeof(kFirst));
+  EXPECT_TRUE(entry.second.empty());
+  EXPECT_EQ(entry.first.data(), &test_buffer[1]);
+  EXPECT_EQ(std::memcmp(entry.first.data(), kFirst, sizeof(kFirst)), 0);
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+
+  // Move the write index to byte 12 so that the next entry wraps.
+  ASSERT_EQ(ring.PushBack(std::span(kFirst, 5)), OkStatus());
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+
+  ASSERT_EQ(ring.PushBack(kSecond), OkStatus());
+  ASSERT_EQ(ring.PeekFront(entry), OkStatus());
+  ASSERT_EQ(entry.size(), sizeof(kSecond));
+  ASSERT_EQ(entry.first.size(), 3u);
+  ASSERT_EQ(entry.second.size(), 4u);
+  EXPECT_EQ(entry.first.data(), &test_buffer[13]);
+  EXPECT_EQ(entry.second.data(), &test_buffer[0]);
+  EXPECT_EQ(std::memcmp(entry.first.data(), kSecond, 3), 0);
+  EXPECT_EQ(std::memcmp(entry.second.data(), &kSecond[3], 4), 0);
+}
+
+TEST(PrefixedEntryRingBuffer, PeekFrontCapturingLambda) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[16];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  constexpr byte kEntry[] = {byte(1), byte(2), byte(3), byte(4), byte(5)};
+
+  // Wrap the entry around the end of the buffer, so the output is called twice.
+  ASSERT_EQ(ring.PushBack(std::span(kEntry, 5)), OkStatus());
+  ASSERT_EQ(ring.PushBack(std::span(kEntry, 5)), OkStatus());
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+  ASSERT_EQ(ring.PushBack(kEntry), OkStatus());
+
+  Vector<byte, sizeof(kEntry)> output;
+  int calls = 0;
+  auto read_output = [&](std::span<const byte> data) {
+    calls += 1;
+    for (byte b : data) {
+      output.push_back(b);
+    }
+    return OkStatus();
+  };
+  ASSERT_EQ(ring.PeekFront(read_output), OkStatus());
+
+  EXPECT_EQ(calls, 2);
+  ASSERT_EQ(output.size(), sizeof(kEntry));
+  EXPECT_EQ(std::memcmp(output.data(), kEntry, sizeof(kEntry)), 0);
+
+  // Errors from the output are returned.
+  auto cancel = [](std::span<const byte>) { return Status::Cancelled(); };
+  EXPECT_EQ(ring.PeekFront(cancel), Status::Cancelled());
+}
+
+// Copies data into a reservation, which may wrap around the end of the buffer.
+void WriteReservation(PrefixedEntryRingBufferMulti::Reservation& reservation,
+                      std::span<const byte> data) {
+  ASSERT_EQ(reservation.size(), data.size());
+  std::memcpy(reservation.first.data(), data.data(), reservation.first.size());
+  if (!reservation.second.empty()) {
+    std::memcpy(reservation.second.data(),
+                data.data() + reservation.first.size(),
+                reservation.second.size());
+  }
+}
+
+TEST(PrefixedEntryRingBufferMulti, ReserveBack) {
+  PrefixedEntryRingBufferMulti ring(true);
+  byte test_buffer[16];
+  PrefixedEntryRingBufferMulti::Reservation reservation;
+  EXPECT_EQ(ring.ReserveBack(1, reservation), Status::FailedPrecondition());
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reader reader;
+  EXPECT_EQ(ring.AttachReader(reader), OkStatus());
+
+  EXPECT_EQ(ring.ReserveBack(0, reservation), Status::InvalidArgument());
+  EXPECT_EQ(ring.ReserveBack(15, reservation), Status::OutOfRange());
+  EXPECT_EQ(ring.CommitReservation(reservation), Status::InvalidArgument());
+
+  constexpr byte kData[] = {byte(1), byte(2), byte(3)};
+  ASSERT_EQ(ring.ReserveBack(sizeof(kData), reservation, 9), OkStatus());
+  EXPECT_EQ(reservation.first.data(), &test_buffer[2]);
+  EXPECT_EQ(ring.TotalUsedBytes(), 5u);
+
+  // The entry is not visible until it is committed.
+  EXPECT_EQ(reader.EntryCount(), 0u);
+  WriteReservation(reservation, kData);
+  EXPECT_EQ(reader.EntryCount(), 0u);
+
+  ASSERT_EQ(ring.CommitReservation(reservation), OkStatus());
+  EXPECT_EQ(reservation.size(), 0u);
+  EXPECT_EQ(ring.CommitReservation(reservation), Status::InvalidArgument());
+  ASSERT_EQ(reader.EntryCount(), 1u);
+
+  byte read[4];
+  uint32_t user_preamble = 0;
+  size_t bytes_read = 0;
+  ASSERT_EQ(reader.PeekFrontWithPreamble(read, user_preamble, bytes_read),
+            OkStatus());
+  EXPECT_EQ(user_preamble, 9u);
+  ASSERT_EQ(bytes_read, sizeof(kData));
+  EXPECT_EQ(std::memcmp(read, kData, sizeof(kData)), 0);
+}
+
+TEST(PrefixedEntryRingBufferMulti, ReserveBack_Wraps) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[16];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  // Move the write index to byte 12 so that the reservation wraps.
+  constexpr byte kData[] = {
+      byte(1), byte(2), byte(3), byte(4), byte(5), byte(6), byte(7)};
+  ASSERT_EQ(ring.PushBack(std::span(kData, 5)), OkStatus());
+  ASSERT_EQ(ring.PushBack(std::span(kData, 5)), OkStatus());
+  ASSERT_EQ(ring.PopFrontN(2), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reservation reservation;
+  ASSERT_EQ(ring.ReserveBack(sizeof(kData), reservation), OkStatus());
+  ASSERT_EQ(reservation.first.size(), 3u);
+  ASSERT_EQ(reservation.second.size(), 4u);
+  EXPECT_EQ(reservation.first.data(), &test_buffer[13]);
+  EXPECT_EQ(reservation.second.data(), &test_buffer[0]);
+  WriteReservation(reservation, kData);
+  ASSERT_EQ(ring.CommitReservation(reservation), OkStatus());
+
+  byte read[8];
+  size_t bytes_read = 0;
+  ASSERT_EQ(ring.PeekFront(read, &bytes_read), OkStatus());
+  ASSERT_EQ(bytes_read, sizeof(kData));
+  EXPECT_EQ(std::memcmp(read, kData, sizeof(kData)), 0);
+}
+
+TEST(PrefixedEntryRingBufferMulti, ReserveBack_EntriesVisibleInOrder) {
+  PrefixedEntryRingBufferMulti ring;
+  byte test_buffer[kTestBufferSize];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  PrefixedEntryRingBufferMulti::Reader reader;
+  EXPECT_EQ(ring.AttachReader(reader), OkStatus());
+
+  // Reserve an entry, then reserve and push more entries while it is being
+  // written, as an interrupt would.
+  PrefixedEntryRingBufferMulti::Reservation first;
+  PrefixedEntryRingBufferMulti::Reservation second;
+  ASSERT_EQ(ring.ReserveBack(sizeof(uint32_t), first), OkStatus());
+  ASSERT_EQ(ring.ReserveBack(sizeof(uint32_t), second), OkStatus());
+  ASSERT_EQ(PushBack<uint32_t>(ring, 3), OkStatus());
+  EXPECT_EQ(ring.PendingEntryCount(), 3u);
+
+  // A reader attached now sees the entries that are not yet committed.
+  PrefixedEntryRingBufferMulti::Reader late_reader;
+  EXPECT_EQ(ring.AttachReader(late_reader), OkStatus());
+
+  // Pending entries are not moved or cleared.
+  EXPECT_EQ(ring.Dering(), Status::FailedPrecondition());
+  ring.Clear();
+
+  constexpr uint32_t kSecond = 2;
+  WriteReservation(second, std::as_bytes(std::span(&kSecond, 1)));
+  ASSERT_EQ(ring.CommitReservation(second), OkStatus());
+  EXPECT_EQ(reader.EntryCount(), 0u);
+
+  constexpr uint32_t kFirst = 1;
+  WriteReservation(first, std::as_bytes(std::span(&kFirst, 1)));
+  ASSERT_EQ(ring.CommitReservation(first), OkStatus());
+  EXPECT_EQ(ring.CommitReservation(first), Status::InvalidArgument());
+  EXPECT_EQ(ring.PendingEntryCount(), 0u);
+
+  for (PrefixedEntryRingBufferMulti::Reader* r : {&reader, &late_reader}) {
+    ASSERT_EQ(r->EntryCount(), 3u);
+    for (uint32_t i = 1; i <= 3u; ++i) {
+      EXPECT_EQ(PeekFront<uint32_t>(*r), i);
+      ASSERT_EQ(r->PopFront(), OkStatus());
+    }
+  }
+}
+
+TEST(PrefixedEntryRingBufferMulti, ReserveBack_DoesNotEvictPendingEntries) {
+  PrefixedEntryRingBuffer ring;
+  byte test_buffer[16];
+  EXPECT_EQ(ring.SetBuffer(test_buffer), OkStatus());
+
+  constexpr byte kData[6] = {};
+  ASSERT_EQ(ring.PushBack(kData), OkStatus());
+
+  // The committed entry is evicted to make space for the first reservation,
+  // but the reservation cannot be evicted for the second one.
+  PrefixedEntryRingBufferMulti::Reservation first;
+  PrefixedEntryRingBufferMulti::Reservation second;
+  ASSERT_EQ(ring.ReserveBack(9, first), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+  EXPECT_EQ(ring.ReserveBack(6, second), Status::ResourceExhausted());
+  EXPECT_EQ(ring.PushBack(kData), Status::ResourceExhausted());
+
+  ASSERT_EQ(ring.CommitReservation(first), OkStatus());
+  EXPECT_EQ(ring.CommitReservation(second), Status::InvalidArgument());
+  EXPECT_EQ(ring.EntryCount(), 1u);
+
+  // Once committed, the entry can be evicted.
+  ASSERT_EQ(ring.ReserveBack(6, second), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 0u);
+  ASSERT_EQ(ring.CommitReservation(second), OkStatus());
+  EXPECT_EQ(ring.EntryCount(), 1u);
+}
+
 }  // namespace
 }  // namespace ring_buffer
 }  // namespace pw
@@ -0,0 +1,296 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "pw_assert/assert.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_status/status.h"
+
+namespace pw {
+namespace ring_buffer {
+
+// A circular ring buffer of entries that are all kEntrySizeBytes long, such as
+// trace events or sensor samples, with any number of attached readers. It has
+// the same semantics as PrefixedEntryRingBufferMulti: entries are pushed to
+// the back, each reader peeks and pops entries at its own position, and when
+// the buffer is full PushBack() evicts the oldest entry, moving slow readers
+// forward.
+//
+// Since every entry is the same size, entries are stored without a preamble,
+// and the position of each entry is computed rather than decoded. Entries
+// never wrap around the end of the buffer, so each entry is returned as a
+// single contiguous span, and a reader can access any of its unread entries
+// with entry().
+//
+// Like PrefixedEntryRingBufferMulti, this class has no internal
+// synchronization; users that push and read from different threads must
+// provide their own lock.
+template <size_t kEntrySizeBytes>
+class FixedEntryRingBuffer {
+ public:
+  static_assert(kEntrySizeBytes > 0u, "Entries must be at least one byte");
+
+  // A reader with its own position in the ring buffer it is attached to via
+  // AttachReader(). Readers only see entries pushed after they are attached.
+  class Reader : public IntrusiveList<Reader>::Item {
+   public:
+    constexpr Reader() : buffer_(nullptr), read_idx_(0), entry_count_(0) {}
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    // Copies the oldest unread entry into the provided buffer.
+    //
+    // Return values:
+    // OK - The entry was copied to the start of data.
+    // FAILED_PRECONDITION - The reader is not attached.
+    // OUT_OF_RANGE - No entries to read.
+    // RESOURCE_EXHAUSTED - data is smaller than an entry. Nothing was copied.
+    Status PeekFront(std::span<std::byte> data) const {
+      std::span<const std::byte> entry;
+      const Status status = PeekFront(entry);
+      if (!status.ok()) {
+        return status;
+      }
+      if (data.size_bytes() < kEntrySizeBytes) {
+        return Status::ResourceExhausted();
+      }
+      std::memcpy(data.data(), entry.data(), kEntrySizeBytes);
+      return OkStatus();
+    }
+
+    // Provides the oldest unread entry as a view directly into the ring
+    // buffer, without copying it. The view is valid until the entry is
+    // evicted by a push.
+    //
+    // Return values:
+    // OK - The entry is in entry_out.
+    // FAILED_PRECONDITION - The reader is not attached.
+    // OUT_OF_RANGE - No entries to read.
+    Status PeekFront(std::span<const std::byte>& entry_out) const {
+      if (buffer_ == nullptr) {
+        return Status::FailedPrecondition();
+      }
+      if (entry_count_ == 0u) {
+        return Status::OutOfRange();
+      }
+      entry_out = entry(0);
+      return OkStatus();
+    }
+
+    // Returns the unread entry `index` positions after the oldest one, as a
+    // view directly into the ring buffer. The view is valid until the entry is
+    // evicted by a push.
+    //
+    // Precondition: index < EntryCount()
+    std::span<const std::byte> entry(size_t index) const {
+      PW_DASSERT(index < entry_count_);
+      return buffer_->EntryAt(buffer_->Advance(read_idx_, index));
+    }
+
+    // Pops and discards the oldest unread entry.
+    //
+    // Return values:
+    // OK - The entry was popped.
+    // FAILED_PRECONDITION - The reader is not attached.
+    // OUT_OF_RANGE - No entries to pop.
+    Status PopFront() { return PopFrontN(1); }
+
+    // Pops and discards the oldest `count` unread entries.
+    //
+    // Return values:
+    // OK - The entries were popped.
+    // FAILED_PRECONDITION - The reader is not attached.
+    // OUT_OF_RANGE - Fewer than `count` entries to pop. No entries were
+    // popped.
+    Status PopFrontN(size_t count) {
+      if (buffer_ == nullptr) {
+        return Status::FailedPrecondition();
+      }
+      if (count > entry_count_) {
+        return Status::OutOfRange();
+      }
+      read_idx_ = buffer_->Advance(read_idx_, count);
+      entry_count_ -= count;
+      return OkStatus();
+    }
+
+    // The number of entries this reader has not yet popped.
+    size_t EntryCount() const { return entry_count_; }
+
+   private:
+    friend FixedEntryRingBuffer;
+
+    FixedEntryRingBuffer* buffer_;
+
+    // The slot of the oldest unread entry.
+    size_t read_idx_;
+    size_t entry_count_;
+  };
+
+  constexpr FixedEntryRingBuffer()
+      : buffer_(nullptr), capacity_(0), write_idx_(0) {}
+
+  FixedEntryRingBuffer(const FixedEntryRingBuffer&) = delete;
+  FixedEntryRingBuffer& operator=(const FixedEntryRingBuffer&) = delete;
+
+  // Sets the raw buffer to be used by the ring buffer. The buffer holds
+  // buffer.size_bytes() / kEntrySizeBytes entries; any remaining bytes are
+  // unused.
+  //
+  // Return values:
+  // OK - successfully set the raw buffer.
+  // INVALID_ARGUMENT - Argument was nullptr or smaller than one entry.
+  Status SetBuffer(std::span<std::byte> buffer) {
+    if (buffer.data() == nullptr || buffer.size_bytes() < kEntrySizeBytes) {
+      return Status::InvalidArgument();
+    }
+    buffer_ = buffer.data();
+    capacity_ = buffer.size_bytes() / kEntrySizeBytes;
+    Clear();
+    return OkStatus();
+  }
+
+  // Attaches a reader to the ring buffer. Readers can only be attached to one
+  // ring buffer at a time.
+  //
+  // Return values:
+  // OK - Successfully attached the reader.
+  // INVALID_ARGUMENT - The reader is already attached to a ring buffer.
+  Status AttachReader(Reader& reader) {
+    if (reader.buffer_ != nullptr) {
+      return Status::InvalidArgument();
+    }
+    reader.buffer_ = this;
+    reader.read_idx_ = write_idx_;
+    reader.entry_count_ = 0;
+    readers_.push_back(reader);
+    return OkStatus();
+  }
+
+  // Detaches a reader from the ring buffer.
+  //
+  // Return values:
+  // OK - Successfully detached the reader.
+  // INVALID_ARGUMENT - The reader is not attached to this ring buffer.
+  Status DetachReader(Reader& reader) {
+    if (reader.buffer_ != this) {
+      return Status::InvalidArgument();
+    }
+    reader.buffer_ = nullptr;
+    reader.read_idx_ = 0;
+    reader.entry_count_ = 0;
+    readers_.remove(reader);
+    return OkStatus();
+  }
+
+  // Removes all entries from the ring buffer.
+  void Clear() {
+    write_idx_ = 0;
+    for (Reader& reader : readers_) {
+      reader.read_idx_ = 0;
+      reader.entry_count_ = 0;
+    }
+  }
+
+  // Writes an entry to the back of the ring buffer. If a reader has not read
+  // the oldest entry and the ring buffer is full, the oldest entry is evicted
+  // and the reader moved forward.
+  //
+  // Return values:
+  // OK - The entry was written.
+  // INVALID_ARGUMENT - data is not kEntrySizeBytes long.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  Status PushBack(std::span<const std::byte> data) {
+    return InternalPushBack(data, true);
+  }
+
+  // Writes an entry to the back of the ring buffer if no reader would lose an
+  // unread entry.
+  //
+  // Return values:
+  // OK - The entry was written.
+  // INVALID_ARGUMENT - data is not kEntrySizeBytes long.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // RESOURCE_EXHAUSTED - A reader has not read the oldest entry, and the ring
+  // buffer is full.
+  Status TryPushBack(std::span<const std::byte> data) {
+    return InternalPushBack(data, false);
+  }
+
+  // The number of entries the ring buffer holds.
+  size_t capacity() const { return capacity_; }
+
+  static constexpr size_t entry_size_bytes() { return kEntrySizeBytes; }
+
+ private:
+  Status InternalPushBack(std::span<const std::byte> data,
+                          bool pop_front_if_needed) {
+    if (buffer_ == nullptr) {
+      return Status::FailedPrecondition();
+    }
+    if (data.size_bytes() != kEntrySizeBytes) {
+      return Status::InvalidArgument();
+    }
+
+    if (!pop_front_if_needed) {
+      for (const Reader& reader : readers_) {
+        if (reader.entry_count_ == capacity_) {
+          return Status::ResourceExhausted();
+        }
+      }
+    }
+
+    std::memcpy(buffer_ + write_idx_ * kEntrySizeBytes,
+                data.data(),
+                kEntrySizeBytes);
+    write_idx_ = Advance(write_idx_, 1);
+
+    // The new entry overwrote the oldest entry of any reader that had a full
+    // buffer of unread entries; those readers now start after it.
+    for (Reader& reader : readers_) {
+      if (reader.entry_count_ == capacity_) {
+        reader.read_idx_ = write_idx_;
+      } else {
+        reader.entry_count_ += 1;
+      }
+    }
+    return OkStatus();
+  }
+
+  std::span<const std::byte> EntryAt(size_t slot) const {
+    return std::span(buffer_ + slot * kEntrySizeBytes, kEntrySizeBytes);
+  }
+
+  // Returns the slot `count` entries after `slot`, where count <= capacity_.
+  size_t Advance(size_t slot, size_t count) const {
+    slot += count;
+    return slot >= capacity_ ? slot - capacity_ : slot;
+  }
+
+  std::byte* buffer_;
+  size_t capacity_;
+
+  // The slot the next entry is written to.
+  size_t write_idx_;
+
+  IntrusiveList<Reader> readers_;
+};
+
+}  // namespace ring_buffer
+}  // namespace pw
@@ -17,6 +17,7 @@
 #include <span>
 
 #include "pw_containers/intrusive_list.h"
+#include "pw_function/function_ref.h"
 #include "pw_status/status.h"
 
 namespace pw {
@@ -39,7 +40,29 @@ namespace ring_buffer {
 // around as needed.
 class PrefixedEntryRingBufferMulti {
  public:
-  typedef Status (*ReadOutput)(std::span<const std::byte>);
+  // Receives an entry's data from PeekFront and PeekFrontWithPreamble. It is
+  // called once, or twice if the entry wraps around the end of the buffer.
+  using ReadOutput = FunctionRef<Status(std::span<const std::byte>)>;
+
+  // An entry's data within the ring buffer. If the entry wraps around the end
+  // of the buffer, its data starts in `first` and continues in `second`;
+  // otherwise, `second` is empty.
+  struct EntrySpans {
+    std::span<const std::byte> first;
+    std::span<const std::byte> second;
+
+    size_t size() const { return first.size() + second.size(); }
+  };
+
+  // Space reserved for an entry's data by ReserveBack(). The data is written to
+  // `first` and continues in `second` if the space wraps around the end of the
+  // buffer.
+  struct Reservation {
+    std::span<std::byte> first;
+    std::span<std::byte> second;
+
+    size_t size() const { return first.size() + second.size(); }
+  };
 
   // A reader that provides a single-reader interface into the multi-reader ring
   // buffer it has been attached to via AttachReader(). Readers maintain their
@@ -84,6 +107,19 @@ class PrefixedEntryRingBufferMulti {
       return buffer->InternalPeekFront(*this, output);
     }
 
+    // Provides the oldest stored data chunk as views directly into the ring
+    // buffer, without copying it. The views are valid until the entry is
+    // popped, either by this reader or by the ring buffer making space for a
+    // new entry.
+    //
+    // Return values:
+    // OK - The entry's data is in entry_out.
+    // FAILED_PRECONDITION - Buffer not initialized.
+    // OUT_OF_RANGE - No entries in ring buffer to read.
+    Status PeekFront(EntrySpans& entry_out) {
+      return buffer->InternalPeekFrontSpans(*this, entry_out, false);
+    }
+
     // Same as PeekFront but includes the entry's preamble of optional user
     // value and the varint of the data size.
     // TODO(pwbug/341): Move all other APIs to passing bytes_read by reference,
@@ -110,6 +146,19 @@ class PrefixedEntryRingBufferMulti {
     // OUT_OF_RANGE - No entries in ring buffer to pop.
     Status PopFront() { return buffer->InternalPopFront(*this); }
 
+    // Pop and discard the oldest `count` data chunks from the ring buffer.
+    // This is faster than calling PopFront() `count` times, since the reader's
+    // position is only updated once.
+    //
+    // Return values:
+    // OK - Entries successfully popped from the ring buffer.
+    // FAILED_PRECONDITION - Buffer not initialized.
+    // OUT_OF_RANGE - Fewer than `count` entries in ring buffer to pop. No
+    // entries were popped.
+    Status PopFrontN(size_t count) {
+      return buffer->InternalPopFrontN(*this, count);
+    }
+
     // Get the size in bytes of the next chunk, not including preamble, to be
     // read.
     size_t FrontEntryDataSizeBytes() {
@@ -142,6 +191,10 @@ class PrefixedEntryRingBufferMulti {
       : buffer_(nullptr),
         buffer_bytes_(0),
         write_idx_(0),
+        pending_idx_(0),
+        pending_bytes_(0),
+        pending_entries_(0),
+        uncommitted_entries_(0),
         user_preamble_(user_preamble) {}
 
   // Set the raw buffer to be used by the ring buffer.
@@ -184,9 +237,11 @@ class PrefixedEntryRingBufferMulti {
   // INVALID_ARGUMENT - Size of data to write is zero bytes
   // FAILED_PRECONDITION - Buffer not initialized.
   // OUT_OF_RANGE - Size of data is greater than buffer size.
+  // RESOURCE_EXHAUSTED - Outstanding reservations occupy the space needed for
+  // the data. See ReserveBack().
   Status PushBack(std::span<const std::byte> data,
                   uint32_t user_preamble_data = 0) {
-    return InternalPushBack(data, user_preamble_data, true);
+    return InternalPushBack(std::span(&data, 1), user_preamble_data, true);
   }
 
   // [Deprecated] An implementation of PushBack that accepts a single-byte as
@@ -211,7 +266,7 @@ class PrefixedEntryRingBufferMulti {
   // without popping off existing elements.
   Status TryPushBack(std::span<const std::byte> data,
                      uint32_t user_preamble_data = 0) {
-    return InternalPushBack(data, user_preamble_data, false);
+    return InternalPushBack(std::span(&data, 1), user_preamble_data, false);
   }
 
   // [Deprecated] An implementation of TryPushBack that accepts a single-byte as
@@ -221,6 +276,75 @@ class PrefixedEntryRingBufferMulti {
     return TryPushBack(data, static_cast<uint32_t>(user_preamble_data));
   }
 
+  // Write several chunks of data to the ring buffer as separate entries, each
+  // with the same preamble, evicting the oldest entries as needed like
+  // PushBack(). The free space is checked and the readers are updated once for
+  // the whole batch.
+  //
+  // Return values:
+  // OK - Data successfully written to the ring buffer.
+  // INVALID_ARGUMENT - Size of one of the data chunks to write is zero bytes.
+  // Nothing was written.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // OUT_OF_RANGE - Total size of the entries is greater than buffer size.
+  // Nothing was written.
+  // RESOURCE_EXHAUSTED - Outstanding reservations occupy the space needed for
+  // the entries. Nothing was written.
+  Status PushBackMany(std::span<const std::span<const std::byte>> entries,
+                      uint32_t user_preamble_data = 0) {
+    return InternalPushBack(entries, user_preamble_data, true);
+  }
+
+  // Same as PushBackMany, but only writes the entries if there is space for
+  // all of them without popping off existing entries.
+  //
+  // Return values:
+  // Same as PushBackMany, plus:
+  // RESOURCE_EXHAUSTED - The ring buffer doesn't have space for the entries
+  // without popping off existing elements. Nothing was written.
+  Status TryPushBackMany(std::span<const std::span<const std::byte>> entries,
+                         uint32_t user_preamble_data = 0) {
+    return InternalPushBack(entries, user_preamble_data, false);
+  }
+
+  // Reserve space for an entry of `size_bytes` at the back of the ring buffer,
+  // evicting the oldest entries as needed like PushBack(). The entry's preamble
+  // is written immediately, and the caller writes the data into the returned
+  // reservation. The entry is not visible to readers until it is committed
+  // with CommitReservation().
+  //
+  // The reservation's bytes are not touched by the ring buffer until the entry
+  // is committed, so the data may be written without holding the lock that
+  // guards the ring buffer. Several reservations may be outstanding at once.
+  // Entries become visible in the order they were reserved, once every entry
+  // reserved before them has been committed, so each reservation must be
+  // committed. Entries pushed while reservations are outstanding are delayed
+  // the same way.
+  //
+  // Return values:
+  // OK - Space successfully reserved.
+  // INVALID_ARGUMENT - Size of data to reserve is zero bytes.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // OUT_OF_RANGE - Size of data is greater than buffer size.
+  // RESOURCE_EXHAUSTED - Other outstanding reservations occupy the space
+  // needed for the entry.
+  Status ReserveBack(size_t size_bytes,
+                     Reservation& reservation_out,
+                     uint32_t user_preamble_data = 0);
+
+  // Commit an entry reserved with ReserveBack() once its data is written. The
+  // reservation is cleared.
+  //
+  // Return values:
+  // OK - The entry was committed.
+  // INVALID_ARGUMENT - The reservation is empty or was already committed.
+  // FAILED_PRECONDITION - There are no outstanding reservations.
+  Status CommitReservation(Reservation& reservation);
+
+  // Get the number of entries that were pushed or reserved, but are not yet
+  // visible to readers because reservations are waiting to be committed.
+  size_t PendingEntryCount() const { return pending_entries_; }
+
   // Get the size in bytes of all the current entries in the ring buffer,
   // including preamble and data chunk.
   size_t TotalUsedBytes() { return buffer_bytes_ - RawAvailableBytes(); }
@@ -231,7 +355,8 @@ class PrefixedEntryRingBufferMulti {
   //
   // Return values:
   // OK - Buffer data successfully deringed.
-  // FAILED_PRECONDITION - Buffer not initialized, or no readers attached.
+  // FAILED_PRECONDITION - Buffer not initialized, no readers attached, or
+  // reservations are outstanding.
   Status Dering();
 
  protected:
@@ -266,6 +391,14 @@ class PrefixedEntryRingBufferMulti {
   // OUT_OF_RANGE - No entries in ring buffer to pop.
   Status InternalPopFront(Reader& reader);
 
+  // Pop and discard the oldest `count` entries.
+  //
+  // Return values:
+  // OK - Entries successfully popped from the ring buffer.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // OUT_OF_RANGE - Fewer than `count` entries in ring buffer to pop.
+  Status InternalPopFrontN(Reader& reader, size_t count);
+
   // Get the size in bytes of the next chunk, not including preamble, to be
   // read.
   size_t InternalFrontEntryDataSizeBytes(Reader& reader);
@@ -274,6 +407,13 @@ class PrefixedEntryRingBufferMulti {
   // chunk, to be read.
   size_t InternalFrontEntryTotalSizeBytes(Reader& reader);
 
+  // Provides views of the front entry within the ring buffer, optionally
+  // including its preamble.
+  Status InternalPeekFrontSpans(Reader& reader,
+                                EntrySpans& entry_out,
+                                bool include_preamble,
+                                uint32_t* user_preamble_out = nullptr);
+
   // Internal version of Read used by all the public interface versions. T
   // should be of type ReadOutput.
   template <typename T>
@@ -290,17 +430,32 @@ class PrefixedEntryRingBufferMulti {
   };
 
   // Push back implementation, which optionally discards front elements to fit
-  // the incoming element.
-  Status InternalPushBack(std::span<const std::byte> data,
+  // the incoming elements.
+  Status InternalPushBack(std::span<const std::span<const std::byte>> entries,
                           uint32_t user_preamble_data,
                           bool pop_front_if_needed);
 
-  // Internal function to pop all of the slowest readers. This function may pop
-  // multiple readers if multiple are slow.
+  // Makes `total_write_bytes` available at the write index, optionally
+  // discarding front elements.
+  Status MakeSpace(size_t total_write_bytes, bool pop_front_if_needed);
+
+  // Adds `entry_count` entries, which occupy `entry_bytes` starting at
+  // `entry_idx`, to the pending entries and publishes them if possible.
+  void AddPendingEntries(size_t entry_idx,
+                         size_t entry_count,
+                         size_t entry_bytes);
+
+  // Makes the pending entries visible to the readers, unless some of them are
+  // still waiting to be committed.
+  void PublishPendingEntries();
+
+  // Internal function to pop all of the slowest readers, which are at the same
+  // position as slowest_reader. This function may pop multiple readers if
+  // multiple are slow. slowest_reader remains the slowest reader afterwards.
   //
-  // Precondition: This function requires that at least one reader is attached
+  // Precondition: slowest_reader is the reader returned by GetSlowestReader(),
   // and has at least one entry to pop.
-  void InternalPopFrontAll();
+  void InternalPopFrontAll(Reader& slowest_reader);
 
   // Returns the slowest reader in the list.
   //
@@ -309,13 +464,22 @@ class PrefixedEntryRingBufferMulti {
 
   // Get info struct with the size of the preamble and data chunk for the next
   // entry to be read.
-  EntryInfo FrontEntryInfo(Reader& reader);
+  EntryInfo FrontEntryInfo(Reader& reader) {
+    return EntryInfoAt(reader.read_idx);
+  }
+
+  // Get info struct with the size of the preamble and data chunk for the entry
+  // that starts at the given index.
+  EntryInfo EntryInfoAt(size_t read_idx);
 
   // Get the raw number of available bytes free in the ring buffer. This is
   // not available bytes for data, since there is a variable size preamble for
   // each entry.
   size_t RawAvailableBytes();
 
+  // Same as RawAvailableBytes, for the already-determined slowest reader.
+  size_t RawAvailableBytes(const Reader& slowest_reader);
+
   // Do the basic write of the specified number of bytes starting at the last
   // write index of the ring buffer to the destination, handing any wrap-around
   // of the ring buffer. This is basic, raw operation with no safety checks.
@@ -332,6 +496,15 @@ class PrefixedEntryRingBufferMulti {
   size_t buffer_bytes_;
 
   size_t write_idx_;
+
+  // Entries that were written or reserved but are not yet visible to readers,
+  // since some of them are waiting to be committed. The pending entries start
+  // at pending_idx_ and end at write_idx_.
+  size_t pending_idx_;
+  size_t pending_bytes_;
+  size_t pending_entries_;
+  size_t uncommitted_entries_;
+
   const bool user_preamble_;
 
   // List of attached readers.
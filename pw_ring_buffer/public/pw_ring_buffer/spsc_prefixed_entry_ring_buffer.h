@@ -0,0 +1,183 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_status/status.h"
+
+namespace pw {
+namespace ring_buffer {
+
+// A lock-free circular ring buffer of arbitrary length data entries for a
+// single producer and a single consumer. Entries use the same format as
+// PrefixedEntryRingBufferMulti: an optional varint user preamble, a varint of
+// the data size, and the data.
+//
+// The producer calls PushBack() and the consumer calls the Peek and Pop
+// functions. These may run concurrently, for example with the producer in an
+// interrupt handler and the consumer in a thread, without a lock. The producer
+// owns the write index and the consumer owns the read index; each publishes its
+// index with release ordering and reads the other's with acquire ordering.
+// Neither side ever waits for the other, so PushBack() is wait-free.
+//
+// Because the producer never moves the read index, old entries are not evicted
+// to make space. PushBack() fails with RESOURCE_EXHAUSTED if the entry does not
+// fit, like PrefixedEntryRingBufferMulti::TryPushBack(). One byte of the buffer
+// is kept free to distinguish a full buffer from an empty one.
+//
+// SetBuffer() and Clear() must not be called while the producer or consumer may
+// be using the ring buffer.
+class SpscPrefixedEntryRingBuffer {
+ public:
+  constexpr SpscPrefixedEntryRingBuffer(bool user_preamble = false)
+      : buffer_(nullptr),
+        buffer_bytes_(0),
+        read_idx_(0),
+        write_idx_(0),
+        user_preamble_(user_preamble) {}
+
+  SpscPrefixedEntryRingBuffer(const SpscPrefixedEntryRingBuffer&) = delete;
+  SpscPrefixedEntryRingBuffer& operator=(const SpscPrefixedEntryRingBuffer&) =
+      delete;
+
+  // Set the raw buffer to be used by the ring buffer.
+  //
+  // Return values:
+  // OK - successfully set the raw buffer.
+  // INVALID_ARGUMENT - Argument was nullptr, or smaller than two bytes.
+  Status SetBuffer(std::span<std::byte> buffer);
+
+  // Removes all data from the ring buffer.
+  void Clear() {
+    read_idx_.store(0, std::memory_order_relaxed);
+    write_idx_.store(0, std::memory_order_relaxed);
+  }
+
+  // Write a chunk of data to the ring buffer if there is space available. May
+  // only be called by the producer.
+  //
+  // Preamble argument is a caller-provided value prepended to the front of the
+  // entry. It is only used if user_preamble was set at class construction
+  // time. It is varint-encoded before insertion into the buffer.
+  //
+  // Return values:
+  // OK - Data successfully written to the ring buffer.
+  // INVALID_ARGUMENT - Size of data to write is zero bytes
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // OUT_OF_RANGE - Size of data is greater than buffer size.
+  // RESOURCE_EXHAUSTED - The ring buffer doesn't have space for the data
+  // until the consumer pops existing entries.
+  Status PushBack(std::span<const std::byte> data,
+                  uint32_t user_preamble_data = 0);
+
+  // Read the oldest stored data chunk of data from the ring buffer to the
+  // provided destination std::span. The number of bytes read is written to
+  // bytes_read_out. May only be called by the consumer.
+  //
+  // Return values:
+  // OK - Data successfully read from the ring buffer.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // OUT_OF_RANGE - No entries in ring buffer to read.
+  // RESOURCE_EXHAUSTED - Destination data std::span was smaller number of
+  // bytes than the data size of the data chunk being read.  Available
+  // destination bytes were filled, remaining bytes of the data chunk were
+  // ignored.
+  Status PeekFront(std::span<std::byte> data, size_t& bytes_read_out) {
+    uint32_t user_preamble;
+    return PeekFront(data, user_preamble, bytes_read_out);
+  }
+
+  // Same as PeekFront, but also provides the entry's user preamble.
+  Status PeekFront(std::span<std::byte> data,
+                   uint32_t& user_preamble_out,
+                   size_t& bytes_read_out);
+
+  // Pop and discard the oldest stored data chunk of data from the ring
+  // buffer. May only be called by the consumer.
+  //
+  // Return values:
+  // OK - Data successfully read from the ring buffer.
+  // FAILED_PRECONDITION - Buffer not initialized.
+  // OUT_OF_RANGE - No entries in ring buffer to pop.
+  Status PopFront();
+
+  // Get the size in bytes of the next chunk, not including preamble, to be
+  // read, or 0 if the ring buffer is empty. May only be called by the
+  // consumer.
+  size_t FrontEntryDataSizeBytes();
+
+  // Returns true if there are no entries in the ring buffer. When called by
+  // the consumer, entries cannot disappear until the consumer pops them.
+  bool empty() const {
+    return read_idx_.load(std::memory_order_relaxed) ==
+           write_idx_.load(std::memory_order_acquire);
+  }
+
+  // Get the size in bytes of all the current entries in the ring buffer,
+  // including preamble and data chunk. The result may be stale by the time it
+  // is used if the other side is active.
+  size_t TotalUsedBytes() const {
+    return UsedBytes(read_idx_.load(std::memory_order_acquire),
+                     write_idx_.load(std::memory_order_acquire));
+  }
+
+ private:
+  struct EntryInfo {
+    size_t preamble_bytes;
+    uint32_t user_preamble;
+    size_t data_bytes;
+  };
+
+  // Returns the number of bytes occupied by entries between the given indices.
+  size_t UsedBytes(size_t read_idx, size_t write_idx) const {
+    return write_idx >= read_idx ? write_idx - read_idx
+                                 : buffer_bytes_ - (read_idx - write_idx);
+  }
+
+  // Get info struct with the size of the preamble and data chunk for the entry
+  // at read_idx. `used_bytes` bounds how far the preamble may be read.
+  EntryInfo FrontEntryInfo(size_t read_idx, size_t used_bytes) const;
+
+  // Copies source into the ring buffer starting at write_idx, handling
+  // wrap-around. Returns the index after the copied bytes.
+  size_t RawWrite(size_t write_idx, std::span<const std::byte> source);
+
+  // Copies bytes out of the ring buffer starting at source_idx, handling
+  // wrap-around.
+  void RawRead(std::byte* destination,
+               size_t source_idx,
+               size_t length_bytes) const;
+
+  size_t IncrementIndex(size_t index, size_t count) const {
+    index += count;
+    return index >= buffer_bytes_ ? index - buffer_bytes_ : index;
+  }
+
+  std::byte* buffer_;
+  size_t buffer_bytes_;
+
+  // Only the consumer modifies read_idx_, and only the producer modifies
+  // write_idx_. Both are in the range [0, buffer_bytes_).
+  std::atomic<size_t> read_idx_;
+  std::atomic<size_t> write_idx_;
+
+  const bool user_preamble_;
+};
+
+}  // namespace ring_buffer
+}  // namespace pw
@@ -0,0 +1,211 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_ring_buffer/spsc_prefixed_entry_ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pw_assert/assert.h"
+#include "pw_varint/varint.h"
+
+namespace pw {
+namespace ring_buffer {
+
+using std::byte;
+
+Status SpscPrefixedEntryRingBuffer::SetBuffer(std::span<byte> buffer) {
+  if ((buffer.data() == nullptr) ||  //
+      (buffer.size_bytes() < 2)) {
+    return Status::InvalidArgument();
+  }
+
+  buffer_ = buffer.data();
+  buffer_bytes_ = buffer.size_bytes();
+
+  Clear();
+  return OkStatus();
+}
+
+Status SpscPrefixedEntryRingBuffer::PushBack(std::span<const byte> data,
+                                             uint32_t user_preamble_data) {
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+  if (data.size_bytes() == 0) {
+    return Status::InvalidArgument();
+  }
+
+  // Prepare a single buffer that can hold both the user preamble and entry
+  // length.
+  byte preamble_buf[varint::kMaxVarint32SizeBytes * 2];
+  size_t user_preamble_bytes = 0;
+  if (user_preamble_) {
+    user_preamble_bytes =
+        varint::Encode<uint32_t>(user_preamble_data, preamble_buf);
+  }
+  size_t length_bytes = varint::Encode<uint32_t>(
+      data.size_bytes(), std::span(preamble_buf).subspan(user_preamble_bytes));
+  size_t total_write_bytes =
+      user_preamble_bytes + length_bytes + data.size_bytes();
+
+  // One byte is always kept free.
+  if (buffer_bytes_ - 1 < total_write_bytes) {
+    return Status::OutOfRange();
+  }
+
+  // Only this function modifies write_idx_. Acquiring read_idx_ ensures the
+  // consumer is done with the bytes it has popped before they are overwritten.
+  const size_t write_idx = write_idx_.load(std::memory_order_relaxed);
+  const size_t read_idx = read_idx_.load(std::memory_order_acquire);
+  if (buffer_bytes_ - 1 - UsedBytes(read_idx, write_idx) < total_write_bytes) {
+    return Status::ResourceExhausted();
+  }
+
+  // Write the new entry into the ring buffer, then publish it to the consumer.
+  size_t next_write_idx = RawWrite(
+      write_idx, std::span(preamble_buf, user_preamble_bytes + length_bytes));
+  next_write_idx = RawWrite(next_write_idx, data);
+  write_idx_.store(next_write_idx, std::memory_order_release);
+  return OkStatus();
+}
+
+Status SpscPrefixedEntryRingBuffer::PeekFront(std::span<byte> data,
+                                              uint32_t& user_preamble_out,
+                                              size_t& bytes_read_out) {
+  bytes_read_out = 0;
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+
+  // Acquiring write_idx_ ensures that the producer's writes to the entries
+  // before it are visible.
+  const size_t read_idx = read_idx_.load(std::memory_order_relaxed);
+  const size_t write_idx = write_idx_.load(std::memory_order_acquire);
+  if (read_idx == write_idx) {
+    return Status::OutOfRange();
+  }
+
+  EntryInfo info = FrontEntryInfo(read_idx, UsedBytes(read_idx, write_idx));
+  user_preamble_out = info.user_preamble;
+
+  size_t copy_size = std::min(data.size_bytes(), info.data_bytes);
+  if (copy_size != 0u) {
+    RawRead(
+        data.data(), IncrementIndex(read_idx, info.preamble_bytes), copy_size);
+  }
+  bytes_read_out = copy_size;
+
+  return (copy_size == info.data_bytes) ? OkStatus()
+                                        : Status::ResourceExhausted();
+}
+
+Status SpscPrefixedEntryRingBuffer::PopFront() {
+  if (buffer_ == nullptr) {
+    return Status::FailedPrecondition();
+  }
+
+  const size_t read_idx = read_idx_.load(std::memory_order_relaxed);
+  const size_t write_idx = write_idx_.load(std::memory_order_acquire);
+  if (read_idx == write_idx) {
+    return Status::OutOfRange();
+  }
+
+  // Advance the read index past the front entry. Releasing read_idx_ hands the
+  // entry's bytes back to the producer only after they are no longer read.
+  EntryInfo info = FrontEntryInfo(read_idx, UsedBytes(read_idx, write_idx));
+  read_idx_.store(
+      IncrementIndex(read_idx, info.preamble_bytes + info.data_bytes),
+      std::memory_order_release);
+  return OkStatus();
+}
+
+size_t SpscPrefixedEntryRingBuffer::FrontEntryDataSizeBytes() {
+  if (buffer_ == nullptr) {
+    return 0;
+  }
+
+  const size_t read_idx = read_idx_.load(std::memory_order_relaxed);
+  const size_t write_idx = write_idx_.load(std::memory_order_acquire);
+  if (read_idx == write_idx) {
+    return 0;
+  }
+  return FrontEntryInfo(read_idx, UsedBytes(read_idx, write_idx)).data_bytes;
+}
+
+SpscPrefixedEntryRingBuffer::EntryInfo
+SpscPrefixedEntryRingBuffer::FrontEntryInfo(size_t read_idx,
+                                            size_t used_bytes) const {
+  // Entry headers consists of: (optional prefix varint, varint size, data...)
+  // Only bytes that belong to published entries are read, since the producer
+  // may be writing the rest of the buffer.
+  byte varint_buf[varint::kMaxVarint32SizeBytes];
+
+  size_t user_preamble_bytes = 0;
+  uint64_t user_preamble_data = 0;
+  if (user_preamble_) {
+    const size_t size = std::min(sizeof(varint_buf), used_bytes);
+    RawRead(varint_buf, read_idx, size);
+    user_preamble_bytes =
+        varint::Decode(std::span(varint_buf, size), &user_preamble_data);
+    PW_DASSERT(user_preamble_bytes != 0u);
+  }
+
+  const size_t size =
+      std::min(sizeof(varint_buf), used_bytes - user_preamble_bytes);
+  RawRead(varint_buf, IncrementIndex(read_idx, user_preamble_bytes), size);
+  uint64_t entry_bytes;
+  size_t length_bytes =
+      varint::Decode(std::span(varint_buf, size), &entry_bytes);
+  PW_DASSERT(length_bytes != 0u);
+
+  EntryInfo info = {};
+  info.preamble_bytes = user_preamble_bytes + length_bytes;
+  info.user_preamble = static_cast<uint32_t>(user_preamble_data);
+  info.data_bytes = entry_bytes;
+  return info;
+}
+
+size_t SpscPrefixedEntryRingBuffer::RawWrite(size_t write_idx,
+                                             std::span<const byte> source) {
+  // Write until the end of the source or the backing buffer.
+  size_t bytes_until_wrap = buffer_bytes_ - write_idx;
+  size_t bytes_to_copy = std::min(source.size(), bytes_until_wrap);
+  std::memcpy(buffer_ + write_idx, source.data(), bytes_to_copy);
+
+  // If there wasn't space in the backing buffer, wrap to the front.
+  if (bytes_to_copy < source.size()) {
+    std::memcpy(
+        buffer_, source.data() + bytes_to_copy, source.size() - bytes_to_copy);
+  }
+  return IncrementIndex(write_idx, source.size());
+}
+
+void SpscPrefixedEntryRingBuffer::RawRead(byte* destination,
+                                          size_t source_idx,
+                                          size_t length_bytes) const {
+  // Read the pre-wrap bytes.
+  size_t bytes_until_wrap = buffer_bytes_ - source_idx;
+  size_t bytes_to_copy = std::min(length_bytes, bytes_until_wrap);
+  std::memcpy(destination, buffer_ + source_idx, bytes_to_copy);
+
+  // Read the post-wrap bytes, if needed.
+  if (bytes_to_copy < length_bytes) {
+    std::memcpy(
+        destination + bytes_to_copy, buffer_, length_bytes - bytes_to_copy);
+  }
+}
+
+}  // namespace ring_buffer
+}  // namespace pw
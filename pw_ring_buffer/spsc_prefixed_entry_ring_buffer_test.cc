@@ -0,0 +1,217 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_ring_buffer/spsc_prefixed_entry_ring_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "pw_unit_test/framework.h"
+
+using std::byte;
+
+namespace pw {
+namespace ring_buffer {
+namespace {
+
+TEST(SpscPrefixedEntryRingBuffer, NoBuffer) {
+  SpscPrefixedEntryRingBuffer ring;
+
+  byte buf[32];
+  size_t count;
+
+  EXPECT_EQ(ring.SetBuffer(std::span<byte>(nullptr, 10u)),
+            Status::InvalidArgument());
+  EXPECT_EQ(ring.SetBuffer(std::span(buf, 1u)), Status::InvalidArgument());
+  EXPECT_EQ(ring.FrontEntryDataSizeBytes(), 0u);
+
+  EXPECT_EQ(ring.PushBack(buf), Status::FailedPrecondition());
+  EXPECT_EQ(ring.PeekFront(buf, count), Status::FailedPrecondition());
+  EXPECT_EQ(count, 0u);
+  EXPECT_EQ(ring.PopFront(), Status::FailedPrecondition());
+  EXPECT_TRUE(ring.empty());
+}
+
+TEST(SpscPrefixedEntryRingBuffer, EmptyAndInvalidEntries) {
+  SpscPrefixedEntryRingBuffer ring;
+  byte buffer[16];
+  ASSERT_EQ(ring.SetBuffer(buffer), OkStatus());
+
+  byte read[16];
+  size_t count;
+  EXPECT_TRUE(ring.empty());
+  EXPECT_EQ(ring.PeekFront(read, count), Status::OutOfRange());
+  EXPECT_EQ(ring.PopFront(), Status::OutOfRange());
+
+  EXPECT_EQ(ring.PushBack(std::span<const byte>()), Status::InvalidArgument());
+
+  // One byte is kept free, and each entry has a 1-byte size prefix.
+  constexpr byte kTooLarge[15] = {};
+  EXPECT_EQ(ring.PushBack(kTooLarge), Status::OutOfRange());
+  constexpr byte kLargest[14] = {};
+  EXPECT_EQ(ring.PushBack(kLargest), OkStatus());
+  EXPECT_EQ(ring.TotalUsedBytes(), 15u);
+}
+
+TEST(SpscPrefixedEntryRingBuffer, PushPeekPop) {
+  SpscPrefixedEntryRingBuffer ring;
+  byte buffer[32];
+  ASSERT_EQ(ring.SetBuffer(buffer), OkStatus());
+
+  constexpr byte kFirst[] = {byte(1), byte(2), byte(3)};
+  constexpr byte kSecond[] = {byte(4), byte(5)};
+  ASSERT_EQ(ring.PushBack(kFirst), OkStatus());
+  ASSERT_EQ(ring.PushBack(kSecond), OkStatus());
+  EXPECT_FALSE(ring.empty());
+  EXPECT_EQ(ring.TotalUsedBytes(), 7u);
+
+  byte read[8];
+  size_t count;
+  EXPECT_EQ(ring.FrontEntryDataSizeBytes(), 3u);
+  ASSERT_EQ(ring.PeekFront(read, count), OkStatus());
+  ASSERT_EQ(count, 3u);
+  EXPECT_EQ(std::memcmp(read, kFirst, sizeof(kFirst)), 0);
+
+  // Peeking does not remove the entry.
+  ASSERT_EQ(ring.PeekFront(read, count), OkStatus());
+  EXPECT_EQ(count, 3u);
+
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(ring.FrontEntryDataSizeBytes(), 2u);
+  ASSERT_EQ(ring.PeekFront(read, count), OkStatus());
+  ASSERT_EQ(count, 2u);
+  EXPECT_EQ(std::memcmp(read, kSecond, sizeof(kSecond)), 0);
+
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_TRUE(ring.empty());
+  EXPECT_EQ(ring.TotalUsedBytes(), 0u);
+}
+
+TEST(SpscPrefixedEntryRingBuffer, PeekFront_SmallDestination) {
+  SpscPrefixedEntryRingBuffer ring;
+  byte buffer[16];
+  ASSERT_EQ(ring.SetBuffer(buffer), OkStatus());
+
+  constexpr byte kData[] = {byte(1), byte(2), byte(3), byte(4)};
+  ASSERT_EQ(ring.PushBack(kData), OkStatus());
+
+  byte read[2];
+  size_t count;
+  EXPECT_EQ(ring.PeekFront(read, count), Status::ResourceExhausted());
+  EXPECT_EQ(count, 2u);
+  EXPECT_EQ(read[0], byte(1));
+  EXPECT_EQ(read[1], byte(2));
+}
+
+TEST(SpscPrefixedEntryRingBuffer, Full_DoesNotEvict) {
+  SpscPrefixedEntryRingBuffer ring;
+  byte buffer[10];
+  ASSERT_EQ(ring.SetBuffer(buffer), OkStatus());
+
+  constexpr byte kData[] = {byte(1), byte(2), byte(3)};
+  ASSERT_EQ(ring.PushBack(kData), OkStatus());
+  ASSERT_EQ(ring.PushBack(kData), OkStatus());
+  EXPECT_EQ(ring.PushBack(kData), Status::ResourceExhausted());
+
+  // The oldest entry is still present.
+  byte read[4];
+  size_t count;
+  ASSERT_EQ(ring.PeekFront(read, count), OkStatus());
+  EXPECT_EQ(count, 3u);
+
+  ASSERT_EQ(ring.PopFront(), OkStatus());
+  EXPECT_EQ(ring.PushBack(kData), OkStatus());
+}
+
+TEST(SpscPrefixedEntryRingBuffer, UserPreamble) {
+  SpscPrefixedEntryRingBuffer ring(true);
+  byte buffer[32];
+  ASSERT_EQ(ring.SetBuffer(buffer), OkStatus());
+
+  constexpr byte kData[] = {byte(7), byte(8)};
+  ASSERT_EQ(ring.PushBack(kData, 300u), OkStatus());
+  EXPECT_EQ(ring.TotalUsedBytes(), 2u + 1u + sizeof(kData));
+
+  byte read[4];
+  uint32_t user_preamble = 0;
+  size_t count;
+  EXPECT_EQ(ring.FrontEntryDataSizeBytes(), 2u);
+  ASSERT_EQ(ring.PeekFront(read, user_preamble, count), OkStatus());
+  EXPECT_EQ(user_preamble, 300u);
+  ASSERT_EQ(count, 2u);
+  EXPECT_EQ(read[0], byte(7));
+  EXPECT_EQ(read[1], byte(8));
+}
+
+// Writes entries of varying sizes so that entries and their preambles wrap
+// around the end of the buffer at every offset.
+void WrapAroundTest(bool user_preamble) {
+  SpscPrefixedEntryRingBuffer ring(user_preamble);
+  byte buffer[23];
+  ASSERT_EQ(ring.SetBuffer(buffer), OkStatus());
+
+  byte data[8];
+  byte read[8];
+
+  for (uint32_t i = 0; i < 500u; ++i) {
+    const size_t size = 1 + i % sizeof(data);
+    for (size_t j = 0; j < size; ++j) {
+      data[j] = byte(i + j);
+    }
+
+    // Keep a second entry in the buffer some of the time.
+    if (i % 3 == 0u) {
+      ASSERT_EQ(ring.PushBack(std::span(data, 1), i), OkStatus());
+    }
+    ASSERT_EQ(ring.PushBack(std::span(data, size), i + 1000u), OkStatus());
+
+    if (i % 3 == 0u) {
+      ASSERT_EQ(ring.PopFront(), OkStatus());
+    }
+
+    uint32_t preamble = 0;
+    size_t count;
+    ASSERT_EQ(ring.PeekFront(read, preamble, count), OkStatus());
+    ASSERT_EQ(count, size);
+    EXPECT_EQ(std::memcmp(read, data, size), 0);
+    if (user_preamble) {
+      EXPECT_EQ(preamble, i + 1000u);
+    }
+    ASSERT_EQ(ring.PopFront(), OkStatus());
+    ASSERT_TRUE(ring.empty());
+  }
+}
+
+TEST(SpscPrefixedEntryRingBuffer, WrapAround) { WrapAroundTest(false); }
+
+TEST(SpscPrefixedEntryRingBuffer, WrapAround_UserPreamble) {
+  WrapAroundTest(true);
+}
+
+TEST(SpscPrefixedEntryRingBuffer, Clear) {
+  SpscPrefixedEntryRingBuffer ring;
+  byte buffer[16];
+  ASSERT_EQ(ring.SetBuffer(buffer), OkStatus());
+
+  constexpr byte kData[] = {byte(1)};
+  ASSERT_EQ(ring.PushBack(kData), OkStatus());
+  ring.Clear();
+  EXPECT_TRUE(ring.empty());
+  EXPECT_EQ(ring.TotalUsedBytes(), 0u);
+}
+
+}  // namespace
+}  // namespace ring_buffer
+}  // namespace pw
@@ -17,6 +17,7 @@
 
 #include "pw_bytes/span.h"
 #include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
 
 namespace pw::router {
 
@@ -30,6 +31,21 @@ class Egress {
   //
   // TODO(frolv): Document possible return values.
   virtual Status SendPacket(ConstByteSpan packet) = 0;
+
+  // Sends several complete packets, in order. Links that can transmit several
+  // packets at once more cheaply than one at a time may override this. Returns
+  // the number of packets sent, with OK if all were sent or the error that
+  // stopped sending.
+  //
+  // The default sends the packets one at a time with SendPacket().
+  virtual StatusWithSize SendPackets(std::span<const ConstByteSpan> packets) {
+    for (size_t i = 0; i < packets.size(); ++i) {
+      if (Status status = SendPacket(packets[i]); !status.ok()) {
+        return StatusWithSize(status, i);
+      }
+    }
+    return StatusWithSize(packets.size());
+  }
 };
 
 }  // namespace pw::router
@@ -43,4 +43,18 @@ class PacketParser {
   virtual std::optional<uint32_t> GetDestinationAddress() const = 0;
 };
 
+// A StatelessPacketParser extracts data from a packet without storing any state
+// between calls. Its functions must be reentrant: they may be called from
+// several threads at once, so routers can parse packets in parallel without a
+// lock.
+class StatelessPacketParser {
+ public:
+  virtual ~StatelessPacketParser() = default;
+
+  // Returns the destination address of a packet, or std::nullopt if the packet
+  // is incomplete or corrupt.
+  virtual std::optional<uint32_t> GetDestinationAddress(
+      ConstByteSpan packet) const = 0;
+};
+
 }  // namespace pw::router
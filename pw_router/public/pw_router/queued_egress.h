@@ -0,0 +1,168 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_containers/inline_queue.h"
+#include "pw_metric/metric.h"
+#include "pw_router/egress.h"
+#include "pw_status/status.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::router {
+
+// QueuedEgress is an Egress which copies packets into a bounded queue and
+// returns immediately, then sends them to an output egress from a drain
+// thread. A router using queued egresses is not slowed down by its slowest
+// link, and a busy link does not hold up packets for the others.
+//
+// Packets are copied into fixed-size buffers from a pool owned by the egress.
+// When every buffer is in use, or a packet is larger than a buffer, the packet
+// is dropped and SendPacket() returns RESOURCE_EXHAUSTED. The drain thread
+// sends up to a batch of queued packets at a time with the output's
+// SendPackets(), so links which can transmit several packets at once should
+// override it.
+//
+// The QueuedEgress is a ThreadCore. Start the drain thread by creating a thread
+// for it:
+//
+//   pw::router::QueuedEgressWithBuffer<8, 256> uart_queue(uart_egress);
+//   pw::thread::Thread uart_drain(options, uart_queue);
+//
+// Only one drain thread may be started for each QueuedEgress. SendPacket() is
+// thread safe, but NOT IRQ safe.
+class QueuedEgress : public Egress, public thread::ThreadCore {
+ public:
+  struct QueuedPacket {
+    uint16_t buffer_index;
+    uint16_t size;
+  };
+
+  // The buffers are buffer_count() equal slices of packet_buffers. free_buffers
+  // and queue must have room for every buffer. batch and batch_buffers hold the
+  // packets being sent, and set the largest batch.
+  QueuedEgress(Egress& output,
+               ByteSpan packet_buffers,
+               size_t max_packet_size,
+               InlineQueue<uint16_t>& free_buffers,
+               InlineQueue<QueuedPacket>& queue,
+               std::span<ConstByteSpan> batch,
+               std::span<uint16_t> batch_buffers);
+
+  // Queues a copy of the packet to be sent by the drain thread.
+  //
+  // Returns:
+  //   OK - The packet was queued.
+  //   FAILED_PRECONDITION - RequestStop() was called; the packet was dropped.
+  //   RESOURCE_EXHAUSTED - The queue is full or the packet is too large; the
+  //       packet was dropped.
+  Status SendPacket(ConstByteSpan packet) override PW_LOCKS_EXCLUDED(lock_);
+
+  // Requests the drain thread to stop. Packets which were already queued are
+  // still sent before it returns from Run(); new packets are dropped.
+  void RequestStop() PW_LOCKS_EXCLUDED(lock_);
+
+  size_t max_packet_size() const { return max_packet_size_; }
+
+  // The number of packets currently queued or being sent.
+  uint32_t queue_depth() const { return queue_depth_.value(); }
+
+  // Packets dropped because the queue was full or they were too large.
+  uint32_t dropped_packets() const { return dropped_packets_.value(); }
+
+  // Packets the output egress failed to send.
+  uint32_t send_errors() const { return send_errors_.value(); }
+
+  metric::Group& metrics() { return metrics_; }
+
+ private:
+  void Run() override PW_LOCKS_EXCLUDED(lock_);
+
+  ByteSpan Buffer(uint16_t index) const {
+    return packet_buffers_.subspan(index * max_packet_size_, max_packet_size_);
+  }
+
+  // Updates the queue depth metrics with the number of buffers in use.
+  void UpdateQueueDepth() PW_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  Egress& output_;
+  const ByteSpan packet_buffers_;
+  const size_t max_packet_size_;
+  const size_t buffer_count_;
+
+  sync::InterruptSpinLock lock_;
+  bool stop_requested_ PW_GUARDED_BY(lock_);
+  InlineQueue<uint16_t>& free_buffers_ PW_GUARDED_BY(lock_);
+  InlineQueue<QueuedPacket>& queue_ PW_GUARDED_BY(lock_);
+
+  // Only used by the drain thread.
+  const std::span<ConstByteSpan> batch_;
+  const std::span<uint16_t> batch_buffers_;
+
+  // Released once per queued packet, plus once when a stop is requested.
+  sync::CountingSemaphore packets_available_;
+
+  PW_METRIC_GROUP(metrics_, "queued_egress");
+  PW_METRIC(metrics_, queue_depth_, "queue_depth", 0u);
+  PW_METRIC(metrics_, max_queue_depth_, "max_queue_depth", 0u);
+  PW_METRIC(metrics_, sent_packets_, "sent_packets", 0u);
+  PW_METRIC(metrics_, dropped_packets_, "dropped_packets", 0u);
+  PW_METRIC(metrics_, send_errors_, "send_errors", 0u);
+};
+
+namespace internal {
+
+// Holds the storage for QueuedEgressWithBuffer. This is a separate base class
+// so that the storage is constructed before the QueuedEgress refers to it.
+template <size_t kPackets, size_t kMaxPacketSize, size_t kMaxBatch>
+struct QueuedEgressBuffer {
+  std::array<std::byte, kPackets * kMaxPacketSize> packet_buffers;
+  InlineQueue<uint16_t, kPackets> free_buffers;
+  InlineQueue<QueuedEgress::QueuedPacket, kPackets> queue;
+  std::array<ConstByteSpan, kMaxBatch> batch;
+  std::array<uint16_t, kMaxBatch> batch_buffers;
+};
+
+}  // namespace internal
+
+// A QueuedEgress with buffers for kPackets packets of up to kMaxPacketSize
+// bytes, which sends up to kMaxBatch packets at a time.
+template <size_t kPackets, size_t kMaxPacketSize, size_t kMaxBatch = 4>
+class QueuedEgressWithBuffer
+    : private internal::QueuedEgressBuffer<kPackets, kMaxPacketSize, kMaxBatch>,
+      public QueuedEgress {
+ public:
+  static_assert(kPackets > 0u && kPackets <= UINT16_MAX);
+  static_assert(kMaxPacketSize > 0u && kMaxPacketSize <= UINT16_MAX);
+  static_assert(kMaxBatch > 0u);
+
+  QueuedEgressWithBuffer(Egress& output)
+      : QueuedEgress(output,
+                     this->packet_buffers,
+                     kMaxPacketSize,
+                     this->free_buffers,
+                     this->queue,
+                     this->batch,
+                     this->batch_buffers) {}
+};
+
+}  // namespace pw::router
@@ -0,0 +1,93 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_metric/metric.h"
+#include "pw_router/egress.h"
+#include "pw_router/packet_parser.h"
+#include "pw_status/status.h"
+
+namespace pw::router {
+
+// A packet router with a static routing table, for routing packets from several
+// threads in parallel.
+//
+// Unlike StaticRouter, StatelessRouter uses a StatelessPacketParser, so packets
+// are parsed without a lock. Its routes must be sorted by address, and are
+// found with a binary search rather than a linear scan.
+//
+// Thread-safety:
+//   RoutePacket() may be called from several threads at once. Synchronization
+//   at the egress level must be implemented by derived egresses.
+//
+class StatelessRouter {
+ public:
+  struct Route {
+    uint32_t address;
+    Egress& egress;
+  };
+
+  // Returns true if the routes are sorted by address, with no duplicates. This
+  // can be checked at compile time:
+  //
+  //   static_assert(StatelessRouter::RoutesAreSorted(kRoutes));
+  //
+  static constexpr bool RoutesAreSorted(std::span<const Route> routes) {
+    for (size_t i = 1; i < routes.size(); ++i) {
+      if (routes[i - 1].address >= routes[i].address) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The routes must be sorted by address, with no duplicates.
+  StatelessRouter(const StatelessPacketParser& parser,
+                  std::span<const Route> routes);
+
+  StatelessRouter(const StatelessRouter&) = delete;
+  StatelessRouter(StatelessRouter&&) = delete;
+  StatelessRouter& operator=(const StatelessRouter&) = delete;
+  StatelessRouter& operator=(StatelessRouter&&) = delete;
+
+  uint32_t dropped_packets() const {
+    return parser_errors_.value() + route_errors_.value() +
+           egress_errors_.value();
+  }
+
+  const metric::Group& metrics() { return metrics_; }
+
+  // Routes a single packet through the appropriate egress.
+  // Returns one of the following to indicate a router-side error:
+  //
+  //   OK - Packet sent successfully.
+  //   DATA_LOSS - Packet corrupt or incomplete.
+  //   NOT_FOUND - No registered route for the packet.
+  //   UNAVAILABLE - Route egress did not accept packet.
+  //
+  Status RoutePacket(ConstByteSpan packet);
+
+ private:
+  const StatelessPacketParser& parser_;
+  const std::span<const Route> routes_;
+  PW_METRIC_GROUP(metrics_, "stateless_router");
+  PW_METRIC(metrics_, parser_errors_, "parser_errors", 0u);
+  PW_METRIC(metrics_, route_errors_, "route_errors", 0u);
+  PW_METRIC(metrics_, egress_errors_, "egress_errors", 0u);
+};
+
+}  // namespace pw::router
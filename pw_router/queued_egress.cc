@@ -0,0 +1,151 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/queued_egress.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "pw_assert/check.h"
+
+namespace pw::router {
+
+QueuedEgress::QueuedEgress(Egress& output,
+                           ByteSpan packet_buffers,
+                           size_t max_packet_size,
+                           InlineQueue<uint16_t>& free_buffers,
+                           InlineQueue<QueuedPacket>& queue,
+                           std::span<ConstByteSpan> batch,
+                           std::span<uint16_t> batch_buffers)
+    : output_(output),
+      packet_buffers_(packet_buffers),
+      max_packet_size_(max_packet_size),
+      buffer_count_(packet_buffers.size() / max_packet_size),
+      stop_requested_(false),
+      free_buffers_(free_buffers),
+      queue_(queue),
+      batch_(batch),
+      batch_buffers_(batch_buffers) {
+  PW_CHECK_UINT_LE(buffer_count_, free_buffers.capacity());
+  PW_CHECK_UINT_LE(buffer_count_, queue.capacity());
+  PW_CHECK_UINT_EQ(batch.size(), batch_buffers.size());
+  PW_CHECK_UINT_GT(batch.size(), 0u);
+
+  for (size_t i = 0; i < buffer_count_; ++i) {
+    free_buffers_.push(static_cast<uint16_t>(i));
+  }
+}
+
+Status QueuedEgress::SendPacket(ConstByteSpan packet) {
+  if (packet.size() > max_packet_size_) {
+    dropped_packets_.Increment();
+    return Status::ResourceExhausted();
+  }
+
+  uint16_t buffer_index;
+  {
+    std::lock_guard lock(lock_);
+    if (stop_requested_) {
+      return Status::FailedPrecondition();
+    }
+    if (free_buffers_.empty()) {
+      dropped_packets_.Increment();
+      return Status::ResourceExhausted();
+    }
+    buffer_index = free_buffers_.front();
+    free_buffers_.pop();
+    UpdateQueueDepth();
+  }
+
+  // Copy the packet without holding the lock, which masks interrupts.
+  std::copy(packet.begin(), packet.end(), Buffer(buffer_index).begin());
+
+  {
+    std::lock_guard lock(lock_);
+    if (stop_requested_) {
+      // The drain thread may already have returned, so give the buffer back.
+      free_buffers_.push(buffer_index);
+      UpdateQueueDepth();
+      return Status::FailedPrecondition();
+    }
+    queue_.push(QueuedPacket{.buffer_index = buffer_index,
+                             .size = static_cast<uint16_t>(packet.size())});
+  }
+  packets_available_.release();
+  return OkStatus();
+}
+
+void QueuedEgress::RequestStop() {
+  {
+    std::lock_guard lock(lock_);
+    if (stop_requested_) {
+      return;
+    }
+    stop_requested_ = true;
+  }
+  packets_available_.release();
+}
+
+void QueuedEgress::Run() {
+  while (true) {
+    packets_available_.acquire();
+
+    // Take the first packet, then any others already queued, up to a batch.
+    size_t count = 0;
+    bool acquired = true;
+    while (acquired) {
+      {
+        std::lock_guard lock(lock_);
+        if (queue_.empty()) {
+          // Every packet has its own release, so an empty queue means this was
+          // the stop request's release.
+          if (count == 0) {
+            return;
+          }
+          // Send the batch first; keep the release so the next acquire stops.
+          packets_available_.release();
+          break;
+        }
+        const QueuedPacket& queued = queue_.front();
+        batch_buffers_[count] = queued.buffer_index;
+        batch_[count] = Buffer(queued.buffer_index).first(queued.size);
+        queue_.pop();
+      }
+      count += 1;
+      acquired = count < batch_.size() && packets_available_.try_acquire();
+    }
+
+    const StatusWithSize result = output_.SendPackets(batch_.first(count));
+    sent_packets_.Increment(result.size());
+    if (!result.ok()) {
+      send_errors_.Increment(count - result.size());
+    }
+
+    std::lock_guard lock(lock_);
+    for (size_t i = 0; i < count; ++i) {
+      free_buffers_.push(batch_buffers_[i]);
+    }
+    UpdateQueueDepth();
+  }
+}
+
+void QueuedEgress::UpdateQueueDepth() {
+  const uint32_t depth = buffer_count_ - free_buffers_.size();
+  queue_depth_.Set(depth);
+  if (depth > max_queue_depth_.value()) {
+    max_queue_depth_.Set(depth);
+  }
+}
+
+}  // namespace pw::router
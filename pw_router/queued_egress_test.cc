@@ -0,0 +1,178 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/queued_egress.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/mutex.h"
+#include "pw_thread/test_threads.h"
+#include "pw_thread/thread.h"
+
+namespace pw::router {
+namespace {
+
+// Records the packets sent and the size of each batch.
+class RecordingEgress : public Egress {
+ public:
+  Status SendPacket(ConstByteSpan packet) override {
+    const ConstByteSpan packets[] = {packet};
+    return SendPackets(packets).status();
+  }
+
+  StatusWithSize SendPackets(std::span<const ConstByteSpan> packets) override {
+    std::lock_guard lock(mutex_);
+    batches_[batch_count_++] = packets.size();
+    for (ConstByteSpan packet : packets) {
+      first_bytes_[packet_count_++] = packet[0];
+    }
+    if (packet_count_ >= expected_packets_) {
+      done_.release();
+    }
+    return StatusWithSize(packets.size());
+  }
+
+  void WaitForPackets(size_t count) {
+    {
+      std::lock_guard lock(mutex_);
+      expected_packets_ = count;
+      if (packet_count_ >= count) {
+        return;
+      }
+    }
+    done_.acquire();
+  }
+
+  size_t batch_count() const { return batch_count_; }
+  size_t batch(size_t i) const { return batches_[i]; }
+  size_t packet_count() const { return packet_count_; }
+  std::byte first_byte(size_t i) const { return first_bytes_[i]; }
+
+ private:
+  sync::Mutex mutex_;
+  sync::BinarySemaphore done_;
+  size_t expected_packets_ = SIZE_MAX;
+  std::array<size_t, 16> batches_ = {};
+  size_t batch_count_ = 0;
+  std::array<std::byte, 16> first_bytes_ = {};
+  size_t packet_count_ = 0;
+};
+
+std::array<std::byte, 4> Packet(uint8_t first) {
+  return {std::byte{first}, std::byte{0}, std::byte{0}, std::byte{0}};
+}
+
+void StopAndJoin(QueuedEgress& egress, thread::Thread& thread) {
+  egress.RequestStop();
+#if PW_THREAD_JOINING_ENABLED
+  thread.join();
+#else
+  thread.detach();
+#endif  // PW_THREAD_JOINING_ENABLED
+  thread::test::WaitUntilDetachedThreadsCleanedUp();
+}
+
+TEST(QueuedEgress, DropsPacketsWhenFull) {
+  RecordingEgress output;
+  QueuedEgressWithBuffer<2, 8> egress(output);
+
+  // No drain thread is running, so the queue fills up.
+  EXPECT_EQ(egress.SendPacket(Packet(1)), OkStatus());
+  EXPECT_EQ(egress.SendPacket(Packet(2)), OkStatus());
+  EXPECT_EQ(egress.queue_depth(), 2u);
+  EXPECT_EQ(egress.SendPacket(Packet(3)), Status::ResourceExhausted());
+  EXPECT_EQ(egress.dropped_packets(), 1u);
+}
+
+TEST(QueuedEgress, DropsOversizedPackets) {
+  RecordingEgress output;
+  QueuedEgressWithBuffer<2, 2> egress(output);
+  EXPECT_EQ(egress.SendPacket(Packet(1)), Status::ResourceExhausted());
+  EXPECT_EQ(egress.dropped_packets(), 1u);
+  EXPECT_EQ(egress.queue_depth(), 0u);
+}
+
+TEST(QueuedEgress, RejectsPacketsAfterStop) {
+  RecordingEgress output;
+  QueuedEgressWithBuffer<2, 8> egress(output);
+  egress.RequestStop();
+  EXPECT_EQ(egress.SendPacket(Packet(1)), Status::FailedPrecondition());
+}
+
+TEST(QueuedEgress, SendsQueuedPacketsInOrder) {
+  RecordingEgress output;
+  QueuedEgressWithBuffer<4, 8> egress(output);
+  thread::Thread drain(thread::test::TestOptionsThread0(), egress);
+
+  for (uint8_t i = 0; i < 10; ++i) {
+    // Retry while the queue is full.
+    while (!egress.SendPacket(Packet(i)).ok()) {
+    }
+  }
+  output.WaitForPackets(10);
+  StopAndJoin(egress, drain);
+
+  ASSERT_EQ(output.packet_count(), 10u);
+  for (uint8_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(output.first_byte(i), std::byte{i});
+  }
+  EXPECT_EQ(egress.queue_depth(), 0u);
+}
+
+TEST(QueuedEgress, BatchesQueuedPackets) {
+  RecordingEgress output;
+  QueuedEgressWithBuffer<8, 8, 4> egress(output);
+
+  // Queue all the packets before the drain thread starts, so they are batched.
+  for (uint8_t i = 0; i < 6; ++i) {
+    ASSERT_EQ(egress.SendPacket(Packet(i)), OkStatus());
+  }
+  EXPECT_EQ(egress.queue_depth(), 6u);
+
+  thread::Thread drain(thread::test::TestOptionsThread0(), egress);
+  output.WaitForPackets(6);
+  StopAndJoin(egress, drain);
+
+  ASSERT_EQ(output.batch_count(), 2u);
+  EXPECT_EQ(output.batch(0), 4u);
+  EXPECT_EQ(output.batch(1), 2u);
+  EXPECT_EQ(egress.metrics().metrics().size(), 5u);
+}
+
+TEST(QueuedEgress, SendsPendingPacketsBeforeStopping) {
+  RecordingEgress output;
+  QueuedEgressWithBuffer<4, 8, 1> egress(output);
+
+  for (uint8_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(egress.SendPacket(Packet(i)), OkStatus());
+  }
+  egress.RequestStop();
+
+  thread::Thread drain(thread::test::TestOptionsThread0(), egress);
+#if PW_THREAD_JOINING_ENABLED
+  drain.join();
+#else
+  drain.detach();
+#endif  // PW_THREAD_JOINING_ENABLED
+  thread::test::WaitUntilDetachedThreadsCleanedUp();
+
+  output.WaitForPackets(3);
+  EXPECT_EQ(output.batch_count(), 3u);
+}
+
+}  // namespace
+}  // namespace pw::router
@@ -0,0 +1,55 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/stateless_router.h"
+
+#include <algorithm>
+#include <optional>
+
+#include "pw_assert/check.h"
+
+namespace pw::router {
+
+StatelessRouter::StatelessRouter(const StatelessPacketParser& parser,
+                                 std::span<const Route> routes)
+    : parser_(parser), routes_(routes) {
+  PW_DCHECK(RoutesAreSorted(routes), "Routes must be sorted by address");
+}
+
+Status StatelessRouter::RoutePacket(ConstByteSpan packet) {
+  const std::optional<uint32_t> address = parser_.GetDestinationAddress(packet);
+  if (!address.has_value()) {
+    parser_errors_.Increment();
+    return Status::DataLoss();
+  }
+
+  auto route = std::lower_bound(
+      routes_.begin(),
+      routes_.end(),
+      address.value(),
+      [](const Route& r, uint32_t value) { return r.address < value; });
+  if (route == routes_.end() || route->address != address.value()) {
+    route_errors_.Increment();
+    return Status::NotFound();
+  }
+
+  if (Status status = route->egress.SendPacket(packet); !status.ok()) {
+    egress_errors_.Increment();
+    return Status::Unavailable();
+  }
+
+  return OkStatus();
+}
+
+}  // namespace pw::router
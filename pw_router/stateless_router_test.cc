@@ -0,0 +1,117 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_router/stateless_router.h"
+
+#include "gtest/gtest.h"
+#include "pw_router/egress_function.h"
+
+namespace pw::router {
+namespace {
+
+struct BasicPacket {
+  static constexpr uint32_t kMagic = 0x8badf00d;
+
+  constexpr BasicPacket(uint32_t addr, uint64_t data)
+      : magic(kMagic), address(addr), payload(data) {}
+
+  ConstByteSpan data() const { return std::as_bytes(std::span(this, 1)); }
+
+  uint32_t magic;
+  uint32_t address;
+  uint64_t payload;
+};
+
+class BasicPacketParser : public StatelessPacketParser {
+ public:
+  std::optional<uint32_t> GetDestinationAddress(
+      ConstByteSpan packet) const final {
+    if (packet.size() < sizeof(BasicPacket)) {
+      return std::nullopt;
+    }
+    const auto& basic = *reinterpret_cast<const BasicPacket*>(packet.data());
+    if (basic.magic != BasicPacket::kMagic) {
+      return std::nullopt;
+    }
+    return basic.address;
+  }
+};
+
+EgressFunction GoodEgress(+[](ConstByteSpan) { return OkStatus(); });
+EgressFunction BadEgress(+[](ConstByteSpan) {
+  return Status::ResourceExhausted();
+});
+
+constexpr StatelessRouter::Route kRoutes[] = {
+    {1, GoodEgress}, {2, BadEgress}, {7, GoodEgress}, {40, GoodEgress}};
+static_assert(StatelessRouter::RoutesAreSorted(kRoutes));
+
+TEST(StatelessRouter, RoutesAreSorted) {
+  constexpr StatelessRouter::Route unsorted[] = {{2, GoodEgress},
+                                                 {1, GoodEgress}};
+  constexpr StatelessRouter::Route duplicate[] = {{1, GoodEgress},
+                                                  {1, GoodEgress}};
+  static_assert(!StatelessRouter::RoutesAreSorted(unsorted));
+  static_assert(!StatelessRouter::RoutesAreSorted(duplicate));
+  static_assert(StatelessRouter::RoutesAreSorted(
+      std::span<const StatelessRouter::Route>()));
+}
+
+TEST(StatelessRouter, RoutePacket_RoutesToAnEgress) {
+  BasicPacketParser parser;
+  StatelessRouter router(parser, kRoutes);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(1, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(7, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(40, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(2, 0xdddd).data()),
+            Status::Unavailable());
+}
+
+TEST(StatelessRouter, RoutePacket_ReturnsParserError) {
+  BasicPacketParser parser;
+  StatelessRouter router(parser, kRoutes);
+
+  BasicPacket bad_magic(1, 0xdddd);
+  bad_magic.magic = 0x1badda7a;
+  EXPECT_EQ(router.RoutePacket(bad_magic.data()), Status::DataLoss());
+  EXPECT_EQ(router.RoutePacket(bad_magic.data().first(4)), Status::DataLoss());
+}
+
+TEST(StatelessRouter, RoutePacket_ReturnsNotFoundOnInvalidRoute) {
+  BasicPacketParser parser;
+  StatelessRouter router(parser, kRoutes);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(0, 0xdddd).data()),
+            Status::NotFound());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(3, 0xdddd).data()),
+            Status::NotFound());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(41, 0xdddd).data()),
+            Status::NotFound());
+}
+
+TEST(StatelessRouter, RoutePacket_TracksNumberOfDrops) {
+  BasicPacketParser parser;
+  StatelessRouter router(parser, kRoutes);
+
+  EXPECT_EQ(router.RoutePacket(BasicPacket(1, 0xdddd).data()), OkStatus());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(2, 0xdddd).data()),
+            Status::Unavailable());
+  EXPECT_EQ(router.RoutePacket(BasicPacket(3, 0xdddd).data()),
+            Status::NotFound());
+  EXPECT_EQ(router.dropped_packets(), 2u);
+}
+
+}  // namespace
+}  // namespace pw::router
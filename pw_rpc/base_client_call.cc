@@ -24,20 +24,21 @@ BaseClientCall& BaseClientCall::operator=(BaseClientCall&& other) {
   Unregister();
 
   active_ = other.active_;
-
-  if (other.active()) {
-    // If the call being assigned is active, replace it in the client's list
-    // with a reference to the current object.
-    other.Unregister();
-    other.channel_->client()->RegisterCall(*this);
-  }
-
   channel_ = other.channel_;
   service_id_ = other.service_id_;
   method_id_ = other.method_id_;
+  call_id_ = other.call_id_;
   request_ = std::move(other.request_);
   handler_ = other.handler_;
 
+  if (active()) {
+    // If the call being assigned is active, replace it in the client's list
+    // with a reference to the current object. This must happen after the IDs
+    // are copied, since the client files calls by their IDs.
+    other.Unregister();
+    channel_->client()->RegisterCall(*this);
+  }
+
   return *this;
 }
 
@@ -47,6 +48,16 @@ void BaseClientCall::Cancel() {
   }
 }
 
+Status BaseClientCall::GrantCredit(uint32_t packets) {
+  if (!active()) {
+    return Status::FailedPrecondition();
+  }
+
+  Packet packet = NewPacket(PacketType::SERVER_STREAM_CREDIT);
+  packet.set_credit(packets);
+  return channel_->Send(packet);
+}
+
 std::span<std::byte> BaseClientCall::AcquirePayloadBuffer() {
   if (!active()) {
     return {};
@@ -56,21 +67,29 @@ std::span<std::byte> BaseClientCall::AcquirePayloadBuffer() {
   return request_.payload(NewPacket(PacketType::REQUEST));
 }
 
-Status BaseClientCall::ReleasePayloadBuffer(
-    std::span<const std::byte> payload) {
+Status BaseClientCall::ReleasePayloadBuffer(std::span<const std::byte> payload,
+                                            uint32_t stream_credit) {
   if (!active()) {
     return Status::FailedPrecondition();
   }
 
-  return channel_->Send(request_, NewPacket(PacketType::REQUEST, payload));
+  Packet packet = NewPacket(PacketType::REQUEST, payload);
+  packet.set_credit(stream_credit);
+  return channel_->Send(request_, packet);
 }
 
 Packet BaseClientCall::NewPacket(PacketType type,
                                  std::span<const std::byte> payload) const {
-  return Packet(type, channel_->id(), service_id_, method_id_, payload);
+  Packet packet(type, channel_->id(), service_id_, method_id_, payload);
+  packet.set_call_id(call_id_);
+  return packet;
 }
 
-void BaseClientCall::Register() { channel_->client()->RegisterCall(*this); }
+void BaseClientCall::Register() {
+  Client& client = *channel_->client();
+  call_id_ = client.NewCallId();
+  client.RegisterCall(*this);
+}
 
 void BaseClientCall::Unregister() {
   if (active()) {
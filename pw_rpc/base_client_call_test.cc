@@ -63,10 +63,15 @@ class FakeClientCall : public BaseClientCall {
                            ResponseHandler handler)
       : BaseClientCall(channel, service_id, method_id, handler) {}
 
-  Status SendPacket(std::span<const std::byte> payload) {
+  constexpr FakeClientCall() = default;
+
+  using BaseClientCall::call_id;
+
+  Status SendPacket(std::span<const std::byte> payload,
+                    uint32_t stream_credit = 0) {
     std::span buffer = AcquirePayloadBuffer();
     std::memcpy(buffer.data(), payload.data(), payload.size());
-    return ReleasePayloadBuffer(buffer.first(payload.size()));
+    return ReleasePayloadBuffer(buffer.first(payload.size()), stream_credit);
   }
 };
 
@@ -86,6 +91,47 @@ TEST(BaseClientCall, SendsPacketWithPayload) {
   EXPECT_EQ(packet.service_id(), context.service_id());
   EXPECT_EQ(packet.method_id(), context.method_id());
   EXPECT_EQ(std::memcmp(packet.payload().data(), payload, sizeof(payload)), 0);
+  EXPECT_EQ(packet.credit(), 0u);
+  EXPECT_NE(packet.call_id(), 0u);
+  EXPECT_EQ(packet.call_id(), call.call_id());
+}
+
+TEST(BaseClientCall, SendsRequestWithStreamCredit) {
+  ClientContextForTest context;
+  FakeClientCall call(&context.channel(),
+                      context.service_id(),
+                      context.method_id(),
+                      [](BaseClientCall&, const Packet&) {});
+
+  constexpr std::byte payload[]{std::byte{0x08}, std::byte{0x39}};
+  call.SendPacket(payload, 16);
+
+  Packet packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::REQUEST);
+  EXPECT_EQ(packet.credit(), 16u);
+}
+
+TEST(BaseClientCall, GrantCredit_SendsCreditPacket) {
+  ClientContextForTest context;
+  FakeClientCall call(&context.channel(),
+                      context.service_id(),
+                      context.method_id(),
+                      [](BaseClientCall&, const Packet&) {});
+
+  EXPECT_EQ(OkStatus(), call.GrantCredit(5));
+
+  EXPECT_EQ(context.output().packet_count(), 1u);
+  Packet packet = context.output().sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::SERVER_STREAM_CREDIT);
+  EXPECT_EQ(packet.channel_id(), context.channel().id());
+  EXPECT_EQ(packet.service_id(), context.service_id());
+  EXPECT_EQ(packet.method_id(), context.method_id());
+  EXPECT_EQ(packet.credit(), 5u);
+}
+
+TEST(BaseClientCall, GrantCredit_Inactive_FailedPrecondition) {
+  FakeClientCall call;
+  EXPECT_EQ(Status::FailedPrecondition(), call.GrantCredit(5));
 }
 
 }  // namespace
@@ -14,6 +14,8 @@
 
 #include "pw_rpc/internal/base_server_writer.h"
 
+#include <limits>
+
 #include "pw_assert/check.h"
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/packet.h"
@@ -22,7 +24,10 @@
 namespace pw::rpc::internal {
 
 BaseServerWriter::BaseServerWriter(ServerCall& call)
-    : call_(call), state_(kOpen) {
+    : call_(call),
+      flow_controlled_(call.stream_credit() != 0u),
+      credit_(call.stream_credit()),
+      state_(kOpen) {
   call_.server().RegisterWriter(*this);
 }
 
@@ -40,6 +45,8 @@ BaseServerWriter& BaseServerWriter::operator=(BaseServerWriter&& other) {
 
   call_ = std::move(other.call_);
   response_ = std::move(other.response_);
+  flow_controlled_ = other.flow_controlled_;
+  credit_ = other.credit_;
 
   return *this;
 }
@@ -59,13 +66,17 @@ Status BaseServerWriter::Finish(Status status) {
 
   Close();
 
+  call_.server().StreamFinished(call_.service().id(), method().id(), status);
+
   // Send a control packet indicating that the stream (and RPC) has terminated.
-  return call_.channel().Send(Packet(PacketType::SERVER_STREAM_END,
-                                     call_.channel().id(),
-                                     call_.service().id(),
-                                     method().id(),
-                                     {},
-                                     status));
+  Packet stream_end(PacketType::SERVER_STREAM_END,
+                    call_.channel().id(),
+                    call_.service().id(),
+                    method().id(),
+                    {},
+                    status);
+  stream_end.set_call_id(call_.call_id());
+  return call_.channel().Send(stream_end);
 }
 
 std::span<std::byte> BaseServerWriter::AcquirePayloadBuffer() {
@@ -82,7 +93,21 @@ std::span<std::byte> BaseServerWriter::AcquirePayloadBuffer() {
 Status BaseServerWriter::ReleasePayloadBuffer(
     std::span<const std::byte> payload) {
   PW_DCHECK(open());
-  return call_.channel().Send(response_, ResponsePacket(payload));
+
+  if (flow_controlled_ && credit_ == 0u) {
+    call_.channel().Release(response_);
+    return Status::Unavailable();
+  }
+
+  const Packet response = ResponsePacket(payload);
+  Status status = call_.channel().Send(response_, response);
+  call_.server().ResponseSent(response, payload.size(), status);
+
+  // A packet the client did not receive does not use any credit.
+  if (flow_controlled_ && status.ok()) {
+    credit_ -= 1;
+  }
+  return status;
 }
 
 Status BaseServerWriter::ReleasePayloadBuffer() {
@@ -91,6 +116,12 @@ Status BaseServerWriter::ReleasePayloadBuffer() {
   return OkStatus();
 }
 
+Status BaseServerWriter::ReleasePayloadBufferForEncodeFailure() {
+  ReleasePayloadBuffer();
+  call_.server().ResponseSent(ResponsePacket(), 0, Status::Internal());
+  return Status::Internal();
+}
+
 void BaseServerWriter::Close() {
   if (!open()) {
     return;
@@ -100,13 +131,23 @@ void BaseServerWriter::Close() {
   state_ = kClosed;
 }
 
+void BaseServerWriter::AddCredit(uint32_t credit) {
+  if (credit > std::numeric_limits<uint32_t>::max() - credit_) {
+    credit_ = std::numeric_limits<uint32_t>::max();
+  } else {
+    credit_ += credit;
+  }
+}
+
 Packet BaseServerWriter::ResponsePacket(
     std::span<const std::byte> payload) const {
-  return Packet(PacketType::RESPONSE,
+  Packet packet(PacketType::RESPONSE,
                 call_.channel().id(),
                 call_.service().id(),
                 method().id(),
                 payload);
+  packet.set_call_id(call_.call_id());
+  return packet;
 }
 
 }  // namespace pw::rpc::internal
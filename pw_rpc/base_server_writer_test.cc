@@ -74,6 +74,11 @@ class FakeServerWriter : public BaseServerWriter {
   }
 
   ByteSpan PayloadBuffer() { return AcquirePayloadBuffer(); }
+
+  // Sends a payload that was built in PayloadBuffer().
+  Status WritePayloadBuffer(std::span<const byte> payload) {
+    return ReleasePayloadBuffer(payload);
+  }
   const Channel::OutputBuffer& output_buffer() { return buffer(); }
 };
 
@@ -165,15 +170,32 @@ TEST(ServerWriter, Open_SendsPacketWithPayload) {
   constexpr byte data[] = {byte{0xf0}, byte{0x0d}};
   ASSERT_EQ(OkStatus(), writer.Write(data));
 
-  byte encoded[64];
-  auto result = context.packet(data).Encode(encoded);
-  ASSERT_EQ(OkStatus(), result.status());
+  const Packet expected = context.packet(data);
+  const Packet& sent = context.output().sent_packet();
+  EXPECT_EQ(sent.type(), expected.type());
+  EXPECT_EQ(sent.channel_id(), expected.channel_id());
+  EXPECT_EQ(sent.service_id(), expected.service_id());
+  EXPECT_EQ(sent.method_id(), expected.method_id());
+  EXPECT_EQ(sent.status(), expected.status());
+  ASSERT_EQ(sent.payload().size(), sizeof(data));
+  EXPECT_EQ(0, std::memcmp(sent.payload().data(), data, sizeof(data)));
+}
 
-  EXPECT_EQ(result.value().size(), context.output().sent_data().size());
-  EXPECT_EQ(
-      0,
-      std::memcmp(
-          encoded, context.output().sent_data().data(), result.value().size()));
+TEST(ServerWriter, PayloadBuffer_IsNotCopiedWhenSent) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  FakeServerWriter writer(context.get());
+
+  ByteSpan payload = writer.PayloadBuffer();
+  ASSERT_GE(payload.size(), 3u);
+  payload[0] = byte{1};
+  payload[1] = byte{2};
+  payload[2] = byte{3};
+  ASSERT_EQ(OkStatus(), writer.WritePayloadBuffer(payload.first(3)));
+
+  // The packet is encoded around the payload, which stays where it was built.
+  const Packet& sent = context.output().sent_packet();
+  EXPECT_EQ(sent.payload().data(), payload.data());
+  EXPECT_EQ(sent.payload().size(), 3u);
 }
 
 TEST(ServerWriter, Closed_IgnoresFinish) {
@@ -184,6 +206,119 @@ TEST(ServerWriter, Closed_IgnoresFinish) {
   EXPECT_EQ(Status::FailedPrecondition(), writer.Finish());
 }
 
+// Returns a copy of the context's call with stream credit from the client.
+ServerCall CallWithCredit(ServerCall& call, uint32_t credit) {
+  return ServerCall(
+      call.server(), call.channel(), call.service(), call.method(), credit);
+}
+
+Status SendCredit(ServerContextForTest<TestService>& context,
+                  uint32_t credit) {
+  Packet packet(PacketType::SERVER_STREAM_CREDIT,
+                context.channel_id(),
+                context.service_id(),
+                context.get().method().id());
+  packet.set_credit(credit);
+
+  byte encoded[64];
+  auto result = packet.Encode(encoded);
+  EXPECT_EQ(OkStatus(), result.status());
+  return context.server().ProcessPacket(result.value_or(ConstByteSpan()),
+                                        context.output());
+}
+
+TEST(ServerWriter, NoCreditInRequest_NotFlowControlled) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  FakeServerWriter writer(context.get());
+
+  EXPECT_FALSE(writer.flow_controlled());
+
+  constexpr byte data[] = {byte{0xf0}, byte{0x0d}};
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(OkStatus(), writer.Write(data));
+  }
+  EXPECT_EQ(5u, context.output().packet_count());
+}
+
+TEST(ServerWriter, FlowControlled_OutOfCredit_Unavailable) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  ServerCall call = CallWithCredit(context.get(), 2);
+  FakeServerWriter writer(call);
+
+  ASSERT_TRUE(writer.flow_controlled());
+  EXPECT_EQ(2u, writer.available_credit());
+
+  constexpr byte data[] = {byte{0xf0}, byte{0x0d}};
+  EXPECT_EQ(OkStatus(), writer.Write(data));
+  EXPECT_EQ(1u, writer.available_credit());
+  EXPECT_EQ(OkStatus(), writer.Write(data));
+  EXPECT_EQ(0u, writer.available_credit());
+
+  EXPECT_EQ(Status::Unavailable(), writer.Write(data));
+  EXPECT_EQ(2u, context.output().packet_count());
+  EXPECT_TRUE(writer.output_buffer().empty());
+
+  // Finishing the stream does not require credit.
+  EXPECT_EQ(OkStatus(), writer.Finish());
+  EXPECT_EQ(PacketType::SERVER_STREAM_END,
+            context.output().sent_packet().type());
+}
+
+TEST(ServerWriter, FlowControlled_CreditPacket_AddsCredit) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  ServerCall call = CallWithCredit(context.get(), 1);
+  FakeServerWriter writer(call);
+
+  constexpr byte data[] = {byte{0xf0}, byte{0x0d}};
+  ASSERT_EQ(OkStatus(), writer.Write(data));
+  ASSERT_EQ(Status::Unavailable(), writer.Write(data));
+
+  ASSERT_EQ(OkStatus(), SendCredit(context, 3));
+  EXPECT_EQ(3u, writer.available_credit());
+  EXPECT_EQ(OkStatus(), writer.Write(data));
+  EXPECT_EQ(2u, writer.available_credit());
+}
+
+TEST(ServerWriter, FlowControlled_SendFails_CreditNotUsed) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  ServerCall call = CallWithCredit(context.get(), 1);
+  FakeServerWriter writer(call);
+  context.output().set_send_status(Status::Unauthenticated());
+
+  constexpr byte data[] = {byte{0xf0}, byte{0x0d}};
+  EXPECT_EQ(Status::Unauthenticated(), writer.Write(data));
+  EXPECT_EQ(1u, writer.available_credit());
+}
+
+TEST(ServerWriter, FlowControlled_CreditSaturates) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  ServerCall call = CallWithCredit(context.get(), 10);
+  FakeServerWriter writer(call);
+
+  ASSERT_EQ(OkStatus(), SendCredit(context, 0xffffffff));
+  EXPECT_EQ(0xffffffffu, writer.available_credit());
+}
+
+TEST(ServerWriter, FlowControlled_MovePreservesCredit) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+  ServerCall call = CallWithCredit(context.get(), 4);
+  FakeServerWriter moved(call);
+  FakeServerWriter writer(std::move(moved));
+
+  EXPECT_TRUE(writer.flow_controlled());
+  EXPECT_EQ(4u, writer.available_credit());
+}
+
+TEST(ServerWriter, CreditPacket_NoStream_SendsError) {
+  ServerContextForTest<TestService> context(TestService::method.method());
+
+  ASSERT_EQ(OkStatus(), SendCredit(context, 1));
+
+  const Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(PacketType::SERVER_ERROR, packet.type());
+  EXPECT_EQ(Status::FailedPrecondition(), packet.status());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace pw::rpc
@@ -0,0 +1,90 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/batching_channel_output.h"
+
+#include <algorithm>
+
+#include "pw_log/log.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_rpc/internal/packet.pwpb.h"
+#include "pw_varint/varint.h"
+
+namespace pw::rpc::internal {
+
+Status BaseBatchingChannelOutput::SendAndReleaseBuffer(
+    std::span<const std::byte> packet) {
+  if (packet.empty()) {
+    return OkStatus();
+  }
+
+  const size_t encoded_size =
+      protobuf::SizeOfFieldKey(
+          static_cast<uint32_t>(RpcPacketBatch::Fields::PACKETS)) +
+      varint::EncodedSize(packet.size()) + packet.size();
+
+  if (batch_size_bytes_ + encoded_size > batch_buffer_.size()) {
+    // The failure belongs to the previously batched packets, not this one, so
+    // it is only logged.
+    if (Status status = Flush(); !status.ok()) {
+      PW_LOG_WARN("Failed to flush RPC packet batch on %s: %d",
+                  name(),
+                  static_cast<int>(status.code()));
+    }
+  }
+
+  protobuf::NestedEncoder encoder(batch_buffer_.subspan(batch_size_bytes_));
+  RpcPacketBatch::Encoder batch(&encoder);
+  batch.WritePackets(packet);
+
+  Result<ConstByteSpan> encoded = encoder.Encode();
+  if (!encoded.ok()) {
+    return Status::ResourceExhausted();
+  }
+
+  batch_size_bytes_ += encoded.value().size();
+  batched_packets_ += 1;
+  return OkStatus();
+}
+
+Status BaseBatchingChannelOutput::Flush() {
+  if (batched_packets_ == 0u) {
+    return OkStatus();
+  }
+
+  ConstByteSpan frame = batch_buffer_.first(batch_size_bytes_);
+
+  // A single packet is sent without the batch encoding, which saves a few
+  // bytes and lets receivers that do not support batches process it.
+  if (batched_packets_ == 1u) {
+    protobuf::Decoder decoder(frame);
+    decoder.Next();
+    decoder.ReadBytes(&frame);
+  }
+
+  batch_size_bytes_ = 0;
+  batched_packets_ = 0;
+
+  std::span<std::byte> buffer = output_.AcquireBuffer();
+  if (buffer.size() < frame.size()) {
+    output_.DiscardBuffer(buffer);
+    return Status::ResourceExhausted();
+  }
+
+  std::copy(frame.begin(), frame.end(), buffer.begin());
+  return output_.SendAndReleaseBuffer(buffer.first(frame.size()));
+}
+
+}  // namespace pw::rpc::internal
@@ -0,0 +1,172 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/batching_channel_output.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_status/try.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::Packet;
+using internal::PacketType;
+
+// Records the frames sent through it.
+template <size_t kBufferSize>
+class FrameOutput : public ChannelOutput {
+ public:
+  constexpr FrameOutput() : ChannelOutput("FrameOutput"), buffer_{} {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> frame) override {
+    if (frame.empty()) {
+      return OkStatus();
+    }
+    frame_count_ += 1;
+    last_frame_ = frame;
+    return send_status_;
+  }
+
+  size_t frame_count() const { return frame_count_; }
+  ConstByteSpan last_frame() const { return last_frame_; }
+
+  void set_send_status(Status status) { send_status_ = status; }
+
+ private:
+  std::array<std::byte, kBufferSize> buffer_;
+  ConstByteSpan last_frame_;
+  size_t frame_count_ = 0;
+  Status send_status_;
+};
+
+// Encodes a response packet for the given method into the output's buffer and
+// sends it.
+Status SendPacket(ChannelOutput& output, uint32_t method_id) {
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  Result<ConstByteSpan> encoded =
+      Packet(PacketType::RESPONSE, 1, 42, method_id).Encode(buffer);
+  EXPECT_EQ(OkStatus(), encoded.status());
+  return output.SendAndReleaseBuffer(encoded.value_or(ConstByteSpan()));
+}
+
+// Returns the method IDs of the packets in a frame.
+size_t DecodeMethodIds(ConstByteSpan frame, std::span<uint32_t> method_ids) {
+  size_t count = 0;
+  EXPECT_EQ(OkStatus(),
+            internal::ForEachPacket(frame, [&](ConstByteSpan data) {
+              Result<Packet> packet = Packet::FromBuffer(data);
+              PW_TRY(packet.status());
+              method_ids[count++] = packet.value().method_id();
+              return OkStatus();
+            }));
+  return count;
+}
+
+class BatchingChannelOutputTest : public ::testing::Test {
+ protected:
+  BatchingChannelOutputTest() : batching_output_(output_) {}
+
+  FrameOutput<128> output_;
+  BatchingChannelOutput<32, 64> batching_output_;
+};
+
+TEST_F(BatchingChannelOutputTest, Send_DoesNotSendUntilFlush) {
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output_, 100));
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output_, 200));
+
+  EXPECT_EQ(0u, output_.frame_count());
+  EXPECT_EQ(2u, batching_output_.batched_packets());
+}
+
+TEST_F(BatchingChannelOutputTest, Flush_SendsBatchInOneFrame) {
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output_, 100));
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output_, 200));
+  EXPECT_EQ(OkStatus(), batching_output_.Flush());
+
+  ASSERT_EQ(1u, output_.frame_count());
+  EXPECT_TRUE(internal::IsPacketBatch(output_.last_frame()));
+  EXPECT_EQ(0u, batching_output_.batched_packets());
+  EXPECT_EQ(0u, batching_output_.batch_size_bytes());
+
+  std::array<uint32_t, 4> method_ids{};
+  ASSERT_EQ(2u, DecodeMethodIds(output_.last_frame(), method_ids));
+  EXPECT_EQ(100u, method_ids[0]);
+  EXPECT_EQ(200u, method_ids[1]);
+}
+
+TEST_F(BatchingChannelOutputTest, Flush_SinglePacket_SentUnbatched) {
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output_, 100));
+  EXPECT_EQ(OkStatus(), batching_output_.Flush());
+
+  ASSERT_EQ(1u, output_.frame_count());
+  EXPECT_FALSE(internal::IsPacketBatch(output_.last_frame()));
+
+  Result<Packet> packet = Packet::FromBuffer(output_.last_frame());
+  ASSERT_EQ(OkStatus(), packet.status());
+  EXPECT_EQ(100u, packet.value().method_id());
+}
+
+TEST_F(BatchingChannelOutputTest, Flush_Empty_SendsNothing) {
+  EXPECT_EQ(OkStatus(), batching_output_.Flush());
+  EXPECT_EQ(0u, output_.frame_count());
+}
+
+TEST_F(BatchingChannelOutputTest, Send_BatchFull_FlushesBatch) {
+  // Each response packet is 18 bytes encoded, or 20 bytes in a batch, so three
+  // fit in the 64-byte batch.
+  for (uint32_t method_id = 1; method_id <= 4; ++method_id) {
+    EXPECT_EQ(OkStatus(), SendPacket(batching_output_, method_id));
+  }
+
+  ASSERT_EQ(1u, output_.frame_count());
+  EXPECT_EQ(1u, batching_output_.batched_packets());
+
+  std::array<uint32_t, 4> method_ids{};
+  ASSERT_EQ(3u, DecodeMethodIds(output_.last_frame(), method_ids));
+  EXPECT_EQ(1u, method_ids[0]);
+  EXPECT_EQ(3u, method_ids[2]);
+}
+
+TEST_F(BatchingChannelOutputTest, Send_EmptyBuffer_Released) {
+  batching_output_.DiscardBuffer(batching_output_.AcquireBuffer());
+  EXPECT_EQ(0u, batching_output_.batched_packets());
+}
+
+TEST_F(BatchingChannelOutputTest, Flush_ReturnsOutputStatus) {
+  output_.set_send_status(Status::Unavailable());
+
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output_, 100));
+  EXPECT_EQ(Status::Unavailable(), batching_output_.Flush());
+  EXPECT_EQ(0u, batching_output_.batched_packets());
+}
+
+TEST(BatchingChannelOutput, Flush_OutputBufferTooSmall) {
+  FrameOutput<16> output;
+  BatchingChannelOutput<32, 64> batching_output(output);
+
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output, 100));
+  EXPECT_EQ(OkStatus(), SendPacket(batching_output, 200));
+  EXPECT_EQ(Status::ResourceExhausted(), batching_output.Flush());
+
+  EXPECT_EQ(0u, output.frame_count());
+  EXPECT_EQ(0u, batching_output.batched_packets());
+}
+
+}  // namespace
+}  // namespace pw::rpc
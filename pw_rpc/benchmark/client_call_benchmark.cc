@@ -0,0 +1,135 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program measures how long the RPC client takes to match responses to
+// active calls, for 1 to 256 concurrent calls. Build the client_call_benchmark
+// target for the target of interest and run it; results are logged with pw_log.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/internal/base_client_call.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace {
+
+using pw::chrono::SystemClock;
+using pw::rpc::internal::BaseClientCall;
+using pw::rpc::internal::Packet;
+using pw::rpc::internal::PacketType;
+
+constexpr uint32_t kChannelId = 1;
+constexpr uint32_t kServiceId = 0x16e4a5b1;
+constexpr size_t kMaxCalls = 256;
+constexpr size_t kIterations = 64;
+
+// Method IDs are hashes of the method names, so spread them out similarly.
+constexpr uint32_t MethodId(size_t index) {
+  return uint32_t(index + 1) * 0x01000193u;
+}
+
+// Discards outgoing packets. Responses to active calls do not send anything.
+class NullOutput : public pw::rpc::ChannelOutput {
+ public:
+  constexpr NullOutput() : ChannelOutput("NullOutput"), buffer_{} {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  pw::Status SendAndReleaseBuffer(std::span<const std::byte>) override {
+    return pw::OkStatus();
+  }
+
+ private:
+  std::array<std::byte, 64> buffer_;
+};
+
+// Stores the number of responses so the calls are not optimized out.
+volatile size_t responses;
+
+class BenchmarkCall : public BaseClientCall {
+ public:
+  constexpr BenchmarkCall() = default;
+
+  BenchmarkCall(pw::rpc::Channel* channel, uint32_t method_id)
+      : BaseClientCall(channel, kServiceId, method_id, HandleResponse) {}
+
+ private:
+  static void HandleResponse(BaseClientCall&, const Packet&) {
+    responses = responses + 1;
+  }
+};
+
+NullOutput output;
+std::array<pw::rpc::Channel, 1> channels{
+    pw::rpc::Channel::Create<kChannelId>(&output)};
+pw::rpc::Client client(channels);
+
+std::array<BenchmarkCall, kMaxCalls> calls;
+
+// Encoded response packets for each call.
+std::array<std::array<std::byte, 32>, kMaxCalls> packet_buffers;
+std::array<pw::ConstByteSpan, kMaxCalls> packets;
+
+void RunBenchmark(size_t call_count) {
+  for (size_t i = 0; i < call_count; ++i) {
+    calls[i] = BenchmarkCall(&channels[0], MethodId(i));
+  }
+
+  const SystemClock::time_point start = SystemClock::now();
+  for (size_t iteration = 0; iteration < kIterations; ++iteration) {
+    for (size_t i = 0; i < call_count; ++i) {
+      client.ProcessPacket(packets[i]);
+    }
+  }
+  const SystemClock::duration elapsed = SystemClock::now() - start;
+
+  for (size_t i = 0; i < call_count; ++i) {
+    calls[i] = BenchmarkCall();
+  }
+
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  const uint64_t total_packets = uint64_t(call_count) * kIterations;
+
+  PW_LOG_INFO("%3u calls: %u responses in %u us (%u ns per response)",
+              unsigned(call_count),
+              unsigned(total_packets),
+              unsigned(elapsed_ns / 1000),
+              unsigned(elapsed_ns / total_packets));
+}
+
+}  // namespace
+
+int main() {
+  for (size_t i = 0; i < kMaxCalls; ++i) {
+    const Packet packet(
+        PacketType::RESPONSE, kChannelId, kServiceId, MethodId(i));
+    pw::Result<pw::ConstByteSpan> encoded = packet.Encode(packet_buffers[i]);
+    if (!encoded.ok()) {
+      PW_LOG_ERROR("Failed to encode response packet");
+      return 1;
+    }
+    packets[i] = encoded.value();
+  }
+
+  for (size_t call_count = 1; call_count <= kMaxCalls; call_count *= 2) {
+    RunBenchmark(call_count);
+  }
+  return 0;
+}
@@ -0,0 +1,182 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc_private/loopback_benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_log/log.h"
+#include "pw_status/try.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::rpc::internal {
+namespace {
+
+using chrono::SystemClock;
+
+constexpr uint64_t kHdlcAddress = 'R';
+
+constexpr size_t kPayloadSizes[] = {0, 16, 64, 256};
+constexpr size_t kUnaryIterations = 1000;
+constexpr uint32_t kStreamResponses = 1000;
+
+int64_t ElapsedNanoseconds(SystemClock::time_point start) {
+  return std::max<int64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(SystemClock::now() -
+                                                           start)
+          .count(),
+      1);
+}
+
+Status BenchmarkUnary(LoopbackTransport& transport,
+                      LoopbackBenchmarkCalls& calls,
+                      size_t payload_size) {
+  calls.Reset();
+
+  const SystemClock::time_point start = SystemClock::now();
+  for (size_t i = 0; i < kUnaryIterations; ++i) {
+    PW_TRY(calls.StartUnaryEcho(transport.channel(), payload_size));
+    PW_TRY(transport.DeliverRequests());
+  }
+  const int64_t elapsed_ns = ElapsedNanoseconds(start);
+
+  if (calls.responses() != kUnaryIterations) {
+    PW_LOG_ERROR("Expected %u unary responses, received %u",
+                 unsigned(kUnaryIterations),
+                 unsigned(calls.responses()));
+    return Status::DataLoss();
+  }
+
+  PW_LOG_INFO("  unary         %3u B: %7u ns per round trip",
+              unsigned(payload_size),
+              unsigned(elapsed_ns / kUnaryIterations));
+  return OkStatus();
+}
+
+Status BenchmarkServerStream(LoopbackTransport& transport,
+                             LoopbackBenchmarkCalls& calls,
+                             size_t payload_size) {
+  calls.Reset();
+
+  const SystemClock::time_point start = SystemClock::now();
+  PW_TRY(calls.StartServerStream(
+      transport.channel(), kStreamResponses, payload_size));
+  PW_TRY(transport.DeliverRequests());
+  const int64_t elapsed_ns = ElapsedNanoseconds(start);
+
+  if (!calls.stream_finished() || calls.responses() != kStreamResponses) {
+    PW_LOG_ERROR("Expected %u stream responses, received %u",
+                 unsigned(kStreamResponses),
+                 unsigned(calls.responses()));
+    return Status::DataLoss();
+  }
+
+  const uint64_t packets_per_s =
+      uint64_t(kStreamResponses) * 1'000'000'000u / uint64_t(elapsed_ns);
+  const uint64_t bytes_per_s =
+      uint64_t(calls.response_bytes()) * 1'000'000'000u / uint64_t(elapsed_ns);
+
+  PW_LOG_INFO("  server stream %3u B: %7u packets/s, %9u B/s",
+              unsigned(payload_size),
+              unsigned(packets_per_s),
+              unsigned(bytes_per_s));
+  return OkStatus();
+}
+
+}  // namespace
+
+LoopbackTransport::LoopbackTransport()
+    : framing_(Framing::kNone),
+      client_output_("client", *this, /*to_server=*/true),
+      server_output_("server", *this, /*to_server=*/false),
+      client_channels_{rpc::Channel::Create<kChannelId>(&client_output_)},
+      server_channels_{rpc::Channel::Create<kChannelId>(&server_output_)},
+      client_(client_channels_),
+      server_(server_channels_),
+      pending_request_size_(0) {}
+
+Status LoopbackTransport::DeliverRequests() {
+  while (pending_request_size_ != 0u) {
+    // Copy the request out so the server can send, and the client can queue a
+    // new request, while this one is processed.
+    const size_t size = pending_request_size_;
+    std::memcpy(delivered_request_.data(), pending_request_.data(), size);
+    pending_request_size_ = 0;
+
+    PW_TRY(server_.ProcessPacket(std::span(delivered_request_).first(size),
+                                 server_output_));
+  }
+  return OkStatus();
+}
+
+Status LoopbackTransport::Transfer(ConstByteSpan packet, bool to_server) {
+  if (framing_ == Framing::kNone) {
+    return Receive(packet, to_server);
+  }
+
+  stream::MemoryWriter writer(frame_);
+  PW_TRY(hdlc::WriteUIFrame(kHdlcAddress, packet, writer));
+
+  hdlc::Decoder& decoder = to_server ? server_decoder_ : client_decoder_;
+  Status status = Status::DataLoss();
+  decoder.Process(writer.WrittenData(), [&](const Result<hdlc::Frame>& frame) {
+    status = frame.ok() ? Receive(frame.value().data(), to_server)
+                        : frame.status();
+  });
+  return status;
+}
+
+Status LoopbackTransport::Receive(ConstByteSpan packet, bool to_server) {
+  if (!to_server) {
+    return client_.ProcessPacket(packet);
+  }
+
+  if (pending_request_size_ != 0u) {
+    return Status::ResourceExhausted();
+  }
+  std::memcpy(pending_request_.data(), packet.data(), packet.size());
+  pending_request_size_ = packet.size();
+  return OkStatus();
+}
+
+Status RunLoopbackBenchmarks(const char* name,
+                             Service& service,
+                             LoopbackBenchmarkCalls& calls) {
+  LoopbackTransport transport;
+  transport.server().RegisterService(service);
+
+  for (LoopbackTransport::Framing framing :
+       {LoopbackTransport::Framing::kNone, LoopbackTransport::Framing::kHdlc}) {
+    transport.set_framing(framing);
+    PW_LOG_INFO("%s loopback, %s",
+                name,
+                framing == LoopbackTransport::Framing::kHdlc ? "HDLC framing"
+                                                             : "no framing");
+
+    for (size_t payload_size : kPayloadSizes) {
+      PW_TRY(BenchmarkUnary(transport, calls, payload_size));
+    }
+    for (size_t payload_size : kPayloadSizes) {
+      PW_TRY(BenchmarkServerStream(transport, calls, payload_size));
+    }
+  }
+
+  return OkStatus();
+}
+
+}  // namespace pw::rpc::internal
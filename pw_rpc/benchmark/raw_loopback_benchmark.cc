@@ -0,0 +1,216 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program measures end-to-end unary round-trip latency and server stream
+// throughput for raw RPC methods, with a client and server connected in memory.
+// Build the raw_loopback_benchmark target and run it; results are logged with
+// pw_log.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_log/log.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_rpc/benchmark/benchmark.pwpb.h"
+#include "pw_rpc/benchmark/benchmark.raw_rpc.pb.h"
+#include "pw_rpc/internal/base_client_call.h"
+#include "pw_rpc/internal/hash.h"
+#include "pw_rpc_private/loopback_benchmark.h"
+#include "pw_status/try.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::BaseClientCall;
+using internal::Packet;
+using internal::PacketType;
+
+constexpr std::array<std::byte, 256> kData{};
+
+class BenchmarkService final
+    : public benchmark::generated::Benchmark<BenchmarkService> {
+ public:
+  static StatusWithSize UnaryEcho(ServerContext&,
+                                  ConstByteSpan request,
+                                  ByteSpan response) {
+    // The request and response are both Payload messages, so echo the bytes.
+    if (request.size() > response.size()) {
+      return StatusWithSize::ResourceExhausted();
+    }
+    std::copy(request.begin(), request.end(), response.begin());
+    return StatusWithSize(request.size());
+  }
+
+  static void ServerStream(ServerContext&,
+                           ConstByteSpan request,
+                           RawServerWriter& writer) {
+    uint32_t responses = 0;
+    uint32_t payload_size = 0;
+
+    protobuf::Decoder decoder(request);
+    while (decoder.Next().ok()) {
+      switch (static_cast<benchmark::StreamRequest::Fields>(
+          decoder.FieldNumber())) {
+        case benchmark::StreamRequest::Fields::RESPONSES:
+          decoder.ReadUint32(&responses);
+          break;
+        case benchmark::StreamRequest::Fields::PAYLOAD_SIZE:
+          decoder.ReadUint32(&payload_size);
+          break;
+      }
+    }
+
+    if (payload_size > kData.size()) {
+      writer.Finish(Status::InvalidArgument());
+      return;
+    }
+
+    for (uint32_t i = 0; i < responses; ++i) {
+      protobuf::NestedEncoder encoder(writer.PayloadBuffer());
+      benchmark::Payload::Encoder payload(&encoder);
+      payload.WriteData(std::span(kData).first(payload_size));
+
+      Result<ConstByteSpan> encoded = encoder.Encode();
+      if (!encoded.ok() || !writer.Write(encoded.value()).ok()) {
+        writer.Finish(Status::Internal());
+        return;
+      }
+    }
+    writer.Finish();
+  }
+};
+
+class RawBenchmarkCalls;
+
+// A raw client call, which reports responses to RawBenchmarkCalls.
+class RawCall : public BaseClientCall {
+ public:
+  constexpr RawCall() = default;
+
+  RawCall(rpc::Channel& channel, uint32_t method_id, RawBenchmarkCalls& calls)
+      : BaseClientCall(&channel, kServiceId, method_id, HandleResponse),
+        calls_(&calls) {}
+
+  RawCall(RawCall&&) = default;
+  RawCall& operator=(RawCall&&) = default;
+
+  // Returns a buffer in which to encode the request, which Send sends.
+  ByteSpan PayloadBuffer() { return AcquirePayloadBuffer(); }
+  Status Send(ConstByteSpan payload) { return ReleasePayloadBuffer(payload); }
+
+  static constexpr uint32_t kServiceId =
+      internal::Hash("pw.rpc.benchmark.Benchmark");
+
+ private:
+  static void HandleResponse(BaseClientCall& call, const Packet& packet);
+
+  RawBenchmarkCalls* calls_ = nullptr;
+};
+
+class RawBenchmarkCalls : public internal::LoopbackBenchmarkCalls {
+ public:
+  Status StartUnaryEcho(rpc::Channel& channel, size_t payload_size) override {
+    call_ = RawCall();  // The client allows only one call per method.
+    call_ = RawCall(channel, kUnaryEchoId, *this);
+
+    protobuf::NestedEncoder encoder(call_.PayloadBuffer());
+    benchmark::Payload::Encoder payload(&encoder);
+    payload.WriteData(std::span(kData).first(payload_size));
+    PW_TRY_ASSIGN(ConstByteSpan request, encoder.Encode());
+    return call_.Send(request);
+  }
+
+  Status StartServerStream(rpc::Channel& channel,
+                           uint32_t responses,
+                           size_t payload_size) override {
+    call_ = RawCall();  // The client allows only one call per method.
+    call_ = RawCall(channel, kServerStreamId, *this);
+
+    protobuf::NestedEncoder encoder(call_.PayloadBuffer());
+    benchmark::StreamRequest::Encoder request(&encoder);
+    request.WriteResponses(responses);
+    request.WritePayloadSize(static_cast<uint32_t>(payload_size));
+    PW_TRY_ASSIGN(ConstByteSpan encoded, encoder.Encode());
+    return call_.Send(encoded);
+  }
+
+  size_t responses() const override { return responses_; }
+  size_t response_bytes() const override { return response_bytes_; }
+  bool stream_finished() const override { return stream_finished_; }
+
+  void Reset() override {
+    responses_ = 0;
+    response_bytes_ = 0;
+    stream_finished_ = false;
+  }
+
+ private:
+  friend class RawCall;
+
+  static constexpr uint32_t kUnaryEchoId = internal::Hash("UnaryEcho");
+  static constexpr uint32_t kServerStreamId = internal::Hash("ServerStream");
+
+  void ReceivedResponse(ConstByteSpan payload) {
+    responses_ += 1;
+
+    protobuf::Decoder decoder(payload);
+    while (decoder.Next().ok()) {
+      ConstByteSpan data;
+      if (static_cast<benchmark::Payload::Fields>(decoder.FieldNumber()) ==
+              benchmark::Payload::Fields::DATA &&
+          decoder.ReadBytes(&data).ok()) {
+        response_bytes_ += data.size();
+      }
+    }
+  }
+
+  RawCall call_;
+  size_t responses_ = 0;
+  size_t response_bytes_ = 0;
+  bool stream_finished_ = false;
+};
+
+void RawCall::HandleResponse(BaseClientCall& base, const Packet& packet) {
+  RawCall& call = static_cast<RawCall&>(base);
+
+  switch (packet.type()) {
+    case PacketType::RESPONSE:
+      call.calls_->ReceivedResponse(packet.payload());
+      break;
+    case PacketType::SERVER_STREAM_END:
+      call.calls_->stream_finished_ = true;
+      call.Unregister();
+      break;
+    default:
+      PW_LOG_ERROR("RPC failed with status %s", packet.status().str());
+      call.Unregister();
+      break;
+  }
+}
+
+}  // namespace
+}  // namespace pw::rpc
+
+int main() {
+  pw::rpc::BenchmarkService service;
+  pw::rpc::RawBenchmarkCalls calls;
+
+  return pw::rpc::internal::RunLoopbackBenchmarks("Raw", service, calls).ok()
+             ? 0
+             : 1;
+}
@@ -14,6 +14,9 @@
 
 #include "pw_rpc/internal/channel.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "pw_log/log.h"
 #include "pw_rpc/internal/packet.h"
 
@@ -22,14 +25,36 @@ namespace pw::rpc::internal {
 using std::byte;
 
 std::span<byte> Channel::OutputBuffer::payload(const Packet& packet) const {
-  const size_t reserved_size = packet.MinEncodedSizeBytes();
+  const size_t reserved_size = packet.PayloadOffset(buffer_.size());
   return reserved_size <= buffer_.size() ? buffer_.subspan(reserved_size)
                                          : std::span<byte>();
 }
 
+Channel* Channel::Find(std::span<Channel> channels, uint32_t id) {
+  // Unsigned wraparound makes an ID of 0 out of range.
+  if (const size_t index = id - 1u;
+      index < channels.size() && channels[index].id() == id) {
+    return &channels[index];
+  }
+
+  for (Channel& channel : channels) {
+    if (channel.id() == id) {
+      return &channel;
+    }
+  }
+  return nullptr;
+}
+
 Status Channel::Send(OutputBuffer& buffer, const internal::Packet& packet) {
   Result encoded = packet.Encode(buffer.buffer_);
 
+  // A payload in the buffer is overwritten as fragments are encoded, so only
+  // payloads from elsewhere are split.
+  if (!encoded.ok() && fragment_large_payloads() &&
+      !packet.payload().empty() && !buffer.Contains(packet.payload())) {
+    return SendFragments(buffer, packet);
+  }
+
   if (!encoded.ok()) {
     PW_LOG_ERROR("Failed to encode RPC response packet to channel %u buffer",
                  static_cast<unsigned>(id()));
@@ -42,4 +67,53 @@ Status Channel::Send(OutputBuffer& buffer, const internal::Packet& packet) {
   return output().SendAndReleaseBuffer(encoded.value());
 }
 
+Status Channel::SendFragments(OutputBuffer& buffer,
+                              const internal::Packet& packet) {
+  Packet fragment = packet;
+  ConstByteSpan remaining = packet.payload();
+
+  while (!remaining.empty()) {
+    if (buffer.empty()) {
+      buffer = AcquireBuffer();
+    }
+
+    fragment.set_payload_offset(
+        static_cast<uint32_t>(packet.payload().size() - remaining.size()));
+    fragment.set_continued(false);
+    ByteSpan payload = buffer.payload(fragment);
+    if (payload.size() < remaining.size()) {
+      fragment.set_continued(true);
+      payload = buffer.payload(fragment);
+    }
+
+    if (payload.empty()) {
+      PW_LOG_ERROR("Channel %u buffer is too small to split an RPC payload",
+                   static_cast<unsigned>(id()));
+      Release(buffer);
+      return Status::Internal();
+    }
+
+    // Copy the fragment to where Encode() expects the payload, so that the
+    // packet is encoded around it without another copy.
+    const size_t size = std::min(payload.size(), remaining.size());
+    std::memcpy(payload.data(), remaining.data(), size);
+    fragment.set_payload(payload.first(size));
+    remaining = remaining.subspan(size);
+
+    Result encoded = fragment.Encode(buffer.buffer_);
+    if (!encoded.ok()) {
+      Release(buffer);
+      return Status::Internal();
+    }
+
+    buffer.buffer_ = {};
+    if (Status status = output().SendAndReleaseBuffer(encoded.value());
+        !status.ok()) {
+      return status;
+    }
+  }
+
+  return OkStatus();
+}
+
 }  // namespace pw::rpc::internal
@@ -14,8 +14,12 @@
 
 #include "pw_rpc/channel.h"
 
+#include <array>
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/payload_reassembler.h"
 #include "pw_rpc_private/internal_test_utils.h"
 
 namespace pw::rpc::internal {
@@ -54,6 +58,41 @@ TEST(Channel, Create_FromEnum) {
   static_assert(two.id() == 2);
 }
 
+TEST(Channel, Find_SequentialIds) {
+  std::array<Channel, 3> channels{
+      Channel(1, nullptr),
+      Channel(2, nullptr),
+      Channel(3, nullptr),
+  };
+
+  EXPECT_EQ(&channels[0], Channel::Find(channels, 1));
+  EXPECT_EQ(&channels[1], Channel::Find(channels, 2));
+  EXPECT_EQ(&channels[2], Channel::Find(channels, 3));
+  EXPECT_EQ(nullptr, Channel::Find(channels, 4));
+  EXPECT_EQ(nullptr, Channel::Find(channels, 0));
+}
+
+TEST(Channel, Find_NonSequentialIds) {
+  // Unassigned channels can only be created as rpc::Channels, which the server
+  // and client treat as internal::Channels.
+  std::array<rpc::Channel, 4> rpc_channels{
+      Channel(9, nullptr),
+      Channel(3, nullptr),
+      rpc::Channel(),
+      Channel(1, nullptr),
+  };
+  std::span<Channel> channels(static_cast<Channel*>(rpc_channels.data()),
+                              rpc_channels.size());
+
+  EXPECT_EQ(&channels[0], Channel::Find(channels, 9));
+  EXPECT_EQ(&channels[1], Channel::Find(channels, 3));
+  EXPECT_EQ(&channels[2],
+            Channel::Find(channels, Channel::kUnassignedChannelId));
+  EXPECT_EQ(&channels[3], Channel::Find(channels, 1));
+  EXPECT_EQ(nullptr, Channel::Find(channels, 2));
+  EXPECT_EQ(nullptr, Channel::Find(channels, 0xffffffff));
+}
+
 TEST(Channel, TestPacket_ReservedSizeMatchesMinEncodedSizeBytes) {
   EXPECT_EQ(kReservedSize, kTestPacket.MinEncodedSizeBytes());
 }
@@ -123,5 +162,88 @@ TEST(Channel, OutputBuffer_ReturnsStatusFromChannelOutputSend) {
   EXPECT_EQ(Status::Aborted(), channel.Send(output_buffer, kTestPacket));
 }
 
+// Reassembles the payloads of the packets sent through it.
+class ReassemblingOutput : public ChannelOutput {
+ public:
+  ReassemblingOutput() : ChannelOutput("ReassemblingOutput") {
+    reassembler_.set_buffer(payload_);
+  }
+
+  std::span<byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const byte> buffer) override {
+    if (buffer.empty()) {
+      return OkStatus();
+    }
+
+    packet_count_ += 1;
+    Result<Packet> result = Packet::FromBuffer(buffer);
+    EXPECT_EQ(OkStatus(), result.status());
+    Packet packet = result.value_or(Packet());
+    if (reassembler_.Add(packet).ok()) {
+      reassembled_ = packet;
+    }
+    return OkStatus();
+  }
+
+  size_t packet_count() const { return packet_count_; }
+  const Packet& reassembled() const { return reassembled_; }
+
+ private:
+  std::array<byte, kReservedSize + 16> buffer_;
+  std::array<byte, 128> payload_;
+  PayloadReassembler reassembler_;
+  Packet reassembled_;
+  size_t packet_count_ = 0;
+};
+
+TEST(Channel, Send_LargePayload_IsSplit) {
+  ReassemblingOutput output;
+  internal::Channel channel(100, &output);
+  channel.set_fragment_large_payloads(true);
+
+  std::array<byte, 100> data;
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<byte>(i);
+  }
+  Packet packet = kTestPacket;
+  packet.set_call_id(5);
+  packet.set_payload(data);
+
+  ASSERT_EQ(OkStatus(), channel.Send(packet));
+  EXPECT_GT(output.packet_count(), 1u);
+
+  const Packet& received = output.reassembled();
+  EXPECT_EQ(5u, received.call_id());
+  ASSERT_EQ(data.size(), received.payload().size());
+  EXPECT_EQ(0,
+            std::memcmp(data.data(), received.payload().data(), data.size()));
+}
+
+TEST(Channel, Send_LargePayload_NotSplitUnlessEnabled) {
+  ReassemblingOutput output;
+  internal::Channel channel(100, &output);
+
+  std::array<byte, 100> data = {};
+  Packet packet = kTestPacket;
+  packet.set_payload(data);
+
+  EXPECT_EQ(Status::Internal(), channel.Send(packet));
+  EXPECT_EQ(0u, output.packet_count());
+}
+
+TEST(Channel, Send_LargePayload_NoRoomForFragment) {
+  TestOutput<kReservedSize> output;
+  internal::Channel channel(100, &output);
+  channel.set_fragment_large_payloads(true);
+
+  Packet packet = kTestPacket;
+  byte data[1] = {};
+  packet.set_payload(data);
+
+  EXPECT_EQ(Status::Internal(), channel.Send(packet));
+  EXPECT_EQ(0u, output.packet_count());
+}
+
 }  // namespace
 }  // namespace pw::rpc::internal
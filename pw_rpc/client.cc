@@ -27,6 +27,12 @@ using internal::PacketType;
 }  // namespace
 
 Status Client::ProcessPacket(ConstByteSpan data) {
+  return internal::ForEachPacket(data, [this](ConstByteSpan packet) {
+    return ProcessSinglePacket(packet);
+  });
+}
+
+Status Client::ProcessSinglePacket(ConstByteSpan data) {
   Result<Packet> result = Packet::FromBuffer(data);
   if (!result.ok()) {
     PW_LOG_WARN("RPC client failed to decode incoming packet");
@@ -45,27 +51,33 @@ Status Client::ProcessPacket(ConstByteSpan data) {
     return Status::DataLoss();
   }
 
-  auto call = std::find_if(calls_.begin(), calls_.end(), [&](auto& c) {
-    return c.channel().id() == packet.channel_id() &&
-           c.service_id() == packet.service_id() &&
-           c.method_id() == packet.method_id();
-  });
+  BaseClientCall* call = FindCall(packet.channel_id(),
+                                 packet.service_id(),
+                                 packet.method_id(),
+                                 packet.call_id());
 
-  auto channel = std::find_if(channels_.begin(), channels_.end(), [&](auto& c) {
-    return c.id() == packet.channel_id();
-  });
+  internal::Channel* channel =
+      internal::Channel::Find(channels_, packet.channel_id());
 
-  if (channel == channels_.end()) {
+  if (channel == nullptr) {
     PW_LOG_WARN("RPC client received a packet for an unregistered channel");
     return Status::NotFound();
   }
 
-  if (call == calls_.end()) {
+  if (call == nullptr) {
     PW_LOG_WARN("RPC client received a packet for a request it did not make");
     channel->Send(Packet::ClientError(packet, Status::FailedPrecondition()));
     return Status::NotFound();
   }
 
+  if (Status status = reassembler_.Add(packet); !status.ok()) {
+    if (status.IsUnavailable()) {
+      return OkStatus();  // Wait for the rest of a split payload.
+    }
+    PW_LOG_WARN("RPC client failed to reassemble a split response");
+    return status;
+  }
+
   switch (packet.type()) {
     case PacketType::RESPONSE:
     case PacketType::SERVER_ERROR:
@@ -82,20 +94,39 @@ Status Client::ProcessPacket(ConstByteSpan data) {
   return OkStatus();
 }
 
+size_t Client::active_calls() const {
+  size_t count = 0;
+  for (const CallList& calls : calls_) {
+    count += calls.size();
+  }
+  return count;
+}
+
 Status Client::RegisterCall(BaseClientCall& call) {
-  auto existing_call = std::find_if(calls_.begin(), calls_.end(), [&](auto& c) {
-    return c.channel().id() == call.channel().id() &&
-           c.service_id() == call.service_id() &&
-           c.method_id() == call.method_id();
-  });
-  if (existing_call != calls_.end()) {
-    PW_LOG_WARN(
-        "RPC client tried to call same method multiple times; aborting.");
+  if (FindCall(call.channel().id(),
+               call.service_id(),
+               call.method_id(),
+               call.call_id()) != nullptr) {
+    PW_LOG_WARN("RPC client tried to register a call ID twice; aborting.");
     return Status::FailedPrecondition();
   }
 
-  calls_.push_front(call);
+  CallsFor(call.channel().id(), call.service_id(), call.method_id())
+      .push_front(call);
   return OkStatus();
 }
 
+BaseClientCall* Client::FindCall(uint32_t channel_id,
+                                 uint32_t service_id,
+                                 uint32_t method_id,
+                                 uint32_t call_id) {
+  CallList& calls = CallsFor(channel_id, service_id, method_id);
+  auto call = std::find_if(calls.begin(), calls.end(), [&](auto& c) {
+    return c.channel().id() == channel_id && c.service_id() == service_id &&
+           c.method_id() == method_id &&
+           (call_id == 0u || c.call_id() == call_id);
+  });
+  return call == calls.end() ? nullptr : &(*call);
+}
+
 }  // namespace pw::rpc
@@ -14,17 +14,23 @@
 
 #include "pw_rpc/client_server.h"
 
+#include "pw_rpc/internal/packet.h"
+
 namespace pw::rpc {
 
 Status ClientServer::ProcessPacket(std::span<const std::byte> packet,
                                    ChannelOutput& interface) {
-  Status status = server_.ProcessPacket(packet, interface);
-  if (status.IsInvalidArgument()) {
-    // INVALID_ARGUMENT indicates the packet is intended for a client.
-    status = client_.ProcessPacket(packet);
-  }
-
-  return status;
+  // A batch may mix packets for the client and the server, so dispatch each
+  // packet individually.
+  return internal::ForEachPacket(
+      packet, [this, &interface](ConstByteSpan single_packet) {
+        Status status = server_.ProcessPacket(single_packet, interface);
+        if (status.IsInvalidArgument()) {
+          // INVALID_ARGUMENT indicates the packet is intended for a client.
+          status = client_.ProcessPacket(single_packet);
+        }
+        return status;
+      });
 }
 
 }  // namespace pw::rpc
@@ -14,6 +14,8 @@
 
 #include "pw_rpc/client.h"
 
+#include <array>
+
 #include "gtest/gtest.h"
 #include "pw_rpc/internal/packet.h"
 #include "pw_rpc_private/internal_test_utils.h"
@@ -27,6 +29,8 @@ using internal::PacketType;
 
 class TestClientCall : public BaseClientCall {
  public:
+  constexpr TestClientCall() = default;
+
   constexpr TestClientCall(Channel* channel,
                            uint32_t service_id,
                            uint32_t method_id)
@@ -36,12 +40,18 @@ class TestClientCall : public BaseClientCall {
     static_cast<TestClientCall&>(call).HandlePacket(packet);
   }
 
-  void HandlePacket(const Packet&) { invoked_ = true; }
+  void HandlePacket(const Packet& packet) {
+    invoked_ = true;
+    payload_size_ = packet.payload().size();
+  }
 
   constexpr bool invoked() const { return invoked_; }
+  constexpr size_t payload_size() const { return payload_size_; }
+  constexpr uint32_t id() const { return call_id(); }
 
  private:
   bool invoked_ = false;
+  size_t payload_size_ = 0;
 };
 
 TEST(Client, ProcessPacket_InvokesARegisteredClientCall) {
@@ -69,6 +79,40 @@ TEST(Client, ProcessPacket_SendsClientErrorOnUnregisteredCall) {
   EXPECT_EQ(packet.status(), Status::FailedPrecondition());
 }
 
+TEST(Client, ProcessPacket_SplitResponse_InvokesCallWithPayload) {
+  ClientContextForTest context;
+  std::byte reassembly_buffer[16];
+  context.client().set_reassembly_buffer(reassembly_buffer);
+
+  TestClientCall call(
+      &context.channel(), context.service_id(), context.method_id());
+
+  constexpr std::byte payload[] = {
+      std::byte{0x01}, std::byte{0x02}, std::byte{0x03}};
+  Packet packet(PacketType::RESPONSE,
+                context.channel_id(),
+                context.service_id(),
+                context.method_id(),
+                std::span(payload).first(2));
+  packet.set_call_id(call.id());
+  packet.set_continued(true);
+
+  std::byte buffer[64];
+  Result result = packet.Encode(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(OkStatus(), context.client().ProcessPacket(result.value()));
+  EXPECT_FALSE(call.invoked());
+
+  packet.set_payload(std::span(payload).subspan(2));
+  packet.set_payload_offset(2);
+  packet.set_continued(false);
+  result = packet.Encode(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(OkStatus(), context.client().ProcessPacket(result.value()));
+  EXPECT_TRUE(call.invoked());
+  EXPECT_EQ(sizeof(payload), call.payload_size());
+}
+
 TEST(Client, ProcessPacket_ReturnsDataLossOnBadPacket) {
   ClientContextForTest context;
 
@@ -77,6 +121,141 @@ TEST(Client, ProcessPacket_ReturnsDataLossOnBadPacket) {
   EXPECT_EQ(context.client().ProcessPacket(bad_packet), Status::DataLoss());
 }
 
+Status SendResponse(Client& client,
+                    uint32_t channel_id,
+                    uint32_t service_id,
+                    uint32_t method_id) {
+  Packet packet(PacketType::RESPONSE, channel_id, service_id, method_id);
+  std::byte buffer[64];
+  Result result = packet.Encode(buffer);
+  EXPECT_EQ(result.status(), OkStatus());
+  return client.ProcessPacket(result.value_or(ConstByteSpan()));
+}
+
+TEST(Client, ProcessPacket_ManyCalls_InvokesMatchingCall) {
+  ClientContextForTest context;
+  std::array<TestClientCall, 40> calls;
+
+  for (size_t i = 0; i < calls.size(); ++i) {
+    calls[i] = TestClientCall(&context.channel(),
+                              context.service_id() + i % 3,
+                              context.method_id() + i);
+  }
+  EXPECT_EQ(calls.size(), context.client().active_calls());
+
+  for (size_t i = 0; i < calls.size(); ++i) {
+    ASSERT_EQ(OkStatus(),
+              SendResponse(context.client(),
+                           context.channel_id(),
+                           context.service_id() + i % 3,
+                           context.method_id() + i));
+    for (size_t j = 0; j < calls.size(); ++j) {
+      EXPECT_EQ(j <= i, calls[j].invoked());
+    }
+  }
+}
+
+TEST(Client, ProcessPacket_ManyCalls_UnknownCallNotFound) {
+  ClientContextForTest context;
+  std::array<TestClientCall, 20> calls;
+
+  for (size_t i = 0; i < calls.size(); ++i) {
+    calls[i] = TestClientCall(
+        &context.channel(), context.service_id(), context.method_id() + i);
+  }
+
+  EXPECT_EQ(Status::NotFound(),
+            SendResponse(context.client(),
+                         context.channel_id(),
+                         context.service_id() + 1,
+                         context.method_id()));
+  for (const TestClientCall& call : calls) {
+    EXPECT_FALSE(call.invoked());
+  }
+}
+
+Status SendResponse(Client& client,
+                    uint32_t channel_id,
+                    uint32_t service_id,
+                    uint32_t method_id,
+                    uint32_t call_id) {
+  Packet packet(PacketType::RESPONSE, channel_id, service_id, method_id);
+  packet.set_call_id(call_id);
+  std::byte buffer[64];
+  Result result = packet.Encode(buffer);
+  EXPECT_EQ(result.status(), OkStatus());
+  return client.ProcessPacket(result.value_or(ConstByteSpan()));
+}
+
+TEST(Client, ConcurrentCallsToOneMethod_InvokesMatchingCall) {
+  ClientContextForTest context;
+  std::array<TestClientCall, 3> calls;
+
+  for (TestClientCall& call : calls) {
+    call = TestClientCall(
+        &context.channel(), context.service_id(), context.method_id());
+  }
+  EXPECT_EQ(calls.size(), context.client().active_calls());
+  EXPECT_NE(calls[0].id(), calls[1].id());
+  EXPECT_NE(calls[1].id(), calls[2].id());
+
+  ASSERT_EQ(OkStatus(),
+            SendResponse(context.client(),
+                         context.channel_id(),
+                         context.service_id(),
+                         context.method_id(),
+                         calls[1].id()));
+  EXPECT_FALSE(calls[0].invoked());
+  EXPECT_TRUE(calls[1].invoked());
+  EXPECT_FALSE(calls[2].invoked());
+}
+
+TEST(Client, ResponseWithoutCallId_InvokesCallToMethod) {
+  ClientContextForTest context;
+  TestClientCall call(
+      &context.channel(), context.service_id(), context.method_id());
+
+  // Servers that predate call IDs do not send them back.
+  ASSERT_EQ(OkStatus(),
+            SendResponse(context.client(),
+                         context.channel_id(),
+                         context.service_id(),
+                         context.method_id(),
+                         0));
+  EXPECT_TRUE(call.invoked());
+}
+
+TEST(Client, ResponseWithUnknownCallId_NotFound) {
+  ClientContextForTest context;
+  TestClientCall call(
+      &context.channel(), context.service_id(), context.method_id());
+
+  EXPECT_EQ(Status::NotFound(),
+            SendResponse(context.client(),
+                         context.channel_id(),
+                         context.service_id(),
+                         context.method_id(),
+                         call.id() + 1));
+  EXPECT_FALSE(call.invoked());
+}
+
+TEST(Client, ActiveCalls_CountsRegisteredCalls) {
+  ClientContextForTest context;
+  EXPECT_EQ(0u, context.client().active_calls());
+
+  {
+    TestClientCall one(
+        &context.channel(), context.service_id(), context.method_id());
+    {
+      TestClientCall two(
+          &context.channel(), context.service_id(), context.method_id() + 1);
+      EXPECT_EQ(2u, context.client().active_calls());
+    }
+    EXPECT_EQ(1u, context.client().active_calls());
+  }
+  EXPECT_EQ(0u, context.client().active_calls());
+}
+
 TEST(Client, ProcessPacket_ReturnsInvalidArgumentOnServerPacket) {
   ClientContextForTest context;
   EXPECT_EQ(context.SendPacket(PacketType::REQUEST), Status::InvalidArgument());
@@ -0,0 +1,114 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/dispatcher.h"
+
+#include <cstring>
+#include <mutex>
+
+#include "pw_log/log.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace pw::rpc {
+
+using internal::Packet;
+using internal::QueuedPacket;
+
+Dispatcher::Dispatcher(Server& server,
+                       std::span<Worker> workers,
+                       std::span<QueuedPacket> packets,
+                       std::span<std::byte> packet_buffers)
+    : server_(server),
+      workers_(workers),
+      max_packet_size_bytes_(packet_buffers.size() / packets.size()) {
+  for (Worker& worker : workers_) {
+    worker.dispatcher_ = this;
+  }
+
+  for (size_t i = 0; i < packets.size(); ++i) {
+    packets[i].data_ = packet_buffers.subspan(i * max_packet_size_bytes_,
+                                              max_packet_size_bytes_);
+    free_packets_.push_front(packets[i]);
+  }
+}
+
+Status Dispatcher::Enqueue(ConstByteSpan data, ChannelOutput& interface) {
+  // Only the service ID is needed here; the worker decodes the packet again
+  // when the Server processes it.
+  Result<Packet> packet = Packet::FromBuffer(data);
+  if (!packet.ok()) {
+    PW_LOG_WARN("Failed to decode packet on interface %s", interface.name());
+    return Status::DataLoss();
+  }
+
+  if (data.size() > max_packet_size_bytes_) {
+    PW_LOG_WARN("Dropped %u B packet on interface %s; the maximum is %u B",
+                unsigned(data.size()),
+                interface.name(),
+                unsigned(max_packet_size_bytes_));
+    return Status::ResourceExhausted();
+  }
+
+  QueuedPacket* queued;
+  {
+    std::lock_guard lock(lock_);
+    if (free_packets_.empty()) {
+      return Status::ResourceExhausted();
+    }
+    queued = &free_packets_.front();
+    free_packets_.pop_front();
+  }
+
+  std::memcpy(queued->data_.data(), data.data(), data.size());
+  queued->size_ = data.size();
+  queued->interface_ = &interface;
+
+  Worker& worker = WorkerFor(packet.value().service_id());
+  {
+    std::lock_guard lock(lock_);
+    worker.queue_.push_back(*queued);
+  }
+  worker.pending_.release();
+  return OkStatus();
+}
+
+void Dispatcher::Worker::ProcessPending() {
+  while (pending_.try_acquire()) {
+    ProcessOne();
+  }
+}
+
+void Dispatcher::Worker::Run() {
+  while (true) {
+    pending_.acquire();
+    ProcessOne();
+  }
+}
+
+void Dispatcher::Worker::ProcessOne() {
+  QueuedPacket* queued;
+  {
+    std::lock_guard lock(dispatcher_->lock_);
+    queued = &queue_.front();
+    queue_.pop_front();
+  }
+
+  dispatcher_->server_.ProcessPacket(queued->data_.first(queued->size_),
+                                     *queued->interface_);
+
+  std::lock_guard lock(dispatcher_->lock_);
+  dispatcher_->free_packets_.push_front(*queued);
+}
+
+}  // namespace pw::rpc
@@ -0,0 +1,170 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/dispatcher.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/test_method.h"
+#include "pw_rpc/service.h"
+#include "pw_rpc_private/internal_test_utils.h"
+
+namespace pw::rpc {
+namespace {
+
+using std::byte;
+
+using internal::Packet;
+using internal::PacketType;
+using internal::TestMethod;
+using internal::TestMethodUnion;
+
+class TestService : public Service {
+ public:
+  TestService(uint32_t service_id)
+      : Service(service_id, methods_), methods_{TestMethod(100)} {}
+
+  const TestMethod& method() const { return methods_[0].test_method(); }
+
+ private:
+  std::array<TestMethodUnion, 1> methods_;
+};
+
+// With two workers, service 42 is handled by worker 0 and service 43 by
+// worker 1.
+constexpr uint32_t kServiceForWorker0 = 42;
+constexpr uint32_t kServiceForWorker1 = 43;
+
+constexpr size_t kQueueDepth = 3;
+constexpr size_t kMaxPacketSize = 32;
+
+class DispatcherTest : public ::testing::Test {
+ protected:
+  DispatcherTest()
+      : channels_{Channel::Create<1>(&output_)},
+        server_(channels_),
+        service_0_(kServiceForWorker0),
+        service_1_(kServiceForWorker1),
+        dispatcher_(server_) {
+    server_.RegisterService(service_0_);
+    server_.RegisterService(service_1_);
+  }
+
+  std::span<const byte> EncodeRequest(uint32_t service_id,
+                                      std::span<const byte> payload = {}) {
+    auto result = Packet(PacketType::REQUEST, 1, service_id, 100, payload)
+                      .Encode(request_buffer_);
+    EXPECT_EQ(OkStatus(), result.status());
+    return result.value_or(ConstByteSpan());
+  }
+
+  Status Enqueue(uint32_t service_id, std::span<const byte> payload = {}) {
+    return dispatcher_.Enqueue(EncodeRequest(service_id, payload), output_);
+  }
+
+  TestOutput<128> output_;
+  std::array<Channel, 1> channels_;
+  Server server_;
+  TestService service_0_;
+  TestService service_1_;
+  DispatcherBuffer<2, kQueueDepth, kMaxPacketSize> dispatcher_;
+
+ private:
+  byte request_buffer_[64];
+};
+
+TEST_F(DispatcherTest, Enqueue_DoesNotInvokeMethod) {
+  ASSERT_EQ(OkStatus(), Enqueue(kServiceForWorker0));
+  EXPECT_EQ(0u, service_0_.method().last_channel_id());
+}
+
+TEST_F(DispatcherTest, ProcessPending_InvokesMethodWithCopiedPacket) {
+  constexpr byte kPayload[] = {byte{1}, byte{2}, byte{3}};
+  std::array<byte, 64> packet{};
+  const ConstByteSpan encoded = EncodeRequest(kServiceForWorker0, kPayload);
+  std::memcpy(packet.data(), encoded.data(), encoded.size());
+
+  ASSERT_EQ(OkStatus(),
+            dispatcher_.Enqueue(std::span(packet).first(encoded.size()),
+                                output_));
+  packet.fill(byte{0});
+
+  dispatcher_.worker(0).ProcessPending();
+
+  const TestMethod& method = service_0_.method();
+  EXPECT_EQ(1u, method.last_channel_id());
+  ASSERT_EQ(sizeof(kPayload), method.last_request().payload().size());
+  EXPECT_EQ(0,
+            std::memcmp(kPayload,
+                        method.last_request().payload().data(),
+                        sizeof(kPayload)));
+}
+
+TEST_F(DispatcherTest, ServicesAreProcessedByTheirWorkers) {
+  ASSERT_EQ(OkStatus(), Enqueue(kServiceForWorker0));
+  ASSERT_EQ(OkStatus(), Enqueue(kServiceForWorker1));
+
+  dispatcher_.worker(1).ProcessPending();
+  EXPECT_EQ(0u, service_0_.method().last_channel_id());
+  EXPECT_EQ(1u, service_1_.method().last_channel_id());
+
+  dispatcher_.worker(0).ProcessPending();
+  EXPECT_EQ(1u, service_0_.method().last_channel_id());
+}
+
+TEST_F(DispatcherTest, PacketsAreProcessedInOrder) {
+  constexpr byte kFirst[] = {byte{1}};
+  constexpr byte kSecond[] = {byte{2}};
+  ASSERT_EQ(OkStatus(), Enqueue(kServiceForWorker0, kFirst));
+  ASSERT_EQ(OkStatus(), Enqueue(kServiceForWorker0, kSecond));
+
+  dispatcher_.worker(0).ProcessPending();
+
+  // The method records the last request, which is the second.
+  ASSERT_EQ(1u, service_0_.method().last_request().payload().size());
+  EXPECT_EQ(byte{2}, service_0_.method().last_request().payload()[0]);
+}
+
+TEST_F(DispatcherTest, Enqueue_QueueFull_ResourceExhausted) {
+  for (size_t i = 0; i < kQueueDepth; ++i) {
+    ASSERT_EQ(OkStatus(), Enqueue(kServiceForWorker0));
+  }
+  EXPECT_EQ(Status::ResourceExhausted(), Enqueue(kServiceForWorker1));
+
+  // Processing the queued packets frees their buffers.
+  dispatcher_.worker(0).ProcessPending();
+  EXPECT_EQ(OkStatus(), Enqueue(kServiceForWorker1));
+}
+
+TEST_F(DispatcherTest, Enqueue_PacketTooLarge_ResourceExhausted) {
+  std::array<byte, kMaxPacketSize> payload{};
+  EXPECT_EQ(Status::ResourceExhausted(), Enqueue(kServiceForWorker0, payload));
+}
+
+TEST_F(DispatcherTest, Enqueue_BadPacket_DataLoss) {
+  constexpr byte kBadPacket[] = {byte{0xff}, byte{0xff}, byte{0xff}};
+  EXPECT_EQ(Status::DataLoss(), dispatcher_.Enqueue(kBadPacket, output_));
+}
+
+TEST_F(DispatcherTest, MaxPacketSize) {
+  EXPECT_EQ(kMaxPacketSize, dispatcher_.max_packet_size_bytes());
+  EXPECT_EQ(2u, dispatcher_.worker_count());
+}
+
+}  // namespace
+}  // namespace pw::rpc
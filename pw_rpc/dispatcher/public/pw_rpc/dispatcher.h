@@ -0,0 +1,173 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_containers/intrusive_list.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/server.h"
+#include "pw_status/status.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::rpc {
+
+class Dispatcher;
+
+namespace internal {
+
+// A packet copied out of the receive path, waiting to be processed.
+class QueuedPacket : public IntrusiveList<QueuedPacket>::Item {
+ public:
+  constexpr QueuedPacket() : interface_(nullptr), data_{}, size_(0) {}
+
+ private:
+  friend class rpc::Dispatcher;
+
+  ChannelOutput* interface_;
+  std::span<std::byte> data_;
+  size_t size_;
+};
+
+}  // namespace internal
+
+// Queues incoming packets so that a Server processes them on worker threads
+// rather than on the thread that received them. Enqueue copies the packet into
+// one of a fixed pool of buffers and returns without waiting for the method to
+// run, so a slow RPC handler does not hold up the receive path.
+//
+// Each worker is a thread::ThreadCore, to be run in its own thread:
+//
+//   pw::rpc::DispatcherBuffer<2, 8, 256> dispatcher(server);
+//
+//   pw::thread::Thread(worker_options_0, dispatcher.worker(0)).detach();
+//   pw::thread::Thread(worker_options_1, dispatcher.worker(1)).detach();
+//
+//   // On the receive thread:
+//   dispatcher.Enqueue(packet, output);
+//
+// All packets for a service are processed by the same worker, in the order in
+// which they were enqueued, so packets for a call are never reordered. Methods
+// of services on different workers run concurrently. The ChannelOutputs must
+// therefore be thread safe (see SynchronizedChannelOutput), and since the
+// Server does not synchronize its channels or server streaming writers, use a
+// single worker if channels are assigned dynamically or if services on
+// different workers have server streaming RPCs.
+class Dispatcher {
+ public:
+  class Worker final : public thread::ThreadCore {
+   public:
+    Worker() : dispatcher_(nullptr) {}
+
+    // Processes the packets queued for this worker without blocking. This is
+    // an alternative to running the worker in a thread.
+    void ProcessPending();
+
+   private:
+    friend class Dispatcher;
+
+    // Processes packets for this worker as they arrive. Does not return.
+    void Run() override;
+
+    void ProcessOne();
+
+    Dispatcher* dispatcher_;
+    sync::CountingSemaphore pending_;
+    IntrusiveList<internal::QueuedPacket> queue_;
+  };
+
+  Dispatcher(const Dispatcher&) = delete;
+  Dispatcher& operator=(const Dispatcher&) = delete;
+
+  // Copies a packet into a free buffer and queues it for the worker that
+  // handles its service. This does not block and is safe to call from an
+  // interrupt. Returns:
+  //
+  //   OK - The packet was queued.
+  //   DATA_LOSS - Failed to decode the packet.
+  //   RESOURCE_EXHAUSTED - No buffers are free, or the packet is larger than
+  //       a buffer. The packet is dropped.
+  //
+  Status Enqueue(ConstByteSpan packet, ChannelOutput& interface);
+
+  Worker& worker(size_t index) { return workers_[index]; }
+
+  size_t worker_count() const { return workers_.size(); }
+
+  // The largest packet that can be queued.
+  size_t max_packet_size_bytes() const { return max_packet_size_bytes_; }
+
+ protected:
+  // Splits packet_buffers into one buffer per QueuedPacket.
+  Dispatcher(Server& server,
+             std::span<Worker> workers,
+             std::span<internal::QueuedPacket> packets,
+             std::span<std::byte> packet_buffers);
+
+ private:
+  Worker& WorkerFor(uint32_t service_id) {
+    return workers_[service_id % workers_.size()];
+  }
+
+  Server& server_;
+  std::span<Worker> workers_;
+  const size_t max_packet_size_bytes_;
+
+  sync::InterruptSpinLock lock_;
+  IntrusiveList<internal::QueuedPacket> free_packets_ PW_GUARDED_BY(lock_);
+};
+
+namespace internal {
+
+// Storage for a DispatcherBuffer. This is a base class so that it is
+// constructed before the Dispatcher that uses it.
+template <size_t kWorkers, size_t kQueueDepth, size_t kMaxPacketSizeBytes>
+struct DispatcherStorage {
+  std::array<Dispatcher::Worker, kWorkers> workers;
+  std::array<QueuedPacket, kQueueDepth> packets;
+  std::array<std::byte, kQueueDepth * kMaxPacketSizeBytes> packet_buffers;
+};
+
+}  // namespace internal
+
+// Allocates storage for a Dispatcher with kWorkers workers, which can queue up
+// to kQueueDepth packets of at most kMaxPacketSizeBytes.
+template <size_t kWorkers, size_t kQueueDepth, size_t kMaxPacketSizeBytes>
+class DispatcherBuffer
+    : private internal::
+          DispatcherStorage<kWorkers, kQueueDepth, kMaxPacketSizeBytes>,
+      public Dispatcher {
+ public:
+  static_assert(kWorkers > 0u, "A Dispatcher requires at least one worker");
+  static_assert(kQueueDepth > 0u, "A Dispatcher requires at least one buffer");
+
+  explicit DispatcherBuffer(Server& server)
+      : Dispatcher(server,
+                   Storage::workers,
+                   Storage::packets,
+                   Storage::packet_buffers) {}
+
+ private:
+  using Storage = internal::
+      DispatcherStorage<kWorkers, kQueueDepth, kMaxPacketSizeBytes>;
+};
+
+}  // namespace pw::rpc
@@ -0,0 +1,160 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_metric/metric.h"
+#include "pw_rpc/server_instrumentation.h"
+#include "pw_status/status.h"
+
+namespace pw::rpc {
+namespace internal {
+
+class BaseServerMetrics;
+
+}  // namespace internal
+
+// Metrics for one RPC method. Latencies are the time from when the server
+// receives a request until the method's handler returns, which includes
+// sending the response for unary RPCs.
+class MethodMetrics {
+ public:
+  MethodMetrics() = default;
+
+  MethodMetrics(const MethodMetrics&) = delete;
+  MethodMetrics& operator=(const MethodMetrics&) = delete;
+
+  uint32_t service_id() const { return service_id_.value(); }
+  uint32_t method_id() const { return method_id_.value(); }
+
+  uint32_t calls() const { return calls_.value(); }
+  uint32_t bytes_in() const { return bytes_in_.value(); }
+  uint32_t responses() const { return responses_.value(); }
+  uint32_t bytes_out() const { return bytes_out_.value(); }
+
+  // Responses that failed to encode or send.
+  uint32_t response_failures() const { return response_failures_.value(); }
+
+  uint32_t streams_finished() const { return streams_finished_.value(); }
+
+  // Latency histogram buckets.
+  uint32_t latency_under_100us() const { return latency_under_100us_.value(); }
+  uint32_t latency_under_1ms() const { return latency_under_1ms_.value(); }
+  uint32_t latency_under_10ms() const { return latency_under_10ms_.value(); }
+  uint32_t latency_under_100ms() const { return latency_under_100ms_.value(); }
+  uint32_t latency_over_100ms() const { return latency_over_100ms_.value(); }
+
+  uint32_t max_latency_us() const { return max_latency_us_.value(); }
+
+  metric::Group& metrics() { return metrics_; }
+
+ private:
+  friend class internal::BaseServerMetrics;
+
+  void Assign(uint32_t service_id, uint32_t method_id) {
+    service_id_.Set(service_id);
+    method_id_.Set(method_id);
+  }
+
+  void RecordLatency(uint32_t latency_us);
+
+  PW_METRIC_GROUP(metrics_, "method");
+  PW_METRIC(metrics_, service_id_, "service_id", 0u);
+  PW_METRIC(metrics_, method_id_, "method_id", 0u);
+  PW_METRIC(metrics_, calls_, "calls", 0u);
+  PW_METRIC(metrics_, bytes_in_, "bytes_in", 0u);
+  PW_METRIC(metrics_, responses_, "responses", 0u);
+  PW_METRIC(metrics_, bytes_out_, "bytes_out", 0u);
+  PW_METRIC(metrics_, response_failures_, "response_failures", 0u);
+  PW_METRIC(metrics_, streams_finished_, "streams_finished", 0u);
+  PW_METRIC(metrics_, latency_under_100us_, "latency_under_100us", 0u);
+  PW_METRIC(metrics_, latency_under_1ms_, "latency_under_1ms", 0u);
+  PW_METRIC(metrics_, latency_under_10ms_, "latency_under_10ms", 0u);
+  PW_METRIC(metrics_, latency_under_100ms_, "latency_under_100ms", 0u);
+  PW_METRIC(metrics_, latency_over_100ms_, "latency_over_100ms", 0u);
+  PW_METRIC(metrics_, max_latency_us_, "max_latency_us", 0u);
+};
+
+namespace internal {
+
+// Non-templated base so the code is shared between ServerMetrics with
+// different numbers of methods.
+class BaseServerMetrics : public ServerInstrumentation {
+ public:
+  // The group with a child group for each method that has been called. Serve
+  // this group with pw::metric::MetricService to read the metrics remotely.
+  metric::Group& metrics() { return metrics_; }
+
+  // Returns the metrics for a method, or null if it has not been called.
+  const MethodMetrics* Find(uint32_t service_id, uint32_t method_id) const;
+
+  // Calls for methods after every method slot is used are not tracked.
+  uint32_t untracked_calls() const { return untracked_calls_.value(); }
+
+  int64_t RequestReceived(uint32_t service_id,
+                          uint32_t method_id,
+                          size_t payload_size_bytes) override;
+
+  void MethodReturned(uint32_t service_id,
+                      uint32_t method_id,
+                      int64_t request_received) override;
+
+  void ResponseSent(uint32_t service_id,
+                    uint32_t method_id,
+                    size_t payload_size_bytes,
+                    Status status) override;
+
+  void StreamFinished(uint32_t service_id,
+                      uint32_t method_id,
+                      Status status) override;
+
+ protected:
+  BaseServerMetrics(std::span<MethodMetrics> methods)
+      : methods_(methods), assigned_methods_(0) {}
+
+ private:
+  MethodMetrics* FindMethod(uint32_t service_id, uint32_t method_id) {
+    return const_cast<MethodMetrics*>(Find(service_id, method_id));
+  }
+
+  // Finds the method's metrics or assigns a slot for them if there is room.
+  MethodMetrics* FindOrAssign(uint32_t service_id, uint32_t method_id);
+
+  PW_METRIC_GROUP(metrics_, "rpc_server");
+  PW_METRIC(metrics_, untracked_calls_, "untracked_calls", 0u);
+
+  std::span<MethodMetrics> methods_;
+  size_t assigned_methods_;
+};
+
+}  // namespace internal
+
+// Records per-method pw_metric metrics for up to kMaxMethods methods. Register
+// it with Server::set_instrumentation; PW_RPC_SERVER_INSTRUMENTATION must be
+// enabled. Like pw_metric, ServerMetrics is not synchronized; it may only be
+// used with a server that processes packets from one thread.
+template <size_t kMaxMethods>
+class ServerMetrics : public internal::BaseServerMetrics {
+ public:
+  ServerMetrics() : internal::BaseServerMetrics(methods_) {}
+
+ private:
+  std::array<MethodMetrics, kMaxMethods> methods_;
+};
+
+}  // namespace pw::rpc
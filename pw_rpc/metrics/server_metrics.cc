@@ -0,0 +1,136 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/server_metrics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "pw_chrono/system_clock.h"
+
+namespace pw::rpc {
+
+using chrono::SystemClock;
+
+void MethodMetrics::RecordLatency(uint32_t latency_us) {
+  if (latency_us < 100u) {
+    latency_under_100us_.Increment();
+  } else if (latency_us < 1'000u) {
+    latency_under_1ms_.Increment();
+  } else if (latency_us < 10'000u) {
+    latency_under_10ms_.Increment();
+  } else if (latency_us < 100'000u) {
+    latency_under_100ms_.Increment();
+  } else {
+    latency_over_100ms_.Increment();
+  }
+
+  if (latency_us > max_latency_us_.value()) {
+    max_latency_us_.Set(latency_us);
+  }
+}
+
+namespace internal {
+
+const MethodMetrics* BaseServerMetrics::Find(uint32_t service_id,
+                                             uint32_t method_id) const {
+  for (size_t i = 0; i < assigned_methods_; ++i) {
+    if (methods_[i].service_id() == service_id &&
+        methods_[i].method_id() == method_id) {
+      return &methods_[i];
+    }
+  }
+  return nullptr;
+}
+
+MethodMetrics* BaseServerMetrics::FindOrAssign(uint32_t service_id,
+                                               uint32_t method_id) {
+  if (MethodMetrics* method = FindMethod(service_id, method_id);
+      method != nullptr) {
+    return method;
+  }
+
+  if (assigned_methods_ == methods_.size()) {
+    return nullptr;
+  }
+
+  // Methods are only added to the group once they are used, so unused slots
+  // are not reported.
+  MethodMetrics& method = methods_[assigned_methods_++];
+  method.Assign(service_id, method_id);
+  metrics_.Add(method.metrics());
+  return &method;
+}
+
+int64_t BaseServerMetrics::RequestReceived(uint32_t service_id,
+                                           uint32_t method_id,
+                                           size_t payload_size_bytes) {
+  if (MethodMetrics* method = FindOrAssign(service_id, method_id);
+      method != nullptr) {
+    method->calls_.Increment();
+    method->bytes_in_.Increment(payload_size_bytes);
+  } else {
+    untracked_calls_.Increment();
+  }
+
+  return SystemClock::now().time_since_epoch().count();
+}
+
+void BaseServerMetrics::MethodReturned(uint32_t service_id,
+                                       uint32_t method_id,
+                                       int64_t request_received) {
+  MethodMetrics* method = FindMethod(service_id, method_id);
+  if (method == nullptr) {
+    return;
+  }
+
+  const SystemClock::duration latency =
+      SystemClock::now() -
+      SystemClock::time_point(SystemClock::duration(request_received));
+  const int64_t latency_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+
+  method->RecordLatency(static_cast<uint32_t>(std::clamp<int64_t>(
+      latency_us, 0, std::numeric_limits<uint32_t>::max())));
+}
+
+void BaseServerMetrics::ResponseSent(uint32_t service_id,
+                                     uint32_t method_id,
+                                     size_t payload_size_bytes,
+                                     Status status) {
+  MethodMetrics* method = FindMethod(service_id, method_id);
+  if (method == nullptr) {
+    return;
+  }
+
+  if (status.ok()) {
+    method->responses_.Increment();
+    method->bytes_out_.Increment(payload_size_bytes);
+  } else {
+    method->response_failures_.Increment();
+  }
+}
+
+void BaseServerMetrics::StreamFinished(uint32_t service_id,
+                                       uint32_t method_id,
+                                       Status) {
+  if (MethodMetrics* method = FindMethod(service_id, method_id);
+      method != nullptr) {
+    method->streams_finished_.Increment();
+  }
+}
+
+}  // namespace internal
+}  // namespace pw::rpc
@@ -0,0 +1,131 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/server_metrics.h"
+
+#include "gtest/gtest.h"
+
+namespace pw::rpc {
+namespace {
+
+constexpr uint32_t kServiceId = 16;
+constexpr uint32_t kMethodId = 111;
+
+uint32_t LatencySamples(const MethodMetrics& method) {
+  return method.latency_under_100us() + method.latency_under_1ms() +
+         method.latency_under_10ms() + method.latency_under_100ms() +
+         method.latency_over_100ms();
+}
+
+TEST(ServerMetrics, NoMethodsCalled) {
+  ServerMetrics<2> metrics;
+
+  EXPECT_EQ(nullptr, metrics.Find(kServiceId, kMethodId));
+  EXPECT_EQ(0u, metrics.untracked_calls());
+  EXPECT_TRUE(metrics.metrics().children().empty());
+}
+
+TEST(ServerMetrics, RequestReceived_CountsCallsAndBytes) {
+  ServerMetrics<2> metrics;
+
+  metrics.RequestReceived(kServiceId, kMethodId, 10);
+  metrics.RequestReceived(kServiceId, kMethodId, 5);
+
+  const MethodMetrics* method = metrics.Find(kServiceId, kMethodId);
+  ASSERT_NE(nullptr, method);
+  EXPECT_EQ(kServiceId, method->service_id());
+  EXPECT_EQ(kMethodId, method->method_id());
+  EXPECT_EQ(2u, method->calls());
+  EXPECT_EQ(15u, method->bytes_in());
+}
+
+TEST(ServerMetrics, MethodReturned_RecordsLatency) {
+  ServerMetrics<2> metrics;
+
+  const int64_t received = metrics.RequestReceived(kServiceId, kMethodId, 0);
+  metrics.MethodReturned(kServiceId, kMethodId, received);
+
+  const MethodMetrics* method = metrics.Find(kServiceId, kMethodId);
+  ASSERT_NE(nullptr, method);
+  EXPECT_EQ(1u, LatencySamples(*method));
+}
+
+TEST(ServerMetrics, MethodReturned_UnknownMethod_Ignored) {
+  ServerMetrics<2> metrics;
+
+  metrics.MethodReturned(kServiceId, kMethodId, 0);
+
+  EXPECT_EQ(nullptr, metrics.Find(kServiceId, kMethodId));
+}
+
+TEST(ServerMetrics, ResponseSent_CountsResponsesAndFailures) {
+  ServerMetrics<2> metrics;
+  metrics.RequestReceived(kServiceId, kMethodId, 0);
+
+  metrics.ResponseSent(kServiceId, kMethodId, 20, OkStatus());
+  metrics.ResponseSent(kServiceId, kMethodId, 30, OkStatus());
+  metrics.ResponseSent(kServiceId, kMethodId, 40, Status::Unavailable());
+
+  const MethodMetrics* method = metrics.Find(kServiceId, kMethodId);
+  ASSERT_NE(nullptr, method);
+  EXPECT_EQ(2u, method->responses());
+  EXPECT_EQ(50u, method->bytes_out());
+  EXPECT_EQ(1u, method->response_failures());
+}
+
+TEST(ServerMetrics, StreamFinished_CountsStreams) {
+  ServerMetrics<2> metrics;
+  metrics.RequestReceived(kServiceId, kMethodId, 0);
+
+  metrics.StreamFinished(kServiceId, kMethodId, OkStatus());
+
+  const MethodMetrics* method = metrics.Find(kServiceId, kMethodId);
+  ASSERT_NE(nullptr, method);
+  EXPECT_EQ(1u, method->streams_finished());
+}
+
+TEST(ServerMetrics, MethodsTrackedSeparately) {
+  ServerMetrics<2> metrics;
+
+  metrics.RequestReceived(kServiceId, kMethodId, 1);
+  metrics.RequestReceived(kServiceId, kMethodId + 1, 2);
+  metrics.RequestReceived(kServiceId, kMethodId + 1, 3);
+
+  ASSERT_NE(nullptr, metrics.Find(kServiceId, kMethodId));
+  ASSERT_NE(nullptr, metrics.Find(kServiceId, kMethodId + 1));
+  EXPECT_EQ(1u, metrics.Find(kServiceId, kMethodId)->calls());
+  EXPECT_EQ(2u, metrics.Find(kServiceId, kMethodId + 1)->calls());
+
+  size_t method_groups = 0;
+  for ([[maybe_unused]] const metric::Group& group :
+       metrics.metrics().children()) {
+    method_groups += 1;
+  }
+  EXPECT_EQ(2u, method_groups);
+}
+
+TEST(ServerMetrics, Full_CountsUntrackedCalls) {
+  ServerMetrics<1> metrics;
+
+  metrics.RequestReceived(kServiceId, kMethodId, 1);
+  metrics.RequestReceived(kServiceId, kMethodId + 1, 2);
+  metrics.RequestReceived(kServiceId + 1, kMethodId, 3);
+
+  EXPECT_NE(nullptr, metrics.Find(kServiceId, kMethodId));
+  EXPECT_EQ(nullptr, metrics.Find(kServiceId, kMethodId + 1));
+  EXPECT_EQ(2u, metrics.untracked_calls());
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -0,0 +1,143 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program measures end-to-end unary round-trip latency and server stream
+// throughput for Nanopb RPC methods, with a client and server connected in
+// memory. Build the nanopb_loopback_benchmark target and run it; results are
+// logged with pw_log.
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_log/log.h"
+#include "pw_rpc/benchmark/benchmark.rpc.pb.h"
+#include "pw_rpc_private/loopback_benchmark.h"
+
+namespace pw::rpc {
+namespace {
+
+using BenchmarkClient = benchmark::nanopb::BenchmarkClient;
+
+class BenchmarkService final
+    : public benchmark::generated::Benchmark<BenchmarkService> {
+ public:
+  static Status UnaryEcho(ServerContext&,
+                          const pw_rpc_benchmark_Payload& request,
+                          pw_rpc_benchmark_Payload& response) {
+    response = request;
+    return OkStatus();
+  }
+
+  static void ServerStream(ServerContext&,
+                           const pw_rpc_benchmark_StreamRequest& request,
+                           ServerWriter<pw_rpc_benchmark_Payload>& writer) {
+    pw_rpc_benchmark_Payload response{};
+    if (request.payload_size > sizeof(response.data.bytes)) {
+      writer.Finish(Status::InvalidArgument());
+      return;
+    }
+    response.data.size = request.payload_size;
+
+    for (uint32_t i = 0; i < request.responses; ++i) {
+      if (!writer.Write(response).ok()) {
+        writer.Finish(Status::Internal());
+        return;
+      }
+    }
+    writer.Finish();
+  }
+};
+
+class NanopbBenchmarkCalls
+    : public internal::LoopbackBenchmarkCalls,
+      public UnaryResponseHandler<pw_rpc_benchmark_Payload>,
+      public ServerStreamingResponseHandler<pw_rpc_benchmark_Payload> {
+ public:
+  Status StartUnaryEcho(rpc::Channel& channel, size_t payload_size) override {
+    pw_rpc_benchmark_Payload request{};
+    if (payload_size > sizeof(request.data.bytes)) {
+      return Status::InvalidArgument();
+    }
+    request.data.size = payload_size;
+
+    unary_call_ = BenchmarkClient::UnaryEcho(
+        channel, request, static_cast<UnaryHandler&>(*this));
+    return OkStatus();
+  }
+
+  Status StartServerStream(rpc::Channel& channel,
+                           uint32_t responses,
+                           size_t payload_size) override {
+    const pw_rpc_benchmark_StreamRequest request{
+        .responses = responses,
+        .payload_size = static_cast<uint32_t>(payload_size),
+    };
+    stream_call_ = BenchmarkClient::ServerStream(
+        channel, request, static_cast<StreamHandler&>(*this));
+    return OkStatus();
+  }
+
+  size_t responses() const override { return responses_; }
+  size_t response_bytes() const override { return response_bytes_; }
+  bool stream_finished() const override { return stream_finished_; }
+
+  void Reset() override {
+    responses_ = 0;
+    response_bytes_ = 0;
+    stream_finished_ = false;
+  }
+
+ private:
+  using UnaryHandler = UnaryResponseHandler<pw_rpc_benchmark_Payload>;
+  using StreamHandler =
+      ServerStreamingResponseHandler<pw_rpc_benchmark_Payload>;
+
+  // UnaryResponseHandler
+  void ReceivedResponse(Status,
+                        const pw_rpc_benchmark_Payload& response) override {
+    ReceivedResponse(response);
+  }
+
+  // ServerStreamingResponseHandler
+  void ReceivedResponse(const pw_rpc_benchmark_Payload& response) override {
+    responses_ += 1;
+    response_bytes_ += response.data.size;
+  }
+
+  void Complete(Status) override { stream_finished_ = true; }
+
+  // Shared by both handlers.
+  void RpcError(Status status) override {
+    PW_LOG_ERROR("RPC failed with status %s", status.str());
+  }
+
+  BenchmarkClient::UnaryEchoCall unary_call_;
+  BenchmarkClient::ServerStreamCall stream_call_;
+  size_t responses_ = 0;
+  size_t response_bytes_ = 0;
+  bool stream_finished_ = false;
+};
+
+}  // namespace
+}  // namespace pw::rpc
+
+int main() {
+  pw::rpc::BenchmarkService service;
+  pw::rpc::NanopbBenchmarkCalls calls;
+
+  return pw::rpc::internal::RunLoopbackBenchmarks("Nanopb", service, calls)
+                 .ok()
+             ? 0
+             : 1;
+}
@@ -17,7 +17,8 @@
 namespace pw::rpc {
 namespace internal {
 
-Status BaseNanopbClientCall::SendRequest(const void* request_struct) {
+Status BaseNanopbClientCall::SendRequest(const void* request_struct,
+                                         uint32_t stream_credit) {
   std::span<std::byte> buffer = AcquirePayloadBuffer();
 
   StatusWithSize sws = serde_.EncodeRequest(buffer, request_struct);
@@ -26,7 +27,7 @@ Status BaseNanopbClientCall::SendRequest(const void* request_struct) {
     return sws.status();
   }
 
-  return ReleasePayloadBuffer(buffer.first(sws.size()));
+  return ReleasePayloadBuffer(buffer.first(sws.size()), stream_credit);
 }
 
 }  // namespace internal
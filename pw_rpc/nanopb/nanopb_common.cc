@@ -14,10 +14,14 @@
 
 #include "pw_rpc/internal/nanopb_common.h"
 
+#include "pb_common.h"
 #include "pb_decode.h"
 #include "pb_encode.h"
+#include "pw_rpc/nanopb_bytes_view.h"
+#include "pw_varint/varint.h"
 
-namespace pw::rpc::internal {
+namespace pw::rpc {
+namespace internal {
 
 // Nanopb 3 uses pb_field_s and Nanopb 4 uses pb_msgdesc_s for fields. The
 // Nanopb version macro is difficult to use, so deduce the correct type from the
@@ -32,6 +36,58 @@ struct NanopbTraits<bool(pb_istream_t*, FieldsType, void*)> {
 
 using Fields = typename NanopbTraits<decltype(pb_decode)>::Fields;
 
+namespace {
+
+// Nanopb 4's field iterator stores the field type, while Nanopb 3's points to
+// the field descriptor.
+template <typename Iterator>
+auto FieldType(const Iterator& field) -> decltype(field.type) {
+  return field.type;
+}
+
+template <typename Iterator>
+auto FieldType(const Iterator& field) -> decltype(field.pos->type) {
+  return field.pos->type;
+}
+
+// Decode callback for bytes and string fields that records where the field's
+// data is in the encoded message. pw_rpc always decodes from a buffer, so the
+// stream's state points to the data. Only the pointer fits in the callback's
+// arg, so NanopbBytesView recovers the size from the preceding length prefix.
+bool DecodeView(pb_istream_t* stream, const pb_field_t*, void** arg) {
+  *arg = stream->state;
+  return pb_read(stream, nullptr, stream->bytes_left);
+}
+
+// Sets up the top-level callback bytes and string fields that have no decode
+// callback to be decoded as views. A struct may be reused between calls, so
+// views left from a previous decode are cleared.
+void PrepareViewFields(Fields fields, void* proto_struct) {
+  pb_field_iter_t field;
+  if (!pb_field_iter_begin(&field, fields, proto_struct)) {
+    return;  // The message has no fields.
+  }
+
+  do {
+    const pb_type_t type = FieldType(field);
+    if (PB_ATYPE(type) != PB_ATYPE_CALLBACK ||
+        PB_HTYPE(type) == PB_HTYPE_ONEOF ||
+        (PB_LTYPE(type) != PB_LTYPE_BYTES &&
+         PB_LTYPE(type) != PB_LTYPE_STRING)) {
+      continue;
+    }
+
+    pb_callback_t& callback = *static_cast<pb_callback_t*>(field.pData);
+    if (callback.funcs.decode == nullptr ||
+        callback.funcs.decode == DecodeView) {
+      callback.funcs.decode = DecodeView;
+      callback.arg = nullptr;
+    }
+  } while (pb_field_iter_next(&field));
+}
+
+}  // namespace
+
 StatusWithSize NanopbMethodSerde::Encode(NanopbMessageDescriptor fields,
                                          ByteSpan buffer,
                                          const void* proto_struct) const {
@@ -47,9 +103,32 @@ StatusWithSize NanopbMethodSerde::Encode(NanopbMessageDescriptor fields,
 bool NanopbMethodSerde::Decode(NanopbMessageDescriptor fields,
                                void* proto_struct,
                                ConstByteSpan buffer) const {
+  PrepareViewFields(static_cast<Fields>(fields), proto_struct);
+
   auto input = pb_istream_from_buffer(
       reinterpret_cast<const pb_byte_t*>(buffer.data()), buffer.size());
   return pb_decode(&input, static_cast<Fields>(fields), proto_struct);
 }
 
-}  // namespace pw::rpc::internal
+}  // namespace internal
+
+ConstByteSpan NanopbBytesView(const pb_callback_t& field) {
+  if (field.funcs.decode != internal::DecodeView || field.arg == nullptr) {
+    return ConstByteSpan();
+  }
+
+  // The field's length is a varint that ends right before the data. The last
+  // byte of a varint has its top bit clear, so the length starts just after
+  // the last byte of the field key, which is the previous such byte.
+  const std::byte* const data = static_cast<const std::byte*>(field.arg);
+  const std::byte* length = data - 1;
+  while ((length[-1] & std::byte{0x80}) != std::byte{0}) {
+    length -= 1;
+  }
+
+  uint64_t size = 0;
+  varint::Decode(ConstByteSpan(length, data - length), &size);
+  return ConstByteSpan(data, static_cast<size_t>(size));
+}
+
+}  // namespace pw::rpc
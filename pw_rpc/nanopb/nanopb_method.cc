@@ -18,6 +18,7 @@
 #include "pb_encode.h"
 #include "pw_log/log.h"
 #include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/server.h"
 
 namespace pw::rpc::internal {
 
@@ -32,7 +33,7 @@ void NanopbMethod::CallUnary(ServerCall& call,
   }
 
   const Status status = function_.unary(call, request_struct, response_struct);
-  SendResponse(call.channel(), request, response_struct, status);
+  SendResponse(call, request, response_struct, status);
 }
 
 void NanopbMethod::CallServerStreaming(ServerCall& call,
@@ -46,6 +47,14 @@ void NanopbMethod::CallServerStreaming(ServerCall& call,
   function_.server_streaming(call, request_struct, server_writer);
 }
 
+void NanopbMethod::SendPoolExhaustedError(ServerCall& call,
+                                          const Packet& request) {
+  PW_LOG_WARN("No Nanopb struct pool block for request from channel %u",
+              unsigned(call.channel().id()));
+  call.channel().Send(
+      Packet::ServerError(request, Status::ResourceExhausted()));
+}
+
 bool NanopbMethod::DecodeRequest(Channel& channel,
                                  const Packet& request,
                                  void* proto_struct) const {
@@ -59,10 +68,11 @@ bool NanopbMethod::DecodeRequest(Channel& channel,
   return false;
 }
 
-void NanopbMethod::SendResponse(Channel& channel,
+void NanopbMethod::SendResponse(ServerCall& call,
                                 const Packet& request,
                                 const void* response_struct,
                                 Status status) const {
+  Channel& channel = call.channel();
   Channel::OutputBuffer response_buffer = channel.AcquireBuffer();
   std::span payload_buffer = response_buffer.payload(request);
 
@@ -74,6 +84,7 @@ void NanopbMethod::SendResponse(Channel& channel,
     response.set_payload(payload_buffer.first(encoded.size()));
     response.set_status(status);
     pw::Status send_status = channel.Send(response_buffer, response);
+    call.server().ResponseSent(response, encoded.size(), send_status);
     if (send_status.ok()) {
       return;
     }
@@ -89,6 +100,8 @@ void NanopbMethod::SendResponse(Channel& channel,
         "Nanopb failed to encode response packet for channel %u, status %u",
         unsigned(channel.id()),
         encoded.status().code());
+    call.server().ResponseSent(
+        Packet::Response(request), 0, Status::Internal());
   }
   channel.Send(response_buffer,
                Packet::ServerError(request, Status::Internal()));
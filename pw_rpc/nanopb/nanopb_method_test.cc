@@ -18,6 +18,7 @@
 
 #include "gtest/gtest.h"
 #include "pw_rpc/internal/nanopb_method_union.h"
+#include "pw_rpc/nanopb_bytes_view.h"
 #include "pw_rpc/server_context.h"
 #include "pw_rpc/service.h"
 #include "pw_rpc_nanopb_private/internal_test_utils.h"
@@ -147,17 +148,33 @@ void StartStream(ServerContext&,
   last_writer = std::move(writer);
 }
 
+ConstByteSpan last_data;
+std::string_view last_name;
+uint32_t last_id;
+
+Status ReadViews(ServerContext&,
+                 const pw_rpc_test_TestBytesRequest& request,
+                 pw_rpc_test_TestResponse&) {
+  last_data = NanopbBytesView(request.data);
+  last_name = NanopbStringView(request.name);
+  last_id = request.id;
+  return OkStatus();
+}
+
 class FakeService : public Service {
  public:
   FakeService(uint32_t id) : Service(id, kMethods) {}
 
-  static constexpr std::array<NanopbMethodUnion, 3> kMethods = {
+  static constexpr std::array<NanopbMethodUnion, 4> kMethods = {
       NanopbMethod::Unary<DoNothing>(
           10u, pw_rpc_test_Empty_fields, pw_rpc_test_Empty_fields),
       NanopbMethod::Unary<AddFive>(
           11u, pw_rpc_test_TestRequest_fields, pw_rpc_test_TestResponse_fields),
       NanopbMethod::ServerStreaming<StartStream>(
           12u, pw_rpc_test_TestRequest_fields, pw_rpc_test_TestResponse_fields),
+      NanopbMethod::Unary<ReadViews>(13u,
+                                     pw_rpc_test_TestBytesRequest_fields,
+                                     pw_rpc_test_TestResponse_fields),
   };
 };
 
@@ -246,15 +263,16 @@ TEST(NanopbMethod, ServerWriter_SendsResponse) {
   EXPECT_EQ(OkStatus(), last_writer.Write({.value = 100}));
 
   PW_ENCODE_PB(pw_rpc_test_TestResponse, payload, .value = 100);
-  std::array<byte, 128> encoded_response = {};
-  auto encoded = context.packet(payload).Encode(encoded_response);
-  ASSERT_EQ(OkStatus(), encoded.status());
 
-  ASSERT_EQ(encoded.value().size(), context.output().sent_data().size());
+  const Packet& packet = context.output().sent_packet();
+  EXPECT_EQ(PacketType::RESPONSE, packet.type());
+  EXPECT_EQ(OkStatus(), packet.status());
+  EXPECT_EQ(context.service_id(), packet.service_id());
+  EXPECT_EQ(method.id(), packet.method_id());
+  ASSERT_EQ(payload.size(), packet.payload().size());
   EXPECT_EQ(0,
-            std::memcmp(encoded.value().data(),
-                        context.output().sent_data().data(),
-                        encoded.value().size()));
+            std::memcmp(
+                payload.data(), packet.payload().data(), payload.size()));
 }
 
 TEST(NanopbMethod, ServerWriter_WriteWhenClosed_ReturnsFailedPrecondition) {
@@ -308,5 +326,65 @@ TEST(NanopbMethod,
   EXPECT_EQ(Status::Internal(), last_writer.Write({.value = 1}));  // Too big
 }
 
+TEST(NanopbMethod, CallbackFields_DecodedAsViewsIntoPacket) {
+  // data: "abc", name: "hi", id: 7
+  constexpr std::array<byte, 11> request{
+      byte{0x0a}, byte{3},   byte{'a'}, byte{'b'}, byte{'c'}, byte{0x12},
+      byte{2},    byte{'h'}, byte{'i'}, byte{0x18}, byte{7}};
+
+  const NanopbMethod& method =
+      std::get<3>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(), context.packet(request));
+
+  EXPECT_EQ(OkStatus(), context.output().sent_packet().status());
+
+  // The views point into the request payload; nothing was copied.
+  EXPECT_EQ(last_data.data(), &request[2]);
+  EXPECT_EQ(last_data.size(), 3u);
+  EXPECT_EQ(reinterpret_cast<const byte*>(last_name.data()), &request[7]);
+  EXPECT_EQ(last_name, "hi");
+  EXPECT_EQ(last_id, 7u);
+}
+
+TEST(NanopbMethod, CallbackFields_MissingFieldsAreEmpty) {
+  constexpr std::array<byte, 4> request{
+      byte{0x12}, byte{0}, byte{0x18}, byte{9}};
+
+  const NanopbMethod& method =
+      std::get<3>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(), context.packet(request));
+
+  EXPECT_TRUE(last_data.empty());
+  EXPECT_TRUE(last_name.empty());
+  EXPECT_EQ(last_id, 9u);
+}
+
+TEST(NanopbMethod, CallbackFields_MultiByteLength) {
+  std::array<byte, 3 + 200> request{};
+  request[0] = byte{0x0a};
+  request[1] = byte{0xc8};  // 200 as a varint
+  request[2] = byte{0x01};
+  for (size_t i = 3; i < request.size(); ++i) {
+    request[i] = static_cast<byte>(i);
+  }
+
+  const NanopbMethod& method =
+      std::get<3>(FakeService::kMethods).nanopb_method();
+  ServerContextForTest<FakeService> context(method);
+  method.Invoke(context.get(), context.packet(request));
+
+  EXPECT_EQ(last_data.data(), &request[3]);
+  EXPECT_EQ(last_data.size(), 200u);
+  EXPECT_TRUE(last_name.empty());
+}
+
+TEST(NanopbBytesView, NotDecoded_IsEmpty) {
+  pb_callback_t field{};
+  EXPECT_TRUE(NanopbBytesView(field).empty());
+  EXPECT_TRUE(NanopbStringView(field).empty());
+}
+
 }  // namespace
 }  // namespace pw::rpc::internal
@@ -0,0 +1,69 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/nanopb_struct_pool.h"
+
+#include <bitset>
+
+namespace pw::rpc {
+namespace {
+
+// The high-water mark across all pools.
+std::atomic<uint32_t> global_high_water_mark(0);
+
+void UpdateHighWaterMark(std::atomic<uint32_t>& high_water_mark,
+                         uint32_t in_use) {
+  uint32_t current = high_water_mark.load(std::memory_order_relaxed);
+  while (current < in_use && !high_water_mark.compare_exchange_weak(
+                                 current, in_use, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+size_t NanopbStructPoolHighWaterMark() {
+  return global_high_water_mark.load(std::memory_order_relaxed);
+}
+
+namespace internal {
+
+int BaseNanopbStructPool::Acquire() {
+  uint32_t in_use = in_use_.load(std::memory_order_relaxed);
+  uint32_t block;
+
+  do {
+    const uint32_t free_blocks = all_blocks_ & ~in_use;
+    if (free_blocks == 0u) {
+      return kNoBlock;
+    }
+
+    block = free_blocks & (~free_blocks + 1);  // Lowest free block
+  } while (!in_use_.compare_exchange_weak(in_use,
+                                          in_use | block,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed));
+
+  const uint32_t blocks_in_use = std::bitset<32>(in_use | block).count();
+  UpdateHighWaterMark(high_water_mark_, blocks_in_use);
+  UpdateHighWaterMark(global_high_water_mark, blocks_in_use);
+
+  int index = 0;
+  while ((block >>= 1) != 0u) {
+    index += 1;
+  }
+  return index;
+}
+
+}  // namespace internal
+}  // namespace pw::rpc
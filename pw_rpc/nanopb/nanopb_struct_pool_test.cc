@@ -0,0 +1,119 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/nanopb_struct_pool.h"
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#include "gtest/gtest.h"
+
+namespace pw::rpc::internal {
+namespace {
+
+using TestPool = NanopbStructPool<16, 3>;
+
+TEST(NanopbStructPool, Block_DistinctBlocks) {
+  TestPool pool;
+  TestPool::Block first(pool);
+  TestPool::Block second(pool);
+
+  ASSERT_TRUE(first.ok());
+  ASSERT_TRUE(second.ok());
+  EXPECT_NE(first.get(), second.get());
+}
+
+TEST(NanopbStructPool, Block_Exhausted) {
+  TestPool pool;
+  TestPool::Block first(pool);
+  TestPool::Block second(pool);
+  TestPool::Block third(pool);
+  TestPool::Block fourth(pool);
+
+  EXPECT_TRUE(third.ok());
+  EXPECT_FALSE(fourth.ok());
+}
+
+TEST(NanopbStructPool, Block_ReleasedWhenDestroyed) {
+  TestPool pool;
+  TestPool::Block first(pool);
+  TestPool::Block second(pool);
+  void* third_block;
+  {
+    TestPool::Block third(pool);
+    ASSERT_TRUE(third.ok());
+    third_block = third.get();
+  }
+
+  TestPool::Block reused(pool);
+  ASSERT_TRUE(reused.ok());
+  EXPECT_EQ(third_block, reused.get());
+}
+
+TEST(NanopbStructPool, Block_Zeroed) {
+  TestPool pool;
+  {
+    TestPool::Block block(pool);
+    std::memset(block.get(), 0xa5, 16);
+  }
+
+  TestPool::Block block(pool);
+  const std::byte* data = static_cast<const std::byte*>(block.get());
+  for (size_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(std::byte{0}, data[i]);
+  }
+}
+
+TEST(NanopbStructPool, Block_Aligned) {
+  TestPool pool;
+  TestPool::Block first(pool);
+  TestPool::Block second(pool);
+
+  EXPECT_EQ(0u,
+            reinterpret_cast<uintptr_t>(second.get()) %
+                alignof(std::max_align_t));
+}
+
+TEST(NanopbStructPool, HighWaterMark) {
+  TestPool pool;
+  EXPECT_EQ(0u, pool.high_water_mark());
+
+  {
+    TestPool::Block first(pool);
+    TestPool::Block second(pool);
+    EXPECT_EQ(2u, pool.high_water_mark());
+  }
+
+  TestPool::Block block(pool);
+  EXPECT_EQ(2u, pool.high_water_mark());
+  EXPECT_GE(NanopbStructPoolHighWaterMark(), 2u);
+}
+
+TEST(NanopbStructPool, ThirtyTwoBlocks) {
+  NanopbStructPool<8, 32> pool;
+  std::optional<NanopbStructPool<8, 32>::Block> blocks[33];
+
+  for (size_t i = 0; i < 32; ++i) {
+    blocks[i].emplace(pool);
+    EXPECT_TRUE(blocks[i]->ok());
+  }
+
+  blocks[32].emplace(pool);
+  EXPECT_FALSE(blocks[32]->ok());
+  EXPECT_EQ(32u, pool.high_water_mark());
+}
+
+}  // namespace
+}  // namespace pw::rpc::internal
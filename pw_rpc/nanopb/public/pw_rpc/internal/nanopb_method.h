@@ -24,6 +24,7 @@
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/method_type.h"
 #include "pw_rpc/internal/nanopb_common.h"
+#include "pw_rpc/internal/nanopb_struct_pool.h"
 #include "pw_rpc/server_context.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
@@ -253,15 +254,28 @@ class NanopbMethod : public Method {
   static void UnaryInvoker(const Method& method,
                            ServerCall& call,
                            const Packet& request) {
-    _PW_RPC_NANOPB_STRUCT_STORAGE_CLASS
-    std::aligned_storage_t<kRequestSize, alignof(std::max_align_t)>
-        request_struct{};
-    _PW_RPC_NANOPB_STRUCT_STORAGE_CLASS
-    std::aligned_storage_t<kResponseSize, alignof(std::max_align_t)>
-        response_struct{};
-
-    static_cast<const NanopbMethod&>(method).CallUnary(
-        call, request, &request_struct, &response_struct);
+    if constexpr (cfg::kNanopbStructPoolBlocks > 0u) {
+      PooledNanopbStruct<kRequestSize> request_struct;
+      PooledNanopbStruct<kResponseSize> response_struct;
+
+      if (!request_struct.ok() || !response_struct.ok()) {
+        SendPoolExhaustedError(call, request);
+        return;
+      }
+
+      static_cast<const NanopbMethod&>(method).CallUnary(
+          call, request, request_struct.get(), response_struct.get());
+    } else {
+      _PW_RPC_NANOPB_STRUCT_STORAGE_CLASS
+      std::aligned_storage_t<kRequestSize, alignof(std::max_align_t)>
+          request_struct{};
+      _PW_RPC_NANOPB_STRUCT_STORAGE_CLASS
+      std::aligned_storage_t<kResponseSize, alignof(std::max_align_t)>
+          response_struct{};
+
+      static_cast<const NanopbMethod&>(method).CallUnary(
+          call, request, &request_struct, &response_struct);
+    }
   }
 
   // Invoker function for server streaming RPCs. Allocates space for a request
@@ -271,22 +285,38 @@ class NanopbMethod : public Method {
   static void ServerStreamingInvoker(const Method& method,
                                      ServerCall& call,
                                      const Packet& request) {
-    _PW_RPC_NANOPB_STRUCT_STORAGE_CLASS
-    std::aligned_storage_t<kRequestSize, alignof(std::max_align_t)>
-        request_struct{};
-
-    static_cast<const NanopbMethod&>(method).CallServerStreaming(
-        call, request, &request_struct);
+    if constexpr (cfg::kNanopbStructPoolBlocks > 0u) {
+      PooledNanopbStruct<kRequestSize> request_struct;
+
+      if (!request_struct.ok()) {
+        SendPoolExhaustedError(call, request);
+        return;
+      }
+
+      static_cast<const NanopbMethod&>(method).CallServerStreaming(
+          call, request, request_struct.get());
+    } else {
+      _PW_RPC_NANOPB_STRUCT_STORAGE_CLASS
+      std::aligned_storage_t<kRequestSize, alignof(std::max_align_t)>
+          request_struct{};
+
+      static_cast<const NanopbMethod&>(method).CallServerStreaming(
+          call, request, &request_struct);
+    }
   }
 
+  // Sends a RESOURCE_EXHAUSTED error for a request that arrived when no struct
+  // pool blocks were available.
+  static void SendPoolExhaustedError(ServerCall& call, const Packet& request);
+
   // Decodes a request protobuf with Nanopb to the provided buffer. Sends an
   // error packet if the request failed to decode.
   bool DecodeRequest(Channel& channel,
                      const Packet& request,
                      void* proto_struct) const;
 
-  // Encodes a response and sends it over the provided channel.
-  void SendResponse(Channel& channel,
+  // Encodes a response and sends it over the call's channel.
+  void SendResponse(ServerCall& call,
                     const Packet& request,
                     const void* response_struct,
                     Status status) const;
@@ -315,8 +345,7 @@ Status ServerWriter<T>::Write(const T& response) {
     return ReleasePayloadBuffer(buffer.first(result.size()));
   }
 
-  ReleasePayloadBuffer();
-  return Status::Internal();
+  return ReleasePayloadBufferForEncodeFailure();
 }
 
 }  // namespace pw::rpc
@@ -0,0 +1,125 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "pw_rpc/internal/config.h"
+
+namespace pw::rpc {
+
+// Returns the largest number of blocks that have been in use at once in any
+// Nanopb struct pool (see PW_RPC_NANOPB_STRUCT_BUFFER_POOL_BLOCKS). If this
+// reaches the configured number of blocks, RPCs may have failed with
+// RESOURCE_EXHAUSTED.
+size_t NanopbStructPoolHighWaterMark();
+
+namespace internal {
+
+// Tracks which blocks of a pool are in use. The bookkeeping is lock free, so
+// blocks may be acquired and released from any thread.
+class BaseNanopbStructPool {
+ public:
+  static constexpr int kNoBlock = -1;
+
+  // The largest number of blocks that have been in use at once in this pool.
+  size_t high_water_mark() const {
+    return high_water_mark_.load(std::memory_order_relaxed);
+  }
+
+ protected:
+  constexpr BaseNanopbStructPool(size_t blocks)
+      : all_blocks_(blocks == 32u ? ~uint32_t(0) : (uint32_t(1) << blocks) - 1),
+        in_use_(0),
+        high_water_mark_(0) {}
+
+  // Claims a free block and returns its index, or kNoBlock if all blocks are
+  // in use.
+  int Acquire();
+
+  void Release(int index) {
+    in_use_.fetch_and(~(uint32_t(1) << index), std::memory_order_release);
+  }
+
+ private:
+  const uint32_t all_blocks_;
+  std::atomic<uint32_t> in_use_;
+  std::atomic<uint32_t> high_water_mark_;
+};
+
+// A pool of kBlocks blocks of kBlockSize bytes, aligned for any type.
+template <size_t kBlockSize, size_t kBlocks>
+class NanopbStructPool : public BaseNanopbStructPool {
+ public:
+  static_assert(kBlocks > 0u && kBlocks <= 32u);
+
+  // A block taken from the pool for the lifetime of the object. The block is
+  // zeroed, so it holds a default-initialized Nanopb struct.
+  class Block {
+   public:
+    Block(NanopbStructPool& pool) : pool_(pool), index_(pool.Acquire()) {
+      if (ok()) {
+        std::memset(get(), 0, kBlockSize);
+      }
+    }
+
+    Block(const Block&) = delete;
+    Block& operator=(const Block&) = delete;
+
+    ~Block() {
+      if (ok()) {
+        pool_.Release(index_);
+      }
+    }
+
+    // False if the pool was exhausted.
+    bool ok() const { return index_ != kNoBlock; }
+
+    void* get() { return &pool_.blocks_[index_]; }
+
+   private:
+    NanopbStructPool& pool_;
+    const int index_;
+  };
+
+  constexpr NanopbStructPool() : BaseNanopbStructPool(kBlocks), blocks_{} {}
+
+ private:
+  std::aligned_storage_t<kBlockSize, alignof(std::max_align_t)>
+      blocks_[kBlocks];
+};
+
+// The pool for one Nanopb struct size class. Constant initialized, so it is
+// ready before any static constructors run.
+template <size_t kBlockSize>
+inline NanopbStructPool<kBlockSize, cfg::kNanopbStructPoolBlocks>
+    nanopb_struct_pool;
+
+// A block from the pool for a Nanopb struct size class.
+template <size_t kBlockSize>
+class PooledNanopbStruct
+    : public NanopbStructPool<kBlockSize,
+                              cfg::kNanopbStructPoolBlocks>::Block {
+ public:
+  PooledNanopbStruct()
+      : NanopbStructPool<kBlockSize, cfg::kNanopbStructPoolBlocks>::Block(
+            nanopb_struct_pool<kBlockSize>) {}
+};
+
+}  // namespace internal
+}  // namespace pw::rpc
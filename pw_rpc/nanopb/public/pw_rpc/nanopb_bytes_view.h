@@ -0,0 +1,52 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <string_view>
+
+#include "pb.h"
+#include "pw_bytes/span.h"
+
+namespace pw::rpc {
+
+// Nanopb generates a pb_callback_t for bytes and string fields that have no
+// max_size or max_length option, or that have the type:FT_CALLBACK option.
+// When pw_rpc decodes a request or response, each such field in the top-level
+// message that has no decode callback of its own is decoded as a view into the
+// encoded packet instead of being skipped. The field's data is not copied, and
+// the struct needs no buffer sized for the field's largest value.
+//
+// The view is only valid while the RPC function or response handler is
+// running, since the packet's buffer is reused afterwards. Copy anything that
+// is needed later.
+//
+//   // .options: my.pkg.WriteRequest.data type:FT_CALLBACK
+//   Status WriteFile(ServerContext&,
+//                    const my_pkg_WriteRequest& request,
+//                    my_pkg_WriteResponse&) {
+//     return file.Write(pw::rpc::NanopbBytesView(request.data));
+//   }
+//
+// Returns an empty span if the field was not present. If a field appears more
+// than once, the last occurrence is used, as for other singular fields.
+ConstByteSpan NanopbBytesView(const pb_callback_t& field);
+
+// Returns a string field that was decoded as a view. See NanopbBytesView.
+inline std::string_view NanopbStringView(const pb_callback_t& field) {
+  const ConstByteSpan bytes = NanopbBytesView(field);
+  return std::string_view(reinterpret_cast<const char*>(bytes.data()),
+                          bytes.size());
+}
+
+}  // namespace pw::rpc
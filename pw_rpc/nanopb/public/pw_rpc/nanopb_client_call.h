@@ -59,7 +59,9 @@ namespace internal {
 // Non-templated nanopb base class providing protobuf encoding and decoding.
 class BaseNanopbClientCall : public BaseClientCall {
  public:
-  Status SendRequest(const void* request_struct);
+  // Encodes and sends the request. A nonzero stream_credit makes the server
+  // stream flow controlled; see BaseClientCall::GrantCredit.
+  Status SendRequest(const void* request_struct, uint32_t stream_credit = 0);
 
  protected:
   constexpr BaseNanopbClientCall(
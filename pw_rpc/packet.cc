@@ -14,7 +14,11 @@
 
 #include "pw_rpc/internal/packet.h"
 
+#include <algorithm>
+
 #include "pw_protobuf/decoder.h"
+#include "pw_protobuf/wire_format.h"
+#include "pw_varint/varint.h"
 
 namespace pw::rpc::internal {
 
@@ -59,6 +63,22 @@ Result<Packet> Packet::FromBuffer(ConstByteSpan data) {
         packet.set_status(static_cast<Status::Code>(value));
         break;
       }
+
+      case RpcPacket::Fields::CREDIT:
+        decoder.ReadUint32(&packet.credit_);
+        break;
+
+      case RpcPacket::Fields::CALL_ID:
+        decoder.ReadUint32(&packet.call_id_);
+        break;
+
+      case RpcPacket::Fields::CONTINUED:
+        decoder.ReadBool(&packet.continued_);
+        break;
+
+      case RpcPacket::Fields::PAYLOAD_OFFSET:
+        decoder.ReadUint32(&packet.payload_offset_);
+        break;
     }
   }
 
@@ -69,22 +89,101 @@ Result<Packet> Packet::FromBuffer(ConstByteSpan data) {
   return packet;
 }
 
+namespace {
+
+// Writes all of the packet's fields except for the payload.
+void EncodeFields(const Packet& packet, RpcPacket::Encoder& rpc_packet) {
+  rpc_packet.WriteType(packet.type());
+  rpc_packet.WriteChannelId(packet.channel_id());
+  rpc_packet.WriteServiceId(packet.service_id());
+  rpc_packet.WriteMethodId(packet.method_id());
+  rpc_packet.WriteStatus(packet.status().code());
+
+  // Credit is only used for flow-controlled server streams, so it is omitted
+  // from other packets.
+  if (packet.credit() != 0u) {
+    rpc_packet.WriteCredit(packet.credit());
+  }
+
+  // Calls without an ID are from clients that do not assign them, so the ID
+  // is omitted to keep their packets unchanged.
+  if (packet.call_id() != 0u) {
+    rpc_packet.WriteCallId(packet.call_id());
+  }
+
+  // The fragment fields are only sent in packets with part of a split payload.
+  if (packet.continued()) {
+    rpc_packet.WriteContinued(true);
+  }
+  if (packet.payload_offset() != 0u) {
+    rpc_packet.WritePayloadOffset(packet.payload_offset());
+  }
+}
+
+// Encodes a varint padded with continuation bytes to fill the output exactly.
+// Protobuf decoders accept padded varints.
+void EncodePaddedVarint(uint64_t value, ByteSpan output) {
+  for (size_t i = 0; i < output.size() - 1; ++i) {
+    output[i] = static_cast<byte>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  output[output.size() - 1] = static_cast<byte>(value);
+}
+
+}  // namespace
+
 Result<ConstByteSpan> Packet::Encode(ByteSpan buffer) const {
+  if (ConstByteSpan encoded = EncodeAroundPayload(buffer); !encoded.empty()) {
+    return encoded;
+  }
+
   pw::protobuf::NestedEncoder encoder(buffer);
   RpcPacket::Encoder rpc_packet(&encoder);
 
   // The payload is encoded first, as it may share the encode buffer.
   rpc_packet.WritePayload(payload_);
-
-  rpc_packet.WriteType(type_);
-  rpc_packet.WriteChannelId(channel_id_);
-  rpc_packet.WriteServiceId(service_id_);
-  rpc_packet.WriteMethodId(method_id_);
-  rpc_packet.WriteStatus(status_.code());
+  EncodeFields(*this, rpc_packet);
 
   return encoder.Encode();
 }
 
+ConstByteSpan Packet::EncodeAroundPayload(ByteSpan buffer) const {
+  // The payload must be in the buffer, with room in front of it for its key and
+  // at least one byte of length.
+  if (payload_.empty() || payload_.data() < buffer.data() + 2 ||
+      payload_.data() + payload_.size() > buffer.data() + buffer.size()) {
+    return {};
+  }
+
+  const size_t offset = payload_.data() - buffer.data();
+
+  pw::protobuf::NestedEncoder encoder(buffer.first(offset - 2));
+  RpcPacket::Encoder rpc_packet(&encoder);
+  EncodeFields(*this, rpc_packet);
+
+  Result<ConstByteSpan> fields = encoder.Encode();
+  if (!fields.ok()) {
+    return {};
+  }
+
+  // The payload's length fills the space between the key and the payload. It
+  // is limited to the size of a 32-bit varint, as some decoders read lengths
+  // as 32-bit values.
+  const size_t length_size = offset - fields.value().size() - 1;
+  if (length_size < varint::EncodedSize(payload_.size()) ||
+      length_size > varint::kMaxVarint32SizeBytes) {
+    return {};
+  }
+
+  buffer[fields.value().size()] = static_cast<byte>(protobuf::MakeKey(
+      static_cast<uint32_t>(RpcPacket::Fields::PAYLOAD),
+      protobuf::WireType::kDelimited));
+  EncodePaddedVarint(payload_.size(),
+                     buffer.subspan(fields.value().size() + 1, length_size));
+
+  return buffer.first(offset + payload_.size());
+}
+
 size_t Packet::MinEncodedSizeBytes() const {
   size_t reserved_size = 0;
 
@@ -102,7 +201,38 @@ size_t Packet::MinEncodedSizeBytes() const {
   // Payload field takes at least two bytes to encode (varint key + length).
   reserved_size += 2;
 
+  // The call ID is only encoded if it is set (varint key + varint ID).
+  if (call_id_ != 0u) {
+    reserved_size += 1 + varint::EncodedSize(call_id_);
+  }
+
   return reserved_size;
 }
 
+size_t Packet::PayloadOffset(size_t buffer_size) const {
+  // MinEncodedSizeBytes() includes 2 bytes for the payload's key and length.
+  size_t offset = MinEncodedSizeBytes() - 2;
+
+  if (credit_ != 0u) {
+    offset += 1 + varint::EncodedSize(credit_);
+  }
+  if (continued_) {
+    offset += 2;  // varint key + bool
+  }
+  if (payload_offset_ != 0u) {
+    offset += 1 + varint::EncodedSize(payload_offset_);
+  }
+
+  return offset + 1 +
+         std::min(varint::EncodedSize(buffer_size),
+                  varint::kMaxVarint32SizeBytes);
+}
+
+bool IsPacketBatch(ConstByteSpan data) {
+  protobuf::Decoder decoder(data);
+  return decoder.Next().ok() &&
+         static_cast<RpcPacketBatch::Fields>(decoder.FieldNumber()) ==
+             RpcPacketBatch::Fields::PACKETS;
+}
+
 }  // namespace pw::rpc::internal
@@ -0,0 +1,150 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file implements a fuzz test for decoding RPC packets. The fuzz data is
+// decoded as a packet or a batch of packets. Each decoded packet is encoded and
+// decoded again, which must produce the same packet.
+//
+// A custom mutator keeps most inputs valid packets. It decodes the input,
+// changes one of the packet's fields, and encodes the packet again, so the
+// fuzzer explores packet contents rather than protobuf encoding errors.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "pw_assert/assert.h"
+#include "pw_bytes/span.h"
+#include "pw_fuzzer/execution_timer.h"
+#include "pw_rpc/internal/packet.h"
+
+extern "C" size_t LLVMFuzzerMutate(uint8_t* data, size_t size, size_t max_size);
+
+namespace pw::rpc::internal {
+namespace {
+
+// The maximum payload size created by the mutator.
+constexpr size_t kMaxPayloadSize = 256;
+
+bool SamePacket(const Packet& a, const Packet& b) {
+  return a.type() == b.type() && a.channel_id() == b.channel_id() &&
+         a.service_id() == b.service_id() && a.method_id() == b.method_id() &&
+         a.status() == b.status() && a.credit() == b.credit() &&
+         a.call_id() == b.call_id() &&
+         a.payload().size() == b.payload().size() &&
+         std::memcmp(a.payload().data(),
+                     b.payload().data(),
+                     a.payload().size()) == 0;
+}
+
+Status CheckPacket(ConstByteSpan data) {
+  const Result<Packet> packet = Packet::FromBuffer(data);
+  if (!packet.ok()) {
+    return packet.status();
+  }
+
+  // The encoded packet is never larger than the fields it was decoded from,
+  // plus the fields that are always encoded.
+  std::vector<std::byte> buffer(data.size() +
+                                packet.value().MinEncodedSizeBytes() + 32);
+  const Result<ConstByteSpan> encoded = packet.value().Encode(buffer);
+  PW_ASSERT(encoded.ok());
+
+  const Result<Packet> decoded = Packet::FromBuffer(encoded.value());
+  PW_ASSERT(decoded.ok());
+  PW_ASSERT(SamePacket(packet.value(), decoded.value()));
+  return OkStatus();
+}
+
+// Returns a random 32-bit value, with small values as likely as large ones.
+uint32_t RandomId(std::minstd_rand& random) {
+  return static_cast<uint32_t>(random()) >> (random() % 32);
+}
+
+}  // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  fuzzer::ScopedExecutionTimer timer(data, size);
+  ForEachPacket(std::as_bytes(std::span(data, size)), CheckPacket)
+      .IgnoreError();
+  return 0;
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t* data,
+                                          size_t size,
+                                          size_t max_size,
+                                          unsigned int seed) {
+  std::minstd_rand random(seed);
+  Result<Packet> packet =
+      Packet::FromBuffer(std::as_bytes(std::span(data, size)));
+
+  // Sometimes mutate the raw bytes instead, to explore malformed packets and
+  // packet batches.
+  if (!packet.ok() || random() % 4 == 0) {
+    return LLVMFuzzerMutate(data, size, max_size);
+  }
+
+  // The payload refers to the input, so copy it to change it.
+  std::vector<std::byte> payload(packet.value().payload().begin(),
+                                 packet.value().payload().end());
+
+  switch (random() % 8) {
+    case 0: {
+      // Usually pick a defined packet type.
+      const uint32_t type = random() % 8 == 0 ? RandomId(random) : random() % 9;
+      packet.value().set_type(static_cast<PacketType>(type));
+      break;
+    }
+    case 1:
+      packet.value().set_channel_id(RandomId(random));
+      break;
+    case 2:
+      packet.value().set_service_id(RandomId(random));
+      break;
+    case 3:
+      packet.value().set_method_id(RandomId(random));
+      break;
+    case 4:
+      packet.value().set_status(static_cast<Status::Code>(random() % 17));
+      break;
+    case 5:
+      packet.value().set_credit(random() % 2 == 0 ? 0 : RandomId(random));
+      break;
+    case 6:
+      packet.value().set_call_id(random() % 2 == 0 ? 0 : RandomId(random));
+      break;
+    case 7: {
+      const size_t payload_size = payload.size();
+      payload.resize(kMaxPayloadSize);
+      payload.resize(
+          LLVMFuzzerMutate(reinterpret_cast<uint8_t*>(payload.data()),
+                           payload_size,
+                           payload.size()));
+      break;
+    }
+  }
+  packet.value().set_payload(payload);
+
+  std::vector<std::byte> buffer(max_size);
+  const Result<ConstByteSpan> encoded = packet.value().Encode(buffer);
+  if (!encoded.ok()) {
+    return LLVMFuzzerMutate(data, size, max_size);
+  }
+  std::memcpy(data, encoded.value().data(), encoded.value().size());
+  return encoded.value().size();
+}
+
+}  // namespace pw::rpc::internal
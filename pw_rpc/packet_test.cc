@@ -14,6 +14,9 @@
 
 #include "pw_rpc/internal/packet.h"
 
+#include <array>
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
 #include "pw_protobuf/codegen.h"
@@ -69,6 +72,7 @@ static_assert(Packet().service_id() == 0);
 static_assert(Packet().method_id() == 0);
 static_assert(Packet().status() == static_cast<Status::Code>(0));
 static_assert(Packet().payload().empty());
+static_assert(Packet().credit() == 0);
 
 TEST(Packet, Encode) {
   byte buffer[64];
@@ -141,6 +145,162 @@ TEST(Packet, EncodeDecode) {
   EXPECT_EQ(decoded.status(), Status::Unavailable());
 }
 
+TEST(Packet, EncodeDecode_Credit) {
+  Packet packet(PacketType::SERVER_STREAM_CREDIT, 1, 42, 100);
+  packet.set_credit(300);
+
+  byte buffer[64];
+  Result result = packet.Encode(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+
+  // The credit field takes a key and a two-byte varint.
+  EXPECT_EQ(Packet(PacketType::SERVER_STREAM_CREDIT, 1, 42, 100)
+                    .Encode(buffer)
+                    .value()
+                    .size() +
+                3,
+            result.value().size());
+
+  Result decoded =
+      Packet::FromBuffer(std::span(buffer, result.value().size()));
+  ASSERT_EQ(OkStatus(), decoded.status());
+  EXPECT_EQ(PacketType::SERVER_STREAM_CREDIT, decoded.value().type());
+  EXPECT_EQ(300u, decoded.value().credit());
+}
+
+TEST(Packet, EncodeDecode_CallId) {
+  Packet packet(PacketType::REQUEST, 1, 42, 100);
+  packet.set_call_id(300);
+
+  byte buffer[64];
+  Result result = packet.Encode(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+
+  // The call ID takes a key and a two-byte varint, and is omitted if zero.
+  EXPECT_EQ(
+      Packet(PacketType::REQUEST, 1, 42, 100).Encode(buffer).value().size() +
+          3,
+      result.value().size());
+
+  Result decoded =
+      Packet::FromBuffer(std::span(buffer, result.value().size()));
+  ASSERT_EQ(OkStatus(), decoded.status());
+  EXPECT_EQ(300u, decoded.value().call_id());
+}
+
+TEST(Packet, EncodeDecode_Fragment) {
+  Packet packet(PacketType::REQUEST, 1, 42, 100);
+  packet.set_continued(true);
+  packet.set_payload_offset(300);
+  EXPECT_TRUE(packet.fragment());
+
+  byte buffer[64];
+  Result result = packet.Encode(buffer);
+  ASSERT_EQ(result.status(), OkStatus());
+
+  // continued takes a key and a bool, and payload_offset a key and a two-byte
+  // varint. Both are omitted from packets that are not fragments.
+  EXPECT_EQ(
+      Packet(PacketType::REQUEST, 1, 42, 100).Encode(buffer).value().size() +
+          2 + 3,
+      result.value().size());
+
+  Result decoded =
+      Packet::FromBuffer(std::span(buffer, result.value().size()));
+  ASSERT_EQ(OkStatus(), decoded.status());
+  EXPECT_TRUE(decoded.value().continued());
+  EXPECT_EQ(300u, decoded.value().payload_offset());
+  EXPECT_FALSE(Packet(PacketType::REQUEST, 1, 42, 100).fragment());
+}
+
+TEST(Packet, Encode_FragmentPayloadAtPayloadOffset_IsNotCopied) {
+  byte buffer[64];
+  Packet packet(PacketType::RESPONSE, 1, 42, 100);
+  packet.set_continued(true);
+  packet.set_payload_offset(1000);
+  ByteSpan payload = std::span(buffer).subspan(packet.PayloadOffset(64));
+  packet.set_payload(payload.first(3));
+
+  Result<ConstByteSpan> result = packet.Encode(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(result.value().size(), packet.PayloadOffset(64) + 3);
+}
+
+TEST(Packet, Response_KeepsCallId) {
+  Packet request(PacketType::REQUEST, 1, 42, 100);
+  request.set_call_id(7);
+
+  EXPECT_EQ(7u, Packet::Response(request).call_id());
+  EXPECT_EQ(7u, Packet::ServerError(request, Status::Internal()).call_id());
+  EXPECT_EQ(7u, Packet::ClientError(request, Status::Internal()).call_id());
+}
+
+// A batch of two packets: a one-byte packet and a two-byte packet.
+constexpr auto kBatch =
+    bytes::Array<MakeKey(15, protobuf::WireType::kDelimited),
+                 0x01,
+                 0xAA,
+                 MakeKey(15, protobuf::WireType::kDelimited),
+                 0x02,
+                 0xBB,
+                 0xCC>();
+
+TEST(Packet, IsPacketBatch) {
+  EXPECT_TRUE(IsPacketBatch(kBatch));
+  EXPECT_FALSE(IsPacketBatch(kEncoded));
+  EXPECT_FALSE(IsPacketBatch(ConstByteSpan()));
+}
+
+TEST(Packet, ForEachPacket_SinglePacket) {
+  size_t count = 0;
+  EXPECT_EQ(OkStatus(), ForEachPacket(kEncoded, [&](ConstByteSpan packet) {
+              EXPECT_EQ(packet.data(), kEncoded.data());
+              EXPECT_EQ(packet.size(), kEncoded.size());
+              count += 1;
+              return OkStatus();
+            }));
+  EXPECT_EQ(1u, count);
+}
+
+TEST(Packet, ForEachPacket_Batch) {
+  std::array<size_t, 2> sizes{};
+  size_t count = 0;
+  EXPECT_EQ(OkStatus(), ForEachPacket(kBatch, [&](ConstByteSpan packet) {
+              sizes[count++] = packet.size();
+              return OkStatus();
+            }));
+  ASSERT_EQ(2u, count);
+  EXPECT_EQ(1u, sizes[0]);
+  EXPECT_EQ(2u, sizes[1]);
+}
+
+TEST(Packet, ForEachPacket_Batch_ProcessesAllAndReturnsFirstError) {
+  size_t count = 0;
+  EXPECT_EQ(Status::NotFound(), ForEachPacket(kBatch, [&](ConstByteSpan) {
+              count += 1;
+              return count == 1u ? Status::NotFound() : Status::Internal();
+            }));
+  EXPECT_EQ(2u, count);
+}
+
+TEST(Packet, ForEachPacket_MalformedBatch) {
+  // The second packet's length runs past the end of the batch.
+  constexpr auto kTruncated =
+      bytes::Array<MakeKey(15, protobuf::WireType::kDelimited),
+                   0x01,
+                   0xAA,
+                   MakeKey(15, protobuf::WireType::kDelimited),
+                   0x05,
+                   0xBB>();
+
+  size_t count = 0;
+  EXPECT_EQ(Status::DataLoss(), ForEachPacket(kTruncated, [&](ConstByteSpan) {
+              count += 1;
+              return OkStatus();
+            }));
+  EXPECT_EQ(1u, count);
+}
+
 constexpr size_t kReservedSize = 2 /* type */ + 2 /* channel */ +
                                  5 /* service */ + 5 /* method */ +
                                  2 /* payload key */ + 2 /* status */;
@@ -156,5 +316,76 @@ TEST(Packet, PayloadUsableSpace_LargerVarints) {
       Packet(PacketType::RESPONSE, 17000, 200, 200).MinEncodedSizeBytes());
 }
 
+TEST(Packet, PayloadOffset_ReservesLengthForBufferSize) {
+  const Packet packet(PacketType::RESPONSE, 1, 42, 100);
+  const size_t fields = packet.MinEncodedSizeBytes() - 2;
+
+  EXPECT_EQ(fields + 1 + 1, packet.PayloadOffset(100));
+  EXPECT_EQ(fields + 1 + 2, packet.PayloadOffset(128));
+  EXPECT_EQ(fields + 1 + 3, packet.PayloadOffset(20000));
+}
+
+void ExpectDecodesTo(ConstByteSpan data, const Packet& packet) {
+  Result<Packet> decoded = Packet::FromBuffer(data);
+  ASSERT_EQ(OkStatus(), decoded.status());
+  EXPECT_EQ(decoded.value().type(), packet.type());
+  EXPECT_EQ(decoded.value().channel_id(), packet.channel_id());
+  EXPECT_EQ(decoded.value().service_id(), packet.service_id());
+  EXPECT_EQ(decoded.value().method_id(), packet.method_id());
+  EXPECT_EQ(decoded.value().status(), packet.status());
+  EXPECT_EQ(decoded.value().call_id(), packet.call_id());
+  ASSERT_EQ(decoded.value().payload().size(), packet.payload().size());
+  EXPECT_EQ(0,
+            std::memcmp(decoded.value().payload().data(),
+                        packet.payload().data(),
+                        packet.payload().size()));
+}
+
+TEST(Packet, Encode_PayloadAtPayloadOffset_IsNotCopied) {
+  byte buffer[300];
+  Packet packet(PacketType::RESPONSE, 1, 42, 100);
+  ByteSpan payload = std::span(buffer).subspan(packet.PayloadOffset(300));
+
+  // A small payload's length is padded to the two bytes reserved for it.
+  for (size_t size : {size_t{1}, size_t{200}, payload.size()}) {
+    std::memset(payload.data(), static_cast<int>(size), size);
+    packet.set_payload(payload.first(size));
+
+    Result<ConstByteSpan> result = packet.Encode(buffer);
+    ASSERT_EQ(OkStatus(), result.status());
+    EXPECT_EQ(result.value().data(), buffer);
+    EXPECT_EQ(result.value().size(), packet.PayloadOffset(300) + size);
+    ExpectDecodesTo(result.value(), packet);
+  }
+}
+
+TEST(Packet, Encode_PayloadAtPayloadOffset_WithCallId_IsNotCopied) {
+  byte buffer[64];
+  Packet packet(PacketType::RESPONSE, 1, 42, 100);
+  packet.set_call_id(1000);
+  ByteSpan payload = std::span(buffer).subspan(packet.PayloadOffset(64));
+  packet.set_payload(payload.first(3));
+
+  Result<ConstByteSpan> result = packet.Encode(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(result.value().size(), packet.PayloadOffset(64) + 3);
+  ExpectDecodesTo(result.value(), packet);
+}
+
+TEST(Packet, Encode_PayloadInBufferWithoutRoom_IsCopied) {
+  byte buffer[64] = {};
+  Packet packet(PacketType::RESPONSE, 1, 42, 100);
+
+  // The payload starts too early for the other fields to fit in front of it.
+  packet.set_payload(std::span(buffer).subspan(4, 3));
+  const std::array<byte, 3> payload = {byte{4}, byte{5}, byte{6}};
+  std::memcpy(buffer + 4, payload.data(), payload.size());
+
+  Result<ConstByteSpan> result = packet.Encode(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  packet.set_payload(payload);
+  ExpectDecodesTo(result.value(), packet);
+}
+
 }  // namespace
 }  // namespace pw::rpc::internal
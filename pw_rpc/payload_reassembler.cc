@@ -0,0 +1,67 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/payload_reassembler.h"
+
+#include <algorithm>
+
+namespace pw::rpc::internal {
+
+Status PayloadReassembler::Add(Packet& packet) {
+  if (!packet.fragment()) {
+    return OkStatus();
+  }
+
+  if (packet.payload_offset() == 0u) {
+    // A new first fragment for the current call restarts its payload, since
+    // the sender only does that if it gave up on the previous one.
+    if (active_ && !IsFromCurrentCall(packet)) {
+      return Status::ResourceExhausted();
+    }
+
+    channel_id_ = packet.channel_id();
+    service_id_ = packet.service_id();
+    method_id_ = packet.method_id();
+    call_id_ = packet.call_id();
+    type_ = packet.type();
+    size_ = 0;
+    active_ = true;
+  } else if (!active_ || !IsFromCurrentCall(packet)) {
+    return Status::DataLoss();
+  } else if (packet.payload_offset() != size_) {
+    active_ = false;
+    return Status::DataLoss();
+  }
+
+  if (packet.payload().size() > buffer_.size() - size_) {
+    active_ = false;
+    return Status::ResourceExhausted();
+  }
+
+  std::copy(packet.payload().begin(),
+            packet.payload().end(),
+            buffer_.begin() + size_);
+  size_ += packet.payload().size();
+
+  if (packet.continued()) {
+    return Status::Unavailable();
+  }
+
+  active_ = false;
+  packet.set_payload(buffer_.first(size_));
+  packet.set_payload_offset(0);
+  return OkStatus();
+}
+
+}  // namespace pw::rpc::internal
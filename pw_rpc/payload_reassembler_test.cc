@@ -0,0 +1,141 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/internal/payload_reassembler.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+
+namespace pw::rpc::internal {
+namespace {
+
+constexpr auto kPayload = bytes::Array<1, 2, 3, 4, 5, 6, 7, 8, 9, 10>();
+
+Packet Fragment(size_t offset, size_t size, bool continued) {
+  Packet packet(PacketType::REQUEST,
+                1,
+                42,
+                100,
+                std::span(kPayload).subspan(offset, size));
+  packet.set_call_id(7);
+  packet.set_payload_offset(offset);
+  packet.set_continued(continued);
+  return packet;
+}
+
+TEST(PayloadReassembler, PacketThatIsNotAFragment_IsUnchanged) {
+  PayloadReassembler reassembler;
+  Packet packet(PacketType::REQUEST, 1, 42, 100, kPayload);
+
+  ASSERT_EQ(OkStatus(), reassembler.Add(packet));
+  EXPECT_EQ(packet.payload().data(), kPayload.data());
+  EXPECT_EQ(packet.payload().size(), kPayload.size());
+}
+
+TEST(PayloadReassembler, Reassembles) {
+  std::array<std::byte, 16> buffer;
+  PayloadReassembler reassembler;
+  reassembler.set_buffer(buffer);
+
+  Packet first = Fragment(0, 4, true);
+  Packet second = Fragment(4, 4, true);
+  Packet last = Fragment(8, 2, false);
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(first));
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(second));
+  ASSERT_EQ(OkStatus(), reassembler.Add(last));
+
+  EXPECT_FALSE(last.fragment());
+  EXPECT_EQ(7u, last.call_id());
+  ASSERT_EQ(kPayload.size(), last.payload().size());
+  EXPECT_EQ(
+      0, std::memcmp(kPayload.data(), last.payload().data(), kPayload.size()));
+}
+
+TEST(PayloadReassembler, MissingFragment_DataLoss) {
+  std::array<std::byte, 16> buffer;
+  PayloadReassembler reassembler;
+  reassembler.set_buffer(buffer);
+
+  Packet first = Fragment(0, 4, true);
+  Packet last = Fragment(8, 2, false);
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(first));
+  EXPECT_EQ(Status::DataLoss(), reassembler.Add(last));
+
+  // Fragments without a first fragment are also rejected.
+  Packet second = Fragment(4, 4, true);
+  EXPECT_EQ(Status::DataLoss(), reassembler.Add(second));
+}
+
+TEST(PayloadReassembler, PayloadTooLarge_ResourceExhausted) {
+  std::array<std::byte, 6> buffer;
+  PayloadReassembler reassembler;
+  reassembler.set_buffer(buffer);
+
+  Packet first = Fragment(0, 4, true);
+  Packet second = Fragment(4, 4, true);
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(first));
+  EXPECT_EQ(Status::ResourceExhausted(), reassembler.Add(second));
+
+  Packet last = Fragment(8, 2, false);
+  EXPECT_EQ(Status::DataLoss(), reassembler.Add(last));
+}
+
+TEST(PayloadReassembler, NoBuffer_ResourceExhausted) {
+  PayloadReassembler reassembler;
+  Packet first = Fragment(0, 4, true);
+  EXPECT_EQ(Status::ResourceExhausted(), reassembler.Add(first));
+}
+
+TEST(PayloadReassembler, OtherCallInProgress_ResourceExhausted) {
+  std::array<std::byte, 16> buffer;
+  PayloadReassembler reassembler;
+  reassembler.set_buffer(buffer);
+
+  Packet first = Fragment(0, 4, true);
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(first));
+
+  Packet other_call = Fragment(0, 4, true);
+  other_call.set_call_id(8);
+  EXPECT_EQ(Status::ResourceExhausted(), reassembler.Add(other_call));
+
+  // The payload in progress is not affected.
+  Packet second = Fragment(4, 4, true);
+  Packet last = Fragment(8, 2, false);
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(second));
+  ASSERT_EQ(OkStatus(), reassembler.Add(last));
+  EXPECT_EQ(kPayload.size(), last.payload().size());
+}
+
+TEST(PayloadReassembler, FirstFragmentAgain_Restarts) {
+  std::array<std::byte, 16> buffer;
+  PayloadReassembler reassembler;
+  reassembler.set_buffer(buffer);
+
+  Packet first = Fragment(0, 4, true);
+  Packet second = Fragment(4, 4, true);
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(first));
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(second));
+
+  Packet first_again = Fragment(0, 8, true);
+  Packet last = Fragment(8, 2, false);
+  EXPECT_EQ(Status::Unavailable(), reassembler.Add(first_again));
+  ASSERT_EQ(OkStatus(), reassembler.Add(last));
+  EXPECT_EQ(kPayload.size(), last.payload().size());
+}
+
+}  // namespace
+}  // namespace pw::rpc::internal
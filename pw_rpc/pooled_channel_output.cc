@@ -0,0 +1,77 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/pooled_channel_output.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "pw_assert/assert.h"
+
+namespace pw::rpc::internal {
+
+BasePooledChannelOutput::BasePooledChannelOutput(
+    ChannelOutput& output, ByteSpan buffers, std::span<uint8_t> free_buffers)
+    : ChannelOutput(output.name()),
+      output_(output),
+      buffers_(buffers),
+      buffer_size_bytes_(buffers.size() / free_buffers.size()),
+      free_buffers_(free_buffers),
+      free_count_(free_buffers.size()) {
+  for (size_t i = 0; i < free_buffers_.size(); ++i) {
+    free_buffers_[i] = static_cast<uint8_t>(i);
+  }
+  buffer_available_.release(free_buffers_.size());
+}
+
+std::span<std::byte> BasePooledChannelOutput::AcquireBuffer() {
+  buffer_available_.acquire();
+
+  std::lock_guard lock(pool_mutex_);
+  const uint8_t index = free_buffers_[--free_count_];
+  return buffers_.subspan(index * buffer_size_bytes_, buffer_size_bytes_);
+}
+
+Status BasePooledChannelOutput::SendAndReleaseBuffer(
+    std::span<const std::byte> packet) {
+  // The packet starts at the start of the buffer it was encoded in.
+  const size_t offset = static_cast<size_t>(packet.data() - buffers_.data());
+  PW_ASSERT(packet.data() >= buffers_.data() && offset < buffers_.size() &&
+            offset % buffer_size_bytes_ == 0u);
+
+  Status status = OkStatus();
+
+  if (!packet.empty()) {
+    std::lock_guard lock(send_mutex_);
+
+    std::span<std::byte> buffer = output_.AcquireBuffer();
+    if (buffer.size() < packet.size()) {
+      output_.DiscardBuffer(buffer);
+      status = Status::ResourceExhausted();
+    } else {
+      std::copy(packet.begin(), packet.end(), buffer.begin());
+      status = output_.SendAndReleaseBuffer(buffer.first(packet.size()));
+    }
+  }
+
+  {
+    std::lock_guard lock(pool_mutex_);
+    free_buffers_[free_count_++] =
+        static_cast<uint8_t>(offset / buffer_size_bytes_);
+  }
+  buffer_available_.release();
+  return status;
+}
+
+}  // namespace pw::rpc::internal
@@ -0,0 +1,136 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/pooled_channel_output.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace pw::rpc {
+namespace {
+
+// Records the packets sent through it.
+class PacketOutput : public ChannelOutput {
+ public:
+  constexpr PacketOutput() : ChannelOutput("PacketOutput"), buffer_{} {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> packet) override {
+    if (packet.empty()) {
+      return OkStatus();
+    }
+    sent_count_ += 1;
+    last_packet_ = packet;
+    return send_status_;
+  }
+
+  size_t sent_count() const { return sent_count_; }
+  ConstByteSpan last_packet() const { return last_packet_; }
+
+  void set_send_status(Status status) { send_status_ = status; }
+
+ private:
+  std::array<std::byte, 16> buffer_;
+  ConstByteSpan last_packet_;
+  size_t sent_count_ = 0;
+  Status send_status_;
+};
+
+Status SendBytes(std::span<std::byte> buffer,
+                 ChannelOutput& output,
+                 const char* data) {
+  const size_t size = std::strlen(data);
+  std::memcpy(buffer.data(), data, size);
+  return output.SendAndReleaseBuffer(buffer.first(size));
+}
+
+bool Equals(ConstByteSpan packet, const char* data) {
+  return packet.size() == std::strlen(data) &&
+         std::memcmp(packet.data(), data, packet.size()) == 0;
+}
+
+class PooledChannelOutputTest : public ::testing::Test {
+ protected:
+  PooledChannelOutputTest() : pooled_output_(output_) {}
+
+  PacketOutput output_;
+  PooledChannelOutput<3, 8> pooled_output_;
+};
+
+TEST_F(PooledChannelOutputTest, AcquireBuffer_ReturnsSeparateBuffers) {
+  std::span<std::byte> first = pooled_output_.AcquireBuffer();
+  std::span<std::byte> second = pooled_output_.AcquireBuffer();
+  std::span<std::byte> third = pooled_output_.AcquireBuffer();
+
+  EXPECT_EQ(8u, first.size());
+  EXPECT_EQ(8u, second.size());
+  EXPECT_EQ(8u, third.size());
+  EXPECT_NE(first.data(), second.data());
+  EXPECT_NE(first.data(), third.data());
+  EXPECT_NE(second.data(), third.data());
+
+  pooled_output_.DiscardBuffer(first);
+  pooled_output_.DiscardBuffer(second);
+  pooled_output_.DiscardBuffer(third);
+  EXPECT_EQ(0u, output_.sent_count());
+}
+
+TEST_F(PooledChannelOutputTest, Send_InterleavedEncodes) {
+  // Packets encoded at the same time are sent in the order they are released.
+  std::span<std::byte> first = pooled_output_.AcquireBuffer();
+  std::span<std::byte> second = pooled_output_.AcquireBuffer();
+
+  EXPECT_EQ(OkStatus(), SendBytes(second, pooled_output_, "second"));
+  EXPECT_EQ(1u, output_.sent_count());
+  EXPECT_TRUE(Equals(output_.last_packet(), "second"));
+
+  EXPECT_EQ(OkStatus(), SendBytes(first, pooled_output_, "first"));
+  EXPECT_EQ(2u, output_.sent_count());
+  EXPECT_TRUE(Equals(output_.last_packet(), "first"));
+}
+
+TEST_F(PooledChannelOutputTest, Send_ReleasesBuffer) {
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(OkStatus(),
+              SendBytes(pooled_output_.AcquireBuffer(), pooled_output_, "hi"));
+  }
+  EXPECT_EQ(10u, output_.sent_count());
+}
+
+TEST_F(PooledChannelOutputTest, Send_ReturnsOutputStatus) {
+  output_.set_send_status(Status::Unavailable());
+  EXPECT_EQ(Status::Unavailable(),
+            SendBytes(pooled_output_.AcquireBuffer(), pooled_output_, "hi"));
+}
+
+TEST(PooledChannelOutput, Send_OutputBufferTooSmall) {
+  PacketOutput output;
+  PooledChannelOutput<1, 32> pooled_output(output);
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            SendBytes(pooled_output.AcquireBuffer(),
+                      pooled_output,
+                      "more than sixteen bytes"));
+  EXPECT_EQ(0u, output.sent_count());
+
+  // The buffer is still returned to the pool.
+  EXPECT_EQ(OkStatus(),
+            SendBytes(pooled_output.AcquireBuffer(), pooled_output, "hi"));
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -0,0 +1,148 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/priority_channel_output.h"
+
+#include <algorithm>
+
+#include "pw_assert/assert.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace pw::rpc::internal {
+
+BasePriorityChannelOutput::BasePriorityChannelOutput(
+    ChannelOutput& output,
+    PriorityFunction priority,
+    ByteSpan slot_storage,
+    std::span<size_t> packet_sizes,
+    std::span<SlotIndex> free_slots,
+    std::span<SlotIndex> queue_slots,
+    std::span<Queue> queues)
+    : ChannelOutput(output.name()),
+      output_(output),
+      priority_(priority),
+      slot_storage_(slot_storage),
+      slot_size_bytes_(slot_storage.size() / free_slots.size()),
+      packet_sizes_(packet_sizes),
+      free_slots_(free_slots),
+      free_count_(0),
+      acquired_slot_(kNoSlot),
+      queue_slots_(queue_slots),
+      queues_(queues),
+      queue_depth_(queue_slots.size() / queues.size()),
+      dropped_packets_(0) {
+  PW_ASSERT(priority_ != nullptr);
+
+  for (size_t i = 0; i < free_slots_.size(); ++i) {
+    Free(static_cast<SlotIndex>(i));
+  }
+  std::fill(queues_.begin(), queues_.end(), Queue{0, 0});
+}
+
+std::span<std::byte> BasePriorityChannelOutput::AcquireBuffer() {
+  if (free_count_ == 0u) {
+    return {};
+  }
+  acquired_slot_ = free_slots_[--free_count_];
+  return slot(acquired_slot_);
+}
+
+Status BasePriorityChannelOutput::SendAndReleaseBuffer(
+    std::span<const std::byte> packet) {
+  const SlotIndex index = acquired_slot_;
+  acquired_slot_ = kNoSlot;
+
+  if (index == kNoSlot) {
+    return packet.empty() ? OkStatus() : Status::ResourceExhausted();
+  }
+
+  if (packet.empty()) {
+    Free(index);
+    return OkStatus();
+  }
+
+  const size_t priority = PriorityOf(packet);
+  Queue& queue = queues_[priority];
+  if (queue.count == queue_depth_) {
+    Free(index);
+    dropped_packets_ += 1;
+    return Status::ResourceExhausted();
+  }
+
+  queue_slot(priority, queue.head + queue.count) = index;
+  queue.count += 1;
+  packet_sizes_[index] = packet.size();
+  return OkStatus();
+}
+
+Status BasePriorityChannelOutput::SendNext() {
+  auto queue = std::find_if(queues_.begin(), queues_.end(), [](const Queue& q) {
+    return q.count != 0u;
+  });
+  if (queue == queues_.end()) {
+    return Status::NotFound();
+  }
+
+  const size_t priority = static_cast<size_t>(queue - queues_.begin());
+  const SlotIndex index = queue_slot(priority, queue->head);
+  queue->head = (queue->head + 1) % queue_depth_;
+  queue->count -= 1;
+
+  ConstByteSpan packet = slot(index).first(packet_sizes_[index]);
+
+  std::span<std::byte> buffer = output_.AcquireBuffer();
+  if (buffer.size() < packet.size()) {
+    Free(index);
+    output_.DiscardBuffer(buffer);
+    return Status::ResourceExhausted();
+  }
+
+  std::copy(packet.begin(), packet.end(), buffer.begin());
+  Free(index);
+  return output_.SendAndReleaseBuffer(buffer.first(packet.size()));
+}
+
+Status BasePriorityChannelOutput::Flush() {
+  while (queued_packets() != 0u) {
+    if (Status status = SendNext(); !status.ok()) {
+      return status;
+    }
+  }
+  return OkStatus();
+}
+
+size_t BasePriorityChannelOutput::queued_packets() const {
+  size_t count = 0;
+  for (const Queue& queue : queues_) {
+    count += queue.count;
+  }
+  return count;
+}
+
+size_t BasePriorityChannelOutput::PriorityOf(
+    std::span<const std::byte> packet) const {
+  const size_t lowest = queues_.size() - 1;
+
+  // Packets that cannot be decoded are not urgent.
+  Result<Packet> decoded = Packet::FromBuffer(packet);
+  if (!decoded.ok()) {
+    return lowest;
+  }
+
+  return std::min(
+      priority_(decoded.value().service_id(), decoded.value().method_id()),
+      lowest);
+}
+
+}  // namespace pw::rpc::internal
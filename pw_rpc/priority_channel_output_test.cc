@@ -0,0 +1,196 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/priority_channel_output.h"
+
+#include <array>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/internal/packet.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::Packet;
+using internal::PacketType;
+
+constexpr uint32_t kControlService = 1;
+constexpr uint32_t kLogService = 2;
+
+// Control RPCs are urgent, logs are bulk, and everything else is in between.
+size_t TestPriority(uint32_t service_id, uint32_t) {
+  switch (service_id) {
+    case kControlService:
+      return 0;
+    case kLogService:
+      return 2;
+    default:
+      return 1;
+  }
+}
+
+// Records the method IDs of the packets sent through it.
+class PacketOutput : public ChannelOutput {
+ public:
+  constexpr PacketOutput() : ChannelOutput("PacketOutput"), buffer_{} {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> packet) override {
+    if (packet.empty()) {
+      return OkStatus();
+    }
+    Result<Packet> decoded = Packet::FromBuffer(packet);
+    EXPECT_EQ(OkStatus(), decoded.status());
+    if (decoded.ok() && sent_count_ < sent_.size()) {
+      sent_[sent_count_] = decoded.value().method_id();
+    }
+    sent_count_ += 1;
+    return send_status_;
+  }
+
+  size_t sent_count() const { return sent_count_; }
+  uint32_t sent(size_t index) const { return sent_[index]; }
+
+  void set_send_status(Status status) { send_status_ = status; }
+
+ private:
+  std::array<std::byte, 64> buffer_;
+  std::array<uint32_t, 16> sent_{};
+  size_t sent_count_ = 0;
+  Status send_status_;
+};
+
+Status SendPacket(ChannelOutput& output,
+                  uint32_t service_id,
+                  uint32_t method_id) {
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  Result<ConstByteSpan> encoded =
+      Packet(PacketType::RESPONSE, 1, service_id, method_id).Encode(buffer);
+  EXPECT_EQ(OkStatus(), encoded.status());
+  return output.SendAndReleaseBuffer(encoded.value_or(ConstByteSpan()));
+}
+
+class PriorityChannelOutputTest : public ::testing::Test {
+ protected:
+  PriorityChannelOutputTest() : priority_output_(output_, TestPriority) {}
+
+  PacketOutput output_;
+  PriorityChannelOutput<3, 2, 32> priority_output_;
+};
+
+TEST_F(PriorityChannelOutputTest, Send_QueuesUntilSendNext) {
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 1));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kControlService, 2));
+
+  EXPECT_EQ(0u, output_.sent_count());
+  EXPECT_EQ(2u, priority_output_.queued_packets());
+  EXPECT_EQ(1u, priority_output_.queued_packets(0));
+  EXPECT_EQ(0u, priority_output_.queued_packets(1));
+  EXPECT_EQ(1u, priority_output_.queued_packets(2));
+}
+
+TEST_F(PriorityChannelOutputTest, SendNext_SendsMostUrgentFirst) {
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 1));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, 99, 2));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kControlService, 3));
+
+  EXPECT_EQ(OkStatus(), priority_output_.SendNext());
+  ASSERT_EQ(1u, output_.sent_count());
+  EXPECT_EQ(3u, output_.sent(0));
+
+  EXPECT_EQ(OkStatus(), priority_output_.SendNext());
+  EXPECT_EQ(OkStatus(), priority_output_.SendNext());
+  ASSERT_EQ(3u, output_.sent_count());
+  EXPECT_EQ(2u, output_.sent(1));
+  EXPECT_EQ(1u, output_.sent(2));
+
+  EXPECT_EQ(Status::NotFound(), priority_output_.SendNext());
+}
+
+TEST_F(PriorityChannelOutputTest, SendNext_SamePriorityInOrder) {
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 1));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 2));
+  EXPECT_EQ(OkStatus(), priority_output_.Flush());
+
+  ASSERT_EQ(2u, output_.sent_count());
+  EXPECT_EQ(1u, output_.sent(0));
+  EXPECT_EQ(2u, output_.sent(1));
+}
+
+TEST_F(PriorityChannelOutputTest, UrgentPacketOvertakesBulkStream) {
+  // Keep the bulk queue full, as a saturating log stream would, and send one
+  // packet per iteration.
+  for (uint32_t i = 0; i < 4; ++i) {
+    while (SendPacket(priority_output_, kLogService, 100 + i).ok()) {
+    }
+    if (i == 1) {
+      EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kControlService, 1));
+    }
+    EXPECT_EQ(OkStatus(), priority_output_.SendNext());
+  }
+
+  ASSERT_EQ(4u, output_.sent_count());
+  EXPECT_EQ(1u, output_.sent(1));
+}
+
+TEST_F(PriorityChannelOutputTest, FullQueue_RejectsOnlyThatPriority) {
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 1));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 2));
+  EXPECT_EQ(Status::ResourceExhausted(),
+            SendPacket(priority_output_, kLogService, 3));
+  EXPECT_EQ(1u, priority_output_.dropped_packets());
+
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kControlService, 4));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kControlService, 5));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, 99, 6));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, 99, 7));
+  EXPECT_EQ(6u, priority_output_.queued_packets());
+
+  EXPECT_EQ(OkStatus(), priority_output_.Flush());
+  EXPECT_EQ(6u, output_.sent_count());
+  EXPECT_EQ(0u, priority_output_.queued_packets());
+
+  // The slots are reused once the queues drain.
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 8));
+}
+
+TEST_F(PriorityChannelOutputTest, PriorityPastLowest_UsesLowest) {
+  PriorityChannelOutput<2, 1, 32> output(
+      output_, [](uint32_t, uint32_t) -> size_t { return 10; });
+  EXPECT_EQ(OkStatus(), SendPacket(output, kControlService, 1));
+  EXPECT_EQ(1u, output.queued_packets(1));
+}
+
+TEST_F(PriorityChannelOutputTest, EmptyPacket_ReleasesSlot) {
+  PriorityChannelOutput<1, 1, 32> output(output_, TestPriority);
+  for (int i = 0; i < 4; ++i) {
+    output.DiscardBuffer(output.AcquireBuffer());
+  }
+  EXPECT_EQ(OkStatus(), SendPacket(output, kLogService, 1));
+  EXPECT_EQ(1u, output.queued_packets());
+}
+
+TEST_F(PriorityChannelOutputTest, Flush_StopsAtFailure) {
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kControlService, 1));
+  EXPECT_EQ(OkStatus(), SendPacket(priority_output_, kLogService, 2));
+
+  output_.set_send_status(Status::Unavailable());
+  EXPECT_EQ(Status::Unavailable(), priority_output_.Flush());
+  EXPECT_EQ(1u, output_.sent_count());
+  EXPECT_EQ(1u, priority_output_.queued_packets());
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -0,0 +1,105 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/serialized_size.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+
+namespace pw::rpc {
+namespace internal {
+
+// Non-templated base so the code is shared between BatchingChannelOutputs with
+// different buffer sizes.
+class BaseBatchingChannelOutput : public ChannelOutput {
+ public:
+  // Returns a buffer for a single packet, which is added to the batch when it
+  // is sent.
+  std::span<std::byte> AcquireBuffer() final { return packet_buffer_; }
+
+  // Adds the packet to the batch. If the packet does not fit in the batch, the
+  // batched packets are flushed first.
+  Status SendAndReleaseBuffer(std::span<const std::byte> packet) final;
+
+  // Sends the batched packets in a single frame through the wrapped output. A
+  // batch of one packet is sent as a plain packet. Returns the status from the
+  // wrapped output, or RESOURCE_EXHAUSTED if the wrapped output's buffer is too
+  // small for the batch. The batch is discarded either way.
+  Status Flush();
+
+  // The number of packets waiting to be flushed.
+  size_t batched_packets() const { return batched_packets_; }
+
+  // The encoded size of the batch waiting to be flushed.
+  size_t batch_size_bytes() const { return batch_size_bytes_; }
+
+ protected:
+  constexpr BaseBatchingChannelOutput(ChannelOutput& output,
+                                      ByteSpan packet_buffer,
+                                      ByteSpan batch_buffer)
+      : ChannelOutput(output.name()),
+        output_(output),
+        packet_buffer_(packet_buffer),
+        batch_buffer_(batch_buffer),
+        batch_size_bytes_(0),
+        batched_packets_(0) {}
+
+ private:
+  ChannelOutput& output_;
+  ByteSpan packet_buffer_;
+  ByteSpan batch_buffer_;
+  size_t batch_size_bytes_;
+  size_t batched_packets_;
+};
+
+}  // namespace internal
+
+// Wraps a ChannelOutput to send several packets in one transport frame. Each
+// packet sent through the BatchingChannelOutput is added to a batch, which is
+// sent through the wrapped output when the next packet does not fit or when
+// Flush() is called. Batching reduces per-frame overhead, such as HDLC framing,
+// for streams of small packets at the cost of latency. Call Flush() after a
+// burst of packets or periodically to bound that latency.
+//
+// Servers and clients process batched frames in ProcessPacket. A receiver that
+// predates batching drops batches of more than one packet.
+//
+// kBatchSizeBytes should not exceed the wrapped output's buffer size.
+// BatchingChannelOutput does not synchronize access; its sends and flushes must
+// be serialized by the user.
+template <size_t kMaxPacketSizeBytes, size_t kBatchSizeBytes>
+class BatchingChannelOutput : public internal::BaseBatchingChannelOutput {
+ public:
+  constexpr BatchingChannelOutput(ChannelOutput& output)
+      : internal::BaseBatchingChannelOutput(
+            output, packet_buffer_, batch_buffer_),
+        packet_buffer_{},
+        batch_buffer_{} {}
+
+ private:
+  static_assert(protobuf::kMaxSizeOfFieldKey + protobuf::kMaxSizeOfLength +
+                        kMaxPacketSizeBytes <=
+                    kBatchSizeBytes,
+                "The batch must be large enough to hold the largest packet");
+
+  std::array<std::byte, kMaxPacketSizeBytes> packet_buffer_;
+  std::array<std::byte, kBatchSizeBytes> batch_buffer_;
+};
+
+}  // namespace pw::rpc
@@ -66,7 +66,10 @@ class Channel {
 
   // Creates a dynamically assignable channel without a set ID or output.
   constexpr Channel()
-      : id_(kUnassignedChannelId), output_(nullptr), client_(nullptr) {}
+      : id_(kUnassignedChannelId),
+        output_(nullptr),
+        client_(nullptr),
+        fragment_large_payloads_(false) {}
 
   // Creates a channel with a static ID. The channel's output can also be
   // static, or it can set to null to allow dynamically opening connections
@@ -114,9 +117,23 @@ class Channel {
   constexpr uint32_t id() const { return id_; }
   constexpr bool assigned() const { return id_ != kUnassignedChannelId; }
 
+  // Allows payloads that do not fit in one buffer from the ChannelOutput to be
+  // split across several packets. Only enable this if the other end of the
+  // channel reassembles split payloads into a buffer set with
+  // Server::set_reassembly_buffer or Client::set_reassembly_buffer.
+  constexpr void set_fragment_large_payloads(bool enabled) {
+    fragment_large_payloads_ = enabled;
+  }
+  constexpr bool fragment_large_payloads() const {
+    return fragment_large_payloads_;
+  }
+
  protected:
   constexpr Channel(uint32_t id, ChannelOutput* output)
-      : id_(id), output_(output), client_(nullptr) {
+      : id_(id),
+        output_(output),
+        client_(nullptr),
+        fragment_large_payloads_(false) {
     PW_ASSERT(id != kUnassignedChannelId);
   }
 
@@ -135,6 +152,7 @@ class Channel {
   uint32_t id_;
   ChannelOutput* output_;
   Client* client_;
+  bool fragment_large_payloads_;
 };
 
 }  // namespace pw::rpc
@@ -13,12 +13,17 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <span>
 
 #include "pw_bytes/span.h"
 #include "pw_rpc/internal/base_client_call.h"
 #include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/config.h"
+#include "pw_rpc/internal/payload_reassembler.h"
 
 namespace pw::rpc {
 
@@ -28,35 +33,87 @@ class Client {
   // between a client and a server, but not between multiple clients.
   constexpr Client(std::span<Channel> channels)
       : channels_(static_cast<internal::Channel*>(channels.data()),
-                  channels.size()) {
+                  channels.size()),
+        next_call_id_(1) {
     for (Channel& channel : channels_) {
       channel.set_client(this);
     };
   }
 
   // Processes an incoming RPC packet. The packet may be an RPC response or a
-  // control packet, the result of which is processed in this function. Returns
+  // control packet, the result of which is processed in this function. The
+  // data may also be a batch of packets, each of which is processed. Returns
   // whether the packet was able to be processed:
   //
   //   OK - The packet was processed by the client.
-  //   DATA_LOSS - Failed to decode the packet.
+  //   DATA_LOSS - Failed to decode the packet, or part of a split response
+  //       was lost.
   //   INVALID_ARGUMENT - The packet is intended for a server, not a client.
   //   NOT_FOUND - The packet belongs to an unknown RPC call.
+  //   RESOURCE_EXHAUSTED - A split response does not fit in the reassembly
+  //       buffer.
   //   UNIMPLEMENTED - Received a type of packet that the client doesn't know
   //       how to handle.
   //
   Status ProcessPacket(ConstByteSpan data);
 
-  size_t active_calls() const { return calls_.size(); }
+  size_t active_calls() const;
+
+  // Sets the buffer into which response payloads that were split across
+  // several packets are reassembled. Split responses are dropped if they do
+  // not fit, or if no buffer is set. One response is reassembled at a time.
+  // The buffer must outlive the client.
+  void set_reassembly_buffer(ByteSpan buffer) {
+    reassembler_.set_buffer(buffer);
+  }
 
  private:
   friend class internal::BaseClientCall;
 
+  Status ProcessSinglePacket(ConstByteSpan data);
+
+  using CallList = IntrusiveList<internal::BaseClientCall>;
+
   Status RegisterCall(internal::BaseClientCall& call);
-  void RemoveCall(const internal::BaseClientCall& call) { calls_.remove(call); }
+
+  // Returns an ID for a new call. IDs are nonzero, since zero is sent by
+  // clients that do not assign them.
+  uint32_t NewCallId() {
+    const uint32_t id = next_call_id_;
+    next_call_id_ = id == std::numeric_limits<uint32_t>::max() ? 1 : id + 1;
+    return id;
+  }
+
+  void RemoveCall(const internal::BaseClientCall& call) {
+    CallsFor(call.channel().id(), call.service_id(), call.method_id())
+        .remove(call);
+  }
+
+  // Returns the call list that holds calls with the provided IDs.
+  CallList& CallsFor(uint32_t channel_id,
+                     uint32_t service_id,
+                     uint32_t method_id) {
+    // Service and method IDs are hashes, so their low bits are well mixed.
+    return calls_[(service_id ^ method_id ^ (channel_id * 0x9e3779b9u)) %
+                  calls_.size()];
+  }
+
+  // Finds the call with the given IDs. A call ID of zero, sent by servers that
+  // predate call IDs, matches any call to the method.
+  internal::BaseClientCall* FindCall(uint32_t channel_id,
+                                     uint32_t service_id,
+                                     uint32_t method_id,
+                                     uint32_t call_id);
 
   std::span<internal::Channel> channels_;
-  IntrusiveList<internal::BaseClientCall> calls_;
+  uint32_t next_call_id_;
+
+  // Active calls, stored in hash buckets keyed on channel, service, and method.
+  // Concurrent calls to one method share a bucket and are told apart by their
+  // call IDs.
+  std::array<CallList, cfg::kClientCallBuckets> calls_;
+
+  internal::PayloadReassembler reassembler_;
 };
 
 }  // namespace pw::rpc
@@ -35,6 +35,7 @@ class BaseClientCall : public IntrusiveList<BaseClientCall>::Item {
       : channel_(static_cast<Channel*>(channel)),
         service_id_(service_id),
         method_id_(method_id),
+        call_id_(0),
         handler_(handler),
         active_(true) {
     PW_ASSERT(channel_ != nullptr);
@@ -45,6 +46,7 @@ class BaseClientCall : public IntrusiveList<BaseClientCall>::Item {
       : channel_(nullptr),
         service_id_(0),
         method_id_(0),
+        call_id_(0),
         handler_(nullptr),
         active_(false) {}
 
@@ -62,13 +64,26 @@ class BaseClientCall : public IntrusiveList<BaseClientCall>::Item {
 
   void Cancel();
 
+  // Grants a flow-controlled server stream credit to send this many more
+  // packets. The stream must have been made flow controlled by sending credit
+  // in the request.
+  Status GrantCredit(uint32_t packets);
+
  protected:
   constexpr Channel& channel() const { return *channel_; }
   constexpr uint32_t service_id() const { return service_id_; }
   constexpr uint32_t method_id() const { return method_id_; }
 
+  // The ID the client assigned to this call, which distinguishes it from other
+  // pending calls to the same method.
+  constexpr uint32_t call_id() const { return call_id_; }
+
   std::span<std::byte> AcquirePayloadBuffer();
-  Status ReleasePayloadBuffer(std::span<const std::byte> payload);
+  // Sends the request. A nonzero stream_credit makes the RPC's server stream
+  // flow controlled: the server sends at most that many responses until more
+  // credit is granted with GrantCredit.
+  Status ReleasePayloadBuffer(std::span<const std::byte> payload,
+                              uint32_t stream_credit = 0);
 
   void Unregister();
 
@@ -85,6 +100,7 @@ class BaseClientCall : public IntrusiveList<BaseClientCall>::Item {
   Channel* channel_;
   uint32_t service_id_;
   uint32_t method_id_;
+  uint32_t call_id_;
   Channel::OutputBuffer request_;
   ResponseHandler handler_;
   bool active_;
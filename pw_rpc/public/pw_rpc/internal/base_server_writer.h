@@ -41,7 +41,8 @@ class BaseServerWriter : public IntrusiveList<BaseServerWriter>::Item {
 
   BaseServerWriter(const BaseServerWriter&) = delete;
 
-  BaseServerWriter(BaseServerWriter&& other) : state_(kClosed) {
+  BaseServerWriter(BaseServerWriter&& other)
+      : flow_controlled_(false), credit_(0), state_(kClosed) {
     *this = std::move(other);
   }
 
@@ -57,12 +58,23 @@ class BaseServerWriter : public IntrusiveList<BaseServerWriter>::Item {
   uint32_t channel_id() const { return call_.channel().id(); }
   uint32_t service_id() const { return call_.service().id(); }
   uint32_t method_id() const;
+  uint32_t call_id() const { return call_.call_id(); }
 
   // Closes the ServerWriter, if it is open.
   Status Finish(Status status = OkStatus());
 
+  // True if the client limits how many packets this writer may send. A client
+  // enables flow control by granting credit in its request.
+  bool flow_controlled() const { return flow_controlled_; }
+
+  // The number of packets the writer may send before the client grants more
+  // credit. When this reaches zero, writes fail with UNAVAILABLE. Only
+  // meaningful if flow_controlled() is true.
+  uint32_t available_credit() const { return credit_; }
+
  protected:
-  constexpr BaseServerWriter() : state_{kClosed} {}
+  constexpr BaseServerWriter()
+      : flow_controlled_(false), credit_(0), state_{kClosed} {}
 
   const Method& method() const { return call_.method(); }
 
@@ -75,21 +87,31 @@ class BaseServerWriter : public IntrusiveList<BaseServerWriter>::Item {
   std::span<std::byte> AcquirePayloadBuffer();
 
   // Releases the buffer, sending a packet with the specified payload. The
-  // BaseServerWriter MUST be open when this is called!
+  // BaseServerWriter MUST be open when this is called! If the writer is out of
+  // credit, the packet is not sent and this returns UNAVAILABLE.
   Status ReleasePayloadBuffer(std::span<const std::byte> payload);
 
   // Releases the buffer without sending a packet.
   Status ReleasePayloadBuffer();
 
+  // Releases the buffer without sending a packet because the response failed
+  // to encode. Returns INTERNAL.
+  Status ReleasePayloadBufferForEncodeFailure();
+
  private:
   friend class rpc::Server;
 
   void Close();
 
+  // Adds credit granted by the client in a SERVER_STREAM_CREDIT packet.
+  void AddCredit(uint32_t credit);
+
   Packet ResponsePacket(std::span<const std::byte> payload = {}) const;
 
   ServerCall call_;
   Channel::OutputBuffer response_;
+  bool flow_controlled_;
+  uint32_t credit_;
   enum { kClosed, kOpen } state_;
 };
 
@@ -41,16 +41,22 @@ class ServerCall {
       : server_(nullptr),
         channel_(nullptr),
         service_(nullptr),
-        method_(nullptr) {}
+        method_(nullptr),
+        stream_credit_(0),
+        call_id_(0) {}
 
   constexpr ServerCall(Server& server,
                        Channel& channel,
                        Service& service,
-                       const internal::Method& method)
+                       const internal::Method& method,
+                       uint32_t stream_credit = 0,
+                       uint32_t call_id = 0)
       : server_(&server),
         channel_(&channel),
         service_(&service),
-        method_(&method) {}
+        method_(&method),
+        stream_credit_(stream_credit),
+        call_id_(call_id) {}
 
   constexpr ServerCall(const ServerCall&) = default;
   constexpr ServerCall& operator=(const ServerCall&) = default;
@@ -78,11 +84,21 @@ class ServerCall {
     return *method_;
   }
 
+  // The credit the client granted for the call's server stream in its request.
+  // Zero if the server stream is not flow controlled.
+  constexpr uint32_t stream_credit() const { return stream_credit_; }
+
+  // The ID the client assigned to the call, which is sent back in every packet
+  // for it. Zero if the client does not assign call IDs.
+  constexpr uint32_t call_id() const { return call_id_; }
+
  private:
   Server* server_;
   Channel* channel_;
   Service* service_;
   const internal::Method* method_;
+  uint32_t stream_credit_;
+  uint32_t call_id_;
 };
 
 }  // namespace internal
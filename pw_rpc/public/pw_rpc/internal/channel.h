@@ -30,6 +30,11 @@ class Channel : public rpc::Channel {
   constexpr Channel(uint32_t id, ChannelOutput* output)
       : rpc::Channel(id, output) {}
 
+  // Finds the channel with the provided ID, or returns nullptr if there is
+  // none. Channels are commonly numbered sequentially from 1, so the channel at
+  // index id - 1 is checked before searching the rest.
+  static Channel* Find(std::span<Channel> channels, uint32_t id);
+
   class OutputBuffer {
    public:
     constexpr OutputBuffer() = default;
@@ -78,12 +83,20 @@ class Channel : public rpc::Channel {
     return Send(buffer, packet);
   }
 
+  // Encodes and sends a packet. If the packet's payload is not in the buffer
+  // and the packet does not fit in it, the payload is split across several
+  // packets if fragment_large_payloads() is set.
   Status Send(OutputBuffer& output, const internal::Packet& packet);
 
   void Release(OutputBuffer& buffer) {
     output().DiscardBuffer(buffer.buffer_);
     buffer.buffer_ = {};
   }
+
+ private:
+  // Sends the packet's payload in as many packets as needed, the first of
+  // which is encoded into buffer.
+  Status SendFragments(OutputBuffer& buffer, const internal::Packet& packet);
 };
 
 }  // namespace pw::rpc::internal
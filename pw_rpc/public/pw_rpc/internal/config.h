@@ -55,3 +55,61 @@ inline constexpr size_t kNanopbStructMinBufferSize =
 #endif  // PW_RPC_NANOPB_STRUCT_BUFFER_STACK_ALLOCATE
 
 #undef PW_RPC_NANOPB_STRUCT_BUFFER_STACK_ALLOCATE
+
+// If nonzero, the Nanopb structs are taken from pools of fixed-size blocks
+// instead of the stack or a global variable, which is safe when ProcessPacket
+// is called from multiple threads. Each struct size class (see
+// PW_RPC_NANOPB_STRUCT_MIN_BUFFER_SIZE) has its own pool with this many blocks.
+// An RPC that arrives when its pool is exhausted fails with RESOURCE_EXHAUSTED.
+// Takes precedence over PW_RPC_NANOPB_STRUCT_BUFFER_STACK_ALLOCATE. Must be no
+// more than 32.
+#ifndef PW_RPC_NANOPB_STRUCT_BUFFER_POOL_BLOCKS
+#define PW_RPC_NANOPB_STRUCT_BUFFER_POOL_BLOCKS 0
+#endif  // PW_RPC_NANOPB_STRUCT_BUFFER_POOL_BLOCKS
+
+namespace pw::rpc::cfg {
+
+inline constexpr size_t kNanopbStructPoolBlocks =
+    PW_RPC_NANOPB_STRUCT_BUFFER_POOL_BLOCKS;
+
+static_assert(kNanopbStructPoolBlocks <= 32u,
+              "PW_RPC_NANOPB_STRUCT_BUFFER_POOL_BLOCKS must be at most 32");
+
+}  // namespace pw::rpc::cfg
+
+#undef PW_RPC_NANOPB_STRUCT_BUFFER_POOL_BLOCKS
+
+// The number of hash buckets the RPC client uses to find active calls when a
+// response arrives. Each bucket is a list head, which is one pointer. Clients
+// with many concurrent calls match responses faster with more buckets. Must be
+// a power of two.
+#ifndef PW_RPC_CLIENT_CALL_BUCKETS
+#define PW_RPC_CLIENT_CALL_BUCKETS 8
+#endif  // PW_RPC_CLIENT_CALL_BUCKETS
+
+namespace pw::rpc::cfg {
+
+inline constexpr size_t kClientCallBuckets = PW_RPC_CLIENT_CALL_BUCKETS;
+
+static_assert(kClientCallBuckets > 0u &&
+                  (kClientCallBuckets & (kClientCallBuckets - 1)) == 0u,
+              "PW_RPC_CLIENT_CALL_BUCKETS must be a power of two");
+
+}  // namespace pw::rpc::cfg
+
+#undef PW_RPC_CLIENT_CALL_BUCKETS
+
+// Whether the server reports events to a ServerInstrumentation (see
+// pw_rpc/server_instrumentation.h). When disabled, the instrumentation calls
+// are compiled out.
+#ifndef PW_RPC_SERVER_INSTRUMENTATION
+#define PW_RPC_SERVER_INSTRUMENTATION 0
+#endif  // PW_RPC_SERVER_INSTRUMENTATION
+
+namespace pw::rpc::cfg {
+
+inline constexpr bool kServerInstrumentation = PW_RPC_SERVER_INSTRUMENTATION;
+
+}  // namespace pw::rpc::cfg
+
+#undef PW_RPC_SERVER_INSTRUMENTATION
@@ -18,6 +18,7 @@
 #include <span>
 
 #include "pw_bytes/span.h"
+#include "pw_protobuf/decoder.h"
 #include "pw_rpc/internal/packet.pwpb.h"
 #include "pw_status/status_with_size.h"
 
@@ -31,38 +32,23 @@ class Packet {
   // their default values.
   static Result<Packet> FromBuffer(ConstByteSpan data);
 
-  // Creates an RPC packet with the channel, service, and method ID of the
+  // Creates an RPC packet with the channel, service, method, and call ID of the
   // provided packet.
   static constexpr Packet Response(const Packet& request,
                                    Status status = OkStatus()) {
-    return Packet(PacketType::RESPONSE,
-                  request.channel_id(),
-                  request.service_id(),
-                  request.method_id(),
-                  {},
-                  status);
+    return ForCall(PacketType::RESPONSE, request, status);
   }
 
-  // Creates a SERVER_ERROR packet with the channel, service, and method ID of
-  // the provided packet.
+  // Creates a SERVER_ERROR packet with the channel, service, method, and call
+  // ID of the provided packet.
   static constexpr Packet ServerError(const Packet& packet, Status status) {
-    return Packet(PacketType::SERVER_ERROR,
-                  packet.channel_id(),
-                  packet.service_id(),
-                  packet.method_id(),
-                  {},
-                  status);
+    return ForCall(PacketType::SERVER_ERROR, packet, status);
   }
 
-  // Creates a CLIENT_ERROR packet with the channel, service, and method ID of
-  // the provided packet.
+  // Creates a CLIENT_ERROR packet with the channel, service, method, and call
+  // ID of the provided packet.
   static constexpr Packet ClientError(const Packet& packet, Status status) {
-    return Packet(PacketType::CLIENT_ERROR,
-                  packet.channel_id(),
-                  packet.service_id(),
-                  packet.method_id(),
-                  {},
-                  status);
+    return ForCall(PacketType::CLIENT_ERROR, packet, status);
   }
 
   // Creates an empty packet.
@@ -80,9 +66,16 @@ class Packet {
         service_id_(service_id),
         method_id_(method_id),
         payload_(payload),
-        status_(status) {}
+        status_(status),
+        credit_(0),
+        call_id_(0),
+        continued_(false),
+        payload_offset_(0) {}
 
   // Encodes the packet into its wire format. Returns the encoded size.
+  //
+  // If the payload was built in the buffer at PayloadOffset(), the other fields
+  // are encoded in front of it and the payload is not copied.
   Result<ConstByteSpan> Encode(ByteSpan buffer) const;
 
   // Determines the space required to encode the packet proto fields for a
@@ -90,6 +83,12 @@ class Packet {
   // reserved space and available space for the payload.
   size_t MinEncodedSizeBytes() const;
 
+  // Returns the offset in a buffer of buffer_size bytes at which to build this
+  // packet's payload, so that Encode() can encode the packet without copying
+  // the payload. This reserves space for the other fields and for the
+  // payload's length at the largest size the buffer could hold.
+  size_t PayloadOffset(size_t buffer_size) const;
+
   enum Destination : bool { kServer, kClient };
 
   constexpr Destination destination() const {
@@ -102,6 +101,16 @@ class Packet {
   constexpr uint32_t method_id() const { return method_id_; }
   constexpr const ConstByteSpan& payload() const { return payload_; }
   constexpr Status status() const { return status_; }
+  constexpr uint32_t credit() const { return credit_; }
+  constexpr uint32_t call_id() const { return call_id_; }
+  constexpr bool continued() const { return continued_; }
+  constexpr uint32_t payload_offset() const { return payload_offset_; }
+
+  // True if this packet carries part of a payload that was split across
+  // several packets.
+  constexpr bool fragment() const {
+    return continued_ || payload_offset_ != 0u;
+  }
 
   constexpr void set_type(PacketType type) { type_ = type; }
   constexpr void set_channel_id(uint32_t channel_id) {
@@ -113,14 +122,79 @@ class Packet {
   constexpr void set_method_id(uint32_t method_id) { method_id_ = method_id; }
   constexpr void set_payload(ConstByteSpan payload) { payload_ = payload; }
   constexpr void set_status(Status status) { status_ = status; }
+  constexpr void set_credit(uint32_t credit) { credit_ = credit; }
+  constexpr void set_call_id(uint32_t call_id) { call_id_ = call_id; }
+  constexpr void set_continued(bool continued) { continued_ = continued; }
+  constexpr void set_payload_offset(uint32_t offset) {
+    payload_offset_ = offset;
+  }
 
  private:
+  static constexpr Packet ForCall(PacketType type,
+                                  const Packet& call,
+                                  Status status) {
+    Packet packet(type,
+                  call.channel_id(),
+                  call.service_id(),
+                  call.method_id(),
+                  {},
+                  status);
+    packet.set_call_id(call.call_id());
+    return packet;
+  }
+
+  // Encodes the packet's fields in front of a payload that is already in the
+  // buffer. Returns an empty span if there is not room for them.
+  ConstByteSpan EncodeAroundPayload(ByteSpan buffer) const;
+
   PacketType type_;
   uint32_t channel_id_;
   uint32_t service_id_;
   uint32_t method_id_;
   ConstByteSpan payload_;
   Status status_;
+  uint32_t credit_;
+  uint32_t call_id_;
+  bool continued_;
+  uint32_t payload_offset_;
 };
 
+// Returns true if the data is an encoded RpcPacketBatch rather than a single
+// RpcPacket.
+bool IsPacketBatch(ConstByteSpan data);
+
+// Calls process(ConstByteSpan) for each packet in data, which is either a
+// single encoded packet or an RpcPacketBatch. Every packet in a batch is
+// processed; the first non-OK status returned by process is returned. Returns
+// DATA_LOSS if the batch is malformed.
+template <typename Function>
+Status ForEachPacket(ConstByteSpan data, Function&& process) {
+  if (!IsPacketBatch(data)) {
+    return process(data);
+  }
+
+  Status result;
+  Status status;
+  protobuf::Decoder decoder(data);
+
+  while ((status = decoder.Next()).ok()) {
+    ConstByteSpan packet;
+    if (static_cast<RpcPacketBatch::Fields>(decoder.FieldNumber()) !=
+            RpcPacketBatch::Fields::PACKETS ||
+        !decoder.ReadBytes(&packet).ok()) {
+      return Status::DataLoss();
+    }
+
+    const Status packet_status = process(packet);
+    if (result.ok()) {
+      result = packet_status;
+    }
+  }
+
+  if (status.IsDataLoss()) {
+    return status;
+  }
+  return result;
+}
+
 }  // namespace pw::rpc::internal
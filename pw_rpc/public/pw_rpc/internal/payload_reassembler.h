@@ -0,0 +1,84 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_status/status.h"
+
+namespace pw::rpc::internal {
+
+// Reassembles payloads that were split across several packets (see
+// Channel::set_fragment_large_payloads) into a caller-provided buffer. One
+// payload is reassembled at a time.
+class PayloadReassembler {
+ public:
+  constexpr PayloadReassembler()
+      : buffer_{},
+        size_(0),
+        channel_id_(0),
+        service_id_(0),
+        method_id_(0),
+        call_id_(0),
+        type_{},
+        active_(false) {}
+
+  PayloadReassembler(const PayloadReassembler&) = delete;
+  PayloadReassembler& operator=(const PayloadReassembler&) = delete;
+
+  // Sets the buffer into which payloads are reassembled. A payload in progress
+  // is discarded.
+  void set_buffer(ByteSpan buffer) {
+    buffer_ = buffer;
+    active_ = false;
+  }
+
+  // Adds a received packet. Packets that are not fragments are returned
+  // unchanged.
+  //
+  // Returns:
+  //
+  //   OK - The packet is complete. If it was the last fragment of a payload,
+  //       its payload is set to the reassembled payload, which remains valid
+  //       until the next fragment is added.
+  //   UNAVAILABLE - The fragment was stored; more are needed for the payload.
+  //   RESOURCE_EXHAUSTED - The payload does not fit in the buffer, or another
+  //       payload is being reassembled.
+  //   DATA_LOSS - A fragment was lost, so the payload cannot be reassembled.
+  //
+  // After an error, the remaining fragments of the payload are rejected with
+  // DATA_LOSS.
+  Status Add(Packet& packet);
+
+ private:
+  bool IsFromCurrentCall(const Packet& packet) const {
+    return packet.type() == type_ && packet.channel_id() == channel_id_ &&
+           packet.service_id() == service_id_ &&
+           packet.method_id() == method_id_ && packet.call_id() == call_id_;
+  }
+
+  ByteSpan buffer_;
+  size_t size_;
+
+  uint32_t channel_id_;
+  uint32_t service_id_;
+  uint32_t method_id_;
+  uint32_t call_id_;
+  PacketType type_;
+  bool active_;
+};
+
+}  // namespace pw::rpc::internal
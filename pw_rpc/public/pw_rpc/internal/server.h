@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include "pw_rpc/internal/packet.h"
 #include "pw_rpc/server.h"
 
 namespace pw::rpc::internal {
@@ -28,6 +29,31 @@ class Server : public rpc::Server {
   void RemoveWriter(const BaseServerWriter& writer) {
     writers().remove(writer);
   }
+
+  // Reports a response for the method of the provided packet to the server's
+  // instrumentation, if any.
+  void ResponseSent(const Packet& packet,
+                    size_t payload_size_bytes,
+                    Status status) const {
+    if (ServerInstrumentation* instrumentation = this->instrumentation();
+        instrumentation != nullptr) {
+      instrumentation->ResponseSent(packet.service_id(),
+                                    packet.method_id(),
+                                    payload_size_bytes,
+                                    status);
+    }
+  }
+
+  // Reports that a server stream finished to the server's instrumentation, if
+  // any.
+  void StreamFinished(uint32_t service_id,
+                      uint32_t method_id,
+                      Status status) const {
+    if (ServerInstrumentation* instrumentation = this->instrumentation();
+        instrumentation != nullptr) {
+      instrumentation->StreamFinished(service_id, method_id, status);
+    }
+  }
 };
 
 }  // namespace pw::rpc::internal
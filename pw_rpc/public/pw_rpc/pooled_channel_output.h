@@ -0,0 +1,88 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::rpc {
+namespace internal {
+
+// Non-templated base so the code is shared between PooledChannelOutputs with
+// different buffer sizes.
+class BasePooledChannelOutput : public ChannelOutput {
+ public:
+  // Takes a buffer from the pool, blocking until one is free. The pool lock is
+  // only held while the buffer is taken, so threads encode in parallel.
+  std::span<std::byte> AcquireBuffer() final;
+
+  // Sends the packet through the wrapped output and returns the buffer to the
+  // pool. Sends are serialized with a lock that is held only while the packet
+  // is copied to and sent through the wrapped output.
+  Status SendAndReleaseBuffer(std::span<const std::byte> packet) final;
+
+ protected:
+  BasePooledChannelOutput(ChannelOutput& output,
+                          ByteSpan buffers,
+                          std::span<uint8_t> free_buffers);
+
+ private:
+  ChannelOutput& output_;
+  const ByteSpan buffers_;
+  const size_t buffer_size_bytes_;
+
+  sync::CountingSemaphore buffer_available_;
+
+  sync::Mutex pool_mutex_;
+  std::span<uint8_t> free_buffers_ PW_GUARDED_BY(pool_mutex_);
+  size_t free_count_ PW_GUARDED_BY(pool_mutex_);
+
+  sync::Mutex send_mutex_;
+};
+
+}  // namespace internal
+
+// A multi-threaded ChannelOutput with a pool of kBuffers packet buffers. Unlike
+// SynchronizedChannelOutput, which holds one lock while a packet is encoded and
+// sent, each thread encodes into its own buffer from the pool in parallel. Only
+// the send through the wrapped output is serialized. When every buffer is in
+// use, AcquireBuffer() blocks until one is released.
+//
+// Each packet is copied once, into the wrapped output's buffer, while the send
+// lock is held. The wrapped output is only accessed with that lock held, so it
+// need not be synchronized itself.
+template <size_t kBuffers, size_t kBufferSizeBytes>
+class PooledChannelOutput : public internal::BasePooledChannelOutput {
+ public:
+  PooledChannelOutput(ChannelOutput& output)
+      : internal::BasePooledChannelOutput(output, buffers_, free_buffers_) {}
+
+ private:
+  static_assert(kBuffers > 0u && kBuffers <= 255u,
+                "PooledChannelOutput supports 1 to 255 buffers");
+
+  std::array<std::byte, kBuffers * kBufferSizeBytes> buffers_;
+  std::array<uint8_t, kBuffers> free_buffers_;
+};
+
+}  // namespace pw::rpc
@@ -0,0 +1,163 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+
+namespace pw::rpc {
+namespace internal {
+
+// Non-templated base so the code is shared between PriorityChannelOutputs with
+// different sizes.
+class BasePriorityChannelOutput : public ChannelOutput {
+ public:
+  // Returns the priority of packets for a method. 0 is the most urgent
+  // priority; values past the lowest priority are treated as the lowest.
+  using PriorityFunction = size_t (*)(uint32_t service_id, uint32_t method_id);
+
+  // Returns a free packet slot. All slots are in use only if packets are
+  // acquired concurrently, in which case an empty buffer is returned.
+  std::span<std::byte> AcquireBuffer() final;
+
+  // Queues the packet by its method's priority. Returns RESOURCE_EXHAUSTED and
+  // drops the packet if that priority's queue is full.
+  Status SendAndReleaseBuffer(std::span<const std::byte> packet) final;
+
+  // Sends the oldest packet of the most urgent non-empty queue through the
+  // wrapped output. The packet is removed from its queue even if sending
+  // fails. Returns NOT_FOUND if no packets are queued, RESOURCE_EXHAUSTED if
+  // the wrapped output's buffer is too small, or the wrapped output's status.
+  Status SendNext();
+
+  // Sends queued packets in priority order until the queues are empty or a
+  // send fails. Returns the first failure; packets after it stay queued.
+  Status Flush();
+
+  size_t priorities() const { return queues_.size(); }
+
+  // The number of packets waiting to be sent, in total or at one priority.
+  size_t queued_packets() const;
+  size_t queued_packets(size_t priority) const {
+    return queues_[priority].count;
+  }
+
+  // The number of packets dropped because their queue was full.
+  size_t dropped_packets() const { return dropped_packets_; }
+
+ protected:
+  using SlotIndex = uint16_t;
+  static constexpr SlotIndex kNoSlot = std::numeric_limits<SlotIndex>::max();
+
+  // A FIFO of slot indices, stored in a range of queue_slots_.
+  struct Queue {
+    size_t head;
+    size_t count;
+  };
+
+  BasePriorityChannelOutput(ChannelOutput& output,
+                            PriorityFunction priority,
+                            ByteSpan slot_storage,
+                            std::span<size_t> packet_sizes,
+                            std::span<SlotIndex> free_slots,
+                            std::span<SlotIndex> queue_slots,
+                            std::span<Queue> queues);
+
+ private:
+  size_t PriorityOf(std::span<const std::byte> packet) const;
+
+  ByteSpan slot(SlotIndex index) const {
+    return slot_storage_.subspan(index * slot_size_bytes_, slot_size_bytes_);
+  }
+
+  SlotIndex& queue_slot(size_t priority, size_t position) const {
+    return queue_slots_[priority * queue_depth_ + position % queue_depth_];
+  }
+
+  void Free(SlotIndex index) { free_slots_[free_count_++] = index; }
+
+  ChannelOutput& output_;
+  PriorityFunction priority_;
+
+  ByteSpan slot_storage_;
+  size_t slot_size_bytes_;
+  std::span<size_t> packet_sizes_;
+
+  std::span<SlotIndex> free_slots_;
+  size_t free_count_;
+  SlotIndex acquired_slot_;
+
+  std::span<SlotIndex> queue_slots_;
+  std::span<Queue> queues_;
+  size_t queue_depth_;
+
+  size_t dropped_packets_;
+};
+
+}  // namespace internal
+
+// Wraps a ChannelOutput to send urgent packets ahead of bulk traffic. Packets
+// sent through the PriorityChannelOutput are queued by the priority of their
+// RPC method, as returned by a user-provided function, and sent through the
+// wrapped output by SendNext() or Flush(), most urgent queue first. A
+// transmit loop that calls SendNext() for each packet lets a control RPC's
+// response overtake a saturating log or trace stream after at most one packet.
+//
+// Each priority queues up to kQueueDepth packets of up to kMaxPacketSizeBytes.
+// When a queue is full, further packets at that priority are rejected with
+// RESOURCE_EXHAUSTED, so a bulk stream is throttled without taking space from
+// more urgent packets. Priorities are strict: bulk packets are only sent while
+// the more urgent queues are empty.
+//
+// Packets are built directly in their slot, so queueing does not copy them;
+// sending copies each packet once into the wrapped output's buffer.
+//
+// PriorityChannelOutput does not synchronize access. With several threads,
+// wrap it in a SynchronizedChannelOutput and hold the same mutex when calling
+// SendNext() or Flush().
+template <size_t kPriorities, size_t kQueueDepth, size_t kMaxPacketSizeBytes>
+class PriorityChannelOutput : public internal::BasePriorityChannelOutput {
+ public:
+  PriorityChannelOutput(ChannelOutput& output, PriorityFunction priority)
+      : internal::BasePriorityChannelOutput(output,
+                                            priority,
+                                            slot_storage_,
+                                            packet_sizes_,
+                                            free_slots_,
+                                            queue_slots_,
+                                            queues_) {}
+
+ private:
+  static_assert(kPriorities > 0u && kQueueDepth > 0u);
+
+  // Every queue can be full while one more packet is being built.
+  static constexpr size_t kSlots = kPriorities * kQueueDepth + 1;
+
+  static_assert(kSlots < kNoSlot, "Too many packet slots");
+
+  std::array<std::byte, kSlots * kMaxPacketSizeBytes> slot_storage_;
+  std::array<size_t, kSlots> packet_sizes_;
+  std::array<SlotIndex, kSlots> free_slots_;
+  std::array<SlotIndex, kPriorities * kQueueDepth> queue_slots_;
+  std::array<Queue, kPriorities> queues_;
+};
+
+}  // namespace pw::rpc
@@ -21,7 +21,10 @@
 #include "pw_rpc/channel.h"
 #include "pw_rpc/internal/base_server_writer.h"
 #include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/config.h"
 #include "pw_rpc/internal/method.h"
+#include "pw_rpc/internal/payload_reassembler.h"
+#include "pw_rpc/server_instrumentation.h"
 #include "pw_rpc/service.h"
 #include "pw_status/status.h"
 
@@ -31,7 +34,8 @@ class Server {
  public:
   constexpr Server(std::span<Channel> channels)
       : channels_(static_cast<internal::Channel*>(channels.data()),
-                  channels.size()) {}
+                  channels.size()),
+        instrumentation_(nullptr) {}
 
   ~Server();
 
@@ -40,7 +44,8 @@ class Server {
   void RegisterService(Service& service) { services_.push_front(service); }
 
   // Processes an RPC packet. The packet may contain an RPC request or a control
-  // packet, the result of which is processed in this function. Returns whether
+  // packet, the result of which is processed in this function. The data may
+  // also be a batch of packets, each of which is processed. Returns whether
   // the packet was able to be processed:
   //
   //   OK - The packet was processed by the server.
@@ -52,16 +57,48 @@ class Server {
 
   constexpr size_t channel_count() const { return channels_.size(); }
 
+  // Sets the instrumentation to which the server reports events as it
+  // processes RPCs. Has no effect unless PW_RPC_SERVER_INSTRUMENTATION is
+  // enabled.
+  void set_instrumentation(ServerInstrumentation& instrumentation) {
+    instrumentation_ = &instrumentation;
+  }
+
+  // Sets the buffer into which request payloads that were split across several
+  // packets are reassembled. Split requests are rejected with
+  // RESOURCE_EXHAUSTED if they do not fit, or if no buffer is set. One request
+  // is reassembled at a time. The buffer must outlive the server.
+  void set_reassembly_buffer(ByteSpan buffer) {
+    reassembler_.set_buffer(buffer);
+  }
+
  protected:
   IntrusiveList<internal::BaseServerWriter>& writers() { return writers_; }
 
+  // Returns the instrumentation, or null if there is none. Always null if
+  // instrumentation is disabled, so calls through it are compiled out.
+  ServerInstrumentation* instrumentation() const {
+    if constexpr (cfg::kServerInstrumentation) {
+      return instrumentation_;
+    } else {
+      return nullptr;
+    }
+  }
+
  private:
+  Status ProcessSinglePacket(std::span<const std::byte> packet,
+                             ChannelOutput& interface);
+
   std::tuple<Service*, const internal::Method*> FindMethod(
       const internal::Packet& packet);
 
+  internal::BaseServerWriter* FindWriter(const internal::Packet& packet);
+
   void HandleCancelPacket(const internal::Packet& request,
                           internal::Channel& channel);
   void HandleClientError(const internal::Packet& packet);
+  void HandleCreditPacket(const internal::Packet& packet,
+                          internal::Channel& channel);
 
   internal::Channel* FindChannel(uint32_t id) const;
   internal::Channel* AssignChannel(uint32_t id, ChannelOutput& interface);
@@ -69,6 +106,8 @@ class Server {
   std::span<internal::Channel> channels_;
   IntrusiveList<Service> services_;
   IntrusiveList<internal::BaseServerWriter> writers_;
+  ServerInstrumentation* instrumentation_;
+  internal::PayloadReassembler reassembler_;
 };
 
 }  // namespace pw::rpc
@@ -0,0 +1,59 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_status/status.h"
+
+namespace pw::rpc {
+
+// Receives events from a Server as it processes RPCs. The server only reports
+// events if PW_RPC_SERVER_INSTRUMENTATION is enabled; otherwise, the calls are
+// compiled out. pw_rpc/metrics provides an implementation that records
+// per-method pw_metric metrics.
+//
+// Events are reported from the thread that processes the packet or writes to
+// the stream, so implementations must be quick, and thread safe if the server
+// is used from multiple threads.
+class ServerInstrumentation {
+ public:
+  virtual ~ServerInstrumentation() = default;
+
+  // A request for a method arrived and is about to be handled. The returned
+  // value, such as a timestamp, is passed to MethodReturned.
+  virtual int64_t RequestReceived(uint32_t service_id,
+                                  uint32_t method_id,
+                                  size_t payload_size_bytes) = 0;
+
+  // The method's handler returned. For unary RPCs, the response was sent before
+  // the handler returned.
+  virtual void MethodReturned(uint32_t service_id,
+                              uint32_t method_id,
+                              int64_t request_received) = 0;
+
+  // A response was sent, or failed to encode or send if status is not OK.
+  virtual void ResponseSent(uint32_t service_id,
+                            uint32_t method_id,
+                            size_t payload_size_bytes,
+                            Status status) = 0;
+
+  // A server stream was finished with the provided status.
+  virtual void StreamFinished(uint32_t service_id,
+                              uint32_t method_id,
+                              Status status) = 0;
+};
+
+}  // namespace pw::rpc
@@ -35,12 +35,42 @@ class Service : public IntrusiveList<Service>::Item {
   uint32_t id() const { return id_; }
 
  protected:
+  // Tag indicating that a service's methods are sorted by ID, which allows
+  // finding them with a binary search. Generated services sort their methods.
+  struct MethodsSortedById {};
+
   template <typename T, size_t kMethodCount>
   constexpr Service(uint32_t id, const std::array<T, kMethodCount>& methods)
+      : Service(id, methods, false) {}
+
+  template <typename T, size_t kMethodCount>
+  constexpr Service(uint32_t id,
+                    const std::array<T, kMethodCount>& methods,
+                    MethodsSortedById)
+      : Service(id, methods, true) {}
+
+  // For use by tests with only one method.
+  template <typename T>
+  constexpr Service(uint32_t id, const T& method)
+      : id_(id),
+        methods_(&method),
+        method_size_(sizeof(T)),
+        method_count_(1),
+        sorted_by_id_(true) {}
+
+ private:
+  friend class Server;
+  friend class ServiceTestHelper;
+
+  template <typename T, size_t kMethodCount>
+  constexpr Service(uint32_t id,
+                    const std::array<T, kMethodCount>& methods,
+                    bool sorted_by_id)
       : id_(id),
         methods_(methods.data()),
         method_size_(sizeof(T)),
-        method_count_(static_cast<uint16_t>(kMethodCount)) {
+        method_count_(static_cast<uint16_t>(kMethodCount)),
+        sorted_by_id_(sorted_by_id) {
     PW_MODIFY_DIAGNOSTICS_PUSH();
     // GCC 10 emits spurious -Wtype-limits warnings for the static_assert.
     PW_MODIFY_DIAGNOSTIC_GCC(ignored, "-Wtype-limits");
@@ -48,22 +78,21 @@ class Service : public IntrusiveList<Service>::Item {
     PW_MODIFY_DIAGNOSTICS_POP();
   }
 
-  // For use by tests with only one method.
-  template <typename T>
-  constexpr Service(uint32_t id, const T& method)
-      : id_(id), methods_(&method), method_size_(sizeof(T)), method_count_(1) {}
-
- private:
-  friend class Server;
-  friend class ServiceTestHelper;
-
   // Finds the method with the provided method_id. Returns nullptr if no match.
   const internal::Method* FindMethod(uint32_t method_id) const;
 
+  const internal::Method& method(size_t index) const {
+    const auto raw = reinterpret_cast<const std::byte*>(methods_);
+    return reinterpret_cast<const internal::MethodUnion*>(
+               raw + index * method_size_)
+        ->method();
+  }
+
   const uint32_t id_;
   const internal::MethodUnion* const methods_;
   const uint16_t method_size_;
   const uint16_t method_count_;
+  const bool sorted_by_id_;
 };
 
 }  // namespace pw::rpc
@@ -0,0 +1,141 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/service.h"
+#include "pw_status/status.h"
+
+namespace pw::rpc::internal {
+
+// Connects a Client and a Server in memory. Requests are queued and delivered
+// by DeliverRequests(), so the server never runs inside the client's send.
+// Responses are delivered to the client as soon as the server sends them.
+//
+// With Framing::kHdlc, every packet is HDLC encoded and decoded on its way
+// through, which includes the cost of framing in the measurements.
+class LoopbackTransport {
+ public:
+  static constexpr uint32_t kChannelId = 1;
+  static constexpr size_t kMaxPacketSizeBytes = 512;
+
+  enum class Framing { kNone, kHdlc };
+
+  LoopbackTransport();
+
+  LoopbackTransport(const LoopbackTransport&) = delete;
+  LoopbackTransport& operator=(const LoopbackTransport&) = delete;
+
+  Framing framing() const { return framing_; }
+  void set_framing(Framing framing) { framing_ = framing; }
+
+  // The client's channel to the server, on which calls are started.
+  rpc::Channel& channel() { return client_channels_[0]; }
+
+  rpc::Client& client() { return client_; }
+  rpc::Server& server() { return server_; }
+
+  // Delivers queued requests to the server until none remain. Returns the
+  // first error from sending or processing a packet.
+  Status DeliverRequests();
+
+ private:
+  class Output : public ChannelOutput {
+   public:
+    Output(const char* name, LoopbackTransport& transport, bool to_server)
+        : ChannelOutput(name), transport_(transport), to_server_(to_server) {}
+
+    ByteSpan AcquireBuffer() override { return buffer_; }
+
+    Status SendAndReleaseBuffer(ConstByteSpan packet) override {
+      if (packet.empty()) {
+        return OkStatus();
+      }
+      return transport_.Transfer(packet, to_server_);
+    }
+
+   private:
+    LoopbackTransport& transport_;
+    const bool to_server_;
+    std::array<std::byte, kMaxPacketSizeBytes> buffer_;
+  };
+
+  // Unframes a packet if needed, then passes it to the destination.
+  Status Transfer(ConstByteSpan packet, bool to_server);
+  Status Receive(ConstByteSpan packet, bool to_server);
+
+  Framing framing_;
+
+  Output client_output_;
+  Output server_output_;
+  std::array<rpc::Channel, 1> client_channels_;
+  std::array<rpc::Channel, 1> server_channels_;
+  rpc::Client client_;
+  rpc::Server server_;
+
+  // A request from the client that has not been delivered yet.
+  std::array<std::byte, kMaxPacketSizeBytes> pending_request_;
+  size_t pending_request_size_;
+  std::array<std::byte, kMaxPacketSizeBytes> delivered_request_;
+
+  // Every byte may be escaped, plus the flags, address, control, and FCS.
+  std::array<std::byte, 2 * kMaxPacketSizeBytes + 16> frame_;
+  hdlc::DecoderBuffer<kMaxPacketSizeBytes + 16> client_decoder_;
+  hdlc::DecoderBuffer<kMaxPacketSizeBytes + 16> server_decoder_;
+};
+
+// Starts calls to the benchmark service (pw_rpc/benchmark/benchmark.proto)
+// with a particular protobuf library and counts the responses.
+class LoopbackBenchmarkCalls {
+ public:
+  virtual ~LoopbackBenchmarkCalls() = default;
+
+  // Starts a UnaryEcho call with a payload of the given size.
+  virtual Status StartUnaryEcho(rpc::Channel& channel, size_t payload_size) = 0;
+
+  // Starts a ServerStream call for responses of the given size.
+  virtual Status StartServerStream(rpc::Channel& channel,
+                                   uint32_t responses,
+                                   size_t payload_size) = 0;
+
+  // The number of responses received for calls started since the last Reset.
+  virtual size_t responses() const = 0;
+
+  // The total response payload bytes received since the last Reset.
+  virtual size_t response_bytes() const = 0;
+
+  // True if the server stream started since the last Reset has finished.
+  virtual bool stream_finished() const = 0;
+
+  virtual void Reset() = 0;
+};
+
+// Measures unary round-trip latency and server stream throughput for several
+// payload sizes, with and without HDLC framing, and logs the results. The
+// service must implement the benchmark service. Returns an error if an RPC
+// fails.
+Status RunLoopbackBenchmarks(const char* name,
+                             Service& service,
+                             LoopbackBenchmarkCalls& calls);
+
+}  // namespace pw::rpc::internal
@@ -385,12 +385,30 @@ class Client:
         for service in self.services:
             yield from service.methods
 
+    def _process_batch(self, data: bytes, impl_args: tuple,
+                       impl_kwargs: dict) -> Status:
+        try:
+            batch = packets.split_batch(data)
+        except DecodeError as err:
+            _LOG.warning('Failed to decode packet batch: %s', err)
+            return Status.DATA_LOSS
+
+        result = Status.OK
+        for packet_data in batch:
+            status = self.process_packet(packet_data, *impl_args,
+                                         **impl_kwargs)
+            if result is Status.OK:
+                result = status
+
+        return result
+
     def process_packet(self, pw_rpc_raw_packet_data: bytes, *impl_args,
                        **impl_kwargs) -> Status:
         """Processes an incoming packet.
 
         Args:
-          pw_rpc_raw_packet_data: raw binary data for exactly one RPC packet
+          pw_rpc_raw_packet_data: raw binary data for one RPC packet or a batch
+              of packets
           impl_args: optional positional arguments passed to the ClientImpl
           impl_kwargs: optional keyword arguments passed to the ClientImpl
 
@@ -399,7 +417,14 @@ class Client:
           DATA_LOSS - the packet could not be decoded
           INVALID_ARGUMENT - the packet is for a server, not a client
           NOT_FOUND - the packet's channel ID is not known to this client
+
+          For a batch, every packet is processed and the first non-OK status
+          is returned.
         """
+        if packets.is_batch(pw_rpc_raw_packet_data):
+            return self._process_batch(pw_rpc_raw_packet_data, impl_args,
+                                       impl_kwargs)
+
         try:
             packet = packets.decode(pw_rpc_raw_packet_data)
         except DecodeError as err:
@@ -16,7 +16,7 @@
 import abc
 from datetime import datetime
 import os
-from typing import cast, Any, Callable, Iterable
+from typing import cast, Any, Callable, Iterable, List
 
 from pw_protobuf.output_file import OutputFile
 from pw_protobuf.proto_tree import ProtoNode, ProtoService, ProtoServiceMethod
@@ -107,7 +107,8 @@ def service_class(service: ProtoService, root: ProtoNode, output: OutputFile,
         output.write_line()
 
         output.write_line(f'constexpr {service.name()}()')
-        output.write_line(f'    : {base_class}(kServiceId, kMethods) {{}}')
+        output.write_line(f'    : {base_class}(kServiceId, kMethods, '
+                          'MethodsSortedById()) {}')
 
         output.write_line()
         output.write_line(
@@ -143,7 +144,7 @@ def service_class(service: ProtoService, root: ProtoNode, output: OutputFile,
                           f' {len(service.methods())}> kMethods = {{')
 
         with output.indent(4):
-            for method in service.methods():
+            for method in _methods_sorted_by_id(service):
                 method_descriptor(method, pw_rpc.ids.calculate(method.name()),
                                   output)
 
@@ -157,13 +158,24 @@ def service_class(service: ProtoService, root: ProtoNode, output: OutputFile,
     output.write_line('\n}  // namespace generated\n')
 
 
+def _methods_sorted_by_id(
+        service: ProtoService) -> List[ProtoServiceMethod]:
+    """Returns a service's methods in the order of the method table.
+
+    The table is sorted by method ID so that Service::FindMethod can binary
+    search it.
+    """
+    return sorted(service.methods(),
+                  key=lambda method: pw_rpc.ids.calculate(method.name()))
+
+
 def _method_lookup_table(service: ProtoService, output: OutputFile) -> None:
     """Generates array of method IDs for looking up methods at compile time."""
     output.write_line('static constexpr std::array<uint32_t, '
                       f'{len(service.methods())}> kMethodIds = {{')
 
     with output.indent(4):
-        for method in service.methods():
+        for method in _methods_sorted_by_id(service):
             method_id = pw_rpc.ids.calculate(method.name())
             output.write_line(
                 f'0x{method_id:08x},  // Hash of "{method.name()}"')
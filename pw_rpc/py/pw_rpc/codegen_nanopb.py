@@ -94,11 +94,18 @@ def _generate_code_for_client_method(method: ProtoServiceMethod,
         f'using {call_alias} = {RPC_NAMESPACE}::NanopbClientCall<')
     output.write_line(f'    {callback}>;')
     output.write_line()
+    server_streaming = (
+        method.type() == ProtoServiceMethod.Type.SERVER_STREAMING)
+
     output.write_line(f'static {call_alias} {method.name()}(')
     with output.indent(4):
         output.write_line(f'{RPC_NAMESPACE}::Channel& channel,')
         output.write_line(f'const {req}& request,')
-        output.write_line(f'{callback}& callback) {{')
+        if server_streaming:
+            output.write_line(f'{callback}& callback,')
+            output.write_line('uint32_t stream_credit = 0) {')
+        else:
+            output.write_line(f'{callback}& callback) {{')
 
     with output.indent():
         output.write_line(f'{call_alias} call(&channel,')
@@ -109,7 +116,10 @@ def _generate_code_for_client_method(method: ProtoServiceMethod,
             output.write_line('callback,')
             output.write_line(f'{req}_fields,')
             output.write_line(f'{res}_fields);')
-        output.write_line('call.SendRequest(&request);')
+        if server_streaming:
+            output.write_line('call.SendRequest(&request, stream_credit);')
+        else:
+            output.write_line('call.SendRequest(&request);')
         output.write_line('return call;')
 
     output.write_line('}')
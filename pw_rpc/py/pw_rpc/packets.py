@@ -13,11 +13,16 @@
 # the License.
 """Functions for working with pw_rpc packets."""
 
+from typing import List
+
 from google.protobuf import message
 from pw_status import Status
 
 from pw_rpc.internal import packet_pb2
 
+# Key of the length-delimited packets field (15) that starts an RpcPacketBatch.
+_BATCH_KEY = 15 << 3 | 2
+
 
 def decode(data: bytes):
     packet = packet_pb2.RpcPacket()
@@ -25,6 +30,18 @@ def decode(data: bytes):
     return packet
 
 
+def is_batch(data: bytes) -> bool:
+    """True if the data is an RpcPacketBatch rather than a single packet."""
+    return bool(data) and data[0] == _BATCH_KEY
+
+
+def split_batch(data: bytes) -> List[bytes]:
+    """Returns the encoded packets in an RpcPacketBatch."""
+    batch = packet_pb2.RpcPacketBatch()
+    batch.MergeFromString(data)
+    return list(batch.packets)
+
+
 def decode_payload(packet, payload_type):
     payload = payload_type()
     payload.MergeFromString(packet.payload)
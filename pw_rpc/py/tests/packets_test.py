@@ -18,7 +18,7 @@ import unittest
 
 from pw_status import Status
 
-from pw_rpc.internal.packet_pb2 import PacketType, RpcPacket
+from pw_rpc.internal.packet_pb2 import PacketType, RpcPacket, RpcPacketBatch
 from pw_rpc import packets
 
 _TEST_REQUEST = RpcPacket(type=PacketType.REQUEST,
@@ -92,6 +92,23 @@ class PacketsTest(unittest.TestCase):
                           method_id=3,
                           payload=RpcPacket(status=321).SerializeToString())))
 
+    def test_batch(self):
+        response = RpcPacket(type=PacketType.RESPONSE,
+                             channel_id=1,
+                             service_id=2,
+                             method_id=3).SerializeToString()
+        batch = RpcPacketBatch(
+            packets=[_TEST_REQUEST.SerializeToString(), response])
+
+        data = batch.SerializeToString()
+        self.assertTrue(packets.is_batch(data))
+        self.assertEqual(packets.split_batch(data),
+                         [_TEST_REQUEST.SerializeToString(), response])
+
+    def test_is_batch_single_packet(self):
+        self.assertFalse(packets.is_batch(_TEST_REQUEST.SerializeToString()))
+        self.assertFalse(packets.is_batch(b''))
+
 
 if __name__ == '__main__':
     unittest.main()
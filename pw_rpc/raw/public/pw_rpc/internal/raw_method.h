@@ -29,12 +29,20 @@ class RawServerWriter : public internal::BaseServerWriter {
 
   ~RawServerWriter();
 
-  // Returns a buffer in which a response payload can be built.
+  // Returns a buffer in which a response payload can be built. The buffer is
+  // the payload region of the channel's output buffer, so a payload built in it
+  // and passed to Write() is sent without being copied.
   ByteSpan PayloadBuffer() { return AcquirePayloadBuffer(); }
 
+  // Releases the buffer returned by PayloadBuffer() without sending it. Does
+  // nothing if no buffer is held.
+  void ReleaseBuffer();
+
   // Sends a response packet with the given raw payload. The payload can either
   // be in the buffer previously acquired from PayloadBuffer(), or an arbitrary
-  // external buffer.
+  // external buffer. An external payload too large for the channel's buffer
+  // is split across several packets if the channel allows it (see
+  // Channel::set_fragment_large_payloads); otherwise, OUT_OF_RANGE is returned.
   Status Write(ConstByteSpan response);
 };
 
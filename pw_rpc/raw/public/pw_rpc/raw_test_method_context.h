@@ -100,7 +100,8 @@ class MessageOutput final : public ChannelOutput {
       : ChannelOutput("internal::test::raw::MessageOutput"),
         responses_(responses),
         buffers_(buffers),
-        packet_buffer_(packet_buffer) {
+        packet_buffer_(packet_buffer),
+        buffer_held_(false) {
     clear();
   }
 
@@ -111,6 +112,9 @@ class MessageOutput final : public ChannelOutput {
 
   bool stream_ended() const { return stream_ended_; }
 
+  // True if the packet buffer was acquired and not yet sent or released.
+  bool buffer_held() const { return buffer_held_; }
+
   void clear() {
     responses_.clear();
     buffers_.clear();
@@ -120,7 +124,10 @@ class MessageOutput final : public ChannelOutput {
   }
 
  private:
-  ByteSpan AcquireBuffer() override { return packet_buffer_; }
+  ByteSpan AcquireBuffer() override {
+    buffer_held_ = true;
+    return packet_buffer_;
+  }
 
   Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override;
 
@@ -129,6 +136,7 @@ class MessageOutput final : public ChannelOutput {
   ByteSpan packet_buffer_;
   size_t total_responses_;
   bool stream_ended_;
+  bool buffer_held_;
   Status last_status_;
 };
 
@@ -241,6 +249,10 @@ class ServerStreamingContext {
   // True if the stream has terminated.
   bool done() const { return ctx_.output.stream_ended(); }
 
+  // True if a writer acquired the channel's buffer and has not yet sent or
+  // released it.
+  bool buffer_held() const { return ctx_.output.buffer_held(); }
+
   // The status of the stream. Only valid if done() is true.
   Status status() const {
     PW_ASSERT(done());
@@ -271,6 +283,7 @@ Status MessageOutput<kOutputSize>::SendAndReleaseBuffer(
     std::span<const std::byte> buffer) {
   PW_ASSERT(!stream_ended_);
   PW_ASSERT(buffer.data() == packet_buffer_.data());
+  buffer_held_ = false;
 
   if (buffer.empty()) {
     return OkStatus();
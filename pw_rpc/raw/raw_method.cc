@@ -18,6 +18,7 @@
 
 #include "pw_log/log.h"
 #include "pw_rpc/internal/packet.h"
+#include "pw_rpc/internal/server.h"
 
 namespace pw::rpc {
 
@@ -27,6 +28,12 @@ RawServerWriter::~RawServerWriter() {
   }
 }
 
+void RawServerWriter::ReleaseBuffer() {
+  if (open() && !buffer().empty()) {
+    ReleasePayloadBuffer();
+  }
+}
+
 Status RawServerWriter::Write(ConstByteSpan response) {
   if (!open()) {
     return Status::FailedPrecondition();
@@ -39,6 +46,10 @@ Status RawServerWriter::Write(ConstByteSpan response) {
   std::span<std::byte> buffer = AcquirePayloadBuffer();
 
   if (response.size() > buffer.size()) {
+    // The channel splits a response that does not fit in its buffer.
+    if (channel().fragment_large_payloads()) {
+      return ReleasePayloadBuffer(response);
+    }
     ReleasePayloadBuffer();
     return Status::OutOfRange();
   }
@@ -58,7 +69,9 @@ void RawMethod::CallUnary(ServerCall& call, const Packet& request) const {
 
   response.set_payload(payload_buffer.first(sws.size()));
   response.set_status(sws.status());
-  if (call.channel().Send(response_buffer, response).ok()) {
+  const Status send_status = call.channel().Send(response_buffer, response);
+  call.server().ResponseSent(response, sws.size(), send_status);
+  if (send_status.ok()) {
     return;
   }
 
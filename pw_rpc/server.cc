@@ -68,6 +68,14 @@ Server::~Server() {
 
 Status Server::ProcessPacket(std::span<const byte> data,
                              ChannelOutput& interface) {
+  return internal::ForEachPacket(
+      data, [this, &interface](ConstByteSpan packet) {
+        return ProcessSinglePacket(packet, interface);
+      });
+}
+
+Status Server::ProcessSinglePacket(std::span<const byte> data,
+                                   ChannelOutput& interface) {
   Packet packet;
   if (!DecodePacket(interface, data, packet)) {
     return Status::DataLoss();
@@ -97,11 +105,35 @@ Status Server::ProcessPacket(std::span<const byte> data,
     return OkStatus();
   }
 
+  if (Status status = reassembler_.Add(packet); !status.ok()) {
+    // Wait for the rest of a split payload. If it cannot be reassembled, the
+    // error is reported once, in response to its last packet.
+    if (!status.IsUnavailable() && !packet.continued()) {
+      PW_LOG_WARN("Failed to reassemble a split RPC request");
+      channel->Send(Packet::ServerError(packet, status));
+    }
+    return OkStatus();
+  }
+
   switch (packet.type()) {
     case PacketType::REQUEST: {
-      internal::ServerCall call(
-          static_cast<internal::Server&>(*this), *channel, *service, *method);
-      method->Invoke(call, packet);
+      internal::ServerCall call(static_cast<internal::Server&>(*this),
+                                *channel,
+                                *service,
+                                *method,
+                                packet.credit(),
+                                packet.call_id());
+
+      if (ServerInstrumentation* instrumentation = this->instrumentation();
+          instrumentation != nullptr) {
+        const int64_t received = instrumentation->RequestReceived(
+            packet.service_id(), packet.method_id(), packet.payload().size());
+        method->Invoke(call, packet);
+        instrumentation->MethodReturned(
+            packet.service_id(), packet.method_id(), received);
+      } else {
+        method->Invoke(call, packet);
+      }
       break;
     }
     case PacketType::CLIENT_STREAM_END:
@@ -113,6 +145,9 @@ Status Server::ProcessPacket(std::span<const byte> data,
     case PacketType::CANCEL_SERVER_STREAM:
       HandleCancelPacket(packet, *channel);
       break;
+    case PacketType::SERVER_STREAM_CREDIT:
+      HandleCreditPacket(packet, *channel);
+      break;
     default:
       channel->Send(Packet::ServerError(packet, Status::Unimplemented()));
       PW_LOG_WARN("Unable to handle packet of type %u",
@@ -135,15 +170,21 @@ std::tuple<Service*, const internal::Method*> Server::FindMethod(
   return {&(*service), service->FindMethod(packet.method_id())};
 }
 
-void Server::HandleCancelPacket(const Packet& packet,
-                                internal::Channel& channel) {
+internal::BaseServerWriter* Server::FindWriter(const Packet& packet) {
   auto writer = std::find_if(writers_.begin(), writers_.end(), [&](auto& w) {
     return w.channel_id() == packet.channel_id() &&
            w.service_id() == packet.service_id() &&
-           w.method_id() == packet.method_id();
+           w.method_id() == packet.method_id() &&
+           w.call_id() == packet.call_id();
   });
+  return writer == writers_.end() ? nullptr : &(*writer);
+}
+
+void Server::HandleCancelPacket(const Packet& packet,
+                                internal::Channel& channel) {
+  internal::BaseServerWriter* writer = FindWriter(packet);
 
-  if (writer == writers_.end()) {
+  if (writer == nullptr) {
     channel.Send(Packet::ServerError(packet, Status::FailedPrecondition()));
     PW_LOG_WARN("Received CANCEL packet for method that is not pending");
   } else {
@@ -155,24 +196,27 @@ void Server::HandleClientError(const Packet& packet) {
   // A client error indicates that the client received a packet that it did not
   // expect. If the packet belongs to a streaming RPC, cancel the stream without
   // sending a final SERVER_STREAM_END packet.
-  auto writer = std::find_if(writers_.begin(), writers_.end(), [&](auto& w) {
-    return w.channel_id() == packet.channel_id() &&
-           w.service_id() == packet.service_id() &&
-           w.method_id() == packet.method_id();
-  });
+  internal::BaseServerWriter* writer = FindWriter(packet);
 
-  if (writer != writers_.end()) {
+  if (writer != nullptr) {
     writer->Close();
   }
 }
 
-internal::Channel* Server::FindChannel(uint32_t id) const {
-  for (internal::Channel& c : channels_) {
-    if (c.id() == id) {
-      return &c;
-    }
+void Server::HandleCreditPacket(const Packet& packet,
+                                internal::Channel& channel) {
+  internal::BaseServerWriter* writer = FindWriter(packet);
+
+  if (writer == nullptr) {
+    channel.Send(Packet::ServerError(packet, Status::FailedPrecondition()));
+    PW_LOG_WARN("Received credit for a stream that is not pending");
+  } else {
+    writer->AddCredit(packet.credit());
   }
-  return nullptr;
+}
+
+internal::Channel* Server::FindChannel(uint32_t id) const {
+  return internal::Channel::Find(channels_, id);
 }
 
 internal::Channel* Server::AssignChannel(uint32_t id,
@@ -19,9 +19,12 @@
 
 #include "gtest/gtest.h"
 #include "pw_assert/check.h"
+#include "pw_rpc/batching_channel_output.h"
+#include "pw_rpc/internal/config.h"
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/packet.h"
 #include "pw_rpc/internal/test_method.h"
+#include "pw_rpc/server_instrumentation.h"
 #include "pw_rpc/service.h"
 #include "pw_rpc_private/internal_test_utils.h"
 
@@ -86,6 +89,22 @@ class BasicServer : public ::testing::Test {
     return result.value_or(ConstByteSpan());
   }
 
+  // Encodes part of kDefaultPayload as a fragment of a request to method 100.
+  std::span<const byte> EncodeFragment(size_t offset,
+                                       size_t size,
+                                       bool continued) {
+    Packet packet(PacketType::REQUEST,
+                  1,
+                  42,
+                  100,
+                  std::span(kDefaultPayload).subspan(offset, size));
+    packet.set_payload_offset(offset);
+    packet.set_continued(continued);
+    auto result = packet.Encode(request_buffer_);
+    EXPECT_EQ(OkStatus(), result.status());
+    return result.value_or(ConstByteSpan());
+  }
+
   TestOutput<128> output_;
   std::array<Channel, 3> channels_;
   Server server_;
@@ -109,6 +128,45 @@ TEST_F(BasicServer, ProcessPacket_ValidMethod_InvokesMethod) {
             0);
 }
 
+class CountingInstrumentation : public ServerInstrumentation {
+ public:
+  int64_t RequestReceived(uint32_t, uint32_t, size_t size) override {
+    requests += 1;
+    return static_cast<int64_t>(size);
+  }
+
+  void MethodReturned(uint32_t, uint32_t, int64_t request_received) override {
+    returned += 1;
+    last_request_received = request_received;
+  }
+
+  void ResponseSent(uint32_t, uint32_t, size_t, Status) override {}
+  void StreamFinished(uint32_t, uint32_t, Status) override {}
+
+  int requests = 0;
+  int returned = 0;
+  int64_t last_request_received = 0;
+};
+
+TEST_F(BasicServer, ProcessPacket_Instrumentation_ReportsRequest) {
+  CountingInstrumentation instrumentation;
+  server_.set_instrumentation(instrumentation);
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(
+                EncodeRequest(PacketType::REQUEST, 1, 42, 100), output_));
+
+  if constexpr (cfg::kServerInstrumentation) {
+    EXPECT_EQ(1, instrumentation.requests);
+    EXPECT_EQ(1, instrumentation.returned);
+    EXPECT_EQ(static_cast<int64_t>(sizeof(kDefaultPayload)),
+              instrumentation.last_request_received);
+  } else {
+    EXPECT_EQ(0, instrumentation.requests);
+    EXPECT_EQ(0, instrumentation.returned);
+  }
+}
+
 TEST_F(BasicServer, ProcessPacket_IncompletePacket_NothingIsInvoked) {
   EXPECT_EQ(Status::DataLoss(),
             server_.ProcessPacket(
@@ -210,6 +268,61 @@ TEST_F(BasicServer,
   EXPECT_EQ(packet.method_id(), 27u);
 }
 
+TEST_F(BasicServer, ProcessPacket_Batch_InvokesEachMethod) {
+  TestOutput<128> frame_output;
+  BatchingChannelOutput<32, 128> batching_output(frame_output);
+
+  for (uint32_t method_id : {100u, 200u}) {
+    std::span<byte> buffer = batching_output.AcquireBuffer();
+    auto result = Packet(PacketType::REQUEST, 1, 42, method_id, kDefaultPayload)
+                      .Encode(buffer);
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(OkStatus(), batching_output.SendAndReleaseBuffer(result.value()));
+  }
+  ASSERT_EQ(OkStatus(), batching_output.Flush());
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(frame_output.sent_data(), output_));
+
+  EXPECT_EQ(1u, service_.method(100).last_channel_id());
+  EXPECT_EQ(1u, service_.method(200).last_channel_id());
+}
+
+TEST_F(BasicServer, ProcessPacket_SplitRequest_InvokesMethodWithPayload) {
+  byte reassembly_buffer[16];
+  server_.set_reassembly_buffer(reassembly_buffer);
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(EncodeFragment(0, 3, true), output_));
+  EXPECT_EQ(0u, service_.method(100).last_channel_id());
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(EncodeFragment(3, 1, false), output_));
+
+  const TestMethod& method = service_.method(100);
+  EXPECT_EQ(1u, method.last_channel_id());
+  ASSERT_EQ(sizeof(kDefaultPayload), method.last_request().payload().size());
+  EXPECT_EQ(std::memcmp(kDefaultPayload,
+                        method.last_request().payload().data(),
+                        method.last_request().payload().size()),
+            0);
+}
+
+TEST_F(BasicServer, ProcessPacket_SplitRequestTooLarge_SendsError) {
+  byte reassembly_buffer[2];
+  server_.set_reassembly_buffer(reassembly_buffer);
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(EncodeFragment(0, 3, true), output_));
+  EXPECT_EQ(0u, output_.packet_count());
+
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(EncodeFragment(3, 1, false), output_));
+  EXPECT_EQ(0u, service_.method(100).last_channel_id());
+  EXPECT_EQ(output_.sent_packet().type(), PacketType::SERVER_ERROR);
+  EXPECT_EQ(output_.sent_packet().status(), Status::DataLoss());
+}
+
 TEST_F(BasicServer, ProcessPacket_Cancel_MethodNotActive_SendsError) {
   // Set up a fake ServerWriter representing an ongoing RPC.
   EXPECT_EQ(OkStatus(),
@@ -298,6 +411,37 @@ TEST_F(MethodPending, ProcessPacket_Cancel_IncorrectService) {
   EXPECT_TRUE(writer_.open());
 }
 
+TEST_F(BasicServer, ProcessPacket_Cancel_ClosesOnlyMatchingCall) {
+  internal::ServerCall first_call(static_cast<internal::Server&>(server_),
+                                  static_cast<internal::Channel&>(channels_[0]),
+                                  service_,
+                                  service_.method(100),
+                                  0,
+                                  /*call_id=*/1);
+  internal::ServerCall second_call(first_call.server(),
+                                   first_call.channel(),
+                                   service_,
+                                   service_.method(100),
+                                   0,
+                                   /*call_id=*/2);
+  internal::BaseServerWriter first(first_call);
+  internal::BaseServerWriter second(second_call);
+
+  Packet cancel(PacketType::CANCEL_SERVER_STREAM, 1, 42, 100);
+  cancel.set_call_id(2);
+  byte buffer[64];
+  EXPECT_EQ(OkStatus(),
+            server_.ProcessPacket(cancel.Encode(buffer).value(), output_));
+
+  EXPECT_TRUE(first.open());
+  EXPECT_FALSE(second.open());
+
+  const Packet& packet = output_.sent_packet();
+  EXPECT_EQ(packet.type(), PacketType::SERVER_STREAM_END);
+  EXPECT_EQ(packet.call_id(), 2u);
+  EXPECT_EQ(packet.status(), Status::Cancelled());
+}
+
 TEST_F(MethodPending, ProcessPacket_CancelIncorrectMethod) {
   EXPECT_EQ(OkStatus(),
             server_.ProcessPacket(
@@ -20,17 +20,30 @@
 namespace pw::rpc {
 
 const internal::Method* Service::FindMethod(uint32_t method_id) const {
-  const internal::MethodUnion* method_impl = methods_;
-
-  for (size_t i = 0; i < method_count_; ++i) {
-    const internal::Method* method = &method_impl->method();
-    if (method->id() == method_id) {
-      return method;
+  if (!sorted_by_id_) {
+    for (size_t i = 0; i < method_count_; ++i) {
+      if (method(i).id() == method_id) {
+        return &method(i);
+      }
     }
+    return nullptr;
+  }
+
+  size_t low = 0;
+  size_t high = method_count_;
 
-    const auto raw = reinterpret_cast<const std::byte*>(method_impl);
-    method_impl =
-        reinterpret_cast<const internal::MethodUnion*>(raw + method_size_);
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    const internal::Method& candidate = method(middle);
+
+    if (candidate.id() == method_id) {
+      return &candidate;
+    }
+    if (candidate.id() < method_id) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
   }
 
   return nullptr;
@@ -82,6 +82,38 @@ TEST(Service, MultipleMethods_FindMethod_NotPresent) {
   EXPECT_EQ(ServiceTestHelper::FindMethod(service, 999), nullptr);
 }
 
+class SortedTestService : public Service {
+ public:
+  constexpr SortedTestService()
+      : Service(0xabcd, kMethods, MethodsSortedById()) {}
+
+  static constexpr std::array<ServiceTestMethodUnion, 6> kMethods = {
+      ServiceTestMethod(100, 'a'),
+      ServiceTestMethod(200, 'b'),
+      ServiceTestMethod(300, 'c'),
+      ServiceTestMethod(400, 'd'),
+      ServiceTestMethod(500, 'e'),
+      ServiceTestMethod(0xffffffff, 'f'),
+  };
+};
+
+TEST(Service, SortedMethods_FindMethod_Present) {
+  SortedTestService service;
+  for (const ServiceTestMethodUnion& method : SortedTestService::kMethods) {
+    EXPECT_EQ(ServiceTestHelper::FindMethod(service, method.method().id()),
+              &method.method());
+  }
+}
+
+TEST(Service, SortedMethods_FindMethod_NotPresent) {
+  SortedTestService service;
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 0), nullptr);
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 150), nullptr);
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 450), nullptr);
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 501), nullptr);
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 0xfffffffe), nullptr);
+}
+
 class EmptyTestService : public Service {
  public:
   constexpr EmptyTestService() : Service(0xabcd, kMethods) {}
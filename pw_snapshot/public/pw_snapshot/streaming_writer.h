@@ -0,0 +1,112 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/streaming_encoder.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_thread/thread_info.h"
+
+namespace pw::metric {
+
+// Forward declared, since pw_metric/metric.h cannot be included alongside the
+// generated pw.metric protos, which snapshot.pwpb.h includes.
+class Group;
+
+}  // namespace pw::metric
+
+namespace pw::snapshot {
+
+// Writes a pw.snapshot.Snapshot proto directly to a pw::stream::Writer, such as
+// a BlobStore::BlobWriter or a PersistentBufferWriter, without building it in a
+// RAM buffer first.
+//
+// Each submessage's size is calculated before it is written, so the encoder
+// writes the submessage's key and length and then streams its fields straight
+// through; no scratch buffer is needed. Stack usage is a few small encoders per
+// call and does not depend on how much data is written, apart from
+// WriteMetrics(), which recurses once per level of nested metric groups.
+//
+//   pw::blob_store::BlobStore::BlobWriter blob_writer(snapshot_blob);
+//   PW_TRY(blob_writer.Open());
+//   pw::snapshot::SnapshotWriter snapshot(blob_writer);
+//
+//   pw::cpu_exception::DumpCpuStateProto(
+//       snapshot.encoder(),
+//       static_cast<uint32_t>(Snapshot::Fields::ARMV7M_CPU_STATE),
+//       cpu_state);
+//   pw::thread::ForEachThread([&](const pw::thread::ThreadInfo& thread) {
+//     snapshot.WriteThread(thread, SnapshotWriter::CapturedStack(thread, 512));
+//     return snapshot.status().ok();
+//   });
+//   snapshot.WriteMetrics(pw::metric::global_groups.front());
+//   PW_TRY(snapshot.status());
+//   PW_TRY(blob_writer.Close());
+//
+// As with StreamingEncoder, each Write function returns the writer's status,
+// and once a write fails all later writes are skipped.
+class SnapshotWriter {
+ public:
+  explicit constexpr SnapshotWriter(stream::Writer& writer)
+      : encoder_(writer, ByteSpan()) {}
+
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  // Returns the portion of a thread's stack to capture: up to max_bytes from
+  // the stack pointer towards the start of the stack, where the most recent
+  // frames are. Returns an empty span if the stack bounds are unknown.
+  //
+  // This reads the stack in place, so the thread must not be running while
+  // the snapshot is written.
+  static ConstByteSpan CapturedStack(const thread::ThreadInfo& thread,
+                                     size_t max_bytes);
+
+  // Writes a pw.thread.Thread to the threads field. raw_stack is streamed from
+  // where it is, e.g. the span returned by CapturedStack(). active marks the
+  // thread that was running when the snapshot was taken.
+  Status WriteThread(const thread::ThreadInfo& thread,
+                     ConstByteSpan raw_stack = {},
+                     bool active = false);
+
+  // Writes an already encoded pw.log.LogEntry to the logs field. Log buffers
+  // such as pw_multisink store entries encoded, so they can be copied into the
+  // snapshot entry by entry.
+  Status WriteLog(ConstByteSpan encoded_log_entry);
+
+  // Writes every metric in the group and its children, as pw.metric.Metric
+  // messages in the metrics field and pw.metric.Histogram messages in the
+  // histograms field. Sharded counters are written as int metrics. Groups
+  // nested more than kMaxMetricDepth deep are skipped and OUT_OF_RANGE is
+  // returned, but the rest of the metrics are still written.
+  static constexpr size_t kMaxMetricDepth = 8;
+  Status WriteMetrics(const metric::Group& group);
+
+  // The encoder for the snapshot, for writing other fields directly. Write
+  // submessages with GetNestedEncoder(field_number, size) to avoid staging them
+  // in RAM, since this encoder has no scratch buffer.
+  protobuf::StreamingEncoder& encoder() { return encoder_; }
+
+  // Returns the status of the first write that failed, or OK.
+  Status status() const { return encoder_.status(); }
+
+ private:
+  protobuf::StreamingEncoder encoder_;
+};
+
+}  // namespace pw::snapshot
@@ -0,0 +1,137 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_snapshot/streaming_writer.h"
+
+#include <algorithm>
+
+#include "pw_protobuf/serialized_size.h"
+#include "pw_snapshot_protos/snapshot.pwpb.h"
+#include "pw_thread_protos/thread.pwpb.h"
+
+namespace pw::snapshot {
+namespace {
+
+// Passes each field of a pw.thread.Thread to fields, which either adds up their
+// sizes or writes them, so the two cannot disagree.
+template <typename Fields>
+void VisitThreadFields(const thread::ThreadInfo& info,
+                       ConstByteSpan raw_stack,
+                       bool active,
+                       Fields& fields) {
+  using Field = thread::Thread::Fields;
+  if (info.thread_name().has_value()) {
+    fields.Bytes(Field::NAME, info.thread_name().value());
+  }
+  if (active) {
+    fields.Varint(Field::ACTIVE, 1);
+  }
+  if (!raw_stack.empty()) {
+    fields.Bytes(Field::RAW_STACK, raw_stack);
+  }
+  if (info.stack_size().has_value()) {
+    fields.Varint(Field::STACK_SIZE, info.stack_size().value());
+  }
+  if (info.stack_high_addr().has_value()) {
+    fields.Varint(Field::STACK_START_POINTER, info.stack_high_addr().value());
+  }
+  if (info.stack_pointer().has_value()) {
+    fields.Varint(Field::STACK_POINTER, info.stack_pointer().value());
+  }
+  if (info.cpu_usage_hundredths().has_value()) {
+    fields.Varint(Field::CPU_USAGE_HUNDREDTHS,
+                  info.cpu_usage_hundredths().value());
+  }
+  if (info.stack_low_addr().has_value()) {
+    fields.Varint(Field::STACK_END_POINTER, info.stack_low_addr().value());
+  }
+  if (info.stack_peak_addr().has_value()) {
+    fields.Varint(Field::STACK_POINTER_EST_PEAK,
+                  info.stack_peak_addr().value());
+  }
+  if (info.run_time().has_value()) {
+    fields.Varint(Field::RUN_TIME, info.run_time().value());
+  }
+}
+
+class SizeFields {
+ public:
+  void Varint(thread::Thread::Fields field, uint64_t value) {
+    size_ += protobuf::SizeOfVarintField(static_cast<uint32_t>(field), value);
+  }
+  void Bytes(thread::Thread::Fields field, ConstByteSpan value) {
+    size_ += protobuf::SizeOfDelimitedField(static_cast<uint32_t>(field),
+                                            value.size());
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  size_t size_ = 0;
+};
+
+class WriteFields {
+ public:
+  explicit WriteFields(protobuf::StreamingEncoder& encoder)
+      : encoder_(encoder) {}
+
+  void Varint(thread::Thread::Fields field, uint64_t value) {
+    encoder_.WriteUint64(static_cast<uint32_t>(field), value);
+  }
+  void Bytes(thread::Thread::Fields field, ConstByteSpan value) {
+    encoder_.WriteBytes(static_cast<uint32_t>(field), value);
+  }
+
+ private:
+  protobuf::StreamingEncoder& encoder_;
+};
+
+}  // namespace
+
+ConstByteSpan SnapshotWriter::CapturedStack(const thread::ThreadInfo& thread,
+                                            size_t max_bytes) {
+  if (!thread.stack_pointer().has_value() ||
+      !thread.stack_high_addr().has_value()) {
+    return ConstByteSpan();
+  }
+  const uintptr_t stack_pointer = thread.stack_pointer().value();
+  const uintptr_t stack_start = thread.stack_high_addr().value();
+  if (stack_pointer >= stack_start) {
+    return ConstByteSpan();
+  }
+  const size_t stack_used = stack_start - stack_pointer;
+  return ConstByteSpan(reinterpret_cast<const std::byte*>(stack_pointer),
+                       std::min(max_bytes, stack_used));
+}
+
+Status SnapshotWriter::WriteThread(const thread::ThreadInfo& thread,
+                                   ConstByteSpan raw_stack,
+                                   bool active) {
+  SizeFields size;
+  VisitThreadFields(thread, raw_stack, active, size);
+
+  protobuf::StreamingEncoder thread_encoder = encoder_.GetNestedEncoder(
+      static_cast<uint32_t>(Snapshot::Fields::THREADS), size.size());
+  WriteFields write(thread_encoder);
+  VisitThreadFields(thread, raw_stack, active, write);
+  thread_encoder.Finalize();
+  return status();
+}
+
+Status SnapshotWriter::WriteLog(ConstByteSpan encoded_log_entry) {
+  return encoder_.WriteBytes(static_cast<uint32_t>(Snapshot::Fields::LOGS),
+                             encoded_log_entry);
+}
+
+}  // namespace pw::snapshot
@@ -0,0 +1,143 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// pw_metric/metric.h and the generated pw.metric protos both declare
+// pw::metric::Metric, so this file cannot include the generated headers and
+// uses the field numbers directly.
+
+#include <array>
+#include <span>
+
+#include "pw_metric/metric.h"
+#include "pw_protobuf/serialized_size.h"
+#include "pw_snapshot/streaming_writer.h"
+#include "pw_status/try.h"
+
+namespace pw::snapshot {
+namespace {
+
+// Fields of pw.snapshot.Snapshot.
+constexpr uint32_t kSnapshotMetrics = 21;
+constexpr uint32_t kSnapshotHistograms = 22;
+
+// Fields of pw.metric.Metric.
+constexpr uint32_t kMetricTokenPath = 1;
+constexpr uint32_t kMetricAsFloat = 3;
+constexpr uint32_t kMetricAsInt = 4;
+
+// Fields of pw.metric.Histogram.
+constexpr uint32_t kHistogramTokenPath = 1;
+constexpr uint32_t kHistogramBucketCounts = 2;
+constexpr uint32_t kHistogramMax = 3;
+
+// Walks a metric group tree, writing each metric with its token path as a
+// known-size submessage. The path is kept in a fixed array, so the only stack
+// growth is one frame per level of group nesting.
+class MetricTreeWriter {
+ public:
+  explicit MetricTreeWriter(protobuf::StreamingEncoder& encoder)
+      : encoder_(encoder) {}
+
+  Status Walk(const metric::Group& group) {
+    if (depth_ == SnapshotWriter::kMaxMetricDepth) {
+      return Status::OutOfRange();
+    }
+    path_[depth_++] = group.name();
+
+    Status status;
+    for (const metric::Metric& m : group.metrics()) {
+      if (m.is_float()) {
+        WriteFloat(m.name(), m.as_float());
+      } else {
+        WriteInt(m.name(), m.as_int());
+      }
+    }
+    for (const metric::ShardedCounter& counter : group.sharded_counters()) {
+      WriteInt(counter.name(), counter.value());
+    }
+    for (const metric::Histogram& histogram : group.histograms()) {
+      Write(histogram);
+    }
+    for (const metric::Group& child : group.children()) {
+      status.Update(Walk(child));
+    }
+
+    depth_ -= 1;
+    return status;
+  }
+
+ private:
+  // The path to a metric with the given name in the current group.
+  std::span<const uint32_t> PathTo(metric::Token name) {
+    path_[depth_] = name;
+    return std::span(path_).first(depth_ + 1);
+  }
+
+  static size_t PathSize(std::span<const uint32_t> path) {
+    return protobuf::SizeOfDelimitedField(kMetricTokenPath,
+                                          path.size_bytes());
+  }
+
+  void WriteInt(metric::Token name, uint32_t value) {
+    const std::span<const uint32_t> path = PathTo(name);
+    protobuf::StreamingEncoder metric = encoder_.GetNestedEncoder(
+        kSnapshotMetrics,
+        PathSize(path) + protobuf::SizeOfVarintField(kMetricAsInt, value));
+    metric.WritePackedFixed32(kMetricTokenPath, path);
+    metric.WriteUint32(kMetricAsInt, value);
+  }
+
+  void WriteFloat(metric::Token name, float value) {
+    const std::span<const uint32_t> path = PathTo(name);
+    protobuf::StreamingEncoder metric = encoder_.GetNestedEncoder(
+        kSnapshotMetrics,
+        PathSize(path) + protobuf::SizeOfFixed32Field(kMetricAsFloat));
+    metric.WritePackedFixed32(kMetricTokenPath, path);
+    metric.WriteFloat(kMetricAsFloat, value);
+  }
+
+  // The bucket counts are written unpacked, which decoders accept for packed
+  // fields, since the counters are not stored contiguously.
+  void Write(const metric::Histogram& histogram) {
+    const std::span<const uint32_t> path = PathTo(histogram.name());
+    size_t size = PathSize(path) +
+                  protobuf::SizeOfVarintField(kHistogramMax, histogram.max());
+    for (size_t i = 0; i < histogram.bucket_count(); ++i) {
+      size += protobuf::SizeOfVarintField(kHistogramBucketCounts,
+                                          histogram.bucket(i));
+    }
+
+    protobuf::StreamingEncoder proto =
+        encoder_.GetNestedEncoder(kSnapshotHistograms, size);
+    proto.WritePackedFixed32(kHistogramTokenPath, path);
+    for (size_t i = 0; i < histogram.bucket_count(); ++i) {
+      proto.WriteUint32(kHistogramBucketCounts, histogram.bucket(i));
+    }
+    proto.WriteUint32(kHistogramMax, histogram.max());
+  }
+
+  protobuf::StreamingEncoder& encoder_;
+  std::array<uint32_t, SnapshotWriter::kMaxMetricDepth + 1> path_;
+  size_t depth_ = 0;
+};
+
+}  // namespace
+
+Status SnapshotWriter::WriteMetrics(const metric::Group& group) {
+  const Status walk_status = MetricTreeWriter(encoder_).Walk(group);
+  PW_TRY(status());
+  return walk_status;
+}
+
+}  // namespace pw::snapshot
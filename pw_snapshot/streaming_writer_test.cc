@@ -0,0 +1,194 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_snapshot/streaming_writer.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_metric/metric.h"
+#include "pw_protobuf/decoder.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_thread_protos/thread.pwpb.h"
+
+namespace pw::snapshot {
+namespace {
+
+// Fields of pw.snapshot.Snapshot. snapshot.pwpb.h cannot be included alongside
+// pw_metric/metric.h; see streaming_writer_metrics.cc.
+constexpr uint32_t kLogs = 1;
+constexpr uint32_t kThreads = 18;
+constexpr uint32_t kMetrics = 21;
+
+uint32_t Field(thread::Thread::Fields field) {
+  return static_cast<uint32_t>(field);
+}
+
+TEST(SnapshotWriter, WriteThread) {
+  std::array<std::byte, 64> stack;
+  for (size_t i = 0; i < stack.size(); ++i) {
+    stack[i] = std::byte(i);
+  }
+  const uintptr_t stack_low = reinterpret_cast<uintptr_t>(stack.data());
+  const uintptr_t stack_high = stack_low + stack.size();
+
+  thread::ThreadInfo info;
+  info.set_thread_name(std::as_bytes(std::span("idle", 4)));
+  info.set_stack_low_addr(stack_low);
+  info.set_stack_high_addr(stack_high);
+  info.set_stack_pointer(stack_high - 16);
+
+  std::array<std::byte, 128> buffer;
+  stream::MemoryWriter writer(buffer);
+  SnapshotWriter snapshot(writer);
+  const ConstByteSpan captured = SnapshotWriter::CapturedStack(info, 8);
+  ASSERT_EQ(captured.size(), 8u);
+  EXPECT_EQ(captured.data(), stack.data() + stack.size() - 16);
+  EXPECT_EQ(snapshot.WriteThread(info, captured, true), OkStatus());
+
+  protobuf::Decoder decoder(writer.WrittenData());
+  ASSERT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber(), kThreads);
+  protobuf::Decoder thread({});
+  ASSERT_EQ(decoder.ReadMessage(&thread), OkStatus());
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+
+  size_t fields = 0;
+  while (thread.Next().ok()) {
+    fields += 1;
+    if (thread.FieldNumber() == Field(thread::Thread::Fields::NAME)) {
+      std::string_view name;
+      ASSERT_EQ(thread.ReadString(&name), OkStatus());
+      EXPECT_EQ(name, "idle");
+    } else if (thread.FieldNumber() == Field(thread::Thread::Fields::ACTIVE)) {
+      bool active = false;
+      ASSERT_EQ(thread.ReadBool(&active), OkStatus());
+      EXPECT_TRUE(active);
+    } else if (thread.FieldNumber() ==
+               Field(thread::Thread::Fields::RAW_STACK)) {
+      ConstByteSpan raw_stack;
+      ASSERT_EQ(thread.ReadBytes(&raw_stack), OkStatus());
+      ASSERT_EQ(raw_stack.size(), 8u);
+      EXPECT_EQ(std::memcmp(raw_stack.data(), &stack[48], 8), 0);
+    } else if (thread.FieldNumber() ==
+               Field(thread::Thread::Fields::STACK_POINTER)) {
+      uint64_t stack_pointer = 0;
+      ASSERT_EQ(thread.ReadUint64(&stack_pointer), OkStatus());
+      EXPECT_EQ(stack_pointer, stack_high - 16);
+    } else if (thread.FieldNumber() ==
+               Field(thread::Thread::Fields::STACK_SIZE)) {
+      uint64_t size = 0;
+      ASSERT_EQ(thread.ReadUint64(&size), OkStatus());
+      EXPECT_EQ(size, stack.size());
+    }
+  }
+  // Name, active, raw stack, size, start, pointer, and end.
+  EXPECT_EQ(fields, 7u);
+}
+
+TEST(SnapshotWriter, CapturedStackUnknownBounds) {
+  thread::ThreadInfo info;
+  EXPECT_TRUE(SnapshotWriter::CapturedStack(info, 128).empty());
+  info.set_stack_pointer(0x2000);
+  EXPECT_TRUE(SnapshotWriter::CapturedStack(info, 128).empty());
+  info.set_stack_high_addr(0x2000);
+  EXPECT_TRUE(SnapshotWriter::CapturedStack(info, 128).empty());
+}
+
+TEST(SnapshotWriter, WriteLog) {
+  constexpr auto kLogEntry = bytes::Array<0x0a, 0x02, 0x12, 0x34>();
+  std::array<std::byte, 16> buffer;
+  stream::MemoryWriter writer(buffer);
+  SnapshotWriter snapshot(writer);
+  EXPECT_EQ(snapshot.WriteLog(kLogEntry), OkStatus());
+  EXPECT_EQ(snapshot.WriteLog(kLogEntry), OkStatus());
+
+  protobuf::Decoder decoder(writer.WrittenData());
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(decoder.Next(), OkStatus());
+    EXPECT_EQ(decoder.FieldNumber(), kLogs);
+    ConstByteSpan entry;
+    ASSERT_EQ(decoder.ReadBytes(&entry), OkStatus());
+    ASSERT_EQ(entry.size(), kLogEntry.size());
+    EXPECT_EQ(std::memcmp(entry.data(), kLogEntry.data(), entry.size()), 0);
+  }
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(SnapshotWriter, WriteMetrics) {
+  PW_METRIC_GROUP(parent, "parent");
+  PW_METRIC(parent, count, "count", 7u);
+  PW_METRIC_GROUP(child, "child");
+  PW_METRIC(child, ratio, "ratio", 0.5f);
+  parent.Add(child);
+
+  std::array<std::byte, 64> buffer;
+  stream::MemoryWriter writer(buffer);
+  SnapshotWriter snapshot(writer);
+  EXPECT_EQ(snapshot.WriteMetrics(parent), OkStatus());
+
+  protobuf::Decoder decoder(writer.WrittenData());
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(decoder.Next(), OkStatus());
+    ASSERT_EQ(decoder.FieldNumber(), kMetrics);
+    protobuf::Decoder metric({});
+    ASSERT_EQ(decoder.ReadMessage(&metric), OkStatus());
+
+    ASSERT_EQ(metric.Next(), OkStatus());
+    ASSERT_EQ(metric.FieldNumber(), 1u);
+    ConstByteSpan path;
+    ASSERT_EQ(metric.ReadBytes(&path), OkStatus());
+    uint32_t first_token;
+    std::memcpy(&first_token, path.data(), sizeof(first_token));
+    EXPECT_EQ(first_token, parent.name());
+
+    ASSERT_EQ(metric.Next(), OkStatus());
+    if (i == 0) {
+      // The parent's own metrics come before its children's.
+      EXPECT_EQ(path.size(), 2 * sizeof(uint32_t));
+      uint32_t value = 0;
+      ASSERT_EQ(metric.FieldNumber(), 4u);
+      ASSERT_EQ(metric.ReadUint32(&value), OkStatus());
+      EXPECT_EQ(value, 7u);
+    } else {
+      EXPECT_EQ(path.size(), 3 * sizeof(uint32_t));
+      float value = 0;
+      ASSERT_EQ(metric.FieldNumber(), 3u);
+      ASSERT_EQ(metric.ReadFloat(&value), OkStatus());
+      EXPECT_EQ(value, 0.5f);
+    }
+  }
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(SnapshotWriter, StopsAtFirstFailure) {
+  constexpr auto kLogEntry = bytes::Array<1, 2, 3, 4, 5, 6, 7, 8>();
+  std::array<std::byte, 12> buffer;
+  stream::MemoryWriter writer(buffer);
+  SnapshotWriter snapshot(writer);
+
+  EXPECT_EQ(snapshot.WriteLog(kLogEntry), OkStatus());
+  EXPECT_EQ(snapshot.WriteLog(kLogEntry), Status::ResourceExhausted());
+
+  thread::ThreadInfo info;
+  info.set_stack_pointer(0);
+  EXPECT_EQ(snapshot.WriteThread(info), Status::ResourceExhausted());
+  EXPECT_EQ(snapshot.status(), Status::ResourceExhausted());
+  EXPECT_EQ(writer.bytes_written(), 10u);
+}
+
+}  // namespace
+}  // namespace pw::snapshot
@@ -0,0 +1,86 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/buffered_stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "pw_status/try.h"
+
+namespace pw::stream {
+
+Status BufferedWriter::Flush() {
+  if (buffered_ == 0u) {
+    return OkStatus();
+  }
+  PW_TRY(writer_.Write(buffer_.first(buffered_)));
+  buffered_ = 0;
+  return OkStatus();
+}
+
+size_t BufferedWriter::ConservativeWriteLimit() const {
+  const size_t limit = writer_.ConservativeWriteLimit();
+  if (limit == std::numeric_limits<size_t>::max()) {
+    return limit;
+  }
+  return limit > buffered_ ? limit - buffered_ : 0;
+}
+
+Status BufferedWriter::DoWrite(ConstByteSpan data) {
+  if (data.size() > buffer_.size() - buffered_) {
+    PW_TRY(Flush());
+  }
+
+  if (data.size() >= buffer_.size()) {
+    return writer_.Write(data);
+  }
+
+  std::memcpy(buffer_.data() + buffered_, data.data(), data.size());
+  buffered_ += data.size();
+  return OkStatus();
+}
+
+size_t BufferedReader::ConservativeReadLimit() const {
+  const size_t limit = reader_.ConservativeReadLimit();
+  if (limit > std::numeric_limits<size_t>::max() - buffered_bytes()) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return limit + buffered_bytes();
+}
+
+StatusWithSize BufferedReader::DoRead(ByteSpan dest) {
+  if (buffered_bytes() == 0u) {
+    if (dest.size() >= buffer_.size()) {
+      Result<ByteSpan> result = reader_.Read(dest);
+      return result.ok() ? StatusWithSize(result.value().size())
+                         : StatusWithSize(result.status(), 0);
+    }
+
+    Result<ByteSpan> result = reader_.Read(buffer_);
+    if (!result.ok()) {
+      return StatusWithSize(result.status(), 0);
+    }
+    position_ = 0;
+    size_ = result.value().size();
+  }
+
+  const size_t bytes_to_read = std::min(dest.size(), buffered_bytes());
+  std::memcpy(dest.data(), buffer_.data() + position_, bytes_to_read);
+  position_ += bytes_to_read;
+  return StatusWithSize(bytes_to_read);
+}
+
+}  // namespace pw::stream
@@ -0,0 +1,185 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/buffered_stream.h"
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::stream {
+namespace {
+
+// Writes to a MemoryWriter and counts the writes.
+class CountingWriter : public Writer {
+ public:
+  int writes() const { return writes_; }
+  ConstByteSpan data() const { return memory_writer_.WrittenData(); }
+
+  size_t ConservativeWriteLimit() const override {
+    return memory_writer_.ConservativeWriteLimit();
+  }
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    writes_ += 1;
+    return memory_writer_.Write(data);
+  }
+
+  MemoryWriterBuffer<64> memory_writer_;
+  int writes_ = 0;
+};
+
+// Reads from a MemoryReader and counts the reads.
+class CountingReader : public Reader {
+ public:
+  CountingReader(ConstByteSpan data) : memory_reader_(data) {}
+
+  int reads() const { return reads_; }
+
+  size_t ConservativeReadLimit() const override {
+    return memory_reader_.ConservativeReadLimit();
+  }
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override {
+    reads_ += 1;
+    Result<ByteSpan> result = memory_reader_.Read(dest);
+    return result.ok() ? StatusWithSize(result.value().size())
+                       : StatusWithSize(result.status(), 0);
+  }
+
+  MemoryReader memory_reader_;
+  int reads_ = 0;
+};
+
+bool Equal(ConstByteSpan data, const char* expected) {
+  return data.size() == std::strlen(expected) &&
+         std::memcmp(data.data(), expected, data.size()) == 0;
+}
+
+TEST(BufferedWriter, SmallWritesAreBuffered) {
+  CountingWriter output;
+  BufferedWriterBuffer<8> writer(output);
+
+  for (char c : std::string_view("abcde")) {
+    ASSERT_EQ(OkStatus(), writer.Write(std::byte(c)));
+  }
+  EXPECT_EQ(output.writes(), 0);
+  EXPECT_EQ(writer.buffered_bytes(), 5u);
+
+  EXPECT_EQ(OkStatus(), writer.Flush());
+  EXPECT_EQ(output.writes(), 1);
+  EXPECT_EQ(writer.buffered_bytes(), 0u);
+  EXPECT_TRUE(Equal(output.data(), "abcde"));
+
+  EXPECT_EQ(OkStatus(), writer.Flush());
+  EXPECT_EQ(output.writes(), 1);
+}
+
+TEST(BufferedWriter, FlushesWhenFull) {
+  CountingWriter output;
+  BufferedWriterBuffer<4> writer(output);
+
+  ASSERT_EQ(OkStatus(), writer.Write("abc", 3));
+  ASSERT_EQ(OkStatus(), writer.Write("de", 2));
+  EXPECT_EQ(output.writes(), 1);
+  EXPECT_TRUE(Equal(output.data(), "abc"));
+
+  ASSERT_EQ(OkStatus(), writer.Flush());
+  EXPECT_TRUE(Equal(output.data(), "abcde"));
+}
+
+TEST(BufferedWriter, LargeWritesSkipBuffer) {
+  CountingWriter output;
+  BufferedWriterBuffer<4> writer(output);
+
+  ASSERT_EQ(OkStatus(), writer.Write("a", 1));
+  ASSERT_EQ(OkStatus(), writer.Write("bcdefgh", 7));
+  EXPECT_EQ(output.writes(), 2);
+  EXPECT_EQ(writer.buffered_bytes(), 0u);
+  EXPECT_TRUE(Equal(output.data(), "abcdefgh"));
+}
+
+TEST(BufferedWriter, ConservativeWriteLimit) {
+  CountingWriter output;
+  BufferedWriterBuffer<8> writer(output);
+  EXPECT_EQ(writer.ConservativeWriteLimit(), 64u);
+
+  ASSERT_EQ(OkStatus(), writer.Write("abc", 3));
+  EXPECT_EQ(writer.ConservativeWriteLimit(), 61u);
+}
+
+TEST(BufferedWriter, FlushFails_DataStaysBuffered) {
+  std::array<std::byte, 2> small;
+  MemoryWriter output(small);
+  BufferedWriterBuffer<8> writer(output);
+
+  ASSERT_EQ(OkStatus(), writer.Write("abc", 3));
+  EXPECT_EQ(Status::ResourceExhausted(), writer.Flush());
+  EXPECT_EQ(writer.buffered_bytes(), 3u);
+}
+
+TEST(BufferedReader, SmallReadsAreBuffered) {
+  constexpr char kData[] = "abcdefghij";
+  CountingReader input(std::as_bytes(std::span(kData, 10)));
+  BufferedReaderBuffer<8> reader(input);
+
+  char c;
+  for (size_t i = 0; i < 10; ++i) {
+    Result<ByteSpan> result = reader.Read(&c, 1);
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(result.value().size(), 1u);
+    EXPECT_EQ(c, kData[i]);
+  }
+  EXPECT_EQ(input.reads(), 2);
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(&c, 1).status());
+}
+
+TEST(BufferedReader, ReadReturnsBufferedDataFirst) {
+  constexpr char kData[] = "abcdefghij";
+  CountingReader input(std::as_bytes(std::span(kData, 10)));
+  BufferedReaderBuffer<4> reader(input);
+
+  std::array<std::byte, 8> dest;
+  ASSERT_EQ(OkStatus(), reader.Read(dest.data(), 1).status());
+  EXPECT_EQ(reader.buffered_bytes(), 3u);
+
+  Result<ByteSpan> result = reader.Read(dest);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_TRUE(Equal(result.value(), "bcd"));
+
+  // The buffer is empty, so a large read goes directly to the input.
+  result = reader.Read(dest);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_TRUE(Equal(result.value(), "efghij"));
+  EXPECT_EQ(input.reads(), 2);
+}
+
+TEST(BufferedReader, ConservativeReadLimit) {
+  constexpr char kData[] = "abcdefghij";
+  CountingReader input(std::as_bytes(std::span(kData, 10)));
+  BufferedReaderBuffer<4> reader(input);
+  EXPECT_EQ(reader.ConservativeReadLimit(), 10u);
+
+  char c;
+  ASSERT_EQ(OkStatus(), reader.Read(&c, 1).status());
+  EXPECT_EQ(reader.ConservativeReadLimit(), 9u);
+}
+
+}  // namespace
+}  // namespace pw::stream
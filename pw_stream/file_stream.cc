@@ -0,0 +1,196 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/file_stream.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace pw::stream {
+namespace {
+
+Status OpenError() {
+  return errno == ENOENT ? Status::NotFound() : Status::Internal();
+}
+
+int ToPosixWhence(Whence origin) {
+  switch (origin) {
+    case Whence::kCurrent:
+      return SEEK_CUR;
+    case Whence::kEnd:
+      return SEEK_END;
+    case Whence::kBeginning:
+    default:
+      return SEEK_SET;
+  }
+}
+
+Status SeekFile(int fd, ptrdiff_t offset, Whence origin) {
+  if (lseek(fd, offset, ToPosixWhence(origin)) < 0) {
+    return errno == EINVAL ? Status::OutOfRange() : Status::Internal();
+  }
+  return OkStatus();
+}
+
+size_t TellFile(int fd) {
+  const off_t position = lseek(fd, 0, SEEK_CUR);
+  return position < 0 ? 0 : static_cast<size_t>(position);
+}
+
+}  // namespace
+
+Status FileReader::Open(const char* path) {
+  Close();
+  fd_ = open(path, O_RDONLY);
+  return fd_ == kInvalidFd ? OpenError() : OkStatus();
+}
+
+void FileReader::Close() {
+  if (fd_ != kInvalidFd) {
+    close(fd_);
+    fd_ = kInvalidFd;
+  }
+}
+
+StatusWithSize FileReader::DoRead(ByteSpan dest) {
+  if (dest.empty()) {
+    return StatusWithSize(0);
+  }
+  const ssize_t bytes_read = read(fd_, dest.data(), dest.size_bytes());
+  if (bytes_read < 0) {
+    return StatusWithSize::Internal();
+  }
+  if (bytes_read == 0) {
+    return StatusWithSize::OutOfRange();
+  }
+  return StatusWithSize(bytes_read);
+}
+
+Status FileReader::DoSeek(ptrdiff_t offset, Whence origin) {
+  return SeekFile(fd_, offset, origin);
+}
+
+size_t FileReader::DoTell() const { return TellFile(fd_); }
+
+Status FileWriter::Open(const char* path) {
+  Close();
+  fd_ = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  return fd_ == kInvalidFd ? OpenError() : OkStatus();
+}
+
+void FileWriter::Close() {
+  if (fd_ != kInvalidFd) {
+    close(fd_);
+    fd_ = kInvalidFd;
+  }
+}
+
+Status FileWriter::DoWrite(ConstByteSpan data) {
+  while (!data.empty()) {
+    const ssize_t bytes_written = write(fd_, data.data(), data.size_bytes());
+    if (bytes_written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == ENOSPC ? Status::ResourceExhausted() : Status::Internal();
+    }
+    data = data.subspan(bytes_written);
+  }
+  return OkStatus();
+}
+
+Status FileWriter::DoSeek(ptrdiff_t offset, Whence origin) {
+  return SeekFile(fd_, offset, origin);
+}
+
+size_t FileWriter::DoTell() const { return TellFile(fd_); }
+
+Status MappedFileReader::Open(const char* path) {
+  Close();
+
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return OpenError();
+  }
+
+  struct stat file_info;
+  if (fstat(fd, &file_info) < 0) {
+    close(fd);
+    return Status::Internal();
+  }
+
+  // An empty file cannot be mapped, and has no data to map.
+  if (file_info.st_size > 0) {
+    void* mapped =
+        mmap(nullptr, file_info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      close(fd);
+      return Status::Internal();
+    }
+    data_ = ConstByteSpan(static_cast<const std::byte*>(mapped),
+                          file_info.st_size);
+  }
+
+  // The mapping remains valid after the file is closed.
+  close(fd);
+  position_ = 0;
+  return OkStatus();
+}
+
+void MappedFileReader::Close() {
+  if (!data_.empty()) {
+    munmap(const_cast<std::byte*>(data_.data()), data_.size());
+  }
+  data_ = ConstByteSpan();
+  position_ = 0;
+}
+
+ConstByteSpan MappedFileReader::ReadInPlace(size_t max_size) {
+  const ConstByteSpan data =
+      data_.subspan(position_, std::min(max_size, data_.size() - position_));
+  position_ += data.size();
+  return data;
+}
+
+StatusWithSize MappedFileReader::DoRead(ByteSpan dest) {
+  if (position_ == data_.size()) {
+    return StatusWithSize::OutOfRange();
+  }
+  const ConstByteSpan data = ReadInPlace(dest.size());
+  std::memcpy(dest.data(), data.data(), data.size());
+  return StatusWithSize(data.size());
+}
+
+Status MappedFileReader::DoSeek(ptrdiff_t offset, Whence origin) {
+  ptrdiff_t position = offset;
+  if (origin == Whence::kCurrent) {
+    position += position_;
+  } else if (origin == Whence::kEnd) {
+    position += data_.size();
+  }
+
+  if (position < 0 || static_cast<size_t>(position) > data_.size()) {
+    return Status::OutOfRange();
+  }
+  position_ = position;
+  return OkStatus();
+}
+
+}  // namespace pw::stream
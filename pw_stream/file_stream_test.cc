@@ -0,0 +1,149 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/file_stream.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace pw::stream {
+namespace {
+
+constexpr std::string_view kContents = "The quick brown fox";
+
+class FileStreamTest : public ::testing::Test {
+ protected:
+  FileStreamTest() : path_("/tmp/pw_stream_file_test_XXXXXX") {}
+
+  void SetUp() override {
+    const int fd = mkstemp(path_);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    FileWriter writer;
+    ASSERT_EQ(OkStatus(), writer.Open(path_));
+    ASSERT_EQ(OkStatus(), writer.Write(kContents.data(), kContents.size()));
+  }
+
+  void TearDown() override { unlink(path_); }
+
+  static bool Equal(ConstByteSpan data, std::string_view expected) {
+    return data.size() == expected.size() &&
+           std::memcmp(data.data(), expected.data(), data.size()) == 0;
+  }
+
+  char path_[32];
+};
+
+TEST_F(FileStreamTest, FileReader_ReadsFile) {
+  FileReader reader;
+  ASSERT_EQ(OkStatus(), reader.Open(path_));
+
+  std::array<std::byte, 64> buffer;
+  Result<ByteSpan> result = reader.Read(buffer);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_TRUE(Equal(result.value(), kContents));
+  EXPECT_EQ(reader.Tell(), kContents.size());
+
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(buffer).status());
+}
+
+TEST_F(FileStreamTest, FileReader_Seek) {
+  FileReader reader;
+  ASSERT_EQ(OkStatus(), reader.Open(path_));
+
+  std::array<std::byte, 5> buffer;
+  ASSERT_EQ(OkStatus(), reader.Seek(4));
+  EXPECT_TRUE(Equal(reader.Read(buffer).value(), "quick"));
+
+  ASSERT_EQ(OkStatus(), reader.Seek(1, Whence::kCurrent));
+  EXPECT_TRUE(Equal(reader.Read(buffer).value(), "brown"));
+
+  ASSERT_EQ(OkStatus(), reader.Seek(-3, Whence::kEnd));
+  EXPECT_TRUE(Equal(reader.Read(buffer).value(), "fox"));
+
+  EXPECT_EQ(Status::OutOfRange(), reader.Seek(-1));
+}
+
+TEST_F(FileStreamTest, FileReader_MissingFile) {
+  FileReader reader;
+  EXPECT_EQ(Status::NotFound(), reader.Open("/tmp/pw_stream_no_such_file"));
+  EXPECT_FALSE(reader.is_open());
+}
+
+TEST_F(FileStreamTest, FileWriter_Seek) {
+  {
+    FileWriter writer;
+    ASSERT_EQ(OkStatus(), writer.Open(path_));
+    ASSERT_EQ(OkStatus(), writer.Write(kContents.data(), kContents.size()));
+    ASSERT_EQ(OkStatus(), writer.Seek(4));
+    EXPECT_EQ(writer.Tell(), 4u);
+    ASSERT_EQ(OkStatus(), writer.Write("QUICK", 5));
+  }
+
+  MappedFileReader reader;
+  ASSERT_EQ(OkStatus(), reader.Open(path_));
+  EXPECT_TRUE(Equal(reader.data(), "The QUICK brown fox"));
+}
+
+TEST_F(FileStreamTest, MappedFileReader_ReadInPlace) {
+  MappedFileReader reader;
+  ASSERT_EQ(OkStatus(), reader.Open(path_));
+  EXPECT_TRUE(Equal(reader.data(), kContents));
+
+  EXPECT_TRUE(Equal(reader.ReadInPlace(3), "The"));
+  EXPECT_EQ(reader.ConservativeReadLimit(), kContents.size() - 3);
+
+  ASSERT_EQ(OkStatus(), reader.Seek(-3, Whence::kEnd));
+  const ConstByteSpan rest = reader.ReadInPlace(100);
+  EXPECT_TRUE(Equal(rest, "fox"));
+  EXPECT_EQ(rest.data(), reader.data().data() + kContents.size() - 3);
+  EXPECT_TRUE(reader.ReadInPlace(100).empty());
+}
+
+TEST_F(FileStreamTest, MappedFileReader_Read) {
+  MappedFileReader reader;
+  ASSERT_EQ(OkStatus(), reader.Open(path_));
+
+  std::array<std::byte, 10> buffer;
+  EXPECT_TRUE(Equal(reader.Read(buffer).value(), "The quick "));
+  EXPECT_TRUE(Equal(reader.Read(buffer).value(), "brown fox"));
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(buffer).status());
+
+  EXPECT_EQ(Status::OutOfRange(), reader.Seek(1, Whence::kEnd));
+  EXPECT_EQ(reader.Tell(), kContents.size());
+}
+
+TEST_F(FileStreamTest, MappedFileReader_EmptyFile) {
+  {
+    FileWriter writer;
+    ASSERT_EQ(OkStatus(), writer.Open(path_));
+  }
+
+  MappedFileReader reader;
+  ASSERT_EQ(OkStatus(), reader.Open(path_));
+  EXPECT_TRUE(reader.data().empty());
+
+  std::array<std::byte, 4> buffer;
+  EXPECT_EQ(Status::OutOfRange(), reader.Read(buffer).status());
+}
+
+}  // namespace
+}  // namespace pw::stream
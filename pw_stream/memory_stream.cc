@@ -36,6 +36,30 @@ Status MemoryWriter::DoWrite(ConstByteSpan data) {
   return OkStatus();
 }
 
+Status MemoryWriter::DoWritev(std::span<const ConstByteSpan> data) {
+  size_t total_size = 0;
+  for (ConstByteSpan buffer : data) {
+    total_size += buffer.size_bytes();
+  }
+
+  if (ConservativeWriteLimit() == 0 && total_size != 0u) {
+    return Status::OutOfRange();
+  }
+  if (ConservativeWriteLimit() < total_size) {
+    return Status::ResourceExhausted();
+  }
+
+  for (ConstByteSpan buffer : data) {
+    if (buffer.empty()) {
+      continue;  // Empty spans may have a null data pointer.
+    }
+    std::memmove(
+        dest_.data() + bytes_written_, buffer.data(), buffer.size_bytes());
+    bytes_written_ += buffer.size_bytes();
+  }
+  return OkStatus();
+}
+
 StatusWithSize MemoryReader::DoRead(ByteSpan dest) {
   if (source_.size_bytes() == bytes_read_) {
     return StatusWithSize::OutOfRange();
@@ -50,4 +74,19 @@ StatusWithSize MemoryReader::DoRead(ByteSpan dest) {
   return StatusWithSize(bytes_to_read);
 }
 
+Status MemoryReader::DoSeek(ptrdiff_t offset, Whence origin) {
+  ptrdiff_t position = offset;
+  if (origin == Whence::kCurrent) {
+    position += bytes_read_;
+  } else if (origin == Whence::kEnd) {
+    position += source_.size_bytes();
+  }
+
+  if (position < 0 || static_cast<size_t>(position) > source_.size_bytes()) {
+    return Status::OutOfRange();
+  }
+  bytes_read_ = position;
+  return OkStatus();
+}
+
 }  // namespace pw::stream
@@ -146,6 +146,55 @@ TEST(MemoryWriter, OverlappingBuffer) {
       kTestString.data());
 }
 
+TEST(MemoryWriter, VectoredWrite) {
+  constexpr std::string_view kFirst("vectored ");
+  constexpr std::string_view kSecond("write");
+  const std::array<ConstByteSpan, 3> buffers = {
+      std::as_bytes(std::span(kFirst)),
+      ConstByteSpan(),
+      std::as_bytes(std::span(kSecond))};
+
+  MemoryWriter memory_writer(memory_buffer);
+  EXPECT_EQ(memory_writer.Write(buffers), OkStatus());
+  EXPECT_EQ(memory_writer.bytes_written(), kFirst.size() + kSecond.size());
+  EXPECT_EQ(std::memcmp(memory_writer.data(), "vectored write", 14), 0);
+}
+
+TEST(MemoryWriter, VectoredWrite_DoesNotFit_NothingWritten) {
+  std::array<std::byte, 8> dest = {};
+  const std::array<std::byte, 5> data = {};
+  const std::array<ConstByteSpan, 2> buffers = {data, data};
+
+  MemoryWriter memory_writer(dest);
+  EXPECT_EQ(memory_writer.Write(buffers), Status::ResourceExhausted());
+  EXPECT_EQ(memory_writer.bytes_written(), 0u);
+
+  EXPECT_EQ(memory_writer.Write(std::span(buffers).first(1)), OkStatus());
+  EXPECT_EQ(memory_writer.bytes_written(), 5u);
+}
+
+TEST(MemoryReader, Seek) {
+  constexpr std::string_view kData("0123456789");
+  MemoryReader reader(std::as_bytes(std::span(kData)));
+  std::array<std::byte, 3> buffer;
+
+  ASSERT_EQ(reader.Seek(4), OkStatus());
+  ASSERT_EQ(reader.Read(buffer).status(), OkStatus());
+  EXPECT_EQ(buffer[0], std::byte{'4'});
+  EXPECT_EQ(reader.Tell(), 7u);
+
+  ASSERT_EQ(reader.Seek(-5, Whence::kCurrent), OkStatus());
+  EXPECT_EQ(reader.Tell(), 2u);
+
+  ASSERT_EQ(reader.Seek(-1, Whence::kEnd), OkStatus());
+  ASSERT_EQ(reader.Read(buffer).status(), OkStatus());
+  EXPECT_EQ(buffer[0], std::byte{'9'});
+
+  EXPECT_EQ(reader.Seek(-1), Status::OutOfRange());
+  EXPECT_EQ(reader.Seek(1, Whence::kEnd), Status::OutOfRange());
+  EXPECT_EQ(reader.Tell(), 10u);
+}
+
 #define TESTING_CHECK_FAILURES_IS_SUPPORTED 0
 #if TESTING_CHECK_FAILURES_IS_SUPPORTED
 
@@ -0,0 +1,199 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/pipe.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "pw_assert/assert.h"
+
+namespace pw::stream {
+namespace {
+
+// Waits on the notification until ready() returns true or the timeout passes.
+// Returns the final result of ready().
+template <typename Ready>
+bool WaitUntil(sync::TimedThreadNotification& notification,
+               chrono::SystemClock::duration timeout,
+               Ready ready) {
+  if (ready()) {
+    return true;
+  }
+  if (timeout <= kPipeNonBlocking) {
+    return false;
+  }
+
+  if (timeout == kPipeBlockForever) {
+    do {
+      notification.acquire();
+    } while (!ready());
+    return true;
+  }
+
+  const chrono::SystemClock::time_point deadline =
+      chrono::SystemClock::TimePointAfterAtLeast(timeout);
+  do {
+    if (!notification.try_acquire_until(deadline)) {
+      return ready();
+    }
+  } while (!ready());
+  return true;
+}
+
+}  // namespace
+
+Pipe::Pipe(ByteSpan buffer)
+    : buffer_(buffer),
+      read_position_(0),
+      write_position_(0),
+      closed_(false),
+      writer_(*this),
+      reader_(*this) {
+  PW_DASSERT(buffer.size() <= std::numeric_limits<size_t>::max() / 2);
+}
+
+size_t Pipe::ReadableBytes() const {
+  const size_t read = read_position_.load(std::memory_order_acquire);
+  const size_t write = write_position_.load(std::memory_order_acquire);
+  return write >= read ? write - read : write + 2 * capacity() - read;
+}
+
+Result<ByteSpan> PipeWriter::AcquireWrite() {
+  if (pipe_.closed_.load(std::memory_order_relaxed)) {
+    return Status::OutOfRange();
+  }
+  if (!WaitUntil(pipe_.writable_, timeout_, [this] {
+        return pipe_.WritableBytes() != 0u;
+      })) {
+    return Status::ResourceExhausted();
+  }
+
+  const size_t offset =
+      pipe_.Offset(pipe_.write_position_.load(std::memory_order_relaxed));
+  return pipe_.buffer_.subspan(
+      offset, std::min(pipe_.WritableBytes(), pipe_.capacity() - offset));
+}
+
+void PipeWriter::CommitWrite(size_t size) {
+  PW_DASSERT(size <= pipe_.WritableBytes());
+  const size_t write = pipe_.write_position_.load(std::memory_order_relaxed);
+  pipe_.write_position_.store(pipe_.Advance(write, size),
+                              std::memory_order_release);
+  pipe_.readable_.release();
+}
+
+void PipeWriter::Close() {
+  pipe_.closed_.store(true, std::memory_order_release);
+  pipe_.readable_.release();
+}
+
+size_t PipeWriter::ConservativeWriteLimit() const {
+  if (pipe_.closed_.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+  if (timeout_ == kPipeBlockForever) {
+    return std::numeric_limits<size_t>::max();
+  }
+  return pipe_.WritableBytes();
+}
+
+Status PipeWriter::DoWrite(ConstByteSpan data) {
+  if (pipe_.closed_.load(std::memory_order_relaxed)) {
+    return Status::OutOfRange();
+  }
+
+  // Unless blocking indefinitely, only write if all of the data fits.
+  if (timeout_ != kPipeBlockForever &&
+      (data.size() > pipe_.capacity() ||
+       !WaitUntil(pipe_.writable_, timeout_, [this, &data] {
+         return pipe_.WritableBytes() >= data.size();
+       }))) {
+    return Status::ResourceExhausted();
+  }
+
+  while (!data.empty()) {
+    const Result<ByteSpan> space = AcquireWrite();
+    if (!space.ok()) {
+      return space.status();
+    }
+    const size_t size = std::min(space.value().size(), data.size());
+    std::memcpy(space.value().data(), data.data(), size);
+    CommitWrite(size);
+    data = data.subspan(size);
+  }
+  return OkStatus();
+}
+
+Result<ConstByteSpan> PipeReader::PeekRead() {
+  WaitUntil(pipe_.readable_, timeout_, [this] {
+    return pipe_.ReadableBytes() != 0u ||
+           pipe_.closed_.load(std::memory_order_relaxed);
+  });
+
+  // Check whether the writer was closed before checking for data, so that data
+  // written before closing is always read.
+  const bool closed = pipe_.closed_.load(std::memory_order_acquire);
+  const size_t readable = pipe_.ReadableBytes();
+  if (readable == 0u) {
+    return closed ? Status::OutOfRange() : Status::ResourceExhausted();
+  }
+
+  const size_t offset =
+      pipe_.Offset(pipe_.read_position_.load(std::memory_order_relaxed));
+  return ConstByteSpan(pipe_.buffer_)
+      .subspan(offset, std::min(readable, pipe_.capacity() - offset));
+}
+
+void PipeReader::ConsumeRead(size_t size) {
+  PW_DASSERT(size <= pipe_.ReadableBytes());
+  const size_t read = pipe_.read_position_.load(std::memory_order_relaxed);
+  pipe_.read_position_.store(pipe_.Advance(read, size),
+                             std::memory_order_release);
+  pipe_.writable_.release();
+}
+
+size_t PipeReader::ConservativeReadLimit() const {
+  return pipe_.ReadableBytes();
+}
+
+StatusWithSize PipeReader::DoRead(ByteSpan dest) {
+  if (dest.empty()) {
+    return StatusWithSize(0);
+  }
+
+  Result<ConstByteSpan> data = PeekRead();
+  if (!data.ok()) {
+    return StatusWithSize(data.status(), 0);
+  }
+
+  // Copy the data that is available, which may wrap around the buffer, without
+  // waiting for more.
+  size_t bytes_read = 0;
+  while (true) {
+    const size_t size =
+        std::min(data.value().size(), dest.size() - bytes_read);
+    std::memcpy(&dest[bytes_read], data.value().data(), size);
+    ConsumeRead(size);
+    bytes_read += size;
+
+    if (bytes_read == dest.size() || pipe_.ReadableBytes() == 0u) {
+      return StatusWithSize(bytes_read);
+    }
+    data = PeekRead();
+  }
+}
+
+}  // namespace pw::stream
@@ -0,0 +1,203 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_stream/pipe.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+
+namespace pw::stream {
+namespace {
+
+// TODO(pwbug/291): Add real concurrency tests.
+
+constexpr auto kData = bytes::Array<1, 2, 3, 4, 5, 6, 7, 8, 9, 10>();
+
+class PipeTest : public ::testing::Test {
+ protected:
+  PipeTest() {
+    pipe_.writer().set_timeout(kPipeNonBlocking);
+    pipe_.reader().set_timeout(kPipeNonBlocking);
+  }
+
+  PipeBuffer<16> pipe_;
+  std::array<std::byte, 32> read_buffer_ = {};
+};
+
+TEST_F(PipeTest, WriteThenRead) {
+  ASSERT_EQ(OkStatus(), pipe_.writer().Write(kData));
+  EXPECT_EQ(pipe_.reader().ConservativeReadLimit(), kData.size());
+
+  Result<ByteSpan> result = pipe_.reader().Read(read_buffer_);
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_EQ(result.value().size(), kData.size());
+  EXPECT_EQ(std::memcmp(result.value().data(), kData.data(), kData.size()), 0);
+  EXPECT_EQ(pipe_.reader().ConservativeReadLimit(), 0u);
+}
+
+TEST_F(PipeTest, ReadLessThanAvailable) {
+  ASSERT_EQ(OkStatus(), pipe_.writer().Write(kData));
+
+  Result<ByteSpan> result =
+      pipe_.reader().Read(std::span(read_buffer_).first(4));
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(result.value().size(), 4u);
+  EXPECT_EQ(pipe_.reader().ConservativeReadLimit(), kData.size() - 4);
+
+  result = pipe_.reader().Read(read_buffer_);
+  ASSERT_EQ(OkStatus(), result.status());
+  ASSERT_EQ(result.value().size(), kData.size() - 4);
+  EXPECT_EQ(result.value()[0], std::byte{5});
+}
+
+TEST_F(PipeTest, NonBlocking_EmptyRead_ResourceExhausted) {
+  EXPECT_EQ(Status::ResourceExhausted(),
+            pipe_.reader().Read(read_buffer_).status());
+  EXPECT_EQ(Status::ResourceExhausted(), pipe_.reader().PeekRead().status());
+}
+
+TEST_F(PipeTest, NonBlocking_WriteDoesNotFit_NothingWritten) {
+  ASSERT_EQ(OkStatus(), pipe_.writer().Write(kData));
+  EXPECT_EQ(pipe_.writer().ConservativeWriteLimit(), 16u - kData.size());
+
+  EXPECT_EQ(Status::ResourceExhausted(), pipe_.writer().Write(kData));
+  EXPECT_EQ(pipe_.reader().ConservativeReadLimit(), kData.size());
+
+  // Data larger than the pipe never fits.
+  std::array<std::byte, 17> too_large = {};
+  pipe_.reader().ConsumeRead(kData.size());
+  EXPECT_EQ(Status::ResourceExhausted(), pipe_.writer().Write(too_large));
+}
+
+TEST_F(PipeTest, Timed_EmptyRead_TimesOut) {
+  pipe_.reader().set_timeout(std::chrono::milliseconds(1));
+  EXPECT_EQ(Status::ResourceExhausted(),
+            pipe_.reader().Read(read_buffer_).status());
+}
+
+TEST_F(PipeTest, Timed_FullWrite_TimesOut) {
+  pipe_.writer().set_timeout(std::chrono::milliseconds(1));
+  ASSERT_EQ(OkStatus(), pipe_.writer().Write(kData));
+  EXPECT_EQ(Status::ResourceExhausted(), pipe_.writer().Write(kData));
+}
+
+TEST_F(PipeTest, Blocking_DataAvailable_DoesNotWait) {
+  pipe_.writer().set_timeout(kPipeBlockForever);
+  pipe_.reader().set_timeout(kPipeBlockForever);
+  EXPECT_EQ(pipe_.writer().ConservativeWriteLimit(),
+            std::numeric_limits<size_t>::max());
+
+  ASSERT_EQ(OkStatus(), pipe_.writer().Write(kData));
+  Result<ByteSpan> result = pipe_.reader().Read(read_buffer_);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(result.value().size(), kData.size());
+}
+
+TEST_F(PipeTest, WrapsAround) {
+  uint8_t next_write = 0;
+  uint8_t next_read = 0;
+
+  for (int cycle = 0; cycle < 50; ++cycle) {
+    std::array<std::byte, 7> chunk;
+    for (std::byte& b : chunk) {
+      b = std::byte{next_write++};
+    }
+    ASSERT_EQ(OkStatus(), pipe_.writer().Write(chunk));
+
+    // A read returns all of the data, even when it wraps around the buffer.
+    Result<ByteSpan> result = pipe_.reader().Read(read_buffer_);
+    ASSERT_EQ(OkStatus(), result.status());
+    ASSERT_EQ(result.value().size(), chunk.size());
+    for (std::byte b : result.value()) {
+      ASSERT_EQ(b, std::byte{next_read++});
+    }
+  }
+}
+
+TEST_F(PipeTest, ZeroCopy_SpansStopAtEndOfBuffer) {
+  Result<ByteSpan> space = pipe_.writer().AcquireWrite();
+  ASSERT_EQ(OkStatus(), space.status());
+  ASSERT_EQ(space.value().size(), 16u);
+  std::memcpy(space.value().data(), kData.data(), kData.size());
+  pipe_.writer().CommitWrite(kData.size());
+
+  Result<ConstByteSpan> data = pipe_.reader().PeekRead();
+  ASSERT_EQ(OkStatus(), data.status());
+  ASSERT_EQ(data.value().size(), kData.size());
+  EXPECT_EQ(data.value().data(), space.value().data());
+  pipe_.reader().ConsumeRead(8);
+
+  // The free space wraps around, so only the end of the buffer is returned.
+  space = pipe_.writer().AcquireWrite();
+  ASSERT_EQ(OkStatus(), space.status());
+  EXPECT_EQ(space.value().size(), 16u - kData.size());
+  pipe_.writer().CommitWrite(space.value().size());
+
+  space = pipe_.writer().AcquireWrite();
+  ASSERT_EQ(OkStatus(), space.status());
+  EXPECT_EQ(space.value().size(), 8u);
+  pipe_.writer().CommitWrite(8);
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            pipe_.writer().AcquireWrite().status());
+
+  data = pipe_.reader().PeekRead();
+  ASSERT_EQ(OkStatus(), data.status());
+  EXPECT_EQ(data.value().size(), 8u);  // Up to the end of the buffer.
+  pipe_.reader().ConsumeRead(8);
+
+  data = pipe_.reader().PeekRead();
+  ASSERT_EQ(OkStatus(), data.status());
+  EXPECT_EQ(data.value().size(), 8u);
+}
+
+TEST_F(PipeTest, ZeroCopy_PartialConsume) {
+  ASSERT_EQ(OkStatus(), pipe_.writer().Write(kData));
+
+  Result<ConstByteSpan> data = pipe_.reader().PeekRead();
+  ASSERT_EQ(OkStatus(), data.status());
+  pipe_.reader().ConsumeRead(3);
+
+  data = pipe_.reader().PeekRead();
+  ASSERT_EQ(OkStatus(), data.status());
+  ASSERT_EQ(data.value().size(), kData.size() - 3);
+  EXPECT_EQ(data.value()[0], std::byte{4});
+}
+
+TEST_F(PipeTest, Close_ReaderDrainsThenOutOfRange) {
+  ASSERT_EQ(OkStatus(), pipe_.writer().Write(kData));
+  pipe_.writer().Close();
+
+  EXPECT_EQ(Status::OutOfRange(), pipe_.writer().Write(kData));
+  EXPECT_EQ(Status::OutOfRange(), pipe_.writer().AcquireWrite().status());
+  EXPECT_EQ(pipe_.writer().ConservativeWriteLimit(), 0u);
+
+  Result<ByteSpan> result = pipe_.reader().Read(read_buffer_);
+  ASSERT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(result.value().size(), kData.size());
+
+  // A blocking reader does not wait once the writer is closed.
+  pipe_.reader().set_timeout(kPipeBlockForever);
+  EXPECT_EQ(Status::OutOfRange(), pipe_.reader().Read(read_buffer_).status());
+  EXPECT_EQ(Status::OutOfRange(), pipe_.reader().PeekRead().status());
+}
+
+}  // namespace
+}  // namespace pw::stream
@@ -0,0 +1,103 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::stream {
+
+// Collects small writes in a buffer and writes them to another Writer in bulk,
+// so writers that are slow per call, such as sockets or UARTs, are not written
+// a byte at a time.
+//
+// Data is only written to the underlying writer when the buffer fills or
+// Flush() is called. It is NOT flushed when the BufferedWriter is destroyed.
+// Writes at least as large as the buffer skip it, after the buffered data is
+// flushed.
+class BufferedWriter : public Writer {
+ public:
+  constexpr BufferedWriter(Writer& writer, ByteSpan buffer)
+      : writer_(writer), buffer_(buffer), buffered_(0) {}
+
+  // Writes the buffered data to the underlying writer. If that fails, the data
+  // stays buffered.
+  Status Flush();
+
+  // Number of bytes waiting to be flushed.
+  size_t buffered_bytes() const { return buffered_; }
+
+  // The underlying writer's limit, less the data that is already buffered.
+  size_t ConservativeWriteLimit() const override;
+
+ private:
+  Status DoWrite(ConstByteSpan data) override;
+
+  Writer& writer_;
+  const ByteSpan buffer_;
+  size_t buffered_;
+};
+
+// BufferedWriter with its own buffer.
+template <size_t kBufferSize>
+class BufferedWriterBuffer final : public BufferedWriter {
+ public:
+  constexpr BufferedWriterBuffer(Writer& writer)
+      : BufferedWriter(writer, buffer_) {}
+
+ private:
+  std::array<std::byte, kBufferSize> buffer_;
+};
+
+// Reads from another Reader in buffer-sized chunks and serves small reads from
+// the buffer, so readers that are slow per call are not read a byte at a time.
+// Reads at least as large as the buffer go directly to the underlying reader
+// once the buffered data has been read.
+class BufferedReader : public Reader {
+ public:
+  constexpr BufferedReader(Reader& reader, ByteSpan buffer)
+      : reader_(reader), buffer_(buffer), position_(0), size_(0) {}
+
+  // Number of bytes read from the underlying reader but not yet returned.
+  size_t buffered_bytes() const { return size_ - position_; }
+
+  // The buffered data plus the underlying reader's limit.
+  size_t ConservativeReadLimit() const override;
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override;
+
+  Reader& reader_;
+  const ByteSpan buffer_;
+  size_t position_;
+  size_t size_;
+};
+
+// BufferedReader with its own buffer.
+template <size_t kBufferSize>
+class BufferedReaderBuffer final : public BufferedReader {
+ public:
+  constexpr BufferedReaderBuffer(Reader& reader)
+      : BufferedReader(reader, buffer_) {}
+
+ private:
+  std::array<std::byte, kBufferSize> buffer_;
+};
+
+}  // namespace pw::stream
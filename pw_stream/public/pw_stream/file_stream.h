@@ -0,0 +1,116 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_bytes/span.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+
+namespace pw::stream {
+
+// Streams for reading and writing files on POSIX hosts, for host tools.
+
+// Reads a file with read().
+class FileReader final : public SeekableReader {
+ public:
+  FileReader() = default;
+  ~FileReader() { Close(); }
+
+  FileReader(const FileReader&) = delete;
+  FileReader& operator=(const FileReader&) = delete;
+
+  // Opens the file for reading. Returns NOT_FOUND if it does not exist.
+  Status Open(const char* path);
+
+  void Close();
+
+  bool is_open() const { return fd_ != kInvalidFd; }
+
+ private:
+  static constexpr int kInvalidFd = -1;
+
+  StatusWithSize DoRead(ByteSpan dest) override;
+  Status DoSeek(ptrdiff_t offset, Whence origin) override;
+  size_t DoTell() const override;
+
+  int fd_ = kInvalidFd;
+};
+
+// Writes a file with write().
+class FileWriter final : public SeekableWriter {
+ public:
+  FileWriter() = default;
+  ~FileWriter() { Close(); }
+
+  FileWriter(const FileWriter&) = delete;
+  FileWriter& operator=(const FileWriter&) = delete;
+
+  // Creates the file, or truncates it if it exists, and opens it for writing.
+  Status Open(const char* path);
+
+  void Close();
+
+  bool is_open() const { return fd_ != kInvalidFd; }
+
+ private:
+  static constexpr int kInvalidFd = -1;
+
+  Status DoWrite(ConstByteSpan data) override;
+  Status DoSeek(ptrdiff_t offset, Whence origin) override;
+  size_t DoTell() const override;
+
+  int fd_ = kInvalidFd;
+};
+
+// Reads a file by mapping it into memory with mmap(). Besides copying with
+// Read(), data() and ReadInPlace() give direct access to the file's contents,
+// so large files can be processed without copying them.
+class MappedFileReader final : public SeekableReader {
+ public:
+  MappedFileReader() = default;
+  ~MappedFileReader() { Close(); }
+
+  MappedFileReader(const MappedFileReader&) = delete;
+  MappedFileReader& operator=(const MappedFileReader&) = delete;
+
+  // Maps the file into memory. Returns NOT_FOUND if it does not exist.
+  Status Open(const char* path);
+
+  void Close();
+
+  // The file's contents, which stay valid until the reader is closed.
+  ConstByteSpan data() const { return data_; }
+
+  // Returns up to max_size bytes from the current position without copying
+  // them, and moves the position past them. Returns an empty span at the end
+  // of the file.
+  ConstByteSpan ReadInPlace(size_t max_size);
+
+  size_t ConservativeReadLimit() const override {
+    return data_.size() - position_;
+  }
+
+ private:
+  StatusWithSize DoRead(ByteSpan dest) override;
+  Status DoSeek(ptrdiff_t offset, Whence origin) override;
+  size_t DoTell() const override { return position_; }
+
+  ConstByteSpan data_;
+  size_t position_ = 0;
+};
+
+}  // namespace pw::stream
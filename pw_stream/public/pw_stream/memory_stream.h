@@ -45,6 +45,9 @@ class MemoryWriter : public Writer {
   // perform a partial write and Status::ResourceExhausted() will be returned.
   Status DoWrite(ConstByteSpan data) override;
 
+  // Writes all of the buffers, or none of them if they do not fit.
+  Status DoWritev(std::span<const ConstByteSpan> data) override;
+
   ByteSpan dest_;
   size_t bytes_written_ = 0;
 };
@@ -58,7 +61,7 @@ class MemoryWriterBuffer final : public MemoryWriter {
   std::array<std::byte, kSizeBytes> buffer_;
 };
 
-class MemoryReader final : public Reader {
+class MemoryReader final : public SeekableReader {
  public:
   constexpr MemoryReader(ConstByteSpan source)
       : source_(source), bytes_read_(0) {}
@@ -78,6 +81,10 @@ class MemoryReader final : public Reader {
   // requested, this will perform a partial read and OK will still be returned.
   StatusWithSize DoRead(ByteSpan dest) override;
 
+  Status DoSeek(ptrdiff_t offset, Whence origin) override;
+
+  size_t DoTell() const override { return bytes_read_; }
+
   ConstByteSpan source_;
   size_t bytes_read_;
 };
@@ -0,0 +1,215 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_result/result.h"
+#include "pw_status/status.h"
+#include "pw_status/status_with_size.h"
+#include "pw_stream/stream.h"
+#include "pw_sync/timed_thread_notification.h"
+
+namespace pw::stream {
+
+class Pipe;
+
+// Timeouts for the ends of a Pipe. A PipeWriter or PipeReader with the
+// kPipeNonBlocking timeout never waits, and one with kPipeBlockForever waits
+// until it can make progress.
+inline constexpr chrono::SystemClock::duration kPipeNonBlocking =
+    chrono::SystemClock::duration::zero();
+inline constexpr chrono::SystemClock::duration kPipeBlockForever =
+    chrono::SystemClock::duration::max();
+
+// The writing end of a Pipe.
+//
+// With kPipeBlockForever, the default, Write() waits for space as needed and
+// writes data larger than the pipe in several parts. With a finite timeout or
+// kPipeNonBlocking, Write() waits up to the timeout for enough space for all of
+// the data, and otherwise writes nothing and returns RESOURCE_EXHAUSTED.
+class PipeWriter final : public Writer {
+ public:
+  PipeWriter(const PipeWriter&) = delete;
+  PipeWriter& operator=(const PipeWriter&) = delete;
+
+  void set_timeout(chrono::SystemClock::duration timeout) {
+    timeout_ = timeout;
+  }
+
+  // Returns contiguous free space in the pipe to write into directly, waiting
+  // up to the timeout for some to become available. The span may be smaller
+  // than the free space when it wraps around the end of the buffer. The data is
+  // not passed to the reader until CommitWrite() is called.
+  //
+  // Returns:
+  //
+  // OK - the span of free space, which is not empty.
+  // RESOURCE_EXHAUSTED - the pipe stayed full until the timeout.
+  // OUT_OF_RANGE - the writer was closed.
+  Result<ByteSpan> AcquireWrite();
+
+  // Passes the first size bytes of the span from AcquireWrite() to the reader.
+  void CommitWrite(size_t size);
+
+  // Closes the writer. The reader reads the remaining data, after which its
+  // reads return OUT_OF_RANGE.
+  void Close();
+
+  // Returns the free space in the pipe, or the largest size_t if the writer
+  // blocks until all data is written.
+  size_t ConservativeWriteLimit() const override;
+
+ private:
+  friend class Pipe;
+
+  constexpr explicit PipeWriter(Pipe& pipe)
+      : pipe_(pipe), timeout_(kPipeBlockForever) {}
+
+  Status DoWrite(ConstByteSpan data) override;
+
+  Pipe& pipe_;
+  chrono::SystemClock::duration timeout_;
+};
+
+// The reading end of a Pipe.
+//
+// Read() waits up to the timeout for data, and returns as much of it as fits,
+// without waiting to fill the destination.
+class PipeReader final : public Reader {
+ public:
+  PipeReader(const PipeReader&) = delete;
+  PipeReader& operator=(const PipeReader&) = delete;
+
+  void set_timeout(chrono::SystemClock::duration timeout) {
+    timeout_ = timeout;
+  }
+
+  // Returns contiguous data in the pipe to read directly, waiting up to the
+  // timeout for some to become available. The span may hold less than all of
+  // the data when it wraps around the end of the buffer. The data stays in the
+  // pipe until ConsumeRead() is called.
+  //
+  // Returns:
+  //
+  // OK - the span of data, which is not empty.
+  // RESOURCE_EXHAUSTED - the pipe stayed empty until the timeout.
+  // OUT_OF_RANGE - the writer was closed and all data was read.
+  Result<ConstByteSpan> PeekRead();
+
+  // Removes the first size bytes of the span from PeekRead() from the pipe.
+  void ConsumeRead(size_t size);
+
+  // Returns the number of bytes in the pipe.
+  size_t ConservativeReadLimit() const override;
+
+ private:
+  friend class Pipe;
+
+  constexpr explicit PipeReader(Pipe& pipe)
+      : pipe_(pipe), timeout_(kPipeBlockForever) {}
+
+  StatusWithSize DoRead(ByteSpan dest) override;
+
+  Pipe& pipe_;
+  chrono::SystemClock::duration timeout_;
+};
+
+// A Pipe connects a thread writing to a Writer with a thread reading from a
+// Reader through a ring buffer, for example an HDLC encoder with a thread that
+// sends the encoded data:
+//
+//   pw::stream::PipeBuffer<512> tx_pipe;
+//
+//   // Encoding thread
+//   pw::hdlc::WriteUIFrame(address, packet, tx_pipe.writer());
+//
+//   // TX thread
+//   while (true) {
+//     pw::Result<pw::ConstByteSpan> data = tx_pipe.reader().PeekRead();
+//     if (!data.ok()) {
+//       break;
+//     }
+//     uart.Send(data.value());
+//     tx_pipe.reader().ConsumeRead(data.value().size());
+//   }
+//
+// Besides Write() and Read(), which copy data in and out of the pipe, data can
+// be written and read in place with AcquireWrite() and CommitWrite(), and
+// PeekRead() and ConsumeRead(). Each end can block, block with a timeout, or
+// not block at all; see set_timeout().
+//
+// IMPORTANT: The pipe only supports ONE writing thread and ONE reading thread.
+// The ends do not take locks; the positions in the ring buffer are atomics and
+// a TimedThreadNotification wakes each end when the other makes progress.
+class Pipe {
+ public:
+  explicit Pipe(ByteSpan buffer);
+
+  Pipe(const Pipe&) = delete;
+  Pipe& operator=(const Pipe&) = delete;
+
+  PipeWriter& writer() { return writer_; }
+  PipeReader& reader() { return reader_; }
+
+  size_t capacity() const { return buffer_.size(); }
+
+ private:
+  friend class PipeWriter;
+  friend class PipeReader;
+
+  // Read and write positions are kept in [0, 2 * capacity), so that a full pipe
+  // can be told apart from an empty one.
+  size_t Offset(size_t position) const {
+    return position < capacity() ? position : position - capacity();
+  }
+
+  size_t Advance(size_t position, size_t size) const {
+    position += size;
+    return position < 2 * capacity() ? position : position - 2 * capacity();
+  }
+
+  size_t ReadableBytes() const;
+  size_t WritableBytes() const { return capacity() - ReadableBytes(); }
+
+  const ByteSpan buffer_;
+
+  std::atomic<size_t> read_position_;
+  std::atomic<size_t> write_position_;
+  std::atomic<bool> closed_;
+
+  // Notified when data is written or the writer is closed.
+  sync::TimedThreadNotification readable_;
+  // Notified when data is read.
+  sync::TimedThreadNotification writable_;
+
+  PipeWriter writer_;
+  PipeReader reader_;
+};
+
+// A Pipe with its own buffer.
+template <size_t kSizeBytes>
+class PipeBuffer : public Pipe {
+ public:
+  PipeBuffer() : Pipe(buffer_) {}
+
+ private:
+  std::array<std::byte, kSizeBytes> buffer_;
+};
+
+}  // namespace pw::stream
@@ -17,6 +17,7 @@
 #include <netinet/in.h>
 #include <stdio.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <array>
@@ -31,11 +32,16 @@ namespace pw::stream {
 static constexpr int kExitCode = -1;
 static constexpr int kInvalidFd = -1;
 
+class ServerSocket;
+
 class SocketStream : public Writer, public Reader {
  public:
   explicit SocketStream() {}
   ~SocketStream();
 
+  SocketStream(const SocketStream&) = delete;
+  SocketStream& operator=(const SocketStream&) = delete;
+
   // Listen to the port and return after a client is connected
   Status Serve(uint16_t port);
 
@@ -46,15 +52,65 @@ class SocketStream : public Writer, public Reader {
   // Close the socket stream and release all resources
   void Close();
 
+  // Whether the stream has a connection.
+  bool is_open() const { return conn_fd_ != kInvalidFd; }
+
+  // The connection's file descriptor, for waiting on with poll() or similar.
+  int connection_fd() const { return conn_fd_; }
+
+  // In non-blocking mode, Read() returns RESOURCE_EXHAUSTED instead of waiting
+  // when no data is available. Writes still block until all of the data is
+  // sent, so frames are never partially written.
+  void set_nonblocking(bool nonblocking) { nonblocking_ = nonblocking; }
+
  private:
+  friend class ServerSocket;
+
   Status DoWrite(std::span<const std::byte> data) override;
 
+  // Writes the buffers with writev(), so a frame split into several buffers is
+  // sent with as few system calls as possible.
+  Status DoWritev(std::span<const ConstByteSpan> data) override;
+
   StatusWithSize DoRead(ByteSpan dest) override;
 
   uint16_t listen_port_ = 0;
   int socket_fd_ = kInvalidFd;
   int conn_fd_ = kInvalidFd;
+  bool nonblocking_ = false;
   struct sockaddr_in sockaddr_client_;
 };
 
+// Listens on a port and accepts any number of connections, each into its own
+// SocketStream. SocketStream::Serve() only accepts a single connection.
+class ServerSocket {
+ public:
+  ServerSocket() = default;
+  ~ServerSocket() { Close(); }
+
+  ServerSocket(const ServerSocket&) = delete;
+  ServerSocket& operator=(const ServerSocket&) = delete;
+
+  // Listens on the port. If the port is 0, one is chosen; see port().
+  Status Listen(uint16_t port);
+
+  // Accepts a connection into the stream, which must not be open. Blocks until
+  // a client connects; to avoid blocking, wait until fd() is readable first.
+  Status Accept(SocketStream& stream);
+
+  // Stops listening. Accepted connections stay open.
+  void Close();
+
+  // The port being listened on.
+  uint16_t port() const { return port_; }
+
+  // The listening socket's file descriptor, for waiting on with poll() or
+  // similar.
+  int fd() const { return socket_fd_; }
+
+ private:
+  uint16_t port_ = 0;
+  int socket_fd_ = kInvalidFd;
+};
+
 }  // namespace pw::stream
@@ -15,6 +15,7 @@
 
 #include <array>
 #include <cstddef>
+#include <limits>
 #include <span>
 
 #include "pw_assert/assert.h"
@@ -69,6 +70,21 @@ class Writer {
   }
   Status Write(const std::byte b) { return Write(&b, 1); }
 
+  // Writes several buffers in order, as if they were one contiguous buffer.
+  // Writers that can send several buffers at once, such as sockets with
+  // writev(), do so with a single operation. Otherwise, each buffer is written
+  // with DoWrite().
+  //
+  // Returns the same statuses as Write(ConstByteSpan). Unless the writer
+  // overrides DoWritev() to write the buffers atomically, the buffers before
+  // the one that failed may have been written.
+  Status Write(std::span<const ConstByteSpan> data) {
+    for ([[maybe_unused]] ConstByteSpan buffer : data) {
+      PW_DASSERT(buffer.empty() || buffer.data() != nullptr);
+    }
+    return DoWritev(data);
+  }
+
   // Probable (not guaranteed) minimum number of bytes at this time that can be
   // written. This number is advisory and not guaranteed to write without a
   // RESOURCE_EXHAUSTED or OUT_OF_RANGE. As Writer processes/handles enqueued of
@@ -84,6 +100,20 @@ class Writer {
 
  private:
   virtual Status DoWrite(ConstByteSpan data) = 0;
+
+  // Writes the buffers with one DoWrite() call each. Override this if the
+  // writer can write several buffers more efficiently.
+  virtual Status DoWritev(std::span<const ConstByteSpan> data) {
+    for (ConstByteSpan buffer : data) {
+      if (buffer.empty()) {
+        continue;
+      }
+      if (Status status = DoWrite(buffer); !status.ok()) {
+        return status;
+      }
+    }
+    return OkStatus();
+  }
 };
 
 // General-purpose reader interface
@@ -144,4 +174,58 @@ class Reader {
   virtual StatusWithSize DoRead(ByteSpan dest) = 0;
 };
 
+// The position a seek offset is relative to.
+enum class Whence {
+  kBeginning,
+  kCurrent,
+  kEnd,
+};
+
+// A Reader whose read position can be changed, such as a file.
+class SeekableReader : public Reader {
+ public:
+  // Moves the position of the next read to offset bytes from origin.
+  //
+  // Returns:
+  //
+  // OK - the position was changed.
+  // OUT_OF_RANGE - the position would be before the beginning or past the end
+  //     of the data. The position is unchanged.
+  // Other errors are implementation-defined.
+  Status Seek(ptrdiff_t offset, Whence origin = Whence::kBeginning) {
+    return DoSeek(offset, origin);
+  }
+
+  // Returns the position of the next read, in bytes from the beginning.
+  size_t Tell() const { return DoTell(); }
+
+ private:
+  virtual Status DoSeek(ptrdiff_t offset, Whence origin) = 0;
+  virtual size_t DoTell() const = 0;
+};
+
+// A Writer whose write position can be changed, such as a file.
+class SeekableWriter : public Writer {
+ public:
+  // Moves the position of the next write to offset bytes from origin.
+  //
+  // Returns:
+  //
+  // OK - the position was changed.
+  // OUT_OF_RANGE - the position would be before the beginning of the data, or
+  //     past its end if the writer does not support that. The position is
+  //     unchanged.
+  // Other errors are implementation-defined.
+  Status Seek(ptrdiff_t offset, Whence origin = Whence::kBeginning) {
+    return DoSeek(offset, origin);
+  }
+
+  // Returns the position of the next write, in bytes from the beginning.
+  size_t Tell() const { return DoTell(); }
+
+ private:
+  virtual Status DoSeek(ptrdiff_t offset, Whence origin) = 0;
+  virtual size_t DoTell() const = 0;
+};
+
 }  // namespace pw::stream
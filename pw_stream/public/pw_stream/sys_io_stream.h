@@ -30,10 +30,18 @@ class SysIoWriter : public Writer {
   }
 };
 
+// Reads block until at least one byte arrives, then return it along with any
+// other bytes that are already available, rather than waiting to fill dest.
 class SysIoReader : public Reader {
  private:
   StatusWithSize DoRead(ByteSpan dest) override {
-    return pw::sys_io::ReadBytes(dest);
+    if (dest.empty()) {
+      return StatusWithSize(0);
+    }
+    if (Status status = pw::sys_io::ReadByte(&dest[0]); !status.ok()) {
+      return StatusWithSize(status, 0);
+    }
+    return StatusWithSize(1 + pw::sys_io::TryReadBytes(dest.subspan(1)).size());
   }
 };
 
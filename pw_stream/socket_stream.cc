@@ -13,11 +13,19 @@
 // the License.
 
 #include "pw_stream/socket_stream.h"
+
+#include <errno.h>
+
+#include <algorithm>
+
 namespace pw::stream {
 
 static constexpr uint32_t kMaxConcurrentUser = 1;
 static constexpr char kLocalhostAddress[] = "127.0.0.1";
 
+// Number of buffers passed to each writev() call.
+static constexpr size_t kMaxIovecs = 16;
+
 SocketStream::~SocketStream() { Close(); }
 
 // Listen to the port and return after a client is connected
@@ -99,12 +107,97 @@ Status SocketStream::DoWrite(std::span<const std::byte> data) {
   return OkStatus();
 }
 
+Status SocketStream::DoWritev(std::span<const ConstByteSpan> data) {
+  while (!data.empty()) {
+    std::array<struct iovec, kMaxIovecs> iov;
+    const size_t count = std::min(data.size(), iov.size());
+    size_t total_size = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+      iov[i].iov_base = const_cast<std::byte*>(data[i].data());
+      iov[i].iov_len = data[i].size_bytes();
+      total_size += data[i].size_bytes();
+    }
+
+    ssize_t bytes_sent = writev(conn_fd_, iov.data(), count);
+    if (bytes_sent < 0 || static_cast<size_t>(bytes_sent) != total_size) {
+      return Status::Internal();
+    }
+    data = data.subspan(count);
+  }
+  return OkStatus();
+}
+
 StatusWithSize SocketStream::DoRead(ByteSpan dest) {
-  ssize_t bytes_rcvd = recv(conn_fd_, dest.data(), dest.size_bytes(), 0);
+  ssize_t bytes_rcvd = recv(conn_fd_,
+                            dest.data(),
+                            dest.size_bytes(),
+                            nonblocking_ ? MSG_DONTWAIT : 0);
   if (bytes_rcvd < 0) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return StatusWithSize::ResourceExhausted();
+    }
     return StatusWithSize::Internal();
   }
+  if (bytes_rcvd == 0 && !dest.empty()) {
+    return StatusWithSize::OutOfRange();  // The connection was closed.
+  }
   return StatusWithSize(bytes_rcvd);
 }
 
+Status ServerSocket::Listen(uint16_t port) {
+  socket_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (socket_fd_ == kInvalidFd) {
+    return Status::Internal();
+  }
+
+  const int reuse_address = 1;
+  setsockopt(socket_fd_,
+             SOL_SOCKET,
+             SO_REUSEADDR,
+             &reuse_address,
+             sizeof(reuse_address));
+
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = INADDR_ANY;
+
+  socklen_t len = sizeof(addr);
+  if (bind(socket_fd_, reinterpret_cast<struct sockaddr*>(&addr), len) < 0 ||
+      listen(socket_fd_, SOMAXCONN) < 0 ||
+      getsockname(
+          socket_fd_, reinterpret_cast<struct sockaddr*>(&addr), &len) < 0) {
+    Close();
+    return Status::Internal();
+  }
+
+  port_ = ntohs(addr.sin_port);
+  return OkStatus();
+}
+
+Status ServerSocket::Accept(SocketStream& stream) {
+  if (stream.is_open()) {
+    return Status::FailedPrecondition();
+  }
+
+  socklen_t len = sizeof(stream.sockaddr_client_);
+  stream.conn_fd_ =
+      accept(socket_fd_,
+             reinterpret_cast<sockaddr*>(&stream.sockaddr_client_),
+             &len);
+  if (stream.conn_fd_ < 0) {
+    stream.conn_fd_ = kInvalidFd;
+    return Status::Internal();
+  }
+  return OkStatus();
+}
+
+void ServerSocket::Close() {
+  if (socket_fd_ != kInvalidFd) {
+    close(socket_fd_);
+    socket_fd_ = kInvalidFd;
+  }
+}
+
 };  // namespace pw::stream
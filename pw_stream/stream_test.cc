@@ -14,6 +14,7 @@
 
 #include "pw_stream/stream.h"
 
+#include <array>
 #include <limits>
 
 #include "gtest/gtest.h"
@@ -33,5 +34,48 @@ TEST(Stream, DefaultConservativeReadLimit) {
   EXPECT_EQ(stream.ConservativeReadLimit(), std::numeric_limits<size_t>::max());
 }
 
+// Counts DoWrite() calls and fails after a number of them.
+class CountingWriter : public Writer {
+ public:
+  constexpr CountingWriter(int fail_after) : fail_after_(fail_after) {}
+
+  int writes() const { return writes_; }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    if (writes_ == fail_after_) {
+      return Status::Unavailable();
+    }
+    writes_ += 1;
+    bytes_ += data.size();
+    return OkStatus();
+  }
+
+  const int fail_after_;
+  int writes_ = 0;
+  size_t bytes_ = 0;
+};
+
+TEST(Stream, DefaultVectoredWrite_WritesEachBuffer) {
+  const std::array<std::byte, 3> data = {};
+  const std::array<ConstByteSpan, 4> buffers = {
+      data, ConstByteSpan(), std::span(data).first(1), data};
+
+  CountingWriter writer(10);
+  EXPECT_EQ(writer.Write(buffers), OkStatus());
+  EXPECT_EQ(writer.writes(), 3);  // The empty buffer is skipped.
+  EXPECT_EQ(writer.bytes(), 7u);
+}
+
+TEST(Stream, DefaultVectoredWrite_StopsAtError) {
+  const std::array<std::byte, 3> data = {};
+  const std::array<ConstByteSpan, 3> buffers = {data, data, data};
+
+  CountingWriter writer(1);
+  EXPECT_EQ(writer.Write(buffers), Status::Unavailable());
+  EXPECT_EQ(writer.writes(), 1);
+}
+
 }  // namespace
 }  // namespace pw::stream
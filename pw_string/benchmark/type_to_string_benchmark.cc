@@ -0,0 +1,130 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program compares the speed of pw_string's IntToString and FloatToString
+// with snprintf. Build the type_to_string_benchmark target for the target of
+// interest and run it; results are logged with pw_log.
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_string/type_to_string.h"
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+// Formats the i-th test value into the buffer and returns the length.
+using FormatFunction = size_t (*)(size_t i, std::span<char> buffer);
+
+struct Implementation {
+  const char* name;
+  FormatFunction function;
+};
+
+constexpr size_t kValueCount = 256;
+constexpr size_t kIterations = 64;
+
+std::array<uint32_t, kValueCount> int_values;
+std::array<int64_t, kValueCount> int64_values;
+std::array<float, kValueCount> float_values;
+
+size_t IntToStringUint32(size_t i, std::span<char> buffer) {
+  return pw::string::IntToString(int_values[i], buffer).size();
+}
+
+size_t SnprintfUint32(size_t i, std::span<char> buffer) {
+  return std::snprintf(
+      buffer.data(), buffer.size(), "%" PRIu32, int_values[i]);
+}
+
+size_t IntToStringInt64(size_t i, std::span<char> buffer) {
+  return pw::string::IntToString(int64_values[i], buffer).size();
+}
+
+size_t SnprintfInt64(size_t i, std::span<char> buffer) {
+  return std::snprintf(
+      buffer.data(), buffer.size(), "%" PRId64, int64_values[i]);
+}
+
+size_t FloatToString(size_t i, std::span<char> buffer) {
+  return pw::string::FloatToString(float_values[i], buffer).size();
+}
+
+size_t SnprintfFloat(size_t i, std::span<char> buffer) {
+  // %.9g always round trips, but is not always the shortest string.
+  return std::snprintf(
+      buffer.data(), buffer.size(), "%.9g", double(float_values[i]));
+}
+
+constexpr Implementation kImplementations[] = {
+    {"IntToString uint32_t", IntToStringUint32},
+    {"snprintf uint32_t", SnprintfUint32},
+    {"IntToString int64_t", IntToStringInt64},
+    {"snprintf int64_t", SnprintfInt64},
+    {"FloatToString", FloatToString},
+    {"snprintf float", SnprintfFloat},
+};
+
+// Stores the results so the calculations are not optimized out.
+volatile size_t result;
+
+void RunBenchmark(const Implementation& implementation) {
+  std::array<char, 32> buffer;
+  size_t total_chars = 0;
+
+  const SystemClock::time_point start = SystemClock::now();
+  for (size_t iteration = 0; iteration < kIterations; ++iteration) {
+    for (size_t i = 0; i < kValueCount; ++i) {
+      total_chars += implementation.function(i, buffer);
+    }
+  }
+  const SystemClock::duration elapsed = SystemClock::now() - start;
+
+  result = total_chars;
+
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  const size_t calls = kValueCount * kIterations;
+
+  PW_LOG_INFO("%s: %u calls in %u us (%u ns per call)",
+              implementation.name,
+              unsigned(calls),
+              unsigned(elapsed_ns / 1000),
+              unsigned(elapsed_ns / calls));
+}
+
+}  // namespace
+
+int main() {
+  // Use a fixed pseudorandom sequence with a mix of magnitudes.
+  uint32_t state = 1;
+  for (size_t i = 0; i < kValueCount; ++i) {
+    state = state * 1664525u + 1013904223u;
+    int_values[i] = state >> (i % 32);
+    int64_values[i] = (int64_t(state) << (i % 32)) * (i % 2 == 0u ? 1 : -1);
+    float_values[i] = float(int32_t(state)) / float(1u << (i % 32));
+  }
+
+  for (const Implementation& implementation : kImplementations) {
+    RunBenchmark(implementation);
+  }
+  return 0;
+}
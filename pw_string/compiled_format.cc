@@ -0,0 +1,45 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_string/compiled_format.h"
+
+namespace pw::string::internal {
+
+void AppendField(StringBuilder& builder,
+                 const FormatSegment& spec,
+                 std::string_view text,
+                 bool numeric) {
+  const size_t padding =
+      spec.width > text.size() ? spec.width - text.size() : 0u;
+
+  if (spec.left_justify) {
+    builder.append(text);
+    builder.append(padding, ' ');
+    return;
+  }
+
+  if (spec.zero_pad && numeric) {
+    // Zeros go after the sign, like printf.
+    if (!text.empty() && text[0] == '-') {
+      builder.push_back('-');
+      text.remove_prefix(1);
+    }
+    builder.append(padding, '0');
+  } else {
+    builder.append(padding, ' ');
+  }
+  builder.append(text);
+}
+
+}  // namespace pw::string::internal
@@ -0,0 +1,163 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_string/compiled_format.h"
+
+#include <cstdint>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace pw::string {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+TEST(CompiledFormat, ParseFormat_Segments) {
+  constexpr std::string_view kFormat = "a%db%%c%-5sd";
+  constexpr auto kParsed =
+      internal::ParseFormat<internal::FormatSegmentCount(kFormat)>(kFormat);
+
+  static_assert(kParsed.valid);
+  static_assert(kParsed.argument_count == 2u);
+  static_assert(kParsed.segments.size() == 4u);
+  static_assert(kParsed.segments[0].conversion ==
+                internal::FormatSegment::kInteger);
+  static_assert(kParsed.segments[1].conversion ==
+                internal::FormatSegment::kNone);
+  static_assert(kParsed.segments[2].conversion ==
+                internal::FormatSegment::kString);
+  static_assert(kParsed.segments[2].left_justify);
+  static_assert(kParsed.segments[2].width == 5u);
+}
+
+TEST(CompiledFormat, ParseFormat_UnsupportedConversions_Invalid) {
+  constexpr std::string_view kPrecision = "%.3f";
+  static_assert(!internal::ParseFormat<2>(kPrecision).valid);
+  constexpr std::string_view kStar = "%*d";
+  static_assert(!internal::ParseFormat<2>(kStar).valid);
+  constexpr std::string_view kUnknown = "%q";
+  static_assert(!internal::ParseFormat<2>(kUnknown).valid);
+  constexpr std::string_view kTrailingPercent = "abc%";
+  static_assert(!internal::ParseFormat<2>(kTrailingPercent).valid);
+}
+
+TEST(CompiledFormat, ArgumentsMatch) {
+  constexpr std::string_view kFormat = "%d %s %f %p";
+  constexpr auto kParsed = internal::ParseFormat<5>(kFormat);
+
+  static_assert(
+      internal::ArgumentsMatch<int, const char*, float, void*>(kParsed));
+  static_assert(
+      internal::ArgumentsMatch<char, std::string_view, double, char*>(
+          kParsed));
+  static_assert(
+      !internal::ArgumentsMatch<float, const char*, float, void*>(kParsed));
+  static_assert(!internal::ArgumentsMatch<int, int, float, void*>(kParsed));
+  static_assert(
+      !internal::ArgumentsMatch<int, const char*, int, void*>(kParsed));
+  static_assert(!internal::ArgumentsMatch<bool, const char*, float, int>(
+      kParsed));
+}
+
+TEST(CompiledFormat, NoArguments) {
+  char buffer[16];
+  StatusWithSize result = PW_FORMAT(buffer, "Hello");
+  EXPECT_EQ(OkStatus(), result.status());
+  EXPECT_EQ(5u, result.size());
+  EXPECT_STREQ("Hello", buffer);
+}
+
+TEST(CompiledFormat, Integers) {
+  char buffer[64];
+  const unsigned short small = 7;
+  const int64_t large = -1234567890123;
+  EXPECT_EQ(OkStatus(),
+            PW_FORMAT(buffer, "%d|%u|%i|%lld", 42, small, -5, large).status());
+  EXPECT_STREQ("42|7|-5|-1234567890123", buffer);
+}
+
+TEST(CompiledFormat, Hex) {
+  char buffer[32];
+  EXPECT_EQ(OkStatus(),
+            PW_FORMAT(buffer, "%x %X %08x %x", 0xbeefu, 0xbeef, 0x1f, -1)
+                .status());
+  EXPECT_STREQ("beef BEEF 0000001f ffffffff", buffer);
+}
+
+TEST(CompiledFormat, Width) {
+  char buffer[32];
+  EXPECT_EQ(OkStatus(),
+            PW_FORMAT(buffer, "[%5d][%-5d][%05d][%3s]", 42, 42, -42, "a")
+                .status());
+  EXPECT_STREQ("[   42][42   ][-0042][  a]", buffer);
+}
+
+TEST(CompiledFormat, Strings) {
+  char buffer[32];
+  const char* null_string = nullptr;
+  EXPECT_EQ(OkStatus(),
+            PW_FORMAT(buffer, "%s,%s,%s", "one", "two"sv, null_string)
+                .status());
+  EXPECT_STREQ("one,two,(null)", buffer);
+}
+
+TEST(CompiledFormat, CharsAndPercent) {
+  char buffer[16];
+  EXPECT_EQ(OkStatus(), PW_FORMAT(buffer, "%c%c 100%%", 'o', 'k').status());
+  EXPECT_STREQ("ok 100%", buffer);
+}
+
+TEST(CompiledFormat, Floats) {
+  char buffer[32];
+  EXPECT_EQ(OkStatus(), PW_FORMAT(buffer, "%f %g", 1.5f, 0.1).status());
+  EXPECT_STREQ("1.5 0.1", buffer);
+}
+
+enum class Color : uint8_t { kRed = 1, kBlue = 200 };
+
+TEST(CompiledFormat, Enums) {
+  char buffer[16];
+  EXPECT_EQ(OkStatus(),
+            PW_FORMAT(buffer, "%d %x", Color::kRed, Color::kBlue).status());
+  EXPECT_STREQ("1 c8", buffer);
+}
+
+TEST(CompiledFormat, Pointer) {
+  char buffer[32];
+  char expected[32];
+  int value = 0;
+  PointerToString(&value, expected);
+  EXPECT_EQ(OkStatus(), PW_FORMAT(buffer, "%p", &value).status());
+  EXPECT_STREQ(expected, buffer);
+}
+
+TEST(CompiledFormat, StringBuilder) {
+  StringBuffer<32> sb;
+  sb << "x=";
+  PW_FORMAT(sb, "%d, y=%d", 1, 2) << '!';
+  EXPECT_EQ(OkStatus(), sb.status());
+  EXPECT_EQ("x=1, y=2!"sv, sb.view());
+}
+
+TEST(CompiledFormat, BufferTooSmall_ResourceExhausted) {
+  char buffer[8];
+  StatusWithSize result = PW_FORMAT(buffer, "abc%sxyz", "defghi");
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(7u, result.size());
+  EXPECT_STREQ("abcdefg", buffer);
+}
+
+}  // namespace
+}  // namespace pw::string
@@ -0,0 +1,376 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "pw_preprocessor/arguments.h"
+#include "pw_status/status_with_size.h"
+#include "pw_string/string_builder.h"
+#include "pw_string/type_to_string.h"
+#include "pw_string/util.h"
+
+// PW_FORMAT is a printf-style formatting macro that parses its format string at
+// compile time. Each conversion specifier is checked against its argument's
+// type with a static_assert, and is expanded into a direct call to the
+// pw_string/type_to_string.h functions. Nothing is parsed at run time and
+// vsnprintf is not needed.
+//
+//   PW_FORMAT(destination, format, ...)
+//
+// The destination is a std::span<char> (or a char array) or a StringBuilder.
+// For a buffer, PW_FORMAT returns a StatusWithSize, like pw::string::Format.
+// For a StringBuilder, the text is appended and the StringBuilder is returned.
+//
+//   char buffer[32];
+//   PW_FORMAT(buffer, "Battery %d%% (%s)", level, charging ? "on" : "off");
+//
+//   pw::StringBuffer<64> sb;
+//   PW_FORMAT(sb, "addr=0x%08x value=%f", address, value);
+//
+// The format string must be a string literal. Supported conversions:
+//
+//   %d %i %u  Any integer or enum, printed according to its type. The
+//             signedness does not have to match the specifier.
+//   %x %X     Any integer or enum, in hexadecimal. Negative values are printed
+//             as unsigned, like printf.
+//   %c        An integer, printed as a char.
+//   %s        A const char* or anything convertible to std::string_view.
+//   %f %g %e  A float or double, printed as the shortest round-trip string with
+//             pw::string::FloatToString.
+//   %p        A pointer, printed in hexadecimal.
+//   %%        A literal %.
+//
+// The '-' (left justify) and '0' (zero pad) flags and a fixed field width are
+// supported. Length modifiers (h, hh, l, ll, j, z, t, L) are accepted and
+// ignored, since the argument types are known. Precision and * widths are not
+// supported.
+//
+// Output that does not fit is handled as in StringBuilder: strings are
+// truncated, numbers that do not fit are omitted, and the status is set to
+// RESOURCE_EXHAUSTED.
+#define PW_FORMAT(destination, format, ...)                  \
+  ::pw::string::internal::CompiledFormat(                    \
+      destination, [] { return ::std::string_view(format); } \
+          PW_COMMA_ARGS(__VA_ARGS__))
+
+namespace pw::string::internal {
+
+// A conversion specifier, with the literal text that precedes it.
+struct FormatSegment {
+  enum Conversion : char {
+    kNone = '\0',  // Literal text only: %% or the end of the string.
+    kInteger = 'd',
+    kHex = 'x',
+    kUpperHex = 'X',
+    kChar = 'c',
+    kString = 's',
+    kFloat = 'f',
+    kPointer = 'p',
+  };
+
+  size_t literal_start;
+  size_t literal_size;
+  Conversion conversion;
+  bool left_justify;
+  bool zero_pad;
+  uint8_t width;
+};
+
+template <size_t kSegments>
+struct ParsedFormat {
+  std::array<FormatSegment, kSegments> segments;
+  size_t argument_count;
+  bool valid;
+};
+
+// Each % starts a segment; the text after the last one is another.
+constexpr size_t FormatSegmentCount(std::string_view format) {
+  size_t count = 1;
+  for (size_t i = 0; i < format.size(); ++i) {
+    if (format[i] == '%') {
+      count += 1;
+      i += 1;  // Skip the second % in %%.
+    }
+  }
+  return count;
+}
+
+constexpr bool IsLengthModifier(char c) {
+  return c == 'h' || c == 'l' || c == 'j' || c == 'z' || c == 't' || c == 'L';
+}
+
+template <size_t kSegments>
+constexpr ParsedFormat<kSegments> ParseFormat(std::string_view format) {
+  ParsedFormat<kSegments> parsed{};
+  parsed.valid = true;
+
+  size_t segment = 0;
+  size_t literal_start = 0;
+  size_t i = 0;
+
+  while (i < format.size()) {
+    if (format[i] != '%') {
+      i += 1;
+      continue;
+    }
+
+    FormatSegment& spec = parsed.segments[segment++];
+    spec.literal_start = literal_start;
+    spec.literal_size = i - literal_start;
+    i += 1;
+
+    if (i < format.size() && format[i] == '%') {
+      spec.literal_size += 1;  // Keep one % as part of the literal text.
+      spec.conversion = FormatSegment::kNone;
+      literal_start = ++i;
+      continue;
+    }
+
+    for (; i < format.size() && (format[i] == '-' || format[i] == '0'); ++i) {
+      spec.left_justify |= format[i] == '-';
+      spec.zero_pad |= format[i] == '0';
+    }
+
+    unsigned width = 0;
+    for (; i < format.size() && format[i] >= '0' && format[i] <= '9'; ++i) {
+      width = width * 10 + (format[i] - '0');
+    }
+    spec.width = static_cast<uint8_t>(width);
+
+    while (i < format.size() && IsLengthModifier(format[i])) {
+      i += 1;
+    }
+
+    if (i == format.size() || width > 255u) {
+      parsed.valid = false;
+      return parsed;
+    }
+
+    switch (format[i]) {
+      case 'd':
+      case 'i':
+      case 'u':
+        spec.conversion = FormatSegment::kInteger;
+        break;
+      case 'x':
+        spec.conversion = FormatSegment::kHex;
+        break;
+      case 'X':
+        spec.conversion = FormatSegment::kUpperHex;
+        break;
+      case 'c':
+        spec.conversion = FormatSegment::kChar;
+        break;
+      case 's':
+        spec.conversion = FormatSegment::kString;
+        break;
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'e':
+      case 'E':
+        spec.conversion = FormatSegment::kFloat;
+        break;
+      case 'p':
+        spec.conversion = FormatSegment::kPointer;
+        break;
+      default:  // Precision, *, and unknown conversions are not supported.
+        parsed.valid = false;
+        return parsed;
+    }
+
+    parsed.argument_count += 1;
+    literal_start = ++i;
+  }
+
+  FormatSegment& last = parsed.segments[segment++];
+  last.literal_start = literal_start;
+  last.literal_size = format.size() - literal_start;
+  last.conversion = FormatSegment::kNone;
+  return parsed;
+}
+
+template <typename T>
+constexpr bool IsFormatString() {
+  return std::is_convertible_v<T, std::string_view> ||
+         std::is_convertible_v<T, const char*>;
+}
+
+template <typename T>
+constexpr bool IsFormatInteger() {
+  return (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+         std::is_enum_v<T>;
+}
+
+template <typename T>
+constexpr bool ArgumentMatches(FormatSegment::Conversion conversion) {
+  using Arg = std::remove_cv_t<std::remove_reference_t<T>>;
+  switch (conversion) {
+    case FormatSegment::kInteger:
+    case FormatSegment::kHex:
+    case FormatSegment::kUpperHex:
+    case FormatSegment::kChar:
+      return IsFormatInteger<Arg>();
+    case FormatSegment::kString:
+      return IsFormatString<Arg>();
+    case FormatSegment::kFloat:
+      return std::is_floating_point_v<Arg>;
+    case FormatSegment::kPointer:
+      return std::is_pointer_v<std::decay_t<Arg>> ||
+             std::is_null_pointer_v<Arg>;
+    case FormatSegment::kNone:
+      break;
+  }
+  return false;
+}
+
+// Checks each argument against the conversion it is used with.
+template <typename... Args, size_t kSegments>
+constexpr bool ArgumentsMatch(const ParsedFormat<kSegments>& parsed) {
+  if (!parsed.valid || parsed.argument_count != sizeof...(Args)) {
+    return true;  // These errors are reported separately.
+  }
+
+  size_t segment = 0;
+  bool matches = true;
+
+  [[maybe_unused]] const auto next_conversion = [&]() {
+    while (parsed.segments[segment].conversion == FormatSegment::kNone) {
+      segment += 1;
+    }
+    return parsed.segments[segment++].conversion;
+  };
+
+  ((matches = ArgumentMatches<Args>(next_conversion()) && matches), ...);
+  return matches;
+}
+
+// Writes an already converted argument, with padding to the field width.
+void AppendField(StringBuilder& builder,
+                 const FormatSegment& spec,
+                 std::string_view text,
+                 bool numeric);
+
+template <typename T>
+void AppendArgument(StringBuilder& builder,
+                    const FormatSegment& spec,
+                    const T& value) {
+  if constexpr (IsFormatString<T>()) {
+    // char* arguments may also be printed with %p.
+    if (spec.conversion == FormatSegment::kString) {
+      std::string_view text;
+      if constexpr (std::is_convertible_v<T, const char*>) {
+        const char* str = value;
+        text = str == nullptr ? kNullPointerString
+                              : ClampedCString(str, builder.max_size() + 1);
+      } else {
+        text = value;
+      }
+      AppendField(builder, spec, text, false);
+      return;
+    }
+  }
+
+  if constexpr (std::is_enum_v<T>) {
+    AppendArgument(builder, spec, std::underlying_type_t<T>(value));
+  } else if constexpr (std::is_integral_v<T> || std::is_floating_point_v<T> ||
+                       std::is_pointer_v<std::decay_t<T>> ||
+                       std::is_null_pointer_v<T>) {
+    // Numbers are converted into a small buffer so that they can be padded.
+    char buffer[24];
+    StatusWithSize result;
+
+    if constexpr (std::is_floating_point_v<T>) {
+      result = FloatToString(value, buffer);
+    } else if constexpr (!std::is_integral_v<T>) {
+      result = PointerToString(value, buffer);
+    } else if (spec.conversion == FormatSegment::kChar) {
+      buffer[0] = static_cast<char>(value);
+      AppendField(builder, spec, std::string_view(buffer, 1), false);
+      return;
+    } else if (spec.conversion == FormatSegment::kInteger) {
+      result = IntToString(value, buffer);
+    } else {
+      result = IntToHexString(static_cast<std::make_unsigned_t<T>>(value),
+                              buffer);
+      if (spec.conversion == FormatSegment::kUpperHex) {
+        for (size_t i = 0; i < result.size(); ++i) {
+          if (buffer[i] >= 'a') {
+            buffer[i] -= 'a' - 'A';
+          }
+        }
+      }
+    }
+
+    AppendField(builder, spec, std::string_view(buffer, result.size()), true);
+  }
+}
+
+template <typename Provider, typename... Args>
+StringBuilder& CompiledFormat(StringBuilder& builder,
+                              Provider format_provider,
+                              const Args&... args) {
+  constexpr std::string_view kFormat = format_provider();
+  static constexpr auto kParsed =
+      ParseFormat<FormatSegmentCount(kFormat)>(kFormat);
+
+  static_assert(kParsed.valid,
+                "PW_FORMAT only supports the %d, %i, %u, %x, %X, %c, %s, %f, "
+                "%g, %e, %p, and %% conversions, with the '-' and '0' flags "
+                "and a field width");
+  static_assert(kParsed.argument_count == sizeof...(Args),
+                "The number of PW_FORMAT arguments does not match the number "
+                "of conversions in the format string");
+  static_assert(ArgumentsMatch<Args...>(kParsed),
+                "A PW_FORMAT argument's type does not match its conversion");
+
+  size_t segment = 0;
+
+  // Writes literal text up to the next conversion, then the argument.
+  [[maybe_unused]] const auto append_next = [&](const auto& arg) {
+    while (true) {
+      const FormatSegment& spec = kParsed.segments[segment++];
+      builder.append(kFormat.data() + spec.literal_start, spec.literal_size);
+      if (spec.conversion != FormatSegment::kNone) {
+        AppendArgument(builder, spec, arg);
+        return;
+      }
+    }
+  };
+  (append_next(args), ...);
+
+  for (; segment < kParsed.segments.size(); ++segment) {
+    const FormatSegment& spec = kParsed.segments[segment];
+    builder.append(kFormat.data() + spec.literal_start, spec.literal_size);
+  }
+  return builder;
+}
+
+template <typename Provider, typename... Args>
+StatusWithSize CompiledFormat(std::span<char> buffer,
+                              Provider format_provider,
+                              const Args&... args) {
+  StringBuilder builder(buffer);
+  CompiledFormat(builder, format_provider, args...);
+  return builder.status_with_size();
+}
+
+}  // namespace pw::string::internal
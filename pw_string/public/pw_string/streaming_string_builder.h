@@ -0,0 +1,80 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+#include "pw_string/string_builder.h"
+
+namespace pw {
+
+// StreamingStringBuilder is a StringBuilder that writes its contents to a
+// stream::Writer whenever the buffer fills up, rather than truncating. This
+// allows formatting output of any length, such as a large log dump or a report
+// sent over a transport, with a small buffer and the same << and append calls
+// used with a StringBuilder.
+//
+//   std::array<char, 64> buffer;
+//   StreamingStringBuilder sb(buffer, uart_writer);
+//   for (const Item& item : items) {
+//     sb << item.name << ": " << item.value << '\n';
+//   }
+//   sb.Flush();
+//
+// A single value that does not fit in an empty buffer is handled as in a
+// StringBuilder: it is truncated or omitted and status() is set to
+// RESOURCE_EXHAUSTED. The buffer should be larger than the largest formatted
+// value. If the Writer fails, its status is reported by status() and
+// output that does not fit in the buffer is dropped. Any remaining output is
+// flushed on destruction.
+class StreamingStringBuilder : public StringBuilder {
+ public:
+  StreamingStringBuilder(std::span<char> buffer, stream::Writer& writer)
+      : StringBuilder(buffer, WriteToStream), writer_(writer) {}
+
+  StreamingStringBuilder(const StreamingStringBuilder&) = delete;
+  StreamingStringBuilder& operator=(const StreamingStringBuilder&) = delete;
+
+  ~StreamingStringBuilder() { Flush(); }
+
+  // Writes the buffered contents to the Writer. Returns the builder's status,
+  // which reflects any earlier errors as well as the result of this write.
+  Status Flush();
+
+ private:
+  static Status WriteToStream(StringBuilder& builder);
+
+  stream::Writer& writer_;
+};
+
+// StreamingStringBuffer declares a StreamingStringBuilder with a buffer of the
+// specified size.
+template <size_t kSizeBytes>
+class StreamingStringBuffer : public StreamingStringBuilder {
+ public:
+  explicit StreamingStringBuffer(stream::Writer& writer)
+      : StreamingStringBuilder(buffer_, writer) {}
+
+ private:
+  static_assert(kSizeBytes > 1u,
+                "A StreamingStringBuffer needs room for at least one character "
+                "and the null terminator");
+
+  char buffer_[kSizeBytes];
+};
+
+}  // namespace pw
@@ -191,7 +191,11 @@ class StringBuilder {
     if constexpr (std::is_convertible_v<T, std::string_view>) {
       append(value);
     } else {
-      HandleStatusWithSize(ToString(value, buffer_.subspan(size_)));
+      StatusWithSize result = ToString(value, buffer_.subspan(size_));
+      if (result.IsResourceExhausted() && FlushToRetry()) {
+        result = ToString(value, buffer_.subspan(size_));
+      }
+      HandleStatusWithSize(result);
     }
     return *this;
   }
@@ -240,7 +244,25 @@ class StringBuilder {
 
   void CopySizeAndStatus(const StringBuilder& other);
 
+  // Writes out the contents of the buffer, so that it can be reused. A
+  // StringBuilder constructed with a FlushFunction calls it when output does
+  // not fit in the remaining space, then empties the buffer and continues.
+  using FlushFunction = Status (*)(StringBuilder& builder);
+
+  constexpr StringBuilder(std::span<char> buffer, FlushFunction flush)
+      : buffer_(buffer), size_(0), flush_(flush) {
+    NullTerminate();
+  }
+
+  // Flushes the buffer with the FlushFunction and empties it. On failure, sets
+  // the status and returns false.
+  bool FlushBuffer();
+
  private:
+  // Flushes the buffer if there is a FlushFunction and the buffer is not
+  // empty, so that output that did not fit can be retried.
+  bool FlushToRetry() { return flush_ != nullptr && !empty() && FlushBuffer(); }
+
   size_t ResizeAndTerminate(size_t chars_to_append);
 
   void HandleStatusWithSize(StatusWithSize written);
@@ -258,6 +280,7 @@ class StringBuilder {
   size_t size_;
   Status status_;
   Status last_status_;
+  FlushFunction flush_ = nullptr;
 };
 
 // StringBuffers declare a buffer along with a StringBuilder. StringBuffer can
@@ -74,7 +74,7 @@ StatusWithSize ToString(const T& value, std::span<char> buffer) {
   } else if constexpr (std::is_enum_v<T>) {
     return string::IntToString(std::underlying_type_t<T>(value), buffer);
   } else if constexpr (std::is_floating_point_v<T>) {
-    return string::FloatAsIntToString(value, buffer);
+    return string::FloatToString(value, buffer);
   } else if constexpr (std::is_convertible_v<T, std::string_view>) {
     return string::CopyStringOrNull(value, buffer);
   } else if constexpr (std::is_pointer_v<std::remove_cv_t<T>> ||
@@ -98,6 +98,27 @@ StatusWithSize IntToHexString(uint64_t value,
 //
 StatusWithSize FloatAsIntToString(float value, std::span<char> buffer);
 
+// Writes a floating point number as the shortest null-terminated string that
+// converts back to the same float. Returns the number of characters written,
+// excluding the null terminator, and the status.
+//
+// Numbers from 1e-4 up to 1e9 are printed in fixed point notation. Others use
+// scientific notation, like %g. Integers are printed without a decimal point.
+// Infinity and NaN are printed as in FloatAsIntToString.
+//
+// Numbers are never truncated; if the entire number does not fit, only a null
+// terminator is written and the status is RESOURCE_EXHAUSTED.
+//
+// Examples:
+//
+//   FloatToString(1.25, buffer)     -> writes "1.25" to the buffer
+//   FloatToString(0.1, buffer)      -> writes "0.1" to the buffer
+//   FloatToString(-4, buffer)       -> writes "-4" to the buffer
+//   FloatToString(3.5e20, buffer)   -> writes "3.5e+20" to the buffer
+//   FloatToString(1e-5, buffer)     -> writes "1e-05" to the buffer
+//
+StatusWithSize FloatToString(float value, std::span<char> buffer);
+
 // Writes a bool as "true" or "false". Semantics match CopyEntireString.
 StatusWithSize BoolToString(bool value, std::span<char> buffer);
 
@@ -0,0 +1,118 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_string/streaming_string_builder.h"
+
+#include <cstring>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+std::string_view Written(const stream::MemoryWriter& writer) {
+  return std::string_view(
+      reinterpret_cast<const char*>(writer.WrittenData().data()),
+      writer.bytes_written());
+}
+
+// A Writer that always fails.
+class FailingWriter : public stream::Writer {
+ public:
+  size_t ConservativeWriteLimit() const override { return 0; }
+
+ private:
+  Status DoWrite(ConstByteSpan) override { return Status::Unavailable(); }
+};
+
+TEST(StreamingStringBuilder, FitsInBuffer_NotWrittenUntilFlush) {
+  stream::MemoryWriterBuffer<64> writer;
+  StreamingStringBuffer<16> sb(writer);
+
+  sb << "abc" << 123;
+  EXPECT_EQ(writer.bytes_written(), 0u);
+  EXPECT_EQ(sb.view(), "abc123"sv);
+
+  EXPECT_EQ(OkStatus(), sb.Flush());
+  EXPECT_EQ(Written(writer), "abc123"sv);
+  EXPECT_TRUE(sb.empty());
+}
+
+TEST(StreamingStringBuilder, LongString_FlushedInChunks) {
+  stream::MemoryWriterBuffer<64> writer;
+  StreamingStringBuffer<8> sb(writer);
+
+  sb << "The quick brown fox jumps over the lazy dog";
+  EXPECT_EQ(OkStatus(), sb.status());
+  EXPECT_EQ(OkStatus(), sb.Flush());
+  EXPECT_EQ(Written(writer), "The quick brown fox jumps over the lazy dog"sv);
+}
+
+TEST(StreamingStringBuilder, ManyValues_NoneTruncated) {
+  stream::MemoryWriterBuffer<256> writer;
+  StreamingStringBuffer<8> sb(writer);
+
+  for (int i = 0; i < 20; ++i) {
+    sb << i << ',';
+  }
+  sb.append(3, '!');
+  EXPECT_EQ(OkStatus(), sb.Flush());
+  EXPECT_EQ(Written(writer),
+            "0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,!!!"sv);
+}
+
+TEST(StreamingStringBuilder, Format_RetriedAfterFlush) {
+  stream::MemoryWriterBuffer<64> writer;
+  StreamingStringBuffer<12> sb(writer);
+
+  sb << "abcdefgh";
+  sb.Format("%d-%s", 4321, "xyz");
+  EXPECT_EQ(OkStatus(), sb.Flush());
+  EXPECT_EQ(Written(writer), "abcdefgh4321-xyz"sv);
+}
+
+TEST(StreamingStringBuilder, ValueLargerThanBuffer_NotWritten) {
+  stream::MemoryWriterBuffer<64> writer;
+  StreamingStringBuffer<4> sb(writer);
+
+  sb << 123456;
+  EXPECT_EQ(Status::ResourceExhausted(), sb.status());
+  sb.Flush();
+  EXPECT_EQ(writer.bytes_written(), 0u);
+}
+
+TEST(StreamingStringBuilder, WriterFails_ReportsError) {
+  FailingWriter writer;
+  StreamingStringBuffer<4> sb(writer);
+
+  sb << "abcdef";
+  EXPECT_EQ(Status::Unavailable(), sb.status());
+  EXPECT_EQ(Status::Unavailable(), sb.Flush());
+}
+
+TEST(StreamingStringBuilder, Destructor_Flushes) {
+  stream::MemoryWriterBuffer<64> writer;
+  {
+    StreamingStringBuffer<16> sb(writer);
+    sb << "bye";
+  }
+  EXPECT_EQ(Written(writer), "bye"sv);
+}
+
+}  // namespace
+}  // namespace pw
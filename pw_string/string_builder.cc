@@ -29,18 +29,47 @@ void StringBuilder::clear() {
 }
 
 StringBuilder& StringBuilder::append(size_t count, char ch) {
+  // With a FlushFunction, fill and flush the buffer until the rest fits.
+  while (flush_ != nullptr && count > max_size() - size()) {
+    const size_t chunk = max_size() - size();
+    std::memset(&buffer_[size_], ch, chunk);
+    size_ += chunk;
+    count -= chunk;
+    if (!FlushBuffer()) {
+      return *this;
+    }
+  }
+
   char* const append_destination = &buffer_[size_];
   std::memset(append_destination, ch, ResizeAndTerminate(count));
   return *this;
 }
 
 StringBuilder& StringBuilder::append(const char* str, size_t count) {
+  // With a FlushFunction, fill and flush the buffer until the rest fits.
+  while (flush_ != nullptr && count > max_size() - size()) {
+    const size_t chunk = max_size() - size();
+    std::memcpy(&buffer_[size_], str, chunk);
+    size_ += chunk;
+    str += chunk;
+    count -= chunk;
+    if (!FlushBuffer()) {
+      return *this;
+    }
+  }
+
   char* const append_destination = &buffer_[size_];
   std::memcpy(append_destination, str, ResizeAndTerminate(count));
   return *this;
 }
 
 StringBuilder& StringBuilder::append(const char* str) {
+  // Output to a StringBuilder with a FlushFunction is not limited by the
+  // buffer's size, so the whole string is appended.
+  if (flush_ != nullptr) {
+    return append(str, std::strlen(str));
+  }
+
   // Use buffer_.size() - size() as the maximum length so that strings too long
   // to fit in the buffer will request one character too many, which sets the
   // status to RESOURCE_EXHAUSTED.
@@ -95,8 +124,17 @@ StringBuilder& StringBuilder::Format(const char* format, ...) {
 }
 
 StringBuilder& StringBuilder::FormatVaList(const char* format, va_list args) {
-  HandleStatusWithSize(
-      string::FormatVaList(buffer_.subspan(size_), format, args));
+  va_list retry_args;
+  va_copy(retry_args, args);
+
+  StatusWithSize result =
+      string::FormatVaList(buffer_.subspan(size_), format, args);
+  if (result.IsResourceExhausted() && FlushToRetry()) {
+    result = string::FormatVaList(buffer_.subspan(size_), format, retry_args);
+  }
+  va_end(retry_args);
+
+  HandleStatusWithSize(result);
   return *this;
 }
 
@@ -106,6 +144,18 @@ void StringBuilder::CopySizeAndStatus(const StringBuilder& other) {
   last_status_ = other.last_status_;
 }
 
+bool StringBuilder::FlushBuffer() {
+  const Status status = flush_(*this);
+  if (!status.ok()) {
+    SetErrorStatus(status);
+    return false;
+  }
+
+  size_ = 0;
+  NullTerminate();
+  return true;
+}
+
 void StringBuilder::HandleStatusWithSize(StatusWithSize written) {
   const Status status = written.status();
   last_status_ = status;
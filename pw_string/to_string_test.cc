@@ -121,6 +121,10 @@ TEST(ToString, Integer_BufferTooSmall_WritesNullTerminator) {
 TEST(ToString, Float) {
   EXPECT_EQ(1u, ToString(0.0f, buffer).size());
   EXPECT_STREQ("0", buffer);
+  EXPECT_EQ(4u, ToString(-1.5f, buffer).size());
+  EXPECT_STREQ("-1.5", buffer);
+  EXPECT_EQ(3u, ToString(0.1, buffer).size());
+  EXPECT_STREQ("0.1", buffer);
   EXPECT_EQ(3u, ToString(INFINITY, buffer).size());
   EXPECT_STREQ("inf", buffer);
   EXPECT_EQ(4u, ToString(-NAN, buffer).size());
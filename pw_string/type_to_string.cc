@@ -14,6 +14,7 @@
 
 #include "pw_string/type_to_string.h"
 
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstring>
@@ -47,6 +48,15 @@ constexpr std::array<uint64_t, 20> kPowersOf10{
     10000000000000000000ull,  // 10^19
 };
 
+// The two-digit decimal strings "00" to "99". Writing two digits at a time
+// halves the number of divisions when printing integers.
+constexpr char kDigitPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
 StatusWithSize HandleExhaustedBuffer(std::span<char> buffer) {
   if (!buffer.empty()) {
     buffer[0] = '\0';
@@ -54,6 +64,280 @@ StatusWithSize HandleExhaustedBuffer(std::span<char> buffer) {
   return StatusWithSize::ResourceExhausted();
 }
 
+// Shortest round-trip float printing, based on Ulf Adams' Ryu algorithm
+// (https://github.com/ulfjack/ryu). Ryu finds the shortest decimal that parses
+// back to the same float with 32x64-bit multiplications against two small
+// tables of powers of 5, instead of the big integer arithmetic snprintf uses.
+constexpr int kFloatMantissaBits = 23;
+constexpr int kFloatExponentBits = 8;
+constexpr int kFloatExponentBias = 127;
+
+constexpr int kPow5InverseBitCount = 59;
+constexpr int kPow5BitCount = 61;
+
+// The top 61 bits of 5^i, for the negative exponent case.
+constexpr uint64_t kPow5Split[48] = {
+    0x1000000000000000ull,
+    0x1400000000000000ull,
+    0x1900000000000000ull,
+    0x1f40000000000000ull,
+    0x1388000000000000ull,
+    0x186a000000000000ull,
+    0x1e84800000000000ull,
+    0x1312d00000000000ull,
+    0x17d7840000000000ull,
+    0x1dcd650000000000ull,
+    0x12a05f2000000000ull,
+    0x174876e800000000ull,
+    0x1d1a94a200000000ull,
+    0x12309ce540000000ull,
+    0x16bcc41e90000000ull,
+    0x1c6bf52634000000ull,
+    0x11c37937e0800000ull,
+    0x16345785d8a00000ull,
+    0x1bc16d674ec80000ull,
+    0x1158e460913d0000ull,
+    0x15af1d78b58c4000ull,
+    0x1b1ae4d6e2ef5000ull,
+    0x10f0cf064dd59200ull,
+    0x152d02c7e14af680ull,
+    0x1a784379d99db420ull,
+    0x108b2a2c28029094ull,
+    0x14adf4b7320334b9ull,
+    0x19d971e4fe8401e7ull,
+    0x1027e72f1f128130ull,
+    0x1431e0fae6d7217cull,
+    0x193e5939a08ce9dbull,
+    0x1f8def8808b02452ull,
+    0x13b8b5b5056e16b3ull,
+    0x18a6e32246c99c60ull,
+    0x1ed09bead87c0378ull,
+    0x13426172c74d822bull,
+    0x1812f9cf7920e2b6ull,
+    0x1e17b84357691b64ull,
+    0x12ced32a16a1b11eull,
+    0x178287f49c4a1d66ull,
+    0x1d6329f1c35ca4bfull,
+    0x125dfa371a19e6f7ull,
+    0x16f578c4e0a060b5ull,
+    0x1cb2d6f618c878e3ull,
+    0x11efc659cf7d4b8dull,
+    0x166bb7f0435c9e71ull,
+    0x1c06a5ec5433c60dull,
+    0x118427b3b4a05bc8ull,
+};
+
+// floor(2^(Pow5Bits(q) - 1 + 59) / 5^q) + 1, for the positive exponent case.
+constexpr uint64_t kPow5InverseSplit[31] = {
+    0x0800000000000001ull,
+    0x0666666666666667ull,
+    0x051eb851eb851eb9ull,
+    0x04189374bc6a7efaull,
+    0x068db8bac710cb2aull,
+    0x053e2d6238da3c22ull,
+    0x0431bde82d7b634eull,
+    0x06b5fca6af2bd216ull,
+    0x055e63b88c230e78ull,
+    0x044b82fa09b5a52dull,
+    0x06df37f675ef6eaeull,
+    0x057f5ff85e592558ull,
+    0x0465e6604b7a8447ull,
+    0x0709709a125da071ull,
+    0x05a126e1a84ae6c1ull,
+    0x0480ebe7b9d58567ull,
+    0x0734aca5f6226f0bull,
+    0x05c3bd5191b525a3ull,
+    0x049c97747490eae9ull,
+    0x0760f253edb4ab0eull,
+    0x05e72843249088d8ull,
+    0x04b8ed0283a6d3e0ull,
+    0x078e480405d7b966ull,
+    0x060b6cd004ac9452ull,
+    0x04d5f0a66a23a9dbull,
+    0x07bcb43d769f762bull,
+    0x063090312bb2c4efull,
+    0x04f3a68dbc8f03f3ull,
+    0x07ec3daf94180651ull,
+    0x065697bfa9acd1daull,
+    0x051212ffbaf0a7e2ull,
+};
+
+// Returns the number of bits in 5^e, for 0 <= e <= 3528.
+constexpr int32_t Pow5Bits(int32_t e) {
+  return static_cast<int32_t>((static_cast<uint32_t>(e) * 1217359) >> 19) + 1;
+}
+
+// Returns floor(log10(2^e)), for 0 <= e <= 1650.
+constexpr uint32_t Log10Pow2(int32_t e) {
+  return (static_cast<uint32_t>(e) * 78913) >> 18;
+}
+
+// Returns floor(log10(5^e)), for 0 <= e <= 2620.
+constexpr uint32_t Log10Pow5(int32_t e) {
+  return (static_cast<uint32_t>(e) * 732923) >> 20;
+}
+
+bool IsMultipleOfPowerOf5(uint32_t value, uint32_t power) {
+  uint32_t count = 0;
+  while (value % 5 == 0u) {
+    value /= 5;
+    count += 1;
+  }
+  return count >= power;
+}
+
+constexpr bool IsMultipleOfPowerOf2(uint32_t value, uint32_t power) {
+  return (value & ((1u << power) - 1)) == 0u;
+}
+
+// Returns (m * factor) >> shift, where shift > 32. Only 32x32-bit
+// multiplications are needed, which is important on 32-bit MCUs.
+constexpr uint32_t MulShift(uint32_t m, uint64_t factor, int32_t shift) {
+  const uint64_t low = static_cast<uint64_t>(m) * static_cast<uint32_t>(factor);
+  const uint64_t high = static_cast<uint64_t>(m) * (factor >> 32);
+  return static_cast<uint32_t>(((low >> 32) + high) >> (shift - 32));
+}
+
+struct DecimalFloat {
+  uint32_t digits;   // The shortest decimal significand, with no trailing 0s.
+  int32_t exponent;  // The base 10 exponent.
+};
+
+// Converts a finite, nonzero float from its IEEE 754 bits to the shortest
+// decimal that rounds back to it.
+DecimalFloat ShortestDecimal(uint32_t ieee_mantissa, uint32_t ieee_exponent) {
+  // Decode the float as m2 * 2^e2. e2 is 2 smaller than the true exponent so
+  // that the halfway points to the neighboring floats are integers.
+  int32_t e2;
+  uint32_t m2;
+  if (ieee_exponent == 0u) {
+    e2 = 1 - kFloatExponentBias - kFloatMantissaBits - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = static_cast<int32_t>(ieee_exponent) - kFloatExponentBias -
+         kFloatMantissaBits - 2;
+    m2 = (1u << kFloatMantissaBits) | ieee_mantissa;
+  }
+  const bool accept_bounds = (m2 & 1u) == 0u;
+
+  // The value, and the halfway points to the next float up and down (mp and
+  // mm). The gap below is smaller at powers of 2.
+  const uint32_t mv = 4 * m2;
+  const uint32_t mp = 4 * m2 + 2;
+  const uint32_t mm_shift = ieee_mantissa != 0u || ieee_exponent <= 1u;
+  const uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+  // Convert all three to decimal, as vr * 10^e10 etc.
+  uint32_t vr, vp, vm;
+  int32_t e10;
+  bool vm_is_trailing_zeros = false;
+  bool vr_is_trailing_zeros = false;
+  uint32_t last_removed_digit = 0;
+
+  if (e2 >= 0) {
+    const uint32_t q = Log10Pow2(e2);
+    e10 = static_cast<int32_t>(q);
+    const int32_t k = kPow5InverseBitCount + Pow5Bits(q) - 1;
+    const int32_t i = -e2 + static_cast<int32_t>(q) + k;
+    vr = MulShift(mv, kPow5InverseSplit[q], i);
+    vp = MulShift(mp, kPow5InverseSplit[q], i);
+    vm = MulShift(mm, kPow5InverseSplit[q], i);
+
+    if (q != 0u && (vp - 1) / 10 <= vm / 10) {
+      // One digit is removed below at most, so compute the digit it drops,
+      // which is needed for rounding.
+      const int32_t l = kPow5InverseBitCount + Pow5Bits(q - 1) - 1;
+      last_removed_digit =
+          MulShift(mv, kPow5InverseSplit[q - 1], -e2 + q - 1 + l) % 10;
+    }
+    if (q <= 9u) {
+      // Only one of mp, mv, and mm can be a multiple of 5, if any.
+      if (mv % 5 == 0u) {
+        vr_is_trailing_zeros = IsMultipleOfPowerOf5(mv, q);
+      } else if (accept_bounds) {
+        vm_is_trailing_zeros = IsMultipleOfPowerOf5(mm, q);
+      } else {
+        vp -= IsMultipleOfPowerOf5(mp, q);
+      }
+    }
+  } else {
+    const uint32_t q = Log10Pow5(-e2);
+    e10 = static_cast<int32_t>(q) + e2;
+    const int32_t i = -e2 - static_cast<int32_t>(q);
+    const int32_t k = Pow5Bits(i) - kPow5BitCount;
+    int32_t j = static_cast<int32_t>(q) - k;
+    vr = MulShift(mv, kPow5Split[i], j);
+    vp = MulShift(mp, kPow5Split[i], j);
+    vm = MulShift(mm, kPow5Split[i], j);
+
+    if (q != 0u && (vp - 1) / 10 <= vm / 10) {
+      j = static_cast<int32_t>(q) - 1 - (Pow5Bits(i + 1) - kPow5BitCount);
+      last_removed_digit = MulShift(mv, kPow5Split[i + 1], j) % 10;
+    }
+    if (q <= 1u) {
+      // mv has at least q trailing 0 bits, so vr has at least q trailing 0s.
+      vr_is_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_is_trailing_zeros = mm_shift == 1u;
+      } else {
+        vp -= 1;
+      }
+    } else if (q < 31u) {
+      vr_is_trailing_zeros = IsMultipleOfPowerOf2(mv, q - 1);
+    }
+  }
+
+  // Remove digits while vp and vm still differ, which finds the shortest
+  // representation in the interval.
+  int32_t removed = 0;
+  uint32_t output;
+  if (vm_is_trailing_zeros || vr_is_trailing_zeros) {
+    // The rare case: handle exact halfway points and inclusive bounds.
+    while (vp / 10 > vm / 10) {
+      vm_is_trailing_zeros &= vm % 10 == 0u;
+      vr_is_trailing_zeros &= last_removed_digit == 0u;
+      last_removed_digit = vr % 10;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed += 1;
+    }
+    if (vm_is_trailing_zeros) {
+      while (vm % 10 == 0u) {
+        vr_is_trailing_zeros &= last_removed_digit == 0u;
+        last_removed_digit = vr % 10;
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        removed += 1;
+      }
+    }
+    if (vr_is_trailing_zeros && last_removed_digit == 5u && vr % 2 == 0u) {
+      last_removed_digit = 4;  // Round half to even.
+    }
+    output = vr + ((vr == vm && (!accept_bounds || !vm_is_trailing_zeros)) ||
+                   last_removed_digit >= 5u);
+  } else {
+    // The common case.
+    while (vp / 10 > vm / 10) {
+      last_removed_digit = vr % 10;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed += 1;
+    }
+    output = vr + (vr == vm || last_removed_digit >= 5u);
+  }
+
+  // The interval search can leave trailing 0s, e.g. for 1e10.
+  int32_t exponent = e10 + removed;
+  while (output % 10 == 0u) {
+    output /= 10;
+    exponent += 1;
+  }
+  return {output, exponent};
+}
+
 }  // namespace
 
 uint_fast8_t DecimalDigitCount(uint64_t integer) {
@@ -101,10 +385,15 @@ StatusWithSize IntToString(uint64_t value, std::span<char> buffer) {
       value /= max_uint32_base_power;
     }
 
-    // Write the specified number of digits, with leading 0s.
-    for (uint_fast8_t i = 0; i < digit_count; ++i) {
+    // Write the specified number of digits, with leading 0s, two at a time.
+    for (; digit_count >= 2u; digit_count -= 2) {
+      const char* pair = &kDigitPairs[2 * (lower_digits % (base * base))];
+      buffer[--remaining] = pair[1];
+      buffer[--remaining] = pair[0];
+      lower_digits /= base * base;
+    }
+    if (digit_count != 0u) {
       buffer[--remaining] = lower_digits % base + '0';
-      lower_digits /= base;
     }
   }
   return StatusWithSize(total_digits);
@@ -169,6 +458,82 @@ StatusWithSize FloatAsIntToString(float value, std::span<char> buffer) {
   return HandleExhaustedBuffer(buffer);
 }
 
+StatusWithSize FloatToString(float value, std::span<char> buffer) {
+  if (!std::isfinite(value)) {
+    return FloatAsIntToString(value, buffer);
+  }
+
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint32_t ieee_mantissa = bits & ((1u << kFloatMantissaBits) - 1);
+  const uint32_t ieee_exponent =
+      (bits >> kFloatMantissaBits) & ((1u << kFloatExponentBits) - 1);
+
+  // The longest string is 15 characters, e.g. "-1.23456789e-38".
+  std::array<char, 16> text;
+  size_t size = 0;
+  if (std::signbit(value)) {
+    text[size++] = '-';
+  }
+
+  if (ieee_mantissa == 0u && ieee_exponent == 0u) {
+    text[size++] = '0';
+    return CopyEntireStringOrNull(std::string_view(text.data(), size), buffer);
+  }
+
+  const DecimalFloat decimal = ShortestDecimal(ieee_mantissa, ieee_exponent);
+
+  // Write the significand's digits, then move them into place.
+  char digits[10];
+  const size_t digit_count =
+      IntToString<uint64_t>(decimal.digits, digits).size();
+  const int32_t exponent = static_cast<int32_t>(digit_count) - 1 +
+                           decimal.exponent;  // As in d.ddd * 10^exponent
+
+  if (exponent < -4 || exponent >= 9) {
+    // Scientific notation, like %g: d.ddde+XX.
+    text[size++] = digits[0];
+    if (digit_count > 1u) {
+      text[size++] = '.';
+      std::memcpy(&text[size], &digits[1], digit_count - 1);
+      size += digit_count - 1;
+    }
+    text[size++] = 'e';
+    text[size++] = exponent < 0 ? '-' : '+';
+    const int32_t exponent_abs = std::abs(exponent);
+    text[size++] = kDigitPairs[2 * exponent_abs];
+    text[size++] = kDigitPairs[2 * exponent_abs + 1];
+  } else if (exponent < 0) {
+    // 0.000ddd
+    text[size++] = '0';
+    text[size++] = '.';
+    for (int32_t i = -1; i > exponent; --i) {
+      text[size++] = '0';
+    }
+    std::memcpy(&text[size], digits, digit_count);
+    size += digit_count;
+  } else if (static_cast<size_t>(exponent) + 1 >= digit_count) {
+    // An integer: ddd000
+    std::memcpy(&text[size], digits, digit_count);
+    size += digit_count;
+    for (size_t i = digit_count; i <= static_cast<size_t>(exponent); ++i) {
+      text[size++] = '0';
+    }
+  } else {
+    // ddd.ddd
+    const size_t integer_digits = exponent + 1;
+    std::memcpy(&text[size], digits, integer_digits);
+    size += integer_digits;
+    text[size++] = '.';
+    std::memcpy(&text[size],
+                &digits[integer_digits],
+                digit_count - integer_digits);
+    size += digit_count - integer_digits;
+  }
+
+  return CopyEntireStringOrNull(std::string_view(text.data(), size), buffer);
+}
+
 StatusWithSize BoolToString(bool value, std::span<char> buffer) {
   return CopyEntireStringOrNull(value ? "true" : "false", buffer);
 }
@@ -407,6 +407,79 @@ TEST_F(FloatAsIntToStringTest, TooSmall_NaN_NullTerminates) {
   EXPECT_STREQ("", buffer_);
 }
 
+class FloatToStringTest : public TestWithBuffer {};
+
+TEST_F(FloatToStringTest, Zero) {
+  EXPECT_EQ(1u, FloatToString(0.0f, buffer_).size());
+  EXPECT_STREQ("0", buffer_);
+  EXPECT_EQ(2u, FloatToString(-0.0f, buffer_).size());
+  EXPECT_STREQ("-0", buffer_);
+}
+
+TEST_F(FloatToStringTest, Integers_NoDecimalPoint) {
+  EXPECT_EQ(1u, FloatToString(1.0f, buffer_).size());
+  EXPECT_STREQ("1", buffer_);
+  EXPECT_EQ(4u, FloatToString(-250.0f, buffer_).size());
+  EXPECT_STREQ("-250", buffer_);
+  EXPECT_EQ(8u, FloatToString(16777216.0f, buffer_).size());
+  EXPECT_STREQ("16777216", buffer_);
+}
+
+TEST_F(FloatToStringTest, Fractions_ShortestRoundTrip) {
+  EXPECT_EQ(4u, FloatToString(1.25f, buffer_).size());
+  EXPECT_STREQ("1.25", buffer_);
+  EXPECT_EQ(3u, FloatToString(0.1f, buffer_).size());
+  EXPECT_STREQ("0.1", buffer_);
+  EXPECT_EQ(9u, FloatToString(3.1415927f, buffer_).size());
+  EXPECT_STREQ("3.1415927", buffer_);
+  EXPECT_EQ(11u, FloatToString(-0.33333334f, buffer_).size());
+  EXPECT_STREQ("-0.33333334", buffer_);
+  EXPECT_EQ(6u, FloatToString(0.0001f, buffer_).size());
+  EXPECT_STREQ("0.0001", buffer_);
+}
+
+TEST_F(FloatToStringTest, LargeAndSmall_ScientificNotation) {
+  EXPECT_EQ(5u, FloatToString(1e9f, buffer_).size());
+  EXPECT_STREQ("1e+09", buffer_);
+  EXPECT_EQ(7u, FloatToString(3.5e20f, buffer_).size());
+  EXPECT_STREQ("3.5e+20", buffer_);
+  EXPECT_EQ(6u, FloatToString(-1e-5f, buffer_).size());
+  EXPECT_STREQ("-1e-05", buffer_);
+  EXPECT_EQ(13u,
+            FloatToString(std::numeric_limits<float>::max(), buffer_).size());
+  EXPECT_STREQ("3.4028235e+38", buffer_);
+  EXPECT_EQ(5u,
+            FloatToString(std::numeric_limits<float>::denorm_min(), buffer_)
+                .size());
+  EXPECT_STREQ("1e-45", buffer_);
+}
+
+TEST_F(FloatToStringTest, InfinityAndNan) {
+  EXPECT_EQ(4u, FloatToString(-INFINITY, buffer_).size());
+  EXPECT_STREQ("-inf", buffer_);
+  EXPECT_EQ(3u, FloatToString(NAN, buffer_).size());
+  EXPECT_STREQ("NaN", buffer_);
+}
+
+TEST_F(FloatToStringTest, ExactFit) {
+  EXPECT_EQ(4u, FloatToString(1.25f, std::span(buffer_, 5)).size());
+  EXPECT_STREQ("1.25", buffer_);
+}
+
+TEST_F(FloatToStringTest, TooSmall_NullTerminates) {
+  auto result = FloatToString(1.25f, std::span(buffer_, 4));
+  EXPECT_EQ(0u, result.size());
+  EXPECT_FALSE(result.ok());
+  EXPECT_STREQ("", buffer_);
+}
+
+TEST_F(FloatToStringTest, EmptyBuffer_WritesNothing) {
+  auto result = FloatToString(1.25f, std::span(buffer_, 0));
+  EXPECT_EQ(0u, result.size());
+  EXPECT_FALSE(result.ok());
+  EXPECT_STREQ(kStartingString, buffer_);
+}
+
 class CopyStringOrNullTest : public TestWithBuffer {};
 
 using namespace std::literals::string_view_literals;
@@ -0,0 +1,65 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/instrumented_mutex.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace pw::sync {
+namespace {
+
+uint32_t ToMicroseconds(chrono::SystemClock::duration duration) {
+  const auto us =
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+  if (us <= 0) {
+    return 0;
+  }
+  if (static_cast<uint64_t>(us) > std::numeric_limits<uint32_t>::max()) {
+    return std::numeric_limits<uint32_t>::max();
+  }
+  return static_cast<uint32_t>(us);
+}
+
+uint32_t SaturatingAdd(uint32_t a, uint32_t b) {
+  const uint32_t sum = a + b;
+  return sum < a ? std::numeric_limits<uint32_t>::max() : sum;
+}
+
+}  // namespace
+
+void LockMetrics::Acquired() {
+  acquisitions_.Increment();
+  acquired_at_ = chrono::SystemClock::now();
+}
+
+void LockMetrics::AcquiredAfterWait(
+    chrono::SystemClock::time_point wait_start) {
+  acquired_at_ = chrono::SystemClock::now();
+  acquisitions_.Increment();
+  contended_acquisitions_.Increment();
+
+  const uint32_t wait_us = ToMicroseconds(acquired_at_ - wait_start);
+  total_wait_us_.Set(SaturatingAdd(total_wait_us_.value(), wait_us));
+  max_wait_us_.Set(std::max(max_wait_us_.value(), wait_us));
+}
+
+void LockMetrics::Releasing() {
+  const uint32_t hold_us =
+      ToMicroseconds(chrono::SystemClock::now() - acquired_at_);
+  max_hold_us_.Set(std::max(max_hold_us_.value(), hold_us));
+}
+
+}  // namespace pw::sync
@@ -0,0 +1,94 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/instrumented_mutex.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "gtest/gtest.h"
+#include "pw_chrono/system_clock.h"
+
+using namespace std::chrono_literals;
+
+namespace pw::sync {
+namespace {
+
+// TODO(pwbug/291): Add real concurrency tests.
+
+constexpr metric::Token kLockName = 0x4c6f636b;
+
+void BusyWait(chrono::SystemClock::duration duration) {
+  const auto deadline = chrono::SystemClock::TimePointAfterAtLeast(duration);
+  while (chrono::SystemClock::now() < deadline) {
+  }
+}
+
+TEST(InstrumentedMutex, InitialState) {
+  InstrumentedMutex mutex(kLockName);
+  const LockMetrics& metrics = mutex.lock_metrics();
+  EXPECT_EQ(metrics.acquisitions(), 0u);
+  EXPECT_EQ(metrics.contended_acquisitions(), 0u);
+  EXPECT_EQ(metrics.total_wait_us(), 0u);
+  EXPECT_EQ(metrics.max_wait_us(), 0u);
+  EXPECT_EQ(metrics.max_hold_us(), 0u);
+  EXPECT_EQ(mutex.metrics().name(), kLockName);
+}
+
+TEST(InstrumentedMutex, CountsUncontendedAcquisitions) {
+  InstrumentedMutex mutex(kLockName);
+  mutex.lock();
+  mutex.unlock();
+  {
+    std::lock_guard lock(mutex);
+  }
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+
+  EXPECT_EQ(mutex.lock_metrics().acquisitions(), 3u);
+  EXPECT_EQ(mutex.lock_metrics().contended_acquisitions(), 0u);
+  EXPECT_EQ(mutex.lock_metrics().total_wait_us(), 0u);
+}
+
+TEST(InstrumentedMutex, RecordsMaxHoldTime) {
+  InstrumentedMutex mutex(kLockName);
+  mutex.lock();
+  BusyWait(2ms);
+  mutex.unlock();
+  EXPECT_GE(mutex.lock_metrics().max_hold_us(), 2000u);
+
+  // A shorter hold does not lower the maximum.
+  const uint32_t max_hold_us = mutex.lock_metrics().max_hold_us();
+  mutex.lock();
+  mutex.unlock();
+  EXPECT_EQ(mutex.lock_metrics().max_hold_us(), max_hold_us);
+}
+
+TEST(InstrumentedMutex, MetricsAreInGroup) {
+  InstrumentedMutex mutex(kLockName);
+  EXPECT_EQ(mutex.metrics().metrics().size(), 5u);
+}
+
+TEST(InstrumentedTimedMutex, UncontendedTryLockFor) {
+  InstrumentedTimedMutex mutex(kLockName);
+  ASSERT_TRUE(mutex.try_lock_for(1ms));
+  mutex.unlock();
+  ASSERT_TRUE(mutex.try_lock_until(chrono::SystemClock::now()));
+  mutex.unlock();
+  EXPECT_EQ(mutex.lock_metrics().acquisitions(), 2u);
+  EXPECT_EQ(mutex.lock_metrics().contended_acquisitions(), 0u);
+}
+
+}  // namespace
+}  // namespace pw::sync
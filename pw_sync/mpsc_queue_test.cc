@@ -0,0 +1,112 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/mpsc_queue.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::sync {
+namespace {
+
+// TODO(pwbug/291): Add real concurrency tests.
+
+TEST(MpscQueue, EmptyInitialState) {
+  MpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.size(), 0u);
+  EXPECT_EQ(queue.capacity(), 4u);
+
+  int item = 123;
+  EXPECT_FALSE(queue.try_pop(item));
+  EXPECT_EQ(item, 123);
+}
+
+TEST(MpscQueue, PushPopInOrder) {
+  MpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_TRUE(queue.try_push(3));
+  EXPECT_EQ(queue.size(), 3u);
+
+  int item = 0;
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 1);
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 2);
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 3);
+  EXPECT_FALSE(queue.try_pop(item));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, Full) {
+  MpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  EXPECT_FALSE(queue.try_push(4));
+  EXPECT_EQ(queue.size(), 4u);
+
+  int item = -1;
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 0);
+  EXPECT_TRUE(queue.try_push(4));
+  EXPECT_FALSE(queue.try_push(5));
+
+  for (int expected = 1; expected <= 4; ++expected) {
+    EXPECT_TRUE(queue.try_pop(item));
+    EXPECT_EQ(item, expected);
+  }
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, WrapsAround) {
+  MpscQueue<uint16_t, 8> queue;
+  uint16_t next_push = 0;
+  uint16_t next_pop = 0;
+
+  // Keep the queue partly full while the slots are reused many times.
+  for (int cycle = 0; cycle < 100; ++cycle) {
+    while (queue.try_push(next_push)) {
+      next_push += 1;
+    }
+    for (int i = 0; i < 5; ++i) {
+      uint16_t item;
+      ASSERT_TRUE(queue.try_pop(item));
+      ASSERT_EQ(item, next_pop);
+      next_pop += 1;
+    }
+  }
+  EXPECT_EQ(queue.size(), 3u);
+}
+
+TEST(MpscQueue, SmallestCapacity) {
+  MpscQueue<int, 2> queue;
+  int item = 0;
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+    EXPECT_TRUE(queue.try_push(i + 100));
+    EXPECT_FALSE(queue.try_push(i));
+    EXPECT_TRUE(queue.try_pop(item));
+    EXPECT_EQ(item, i);
+    EXPECT_TRUE(queue.try_pop(item));
+    EXPECT_EQ(item, i + 100);
+    EXPECT_FALSE(queue.try_pop(item));
+  }
+}
+
+}  // namespace
+}  // namespace pw::sync
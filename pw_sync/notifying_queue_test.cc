@@ -0,0 +1,68 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/notifying_queue.h"
+
+#include "gtest/gtest.h"
+
+namespace pw::sync {
+namespace {
+
+// TODO(pwbug/291): Add real concurrency tests.
+
+TEST(NotifyingQueue, SpscPushPop) {
+  NotifyingQueue<SpscQueue<int, 4>> queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_EQ(queue.size(), 2u);
+
+  // The items are available, so pop() does not block.
+  EXPECT_EQ(queue.pop(), 1);
+  EXPECT_EQ(queue.pop(), 2);
+
+  int item = 0;
+  EXPECT_FALSE(queue.try_pop(item));
+}
+
+TEST(NotifyingQueue, MpscPushPop) {
+  NotifyingQueue<MpscQueue<int, 2>> queue;
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_FALSE(queue.try_push(3));
+
+  EXPECT_EQ(queue.pop(), 1);
+
+  int item = 0;
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 2);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(NotifyingQueue, StaleNotificationDoesNotReturnEarly) {
+  NotifyingQueue<SpscQueue<int, 4>> queue;
+
+  // Consume an item without blocking, which leaves the notification set.
+  EXPECT_TRUE(queue.try_push(1));
+  int item = 0;
+  EXPECT_TRUE(queue.try_pop(item));
+
+  // pop() consumes the stale notification, rechecks the queue, and only returns
+  // once an item is actually available.
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_EQ(queue.pop(), 2);
+}
+
+}  // namespace
+}  // namespace pw::sync
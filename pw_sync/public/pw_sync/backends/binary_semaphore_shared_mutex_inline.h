@@ -0,0 +1,68 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <mutex>
+
+#include "pw_sync/shared_mutex.h"
+
+namespace pw::sync {
+
+inline SharedMutex::SharedMutex() : native_type_() {}
+
+inline SharedMutex::~SharedMutex() {}
+
+inline void SharedMutex::lock() { native_type_.writer_semaphore.acquire(); }
+
+inline bool SharedMutex::try_lock() {
+  return native_type_.writer_semaphore.try_acquire();
+}
+
+inline void SharedMutex::unlock() { native_type_.writer_semaphore.release(); }
+
+inline void SharedMutex::lock_shared() {
+  std::lock_guard lock(native_type_.reader_count_mutex);
+  if (native_type_.reader_count == 0u) {
+    // Readers hold the lock as a group; later readers only count themselves.
+    native_type_.writer_semaphore.acquire();
+  }
+  native_type_.reader_count += 1;
+}
+
+inline bool SharedMutex::try_lock_shared() {
+  if (!native_type_.reader_count_mutex.try_lock()) {
+    return false;
+  }
+  std::lock_guard lock(native_type_.reader_count_mutex, std::adopt_lock);
+  if (native_type_.reader_count == 0u &&
+      !native_type_.writer_semaphore.try_acquire()) {
+    return false;
+  }
+  native_type_.reader_count += 1;
+  return true;
+}
+
+inline void SharedMutex::unlock_shared() {
+  std::lock_guard lock(native_type_.reader_count_mutex);
+  native_type_.reader_count -= 1;
+  if (native_type_.reader_count == 0u) {
+    native_type_.writer_semaphore.release();
+  }
+}
+
+inline SharedMutex::native_handle_type SharedMutex::native_handle() {
+  return native_type_;
+}
+
+}  // namespace pw::sync
@@ -0,0 +1,42 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::sync::backend {
+
+// A shared mutex built from a Mutex and a BinarySemaphore, for platforms
+// without a native reader-writer lock. The semaphore is held by the writer, or
+// on behalf of all readers by the first reader. The mutex protects the count
+// of readers.
+//
+// Readers are preferred: while any reader holds the lock, new readers are
+// admitted even if a writer is waiting. The semaphore is used instead of a
+// mutex since it may be released by a different reader than the one that
+// acquired it, so writers do not get priority inheritance.
+struct NativeSharedMutex {
+  NativeSharedMutex() : reader_count(0) { writer_semaphore.release(); }
+
+  Mutex reader_count_mutex;
+  size_t reader_count PW_GUARDED_BY(reader_count_mutex);
+  BinarySemaphore writer_semaphore;
+};
+
+using NativeSharedMutexHandle = NativeSharedMutex&;
+
+}  // namespace pw::sync::backend
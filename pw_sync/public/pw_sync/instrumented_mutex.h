@@ -0,0 +1,163 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_metric/metric.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/timed_mutex.h"
+
+namespace pw::sync {
+
+// Contention statistics for one lock, recorded as a pw_metric group:
+//
+//   acquisitions            Number of times the lock was acquired.
+//   contended_acquisitions  Acquisitions that had to wait for another owner.
+//   total_wait_us           Total time spent waiting, in microseconds.
+//   max_wait_us             Longest single wait, in microseconds.
+//   max_hold_us             Longest time the lock was held, in microseconds.
+//
+// The times saturate at UINT32_MAX. All updates are made while the lock is
+// held, so the metrics need no synchronization of their own.
+class LockMetrics {
+ public:
+  explicit LockMetrics(metric::Token name) : group_(name) {}
+
+  LockMetrics(const LockMetrics&) = delete;
+  LockMetrics& operator=(const LockMetrics&) = delete;
+
+  metric::Group& group() { return group_; }
+  const metric::Group& group() const { return group_; }
+
+  uint32_t acquisitions() const { return acquisitions_.value(); }
+  uint32_t contended_acquisitions() const {
+    return contended_acquisitions_.value();
+  }
+  uint32_t total_wait_us() const { return total_wait_us_.value(); }
+  uint32_t max_wait_us() const { return max_wait_us_.value(); }
+  uint32_t max_hold_us() const { return max_hold_us_.value(); }
+
+  // Records an acquisition that did not wait. Must be called with the lock
+  // held.
+  void Acquired();
+
+  // Records an acquisition that waited since wait_start. Must be called with
+  // the lock held.
+  void AcquiredAfterWait(chrono::SystemClock::time_point wait_start);
+
+  // Records the hold time. Must be called before the lock is released.
+  void Releasing();
+
+ private:
+  metric::Group group_;
+  PW_METRIC(group_, acquisitions_, "acquisitions", 0u);
+  PW_METRIC(group_, contended_acquisitions_, "contended_acquisitions", 0u);
+  PW_METRIC(group_, total_wait_us_, "total_wait_us", 0u);
+  PW_METRIC(group_, max_wait_us_, "max_wait_us", 0u);
+  PW_METRIC(group_, max_hold_us_, "max_hold_us", 0u);
+
+  chrono::SystemClock::time_point acquired_at_;
+};
+
+// InstrumentedLock wraps a Mutex or TimedMutex and records how often it is
+// contended, how long threads wait for it, and how long it is held. It has the
+// same API as the wrapped lock, so it can replace a lock to find out whether it
+// hurts latency, then be swapped back:
+//
+//   class LogQueue {
+//     ...
+//    private:
+//     pw::sync::InstrumentedMutex lock_{
+//         PW_TOKENIZE_STRING_DOMAIN("metrics", "log_queue_lock")};
+//   };
+//
+//   parent_metrics.Add(log_queue.lock_.metrics());
+//
+// Each acquisition first tries to take the lock without blocking. Only if that
+// fails is the lock counted as contended and the wait timed, so an uncontended
+// acquisition reads the clock once and a contended one twice. The name is the
+// token of the metric group; use PW_TOKENIZE_STRING_DOMAIN("metrics", ...) so
+// the name is detokenized with the other metrics.
+template <typename Lock>
+class PW_LOCKABLE("pw::sync::InstrumentedLock") InstrumentedLock {
+ public:
+  explicit InstrumentedLock(metric::Token name) : metrics_(name) {}
+
+  InstrumentedLock(const InstrumentedLock&) = delete;
+  InstrumentedLock& operator=(const InstrumentedLock&) = delete;
+
+  void lock() PW_EXCLUSIVE_LOCK_FUNCTION() PW_NO_LOCK_SAFETY_ANALYSIS {
+    if (lock_.try_lock()) {
+      metrics_.Acquired();
+      return;
+    }
+    const auto wait_start = chrono::SystemClock::now();
+    lock_.lock();
+    metrics_.AcquiredAfterWait(wait_start);
+  }
+
+  bool try_lock() PW_EXCLUSIVE_TRYLOCK_FUNCTION(true)
+      PW_NO_LOCK_SAFETY_ANALYSIS {
+    if (!lock_.try_lock()) {
+      return false;
+    }
+    metrics_.Acquired();
+    return true;
+  }
+
+  // Only available if Lock is a TimedMutex.
+  bool try_lock_for(chrono::SystemClock::duration for_at_least)
+      PW_EXCLUSIVE_TRYLOCK_FUNCTION(true) PW_NO_LOCK_SAFETY_ANALYSIS {
+    return try_lock_until(
+        chrono::SystemClock::TimePointAfterAtLeast(for_at_least));
+  }
+
+  // Only available if Lock is a TimedMutex.
+  bool try_lock_until(chrono::SystemClock::time_point until_at_least)
+      PW_EXCLUSIVE_TRYLOCK_FUNCTION(true) PW_NO_LOCK_SAFETY_ANALYSIS {
+    if (lock_.try_lock()) {
+      metrics_.Acquired();
+      return true;
+    }
+    const auto wait_start = chrono::SystemClock::now();
+    if (!lock_.try_lock_until(until_at_least)) {
+      return false;
+    }
+    metrics_.AcquiredAfterWait(wait_start);
+    return true;
+  }
+
+  void unlock() PW_UNLOCK_FUNCTION() PW_NO_LOCK_SAFETY_ANALYSIS {
+    metrics_.Releasing();
+    lock_.unlock();
+  }
+
+  // The metric group, to add to a parent group or dump.
+  metric::Group& metrics() { return metrics_.group(); }
+
+  // The recorded statistics. These are only consistent while the lock is held.
+  const LockMetrics& lock_metrics() const { return metrics_; }
+
+ private:
+  Lock lock_;
+  LockMetrics metrics_;
+};
+
+using InstrumentedMutex = InstrumentedLock<Mutex>;
+using InstrumentedTimedMutex = InstrumentedLock<TimedMutex>;
+
+}  // namespace pw::sync
@@ -0,0 +1,149 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace pw::sync {
+
+// The MpscQueue is a lock-free, fixed-capacity queue for passing items from
+// MULTIPLE producers to a SINGLE consumer. Producers may be any mix of threads
+// and interrupt handlers.
+//
+// IMPORTANT: try_pop must only be called from one consumer context at a time.
+//
+// Each slot has a sequence number that tells producers and the consumer whose
+// turn it is to use the slot. A producer claims a slot with a compare-and-swap
+// on the tail index, writes the item, then publishes it by advancing the slot's
+// sequence number. No locks are taken and interrupts are not masked, so a
+// producer that is preempted while writing an item never blocks other
+// producers. However, the consumer cannot pop past a claimed slot until that
+// item is published; until then try_pop returns false as if the queue were
+// empty.
+//
+// The MpscQueue requires an atomic compare-and-swap instruction, such as
+// LDREX/STREX on ARMv7-M. On cores without one, such as ARMv6-M, use an
+// SpscQueue per producer or a queue protected by an InterruptSpinLock.
+//
+// kCapacity must be a power of two of at least 2. T must be default
+// constructible and move assignable; items are stored by value in the queue.
+template <typename T, size_t kCapacity>
+class MpscQueue {
+ public:
+  // With one slot, a published item and a free slot would have the same
+  // sequence number.
+  static_assert(kCapacity >= 2u && (kCapacity & (kCapacity - 1)) == 0u,
+                "The MpscQueue capacity must be a power of two, at least 2");
+  static_assert(std::atomic<size_t>::is_always_lock_free,
+                "The MpscQueue requires lock-free atomics");
+
+  using value_type = T;
+
+  MpscQueue() : head_(0), tail_(0) {
+    for (size_t i = 0; i < kCapacity; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Adds an item to the back of the queue. Returns false if the queue is full.
+  //
+  // This is IRQ and thread safe.
+  bool try_push(const T& item) { return Emplace(item); }
+  bool try_push(T&& item) { return Emplace(std::move(item)); }
+
+  // Moves the item at the front of the queue into item. Returns false if the
+  // queue is empty or the front item is still being written, in which case
+  // item is not modified.
+  //
+  // IMPORTANT: This should only be used by a single consumer.
+  bool try_pop(T& item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[head & kIndexMask];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+      return false;
+    }
+    item = std::move(slot.item);
+
+    // Hand the slot back to producers for the next lap around the queue.
+    slot.sequence.store(head + kCapacity, std::memory_order_release);
+    head_.store(head + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // The number of items in the queue, including items that producers have
+  // claimed but not yet finished writing. This is a snapshot; if a producer or
+  // the consumer is active, the size may already have changed when this
+  // returns.
+  size_t size() const {
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    // The consumer may pop items between the two loads.
+    return tail > head ? tail - head : 0u;
+  }
+
+  bool empty() const { return size() == 0u; }
+
+  static constexpr size_t capacity() { return kCapacity; }
+
+ private:
+  static constexpr size_t kIndexMask = kCapacity - 1;
+
+  // A slot's sequence number is its index for the current lap while it is free,
+  // and its index + 1 once it holds an item for that lap.
+  struct Slot {
+    std::atomic<size_t> sequence;
+    T item;
+  };
+
+  template <typename U>
+  bool Emplace(U&& item) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    while (true) {
+      slot = &slots_[tail & kIndexMask];
+      const auto lag = static_cast<std::ptrdiff_t>(
+          slot->sequence.load(std::memory_order_acquire) - tail);
+
+      if (lag == 0) {  // The slot is free; try to claim it.
+        if (tail_.compare_exchange_weak(
+                tail, tail + 1, std::memory_order_relaxed)) {
+          break;
+        }
+        // Another producer claimed it first; tail was updated, so retry.
+      } else if (lag < 0) {
+        // The slot is still in use from the previous lap, so the queue is full.
+        return false;
+      } else {
+        tail = tail_.load(std::memory_order_relaxed);  // Fell behind; reload.
+      }
+    }
+
+    slot->item = std::forward<U>(item);
+    slot->sequence.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  std::atomic<size_t> head_;  // Only written by the consumer.
+  std::atomic<size_t> tail_;  // Claimed by producers with compare-and-swap.
+  std::array<Slot, kCapacity> slots_;
+};
+
+}  // namespace pw::sync
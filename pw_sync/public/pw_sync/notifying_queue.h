@@ -0,0 +1,99 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+#include "pw_sync/mpsc_queue.h"
+#include "pw_sync/spsc_queue.h"
+#include "pw_sync/thread_notification.h"
+
+namespace pw::sync {
+
+// The NotifyingQueue pairs a lock-free SpscQueue or MpscQueue with a
+// ThreadNotification, so that the consuming thread can block until an item is
+// available. Producers push without locks and release the notification, which
+// is IRQ safe. The consumer only blocks when the queue is empty.
+//
+// Since the notification latches, an item pushed between the consumer finding
+// the queue empty and blocking is never missed. The consumer rechecks the queue
+// after every wakeup, so one notification for several items is fine.
+//
+//   pw::sync::NotifyingQueue<pw::sync::SpscQueue<std::byte, 256>> rx_queue;
+//
+//   void UartRxInterrupt() { rx_queue.try_push(ReadRxRegister()); }
+//
+//   void RxThread() {
+//     while (true) {
+//       HandleByte(rx_queue.pop());
+//     }
+//   }
+//
+// The same producer and consumer restrictions apply as for the wrapped queue.
+// Since ThreadNotification only supports a single waiting thread, there must
+// only be one consumer.
+template <typename Queue>
+class NotifyingQueue {
+ public:
+  using value_type = typename Queue::value_type;
+
+  NotifyingQueue() = default;
+
+  NotifyingQueue(const NotifyingQueue&) = delete;
+  NotifyingQueue& operator=(const NotifyingQueue&) = delete;
+
+  // Adds an item and notifies the consumer. Returns false if the queue is full.
+  bool try_push(const value_type& item) {
+    return Notify(queue_.try_push(item));
+  }
+  bool try_push(value_type&& item) {
+    return Notify(queue_.try_push(std::move(item)));
+  }
+
+  // Blocks indefinitely until an item is available, then removes and returns
+  // it.
+  //
+  // IMPORTANT: This should only be used by a single consumer thread.
+  value_type pop() {
+    value_type item;
+    while (!queue_.try_pop(item)) {
+      notification_.acquire();
+    }
+    return item;
+  }
+
+  // Removes the front item without blocking. Returns false if the queue is
+  // empty.
+  //
+  // IMPORTANT: This should only be used by a single consumer.
+  bool try_pop(value_type& item) { return queue_.try_pop(item); }
+
+  size_t size() const { return queue_.size(); }
+  bool empty() const { return queue_.empty(); }
+  static constexpr size_t capacity() { return Queue::capacity(); }
+
+ private:
+  bool Notify(bool pushed) {
+    if (pushed) {
+      notification_.release();
+    }
+    return pushed;
+  }
+
+  Queue queue_;
+  ThreadNotification notification_;
+};
+
+}  // namespace pw::sync
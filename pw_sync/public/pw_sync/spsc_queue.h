@@ -0,0 +1,106 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace pw::sync {
+
+// The SpscQueue is a lock-free, fixed-capacity queue for passing items from a
+// SINGLE producer to a SINGLE consumer, such as from an interrupt handler to a
+// thread or between two threads.
+//
+// IMPORTANT: try_push must only be called from one producer context and
+// try_pop from one consumer context at a time. Use an MpscQueue if there are
+// multiple producers.
+//
+// Neither side ever blocks, masks interrupts, or takes a lock; each operation
+// is a few loads and one store to a std::atomic index. To let the consumer
+// block until items arrive, wrap the queue in a NotifyingQueue.
+//
+// kCapacity must be a power of two. T must be default constructible and
+// move assignable; items are stored by value in the queue.
+template <typename T, size_t kCapacity>
+class SpscQueue {
+ public:
+  static_assert(kCapacity > 0u && (kCapacity & (kCapacity - 1)) == 0u,
+                "The SpscQueue capacity must be a power of two");
+  static_assert(std::atomic<size_t>::is_always_lock_free,
+                "The SpscQueue requires lock-free atomics");
+
+  using value_type = T;
+
+  constexpr SpscQueue() : head_(0), tail_(0), items_{} {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  // Adds an item to the back of the queue. Returns false if the queue is full.
+  //
+  // IMPORTANT: This should only be used by a single producer.
+  bool try_push(const T& item) { return Emplace(item); }
+  bool try_push(T&& item) { return Emplace(std::move(item)); }
+
+  // Moves the item at the front of the queue into item. Returns false if the
+  // queue is empty, in which case item is not modified.
+  //
+  // IMPORTANT: This should only be used by a single consumer.
+  bool try_pop(T& item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    item = std::move(items_[head & kIndexMask]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // The number of items in the queue. This is a snapshot; if the other side is
+  // active, the size may already have changed when this returns.
+  size_t size() const {
+    const size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  bool empty() const { return size() == 0u; }
+  bool full() const { return size() >= kCapacity; }
+
+  static constexpr size_t capacity() { return kCapacity; }
+
+ private:
+  static constexpr size_t kIndexMask = kCapacity - 1;
+
+  template <typename U>
+  bool Emplace(U&& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+      return false;
+    }
+    items_[tail & kIndexMask] = std::forward<U>(item);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // The indices count up without wrapping to the capacity, so that a full
+  // queue can be told apart from an empty one. Unsigned overflow is harmless
+  // since the capacity is a power of two.
+  std::atomic<size_t> head_;  // Only written by the consumer.
+  std::atomic<size_t> tail_;  // Only written by the producer.
+  std::array<T, kCapacity> items_;
+};
+
+}  // namespace pw::sync
@@ -0,0 +1,88 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "gtest/gtest.h"
+#include "pw_sync/shared_mutex.h"
+
+namespace pw::sync {
+namespace {
+
+// TODO(pwbug/291): Add real concurrency tests once we have pw::thread.
+
+TEST(SharedMutex, LockUnlock) {
+  SharedMutex mutex;
+  mutex.lock();
+  // TODO(pwbug/291): Ensure it fails to lock when already held.
+  // EXPECT_FALSE(mutex.try_lock_shared());
+  mutex.unlock();
+}
+
+SharedMutex static_shared_mutex;
+TEST(SharedMutex, LockUnlockStatic) {
+  static_shared_mutex.lock();
+  static_shared_mutex.unlock();
+  static_shared_mutex.lock_shared();
+  static_shared_mutex.unlock_shared();
+}
+
+TEST(SharedMutex, TryLockUnlock) {
+  SharedMutex mutex;
+  const bool locked = mutex.try_lock();
+  EXPECT_TRUE(locked);
+  if (locked) {
+    mutex.unlock();
+  }
+}
+
+TEST(SharedMutex, LockSharedUnlockShared) {
+  SharedMutex mutex;
+  mutex.lock_shared();
+  mutex.unlock_shared();
+
+  // The mutex is available for exclusive locking once readers are done.
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(SharedMutex, TryLockSharedUnlockShared) {
+  SharedMutex mutex;
+  const bool locked = mutex.try_lock_shared();
+  EXPECT_TRUE(locked);
+  if (locked) {
+    mutex.unlock_shared();
+  }
+  ASSERT_TRUE(mutex.try_lock());
+  mutex.unlock();
+}
+
+TEST(SharedMutex, StdLockHelpers) {
+  SharedMutex mutex;
+  {
+    std::shared_lock lock(mutex);
+    EXPECT_TRUE(lock.owns_lock());
+  }
+  {
+    std::unique_lock lock(mutex);
+    EXPECT_TRUE(lock.owns_lock());
+  }
+  {
+    std::lock_guard lock(mutex);
+  }
+}
+
+}  // namespace
+}  // namespace pw::sync
@@ -0,0 +1,123 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_sync/spsc_queue.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+
+namespace pw::sync {
+namespace {
+
+// TODO(pwbug/291): Add real concurrency tests.
+
+TEST(SpscQueue, EmptyInitialState) {
+  SpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.full());
+  EXPECT_EQ(queue.size(), 0u);
+  EXPECT_EQ(queue.capacity(), 4u);
+
+  int item = 123;
+  EXPECT_FALSE(queue.try_pop(item));
+  EXPECT_EQ(item, 123);
+}
+
+TEST(SpscQueue, PushPopInOrder) {
+  SpscQueue<int, 4> queue;
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_TRUE(queue.try_push(3));
+  EXPECT_EQ(queue.size(), 3u);
+
+  int item = 0;
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 1);
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 2);
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 3);
+  EXPECT_FALSE(queue.try_pop(item));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueue, Full) {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  EXPECT_TRUE(queue.full());
+  EXPECT_FALSE(queue.try_push(4));
+
+  int item = -1;
+  EXPECT_TRUE(queue.try_pop(item));
+  EXPECT_EQ(item, 0);
+  EXPECT_FALSE(queue.full());
+  EXPECT_TRUE(queue.try_push(4));
+  EXPECT_FALSE(queue.try_push(5));
+  EXPECT_EQ(queue.size(), 4u);
+}
+
+TEST(SpscQueue, WrapsAround) {
+  SpscQueue<uint16_t, 8> queue;
+  uint16_t next_push = 0;
+  uint16_t next_pop = 0;
+
+  // Keep the queue partly full while the indices go around many times.
+  for (int cycle = 0; cycle < 100; ++cycle) {
+    while (queue.try_push(next_push)) {
+      next_push += 1;
+    }
+    for (int i = 0; i < 5; ++i) {
+      uint16_t item;
+      ASSERT_TRUE(queue.try_pop(item));
+      ASSERT_EQ(item, next_pop);
+      next_pop += 1;
+    }
+  }
+  EXPECT_EQ(queue.size(), 3u);
+}
+
+struct Entry {
+  uint32_t timestamp;
+  char data[12];
+};
+
+TEST(SpscQueue, StructItems) {
+  SpscQueue<Entry, 2> queue;
+  EXPECT_TRUE(queue.try_push(Entry{1, "hello"}));
+  EXPECT_TRUE(queue.try_push(Entry{2, "world"}));
+
+  Entry entry;
+  EXPECT_TRUE(queue.try_pop(entry));
+  EXPECT_EQ(entry.timestamp, 1u);
+  EXPECT_STREQ(entry.data, "hello");
+  EXPECT_TRUE(queue.try_pop(entry));
+  EXPECT_EQ(entry.timestamp, 2u);
+  EXPECT_STREQ(entry.data, "world");
+}
+
+SpscQueue<int, 16> static_queue;
+TEST(SpscQueue, Static) {
+  EXPECT_TRUE(static_queue.empty());
+  EXPECT_TRUE(static_queue.try_push(42));
+
+  int item = 0;
+  EXPECT_TRUE(static_queue.try_pop(item));
+  EXPECT_EQ(item, 42);
+}
+
+}  // namespace
+}  // namespace pw::sync
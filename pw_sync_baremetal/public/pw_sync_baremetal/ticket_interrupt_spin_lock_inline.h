@@ -0,0 +1,110 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/yield_core.h"
+
+namespace pw::sync {
+namespace backend {
+
+// On Cortex-M, interrupts are masked through PRIMASK while the lock is held.
+// Other architectures do not mask interrupts, which is only suitable for
+// testing the lock on a host.
+inline uint32_t MaskLocalInterrupts() {
+#if defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+  uint32_t primask;
+  asm volatile("mrs %0, primask\n\tcpsid i" : "=r"(primask)::"memory");
+  return primask;
+#else
+  return 0;
+#endif  // __ARM_ARCH_PROFILE == 'M'
+}
+
+inline void RestoreLocalInterrupts([[maybe_unused]] uint32_t mask) {
+#if defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+  asm volatile("msr primask, %0" ::"r"(mask) : "memory");
+#endif  // __ARM_ARCH_PROFILE == 'M'
+}
+
+// Waits until another core may have released a lock. On ARM this sleeps in WFE
+// until the SEV in SignalSpinLockRelease() rather than spinning on the bus.
+inline void WaitForSpinLockRelease() {
+#if defined(__arm__) || defined(__aarch64__)
+  asm volatile("wfe" ::: "memory");
+#else
+  PW_SYNC_YIELD_CORE_FOR_SMT();
+#endif  // defined(__arm__) || defined(__aarch64__)
+}
+
+inline void SignalSpinLockRelease() {
+#if defined(__arm__) || defined(__aarch64__)
+  // Complete the store that released the lock before waking the other cores.
+  asm volatile("dsb sy\n\tsev" ::: "memory");
+#endif  // defined(__arm__) || defined(__aarch64__)
+}
+
+}  // namespace backend
+
+constexpr InterruptSpinLock::InterruptSpinLock()
+    : native_type_{.next_ticket = 0, .now_serving = 0,
+                   .saved_interrupt_mask = 0} {}
+
+inline void InterruptSpinLock::lock() {
+  // Interrupts are masked before taking a ticket, so an interrupt on this core
+  // cannot deadlock by waiting behind a ticket that this core holds.
+  const uint32_t saved_mask = backend::MaskLocalInterrupts();
+  const uint16_t ticket =
+      native_type_.next_ticket.fetch_add(1, std::memory_order_relaxed);
+  while (native_type_.now_serving.load(std::memory_order_acquire) != ticket) {
+    backend::WaitForSpinLockRelease();
+  }
+  native_type_.saved_interrupt_mask = saved_mask;
+}
+
+inline bool InterruptSpinLock::try_lock() {
+  const uint32_t saved_mask = backend::MaskLocalInterrupts();
+  uint16_t ticket = native_type_.now_serving.load(std::memory_order_acquire);
+  // The lock is free only if no ticket past the one being served was taken.
+  if (!native_type_.next_ticket.compare_exchange_strong(
+          ticket,
+          static_cast<uint16_t>(ticket + 1),
+          std::memory_order_acquire,
+          std::memory_order_relaxed)) {
+    backend::RestoreLocalInterrupts(saved_mask);
+    return false;
+  }
+  native_type_.saved_interrupt_mask = saved_mask;
+  return true;
+}
+
+inline void InterruptSpinLock::unlock() {
+  const uint32_t saved_mask = native_type_.saved_interrupt_mask;
+  // Only the holder writes now_serving, so this need not be a read-modify-write.
+  const uint16_t next_ticket = static_cast<uint16_t>(
+      native_type_.now_serving.load(std::memory_order_relaxed) + 1);
+  native_type_.now_serving.store(next_ticket, std::memory_order_release);
+  backend::SignalSpinLockRelease();
+  backend::RestoreLocalInterrupts(saved_mask);
+}
+
+inline InterruptSpinLock::native_handle_type
+InterruptSpinLock::native_handle() {
+  return native_type_;
+}
+
+}  // namespace pw::sync
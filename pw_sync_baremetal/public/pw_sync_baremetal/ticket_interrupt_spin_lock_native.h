@@ -0,0 +1,31 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace pw::sync::backend {
+
+// A ticket lock: each locker takes the next ticket and waits until it is
+// served, so the lock is granted in FIFO order. Waiters only read now_serving,
+// so only the holder's unlock writes to it.
+struct NativeInterruptSpinLock {
+  std::atomic<uint16_t> next_ticket;
+  std::atomic<uint16_t> now_serving;
+  uint32_t saved_interrupt_mask;  // Only accessed by the holder.
+};
+using NativeInterruptSpinLockHandle = NativeInterruptSpinLock&;
+
+}  // namespace pw::sync::backend
@@ -15,45 +15,81 @@
 #include "pw_sync/counting_semaphore.h"
 
 #include "pw_assert/check.h"
+#include "pw_chrono_stl/simulated_time.h"
 
 using pw::chrono::SystemClock;
+using pw::chrono::stl::SimulatedTimeEnabled;
 
 namespace pw::sync {
 
+// Waiters increment waiters before they check the count under the mutex, and
+// release() checks waiters after it updates the count. Since both are
+// sequentially consistent, either release() sees the waiter and notifies it
+// under the mutex, or the waiter sees the updated count.
+
 void CountingSemaphore::release(ptrdiff_t update) {
   PW_DCHECK_UINT_GE(update, 0);
-  {
+  PW_DCHECK_UINT_LE(update,
+                    CountingSemaphore::max() - native_type_.count.load());
+  native_type_.count.fetch_add(update);
+  if (SimulatedTimeEnabled()) {
+    chrono::stl::internal::SimulatedNotify();
+    return;
+  }
+  if (native_type_.waiters.load() != 0u) {
     std::lock_guard lock(native_type_.mutex);
-    PW_DCHECK_UINT_LE(update, CountingSemaphore::max() - native_type_.count);
-    native_type_.count += update;
-    native_type_.condition.notify_one();
+    if (update == 1) {
+      native_type_.condition.notify_one();
+    } else {
+      native_type_.condition.notify_all();
+    }
   }
 }
 
 void CountingSemaphore::acquire() {
-  std::unique_lock lock(native_type_.mutex);
-  native_type_.condition.wait(lock, [&] { return native_type_.count != 0; });
-  --native_type_.count;
+  if (try_acquire()) {
+    return;
+  }
+  if (SimulatedTimeEnabled()) {
+    chrono::stl::internal::SimulatedWait([this] { return try_acquire(); });
+    return;
+  }
+  native_type_.waiters.fetch_add(1);
+  {
+    std::unique_lock lock(native_type_.mutex);
+    native_type_.condition.wait(lock, [&] { return try_acquire(); });
+  }
+  native_type_.waiters.fetch_sub(1);
 }
 
 bool CountingSemaphore::try_acquire() noexcept {
-  std::lock_guard lock(native_type_.mutex);
-  if (native_type_.count != 0) {
-    --native_type_.count;
-    return true;
+  ptrdiff_t count = native_type_.count.load();
+  while (count != 0) {
+    if (native_type_.count.compare_exchange_weak(count, count - 1)) {
+      return true;
+    }
   }
   return false;
 }
 
 bool CountingSemaphore::try_acquire_until(
     SystemClock::time_point until_at_least) {
-  std::unique_lock lock(native_type_.mutex);
-  if (native_type_.condition.wait_until(
-          lock, until_at_least, [&] { return native_type_.count != 0; })) {
-    --native_type_.count;
+  if (try_acquire()) {
     return true;
   }
-  return false;
+  if (SimulatedTimeEnabled()) {
+    return chrono::stl::internal::SimulatedWaitUntil(
+        until_at_least, [this] { return try_acquire(); });
+  }
+  native_type_.waiters.fetch_add(1);
+  bool acquired;
+  {
+    std::unique_lock lock(native_type_.mutex);
+    acquired = native_type_.condition.wait_until(
+        lock, until_at_least, [&] { return try_acquire(); });
+  }
+  native_type_.waiters.fetch_sub(1);
+  return acquired;
 }
 
 }  // namespace pw::sync
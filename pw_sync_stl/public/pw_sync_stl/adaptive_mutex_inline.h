@@ -0,0 +1,71 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_chrono_stl/simulated_time.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/yield_core.h"
+
+// The longest pause between attempts to take a contended lock before blocking.
+// The pauses double after each failed attempt, so a thread spins for about
+// twice this many PW_SYNC_YIELD_CORE_FOR_SMT() hints in total.
+#ifndef PW_SYNC_STL_ADAPTIVE_MUTEX_MAX_SPIN_PAUSES
+#define PW_SYNC_STL_ADAPTIVE_MUTEX_MAX_SPIN_PAUSES 64
+#endif  // PW_SYNC_STL_ADAPTIVE_MUTEX_MAX_SPIN_PAUSES
+
+namespace pw::sync {
+
+inline Mutex::Mutex() : native_type_() {}
+
+inline Mutex::~Mutex() {}
+
+inline void Mutex::lock() {
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    if (!native_type_.try_lock()) {
+      chrono::stl::internal::SimulatedWait(
+          [this] { return native_type_.try_lock(); });
+    }
+    return;
+  }
+
+  // Most critical sections are shorter than a context switch, so spin for a
+  // while in case the owner is running on another core and releases the lock
+  // soon. Only block in the OS once that fails.
+  for (uint32_t pauses = 1;
+       pauses <= PW_SYNC_STL_ADAPTIVE_MUTEX_MAX_SPIN_PAUSES;
+       pauses *= 2) {
+    if (native_type_.try_lock()) {
+      return;
+    }
+    for (uint32_t i = 0; i < pauses; ++i) {
+      PW_SYNC_YIELD_CORE_FOR_SMT();
+    }
+  }
+  native_type_.lock();
+}
+
+inline bool Mutex::try_lock() { return native_type_.try_lock(); }
+
+inline void Mutex::unlock() {
+  native_type_.unlock();
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    chrono::stl::internal::SimulatedNotify();
+  }
+}
+
+inline Mutex::native_handle_type Mutex::native_handle() { return native_type_; }
+
+}  // namespace pw::sync
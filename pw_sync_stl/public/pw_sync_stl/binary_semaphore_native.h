@@ -13,16 +13,22 @@
 // the License.
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <limits>
 #include <mutex>
 
 namespace pw::sync::backend {
 
+// The count is atomic so that releasing and acquiring without contention never
+// touches the mutex or condition variable. They are only used to block, and to
+// wake threads that are blocked, which are counted in waiters.
 struct NativeBinarySemaphore {
+  std::atomic<ptrdiff_t> count;
+  std::atomic<uint32_t> waiters;
   std::mutex mutex;
   std::condition_variable_any condition;
-  ptrdiff_t count;
 };
 using NativeBinarySemaphoreHandle = NativeBinarySemaphore&;
 
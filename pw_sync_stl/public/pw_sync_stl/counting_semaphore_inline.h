@@ -21,7 +21,7 @@ using pw::chrono::SystemClock;
 namespace pw::sync {
 
 inline CountingSemaphore::CountingSemaphore()
-    : native_type_{.mutex = {}, .condition = {}, .count = 0} {}
+    : native_type_{.count = 0, .waiters = 0, .mutex = {}, .condition = {}} {}
 
 inline CountingSemaphore::~CountingSemaphore() {}
 
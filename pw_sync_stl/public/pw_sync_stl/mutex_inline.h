@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include "pw_chrono_stl/simulated_time.h"
 #include "pw_sync/mutex.h"
 
 namespace pw::sync {
@@ -21,11 +22,25 @@ inline Mutex::Mutex() : native_type_() {}
 
 inline Mutex::~Mutex() {}
 
-inline void Mutex::lock() { native_type_.lock(); }
+inline void Mutex::lock() {
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    if (!native_type_.try_lock()) {
+      chrono::stl::internal::SimulatedWait(
+          [this] { return native_type_.try_lock(); });
+    }
+    return;
+  }
+  native_type_.lock();
+}
 
 inline bool Mutex::try_lock() { return native_type_.try_lock(); }
 
-inline void Mutex::unlock() { native_type_.unlock(); }
+inline void Mutex::unlock() {
+  native_type_.unlock();
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    chrono::stl::internal::SimulatedNotify();
+  }
+}
 
 inline Mutex::native_handle_type Mutex::native_handle() { return native_type_; }
 
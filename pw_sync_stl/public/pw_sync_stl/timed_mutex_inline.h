@@ -14,17 +14,26 @@
 #pragma once
 
 #include "pw_chrono/system_clock.h"
+#include "pw_chrono_stl/simulated_time.h"
 #include "pw_sync/mutex.h"
 
 namespace pw::sync {
 
 inline bool TimedMutex::try_lock_for(
     chrono::SystemClock::duration for_at_least) {
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    return try_lock_until(
+        chrono::SystemClock::TimePointAfterAtLeast(for_at_least));
+  }
   return native_handle().try_lock_for(for_at_least);
 }
 
 inline bool TimedMutex::try_lock_until(
     chrono::SystemClock::time_point until_at_least) {
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    return try_lock() || chrono::stl::internal::SimulatedWaitUntil(
+                             until_at_least, [this] { return try_lock(); });
+  }
   return native_handle().try_lock_until(until_at_least);
 }
 
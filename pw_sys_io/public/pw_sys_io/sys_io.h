@@ -84,28 +84,43 @@ Status WriteByte(std::byte b);
 // are returned as part of the StatusWithSize.
 StatusWithSize WriteLine(const std::string_view& s);
 
-// Fill a byte std::span from the sys io backend using ReadByte().
-// Implemented by: Facade
+// Fill a byte std::span from the sys io backend.
+// Implemented by: Facade (default_putget_bytes) or Backend
 //
-// This function is implemented by this facade and simply uses ReadByte() to
-// read enough bytes to fill the destination span. If there's an error reading a
-// byte, the read is aborted and the contents of the destination span are
-// undefined. This function blocks until either an error occurs, or all bytes
-// are successfully read from the backend's ReadByte() implementation.
+// The default implementation in the facade's default_putget_bytes target
+// simply uses ReadByte() to read enough bytes to fill the destination span.
+// Backends that can move data in bulk (e.g. by DMA) implement this themselves
+// and do not depend on default_putget_bytes. If there's an error reading, the
+// read is aborted and the contents of the destination span are undefined. This
+// function blocks until either an error occurs, or all bytes are successfully
+// read.
 //
 // Return status is OkStatus() if the destination span was successfully
 // filled. In all cases, the number of bytes successuflly read to the
 // destination span are returned as part of the StatusWithSize.
 StatusWithSize ReadBytes(std::span<std::byte> dest);
 
-// Write std::span of bytes out the sys io backend using WriteByte().
-// Implemented by: Facade
-//
-// This function is implemented by this facade and simply writes the source
-// contents using WriteByte(). If an error writing a byte is encountered, the
-// write is aborted and the error status returned. This function blocks until
-// either an error occurs, or all bytes are successfully read from the backend's
-// WriteByte() implementation.
+// Read the bytes that are available from the sys io backend without blocking.
+// Implemented by: Facade (default_putget_bytes) or Backend
+//
+// The default implementation calls TryReadByte() until it reports no more
+// bytes or the destination span is full.
+//
+// Returns OkStatus() - Between 1 and dest.size() bytes were read.
+//         Status::Unavailable() - No bytes are available to read; try later.
+//         Status::Unimplemented() - Not supported on this target.
+// In all cases, the number of bytes read to the destination span are returned
+// as part of the StatusWithSize.
+StatusWithSize TryReadBytes(std::span<std::byte> dest);
+
+// Write std::span of bytes out the sys io backend.
+// Implemented by: Facade (default_putget_bytes) or Backend
+//
+// The default implementation in the facade's default_putget_bytes target
+// simply writes the source contents using WriteByte(). Backends that can move
+// data in bulk implement this themselves. If an error writing is encountered,
+// the write is aborted and the error status returned. This function blocks
+// until either an error occurs, or all bytes are accepted by the backend.
 //
 // Return status is OkStatus() if all the bytes from the source span were
 // successfully written. In all cases, the number of bytes successfully written
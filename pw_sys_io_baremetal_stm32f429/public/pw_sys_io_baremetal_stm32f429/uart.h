@@ -0,0 +1,31 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "pw_status/status_with_size.h"
+
+namespace pw::sys_io::stm32f429 {
+
+// Reads a burst of bytes from USART1. Blocks until at least one byte has been
+// received, then returns once the receive line goes idle for a frame time or
+// dest is full, whichever comes first. This reads a whole packet in one call
+// without knowing its length in advance.
+//
+// Returns OkStatus() with the number of bytes read.
+StatusWithSize ReadUntilIdle(std::span<std::byte> dest);
+
+}  // namespace pw::sys_io::stm32f429
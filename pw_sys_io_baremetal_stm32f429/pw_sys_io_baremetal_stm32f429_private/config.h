@@ -0,0 +1,35 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+// Drive USART1 with DMA rather than by polling the data register. In DMA mode,
+// received bytes are written to a circular buffer by DMA2 stream 2 without CPU
+// involvement, and writes are copied to a transmit buffer and sent by DMA2
+// stream 7 while the CPU continues.
+#ifndef PW_SYS_IO_STM32F429_USE_DMA
+#define PW_SYS_IO_STM32F429_USE_DMA 0
+#endif  // PW_SYS_IO_STM32F429_USE_DMA
+
+// Size of the circular receive buffer used in DMA mode. Bytes are lost if the
+// buffer is not drained before the DMA wraps around it, so at 115200 baud the
+// default allows about 44 ms between reads.
+#ifndef PW_SYS_IO_STM32F429_RX_BUFFER_SIZE
+#define PW_SYS_IO_STM32F429_RX_BUFFER_SIZE 512
+#endif  // PW_SYS_IO_STM32F429_RX_BUFFER_SIZE
+
+// Size of each of the two transmit buffers used in DMA mode. One buffer is
+// filled while the other is sent.
+#ifndef PW_SYS_IO_STM32F429_TX_BUFFER_SIZE
+#define PW_SYS_IO_STM32F429_TX_BUFFER_SIZE 128
+#endif  // PW_SYS_IO_STM32F429_TX_BUFFER_SIZE
@@ -12,10 +12,15 @@
 // License for the specific language governing permissions and limitations under
 // the License.
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <cstring>
 
 #include "pw_preprocessor/compiler.h"
 #include "pw_sys_io/sys_io.h"
+#include "pw_sys_io_baremetal_stm32f429/uart.h"
+#include "pw_sys_io_baremetal_stm32f429_private/config.h"
 
 namespace {
 
@@ -43,6 +48,9 @@ PW_PACKED(struct) RccBlock {
 // Mask for ahb1_config (AHB1ENR) to enable the "A" GPIO pins.
 constexpr uint32_t kGpioAEnable = 0x1u;
 
+// Mask for ahb1_config (AHB1ENR) to enable DMA2.
+constexpr uint32_t kDma2Enable = 0x1u << 22;
+
 // Mask for apb2_config (APB2ENR) to enable USART1.
 constexpr uint32_t kUsart1Enable = 0x1u << 4;
 
@@ -83,6 +91,8 @@ constexpr uint32_t kGpio10AltModeHighPos = 8;
 constexpr uint8_t kGpioAlternateFunctionUsart1 = 0x07u;
 
 // USART status flags.
+constexpr uint32_t kIdleLineDetected = 0x1u << 4;
+constexpr uint32_t kReadDataReady = 0x1u << 5;
 constexpr uint32_t kTxRegisterEmpty = 0x1u << 7;
 
 // USART configuration flags for config1 register.
@@ -90,9 +100,12 @@ constexpr uint32_t kTxRegisterEmpty = 0x1u << 7;
 // to reasonable values and we don't need to change them.
 constexpr uint32_t kReceiveEnable = 0x1 << 2;
 constexpr uint32_t kTransmitEnable = 0x1 << 3;
-constexpr uint32_t kReadDataReady = 0x1u << 5;
 constexpr uint32_t kEnableUsart = 0x1 << 13;
 
+// USART configuration flags for config3 register.
+constexpr uint32_t kDmaReceiveEnable = 0x1u << 6;
+constexpr uint32_t kDmaTransmitEnable = 0x1u << 7;
+
 // Layout of memory mapped registers for USART blocks.
 PW_PACKED(struct) UsartBlock {
   uint32_t status;
@@ -128,6 +141,157 @@ volatile GpioBlock& gpio_a =
 volatile UsartBlock& usart1 =
     *reinterpret_cast<volatile UsartBlock*>(kApb2PeripheralBase + 0x1000U);
 
+// Clears the idle line flag, which requires reading the status register and
+// then the data register. The data register is left alone if it holds a byte
+// that hasn't been read yet.
+void ClearIdleLine() {
+  if (!(usart1.status & kReadDataReady)) {
+    [[maybe_unused]] uint32_t discarded = usart1.data_register;
+  }
+}
+
+#if PW_SYS_IO_STM32F429_USE_DMA
+
+// Layout of the registers for one DMA stream.
+PW_PACKED(struct) DmaStream {
+  uint32_t config;
+  // Number of items left to transfer. Counts down as the transfer proceeds and
+  // is reloaded at the end of each pass in circular mode.
+  uint32_t count;
+  uint32_t peripheral_address;
+  uint32_t memory0_address;
+  uint32_t memory1_address;
+  uint32_t fifo_config;
+};
+
+// Layout of memory mapped registers for DMA controllers.
+PW_PACKED(struct) DmaBlock {
+  uint32_t low_status;
+  uint32_t high_status;
+  uint32_t low_clear;
+  uint32_t high_clear;
+  DmaStream streams[8];
+};
+
+// DMA stream configuration flags. Peripheral-to-memory is the direction field's
+// zero value, and byte-sized transfers are the size fields' zero values.
+constexpr uint32_t kDmaStreamEnable = 0x1u;
+constexpr uint32_t kDmaMemoryToPeripheral = 0x1u << 6;
+constexpr uint32_t kDmaCircular = 0x1u << 8;
+constexpr uint32_t kDmaMemoryIncrement = 0x1u << 10;
+constexpr uint32_t kDmaChannelPos = 25;
+
+// USART1 requests are on channel 4 of DMA2, with RX on stream 2 and TX on
+// stream 7. See table 43 of RM0090.
+constexpr uint32_t kUsart1DmaChannel = 4;
+constexpr size_t kUsart1RxStream = 2;
+constexpr size_t kUsart1TxStream = 7;
+
+// All event flags for stream 2 in low_status/low_clear, and for stream 7 in
+// high_status/high_clear.
+constexpr uint32_t kDmaStream2Flags = 0x3Du << 16;
+constexpr uint32_t kDmaStream7Flags = 0x3Du << 22;
+constexpr uint32_t kDmaStream7TransferError = 0x1u << 25;
+
+// Declare a reference to the memory mapped block for DMA2.
+volatile DmaBlock& dma2 =
+    *reinterpret_cast<volatile DmaBlock*>(kAhb1PeripheralBase + 0x6400U);
+
+volatile DmaStream& usart1_rx_dma = dma2.streams[kUsart1RxStream];
+volatile DmaStream& usart1_tx_dma = dma2.streams[kUsart1TxStream];
+
+constexpr size_t kRxBufferSize = PW_SYS_IO_STM32F429_RX_BUFFER_SIZE;
+constexpr size_t kTxBufferSize = PW_SYS_IO_STM32F429_TX_BUFFER_SIZE;
+
+// DMA2 cannot reach the core coupled memory, so these must stay in SRAM.
+std::byte rx_buffer[kRxBufferSize];
+std::byte tx_buffers[2][kTxBufferSize];
+
+// Index in rx_buffer of the next byte to read.
+size_t rx_read_index = 0;
+
+// Index of the transmit buffer to fill next.
+size_t tx_next_buffer = 0;
+
+void InitDma() {
+  platform_rcc.ahb1_config |= kDma2Enable;
+
+  // Receive continuously into rx_buffer, wrapping around at the end.
+  usart1_rx_dma.peripheral_address =
+      reinterpret_cast<uint32_t>(&usart1.data_register);
+  usart1_rx_dma.memory0_address = reinterpret_cast<uint32_t>(rx_buffer);
+  usart1_rx_dma.count = kRxBufferSize;
+  usart1_rx_dma.config = (kUsart1DmaChannel << kDmaChannelPos) |
+                         kDmaMemoryIncrement | kDmaCircular;
+  dma2.low_clear = kDmaStream2Flags;
+  usart1_rx_dma.config |= kDmaStreamEnable;
+
+  // Transmits are started one buffer at a time by StartTransmit().
+  usart1_tx_dma.peripheral_address =
+      reinterpret_cast<uint32_t>(&usart1.data_register);
+  usart1_tx_dma.config = (kUsart1DmaChannel << kDmaChannelPos) |
+                         kDmaMemoryIncrement | kDmaMemoryToPeripheral;
+
+  usart1.config3 |= kDmaReceiveEnable | kDmaTransmitEnable;
+}
+
+// Copies bytes the DMA has written to rx_buffer into dest, and returns how many
+// were copied.
+size_t CopyReceived(std::span<std::byte> dest) {
+  const size_t write_index =
+      (kRxBufferSize - usart1_rx_dma.count) % kRxBufferSize;
+  // Don't read the buffer until the DMA position has been read.
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  size_t copied = 0;
+  while (copied < dest.size() && rx_read_index != write_index) {
+    const size_t end =
+        write_index > rx_read_index ? write_index : kRxBufferSize;
+    const size_t chunk = std::min(end - rx_read_index, dest.size() - copied);
+    std::memcpy(&dest[copied], &rx_buffer[rx_read_index], chunk);
+    copied += chunk;
+    rx_read_index = (rx_read_index + chunk) % kRxBufferSize;
+  }
+  return copied;
+}
+
+// Waits for the previous transmit, if any, to finish with its buffer.
+pw::Status WaitForTransmit() {
+  while (usart1_tx_dma.config & kDmaStreamEnable) {
+  }
+  if (dma2.high_status & kDmaStream7TransferError) {
+    dma2.high_clear = kDmaStream7Flags;
+    return pw::Status::Internal();
+  }
+  return pw::OkStatus();
+}
+
+void StartTransmit(const std::byte* data, size_t size) {
+  dma2.high_clear = kDmaStream7Flags;
+  usart1_tx_dma.memory0_address = reinterpret_cast<uint32_t>(data);
+  usart1_tx_dma.count = size;
+  // The buffer must be written before the DMA starts reading it.
+  std::atomic_thread_fence(std::memory_order_release);
+  usart1_tx_dma.config |= kDmaStreamEnable;
+}
+
+#endif  // PW_SYS_IO_STM32F429_USE_DMA
+
+// Copies bytes that have already been received into dest without waiting, and
+// returns how many were copied.
+size_t ReadAvailable(std::span<std::byte> dest) {
+#if PW_SYS_IO_STM32F429_USE_DMA
+  return CopyReceived(dest);
+#else
+  size_t bytes_read = 0;
+  while (bytes_read < dest.size() &&
+         pw::sys_io::TryReadByte(&dest[bytes_read]).ok()) {
+    bytes_read += 1;
+  }
+  return bytes_read;
+#endif  // PW_SYS_IO_STM32F429_USE_DMA
+}
+
 }  // namespace
 
 extern "C" void pw_sys_io_Init() {
@@ -157,10 +321,66 @@ extern "C" void pw_sys_io_Init() {
   usart1.baud_rate = CalcBaudRegister(kSystemCoreClock, /*target_baud=*/115200);
 
   usart1.config1 = kEnableUsart | kReceiveEnable | kTransmitEnable;
+
+#if PW_SYS_IO_STM32F429_USE_DMA
+  InitDma();
+#endif  // PW_SYS_IO_STM32F429_USE_DMA
 }
 
 namespace pw::sys_io {
 
+#if PW_SYS_IO_STM32F429_USE_DMA
+
+// Wait for a byte to read on USART1. Bytes are received by DMA, but this still
+// spins until one arrives.
+Status ReadByte(std::byte* dest) {
+  while (CopyReceived(std::span(dest, 1)) == 0) {
+  }
+  return OkStatus();
+}
+
+Status TryReadByte(std::byte* dest) {
+  if (CopyReceived(std::span(dest, 1)) == 0) {
+    return Status::Unavailable();
+  }
+  return OkStatus();
+}
+
+// Copies received bytes in bulk rather than one at a time.
+StatusWithSize ReadBytes(std::span<std::byte> dest) {
+  size_t bytes_read = 0;
+  while (bytes_read < dest.size()) {
+    bytes_read += CopyReceived(dest.subspan(bytes_read));
+  }
+  return StatusWithSize(bytes_read);
+}
+
+Status WriteByte(std::byte b) {
+  return WriteBytes(std::span(&b, 1)).status();
+}
+
+// Copies src into one transmit buffer while the other is being sent, so this
+// only blocks once both buffers are in use. Returns before the last buffer has
+// been sent.
+StatusWithSize WriteBytes(std::span<const std::byte> src) {
+  size_t bytes_written = 0;
+  while (bytes_written < src.size()) {
+    std::byte* buffer = tx_buffers[tx_next_buffer];
+    const size_t chunk = std::min(src.size() - bytes_written, kTxBufferSize);
+    std::memcpy(buffer, &src[bytes_written], chunk);
+
+    if (Status status = WaitForTransmit(); !status.ok()) {
+      return StatusWithSize(status, bytes_written);
+    }
+    StartTransmit(buffer, chunk);
+    tx_next_buffer ^= 1;
+    bytes_written += chunk;
+  }
+  return StatusWithSize(bytes_written);
+}
+
+#else
+
 // Wait for a byte to read on USART1. This blocks until a byte is read. This is
 // extremely inefficient as it requires the target to burn CPU cycles polling to
 // see if a byte is ready yet.
@@ -183,6 +403,13 @@ Status TryReadByte(std::byte* dest) {
   return OkStatus();
 }
 
+StatusWithSize ReadBytes(std::span<std::byte> dest) {
+  for (std::byte& b : dest) {
+    ReadByte(&b);
+  }
+  return StatusWithSize(dest.size());
+}
+
 // Send a byte over USART1. Since this blocks on every byte, it's rather
 // inefficient. At the default baud rate of 115200, one byte blocks the CPU for
 // ~87 micro seconds. This means it takes only 10 bytes to block the CPU for
@@ -196,6 +423,23 @@ Status WriteByte(std::byte b) {
   return OkStatus();
 }
 
+StatusWithSize WriteBytes(std::span<const std::byte> src) {
+  for (std::byte b : src) {
+    WriteByte(b);
+  }
+  return StatusWithSize(src.size());
+}
+
+#endif  // PW_SYS_IO_STM32F429_USE_DMA
+
+StatusWithSize TryReadBytes(std::span<std::byte> dest) {
+  const size_t bytes_read = ReadAvailable(dest);
+  if (bytes_read == 0 && !dest.empty()) {
+    return StatusWithSize::Unavailable();
+  }
+  return StatusWithSize(bytes_read);
+}
+
 // Writes a string using pw::sys_io, and add newline characters at the end.
 StatusWithSize WriteLine(const std::string_view& s) {
   size_t chars_written = 0;
@@ -212,4 +456,22 @@ StatusWithSize WriteLine(const std::string_view& s) {
   return StatusWithSize(result.status(), chars_written);
 }
 
+namespace stm32f429 {
+
+StatusWithSize ReadUntilIdle(std::span<std::byte> dest) {
+  size_t bytes_read = 0;
+  while (bytes_read < dest.size()) {
+    // Check for idle before reading, so bytes that arrive just before the line
+    // goes idle are picked up by this read.
+    const bool idle = usart1.status & kIdleLineDetected;
+    bytes_read += ReadAvailable(dest.subspan(bytes_read));
+    if (idle && bytes_read != 0) {
+      break;
+    }
+  }
+  ClearIdleLine();
+  return StatusWithSize(bytes_read);
+}
+
+}  // namespace stm32f429
 }  // namespace pw::sys_io
@@ -19,6 +19,7 @@ import (
 	"log"
 	"os"
 	"os/exec"
+	"time"
 
 	pb "pigweed.dev/proto/pw_target_runner/target_runner_pb"
 )
@@ -26,16 +27,34 @@ import (
 // ExecDeviceRunner is a struct that implements the DeviceRunner interface,
 // running its executables through a command with the path of the executable as
 // an argument.
+//
+// ExecDeviceRunner also implements BatchDeviceRunner. If a maximum batch size
+// is set, the command may be passed several executable paths at once. It must
+// then run all of them, exiting with a nonzero status if any fail.
 type ExecDeviceRunner struct {
-	command []string
-	logger  *log.Logger
+	command      []string
+	logger       *log.Logger
+	maxBatchSize int
 }
 
 // NewExecDeviceRunner creates a new ExecDeviceRunner with a custom logger.
 func NewExecDeviceRunner(id int, command []string) *ExecDeviceRunner {
 	logPrefix := fmt.Sprintf("[ExecDeviceRunner %d] ", id)
 	logger := log.New(os.Stdout, logPrefix, log.LstdFlags)
-	return &ExecDeviceRunner{command, logger}
+	return &ExecDeviceRunner{command: command, logger: logger}
+}
+
+// SetMaxBatchSize sets the largest number of executable paths passed to the
+// runner's command at once. Batching is disabled if this is less than 2, which
+// is the default.
+func (r *ExecDeviceRunner) SetMaxBatchSize(size int) {
+	r.maxBatchSize = size
+}
+
+// MaxBatchSize returns the largest number of executables run at once. Part of
+// BatchDeviceRunner interface.
+func (r *ExecDeviceRunner) MaxBatchSize() int {
+	return r.maxBatchSize
 }
 
 // WorkerStart starts the worker. Part of DeviceRunner interface.
@@ -53,13 +72,51 @@ func (r *ExecDeviceRunner) WorkerExit() {
 // with the binary path as an argument. The combined stdout and stderr of the
 // command is returned as the run output.
 func (r *ExecDeviceRunner) HandleRunRequest(req *RunRequest) *RunResponse {
-	res := &RunResponse{Status: pb.RunStatus_SUCCESS}
-
 	r.logger.Printf("Running executable %s\n", req.Path)
+	return r.run([]string{req.Path})
+}
+
+// HandleRunBatch runs several binaries with a single execution of the runner's
+// command, with all of their paths as arguments. Part of BatchDeviceRunner
+// interface.
+//
+// If the batch succeeds, every request receives the output of the whole batch.
+// If it fails, the command's output does not say which binary failed, so each
+// binary is run again on its own to find out.
+func (r *ExecDeviceRunner) HandleRunBatch(reqs []*RunRequest) []*RunResponse {
+	paths := make([]string, len(reqs))
+	for i, req := range reqs {
+		paths[i] = req.Path
+	}
+
+	r.logger.Printf("Running executables %v\n", paths)
+	batchRes := r.run(paths)
+
+	responses := make([]*RunResponse, len(reqs))
+	for i, req := range reqs {
+		if batchRes.Err == nil && batchRes.Status == pb.RunStatus_SUCCESS {
+			res := *batchRes
+			responses[i] = &res
+			continue
+		}
+
+		if batchRes.Err == nil {
+			r.logger.Printf("Batch failed; rerunning %s alone\n", req.Path)
+		}
+		runStart := time.Now()
+		responses[i] = r.run([]string{req.Path})
+		responses[i].RunTime = time.Since(runStart)
+	}
+	return responses
+}
+
+// run executes the runner's command with the paths appended to its arguments.
+func (r *ExecDeviceRunner) run(paths []string) *RunResponse {
+	res := &RunResponse{Status: pb.RunStatus_SUCCESS}
 
-	// Copy runner command args, appending the binary path to the end.
+	// Copy runner command args, appending the binary paths to the end.
 	args := append([]string(nil), r.command[1:]...)
-	args = append(args, req.Path)
+	args = append(args, paths...)
 
 	cmd := exec.Command(r.command[0], args...)
 	output, err := cmd.CombinedOutput()
@@ -33,26 +33,34 @@ import (
 )
 
 var (
-	errServerNotBound   = errors.New("Server not bound to a port")
-	errServerNotRunning = errors.New("Server is not running")
+	errServerNotBound     = errors.New("Server not bound to a port")
+	errServerNotRunning   = errors.New("Server is not running")
+	errUnknownDeviceClass = errors.New("No workers registered for device class")
 )
 
 // Server is a gRPC server that runs a TargetRunner service.
+//
+// Workers are grouped into pools by device class. Each run request names the
+// class of device it must run on, and is only scheduled on workers in that
+// class's pool. Workers registered without a class, and requests that don't
+// specify one, use the default class "".
 type Server struct {
-	grpcServer  *grpc.Server
-	listener    net.Listener
-	tasksPassed uint32
-	tasksFailed uint32
-	startTime   time.Time
-	active      bool
-	workerPool  *WorkerPool
+	grpcServer    *grpc.Server
+	listener      net.Listener
+	tasksPassed   uint32
+	tasksFailed   uint32
+	startTime     time.Time
+	active        bool
+	workerPools   map[string]*WorkerPool
+	timingHistory *TimingHistory
 }
 
 // NewServer creates a gRPC server with a registered TargetRunner service.
 func NewServer() *Server {
 	s := &Server{
-		grpcServer: grpc.NewServer(),
-		workerPool: newWorkerPool("ServerWorkerPool"),
+		grpcServer:    grpc.NewServer(),
+		workerPools:   make(map[string]*WorkerPool),
+		timingHistory: NewTimingHistory(),
 	}
 
 	reflection.Register(s.grpcServer)
@@ -71,23 +79,59 @@ func (s *Server) Bind(port int) error {
 	return nil
 }
 
-// RegisterWorker adds a worker to the server's worker pool.
+// UseTimingHistoryFile loads the run times of previously run executables from
+// a file, which are used to schedule the longest executables first. New run
+// times are saved to the file. Without a file, run times are only remembered
+// while the server is running.
+func (s *Server) UseTimingHistoryFile(path string) error {
+	return s.timingHistory.UseFile(path)
+}
+
+// RegisterWorker adds a worker to the server's default worker pool.
 func (s *Server) RegisterWorker(worker DeviceRunner) {
-	s.workerPool.RegisterWorker(worker)
+	s.RegisterWorkerForDeviceClass("", worker)
+}
+
+// RegisterWorkerForDeviceClass adds a worker to the server's worker pool for a
+// class of device, creating the pool if necessary. Workers must be registered
+// before the server is started.
+func (s *Server) RegisterWorkerForDeviceClass(deviceClass string, worker DeviceRunner) {
+	pool, ok := s.workerPools[deviceClass]
+	if !ok {
+		name := "ServerWorkerPool"
+		if deviceClass != "" {
+			name = fmt.Sprintf("ServerWorkerPool %s", deviceClass)
+		}
+		pool = newWorkerPool(name, deviceClass, s.timingHistory)
+		s.workerPools[deviceClass] = pool
+	}
+	pool.RegisterWorker(worker)
 }
 
-// RunBinary runs an executable through a worker in the server, returning
-// the worker's response. The function blocks until the executable has been
-// processed.
+// RunBinary runs an executable through a worker in the server's default pool,
+// returning the worker's response. The function blocks until the executable
+// has been processed.
 func (s *Server) RunBinary(path string) (*RunResponse, error) {
+	return s.RunBinaryOnDeviceClass(path, "")
+}
+
+// RunBinaryOnDeviceClass runs an executable through a worker for a class of
+// device, returning the worker's response. The function blocks until the
+// executable has been processed.
+func (s *Server) RunBinaryOnDeviceClass(path string, deviceClass string) (*RunResponse, error) {
 	if !s.active {
 		return nil, errServerNotRunning
 	}
 
+	pool, ok := s.workerPools[deviceClass]
+	if !ok {
+		return nil, errUnknownDeviceClass
+	}
+
 	resChan := make(chan *RunResponse, 1)
 	defer close(resChan)
 
-	s.workerPool.QueueExecutable(&RunRequest{
+	pool.QueueExecutable(&RunRequest{
 		Path:            path,
 		ResponseChannel: resChan,
 	})
@@ -119,7 +163,9 @@ func (s *Server) Serve() error {
 
 	s.startTime = time.Now()
 	s.active = true
-	s.workerPool.Start()
+	for _, pool := range s.workerPools {
+		pool.Start()
+	}
 
 	return s.grpcServer.Serve(s.listener)
 }
@@ -135,7 +181,11 @@ func (s *pwTargetRunnerService) RunBinary(
 	ctx context.Context,
 	desc *pb.RunBinaryRequest,
 ) (*pb.RunBinaryResponse, error) {
-	runRes, err := s.server.RunBinary(desc.FilePath)
+	runRes, err := s.server.RunBinaryOnDeviceClass(desc.FilePath, desc.DeviceClass)
+	if err == errUnknownDeviceClass {
+		return nil, status.Errorf(
+			codes.InvalidArgument, "No workers for device class %q", desc.DeviceClass)
+	}
 	if err != nil {
 		return nil, status.Error(codes.Internal, "Internal server error")
 	}
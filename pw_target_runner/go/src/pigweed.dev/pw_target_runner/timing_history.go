@@ -0,0 +1,154 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+package pw_target_runner
+
+import (
+	"bufio"
+	"fmt"
+	"io/ioutil"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+)
+
+// timingKey identifies an executable run on a class of devices. The same
+// binary can take very different amounts of time on different devices.
+type timingKey struct {
+	deviceClass string
+	path        string
+}
+
+// TimingHistory records how long executables have taken to run so that the
+// worker pools can schedule the longest ones first. It is safe for concurrent
+// use. Timings can optionally be persisted to a file so that they survive
+// server restarts.
+type TimingHistory struct {
+	lock     sync.Mutex
+	timings  map[timingKey]time.Duration
+	filePath string
+}
+
+// NewTimingHistory creates an empty, in-memory timing history.
+func NewTimingHistory() *TimingHistory {
+	return &TimingHistory{timings: make(map[timingKey]time.Duration)}
+}
+
+// Expected returns the expected run time of an executable on a device class,
+// or 0 if it has not been run before.
+func (h *TimingHistory) Expected(deviceClass, path string) time.Duration {
+	h.lock.Lock()
+	defer h.lock.Unlock()
+	return h.timings[timingKey{deviceClass, path}]
+}
+
+// Record adds a run time for an executable. The expected time is a moving
+// average that weighs the most recent run as much as all previous runs, so it
+// follows tests whose run time changes. If a history file is in use, it is
+// rewritten with the new timing.
+func (h *TimingHistory) Record(deviceClass, path string, runTime time.Duration) error {
+	h.lock.Lock()
+	defer h.lock.Unlock()
+
+	key := timingKey{deviceClass, path}
+	if previous, ok := h.timings[key]; ok {
+		runTime = (previous + runTime) / 2
+	}
+	if runTime <= 0 {
+		runTime = 1
+	}
+	h.timings[key] = runTime
+
+	if h.filePath == "" {
+		return nil
+	}
+	return h.save()
+}
+
+// UseFile loads previously recorded timings from a file, then saves timings to
+// the file as they are recorded. A missing file is not an error; it is created
+// when the first timing is recorded.
+//
+// Each line of the file holds the device class, executable path, and run time
+// in nanoseconds, separated by tabs.
+func (h *TimingHistory) UseFile(filePath string) error {
+	h.lock.Lock()
+	defer h.lock.Unlock()
+
+	h.filePath = filePath
+
+	file, err := os.Open(filePath)
+	if os.IsNotExist(err) {
+		return nil
+	}
+	if err != nil {
+		return err
+	}
+	defer file.Close()
+
+	scanner := bufio.NewScanner(file)
+	for line := 1; scanner.Scan(); line++ {
+		fields := strings.Split(scanner.Text(), "\t")
+		if len(fields) != 3 {
+			return fmt.Errorf("%s:%d: expected 3 tab-separated fields", filePath, line)
+		}
+		ns, err := strconv.ParseInt(fields[2], 10, 64)
+		if err != nil || ns <= 0 {
+			return fmt.Errorf("%s:%d: invalid run time %q", filePath, line, fields[2])
+		}
+		h.timings[timingKey{fields[0], fields[1]}] = time.Duration(ns)
+	}
+	return scanner.Err()
+}
+
+// save writes all timings to the history file. It writes a temporary file and
+// renames it so that a crash never leaves a truncated history behind. Must be
+// called with the lock held.
+func (h *TimingHistory) save() error {
+	keys := make([]timingKey, 0, len(h.timings))
+	for key := range h.timings {
+		keys = append(keys, key)
+	}
+	sort.Slice(keys, func(i, j int) bool {
+		if keys[i].deviceClass != keys[j].deviceClass {
+			return keys[i].deviceClass < keys[j].deviceClass
+		}
+		return keys[i].path < keys[j].path
+	})
+
+	var contents strings.Builder
+	for _, key := range keys {
+		fmt.Fprintf(&contents, "%s\t%s\t%d\n",
+			key.deviceClass, key.path, int64(h.timings[key]))
+	}
+
+	tmp, err := ioutil.TempFile(filepath.Dir(h.filePath), ".timing_history")
+	if err != nil {
+		return err
+	}
+	if _, err := tmp.WriteString(contents.String()); err != nil {
+		tmp.Close()
+		os.Remove(tmp.Name())
+		return err
+	}
+	if err := tmp.Close(); err != nil {
+		os.Remove(tmp.Name())
+		return err
+	}
+	return os.Rename(tmp.Name(), h.filePath)
+}
@@ -15,6 +15,7 @@
 package pw_target_runner
 
 import (
+	"container/heap"
 	"errors"
 	"fmt"
 	"log"
@@ -76,32 +77,105 @@ type DeviceRunner interface {
 	WorkerExit()
 }
 
+// BatchDeviceRunner is a DeviceRunner that can run several executables at once,
+// for example by flashing them to a device together. Batching saves the setup
+// cost of each run, such as flashing and resetting the device.
+type BatchDeviceRunner interface {
+	DeviceRunner
+
+	// MaxBatchSize returns the largest number of executables the worker
+	// can run at once. Batching is disabled if this is less than 2.
+	MaxBatchSize() int
+
+	// HandleRunBatch runs several executables and returns one response
+	// per request, in the same order. A response's RunTime may be left as
+	// 0, in which case the run time of the batch is divided evenly among
+	// its requests.
+	HandleRunBatch([]*RunRequest) []*RunResponse
+}
+
+// queuedRequest is a run request in a worker pool's queue.
+type queuedRequest struct {
+	req *RunRequest
+
+	// Expected run time from the timing history, or 0 if unknown.
+	expected time.Duration
+
+	// Order in which the request was queued, to keep the queue FIFO among
+	// requests with the same expected run time.
+	seq uint64
+}
+
+// runQueue is a container/heap priority queue of run requests, ordered by
+// expected run time from longest to shortest. Running the longest executables
+// first keeps one long test from being the only thing left running at the end.
+// Executables with unknown run times are run first, both because they could be
+// long and so that their timings are learned as early as possible.
+type runQueue []*queuedRequest
+
+func (q runQueue) Len() int { return len(q) }
+
+func (q runQueue) Less(i, j int) bool {
+	a, b := q[i], q[j]
+	if (a.expected == 0) != (b.expected == 0) {
+		return a.expected == 0
+	}
+	if a.expected != b.expected {
+		return a.expected > b.expected
+	}
+	return a.seq < b.seq
+}
+
+func (q runQueue) Swap(i, j int) { q[i], q[j] = q[j], q[i] }
+
+func (q *runQueue) Push(x interface{}) { *q = append(*q, x.(*queuedRequest)) }
+
+func (q *runQueue) Pop() interface{} {
+	old := *q
+	item := old[len(old)-1]
+	old[len(old)-1] = nil
+	*q = old[:len(old)-1]
+	return item
+}
+
 // WorkerPool represents a collection of device runners which run on-device
-// binaries. The worker pool distributes requests to run binaries among its
-// available workers.
+// binaries on one class of device. The worker pool distributes requests to run
+// binaries among its available workers, longest expected run time first.
 type WorkerPool struct {
 	activeWorkers uint32
+	deviceClass   string
 	logger        *log.Logger
 	workers       []DeviceRunner
 	waitGroup     sync.WaitGroup
-	reqChannel    chan *RunRequest
-	quitChannel   chan bool
+	history       *TimingHistory
+
+	// Protects the queue and stopping flag. cond is signaled when either
+	// changes.
+	lock     sync.Mutex
+	cond     *sync.Cond
+	queue    runQueue
+	nextSeq  uint64
+	stopping bool
 }
 
 var (
-	errWorkerPoolActive    = errors.New("Worker pool is running")
-	errNoRegisteredWorkers = errors.New("No workers registered in pool")
+	errWorkerPoolActive     = errors.New("Worker pool is running")
+	errNoRegisteredWorkers  = errors.New("No workers registered in pool")
+	errMissingBatchResponse = errors.New("Worker did not respond to batched request")
 )
 
-// newWorkerPool creates an empty worker pool.
-func newWorkerPool(name string) *WorkerPool {
+// newWorkerPool creates an empty worker pool for a class of devices. Run times
+// are looked up in and recorded to the history, if it is not nil.
+func newWorkerPool(name string, deviceClass string, history *TimingHistory) *WorkerPool {
 	logPrefix := fmt.Sprintf("[%s] ", name)
-	return &WorkerPool{
+	p := &WorkerPool{
+		deviceClass: deviceClass,
 		logger:      log.New(os.Stdout, logPrefix, log.LstdFlags),
 		workers:     make([]DeviceRunner, 0),
-		reqChannel:  make(chan *RunRequest, 1024),
-		quitChannel: make(chan bool, 64),
+		history:     history,
 	}
+	p.cond = sync.NewCond(&p.lock)
+	return p
 }
 
 // RegisterWorker adds a new worker to the pool. This cannot be done when the
@@ -138,12 +212,19 @@ func (p *WorkerPool) Stop() {
 		return
 	}
 
-	// Send N quit commands to the workers and wait for them to exit.
-	for i := uint32(0); i < p.activeWorkers; i++ {
-		p.quitChannel <- true
-	}
+	// Wake all of the workers so they see the stop request, and wait for
+	// them to exit.
+	p.lock.Lock()
+	p.stopping = true
+	p.cond.Broadcast()
+	p.lock.Unlock()
+
 	p.waitGroup.Wait()
 
+	p.lock.Lock()
+	p.stopping = false
+	p.lock.Unlock()
+
 	p.logger.Println("All workers in pool stopped")
 }
 
@@ -166,9 +247,52 @@ func (p *WorkerPool) QueueExecutable(req *RunRequest) {
 
 	p.logger.Printf("Queueing executable %s\n", req.Path)
 
+	var expected time.Duration
+	if p.history != nil {
+		expected = p.history.Expected(p.deviceClass, req.Path)
+	}
+
+	p.lock.Lock()
+	defer p.lock.Unlock()
+
 	// Start tracking how long the request is queued.
 	req.queueStart = time.Now()
-	p.reqChannel <- req
+	heap.Push(&p.queue, &queuedRequest{req, expected, p.nextSeq})
+	p.nextSeq++
+	p.cond.Signal()
+}
+
+// nextBatch blocks until there are queued requests, then removes up to
+// maxBatchSize of them from the queue. It returns false if the pool is
+// stopping.
+func (p *WorkerPool) nextBatch(maxBatchSize int) ([]*RunRequest, bool) {
+	p.lock.Lock()
+	defer p.lock.Unlock()
+
+	// Stop requests are processed before queued requests.
+	for len(p.queue) == 0 && !p.stopping {
+		p.cond.Wait()
+	}
+	if p.stopping {
+		return nil, false
+	}
+
+	// Only batch as much as is needed to give every worker a share of the
+	// queue. Batching a short queue onto one device would leave the other
+	// devices idle.
+	size := (len(p.queue) + len(p.workers) - 1) / len(p.workers)
+	if size > maxBatchSize {
+		size = maxBatchSize
+	}
+	if size < 1 {
+		size = 1
+	}
+
+	batch := make([]*RunRequest, 0, size)
+	for len(batch) < size {
+		batch = append(batch, heap.Pop(&p.queue).(*queuedRequest).req)
+	}
+	return batch, true
 }
 
 // runWorker is a function run by the worker pool in a separate goroutine for
@@ -185,37 +309,45 @@ func (p *WorkerPool) runWorker(worker DeviceRunner) {
 		return
 	}
 
-processLoop:
+	maxBatchSize := 1
+	batchRunner, canBatch := worker.(BatchDeviceRunner)
+	if canBatch && batchRunner.MaxBatchSize() > 1 {
+		maxBatchSize = batchRunner.MaxBatchSize()
+	}
+
 	for {
-		// Force the quit channel to be processed before the request
-		// channel by using a select statement with an empty default
-		// case to make the read non-blocking. If the quit channel is
-		// empty, the code will fall through to the main select below.
-		select {
-		case q, ok := <-p.quitChannel:
-			if q || !ok {
-				break processLoop
-			}
-		default:
+		batch, ok := p.nextBatch(maxBatchSize)
+		if !ok {
+			break
 		}
 
-		select {
-		case q, ok := <-p.quitChannel:
-			if q || !ok {
-				break processLoop
+		runStart := time.Now()
+		var responses []*RunResponse
+		if len(batch) == 1 {
+			responses = []*RunResponse{worker.HandleRunRequest(batch[0])}
+		} else {
+			p.logger.Printf("Running %d executables as a batch\n", len(batch))
+			responses = batchRunner.HandleRunBatch(batch)
+		}
+		runTime := time.Since(runStart)
+
+		for i, req := range batch {
+			var res *RunResponse
+			if i < len(responses) && responses[i] != nil {
+				res = responses[i]
+			} else {
+				res = &RunResponse{Err: errMissingBatchResponse}
 			}
-		case req, ok := <-p.reqChannel:
-			if !ok {
-				continue
+			if res.RunTime == 0 {
+				res.RunTime = runTime / time.Duration(len(batch))
 			}
+			res.QueueTime = runStart.Sub(req.queueStart)
 
-			queueTime := time.Since(req.queueStart)
-
-			runStart := time.Now()
-			res := worker.HandleRunRequest(req)
-			res.RunTime = time.Since(runStart)
-
-			res.QueueTime = queueTime
+			if res.Err == nil && p.history != nil {
+				if err := p.history.Record(p.deviceClass, req.Path, res.RunTime); err != nil {
+					p.logger.Printf("Failed to save run time: %v\n", err)
+				}
+			}
 			req.ResponseChannel <- res
 		}
 	}
@@ -50,15 +50,17 @@ func NewClient(host string, port int) (*Client, error) {
 	return &Client{conn}, nil
 }
 
-// RunBinary sends a RunBinary RPC to the target runner service.
-func (c *Client) RunBinary(path string) error {
+// RunBinary sends a RunBinary RPC to the target runner service. The binary is
+// run on a worker for the given device class, or a default worker if the class
+// is empty.
+func (c *Client) RunBinary(path string, deviceClass string) error {
 	abspath, err := filepath.Abs(path)
 	if err != nil {
 		return err
 	}
 
 	client := pb.NewTargetRunnerClient(c.conn)
-	req := &pb.RunBinaryRequest{FilePath: abspath}
+	req := &pb.RunBinaryRequest{FilePath: abspath, DeviceClass: deviceClass}
 
 	res, err := client.RunBinary(context.Background(), req)
 	if err != nil {
@@ -84,6 +86,7 @@ func main() {
 	hostPtr := flag.String("host", "localhost", "Server host")
 	portPtr := flag.Int("port", 8080, "Server port")
 	pathPtr := flag.String("binary", "", "Path to executable file")
+	deviceClassPtr := flag.String("device_class", "", "Class of device to run on")
 
 	flag.Parse()
 
@@ -96,7 +99,7 @@ func main() {
 		log.Fatalf("Failed to create gRPC client: %v", err)
 	}
 
-	if err := cli.RunBinary(*pathPtr); err != nil {
+	if err := cli.RunBinary(*pathPtr, *deviceClassPtr); err != nil {
 		log.Println("Failed to run executable on target:")
 		log.Println("")
 
@@ -51,6 +51,13 @@ func configureServerFromFile(s *pw_target_runner.Server, filepath string) error
 
 	log.Printf("Parsed server configuration from %s\n", filepath)
 
+	if historyFile := config.GetTimingHistoryFile(); historyFile != "" {
+		if err := s.UseTimingHistoryFile(historyFile); err != nil {
+			return err
+		}
+		log.Printf("Using run time history file %s\n", historyFile)
+	}
+
 	runners := config.GetRunner()
 	if runners == nil {
 		return nil
@@ -74,12 +81,14 @@ func configureServerFromFile(s *pw_target_runner.Server, filepath string) error
 		}
 
 		worker := pw_target_runner.NewExecDeviceRunner(i, cmd)
-		s.RegisterWorker(worker)
+		worker.SetMaxBatchSize(int(runner.GetMaxBatchSize()))
+		s.RegisterWorkerForDeviceClass(runner.GetDeviceClass(), worker)
 
 		log.Printf(
-			"Registered ExecDeviceRunner %s with args %v\n",
+			"Registered ExecDeviceRunner %s with args %v for device class %q\n",
 			cmd[0],
-			cmd[1:])
+			cmd[1:],
+			runner.GetDeviceClass())
 	}
 
 	return nil
@@ -0,0 +1,106 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "pw_bytes/span.h"
+
+namespace pw::thread {
+
+// ThreadInfo is a snapshot of one thread's run-time statistics, as reported by
+// pw::thread::ForEachThread(). Which fields are set depends on the backend and
+// on how the RTOS is configured, so each field is optional.
+//
+// Addresses assume a descending stack: the stack starts at stack_high_addr and
+// grows down towards stack_low_addr.
+class ThreadInfo {
+ public:
+  constexpr ThreadInfo() = default;
+
+  // The thread's name. This points into the RTOS's thread control block, so it
+  // is only valid while the thread exists.
+  std::optional<ConstByteSpan> thread_name() const { return thread_name_; }
+  void set_thread_name(ConstByteSpan name) { thread_name_ = name; }
+
+  // The lowest address of the stack, where it ends.
+  std::optional<uintptr_t> stack_low_addr() const { return stack_low_addr_; }
+  void set_stack_low_addr(uintptr_t addr) { stack_low_addr_ = addr; }
+
+  // The highest address of the stack, where it starts.
+  std::optional<uintptr_t> stack_high_addr() const { return stack_high_addr_; }
+  void set_stack_high_addr(uintptr_t addr) { stack_high_addr_ = addr; }
+
+  // The thread's stack pointer the last time it was switched out.
+  std::optional<uintptr_t> stack_pointer() const { return stack_pointer_; }
+  void set_stack_pointer(uintptr_t addr) { stack_pointer_ = addr; }
+
+  // The deepest the stack pointer is estimated to have reached, i.e. the stack
+  // high-water mark. This is found by checking how much of the stack's fill
+  // pattern has been overwritten, so it may underestimate if the thread wrote
+  // the fill value itself.
+  std::optional<uintptr_t> stack_peak_addr() const { return stack_peak_addr_; }
+  void set_stack_peak_addr(uintptr_t addr) { stack_peak_addr_ = addr; }
+
+  // The total time the thread has run, in the units of the RTOS's run-time
+  // counter.
+  std::optional<uint64_t> run_time() const { return run_time_; }
+  void set_run_time(uint64_t run_time) { run_time_ = run_time; }
+
+  // The share of the total run time spent in this thread, in hundredths of a
+  // percent (e.g. 5.00% = 500).
+  std::optional<uint32_t> cpu_usage_hundredths() const {
+    return cpu_usage_hundredths_;
+  }
+  void set_cpu_usage_hundredths(uint32_t usage) {
+    cpu_usage_hundredths_ = usage;
+  }
+
+  // The stack size, if both ends of the stack are known.
+  std::optional<size_t> stack_size() const {
+    if (!stack_low_addr_.has_value() || !stack_high_addr_.has_value()) {
+      return std::nullopt;
+    }
+    return *stack_high_addr_ - *stack_low_addr_;
+  }
+
+  // The peak stack usage in bytes, if the start and peak are known.
+  std::optional<size_t> stack_peak_usage() const {
+    if (!stack_high_addr_.has_value() || !stack_peak_addr_.has_value()) {
+      return std::nullopt;
+    }
+    return *stack_high_addr_ - *stack_peak_addr_;
+  }
+
+  // How many bytes of the stack have never been used, if the end and peak are
+  // known. This is how much the stack could be shrunk by.
+  std::optional<size_t> stack_unused() const {
+    if (!stack_low_addr_.has_value() || !stack_peak_addr_.has_value()) {
+      return std::nullopt;
+    }
+    return *stack_peak_addr_ - *stack_low_addr_;
+  }
+
+ private:
+  std::optional<ConstByteSpan> thread_name_;
+  std::optional<uintptr_t> stack_low_addr_;
+  std::optional<uintptr_t> stack_high_addr_;
+  std::optional<uintptr_t> stack_pointer_;
+  std::optional<uintptr_t> stack_peak_addr_;
+  std::optional<uint64_t> run_time_;
+  std::optional<uint32_t> cpu_usage_hundredths_;
+};
+
+}  // namespace pw::thread
@@ -0,0 +1,39 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_function/function_ref.h"
+#include "pw_status/status.h"
+#include "pw_thread/thread_info.h"
+
+namespace pw::thread {
+
+// Calls the callback with the ThreadInfo of each thread known to the RTOS,
+// including threads which were not created through pw::thread::Thread. The
+// callback returns true to continue to the next thread, or false to stop.
+//
+// The threads must not be created or deleted while they are being iterated
+// over, so backends may suspend the scheduler while the callback runs. The
+// callback must therefore not block; copy what is needed and process it
+// afterwards.
+//
+// This is thread safe, but NOT IRQ safe.
+//
+// Returns:
+//   OK - All threads were visited, or the callback stopped the iteration.
+//   FAILED_PRECONDITION - The RTOS is not configured to allow iteration.
+//   RESOURCE_EXHAUSTED - There were more threads than the backend can handle.
+Status ForEachThread(FunctionRef<bool(const ThreadInfo&)> callback);
+
+}  // namespace pw::thread
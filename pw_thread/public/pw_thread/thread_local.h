@@ -0,0 +1,87 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_thread_backend/thread_local_native.h"
+
+namespace pw::thread {
+namespace backend {
+
+// The backend must provide these, either inline in
+// pw_thread_backend/thread_local_inline.h or in a translation unit.
+
+// Reserves a new per-thread slot. Slots are never freed. Running out of slots
+// is fatal.
+NativeThreadLocalKey AllocateThreadLocalKey();
+
+// Returns the calling thread's value for the slot, or nullptr if the thread has
+// not set one.
+void* GetThreadLocal(NativeThreadLocalKey key);
+
+// Sets the calling thread's value for the slot.
+void SetThreadLocal(NativeThreadLocalKey key, void* value);
+
+}  // namespace backend
+
+// ThreadLocal holds a separate T* for every thread. Each thread sees nullptr
+// until it sets its own pointer, and only ever sees the pointer it set. This
+// gives per-thread caches a home on toolchains where the thread_local keyword
+// is not supported, and lets them be read without a lock:
+//
+//   pw::thread::ThreadLocal<EncodeBuffer> encode_buffer;
+//
+//   void WorkerThread() {
+//     EncodeBuffer buffer;
+//     encode_buffer.set(&buffer);
+//     ...
+//   }
+//
+//   void Encode(...) {
+//     EncodeBuffer* buffer = encode_buffer.get();
+//     ...
+//   }
+//
+// ThreadLocal only stores the pointer; the thread owns the object and must
+// clear the pointer before the object goes away. The number of ThreadLocals is
+// limited by the backend, which usually maps each one to an RTOS task-local
+// storage slot. Slots are never given back, so ThreadLocals are meant to be
+// static or global objects rather than created on the fly.
+//
+// get() and set() are thread safe, but NOT IRQ safe. Constructing a ThreadLocal
+// is thread safe and does not need the scheduler to be running.
+template <typename T>
+class ThreadLocal {
+ public:
+  ThreadLocal() : key_(backend::AllocateThreadLocalKey()) {}
+  ThreadLocal(const ThreadLocal&) = delete;
+  ThreadLocal(ThreadLocal&&) = delete;
+  ThreadLocal& operator=(const ThreadLocal&) = delete;
+  ThreadLocal& operator=(ThreadLocal&&) = delete;
+
+  // Returns the calling thread's pointer, or nullptr if it has not set one.
+  T* get() const { return static_cast<T*>(backend::GetThreadLocal(key_)); }
+
+  // Sets the calling thread's pointer. Pass nullptr to clear it.
+  void set(T* value) { backend::SetThreadLocal(key_, value); }
+
+ private:
+  const backend::NativeThreadLocalKey key_;
+};
+
+}  // namespace pw::thread
+
+// The backend can opt to include an inline implementation.
+#if __has_include("pw_thread_backend/thread_local_inline.h")
+#include "pw_thread_backend/thread_local_inline.h"
+#endif  // __has_include("pw_thread_backend/thread_local_inline.h")
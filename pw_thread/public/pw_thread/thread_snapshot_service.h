@@ -0,0 +1,69 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "pw_status/status.h"
+#include "pw_thread/thread_info.h"
+#include "pw_thread_protos/thread.pwpb.h"
+#include "pw_thread_protos/thread_snapshot_service.raw_rpc.pb.h"
+
+namespace pw::thread {
+
+// Encodes the fields of a ThreadInfo that are set into a pw.thread.Thread
+// message. Fields that are not set are left out.
+Status ProtoEncodeThreadInfo(Thread::Encoder& encoder,
+                             const ThreadInfo& thread_info);
+
+// RPC service that reports the stack usage and run time of every thread, using
+// pw::thread::ForEachThread(). GetThreadInfo() streams one SnapshotThreadInfo
+// response per thread, then finishes the call with the iteration's status.
+//
+// The thread info is copied out of the RTOS into the given buffer first and
+// encoded afterwards, so the scheduler is not held off while responses are
+// sent. Threads beyond the buffer's size are left out and the call finishes
+// with RESOURCE_EXHAUSTED. Use ThreadSnapshotServiceBuffer to allocate the
+// buffer along with the service.
+//
+// Only one GetThreadInfo() call may run at a time, since they share the buffer.
+class ThreadSnapshotService final
+    : public generated::ThreadSnapshotService<ThreadSnapshotService> {
+ public:
+  ThreadSnapshotService(std::span<ThreadInfo> thread_info_buffer)
+      : thread_info_buffer_(thread_info_buffer) {}
+
+  void GetThreadInfo(ServerContext&,
+                     ConstByteSpan request,
+                     rpc::RawServerWriter& response_writer);
+
+ private:
+  std::span<ThreadInfo> thread_info_buffer_;
+};
+
+template <size_t kMaxThreads>
+class ThreadSnapshotServiceBuffer {
+ public:
+  ThreadSnapshotServiceBuffer() : service_(thread_info_buffer_) {}
+
+  ThreadSnapshotService& service() { return service_; }
+
+ private:
+  std::array<ThreadInfo, kMaxThreads> thread_info_buffer_;
+  ThreadSnapshotService service_;
+};
+
+}  // namespace pw::thread
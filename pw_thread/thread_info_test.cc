@@ -0,0 +1,58 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_info.h"
+
+#include "gtest/gtest.h"
+
+namespace pw::thread {
+namespace {
+
+TEST(ThreadInfo, DefaultsToUnset) {
+  ThreadInfo info;
+  EXPECT_FALSE(info.thread_name().has_value());
+  EXPECT_FALSE(info.stack_low_addr().has_value());
+  EXPECT_FALSE(info.stack_high_addr().has_value());
+  EXPECT_FALSE(info.stack_pointer().has_value());
+  EXPECT_FALSE(info.stack_peak_addr().has_value());
+  EXPECT_FALSE(info.run_time().has_value());
+  EXPECT_FALSE(info.cpu_usage_hundredths().has_value());
+  EXPECT_FALSE(info.stack_size().has_value());
+  EXPECT_FALSE(info.stack_peak_usage().has_value());
+  EXPECT_FALSE(info.stack_unused().has_value());
+}
+
+TEST(ThreadInfo, StackUsage) {
+  ThreadInfo info;
+  info.set_stack_low_addr(0x1000);
+  info.set_stack_high_addr(0x1400);
+  EXPECT_EQ(info.stack_size().value(), 0x400u);
+  EXPECT_FALSE(info.stack_peak_usage().has_value());
+  EXPECT_FALSE(info.stack_unused().has_value());
+
+  info.set_stack_peak_addr(0x1100);
+  EXPECT_EQ(info.stack_peak_usage().value(), 0x300u);
+  EXPECT_EQ(info.stack_unused().value(), 0x100u);
+}
+
+TEST(ThreadInfo, RunTime) {
+  ThreadInfo info;
+  info.set_run_time(123456789012u);
+  info.set_cpu_usage_hundredths(500);
+  EXPECT_EQ(info.run_time().value(), 123456789012u);
+  EXPECT_EQ(info.cpu_usage_hundredths().value(), 500u);
+}
+
+}  // namespace
+}  // namespace pw::thread
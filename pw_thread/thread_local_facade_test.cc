@@ -0,0 +1,88 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_local.h"
+
+#include "gtest/gtest.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_thread/test_threads.h"
+#include "pw_thread/thread.h"
+
+using pw::thread::test::TestOptionsThread0;
+using pw::thread::test::WaitUntilDetachedThreadsCleanedUp;
+
+namespace pw::thread {
+namespace {
+
+ThreadLocal<int> first_local;
+ThreadLocal<int> second_local;
+
+TEST(ThreadLocal, SetAndGet) {
+  int value = 1;
+  EXPECT_EQ(first_local.get(), nullptr);
+  first_local.set(&value);
+  EXPECT_EQ(first_local.get(), &value);
+  first_local.set(nullptr);
+  EXPECT_EQ(first_local.get(), nullptr);
+}
+
+TEST(ThreadLocal, SlotsAreIndependent) {
+  int first = 1;
+  int second = 2;
+  first_local.set(&first);
+  second_local.set(&second);
+  EXPECT_EQ(first_local.get(), &first);
+  EXPECT_EQ(second_local.get(), &second);
+
+  second_local.set(nullptr);
+  EXPECT_EQ(first_local.get(), &first);
+  EXPECT_EQ(second_local.get(), nullptr);
+  first_local.set(nullptr);
+}
+
+struct OtherThreadState {
+  int* seen_before_set = nullptr;
+  int* seen_after_set = nullptr;
+  int value = 0;
+  sync::BinarySemaphore done;
+};
+
+void SetFromOtherThread(void* arg) {
+  OtherThreadState& state = *static_cast<OtherThreadState*>(arg);
+  state.seen_before_set = first_local.get();
+  first_local.set(&state.value);
+  state.seen_after_set = first_local.get();
+  first_local.set(nullptr);
+  state.done.release();
+}
+
+TEST(ThreadLocal, ThreadsHaveSeparateValues) {
+  int value = 1;
+  first_local.set(&value);
+
+  OtherThreadState state;
+  Thread(TestOptionsThread0(), SetFromOtherThread, &state).detach();
+  state.done.acquire();
+  WaitUntilDetachedThreadsCleanedUp();
+
+  // The other thread saw neither this thread's value nor its own before it set
+  // one, and setting its value did not change this thread's.
+  EXPECT_EQ(state.seen_before_set, nullptr);
+  EXPECT_EQ(state.seen_after_set, &state.value);
+  EXPECT_EQ(first_local.get(), &value);
+  first_local.set(nullptr);
+}
+
+}  // namespace
+}  // namespace pw::thread
@@ -0,0 +1,100 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_snapshot_service.h"
+
+#include "pw_protobuf/encoder.h"
+#include "pw_status/try.h"
+#include "pw_thread/thread_iteration.h"
+#include "pw_thread_protos/thread_snapshot_service.pwpb.h"
+
+namespace pw::thread {
+
+Status ProtoEncodeThreadInfo(Thread::Encoder& encoder,
+                             const ThreadInfo& thread_info) {
+  if (thread_info.thread_name().has_value()) {
+    PW_TRY(encoder.WriteName(thread_info.thread_name().value()));
+  }
+  if (thread_info.stack_high_addr().has_value()) {
+    PW_TRY(encoder.WriteStackStartPointer(
+        thread_info.stack_high_addr().value()));
+  }
+  if (thread_info.stack_low_addr().has_value()) {
+    PW_TRY(encoder.WriteStackEndPointer(thread_info.stack_low_addr().value()));
+  }
+  if (thread_info.stack_size().has_value()) {
+    PW_TRY(encoder.WriteStackSize(thread_info.stack_size().value()));
+  }
+  if (thread_info.stack_pointer().has_value()) {
+    PW_TRY(encoder.WriteStackPointer(thread_info.stack_pointer().value()));
+  }
+  if (thread_info.stack_peak_addr().has_value()) {
+    PW_TRY(encoder.WriteStackPointerEstPeak(
+        thread_info.stack_peak_addr().value()));
+  }
+  if (thread_info.cpu_usage_hundredths().has_value()) {
+    PW_TRY(encoder.WriteCpuUsageHundredths(
+        thread_info.cpu_usage_hundredths().value()));
+  }
+  if (thread_info.run_time().has_value()) {
+    PW_TRY(encoder.WriteRunTime(thread_info.run_time().value()));
+  }
+  return OkStatus();
+}
+
+void ThreadSnapshotService::GetThreadInfo(
+    ServerContext&, ConstByteSpan, rpc::RawServerWriter& response_writer) {
+  size_t thread_count = 0;
+  bool buffer_full = false;
+  Status status = ForEachThread([&](const ThreadInfo& thread_info) {
+    if (thread_count == thread_info_buffer_.size()) {
+      buffer_full = true;
+      return false;
+    }
+    thread_info_buffer_[thread_count++] = thread_info;
+    return true;
+  });
+  if (status.ok() && buffer_full) {
+    status = Status::ResourceExhausted();
+  }
+
+  for (size_t i = 0; i < thread_count; ++i) {
+    protobuf::NestedEncoder proto_encoder(response_writer.PayloadBuffer());
+    SnapshotThreadInfo::Encoder snapshot_encoder(&proto_encoder);
+    {
+      Thread::Encoder thread_encoder = snapshot_encoder.GetThreadsEncoder();
+      const Status encode_status =
+          ProtoEncodeThreadInfo(thread_encoder, thread_info_buffer_[i]);
+      if (!encode_status.ok()) {
+        response_writer.Finish(encode_status);
+        return;
+      }
+    }
+
+    Result<ConstByteSpan> payload = proto_encoder.Encode();
+    if (!payload.ok()) {
+      response_writer.Finish(payload.status());
+      return;
+    }
+    const Status write_status = response_writer.Write(payload.value());
+    if (!write_status.ok()) {
+      response_writer.Finish(write_status);
+      return;
+    }
+  }
+
+  response_writer.Finish(status);
+}
+
+}  // namespace pw::thread
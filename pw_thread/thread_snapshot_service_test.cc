@@ -0,0 +1,55 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_snapshot_service.h"
+
+#include "gtest/gtest.h"
+#include "pw_rpc/raw_test_method_context.h"
+#include "pw_thread/thread_iteration.h"
+
+namespace pw::thread {
+namespace {
+
+TEST(ThreadSnapshotService, ReportsEveryThread) {
+  size_t thread_count = 0;
+  ASSERT_EQ(OkStatus(), ForEachThread([&thread_count](const ThreadInfo&) {
+              ++thread_count;
+              return true;
+            }));
+  ASSERT_GT(thread_count, 0u);
+
+  std::array<ThreadInfo, 32> buffer;
+  ASSERT_LE(thread_count, buffer.size());
+  PW_RAW_TEST_METHOD_CONTEXT(ThreadSnapshotService, GetThreadInfo, 32)
+  context(buffer);
+  context.call({});
+
+  ASSERT_TRUE(context.done());
+  EXPECT_EQ(OkStatus(), context.status());
+  EXPECT_EQ(thread_count, context.total_responses());
+}
+
+TEST(ThreadSnapshotService, BufferTooSmall) {
+  std::array<ThreadInfo, 0> buffer;
+  PW_RAW_TEST_METHOD_CONTEXT(ThreadSnapshotService, GetThreadInfo)
+  context(buffer);
+  context.call({});
+
+  ASSERT_TRUE(context.done());
+  EXPECT_EQ(Status::ResourceExhausted(), context.status());
+  EXPECT_EQ(0u, context.total_responses());
+}
+
+}  // namespace
+}  // namespace pw::thread
@@ -68,6 +68,18 @@
 #define PW_THREAD_EMBOS_CONFIG_DEFAULT_TIME_SLICE_INTERVAL 2
 #endif  // PW_THREAD_EMBOS_CONFIG_DEFAULT_TIME_SLICE_INTERVAL
 
+// The maximum number of pw::thread::ThreadLocal objects. By default this is 4.
+#ifndef PW_THREAD_EMBOS_CONFIG_MAX_THREAD_LOCALS
+#define PW_THREAD_EMBOS_CONFIG_MAX_THREAD_LOCALS 4
+#endif  // PW_THREAD_EMBOS_CONFIG_MAX_THREAD_LOCALS
+
+// The maximum number of tasks which may have pw::thread::ThreadLocal values set
+// at the same time. A task's values take up an entry from when it first sets
+// one until it terminates. By default this is 8.
+#ifndef PW_THREAD_EMBOS_CONFIG_THREAD_LOCAL_MAX_TASKS
+#define PW_THREAD_EMBOS_CONFIG_THREAD_LOCAL_MAX_TASKS 8
+#endif  // PW_THREAD_EMBOS_CONFIG_THREAD_LOCAL_MAX_TASKS
+
 namespace pw::thread::embos::config {
 
 inline constexpr size_t kMaximumNameLength =
@@ -81,5 +93,9 @@ inline constexpr OS_PRIO kDefaultPriority =
     PW_THREAD_EMBOS_CONFIG_DEFAULT_PRIORITY;
 inline constexpr OS_PRIO kDefaultTimeSliceInterval =
     PW_THREAD_EMBOS_CONFIG_DEFAULT_TIME_SLICE_INTERVAL;
+inline constexpr size_t kMaxThreadLocals =
+    PW_THREAD_EMBOS_CONFIG_MAX_THREAD_LOCALS;
+inline constexpr size_t kThreadLocalMaxTasks =
+    PW_THREAD_EMBOS_CONFIG_THREAD_LOCAL_MAX_TASKS;
 
 }  // namespace pw::thread::embos::config
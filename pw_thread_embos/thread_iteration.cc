@@ -0,0 +1,71 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_iteration.h"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "RTOS.h"
+
+namespace pw::thread {
+namespace {
+
+ThreadInfo ToThreadInfo(OS_TASK& task) {
+  ThreadInfo info;
+#if OS_TRACKNAME
+  const char* name = OS_GetTaskName(&task);
+  if (name != nullptr) {
+    info.set_thread_name(std::as_bytes(std::span(name, std::strlen(name))));
+  }
+#endif  // OS_TRACKNAME
+
+  info.set_stack_pointer(reinterpret_cast<uintptr_t>(task.pStack));
+
+#if OS_CHECKSTACK
+  // With stack checking, embOS fills each stack with a pattern when the task
+  // is created, and OS_GetStackUsed() finds how much of it was overwritten.
+  const uintptr_t stack_low_addr =
+      reinterpret_cast<uintptr_t>(OS_GetStackBase(&task));
+  const uintptr_t stack_high_addr = stack_low_addr + OS_GetStackSize(&task);
+  info.set_stack_low_addr(stack_low_addr);
+  info.set_stack_high_addr(stack_high_addr);
+  info.set_stack_peak_addr(stack_high_addr - OS_GetStackUsed(&task));
+#endif  // OS_CHECKSTACK
+
+#if OS_PROFILE
+  // The load is in tenths of a percent over the last OS_STAT_Sample() period.
+  info.set_cpu_usage_hundredths(static_cast<uint32_t>(OS_STAT_GetLoad(&task)) *
+                                10u);
+#endif  // OS_PROFILE
+
+  return info;
+}
+
+}  // namespace
+
+Status ForEachThread(FunctionRef<bool(const ThreadInfo&)> callback) {
+  // Prevent task switches, so tasks are not deleted while the callback runs.
+  OS_SuspendAllTasks();
+  for (OS_TASK* task = OS_Global.pTask; task != nullptr; task = task->pNext) {
+    if (!callback(ToThreadInfo(*task))) {
+      break;
+    }
+  }
+  OS_ResumeAllSuspendedTasks();
+  return OkStatus();
+}
+
+}  // namespace pw::thread
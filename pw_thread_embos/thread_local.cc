@@ -0,0 +1,112 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_local.h"
+
+#include <array>
+#include <atomic>
+
+#include "RTOS.h"
+#include "pw_assert/check.h"
+#include "pw_thread_embos/config.h"
+
+namespace pw::thread::backend {
+namespace {
+
+// embOS has no task-local storage slots, so each task which sets a value claims
+// an entry from this table, keyed by its task control block. The owner is only
+// written with a compare-exchange when an entry is claimed and when its task
+// terminates, so a task finds its own entry without taking a lock.
+struct ThreadLocalEntry {
+  std::atomic<OS_TASK*> owner;
+  std::array<void*, embos::config::kMaxThreadLocals> values;
+};
+
+std::array<ThreadLocalEntry, embos::config::kThreadLocalMaxTasks> entries;
+
+OS_ON_TERMINATE_HOOK terminate_hook;
+bool terminate_hook_added = false;
+
+ThreadLocalEntry* FindEntry(OS_TASK* task) {
+  for (ThreadLocalEntry& entry : entries) {
+    if (entry.owner.load(std::memory_order_relaxed) == task) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// Frees the entry of a terminated task, so neither its values nor its entry are
+// inherited by a later task which reuses the task control block.
+void ReleaseEntry(OS_CONST_PTR OS_TASK* task) {
+  ThreadLocalEntry* const entry = FindEntry(const_cast<OS_TASK*>(task));
+  if (entry == nullptr) {
+    return;
+  }
+  entry->values.fill(nullptr);
+  entry->owner.store(nullptr, std::memory_order_release);
+}
+
+ThreadLocalEntry& ClaimEntry(OS_TASK* task) {
+  OS_SuspendAllTasks();
+  if (!terminate_hook_added) {
+    OS_AddOnTerminateHook(&terminate_hook, ReleaseEntry);
+    terminate_hook_added = true;
+  }
+  OS_ResumeAllSuspendedTasks();
+
+  for (ThreadLocalEntry& entry : entries) {
+    OS_TASK* expected = nullptr;
+    if (entry.owner.compare_exchange_strong(
+            expected, task, std::memory_order_acquire)) {
+      return entry;
+    }
+  }
+  PW_CRASH("Out of pw::thread::ThreadLocal task entries");
+}
+
+}  // namespace
+
+NativeThreadLocalKey AllocateThreadLocalKey() {
+  static std::atomic<size_t> next_key = 0;
+  const size_t key = next_key.fetch_add(1, std::memory_order_relaxed);
+  PW_CHECK_UINT_LT(key,
+                   embos::config::kMaxThreadLocals,
+                   "Out of pw::thread::ThreadLocal slots");
+  return key;
+}
+
+void* GetThreadLocal(NativeThreadLocalKey key) {
+  OS_TASK* const task = OS_GetTaskID();
+  if (task == nullptr) {
+    return nullptr;  // Free entries have a null owner.
+  }
+  const ThreadLocalEntry* const entry = FindEntry(task);
+  return entry == nullptr ? nullptr : entry->values[key];
+}
+
+void SetThreadLocal(NativeThreadLocalKey key, void* value) {
+  OS_TASK* const task = OS_GetTaskID();
+  PW_DCHECK_NOTNULL(task, "Not called from a task");
+  ThreadLocalEntry* entry = FindEntry(task);
+  if (entry == nullptr) {
+    if (value == nullptr) {
+      return;  // Nothing to clear.
+    }
+    entry = &ClaimEntry(task);
+  }
+  entry->values[key] = value;
+}
+
+}  // namespace pw::thread::backend
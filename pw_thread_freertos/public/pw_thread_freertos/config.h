@@ -58,6 +58,20 @@
 #define PW_THREAD_FREERTOS_CONFIG_DEFAULT_PRIORITY (tskIDLE_PRIORITY + 1)
 #endif  // PW_THREAD_FREERTOS_CONFIG_DEFAULT_PRIORITY
 
+// The maximum number of threads which pw::thread::ForEachThread() can report.
+// Iteration reserves a static buffer of this many TaskStatus_t.
+#ifndef PW_THREAD_FREERTOS_CONFIG_THREAD_ITERATION_MAX_THREADS
+#define PW_THREAD_FREERTOS_CONFIG_THREAD_ITERATION_MAX_THREADS 16
+#endif  // PW_THREAD_FREERTOS_CONFIG_THREAD_ITERATION_MAX_THREADS
+
+// The first FreeRTOS thread local storage pointer index used by
+// pw::thread::ThreadLocal. The indices below this are left to the application.
+// Each ThreadLocal uses one index, up to
+// configNUM_THREAD_LOCAL_STORAGE_POINTERS.
+#ifndef PW_THREAD_FREERTOS_CONFIG_THREAD_LOCAL_FIRST_INDEX
+#define PW_THREAD_FREERTOS_CONFIG_THREAD_LOCAL_FIRST_INDEX 0
+#endif  // PW_THREAD_FREERTOS_CONFIG_THREAD_LOCAL_FIRST_INDEX
+
 namespace pw::thread::freertos::config {
 
 inline constexpr size_t kMinimumStackSizeWords = configMINIMAL_STACK_SIZE;
@@ -65,5 +79,9 @@ inline constexpr size_t kDefaultStackSizeWords =
     PW_THREAD_FREERTOS_CONFIG_DEFAULT_STACK_SIZE_WORDS;
 inline constexpr UBaseType_t kDefaultPriority =
     PW_THREAD_FREERTOS_CONFIG_DEFAULT_PRIORITY;
+inline constexpr size_t kThreadIterationMaxThreads =
+    PW_THREAD_FREERTOS_CONFIG_THREAD_ITERATION_MAX_THREADS;
+inline constexpr BaseType_t kThreadLocalFirstIndex =
+    PW_THREAD_FREERTOS_CONFIG_THREAD_LOCAL_FIRST_INDEX;
 
 }  // namespace pw::thread::freertos::config
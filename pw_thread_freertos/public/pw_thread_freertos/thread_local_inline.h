@@ -0,0 +1,30 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "FreeRTOS.h"
+#include "pw_thread/thread_local.h"
+#include "task.h"
+
+namespace pw::thread::backend {
+
+inline void* GetThreadLocal(NativeThreadLocalKey key) {
+  return pvTaskGetThreadLocalStoragePointer(nullptr, key);
+}
+
+inline void SetThreadLocal(NativeThreadLocalKey key, void* value) {
+  vTaskSetThreadLocalStoragePointer(nullptr, key, value);
+}
+
+}  // namespace pw::thread::backend
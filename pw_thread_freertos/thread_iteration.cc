@@ -0,0 +1,106 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_iteration.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <span>
+
+#include "FreeRTOS.h"
+#include "pw_thread_freertos/config.h"
+#include "task.h"
+
+namespace pw::thread {
+
+#if configUSE_TRACE_FACILITY == 1
+
+namespace {
+
+// Older FreeRTOS versions always use a 32-bit run-time counter.
+#ifdef configRUN_TIME_COUNTER_TYPE
+using RunTimeCounter = configRUN_TIME_COUNTER_TYPE;
+#else
+using RunTimeCounter = uint32_t;
+#endif  // configRUN_TIME_COUNTER_TYPE
+
+ThreadInfo ToThreadInfo(const TaskStatus_t& status, uint64_t total_run_time) {
+  ThreadInfo info;
+  info.set_thread_name(std::as_bytes(
+      std::span(status.pcTaskName, std::strlen(status.pcTaskName))));
+
+  const uintptr_t stack_low_addr =
+      reinterpret_cast<uintptr_t>(status.pxStackBase);
+  info.set_stack_low_addr(stack_low_addr);
+
+  // pxTopOfStack is guaranteed to be the first member of the TCB, which the
+  // task handle points to.
+  info.set_stack_pointer(reinterpret_cast<uintptr_t>(
+      *reinterpret_cast<StackType_t* const*>(status.xHandle)));
+
+#if portSTACK_GROWTH < 0
+  // FreeRTOS fills new stacks with tskSTACK_FILL_BYTE, and the high-water mark
+  // is how many words at the end of the stack still hold the fill.
+  info.set_stack_peak_addr(stack_low_addr + status.usStackHighWaterMark *
+                                                sizeof(StackType_t));
+#endif  // portSTACK_GROWTH < 0
+
+#if configGENERATE_RUN_TIME_STATS == 1
+  info.set_run_time(status.ulRunTimeCounter);
+  if (total_run_time != 0) {
+    info.set_cpu_usage_hundredths(static_cast<uint32_t>(
+        uint64_t{status.ulRunTimeCounter} * 10000u / total_run_time));
+  }
+#else
+  static_cast<void>(total_run_time);
+#endif  // configGENERATE_RUN_TIME_STATS == 1
+
+  return info;
+}
+
+// Only used while the scheduler is suspended, so it needs no lock.
+TaskStatus_t task_statuses[freertos::config::kThreadIterationMaxThreads];
+
+}  // namespace
+
+Status ForEachThread(FunctionRef<bool(const ThreadInfo&)> callback) {
+  // Suspend the scheduler, so tasks are not deleted while the callback runs.
+  vTaskSuspendAll();
+
+  // This returns 0 if there are more tasks than fit in the buffer.
+  RunTimeCounter total_run_time = 0;
+  const UBaseType_t task_count = uxTaskGetSystemState(
+      task_statuses, std::size(task_statuses), &total_run_time);
+
+  for (UBaseType_t i = 0; i < task_count; ++i) {
+    if (!callback(ToThreadInfo(task_statuses[i], total_run_time))) {
+      break;
+    }
+  }
+
+  xTaskResumeAll();
+  return task_count == 0 ? Status::ResourceExhausted() : OkStatus();
+}
+
+#else
+
+// uxTaskGetSystemState() requires configUSE_TRACE_FACILITY.
+Status ForEachThread(FunctionRef<bool(const ThreadInfo&)>) {
+  return Status::FailedPrecondition();
+}
+
+#endif  // configUSE_TRACE_FACILITY == 1
+
+}  // namespace pw::thread
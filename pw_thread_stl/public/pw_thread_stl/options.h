@@ -13,14 +13,72 @@
 // the License.
 #pragma once
 
+#include <cstdint>
+
 #include "pw_thread/thread.h"
 
 namespace pw::thread::stl {
 
-// Unfortunately std::thread:attributes was not accepted into the C++ standard.
-// Instead, users are expected to start the thread and after dynamically adjust
-// the thread's attributes using std::thread::native_handle based on the native
-// threading APIs.
-class Options : public thread::Options {};
+// pw::thread::Options for the STL.
+//
+// Unfortunately std::thread:attributes was not accepted into the C++ standard,
+// so these attributes are applied by the new thread itself using the native
+// threading APIs before it runs the thread function. They are only supported
+// on Linux and are ignored on other hosts. Failing to apply them, for example
+// setting a real-time policy without the CAP_SYS_NICE capability, is fatal.
+//
+// The stack size cannot be set, since std::thread always uses the default.
+//
+// Example usage:
+//
+//   // Pins the thread to CPU 3 with a real-time FIFO priority of 50.
+//   pw::thread::Thread rpc_thread(
+//     pw::thread::stl::Options()
+//         .set_cpu_affinity(1u << 3)
+//         .set_scheduling_policy(
+//             pw::thread::stl::Options::SchedulingPolicy::kFifo, 50),
+//     rpc_thread_function);
+//
+class Options : public thread::Options {
+ public:
+  enum class SchedulingPolicy {
+    kDefault,     // Inherit the creating thread's policy and priority.
+    kFifo,        // SCHED_FIFO
+    kRoundRobin,  // SCHED_RR
+  };
+
+  constexpr Options() = default;
+  constexpr Options(const Options&) = default;
+  constexpr Options(Options&& other) = default;
+
+  // Restricts the thread to the CPUs set in cpu_mask, where bit N is CPU N.
+  // A mask of 0, the default, leaves the affinity inherited from the creating
+  // thread.
+  constexpr Options& set_cpu_affinity(uint64_t cpu_mask) {
+    cpu_affinity_ = cpu_mask;
+    return *this;
+  }
+
+  // Sets a real-time scheduling policy and its priority. The priority must be
+  // within the policy's range, which is 1 to 99 on Linux. Higher priority values
+  // have a higher priority.
+  constexpr Options& set_scheduling_policy(SchedulingPolicy policy,
+                                           int priority) {
+    scheduling_policy_ = policy;
+    priority_ = priority;
+    return *this;
+  }
+
+ private:
+  friend thread::Thread;
+
+  uint64_t cpu_affinity() const { return cpu_affinity_; }
+  SchedulingPolicy scheduling_policy() const { return scheduling_policy_; }
+  int priority() const { return priority_; }
+
+  uint64_t cpu_affinity_ = 0;
+  SchedulingPolicy scheduling_policy_ = SchedulingPolicy::kDefault;
+  int priority_ = 0;
+};
 
 }  // namespace pw::thread::stl
@@ -16,6 +16,7 @@
 #include <thread>
 
 #include "pw_chrono/system_clock.h"
+#include "pw_chrono_stl/simulated_time.h"
 #include "pw_thread/sleep.h"
 
 namespace pw::this_thread {
@@ -27,6 +28,10 @@ inline void sleep_for(chrono::SystemClock::duration for_at_least) {
   if (for_at_least == chrono::SystemClock::duration::zero()) {
     return std::this_thread::yield();
   }
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    return sleep_until(
+        chrono::SystemClock::TimePointAfterAtLeast(for_at_least));
+  }
   return std::this_thread::sleep_for(for_at_least);
 }
 
@@ -36,6 +41,11 @@ inline void sleep_until(chrono::SystemClock::time_point until_at_least) {
   if (chrono::SystemClock::now() >= until_at_least) {
     return std::this_thread::yield();
   }
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    chrono::stl::internal::SimulatedWaitUntil(until_at_least,
+                                              [] { return false; });
+    return;
+  }
   return std::this_thread::sleep_until(until_at_least);
 }
 
@@ -15,14 +15,12 @@
 
 #include <thread>
 
+#include "pw_chrono_stl/simulated_time.h"
+
 namespace pw::thread {
 
 inline Thread::Thread() : native_type_() {}
 
-inline Thread::Thread(const Options&, ThreadRoutine entry, void* arg) {
-  native_type_ = std::thread(entry, arg);
-}
-
 inline Thread& Thread::operator=(Thread&& other) {
   native_type_ = std::move(other.native_type_);
   return *this;
@@ -32,9 +30,19 @@ inline Thread::~Thread() = default;
 
 inline Id Thread::get_id() const { return native_type_.get_id(); }
 
-inline void Thread::join() { native_type_.join(); }
+inline void Thread::join() {
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    chrono::stl::internal::SimulatedJoin(native_type_.get_id());
+  }
+  native_type_.join();
+}
 
-inline void Thread::detach() { native_type_.detach(); }
+inline void Thread::detach() {
+  if (chrono::stl::SimulatedTimeEnabled()) {
+    chrono::stl::internal::SimulatedDetach(native_type_.get_id());
+  }
+  native_type_.detach();
+}
 
 inline void Thread::swap(Thread& other) {
   native_type_.swap(other.native_handle());
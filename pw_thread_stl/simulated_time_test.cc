@@ -0,0 +1,122 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_chrono_stl/simulated_time.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_sync/mutex.h"
+#include "pw_thread/sleep.h"
+#include "pw_thread/thread.h"
+#include "pw_thread_stl/options.h"
+
+using namespace std::chrono_literals;
+
+namespace pw::chrono::stl {
+namespace {
+
+// Simulated time jumps ahead while every thread is blocked, so these waits take
+// far less real time than the simulated durations. The real time is only
+// checked loosely, to avoid flakiness on loaded machines.
+constexpr auto kMaxRealTime = std::chrono::seconds(30);
+
+class SimulatedTime : public ::testing::Test {
+ protected:
+  SimulatedTime() {
+    EnableSimulatedTime();
+    real_start_ = std::chrono::steady_clock::now();
+    start_ = SystemClock::now();
+  }
+
+  ~SimulatedTime() {
+    DisableSimulatedTime();
+    EXPECT_LT(std::chrono::steady_clock::now() - real_start_, kMaxRealTime);
+  }
+
+  SystemClock::duration elapsed() const { return SystemClock::now() - start_; }
+
+ private:
+  std::chrono::steady_clock::time_point real_start_;
+  SystemClock::time_point start_;
+};
+
+TEST_F(SimulatedTime, SleepAdvancesClock) {
+  this_thread::sleep_for(1h);
+  EXPECT_GE(elapsed(), 1h);
+  EXPECT_LT(elapsed(), 1h + 1s);
+}
+
+TEST_F(SimulatedTime, ClockDoesNotAdvanceWhileRunning) {
+  const SystemClock::time_point before = SystemClock::now();
+  for (volatile int i = 0; i < 100000; i = i + 1) {
+  }
+  EXPECT_EQ(SystemClock::now(), before);
+}
+
+TEST_F(SimulatedTime, TimedAcquireTimesOut) {
+  sync::BinarySemaphore semaphore;
+  EXPECT_FALSE(semaphore.try_acquire_for(10min));
+  EXPECT_GE(elapsed(), 10min);
+}
+
+struct Sleeper {
+  SystemClock::duration duration;
+  sync::Mutex* mutex;
+  int* wake_order;
+  int woke_at = 0;
+};
+
+void Sleep(void* arg) {
+  Sleeper& sleeper = *static_cast<Sleeper*>(arg);
+  this_thread::sleep_for(sleeper.duration);
+  std::lock_guard lock(*sleeper.mutex);
+  sleeper.woke_at = ++*sleeper.wake_order;
+}
+
+TEST_F(SimulatedTime, ThreadsWakeInDeadlineOrder) {
+  sync::Mutex mutex;
+  int wake_order = 0;
+  Sleeper late = {2h, &mutex, &wake_order};
+  Sleeper early = {1h, &mutex, &wake_order};
+
+  thread::Thread late_thread(thread::stl::Options(), Sleep, &late);
+  thread::Thread early_thread(thread::stl::Options(), Sleep, &early);
+  late_thread.join();
+  early_thread.join();
+
+  EXPECT_EQ(early.woke_at, 1);
+  EXPECT_EQ(late.woke_at, 2);
+  EXPECT_GE(elapsed(), 2h);
+}
+
+void SleepThenRelease(void* semaphore) {
+  this_thread::sleep_for(5min);
+  static_cast<sync::BinarySemaphore*>(semaphore)->release();
+}
+
+TEST_F(SimulatedTime, ReleaseWakesWaiter) {
+  sync::BinarySemaphore semaphore;
+  thread::Thread thread(thread::stl::Options(), SleepThenRelease, &semaphore);
+
+  EXPECT_TRUE(semaphore.try_acquire_for(1h));
+  EXPECT_GE(elapsed(), 5min);
+  EXPECT_LT(elapsed(), 1h);
+  thread.join();
+}
+
+}  // namespace
+}  // namespace pw::chrono::stl
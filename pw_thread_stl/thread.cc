@@ -0,0 +1,102 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread.h"
+
+#include <cstdint>
+#include <thread>
+
+#include "pw_assert/check.h"
+#include "pw_chrono_stl/simulated_time.h"
+#include "pw_thread_stl/options.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif  // defined(__linux__)
+
+namespace pw::thread {
+namespace {
+
+// Applies the attributes to the calling thread.
+void ApplyAttributes([[maybe_unused]] uint64_t cpu_affinity,
+                     [[maybe_unused]] stl::Options::SchedulingPolicy policy,
+                     [[maybe_unused]] int priority) {
+#if defined(__linux__)
+  if (cpu_affinity != 0) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu = 0; cpu < 64; ++cpu) {
+      if ((cpu_affinity & (uint64_t{1} << cpu)) != 0) {
+        CPU_SET(cpu, &cpus);
+      }
+    }
+    PW_CHECK_INT_EQ(pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus),
+                    0,
+                    "Failed to set the thread's CPU affinity");
+  }
+
+  if (policy != stl::Options::SchedulingPolicy::kDefault) {
+    sched_param param = {};
+    param.sched_priority = priority;
+    PW_CHECK_INT_EQ(
+        pthread_setschedparam(
+            pthread_self(),
+            policy == stl::Options::SchedulingPolicy::kFifo ? SCHED_FIFO
+                                                             : SCHED_RR,
+            &param),
+        0,
+        "Failed to set the thread's scheduling policy");
+  }
+#endif  // defined(__linux__)
+}
+
+}  // namespace
+
+Thread::Thread(const thread::Options& facade_options,
+               ThreadRoutine entry,
+               void* arg) {
+  // Cast the generic facade options to the backend specific option of which
+  // only one type can exist at compile time.
+  const auto& options = static_cast<const stl::Options&>(facade_options);
+  const uint64_t cpu_affinity = options.cpu_affinity();
+  const stl::Options::SchedulingPolicy policy = options.scheduling_policy();
+  const int priority = options.priority();
+
+  // The attributes are applied by the new thread before it runs entry, so that
+  // none of entry runs with the wrong attributes.
+  //
+  // Threads started while simulated time is enabled take part in it until they
+  // exit, so the clock cannot advance while they are running.
+  const bool simulated = chrono::stl::SimulatedTimeEnabled();
+  if (simulated) {
+    chrono::stl::internal::SimulatedThreadCreating();
+  }
+  native_type_ =
+      std::thread([cpu_affinity, policy, priority, entry, arg, simulated] {
+        if (simulated) {
+          chrono::stl::internal::SimulatedThreadEntered();
+        }
+        ApplyAttributes(cpu_affinity, policy, priority);
+        entry(arg);
+        if (simulated) {
+          chrono::stl::internal::SimulatedThreadExiting();
+        }
+      });
+  if (simulated) {
+    chrono::stl::internal::SimulatedThreadCreated(native_type_.get_id());
+  }
+}
+
+}  // namespace pw::thread
@@ -0,0 +1,35 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "tx_api.h"
+
+namespace pw::thread::backend {
+
+// The values are stored in an array which the application adds to every
+// TX_THREAD in tx_user.h, which is where the number of slots is chosen:
+//
+//   #define TX_THREAD_USER_EXTENSION void* pw_thread_local_values[4];
+//
+// tx_thread_create() zeroes the control block, so every thread starts with all
+// of its values unset.
+inline constexpr size_t kMaxThreadLocals =
+    sizeof(TX_THREAD::pw_thread_local_values) / sizeof(void*);
+
+// The index into TX_THREAD::pw_thread_local_values.
+using NativeThreadLocalKey = size_t;
+
+}  // namespace pw::thread::backend
@@ -0,0 +1,136 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_thread/thread_iteration.h"
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "pw_assert/check.h"
+#include "tx_api.h"
+#include "tx_thread.h"
+
+#ifdef TX_EXECUTION_PROFILE_ENABLE
+#include "tx_execution_profile.h"
+#endif  // TX_EXECUTION_PROFILE_ENABLE
+
+namespace pw::thread {
+namespace {
+
+#ifndef TX_DISABLE_STACK_FILLING
+
+// ThreadX fills each stack with TX_STACK_FILL when the thread is created. The
+// deepest point the stack has reached is just past the last word, counting up
+// from the end of the stack, which still holds the fill.
+uintptr_t FindStackPeak(const TX_THREAD& thread) {
+  const ULONG* word = static_cast<const ULONG*>(thread.tx_thread_stack_start);
+  const ULONG* const stack_end =
+      reinterpret_cast<const ULONG*>(thread.tx_thread_stack_end);
+  while (word < stack_end && *word == TX_STACK_FILL) {
+    ++word;
+  }
+  return reinterpret_cast<uintptr_t>(word);
+}
+
+#endif  // TX_DISABLE_STACK_FILLING
+
+#ifdef TX_EXECUTION_PROFILE_ENABLE
+
+uint64_t TotalExecutionTime() {
+  EXECUTION_TIME threads = 0;
+  EXECUTION_TIME idle = 0;
+  EXECUTION_TIME isr = 0;
+  _tx_execution_thread_total_time_get(&threads);
+  _tx_execution_idle_time_get(&idle);
+  _tx_execution_isr_time_get(&isr);
+  return threads + idle + isr;
+}
+
+#endif  // TX_EXECUTION_PROFILE_ENABLE
+
+ThreadInfo ToThreadInfo(TX_THREAD& thread,
+                        [[maybe_unused]] uint64_t total_time) {
+  ThreadInfo info;
+  if (thread.tx_thread_name != nullptr) {
+    info.set_thread_name(std::as_bytes(
+        std::span(thread.tx_thread_name, std::strlen(thread.tx_thread_name))));
+  }
+
+  info.set_stack_low_addr(
+      reinterpret_cast<uintptr_t>(thread.tx_thread_stack_start));
+  // tx_thread_stack_end is the address of the stack's last byte.
+  info.set_stack_high_addr(
+      reinterpret_cast<uintptr_t>(thread.tx_thread_stack_end) + 1);
+  info.set_stack_pointer(
+      reinterpret_cast<uintptr_t>(thread.tx_thread_stack_ptr));
+#ifndef TX_DISABLE_STACK_FILLING
+  info.set_stack_peak_addr(FindStackPeak(thread));
+#endif  // TX_DISABLE_STACK_FILLING
+
+#ifdef TX_EXECUTION_PROFILE_ENABLE
+  EXECUTION_TIME run_time = 0;
+  _tx_execution_thread_time_get(&thread, &run_time);
+  info.set_run_time(run_time);
+  if (total_time != 0) {
+    info.set_cpu_usage_hundredths(
+        static_cast<uint32_t>(uint64_t{run_time} * 10000u / total_time));
+  }
+#endif  // TX_EXECUTION_PROFILE_ENABLE
+
+  return info;
+}
+
+}  // namespace
+
+Status ForEachThread(FunctionRef<bool(const ThreadInfo&)> callback) {
+  // Raise this thread's preemption threshold as a thread only critical
+  // section, so threads are not created or deleted while they are visited.
+  TX_THREAD* const current_thread = tx_thread_identify();
+  UINT original_preemption_threshold = TX_MAX_PRIORITIES;  // Invalid.
+  if (current_thread != nullptr) {
+    const UINT preemption_success = tx_thread_preemption_change(
+        current_thread, 0, &original_preemption_threshold);
+    PW_DCHECK_UINT_EQ(TX_SUCCESS,
+                      preemption_success,
+                      "Failed to enter thread critical section");
+  }
+
+#ifdef TX_EXECUTION_PROFILE_ENABLE
+  const uint64_t total_time = TotalExecutionTime();
+#else
+  const uint64_t total_time = 0;
+#endif  // TX_EXECUTION_PROFILE_ENABLE
+
+  // The created threads form a circular list.
+  TX_THREAD* thread = _tx_thread_created_ptr;
+  for (ULONG i = 0; i < _tx_thread_created_count; ++i) {
+    if (!callback(ToThreadInfo(*thread, total_time))) {
+      break;
+    }
+    thread = thread->tx_thread_created_next;
+  }
+
+  if (current_thread != nullptr) {
+    UINT unused = 0;
+    const UINT preemption_success = tx_thread_preemption_change(
+        current_thread, original_preemption_threshold, &unused);
+    PW_DCHECK_UINT_EQ(TX_SUCCESS,
+                      preemption_success,
+                      "Failed to leave thread critical section");
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::thread
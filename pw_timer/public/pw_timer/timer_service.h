@@ -0,0 +1,81 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_chrono/system_clock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/timed_thread_notification.h"
+#include "pw_thread/thread_core.h"
+#include "pw_timer/timer_wheel.h"
+
+namespace pw::timer {
+
+// The TimerService runs a TimerWheel on a dedicated thread, which sleeps until
+// the next timer expires and runs the callbacks. It is a ThreadCore, so the
+// thread is started by the user:
+//
+//   pw::timer::TimerService timer_service(std::chrono::milliseconds(1));
+//   pw::thread::Thread(timer_thread_options, timer_service).detach();
+//
+//   pw::timer::Timer retransmit([](auto) { Retransmit(); });
+//   timer_service.ScheduleAfter(retransmit, std::chrono::milliseconds(200));
+//
+// Callbacks run on the service's thread without the lock held, so they may
+// schedule and cancel timers. Slow callbacks delay the timers after them;
+// callbacks which do real work should push it to a pw::work_queue::WorkQueue.
+//
+// This is thread safe, but NOT IRQ safe.
+class TimerService : public thread::ThreadCore {
+ public:
+  explicit TimerService(chrono::SystemClock::duration tick)
+      : stop_requested_(false),
+        wake_time_(chrono::SystemClock::time_point::max()),
+        wheel_(chrono::SystemClock::now(), tick) {}
+
+  // Schedules the timer to expire at the deadline, rescheduling it if it is
+  // already scheduled.
+  void Schedule(Timer& timer, chrono::SystemClock::time_point deadline)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Schedules the timer to expire after at least the delay.
+  void ScheduleAfter(Timer& timer, chrono::SystemClock::duration delay)
+      PW_LOCKS_EXCLUDED(lock_) {
+    Schedule(timer, chrono::SystemClock::TimePointAfterAtLeast(delay));
+  }
+
+  // Cancels the timer. Returns false if it was not scheduled, which includes
+  // a timer whose callback has started. Cancel does not wait for a running
+  // callback, so a timer must not be destroyed while its callback may run.
+  bool Cancel(Timer& timer) PW_LOCKS_EXCLUDED(lock_);
+
+  // Requests the service's thread to return from Run(). Pending timers remain
+  // scheduled but their callbacks are not run.
+  void RequestStop() PW_LOCKS_EXCLUDED(lock_);
+
+ private:
+  void Run() override PW_LOCKS_EXCLUDED(lock_);
+
+  sync::Mutex lock_;
+  bool stop_requested_ PW_GUARDED_BY(lock_);
+
+  // The time the thread is sleeping until. Scheduling an earlier timer wakes
+  // the thread so that it can sleep until the new deadline instead.
+  chrono::SystemClock::time_point wake_time_ PW_GUARDED_BY(lock_);
+  TimerWheel wheel_ PW_GUARDED_BY(lock_);
+
+  sync::TimedThreadNotification wake_;
+};
+
+}  // namespace pw::timer
@@ -0,0 +1,175 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_function/function.h"
+
+namespace pw::timer {
+
+class TimerWheel;
+
+namespace internal {
+
+// Links for the circular, doubly linked lists of timers in the wheel's slots.
+// pw::IntrusiveList is singly linked, which would make cancellation O(n).
+struct TimerLink {
+  TimerLink* next = nullptr;
+  TimerLink* prev = nullptr;
+};
+
+}  // namespace internal
+
+// A Timer calls its callback once the SystemClock reaches the deadline it was
+// scheduled for. The Timer is owned by the user and is linked into a TimerWheel
+// while it is scheduled, so scheduling never allocates. A Timer must not be
+// destroyed or moved while it is scheduled.
+class Timer : private internal::TimerLink {
+ public:
+  // The callback is passed the deadline the timer was scheduled for, which
+  // allows periodic timers to reschedule relative to it without drift.
+  using Callback = Function<void(chrono::SystemClock::time_point deadline)>;
+
+  explicit Timer(Callback&& callback) : callback_(std::move(callback)) {}
+
+  Timer(const Timer&) = delete;
+  Timer& operator=(const Timer&) = delete;
+
+  bool is_scheduled() const { return next != nullptr; }
+
+  // The deadline the timer was most recently scheduled for.
+  chrono::SystemClock::time_point deadline() const { return deadline_; }
+
+ private:
+  friend class TimerWheel;
+  friend class TimerService;
+
+  // pw::Function takes its arguments by rvalue reference, so pass a copy.
+  void Expire() { callback_(chrono::SystemClock::time_point(deadline_)); }
+
+  chrono::SystemClock::time_point deadline_;
+  int64_t expiry_tick_ = 0;
+  uint8_t level_ = 0;
+  uint8_t slot_ = 0;
+  Callback callback_;
+};
+
+// A hierarchical timing wheel, as described by Varghese and Lauck. Scheduling
+// and cancelling a timer are O(1) regardless of how many timers are pending.
+//
+// Time is divided into ticks of a fixed resolution. The wheel has kLevels
+// levels of kSlots slots each; level N holds the timers which expire within
+// kSlots^(N+1) ticks, with one slot per kSlots^N ticks. When the lowest level
+// wraps around, the timers in the next level's current slot are cascaded down
+// into finer slots. Timers further out than the wheel's range are parked in
+// the top level and re-cascaded until they are in range.
+//
+// The wheel does not read a clock itself. Whoever drives it passes in the
+// current time, so a SimulatedSystemClock can be used to fast-forward time
+// deterministically in tests:
+//
+//   pw::chrono::SimulatedSystemClock clock;
+//   pw::timer::TimerWheel wheel(clock.now(), std::chrono::milliseconds(1));
+//
+//   wheel.Schedule(timer, clock.now() + std::chrono::seconds(5));
+//   clock.AdvanceTime(std::chrono::seconds(5));
+//   wheel.RunExpired(clock.now());  // Calls the timer's callback.
+//
+// Timers never expire before their deadline, and expire within one tick after
+// it when the wheel is advanced promptly. Advancing over ticks with no timers
+// is skipped, so a long fast-forward costs O(levels) per cascade.
+//
+// The TimerWheel is not thread safe; see TimerService for a thread safe,
+// self-driving wrapper.
+class TimerWheel {
+ public:
+  static constexpr int kSlotBits = 6;
+  static constexpr int kSlots = 1 << kSlotBits;
+  static constexpr int kLevels = 4;
+
+  // Creates a wheel whose ticks are counted from start. Deadlines are rounded
+  // up to a multiple of tick, which must be positive.
+  TimerWheel(chrono::SystemClock::time_point start,
+             chrono::SystemClock::duration tick);
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  // Schedules the timer to expire at the deadline. A timer which is already
+  // scheduled is rescheduled. A deadline which has already been passed by the
+  // wheel expires on the next call to PopExpired() or RunExpired().
+  void Schedule(Timer& timer, chrono::SystemClock::time_point deadline);
+
+  // Cancels the timer. Returns false if it was not scheduled.
+  bool Cancel(Timer& timer);
+
+  // Advances the wheel to now and removes and returns one expired timer, or
+  // returns nullptr if no timers have expired. The caller is responsible for
+  // running the timer's callback; this lets a caller drop its lock first.
+  Timer* PopExpired(chrono::SystemClock::time_point now);
+
+  // Advances the wheel to now and runs the callbacks of all expired timers.
+  // Callbacks may schedule and cancel timers, including their own. Returns the
+  // number of callbacks which were run.
+  size_t RunExpired(chrono::SystemClock::time_point now);
+
+  // Returns the time by which the wheel next needs to be advanced, or
+  // std::nullopt if no timers are scheduled. This may be earlier than the next
+  // deadline, when timers have to be cascaded down from a higher level.
+  std::optional<chrono::SystemClock::time_point> NextExpiration() const;
+
+  bool empty() const { return scheduled_ == 0; }
+
+ private:
+  static constexpr uint8_t kExpiredLevel = kLevels;
+  static constexpr int64_t kNoTick = INT64_MAX;
+
+  static void PushBack(internal::TimerLink& list, Timer& timer);
+  static bool ListEmpty(const internal::TimerLink& list) {
+    return list.next == &list;
+  }
+
+  // Links the timer into the slot or expired list for its expiry tick.
+  void Insert(Timer& timer);
+
+  // Returns the next tick after current_tick_ at which a slot with timers is
+  // cascaded or expired, or kNoTick.
+  int64_t NextEventTick() const;
+
+  // Cascades the higher levels and expires the lowest level's slot for tick.
+  void ProcessTick(int64_t tick);
+
+  void MoveSlotToExpired(int level, int slot);
+
+  int64_t TicksSinceStart(chrono::SystemClock::time_point time) const {
+    return (time - start_).count();
+  }
+
+  const chrono::SystemClock::time_point start_;
+  const chrono::SystemClock::duration::rep tick_;
+
+  // All ticks up to and including current_tick_ have been processed.
+  int64_t current_tick_;
+  size_t scheduled_;
+
+  // One bit per non-empty slot in each level.
+  uint64_t occupied_[kLevels];
+  internal::TimerLink slots_[kLevels][kSlots];
+  internal::TimerLink expired_;
+};
+
+}  // namespace pw::timer
@@ -0,0 +1,78 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_timer/timer_service.h"
+
+#include <mutex>
+
+namespace pw::timer {
+
+void TimerService::Schedule(Timer& timer,
+                            chrono::SystemClock::time_point deadline) {
+  bool wake = false;
+  {
+    std::lock_guard lock(lock_);
+    wheel_.Schedule(timer, deadline);
+    if (deadline < wake_time_) {
+      wake_time_ = deadline;
+      wake = true;
+    }
+  }
+  if (wake) {
+    wake_.release();
+  }
+}
+
+bool TimerService::Cancel(Timer& timer) {
+  // The thread is not woken; at worst it wakes up once for nothing.
+  std::lock_guard lock(lock_);
+  return wheel_.Cancel(timer);
+}
+
+void TimerService::RequestStop() {
+  {
+    std::lock_guard lock(lock_);
+    stop_requested_ = true;
+  }
+  wake_.release();
+}
+
+void TimerService::Run() {
+  while (true) {
+    lock_.lock();
+    if (stop_requested_) {
+      lock_.unlock();
+      return;
+    }
+
+    if (Timer* timer = wheel_.PopExpired(chrono::SystemClock::now())) {
+      lock_.unlock();
+      timer->Expire();
+      continue;
+    }
+
+    const std::optional<chrono::SystemClock::time_point> next =
+        wheel_.NextExpiration();
+    wake_time_ = next.value_or(chrono::SystemClock::time_point::max());
+    lock_.unlock();
+
+    if (next.has_value()) {
+      wake_.try_acquire_until(next.value());
+    } else {
+      wake_.acquire();
+    }
+  }
+}
+
+}  // namespace pw::timer
@@ -0,0 +1,111 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_timer/timer_service.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_thread/test_threads.h"
+#include "pw_thread/thread.h"
+
+namespace pw::timer {
+namespace {
+
+using namespace std::chrono_literals;
+using chrono::SystemClock;
+
+constexpr SystemClock::duration kTick =
+    std::chrono::ceil<SystemClock::duration>(1ms);
+
+void StopService(TimerService& service, thread::Thread& thread) {
+  service.RequestStop();
+#if PW_THREAD_JOINING_ENABLED
+  thread.join();
+#else
+  thread.detach();
+#endif  // PW_THREAD_JOINING_ENABLED
+  thread::test::WaitUntilDetachedThreadsCleanedUp();
+}
+
+struct Expiry {
+  SystemClock::time_point expired_at;
+  sync::BinarySemaphore done;
+};
+
+TEST(TimerService, RunsCallbackAfterDeadline) {
+  TimerService service(kTick);
+  thread::Thread thread(thread::test::TestOptionsThread0(), service);
+
+  Expiry expiry;
+  Timer timer([&expiry](SystemClock::time_point) {
+    expiry.expired_at = SystemClock::now();
+    expiry.done.release();
+  });
+
+  const SystemClock::time_point deadline = SystemClock::now() + 20 * kTick;
+  service.Schedule(timer, deadline);
+  expiry.done.acquire();
+  EXPECT_GE(expiry.expired_at, deadline);
+  EXPECT_FALSE(timer.is_scheduled());
+
+  StopService(service, thread);
+}
+
+TEST(TimerService, EarlierTimerWakesService) {
+  TimerService service(kTick);
+  thread::Thread thread(thread::test::TestOptionsThread0(), service);
+
+  // The service sleeps until the far timer, so the near one has to wake it.
+  Timer far_timer([](SystemClock::time_point) {});
+  service.ScheduleAfter(far_timer, 1h);
+
+  Expiry expiry;
+  Timer near_timer([&expiry](SystemClock::time_point) {
+    expiry.expired_at = SystemClock::now();
+    expiry.done.release();
+  });
+  service.ScheduleAfter(near_timer, 10 * kTick);
+  EXPECT_TRUE(expiry.done.try_acquire_for(10s));
+  EXPECT_TRUE(far_timer.is_scheduled());
+
+  EXPECT_TRUE(service.Cancel(far_timer));
+  StopService(service, thread);
+}
+
+TEST(TimerService, CancelledTimerDoesNotRun) {
+  TimerService service(kTick);
+  thread::Thread thread(thread::test::TestOptionsThread0(), service);
+
+  Expiry cancelled;
+  Timer cancelled_timer([&cancelled](SystemClock::time_point) {
+    cancelled.done.release();
+  });
+  Expiry expiry;
+  Timer timer([&expiry](SystemClock::time_point) { expiry.done.release(); });
+
+  service.ScheduleAfter(cancelled_timer, 10 * kTick);
+  service.ScheduleAfter(timer, 20 * kTick);
+  EXPECT_TRUE(service.Cancel(cancelled_timer));
+  EXPECT_FALSE(service.Cancel(cancelled_timer));
+
+  expiry.done.acquire();
+  EXPECT_FALSE(cancelled.done.try_acquire());
+
+  StopService(service, thread);
+}
+
+}  // namespace
+}  // namespace pw::timer
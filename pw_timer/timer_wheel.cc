@@ -0,0 +1,234 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_timer/timer_wheel.h"
+
+#include "pw_assert/check.h"
+
+namespace pw::timer {
+namespace {
+
+// The occupancy bitmaps have one bit per slot.
+static_assert(TimerWheel::kSlots == 64);
+
+constexpr int64_t kSlotMask = TimerWheel::kSlots - 1;
+
+// The number of ticks the whole wheel spans.
+constexpr int64_t kWheelRange =
+    int64_t{1} << (TimerWheel::kSlotBits * TimerWheel::kLevels);
+
+constexpr int Shift(int level) { return level * TimerWheel::kSlotBits; }
+
+constexpr uint64_t RotateRight(uint64_t bits, int count) {
+  return count == 0 ? bits : (bits >> count) | (bits << (64 - count));
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel(chrono::SystemClock::time_point start,
+                       chrono::SystemClock::duration tick)
+    : start_(start),
+      tick_(tick.count()),
+      current_tick_(0),
+      scheduled_(0),
+      occupied_{} {
+  PW_CHECK(tick_ > 0, "The timer wheel tick must be positive");
+  for (auto& level : slots_) {
+    for (internal::TimerLink& slot : level) {
+      slot.next = &slot;
+      slot.prev = &slot;
+    }
+  }
+  expired_.next = &expired_;
+  expired_.prev = &expired_;
+}
+
+void TimerWheel::Schedule(Timer& timer,
+                          chrono::SystemClock::time_point deadline) {
+  Cancel(timer);
+
+  // Round up so that the timer never expires before its deadline.
+  const int64_t ticks = TicksSinceStart(deadline);
+  timer.deadline_ = deadline;
+  timer.expiry_tick_ = ticks <= 0 ? 0 : (ticks + tick_ - 1) / tick_;
+  Insert(timer);
+  scheduled_ += 1;
+}
+
+bool TimerWheel::Cancel(Timer& timer) {
+  if (!timer.is_scheduled()) {
+    return false;
+  }
+  timer.prev->next = timer.next;
+  timer.next->prev = timer.prev;
+  timer.next = nullptr;
+  timer.prev = nullptr;
+
+  if (timer.level_ != kExpiredLevel &&
+      ListEmpty(slots_[timer.level_][timer.slot_])) {
+    occupied_[timer.level_] &= ~(uint64_t{1} << timer.slot_);
+  }
+  scheduled_ -= 1;
+  return true;
+}
+
+Timer* TimerWheel::PopExpired(chrono::SystemClock::time_point now) {
+  const int64_t now_tick = TicksSinceStart(now) / tick_;
+
+  // Jump straight to the next tick which has work to do, rather than stepping
+  // through empty slots one tick at a time.
+  while (ListEmpty(expired_) && current_tick_ < now_tick) {
+    const int64_t next_tick = NextEventTick();
+    if (next_tick > now_tick) {
+      current_tick_ = now_tick;
+      break;
+    }
+    current_tick_ = next_tick;
+    ProcessTick(next_tick);
+  }
+
+  if (ListEmpty(expired_)) {
+    return nullptr;
+  }
+  Timer& timer = static_cast<Timer&>(*expired_.next);
+  Cancel(timer);
+  return &timer;
+}
+
+size_t TimerWheel::RunExpired(chrono::SystemClock::time_point now) {
+  size_t count = 0;
+  while (Timer* timer = PopExpired(now)) {
+    timer->Expire();
+    count += 1;
+  }
+  return count;
+}
+
+std::optional<chrono::SystemClock::time_point> TimerWheel::NextExpiration()
+    const {
+  if (!ListEmpty(expired_)) {
+    return start_ + chrono::SystemClock::duration(current_tick_ * tick_);
+  }
+  const int64_t next_tick = NextEventTick();
+  if (next_tick == kNoTick) {
+    return std::nullopt;
+  }
+  return start_ + chrono::SystemClock::duration(next_tick * tick_);
+}
+
+void TimerWheel::PushBack(internal::TimerLink& list, Timer& timer) {
+  timer.next = &list;
+  timer.prev = list.prev;
+  list.prev->next = &timer;
+  list.prev = &timer;
+}
+
+void TimerWheel::Insert(Timer& timer) {
+  const int64_t delta = timer.expiry_tick_ - current_tick_;
+  if (delta <= 0) {
+    timer.level_ = kExpiredLevel;
+    PushBack(expired_, timer);
+    return;
+  }
+
+  // Timers beyond the wheel's range are parked in the top level's furthest
+  // slot. They are reinserted with their real expiry when that slot cascades.
+  int64_t slot_tick = timer.expiry_tick_;
+  if (delta >= kWheelRange) {
+    slot_tick = current_tick_ + kWheelRange - 1;
+  }
+
+  int level = 0;
+  while (level < kLevels - 1 &&
+         (slot_tick - current_tick_) >= (int64_t{1} << Shift(level + 1))) {
+    level += 1;
+  }
+
+  const int slot = static_cast<int>((slot_tick >> Shift(level)) & kSlotMask);
+  timer.level_ = static_cast<uint8_t>(level);
+  timer.slot_ = static_cast<uint8_t>(slot);
+  PushBack(slots_[level][slot], timer);
+  occupied_[level] |= uint64_t{1} << slot;
+}
+
+int64_t TimerWheel::NextEventTick() const {
+  int64_t next_tick = kNoTick;
+
+  // A slot in level N is processed on the ticks which are a multiple of
+  // kSlots^N and whose level N index matches the slot. Find the first occupied
+  // slot after the current tick in each level.
+  for (int level = 0; level < kLevels; ++level) {
+    if (occupied_[level] == 0) {
+      continue;
+    }
+    const int64_t first = (current_tick_ >> Shift(level)) + 1;
+    const uint64_t rotated =
+        RotateRight(occupied_[level], static_cast<int>(first & kSlotMask));
+    const int64_t tick = (first + __builtin_ctzll(rotated)) << Shift(level);
+    if (tick < next_tick) {
+      next_tick = tick;
+    }
+  }
+  return next_tick;
+}
+
+void TimerWheel::ProcessTick(int64_t tick) {
+  // Cascade the higher levels whose slot boundary is at this tick. The timers
+  // are reinserted relative to the new current tick, so they land in lower
+  // levels, or directly in the expired list if they are due now.
+  for (int level = 1; level < kLevels; ++level) {
+    if ((tick & ((int64_t{1} << Shift(level)) - 1)) != 0) {
+      break;
+    }
+    const int slot = static_cast<int>((tick >> Shift(level)) & kSlotMask);
+    internal::TimerLink& list = slots_[level][slot];
+    if (ListEmpty(list)) {
+      continue;
+    }
+
+    // Detach the slot's list before reinserting, since timers may be
+    // reinserted into the same slot.
+    internal::TimerLink cascading;
+    cascading.next = list.next;
+    cascading.prev = list.prev;
+    cascading.next->prev = &cascading;
+    cascading.prev->next = &cascading;
+    list.next = &list;
+    list.prev = &list;
+    occupied_[level] &= ~(uint64_t{1} << slot);
+
+    while (!ListEmpty(cascading)) {
+      Timer& timer = static_cast<Timer&>(*cascading.next);
+      cascading.next = timer.next;
+      timer.next->prev = &cascading;
+      Insert(timer);
+    }
+  }
+
+  MoveSlotToExpired(0, static_cast<int>(tick & kSlotMask));
+}
+
+void TimerWheel::MoveSlotToExpired(int level, int slot) {
+  internal::TimerLink& list = slots_[level][slot];
+  while (!ListEmpty(list)) {
+    Timer& timer = static_cast<Timer&>(*list.next);
+    list.next = timer.next;
+    timer.next->prev = &list;
+    timer.level_ = kExpiredLevel;
+    PushBack(expired_, timer);
+  }
+  occupied_[level] &= ~(uint64_t{1} << slot);
+}
+
+}  // namespace pw::timer
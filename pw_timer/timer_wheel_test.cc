@@ -0,0 +1,246 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_timer/timer_wheel.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "pw_chrono/simulated_system_clock.h"
+
+namespace pw::timer {
+namespace {
+
+using namespace std::chrono_literals;
+using chrono::SystemClock;
+
+constexpr SystemClock::duration kTick =
+    std::chrono::ceil<SystemClock::duration>(1ms);
+
+class TimerWheelTest : public ::testing::Test {
+ protected:
+  TimerWheelTest() : wheel_(clock_.now(), kTick) {}
+
+  // Advances the simulated clock and runs the expired timers.
+  size_t AdvanceBy(SystemClock::duration duration) {
+    clock_.AdvanceTime(duration);
+    return wheel_.RunExpired(clock_.now());
+  }
+
+  chrono::SimulatedSystemClock clock_;
+  TimerWheel wheel_;
+};
+
+struct Expiry {
+  int count = 0;
+  SystemClock::time_point deadline;
+};
+
+TEST_F(TimerWheelTest, EmptyWheel) {
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_FALSE(wheel_.NextExpiration().has_value());
+  EXPECT_EQ(AdvanceBy(1h), 0u);
+}
+
+TEST_F(TimerWheelTest, ExpiresAtDeadline) {
+  Expiry expiry;
+  Timer timer([&expiry](SystemClock::time_point deadline) {
+    expiry.count += 1;
+    expiry.deadline = deadline;
+  });
+
+  const SystemClock::time_point deadline = clock_.now() + 10 * kTick;
+  wheel_.Schedule(timer, deadline);
+  EXPECT_TRUE(timer.is_scheduled());
+  EXPECT_FALSE(wheel_.empty());
+  ASSERT_TRUE(wheel_.NextExpiration().has_value());
+  EXPECT_EQ(wheel_.NextExpiration().value(), deadline);
+
+  EXPECT_EQ(AdvanceBy(9 * kTick), 0u);
+  EXPECT_EQ(expiry.count, 0);
+
+  EXPECT_EQ(AdvanceBy(kTick), 1u);
+  EXPECT_EQ(expiry.count, 1);
+  EXPECT_EQ(expiry.deadline, deadline);
+  EXPECT_FALSE(timer.is_scheduled());
+  EXPECT_TRUE(wheel_.empty());
+
+  EXPECT_EQ(AdvanceBy(1h), 0u);
+  EXPECT_EQ(expiry.count, 1);
+}
+
+TEST_F(TimerWheelTest, PastDeadlineExpiresImmediately) {
+  int count = 0;
+  Timer timer([&count](SystemClock::time_point) { count += 1; });
+
+  AdvanceBy(100 * kTick);
+  wheel_.Schedule(timer, clock_.now() - 10 * kTick);
+  EXPECT_EQ(wheel_.RunExpired(clock_.now()), 1u);
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(TimerWheelTest, Cancel) {
+  int count = 0;
+  Timer timer([&count](SystemClock::time_point) { count += 1; });
+
+  EXPECT_FALSE(wheel_.Cancel(timer));
+  wheel_.Schedule(timer, clock_.now() + 5 * kTick);
+  EXPECT_TRUE(wheel_.Cancel(timer));
+  EXPECT_FALSE(timer.is_scheduled());
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_FALSE(wheel_.NextExpiration().has_value());
+
+  EXPECT_EQ(AdvanceBy(10 * kTick), 0u);
+  EXPECT_EQ(count, 0);
+}
+
+TEST_F(TimerWheelTest, Reschedule) {
+  int count = 0;
+  Timer timer([&count](SystemClock::time_point) { count += 1; });
+
+  wheel_.Schedule(timer, clock_.now() + 5 * kTick);
+  wheel_.Schedule(timer, clock_.now() + 5000 * kTick);
+
+  EXPECT_EQ(AdvanceBy(4999 * kTick), 0u);
+  EXPECT_EQ(AdvanceBy(kTick), 1u);
+  EXPECT_EQ(count, 1);
+}
+
+// Deadlines spread across all levels of the wheel, scheduled out of order.
+constexpr int64_t kTicks[] = {
+    70000, 3, 1, 64, 4096, 63, 262144, 65, 4095, 2000000, 262143, 5000};
+constexpr size_t kTimers = sizeof(kTicks) / sizeof(kTicks[0]);
+
+struct Recorder {
+  SystemClock::time_point start;
+  int64_t expired[kTimers] = {};
+  size_t count = 0;
+};
+
+// Records the tick of its deadline when it expires.
+class RecordingTimer : public Timer {
+ public:
+  RecordingTimer()
+      : Timer([this](SystemClock::time_point deadline) {
+          recorder->expired[recorder->count++] =
+              (deadline - recorder->start) / kTick;
+        }) {}
+
+  Recorder* recorder = nullptr;
+};
+
+TEST_F(TimerWheelTest, ExpiresInDeadlineOrder) {
+  Recorder recorder;
+  recorder.start = clock_.now();
+  RecordingTimer timers[kTimers];
+  for (size_t i = 0; i < kTimers; ++i) {
+    timers[i].recorder = &recorder;
+    wheel_.Schedule(timers[i], recorder.start + kTicks[i] * kTick);
+  }
+
+  // Step through in uneven increments to cross cascades at odd offsets.
+  while (!wheel_.empty()) {
+    const size_t before = recorder.count;
+    AdvanceBy(37 * kTick);
+    const int64_t now_ticks = (clock_.now() - recorder.start) / kTick;
+    for (size_t i = before; i < recorder.count; ++i) {
+      // Nothing expires early, or more than one step late.
+      EXPECT_LE(recorder.expired[i], now_ticks);
+      EXPECT_GT(recorder.expired[i], now_ticks - 37);
+    }
+  }
+
+  ASSERT_EQ(recorder.count, kTimers);
+  for (size_t i = 1; i < kTimers; ++i) {
+    EXPECT_LT(recorder.expired[i - 1], recorder.expired[i]);
+  }
+}
+
+TEST_F(TimerWheelTest, FastForwardBeyondRange) {
+  int count = 0;
+  Timer timer([&count](SystemClock::time_point) { count += 1; });
+
+  // Beyond the 64^4 tick range of the wheel, so the timer is parked in the top
+  // level and cascaded repeatedly.
+  const SystemClock::duration delay = 100'000'000 * kTick;
+  wheel_.Schedule(timer, clock_.now() + delay);
+
+  EXPECT_EQ(AdvanceBy(delay - kTick), 0u);
+  EXPECT_EQ(count, 0);
+  ASSERT_TRUE(wheel_.NextExpiration().has_value());
+  EXPECT_EQ(wheel_.NextExpiration().value(), clock_.now() + kTick);
+
+  EXPECT_EQ(AdvanceBy(kTick), 1u);
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(TimerWheelTest, NextExpirationIsLowerBound) {
+  Timer timer([](SystemClock::time_point) {});
+  const SystemClock::time_point deadline = clock_.now() + 10'000 * kTick;
+  wheel_.Schedule(timer, deadline);
+
+  // Wake up whenever the wheel asks to, as a timer thread would.
+  int wakeups = 0;
+  while (timer.is_scheduled()) {
+    ASSERT_TRUE(wheel_.NextExpiration().has_value());
+    const SystemClock::time_point next = wheel_.NextExpiration().value();
+    ASSERT_LE(next, deadline);
+    clock_.SetTime(next);
+    wheel_.RunExpired(clock_.now());
+    wakeups += 1;
+  }
+  EXPECT_EQ(clock_.now(), deadline);
+  EXPECT_LE(wakeups, TimerWheel::kLevels);
+}
+
+TEST_F(TimerWheelTest, PeriodicTimerReschedulesItself) {
+  struct Periodic {
+    TimerWheel& wheel;
+    Timer* timer;
+    int count;
+  } periodic{wheel_, nullptr, 0};
+
+  Timer timer([&periodic](SystemClock::time_point deadline) {
+    periodic.count += 1;
+    periodic.wheel.Schedule(*periodic.timer, deadline + 100 * kTick);
+  });
+  periodic.timer = &timer;
+  wheel_.Schedule(timer, clock_.now() + 100 * kTick);
+
+  AdvanceBy(1000 * kTick);
+  EXPECT_EQ(periodic.count, 10);
+  EXPECT_TRUE(wheel_.Cancel(timer));
+}
+
+TEST_F(TimerWheelTest, CallbackCancelsOtherTimer) {
+  int second_count = 0;
+  Timer second([&second_count](SystemClock::time_point) { second_count += 1; });
+  struct Canceller {
+    TimerWheel& wheel;
+    Timer& timer;
+  } canceller{wheel_, second};
+  Timer first([&canceller](SystemClock::time_point) {
+    canceller.wheel.Cancel(canceller.timer);
+  });
+
+  // Both expire on the same tick; the first one cancels the second.
+  wheel_.Schedule(first, clock_.now() + 5 * kTick);
+  wheel_.Schedule(second, clock_.now() + 5 * kTick);
+  EXPECT_EQ(AdvanceBy(5 * kTick), 1u);
+  EXPECT_EQ(second_count, 0);
+  EXPECT_TRUE(wheel_.empty());
+}
+
+}  // namespace
+}  // namespace pw::timer
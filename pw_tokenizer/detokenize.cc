@@ -15,7 +15,11 @@
 #include "pw_tokenizer/detokenize.h"
 
 #include <algorithm>
+#include <cstring>
 
+#include "pw_base64/base64.h"
+#include "pw_status/try.h"
+#include "pw_tokenizer/base64.h"
 #include "pw_tokenizer/internal/decode.h"
 
 namespace pw::tokenizer {
@@ -65,6 +69,112 @@ bool IsBetterResult(const DecodingResult& lhs, const DecodingResult& rhs) {
   return lhs.second > rhs.second;
 }
 
+// Text is read from a stream::Reader in chunks of this size.
+constexpr size_t kReadChunkSizeBytes = 4096;
+
+constexpr bool IsBase64Char(char c) {
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+         (c >= '0' && c <= '9') || c == '+' || c == '/' || c == '-' ||
+         c == '_';
+}
+
+// Returns the length of the padded Base64 data at the start of the text, which
+// is a multiple of 4. Sets may_continue if the Base64 data reaches the end of
+// the text, in which case more data could follow in the next chunk.
+size_t Base64Length(std::string_view text, bool& may_continue) {
+  size_t length = 0;
+
+  while (true) {
+    const std::string_view group = text.substr(length, 4);
+
+    size_t chars = 0;
+    while (chars < group.size() && IsBase64Char(group[chars])) {
+      chars += 1;
+    }
+
+    if (chars == 4u) {
+      length += 4;
+      continue;
+    }
+
+    // The final group may be padded: XX== or XXX=.
+    size_t padded = chars;
+    if (chars >= 2u) {
+      while (padded < group.size() && group[padded] == '=') {
+        padded += 1;
+      }
+      if (padded == 4u) {
+        may_continue = false;
+        return length + 4;
+      }
+    }
+
+    may_continue = group.size() < 4u && padded == group.size();
+    return length;
+  }
+}
+
+Status WriteText(stream::Writer& output, std::string_view text) {
+  if (text.empty()) {
+    return OkStatus();
+  }
+  return output.Write(text.data(), text.size());
+}
+
+// Writes the text with prefixed Base64 messages detokenized. Unless at_end is
+// set, stops before a message that may continue past the end of the text.
+// Returns the number of bytes that were processed.
+StatusWithSize DetokenizeBase64Text(const Detokenizer& detokenizer,
+                                    std::string_view text,
+                                    bool at_end,
+                                    stream::Writer& output) {
+  std::vector<std::byte> binary;
+  size_t written = 0;  // End of the text that has been written.
+  size_t position = 0;
+
+  while ((position = text.find(kBase64Prefix, position)) !=
+         std::string_view::npos) {
+    bool may_continue;
+    const size_t length =
+        Base64Length(text.substr(position + sizeof(kBase64Prefix)),
+                     may_continue);
+
+    if (may_continue && !at_end) {
+      break;
+    }
+
+    const size_t message_size = sizeof(kBase64Prefix) + length;
+
+    if (length != 0u) {
+      binary.resize(base64::MaxDecodedSize(length));
+      const size_t binary_size = PrefixedBase64Decode(
+          text.substr(position, message_size), std::span(binary));
+      const DetokenizedString result =
+          detokenizer.Detokenize(binary.data(), binary_size);
+
+      if (!result.matches().empty()) {
+        // Write the plain text before the message, then the message.
+        Status status =
+            WriteText(output, text.substr(written, position - written));
+        if (status.ok()) {
+          status = WriteText(output, result.BestString());
+        }
+        if (!status.ok()) {
+          return StatusWithSize(status, written);
+        }
+        written = position + message_size;
+      }
+    }
+
+    position += message_size;
+  }
+
+  const size_t end = position == std::string_view::npos ? text.size()
+                                                         : position;
+  const Status status = WriteText(output, text.substr(written, end - written));
+  return StatusWithSize(status, status.ok() ? end : written);
+}
+
 }  // namespace
 
 DetokenizedString::DetokenizedString(
@@ -72,7 +182,14 @@ DetokenizedString::DetokenizedString(
     const std::span<const TokenizedStringEntry>& entries,
     const std::span<const uint8_t>& arguments)
     : token_(token), has_token_(true) {
+  // Most tokens have one entry, which needs no sorting.
+  if (entries.size() == 1u) {
+    matches_.push_back(entries[0].first.Format(arguments));
+    return;
+  }
+
   std::vector<DecodingResult> results;
+  results.reserve(entries.size());
 
   for (const auto& [format, date_removed] : entries) {
     results.push_back(DecodingResult{format.Format(arguments), date_removed});
@@ -80,6 +197,7 @@ DetokenizedString::DetokenizedString(
 
   std::sort(results.begin(), results.end(), IsBetterResult);
 
+  matches_.reserve(results.size());
   for (auto& result : results) {
     matches_.push_back(std::move(result.first));
   }
@@ -98,8 +216,30 @@ std::string DetokenizedString::BestStringWithErrors() const {
 }
 
 Detokenizer::Detokenizer(const TokenDatabase& database) {
+  std::vector<TokenDatabase::Entry> sorted;
+  sorted.reserve(database.size());
   for (const auto& entry : database) {
-    database_[entry.token].emplace_back(entry.string, entry.date_removed);
+    sorted.push_back(entry);
+  }
+
+  // Databases are sorted by token, but group the entries in case one is not.
+  std::stable_sort(
+      sorted.begin(),
+      sorted.end(),
+      [](const TokenDatabase::Entry& lhs, const TokenDatabase::Entry& rhs) {
+        return lhs.token < rhs.token;
+      });
+
+  entries_.reserve(sorted.size());
+  database_.reserve(sorted.size());
+
+  for (const TokenDatabase::Entry& entry : sorted) {
+    EntryRange& range =
+        database_.try_emplace(entry.token,
+                              EntryRange{uint32_t(entries_.size()), 0})
+            .first->second;
+    range.count += 1;
+    entries_.emplace_back(entry.string, entry.date_removed);
   }
 }
 
@@ -115,11 +255,81 @@ DetokenizedString Detokenizer::Detokenize(
 
   const auto result = database_.find(token);
 
-  return DetokenizedString(token,
-                           result == database_.end()
-                               ? std::span<TokenizedStringEntry>()
-                               : std::span(result->second),
-                           encoded.subspan(sizeof(token)));
+  return DetokenizedString(
+      token,
+      result == database_.end()
+          ? std::span<const TokenizedStringEntry>()
+          : std::span(entries_).subspan(result->second.index,
+                                        result->second.count),
+      encoded.subspan(sizeof(token)));
+}
+
+Status Detokenizer::DetokenizeBase64(std::string_view text,
+                                     stream::Writer& output) const {
+  return DetokenizeBase64Text(*this, text, /*at_end=*/true, output).status();
+}
+
+Status Detokenizer::DetokenizeBase64(stream::Reader& input,
+                                     stream::Writer& output) const {
+  // Text that could not be processed yet is kept at the start of the buffer and
+  // new data is read after it.
+  std::vector<char> buffer;
+  size_t buffered = 0;
+
+  while (true) {
+    buffer.resize(buffered + kReadChunkSizeBytes);
+    const Result<ByteSpan> read =
+        input.Read(&buffer[buffered], kReadChunkSizeBytes);
+
+    if (read.status().IsOutOfRange()) {
+      break;
+    }
+    PW_TRY(read.status());
+    buffered += read.value().size();
+
+    const StatusWithSize result = DetokenizeBase64Text(
+        *this, std::string_view(buffer.data(), buffered), false, output);
+    PW_TRY(result.status());
+
+    buffered -= result.size();
+    std::memmove(buffer.data(), &buffer[result.size()], buffered);
+  }
+
+  return DetokenizeBase64Text(
+             *this, std::string_view(buffer.data(), buffered), true, output)
+      .status();
+}
+
+Status DetokenizingWriter::DoWrite(ConstByteSpan data) {
+  const std::string_view text(reinterpret_cast<const char*>(data.data()),
+                              data.size());
+
+  // Without held-back text, process the data in place and keep what is left.
+  if (pending_.empty()) {
+    const StatusWithSize result =
+        DetokenizeBase64Text(detokenizer_, text, /*at_end=*/false, output_);
+    PW_TRY(result.status());
+    pending_.assign(text.substr(result.size()));
+    return OkStatus();
+  }
+
+  pending_.append(text);
+  return ProcessPending(/*at_end=*/pending_.size() > kMaxPendingBytes);
+}
+
+Status DetokenizingWriter::Flush() {
+  return ProcessPending(/*at_end=*/true);
+}
+
+Status DetokenizingWriter::ProcessPending(bool at_end) {
+  const StatusWithSize result =
+      DetokenizeBase64Text(detokenizer_, pending_, at_end, output_);
+  if (!result.ok()) {
+    pending_.clear();
+    return result.status();
+  }
+  pending_.erase(0, result.size());
+  return OkStatus();
 }
 
 }  // namespace pw::tokenizer
@@ -14,9 +14,12 @@
 
 #include "pw_tokenizer/detokenize.h"
 
+#include <array>
+#include <string>
 #include <string_view>
 
 #include "gtest/gtest.h"
+#include "pw_stream/memory_stream.h"
 
 namespace pw::tokenizer {
 namespace {
@@ -54,6 +57,15 @@ TEST_F(Detokenize, NoFormatting) {
   EXPECT_EQ(detok_.Detokenize("\xff\xee\xee\xdd"sv).BestString(), "FOUR");
 }
 
+TEST_F(Detokenize, CopiedDetokenizer) {
+  const Detokenizer copy = detok_;
+  detok_ = Detokenizer(TokenDatabase());
+
+  EXPECT_EQ(copy.Detokenize("\1\0\0\0"sv).BestString(), "One");
+  EXPECT_EQ(copy.Detokenize("\xff\xee\xee\xdd"sv).BestString(), "FOUR");
+  EXPECT_TRUE(detok_.Detokenize("\1\0\0\0"sv).BestString().empty());
+}
+
 TEST_F(Detokenize, BestString_MissingToken_IsEmpty) {
   EXPECT_FALSE(detok_.Detokenize("").ok());
   EXPECT_TRUE(detok_.Detokenize("", 0u).BestString().empty());
@@ -97,6 +109,150 @@ TEST_F(Detokenize, BestStringWithErrors_UnknownToken_ErrorMessage) {
             ERR("unknown token fedcba98"));
 }
 
+// Collects written text in a std::string.
+class StringWriter : public stream::Writer {
+ public:
+  const std::string& text() const { return text_; }
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    text_.append(reinterpret_cast<const char*>(data.data()), data.size());
+    return OkStatus();
+  }
+
+  std::string text_;
+};
+
+TEST_F(Detokenize, DetokenizeBase64_ReplacesMessages) {
+  StringWriter output;
+  ASSERT_EQ(OkStatus(),
+            detok_.DetokenizeBase64("Hi $AQAAAA== and $BQAAAA==!"sv, output));
+  EXPECT_EQ(output.text(), "Hi One and TWO!");
+}
+
+TEST_F(Detokenize, DetokenizeBase64_AdjacentMessages) {
+  StringWriter output;
+  ASSERT_EQ(OkStatus(),
+            detok_.DetokenizeBase64("$/wAAAA==$AQAAAA==$/+7u3Q=="sv, output));
+  EXPECT_EQ(output.text(), "333OneFOUR");
+}
+
+TEST_F(Detokenize, DetokenizeBase64_UnknownAndInvalid_Unchanged) {
+  constexpr std::string_view kText = "$AgAAAA== $ $$ $AQ= $AQAA= no tokens $"sv;
+
+  StringWriter output;
+  ASSERT_EQ(OkStatus(), detok_.DetokenizeBase64(kText, output));
+  EXPECT_EQ(output.text(), kText);
+}
+
+TEST_F(Detokenize, DetokenizeBase64_WriteError) {
+  std::array<std::byte, 3> buffer;
+  stream::MemoryWriter output(buffer);
+  EXPECT_EQ(Status::ResourceExhausted(),
+            detok_.DetokenizeBase64("$/+7u3Q== is too long"sv, output));
+}
+
+TEST_F(Detokenize, DetokenizeBase64_FromReader_SplitsMessagesAcrossReads) {
+  // Offset the messages by different amounts so some cross read boundaries.
+  std::string input;
+  std::string expected;
+  for (int i = 0; i < 500; ++i) {
+    input.append(std::string(i % 7, '.'));
+    input.append("$AQAAAA==$BQAAAA==\n");
+    expected.append(std::string(i % 7, '.'));
+    expected.append("OneTWO\n");
+  }
+  input.append("$/+7u3Q==");
+  expected.append("FOUR");
+
+  stream::MemoryReader reader(std::as_bytes(std::span(input)));
+  StringWriter output;
+  ASSERT_EQ(OkStatus(), detok_.DetokenizeBase64(reader, output));
+  EXPECT_EQ(output.text(), expected);
+}
+
+TEST_F(Detokenize, DetokenizeBase64_FromReader_Empty) {
+  stream::MemoryReader reader(ConstByteSpan{});
+  StringWriter output;
+  ASSERT_EQ(OkStatus(), detok_.DetokenizeBase64(reader, output));
+  EXPECT_TRUE(output.text().empty());
+}
+
+Status WriteText(stream::Writer& writer, std::string_view text) {
+  return writer.Write(text.data(), text.size());
+}
+
+TEST_F(Detokenize, DetokenizingWriter_PassesThroughText) {
+  StringWriter output;
+  DetokenizingWriter writer(detok_, output);
+  ASSERT_EQ(OkStatus(), WriteText(writer, "Hi $AQAAAA== and $BQAAAA==!\n"));
+  EXPECT_EQ(output.text(), "Hi One and TWO!\n");
+  EXPECT_EQ(writer.pending_bytes(), 0u);
+}
+
+TEST_F(Detokenize, DetokenizingWriter_SplitsMessagesAtEveryPosition) {
+  constexpr std::string_view kInput = "a $/wAAAA==$AQAAAA== b $/+7u3Q==\n"sv;
+
+  for (size_t split = 0; split <= kInput.size(); ++split) {
+    StringWriter output;
+    DetokenizingWriter writer(detok_, output);
+    ASSERT_EQ(OkStatus(), WriteText(writer, kInput.substr(0, split)));
+    ASSERT_EQ(OkStatus(), WriteText(writer, kInput.substr(split)));
+    EXPECT_EQ(output.text(), "a 333One b FOUR\n");
+  }
+}
+
+TEST_F(Detokenize, DetokenizingWriter_OneByteAtATime) {
+  constexpr std::string_view kInput = "$AQAAAA==, $BQAAAA== $ $$ $AQ= x\n"sv;
+
+  StringWriter output;
+  DetokenizingWriter writer(detok_, output);
+  for (char c : kInput) {
+    ASSERT_EQ(OkStatus(), WriteText(writer, std::string_view(&c, 1)));
+  }
+  EXPECT_EQ(output.text(), "One, TWO $ $$ $AQ= x\n");
+}
+
+TEST_F(Detokenize, DetokenizingWriter_HoldsBackUntilFlush) {
+  StringWriter output;
+  DetokenizingWriter writer(detok_, output);
+
+  // The message could continue, so it is held back.
+  ASSERT_EQ(OkStatus(), WriteText(writer, "Done: $AQAAAA=="));
+  EXPECT_EQ(output.text(), "Done: One");
+  ASSERT_EQ(OkStatus(), WriteText(writer, "text $BQAA"));
+  EXPECT_EQ(output.text(), "Done: Onetext ");
+  EXPECT_EQ(writer.pending_bytes(), 5u);
+
+  ASSERT_EQ(OkStatus(), writer.Flush());
+  EXPECT_EQ(output.text(), "Done: Onetext $BQAA");
+  EXPECT_EQ(writer.pending_bytes(), 0u);
+}
+
+TEST_F(Detokenize, DetokenizingWriter_LongRunIsNotHeldForever) {
+  StringWriter output;
+  DetokenizingWriter writer(detok_, output);
+
+  // The prefix and run fill the pending buffer exactly.
+  const std::string run(DetokenizingWriter::kMaxPendingBytes - 1, 'A');
+  ASSERT_EQ(OkStatus(), WriteText(writer, "$"));
+  ASSERT_EQ(OkStatus(), WriteText(writer, run));
+  EXPECT_TRUE(output.text().empty());
+
+  ASSERT_EQ(OkStatus(), WriteText(writer, "AAAA"));
+  EXPECT_EQ(output.text(), "$" + run + "AAAA");
+  EXPECT_EQ(writer.pending_bytes(), 0u);
+}
+
+TEST_F(Detokenize, DetokenizingWriter_WriteError) {
+  std::array<std::byte, 3> buffer;
+  stream::MemoryWriter output(buffer);
+  DetokenizingWriter writer(detok_, output);
+  EXPECT_EQ(Status::ResourceExhausted(),
+            WriteText(writer, "$/+7u3Q== is too long"));
+  EXPECT_EQ(writer.pending_bytes(), 0u);
+}
+
 alignas(TokenDatabase::RawEntry) constexpr char kDataWithArguments[] =
     "TOKENS\0\0"
     "\x09\x00\x00\x00"
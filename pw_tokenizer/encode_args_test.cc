@@ -0,0 +1,118 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_tokenizer/encode_args.h"
+
+#include <array>
+#include <cstdarg>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace pw::tokenizer {
+namespace {
+
+enum Color : uint8_t { kRed = 1, kBlue = 200 };
+enum class Size : int64_t { kHuge = int64_t{1} << 40 };
+
+static_assert(kAllIntegerArgs<>);
+static_assert(kAllIntegerArgs<int, unsigned, char, bool, short>);
+static_assert(kAllIntegerArgs<long long, uint64_t, Color, Size>);
+static_assert(kAllIntegerArgs<void*, std::nullptr_t, int*>);
+static_assert(!kAllIntegerArgs<int, double>);
+static_assert(!kAllIntegerArgs<float>);
+static_assert(!kAllIntegerArgs<const char*, int>);
+static_assert(!kAllIntegerArgs<int, char*>);
+
+size_t EncodeVarargs(std::span<std::byte> output,
+                     pw_tokenizer_ArgTypes types,
+                     ...) {
+  va_list args;
+  va_start(args, types);
+  const size_t size = EncodeArgs(types, args, output);
+  va_end(args);
+  return size;
+}
+
+// Encodes the arguments with both EncodeArgs and EncodeIntegerArgs into
+// buffers of the given size and checks that the results match. Bytes past the
+// encoded size are not compared, since EncodeArgs may partially write an
+// argument that does not fit.
+#define EXPECT_SAME_ENCODING(buffer_size, ...)                               \
+  do {                                                                       \
+    std::array<std::byte, buffer_size> expected{};                           \
+    std::array<std::byte, buffer_size> actual{};                             \
+    const size_t expected_size =                                             \
+        EncodeVarargs(expected,                                              \
+                      PW_TOKENIZER_ARG_TYPES(__VA_ARGS__)                    \
+                          PW_COMMA_ARGS(__VA_ARGS__));                       \
+    const size_t actual_size = EncodeIntegerArgs(actual, __VA_ARGS__);       \
+    ASSERT_EQ(expected_size, actual_size);                                   \
+    EXPECT_EQ(std::memcmp(expected.data(), actual.data(), actual_size), 0);  \
+  } while (0)
+
+TEST(EncodeIntegerArgs, NoArguments) {
+  std::array<std::byte, 4> buffer{};
+  EXPECT_EQ(EncodeIntegerArgs(buffer), 0u);
+}
+
+TEST(EncodeIntegerArgs, SmallIntegers) {
+  std::array<std::byte, 8> buffer{};
+  ASSERT_EQ(EncodeIntegerArgs(buffer, 0, -1, 1, 63, -64), 5u);
+  EXPECT_EQ(buffer[0], std::byte{0});
+  EXPECT_EQ(buffer[1], std::byte{1});
+  EXPECT_EQ(buffer[2], std::byte{2});
+  EXPECT_EQ(buffer[3], std::byte{126});
+  EXPECT_EQ(buffer[4], std::byte{127});
+}
+
+TEST(EncodeIntegerArgs, MatchesEncodeArgs_Int) {
+  EXPECT_SAME_ENCODING(32, 0, 1, -1, 64, -65);
+  EXPECT_SAME_ENCODING(32,
+                       std::numeric_limits<int>::min(),
+                       std::numeric_limits<int>::max(),
+                       std::numeric_limits<unsigned>::max());
+  EXPECT_SAME_ENCODING(16, 'a', static_cast<signed char>(-3), true, false);
+  EXPECT_SAME_ENCODING(16, static_cast<short>(-300), uint16_t{65535});
+  EXPECT_SAME_ENCODING(16, kRed, kBlue);
+}
+
+TEST(EncodeIntegerArgs, MatchesEncodeArgs_Int64) {
+  EXPECT_SAME_ENCODING(32,
+                       std::numeric_limits<int64_t>::min(),
+                       std::numeric_limits<int64_t>::max());
+  EXPECT_SAME_ENCODING(32, uint64_t{1} << 63, -1ll, Size::kHuge);
+  EXPECT_SAME_ENCODING(32, 1, int64_t{-2}, 3u, uint64_t{4});
+}
+
+TEST(EncodeIntegerArgs, MatchesEncodeArgs_Pointers) {
+  int value = 0;
+  EXPECT_SAME_ENCODING(32, &value, static_cast<void*>(nullptr), nullptr);
+}
+
+TEST(EncodeIntegerArgs, MatchesEncodeArgs_Truncated) {
+  // The second argument does not fit, so neither it nor the third is encoded.
+  EXPECT_SAME_ENCODING(3, 1, 100000, 2);
+  EXPECT_SAME_ENCODING(1, 1000);
+  EXPECT_SAME_ENCODING(9, std::numeric_limits<int64_t>::min(), 1);
+}
+
+TEST(EncodeIntegerArgs, EmptyBuffer_EncodesNothing) {
+  EXPECT_EQ(EncodeIntegerArgs(std::span<std::byte>(), 1, 2, 3), 0u);
+}
+
+}  // namespace
+}  // namespace pw::tokenizer
@@ -0,0 +1,180 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Tests PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD with
+// PW_TOKENIZER_CFG_ENCODE_IN_PLACE enabled. This test is built with its own
+// copy of tokenize_to_global_handler_with_payload.cc.
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_tokenizer/tokenize_to_global_handler_with_payload.h"
+
+static_assert(PW_TOKENIZER_CFG_ENCODE_IN_PLACE,
+              "This test requires PW_TOKENIZER_CFG_ENCODE_IN_PLACE");
+
+namespace pw::tokenizer {
+namespace {
+
+// Constructs an array with the hashed string followed by the provided bytes.
+template <uint8_t... data, size_t kSize>
+constexpr auto ExpectedData(const char (&format)[kSize]) {
+  const uint32_t value = Hash(format);
+  return std::array<uint8_t, sizeof(uint32_t) + sizeof...(data)>{
+      static_cast<uint8_t>(value & 0xff),
+      static_cast<uint8_t>(value >> 8 & 0xff),
+      static_cast<uint8_t>(value >> 16 & 0xff),
+      static_cast<uint8_t>(value >> 24 & 0xff),
+      data...};
+}
+
+// The global handler backend encodes into buffer_. Tests set the size of the
+// buffer that is provided, or null to drop messages.
+class TokenizeInPlace : public ::testing::Test {
+ public:
+  static uint8_t* Acquire(pw_tokenizer_Payload payload, size_t* size) {
+    acquired_payload_ = payload;
+    acquired_ += 1;
+    *size = buffer_size_;
+    return provide_buffer_ ? buffer_.data() : nullptr;
+  }
+
+  static void Release(pw_tokenizer_Payload payload,
+                      uint8_t* buffer,
+                      size_t size) {
+    EXPECT_EQ(payload, acquired_payload_);
+    EXPECT_EQ(buffer, buffer_.data());
+    released_ += 1;
+    released_size_ = size;
+  }
+
+ protected:
+  TokenizeInPlace() {
+    buffer_.fill(0);
+    buffer_size_ = buffer_.size();
+    provide_buffer_ = true;
+    acquired_payload_ = 0;
+    acquired_ = 0;
+    released_ = 0;
+    released_size_ = 0;
+  }
+
+  static std::array<uint8_t, 64> buffer_;
+  static size_t buffer_size_;
+  static bool provide_buffer_;
+
+  static pw_tokenizer_Payload acquired_payload_;
+  static int acquired_;
+  static int released_;
+  static size_t released_size_;
+};
+
+std::array<uint8_t, 64> TokenizeInPlace::buffer_;
+size_t TokenizeInPlace::buffer_size_;
+bool TokenizeInPlace::provide_buffer_;
+pw_tokenizer_Payload TokenizeInPlace::acquired_payload_;
+int TokenizeInPlace::acquired_;
+int TokenizeInPlace::released_;
+size_t TokenizeInPlace::released_size_;
+
+TEST_F(TokenizeInPlace, EncodesIntoAcquiredBuffer) {
+  PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD(
+      static_cast<pw_tokenizer_Payload>(5432), "The answer is: %s", "5432!");
+
+  constexpr auto expected =
+      ExpectedData<5, '5', '4', '3', '2', '!'>("The answer is: %s");
+
+  EXPECT_EQ(acquired_, 1);
+  ASSERT_EQ(released_, 1);
+  EXPECT_EQ(acquired_payload_, 5432u);
+  ASSERT_EQ(released_size_, expected.size());
+  EXPECT_EQ(std::memcmp(expected.data(), buffer_.data(), expected.size()), 0);
+}
+
+TEST_F(TokenizeInPlace, SmallBuffer_TruncatesArguments) {
+  buffer_size_ = 7;
+
+  PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD(
+      static_cast<pw_tokenizer_Payload>(1), "The answer is: %s", "5432!");
+
+  // The string is truncated to 2 characters, which sets the length's top bit.
+  constexpr auto expected =
+      ExpectedData<0x82, '5', '4'>("The answer is: %s");
+
+  ASSERT_EQ(released_, 1);
+  ASSERT_EQ(released_size_, expected.size());
+  EXPECT_EQ(std::memcmp(expected.data(), buffer_.data(), expected.size()), 0);
+}
+
+TEST_F(TokenizeInPlace, Integers) {
+  PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD(
+      static_cast<pw_tokenizer_Payload>(2), "%d %lld", -1, -65ll);
+
+  constexpr auto expected = ExpectedData<1, 0x81, 0x01>("%d %lld");
+
+  EXPECT_EQ(acquired_, 1);
+  ASSERT_EQ(released_, 1);
+  EXPECT_EQ(acquired_payload_, 2u);
+  ASSERT_EQ(released_size_, expected.size());
+  EXPECT_EQ(std::memcmp(expected.data(), buffer_.data(), expected.size()), 0);
+}
+
+TEST_F(TokenizeInPlace, SmallBuffer_DropsIntegersThatDoNotFit) {
+  buffer_size_ = 6;
+
+  PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD(
+      static_cast<pw_tokenizer_Payload>(1), "%d %d %d", 1, 100000, 2);
+
+  constexpr auto expected = ExpectedData<2>("%d %d %d");
+
+  ASSERT_EQ(released_, 1);
+  ASSERT_EQ(released_size_, expected.size());
+  EXPECT_EQ(std::memcmp(expected.data(), buffer_.data(), expected.size()), 0);
+}
+
+TEST_F(TokenizeInPlace, BufferTooSmallForToken_ReleasedEmpty) {
+  buffer_size_ = 3;
+
+  PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD(
+      static_cast<pw_tokenizer_Payload>(1), "Hello");
+
+  ASSERT_EQ(released_, 1);
+  EXPECT_EQ(released_size_, 0u);
+  EXPECT_EQ(buffer_[0], 0u);
+}
+
+TEST_F(TokenizeInPlace, NullBuffer_Dropped) {
+  provide_buffer_ = false;
+
+  PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD(
+      static_cast<pw_tokenizer_Payload>(1), "Hello %d", 1);
+
+  EXPECT_EQ(acquired_, 1);
+  EXPECT_EQ(released_, 0);
+}
+
+extern "C" uint8_t* pw_tokenizer_AcquireEncodeBufferWithPayload(
+    pw_tokenizer_Payload payload, size_t* buffer_size_bytes) {
+  return TokenizeInPlace::Acquire(payload, buffer_size_bytes);
+}
+
+extern "C" void pw_tokenizer_ReleaseEncodeBufferWithPayload(
+    pw_tokenizer_Payload payload, uint8_t* buffer, size_t size_bytes) {
+  TokenizeInPlace::Release(payload, buffer, size_bytes);
+}
+
+}  // namespace
+}  // namespace pw::tokenizer
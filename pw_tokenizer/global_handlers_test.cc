@@ -76,6 +76,14 @@ TEST_F(TokenizeToGlobalHandler, Variety) {
   EXPECT_EQ(std::memcmp(expected.data(), message_, expected.size()), 0);
 }
 
+TEST_F(TokenizeToGlobalHandler, Integers) {
+  PW_TOKENIZE_TO_GLOBAL_HANDLER("%d %u %lld", -1, 1u, -65ll);
+  constexpr std::array<uint8_t, 8> expected =
+      ExpectedData<1, 2, 0x81, 0x01>("%d %u %lld");
+  ASSERT_EQ(expected.size(), message_size_bytes_);
+  EXPECT_EQ(std::memcmp(expected.data(), message_, expected.size()), 0);
+}
+
 TEST_F(TokenizeToGlobalHandler, Strings) {
   PW_TOKENIZE_TO_GLOBAL_HANDLER("The answer is: %s", "5432!");
   constexpr std::array<uint8_t, 10> expected =
@@ -161,6 +169,16 @@ TEST_F(TokenizeToGlobalHandlerWithPayload, Variety) {
   EXPECT_EQ(payload_, -543);
 }
 
+TEST_F(TokenizeToGlobalHandlerWithPayload, Integers) {
+  PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD(
+      static_cast<pw_tokenizer_Payload>(7), "%d %u %lld", -1, 1u, -65ll);
+  constexpr std::array<uint8_t, 8> expected =
+      ExpectedData<1, 2, 0x81, 0x01>("%d %u %lld");
+  ASSERT_EQ(expected.size(), message_size_bytes_);
+  EXPECT_EQ(std::memcmp(expected.data(), message_, expected.size()), 0);
+  EXPECT_EQ(payload_, 7);
+}
+
 constexpr std::array<uint8_t, 10> kExpected =
     ExpectedData<5, '5', '4', '3', '2', '!'>("The answer is: %s");
 
@@ -14,14 +14,65 @@
 
 #include "pw_tokenizer/hash.h"
 
+#include <algorithm>
+
 namespace pw {
 namespace tokenizer {
+namespace {
+
+constexpr uint32_t Power(size_t exponent)
+    PW_NO_SANITIZE("unsigned-integer-overflow") {
+  uint32_t result = 1;
+  for (size_t i = 0; i < exponent; ++i) {
+    result *= k65599HashConstant;
+  }
+  return result;
+}
+
+// The number of characters hashed per step.
+constexpr size_t kBlockSize = 8;
+
+}  // namespace
+
+uint32_t RuntimeFixedLengthHash(std::string_view string, size_t hash_length)
+    PW_NO_SANITIZE("unsigned-integer-overflow") {
+  const uint8_t* chars = reinterpret_cast<const uint8_t*>(string.data());
+  const size_t length = std::min(string.size(), hash_length);
+
+  // The length is hashed as if it were the first character.
+  uint32_t hash = string.size();
+
+  // Character i is multiplied by 65599^(i + 1). Each block of characters is
+  // hashed as if it were at the start of the string, using constant powers,
+  // then multiplied by the power for the block's position. Only that power is
+  // carried from one block to the next.
+  uint32_t coefficient = 1;
+  size_t i = 0;
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    const uint32_t block =
+        Power(1) * chars[i] + Power(2) * chars[i + 1] +
+        Power(3) * chars[i + 2] + Power(4) * chars[i + 3] +
+        Power(5) * chars[i + 4] + Power(6) * chars[i + 5] +
+        Power(7) * chars[i + 6] + Power(8) * chars[i + 7];
+    hash += coefficient * block;
+    coefficient *= Power(kBlockSize);
+  }
+
+  // Hash the remaining characters one at a time.
+  coefficient *= k65599HashConstant;
+  for (; i < length; ++i) {
+    hash += coefficient * chars[i];
+    coefficient *= k65599HashConstant;
+  }
+
+  return hash;
+}
 
 extern "C" uint32_t pw_tokenizer_65599FixedLengthHash(const char* string,
                                                       size_t string_length,
                                                       size_t hash_length) {
-  return PwTokenizer65599FixedLengthHash(
-      std::string_view(string, string_length), hash_length);
+  return RuntimeFixedLengthHash(std::string_view(string, string_length),
+                                hash_length);
 }
 
 }  // namespace tokenizer
@@ -0,0 +1,80 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Compares the constexpr hash, evaluated at runtime, with the runtime hash
+// that hashes several characters per step.
+
+#include <cstddef>
+#include <string_view>
+
+#include "pw_tokenizer/hash.h"
+#include "pw_unit_test/perf_test.h"
+
+namespace pw::tokenizer {
+namespace {
+
+using unit_test::DoNotOptimize;
+using unit_test::PerfState;
+
+char chars[256];
+
+// Hashes the first `length` characters. The characters are in a mutable
+// buffer, so the hash can't be calculated at compile time.
+template <uint32_t (*kHash)(std::string_view, size_t)>
+void BenchmarkHash(PerfState& state, size_t length) {
+  for (size_t i = 0; i < sizeof(chars); ++i) {
+    chars[i] = static_cast<char>('a' + i % 26);
+  }
+  const std::string_view string(chars, length);
+  while (state.KeepRunning()) {
+    DoNotOptimize(kHash(string, length));
+  }
+}
+
+uint32_t ConstexprHash(std::string_view string, size_t hash_length) {
+  return PwTokenizer65599FixedLengthHash(string, hash_length);
+}
+
+PERF_TEST(Hash, Constexpr_8, state) { BenchmarkHash<ConstexprHash>(state, 8); }
+
+PERF_TEST(Hash, Runtime_8, state) {
+  BenchmarkHash<RuntimeFixedLengthHash>(state, 8);
+}
+
+PERF_TEST(Hash, Constexpr_24, state) {
+  BenchmarkHash<ConstexprHash>(state, 24);
+}
+
+PERF_TEST(Hash, Runtime_24, state) {
+  BenchmarkHash<RuntimeFixedLengthHash>(state, 24);
+}
+
+PERF_TEST(Hash, Constexpr_80, state) {
+  BenchmarkHash<ConstexprHash>(state, 80);
+}
+
+PERF_TEST(Hash, Runtime_80, state) {
+  BenchmarkHash<RuntimeFixedLengthHash>(state, 80);
+}
+
+PERF_TEST(Hash, Constexpr_256, state) {
+  BenchmarkHash<ConstexprHash>(state, 256);
+}
+
+PERF_TEST(Hash, Runtime_256, state) {
+  BenchmarkHash<RuntimeFixedLengthHash>(state, 256);
+}
+
+}  // namespace
+}  // namespace pw::tokenizer
@@ -54,6 +54,25 @@ TEST(Hashing, GeneratedCasesAtRuntime) {
         PwTokenizer65599FixedLengthHash(string, hash_length);
     EXPECT_EQ(calculated_hash, python_hash);
     EXPECT_EQ(calculated_hash, macro_hash);
+    EXPECT_EQ(RuntimeFixedLengthHash(string, hash_length), python_hash);
+  }
+}
+
+TEST(Hashing, RuntimeMatchesConstexpr) {
+  char chars[64];
+  for (size_t i = 0; i < sizeof(chars); ++i) {
+    chars[i] = static_cast<char>(i * 37 + 11);  // Includes values over 127.
+  }
+
+  // Cover every position of the end of the string and the hash length within
+  // the blocks of characters hashed together.
+  for (size_t length = 0; length <= sizeof(chars); ++length) {
+    const std::string_view string(chars, length);
+    for (size_t hash_length = 0; hash_length <= 40; ++hash_length) {
+      EXPECT_EQ(PwTokenizer65599FixedLengthHash(string, hash_length),
+                RuntimeFixedLengthHash(string, hash_length));
+    }
+    EXPECT_EQ(Hash(string), RuntimeHash(string));
   }
 }
 
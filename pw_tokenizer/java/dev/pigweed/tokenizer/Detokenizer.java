@@ -22,6 +22,7 @@
 package dev.pigweed.tokenizer;
 
 import android.util.Base64;
+import java.nio.ByteBuffer;
 import java.util.regex.Matcher;
 import java.util.regex.Pattern;
 
@@ -70,6 +71,46 @@ public class Detokenizer {
     return result.toString();
   }
 
+  /**
+   * Detokenizes a batch of binary tokenized messages with a single native call. The messages are
+   * read from a direct ByteBuffer, from its position to its limit. Each message is preceded by its
+   * length as a 32-bit little-endian integer. The buffer's position is advanced to its limit.
+   *
+   * <p>Returns the detokenized strings in order, with null for messages that could not be
+   * detokenized. Throws IllegalArgumentException if the buffer is not direct or the last message
+   * is incomplete.
+   */
+  public String[] detokenizeBatch(ByteBuffer messages) {
+    String[] result =
+        detokenizeBatchNative(handle, messages, messages.position(), messages.limit());
+    messages.position(messages.limit());
+    return result;
+  }
+
+  /**
+   * Detokenizes a batch of binary tokenized messages, formatted as for detokenizeBatch, and writes
+   * the results to a direct ByteBuffer as UTF-8 without creating any Java objects. Each result is
+   * preceded by its length in bytes as a 32-bit little-endian integer, or -1 with no data if the
+   * message could not be detokenized.
+   *
+   * <p>Stops when the next result does not fit in the output or the next message is incomplete,
+   * and advances the position of each buffer past the data read or written. Call again after
+   * draining the output to continue. The output must have room for the longest result.
+   */
+  public void detokenizeBatchToUtf8(ByteBuffer messages, ByteBuffer output) {
+    long positions =
+        detokenizeBatchToUtf8Native(
+            handle,
+            messages,
+            messages.position(),
+            messages.limit(),
+            output,
+            output.position(),
+            output.limit());
+    messages.position((int) (positions >>> 32));
+    output.position((int) positions);
+  }
+
   /** Deletes memory allocated in C++ when this class is garbage collected. */
   @Override
   protected void finalize() {
@@ -88,4 +129,21 @@ public class Detokenizer {
    * detokenizeNative finishes.
    */
   private native String detokenizeNative(long handle, byte[] data);
+
+  /** Detokenizes length-prefixed messages from buffer[position:limit]. */
+  private native String[] detokenizeBatchNative(
+      long handle, ByteBuffer buffer, int position, int limit);
+
+  /**
+   * Detokenizes length-prefixed messages into length-prefixed UTF-8 strings. Returns the new input
+   * position in the upper 32 bits and the new output position in the lower 32 bits.
+   */
+  private native long detokenizeBatchToUtf8Native(
+      long handle,
+      ByteBuffer input,
+      int inputPosition,
+      int inputLimit,
+      ByteBuffer output,
+      int outputPosition,
+      int outputLimit);
 }
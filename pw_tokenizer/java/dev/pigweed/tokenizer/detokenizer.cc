@@ -18,8 +18,10 @@
 
 #include <jni.h>
 
+#include <cstdint>
 #include <cstring>
 #include <span>
+#include <string>
 
 #include "pw_preprocessor/concat.h"
 #include "pw_tokenizer/detokenize.h"
@@ -45,6 +47,77 @@ jlong PointerToHandle(Detokenizer* detokenizer) {
   return handle;
 }
 
+// Batches of messages are passed in direct ByteBuffers. Each message is
+// preceded by its length as a 32-bit little-endian integer.
+constexpr size_t kLengthPrefixSize = sizeof(uint32_t);
+
+uint32_t ReadLength(const uint8_t* data) {
+  return uint32_t(data[0]) | uint32_t(data[1]) << 8 | uint32_t(data[2]) << 16 |
+         uint32_t(data[3]) << 24;
+}
+
+void WriteLength(int32_t length, uint8_t* data) {
+  const uint32_t value = static_cast<uint32_t>(length);
+  data[0] = static_cast<uint8_t>(value);
+  data[1] = static_cast<uint8_t>(value >> 8);
+  data[2] = static_cast<uint8_t>(value >> 16);
+  data[3] = static_cast<uint8_t>(value >> 24);
+}
+
+// Iterates over the length-prefixed messages in a batch.
+class BatchReader {
+ public:
+  BatchReader(std::span<const uint8_t> batch) : remaining_(batch) {}
+
+  // Reads the next message. Returns false at the end of the batch or if the
+  // next message is incomplete.
+  bool Next(std::span<const uint8_t>& message) {
+    if (remaining_.size() < kLengthPrefixSize) {
+      return false;
+    }
+    const uint32_t length = ReadLength(remaining_.data());
+    if (remaining_.size() - kLengthPrefixSize < length) {
+      return false;
+    }
+    message = remaining_.subspan(kLengthPrefixSize, length);
+    remaining_ = remaining_.subspan(kLengthPrefixSize + length);
+    return true;
+  }
+
+  // True if all messages were read; false if a message was incomplete.
+  bool done() const { return remaining_.empty(); }
+
+  size_t remaining_bytes() const { return remaining_.size(); }
+
+ private:
+  std::span<const uint8_t> remaining_;
+};
+
+void ThrowIllegalArgument(JNIEnv* env, const char* message) {
+  env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"), message);
+}
+
+// Returns the contents of a direct ByteBuffer from position to limit, or
+// throws and returns nullptr if the buffer is not direct or the range is
+// invalid.
+uint8_t* DirectBufferRange(JNIEnv* env,
+                           jobject buffer,
+                           jint position,
+                           jint limit) {
+  uint8_t* const data =
+      static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+  if (data == nullptr) {
+    ThrowIllegalArgument(env, "The ByteBuffer must be a direct buffer");
+    return nullptr;
+  }
+  if (position < 0 || limit < position ||
+      limit > env->GetDirectBufferCapacity(buffer)) {
+    ThrowIllegalArgument(env, "Invalid ByteBuffer position or limit");
+    return nullptr;
+  }
+  return data + position;
+}
+
 }  // namespace
 
 extern "C" {
@@ -87,6 +160,99 @@ JNIEXPORT jstring DETOKENIZER_METHOD(detokenizeNative)(JNIEnv* env,
              : env->NewStringUTF(result.BestString().c_str());
 }
 
+JNIEXPORT jobjectArray DETOKENIZER_METHOD(detokenizeBatchNative)(
+    JNIEnv* env, jobject, jlong handle, jobject buffer, jint position,
+    jint limit) {
+  const uint8_t* const data = DirectBufferRange(env, buffer, position, limit);
+  if (data == nullptr) {
+    return nullptr;
+  }
+  const std::span<const uint8_t> batch(data, limit - position);
+
+  // Count the messages first to size the array.
+  jsize count = 0;
+  std::span<const uint8_t> message;
+  for (BatchReader reader(batch); reader.Next(message);) {
+    count += 1;
+  }
+
+  jobjectArray strings =
+      env->NewObjectArray(count, env->FindClass("java/lang/String"), nullptr);
+  if (strings == nullptr) {
+    return nullptr;  // OutOfMemoryError was thrown.
+  }
+
+  const Detokenizer& detokenizer = *HandleToPointer(handle);
+  BatchReader reader(batch);
+
+  for (jsize i = 0; reader.Next(message); ++i) {
+    const DetokenizedString result = detokenizer.Detokenize(message);
+    if (result.matches().empty()) {
+      continue;  // Leave the element null.
+    }
+
+    // Release each string's local reference so that large batches do not
+    // overflow the local reference table.
+    jstring string = env->NewStringUTF(result.BestString().c_str());
+    if (string == nullptr) {
+      return nullptr;  // OutOfMemoryError was thrown.
+    }
+    env->SetObjectArrayElement(strings, i, string);
+    env->DeleteLocalRef(string);
+  }
+
+  if (!reader.done()) {
+    ThrowIllegalArgument(env, "The last message in the batch is incomplete");
+    return nullptr;
+  }
+  return strings;
+}
+
+JNIEXPORT jlong DETOKENIZER_METHOD(detokenizeBatchToUtf8Native)(
+    JNIEnv* env, jobject, jlong handle, jobject input, jint input_position,
+    jint input_limit, jobject output, jint output_position, jint output_limit) {
+  const uint8_t* const input_data =
+      DirectBufferRange(env, input, input_position, input_limit);
+  if (input_data == nullptr) {
+    return 0;
+  }
+  uint8_t* const output_data =
+      DirectBufferRange(env, output, output_position, output_limit);
+  if (output_data == nullptr) {
+    return 0;
+  }
+
+  const Detokenizer& detokenizer = *HandleToPointer(handle);
+  BatchReader reader(std::span(input_data, input_limit - input_position));
+  const size_t output_size = output_limit - output_position;
+  size_t written = 0;
+  size_t read = 0;
+
+  std::span<const uint8_t> message;
+  while (reader.Next(message)) {
+    const DetokenizedString result = detokenizer.Detokenize(message);
+    const std::string string =
+        result.matches().empty() ? std::string() : result.BestString();
+
+    // Stop before a result that does not fit; the caller drains the output
+    // and calls again.
+    if (output_size - written < kLengthPrefixSize + string.size()) {
+      break;
+    }
+
+    WriteLength(result.matches().empty() ? -1 : jint(string.size()),
+                &output_data[written]);
+    std::memcpy(&output_data[written + kLengthPrefixSize],
+                string.data(),
+                string.size());
+    written += kLengthPrefixSize + string.size();
+    read = input_limit - input_position - reader.remaining_bytes();
+  }
+
+  // Return the new input and output positions.
+  return jlong(input_position + read) << 32 | jlong(output_position + written);
+}
+
 }  // extern "C"
 
 }  // namespace pw::tokenizer
@@ -66,3 +66,15 @@ static_assert(PW_TOKENIZER_CFG_ARG_TYPES_SIZE_BYTES == 4 ||
 #ifndef PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES
 #define PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES 52
 #endif  // PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES
+
+// If true, PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD encodes messages directly
+// into a buffer provided by the global handler backend instead of into a stack
+// buffer of PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES. The backend implements
+// pw_tokenizer_AcquireEncodeBufferWithPayload and
+// pw_tokenizer_ReleaseEncodeBufferWithPayload instead of
+// pw_tokenizer_HandleEncodedMessageWithPayload. This avoids copying each
+// message from the stack into its destination, such as a queue or a per-thread
+// buffer.
+#ifndef PW_TOKENIZER_CFG_ENCODE_IN_PLACE
+#define PW_TOKENIZER_CFG_ENCODE_IN_PLACE 0
+#endif  // PW_TOKENIZER_CFG_ENCODE_IN_PLACE
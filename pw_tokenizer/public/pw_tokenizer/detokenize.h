@@ -28,10 +28,13 @@
 #include <cstdint>
 #include <span>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
 #include "pw_tokenizer/internal/decode.h"
 #include "pw_tokenizer/token_database.h"
 
@@ -70,8 +73,9 @@ class DetokenizedString {
   std::vector<DecodedFormatString> matches_;
 };
 
-// Decodes and detokenizes strings from a TokenDatabase. This class builds a
-// hash table from the TokenDatabase to give O(1) token lookups.
+// Decodes and detokenizes strings from a TokenDatabase. This class parses each
+// entry's format string once and builds a hash table from the TokenDatabase to
+// give O(1) token lookups.
 class Detokenizer {
  public:
   // Constructs a detokenizer from a TokenDatabase. The TokenDatabase is not
@@ -91,8 +95,75 @@ class Detokenizer {
         std::span(static_cast<const uint8_t*>(encoded), size_bytes));
   }
 
+  // Writes text to the output with every prefixed Base64 message (e.g.
+  // "$RhYjmQ==") replaced by its best detokenized string. Messages with
+  // unknown tokens or invalid Base64 are written unchanged, as is other text.
+  // Returns the first error from writing the output.
+  Status DetokenizeBase64(std::string_view text, stream::Writer& output) const;
+
+  // Detokenizes prefixed Base64 messages in text read from the reader until it
+  // is exhausted, as with DetokenizeBase64(std::string_view). The text is read
+  // and written in chunks, so arbitrarily large log archives may be processed.
+  // Returns the first error from reading or writing.
+  //
+  // The Detokenizer is not modified by detokenizing, so multiple threads may
+  // detokenize with the same Detokenizer at once. To use several threads for a
+  // large archive, split it at newlines, detokenize each part into its own
+  // output, and concatenate the outputs in order.
+  Status DetokenizeBase64(stream::Reader& input, stream::Writer& output) const;
+
+ private:
+  // The entries for a token, which are contiguous in entries_.
+  struct EntryRange {
+    uint32_t index;
+    uint32_t count;
+  };
+
+  // All entries, grouped by token, stored in one allocation.
+  std::vector<TokenizedStringEntry> entries_;
+  std::unordered_map<uint32_t, EntryRange> database_;
+};
+
+// A stream::Writer that detokenizes prefixed Base64 messages in the text
+// written to it, as Detokenizer::DetokenizeBase64() does, and writes the result
+// to another writer. Use it to detokenize live device output, such as a serial
+// console, as it arrives:
+//
+//   DetokenizingWriter console(detokenizer, stdout_writer);
+//   while (serial.Read(buffer).ok()) {
+//     console.Write(buffer);
+//   }
+//
+// Text is passed through in as few writes as possible. A message that might
+// continue in the next write is held back until it is complete, so messages
+// may be split across writes at any point. Call Flush() when the input is idle
+// or ends, to write out text that was held back.
+//
+// If writing to the output fails, the text that was not written is dropped and
+// the error is returned.
+class DetokenizingWriter final : public stream::Writer {
+ public:
+  // Held-back text that grows past this size is written out as is.
+  static constexpr size_t kMaxPendingBytes = 4096;
+
+  DetokenizingWriter(const Detokenizer& detokenizer, stream::Writer& output)
+      : detokenizer_(detokenizer), output_(output) {}
+
+  // Writes any text held back because a message might have continued.
+  Status Flush();
+
+  // The number of bytes held back, waiting for more text.
+  size_t pending_bytes() const { return pending_.size(); }
+
  private:
-  std::unordered_map<uint32_t, std::vector<TokenizedStringEntry>> database_;
+  Status DoWrite(ConstByteSpan data) override;
+
+  // Detokenizes the held-back text, keeping any message that may continue.
+  Status ProcessPending(bool at_end);
+
+  const Detokenizer& detokenizer_;
+  stream::Writer& output_;
+  std::string pending_;
 };
 
 }  // namespace pw::tokenizer
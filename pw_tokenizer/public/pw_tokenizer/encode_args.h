@@ -17,10 +17,12 @@
 #include <cstddef>
 #include <cstring>
 #include <span>
+#include <type_traits>
 
 #include "pw_tokenizer/config.h"
 #include "pw_tokenizer/internal/argument_types.h"
 #include "pw_tokenizer/tokenize.h"
+#include "pw_varint/varint.h"
 
 namespace pw {
 namespace tokenizer {
@@ -34,6 +36,81 @@ size_t EncodeArgs(pw_tokenizer_ArgTypes types,
                   va_list args,
                   std::span<std::byte> output);
 
+#ifdef __cpp_fold_expressions
+
+namespace internal {
+
+// True for the types that are encoded as PW_TOKENIZER_ARG_TYPE_INT or
+// PW_TOKENIZER_ARG_TYPE_INT64 and convert directly to int or int64_t.
+template <typename T, typename ArgType = std::decay_t<T>>
+inline constexpr bool kIsIntegerArg =
+    (std::is_integral_v<ArgType> || std::is_enum_v<ArgType> ||
+     std::is_pointer_v<ArgType> || std::is_null_pointer_v<ArgType>) &&
+    (VarargsType<T>() == PW_TOKENIZER_ARG_TYPE_INT ||
+     VarargsType<T>() == PW_TOKENIZER_ARG_TYPE_INT64);
+
+// Converts an argument to the type EncodeArgs reads it as with va_arg.
+template <typename Int, typename T>
+constexpr Int ToIntegerArg(T value) {
+  if constexpr (std::is_null_pointer_v<T>) {
+    return 0;
+  } else if constexpr (std::is_pointer_v<T>) {
+    return static_cast<Int>(reinterpret_cast<intptr_t>(value));
+  } else {
+    return static_cast<Int>(value);
+  }
+}
+
+// Zig-zag varint encodes one argument to the front of output and advances it.
+// Returns false if the varint does not fit, without writing anything.
+template <typename T>
+bool EncodeIntegerArg(T value, std::span<std::byte>& output) {
+  uint64_t encoded;
+  if constexpr (VarargsType<T>() == PW_TOKENIZER_ARG_TYPE_INT) {
+    encoded = varint::ZigZagEncode(ToIntegerArg<int>(value));
+  } else {
+    encoded = varint::ZigZagEncode(ToIntegerArg<int64_t>(value));
+  }
+
+  size_t size = 1;
+  for (uint64_t remaining = encoded >> 7; remaining != 0u; remaining >>= 7) {
+    size += 1;
+  }
+  if (size > output.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < size - 1; ++i) {
+    output[i] = static_cast<std::byte>(encoded | 0x80u);
+    encoded >>= 7;
+  }
+  output[size - 1] = static_cast<std::byte>(encoded);
+  output = output.subspan(size);
+  return true;
+}
+
+}  // namespace internal
+
+// True if every argument is encoded as an integer, so the arguments can be
+// encoded with EncodeIntegerArgs.
+template <typename... Args>
+inline constexpr bool kAllIntegerArgs = (internal::kIsIntegerArg<Args> && ...);
+
+// Encodes integer arguments exactly as EncodeArgs would, but with the argument
+// types resolved at compile time. There is no va_list and no per-argument
+// switch on the packed types; each argument is zig-zag varint encoded directly.
+// As with EncodeArgs, encoding stops at the first argument that does not fit.
+template <typename... Args>
+size_t EncodeIntegerArgs(std::span<std::byte> output, Args... args) {
+  static_assert(kAllIntegerArgs<Args...>,
+                "EncodeIntegerArgs only supports integer arguments");
+  const size_t output_size = output.size();
+  static_cast<void>((internal::EncodeIntegerArg(args, output) && ...));
+  return output_size - output.size();
+}
+
+#endif  // __cpp_fold_expressions
+
 // Encodes a tokenized message to a fixed size buffer. The size of the buffer is
 // determined by the PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES config macro.
 //
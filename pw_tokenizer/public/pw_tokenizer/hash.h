@@ -102,6 +102,18 @@ constexpr uint32_t PwTokenizer65599FixedLengthHash(
                                          hash_length);
 }
 
+// Runtime version of PwTokenizer65599FixedLengthHash, which returns identical
+// results. Instead of updating the coefficient after every character, it
+// multiplies blocks of characters by precomputed powers of 65599, so the
+// multiplications within a block are independent. This is several times faster
+// for long strings. Use it to hash strings that are not known at compile time.
+uint32_t RuntimeFixedLengthHash(std::string_view string, size_t hash_length);
+
+// Runtime version of Hash, which returns identical results.
+inline uint32_t RuntimeHash(std::string_view string) {
+  return RuntimeFixedLengthHash(string, string.size());
+}
+
 }  // namespace pw::tokenizer
 
 #endif  // __cplusplus
@@ -17,6 +17,8 @@
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
+#include <span>
+#include <utility>
 
 namespace pw::tokenizer {
 
@@ -48,9 +50,11 @@ namespace pw::tokenizer {
 // Entries are sorted by token. A string table with a null-terminated string for
 // each entry in order follows the entries.
 //
-// Entries are accessed by iterating over the database. A O(n) Find function is
-// also provided. In typical use, a TokenDatabase is preprocessed by a
-// Detokenizer into a std::unordered_map.
+// Entries are accessed by iterating over the database or with Find, which
+// binary searches the entries. Strings are not indexed, so the string for an
+// entry is found by skipping past the strings before it, unless Find is given
+// an index of string offsets. In typical use, a TokenDatabase is preprocessed
+// by a Detokenizer into a std::unordered_map.
 class TokenDatabase {
  public:
   // Internal struct that describes how the underlying binary token database
@@ -122,6 +126,8 @@ class TokenDatabase {
     }
 
    private:
+    friend class TokenDatabase;
+
     const RawEntry* raw_;
     const char* string_;
   };
@@ -141,7 +147,7 @@ class TokenDatabase {
 
     // Accesses the specified entry in this set. Returns an Entry object, which
     // is constructed from the underlying raw entry. The index must be less than
-    // size(). This operation is O(n) in size().
+    // size(). Finding the entry's string is O(n) in index.
     Entry operator[](size_t index) const;
 
     constexpr const Iterator& begin() const { return begin_; }
@@ -196,9 +202,17 @@ class TokenDatabase {
   // Creates a database with no data. ok() returns false.
   constexpr TokenDatabase() : begin_{.data = nullptr}, end_{.data = nullptr} {}
 
-  // Returns all entries associated with this token. This is a O(n) operation.
+  // Returns all entries associated with this token. The entries are found with
+  // a O(log n) binary search. Finding the first entry's string requires
+  // skipping the strings of the entries before it.
   Entries Find(uint32_t token) const;
 
+  // Returns all entries associated with this token, as with Find(uint32_t),
+  // but finds the strings with an index instead of skipping strings. The index
+  // has an offset for each entry's string from the start of the string table,
+  // in entry order. TokenDatabaseFile builds or loads such an index.
+  Entries Find(uint32_t token, std::span<const uint32_t> string_offsets) const;
+
   // Returns the total number of entries (unique token-string pairs).
   constexpr size_t size() const {
     return (end_.data - begin_.data) / sizeof(RawEntry);
@@ -220,6 +234,14 @@ class TokenDatabase {
 
   static_assert(sizeof(Header) == 2 * sizeof(RawEntry));
 
+  // Returns the first and one past the last raw entry for the token.
+  std::pair<const RawEntry*, const RawEntry*> FindRawEntries(
+      uint32_t token) const;
+
+  // Returns the string that follows the provided number of null-terminated
+  // strings.
+  static const char* SkipStrings(const char* string, size_t count);
+
   template <typename ByteArray>
   static constexpr bool HasValidHeader(const ByteArray& bytes) {
     static_assert(sizeof(*std::data(bytes)) == 1u);
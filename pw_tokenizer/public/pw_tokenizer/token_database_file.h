@@ -0,0 +1,140 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file provides the TokenDatabaseFile class, which memory-maps a binary
+// token database from a file for host tools. It requires POSIX mmap.
+//
+//   TokenDatabaseFile file;
+//   PW_TRY(file.Open("tokens.bin", "tokens.bin.index"));
+//
+//   for (TokenDatabase::Entry entry : file.Find(token)) {
+//     std::cout << entry.string << '\n';
+//   }
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "pw_status/status.h"
+#include "pw_tokenizer/token_database.h"
+
+namespace pw::tokenizer {
+
+// A binary token database that is memory-mapped from a file. The database is
+// validated in place, and is neither copied nor parsed into other structures.
+//
+// Lookups use an index with the offset of each entry's string. The index is
+// either built by scanning the string table or mapped from an index file
+// written by WriteIndex. Index files make opening very large databases nearly
+// instant, since the string table is then only read as strings are accessed.
+//
+// The index file format is a 16-byte header followed by a 4-byte little-endian
+// string offset for each entry.
+//
+//            Header
+//            ======
+//   Offset  Size  Field
+//   -----------------------------------
+//        0     8  Magic number (TKINDEX\0)
+//        8     4  Entry count
+//       12     4  Database file size in bytes
+//
+class TokenDatabaseFile {
+ public:
+  // Creates an empty TokenDatabaseFile. Call Open to map a database.
+  TokenDatabaseFile() = default;
+
+  TokenDatabaseFile(TokenDatabaseFile&&) = default;
+  TokenDatabaseFile& operator=(TokenDatabaseFile&&) = default;
+
+  // Maps and validates a binary token database, replacing any database that
+  // was open. If index_path is provided and names a valid index for this
+  // database, the index is mapped from that file; otherwise, it is built. Index
+  // files that do not match the database are ignored.
+  //
+  // Returns:
+  //
+  // NOT_FOUND - the database file could not be opened.
+  // DATA_LOSS - the file is not a valid binary token database.
+  // OUT_OF_RANGE - the database is 4 GB or larger.
+  // INTERNAL - the file could not be memory-mapped.
+  Status Open(const char* path, const char* index_path = nullptr);
+
+  // The mapped database. Empty if no database is open.
+  const TokenDatabase& database() const { return database_; }
+
+  // Returns all entries associated with this token. The entries are found with
+  // a O(log n) binary search and their strings are found with the index.
+  TokenDatabase::Entries Find(uint32_t token) const {
+    return database_.Find(token, string_offsets_);
+  }
+
+  // True if the string index was mapped from an index file instead of built.
+  bool index_loaded() const { return !index_file_.empty(); }
+
+  // Writes the string index to a file so later calls to Open may load it.
+  // Returns INTERNAL if the file could not be written.
+  Status WriteIndex(const char* index_path) const;
+
+ private:
+  // Owns a read-only memory mapping of a file.
+  class MappedFile {
+   public:
+    constexpr MappedFile() : data_(nullptr), size_(0) {}
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) : data_(other.data_), size_(other.size_) {
+      other.data_ = nullptr;
+      other.size_ = 0;
+    }
+
+    MappedFile& operator=(MappedFile&& other);
+
+    ~MappedFile() { Unmap(); }
+
+    // Maps the file. Returns NOT_FOUND if it cannot be opened or INTERNAL if
+    // mapping fails. Empty files are not mapped.
+    Status Map(const char* path);
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0u; }
+
+   private:
+    void Unmap();
+
+    const char* data_;
+    size_t size_;
+  };
+
+  // Maps the index file and uses it if it is valid for the database.
+  bool UseIndex(const char* index_path);
+
+  void BuildIndex();
+
+  MappedFile database_file_;
+  MappedFile index_file_;
+  TokenDatabase database_;
+
+  // The index is either mapped from index_file_ or built in built_offsets_.
+  std::vector<uint32_t> built_offsets_;
+  std::span<const uint32_t> string_offsets_;
+};
+
+}  // namespace pw::tokenizer
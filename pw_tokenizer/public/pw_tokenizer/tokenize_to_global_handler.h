@@ -55,9 +55,9 @@
 #define PW_TOKENIZE_TO_GLOBAL_HANDLER_MASK(domain, mask, format, ...) \
   do {                                                                \
     PW_TOKENIZE_FORMAT_STRING(domain, mask, format, __VA_ARGS__);     \
-    _pw_tokenizer_ToGlobalHandler(_pw_tokenizer_token,                \
-                                  PW_TOKENIZER_ARG_TYPES(__VA_ARGS__) \
-                                      PW_COMMA_ARGS(__VA_ARGS__));    \
+    _PW_TOKENIZER_TO_GLOBAL_HANDLER(_pw_tokenizer_token,              \
+                                    PW_TOKENIZER_ARG_TYPES(__VA_ARGS__) \
+                                        PW_COMMA_ARGS(__VA_ARGS__));    \
   } while (0)
 
 PW_EXTERN_C_START
@@ -75,3 +75,56 @@ void _pw_tokenizer_ToGlobalHandler(pw_tokenizer_Token token,
                                    ...);
 
 PW_EXTERN_C_END
+
+// In C++17, integer-only argument lists are encoded by a function specialized
+// for the argument types at compile time. See
+// pw_tokenizer/tokenize_to_global_handler_with_payload.h.
+#if defined(__cplusplus) && defined(__cpp_fold_expressions)
+
+#include <cstring>
+#include <span>
+
+#include "pw_preprocessor/compiler.h"
+#include "pw_tokenizer/encode_args.h"
+
+#define _PW_TOKENIZER_TO_GLOBAL_HANDLER \
+  ::pw::tokenizer::internal::ToGlobalHandler
+
+namespace pw {
+namespace tokenizer {
+namespace internal {
+
+// Not inlined, so each integer signature is encoded by one shared function.
+template <typename... Args>
+PW_NO_INLINE void ToGlobalHandlerIntegers(const pw_tokenizer_Token token,
+                                          const Args... args) {
+  std::byte buffer[PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES];
+  std::memcpy(buffer, &token, sizeof(token));
+  const size_t args_size =
+      EncodeIntegerArgs(std::span(buffer).subspan(sizeof(token)), args...);
+
+  pw_tokenizer_HandleEncodedMessage(reinterpret_cast<const uint8_t*>(buffer),
+                                    sizeof(token) + args_size);
+}
+
+template <typename... Args>
+inline void ToGlobalHandler(const pw_tokenizer_Token token,
+                            const pw_tokenizer_ArgTypes types,
+                            const Args... args) {
+  if constexpr (kAllIntegerArgs<Args...>) {
+    static_cast<void>(types);
+    ToGlobalHandlerIntegers(token, args...);
+  } else {
+    _pw_tokenizer_ToGlobalHandler(token, types, args...);
+  }
+}
+
+}  // namespace internal
+}  // namespace tokenizer
+}  // namespace pw
+
+#else
+
+#define _PW_TOKENIZER_TO_GLOBAL_HANDLER _pw_tokenizer_ToGlobalHandler
+
+#endif  // defined(__cplusplus) && defined(__cpp_fold_expressions)
@@ -57,7 +57,7 @@
     domain, mask, payload, format, ...)                                  \
   do {                                                                   \
     PW_TOKENIZE_FORMAT_STRING(domain, mask, format, __VA_ARGS__);        \
-    _pw_tokenizer_ToGlobalHandlerWithPayload(                            \
+    _PW_TOKENIZER_TO_GLOBAL_HANDLER_WITH_PAYLOAD(                        \
         payload,                                                         \
         _pw_tokenizer_token,                                             \
         PW_TOKENIZER_ARG_TYPES(__VA_ARGS__) PW_COMMA_ARGS(__VA_ARGS__)); \
@@ -75,6 +75,49 @@ void pw_tokenizer_HandleEncodedMessageWithPayload(
     const uint8_t encoded_message[],
     size_t size_bytes);
 
+// If PW_TOKENIZER_CFG_ENCODE_IN_PLACE is enabled, the global handler backend
+// implements these two functions instead of
+// pw_tokenizer_HandleEncodedMessageWithPayload. Messages are encoded directly
+// into the acquired buffer, with no intermediate copy.
+//
+// pw_tokenizer_AcquireEncodeBufferWithPayload returns a buffer for a message
+// and sets *buffer_size_bytes to its size. The buffer must be at least 4 bytes
+// to fit the token; arguments that do not fit are truncated or dropped. Return
+// NULL to drop the message.
+//
+// pw_tokenizer_ReleaseEncodeBufferWithPayload is called with the same payload
+// and buffer after the message is encoded. size_bytes is the size of the
+// encoded message, or 0 if the buffer was too small for the token. It is
+// called once for each non-NULL buffer that is acquired.
+//
+// For example, the following encodes log messages directly into the slots of
+// a queue, dropping messages when the queue is full:
+/*
+     uint8_t* pw_tokenizer_AcquireEncodeBufferWithPayload(
+         pw_tokenizer_Payload log_level, size_t* buffer_size_bytes) {
+       MyQueueSlot* slot = MyProject_ReserveQueueSlot();
+       if (slot == NULL) {
+         return NULL;
+       }
+       slot->log_level = log_level;
+       *buffer_size_bytes = sizeof(slot->message);
+       return slot->message;
+     }
+
+     void pw_tokenizer_ReleaseEncodeBufferWithPayload(
+         pw_tokenizer_Payload log_level,
+         uint8_t* buffer,
+         size_t size_bytes) {
+       MyProject_CommitQueueSlot(buffer, size_bytes);
+     }
+ */
+uint8_t* pw_tokenizer_AcquireEncodeBufferWithPayload(
+    pw_tokenizer_Payload payload, size_t* buffer_size_bytes);
+
+void pw_tokenizer_ReleaseEncodeBufferWithPayload(pw_tokenizer_Payload payload,
+                                                 uint8_t* buffer,
+                                                 size_t size_bytes);
+
 // This function encodes the tokenized strings. Do not call it directly;
 // instead, use the PW_TOKENIZE_TO_GLOBAL_HANDLER_WITH_PAYLOAD macro.
 void _pw_tokenizer_ToGlobalHandlerWithPayload(pw_tokenizer_Payload payload,
@@ -83,3 +126,85 @@ void _pw_tokenizer_ToGlobalHandlerWithPayload(pw_tokenizer_Payload payload,
                                               ...);
 
 PW_EXTERN_C_END
+
+// In C++17, integer-only argument lists are encoded by a function specialized
+// for the argument types at compile time, which skips the va_list and the
+// per-argument type dispatch in EncodeArgs. Other arguments use the C function.
+#if defined(__cplusplus) && defined(__cpp_fold_expressions)
+
+#include <cstring>
+#include <span>
+
+#include "pw_preprocessor/compiler.h"
+#include "pw_tokenizer/encode_args.h"
+
+#define _PW_TOKENIZER_TO_GLOBAL_HANDLER_WITH_PAYLOAD \
+  ::pw::tokenizer::internal::ToGlobalHandlerWithPayload
+
+namespace pw {
+namespace tokenizer {
+namespace internal {
+
+// Not inlined, so each integer signature is encoded by one shared function.
+template <typename... Args>
+PW_NO_INLINE void ToGlobalHandlerWithPayloadIntegers(
+    const pw_tokenizer_Payload payload,
+    const pw_tokenizer_Token token,
+    const Args... args) {
+#if PW_TOKENIZER_CFG_ENCODE_IN_PLACE
+  size_t buffer_size = 0;
+  uint8_t* const buffer =
+      pw_tokenizer_AcquireEncodeBufferWithPayload(payload, &buffer_size);
+  if (buffer == nullptr) {
+    return;
+  }
+
+  if (buffer_size < sizeof(token)) {
+    pw_tokenizer_ReleaseEncodeBufferWithPayload(payload, buffer, 0);
+    return;
+  }
+
+  std::memcpy(buffer, &token, sizeof(token));
+  const size_t args_size = EncodeIntegerArgs(
+      std::span(reinterpret_cast<std::byte*>(buffer), buffer_size)
+          .subspan(sizeof(token)),
+      args...);
+
+  pw_tokenizer_ReleaseEncodeBufferWithPayload(
+      payload, buffer, sizeof(token) + args_size);
+#else
+  std::byte buffer[PW_TOKENIZER_CFG_ENCODING_BUFFER_SIZE_BYTES];
+  std::memcpy(buffer, &token, sizeof(token));
+  const size_t args_size =
+      EncodeIntegerArgs(std::span(buffer).subspan(sizeof(token)), args...);
+
+  pw_tokenizer_HandleEncodedMessageWithPayload(
+      payload,
+      reinterpret_cast<const uint8_t*>(buffer),
+      sizeof(token) + args_size);
+#endif  // PW_TOKENIZER_CFG_ENCODE_IN_PLACE
+}
+
+template <typename... Args>
+inline void ToGlobalHandlerWithPayload(const pw_tokenizer_Payload payload,
+                                       const pw_tokenizer_Token token,
+                                       const pw_tokenizer_ArgTypes types,
+                                       const Args... args) {
+  if constexpr (kAllIntegerArgs<Args...>) {
+    static_cast<void>(types);
+    ToGlobalHandlerWithPayloadIntegers(payload, token, args...);
+  } else {
+    _pw_tokenizer_ToGlobalHandlerWithPayload(payload, token, types, args...);
+  }
+}
+
+}  // namespace internal
+}  // namespace tokenizer
+}  // namespace pw
+
+#else
+
+#define _PW_TOKENIZER_TO_GLOBAL_HANDLER_WITH_PAYLOAD \
+  _pw_tokenizer_ToGlobalHandlerWithPayload
+
+#endif  // defined(__cplusplus) && defined(__cpp_fold_expressions)
@@ -14,28 +14,59 @@
 
 #include "pw_tokenizer/token_database.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace pw::tokenizer {
 
 TokenDatabase::Entry TokenDatabase::Entries::operator[](size_t index) const {
-  Iterator it = begin();
-  for (size_t i = 0; i < index; ++i) {
-    ++it;
-  }
-  return it.entry();
+  const RawEntry& raw = begin_.raw_[index];
+  return {raw.token, raw.date_removed, SkipStrings(begin_.string_, index)};
 }
 
 TokenDatabase::Entries TokenDatabase::Find(const uint32_t token) const {
-  Iterator first = begin();
-  while (first != end() && token > first->token) {
-    ++first;
+  const auto [first, last] = FindRawEntries(token);
+
+  if (first == last) {
+    return Entries(end(), end());
   }
 
-  Iterator last = first;
-  while (last != end() && token == last->token) {
-    ++last;
+  // Strings are stored in entry order, so skip the strings of earlier entries.
+  return Entries(Iterator(first, SkipStrings(end_.data, first - begin_.entry)),
+                 Iterator(last, nullptr));
+}
+
+TokenDatabase::Entries TokenDatabase::Find(
+    const uint32_t token, std::span<const uint32_t> string_offsets) const {
+  const auto [first, last] = FindRawEntries(token);
+
+  if (first == last) {
+    return Entries(end(), end());
   }
 
-  return Entries(first, last);
+  return Entries(
+      Iterator(first, end_.data + string_offsets[first - begin_.entry]),
+      Iterator(last, nullptr));
+}
+
+std::pair<const TokenDatabase::RawEntry*, const TokenDatabase::RawEntry*>
+TokenDatabase::FindRawEntries(const uint32_t token) const {
+  const RawEntry* const first = std::lower_bound(
+      begin_.entry, end_.entry, token, [](const RawEntry& entry, uint32_t t) {
+        return entry.token < t;
+      });
+  const RawEntry* const last = std::upper_bound(
+      first, end_.entry, token, [](uint32_t t, const RawEntry& entry) {
+        return t < entry.token;
+      });
+  return {first, last};
+}
+
+const char* TokenDatabase::SkipStrings(const char* string, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    string += std::strlen(string) + 1;
+  }
+  return string;
 }
 
 }  // namespace pw::tokenizer
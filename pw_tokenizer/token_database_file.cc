@@ -0,0 +1,206 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_tokenizer/token_database_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "pw_status/try.h"
+
+namespace pw::tokenizer {
+namespace {
+
+struct IndexHeader {
+  std::array<char, 8> magic;
+  uint32_t entry_count;
+  uint32_t database_size_bytes;
+};
+
+static_assert(sizeof(IndexHeader) == 16u);
+
+constexpr std::array<char, 8> kIndexMagic = {
+    'T', 'K', 'I', 'N', 'D', 'E', 'X', '\0'};
+
+}  // namespace
+
+TokenDatabaseFile::MappedFile& TokenDatabaseFile::MappedFile::operator=(
+    MappedFile&& other) {
+  if (this != &other) {
+    Unmap();
+    data_ = other.data_;
+    size_ = other.size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+Status TokenDatabaseFile::MappedFile::Map(const char* path) {
+  Unmap();
+
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return Status::NotFound();
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return Status::Internal();
+  }
+
+  if (info.st_size == 0) {
+    close(fd);
+    return OkStatus();
+  }
+
+  void* const data =
+      mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping remains valid after the file is closed.
+
+  if (data == MAP_FAILED) {
+    return Status::Internal();
+  }
+
+  data_ = static_cast<const char*>(data);
+  size_ = size_t(info.st_size);
+  return OkStatus();
+}
+
+void TokenDatabaseFile::MappedFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+Status TokenDatabaseFile::Open(const char* path, const char* index_path) {
+  *this = TokenDatabaseFile();
+
+  MappedFile file;
+  PW_TRY(file.Map(path));
+
+  if (file.size() > std::numeric_limits<uint32_t>::max()) {
+    return Status::OutOfRange();
+  }
+
+  const std::span<const char> data(file.data(), file.size());
+  if (!TokenDatabase::IsValid(data)) {
+    return Status::DataLoss();
+  }
+
+  database_file_ = std::move(file);
+  database_ = TokenDatabase::Create(data);
+
+  if (index_path == nullptr || !UseIndex(index_path)) {
+    BuildIndex();
+  }
+  return OkStatus();
+}
+
+bool TokenDatabaseFile::UseIndex(const char* index_path) {
+  MappedFile index;
+  if (!index.Map(index_path).ok() || index.size() < sizeof(IndexHeader)) {
+    return false;
+  }
+
+  IndexHeader header;
+  std::memcpy(&header, index.data(), sizeof(header));
+
+  const size_t entries = database_.size();
+  if (header.magic != kIndexMagic || header.entry_count != entries ||
+      header.database_size_bytes != database_file_.size() ||
+      index.size() != sizeof(header) + entries * sizeof(uint32_t)) {
+    return false;
+  }
+
+  // The header is 16 bytes and mappings are page aligned, so the offsets are
+  // aligned.
+  const std::span<const uint32_t> offsets(
+      reinterpret_cast<const uint32_t*>(index.data() + sizeof(header)),
+      entries);
+
+  // Check that the offsets are in order and within the string table, and that
+  // the table ends with a null terminator, so that a corrupt index cannot
+  // cause reads outside of the database.
+  if (entries != 0u) {
+    const char* const end = database_file_.data() + database_file_.size();
+    const size_t string_table_size = size_t(end - (*database_.begin()).string);
+
+    if (end[-1] != '\0') {
+      return false;
+    }
+
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      if (offsets[i] >= string_table_size ||
+          (i > 0u && offsets[i] <= offsets[i - 1])) {
+        return false;
+      }
+    }
+  }
+
+  index_file_ = std::move(index);
+  string_offsets_ = offsets;
+  return true;
+}
+
+void TokenDatabaseFile::BuildIndex() {
+  built_offsets_.clear();
+  built_offsets_.reserve(database_.size());
+
+  const char* string_table = nullptr;
+  for (const TokenDatabase::Entry entry : database_) {
+    if (string_table == nullptr) {
+      string_table = entry.string;
+    }
+    built_offsets_.push_back(uint32_t(entry.string - string_table));
+  }
+
+  string_offsets_ = built_offsets_;
+}
+
+Status TokenDatabaseFile::WriteIndex(const char* index_path) const {
+  IndexHeader header{};
+  header.magic = kIndexMagic;
+  header.entry_count = uint32_t(string_offsets_.size());
+  header.database_size_bytes = uint32_t(database_file_.size());
+
+  std::FILE* file = std::fopen(index_path, "wb");
+  if (file == nullptr) {
+    return Status::Internal();
+  }
+
+  const bool written =
+      std::fwrite(&header, sizeof(header), 1, file) == 1u &&
+      std::fwrite(string_offsets_.data(),
+                  sizeof(uint32_t),
+                  string_offsets_.size(),
+                  file) == string_offsets_.size();
+
+  if (std::fclose(file) != 0 || !written) {
+    return Status::Internal();
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::tokenizer
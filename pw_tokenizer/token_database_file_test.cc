@@ -0,0 +1,168 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_tokenizer/token_database_file.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include "gtest/gtest.h"
+
+namespace pw::tokenizer {
+namespace {
+
+using namespace std::literals::string_view_literals;
+
+constexpr std::string_view kDatabase =
+    "TOKENS\0\0"
+    "\x04\x00\x00\x00"
+    "\0\0\0\0"
+    "\x01\x00\x00\x00----"
+    "\x02\x00\x00\x00----"
+    "\x02\x00\x00\x00----"
+    "\xFF\x00\x00\x00----"
+    "hi!\0"
+    "goodbye\0"
+    "two\0"
+    "last\0"sv;
+
+// Provides paths for temporary files, which are removed after each test.
+class TokenDatabaseFileTest : public ::testing::Test {
+ protected:
+  TokenDatabaseFileTest()
+      : database_path_(TempPath()), index_path_(database_path_ + ".index") {}
+
+  ~TokenDatabaseFileTest() {
+    std::remove(database_path_.c_str());
+    std::remove(index_path_.c_str());
+  }
+
+  static std::string TempPath() {
+    char path[] = "/tmp/pw_tokenizer_database_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return path;
+  }
+
+  static void WriteFile(const std::string& path, std::string_view contents) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(std::fwrite(contents.data(), 1, contents.size(), file),
+              contents.size());
+    ASSERT_EQ(std::fclose(file), 0);
+  }
+
+  static void ExpectEntries(const TokenDatabaseFile& file) {
+    ASSERT_EQ(file.database().size(), 4u);
+    EXPECT_STREQ(file.Find(1)[0].string, "hi!");
+    ASSERT_EQ(file.Find(2).size(), 2u);
+    EXPECT_STREQ(file.Find(2)[0].string, "goodbye");
+    EXPECT_STREQ(file.Find(2)[1].string, "two");
+    EXPECT_STREQ(file.Find(0xFF)[0].string, "last");
+    EXPECT_TRUE(file.Find(3).empty());
+  }
+
+  const std::string database_path_;
+  const std::string index_path_;
+};
+
+TEST_F(TokenDatabaseFileTest, Open_BuildsIndex) {
+  WriteFile(database_path_, kDatabase);
+
+  TokenDatabaseFile file;
+  ASSERT_EQ(OkStatus(), file.Open(database_path_.c_str()));
+  EXPECT_FALSE(file.index_loaded());
+  ExpectEntries(file);
+}
+
+TEST_F(TokenDatabaseFileTest, Open_MissingFile) {
+  TokenDatabaseFile file;
+  EXPECT_EQ(Status::NotFound(), file.Open("/this/file/does/not/exist"));
+  EXPECT_EQ(file.database().size(), 0u);
+}
+
+TEST_F(TokenDatabaseFileTest, Open_InvalidDatabase) {
+  TokenDatabaseFile file;
+
+  WriteFile(database_path_, "");
+  EXPECT_EQ(Status::DataLoss(), file.Open(database_path_.c_str()));
+
+  WriteFile(database_path_, "TOKENS\0\0\x04\0\0\0\0\0\0\0"sv);
+  EXPECT_EQ(Status::DataLoss(), file.Open(database_path_.c_str()));
+}
+
+TEST_F(TokenDatabaseFileTest, WriteIndex_LoadedByOpen) {
+  WriteFile(database_path_, kDatabase);
+
+  TokenDatabaseFile file;
+  ASSERT_EQ(OkStatus(), file.Open(database_path_.c_str()));
+  ASSERT_EQ(OkStatus(), file.WriteIndex(index_path_.c_str()));
+
+  TokenDatabaseFile indexed;
+  ASSERT_EQ(OkStatus(),
+            indexed.Open(database_path_.c_str(), index_path_.c_str()));
+  EXPECT_TRUE(indexed.index_loaded());
+  ExpectEntries(indexed);
+}
+
+TEST_F(TokenDatabaseFileTest, Open_MissingIndex_BuildsIndex) {
+  WriteFile(database_path_, kDatabase);
+
+  TokenDatabaseFile file;
+  ASSERT_EQ(OkStatus(),
+            file.Open(database_path_.c_str(), index_path_.c_str()));
+  EXPECT_FALSE(file.index_loaded());
+  ExpectEntries(file);
+}
+
+TEST_F(TokenDatabaseFileTest, Open_MismatchedIndex_Ignored) {
+  // Write an index for a different database.
+  WriteFile(database_path_,
+            "TOKENS\0\0\x01\0\0\0\0\0\0\0"
+            "\x01\0\0\0----hi!\0"sv);
+  TokenDatabaseFile file;
+  ASSERT_EQ(OkStatus(), file.Open(database_path_.c_str()));
+  ASSERT_EQ(OkStatus(), file.WriteIndex(index_path_.c_str()));
+
+  WriteFile(database_path_, kDatabase);
+  ASSERT_EQ(OkStatus(),
+            file.Open(database_path_.c_str(), index_path_.c_str()));
+  EXPECT_FALSE(file.index_loaded());
+  ExpectEntries(file);
+}
+
+TEST_F(TokenDatabaseFileTest, Open_CorruptIndex_Ignored) {
+  WriteFile(database_path_, kDatabase);
+
+  // The header is valid, but the offsets are out of order.
+  WriteFile(index_path_,
+            "TKINDEX\0\x04\0\0\0"sv
+            "\x45\0\0\0"
+            "\0\0\0\0\x09\0\0\0\x04\0\0\0\x10\0\0\0"sv);
+
+  TokenDatabaseFile file;
+  ASSERT_EQ(OkStatus(),
+            file.Open(database_path_.c_str(), index_path_.c_str()));
+  EXPECT_FALSE(file.index_loaded());
+  ExpectEntries(file);
+}
+
+}  // namespace
+}  // namespace pw::tokenizer
@@ -36,6 +36,61 @@ alignas(TokenDatabase::RawEntry) constexpr char kBasicData[] =
     "goodbye\0"
     ":)";
 
+alignas(TokenDatabase::RawEntry) constexpr char kLargerData[] =
+    "TOKENS\0\0\x08\0\0\0\0\0\0\0"
+    "\x01\0\0\0date"
+    "\x03\0\0\0date"
+    "\x05\0\0\0date"
+    "\x05\0\0\0date"
+    "\x07\0\0\0date"
+    "\x09\0\0\0date"
+    "\x00\x01\0\0date"
+    "\xFF\xFF\xFF\xFF"
+    "date"
+    "one\0three\0five\0\0seven\0nine\0two fifty-six\0max\0";
+
+constexpr TokenDatabase kLarger = TokenDatabase::Create<kLargerData>();
+static_assert(kLarger.size() == 8u);
+
+TEST(TokenDatabase, Find_EachEntry) {
+  EXPECT_STREQ(kLarger.Find(1)[0].string, "one");
+  EXPECT_STREQ(kLarger.Find(3)[0].string, "three");
+  EXPECT_STREQ(kLarger.Find(7)[0].string, "seven");
+  EXPECT_STREQ(kLarger.Find(9)[0].string, "nine");
+  EXPECT_STREQ(kLarger.Find(256)[0].string, "two fifty-six");
+  EXPECT_STREQ(kLarger.Find(0xFFFFFFFFu)[0].string, "max");
+}
+
+TEST(TokenDatabase, Find_MatchesIteration) {
+  for (TokenDatabase::Entry entry : kLarger) {
+    TokenDatabase::Entries match = kLarger.Find(entry.token);
+    ASSERT_FALSE(match.empty());
+
+    bool found = false;
+    for (TokenDatabase::Entry matched : match) {
+      EXPECT_EQ(matched.token, entry.token);
+      found = found || matched.string == entry.string;
+    }
+    EXPECT_TRUE(found);
+  }
+}
+
+TEST(TokenDatabase, Find_CollisionAfterOtherEntries) {
+  TokenDatabase::Entries match = kLarger.Find(5);
+  ASSERT_EQ(match.size(), 2u);
+  EXPECT_STREQ(match[0].string, "five");
+  EXPECT_STREQ(match[1].string, "");
+  EXPECT_EQ(match.end()->token, 7u);
+}
+
+TEST(TokenDatabase, Find_BetweenEntries) {
+  EXPECT_TRUE(kLarger.Find(0).empty());
+  EXPECT_TRUE(kLarger.Find(2).empty());
+  EXPECT_TRUE(kLarger.Find(8).empty());
+  EXPECT_TRUE(kLarger.Find(255).empty());
+  EXPECT_TRUE(kLarger.Find(0xFFFFFFFEu).empty());
+}
+
 alignas(TokenDatabase::RawEntry) constexpr char kEmptyData[] =
     "TOKENS\0\0\x00\x00\x00\x00\0\0\0";  // Last byte is null terminator.
 
@@ -14,6 +14,9 @@
 
 #include "pw_tokenizer/tokenize_to_global_handler_with_payload.h"
 
+#include <cstring>
+
+#include "pw_tokenizer/config.h"
 #include "pw_tokenizer/encode_args.h"
 
 namespace pw {
@@ -24,6 +27,33 @@ extern "C" void _pw_tokenizer_ToGlobalHandlerWithPayload(
     pw_tokenizer_Token token,
     pw_tokenizer_ArgTypes types,
     ...) {
+#if PW_TOKENIZER_CFG_ENCODE_IN_PLACE
+  size_t buffer_size = 0;
+  uint8_t* const buffer =
+      pw_tokenizer_AcquireEncodeBufferWithPayload(payload, &buffer_size);
+  if (buffer == nullptr) {
+    return;
+  }
+
+  if (buffer_size < sizeof(token)) {
+    pw_tokenizer_ReleaseEncodeBufferWithPayload(payload, buffer, 0);
+    return;
+  }
+
+  std::memcpy(buffer, &token, sizeof(token));
+
+  va_list args;
+  va_start(args, types);
+  const size_t args_size = EncodeArgs(
+      types,
+      args,
+      std::span(reinterpret_cast<std::byte*>(buffer), buffer_size)
+          .subspan(sizeof(token)));
+  va_end(args);
+
+  pw_tokenizer_ReleaseEncodeBufferWithPayload(
+      payload, buffer, sizeof(token) + args_size);
+#else
   va_list args;
   va_start(args, types);
   EncodedMessage encoded(token, types, args);
@@ -31,6 +61,7 @@ extern "C" void _pw_tokenizer_ToGlobalHandlerWithPayload(
 
   pw_tokenizer_HandleEncodedMessageWithPayload(
       payload, encoded.data_as_uint8(), encoded.size());
+#endif  // PW_TOKENIZER_CFG_ENCODE_IN_PLACE
 }
 
 }  // namespace tokenizer
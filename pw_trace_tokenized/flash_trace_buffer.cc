@@ -0,0 +1,339 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_trace_tokenized/flash_trace_buffer.h"
+
+#include <cstring>
+
+#include "pw_checksum/crc16_ccitt.h"
+#include "pw_kvs/alignment.h"
+#include "pw_status/try.h"
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+namespace {
+
+// Whether sequence a is after b, allowing the sequence to wrap.
+bool SequenceAfter(uint32_t a, uint32_t b) {
+  return static_cast<int32_t>(a - b) > 0;
+}
+
+}  // namespace
+
+FlashTraceBuffer::FlashTraceBuffer(kvs::FlashPartition& partition,
+                                   std::span<std::byte> page_buffer)
+    : partition_(partition), page_buffer_(page_buffer) {}
+
+size_t FlashTraceBuffer::sector_header_size() const {
+  return AlignUp(sizeof(SectorHeader), partition_.alignment_bytes());
+}
+
+size_t FlashTraceBuffer::padded_page_size(size_t data_size) const {
+  return AlignUp(kPageHeaderSize + data_size,
+                      partition_.alignment_bytes());
+}
+
+Status FlashTraceBuffer::Init() {
+  if (partition_.sector_count() < 2u ||
+      partition_.alignment_bytes() > kMaxAlignmentBytes ||
+      page_buffer_.empty() || page_buffer_.size() > UINT16_MAX ||
+      sector_header_size() + padded_page_size(page_buffer_.size()) >
+          partition_.sector_size_bytes()) {
+    return Status::InvalidArgument();
+  }
+
+  page_size_ = 0;
+  page_events_ = 0;
+  bool found = false;
+  for (size_t sector = 0; sector < partition_.sector_count(); ++sector) {
+    SectorHeader header;
+    const Status status = ReadSectorHeader(sector, header);
+    if (status.IsNotFound()) {
+      continue;
+    }
+    PW_TRY(status);
+    if (!found || SequenceAfter(header.sequence, sequence_)) {
+      found = true;
+      write_sector_ = sector;
+      sequence_ = header.sequence;
+    }
+  }
+
+  if (!found) {
+    return Clear();
+  }
+
+  erased_sectors_ahead_ = 0;
+  while (erased_sectors_ahead_ + 1 < partition_.sector_count()) {
+    const size_t sector = (write_sector_ + erased_sectors_ahead_ + 1) %
+                          partition_.sector_count();
+    bool erased;
+    PW_TRY(partition_.IsRegionErased(
+        sector_address(sector), partition_.sector_size_bytes(), &erased));
+    if (!erased) {
+      break;
+    }
+    erased_sectors_ahead_ += 1;
+  }
+
+  const Status status = FindWriteOffset();
+  if (status.IsDataLoss()) {
+    return StartNextSector();
+  }
+  return status;
+}
+
+Status FlashTraceBuffer::ReadSectorHeader(size_t sector, SectorHeader& header) {
+  PW_TRY(partition_.Read(sector_address(sector), sizeof(header), &header));
+  if (header.magic != kSectorMagic) {
+    return Status::NotFound();
+  }
+  return OkStatus();
+}
+
+Status FlashTraceBuffer::FindWriteOffset() {
+  const kvs::FlashPartition::Address sector_start =
+      sector_address(write_sector_);
+  size_t offset = sector_header_size();
+
+  while (offset + kPageHeaderSize <= partition_.sector_size_bytes()) {
+    std::byte header[kPageHeaderSize];
+    PW_TRY(partition_.Read(sector_start + offset, sizeof(header), header));
+
+    bool header_erased = true;
+    for (std::byte b : header) {
+      header_erased = header_erased && b == partition_.erased_memory_content();
+    }
+    if (header_erased) {
+      // A page write may have been interrupted after its header, so check that
+      // the rest of the sector is erased too.
+      bool erased;
+      PW_TRY(partition_.IsRegionErased(sector_start + offset,
+                                       partition_.sector_size_bytes() - offset,
+                                       &erased));
+      if (!erased) {
+        return Status::DataLoss();
+      }
+      break;
+    }
+
+    uint16_t size;
+    uint16_t crc;
+    std::memcpy(&size, &header[0], sizeof(size));
+    std::memcpy(&crc, &header[sizeof(size)], sizeof(crc));
+    if (size == 0u || size > page_buffer_.size() ||
+        offset + padded_page_size(size) > partition_.sector_size_bytes()) {
+      return Status::DataLoss();
+    }
+    PW_TRY(partition_.Read(
+        sector_start + offset + kPageHeaderSize, size, page_buffer_.data()));
+    if (checksum::Crc16Ccitt::Calculate(page_buffer_.first(size)) != crc) {
+      return Status::DataLoss();
+    }
+    offset += padded_page_size(size);
+  }
+
+  write_offset_ = offset;
+  return OkStatus();
+}
+
+Status FlashTraceBuffer::WriteAligned(kvs::FlashPartition::Address address,
+                                      std::span<const std::byte> header,
+                                      std::span<const std::byte> data) {
+  kvs::FlashPartition::Output output(partition_, address);
+  AlignedWriterBuffer<kMaxAlignmentBytes> writer(
+      partition_.alignment_bytes(), output);
+  PW_TRY(writer.Write(header).status());
+  PW_TRY(writer.Write(data).status());
+  return writer.Flush().status();
+}
+
+Status FlashTraceBuffer::StartNextSector() {
+  const size_t sector = next_sector();
+  if (erased_sectors_ahead_ == 0u) {
+    PW_TRY(partition_.Erase(sector_address(sector), 1));
+    synchronous_erases_ += 1;
+  } else {
+    erased_sectors_ahead_ -= 1;
+  }
+
+  write_sector_ = sector;
+  write_offset_ = sector_header_size();
+  sequence_ += 1;
+
+  const SectorHeader header{kSectorMagic, sequence_};
+  return WriteAligned(
+      sector_address(sector), std::as_bytes(std::span(&header, 1)), {});
+}
+
+Status FlashTraceBuffer::EraseAhead() {
+  if (erased_sectors_ahead_ > 0u) {
+    return OkStatus();
+  }
+  PW_TRY(partition_.Erase(sector_address(next_sector()), 1));
+  erased_sectors_ahead_ = 1;
+  return OkStatus();
+}
+
+Status FlashTraceBuffer::Clear() {
+  page_size_ = 0;
+  page_events_ = 0;
+  PW_TRY(partition_.Erase());
+
+  // Start with the last sector, so recording starts in the first one.
+  write_sector_ = partition_.sector_count() - 1;
+  sequence_ = 0;
+  erased_sectors_ahead_ = partition_.sector_count();
+  return StartNextSector();
+}
+
+Status FlashTraceBuffer::Flush() {
+  if (page_size_ == 0u) {
+    return OkStatus();
+  }
+  const std::span<const std::byte> data = page_buffer_.first(page_size_);
+  const uint32_t events = page_events_;
+  page_size_ = 0;
+  page_events_ = 0;
+
+  const Status status = WritePage(data);
+  if (!status.ok()) {
+    dropped_events_ += events;
+  }
+  return status;
+}
+
+Status FlashTraceBuffer::WritePage(std::span<const std::byte> data) {
+  if (write_offset_ + padded_page_size(data.size()) >
+      partition_.sector_size_bytes()) {
+    PW_TRY(StartNextSector());
+  }
+
+  const uint16_t size = static_cast<uint16_t>(data.size());
+  const uint16_t crc = checksum::Crc16Ccitt::Calculate(data);
+  std::byte header[kPageHeaderSize];
+  std::memcpy(&header[0], &size, sizeof(size));
+  std::memcpy(&header[sizeof(size)], &crc, sizeof(crc));
+
+  const kvs::FlashPartition::Address address =
+      sector_address(write_sector_) + write_offset_;
+  // The space is used even if the write fails, since it may be partly written.
+  write_offset_ += padded_page_size(data.size());
+  return WriteAligned(address, header, data);
+}
+
+Status FlashTraceBuffer::ForEachPage(
+    std::span<std::byte> buffer,
+    const Function<Status(std::span<const std::byte> page)>& callback) {
+  for (size_t i = 1; i <= partition_.sector_count(); ++i) {
+    const size_t sector = (write_sector_ + i) % partition_.sector_count();
+    SectorHeader header;
+    const Status status = ReadSectorHeader(sector, header);
+    if (status.IsNotFound()) {
+      continue;
+    }
+    PW_TRY(status);
+
+    const size_t end = sector == write_sector_ ? write_offset_
+                                               : partition_.sector_size_bytes();
+    size_t offset = sector_header_size();
+    while (offset + kPageHeaderSize <= end) {
+      const kvs::FlashPartition::Address address =
+          sector_address(sector) + offset;
+      uint16_t size;
+      uint16_t crc;
+      PW_TRY(partition_.Read(address, sizeof(size), &size));
+      PW_TRY(partition_.Read(address + sizeof(size), sizeof(crc), &crc));
+      if (size == 0u || size > buffer.size() ||
+          offset + padded_page_size(size) > end) {
+        break;  // The rest of the sector is erased or not valid.
+      }
+      PW_TRY(partition_.Read(address + kPageHeaderSize, size, buffer.data()));
+      const std::span<const std::byte> page = buffer.first(size);
+      if (checksum::Crc16Ccitt::Calculate(page) != crc) {
+        break;
+      }
+      PW_TRY(callback(std::span<const std::byte>(page)));
+      offset += padded_page_size(size);
+    }
+  }
+  return OkStatus();
+}
+
+Status FlashTraceBuffer::Register() {
+  if (registered_) {
+    return Status::FailedPrecondition();
+  }
+  PW_TRY(Callbacks::Instance().RegisterSink(
+      SinkStartBlock, SinkAddBytes, SinkEndBlock, this, &sink_handle_));
+  registered_ = true;
+  return OkStatus();
+}
+
+Status FlashTraceBuffer::Unregister() {
+  if (!registered_) {
+    return Status::FailedPrecondition();
+  }
+  registered_ = false;
+  return Callbacks::Instance().UnregisterSink(sink_handle_);
+}
+
+void FlashTraceBuffer::AddEvent(std::span<const std::byte> event) {
+  std::byte prefix[varint::kMaxVarint64SizeBytes];
+  const size_t prefix_size = varint::Encode(event.size(), prefix);
+  const size_t entry_size = prefix_size + event.size();
+  if (entry_size > page_buffer_.size()) {
+    dropped_events_ += 1;
+    return;
+  }
+
+  if (page_size_ + entry_size > page_buffer_.size()) {
+    Flush().IgnoreError();  // Failures are counted in dropped_events_.
+  }
+  std::memcpy(&page_buffer_[page_size_], prefix, prefix_size);
+  std::memcpy(&page_buffer_[page_size_ + prefix_size],
+              event.data(),
+              event.size());
+  page_size_ += entry_size;
+  page_events_ += 1;
+}
+
+void FlashTraceBuffer::SinkStartBlock(void* user_data, size_t size) {
+  FlashTraceBuffer& buffer = *static_cast<FlashTraceBuffer*>(user_data);
+  buffer.block_size_ = size;
+  buffer.block_index_ = 0;
+}
+
+void FlashTraceBuffer::SinkAddBytes(void* user_data,
+                                    const void* bytes,
+                                    size_t size) {
+  FlashTraceBuffer& buffer = *static_cast<FlashTraceBuffer*>(user_data);
+  if (buffer.block_size_ > sizeof(buffer.block_) ||
+      buffer.block_index_ + size > buffer.block_size_) {
+    return;  // The block is too large; it is dropped at the end.
+  }
+  std::memcpy(&buffer.block_[buffer.block_index_], bytes, size);
+  buffer.block_index_ += size;
+}
+
+void FlashTraceBuffer::SinkEndBlock(void* user_data) {
+  FlashTraceBuffer& buffer = *static_cast<FlashTraceBuffer*>(user_data);
+  if (buffer.block_index_ != buffer.block_size_) {
+    buffer.dropped_events_ += 1;
+    return;
+  }
+  buffer.AddEvent(std::span(buffer.block_, buffer.block_size_));
+}
+
+}  // namespace pw::trace
@@ -0,0 +1,214 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_TRACE_MODULE_NAME "TST"
+
+#include "pw_trace_tokenized/flash_trace_buffer.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_trace/trace.h"
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+namespace {
+
+constexpr size_t kSectorSize = 256;
+constexpr size_t kSectorCount = 4;
+constexpr size_t kAlignment = 16;
+
+// Each event is a 1 byte size, 4 byte token, 1 byte time delta, and 4 bytes of
+// data, so 6 events fit in a page and 3 pages fit in a sector.
+constexpr size_t kPageSize = 64;
+constexpr size_t kEventsPerPage = 6;
+constexpr size_t kEventsPerSector = 3 * kEventsPerPage;
+
+class FlashTraceBufferTest : public ::testing::Test {
+ protected:
+  FlashTraceBufferTest() : flash_(kAlignment), partition_(&flash_) {
+    PW_TRACE_SET_ENABLED(true);
+  }
+
+  // Traces events with consecutive counters as their data.
+  void TraceEvents(size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      PW_TRACE_INSTANT_DATA("Test", "u32", &counter_, sizeof(counter_));
+      counter_ += 1;
+    }
+  }
+
+  // Returns the counters of the events stored in flash.
+  std::vector<uint32_t> ReadCounters(FlashTraceBuffer& buffer) {
+    std::vector<uint32_t> counters;
+    std::array<std::byte, kPageSize> read_buffer;
+    EXPECT_EQ(
+        OkStatus(),
+        buffer.ForEachPage(read_buffer,
+                           [&counters](std::span<const std::byte> page) {
+                             while (!page.empty()) {
+                               uint64_t size;
+                               const size_t prefix =
+                                   varint::Decode(page, &size);
+                               uint32_t counter;
+                               std::memcpy(&counter,
+                                           &page[prefix + size - 4],
+                                           sizeof(counter));
+                               counters.push_back(counter);
+                               page = page.subspan(prefix + size);
+                             }
+                             return OkStatus();
+                           }));
+    return counters;
+  }
+
+  static std::vector<uint32_t> Range(uint32_t first, uint32_t last) {
+    std::vector<uint32_t> values;
+    for (uint32_t i = first; i < last; ++i) {
+      values.push_back(i);
+    }
+    return values;
+  }
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  std::array<std::byte, kPageSize> page_buffer_;
+  uint32_t counter_ = 0;
+};
+
+TEST_F(FlashTraceBufferTest, InvalidPageBuffer) {
+  std::array<std::byte, kSectorSize> large_buffer;
+  FlashTraceBuffer buffer(partition_, large_buffer);
+  EXPECT_EQ(buffer.Init(), Status::InvalidArgument());
+}
+
+TEST_F(FlashTraceBufferTest, RecordsEventsInPages) {
+  FlashTraceBuffer buffer(partition_, page_buffer_);
+  ASSERT_EQ(buffer.Init(), OkStatus());
+  ASSERT_EQ(buffer.Register(), OkStatus());
+
+  TraceEvents(kEventsPerPage + 2);
+
+  // Only the full page has been written.
+  EXPECT_EQ(ReadCounters(buffer), Range(0, kEventsPerPage));
+
+  ASSERT_EQ(buffer.Flush(), OkStatus());
+  EXPECT_EQ(ReadCounters(buffer), Range(0, kEventsPerPage + 2));
+  EXPECT_EQ(buffer.dropped_events(), 0u);
+  EXPECT_EQ(buffer.Unregister(), OkStatus());
+}
+
+TEST_F(FlashTraceBufferTest, ReadableAfterReboot) {
+  {
+    FlashTraceBuffer buffer(partition_, page_buffer_);
+    ASSERT_EQ(buffer.Init(), OkStatus());
+    ASSERT_EQ(buffer.Register(), OkStatus());
+    TraceEvents(10);
+    ASSERT_EQ(buffer.Flush(), OkStatus());
+    ASSERT_EQ(buffer.Unregister(), OkStatus());
+  }
+
+  FlashTraceBuffer buffer(partition_, page_buffer_);
+  ASSERT_EQ(buffer.Init(), OkStatus());
+  EXPECT_EQ(ReadCounters(buffer), Range(0, 10));
+
+  // New events are added after the old ones.
+  ASSERT_EQ(buffer.Register(), OkStatus());
+  TraceEvents(5);
+  ASSERT_EQ(buffer.Flush(), OkStatus());
+  EXPECT_EQ(ReadCounters(buffer), Range(0, 15));
+  EXPECT_EQ(buffer.Unregister(), OkStatus());
+}
+
+TEST_F(FlashTraceBufferTest, WrapsAroundSectors) {
+  FlashTraceBuffer buffer(partition_, page_buffer_);
+  ASSERT_EQ(buffer.Init(), OkStatus());
+  ASSERT_EQ(buffer.Register(), OkStatus());
+
+  // Fill every sector, then one page into the first sector again.
+  const uint32_t total = (kSectorCount * kEventsPerSector) + kEventsPerPage;
+  TraceEvents(total);
+  ASSERT_EQ(buffer.Flush(), OkStatus());
+
+  // The first sector was erased when writing wrapped around to it.
+  EXPECT_EQ(buffer.synchronous_erases(), 1u);
+  EXPECT_EQ(ReadCounters(buffer), Range(kEventsPerSector, total));
+  EXPECT_EQ(buffer.Unregister(), OkStatus());
+
+  // The history is the same after a reboot.
+  FlashTraceBuffer rebooted(partition_, page_buffer_);
+  ASSERT_EQ(rebooted.Init(), OkStatus());
+  EXPECT_EQ(ReadCounters(rebooted), Range(kEventsPerSector, total));
+}
+
+TEST_F(FlashTraceBufferTest, EraseAhead) {
+  FlashTraceBuffer buffer(partition_, page_buffer_);
+  ASSERT_EQ(buffer.Init(), OkStatus());
+  ASSERT_EQ(buffer.Register(), OkStatus());
+
+  for (size_t page = 0; page < 3 * kSectorCount; ++page) {
+    TraceEvents(kEventsPerPage);
+    ASSERT_EQ(buffer.Flush(), OkStatus());
+    ASSERT_EQ(buffer.EraseAhead(), OkStatus());
+  }
+
+  // The sector after the write sector is kept erased, so writes never wait for
+  // an erase, at the cost of one sector of history.
+  EXPECT_EQ(buffer.synchronous_erases(), 0u);
+  const uint32_t total = kSectorCount * kEventsPerSector;
+  EXPECT_EQ(ReadCounters(buffer), Range(kEventsPerSector, total));
+  EXPECT_EQ(buffer.Unregister(), OkStatus());
+}
+
+TEST_F(FlashTraceBufferTest, PartialWriteContinuesInNextSector) {
+  {
+    FlashTraceBuffer buffer(partition_, page_buffer_);
+    ASSERT_EQ(buffer.Init(), OkStatus());
+    ASSERT_EQ(buffer.Register(), OkStatus());
+    TraceEvents(kEventsPerPage);
+    ASSERT_EQ(buffer.Flush(), OkStatus());
+    ASSERT_EQ(buffer.Unregister(), OkStatus());
+  }
+
+  // Simulate a page write interrupted after its header.
+  const std::array<std::byte, kAlignment> garbage = {std::byte{0x12}};
+  ASSERT_EQ(partition_.Write(16 + 64 + 16, garbage).status(), OkStatus());
+
+  FlashTraceBuffer buffer(partition_, page_buffer_);
+  ASSERT_EQ(buffer.Init(), OkStatus());
+  ASSERT_EQ(buffer.Register(), OkStatus());
+  TraceEvents(kEventsPerPage);
+  ASSERT_EQ(buffer.Flush(), OkStatus());
+
+  EXPECT_EQ(ReadCounters(buffer), Range(0, 2 * kEventsPerPage));
+  EXPECT_EQ(buffer.Unregister(), OkStatus());
+}
+
+TEST_F(FlashTraceBufferTest, Clear) {
+  FlashTraceBuffer buffer(partition_, page_buffer_);
+  ASSERT_EQ(buffer.Init(), OkStatus());
+  ASSERT_EQ(buffer.Register(), OkStatus());
+  TraceEvents(kEventsPerPage + 1);
+
+  ASSERT_EQ(buffer.Clear(), OkStatus());
+  ASSERT_EQ(buffer.Flush(), OkStatus());
+  EXPECT_TRUE(ReadCounters(buffer).empty());
+  EXPECT_EQ(buffer.Unregister(), OkStatus());
+}
+
+}  // namespace
+}  // namespace pw::trace
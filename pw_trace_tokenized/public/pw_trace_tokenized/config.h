@@ -28,6 +28,55 @@
 #define PW_TRACE_QUEUE_SIZE_EVENTS 5
 #endif  // PW_TRACE_QUEUE_SIZE_EVENTS
 
+// PW_TRACE_CONFIG_DEFERRED_PRODUCERS enables deferred processing of trace
+// events when set to a nonzero value. Instead of taking PW_TRACE_QUEUE_LOCK and
+// running the callbacks and sinks when an event is traced, the event's token,
+// time, id, and data are copied into a wait-free single producer queue, and
+// the callbacks and sinks are run later by
+// TokenizedTraceImpl::DrainDeferredEvents(). This sets the number of producer
+// queues, which are selected with PW_TRACE_GET_PRODUCER_INDEX().
+#ifndef PW_TRACE_CONFIG_DEFERRED_PRODUCERS
+#define PW_TRACE_CONFIG_DEFERRED_PRODUCERS 0
+#endif  // PW_TRACE_CONFIG_DEFERRED_PRODUCERS
+
+// PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER is the number of events each
+// producer queue holds between drains. It must be a power of two. Events are
+// dropped when a producer's queue is full.
+#ifndef PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER
+#define PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER 16
+#endif  // PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER
+
+// PW_TRACE_GET_PRODUCER_INDEX returns the index of the producer queue for the
+// current context, which must be less than PW_TRACE_CONFIG_DEFERRED_PRODUCERS.
+// Each queue is single producer: two contexts which can preempt each other, or
+// run on different cores at the same time, must not share an index. For
+// example, use one index per core with tracing disabled in interrupts, or one
+// per thread plus one per interrupt priority level. The default is only safe
+// if events are traced from a single context.
+#ifndef PW_TRACE_GET_PRODUCER_INDEX
+#define PW_TRACE_GET_PRODUCER_INDEX() (0u)
+#endif  // PW_TRACE_GET_PRODUCER_INDEX
+
+// --- Config options for categories ---
+
+// Each module can assign its trace events to a category from 0 to 31, by
+// defining PW_TRACE_CATEGORY before including pw_trace/trace.h. Events are in
+// category 0 by default.
+//
+// PW_TRACE_CONFIG_ENABLED_CATEGORIES is a mask of the categories which are
+// compiled in. Trace events in other categories compile to nothing.
+#ifndef PW_TRACE_CONFIG_ENABLED_CATEGORIES
+#define PW_TRACE_CONFIG_ENABLED_CATEGORIES 0xffffffffu
+#endif  // PW_TRACE_CONFIG_ENABLED_CATEGORIES
+
+// PW_TRACE_CONFIG_DEFAULT_CATEGORY_MASK is the mask of categories enabled at
+// run time until PW_TRACE_SET_CATEGORY_MASK is called. Events in categories
+// which are disabled at run time are discarded with a single load and test,
+// before the event is queued or any callback is called.
+#ifndef PW_TRACE_CONFIG_DEFAULT_CATEGORY_MASK
+#define PW_TRACE_CONFIG_DEFAULT_CATEGORY_MASK 0xffffffffu
+#endif  // PW_TRACE_CONFIG_DEFAULT_CATEGORY_MASK
+
 // --- Config options for time source ----
 
 // PW_TRACE_TIME_TYPE sets the type for trace time.
@@ -119,6 +168,22 @@ static_assert(
 #define PW_TRACE_QUEUE_UNLOCK()
 #endif  // PW_TRACE_QUEUE_UNLOCK
 
+// --- Config options for trace streaming ---
+
+// PW_TRACE_CONFIG_STREAM_DICTIONARY_ENTRIES is the number of distinct tokens a
+// trace stream packet can hold. A packet is finished early if more distinct
+// tokens are traced.
+#ifndef PW_TRACE_CONFIG_STREAM_DICTIONARY_ENTRIES
+#define PW_TRACE_CONFIG_STREAM_DICTIONARY_ENTRIES 16
+#endif  // PW_TRACE_CONFIG_STREAM_DICTIONARY_ENTRIES
+
+// PW_TRACE_CONFIG_STREAM_PACKET_SIZE_BYTES is the size of the packets streamed
+// by the trace RPC service. This must not exceed the max_size of
+// pw.trace.TraceStreamPacket.events in trace_rpc.options.
+#ifndef PW_TRACE_CONFIG_STREAM_PACKET_SIZE_BYTES
+#define PW_TRACE_CONFIG_STREAM_PACKET_SIZE_BYTES 256
+#endif  // PW_TRACE_CONFIG_STREAM_PACKET_SIZE_BYTES
+
 // --- Config options for optional trace buffer ---
 
 // PW_TRACE_BUFFER_SIZE_BYTES is the size in bytes of the optional trace buffer.
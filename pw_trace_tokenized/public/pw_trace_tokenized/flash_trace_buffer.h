@@ -0,0 +1,172 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_function/function.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_status/status.h"
+#include "pw_trace_tokenized/config.h"
+#include "pw_trace_tokenized/trace_callback.h"
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+
+// FlashTraceBuffer is a trace sink which stores events in a flash partition,
+// so a long trace history can be kept without a large RAM buffer and read back
+// after a reboot.
+//
+// Events are batched in a RAM page buffer, in the same size prefixed format as
+// the trace buffer. When the page is full, or Flush() is called, it is written
+// to flash with a small header and CRC. The partition is used as a ring of
+// sectors: each sector starts with a header holding a sequence number, and when
+// the last sector is full, writing continues in the oldest one.
+//
+//   sector := sector_header page*
+//   sector_header := magic (4 bytes), sequence (4 bytes), padded to alignment
+//   page := size (2 bytes), crc16 (2 bytes), events, padded to alignment
+//
+// The sector after the one being written must be erased before writing can
+// move into it. EraseAhead() erases it, so the erase can be scheduled in a low
+// priority context ahead of the write pointer; otherwise it is erased when the
+// writer reaches it, in the context which writes the page.
+//
+// Pages are written from the sink callbacks, while trace events are processed.
+// To keep flash writes out of the traced code, use deferred processing or only
+// call Flush() from a low priority thread.
+class FlashTraceBuffer {
+ public:
+  // The page buffer holds the events for one page. It must fit in a sector with
+  // the sector and page headers.
+  FlashTraceBuffer(kvs::FlashPartition& partition,
+                   std::span<std::byte> page_buffer);
+
+  FlashTraceBuffer(const FlashTraceBuffer&) = delete;
+  FlashTraceBuffer& operator=(const FlashTraceBuffer&) = delete;
+
+  // Finds the end of the data written before a reboot, so new pages are added
+  // after it. Sectors without a valid header are ignored. If a page was
+  // partially written, writing continues in the next sector. Must be called
+  // before any other function. Returns:
+  //
+  //   OK - Ready to record trace events.
+  //   INVALID_ARGUMENT - The page buffer does not fit in a sector, the
+  //       partition has fewer than 2 sectors, or its alignment is larger
+  //       than kMaxAlignmentBytes.
+  //   other errors - Reading or erasing the partition failed.
+  //
+  Status Init();
+
+  // Registers and unregisters the buffer as a trace sink.
+  Status Register();
+  Status Unregister();
+
+  // Writes the events in the page buffer to flash, if there are any. This must
+  // not be called while trace events are processed; hold PW_TRACE_LOCK if they
+  // may be.
+  Status Flush();
+
+  // Erases the sector after the one being written, if it is not yet erased.
+  // This discards the oldest sector of trace history.
+  Status EraseAhead();
+
+  // Erases the whole partition and starts recording from the first sector.
+  Status Clear();
+
+  // Calls the callback with each page of events in flash, from oldest to
+  // newest, read into the provided buffer. Each page holds size prefixed
+  // tokenized events, so concatenated pages match the trace buffer format.
+  // Stops early and returns the callback's status if it is not OK. Pages in the
+  // page buffer which have not been flushed are not included.
+  Status ForEachPage(
+      std::span<std::byte> buffer,
+      const Function<Status(std::span<const std::byte> page)>& callback);
+
+  // The number of events which were not stored, because they did not fit in a
+  // page or writing their page failed.
+  uint32_t dropped_events() const { return dropped_events_; }
+
+  // The number of erases done when writing reached an unerased sector, rather
+  // than in EraseAhead().
+  uint32_t synchronous_erases() const { return synchronous_erases_; }
+
+ public:
+  static constexpr size_t kMaxAlignmentBytes = 64;
+
+ private:
+  static constexpr uint32_t kSectorMagic = 0x74726163;  // "trac"
+  static constexpr size_t kPageHeaderSize = 4;
+
+  struct SectorHeader {
+    uint32_t magic;
+    uint32_t sequence;
+  };
+
+  static void SinkStartBlock(void* user_data, size_t size);
+  static void SinkAddBytes(void* user_data, const void* bytes, size_t size);
+  static void SinkEndBlock(void* user_data);
+
+  void AddEvent(std::span<const std::byte> event);
+
+  size_t sector_header_size() const;
+  size_t padded_page_size(size_t data_size) const;
+  kvs::FlashPartition::Address sector_address(size_t sector) const {
+    return static_cast<kvs::FlashPartition::Address>(
+        sector * partition_.sector_size_bytes());
+  }
+  size_t next_sector() const {
+    return (write_sector_ + 1) % partition_.sector_count();
+  }
+
+  // Reads the header of a sector. Returns NOT_FOUND if it is not valid.
+  Status ReadSectorHeader(size_t sector, SectorHeader& header);
+
+  // Finds the end of the valid pages in the write sector. Returns DATA_LOSS if
+  // the sector cannot be written to after them.
+  Status FindWriteOffset();
+
+  Status WritePage(std::span<const std::byte> data);
+
+  Status WriteAligned(kvs::FlashPartition::Address address,
+                      std::span<const std::byte> header,
+                      std::span<const std::byte> data);
+
+  // Starts writing in the next sector, erasing it first if needed.
+  Status StartNextSector();
+
+  kvs::FlashPartition& partition_;
+  std::span<std::byte> page_buffer_;
+  size_t page_size_ = 0;  // Bytes of events in the page buffer.
+  uint32_t page_events_ = 0;
+
+  size_t write_sector_ = 0;
+  size_t write_offset_ = 0;  // Offset in the write sector.
+  uint32_t sequence_ = 0;
+  size_t erased_sectors_ahead_ = 0;  // Erased sectors after the write sector.
+
+  CallbacksImpl::SinkHandle sink_handle_ = 0;
+  bool registered_ = false;
+  uint32_t dropped_events_ = 0;
+  uint32_t synchronous_erases_ = 0;
+
+  // The event being received from the sink callbacks.
+  size_t block_size_ = 0;
+  size_t block_index_ = 0;
+  std::byte block_[PW_TRACE_BUFFER_MAX_BLOCK_SIZE_BYTES];
+};
+
+}  // namespace pw::trace
@@ -20,6 +20,13 @@
 #include <stdint.h>
 
 #include "pw_preprocessor/arguments.h"
+#include "pw_preprocessor/util.h"
+#include "pw_trace_tokenized/config.h"
+
+// The category of the trace events in this file. See config.h.
+#ifndef PW_TRACE_CATEGORY
+#define PW_TRACE_CATEGORY 0
+#endif  // PW_TRACE_CATEGORY
 
 // Because __FUNCTION__ is not a string literal to the preprocessor it can't be
 // tokenized. So this backend redefines the implementation to instead use the
@@ -31,6 +38,10 @@
 #define PW_TRACE_FUNCTION_LABEL \
   PW_TRACE_FUNCTION_LABEL_FILE_LINE(__FILE__, __LINE__)
 
+// The bit for a category in PW_TRACE_CONFIG_ENABLED_CATEGORIES and the run time
+// category mask.
+#define PW_TRACE_CATEGORY_MASK(category) (UINT32_C(1) << (category))
+
 // Enable these trace types
 #define PW_TRACE_TYPE_INSTANT PW_TRACE_EVENT_TYPE_INSTANT
 #define PW_TRACE_TYPE_INSTANT_GROUP PW_TRACE_EVENT_TYPE_INSTANT_GROUP
@@ -75,32 +86,54 @@ void pw_trace_Enable(bool enabled);
 // Returns true if tracing is currently enabled.
 bool pw_trace_IsEnabled(void);
 
+// This should not be called directly, instead: PW_TRACE_SET_CATEGORY_MASK
+void pw_trace_SetCategoryMask(uint32_t mask);
+
+// Returns the mask of categories which are enabled at run time.
+uint32_t pw_trace_GetCategoryMask(void);
+
+// The run time category mask. This should not be used directly.
+extern uint32_t pw_trace_category_mask;
+
 PW_EXTERN_C_END
 
+// True if trace events in the category are compiled in and enabled at run
+// time. The compile time check is a constant, so disabled categories are
+// removed entirely; the run time check is a single relaxed load.
+#define _PW_TRACE_CATEGORY_ENABLED(category)                     \
+  ((PW_TRACE_CONFIG_ENABLED_CATEGORIES &                         \
+    PW_TRACE_CATEGORY_MASK(category)) != 0u &&                   \
+   (__atomic_load_n(&pw_trace_category_mask, __ATOMIC_RELAXED) & \
+    PW_TRACE_CATEGORY_MASK(category)) != 0u)
+
 // These are what the facade actually calls.
-#define PW_TRACE(event_type, flags, label, group, trace_id)                  \
-  do {                                                                       \
-    static const uint32_t kLabelToken =                                      \
-        PW_TRACE_REF(event_type, PW_TRACE_MODULE_NAME, label, flags, group); \
-    pw_trace_TraceEvent(kLabelToken,                                         \
-                        event_type,                                          \
-                        PW_TRACE_MODULE_NAME,                                \
-                        trace_id,                                            \
-                        flags,                                               \
-                        NULL,                                                \
-                        0);                                                  \
+#define PW_TRACE(event_type, flags, label, group, trace_id)                    \
+  do {                                                                         \
+    if (_PW_TRACE_CATEGORY_ENABLED(PW_TRACE_CATEGORY)) {                       \
+      static const uint32_t kLabelToken =                                      \
+          PW_TRACE_REF(event_type, PW_TRACE_MODULE_NAME, label, flags, group); \
+      pw_trace_TraceEvent(kLabelToken,                                         \
+                          event_type,                                          \
+                          PW_TRACE_MODULE_NAME,                                \
+                          trace_id,                                            \
+                          flags,                                               \
+                          NULL,                                                \
+                          0);                                                  \
+    }                                                                          \
   } while (0)
 
-#define PW_TRACE_DATA(                                                \
-    event_type, flags, label, group, trace_id, type, data, size)      \
-  do {                                                                \
-    static const uint32_t kLabelToken = PW_TRACE_REF_DATA(            \
-        event_type, PW_TRACE_MODULE_NAME, label, flags, group, type); \
-    pw_trace_TraceEvent(kLabelToken,                                  \
-                        event_type,                                   \
-                        PW_TRACE_MODULE_NAME,                         \
-                        trace_id,                                     \
-                        flags,                                        \
-                        data,                                         \
-                        size);                                        \
+#define PW_TRACE_DATA(                                                  \
+    event_type, flags, label, group, trace_id, type, data, size)        \
+  do {                                                                  \
+    if (_PW_TRACE_CATEGORY_ENABLED(PW_TRACE_CATEGORY)) {                \
+      static const uint32_t kLabelToken = PW_TRACE_REF_DATA(            \
+          event_type, PW_TRACE_MODULE_NAME, label, flags, group, type); \
+      pw_trace_TraceEvent(kLabelToken,                                  \
+                          event_type,                                   \
+                          PW_TRACE_MODULE_NAME,                         \
+                          trace_id,                                     \
+                          flags,                                        \
+                          data,                                         \
+                          size);                                        \
+    }                                                                   \
   } while (0)
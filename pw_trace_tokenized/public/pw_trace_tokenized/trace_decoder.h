@@ -0,0 +1,119 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This file provides a host-side decoder for tokenized trace captures, which
+// converts them to the Chrome trace JSON format. It is the C++ equivalent of
+// pw_trace_tokenized/py/pw_trace_tokenized/trace_tokenized.py, for captures
+// too large to decode quickly in Python.
+//
+//   pw::tokenizer::TokenDatabaseFile database;
+//   PW_TRY(database.Open("tokens.bin"));
+//
+//   pw::trace::TraceDecoder decoder(database.database(), ticks_per_second);
+//   std::vector<pw::trace::DecodedTraceEvent> events;
+//   decoder.Decode(capture, events);
+//   pw::trace::WriteChromeTraceJson(events, output_file, num_threads);
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "pw_status/status.h"
+#include "pw_tokenizer/token_database.h"
+#include "pw_trace_tokenized/internal/trace_tokenized_internal.h"
+
+namespace pw::trace {
+
+// The fields of a trace event's token string:
+//
+//   "event_type|flags|module|group|label|<optional data_fmt>"
+//
+// The string views refer to the token database.
+struct TraceTokenInfo {
+  pw_trace_EventType event_type;
+  std::string_view module;
+  std::string_view group;
+  std::string_view label;
+  std::string_view data_fmt;
+  bool has_data;
+
+  // Parses a token string. Returns false if it is not a trace token string.
+  static bool Parse(std::string_view token_string, TraceTokenInfo& info);
+
+  // True for the event types which are followed by a trace ID.
+  bool has_trace_id() const;
+};
+
+struct DecodedTraceEvent {
+  const TraceTokenInfo* info;
+  double timestamp_us;
+  uint32_t trace_id;
+
+  // Refers to the capture passed to TraceDecoder::Decode.
+  std::span<const std::byte> data;
+};
+
+// Decodes trace captures in the format written by the trace buffer and
+// trace_to_file.h: each event is prefixed with a one byte size, and holds a
+// token, a varint time delta in ticks, an optional varint trace ID, and data.
+class TraceDecoder {
+ public:
+  // Looks up each trace token string in the database and parses it once. The
+  // database must outlive the decoder and the decoded events.
+  TraceDecoder(const tokenizer::TokenDatabase& database,
+               uint32_t ticks_per_second);
+
+  TraceDecoder(const TraceDecoder&) = delete;
+  TraceDecoder& operator=(const TraceDecoder&) = delete;
+
+  // Decodes the events in the capture and appends them to events. Events whose
+  // tokens are not in the database are skipped, but their time deltas are
+  // still applied. Returns:
+  //
+  //   OK - All events were decoded.
+  //   DATA_LOSS - The capture ends with a partial or invalid event. The events
+  //       before it were decoded.
+  //
+  Status Decode(std::span<const std::byte> capture,
+                std::vector<DecodedTraceEvent>& events);
+
+  // The number of events skipped because their token was not found.
+  size_t unknown_tokens() const { return unknown_tokens_; }
+
+ private:
+  std::unordered_map<uint32_t, TraceTokenInfo> tokens_;
+  double us_per_tick_;
+  uint64_t time_ticks_ = 0;
+  size_t unknown_tokens_ = 0;
+};
+
+// Appends the Chrome trace JSON object for an event to output, without a
+// trailing comma or newline. The fields match trace.py's generate_trace_json.
+void AppendChromeTraceJson(const DecodedTraceEvent& event, std::string& output);
+
+// Writes the events to a file as a Chrome trace JSON array. The events are
+// formatted in parallel chunks on the given number of threads, and written in
+// order. Returns UNKNOWN if writing to the file fails.
+Status WriteChromeTraceJson(std::span<const DecodedTraceEvent> events,
+                            std::FILE* output,
+                            unsigned num_threads);
+
+}  // namespace pw::trace
@@ -13,7 +13,13 @@
 // the License.
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <span>
+
 #include "pw_trace_protos/trace_rpc.rpc.pb.h"
+#include "pw_trace_tokenized/config.h"
+#include "pw_trace_tokenized/trace_stream.h"
 
 namespace pw::trace {
 
@@ -30,6 +36,29 @@ class TraceService final : public generated::TraceService<TraceService> {
   void GetTraceData(ServerContext&,
                     const pw_trace_Empty& request,
                     ServerWriter<pw_trace_TraceDataMessage>& writer);
+
+  // Starts streaming trace events to the caller, replacing any previous
+  // stream. The stream stays open until the client cancels it.
+  void StreamTraceData(ServerContext&,
+                       const pw_trace_Empty& request,
+                       ServerWriter<pw_trace_TraceStreamPacket>& writer);
+
+  // Sends the events buffered for the stream, if any. Call this periodically
+  // so events are not held back while tracing is quiet.
+  void FlushStream();
+
+ private:
+  Status WriteStreamPacket(std::span<const std::byte> events);
+
+  ServerWriter<pw_trace_TraceStreamPacket> stream_writer_;
+  uint32_t stream_sequence_ = 0;
+  std::array<std::byte, PW_TRACE_CONFIG_STREAM_PACKET_SIZE_BYTES>
+      stream_buffer_;
+  TraceStream stream_{stream_buffer_,
+                      [this](std::span<const std::byte> events) {
+                        return WriteStreamPacket(events);
+                      }};
+  bool stream_registered_ = false;
 };
 
 }  // namespace pw::trace
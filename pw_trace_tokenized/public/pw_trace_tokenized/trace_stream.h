@@ -0,0 +1,131 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+#include "pw_trace_tokenized/config.h"
+#include "pw_trace_tokenized/trace_callback.h"
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+
+// Packs trace events, as they are passed to trace sinks, into compact
+// packets for streaming. Each packet can be decoded on its own.
+//
+// A tokenized event is the 4 byte token, a varint time delta, and a payload of
+// the optional trace ID and data. Events with the same token repeat often, so
+// each packet has a dictionary of the tokens it contains, and each token is
+// only sent the first time it appears in the packet:
+//
+//   packet  := event*
+//   event   := key [token] time_delta [payload_size payload]
+//   key     := varint: (dictionary_index << 2) | (has_payload << 1) | new_token
+//   token   := 4 bytes, as in the tokenized event. Only present if new_token
+//              is set, which adds the token at dictionary_index.
+//   time_delta := zig-zag varint delta from the previous event.
+//   payload := varint size, then the trace ID and data of the tokenized event.
+//
+// The token encodes the event type and flags, so the dictionary compresses the
+// (token, flags) pair of each event to a single byte.
+class TraceStreamEncoder {
+ public:
+  static constexpr size_t kMaxDictionaryEntries =
+      PW_TRACE_CONFIG_STREAM_DICTIONARY_ENTRIES;
+
+  explicit TraceStreamEncoder(std::span<std::byte> buffer)
+      : buffer_(buffer), size_(0), event_count_(0), dictionary_size_(0) {}
+
+  // Adds a tokenized event to the packet. Returns:
+  //
+  //   OK - The event was added.
+  //   RESOURCE_EXHAUSTED - The packet or its dictionary is full. Send the
+  //       packet, Clear() it, and add the event again.
+  //   INVALID_ARGUMENT - The event does not fit in an empty packet.
+  //   DATA_LOSS - The event is not a valid tokenized event.
+  Status AddEvent(std::span<const std::byte> event);
+
+  // The encoded packet.
+  std::span<const std::byte> packet() const {
+    return buffer_.first(size_);
+  }
+
+  size_t event_count() const { return event_count_; }
+  bool empty() const { return event_count_ == 0u; }
+
+  // Starts a new packet with an empty dictionary.
+  void Clear() {
+    size_ = 0;
+    event_count_ = 0;
+    dictionary_size_ = 0;
+  }
+
+ private:
+  std::span<std::byte> buffer_;
+  size_t size_;
+  size_t event_count_;
+  size_t dictionary_size_;
+  uint32_t dictionary_[kMaxDictionaryEntries];
+};
+
+// A trace sink which streams processed trace events in TraceStreamEncoder
+// packets. Full packets are passed to the packet writer from the context which
+// processes trace events, under PW_TRACE_TRY_LOCK, so the writer must not
+// trace. Call Flush() periodically to send partly full packets.
+class TraceStream {
+ public:
+  // Returns the status of sending the packet. Events in packets which fail to
+  // send are counted as dropped.
+  using PacketWriter = Function<Status(std::span<const std::byte> packet)>;
+
+  TraceStream(std::span<std::byte> packet_buffer, PacketWriter&& writer)
+      : encoder_(packet_buffer), writer_(std::move(writer)) {}
+
+  TraceStream(const TraceStream&) = delete;
+  TraceStream& operator=(const TraceStream&) = delete;
+
+  // Registers and unregisters the stream as a trace sink.
+  Status Register();
+  Status Unregister();
+
+  // Sends the current packet, if it has any events. This must not be called
+  // while trace events are processed; hold PW_TRACE_LOCK if they may be.
+  void Flush();
+
+  // The number of events which were not sent, because they did not fit in a
+  // packet, were invalid, or their packet failed to send.
+  uint32_t dropped_events() const { return dropped_events_; }
+
+ private:
+  static void SinkStartBlock(void* user_data, size_t size);
+  static void SinkAddBytes(void* user_data, const void* bytes, size_t size);
+  static void SinkEndBlock(void* user_data);
+
+  TraceStreamEncoder encoder_;
+  PacketWriter writer_;
+  CallbacksImpl::SinkHandle sink_handle_ = 0;
+  bool registered_ = false;
+  uint32_t dropped_events_ = 0;
+
+  // The event being received from the sink callbacks.
+  size_t block_size_ = 0;
+  size_t block_index_ = 0;
+  std::byte block_[PW_TRACE_BUFFER_MAX_BLOCK_SIZE_BYTES];
+};
+
+}  // namespace pw::trace
@@ -33,6 +33,12 @@
 #include "pw_trace_tokenized/config.h"
 #include "pw_trace_tokenized/internal/trace_tokenized_internal.h"
 
+#if defined(__cplusplus) && PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+#include <atomic>
+
+#include "pw_sync/spsc_queue.h"
+#endif  // defined(__cplusplus) && PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+
 #ifdef __cplusplus
 namespace pw {
 namespace trace {
@@ -111,6 +117,20 @@ class TraceQueue {
       true;  // Used to distinquish if head==tail is empty or full
 };
 
+// A trace event as recorded when deferred processing is enabled. Everything the
+// callbacks and sinks need is captured when the event is traced, including the
+// time, so that the drain can run much later.
+struct DeferredTraceEvent {
+  uint32_t trace_token;
+  uint32_t trace_id;
+  PW_TRACE_TIME_TYPE time;
+  const char* module;
+  EventType event_type;
+  uint8_t flags;
+  uint8_t data_size;
+  std::byte data_buffer[PW_TRACE_BUFFER_MAX_DATA_SIZE_BYTES];
+};
+
 }  // namespace internal
 
 class TokenizedTraceImpl {
@@ -131,6 +151,18 @@ class TokenizedTraceImpl {
                         const void* data_buffer,
                         size_t data_size);
 
+#if PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+  // Runs the callbacks and sinks for the events recorded since the last drain,
+  // merging the producer queues in timestamp order. Call this periodically from
+  // a low priority thread. Returns the number of events processed, or 0 if
+  // PW_TRACE_TRY_LOCK fails because another drain is in progress.
+  size_t DrainDeferredEvents();
+
+  // The number of events dropped because a producer queue was full, or the
+  // event's data did not fit. This is a snapshot.
+  uint32_t DeferredEventsDropped() const;
+#endif  // PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+
  private:
   using TraceQueue = internal::TraceQueue<PW_TRACE_QUEUE_SIZE_EVENTS>;
   PW_TRACE_TIME_TYPE last_trace_time_ = 0;
@@ -139,6 +171,43 @@ class TokenizedTraceImpl {
 
   void HandleNextItemInQueue(
       const volatile TraceQueue::QueueEventBlock* event_block);
+
+  void HandleEvent(uint32_t trace_token,
+                   EventType event_type,
+                   const char* module,
+                   uint32_t trace_id,
+                   uint8_t flags,
+                   const std::byte* data_buffer,
+                   size_t data_size,
+                   PW_TRACE_TIME_TYPE trace_time);
+
+#if PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+  static_assert(PW_TRACE_BUFFER_MAX_DATA_SIZE_BYTES <= UINT8_MAX);
+
+  struct DeferredProducer {
+    sync::SpscQueue<internal::DeferredTraceEvent,
+                    PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER>
+        queue;
+
+    // Only written by the producer, so no read-modify-write is needed.
+    std::atomic<uint32_t> dropped{0};
+
+    // The front of the queue, popped by the drain to compare timestamps.
+    internal::DeferredTraceEvent next;
+    bool has_next = false;
+  };
+
+  void PushDeferredEvent(uint32_t trace_token,
+                         EventType event_type,
+                         const char* module,
+                         uint32_t trace_id,
+                         uint8_t flags,
+                         const void* data_buffer,
+                         size_t data_size);
+
+  std::array<DeferredProducer, PW_TRACE_CONFIG_DEFERRED_PRODUCERS>
+      deferred_producers_;
+#endif  // PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
 };
 
 // A singleton object of the TokenizedTraceImpl class which can be used to
@@ -159,6 +228,15 @@ class TokenizedTrace {
 // PW_TRACE_SET_ENABLED is used to enable or disable tracing.
 #define PW_TRACE_SET_ENABLED(enabled) pw_trace_Enable(enabled)
 
+// PW_TRACE_SET_CATEGORY_MASK sets which categories are enabled at run time. Use
+// PW_TRACE_CATEGORY_MASK to build the mask, for example:
+//
+//   PW_TRACE_SET_CATEGORY_MASK(PW_TRACE_CATEGORY_MASK(kRadioCategory) |
+//                              PW_TRACE_CATEGORY_MASK(kSensorCategory));
+//
+// Only categories in PW_TRACE_CONFIG_ENABLED_CATEGORIES can be enabled.
+#define PW_TRACE_SET_CATEGORY_MASK(mask) pw_trace_SetCategoryMask(mask)
+
 // PW_TRACE_REF provides the uint32_t token value for a specific trace event.
 // this can be used in the callback to perform specific actions for that trace.
 // All the fields must match exactly to generate the correct trace reference.
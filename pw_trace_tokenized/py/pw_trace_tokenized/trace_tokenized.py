@@ -48,6 +48,18 @@ def varint_decode(encoded):
     return None
 
 
+def varint_encode(value):
+    encoded = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            encoded.append(byte | 0x80)
+        else:
+            encoded.append(byte)
+            return bytes(encoded)
+
+
 # Token string: "event_type|flag|module|group|label|<optional data_fmt>"
 class TokenIdx(IntEnum):
     EventType = 0
@@ -165,6 +177,51 @@ def get_trace_events(databases, raw_trace_data):
     return events
 
 
+def decode_stream_packet(events):
+    """Converts a packet of compact streamed events to tokenized events.
+
+    See pw_trace_tokenized/trace_stream.h for the encoding. Each event is
+    returned in the format used by the trace buffer, for parse_trace_event.
+    """
+    dictionary = []
+    idx = 0
+    while idx < len(events):
+        key, key_bytes = varint_decode(events[idx:])
+        idx += key_bytes
+        if key & 0b1:
+            dictionary.append(events[idx:idx + 4])
+            idx += 4
+        token = dictionary[key >> 2]
+
+        zig_zag_delta, time_bytes = varint_decode(events[idx:])
+        idx += time_bytes
+        time_delta = (zig_zag_delta >> 1) ^ -(zig_zag_delta & 1)
+
+        payload = b''
+        if key & 0b10:
+            size, size_bytes = varint_decode(events[idx:])
+            idx += size_bytes
+            payload = events[idx:idx + size]
+            idx += size
+
+        yield token + varint_encode(time_delta & (1 << 64) - 1) + payload
+
+
+def get_trace_events_from_stream(databases, packets):
+    """Decodes the events in packets from the StreamTraceData RPC."""
+
+    db = tokens.Database.merged(*databases)
+    last_timestamp = 0
+    events = []
+    for packet in packets:
+        for raw_event in decode_stream_packet(bytes(packet)):
+            event = parse_trace_event(raw_event, db, last_timestamp)
+            if event:
+                last_timestamp = event.timestamp_us
+                events.append(event)
+    return events
+
+
 def get_trace_data_from_file(input_file_name):
     """Handles the decoding traces."""
     with open(input_file_name, "rb") as input_file:
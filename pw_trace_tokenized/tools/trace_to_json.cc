@@ -0,0 +1,149 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Converts a tokenized trace capture to a Chrome trace JSON file. This is the
+// C++ equivalent of `python -m pw_trace_tokenized.trace_tokenized`, for large
+// captures.
+//
+//   trace_to_json --database tokens.bin [--index tokens.bin.index]
+//                 --input trace.bin --output trace.json
+//                 [--ticks-per-second 1000] [--threads N]
+//
+// The database must be a binary token database; create one from an ELF or CSV
+// database with `python -m pw_tokenizer.database create --type binary`.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "pw_tokenizer/token_database_file.h"
+#include "pw_trace_tokenized/trace_decoder.h"
+
+namespace {
+
+struct Options {
+  const char* database = nullptr;
+  const char* index = nullptr;
+  const char* input = nullptr;
+  const char* output = nullptr;
+  uint32_t ticks_per_second = 1000;
+  unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+};
+
+void PrintUsage(const char* program) {
+  std::fprintf(stderr,
+               "Usage: %s --database FILE [--index FILE] --input FILE "
+               "--output FILE [--ticks-per-second N] [--threads N]\n",
+               program);
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options) {
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char* flag = argv[i];
+    const char* value = argv[i + 1];
+    if (std::strcmp(flag, "--database") == 0) {
+      options.database = value;
+    } else if (std::strcmp(flag, "--index") == 0) {
+      options.index = value;
+    } else if (std::strcmp(flag, "--input") == 0) {
+      options.input = value;
+    } else if (std::strcmp(flag, "--output") == 0) {
+      options.output = value;
+    } else if (std::strcmp(flag, "--ticks-per-second") == 0) {
+      options.ticks_per_second =
+          static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+    } else if (std::strcmp(flag, "--threads") == 0) {
+      options.threads = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+    } else {
+      return false;
+    }
+  }
+  return argc % 2 == 1 && options.database != nullptr &&
+         options.input != nullptr && options.output != nullptr &&
+         options.ticks_per_second != 0u;
+}
+
+bool ReadFile(const char* path, std::vector<std::byte>& contents) {
+  std::FILE* file = std::fopen(path, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::fseek(file, 0, SEEK_END);
+  const long size = std::ftell(file);
+  std::fseek(file, 0, SEEK_SET);
+  contents.resize(size < 0 ? 0 : static_cast<size_t>(size));
+  const bool ok = size >= 0 && std::fread(contents.data(),
+                                          1,
+                                          contents.size(),
+                                          file) == contents.size();
+  std::fclose(file);
+  return ok;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Options options;
+  if (!ParseOptions(argc, argv, options)) {
+    PrintUsage(argv[0]);
+    return 2;
+  }
+
+  pw::tokenizer::TokenDatabaseFile database;
+  if (const pw::Status status = database.Open(options.database, options.index);
+      !status.ok()) {
+    std::fprintf(stderr,
+                 "Failed to open token database %s: %s\n",
+                 options.database,
+                 status.str());
+    return 1;
+  }
+
+  std::vector<std::byte> capture;
+  if (!ReadFile(options.input, capture)) {
+    std::fprintf(stderr, "Failed to read %s\n", options.input);
+    return 1;
+  }
+
+  pw::trace::TraceDecoder decoder(database.database(),
+                                  options.ticks_per_second);
+  std::vector<pw::trace::DecodedTraceEvent> events;
+  if (!decoder.Decode(capture, events).ok()) {
+    std::fprintf(stderr,
+                 "The capture ends with an incomplete event; decoded %zu "
+                 "events before it\n",
+                 events.size());
+  }
+  if (decoder.unknown_tokens() != 0u) {
+    std::fprintf(stderr,
+                 "Skipped %zu events with unknown tokens\n",
+                 decoder.unknown_tokens());
+  }
+
+  std::FILE* output = std::fopen(options.output, "w");
+  if (output == nullptr) {
+    std::fprintf(stderr, "Failed to open %s\n", options.output);
+    return 1;
+  }
+  const pw::Status status =
+      pw::trace::WriteChromeTraceJson(events, output, options.threads);
+  if (std::fclose(output) != 0 || !status.ok()) {
+    std::fprintf(stderr, "Failed to write %s\n", options.output);
+    return 1;
+  }
+  return 0;
+}
@@ -40,6 +40,10 @@ void TokenizedTraceImpl::HandleTraceEvent(uint32_t trace_token,
     return;
   }
 
+#if PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+  PushDeferredEvent(
+      trace_token, event_type, module, trace_id, flags, data_buffer, data_size);
+#else
   // Create trace event
   PW_TRACE_QUEUE_LOCK();
   if (!event_queue_
@@ -66,8 +70,118 @@ void TokenizedTraceImpl::HandleTraceEvent(uint32_t trace_token,
     }
     PW_TRACE_UNLOCK();
   }
+#endif  // PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+}
+
+#if PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+
+namespace {
+
+// Whether time a is before time b, assuming they are less than half the range
+// of the time type apart. This is needed since the time may wrap.
+bool TimeBefore(PW_TRACE_TIME_TYPE a, PW_TRACE_TIME_TYPE b) {
+  return PW_TRACE_GET_TIME_DELTA(b, a) > PW_TRACE_GET_TIME_DELTA(a, b);
+}
+
+}  // namespace
+
+void TokenizedTraceImpl::PushDeferredEvent(uint32_t trace_token,
+                                           EventType event_type,
+                                           const char* module,
+                                           uint32_t trace_id,
+                                           uint8_t flags,
+                                           const void* data_buffer,
+                                           size_t data_size) {
+  DeferredProducer& producer =
+      deferred_producers_[PW_TRACE_GET_PRODUCER_INDEX()];
+
+  internal::DeferredTraceEvent event;
+  if (data_size > sizeof(event.data_buffer)) {
+    producer.dropped.store(producer.dropped.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+    return;
+  }
+
+  event.trace_token = trace_token;
+  event.trace_id = trace_id;
+  event.time = PW_TRACE_GET_TIME();
+  event.module = module;
+  event.event_type = event_type;
+  event.flags = flags;
+  event.data_size = static_cast<uint8_t>(data_size);
+  if (data_size > 0) {
+    memcpy(event.data_buffer, data_buffer, data_size);
+  }
+
+  if (!producer.queue.try_push(event)) {
+    producer.dropped.store(producer.dropped.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+  }
+}
+
+size_t TokenizedTraceImpl::DrainDeferredEvents() {
+  if (!PW_TRACE_TRY_LOCK()) {
+    return 0;
+  }
+
+  // Bound the drain so that producers which keep tracing cannot hold it here.
+  constexpr size_t kMaxEvents = PW_TRACE_CONFIG_DEFERRED_PRODUCERS *
+                                PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER;
+  size_t count = 0;
+  while (count < kMaxEvents) {
+    // Take the oldest of the producers' next events, so the time deltas in the
+    // encoded output stay in order.
+    DeferredProducer* oldest = nullptr;
+    for (DeferredProducer& producer : deferred_producers_) {
+      if (!producer.has_next) {
+        producer.has_next = producer.queue.try_pop(producer.next);
+      }
+      if (producer.has_next &&
+          (oldest == nullptr ||
+           TimeBefore(producer.next.time, oldest->next.time))) {
+        oldest = &producer;
+      }
+    }
+    if (oldest == nullptr) {
+      break;
+    }
+
+    const internal::DeferredTraceEvent& event = oldest->next;
+
+    // A producer may be preempted between reading the time and pushing the
+    // event, so an event can arrive after a later one was already drained.
+    // Record it with no time delta rather than a wrapped one.
+    PW_TRACE_TIME_TYPE time = event.time;
+    if (last_trace_time_ != 0 && TimeBefore(time, last_trace_time_)) {
+      time = last_trace_time_;
+    }
+
+    HandleEvent(event.trace_token,
+                event.event_type,
+                event.module,
+                event.trace_id,
+                event.flags,
+                event.data_buffer,
+                event.data_size,
+                time);
+    oldest->has_next = false;
+    count += 1;
+  }
+
+  PW_TRACE_UNLOCK();
+  return count;
+}
+
+uint32_t TokenizedTraceImpl::DeferredEventsDropped() const {
+  uint32_t dropped = 0;
+  for (const DeferredProducer& producer : deferred_producers_) {
+    dropped += producer.dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
 }
 
+#endif  // PW_TRACE_CONFIG_DEFERRED_PRODUCERS > 0
+
 void TokenizedTraceImpl::HandleNextItemInQueue(
     const volatile TraceQueue::QueueEventBlock* event_block) {
   // Get next item in queue
@@ -80,6 +194,24 @@ void TokenizedTraceImpl::HandleNextItemInQueue(
       const_cast<const std::byte*>(event_block->data_buffer);
   size_t data_size = event_block->data_size;
 
+  HandleEvent(trace_token,
+              event_type,
+              module,
+              trace_id,
+              flags,
+              data_buffer,
+              data_size,
+              pw_trace_GetTraceTime());
+}
+
+void TokenizedTraceImpl::HandleEvent(uint32_t trace_token,
+                                     EventType event_type,
+                                     const char* module,
+                                     uint32_t trace_id,
+                                     uint8_t flags,
+                                     const std::byte* data_buffer,
+                                     size_t data_size,
+                                     PW_TRACE_TIME_TYPE trace_time) {
   // Call any event callback which is registered to receive every event.
   pw_trace_TraceEventReturnFlags ret_flags = 0;
   ret_flags |=
@@ -117,7 +249,6 @@ void TokenizedTraceImpl::HandleNextItemInQueue(
   size_t header_size = sizeof(trace_token);
 
   // Compute delta of time elapsed since last trace entry.
-  PW_TRACE_TIME_TYPE trace_time = pw_trace_GetTraceTime();
   PW_TRACE_TIME_TYPE delta =
       (last_trace_time_ == 0)
           ? 0
@@ -298,10 +429,20 @@ CallbacksImpl::EventCallbacks* CallbacksImpl::GetEventCallback(
 
 PW_EXTERN_C_START
 
+uint32_t pw_trace_category_mask = PW_TRACE_CONFIG_DEFAULT_CATEGORY_MASK;
+
 void pw_trace_Enable(bool enable) { TokenizedTrace::Instance().Enable(enable); }
 
 bool pw_trace_IsEnabled() { return TokenizedTrace::Instance().IsEnabled(); }
 
+void pw_trace_SetCategoryMask(uint32_t mask) {
+  __atomic_store_n(&pw_trace_category_mask, mask, __ATOMIC_RELAXED);
+}
+
+uint32_t pw_trace_GetCategoryMask() {
+  return __atomic_load_n(&pw_trace_category_mask, __ATOMIC_RELAXED);
+}
+
 void pw_trace_TraceEvent(uint32_t trace_token,
                          pw_trace_EventType event_type,
                          const char* module,
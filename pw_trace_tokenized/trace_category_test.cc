@@ -0,0 +1,135 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// clang-format off
+#define PW_TRACE_MODULE_NAME "TST"
+
+// Category 3 is compiled out of this test.
+#define PW_TRACE_CONFIG_ENABLED_CATEGORIES 0xfffffff7u
+
+#include "pw_trace/trace.h"
+#include "pw_trace_tokenized/trace_tokenized.h"
+#include "pw_trace_tokenized/trace_callback.h"
+// clang-format on
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class EventCounter {
+ public:
+  EventCounter() {
+    PW_TRACE_SET_ENABLED(true);
+    pw::trace::Callbacks::Instance().RegisterEventCallback(
+        Callback,
+        pw::trace::CallbacksImpl::kCallOnEveryEvent,
+        this,
+        &handle_);
+  }
+
+  ~EventCounter() {
+    pw::trace::Callbacks::Instance().UnregisterEventCallback(handle_);
+    PW_TRACE_SET_CATEGORY_MASK(PW_TRACE_CONFIG_DEFAULT_CATEGORY_MASK);
+  }
+
+  int count() const { return count_; }
+
+ private:
+  static pw_trace_TraceEventReturnFlags Callback(void* user_data,
+                                                 uint32_t,
+                                                 pw_trace_EventType,
+                                                 const char*,
+                                                 uint32_t,
+                                                 uint8_t) {
+    static_cast<EventCounter*>(user_data)->count_ += 1;
+    return 0;
+  }
+
+  pw::trace::CallbacksImpl::EventCallbackHandle handle_;
+  int count_ = 0;
+};
+
+// Traces one event in each of categories 0, 2, and 3.
+void TraceCategory0() { PW_TRACE_INSTANT("Category0"); }
+
+#undef PW_TRACE_CATEGORY
+#define PW_TRACE_CATEGORY 2
+
+void TraceCategory2() {
+  uint8_t data = 0;
+  PW_TRACE_INSTANT_DATA("Category2", "u8", &data, sizeof(data));
+}
+
+#undef PW_TRACE_CATEGORY
+#define PW_TRACE_CATEGORY 3
+
+void TraceCategory3() { PW_TRACE_INSTANT("Category3"); }
+
+#undef PW_TRACE_CATEGORY
+#define PW_TRACE_CATEGORY 0
+
+void TraceAll() {
+  TraceCategory0();
+  TraceCategory2();
+  TraceCategory3();
+}
+
+TEST(TraceCategory, DefaultMaskEnablesCompiledCategories) {
+  EventCounter counter;
+  EXPECT_EQ(pw_trace_GetCategoryMask(), PW_TRACE_CONFIG_DEFAULT_CATEGORY_MASK);
+
+  TraceAll();
+  EXPECT_EQ(counter.count(), 2);
+}
+
+TEST(TraceCategory, RuntimeMask) {
+  EventCounter counter;
+
+  PW_TRACE_SET_CATEGORY_MASK(PW_TRACE_CATEGORY_MASK(2));
+  EXPECT_EQ(pw_trace_GetCategoryMask(), PW_TRACE_CATEGORY_MASK(2));
+  TraceAll();
+  EXPECT_EQ(counter.count(), 1);
+
+  PW_TRACE_SET_CATEGORY_MASK(0);
+  TraceAll();
+  EXPECT_EQ(counter.count(), 1);
+
+  PW_TRACE_SET_CATEGORY_MASK(PW_TRACE_CATEGORY_MASK(0));
+  TraceAll();
+  EXPECT_EQ(counter.count(), 2);
+}
+
+TEST(TraceCategory, CompiledOutCategoryCannotBeEnabled) {
+  EventCounter counter;
+
+  PW_TRACE_SET_CATEGORY_MASK(PW_TRACE_CATEGORY_MASK(3));
+  TraceAll();
+  EXPECT_EQ(counter.count(), 0);
+}
+
+TEST(TraceCategory, DisabledCategorySkipsCallbacksWhileDisabled) {
+  EventCounter counter;
+  PW_TRACE_SET_ENABLED(false);
+
+  // Callbacks registered with kCallOnEveryEvent see events while tracing is
+  // disabled, but not events from disabled categories.
+  TraceCategory0();
+  EXPECT_EQ(counter.count(), 1);
+
+  PW_TRACE_SET_CATEGORY_MASK(~PW_TRACE_CATEGORY_MASK(0));
+  TraceCategory0();
+  EXPECT_EQ(counter.count(), 1);
+}
+
+}  // namespace
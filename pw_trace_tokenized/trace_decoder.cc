@@ -0,0 +1,510 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_trace_tokenized/trace_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstring>
+#include <optional>
+#include <thread>
+
+#include "pw_varint/varint.h"
+
+namespace pw::trace {
+namespace {
+
+constexpr std::array<std::pair<std::string_view, pw_trace_EventType>, 9>
+    kEventTypes = {{
+        {"PW_TRACE_EVENT_TYPE_INSTANT", PW_TRACE_EVENT_TYPE_INSTANT},
+        {"PW_TRACE_EVENT_TYPE_INSTANT_GROUP",
+         PW_TRACE_EVENT_TYPE_INSTANT_GROUP},
+        {"PW_TRACE_EVENT_TYPE_ASYNC_START", PW_TRACE_EVENT_TYPE_ASYNC_START},
+        {"PW_TRACE_EVENT_TYPE_ASYNC_STEP", PW_TRACE_EVENT_TYPE_ASYNC_STEP},
+        {"PW_TRACE_EVENT_TYPE_ASYNC_END", PW_TRACE_EVENT_TYPE_ASYNC_END},
+        {"PW_TRACE_EVENT_TYPE_DURATION_START",
+         PW_TRACE_EVENT_TYPE_DURATION_START},
+        {"PW_TRACE_EVENT_TYPE_DURATION_END", PW_TRACE_EVENT_TYPE_DURATION_END},
+        {"PW_TRACE_EVENT_TYPE_DURATION_GROUP_START",
+         PW_TRACE_EVENT_TYPE_DURATION_GROUP_START},
+        {"PW_TRACE_EVENT_TYPE_DURATION_GROUP_END",
+         PW_TRACE_EVENT_TYPE_DURATION_GROUP_END},
+    }};
+
+// Events are formatted in chunks of this many events per thread.
+constexpr size_t kEventsPerChunk = 4096;
+
+// Splits off the text up to the next '|'. Returns false if there is none.
+bool NextField(std::string_view& text, std::string_view& field) {
+  const size_t end = text.find('|');
+  if (end == std::string_view::npos) {
+    return false;
+  }
+  field = text.substr(0, end);
+  text.remove_prefix(end + 1);
+  return true;
+}
+
+void AppendJsonString(std::string_view text, std::string& output) {
+  output.push_back('"');
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        output.append("\\\"");
+        break;
+      case '\\':
+        output.append("\\\\");
+        break;
+      case '\n':
+        output.append("\\n");
+        break;
+      case '\r':
+        output.append("\\r");
+        break;
+      case '\t':
+        output.append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          char escaped[8];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+          output.append(escaped);
+        } else {
+          output.push_back(c);
+        }
+    }
+  }
+  output.push_back('"');
+}
+
+template <typename... Args>
+void AppendFormat(std::string& output, const char* format, Args... args) {
+  char buffer[32];
+  const int size = std::snprintf(buffer, sizeof(buffer), format, args...);
+  output.append(buffer, std::min(static_cast<size_t>(size), sizeof(buffer)));
+}
+
+std::string_view AsString(std::span<const std::byte> data) {
+  return std::string_view(reinterpret_cast<const char*>(data.data()),
+                          data.size());
+}
+
+uint64_t ReadInteger(std::span<const std::byte> data, bool little_endian) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < data.size(); ++i) {
+    const size_t index = little_endian ? data.size() - 1 - i : i;
+    value = (value << 8) | std::to_integer<uint64_t>(data[index]);
+  }
+  return value;
+}
+
+// Decodes data with a Python struct format string, as used by the
+// @pw_py_struct_fmt: data format, into "data_N" arguments. Supports the
+// integer, bool, and floating point codes. Returns false for other formats.
+bool AppendStructArgs(std::string_view format,
+                      std::span<const std::byte> data,
+                      std::string& output) {
+  bool native = true;
+  bool little_endian = true;
+  if (!format.empty() && std::string_view("@=<>!").find(format[0]) !=
+                             std::string_view::npos) {
+    native = format[0] == '@';
+    little_endian = format[0] != '>' && format[0] != '!';
+    format.remove_prefix(1);
+  }
+
+  std::string args = "{";
+  size_t offset = 0;
+  size_t item = 0;
+  while (!format.empty()) {
+    size_t count = 0;
+    bool has_count = false;
+    while (!format.empty() && format[0] >= '0' && format[0] <= '9') {
+      count = count * 10 + static_cast<size_t>(format[0] - '0');
+      has_count = true;
+      format.remove_prefix(1);
+    }
+    if (format.empty()) {
+      return false;
+    }
+    const char code = format[0];
+    format.remove_prefix(1);
+    if (code == ' ') {
+      continue;
+    }
+    if (!has_count) {
+      count = 1;
+    }
+
+    size_t size;
+    switch (code) {
+      case 'x':
+      case 'b':
+      case 'B':
+      case '?':
+        size = 1;
+        break;
+      case 'h':
+      case 'H':
+        size = 2;
+        break;
+      case 'i':
+      case 'I':
+      case 'f':
+        size = 4;
+        break;
+      case 'l':
+      case 'L':
+        size = native ? sizeof(long) : 4;
+        break;
+      case 'q':
+      case 'Q':
+      case 'd':
+        size = 8;
+        break;
+      default:
+        return false;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      if (native && code != 'x') {
+        offset = (offset + size - 1) / size * size;
+      }
+      if (offset + size > data.size()) {
+        return false;
+      }
+      const uint64_t raw = ReadInteger(data.subspan(offset, size),
+                                       little_endian);
+      offset += size;
+      if (code == 'x') {
+        continue;
+      }
+
+      if (item != 0u) {
+        args.append(", ");
+      }
+      AppendFormat(args, "\"data_%zu\": ", item);
+      item += 1;
+
+      const unsigned shift = 64 - static_cast<unsigned>(size) * 8;
+      switch (code) {
+        case '?':
+          args.append(raw != 0u ? "true" : "false");
+          break;
+        case 'b':
+        case 'h':
+        case 'i':
+        case 'l':
+        case 'q':
+          // Sign extend.
+          AppendFormat(args,
+                       "%" PRId64,
+                       static_cast<int64_t>(raw << shift) >> shift);
+          break;
+        case 'f': {
+          const uint32_t bits = static_cast<uint32_t>(raw);
+          float value;
+          std::memcpy(&value, &bits, sizeof(value));
+          AppendFormat(args, "%.9g", static_cast<double>(value));
+          break;
+        }
+        case 'd': {
+          double value;
+          std::memcpy(&value, &raw, sizeof(value));
+          AppendFormat(args, "%.17g", value);
+          break;
+        }
+        default:
+          AppendFormat(args, "%" PRIu64, raw);
+      }
+    }
+  }
+  args.push_back('}');
+  output.append(args);
+  return true;
+}
+
+void AppendHex(std::span<const std::byte> data, std::string& output) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  for (std::byte b : data) {
+    output.push_back(kHex[std::to_integer<unsigned>(b) >> 4]);
+    output.push_back(kHex[std::to_integer<unsigned>(b) & 0xf]);
+  }
+}
+
+}  // namespace
+
+bool TraceTokenInfo::Parse(std::string_view token_string,
+                           TraceTokenInfo& info) {
+  std::string_view type;
+  std::string_view flags;
+  if (!NextField(token_string, type) || !NextField(token_string, flags) ||
+      !NextField(token_string, info.module) ||
+      !NextField(token_string, info.group)) {
+    return false;
+  }
+
+  const auto found = std::find_if(
+      kEventTypes.begin(), kEventTypes.end(), [type](const auto& entry) {
+        return entry.first == type;
+      });
+  if (found == kEventTypes.end()) {
+    return false;
+  }
+  info.event_type = found->second;
+
+  const size_t label_end = token_string.find('|');
+  info.has_data = label_end != std::string_view::npos;
+  info.label = token_string.substr(0, label_end);
+  info.data_fmt =
+      info.has_data ? token_string.substr(label_end + 1) : std::string_view();
+  return true;
+}
+
+bool TraceTokenInfo::has_trace_id() const {
+  return event_type == PW_TRACE_EVENT_TYPE_ASYNC_START ||
+         event_type == PW_TRACE_EVENT_TYPE_ASYNC_STEP ||
+         event_type == PW_TRACE_EVENT_TYPE_ASYNC_END;
+}
+
+TraceDecoder::TraceDecoder(const tokenizer::TokenDatabase& database,
+                           uint32_t ticks_per_second)
+    : us_per_tick_(1e6 / ticks_per_second) {
+  for (const tokenizer::TokenDatabase::Entry entry : database) {
+    TraceTokenInfo info;
+    if (TraceTokenInfo::Parse(entry.string, info)) {
+      tokens_.emplace(entry.token, info);
+    }
+  }
+}
+
+Status TraceDecoder::Decode(std::span<const std::byte> capture,
+                            std::vector<DecodedTraceEvent>& events) {
+  while (!capture.empty()) {
+    const size_t size = std::to_integer<size_t>(capture[0]);
+    if (size + 1 > capture.size()) {
+      return Status::DataLoss();
+    }
+    std::span<const std::byte> event = capture.subspan(1, size);
+    capture = capture.subspan(size + 1);
+
+    uint32_t token;
+    if (event.size() < sizeof(token)) {
+      return Status::DataLoss();
+    }
+    std::memcpy(&token, event.data(), sizeof(token));
+    event = event.subspan(sizeof(token));
+
+    uint64_t time_delta;
+    size_t bytes = varint::Decode(event, &time_delta);
+    if (bytes == 0u) {
+      return Status::DataLoss();
+    }
+    event = event.subspan(bytes);
+    time_ticks_ += time_delta;
+
+    const auto found = tokens_.find(token);
+    if (found == tokens_.end()) {
+      unknown_tokens_ += 1;
+      continue;
+    }
+    const TraceTokenInfo& info = found->second;
+
+    uint64_t trace_id = 0;
+    if (info.has_trace_id() && !event.empty()) {
+      bytes = varint::Decode(event, &trace_id);
+      if (bytes == 0u) {
+        return Status::DataLoss();
+      }
+      event = event.subspan(bytes);
+    }
+
+    events.push_back(DecodedTraceEvent{
+        .info = &info,
+        .timestamp_us = static_cast<double>(time_ticks_) * us_per_tick_,
+        .trace_id = static_cast<uint32_t>(trace_id),
+        .data = info.has_data ? event : std::span<const std::byte>(),
+    });
+  }
+  return OkStatus();
+}
+
+void AppendChromeTraceJson(const DecodedTraceEvent& event,
+                           std::string& output) {
+  const TraceTokenInfo& info = *event.info;
+
+  std::string_view name = info.label;
+  std::string_view phase;
+  std::string_view scope;  // "s" for instant events
+  std::optional<std::string_view> tid;
+  bool async = false;
+
+  switch (info.event_type) {
+    case PW_TRACE_EVENT_TYPE_DURATION_START:
+      phase = "B";
+      tid = info.label;
+      break;
+    case PW_TRACE_EVENT_TYPE_DURATION_END:
+      phase = "E";
+      tid = info.label;
+      break;
+    case PW_TRACE_EVENT_TYPE_DURATION_GROUP_START:
+      phase = "B";
+      tid = info.group;
+      break;
+    case PW_TRACE_EVENT_TYPE_DURATION_GROUP_END:
+      phase = "E";
+      tid = info.group;
+      break;
+    case PW_TRACE_EVENT_TYPE_INSTANT:
+      phase = "I";
+      scope = "p";
+      break;
+    case PW_TRACE_EVENT_TYPE_INSTANT_GROUP:
+      phase = "I";
+      scope = "t";
+      tid = info.group;
+      break;
+    case PW_TRACE_EVENT_TYPE_ASYNC_START:
+      phase = "b";
+      async = true;
+      break;
+    case PW_TRACE_EVENT_TYPE_ASYNC_STEP:
+      phase = "n";
+      async = true;
+      break;
+    case PW_TRACE_EVENT_TYPE_ASYNC_END:
+      phase = "e";
+      async = true;
+      break;
+    case PW_TRACE_EVENT_TYPE_INVALID:
+      return;
+  }
+  if (async) {
+    tid = info.group;
+  }
+
+  std::string args;
+  if (async) {
+    AppendFormat(args, "{\"id\": %" PRIu32 "}", event.trace_id);
+  }
+  if (info.has_data) {
+    if (info.data_fmt == "@pw_arg_label") {
+      name = AsString(event.data);
+    } else if (info.data_fmt == "@pw_arg_group") {
+      tid = AsString(event.data);
+    } else if (info.data_fmt == "@pw_arg_counter") {
+      phase = "C";
+      args = "{";
+      AppendJsonString(name, args);
+      AppendFormat(args,
+                   ": %" PRIu64 "}",
+                   ReadInteger(event.data.first(std::min<size_t>(
+                                   event.data.size(), sizeof(uint64_t))),
+                               /*little_endian=*/true));
+    } else {
+      constexpr std::string_view kStructFormat = "@pw_py_struct_fmt:";
+      args.clear();
+      if (info.data_fmt.substr(0, kStructFormat.size()) != kStructFormat ||
+          !AppendStructArgs(info.data_fmt.substr(kStructFormat.size()),
+                            event.data,
+                            args)) {
+        args = "{\"data\": \"";
+        AppendHex(event.data, args);
+        args.append("\"}");
+      }
+    }
+  }
+
+  output.append("{\"pid\": ");
+  AppendJsonString(info.module, output);
+  output.append(", \"name\": ");
+  AppendJsonString(name, output);
+  AppendFormat(output, ", \"ts\": %.3f", event.timestamp_us);
+  output.append(", \"ph\": ");
+  AppendJsonString(phase, output);
+  if (!scope.empty()) {
+    output.append(", \"s\": ");
+    AppendJsonString(scope, output);
+  }
+  if (async) {
+    output.append(", \"scope\": ");
+    AppendJsonString(info.group, output);
+  }
+  if (tid.has_value()) {
+    output.append(", \"tid\": ");
+    AppendJsonString(*tid, output);
+  }
+  if (async) {
+    output.append(", \"cat\": ");
+    AppendJsonString(info.module, output);
+    AppendFormat(output, ", \"id\": %" PRIu32, event.trace_id);
+  }
+  if (!args.empty()) {
+    output.append(", \"args\": ");
+    output.append(args);
+  }
+  output.push_back('}');
+}
+
+Status WriteChromeTraceJson(std::span<const DecodedTraceEvent> events,
+                            std::FILE* output,
+                            unsigned num_threads) {
+  num_threads = std::max(num_threads, 1u);
+  std::vector<std::string> chunks(num_threads);
+  std::vector<std::thread> threads;
+
+  if (std::fputs("[", output) < 0) {
+    return Status::Unknown();
+  }
+
+  while (!events.empty()) {
+    // Format up to one chunk per thread, then write the chunks in order.
+    size_t chunk_count = 0;
+    for (; chunk_count < num_threads && !events.empty(); ++chunk_count) {
+      const std::span<const DecodedTraceEvent> chunk =
+          events.first(std::min(events.size(), kEventsPerChunk));
+      events = events.subspan(chunk.size());
+
+      threads.emplace_back([chunk, &text = chunks[chunk_count]] {
+        text.clear();
+        for (const DecodedTraceEvent& event : chunk) {
+          AppendChromeTraceJson(event, text);
+          text.append(",\n");
+        }
+      });
+    }
+
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+
+    for (size_t i = 0; i < chunk_count; ++i) {
+      if (std::fwrite(chunks[i].data(), 1, chunks[i].size(), output) !=
+          chunks[i].size()) {
+        return Status::Unknown();
+      }
+    }
+  }
+
+  // Like trace_tokenized.py, end with an empty object after the last comma.
+  if (std::fputs("{}]", output) < 0) {
+    return Status::Unknown();
+  }
+  return OkStatus();
+}
+
+}  // namespace pw::trace
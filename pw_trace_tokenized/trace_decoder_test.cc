@@ -0,0 +1,167 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_trace_tokenized/trace_decoder.h"
+
+#include <cstdio>
+#include <initializer_list>
+
+#include "gtest/gtest.h"
+
+namespace pw::trace {
+namespace {
+
+alignas(tokenizer::TokenDatabase::RawEntry) constexpr char kDatabase[] =
+    "TOKENS\0\0\x06\0\0\0\0\0\0\0"
+    "\x01\0\0\0\0\0\0\0"
+    "\x02\0\0\0\0\0\0\0"
+    "\x03\0\0\0\0\0\0\0"
+    "\x04\0\0\0\0\0\0\0"
+    "\x05\0\0\0\0\0\0\0"
+    "\x06\0\0\0\0\0\0\0"
+    "PW_TRACE_EVENT_TYPE_INSTANT|0|TST||Hello\0"
+    "PW_TRACE_EVENT_TYPE_ASYNC_START|0|TST|Group|Task\0"
+    "PW_TRACE_EVENT_TYPE_INSTANT|0|TST||Count|@pw_arg_counter\0"
+    "PW_TRACE_EVENT_TYPE_DURATION_START|0|TST||Data|@pw_py_struct_fmt:<hI\0"
+    "PW_TRACE_EVENT_TYPE_DURATION_END|0|TST||Data|unknown\0"
+    "Not a trace token\0";
+
+constexpr tokenizer::TokenDatabase kTokens =
+    tokenizer::TokenDatabase::Create<kDatabase>();
+
+// Appends an event with a 1 byte time delta to a capture.
+void AddEvent(std::vector<std::byte>& capture,
+              uint8_t token,
+              uint8_t time_delta,
+              std::initializer_list<uint8_t> rest = {}) {
+  capture.push_back(std::byte(5 + rest.size()));
+  for (std::byte b : {std::byte{token}, std::byte{0}, std::byte{0}}) {
+    capture.push_back(b);
+  }
+  capture.push_back(std::byte{0});
+  capture.push_back(std::byte{time_delta});
+  for (uint8_t b : rest) {
+    capture.push_back(std::byte{b});
+  }
+}
+
+std::string Json(const DecodedTraceEvent& event) {
+  std::string json;
+  AppendChromeTraceJson(event, json);
+  return json;
+}
+
+TEST(TraceTokenInfo, Parse) {
+  TraceTokenInfo info;
+  ASSERT_TRUE(TraceTokenInfo::Parse(
+      "PW_TRACE_EVENT_TYPE_ASYNC_STEP|1|Mod|Grp|Label|fmt", info));
+  EXPECT_EQ(info.event_type, PW_TRACE_EVENT_TYPE_ASYNC_STEP);
+  EXPECT_EQ(info.module, "Mod");
+  EXPECT_EQ(info.group, "Grp");
+  EXPECT_EQ(info.label, "Label");
+  EXPECT_TRUE(info.has_data);
+  EXPECT_EQ(info.data_fmt, "fmt");
+  EXPECT_TRUE(info.has_trace_id());
+
+  EXPECT_FALSE(TraceTokenInfo::Parse("Hello %s", info));
+  EXPECT_FALSE(TraceTokenInfo::Parse("NOT_A_TYPE|0|Mod|Grp|Label", info));
+}
+
+TEST(TraceDecoder, DecodesEvents) {
+  std::vector<std::byte> capture;
+  AddEvent(capture, 1, 10);
+  AddEvent(capture, 2, 5, {42});
+  AddEvent(capture, 3, 1, {7, 1});
+  AddEvent(capture, 4, 1, {0xfe, 0xff, 3, 0, 0, 0});
+  AddEvent(capture, 5, 1, {0xab});
+
+  TraceDecoder decoder(kTokens, 1000);
+  std::vector<DecodedTraceEvent> events;
+  ASSERT_EQ(decoder.Decode(capture, events), OkStatus());
+  ASSERT_EQ(events.size(), 5u);
+
+  EXPECT_EQ(Json(events[0]),
+            R"({"pid": "TST", "name": "Hello", "ts": 10000.000, "ph": "I", )"
+            R"("s": "p"})");
+  EXPECT_EQ(Json(events[1]),
+            R"({"pid": "TST", "name": "Task", "ts": 15000.000, "ph": "b", )"
+            R"("scope": "Group", "tid": "Group", "cat": "TST", "id": 42, )"
+            R"("args": {"id": 42}})");
+  EXPECT_EQ(Json(events[2]),
+            R"({"pid": "TST", "name": "Count", "ts": 16000.000, "ph": "C", )"
+            R"("s": "p", "args": {"Count": 263}})");
+  EXPECT_EQ(Json(events[3]),
+            R"({"pid": "TST", "name": "Data", "ts": 17000.000, "ph": "B", )"
+            R"("tid": "Data", "args": {"data_0": -2, "data_1": 3}})");
+  EXPECT_EQ(Json(events[4]),
+            R"({"pid": "TST", "name": "Data", "ts": 18000.000, "ph": "E", )"
+            R"("tid": "Data", "args": {"data": "ab"}})");
+}
+
+TEST(TraceDecoder, UnknownTokensKeepTime) {
+  std::vector<std::byte> capture;
+  AddEvent(capture, 6, 10);
+  AddEvent(capture, 9, 10);
+  AddEvent(capture, 1, 10);
+
+  TraceDecoder decoder(kTokens, 1'000'000);
+  std::vector<DecodedTraceEvent> events;
+  ASSERT_EQ(decoder.Decode(capture, events), OkStatus());
+  EXPECT_EQ(decoder.unknown_tokens(), 2u);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].timestamp_us, 30.0);
+}
+
+TEST(TraceDecoder, TruncatedCapture) {
+  std::vector<std::byte> capture;
+  AddEvent(capture, 1, 1);
+  AddEvent(capture, 1, 1);
+  capture.pop_back();
+
+  TraceDecoder decoder(kTokens, 1000);
+  std::vector<DecodedTraceEvent> events;
+  EXPECT_EQ(decoder.Decode(capture, events), Status::DataLoss());
+  EXPECT_EQ(events.size(), 1u);
+}
+
+TEST(WriteChromeTraceJson, WritesEventsInOrder) {
+  std::vector<std::byte> capture;
+  constexpr size_t kEvents = 20000;
+  for (size_t i = 0; i < kEvents; ++i) {
+    AddEvent(capture, 1, 1);
+  }
+  TraceDecoder decoder(kTokens, 1000);
+  std::vector<DecodedTraceEvent> events;
+  ASSERT_EQ(decoder.Decode(capture, events), OkStatus());
+
+  std::string expected = "[";
+  for (const DecodedTraceEvent& event : events) {
+    AppendChromeTraceJson(event, expected);
+    expected.append(",\n");
+  }
+  expected.append("{}]");
+
+  std::FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(WriteChromeTraceJson(events, file, 4), OkStatus());
+
+  std::string written(expected.size() + 1, '\0');
+  std::rewind(file);
+  written.resize(std::fread(written.data(), 1, written.size(), file));
+  std::fclose(file);
+  EXPECT_EQ(written, expected);
+}
+
+}  // namespace
+}  // namespace pw::trace
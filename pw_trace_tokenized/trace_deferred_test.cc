@@ -0,0 +1,202 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_trace_tokenized/trace_callback.h"
+#include "pw_trace_tokenized/trace_tokenized.h"
+
+static_assert(PW_TRACE_CONFIG_DEFERRED_PRODUCERS == 2,
+              "This test must be built with trace_deferred_test_config.h");
+
+namespace {
+
+size_t producer_index = 0;
+PW_TRACE_TIME_TYPE trace_time = 1;
+
+}  // namespace
+
+size_t pw_trace_test_GetProducerIndex() { return producer_index; }
+
+PW_TRACE_TIME_TYPE pw_trace_GetTraceTime() { return trace_time; }
+
+size_t pw_trace_GetTraceTimeTicksPerSecond() { return 1; }
+
+namespace pw::trace {
+namespace {
+
+constexpr uint32_t kToken = 0x12345678;
+
+// Records the trace IDs passed to the event callback and the encoded blocks
+// passed to the sink.
+class DeferredTraceTest : public ::testing::Test {
+ protected:
+  DeferredTraceTest() {
+    producer_index = 0;
+    trace_time = 1;
+    TokenizedTrace::Instance().Enable(true);
+    Callbacks::Instance().RegisterSink(
+        nullptr, SinkAddBytes, SinkEndBlock, this, &sink_handle_);
+    Callbacks::Instance().RegisterEventCallback(
+        EventCallback,
+        CallbacksImpl::kCallOnlyWhenEnabled,
+        this,
+        &event_callback_handle_);
+  }
+
+  ~DeferredTraceTest() {
+    // Leave nothing behind for the next test.
+    TokenizedTrace::Instance().DrainDeferredEvents();
+    Callbacks::Instance().UnregisterSink(sink_handle_);
+    Callbacks::Instance().UnregisterEventCallback(event_callback_handle_);
+    TokenizedTrace::Instance().Enable(false);
+  }
+
+  void Trace(uint32_t trace_id, const void* data = nullptr, size_t size = 0) {
+    TokenizedTrace::Instance().HandleTraceEvent(kToken,
+                                                PW_TRACE_EVENT_TYPE_ASYNC_STEP,
+                                                "TST",
+                                                trace_id,
+                                                /*flags=*/0,
+                                                data,
+                                                size);
+  }
+
+  std::vector<uint32_t> trace_ids_;
+  std::vector<std::vector<std::byte>> blocks_;
+
+ private:
+  static pw_trace_TraceEventReturnFlags EventCallback(void* user_data,
+                                                      uint32_t,
+                                                      pw_trace_EventType,
+                                                      const char*,
+                                                      uint32_t trace_id,
+                                                      uint8_t) {
+    static_cast<DeferredTraceTest*>(user_data)->trace_ids_.push_back(trace_id);
+    return 0;
+  }
+
+  static void SinkAddBytes(void* user_data, const void* bytes, size_t size) {
+    auto& block = static_cast<DeferredTraceTest*>(user_data)->current_block_;
+    const std::byte* begin = static_cast<const std::byte*>(bytes);
+    block.insert(block.end(), begin, begin + size);
+  }
+
+  static void SinkEndBlock(void* user_data) {
+    auto* test = static_cast<DeferredTraceTest*>(user_data);
+    test->blocks_.push_back(std::move(test->current_block_));
+    test->current_block_.clear();
+  }
+
+  std::vector<std::byte> current_block_;
+  CallbacksImpl::SinkHandle sink_handle_;
+  CallbacksImpl::EventCallbackHandle event_callback_handle_;
+};
+
+TEST_F(DeferredTraceTest, EventsAreProcessedWhenDrained) {
+  Trace(1);
+  Trace(2);
+  EXPECT_TRUE(trace_ids_.empty());
+  EXPECT_TRUE(blocks_.empty());
+
+  EXPECT_EQ(TokenizedTrace::Instance().DrainDeferredEvents(), 2u);
+  EXPECT_EQ(trace_ids_, (std::vector<uint32_t>{1, 2}));
+  EXPECT_EQ(blocks_.size(), 2u);
+
+  EXPECT_EQ(TokenizedTrace::Instance().DrainDeferredEvents(), 0u);
+}
+
+TEST_F(DeferredTraceTest, ProducersAreMergedInTimeOrder) {
+  producer_index = 1;
+  trace_time = 10;
+  Trace(10);
+  producer_index = 0;
+  trace_time = 20;
+  Trace(20);
+  producer_index = 1;
+  trace_time = 30;
+  Trace(30);
+  producer_index = 0;
+  trace_time = 40;
+  Trace(40);
+
+  EXPECT_EQ(TokenizedTrace::Instance().DrainDeferredEvents(), 4u);
+  EXPECT_EQ(trace_ids_, (std::vector<uint32_t>{10, 20, 30, 40}));
+}
+
+TEST_F(DeferredTraceTest, TimeIsRecordedWhenTraced) {
+  trace_time = 100;
+  Trace(1);
+  trace_time = 105;
+  Trace(2);
+
+  // Draining much later does not change the recorded time delta.
+  trace_time = 5000;
+  EXPECT_EQ(TokenizedTrace::Instance().DrainDeferredEvents(), 2u);
+  ASSERT_EQ(blocks_.size(), 2u);
+
+  // The header is the token, then the varint time delta, then the trace ID.
+  const std::vector<std::byte>& block = blocks_[1];
+  ASSERT_EQ(block.size(), sizeof(kToken) + 2);
+  uint32_t token;
+  std::memcpy(&token, block.data(), sizeof(token));
+  EXPECT_EQ(token, kToken);
+  EXPECT_EQ(block[4], std::byte{5});
+  EXPECT_EQ(block[5], std::byte{2});
+}
+
+TEST_F(DeferredTraceTest, DataIsCopied) {
+  uint8_t data[] = {0xa, 0xb, 0xc};
+  Trace(1, data, sizeof(data));
+  data[0] = 0;
+
+  EXPECT_EQ(TokenizedTrace::Instance().DrainDeferredEvents(), 1u);
+  ASSERT_EQ(blocks_.size(), 1u);
+  const std::vector<std::byte>& block = blocks_[0];
+  ASSERT_GE(block.size(), sizeof(data));
+  EXPECT_EQ(std::memcmp(block.data() + block.size() - sizeof(data),
+                        "\x0a\x0b\x0c",
+                        sizeof(data)),
+            0);
+}
+
+TEST_F(DeferredTraceTest, FullProducerDropsEvents) {
+  const uint32_t dropped = TokenizedTrace::Instance().DeferredEventsDropped();
+
+  for (uint32_t i = 0; i < PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER + 2;
+       ++i) {
+    Trace(i);
+  }
+  // The other producer has its own queue.
+  producer_index = 1;
+  Trace(100);
+
+  EXPECT_EQ(TokenizedTrace::Instance().DeferredEventsDropped(), dropped + 2);
+  EXPECT_EQ(TokenizedTrace::Instance().DrainDeferredEvents(),
+            PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER + 1u);
+}
+
+TEST_F(DeferredTraceTest, OversizedDataIsDropped) {
+  const uint32_t dropped = TokenizedTrace::Instance().DeferredEventsDropped();
+  std::byte data[PW_TRACE_BUFFER_MAX_DATA_SIZE_BYTES + 1] = {};
+  Trace(1, data, sizeof(data));
+
+  EXPECT_EQ(TokenizedTrace::Instance().DeferredEventsDropped(), dropped + 1);
+  EXPECT_EQ(TokenizedTrace::Instance().DrainDeferredEvents(), 0u);
+}
+
+}  // namespace
+}  // namespace pw::trace
@@ -0,0 +1,34 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration for trace_deferred_test.cc, which is built with its own copy
+// of trace.cc so that deferred processing can be enabled for it alone. This is
+// force included with -include.
+#pragma once
+
+#include <stddef.h>
+
+#define PW_TRACE_CONFIG_DEFERRED_PRODUCERS 2
+#define PW_TRACE_CONFIG_DEFERRED_EVENTS_PER_PRODUCER 4
+#define PW_TRACE_GET_PRODUCER_INDEX() pw_trace_test_GetProducerIndex()
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+size_t pw_trace_test_GetProducerIndex(void);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
@@ -15,6 +15,8 @@
 
 #include "pw_trace_tokenized/trace_rpc_service_nanopb.h"
 
+#include <cstring>
+
 #include "pw_log/log.h"
 #include "pw_preprocessor/util.h"
 #include "pw_trace_tokenized/trace_buffer.h"
@@ -60,4 +62,44 @@ void TraceService::GetTraceData(
   }
   writer.Finish();
 }
+
+void TraceService::StreamTraceData(
+    ServerContext&,
+    const pw_trace_Empty&,
+    ServerWriter<pw_trace_TraceStreamPacket>& writer) {
+  PW_TRACE_LOCK();
+  stream_writer_ = std::move(writer);
+  stream_sequence_ = 0;
+  PW_TRACE_UNLOCK();
+
+  if (!stream_registered_) {
+    const Status status = stream_.Register();
+    if (!status.ok()) {
+      PW_LOG_ERROR("Unable to register trace stream: %s", status.str());
+      stream_writer_.Finish(status);
+      return;
+    }
+    stream_registered_ = true;
+  }
+}
+
+void TraceService::FlushStream() {
+  PW_TRACE_LOCK();
+  stream_.Flush();
+  PW_TRACE_UNLOCK();
+}
+
+Status TraceService::WriteStreamPacket(std::span<const std::byte> events) {
+  static_assert(PW_TRACE_CONFIG_STREAM_PACKET_SIZE_BYTES <=
+                    sizeof(pw_trace_TraceStreamPacket{}.events.bytes),
+                "PW_TRACE_CONFIG_STREAM_PACKET_SIZE_BYTES must not exceed the "
+                "max_size of TraceStreamPacket.events in trace_rpc.options");
+  pw_trace_TraceStreamPacket packet = pw_trace_TraceStreamPacket_init_default;
+  std::memcpy(packet.events.bytes, events.data(), events.size());
+  packet.events.size = events.size();
+  packet.sequence = stream_sequence_++;
+  packet.dropped_events = stream_.dropped_events();
+  return stream_writer_.Write(packet);
+}
+
 }  // namespace pw::trace
\ No newline at end of file
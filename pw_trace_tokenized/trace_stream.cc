@@ -0,0 +1,151 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_trace_tokenized/trace_stream.h"
+
+#include <cstring>
+
+#include "pw_status/try.h"
+
+namespace pw::trace {
+
+Status TraceStreamEncoder::AddEvent(std::span<const std::byte> event) {
+  uint32_t token;
+  if (event.size() < sizeof(token)) {
+    return Status::DataLoss();
+  }
+  std::memcpy(&token, event.data(), sizeof(token));
+
+  uint64_t time_delta;
+  const size_t time_bytes =
+      varint::Decode(event.subspan(sizeof(token)), &time_delta);
+  if (time_bytes == 0u) {
+    return Status::DataLoss();
+  }
+  const std::span<const std::byte> payload =
+      event.subspan(sizeof(token) + time_bytes);
+
+  size_t index = 0;
+  while (index < dictionary_size_ && dictionary_[index] != token) {
+    index += 1;
+  }
+  const bool new_token = index == dictionary_size_;
+  if (new_token && dictionary_size_ == kMaxDictionaryEntries) {
+    return Status::ResourceExhausted();
+  }
+
+  // Encode into a scratch buffer large enough for any event, then copy it into
+  // the packet if it fits, so a partial event is never left in the packet.
+  std::byte scratch[varint::kMaxVarint64SizeBytes + sizeof(token) +
+                    varint::kMaxVarint64SizeBytes +
+                    varint::kMaxVarint64SizeBytes];
+  const uint64_t key =
+      (index << 2) | (payload.empty() ? 0u : 0b10u) | (new_token ? 1u : 0u);
+  size_t header_size = varint::Encode(key, scratch);
+  if (new_token) {
+    std::memcpy(&scratch[header_size], &token, sizeof(token));
+    header_size += sizeof(token);
+  }
+  header_size += varint::Encode(static_cast<int64_t>(time_delta),
+                                std::span(scratch).subspan(header_size));
+  if (!payload.empty()) {
+    header_size +=
+        varint::Encode(payload.size(), std::span(scratch).subspan(header_size));
+  }
+
+  const size_t encoded_size = header_size + payload.size();
+  if (encoded_size > buffer_.size()) {
+    return Status::InvalidArgument();
+  }
+  if (size_ + encoded_size > buffer_.size()) {
+    return Status::ResourceExhausted();
+  }
+
+  std::memcpy(&buffer_[size_], scratch, header_size);
+  if (!payload.empty()) {
+    std::memcpy(&buffer_[size_ + header_size], payload.data(), payload.size());
+  }
+  size_ += encoded_size;
+  event_count_ += 1;
+  if (new_token) {
+    dictionary_[dictionary_size_++] = token;
+  }
+  return OkStatus();
+}
+
+Status TraceStream::Register() {
+  if (registered_) {
+    return Status::FailedPrecondition();
+  }
+  PW_TRY(Callbacks::Instance().RegisterSink(
+      SinkStartBlock, SinkAddBytes, SinkEndBlock, this, &sink_handle_));
+  registered_ = true;
+  return OkStatus();
+}
+
+Status TraceStream::Unregister() {
+  if (!registered_) {
+    return Status::FailedPrecondition();
+  }
+  registered_ = false;
+  return Callbacks::Instance().UnregisterSink(sink_handle_);
+}
+
+void TraceStream::Flush() {
+  if (encoder_.empty()) {
+    return;
+  }
+  if (!writer_(encoder_.packet()).ok()) {
+    dropped_events_ += encoder_.event_count();
+  }
+  encoder_.Clear();
+}
+
+void TraceStream::SinkStartBlock(void* user_data, size_t size) {
+  TraceStream& stream = *static_cast<TraceStream*>(user_data);
+  stream.block_size_ = size;
+  stream.block_index_ = 0;
+}
+
+void TraceStream::SinkAddBytes(void* user_data,
+                               const void* bytes,
+                               size_t size) {
+  TraceStream& stream = *static_cast<TraceStream*>(user_data);
+  if (stream.block_size_ > sizeof(stream.block_) ||
+      stream.block_index_ + size > stream.block_size_) {
+    return;  // The block is too large; it is dropped at the end.
+  }
+  std::memcpy(&stream.block_[stream.block_index_], bytes, size);
+  stream.block_index_ += size;
+}
+
+void TraceStream::SinkEndBlock(void* user_data) {
+  TraceStream& stream = *static_cast<TraceStream*>(user_data);
+  if (stream.block_index_ != stream.block_size_) {
+    stream.dropped_events_ += 1;
+    return;
+  }
+
+  const std::span<const std::byte> event(stream.block_, stream.block_size_);
+  Status status = stream.encoder_.AddEvent(event);
+  if (status.IsResourceExhausted()) {
+    stream.Flush();
+    status = stream.encoder_.AddEvent(event);
+  }
+  if (!status.ok()) {
+    stream.dropped_events_ += 1;
+  }
+}
+
+}  // namespace pw::trace
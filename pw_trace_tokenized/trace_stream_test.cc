@@ -0,0 +1,189 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#define PW_TRACE_MODULE_NAME "TST"
+
+#include "pw_trace_tokenized/trace_stream.h"
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_trace/trace.h"
+
+namespace pw::trace {
+namespace {
+
+constexpr uint32_t kToken = 0x11223344;
+constexpr uint32_t kOtherToken = 0x55667788;
+
+// Builds a tokenized event as passed to trace sinks.
+std::vector<std::byte> Event(uint32_t token,
+                             uint64_t time_delta,
+                             std::vector<std::byte> payload = {}) {
+  std::vector<std::byte> event(sizeof(token) + varint::kMaxVarint64SizeBytes);
+  std::memcpy(event.data(), &token, sizeof(token));
+  const size_t time_bytes = varint::Encode(
+      time_delta, std::span(event).subspan(sizeof(token)));
+  event.resize(sizeof(token) + time_bytes);
+  event.insert(event.end(), payload.begin(), payload.end());
+  return event;
+}
+
+std::vector<std::byte> Bytes(std::initializer_list<uint8_t> bytes) {
+  std::vector<std::byte> result;
+  for (uint8_t byte : bytes) {
+    result.push_back(std::byte{byte});
+  }
+  return result;
+}
+
+std::vector<std::byte> TokenBytes(uint32_t token) {
+  std::vector<std::byte> bytes(sizeof(token));
+  std::memcpy(bytes.data(), &token, sizeof(token));
+  return bytes;
+}
+
+std::vector<std::byte> Packet(const TraceStreamEncoder& encoder) {
+  return std::vector<std::byte>(encoder.packet().begin(),
+                                encoder.packet().end());
+}
+
+TEST(TraceStreamEncoder, RepeatedTokenUsesDictionary) {
+  std::array<std::byte, 64> buffer;
+  TraceStreamEncoder encoder(buffer);
+  EXPECT_TRUE(encoder.empty());
+
+  ASSERT_EQ(encoder.AddEvent(Event(kToken, 3)), OkStatus());
+  ASSERT_EQ(encoder.AddEvent(Event(kToken, 1, Bytes({0x05}))), OkStatus());
+  ASSERT_EQ(encoder.AddEvent(Event(kOtherToken, 200)), OkStatus());
+  EXPECT_EQ(encoder.event_count(), 3u);
+
+  std::vector<std::byte> expected;
+  // New token at index 0, then the zig-zag encoded delta.
+  expected.push_back(std::byte{0b01});
+  for (std::byte b : TokenBytes(kToken)) {
+    expected.push_back(b);
+  }
+  expected.push_back(std::byte{6});
+  // Token at index 0 with a payload: delta, payload size, payload.
+  for (std::byte b : Bytes({0b10, 2, 1, 0x05})) {
+    expected.push_back(b);
+  }
+  // New token at index 1; a delta of 200 zig-zag encodes to 400.
+  expected.push_back(std::byte{0b101});
+  for (std::byte b : TokenBytes(kOtherToken)) {
+    expected.push_back(b);
+  }
+  for (std::byte b : Bytes({0x90, 0x03})) {
+    expected.push_back(b);
+  }
+  EXPECT_EQ(Packet(encoder), expected);
+}
+
+TEST(TraceStreamEncoder, FullPacket) {
+  std::array<std::byte, 10> buffer;
+  TraceStreamEncoder encoder(buffer);
+
+  // 6 bytes for the first event, then 2 for each repeat.
+  ASSERT_EQ(encoder.AddEvent(Event(kToken, 1)), OkStatus());
+  ASSERT_EQ(encoder.AddEvent(Event(kToken, 1)), OkStatus());
+  ASSERT_EQ(encoder.AddEvent(Event(kToken, 1)), OkStatus());
+  EXPECT_EQ(encoder.packet().size(), 10u);
+
+  // Nothing is written for an event which does not fit.
+  EXPECT_EQ(encoder.AddEvent(Event(kToken, 1)), Status::ResourceExhausted());
+  EXPECT_EQ(encoder.packet().size(), 10u);
+  EXPECT_EQ(encoder.event_count(), 3u);
+
+  // The dictionary is reset with the packet, so the token is sent again.
+  encoder.Clear();
+  EXPECT_TRUE(encoder.empty());
+  ASSERT_EQ(encoder.AddEvent(Event(kToken, 1)), OkStatus());
+  EXPECT_EQ(encoder.packet().size(), 6u);
+}
+
+TEST(TraceStreamEncoder, FullDictionary) {
+  std::array<std::byte, 256> buffer;
+  TraceStreamEncoder encoder(buffer);
+
+  for (uint32_t i = 0; i < TraceStreamEncoder::kMaxDictionaryEntries; ++i) {
+    ASSERT_EQ(encoder.AddEvent(Event(i, 1)), OkStatus());
+  }
+  EXPECT_EQ(encoder.AddEvent(Event(kToken, 1)), Status::ResourceExhausted());
+
+  // Tokens already in the dictionary can still be added.
+  EXPECT_EQ(encoder.AddEvent(Event(0, 1)), OkStatus());
+}
+
+TEST(TraceStreamEncoder, InvalidEvents) {
+  std::array<std::byte, 8> buffer;
+  TraceStreamEncoder encoder(buffer);
+
+  EXPECT_EQ(encoder.AddEvent(Bytes({1, 2, 3})), Status::DataLoss());
+  EXPECT_EQ(encoder.AddEvent(Bytes({1, 2, 3, 4, 0x80})), Status::DataLoss());
+  EXPECT_EQ(encoder.AddEvent(Event(kToken, 1, Bytes({1, 2, 3}))),
+            Status::InvalidArgument());
+  EXPECT_TRUE(encoder.empty());
+}
+
+struct Packets {
+  std::vector<std::vector<std::byte>> sent;
+  Status status;
+};
+
+TEST(TraceStream, StreamsTracedEvents) {
+  PW_TRACE_SET_ENABLED(true);
+
+  std::array<std::byte, 12> buffer;
+  Packets packets;
+  TraceStream stream(buffer, [&packets](std::span<const std::byte> packet) {
+    packets.sent.emplace_back(packet.begin(), packet.end());
+    return packets.status;
+  });
+  ASSERT_EQ(stream.Register(), OkStatus());
+
+  // The first event takes 6 bytes and repeats take 2, so the fifth event
+  // starts a new packet.
+  for (int i = 0; i < 5; ++i) {
+    PW_TRACE_INSTANT("Test");
+  }
+  ASSERT_EQ(packets.sent.size(), 1u);
+  EXPECT_EQ(packets.sent[0].size(), 12u);
+
+  stream.Flush();
+  ASSERT_EQ(packets.sent.size(), 2u);
+  EXPECT_EQ(packets.sent[1].size(), 6u);
+
+  // Flushing an empty packet sends nothing.
+  stream.Flush();
+  EXPECT_EQ(packets.sent.size(), 2u);
+  EXPECT_EQ(stream.dropped_events(), 0u);
+
+  // Events in packets which fail to send are counted.
+  packets.status = Status::Unavailable();
+  PW_TRACE_INSTANT("Test");
+  PW_TRACE_INSTANT("Test");
+  stream.Flush();
+  EXPECT_EQ(stream.dropped_events(), 2u);
+
+  EXPECT_EQ(stream.Unregister(), OkStatus());
+  PW_TRACE_INSTANT("Test");
+  stream.Flush();
+  EXPECT_EQ(packets.sent.size(), 3u);
+}
+
+}  // namespace
+}  // namespace pw::trace
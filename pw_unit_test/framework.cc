@@ -56,7 +56,13 @@ int Framework::RunAllTests() {
   if (event_handler_ != nullptr) {
     event_handler_->RunAllTestsStart();
   }
-  for (const TestInfo* test = tests_; test != nullptr; test = test->next()) {
+  uint32_t test_index = 0;
+  for (const TestInfo* test = tests_; test != nullptr;
+       test = test->next(), ++test_index) {
+    if (test_index % shard_count_ != shard_index_) {
+      continue;  // This test case belongs to a different shard.
+    }
+
     if (ShouldRunTest(*test)) {
       test->run();
     } else if (!test->enabled()) {
@@ -124,6 +130,12 @@ void Framework::ExpectationResult(const char* expression,
   event_handler_->TestCaseExpect(current_test_->test_case(), expectation);
 }
 
+void Framework::PerfResult(const PerfTestResult& result) {
+  if (event_handler_ != nullptr) {
+    event_handler_->TestCasePerf(current_test_->test_case(), result);
+  }
+}
+
 bool Framework::ShouldRunTest(const TestInfo& test_info) {
 #if PW_CXX_STANDARD_IS_SUPPORTED(17)
   // Test suite filtering is only supported if using C++17.
@@ -139,11 +151,86 @@ bool Framework::ShouldRunTest(const TestInfo& test_info) {
       return false;
     }
   }
+
+  if (!MatchesTestFilter(test_filter_, test_info.test_case())) {
+    return false;
+  }
 #endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
 
   return test_info.enabled();
 }
 
+#if PW_CXX_STANDARD_IS_SUPPORTED(17)
+namespace {
+
+// Matches "suite_name.test_name" against a single pattern with '*' and '?'
+// wildcards, without copying the name.
+bool MatchesPattern(std::string_view pattern, const TestCase& test_case) {
+  const std::string_view suite(test_case.suite_name);
+  const std::string_view test(test_case.test_name);
+  const size_t name_size = suite.size() + 1 + test.size();
+  auto name_at = [&](size_t i) {
+    if (i < suite.size()) {
+      return suite[i];
+    }
+    return i == suite.size() ? '.' : test[i - suite.size() - 1];
+  };
+
+  // Greedy wildcard matching, which backtracks to the most recent '*'.
+  size_t p = 0;
+  size_t n = 0;
+  size_t star = std::string_view::npos;
+  size_t star_n = 0;
+  while (n < name_size) {
+    if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name_at(n))) {
+      ++p;
+      ++n;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      star_n = n;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      n = ++star_n;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*') {
+    ++p;
+  }
+  return p == pattern.size();
+}
+
+// Returns whether any of the ':'-separated patterns match.
+bool MatchesAnyPattern(std::string_view patterns, const TestCase& test_case) {
+  while (true) {
+    const size_t end = patterns.find(':');
+    if (MatchesPattern(patterns.substr(0, end), test_case)) {
+      return true;
+    }
+    if (end == std::string_view::npos) {
+      return false;
+    }
+    patterns.remove_prefix(end + 1);
+  }
+}
+
+}  // namespace
+
+bool MatchesTestFilter(std::string_view filter, const TestCase& test_case) {
+  const size_t negative_start = filter.find('-');
+  const std::string_view positive = filter.substr(0, negative_start);
+
+  if (!positive.empty() && !MatchesAnyPattern(positive, test_case)) {
+    return false;
+  }
+  if (negative_start == std::string_view::npos) {
+    return true;
+  }
+  return !MatchesAnyPattern(filter.substr(negative_start + 1), test_case);
+}
+#endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
+
 bool TestInfo::enabled() const {
   constexpr size_t kStringSize = sizeof("DISABLED_") - 1;
   return std::strncmp("DISABLED_", test_case().test_name, kStringSize) != 0 &&
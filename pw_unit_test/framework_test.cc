@@ -191,5 +191,52 @@ TEST_F(SetUpAndTearDown, MakeSureItIsSet) {
   value_ = 3210;
 }
 
+#if PW_CXX_STANDARD_IS_SUPPORTED(17)
+
+constexpr unit_test::TestCase kFilterTestCase = {
+    .suite_name = "Suite",
+    .test_name = "Test",
+    .file_name = "framework_test.cc",
+};
+
+bool Matches(std::string_view filter) {
+  return unit_test::internal::MatchesTestFilter(filter, kFilterTestCase);
+}
+
+TEST(TestFilter, EmptyFilterMatchesEverything) {
+  EXPECT_TRUE(Matches(""));
+  EXPECT_TRUE(Matches("*"));
+}
+
+TEST(TestFilter, ExactName) {
+  EXPECT_TRUE(Matches("Suite.Test"));
+  EXPECT_FALSE(Matches("Suite.Tes"));
+  EXPECT_FALSE(Matches("Suite.Test2"));
+  EXPECT_FALSE(Matches("Suite"));
+}
+
+TEST(TestFilter, Wildcards) {
+  EXPECT_TRUE(Matches("Suite.*"));
+  EXPECT_TRUE(Matches("*.Test"));
+  EXPECT_TRUE(Matches("S?ite.T*t"));
+  EXPECT_TRUE(Matches("*e*e*"));
+  EXPECT_FALSE(Matches("Other.*"));
+  EXPECT_FALSE(Matches("Suite.Test?"));
+}
+
+TEST(TestFilter, MultiplePatterns) {
+  EXPECT_TRUE(Matches("Other.*:Suite.*"));
+  EXPECT_FALSE(Matches("Other.*:Another.*"));
+}
+
+TEST(TestFilter, NegativePatterns) {
+  EXPECT_FALSE(Matches("-Suite.*"));
+  EXPECT_TRUE(Matches("-Other.*"));
+  EXPECT_FALSE(Matches("Suite.*-*.Test"));
+  EXPECT_TRUE(Matches("Suite.*-Other.*:*.Skip"));
+}
+
+#endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
+
 }  // namespace
 }  // namespace pw
@@ -83,4 +83,19 @@ void LoggingEventHandler::TestCaseDisabled(const TestCase& test) {
   PW_LOG_DEBUG("Skipping disabled test %s.%s", test.suite_name, test.test_name);
 }
 
+void LoggingEventHandler::TestCasePerf(const TestCase& test_case,
+                                       const PerfTestResult& result) {
+  // Report the time per iteration with picosecond resolution, since fast
+  // operations take less than a nanosecond on some targets.
+  const int64_t ps_per_iteration =
+      result.duration_ns * 1000 / (result.iterations != 0 ? result.iterations
+                                                          : 1);
+  PW_LOG_INFO("[   PERF   ] %s.%s: %u iterations, %u.%03u ns/iteration",
+              test_case.suite_name,
+              test_case.test_name,
+              static_cast<unsigned>(result.iterations),
+              static_cast<unsigned>(ps_per_iteration / 1000),
+              static_cast<unsigned>(ps_per_iteration % 1000));
+}
+
 }  // namespace pw::unit_test
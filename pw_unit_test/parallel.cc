@@ -0,0 +1,362 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_unit_test/parallel.h"
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pw_unit_test/framework.h"
+
+namespace pw::unit_test {
+namespace {
+
+enum class EventType : uint8_t {
+  kRunAllTestsEnd,
+  kTestCaseStart,
+  kTestCaseEnd,
+  kTestCaseDisabled,
+  kTestCaseExpect,
+  kTestCasePerf,
+};
+
+// An event sent from a worker to the parent process. Workers are forked from
+// the parent, so pointers to static data, such as the TestCase structs and
+// expression strings, are valid in both. The evaluated expression is not
+// static, so it is sent as text_size bytes following the record.
+struct EventRecord {
+  EventType type;
+  TestResult result;
+  bool success;
+  int line_number;
+  uint32_t text_size;
+  const TestCase* test_case;
+  const char* expression;
+  RunTestsSummary summary;
+  PerfTestResult perf;
+};
+
+// Event handler used in workers, which writes events to a pipe.
+class WorkerEventHandler final : public EventHandler {
+ public:
+  explicit WorkerEventHandler(int fd) : fd_(fd) {}
+
+  void RunAllTestsStart() override {}
+
+  void RunAllTestsEnd(const RunTestsSummary& summary) override {
+    EventRecord record = {};
+    record.type = EventType::kRunAllTestsEnd;
+    record.summary = summary;
+    Send(record);
+  }
+
+  void TestCaseStart(const TestCase& test_case) override {
+    Send(Record(EventType::kTestCaseStart, test_case));
+  }
+
+  void TestCaseEnd(const TestCase& test_case, TestResult result) override {
+    EventRecord record = Record(EventType::kTestCaseEnd, test_case);
+    record.result = result;
+    Send(record);
+  }
+
+  void TestCaseDisabled(const TestCase& test_case) override {
+    Send(Record(EventType::kTestCaseDisabled, test_case));
+  }
+
+  void TestCaseExpect(const TestCase& test_case,
+                      const TestExpectation& expectation) override {
+    EventRecord record = Record(EventType::kTestCaseExpect, test_case);
+    record.expression = expectation.expression;
+    record.line_number = expectation.line_number;
+    record.success = expectation.success;
+    Send(record, expectation.evaluated_expression);
+  }
+
+  void TestCasePerf(const TestCase& test_case,
+                    const PerfTestResult& result) override {
+    EventRecord record = Record(EventType::kTestCasePerf, test_case);
+    record.perf = result;
+    Send(record);
+  }
+
+ private:
+  static EventRecord Record(EventType type, const TestCase& test_case) {
+    EventRecord record = {};
+    record.type = type;
+    record.test_case = &test_case;
+    return record;
+  }
+
+  void Send(EventRecord record, std::string_view text = {}) {
+    record.text_size = static_cast<uint32_t>(text.size());
+    Write(&record, sizeof(record));
+    Write(text.data(), text.size());
+  }
+
+  void Write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+      const ssize_t written = write(fd_, bytes, size);
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        _exit(1);  // The parent is gone; nothing more can be reported.
+      }
+      bytes += written;
+      size -= static_cast<size_t>(written);
+    }
+  }
+
+  const int fd_;
+};
+
+// An event received from a worker, with its own copy of the text.
+struct ReceivedEvent {
+  EventRecord record;
+  std::string text;
+};
+
+// The parent process's view of a worker.
+struct Worker {
+  pid_t pid = -1;
+  int fd = -1;
+  std::string received;  // Bytes not yet parsed into events.
+
+  // Events of the test case that is currently running, which are dispatched
+  // together when it ends.
+  std::vector<ReceivedEvent> current_test_events;
+  bool finished = false;  // Whether RunAllTestsEnd was received.
+};
+
+void Dispatch(EventHandler& handler, const ReceivedEvent& event) {
+  const EventRecord& record = event.record;
+  switch (record.type) {
+    case EventType::kRunAllTestsEnd:
+      break;
+    case EventType::kTestCaseStart:
+      handler.TestCaseStart(*record.test_case);
+      break;
+    case EventType::kTestCaseEnd:
+      handler.TestCaseEnd(*record.test_case, record.result);
+      break;
+    case EventType::kTestCaseDisabled:
+      handler.TestCaseDisabled(*record.test_case);
+      break;
+    case EventType::kTestCaseExpect: {
+      const TestExpectation expectation = {
+          .expression = record.expression,
+          .evaluated_expression = event.text.c_str(),
+          .line_number = record.line_number,
+          .success = record.success,
+      };
+      handler.TestCaseExpect(*record.test_case, expectation);
+      break;
+    }
+    case EventType::kTestCasePerf:
+      handler.TestCasePerf(*record.test_case, record.perf);
+      break;
+  }
+}
+
+// Parses and handles the complete events that a worker has sent so far.
+void HandleEvents(EventHandler& handler,
+                  Worker& worker,
+                  RunTestsSummary& summary) {
+  size_t offset = 0;
+  while (worker.received.size() - offset >= sizeof(EventRecord)) {
+    ReceivedEvent event;
+    std::memcpy(&event.record, &worker.received[offset], sizeof(EventRecord));
+    const size_t event_size = sizeof(EventRecord) + event.record.text_size;
+    if (worker.received.size() - offset < event_size) {
+      break;
+    }
+    event.text = worker.received.substr(offset + sizeof(EventRecord),
+                                        event.record.text_size);
+    offset += event_size;
+
+    switch (event.record.type) {
+      case EventType::kRunAllTestsEnd:
+        summary.passed_tests += event.record.summary.passed_tests;
+        summary.failed_tests += event.record.summary.failed_tests;
+        summary.skipped_tests += event.record.summary.skipped_tests;
+        summary.disabled_tests += event.record.summary.disabled_tests;
+        worker.finished = true;
+        break;
+      case EventType::kTestCaseDisabled:
+        Dispatch(handler, event);
+        break;
+      case EventType::kTestCaseStart:
+      case EventType::kTestCaseExpect:
+      case EventType::kTestCasePerf:
+        worker.current_test_events.push_back(std::move(event));
+        break;
+      case EventType::kTestCaseEnd:
+        worker.current_test_events.push_back(std::move(event));
+        for (const ReceivedEvent& test_event : worker.current_test_events) {
+          Dispatch(handler, test_event);
+        }
+        worker.current_test_events.clear();
+        break;
+    }
+  }
+  worker.received.erase(0, offset);
+}
+
+// Reports the test case a worker was running when it exited as failed.
+void FailInterruptedTest(EventHandler& handler,
+                         Worker& worker,
+                         RunTestsSummary& summary) {
+  if (worker.current_test_events.empty()) {
+    return;
+  }
+  for (const ReceivedEvent& event : worker.current_test_events) {
+    Dispatch(handler, event);
+  }
+  const TestCase& test_case =
+      *worker.current_test_events.front().record.test_case;
+  const TestExpectation expectation = {
+      .expression = "(test case completes)",
+      .evaluated_expression = "(worker process exited during the test case)",
+      .line_number = 0,
+      .success = false,
+  };
+  handler.TestCaseExpect(test_case, expectation);
+  handler.TestCaseEnd(test_case, TestResult::kFailure);
+  summary.failed_tests += 1;
+  worker.current_test_events.clear();
+}
+
+}  // namespace
+
+int RunAllTestsInParallel(EventHandler& handler, int jobs) {
+  internal::Framework& framework = internal::Framework::Get();
+  if (jobs <= 1) {
+    framework.RegisterEventHandler(&handler);
+    return framework.RunAllTests();
+  }
+
+  const uint32_t shard_index = framework.shard_index();
+  const uint32_t shard_count = framework.shard_count();
+  const uint32_t worker_count = static_cast<uint32_t>(jobs);
+
+  RunTestsSummary summary = {};
+  int exit_status = 0;
+  handler.RunAllTestsStart();
+
+  std::vector<Worker> workers(worker_count);
+  for (uint32_t i = 0; i < worker_count; ++i) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+      exit_status = 1;
+      break;
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0) {
+      // Worker: run every worker_count-th test case of this process's shard.
+      close(fds[0]);
+      for (uint32_t j = 0; j < i; ++j) {
+        close(workers[j].fd);
+      }
+      WorkerEventHandler worker_handler(fds[1]);
+      framework.RegisterEventHandler(&worker_handler);
+      framework.SetTestShard(shard_index + shard_count * i,
+                             shard_count * worker_count);
+      _exit(framework.RunAllTests());
+    }
+
+    close(fds[1]);
+    if (pid < 0) {
+      close(fds[0]);
+      exit_status = 1;
+      break;
+    }
+    workers[i].pid = pid;
+    workers[i].fd = fds[0];
+  }
+
+  // Forward events from the workers until they have all exited.
+  std::vector<pollfd> poll_fds;
+  while (true) {
+    poll_fds.clear();
+    for (Worker& worker : workers) {
+      if (worker.fd >= 0) {
+        poll_fds.push_back({.fd = worker.fd, .events = POLLIN, .revents = 0});
+      }
+    }
+    if (poll_fds.empty()) {
+      break;
+    }
+    if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+
+    for (Worker& worker : workers) {
+      if (worker.fd < 0) {
+        continue;
+      }
+      const auto it = std::find_if(
+          poll_fds.begin(), poll_fds.end(), [&](const pollfd& poll_fd) {
+            return poll_fd.fd == worker.fd;
+          });
+      if (it == poll_fds.end() || it->revents == 0) {
+        continue;
+      }
+
+      char buffer[4096];
+      const ssize_t bytes = read(worker.fd, buffer, sizeof(buffer));
+      if (bytes > 0) {
+        worker.received.append(buffer, static_cast<size_t>(bytes));
+        HandleEvents(handler, worker, summary);
+      } else if (bytes == 0 || errno != EINTR) {
+        close(worker.fd);
+        worker.fd = -1;
+      }
+    }
+  }
+
+  for (Worker& worker : workers) {
+    if (worker.pid < 0) {
+      continue;
+    }
+    int status = 0;
+    while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (!worker.finished || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      exit_status = 1;
+    }
+    FailInterruptedTest(handler, worker, summary);
+  }
+
+  if (summary.failed_tests != 0) {
+    exit_status = 1;
+  }
+  handler.RunAllTestsEnd(summary);
+  return exit_status;
+}
+
+}  // namespace pw::unit_test
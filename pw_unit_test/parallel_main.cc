@@ -0,0 +1,82 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// A main function for host test binaries that supports filtering, sharding,
+// and running tests in parallel. It accepts the following arguments:
+//
+//   --gtest_filter=<filter>  Only run matching test cases; see
+//                            pw::unit_test::internal::MatchesTestFilter().
+//   --jobs=<count>           Run the test cases in this many worker processes.
+//
+// As with Google Test, the shard to run is read from the GTEST_SHARD_INDEX and
+// GTEST_TOTAL_SHARDS environment variables.
+
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+
+#include "pw_sys_io/sys_io.h"
+#include "pw_unit_test/framework.h"
+#include "pw_unit_test/parallel.h"
+#include "pw_unit_test/simple_printing_event_handler.h"
+
+namespace {
+
+bool ParseFlag(std::string_view arg,
+               std::string_view flag,
+               std::string_view& value) {
+  if (arg.size() <= flag.size() || arg.substr(0, flag.size()) != flag ||
+      arg[flag.size()] != '=') {
+    return false;
+  }
+  value = arg.substr(flag.size() + 1);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  pw::unit_test::SimplePrintingEventHandler handler(
+      [](const std::string_view& s, bool append_newline) {
+        if (append_newline) {
+          pw::sys_io::WriteLine(s);
+        } else {
+          pw::sys_io::WriteBytes(std::as_bytes(std::span(s)));
+        }
+      });
+
+  int jobs = 1;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view value;
+    if (ParseFlag(argv[i], "--gtest_filter", value)) {
+      pw::unit_test::SetTestFilter(value);
+    } else if (ParseFlag(argv[i], "--jobs", value)) {
+      // The value is the end of the argument, so it is null terminated.
+      jobs = std::atoi(value.data());
+    } else {
+      std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  const char* shard_index = std::getenv("GTEST_SHARD_INDEX");
+  const char* shard_count = std::getenv("GTEST_TOTAL_SHARDS");
+  if (shard_index != nullptr && shard_count != nullptr) {
+    pw::unit_test::SetTestShard(std::strtoul(shard_index, nullptr, 10),
+                                std::strtoul(shard_count, nullptr, 10));
+  }
+
+  return pw::unit_test::RunAllTestsInParallel(handler, jobs);
+}
@@ -0,0 +1,89 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_unit_test/perf_test.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace pw::unit_test {
+namespace {
+
+// Upper bound on the number of iterations in a batch, which keeps the iteration
+// count from overflowing if the clock doesn't advance.
+constexpr uint32_t kMaxBatchIterations = 1'000'000'000;
+
+}  // namespace
+
+bool PerfState::NextBatch() {
+  const chrono::SystemClock::time_point now = chrono::SystemClock::now();
+
+  switch (phase_) {
+    case Phase::kWarmup:
+      break;
+    case Phase::kMeasuring: {
+      const int64_t elapsed_ns =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now -
+                                                               batch_start_)
+              .count();
+      constexpr int64_t kMinDurationNs =
+          int64_t{config::kPerfMinDurationMs} * 1'000'000;
+
+      if (elapsed_ns >= kMinDurationNs ||
+          batch_iterations_ >= kMaxBatchIterations) {
+        result_ = {.iterations = batch_iterations_, .duration_ns = elapsed_ns};
+        phase_ = Phase::kDone;
+        return false;
+      }
+
+      // Estimate the iterations needed to reach the minimum duration, with
+      // some margin so that the next batch is likely to be the last. Grow by
+      // at least 2x and at most 10x, since short batches are inaccurate.
+      uint64_t next = uint64_t{batch_iterations_} * 10;
+      if (elapsed_ns > 0) {
+        next = std::clamp<uint64_t>(
+            uint64_t{batch_iterations_} * kMinDurationNs * 14 / 10 /
+                static_cast<uint64_t>(elapsed_ns),
+            uint64_t{batch_iterations_} * 2,
+            next);
+      }
+      batch_iterations_ = static_cast<uint32_t>(
+          std::min<uint64_t>(next, kMaxBatchIterations));
+      break;
+    }
+    case Phase::kDone:
+      return false;
+  }
+
+  // This call to KeepRunning() is the first iteration of the batch.
+  phase_ = Phase::kMeasuring;
+  remaining_ = batch_iterations_ - 1;
+  batch_start_ = chrono::SystemClock::now();
+  return true;
+}
+
+namespace internal {
+
+void PerfTest::PigweedTestBody() {
+  PerfState state;
+  PigweedPerfTestBody(state);
+
+  // Only report a result if the loop ran to completion; the body may have
+  // returned early from a failed ASSERT.
+  if (state.done()) {
+    Framework::Get().PerfResult(state.result());
+  }
+}
+
+}  // namespace internal
+}  // namespace pw::unit_test
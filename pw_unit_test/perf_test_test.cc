@@ -0,0 +1,67 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#include "pw_unit_test/perf_test.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace pw::unit_test {
+namespace {
+
+uint32_t iterations_run = 0;
+
+PERF_TEST(PerfTest, MeasuresBatch, state) {
+  iterations_run = 0;
+  std::array<uint32_t, 16> values = {};
+  while (state.KeepRunning()) {
+    iterations_run += 1;
+    for (uint32_t& value : values) {
+      value = value * 31 + iterations_run;
+    }
+    DoNotOptimize(values);
+  }
+
+  ASSERT_TRUE(state.done());
+  EXPECT_GT(state.result().iterations, 0u);
+  EXPECT_LE(state.result().iterations, iterations_run);
+
+  // The measured batch is the last one, after the warmup and smaller batches.
+  EXPECT_GE(iterations_run,
+            state.result().iterations + config::kPerfWarmupIterations);
+  EXPECT_GE(state.result().duration_ns,
+            int64_t{config::kPerfMinDurationMs} * 1'000'000);
+
+  // KeepRunning() keeps returning false once measuring is done.
+  EXPECT_FALSE(state.KeepRunning());
+}
+
+PERF_TEST(PerfTest, SlowIterations, state) {
+  uint32_t count = 0;
+  while (state.KeepRunning()) {
+    const auto end = chrono::SystemClock::now() + std::chrono::milliseconds(1);
+    while (chrono::SystemClock::now() < end) {
+    }
+    count += 1;
+  }
+  DoNotOptimize(count);
+
+  ASSERT_TRUE(state.done());
+  const int64_t ns_per_iteration =
+      state.result().duration_ns / state.result().iterations;
+  EXPECT_GE(ns_per_iteration, 1'000'000);
+}
+
+}  // namespace
+}  // namespace pw::unit_test
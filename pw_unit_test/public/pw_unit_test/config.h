@@ -16,6 +16,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 #include "pw_polyfill/language_feature_macros.h"
 
@@ -23,6 +24,19 @@
 #define PW_UNIT_TEST_CONFIG_MEMORY_POOL_SIZE 16384
 #endif  // PW_UNIT_TEST_CONFIG_MEMORY_POOL_SIZE
 
+// The number of iterations a PERF_TEST runs before it starts measuring, to
+// warm up caches and branch predictors.
+#ifndef PW_UNIT_TEST_CONFIG_PERF_WARMUP_ITERATIONS
+#define PW_UNIT_TEST_CONFIG_PERF_WARMUP_ITERATIONS 10
+#endif  // PW_UNIT_TEST_CONFIG_PERF_WARMUP_ITERATIONS
+
+// The minimum duration of a PERF_TEST's measured batch, in milliseconds. The
+// number of iterations is increased until a batch takes at least this long, so
+// that the timer's resolution does not dominate the result.
+#ifndef PW_UNIT_TEST_CONFIG_PERF_MIN_DURATION_MS
+#define PW_UNIT_TEST_CONFIG_PERF_MIN_DURATION_MS 100
+#endif  // PW_UNIT_TEST_CONFIG_PERF_MIN_DURATION_MS
+
 namespace pw {
 namespace unit_test {
 namespace config {
@@ -30,6 +44,12 @@ namespace config {
 PW_INLINE_VARIABLE constexpr size_t kMemoryPoolSize =
     PW_UNIT_TEST_CONFIG_MEMORY_POOL_SIZE;
 
+PW_INLINE_VARIABLE constexpr uint32_t kPerfWarmupIterations =
+    PW_UNIT_TEST_CONFIG_PERF_WARMUP_ITERATIONS;
+
+PW_INLINE_VARIABLE constexpr uint32_t kPerfMinDurationMs =
+    PW_UNIT_TEST_CONFIG_PERF_MIN_DURATION_MS;
+
 }  // namespace config
 }  // namespace unit_test
 }  // namespace pw
@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include <cstdint>
+
 namespace pw {
 namespace unit_test {
 
@@ -78,6 +80,14 @@ struct TestExpectation {
   bool success;
 };
 
+struct PerfTestResult {
+  // The number of iterations of the measured batch.
+  uint32_t iterations;
+
+  // The total duration of the measured iterations, in nanoseconds.
+  int64_t duration_ns;
+};
+
 struct RunTestsSummary {
   // The number of passed tests among the run tests.
   int passed_tests;
@@ -119,6 +129,10 @@ class EventHandler {
   // result of the expectation.
   virtual void TestCaseExpect(const TestCase& test_case,
                               const TestExpectation& expectation) = 0;
+
+  // Called when a performance test case (see pw_unit_test/perf_test.h) has
+  // finished measuring, before the TestCaseEnd event.
+  virtual void TestCasePerf(const TestCase&, const PerfTestResult&) {}
 };
 
 // Sets the event handler for a test run. Must be called before RUN_ALL_TESTS()
@@ -164,6 +164,8 @@ class Framework {
                            .disabled_tests = 0},
         exit_status_(0),
         event_handler_(nullptr),
+        shard_index_(0),
+        shard_count_(1),
         memory_pool_() {}
 
   static Framework& Get() { return framework_; }
@@ -190,8 +192,24 @@ class Framework {
   void SetTestSuitesToRun(std::span<std::string_view> test_suites) {
     test_suites_to_run_ = test_suites;
   }
+
+  // Only run test cases whose full names, "TestSuite.TestName", match the
+  // filter during the next test run. See MatchesTestFilter() for the syntax.
+  // The filter's characters must remain valid for the duration of the run.
+  void SetTestFilter(std::string_view filter) { test_filter_ = filter; }
 #endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
 
+  // Only run one shard of the registered test cases during the next test run.
+  // Test cases are assigned to shards round-robin in registration order, so
+  // running every shard from 0 to shard_count - 1 runs every test case once.
+  void SetTestShard(uint32_t shard_index, uint32_t shard_count) {
+    shard_index_ = shard_index;
+    shard_count_ = shard_count != 0 ? shard_count : 1;
+  }
+
+  uint32_t shard_index() const { return shard_index_; }
+  uint32_t shard_count() const { return shard_count_; }
+
   bool ShouldRunTest(const TestInfo& test_info);
 
   // Constructs an instance of a unit test class and runs the test.
@@ -268,6 +286,9 @@ class Framework {
                          int line,
                          bool success);
 
+  // Dispatches an event with the measurements of a performance test.
+  void PerfResult(const PerfTestResult& result);
+
  private:
   // Sets current_test_ and dispatches an event indicating that a test started.
   void StartTest(const TestInfo& test);
@@ -299,12 +320,30 @@ class Framework {
 
 #if PW_CXX_STANDARD_IS_SUPPORTED(17)
   std::span<std::string_view> test_suites_to_run_;
+  std::string_view test_filter_;
 #endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
 
+  uint32_t shard_index_;
+  uint32_t shard_count_;
+
   std::aligned_storage_t<config::kMemoryPoolSize, alignof(std::max_align_t)>
       memory_pool_;
 };
 
+#if PW_CXX_STANDARD_IS_SUPPORTED(17)
+// Returns whether the test case's full name, "TestSuite.TestName", matches a
+// Google Test style filter: a ':'-separated list of patterns, optionally
+// followed by '-' and a ':'-separated list of patterns to exclude. In patterns,
+// '*' matches any string and '?' matches any single character. An empty
+// filter matches every test case.
+//
+//   "Status.*"                  All test cases in the Status suite.
+//   "*Crc*:Base64.Encode"       Test cases with Crc in their names, and one
+//                               other test case.
+//   "Kvs*-*.LargeMap:*.Stress"  All Kvs test cases except two.
+bool MatchesTestFilter(std::string_view filter, const TestCase& test_case);
+#endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
+
 // Information about a single test case, including a pointer to a function which
 // constructs and runs the test class. These are statically allocated instead of
 // the test classes, as test classes can be very large.
@@ -398,8 +437,16 @@ class Test {
 inline void SetTestSuitesToRun(std::span<std::string_view> test_suites) {
   internal::Framework::Get().SetTestSuitesToRun(test_suites);
 }
+
+inline void SetTestFilter(std::string_view filter) {
+  internal::Framework::Get().SetTestFilter(filter);
+}
 #endif  // PW_CXX_STANDARD_IS_SUPPORTED(17)
 
+inline void SetTestShard(uint32_t shard_index, uint32_t shard_count) {
+  internal::Framework::Get().SetTestShard(shard_index, shard_count);
+}
+
 }  // namespace unit_test
 }  // namespace pw
 
@@ -31,6 +31,8 @@ class LoggingEventHandler : public EventHandler {
   void TestCaseExpect(const TestCase& test_case,
                       const TestExpectation& expectation) override;
   void TestCaseDisabled(const TestCase& test_case) override;
+  void TestCasePerf(const TestCase& test_case,
+                    const PerfTestResult& result) override;
 
  private:
   bool verbose_;
@@ -0,0 +1,36 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include "pw_unit_test/event_handler.h"
+
+namespace pw::unit_test {
+
+// Runs all registered test cases split across forked worker processes, and
+// returns a status of zero if all tests passed, or nonzero if there were any
+// failures. This is only available on hosts that support fork(), such as Linux
+// and macOS.
+//
+// Each of the jobs workers runs one shard of the test cases (see
+// SetTestShard()); if a shard was already selected, the workers split that
+// shard. The workers send their test events back to this process, which
+// dispatches them to handler one test case at a time, so the output of tests
+// running concurrently is not interleaved. A worker that crashes fails the test
+// case it was running, but the other workers' test cases still run.
+//
+// Test suite filters and test filters set on the framework apply to the
+// workers. If jobs is 1 or less, the tests run in this process.
+int RunAllTestsInParallel(EventHandler& handler, int jobs);
+
+}  // namespace pw::unit_test
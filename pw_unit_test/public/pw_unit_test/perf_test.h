@@ -0,0 +1,139 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_unit_test/framework.h"
+
+// Defines a performance test. The body receives a pw::unit_test::PerfState,
+// named by the third argument, and runs the code to measure in a loop for as
+// long as KeepRunning() returns true:
+//
+//   PERF_TEST(Crc32, FourKiB, state) {
+//     std::array<std::byte, 4096> data = {};
+//     while (state.KeepRunning()) {
+//       pw::unit_test::DoNotOptimize(pw::checksum::Crc32::Calculate(data));
+//     }
+//   }
+//
+// The loop first runs PW_UNIT_TEST_CONFIG_PERF_WARMUP_ITERATIONS unmeasured
+// iterations. It then runs batches of increasing size until one takes at least
+// PW_UNIT_TEST_CONFIG_PERF_MIN_DURATION_MS. That batch's iteration count and
+// duration are reported to the event handler's TestCasePerf() function. Work
+// outside of the loop, such as setup, is not measured.
+//
+// Performance tests are regular test cases: they may use EXPECT and ASSERT
+// statements, and are run and filtered like other tests. Time is measured with
+// pw::chrono::SystemClock, so its resolution depends on the target's clock
+// backend.
+#define PERF_TEST(test_suite_name, test_name, state)                         \
+  static_assert(sizeof(#test_suite_name) > 1,                                \
+                "test_suite_name must not be empty");                        \
+  static_assert(sizeof(#test_name) > 1, "test_name must not be empty");      \
+                                                                             \
+  class _PW_TEST_CLASS_NAME(test_suite_name, test_name) final                \
+      : public ::pw::unit_test::internal::PerfTest {                         \
+   private:                                                                  \
+    void PigweedPerfTestBody(::pw::unit_test::PerfState& state) override;    \
+                                                                             \
+    static ::pw::unit_test::internal::TestInfo test_info_;                   \
+  };                                                                         \
+                                                                             \
+  ::pw::unit_test::internal::TestInfo                                        \
+      _PW_TEST_CLASS_NAME(test_suite_name, test_name)::test_info_(           \
+          #test_suite_name,                                                  \
+          #test_name,                                                        \
+          __FILE__,                                                          \
+          ::pw::unit_test::internal::Framework::CreateAndRunTest<            \
+              _PW_TEST_CLASS_NAME(test_suite_name, test_name)>);             \
+                                                                             \
+  void _PW_TEST_CLASS_NAME(test_suite_name, test_name)::PigweedPerfTestBody( \
+      ::pw::unit_test::PerfState& state)
+
+namespace pw::unit_test {
+
+// Prevents the compiler from optimizing away the computation of value, without
+// the cost of storing it to a volatile variable. Use it on the results of the
+// code being measured.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T>
+inline void DoNotOptimize(T& value) {
+#if defined(__clang__)
+  asm volatile("" : "+r,m"(value) : : "memory");
+#else
+  asm volatile("" : "+m,r"(value) : : "memory");
+#endif  // defined(__clang__)
+}
+
+// Controls the measurement loop of a PERF_TEST.
+class PerfState {
+ public:
+  constexpr PerfState()
+      : remaining_(config::kPerfWarmupIterations),
+        batch_iterations_(1),
+        phase_(Phase::kWarmup),
+        batch_start_{},
+        result_{} {}
+
+  PerfState(const PerfState&) = delete;
+  PerfState& operator=(const PerfState&) = delete;
+
+  // Returns true if the loop should run another iteration. The fast path is a
+  // decrement and a branch; the clock is only read between batches.
+  bool KeepRunning() {
+    if (remaining_ != 0) {
+      remaining_ -= 1;
+      return true;
+    }
+    return NextBatch();
+  }
+
+  // True once a batch has been measured and KeepRunning() returned false.
+  bool done() const { return phase_ == Phase::kDone; }
+
+  // The measurements of the final batch. Only valid once done().
+  const PerfTestResult& result() const { return result_; }
+
+ private:
+  enum class Phase : uint8_t { kWarmup, kMeasuring, kDone };
+
+  // Called when an iteration count runs out. Starts the first or next batch,
+  // or finishes measuring.
+  bool NextBatch();
+
+  uint32_t remaining_;
+  uint32_t batch_iterations_;
+  Phase phase_;
+  chrono::SystemClock::time_point batch_start_;
+  PerfTestResult result_;
+};
+
+namespace internal {
+
+// Base class for PERF_TEST test cases. Runs the body and reports its result.
+class PerfTest : public Test {
+ private:
+  void PigweedTestBody() final;
+
+  virtual void PigweedPerfTestBody(PerfState& state) = 0;
+};
+
+}  // namespace internal
+}  // namespace pw::unit_test
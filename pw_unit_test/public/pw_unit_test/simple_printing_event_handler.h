@@ -51,6 +51,8 @@ class SimplePrintingEventHandler : public EventHandler {
   void TestCaseExpect(const TestCase& test_case,
                       const TestExpectation& expectation) override;
   void TestCaseDisabled(const TestCase& test_case) override;
+  void TestCasePerf(const TestCase& test_case,
+                    const PerfTestResult& result) override;
 
  private:
   void WriteLine(const char* format, ...) PW_PRINTF_FORMAT(2, 3);
@@ -52,6 +52,16 @@ class TestExpectation:
         return f'TestExpectation({str(self)})'
 
 
+@dataclass(frozen=True)
+class PerfTestResult:
+    iterations: int
+    duration_ns: int
+
+    @property
+    def ns_per_iteration(self) -> float:
+        return self.duration_ns / self.iterations if self.iterations else 0.0
+
+
 class EventHandler(abc.ABC):
     @abc.abstractmethod
     def run_all_tests_start(self):
@@ -78,6 +88,9 @@ class EventHandler(abc.ABC):
                          expectation: TestExpectation):
         """Called after each expect/assert statement within a test case."""
 
+    def test_case_perf(self, test_case: TestCase, result: PerfTestResult):
+        """Called when a performance test case has finished measuring."""
+
 
 class LoggingEventHandler(EventHandler):
     """Event handler that logs test events using Google Test format."""
@@ -110,6 +123,10 @@ class LoggingEventHandler(EventHandler):
         log('      Expected: %s', expectation.expression)
         log('        Actual: %s', expectation.evaluated_expression)
 
+    def test_case_perf(self, test_case: TestCase, result: PerfTestResult):
+        _LOG.info('[   PERF   ] %s: %d iterations, %.3f ns/iteration',
+                  test_case, result.iterations, result.ns_per_iteration)
+
 
 def run_tests(rpcs: pw_rpc.client.Services,
               report_passed_expectations: bool = False,
@@ -174,5 +191,10 @@ def run_tests(rpcs: pw_rpc.client.Services,
                     raw_expectation.success,
                 )
                 event_handler.test_case_expect(current_test_case, expectation)
+            elif response.HasField('test_case_perf'):
+                raw_perf = response.test_case_perf
+                event_handler.test_case_perf(
+                    current_test_case,
+                    PerfTestResult(raw_perf.iterations, raw_perf.duration_ns))
 
     return all_tests_passed
@@ -41,4 +41,9 @@ void RpcEventHandler::TestCaseDisabled(const TestCase& test_case) {
   service_.WriteTestCaseDisabled(test_case);
 }
 
+void RpcEventHandler::TestCasePerf(const TestCase&,
+                                   const PerfTestResult& result) {
+  service_.WriteTestCasePerf(result);
+}
+
 }  // namespace pw::unit_test::internal
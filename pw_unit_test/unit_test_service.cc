@@ -139,4 +139,12 @@ void UnitTestService::WriteTestCaseExpectation(
   });
 }
 
+void UnitTestService::WriteTestCasePerf(const PerfTestResult& result) {
+  WriteEvent([&](Event::Encoder& event) {
+    TestCasePerf::Encoder test_case_perf = event.GetTestCasePerfEncoder();
+    test_case_perf.WriteIterations(result.iterations);
+    test_case_perf.WriteDurationNs(result.duration_ns);
+  });
+}
+
 }  // namespace pw::unit_test
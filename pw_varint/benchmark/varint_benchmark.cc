@@ -0,0 +1,128 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This program measures how long it takes to decode varints of various sizes
+// with Decode, with DecodeMany, and with a simple byte-at-a-time loop for
+// comparison. Build the varint_benchmark target for the target of interest and
+// run it; results are logged with pw_log.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_log/log.h"
+#include "pw_preprocessor/compiler.h"
+#include "pw_varint/varint.h"
+
+namespace {
+
+using pw::chrono::SystemClock;
+
+constexpr size_t kValues = 256;
+constexpr size_t kIterations = 1024;
+
+std::array<std::byte, kValues * pw::varint::kMaxVarint64SizeBytes> encoded;
+std::array<uint64_t, kValues> decoded;
+
+// Stores a checksum of the decoded values so decoding is not optimized out.
+volatile uint64_t checksum;
+
+// Decodes a varint one byte at a time, as pw_varint_Decode did before it had a
+// fast path. Like pw_varint_Decode, this is not inlined into the caller.
+PW_NO_INLINE size_t ByteAtATimeDecode(std::span<const std::byte> input,
+                                      uint64_t* output) {
+  uint64_t value = 0;
+  const size_t max_count =
+      std::min(pw::varint::kMaxVarint64SizeBytes, input.size());
+
+  for (size_t count = 0; count < max_count; ++count) {
+    value |= static_cast<uint64_t>(input[count] & std::byte(0x7f))
+             << (7 * count);
+
+    if ((input[count] & std::byte(0x80)) == std::byte(0)) {
+      *output = value;
+      return count + 1;
+    }
+  }
+  return 0;
+}
+
+template <typename Function>
+void Measure(const char* name, size_t encoded_size, Function decode_all) {
+  const std::span<const std::byte> input(encoded.data(), encoded_size);
+
+  const SystemClock::time_point start = SystemClock::now();
+  for (size_t iteration = 0; iteration < kIterations; ++iteration) {
+    decode_all(input);
+    checksum = checksum + decoded[iteration % kValues];
+  }
+  const SystemClock::duration elapsed = SystemClock::now() - start;
+
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  const uint64_t total_values = uint64_t(kValues) * kIterations;
+
+  PW_LOG_INFO("  %-14s %u varints in %u us (%u ns per varint)",
+              name,
+              unsigned(total_values),
+              unsigned(elapsed_ns / 1000),
+              unsigned(elapsed_ns / total_values));
+}
+
+void RunBenchmark(const char* description, uint64_t (*value)(size_t)) {
+  size_t encoded_size = 0;
+  for (size_t i = 0; i < kValues; ++i) {
+    encoded_size += pw::varint::Encode(
+        value(i), std::span(encoded).subspan(encoded_size));
+  }
+
+  PW_LOG_INFO("%s (%u bytes)", description, unsigned(encoded_size));
+
+  Measure("byte-at-a-time", encoded_size, [](std::span<const std::byte> in) {
+    for (uint64_t& out : decoded) {
+      in = in.subspan(ByteAtATimeDecode(in, &out));
+    }
+  });
+
+  Measure("Decode", encoded_size, [](std::span<const std::byte> in) {
+    for (uint64_t& out : decoded) {
+      in = in.subspan(pw::varint::Decode(in, &out));
+    }
+  });
+
+  Measure("DecodeMany", encoded_size, [](std::span<const std::byte> in) {
+    size_t bytes_read;
+    pw::varint::DecodeMany(in, decoded, &bytes_read);
+  });
+}
+
+}  // namespace
+
+int main() {
+  RunBenchmark("1-byte varints", [](size_t i) { return uint64_t(i % 128); });
+  RunBenchmark("2-byte varints",
+               [](size_t i) { return uint64_t(128 + i * 61); });
+  RunBenchmark("5-byte varints",
+               [](size_t i) { return uint64_t(0xffffffffu - i); });
+  RunBenchmark("10-byte varints",
+               [](size_t i) { return ~uint64_t(0) - i; });
+  RunBenchmark("Mixed varints", [](size_t i) {
+    return (uint64_t(1) << (i % 64)) + uint64_t(i);
+  });
+  return 0;
+}
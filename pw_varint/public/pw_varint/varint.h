@@ -62,6 +62,19 @@ size_t pw_varint_ZigZagDecode(const void* input,
                               size_t input_size,
                               int64_t* output);
 
+// Decodes consecutive varints into an array. Returns the number of values
+// decoded and sets *bytes_read to the number of bytes they occupied.
+size_t pw_varint_DecodeMany(const void* input,
+                            size_t input_size,
+                            uint64_t* values,
+                            size_t max_values,
+                            size_t* bytes_read);
+size_t pw_varint_ZigZagDecodeMany(const void* input,
+                                  size_t input_size,
+                                  int64_t* values,
+                                  size_t max_values,
+                                  size_t* bytes_read);
+
 // Returns the size of an when encoded as a varint.
 size_t pw_varint_EncodedSize(uint64_t integer);
 size_t pw_varint_ZigZagEncodedSize(int64_t integer);
@@ -163,6 +176,37 @@ inline size_t Decode(const std::span<const std::byte>& input, uint64_t* value) {
   return pw_varint_Decode(input.data(), input.size(), value);
 }
 
+// Decodes consecutive varints from the input, such as a packed repeated
+// protobuf field, into the values array. If decoding into signed integers, the
+// values are ZigZag decoded. This is faster than calling Decode in a loop.
+//
+// Decoding stops when the input is exhausted, the values array is full, or an
+// invalid varint is found. Returns the number of values decoded and sets
+// *bytes_read to the number of bytes that they occupied. The entire input was
+// decoded if *bytes_read equals input.size().
+//
+//   std::array<uint64_t, 16> values;
+//   size_t bytes_read;
+//   size_t count = DecodeMany(packed_field, values, &bytes_read);
+//
+//   if (bytes_read != packed_field.size()) {
+//     return Status::DataLoss();  // Invalid data or too many values.
+//   }
+//
+inline size_t DecodeMany(std::span<const std::byte> input,
+                         std::span<uint64_t> values,
+                         size_t* bytes_read) {
+  return pw_varint_DecodeMany(
+      input.data(), input.size(), values.data(), values.size(), bytes_read);
+}
+
+inline size_t DecodeMany(std::span<const std::byte> input,
+                         std::span<int64_t> values,
+                         size_t* bytes_read) {
+  return pw_varint_ZigZagDecodeMany(
+      input.data(), input.size(), values.data(), values.size(), bytes_read);
+}
+
 enum class Format {
   kZeroTerminatedLeastSignificant = PW_VARINT_ZERO_TERMINATED_LEAST_SIGNIFICANT,
   kZeroTerminatedMostSignificant = PW_VARINT_ZERO_TERMINATED_MOST_SIGNIFICANT,
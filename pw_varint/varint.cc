@@ -15,19 +15,162 @@
 #include "pw_varint/varint.h"
 
 #include <algorithm>
+#include <cstring>
+#include <type_traits>
 
 namespace pw {
 namespace varint {
 namespace {
 
-inline bool ZeroTerminated(pw_varint_Format format) {
+constexpr bool ZeroTerminated(pw_varint_Format format) {
   return (static_cast<unsigned>(format) & 0b10) == 0;
 }
 
-inline bool LeastSignificant(pw_varint_Format format) {
+constexpr bool LeastSignificant(pw_varint_Format format) {
   return (static_cast<unsigned>(format) & 0b01) == 0;
 }
 
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && \
+    UINTPTR_MAX == UINT64_MAX
+#define PW_VARINT_DECODE_WORDS 1
+#else
+#define PW_VARINT_DECODE_WORDS 0
+#endif
+
+#if PW_VARINT_DECODE_WORDS
+
+// Decodes up to 8 bytes of a varint with a single 8-byte load. The terminating
+// byte is found by counting trailing zeros in the continuation bits, and the
+// 7-bit groups are packed together without a per-byte loop. The input must
+// have at least 8 bytes.
+//
+// Returns the size of the varint, or 0 if it is longer than 8 bytes. In that
+// case, *output is set to the value of its first 8 bytes.
+//
+// This is only used on 64-bit little-endian targets, where the 8 bytes load
+// directly into one register.
+template <pw_varint_Format kFormat>
+size_t DecodeWord(const std::byte* input, uint64_t* output) {
+  constexpr uint64_t kLowBits = 0x0101010101010101;
+
+  uint64_t word;
+  std::memcpy(&word, input, sizeof(word));
+
+  // Find the continuation bits that mark the last byte of the varint.
+  constexpr uint64_t kFlags =
+      LeastSignificant(kFormat) ? kLowBits : kLowBits << 7;
+  const uint64_t last_bytes = (ZeroTerminated(kFormat) ? ~word : word) & kFlags;
+  const size_t count = last_bytes == 0u
+                           ? sizeof(word)
+                           : size_t(__builtin_ctzll(last_bytes)) / 8 + 1;
+
+  // Keep the 7 value bits of each byte in the varint.
+  if (LeastSignificant(kFormat)) {
+    word >>= 1;
+  }
+  uint64_t value =
+      word & (~uint64_t(0) >> (64 - 8 * count)) & (kLowBits * 0x7f);
+
+  // Pack the 7-bit groups: 7 bits into 14 bits, 14 into 28, and 28 into 56.
+  value = (value & 0x007f007f007f007f) | ((value & 0x7f007f007f007f00) >> 1);
+  value = (value & 0x00003fff00003fff) | ((value & 0x3fff00003fff0000) >> 2);
+  value = (value & 0x000000000fffffff) | ((value & 0x0fffffff00000000) >> 4);
+
+  *output = value;
+  return last_bytes == 0u ? 0 : count;
+}
+
+#endif  // PW_VARINT_DECODE_WORDS
+
+template <pw_varint_Format kFormat>
+size_t DecodeOne(const std::byte* input, size_t input_size, uint64_t* output) {
+  if (input_size == 0u) {
+    return 0;
+  }
+
+  // The continuation bit, and its value in the last byte of a varint.
+  constexpr std::byte kFlag =
+      LeastSignificant(kFormat) ? std::byte(0x01) : std::byte(0x80);
+  constexpr std::byte kLast = ZeroTerminated(kFormat) ? std::byte(0) : kFlag;
+  constexpr uint32_t kShift = LeastSignificant(kFormat) ? 1 : 0;
+
+  // Single-byte varints are the most common, so check for them first.
+  if ((input[0] & kFlag) == kLast) {
+    *output = static_cast<uint64_t>((input[0] & ~kFlag) >> kShift);
+    return 1;
+  }
+
+  // Two-byte varints are also common and quicker to decode with a branch.
+  if (input_size >= 2u && (input[1] & kFlag) == kLast) {
+    *output = static_cast<uint64_t>((input[0] & ~kFlag) >> kShift) |
+              static_cast<uint64_t>((input[1] & ~kFlag) >> kShift) << 7;
+    return 2;
+  }
+
+  uint64_t decoded_value = 0;
+  size_t count = 0;
+
+#if PW_VARINT_DECODE_WORDS
+  if (input_size >= sizeof(uint64_t)) {
+    const size_t size = DecodeWord<kFormat>(input, &decoded_value);
+    if (size != 0u) {
+      *output = decoded_value;
+      return size;
+    }
+    count = sizeof(uint64_t);  // Decode the rest of the varint byte by byte.
+  }
+#endif  // PW_VARINT_DECODE_WORDS
+
+  // The largest 64-bit ints require 10 B.
+  const size_t max_count = std::min(kMaxVarint64SizeBytes, input_size);
+
+  for (; count < max_count; ++count) {
+    // Add the bottom seven bits of the next byte to the result.
+    decoded_value |= static_cast<uint64_t>((input[count] & ~kFlag) >> kShift)
+                     << (7 * count);
+
+    // Stop decoding if the end is reached.
+    if ((input[count] & kFlag) == kLast) {
+      *output = decoded_value;
+      return count + 1;
+    }
+  }
+
+  return 0;
+}
+
+template <typename T>
+size_t DecodeMany(const void* input,
+                  size_t input_size,
+                  T* values,
+                  size_t max_values,
+                  size_t* bytes_read) {
+  const std::byte* const start = static_cast<const std::byte*>(input);
+  const std::byte* data = start;
+  const std::byte* const end = start + input_size;
+
+  size_t decoded = 0;
+  for (; decoded < max_values && data != end; ++decoded) {
+    uint64_t value;
+    const size_t bytes =
+        DecodeOne<PW_VARINT_ZERO_TERMINATED_MOST_SIGNIFICANT>(
+            data, size_t(end - data), &value);
+    if (bytes == 0u) {
+      break;
+    }
+
+    if constexpr (std::is_signed<T>()) {
+      values[decoded] = ZigZagDecode(value);
+    } else {
+      values[decoded] = value;
+    }
+    data += bytes;
+  }
+
+  *bytes_read = size_t(data - start);
+  return decoded;
+}
+
 }  // namespace
 
 extern "C" size_t pw_varint_EncodeCustom(uint64_t input,
@@ -77,48 +220,23 @@ extern "C" size_t pw_varint_DecodeCustom(const void* input,
                                          size_t input_size,
                                          uint64_t* output,
                                          pw_varint_Format format) {
-  uint64_t decoded_value = 0;
-  uint_fast8_t count = 0;
-  const std::byte* buffer = static_cast<const std::byte*>(input);
+  const std::byte* const bytes = static_cast<const std::byte*>(input);
 
-  // The largest 64-bit ints require 10 B.
-  const size_t max_count = std::min(kMaxVarint64SizeBytes, input_size);
-
-  std::byte mask;
-  uint32_t shift;
-  if (LeastSignificant(format)) {
-    mask = std::byte(0xfe);
-    shift = 1;
-  } else {
-    mask = std::byte(0x7f);
-    shift = 0;
+  switch (format) {
+    case PW_VARINT_ZERO_TERMINATED_LEAST_SIGNIFICANT:
+      return DecodeOne<PW_VARINT_ZERO_TERMINATED_LEAST_SIGNIFICANT>(
+          bytes, input_size, output);
+    case PW_VARINT_ZERO_TERMINATED_MOST_SIGNIFICANT:
+      return DecodeOne<PW_VARINT_ZERO_TERMINATED_MOST_SIGNIFICANT>(
+          bytes, input_size, output);
+    case PW_VARINT_ONE_TERMINATED_LEAST_SIGNIFICANT:
+      return DecodeOne<PW_VARINT_ONE_TERMINATED_LEAST_SIGNIFICANT>(
+          bytes, input_size, output);
+    case PW_VARINT_ONE_TERMINATED_MOST_SIGNIFICANT:
+      return DecodeOne<PW_VARINT_ONE_TERMINATED_MOST_SIGNIFICANT>(
+          bytes, input_size, output);
   }
-
-  // Determines whether a byte is the last byte of a varint.
-  auto is_last_byte = [&](std::byte byte) {
-    if (ZeroTerminated(format)) {
-      return (byte & ~mask) == std::byte(0);
-    }
-    return (byte & ~mask) != std::byte(0);
-  };
-
-  while (true) {
-    if (count >= max_count) {
-      return 0;
-    }
-
-    // Add the bottom seven bits of the next byte to the result.
-    decoded_value |= static_cast<uint64_t>((buffer[count] & mask) >> shift)
-                     << (7 * count);
-
-    // Stop decoding if the end is reached.
-    if (is_last_byte(buffer[count++])) {
-      break;
-    }
-  }
-
-  *output = decoded_value;
-  return count;
+  return 0;
 }
 
 // TODO(frolv): Remove this deprecated alias.
@@ -150,6 +268,22 @@ extern "C" size_t pw_varint_ZigZagDecode(const void* input,
   return bytes;
 }
 
+extern "C" size_t pw_varint_DecodeMany(const void* input,
+                                       size_t input_size,
+                                       uint64_t* values,
+                                       size_t max_values,
+                                       size_t* bytes_read) {
+  return DecodeMany(input, input_size, values, max_values, bytes_read);
+}
+
+extern "C" size_t pw_varint_ZigZagDecodeMany(const void* input,
+                                             size_t input_size,
+                                             int64_t* values,
+                                             size_t max_values,
+                                             size_t* bytes_read) {
+  return DecodeMany(input, input_size, values, max_values, bytes_read);
+}
+
 extern "C" size_t pw_varint_EncodedSize(uint64_t integer) {
   return EncodedSize(integer);
 }
@@ -14,6 +14,7 @@
 
 #include "pw_varint/varint.h"
 
+#include <array>
 #include <cinttypes>
 #include <cstdint>
 #include <cstring>
@@ -35,6 +36,11 @@ size_t pw_varint_CallDecode(void* input, size_t input_size, uint64_t* output);
 size_t pw_varint_CallZigZagDecode(void* input,
                                   size_t input_size,
                                   int64_t* output);
+size_t pw_varint_CallDecodeMany(const void* input,
+                                size_t input_size,
+                                uint64_t* values,
+                                size_t max_values,
+                                size_t* bytes_read);
 
 }  // extern "C"
 
@@ -1009,6 +1015,103 @@ TEST(Varint, DecodeWithOptions_MultiByte) {
   EXPECT_EQ(value, 0u);
 }
 
+TEST(Varint, DecodeWithOptions_LongInput_AllSizes) {
+  constexpr Format kFormats[] = {
+      Format::kZeroTerminatedLeastSignificant,
+      Format::kZeroTerminatedMostSignificant,
+      Format::kOneTerminatedLeastSignificant,
+      Format::kOneTerminatedMostSignificant,
+  };
+
+  // Decode values of every encoded size, followed by more data than the varint
+  // needs, which exercises decoding 8 bytes at a time.
+  for (Format format : kFormats) {
+    for (int bits = 0; bits <= 64; ++bits) {
+      const uint64_t expected =
+          bits == 64 ? std::numeric_limits<uint64_t>::max()
+                     : (uint64_t(1) << bits) - 1;
+
+      std::array<std::byte, 16> buffer;
+      buffer.fill(std::byte{0xa5});
+      const size_t size = Encode(expected, buffer, format);
+      ASSERT_NE(size, 0u);
+
+      uint64_t value = 0;
+      EXPECT_EQ(Decode(buffer, &value, format), size);
+      EXPECT_EQ(value, expected);
+    }
+  }
+}
+
+TEST(Varint, DecodeMany_Unsigned) {
+  const auto kData = MakeBuffer("\x00\x01\x80\x01\xff\xff\x03\x7f");
+
+  std::array<uint64_t, 8> values{};
+  size_t bytes_read = 0;
+  ASSERT_EQ(DecodeMany(kData, values, &bytes_read), 5u);
+  EXPECT_EQ(bytes_read, kData.size());
+
+  EXPECT_EQ(values[0], 0u);
+  EXPECT_EQ(values[1], 1u);
+  EXPECT_EQ(values[2], 128u);
+  EXPECT_EQ(values[3], 65535u);
+  EXPECT_EQ(values[4], 127u);
+}
+
+TEST(Varint, DecodeMany_Signed) {
+  const auto kData = MakeBuffer("\x00\x01\x02\xfe\xff\x03");
+
+  std::array<int64_t, 8> values{};
+  size_t bytes_read = 0;
+  ASSERT_EQ(DecodeMany(kData, values, &bytes_read), 4u);
+  EXPECT_EQ(bytes_read, kData.size());
+
+  EXPECT_EQ(values[0], 0);
+  EXPECT_EQ(values[1], -1);
+  EXPECT_EQ(values[2], 1);
+  EXPECT_EQ(values[3], 32767);
+}
+
+TEST(Varint, DecodeMany_StopsWhenValuesFull) {
+  const auto kData = MakeBuffer("\x01\x02\x03");
+
+  std::array<uint64_t, 2> values{};
+  size_t bytes_read = 0;
+  ASSERT_EQ(DecodeMany(kData, values, &bytes_read), 2u);
+  EXPECT_EQ(bytes_read, 2u);
+  EXPECT_EQ(values[0], 1u);
+  EXPECT_EQ(values[1], 2u);
+}
+
+TEST(Varint, DecodeMany_StopsAtIncompleteVarint) {
+  const auto kData = MakeBuffer("\x01\x02\x80\x80");
+
+  std::array<uint64_t, 8> values{};
+  size_t bytes_read = 0;
+  ASSERT_EQ(DecodeMany(kData, values, &bytes_read), 2u);
+  EXPECT_EQ(bytes_read, 2u);
+}
+
+TEST(Varint, DecodeMany_Empty) {
+  std::array<uint64_t, 2> values{};
+  size_t bytes_read = 1;
+  EXPECT_EQ(DecodeMany(std::span<const std::byte>(), values, &bytes_read), 0u);
+  EXPECT_EQ(bytes_read, 0u);
+}
+
+TEST(Varint, DecodeMany_FromC) {
+  const auto kData = MakeBuffer("\x05\x80\x01");
+
+  uint64_t values[4] = {};
+  size_t bytes_read = 0;
+  EXPECT_EQ(pw_varint_CallDecodeMany(
+                kData.data(), kData.size(), values, 4, &bytes_read),
+            2u);
+  EXPECT_EQ(bytes_read, 3u);
+  EXPECT_EQ(values[0], 5u);
+  EXPECT_EQ(values[1], 128u);
+}
+
 TEST(Varint, EncodedSize) {
   EXPECT_EQ(EncodedSize(uint64_t(0u)), 1u);
   EXPECT_EQ(EncodedSize(uint64_t(1u)), 1u);
@@ -40,3 +40,12 @@ size_t pw_varint_CallZigZagDecode(void* input,
                                   int64_t* output) {
   return pw_varint_ZigZagDecode(input, input_size, output);
 }
+
+size_t pw_varint_CallDecodeMany(const void* input,
+                                size_t input_size,
+                                uint64_t* values,
+                                size_t max_values,
+                                size_t* bytes_read) {
+  return pw_varint_DecodeMany(
+      input, input_size, values, max_values, bytes_read);
+}
@@ -0,0 +1,109 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_containers/inline_queue.h"
+#include "pw_function/function.h"
+#include "pw_status/status.h"
+#include "pw_sync/counting_semaphore.h"
+#include "pw_sync/interrupt_spin_lock.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::work_queue {
+
+using WorkItem = Function<void()>;
+
+enum class Priority {
+  kNormal,
+  kHigh,
+};
+
+// The WorkQueue runs work items on one or more worker threads, so that modules
+// which need to do work in the background can share threads and their stacks
+// instead of each creating their own.
+//
+// Work items are stored in fixed-capacity queues, one per priority. Pending
+// high priority items are run before normal priority items; within a priority,
+// items are run in the order they were pushed.
+//
+// The WorkQueue is a ThreadCore. Start a worker by creating a thread for it:
+//
+//   pw::work_queue::WorkQueueWithBuffer<10> work_queue;
+//   pw::thread::Thread worker(options, work_queue);
+//
+// Several threads may be started for the same WorkQueue. Each idle worker
+// takes the next pending item, so work is spread across the workers. Note that
+// with more than one worker, items may run concurrently and may complete out of
+// order.
+class WorkQueue : public thread::ThreadCore {
+ public:
+  WorkQueue(InlineQueue<WorkItem>& queue,
+            InlineQueue<WorkItem>& high_priority_queue)
+      : stop_requested_(false),
+        queue_(queue),
+        high_priority_queue_(high_priority_queue) {}
+
+  // Enqueues a work item for a worker thread to run. This is IRQ safe.
+  //
+  // Returns:
+  //   OK - Success, the item will be run.
+  //   FAILED_PRECONDITION - RequestStop() was called; the item was not queued.
+  //   RESOURCE_EXHAUSTED - The queue for this priority is full.
+  Status PushWork(WorkItem&& work_item, Priority priority = Priority::kNormal)
+      PW_LOCKS_EXCLUDED(lock_);
+
+  // Requests the worker threads to stop. Work which was already pushed is still
+  // run before the workers return from Run(); new work is rejected.
+  void RequestStop() PW_LOCKS_EXCLUDED(lock_);
+
+ private:
+  void Run() override PW_LOCKS_EXCLUDED(lock_);
+
+  sync::InterruptSpinLock lock_;
+  bool stop_requested_ PW_GUARDED_BY(lock_);
+  InlineQueue<WorkItem>& queue_ PW_GUARDED_BY(lock_);
+  InlineQueue<WorkItem>& high_priority_queue_ PW_GUARDED_BY(lock_);
+
+  // Released once per queued work item, plus once when a stop is requested.
+  sync::CountingSemaphore work_available_;
+};
+
+namespace internal {
+
+// Holds the queues for WorkQueueWithBuffer. This is a separate base class so
+// that the queues are constructed before the WorkQueue refers to them.
+template <size_t kWorkQueueEntries, size_t kHighPriorityEntries>
+struct WorkQueueBuffer {
+  InlineQueue<WorkItem, kWorkQueueEntries> queue;
+  InlineQueue<WorkItem, kHighPriorityEntries> high_priority_queue;
+};
+
+}  // namespace internal
+
+// A WorkQueue with storage for kWorkQueueEntries normal priority items and
+// kHighPriorityEntries high priority items.
+template <size_t kWorkQueueEntries, size_t kHighPriorityEntries = 0>
+class WorkQueueWithBuffer
+    : private internal::WorkQueueBuffer<kWorkQueueEntries,
+                                        kHighPriorityEntries>,
+      public WorkQueue {
+ public:
+  WorkQueueWithBuffer()
+      : WorkQueue(this->queue, this->high_priority_queue) {}
+};
+
+}  // namespace pw::work_queue
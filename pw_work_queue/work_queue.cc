@@ -0,0 +1,72 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_work_queue/work_queue.h"
+
+#include <mutex>
+
+namespace pw::work_queue {
+
+Status WorkQueue::PushWork(WorkItem&& work_item, Priority priority) {
+  {
+    std::lock_guard lock(lock_);
+    if (stop_requested_) {
+      return Status::FailedPrecondition();
+    }
+    InlineQueue<WorkItem>& queue =
+        priority == Priority::kHigh ? high_priority_queue_ : queue_;
+    if (queue.full()) {
+      return Status::ResourceExhausted();
+    }
+    queue.push(std::move(work_item));
+  }
+  work_available_.release();
+  return OkStatus();
+}
+
+void WorkQueue::RequestStop() {
+  {
+    std::lock_guard lock(lock_);
+    if (stop_requested_) {
+      return;
+    }
+    stop_requested_ = true;
+  }
+  work_available_.release();
+}
+
+void WorkQueue::Run() {
+  while (true) {
+    work_available_.acquire();
+
+    WorkItem work_item;
+    {
+      std::lock_guard lock(lock_);
+      InlineQueue<WorkItem>& queue =
+          high_priority_queue_.empty() ? queue_ : high_priority_queue_;
+      if (queue.empty()) {
+        // Every item has its own release, so an empty queue means this was the
+        // stop request's release. Pass it on so the next worker stops too.
+        work_available_.release();
+        return;
+      }
+      work_item = std::move(queue.front());
+      queue.pop();
+    }
+
+    work_item();
+  }
+}
+
+}  // namespace pw::work_queue
@@ -0,0 +1,151 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_work_queue/work_queue.h"
+
+#include <mutex>
+
+#include "gtest/gtest.h"
+#include "pw_sync/binary_semaphore.h"
+#include "pw_thread/test_threads.h"
+#include "pw_thread/thread.h"
+
+namespace pw::work_queue {
+namespace {
+
+TEST(WorkQueue, RunsPushedWork) {
+  WorkQueueWithBuffer<4> work_queue;
+  struct {
+    int count = 0;
+    sync::BinarySemaphore done;
+  } runs;
+
+  thread::Thread worker(thread::test::TestOptionsThread0(), work_queue);
+
+  auto work = [&runs] {
+    runs.count += 1;
+    if (runs.count == 3) {
+      runs.done.release();
+    }
+  };
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(work_queue.PushWork(work), OkStatus());
+  }
+  runs.done.acquire();
+  EXPECT_EQ(runs.count, 3);
+
+  work_queue.RequestStop();
+#if PW_THREAD_JOINING_ENABLED
+  worker.join();
+#else
+  worker.detach();
+#endif  // PW_THREAD_JOINING_ENABLED
+  thread::test::WaitUntilDetachedThreadsCleanedUp();
+}
+
+TEST(WorkQueue, RejectsWorkWhenFull) {
+  WorkQueueWithBuffer<2> work_queue;
+
+  // No worker is running, so the queue fills up.
+  EXPECT_EQ(work_queue.PushWork([] {}), OkStatus());
+  EXPECT_EQ(work_queue.PushWork([] {}), OkStatus());
+  EXPECT_EQ(work_queue.PushWork([] {}), Status::ResourceExhausted());
+
+  // There is no high priority storage.
+  EXPECT_EQ(work_queue.PushWork([] {}, Priority::kHigh),
+            Status::ResourceExhausted());
+}
+
+TEST(WorkQueue, RejectsWorkAfterStop) {
+  WorkQueueWithBuffer<2> work_queue;
+  work_queue.RequestStop();
+  EXPECT_EQ(work_queue.PushWork([] {}), Status::FailedPrecondition());
+}
+
+TEST(WorkQueue, RunsPendingWorkBeforeStopping) {
+  WorkQueueWithBuffer<4, 2> work_queue;
+  struct {
+    int order[4] = {};
+    int next = 0;
+  } runs;
+
+  // Queue the work before starting the worker, so the run order depends only
+  // on priority.
+  ASSERT_EQ(work_queue.PushWork([&runs] { runs.order[runs.next++] = 1; }),
+            OkStatus());
+  ASSERT_EQ(work_queue.PushWork([&runs] { runs.order[runs.next++] = 2; }),
+            OkStatus());
+  ASSERT_EQ(work_queue.PushWork([&runs] { runs.order[runs.next++] = 3; },
+                                Priority::kHigh),
+            OkStatus());
+  ASSERT_EQ(work_queue.PushWork([&runs] { runs.order[runs.next++] = 4; },
+                                Priority::kHigh),
+            OkStatus());
+  work_queue.RequestStop();
+
+  thread::Thread worker(thread::test::TestOptionsThread0(), work_queue);
+#if PW_THREAD_JOINING_ENABLED
+  worker.join();
+#else
+  worker.detach();
+#endif  // PW_THREAD_JOINING_ENABLED
+  thread::test::WaitUntilDetachedThreadsCleanedUp();
+
+  ASSERT_EQ(runs.next, 4);
+  EXPECT_EQ(runs.order[0], 3);
+  EXPECT_EQ(runs.order[1], 4);
+  EXPECT_EQ(runs.order[2], 1);
+  EXPECT_EQ(runs.order[3], 2);
+}
+
+TEST(WorkQueue, MultipleWorkers) {
+  WorkQueueWithBuffer<8> work_queue;
+  struct {
+    sync::InterruptSpinLock lock;
+    int count = 0;
+    sync::BinarySemaphore done;
+  } runs;
+
+  auto work = [&runs] {
+    std::lock_guard lock(runs.lock);
+    runs.count += 1;
+    if (runs.count == 8) {
+      runs.done.release();
+    }
+  };
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_EQ(work_queue.PushWork(work), OkStatus());
+  }
+
+  thread::Thread worker_0(thread::test::TestOptionsThread0(), work_queue);
+  thread::Thread worker_1(thread::test::TestOptionsThread1(), work_queue);
+  runs.done.acquire();
+
+  // Both workers stop.
+  work_queue.RequestStop();
+#if PW_THREAD_JOINING_ENABLED
+  worker_0.join();
+  worker_1.join();
+#else
+  worker_0.detach();
+  worker_1.detach();
+#endif  // PW_THREAD_JOINING_ENABLED
+  thread::test::WaitUntilDetachedThreadsCleanedUp();
+
+  std::lock_guard lock(runs.lock);
+  EXPECT_EQ(runs.count, 8);
+}
+
+}  // namespace
+}  // namespace pw::work_queue
@@ -50,21 +50,7 @@ rpc::Server& Server() { return server; }
 Status Start() {
   // Declare a buffer for decoding incoming HDLC frames.
   std::array<std::byte, kMaxTransmissionUnit> input_buffer;
-  hdlc::Decoder decoder(input_buffer);
-
-  while (true) {
-    std::byte byte;
-    Status ret_val = pw::sys_io::ReadByte(&byte);
-    if (!ret_val.ok()) {
-      return ret_val;
-    }
-    if (auto result = decoder.Process(byte); result.ok()) {
-      hdlc::Frame& frame = result.value();
-      if (frame.address() == hdlc::kDefaultRpcAddress) {
-        server.ProcessPacket(frame.data(), hdlc_channel_output);
-      }
-    }
-  }
+  return hdlc::ReadAndProcessPackets(server, hdlc_channel_output, input_buffer);
 }
 
 }  // namespace pw::rpc::system_server